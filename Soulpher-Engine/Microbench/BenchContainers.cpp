@@ -0,0 +1,164 @@
+﻿/**
+ * @file BenchContainers.cpp
+ * @brief `TArray`, `TMap` y `TSet` frente a `std::vector`, `std::unordered_map` y `std::unordered_set`.
+ *
+ * @details
+ * Inserción, búsqueda e iteración con N claves enteras. `TMap` y `TSet` son tablas
+ * hash de direccionamiento abierto (ver `THashTable`); con 65 536 claves la tabla ya no
+ * cabe en L1 y se ve el coste de los fallos de caché.
+ */
+
+#include <iostream>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "Microbench.h"
+#include "EngineUtilities/Structures/TArray.h"
+#include "EngineUtilities/Structures/TMap.h"
+#include "EngineUtilities/Structures/TSet.h"
+
+namespace {
+    /// Claves desordenadas pero reproducibles (multiplicativo de Knuth).
+    int keyAt(size_t i) {
+        return static_cast<int>((i * 2654435761u) & 0x7fffffff);
+    }
+
+    // --- Inserción ---
+
+    void TArray_Add(Microbench::State& state) {
+        while (state.keepRunning()) {
+            EU::TArray<int> array;
+            for (size_t i = 0; i < state.range(); ++i) array.Add(static_cast<int>(i));
+            Microbench::doNotOptimize(array);
+        }
+        state.setItemsProcessed(state.iterations() * state.range());
+    }
+
+    void StdVector_PushBack(Microbench::State& state) {
+        while (state.keepRunning()) {
+            std::vector<int> vector;
+            for (size_t i = 0; i < state.range(); ++i) vector.push_back(static_cast<int>(i));
+            Microbench::doNotOptimize(vector.data());
+        }
+        state.setItemsProcessed(state.iterations() * state.range());
+    }
+
+    void TMap_Add(Microbench::State& state) {
+        while (state.keepRunning()) {
+            EU::TMap<int, int> map;
+            for (size_t i = 0; i < state.range(); ++i) map.Add(keyAt(i), static_cast<int>(i));
+            Microbench::doNotOptimize(map);
+        }
+        state.setItemsProcessed(state.iterations() * state.range());
+    }
+
+    void StdUnorderedMap_Insert(Microbench::State& state) {
+        while (state.keepRunning()) {
+            std::unordered_map<int, int> map;
+            for (size_t i = 0; i < state.range(); ++i) map[keyAt(i)] = static_cast<int>(i);
+            Microbench::doNotOptimize(map);
+        }
+        state.setItemsProcessed(state.iterations() * state.range());
+    }
+
+    void TSet_Add(Microbench::State& state) {
+        while (state.keepRunning()) {
+            EU::TSet<int> set;
+            for (size_t i = 0; i < state.range(); ++i) set.Add(keyAt(i));
+            Microbench::doNotOptimize(set);
+        }
+        state.setItemsProcessed(state.iterations() * state.range());
+    }
+
+    void StdUnorderedSet_Insert(Microbench::State& state) {
+        while (state.keepRunning()) {
+            std::unordered_set<int> set;
+            for (size_t i = 0; i < state.range(); ++i) set.insert(keyAt(i));
+            Microbench::doNotOptimize(set);
+        }
+        state.setItemsProcessed(state.iterations() * state.range());
+    }
+
+    // --- Búsqueda (todas las claves, en el orden de inserción) ---
+
+    void TMap_Lookup(Microbench::State& state) {
+        EU::TMap<int, int> map;
+        for (size_t i = 0; i < state.range(); ++i) map.Add(keyAt(i), static_cast<int>(i));
+        while (state.keepRunning()) {
+            int sum = 0;
+            for (size_t i = 0; i < state.range(); ++i) sum += map[keyAt(i)];
+            Microbench::doNotOptimize(sum);
+        }
+        state.setItemsProcessed(state.iterations() * state.range());
+    }
+
+    void StdUnorderedMap_Find(Microbench::State& state) {
+        std::unordered_map<int, int> map;
+        for (size_t i = 0; i < state.range(); ++i) map[keyAt(i)] = static_cast<int>(i);
+        while (state.keepRunning()) {
+            int sum = 0;
+            for (size_t i = 0; i < state.range(); ++i) sum += map.find(keyAt(i))->second;
+            Microbench::doNotOptimize(sum);
+        }
+        state.setItemsProcessed(state.iterations() * state.range());
+    }
+
+    void TSet_Contains(Microbench::State& state) {
+        EU::TSet<int> set;
+        for (size_t i = 0; i < state.range(); ++i) set.Add(keyAt(i));
+        while (state.keepRunning()) {
+            size_t hits = 0;
+            for (size_t i = 0; i < state.range(); ++i) hits += set.Contains(keyAt(i)) ? 1 : 0;
+            Microbench::doNotOptimize(hits);
+        }
+        state.setItemsProcessed(state.iterations() * state.range());
+    }
+
+    void StdUnorderedSet_Count(Microbench::State& state) {
+        std::unordered_set<int> set;
+        for (size_t i = 0; i < state.range(); ++i) set.insert(keyAt(i));
+        while (state.keepRunning()) {
+            size_t hits = 0;
+            for (size_t i = 0; i < state.range(); ++i) hits += set.count(keyAt(i));
+            Microbench::doNotOptimize(hits);
+        }
+        state.setItemsProcessed(state.iterations() * state.range());
+    }
+
+    // --- Iteración (TArray::operator[] solo comprueba el rango en Debug) ---
+
+    void TArray_Iterate(Microbench::State& state) {
+        EU::TArray<int> array;
+        for (size_t i = 0; i < state.range(); ++i) array.Add(static_cast<int>(i));
+        while (state.keepRunning()) {
+            int sum = 0;
+            for (int value : array) sum += value;
+            Microbench::doNotOptimize(sum);
+        }
+        state.setItemsProcessed(state.iterations() * state.range());
+    }
+
+    void StdVector_Iterate(Microbench::State& state) {
+        std::vector<int> vector;
+        for (size_t i = 0; i < state.range(); ++i) vector.push_back(static_cast<int>(i));
+        while (state.keepRunning()) {
+            int sum = 0;
+            for (int value : vector) sum += value;
+            Microbench::doNotOptimize(sum);
+        }
+        state.setItemsProcessed(state.iterations() * state.range());
+    }
+}
+
+MICROBENCH(TArray_Add, 64, 1024, 65536);
+MICROBENCH(StdVector_PushBack, 64, 1024, 65536);
+MICROBENCH(TMap_Add, 64, 1024, 65536);
+MICROBENCH(StdUnorderedMap_Insert, 64, 1024, 65536);
+MICROBENCH(TSet_Add, 64, 1024, 65536);
+MICROBENCH(StdUnorderedSet_Insert, 64, 1024, 65536);
+MICROBENCH(TMap_Lookup, 64, 1024, 65536);
+MICROBENCH(StdUnorderedMap_Find, 64, 1024, 65536);
+MICROBENCH(TSet_Contains, 64, 1024, 65536);
+MICROBENCH(StdUnorderedSet_Count, 64, 1024, 65536);
+MICROBENCH(TArray_Iterate, 64, 1024, 65536);
+MICROBENCH(StdVector_Iterate, 64, 1024, 65536);
@@ -0,0 +1,729 @@
+﻿/**
+ * @file BenchMath.cpp
+ * @brief Matemática de `EngineUtilities` frente a xnamath (SSE) y `<cmath>`.
+ *
+ * @details
+ * Cada prueba procesa un lote de N elementos (matrices, vectores o escalares) para que
+ * el coste del bucle no domine. Los datos son transformaciones afines reproducibles.
+ *
+ * `EU::Matrix4x4` usa la mejor tabla de `EU::GetMatrixKernels` para la CPU (SSE4.1 o
+ * AVX2); las filas `*_Scalar` fuerzan la tabla escalar para ver cuánto aporta el
+ * despacho. `Scalar_TransformCoord` es la referencia escrita a mano, sin llamadas.
+ *
+ * `EU_Batch_*` usa los lotes de `BatchMath.h`: SoA (tres arrays) o con paso, sobre
+ * vértices del tamaño de `SimpleVertex`; comparar con `XM_Vector3TransformCoordStream`.
+ *
+ * `EU_QuatBatch_*` normaliza, interpola y convierte a `Matrix3x4` lotes de cuaterniones
+ * (`QuaternionBatch.h`); `XM_*` hace lo mismo elemento a elemento con xnamath.
+ *
+ * `FastMath_*` mide cada función de `EU::FastMath` en sus dos niveles (`Precise`,
+ * `Fast`) y sus tres anchos (escalar, `_SSE` con 4 valores, `_AVX2` con 8) sobre un
+ * lote dentro de su dominio; `Std_*` es la misma función de `<cmath>` con el mismo lote.
+ */
+
+#include <windows.h>
+#include <xnamath.h>
+#include <cmath>
+#include <vector>
+#include "Microbench.h"
+#include "EngineUtilities/Matrix/Matrix4x4.h"
+#include "EngineUtilities/Vectors/Vector3.h"
+#include "EngineUtilities/Vectors/Quaternion.h"
+#include "EngineUtilities/Utilities/EngineMath.h"
+#include "EngineUtilities/Utilities/BatchMath.h"
+#include "EngineUtilities/Vectors/QuaternionBatch.h"
+
+namespace {
+    /// Matriz afín del elemento `i`: escala, rotación y traslación distintas por índice.
+    XMMATRIX affineAt(size_t i) {
+        const float t = static_cast<float>(i);
+        return XMMatrixScaling(1.0f + 0.01f * (i % 7), 1.0f, 1.0f + 0.02f * (i % 5)) *
+            XMMatrixRotationRollPitchYaw(0.1f * t, 0.2f * t, 0.3f * t) *
+            XMMatrixTranslation(t, -t, 0.5f * t);
+    }
+
+    EU::Matrix4x4 toEU(const XMMATRIX& matrix) {
+        XMFLOAT4X4 stored;
+        XMStoreFloat4x4(&stored, matrix);
+        EU::Matrix4x4 result;
+        for (int r = 0; r < 4; ++r) {
+            for (int c = 0; c < 4; ++c) {
+                result.m[r][c] = stored.m[r][c];
+            }
+        }
+        return result;
+    }
+
+    /// Vértice con el mismo tamaño que `SimpleVertex` (posición + UV).
+    struct SimpleVertexLike {
+        XMFLOAT3 pos;
+        XMFLOAT2 tex;
+    };
+
+    XMFLOAT3 pointAt(size_t i) {
+        const float t = static_cast<float>(i);
+        return XMFLOAT3(std::sin(t), std::cos(t), 0.5f * t);
+    }
+
+    // --- Producto de matrices ---
+
+    void EU_Matrix4x4_Multiply(Microbench::State& state) {
+        std::vector<EU::Matrix4x4> a, b, out(state.range());
+        for (size_t i = 0; i < state.range(); ++i) {
+            a.push_back(toEU(affineAt(i)));
+            b.push_back(toEU(affineAt(i + 1)));
+        }
+        while (state.keepRunning()) {
+            for (size_t i = 0; i < state.range(); ++i) out[i] = a[i] * b[i];
+            Microbench::doNotOptimize(out[0]);
+        }
+        state.setItemsProcessed(state.iterations() * state.range());
+    }
+
+    void EU_Matrix4x4_Multiply_Scalar(Microbench::State& state) {
+        const EU::MatrixKernels& kernels = EU::GetMatrixKernels(EU::SimdLevel::Scalar);
+        std::vector<EU::Matrix4x4> a, b, out(state.range());
+        for (size_t i = 0; i < state.range(); ++i) {
+            a.push_back(toEU(affineAt(i)));
+            b.push_back(toEU(affineAt(i + 1)));
+        }
+        while (state.keepRunning()) {
+            for (size_t i = 0; i < state.range(); ++i) kernels.Multiply(&a[i].m[0][0], &b[i].m[0][0], &out[i].m[0][0]);
+            Microbench::doNotOptimize(out[0]);
+        }
+        state.setItemsProcessed(state.iterations() * state.range());
+    }
+
+    void XM_MatrixMultiply(Microbench::State& state) {
+        std::vector<XMMATRIX> a, b, out(state.range());
+        for (size_t i = 0; i < state.range(); ++i) {
+            a.push_back(affineAt(i));
+            b.push_back(affineAt(i + 1));
+        }
+        while (state.keepRunning()) {
+            for (size_t i = 0; i < state.range(); ++i) out[i] = XMMatrixMultiply(a[i], b[i]);
+            Microbench::doNotOptimize(out[0]);
+        }
+        state.setItemsProcessed(state.iterations() * state.range());
+    }
+
+    // --- Determinante e inversa ---
+
+    void EU_Matrix4x4_Determinant(Microbench::State& state) {
+        std::vector<EU::Matrix4x4> a;
+        for (size_t i = 0; i < state.range(); ++i) a.push_back(toEU(affineAt(i)));
+        while (state.keepRunning()) {
+            float sum = 0.0f;
+            for (size_t i = 0; i < state.range(); ++i) sum += a[i].determinant();
+            Microbench::doNotOptimize(sum);
+        }
+        state.setItemsProcessed(state.iterations() * state.range());
+    }
+
+    void XM_MatrixDeterminant(Microbench::State& state) {
+        std::vector<XMMATRIX> a;
+        for (size_t i = 0; i < state.range(); ++i) a.push_back(affineAt(i));
+        while (state.keepRunning()) {
+            XMVECTOR sum = XMVectorZero();
+            for (size_t i = 0; i < state.range(); ++i) sum = XMVectorAdd(sum, XMMatrixDeterminant(a[i]));
+            Microbench::doNotOptimize(sum);
+        }
+        state.setItemsProcessed(state.iterations() * state.range());
+    }
+
+    void EU_Matrix4x4_Inverse(Microbench::State& state) {
+        std::vector<EU::Matrix4x4> a, out(state.range());
+        for (size_t i = 0; i < state.range(); ++i) a.push_back(toEU(affineAt(i)));
+        while (state.keepRunning()) {
+            for (size_t i = 0; i < state.range(); ++i) out[i] = a[i].inverse();
+            Microbench::doNotOptimize(out[0]);
+        }
+        state.setItemsProcessed(state.iterations() * state.range());
+    }
+
+    void EU_Matrix4x4_Inverse_Scalar(Microbench::State& state) {
+        const EU::MatrixKernels& kernels = EU::GetMatrixKernels(EU::SimdLevel::Scalar);
+        std::vector<EU::Matrix4x4> a, out(state.range());
+        for (size_t i = 0; i < state.range(); ++i) a.push_back(toEU(affineAt(i)));
+        while (state.keepRunning()) {
+            for (size_t i = 0; i < state.range(); ++i) kernels.Inverse(&a[i].m[0][0], &out[i].m[0][0]);
+            Microbench::doNotOptimize(out[0]);
+        }
+        state.setItemsProcessed(state.iterations() * state.range());
+    }
+
+    void XM_MatrixInverse(Microbench::State& state) {
+        std::vector<XMMATRIX> a, out(state.range());
+        for (size_t i = 0; i < state.range(); ++i) a.push_back(affineAt(i));
+        while (state.keepRunning()) {
+            XMVECTOR det;
+            for (size_t i = 0; i < state.range(); ++i) out[i] = XMMatrixInverse(&det, a[i]);
+            Microbench::doNotOptimize(out[0]);
+        }
+        state.setItemsProcessed(state.iterations() * state.range());
+    }
+
+    // --- Transformar puntos ---
+
+    void Scalar_TransformCoord(Microbench::State& state) {
+        const EU::Matrix4x4 m = toEU(affineAt(3));
+        std::vector<XMFLOAT3> in, out(state.range());
+        for (size_t i = 0; i < state.range(); ++i) in.push_back(pointAt(i));
+        while (state.keepRunning()) {
+            for (size_t i = 0; i < state.range(); ++i) {
+                const XMFLOAT3& p = in[i];
+                const float x = p.x * m.m[0][0] + p.y * m.m[1][0] + p.z * m.m[2][0] + m.m[3][0];
+                const float y = p.x * m.m[0][1] + p.y * m.m[1][1] + p.z * m.m[2][1] + m.m[3][1];
+                const float z = p.x * m.m[0][2] + p.y * m.m[1][2] + p.z * m.m[2][2] + m.m[3][2];
+                const float w = p.x * m.m[0][3] + p.y * m.m[1][3] + p.z * m.m[2][3] + m.m[3][3];
+                const float invW = 1.0f / w;
+                out[i] = XMFLOAT3(x * invW, y * invW, z * invW);
+            }
+            Microbench::doNotOptimize(out[0]);
+        }
+        state.setItemsProcessed(state.iterations() * state.range());
+    }
+
+    void EU_Matrix4x4_TransformPoints(Microbench::State& state) {
+        const EU::Matrix4x4 m = toEU(affineAt(3));
+        std::vector<EU::Vector3> in, out(state.range());
+        for (size_t i = 0; i < state.range(); ++i) {
+            const XMFLOAT3 p = pointAt(i);
+            in.push_back(EU::Vector3(p.x, p.y, p.z));
+        }
+        while (state.keepRunning()) {
+            m.transformPoints(in.data(), out.data(), state.range());
+            Microbench::doNotOptimize(out[0]);
+        }
+        state.setItemsProcessed(state.iterations() * state.range());
+    }
+
+    void XM_Vector3TransformCoord(Microbench::State& state) {
+        const XMMATRIX m = affineAt(3);
+        std::vector<XMFLOAT3> in, out(state.range());
+        for (size_t i = 0; i < state.range(); ++i) in.push_back(pointAt(i));
+        while (state.keepRunning()) {
+            for (size_t i = 0; i < state.range(); ++i) {
+                XMStoreFloat3(&out[i], XMVector3TransformCoord(XMLoadFloat3(&in[i]), m));
+            }
+            Microbench::doNotOptimize(out[0]);
+        }
+        state.setItemsProcessed(state.iterations() * state.range());
+    }
+
+    void XM_Vector3TransformCoordStream(Microbench::State& state) {
+        const XMMATRIX m = affineAt(3);
+        std::vector<XMFLOAT3> in, out(state.range());
+        for (size_t i = 0; i < state.range(); ++i) in.push_back(pointAt(i));
+        while (state.keepRunning()) {
+            XMVector3TransformCoordStream(out.data(), sizeof(XMFLOAT3), in.data(), sizeof(XMFLOAT3),
+                static_cast<UINT>(state.range()), m);
+            Microbench::doNotOptimize(out[0]);
+        }
+        state.setItemsProcessed(state.iterations() * state.range());
+    }
+
+    // --- Lotes SoA (BatchMath) ---
+
+    /// Puntos de `pointAt` repartidos en tres arrays.
+    void soaPoints(size_t count, std::vector<float>& xs, std::vector<float>& ys, std::vector<float>& zs) {
+        xs.resize(count);
+        ys.resize(count);
+        zs.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            const XMFLOAT3 p = pointAt(i);
+            xs[i] = p.x;
+            ys[i] = p.y;
+            zs[i] = p.z;
+        }
+    }
+
+    void EU_Batch_TransformPoints(Microbench::State& state) {
+        const EU::Matrix4x4 m = toEU(affineAt(3));
+        std::vector<float> xs, ys, zs, ox(state.range()), oy(state.range()), oz(state.range());
+        soaPoints(state.range(), xs, ys, zs);
+        while (state.keepRunning()) {
+            EU::TransformPoints(m, xs.data(), ys.data(), zs.data(), state.range(), ox.data(), oy.data(), oz.data());
+            Microbench::doNotOptimize(ox[0]);
+        }
+        state.setItemsProcessed(state.iterations() * state.range());
+    }
+
+    void EU_Batch_TransformPoints_Scalar(Microbench::State& state) {
+        const EU::Matrix4x4 m = toEU(affineAt(3));
+        std::vector<float> xs, ys, zs, ox(state.range()), oy(state.range()), oz(state.range());
+        soaPoints(state.range(), xs, ys, zs);
+        while (state.keepRunning()) {
+            EU::BatchScalar::TransformPoints(m, xs.data(), ys.data(), zs.data(), state.range(),
+                ox.data(), oy.data(), oz.data());
+            Microbench::doNotOptimize(ox[0]);
+        }
+        state.setItemsProcessed(state.iterations() * state.range());
+    }
+
+    /// Mismo recorrido que `StaticBatcher`: la posición dentro de un vértice con UV.
+    void EU_Batch_TransformPoints_Strided(Microbench::State& state) {
+        const EU::Matrix4x4 m = toEU(affineAt(3));
+        std::vector<SimpleVertexLike> in(state.range()), out(state.range());
+        for (size_t i = 0; i < state.range(); ++i) in[i].pos = pointAt(i);
+        while (state.keepRunning()) {
+            EU::TransformPoints(m, &in[0].pos, sizeof(SimpleVertexLike), &out[0].pos, sizeof(SimpleVertexLike),
+                state.range());
+            Microbench::doNotOptimize(out[0]);
+        }
+        state.setItemsProcessed(state.iterations() * state.range());
+    }
+
+    void EU_Batch_ComputeAABB(Microbench::State& state) {
+        std::vector<float> xs, ys, zs;
+        soaPoints(state.range(), xs, ys, zs);
+        while (state.keepRunning()) {
+            const EU::AABB box = EU::ComputeAABB(xs.data(), ys.data(), zs.data(), state.range());
+            Microbench::doNotOptimize(box);
+        }
+        state.setItemsProcessed(state.iterations() * state.range());
+    }
+
+    void EU_Batch_ComputeAABB_Strided(Microbench::State& state) {
+        std::vector<SimpleVertexLike> in(state.range());
+        for (size_t i = 0; i < state.range(); ++i) in[i].pos = pointAt(i);
+        while (state.keepRunning()) {
+            const EU::AABB box = EU::ComputeAABB(&in[0].pos, sizeof(SimpleVertexLike), state.range());
+            Microbench::doNotOptimize(box);
+        }
+        state.setItemsProcessed(state.iterations() * state.range());
+    }
+
+    void EU_Batch_TransformAABBs(Microbench::State& state) {
+        std::vector<EU::Matrix4x4> matrices;
+        std::vector<EU::AABB> in(state.range()), out(state.range());
+        for (size_t i = 0; i < state.range(); ++i) {
+            matrices.push_back(toEU(affineAt(i)));
+            const XMFLOAT3 p = pointAt(i);
+            in[i].Min = EU::Vector3(p.x - 1.0f, p.y - 2.0f, p.z - 0.5f);
+            in[i].Max = EU::Vector3(p.x + 1.0f, p.y + 2.0f, p.z + 0.5f);
+        }
+        while (state.keepRunning()) {
+            EU::TransformAABBs(matrices.data(), in.data(), out.data(), state.range());
+            Microbench::doNotOptimize(out[0]);
+        }
+        state.setItemsProcessed(state.iterations() * state.range());
+    }
+
+    // --- Rotación por cuaternión ---
+
+    void EU_Quaternion_Rotate(Microbench::State& state) {
+        const EU::Quaternion q = EU::Quaternion::fromAxisAngle(EU::Vector3(0.0f, 1.0f, 0.0f), 0.7f);
+        std::vector<EU::Vector3> in, out(state.range());
+        for (size_t i = 0; i < state.range(); ++i) {
+            const XMFLOAT3 p = pointAt(i);
+            in.push_back(EU::Vector3(p.x, p.y, p.z));
+        }
+        while (state.keepRunning()) {
+            for (size_t i = 0; i < state.range(); ++i) out[i] = q.rotate(in[i]);
+            Microbench::doNotOptimize(out[0]);
+        }
+        state.setItemsProcessed(state.iterations() * state.range());
+    }
+
+    void XM_Vector3Rotate(Microbench::State& state) {
+        const XMVECTOR q = XMQuaternionRotationAxis(XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f), 0.7f);
+        std::vector<XMFLOAT3> in, out(state.range());
+        for (size_t i = 0; i < state.range(); ++i) in.push_back(pointAt(i));
+        while (state.keepRunning()) {
+            for (size_t i = 0; i < state.range(); ++i) {
+                XMStoreFloat3(&out[i], XMVector3Rotate(XMLoadFloat3(&in[i]), q));
+            }
+            Microbench::doNotOptimize(out[0]);
+        }
+        state.setItemsProcessed(state.iterations() * state.range());
+    }
+
+    // --- Lotes de cuaterniones (QuaternionBatch.h) ---
+
+    /// Rotación unitaria del elemento `i`; `phase` separa las dos poses de una interpolación.
+    EU::Quaternion quaternionAt(size_t i, float phase) {
+        const XMFLOAT3 p = pointAt(i + 1);
+        const float length = std::sqrt(p.x * p.x + p.y * p.y + p.z * p.z);
+        return EU::Quaternion::fromAxisAngle(EU::Vector3(p.x / length, p.y / length, p.z / length),
+            0.01f * static_cast<float>(i % 300) + phase);
+    }
+
+    void EU_QuatBatch_Normalize(Microbench::State& state) {
+        std::vector<EU::Quaternion> in, out(state.range());
+        for (size_t i = 0; i < state.range(); ++i) in.push_back(quaternionAt(i, 0.0f) * 1.5f);
+        while (state.keepRunning()) {
+            EU::NormalizeQuaternions(in.data(), out.data(), state.range());
+            Microbench::doNotOptimize(out[0]);
+        }
+        state.setItemsProcessed(state.iterations() * state.range());
+    }
+
+    void EU_QuatBatch_Nlerp(Microbench::State& state) {
+        std::vector<EU::Quaternion> a, b, out(state.range());
+        for (size_t i = 0; i < state.range(); ++i) {
+            a.push_back(quaternionAt(i, 0.0f));
+            b.push_back(quaternionAt(i, 0.3f));
+        }
+        while (state.keepRunning()) {
+            EU::NlerpQuaternions(a.data(), b.data(), 0.4f, out.data(), state.range());
+            Microbench::doNotOptimize(out[0]);
+        }
+        state.setItemsProcessed(state.iterations() * state.range());
+    }
+
+    template<bool Batched>
+    void quaternionSlerp(Microbench::State& state) {
+        std::vector<EU::Quaternion> a, b, out(state.range());
+        for (size_t i = 0; i < state.range(); ++i) {
+            a.push_back(quaternionAt(i, 0.0f));
+            b.push_back(quaternionAt(i, 0.3f));
+        }
+        while (state.keepRunning()) {
+            if (Batched) {
+                EU::SlerpQuaternions(a.data(), b.data(), 0.4f, out.data(), state.range());
+            } else {
+                for (size_t i = 0; i < state.range(); ++i) out[i] = EU::QuaternionScalar::Slerp(a[i], b[i], 0.4f);
+            }
+            Microbench::doNotOptimize(out[0]);
+        }
+        state.setItemsProcessed(state.iterations() * state.range());
+    }
+
+    void EU_QuatBatch_Slerp(Microbench::State& state) { quaternionSlerp<true>(state); }
+    void EU_QuatBatch_Slerp_Scalar(Microbench::State& state) { quaternionSlerp<false>(state); }
+
+    void XM_QuaternionSlerp(Microbench::State& state) {
+        std::vector<XMFLOAT4> a, b, out(state.range());
+        for (size_t i = 0; i < state.range(); ++i) {
+            const EU::Quaternion qa = quaternionAt(i, 0.0f), qb = quaternionAt(i, 0.3f);
+            a.push_back(XMFLOAT4(qa.x, qa.y, qa.z, qa.w));
+            b.push_back(XMFLOAT4(qb.x, qb.y, qb.z, qb.w));
+        }
+        while (state.keepRunning()) {
+            for (size_t i = 0; i < state.range(); ++i) {
+                XMStoreFloat4(&out[i], XMQuaternionSlerp(XMLoadFloat4(&a[i]), XMLoadFloat4(&b[i]), 0.4f));
+            }
+            Microbench::doNotOptimize(out[0]);
+        }
+        state.setItemsProcessed(state.iterations() * state.range());
+    }
+
+    void EU_QuatBatch_ToMatrices(Microbench::State& state) {
+        std::vector<EU::Quaternion> rotations;
+        std::vector<EU::Vector3> scales, translations;
+        std::vector<EU::Matrix3x4> out(state.range());
+        for (size_t i = 0; i < state.range(); ++i) {
+            const XMFLOAT3 p = pointAt(i);
+            rotations.push_back(quaternionAt(i, 0.0f));
+            scales.push_back(EU::Vector3(1.0f, 1.0f + 0.01f * (i % 7), 1.0f));
+            translations.push_back(EU::Vector3(p.x, p.y, p.z));
+        }
+        while (state.keepRunning()) {
+            EU::QuaternionsToMatrices(rotations.data(), scales.data(), translations.data(), out.data(), state.range());
+            Microbench::doNotOptimize(out[0]);
+        }
+        state.setItemsProcessed(state.iterations() * state.range());
+    }
+
+    /// Referencia de `EU_QuatBatch_ToMatrices`: S * R * T con xnamath, un elemento cada vez.
+    void XM_MatrixAffineTransformation(Microbench::State& state) {
+        std::vector<XMFLOAT4> rotations;
+        std::vector<XMFLOAT3> scales, translations;
+        std::vector<XMFLOAT4X4> out(state.range());
+        for (size_t i = 0; i < state.range(); ++i) {
+            const EU::Quaternion q = quaternionAt(i, 0.0f);
+            rotations.push_back(XMFLOAT4(q.x, q.y, q.z, q.w));
+            scales.push_back(XMFLOAT3(1.0f, 1.0f + 0.01f * (i % 7), 1.0f));
+            translations.push_back(pointAt(i));
+        }
+        while (state.keepRunning()) {
+            for (size_t i = 0; i < state.range(); ++i) {
+                const XMMATRIX m = XMMatrixScalingFromVector(XMLoadFloat3(&scales[i])) *
+                    XMMatrixRotationQuaternion(XMLoadFloat4(&rotations[i]));
+                XMStoreFloat4x4(&out[i], m * XMMatrixTranslationFromVector(XMLoadFloat3(&translations[i])));
+            }
+            Microbench::doNotOptimize(out[0]);
+        }
+        state.setItemsProcessed(state.iterations() * state.range());
+    }
+
+    // --- Normalizar vectores (EU::sqrt es iterativa) ---
+
+    void EU_Vector3_Normalize(Microbench::State& state) {
+        std::vector<EU::Vector3> in, out(state.range());
+        for (size_t i = 0; i < state.range(); ++i) {
+            const XMFLOAT3 p = pointAt(i + 1);
+            in.push_back(EU::Vector3(p.x, p.y, p.z));
+        }
+        while (state.keepRunning()) {
+            for (size_t i = 0; i < state.range(); ++i) out[i] = in[i].normalize();
+            Microbench::doNotOptimize(out[0]);
+        }
+        state.setItemsProcessed(state.iterations() * state.range());
+    }
+
+    void XM_Vector3Normalize(Microbench::State& state) {
+        std::vector<XMFLOAT3> in, out(state.range());
+        for (size_t i = 0; i < state.range(); ++i) in.push_back(pointAt(i + 1));
+        while (state.keepRunning()) {
+            for (size_t i = 0; i < state.range(); ++i) {
+                XMStoreFloat3(&out[i], XMVector3Normalize(XMLoadFloat3(&in[i])));
+            }
+            Microbench::doNotOptimize(out[0]);
+        }
+        state.setItemsProcessed(state.iterations() * state.range());
+    }
+
+    // --- EngineMath frente a <cmath> ---
+
+    void EU_Sqrt(Microbench::State& state) {
+        while (state.keepRunning()) {
+            float sum = 0.0f;
+            for (size_t i = 1; i <= state.range(); ++i) sum += EU::sqrt(static_cast<float>(i));
+            Microbench::doNotOptimize(sum);
+        }
+        state.setItemsProcessed(state.iterations() * state.range());
+    }
+
+    void Std_Sqrt(Microbench::State& state) {
+        while (state.keepRunning()) {
+            float sum = 0.0f;
+            for (size_t i = 1; i <= state.range(); ++i) sum += std::sqrt(static_cast<float>(i));
+            Microbench::doNotOptimize(sum);
+        }
+        state.setItemsProcessed(state.iterations() * state.range());
+    }
+
+    void EU_Sin(Microbench::State& state) {
+        while (state.keepRunning()) {
+            float sum = 0.0f;
+            for (size_t i = 0; i < state.range(); ++i) sum += EU::sin(static_cast<float>(i) * 0.001f);
+            Microbench::doNotOptimize(sum);
+        }
+        state.setItemsProcessed(state.iterations() * state.range());
+    }
+
+    void Std_Sin(Microbench::State& state) {
+        while (state.keepRunning()) {
+            float sum = 0.0f;
+            for (size_t i = 0; i < state.range(); ++i) sum += std::sin(static_cast<float>(i) * 0.001f);
+            Microbench::doNotOptimize(sum);
+        }
+        state.setItemsProcessed(state.iterations() * state.range());
+    }
+
+    // --- EU::FastMath: niveles y anchos frente a <cmath> ---
+
+    using EU::FastMath::Tier;
+
+    enum class FastOp { Sin, Exp, Log, Rsqrt };
+
+    /// Entradas del lote dentro del dominio de cada función (preparadas fuera del cronómetro).
+    std::vector<float> fastInputs(FastOp op, size_t count) {
+        std::vector<float> values(count);
+        for (size_t i = 0; i < count; ++i) {
+            const float t = (static_cast<float>(i) + 0.5f) / static_cast<float>(count);
+            switch (op) {
+            case FastOp::Sin: values[i] = (t - 0.5f) * 50.0f; break;
+            case FastOp::Exp: values[i] = (t - 0.5f) * 160.0f; break;
+            default: values[i] = std::exp((t - 0.3f) * 20.0f); break;
+            }
+        }
+        return values;
+    }
+
+    template<FastOp Op, Tier T>
+    float fastApply(float x) {
+        switch (Op) {
+        case FastOp::Sin: return EU::FastMath::Sin<T>(x);
+        case FastOp::Exp: return EU::FastMath::Exp<T>(x);
+        case FastOp::Log: return EU::FastMath::Log<T>(x);
+        default: return EU::FastMath::Rsqrt<T>(x);
+        }
+    }
+
+    template<FastOp Op, Tier T>
+    __m128 fastApply(__m128 x) {
+        switch (Op) {
+        case FastOp::Sin: return EU::FastMath::Sin<T>(x);
+        case FastOp::Exp: return EU::FastMath::Exp<T>(x);
+        case FastOp::Log: return EU::FastMath::Log<T>(x);
+        default: return EU::FastMath::Rsqrt<T>(x);
+        }
+    }
+
+    template<FastOp Op, Tier T>
+    EU_TARGET("avx2,fma") __m256 fastApply(__m256 x) {
+        switch (Op) {
+        case FastOp::Sin: return EU::FastMath::Sin<T>(x);
+        case FastOp::Exp: return EU::FastMath::Exp<T>(x);
+        case FastOp::Log: return EU::FastMath::Log<T>(x);
+        default: return EU::FastMath::Rsqrt<T>(x);
+        }
+    }
+
+    template<FastOp Op, Tier T>
+    void fastScalar(Microbench::State& state) {
+        const std::vector<float> in = fastInputs(Op, state.range());
+        std::vector<float> out(state.range());
+        while (state.keepRunning()) {
+            for (size_t i = 0; i < state.range(); ++i) out[i] = fastApply<Op, T>(in[i]);
+            Microbench::doNotOptimize(out[0]);
+        }
+        state.setItemsProcessed(state.iterations() * state.range());
+    }
+
+    template<FastOp Op, Tier T>
+    void fastLoop4(Microbench::State& state, const float* in, float* out) {
+        while (state.keepRunning()) {
+            for (size_t i = 0; i < state.range(); i += 4) {
+                _mm_storeu_ps(out + i, fastApply<Op, T>(_mm_loadu_ps(in + i)));
+            }
+            Microbench::doNotOptimize(out[0]);
+        }
+    }
+
+    template<FastOp Op, Tier T>
+    EU_TARGET("avx2,fma") void fastLoop8(Microbench::State& state, const float* in, float* out) {
+        while (state.keepRunning()) {
+            for (size_t i = 0; i < state.range(); i += 8) {
+                _mm256_storeu_ps(out + i, fastApply<Op, T>(_mm256_loadu_ps(in + i)));
+            }
+            Microbench::doNotOptimize(out[0]);
+        }
+    }
+
+    template<FastOp Op, Tier T>
+    void fastSse(Microbench::State& state) {
+        const std::vector<float> in = fastInputs(Op, state.range());
+        std::vector<float> out(state.range());
+        fastLoop4<Op, T>(state, in.data(), out.data());
+        state.setItemsProcessed(state.iterations() * state.range());
+    }
+
+    /// Sin AVX2 mide la versión de 4 (la fila queda igual que la `_SSE`).
+    template<FastOp Op, Tier T>
+    void fastAvx2(Microbench::State& state) {
+        const std::vector<float> in = fastInputs(Op, state.range());
+        std::vector<float> out(state.range());
+        if (EU::GetSimdLevel() == EU::SimdLevel::AVX2) {
+            fastLoop8<Op, T>(state, in.data(), out.data());
+        } else {
+            fastLoop4<Op, T>(state, in.data(), out.data());
+        }
+        state.setItemsProcessed(state.iterations() * state.range());
+    }
+
+    template<FastOp Op>
+    void fastStd(Microbench::State& state) {
+        const std::vector<float> in = fastInputs(Op, state.range());
+        std::vector<float> out(state.range());
+        while (state.keepRunning()) {
+            for (size_t i = 0; i < state.range(); ++i) {
+                switch (Op) {
+                case FastOp::Sin: out[i] = std::sin(in[i]); break;
+                case FastOp::Exp: out[i] = std::exp(in[i]); break;
+                case FastOp::Log: out[i] = std::log(in[i]); break;
+                default: out[i] = 1.0f / std::sqrt(in[i]); break;
+                }
+            }
+            Microbench::doNotOptimize(out[0]);
+        }
+        state.setItemsProcessed(state.iterations() * state.range());
+    }
+
+    void FastMath_Sin_Precise(Microbench::State& state) { fastScalar<FastOp::Sin, Tier::Precise>(state); }
+    void FastMath_Sin_Fast(Microbench::State& state) { fastScalar<FastOp::Sin, Tier::Fast>(state); }
+    void FastMath_Sin_Precise_SSE(Microbench::State& state) { fastSse<FastOp::Sin, Tier::Precise>(state); }
+    void FastMath_Sin_Fast_SSE(Microbench::State& state) { fastSse<FastOp::Sin, Tier::Fast>(state); }
+    void FastMath_Sin_Precise_AVX2(Microbench::State& state) { fastAvx2<FastOp::Sin, Tier::Precise>(state); }
+    void FastMath_Sin_Fast_AVX2(Microbench::State& state) { fastAvx2<FastOp::Sin, Tier::Fast>(state); }
+    void Std_Sin_Batch(Microbench::State& state) { fastStd<FastOp::Sin>(state); }
+
+    void FastMath_Exp_Precise(Microbench::State& state) { fastScalar<FastOp::Exp, Tier::Precise>(state); }
+    void FastMath_Exp_Fast(Microbench::State& state) { fastScalar<FastOp::Exp, Tier::Fast>(state); }
+    void FastMath_Exp_Precise_SSE(Microbench::State& state) { fastSse<FastOp::Exp, Tier::Precise>(state); }
+    void FastMath_Exp_Fast_SSE(Microbench::State& state) { fastSse<FastOp::Exp, Tier::Fast>(state); }
+    void FastMath_Exp_Precise_AVX2(Microbench::State& state) { fastAvx2<FastOp::Exp, Tier::Precise>(state); }
+    void FastMath_Exp_Fast_AVX2(Microbench::State& state) { fastAvx2<FastOp::Exp, Tier::Fast>(state); }
+    void Std_Exp(Microbench::State& state) { fastStd<FastOp::Exp>(state); }
+
+    void FastMath_Log_Precise(Microbench::State& state) { fastScalar<FastOp::Log, Tier::Precise>(state); }
+    void FastMath_Log_Fast(Microbench::State& state) { fastScalar<FastOp::Log, Tier::Fast>(state); }
+    void FastMath_Log_Precise_SSE(Microbench::State& state) { fastSse<FastOp::Log, Tier::Precise>(state); }
+    void FastMath_Log_Fast_SSE(Microbench::State& state) { fastSse<FastOp::Log, Tier::Fast>(state); }
+    void FastMath_Log_Precise_AVX2(Microbench::State& state) { fastAvx2<FastOp::Log, Tier::Precise>(state); }
+    void FastMath_Log_Fast_AVX2(Microbench::State& state) { fastAvx2<FastOp::Log, Tier::Fast>(state); }
+    void Std_Log(Microbench::State& state) { fastStd<FastOp::Log>(state); }
+
+    void FastMath_Rsqrt_Precise(Microbench::State& state) { fastScalar<FastOp::Rsqrt, Tier::Precise>(state); }
+    void FastMath_Rsqrt_Fast(Microbench::State& state) { fastScalar<FastOp::Rsqrt, Tier::Fast>(state); }
+    void FastMath_Rsqrt_Precise_SSE(Microbench::State& state) { fastSse<FastOp::Rsqrt, Tier::Precise>(state); }
+    void FastMath_Rsqrt_Fast_SSE(Microbench::State& state) { fastSse<FastOp::Rsqrt, Tier::Fast>(state); }
+    void FastMath_Rsqrt_Precise_AVX2(Microbench::State& state) { fastAvx2<FastOp::Rsqrt, Tier::Precise>(state); }
+    void FastMath_Rsqrt_Fast_AVX2(Microbench::State& state) { fastAvx2<FastOp::Rsqrt, Tier::Fast>(state); }
+    void Std_Rsqrt(Microbench::State& state) { fastStd<FastOp::Rsqrt>(state); }
+}
+
+MICROBENCH(EU_Matrix4x4_Multiply, 1024);
+MICROBENCH(EU_Matrix4x4_Multiply_Scalar, 1024);
+MICROBENCH(XM_MatrixMultiply, 1024);
+MICROBENCH(EU_Matrix4x4_Determinant, 1024);
+MICROBENCH(XM_MatrixDeterminant, 1024);
+MICROBENCH(EU_Matrix4x4_Inverse, 1024);
+MICROBENCH(EU_Matrix4x4_Inverse_Scalar, 1024);
+MICROBENCH(XM_MatrixInverse, 1024);
+MICROBENCH(Scalar_TransformCoord, 1024);
+MICROBENCH(EU_Matrix4x4_TransformPoints, 1024);
+MICROBENCH(XM_Vector3TransformCoord, 1024);
+MICROBENCH(XM_Vector3TransformCoordStream, 1024);
+MICROBENCH(EU_Batch_TransformPoints, 1024);
+MICROBENCH(EU_Batch_TransformPoints_Scalar, 1024);
+MICROBENCH(EU_Batch_TransformPoints_Strided, 1024);
+MICROBENCH(EU_Batch_ComputeAABB, 1024);
+MICROBENCH(EU_Batch_ComputeAABB_Strided, 1024);
+MICROBENCH(EU_Batch_TransformAABBs, 1024);
+MICROBENCH(EU_Quaternion_Rotate, 1024);
+MICROBENCH(XM_Vector3Rotate, 1024);
+MICROBENCH(EU_QuatBatch_Normalize, 1024);
+MICROBENCH(EU_QuatBatch_Nlerp, 1024);
+MICROBENCH(EU_QuatBatch_Slerp, 1024);
+MICROBENCH(EU_QuatBatch_Slerp_Scalar, 1024);
+MICROBENCH(XM_QuaternionSlerp, 1024);
+MICROBENCH(EU_QuatBatch_ToMatrices, 1024);
+MICROBENCH(XM_MatrixAffineTransformation, 1024);
+MICROBENCH(EU_Vector3_Normalize, 1024);
+MICROBENCH(XM_Vector3Normalize, 1024);
+MICROBENCH(EU_Sqrt, 1024);
+MICROBENCH(Std_Sqrt, 1024);
+MICROBENCH(EU_Sin, 1024);
+MICROBENCH(Std_Sin, 1024);
+MICROBENCH(FastMath_Sin_Precise, 1024);
+MICROBENCH(FastMath_Sin_Fast, 1024);
+MICROBENCH(FastMath_Sin_Precise_SSE, 1024);
+MICROBENCH(FastMath_Sin_Fast_SSE, 1024);
+MICROBENCH(FastMath_Sin_Precise_AVX2, 1024);
+MICROBENCH(FastMath_Sin_Fast_AVX2, 1024);
+MICROBENCH(Std_Sin_Batch, 1024);
+MICROBENCH(FastMath_Exp_Precise, 1024);
+MICROBENCH(FastMath_Exp_Fast, 1024);
+MICROBENCH(FastMath_Exp_Precise_SSE, 1024);
+MICROBENCH(FastMath_Exp_Fast_SSE, 1024);
+MICROBENCH(FastMath_Exp_Precise_AVX2, 1024);
+MICROBENCH(FastMath_Exp_Fast_AVX2, 1024);
+MICROBENCH(Std_Exp, 1024);
+MICROBENCH(FastMath_Log_Precise, 1024);
+MICROBENCH(FastMath_Log_Fast, 1024);
+MICROBENCH(FastMath_Log_Precise_SSE, 1024);
+MICROBENCH(FastMath_Log_Fast_SSE, 1024);
+MICROBENCH(FastMath_Log_Precise_AVX2, 1024);
+MICROBENCH(FastMath_Log_Fast_AVX2, 1024);
+MICROBENCH(Std_Log, 1024);
+MICROBENCH(FastMath_Rsqrt_Precise, 1024);
+MICROBENCH(FastMath_Rsqrt_Fast, 1024);
+MICROBENCH(FastMath_Rsqrt_Precise_SSE, 1024);
+MICROBENCH(FastMath_Rsqrt_Fast_SSE, 1024);
+MICROBENCH(FastMath_Rsqrt_Precise_AVX2, 1024);
+MICROBENCH(FastMath_Rsqrt_Fast_AVX2, 1024);
+MICROBENCH(Std_Rsqrt, 1024);
@@ -0,0 +1,97 @@
+﻿/**
+ * @file BenchPointers.cpp
+ * @brief `TSharedPointer` frente a `std::shared_ptr`: creación y trasiego de referencias.
+ *
+ * @details
+ * `TSharedPointer` cuenta referencias con un `int` normal y reserva objeto y contador por
+ * separado; `std::shared_ptr` usa operaciones atómicas y `make_shared` una sola reserva.
+ * Estas pruebas miden cuánto pesa cada diferencia.
+ */
+
+#include <iostream>
+#include <memory>
+#include <vector>
+#include "Microbench.h"
+#include "EngineUtilities/Memory/TSharedPointer.h"
+
+namespace {
+    struct Payload {
+        float values[16];
+        Payload() : values() {}
+    };
+
+    // --- Creación (reserva de objeto + contador) ---
+
+    void TSharedPointer_MakeShared(Microbench::State& state) {
+        while (state.keepRunning()) {
+            EU::TSharedPointer<Payload> pointer = EU::MakeShared<Payload>();
+            Microbench::doNotOptimize(pointer.ptr);
+        }
+        state.setItemsProcessed(state.iterations());
+    }
+
+    void StdSharedPtr_MakeShared(Microbench::State& state) {
+        while (state.keepRunning()) {
+            std::shared_ptr<Payload> pointer = std::make_shared<Payload>();
+            Microbench::doNotOptimize(pointer);
+        }
+        state.setItemsProcessed(state.iterations());
+    }
+
+    // --- Copia y destrucción de N referencias al mismo objeto ---
+
+    void TSharedPointer_CopyChurn(Microbench::State& state) {
+        EU::TSharedPointer<Payload> source = EU::MakeShared<Payload>();
+        std::vector<EU::TSharedPointer<Payload>> copies(state.range());
+        while (state.keepRunning()) {
+            for (auto& copy : copies) copy = source;
+            for (auto& copy : copies) copy.reset();
+            Microbench::clobberMemory();
+        }
+        state.setItemsProcessed(state.iterations() * state.range());
+    }
+
+    void StdSharedPtr_CopyChurn(Microbench::State& state) {
+        std::shared_ptr<Payload> source = std::make_shared<Payload>();
+        std::vector<std::shared_ptr<Payload>> copies(state.range());
+        while (state.keepRunning()) {
+            for (auto& copy : copies) copy = source;
+            for (auto& copy : copies) copy.reset();
+            Microbench::clobberMemory();
+        }
+        state.setItemsProcessed(state.iterations() * state.range());
+    }
+
+    // --- Paso por valor (el patrón de getMeshAsset()/getComponent<T>()) ---
+
+    __declspec(noinline) float readByValue(EU::TSharedPointer<Payload> pointer) {
+        return pointer->values[0];
+    }
+
+    __declspec(noinline) float readByValue(std::shared_ptr<Payload> pointer) {
+        return pointer->values[0];
+    }
+
+    void TSharedPointer_PassByValue(Microbench::State& state) {
+        EU::TSharedPointer<Payload> source = EU::MakeShared<Payload>();
+        while (state.keepRunning()) {
+            Microbench::doNotOptimize(readByValue(source));
+        }
+        state.setItemsProcessed(state.iterations());
+    }
+
+    void StdSharedPtr_PassByValue(Microbench::State& state) {
+        std::shared_ptr<Payload> source = std::make_shared<Payload>();
+        while (state.keepRunning()) {
+            Microbench::doNotOptimize(readByValue(source));
+        }
+        state.setItemsProcessed(state.iterations());
+    }
+}
+
+MICROBENCH(TSharedPointer_MakeShared);
+MICROBENCH(StdSharedPtr_MakeShared);
+MICROBENCH(TSharedPointer_CopyChurn, 64, 4096);
+MICROBENCH(StdSharedPtr_CopyChurn, 64, 4096);
+MICROBENCH(TSharedPointer_PassByValue);
+MICROBENCH(StdSharedPtr_PassByValue);
@@ -0,0 +1,196 @@
+﻿/**
+ * @file Microbench.cpp
+ * @brief Registro, calibración de iteraciones e informe de los microbenchmarks.
+ */
+
+#include "Microbench.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <thread>
+
+namespace Microbench {
+    namespace {
+        /// Tope de iteraciones por pasada (cuerpos vacíos no calibran nunca).
+        const uint64_t kMaxIterations = 1000000000ull;
+
+        struct Entry {
+            std::string name;
+            Function function;
+            std::vector<size_t> ranges;
+        };
+
+        /// Resultado de un benchmark con un argumento concreto.
+        struct Result {
+            std::string name;
+            uint64_t iterations;
+            double nsPerIteration;
+            double itemsPerSecond;
+        };
+
+        /// Registro construido en el primer uso (orden de inicialización estática seguro).
+        std::vector<Entry>& registry() {
+            static std::vector<Entry> entries;
+            return entries;
+        }
+
+        /// Ejecuta una pasada de `iterations` iteraciones.
+        State runOnce(const Entry& entry, size_t range, uint64_t iterations) {
+            State state(range, iterations);
+            entry.function(state);
+            return state;
+        }
+
+        std::string jsonString(const std::string& text) {
+            std::string out = "\"";
+            for (char c : text) {
+                if (c == '"' || c == '\\') out += '\\';
+                out += c;
+            }
+            return out + "\"";
+        }
+
+        bool writeJson(const std::string& path, const std::vector<Result>& results,
+            double minTime, unsigned int repetitions) {
+            std::ofstream json(path.c_str(), std::ios::trunc);
+            if (!json) {
+                return false;
+            }
+            char date[32] = {};
+            const std::time_t now = std::time(nullptr);
+            std::tm local = {};
+#if defined(_MSC_VER)
+            localtime_s(&local, &now);
+#else
+            localtime_r(&now, &local);
+#endif
+            std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", &local);
+
+            json << "{\n  \"context\": {\n";
+            json << "    \"date\": " << jsonString(date) << ",\n";
+            json << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n";
+#if defined(NDEBUG)
+            json << "    \"library_build_type\": \"release\",\n";
+#else
+            json << "    \"library_build_type\": \"debug\",\n";
+#endif
+            json << "    \"min_time\": " << minTime << ",\n";
+            json << "    \"repetitions\": " << repetitions << "\n  },\n";
+            json << "  \"benchmarks\": [";
+            for (size_t i = 0; i < results.size(); ++i) {
+                const Result& r = results[i];
+                json << (i ? ",\n" : "\n") << "    { \"name\": " << jsonString(r.name)
+                    << ", \"iterations\": " << r.iterations
+                    << ", \"real_time\": " << r.nsPerIteration
+                    << ", \"cpu_time\": " << r.nsPerIteration
+                    << ", \"time_unit\": \"ns\"";
+                if (r.itemsPerSecond > 0.0) {
+                    json << ", \"items_per_second\": " << r.itemsPerSecond;
+                }
+                json << " }";
+            }
+            json << "\n  ]\n}\n";
+            return true;
+        }
+    }
+
+    void useCharPointer(const volatile char* pointer) {
+        static const volatile char* volatile sink;
+        sink = pointer;
+    }
+
+    int registerBenchmark(const char* name, Function function, std::initializer_list<size_t> ranges) {
+        Entry entry = { name, function, std::vector<size_t>(ranges) };
+        registry().push_back(entry);
+        return 0;
+    }
+
+    int runAll(int argc, char** argv) {
+        std::string filter;
+        std::string jsonPath;
+        double minTime = 0.25;
+        unsigned int repetitions = 3;
+        for (int i = 1; i + 1 < argc; ++i) {
+            if (std::strcmp(argv[i], "--filter") == 0) filter = argv[++i];
+            else if (std::strcmp(argv[i], "--min-time") == 0) minTime = std::atof(argv[++i]);
+            else if (std::strcmp(argv[i], "--repetitions") == 0) repetitions = (std::max)(1, std::atoi(argv[++i]));
+            else if (std::strcmp(argv[i], "--json") == 0) jsonPath = argv[++i];
+        }
+
+#if !defined(NDEBUG)
+        std::printf("***WARNING*** Debug build: timings are not representative.\n");
+#endif
+        std::printf("%-44s %14s %14s %12s\n", "Benchmark", "Time (ns)", "Items/s", "Iterations");
+        std::printf("%s\n", std::string(87, '-').c_str());
+
+        std::vector<Result> results;
+        for (const Entry& entry : registry()) {
+            std::vector<size_t> ranges = entry.ranges;
+            if (ranges.empty()) {
+                ranges.push_back(0);
+            }
+            for (size_t range : ranges) {
+                const std::string name = entry.ranges.empty()
+                    ? entry.name : entry.name + "/" + std::to_string(range);
+                if (!filter.empty() && name.find(filter) == std::string::npos) {
+                    continue;
+                }
+
+                // 1) Calibrar: crecer hasta que una pasada dure `minTime`.
+                uint64_t iterations = 1;
+                for (;;) {
+                    const State state = runOnce(entry, range, iterations);
+                    const double seconds = state.elapsedSeconds();
+                    if (seconds >= minTime || iterations >= kMaxIterations) {
+                        break;
+                    }
+                    const double predicted = seconds > 0.0
+                        ? iterations * minTime * 1.4 / seconds
+                        : iterations * 10.0;
+                    iterations = (std::min)(kMaxIterations,
+                        (std::max)(iterations + 1, static_cast<uint64_t>((std::min)(predicted, iterations * 10.0))));
+                }
+
+                // 2) Medir `repetitions` veces y quedarse con la mediana.
+                std::vector<double> nsPerIteration;
+                std::vector<double> itemsPerSecond;
+                for (unsigned int r = 0; r < repetitions; ++r) {
+                    const State state = runOnce(entry, range, iterations);
+                    const double seconds = state.elapsedSeconds();
+                    nsPerIteration.push_back(seconds * 1e9 / iterations);
+                    itemsPerSecond.push_back(seconds > 0.0 ? state.itemsProcessed() / seconds : 0.0);
+                }
+                std::sort(nsPerIteration.begin(), nsPerIteration.end());
+                std::sort(itemsPerSecond.begin(), itemsPerSecond.end());
+                const Result result = { name, iterations,
+                    nsPerIteration[nsPerIteration.size() / 2], itemsPerSecond[itemsPerSecond.size() / 2] };
+                results.push_back(result);
+
+                if (result.itemsPerSecond > 0.0) {
+                    std::printf("%-44s %14.2f %14.4g %12llu\n", name.c_str(), result.nsPerIteration,
+                        result.itemsPerSecond, static_cast<unsigned long long>(iterations));
+                }
+                else {
+                    std::printf("%-44s %14.2f %14s %12llu\n", name.c_str(), result.nsPerIteration,
+                        "-", static_cast<unsigned long long>(iterations));
+                }
+            }
+        }
+
+        if (!jsonPath.empty()) {
+            if (!writeJson(jsonPath, results, minTime, repetitions)) {
+                std::fprintf(stderr, "Cannot write %s\n", jsonPath.c_str());
+                return 1;
+            }
+            std::printf("Results written to %s\n", jsonPath.c_str());
+        }
+        return 0;
+    }
+}
+
+int main(int argc, char** argv) {
+    return Microbench::runAll(argc, argv);
+}
@@ -0,0 +1,142 @@
+﻿/**
+ * @file Microbench.h
+ * @brief Harness mínimo de microbenchmarks al estilo de Google Benchmark.
+ *
+ * @details
+ * Cada benchmark es una función `void(State&)` registrada con @ref MICROBENCH; el
+ * cuerpo a medir va dentro de `while (state.keepRunning())`:
+ *
+ * @code
+ * static void vectorPushBack(Microbench::State& state) {
+ *     while (state.keepRunning()) {
+ *         std::vector<int> v;
+ *         for (size_t i = 0; i < state.range(); ++i) v.push_back((int)i);
+ *         Microbench::doNotOptimize(v.data());
+ *     }
+ *     state.setItemsProcessed(state.iterations() * state.range());
+ * }
+ * MICROBENCH(vectorPushBack, 64, 1024, 8192);
+ * @endcode
+ *
+ * El runner (@ref runAll) aumenta las iteraciones hasta que una pasada dura al menos
+ * `--min-time` segundos, repite la medición `--repetitions` veces y se queda con la
+ * mediana. Resultados en consola y, con `--json archivo`, en el mismo formato JSON que
+ * Google Benchmark (`benchmarks[].name/real_time/items_per_second`), para poder
+ * comparar ejecuciones con las herramientas de siempre.
+ *
+ * @note Para estudiantes: `doNotOptimize` evita que el compilador descubra que el
+ * resultado no se usa y borre el trabajo; sin él, muchos benchmarks miden 0 ns.
+ */
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+namespace Microbench {
+
+    /**
+     * @class State
+     * @brief Estado de una pasada: iteraciones pendientes, cronómetro y contadores.
+     */
+    class State {
+    public:
+        /**
+         * @param range Argumento del benchmark (p. ej. número de elementos).
+         * @param iterations Veces que se ejecuta el cuerpo en esta pasada.
+         */
+        State(size_t range, uint64_t iterations)
+            : m_range(range), m_iterations(iterations), m_remaining(iterations) {}
+
+        /**
+         * @brief Condición del bucle medido: arranca el cronómetro en la primera
+         * llamada y lo para cuando se agotan las iteraciones.
+         */
+        bool keepRunning() {
+            if (m_remaining == m_iterations && !m_running) {
+                resumeTiming();
+            }
+            if (m_remaining == 0) {
+                pauseTiming();
+                return false;
+            }
+            --m_remaining;
+            return true;
+        }
+
+        /** @brief Detiene el cronómetro (preparación que no debe contar). */
+        void pauseTiming() {
+            if (m_running) {
+                m_elapsed += std::chrono::steady_clock::now() - m_start;
+                m_running = false;
+            }
+        }
+
+        /** @brief Reanuda el cronómetro tras @ref pauseTiming. */
+        void resumeTiming() {
+            if (!m_running) {
+                m_start = std::chrono::steady_clock::now();
+                m_running = true;
+            }
+        }
+
+        /** @brief Elementos procesados en toda la pasada (para elementos/s). */
+        void setItemsProcessed(uint64_t items) { m_items = items; }
+
+        size_t range() const { return m_range; }
+        uint64_t iterations() const { return m_iterations; }
+        uint64_t itemsProcessed() const { return m_items; }
+        double elapsedSeconds() const { return std::chrono::duration<double>(m_elapsed).count(); }
+
+    private:
+        size_t m_range;
+        uint64_t m_iterations;
+        uint64_t m_remaining;
+        uint64_t m_items = 0;
+        bool m_running = false;
+        std::chrono::steady_clock::time_point m_start;
+        std::chrono::steady_clock::duration m_elapsed = std::chrono::steady_clock::duration::zero();
+    };
+
+    typedef void (*Function)(State&);
+
+    /**
+     * @brief Registra un benchmark (lo usa @ref MICROBENCH antes de `main`).
+     * @param name Nombre mostrado; con argumentos se muestra como `name/arg`.
+     * @param function Cuerpo del benchmark.
+     * @param ranges Argumentos; vacío = una sola ejecución con `range() == 0`.
+     * @return Siempre 0 (permite registrar en un inicializador estático).
+     */
+    int registerBenchmark(const char* name, Function function, std::initializer_list<size_t> ranges);
+
+    /** @brief Consume un puntero en otra unidad de traducción (el optimizador no lo ve). */
+    void useCharPointer(const volatile char* pointer);
+
+    /** @brief Obliga a materializar `value` en memoria y a no eliminar su cálculo. */
+    template<typename T>
+    inline void doNotOptimize(const T& value) {
+        useCharPointer(&reinterpret_cast<const volatile char&>(value));
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+    }
+
+    /** @brief Barrera del compilador: las escrituras previas no se pueden descartar. */
+    inline void clobberMemory() {
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+    }
+
+    /**
+     * @brief Ejecuta los benchmarks registrados.
+     * @param argc Argumentos de `main`.
+     * @param argv `--filter texto`, `--min-time s`, `--repetitions n`, `--json archivo`.
+     * @return 0, o 1 si el JSON no se pudo escribir.
+     */
+    int runAll(int argc, char** argv);
+}
+
+/// Registra `function` con los argumentos opcionales indicados.
+#define MICROBENCH(function, ...) \
+    static const int function##_registered = Microbench::registerBenchmark(#function, function, { __VA_ARGS__ })
@@ -0,0 +1,205 @@
+﻿/**
+ * @file Json.cpp
+ * @brief Analizador descendente recursivo del lector JSON.
+ */
+
+#include "Json.h"
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace Json {
+    namespace {
+        struct Parser {
+            const char* cursor;
+            const char* begin;
+            std::string error;
+
+            void skipSpace() {
+                while (*cursor == ' ' || *cursor == '\t' || *cursor == '\n' || *cursor == '\r') ++cursor;
+            }
+
+            bool fail(const char* reason) {
+                if (error.empty()) {
+                    error = std::string(reason) + " at offset " + std::to_string(cursor - begin);
+                }
+                return false;
+            }
+
+            bool literal(const char* word) {
+                const size_t length = std::strlen(word);
+                if (std::strncmp(cursor, word, length) != 0) {
+                    return fail("unexpected token");
+                }
+                cursor += length;
+                return true;
+            }
+
+            bool parseString(std::string& out) {
+                ++cursor;  // '"'
+                while (*cursor && *cursor != '"') {
+                    if (*cursor == '\\') {
+                        ++cursor;
+                        switch (*cursor) {
+                        case 'n': out += '\n'; break;
+                        case 't': out += '\t'; break;
+                        case 'r': out += '\r'; break;
+                        case 'b': out += '\b'; break;
+                        case 'f': out += '\f'; break;
+                        case 'u':
+                            // Los informes solo escriben ASCII: \uXXXX se guarda como '?'.
+                            for (int i = 0; i < 4 && cursor[1]; ++i) ++cursor;
+                            out += '?';
+                            break;
+                        case '\0': return fail("unterminated string");
+                        default: out += *cursor; break;
+                        }
+                        ++cursor;
+                    }
+                    else {
+                        out += *cursor++;
+                    }
+                }
+                if (*cursor != '"') {
+                    return fail("unterminated string");
+                }
+                ++cursor;
+                return true;
+            }
+
+            bool parseValue(Value& out) {
+                skipSpace();
+                switch (*cursor) {
+                case '{': {
+                    out.type = Value::Object;
+                    ++cursor;
+                    skipSpace();
+                    if (*cursor == '}') {
+                        ++cursor;
+                        return true;
+                    }
+                    for (;;) {
+                        skipSpace();
+                        if (*cursor != '"') {
+                            return fail("expected key");
+                        }
+                        std::pair<std::string, Value> member;
+                        if (!parseString(member.first)) {
+                            return false;
+                        }
+                        skipSpace();
+                        if (*cursor != ':') {
+                            return fail("expected ':'");
+                        }
+                        ++cursor;
+                        if (!parseValue(member.second)) {
+                            return false;
+                        }
+                        out.members.push_back(member);
+                        skipSpace();
+                        if (*cursor == ',') {
+                            ++cursor;
+                        }
+                        else if (*cursor == '}') {
+                            ++cursor;
+                            return true;
+                        }
+                        else {
+                            return fail("expected ',' or '}'");
+                        }
+                    }
+                }
+                case '[': {
+                    out.type = Value::Array;
+                    ++cursor;
+                    skipSpace();
+                    if (*cursor == ']') {
+                        ++cursor;
+                        return true;
+                    }
+                    for (;;) {
+                        out.items.push_back(Value());
+                        if (!parseValue(out.items.back())) {
+                            return false;
+                        }
+                        skipSpace();
+                        if (*cursor == ',') {
+                            ++cursor;
+                        }
+                        else if (*cursor == ']') {
+                            ++cursor;
+                            return true;
+                        }
+                        else {
+                            return fail("expected ',' or ']'");
+                        }
+                    }
+                }
+                case '"':
+                    out.type = Value::String;
+                    return parseString(out.text);
+                case 't':
+                    out.type = Value::Bool;
+                    out.boolean = true;
+                    return literal("true");
+                case 'f':
+                    out.type = Value::Bool;
+                    return literal("false");
+                case 'n':
+                    return literal("null");
+                default: {
+                    char* end = nullptr;
+                    out.number = std::strtod(cursor, &end);
+                    if (end == cursor) {
+                        return fail("unexpected character");
+                    }
+                    out.type = Value::Number;
+                    cursor = end;
+                    return true;
+                }
+                }
+            }
+        };
+    }
+
+    const Value& Value::operator[](const char* key) const {
+        static const Value null;
+        for (const auto& member : members) {
+            if (member.first == key) {
+                return member.second;
+            }
+        }
+        return null;
+    }
+
+    bool parse(const std::string& text, Value& out, std::string& error) {
+        Parser parser = { text.c_str(), text.c_str(), std::string() };
+        out = Value();
+        if (!parser.parseValue(out)) {
+            error = parser.error;
+            return false;
+        }
+        parser.skipSpace();
+        if (*parser.cursor != '\0') {
+            error = "trailing characters at offset " + std::to_string(parser.cursor - parser.begin);
+            return false;
+        }
+        return true;
+    }
+
+    bool parseFile(const std::string& path, Value& out, std::string& error) {
+        std::ifstream file(path.c_str(), std::ios::binary);
+        if (!file) {
+            error = "cannot open " + path;
+            return false;
+        }
+        std::ostringstream content;
+        content << file.rdbuf();
+        if (!parse(content.str(), out, error)) {
+            error = path + ": " + error;
+            return false;
+        }
+        return true;
+    }
+}
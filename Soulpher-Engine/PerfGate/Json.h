@@ -0,0 +1,59 @@
+﻿/**
+ * @file Json.h
+ * @brief Lector JSON mínimo para los informes de benchmark y microbenchmark.
+ *
+ * @details
+ * Solo lectura y solo lo que escriben `Benchmark::writeReport` y `Microbench --json`:
+ * objetos, arrays, números, cadenas (escapes simples), `true`/`false`/`null`.
+ * Los objetos conservan el orden de las claves, así el informe del gate sale en el
+ * mismo orden que el archivo.
+ */
+
+#pragma once
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Json {
+
+    /**
+     * @class Value
+     * @brief Nodo del documento; un `Value` por defecto es `null`.
+     */
+    class Value {
+    public:
+        enum Type { Null, Bool, Number, String, Array, Object };
+
+        Type type = Null;
+        bool boolean = false;
+        double number = 0.0;
+        std::string text;
+        std::vector<Value> items;                            ///< Elementos de un array.
+        std::vector<std::pair<std::string, Value>> members;  ///< Claves de un objeto, en orden.
+
+        /**
+         * @brief Miembro `key` de un objeto.
+         * @return El miembro, o un `null` compartido si no existe o esto no es un objeto.
+         */
+        const Value& operator[](const char* key) const;
+
+        bool isNumber() const { return type == Number; }
+        bool isArray() const { return type == Array; }
+        bool isObject() const { return type == Object; }
+    };
+
+    /**
+     * @brief Interpreta `text` como un documento JSON.
+     * @param text Contenido completo.
+     * @param out Recibe la raíz.
+     * @param error Recibe la posición y el motivo si falla.
+     * @return `true` si el documento es válido.
+     */
+    bool parse(const std::string& text, Value& out, std::string& error);
+
+    /**
+     * @brief Lee y analiza un archivo.
+     * @return `false` si no se pudo abrir o no es JSON válido (motivo en `error`).
+     */
+    bool parseFile(const std::string& path, Value& out, std::string& error);
+}
@@ -0,0 +1,449 @@
+﻿/**
+ * @file PerfGate.cpp
+ * @brief Puerta de regresiones de rendimiento: ejecuta las pruebas fijas y compara con
+ * la línea base de esta máquina.
+ *
+ * @details
+ * Se lanza desde `bin/` (el mismo directorio de trabajo que el motor):
+ *
+ *     x64\PerfGate.exe [--tolerance 5] [--floor-ms 0.05] [--update-baseline] ...
+ *
+ * 1. Lee el manifiesto (`perf/gate.txt`): una prueba por línea,
+ *    `scene|micro <nombre> <tolerancia%|-> <argumentos...>`.
+ *    - `scene`: ejecuta el motor con esos argumentos (un `--benchmark`, con o sin
+ *      `-stress`) más `-benchmarkout perf/results/<nombre>`.
+ *    - `micro`: ejecuta `Microbench` con esos argumentos más `--json perf/results/<nombre>.json`.
+ * 2. Extrae las métricas de cada informe (todas "menor es mejor"):
+ *    - escenas: `frame.average/p50/p95/p99` y `gpu/<pase>` (ms). `max` no se compara:
+ *      un solo frame lento (el SO, el antivirus) bastaría para tumbar la puerta.
+ *    - microbenchmarks: `<benchmark>` = `real_time` (ns por iteración).
+ * 3. Compara con `perf/baselines/<MÁQUINA>/<informe>.json`. Una métrica regresa si
+ *    empeora más de la tolerancia **y**, en las de milisegundos, más de `--floor-ms`
+ *    en absoluto (un pase de 0,02 ms que pasa a 0,03 es +50% y ruido).
+ * 4. Escribe `perf/results/gate_report.md` (tabla con base, actual y diferencia) y
+ *    resume en consola.
+ *
+ * Código de salida: 0 sin regresiones, 1 con regresiones, 2 si algo no se pudo
+ * ejecutar o falta la línea base. `--update-baseline` copia los informes actuales
+ * como nueva línea base (y sale con 0): se hace a propósito, en una máquina conocida,
+ * y se sube al repositorio junto con el cambio que la justifica.
+ *
+ * @note Para estudiantes: la línea base es **por máquina** porque comparar los ms de un
+ * portátil con los de un equipo de sobremesa no dice nada del código.
+ */
+
+#include <windows.h>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "Json.h"
+
+namespace {
+    /// Cómo se ejecuta y se lee una prueba del manifiesto.
+    enum TestKind { SceneTest, MicroTest };
+
+    /// Una línea del manifiesto.
+    struct Test {
+        TestKind kind;
+        std::string name;
+        double tolerancePct;   ///< < 0 = la global (`--tolerance`).
+        std::string arguments;
+    };
+
+    /// Un valor medido (menor es mejor).
+    struct Metric {
+        std::string name;
+        double value;
+        bool milliseconds;     ///< Aplica `--floor-ms`.
+    };
+
+    enum Status { Pass, Regressed, Improved, Added, Removed };
+
+    /// Una fila del informe de diferencias.
+    struct Row {
+        std::string report;
+        std::string metric;
+        double baseline;
+        double current;
+        double deltaPct;
+        Status status;
+    };
+
+    struct Options {
+        std::string manifest = "perf/gate.txt";
+        std::string baselineRoot = "perf/baselines";
+        std::string resultsDir = "perf/results";
+        std::string machine;
+        std::string engine;
+        std::string microbench;
+        std::string filter;
+        double tolerancePct = 5.0;
+        double floorMs = 0.05;
+        unsigned int timeoutSeconds = 900;
+        bool updateBaseline = false;
+    };
+
+    const char* statusName(Status status) {
+        switch (status) {
+        case Regressed: return "REGRESSED";
+        case Improved: return "improved";
+        case Added: return "new";
+        case Removed: return "missing";
+        default: return "ok";
+        }
+    }
+
+    /// Directorio del ejecutable actual, con '\' final (los ejecutables van juntos en bin/<plataforma>).
+    std::string executableDir() {
+        char path[MAX_PATH] = {};
+        GetModuleFileNameA(nullptr, path, MAX_PATH);
+        std::string dir(path);
+        const size_t slash = dir.find_last_of("\\/");
+        return slash == std::string::npos ? std::string() : dir.substr(0, slash + 1);
+    }
+
+    /// Nombre del equipo, apto para nombre de carpeta.
+    std::string machineName() {
+        char name[MAX_COMPUTERNAME_LENGTH + 1] = {};
+        DWORD size = sizeof(name);
+        if (!GetComputerNameA(name, &size)) {
+            return "unknown";
+        }
+        std::string out(name, size);
+        for (char& c : out) {
+            if (!isalnum(static_cast<unsigned char>(c)) && c != '-' && c != '_') c = '_';
+        }
+        return out;
+    }
+
+    /// Crea `path` y los directorios intermedios que falten.
+    void makeDirectories(const std::string& path) {
+        for (size_t i = 1; i <= path.size(); ++i) {
+            if (i == path.size() || path[i] == '/' || path[i] == '\\') {
+                CreateDirectoryA(path.substr(0, i).c_str(), nullptr);
+            }
+        }
+    }
+
+    bool loadManifest(const std::string& path, std::vector<Test>& tests) {
+        std::ifstream file(path.c_str());
+        if (!file) {
+            std::fprintf(stderr, "Cannot open manifest %s\n", path.c_str());
+            return false;
+        }
+        std::string line;
+        unsigned int number = 0;
+        while (std::getline(file, line)) {
+            ++number;
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            if (number == 1 && line.compare(0, 3, "\xEF\xBB\xBF") == 0) {
+                line.erase(0, 3);  // BOM que añaden algunos editores de Windows
+            }
+            std::istringstream fields(line);
+            std::string kind, name, tolerance;
+            if (!(fields >> kind) || kind[0] == '#') {
+                continue;
+            }
+            if (!(fields >> name >> tolerance) || (kind != "scene" && kind != "micro")) {
+                std::fprintf(stderr, "%s:%u: expected 'scene|micro <name> <tolerance|-> <args...>'\n",
+                    path.c_str(), number);
+                return false;
+            }
+            std::string arguments;
+            std::getline(fields, arguments);
+            Test test = { kind == "scene" ? SceneTest : MicroTest, name,
+                tolerance == "-" ? -1.0 : std::atof(tolerance.c_str()), arguments };
+            tests.push_back(test);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Ejecuta `commandLine` y espera a que termine.
+     * @return `true` si arrancó y terminó dentro del plazo (el código de salida va en `exitCode`).
+     */
+    bool runProcess(const std::string& commandLine, unsigned int timeoutSeconds, DWORD& exitCode) {
+        STARTUPINFOA startup = {};
+        startup.cb = sizeof(startup);
+        PROCESS_INFORMATION process = {};
+        std::vector<char> mutableLine(commandLine.begin(), commandLine.end());
+        mutableLine.push_back('\0');
+        if (!CreateProcessA(nullptr, mutableLine.data(), nullptr, nullptr, FALSE, 0, nullptr, nullptr,
+            &startup, &process)) {
+            std::fprintf(stderr, "Cannot start: %s (error %lu)\n", commandLine.c_str(), GetLastError());
+            return false;
+        }
+        const bool finished = WaitForSingleObject(process.hProcess, timeoutSeconds * 1000) == WAIT_OBJECT_0;
+        if (!finished) {
+            std::fprintf(stderr, "Timed out after %u s: %s\n", timeoutSeconds, commandLine.c_str());
+            TerminateProcess(process.hProcess, 1);
+        }
+        GetExitCodeProcess(process.hProcess, &exitCode);
+        CloseHandle(process.hThread);
+        CloseHandle(process.hProcess);
+        return finished;
+    }
+
+    /**
+     * @brief Informes JSON de una prueba en `dir`: `<nombre>.json` y, para barridos
+     * `-stress`, `<nombre>_<N>.json` (sin extensión, ordenados).
+     */
+    std::vector<std::string> findReports(const std::string& dir, const std::string& name) {
+        std::vector<std::string> stems;
+        WIN32_FIND_DATAA found;
+        HANDLE search = FindFirstFileA((dir + "/" + name + "*.json").c_str(), &found);
+        if (search == INVALID_HANDLE_VALUE) {
+            return stems;
+        }
+        do {
+            std::string stem(found.cFileName);
+            stem.resize(stem.size() - 5);  // ".json"
+            const std::string rest = stem.substr(name.size());
+            const bool sweepPoint = rest.size() > 1 && rest[0] == '_' &&
+                rest.find_first_not_of("0123456789", 1) == std::string::npos;
+            if (rest.empty() || sweepPoint) {
+                stems.push_back(stem);
+            }
+        } while (FindNextFileA(search, &found));
+        FindClose(search);
+        std::sort(stems.begin(), stems.end());
+        return stems;
+    }
+
+    void extractMetrics(TestKind kind, const Json::Value& root, std::vector<Metric>& metrics) {
+        if (kind == SceneTest) {
+            const Json::Value& frame = root["frameTimeMs"];
+            const char* keys[] = { "average", "p50", "p95", "p99" };
+            for (const char* key : keys) {
+                if (frame[key].isNumber()) {
+                    Metric metric = { std::string("frame.") + key, frame[key].number, true };
+                    metrics.push_back(metric);
+                }
+            }
+            for (const Json::Value& pass : root["gpuPassesMs"].items) {
+                std::string name = "gpu/" + pass["name"].text;
+                // El mismo pase puede aparecer a varias profundidades.
+                unsigned int repeat = 1;
+                for (const Metric& existing : metrics) {
+                    if (existing.name == name || existing.name.compare(0, name.size() + 1, name + "#") == 0) ++repeat;
+                }
+                if (repeat > 1) {
+                    name += "#" + std::to_string(repeat);
+                }
+                Metric metric = { name, pass["average"].number, true };
+                metrics.push_back(metric);
+            }
+        }
+        else {
+            for (const Json::Value& benchmark : root["benchmarks"].items) {
+                if (benchmark["real_time"].isNumber()) {
+                    Metric metric = { benchmark["name"].text, benchmark["real_time"].number, false };
+                    metrics.push_back(metric);
+                }
+            }
+        }
+    }
+
+    /// Compara un informe con su línea base y añade sus filas.
+    void compare(const std::string& report, const std::vector<Metric>& baseline,
+        const std::vector<Metric>& current, double tolerancePct, double floorMs, std::vector<Row>& rows) {
+        for (const Metric& now : current) {
+            auto base = std::find_if(baseline.begin(), baseline.end(),
+                [&now](const Metric& m) { return m.name == now.name; });
+            Row row = { report, now.name, 0.0, now.value, 0.0, Added };
+            if (base != baseline.end()) {
+                row.baseline = base->value;
+                row.deltaPct = base->value > 0.0 ? (now.value - base->value) * 100.0 / base->value : 0.0;
+                const double delta = now.value - base->value;
+                const bool aboveFloor = !now.milliseconds || std::fabs(delta) > floorMs;
+                row.status = Pass;
+                if (aboveFloor && row.deltaPct > tolerancePct) row.status = Regressed;
+                else if (aboveFloor && row.deltaPct < -tolerancePct) row.status = Improved;
+            }
+            rows.push_back(row);
+        }
+        for (const Metric& base : baseline) {
+            auto now = std::find_if(current.begin(), current.end(),
+                [&base](const Metric& m) { return m.name == base.name; });
+            if (now == current.end()) {
+                Row row = { report, base.name, base.value, 0.0, 0.0, Removed };
+                rows.push_back(row);
+            }
+        }
+    }
+
+    bool writeMarkdown(const std::string& path, const Options& options, const std::vector<Row>& rows,
+        const std::vector<std::string>& errors, unsigned int regressions) {
+        std::ofstream md(path.c_str(), std::ios::trunc);
+        if (!md) {
+            return false;
+        }
+        md << "# Performance gate: " << (regressions || !errors.empty() ? "FAIL" : "PASS") << "\n\n";
+        md << "Machine `" << options.machine << "`, tolerance " << options.tolerancePct
+           << "% (ms metrics also need > " << options.floorMs << " ms).\n\n";
+        for (const std::string& error : errors) {
+            md << "- **error:** " << error << "\n";
+        }
+        if (!errors.empty()) {
+            md << "\n";
+        }
+        // Primero lo que importa: regresiones, luego el resto en orden del informe.
+        std::vector<const Row*> ordered;
+        for (const Row& row : rows) if (row.status == Regressed) ordered.push_back(&row);
+        for (const Row& row : rows) if (row.status != Regressed) ordered.push_back(&row);
+
+        md << "| Report | Metric | Baseline | Current | Delta | Status |\n";
+        md << "|---|---|---:|---:|---:|---|\n";
+        char line[512];
+        for (const Row* row : ordered) {
+            std::snprintf(line, sizeof(line), "| %s | %s | %.4g | %.4g | %+.1f%% | %s |\n",
+                row->report.c_str(), row->metric.c_str(), row->baseline, row->current, row->deltaPct,
+                row->status == Regressed ? "**REGRESSED**" : statusName(row->status));
+            md << line;
+        }
+        return true;
+    }
+
+    void parseArguments(int argc, char** argv, Options& options) {
+        for (int i = 1; i < argc; ++i) {
+            const bool hasValue = i + 1 < argc;
+            if (std::strcmp(argv[i], "--update-baseline") == 0) options.updateBaseline = true;
+            else if (!hasValue) break;
+            else if (std::strcmp(argv[i], "--manifest") == 0) options.manifest = argv[++i];
+            else if (std::strcmp(argv[i], "--baselines") == 0) options.baselineRoot = argv[++i];
+            else if (std::strcmp(argv[i], "--results") == 0) options.resultsDir = argv[++i];
+            else if (std::strcmp(argv[i], "--machine") == 0) options.machine = argv[++i];
+            else if (std::strcmp(argv[i], "--engine") == 0) options.engine = argv[++i];
+            else if (std::strcmp(argv[i], "--microbench") == 0) options.microbench = argv[++i];
+            else if (std::strcmp(argv[i], "--filter") == 0) options.filter = argv[++i];
+            else if (std::strcmp(argv[i], "--tolerance") == 0) options.tolerancePct = std::atof(argv[++i]);
+            else if (std::strcmp(argv[i], "--floor-ms") == 0) options.floorMs = std::atof(argv[++i]);
+            else if (std::strcmp(argv[i], "--timeout") == 0) options.timeoutSeconds = std::atoi(argv[++i]);
+        }
+#if defined(NDEBUG)
+        const char* suffix = ".exe";
+#else
+        const char* suffix = "_d.exe";
+#endif
+        if (options.engine.empty()) options.engine = executableDir() + "Soulpher-Engine" + suffix;
+        if (options.microbench.empty()) options.microbench = executableDir() + "Microbench" + suffix;
+        if (options.machine.empty()) options.machine = machineName();
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    parseArguments(argc, argv, options);
+
+    std::vector<Test> tests;
+    if (!loadManifest(options.manifest, tests)) {
+        return 2;
+    }
+    const std::string baselineDir = options.baselineRoot + "/" + options.machine;
+    makeDirectories(options.resultsDir);
+    if (options.updateBaseline) {
+        makeDirectories(baselineDir);
+    }
+
+    std::vector<Row> rows;
+    std::vector<std::string> errors;
+    for (const Test& test : tests) {
+        if (!options.filter.empty() && test.name.find(options.filter) == std::string::npos) {
+            continue;
+        }
+        // Informes viejos fuera: si la ejecución falla no se compara un resultado anterior.
+        const std::string output = options.resultsDir + "/" + test.name;
+        for (const std::string& stale : findReports(options.resultsDir, test.name)) {
+            DeleteFileA((options.resultsDir + "/" + stale + ".json").c_str());
+        }
+
+        const std::string commandLine = test.kind == SceneTest
+            ? "\"" + options.engine + "\" " + test.arguments + " -benchmarkout \"" + output + "\""
+            : "\"" + options.microbench + "\" " + test.arguments + " --json \"" + output + ".json\"";
+        std::printf("[%s] %s\n", test.name.c_str(), commandLine.c_str());
+        DWORD exitCode = 0;
+        if (!runProcess(commandLine, options.timeoutSeconds, exitCode) || exitCode != 0) {
+            errors.push_back(test.name + ": run failed (exit code " + std::to_string(exitCode) + ")");
+            continue;
+        }
+
+        const std::vector<std::string> reports = findReports(options.resultsDir, test.name);
+        if (reports.empty()) {
+            errors.push_back(test.name + ": no report written to " + options.resultsDir);
+            continue;
+        }
+        for (const std::string& report : reports) {
+            const std::string currentPath = options.resultsDir + "/" + report + ".json";
+            const std::string baselinePath = baselineDir + "/" + report + ".json";
+            if (options.updateBaseline) {
+                if (!CopyFileA(currentPath.c_str(), baselinePath.c_str(), FALSE)) {
+                    errors.push_back(report + ": cannot write " + baselinePath);
+                }
+                else {
+                    std::printf("  baseline updated: %s\n", baselinePath.c_str());
+                }
+                continue;
+            }
+
+            std::string error;
+            Json::Value currentJson, baselineJson;
+            if (!Json::parseFile(currentPath, currentJson, error)) {
+                errors.push_back(error);
+                continue;
+            }
+            if (GetFileAttributesA(baselinePath.c_str()) == INVALID_FILE_ATTRIBUTES) {
+                errors.push_back(report + ": no baseline for machine " + options.machine +
+                    " (run with --update-baseline)");
+                continue;
+            }
+            if (!Json::parseFile(baselinePath, baselineJson, error)) {
+                errors.push_back(error);
+                continue;
+            }
+            std::vector<Metric> current, baseline;
+            extractMetrics(test.kind, currentJson, current);
+            extractMetrics(test.kind, baselineJson, baseline);
+            compare(report, baseline, current,
+                test.tolerancePct >= 0.0 ? test.tolerancePct : options.tolerancePct, options.floorMs, rows);
+        }
+    }
+
+    if (options.updateBaseline) {
+        std::printf("Baselines for %s written to %s\n", options.machine.c_str(), baselineDir.c_str());
+        return errors.empty() ? 0 : 2;
+    }
+
+    unsigned int regressions = 0;
+    for (const Row& row : rows) {
+        if (row.status != Regressed) {
+            continue;
+        }
+        ++regressions;
+        std::printf("  REGRESSED %-24s %-36s %10.4g -> %10.4g (%+.1f%%)\n", row.report.c_str(),
+            row.metric.c_str(), row.baseline, row.current, row.deltaPct);
+    }
+    for (const std::string& error : errors) {
+        std::fprintf(stderr, "  error: %s\n", error.c_str());
+    }
+
+    const std::string reportPath = options.resultsDir + "/gate_report.md";
+    if (writeMarkdown(reportPath, options, rows, errors, regressions)) {
+        std::printf("Diff report: %s\n", reportPath.c_str());
+    }
+    std::printf("PERF GATE %s: %u metrics, %u regressions, %u errors\n",
+        regressions || !errors.empty() ? "FAIL" : "PASS",
+        static_cast<unsigned int>(rows.size()), regressions, static_cast<unsigned int>(errors.size()));
+    if (!errors.empty()) {
+        return 2;
+    }
+    return regressions ? 1 : 0;
+}
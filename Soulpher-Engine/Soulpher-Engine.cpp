@@ -66,6 +66,9 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCmdLi
  * Recibe y procesa todos los mensajes enviados a la ventana:
  *  - Eventos de teclado y ratón.
  *  - Redibujado (`WM_PAINT`).
+ *  - Redimensionado (`WM_SIZE`): se reenvía a `BaseApp::resize`.
+ *  - F11 (`WM_KEYDOWN`): modo jugador (`BaseApp::togglePlayerMode`).
+ *  - Raw input (`WM_INPUT`) y pérdida de foco: a `BaseApp::onRawInput` / `onFocusLost`.
  *  - Cierre de ventana (`WM_DESTROY`).
  *
  * @note
@@ -95,6 +98,46 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
         PostQuitMessage(0); // Notifica al bucle principal que debe cerrar
         return 0;
 
+    case WM_SIZE:
+    {
+        // La app se guardó en GWLP_USERDATA en BaseApp::run; antes de eso no hay nada que ajustar.
+        BaseApp* app = reinterpret_cast<BaseApp*>(GetWindowLongPtr(hWnd, GWLP_USERDATA));
+        if (app && wParam != SIZE_MINIMIZED) {
+            app->resize(LOWORD(lParam), HIWORD(lParam));
+        }
+        return 0;
+    }
+
+    case WM_INPUT:
+    {
+        BaseApp* app = reinterpret_cast<BaseApp*>(GetWindowLongPtr(hWnd, GWLP_USERDATA));
+        if (app) {
+            app->onRawInput(reinterpret_cast<HRAWINPUT>(lParam));
+        }
+        // DefWindowProc libera el mensaje de raw input.
+        return DefWindowProc(hWnd, message, wParam, lParam);
+    }
+
+    case WM_KILLFOCUS:
+    {
+        BaseApp* app = reinterpret_cast<BaseApp*>(GetWindowLongPtr(hWnd, GWLP_USERDATA));
+        if (app) {
+            app->onFocusLost();
+        }
+        return DefWindowProc(hWnd, message, wParam, lParam);
+    }
+
+    case WM_KEYDOWN:
+    {
+        // Bit 30: la tecla ya estaba pulsada (autorrepetición).
+        BaseApp* app = reinterpret_cast<BaseApp*>(GetWindowLongPtr(hWnd, GWLP_USERDATA));
+        if (app && wParam == VK_F11 && (lParam & (1 << 30)) == 0) {
+            app->togglePlayerMode();
+            return 0;
+        }
+        return DefWindowProc(hWnd, message, wParam, lParam);
+    }
+
     case WM_PAINT:
     {
         PAINTSTRUCT ps;
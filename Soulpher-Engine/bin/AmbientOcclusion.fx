@@ -0,0 +1,134 @@
+//--------------------------------------------------------------------------------------
+// File: AmbientOcclusion.fx
+//
+// Oclusión ambiental en espacio de pantalla (AmbientOcclusion.cpp) a media resolución.
+// CSOcclusion muestrea un hemisferio alrededor de la normal reconstruida del depth
+// buffer; CSTemporal lo mezcla con el resultado del frame anterior reproyectado. El
+// camino diferido lo sube a resolución completa (bilateral) en DeferredLighting.fx.
+// Ambos guardan ( oclusión, z en vista ): la z es la que usan la reproyección y la subida.
+//--------------------------------------------------------------------------------------
+cbuffer cbOcclusion : register( b7 )
+{
+    matrix OcclusionReprojection;   // vista actual -> clip del frame anterior
+    float4 OcclusionSize;           // xy = media resolución, zw = depth buffer
+    float4 OcclusionProjection;     // x = proj._11, y = proj._22, z = cerca, w = lejos
+    float4 OcclusionParams;         // x = radio (mundo), y = intensidad, z = sesgo, w = frame
+    float4 OcclusionTemporal;       // x = peso del frame nuevo, y = 1: hay historia, z = tolerancia de z (relativa)
+};
+
+#define OCCLUSION_TILE 8
+#define OCCLUSION_SAMPLES 8
+
+Texture2D<float>  Depth            : register( t0 );
+Texture2D<float2> OcclusionRaw     : register( t1 );
+Texture2D<float2> OcclusionHistory : register( t2 );
+RWTexture2D<float2> OcclusionTarget : register( u0 );
+
+// Profundidad del depth buffer [0, 1] -> z en vista (proyección en perspectiva LH).
+float LinearDepth( float depth )
+{
+    float n = OcclusionProjection.z;
+    float f = OcclusionProjection.w;
+    return n * f / ( f - depth * ( f - n ) );
+}
+
+// Posición en vista de `coord` (píxeles del depth buffer) a la profundidad `viewZ`.
+float3 ViewPosition( float2 coord, float viewZ )
+{
+    float2 ndc = float2( coord.x / OcclusionSize.z * 2.0f - 1.0f, 1.0f - coord.y / OcclusionSize.w * 2.0f );
+    return float3( ndc / OcclusionProjection.xy * viewZ, viewZ );
+}
+
+float3 LoadViewPosition( int2 pixel )
+{
+    pixel = clamp( pixel, 0, int2( OcclusionSize.zw ) - 1 );
+    return ViewPosition( pixel + 0.5f, LinearDepth( Depth[ pixel ] ) );
+}
+
+// Ruido por píxel (Jimenez 2014) para girar el patrón; cambia cada frame y la
+// acumulación temporal lo promedia.
+float InterleavedGradientNoise( float2 pixel )
+{
+    return frac( 52.9829189f * frac( dot( pixel, float2( 0.06711056f, 0.00583715f ) ) ) );
+}
+
+// Un hilo por píxel de media resolución: la esquina de su bloque 2x2 del depth buffer.
+[numthreads( OCCLUSION_TILE, OCCLUSION_TILE, 1 )]
+void CSOcclusion( uint3 pixelId : SV_DispatchThreadID )
+{
+    if ( any( pixelId.xy >= uint2( OcclusionSize.xy ) ) )
+        return;
+    int2 pixel = int2( pixelId.xy ) * 2;
+    float3 center = LoadViewPosition( pixel );
+    if ( center.z >= OcclusionProjection.w * 0.999f )
+    {
+        OcclusionTarget[ pixelId.xy ] = float2( 1.0f, center.z );  // fondo
+        return;
+    }
+
+    // Normal de la profundidad: en cada eje, la diferencia más corta (no cruza bordes).
+    float3 left = center - LoadViewPosition( pixel - int2( 1, 0 ) );
+    float3 right = LoadViewPosition( pixel + int2( 1, 0 ) ) - center;
+    float3 up = center - LoadViewPosition( pixel - int2( 0, 1 ) );
+    float3 down = LoadViewPosition( pixel + int2( 0, 1 ) ) - center;
+    float3 dx = abs( left.z ) < abs( right.z ) ? left : right;
+    float3 dy = abs( up.z ) < abs( down.z ) ? up : down;
+    float3 normal = normalize( cross( dx, dy ) );
+    if ( dot( normal, center ) > 0.0f )
+        normal = -normal;
+    float3 tangent = normalize( cross( abs( normal.y ) < 0.99f ? float3( 0.0f, 1.0f, 0.0f ) : float3( 1.0f, 0.0f, 0.0f ), normal ) );
+    float3 bitangent = cross( normal, tangent );
+
+    float noise = InterleavedGradientNoise( float2( pixelId.xy ) + OcclusionParams.w * 5.588238f );
+    float radius = OcclusionParams.x;
+    float occlusion = 0.0f;
+    [unroll]
+    for ( uint i = 0; i < OCCLUSION_SAMPLES; ++i )
+    {
+        // Espiral de ángulo áureo en el disco, subida al hemisferio (reparto coseno) y
+        // con más muestras cerca del centro.
+        float t = ( i + noise ) / OCCLUSION_SAMPLES;
+        float angle = i * 2.39996323f + noise * 6.28318531f;
+        float2 disc = float2( cos( angle ), sin( angle ) ) * sqrt( t );
+        float3 direction = tangent * disc.x + bitangent * disc.y + normal * sqrt( 1.0f - t );
+        float3 samplePos = center + direction * ( radius * lerp( 0.1f, 1.0f, t * t ) );
+        if ( samplePos.z <= OcclusionProjection.z )
+            continue;
+
+        float2 ndc = samplePos.xy * OcclusionProjection.xy / samplePos.z;
+        int2 samplePixel = int2( float2( ndc.x * 0.5f + 0.5f, 0.5f - ndc.y * 0.5f ) * OcclusionSize.zw );
+        if ( any( samplePixel < 0 ) || any( samplePixel >= int2( OcclusionSize.zw ) ) )
+            continue;
+        // Ocluye si la superficie queda delante de la muestra; menos si está mucho más
+        // cerca que el centro (es otro objeto, no el entorno del punto).
+        float sceneZ = LinearDepth( Depth[ samplePixel ] );
+        float range = saturate( radius / abs( center.z - sceneZ ) );
+        occlusion += sceneZ < samplePos.z - OcclusionParams.z ? range : 0.0f;
+    }
+    float ao = saturate( 1.0f - occlusion / OCCLUSION_SAMPLES * OcclusionParams.y );
+    OcclusionTarget[ pixelId.xy ] = float2( ao, center.z );
+}
+
+// Acumulación temporal: el punto del píxel se lleva al frame anterior y, si allí la
+// historia tenía la misma profundidad (no estaba tapado), se mezcla con ella.
+[numthreads( OCCLUSION_TILE, OCCLUSION_TILE, 1 )]
+void CSTemporal( uint3 pixelId : SV_DispatchThreadID )
+{
+    if ( any( pixelId.xy >= uint2( OcclusionSize.xy ) ) )
+        return;
+    float2 current = OcclusionRaw[ pixelId.xy ];
+    float result = current.x;
+    if ( OcclusionTemporal.y > 0.5f )
+    {
+        float3 viewPos = ViewPosition( pixelId.xy * 2.0f + 0.5f, current.y );
+        float4 previous = mul( float4( viewPos, 1.0f ), OcclusionReprojection );
+        float2 uv = float2( previous.x / previous.w * 0.5f + 0.5f, 0.5f - previous.y / previous.w * 0.5f );
+        if ( previous.w > 0.0f && all( uv >= 0.0f ) && all( uv < 1.0f ) )
+        {
+            float2 history = OcclusionHistory[ int2( uv * OcclusionSize.zw * 0.5f ) ];
+            if ( abs( history.y - previous.w ) < OcclusionTemporal.z * previous.w )
+                result = lerp( history.x, current.x, OcclusionTemporal.x );
+        }
+    }
+    OcclusionTarget[ pixelId.xy ] = float2( result, current.y );
+}
@@ -0,0 +1,42 @@
+//--------------------------------------------------------------------------------------
+// File: DebugDraw.fx
+//
+// Líneas de depuración (ver DebugDraw.h). Los vértices ya están en mundo y traen su
+// color en RGBA8 (normalizado por el input layout); solo se proyectan.
+//--------------------------------------------------------------------------------------
+cbuffer cbDebugDraw : register( b2 )
+{
+    matrix ViewProj;
+};
+
+//--------------------------------------------------------------------------------------
+struct VS_INPUT
+{
+    float3 Pos   : POSITION;
+    float4 Color : COLOR0;
+};
+
+struct PS_INPUT
+{
+    float4 Pos   : SV_POSITION;
+    float4 Color : COLOR0;
+};
+
+//--------------------------------------------------------------------------------------
+// Vertex Shader
+//--------------------------------------------------------------------------------------
+PS_INPUT VS( VS_INPUT input )
+{
+    PS_INPUT output;
+    output.Pos = mul( float4( input.Pos, 1.0f ), ViewProj );
+    output.Color = input.Color;
+    return output;
+}
+
+//--------------------------------------------------------------------------------------
+// Pixel Shader
+//--------------------------------------------------------------------------------------
+float4 PS( PS_INPUT input ) : SV_Target
+{
+    return input.Color;
+}
@@ -0,0 +1,150 @@
+//--------------------------------------------------------------------------------------
+// File: DeferredLighting.fx
+//
+// Iluminación del camino diferido (DeferredShading.cpp) por baldosas de 16x16 píxeles.
+// Cada grupo saca el rango de profundidad de su baldosa (solo píxeles del G-buffer),
+// prueba las luces contra la caja en vista de esa baldosa y deja la lista en memoria
+// compartida; luego cada hilo ilumina su píxel recorriendo solo esa lista.
+// Los píxeles sin G-buffer (Surface.a = 0) ya traen su color y se copian tal cual.
+// La AO (AmbientOcclusion.fx, media resolución) se sube aquí y oscurece sol y ambiente.
+// El reflejo de las sondas (ReflectionProbes.fxh, t8 y b10 en el CS) usa la rugosidad
+// de Albedo.a y también se oscurece con la AO.
+//--------------------------------------------------------------------------------------
+#define LIGHT_CULLING
+#include "ClusteredLights.fxh"
+
+#define TILE_SIZE 16
+#define TILE_MAX_LIGHTS 256
+
+Texture2D<float>  Depth   : register( t0 );
+Texture2D<float4> Albedo  : register( t1 );
+Texture2D<float4> Surface : register( t2 );
+Texture2D<float2> Occlusion : register( t3 );  // ( AO, z en vista ); sin enlazar = sin AO
+#ifdef LIT_FLOAT
+RWTexture2D<float4> Lit : register( u0 );        // escena HDR (PostProcess)
+#else
+RWTexture2D<unorm float4> Lit : register( u0 );  // back buffer
+#endif
+
+groupshared uint TileMinZ;
+groupshared uint TileMaxZ;
+groupshared uint TileLightCount;
+groupshared uint TileLights[ TILE_MAX_LIGHTS ];
+
+// Profundidad del depth buffer [0, 1] -> z en vista (proyección en perspectiva LH).
+float LinearDepth( float depth )
+{
+    float n = ClusterProjection.z;
+    float f = ClusterProjection.w;
+    return n * f / ( f - depth * ( f - n ) );
+}
+
+// AO a resolución completa: las 4 muestras de media resolución más cercanas, con peso
+// bilineal y por parecido de z (la de un objeto no se corre al fondo ni al revés).
+float UpsampleOcclusion( uint2 pixel, float viewZ )
+{
+    uint width, height;
+    Occlusion.GetDimensions( width, height );
+    if ( width == 0 )
+        return 1.0f;
+    float2 coord = pixel * 0.5f;   // el texel i de media resolución está en el píxel 2i
+    int2 base = int2( coord );
+    float2 f = coord - base;
+    int2 last = int2( ( uint2( ClusterScreen.xy ) + 1 ) / 2 ) - 1;  // la parte escrita (resolución dinámica)
+    float sum = 0.0f;
+    float weightSum = 0.0f;
+    [unroll]
+    for ( uint i = 0; i < 4; ++i )
+    {
+        int2 offset = int2( i & 1, i >> 1 );
+        float2 tap = Occlusion[ min( base + offset, last ) ];
+        float bilinear = ( offset.x ? f.x : 1.0f - f.x ) * ( offset.y ? f.y : 1.0f - f.y );
+        float weight = ( bilinear + 1e-3f ) / ( 1e-3f + abs( tap.y - viewZ ) / viewZ );
+        sum += tap.x * weight;
+        weightSum += weight;
+    }
+    return sum / weightSum;
+}
+
+[numthreads( TILE_SIZE, TILE_SIZE, 1 )]
+void CSLight( uint3 groupId : SV_GroupID, uint3 pixelId : SV_DispatchThreadID, uint threadIndex : SV_GroupIndex )
+{
+    if ( threadIndex == 0 )
+    {
+        TileMinZ = 0x7f7fffff;
+        TileMaxZ = 0;
+        TileLightCount = 0;
+    }
+    GroupMemoryBarrierWithGroupSync();
+
+    // Los hilos fuera del viewport siguen el grupo (barreras) pero no cuentan.
+    uint2 size = uint2( ClusterScreen.xy );
+    bool inside = all( pixelId.xy < size );
+    uint2 pixel = min( pixelId.xy, size - 1 );
+    float4 albedo = Albedo[ pixel ];
+    float4 surface = Surface[ pixel ];
+    bool lit = inside && surface.a > 0.5f;
+    float viewZ = LinearDepth( Depth[ pixel ] );
+    if ( lit )
+    {
+        // Floats positivos: el orden de sus bits es el de sus valores.
+        InterlockedMin( TileMinZ, asuint( viewZ ) );
+        InterlockedMax( TileMaxZ, asuint( viewZ ) );
+    }
+    GroupMemoryBarrierWithGroupSync();
+
+    // Caja de la baldosa en vista y reparto de luces: un hilo por luz, por tandas.
+    float minZ = asfloat( TileMinZ );
+    float maxZ = asfloat( TileMaxZ );
+    if ( minZ <= maxZ )
+    {
+        float2 pixelMin = groupId.xy * TILE_SIZE;
+        float2 pixelMax = min( pixelMin + TILE_SIZE, ClusterScreen.xy );
+        float2 ndcMin = float2( pixelMin.x / ClusterScreen.x * 2.0f - 1.0f, 1.0f - pixelMax.y / ClusterScreen.y * 2.0f );
+        float2 ndcMax = float2( pixelMax.x / ClusterScreen.x * 2.0f - 1.0f, 1.0f - pixelMin.y / ClusterScreen.y * 2.0f );
+        float2 rayMin = ndcMin / ClusterProjection.xy;
+        float2 rayMax = ndcMax / ClusterProjection.xy;
+        float3 boxMin = float3( min( rayMin * minZ, rayMin * maxZ ), minZ );
+        float3 boxMax = float3( max( rayMax * minZ, rayMax * maxZ ), maxZ );
+
+        for ( uint index = threadIndex; index < ClusterInfo.x; index += TILE_SIZE * TILE_SIZE )
+        {
+            ClusterLight light = ClusterLights[ index ];
+            float3 center = mul( float4( light.Position, 1.0f ), ClusterView ).xyz;
+            float3 offset = clamp( center, boxMin, boxMax ) - center;
+            if ( dot( offset, offset ) <= light.Range * light.Range )
+            {
+                uint slot;
+                InterlockedAdd( TileLightCount, 1, slot );
+                if ( slot < TILE_MAX_LIGHTS )
+                    TileLights[ slot ] = index;
+            }
+        }
+    }
+    GroupMemoryBarrierWithGroupSync();
+
+    if ( !inside )
+        return;
+    if ( !lit )
+    {
+        Lit[ pixel ] = albedo;
+        return;
+    }
+
+    // Posición en vista desde la profundidad y, con la inversa de la vista, en mundo.
+    float2 ndc = float2( ( pixel.x + 0.5f ) / ClusterScreen.x * 2.0f - 1.0f,
+                         1.0f - ( pixel.y + 0.5f ) / ClusterScreen.y * 2.0f );
+    float3 viewPos = float3( ndc / ClusterProjection.xy * viewZ, viewZ );
+    float3 worldPos = mul( float4( viewPos, 1.0f ), ClusterInverseView ).xyz;
+    float3 normal = OctDecode( surface.xy * 2.0f - 1.0f );
+
+    float occlusion = UpsampleOcclusion( pixel, viewZ );
+    float3 light = surface.zzz * occlusion;
+    uint count = min( TileLightCount, TILE_MAX_LIGHTS );
+    for ( uint i = 0; i < count; ++i )
+    {
+        light += EvaluateLight( ClusterLights[ TileLights[ i ] ], worldPos, normal );
+    }
+    float3 reflection = ProbeReflection( worldPos, normal, ClusterCamera.xyz, albedo.a ) * occlusion;
+    Lit[ pixel ] = float4( albedo.rgb * light + reflection, 1.0f );
+}
@@ -0,0 +1,43 @@
+//--------------------------------------------------------------------------------------
+// File: DepthOnly.fx
+//
+// Pre-pase de profundidad: solo vertex shader (el programa se crea sin pixel shader).
+// Lee el stream compacto de posiciones (12 bytes por vértice) y usa los mismos
+// constant buffers que Soulpher-Engine.fx (b0 vista, b1 proyección, b2 mundo).
+//
+// IMPORTANTE: la transformación debe ser idéntica, operación por operación, a la del
+// VS principal. El pase principal compara con D3D11_COMPARISON_EQUAL y cualquier
+// diferencia de redondeo dejaría huecos.
+//--------------------------------------------------------------------------------------
+cbuffer cbNeverChanges : register( b0 )
+{
+    matrix View;
+};
+
+cbuffer cbChangeOnResize : register( b1 )
+{
+    matrix Projection;
+};
+
+cbuffer cbChangesEveryFrame : register( b2 )
+{
+    matrix World;
+    float4 vMeshColor;
+};
+
+//--------------------------------------------------------------------------------------
+struct VS_INPUT
+{
+    float4 Pos : POSITION;
+};
+
+//--------------------------------------------------------------------------------------
+// Vertex Shader
+//--------------------------------------------------------------------------------------
+float4 VS( VS_INPUT input ) : SV_POSITION
+{
+    float4 pos = mul( input.Pos, World );
+    pos = mul( pos, View );
+    pos = mul( pos, Projection );
+    return pos;
+}
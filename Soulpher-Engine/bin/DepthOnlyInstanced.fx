@@ -0,0 +1,40 @@
+//--------------------------------------------------------------------------------------
+// File: DepthOnlyInstanced.fx
+//
+// Variante instanciada de DepthOnly.fx para los lotes de la RenderQueue. El mundo
+// llega por instancia desde el slot 1 con el mismo layout que Instancing.fx, y la
+// transformación replica la de Instancing.fx para que el pase principal pueda
+// comparar con D3D11_COMPARISON_EQUAL.
+//--------------------------------------------------------------------------------------
+cbuffer cbNeverChanges : register( b0 )
+{
+    matrix View;
+};
+
+cbuffer cbChangeOnResize : register( b1 )
+{
+    matrix Projection;
+};
+
+//--------------------------------------------------------------------------------------
+struct VS_INPUT
+{
+    float4 Pos    : POSITION;
+    float4 World0 : INSTANCE_WORLD0;
+    float4 World1 : INSTANCE_WORLD1;
+    float4 World2 : INSTANCE_WORLD2;
+    float4 World3 : INSTANCE_WORLD3;
+};
+
+//--------------------------------------------------------------------------------------
+// Vertex Shader
+//--------------------------------------------------------------------------------------
+float4 VS( VS_INPUT input ) : SV_POSITION
+{
+    float4x4 world = float4x4( input.World0, input.World1, input.World2, input.World3 );
+    float4 pos = float4( input.Pos.xyz, 1.0f );
+    pos = mul( world, pos );
+    pos = mul( pos, View );
+    pos = mul( pos, Projection );
+    return pos;
+}
@@ -0,0 +1,121 @@
+//--------------------------------------------------------------------------------------
+// File: GpuCulling.fx
+//
+// Culling del camino GPU-driven (ver GpuCulling.h). Un hilo por instancia:
+// 1) AABB en mundo contra los 6 planos del frustum (normales hacia dentro).
+// 2) Si hay pirámide Hi-Z (HiZ.fx), la caja se proyecta con la viewProj que la
+//    generó y se compara su profundidad mínima con el máximo del mip en que la
+//    caja ocupa como mucho 2x2 texels.
+// 3) Las visibles se añaden a la lista de su grupo: el contador es InstanceCount
+//    de los argumentos indirectos del grupo y la lista empieza en su
+//    StartInstanceLocation (la CPU deja ambos listos antes de lanzar el kernel).
+//--------------------------------------------------------------------------------------
+
+// Mismo layout que GpuCulling::InstanceData (y que el de Instancing.fx con GPU_DRIVEN).
+struct Instance
+{
+    row_major float4x4 World; // mundo ya transpuesto, como CBChangesEveryFrame
+    float4 Color;
+    float3 BoundsMin;
+    uint   Group;
+    float3 BoundsMax;
+    uint   Pad;
+};
+
+StructuredBuffer<Instance> Instances : register( t0 );
+Texture2D<float> HiZ : register( t1 );
+RWBuffer<uint> DrawArgs : register( u0 );            // 5 uint por grupo
+RWStructuredBuffer<uint> VisibleList : register( u1 );
+
+cbuffer cbCull : register( b0 )
+{
+    float4 Planes[6];
+    matrix HiZViewProj;   // transpuesta (como View/Projection)
+    uint   InstanceCount;
+    uint   HiZMipCount;   // 0 = sin pirámide todavía
+    uint2  HiZSize;       // tamaño del mip 0
+};
+
+bool InFrustum( float3 bmin, float3 bmax )
+{
+    [unroll]
+    for ( int i = 0; i < 6; ++i )
+    {
+        // Vértice de la caja más adentro según la normal del plano.
+        float3 p = float3( Planes[i].x >= 0.0f ? bmax.x : bmin.x,
+                           Planes[i].y >= 0.0f ? bmax.y : bmin.y,
+                           Planes[i].z >= 0.0f ? bmax.z : bmin.z );
+        if ( dot( Planes[i].xyz, p ) + Planes[i].w < 0.0f )
+            return false;
+    }
+    return true;
+}
+
+// Mismo criterio que HiZBuffer::isOccluded: ante cualquier duda, visible.
+bool IsOccluded( float3 bmin, float3 bmax )
+{
+    if ( HiZMipCount == 0 )
+        return false;
+
+    float2 ndcMin = float2( 1.0f, 1.0f );
+    float2 ndcMax = float2( -1.0f, -1.0f );
+    float minZ = 1.0f;
+    [unroll]
+    for ( int i = 0; i < 8; ++i )
+    {
+        float3 corner = float3( ( i & 1 ) ? bmax.x : bmin.x,
+                                ( i & 2 ) ? bmax.y : bmin.y,
+                                ( i & 4 ) ? bmax.z : bmin.z );
+        float4 clip = mul( float4( corner, 1.0f ), HiZViewProj );
+        if ( clip.w <= 1e-4f )
+            return false; // cruza el plano de la cámara
+        float3 ndc = clip.xyz / clip.w;
+        ndcMin = min( ndcMin, ndc.xy );
+        ndcMax = max( ndcMax, ndc.xy );
+        minZ = min( minZ, ndc.z );
+    }
+    ndcMin = max( ndcMin, -1.0f );
+    ndcMax = min( ndcMax, 1.0f );
+    if ( any( ndcMin > ndcMax ) || minZ <= 0.0f )
+        return false;
+
+    // Rectángulo en UV (y hacia abajo) y mip donde mide como mucho un texel.
+    float2 uvMin = float2( ndcMin.x * 0.5f + 0.5f, 0.5f - ndcMax.y * 0.5f );
+    float2 uvMax = float2( ndcMax.x * 0.5f + 0.5f, 0.5f - ndcMin.y * 0.5f );
+    float2 extent = ( uvMax - uvMin ) * float2( HiZSize );
+    uint mip = (uint)clamp( ceil( log2( max( max( extent.x, extent.y ), 1.0f ) ) ), 0.0f, (float)( HiZMipCount - 1 ) );
+
+    uint width, height, levels;
+    HiZ.GetDimensions( mip, width, height, levels );
+    // Un texel de margen por lado, como en CPU (huellas de los bordes impares).
+    int2 p0 = max( int2( floor( uvMin * float2( width, height ) ) ) - 1, int2( 0, 0 ) );
+    int2 p1 = min( int2( floor( uvMax * float2( width, height ) ) ) + 1, int2( width, height ) - 1 );
+
+    [loop]
+    for ( int y = p0.y; y <= p1.y; ++y )
+    {
+        [loop]
+        for ( int x = p0.x; x <= p1.x; ++x )
+        {
+            if ( minZ <= HiZ.Load( int3( x, y, mip ) ) )
+                return false;
+        }
+    }
+    return true;
+}
+
+[numthreads( 64, 1, 1 )]
+void CSCull( uint3 id : SV_DispatchThreadID )
+{
+    if ( id.x >= InstanceCount )
+        return;
+
+    Instance instance = Instances[ id.x ];
+    if ( !InFrustum( instance.BoundsMin, instance.BoundsMax ) ||
+         IsOccluded( instance.BoundsMin, instance.BoundsMax ) )
+        return;
+
+    uint slot;
+    InterlockedAdd( DrawArgs[ instance.Group * 5 + 1 ], 1, slot );
+    VisibleList[ DrawArgs[ instance.Group * 5 + 4 ] + slot ] = id.x;
+}
@@ -0,0 +1,329 @@
+//--------------------------------------------------------------------------------------
+// File: GpuParticles.fx
+//
+// Partículas en GPU (ver GpuParticles.h). Las partículas viven en un buffer de
+// capacidad fija; qué huecos están libres y cuáles vivos lo dicen dos listas de
+// índices con contador oculto (append/consume):
+// - CSReset: todas a la lista de muertas.
+// - CSEmit: cada hilo consume un hueco libre, lo inicializa y lo apunta en las vivas.
+// - CSPrepareArgs: argumentos del dispatch de la simulación (un hilo por viva).
+// - CSSimulate: las que siguen vivas van a la otra lista; las que mueren, a las muertas.
+// - CSSortKeys, CSSortLocal, CSSortStep, CSSortMerge: bitonic sort de atrás adelante.
+// - VSParticles / VSParticlesSorted + PSParticles: un quad por viva con fundido suave.
+//--------------------------------------------------------------------------------------
+
+// Mismo layout que GpuParticles::Particle.
+struct Particle
+{
+    float3 Position;
+    float  Age;
+    float3 Velocity;
+    float  Lifetime;
+    uint   Color;      // RGBA8 al nacer
+    uint   ColorEnd;   // RGBA8 al morir
+    float  Size;
+    float  SizeEnd;
+};
+
+struct SortEntry
+{
+    float Key;         // -profundidad de vista (FLT_MAX = hueco vacío)
+    uint  Index;
+};
+
+cbuffer cbParticles : register( b11 )
+{
+    float4 EmitPosition;   // xyz centro, w radio
+    float4 EmitVelocity;   // xyz velocidad media, w dispersión
+    uint4  EmitColor;      // x inicial, y final
+    float4 EmitShape;      // x tamaño inicial, y final, z vida, w variación
+    uint4  EmitInfo;       // x a emitir, y semilla, z capacidad
+    uint4  SortInfo;       // x k, y j, z capacidad del orden
+    float4 Gravity;        // xyz gravedad, w delta
+    float4 Simulation;     // x frenado, y distancia suave, z cerca, w lejos
+    float4 CameraRight;
+    float4 CameraUp;
+    float4 CameraForward;  // profundidad = dot( xyz, p ) + w
+    matrix ViewProj;       // transpuesta (como View/Projection)
+};
+
+// Escritos por CopyStructureCount (solo x).
+cbuffer cbDeadCount : register( b12 )
+{
+    uint4 DeadCount;
+};
+
+cbuffer cbAliveCount : register( b13 )
+{
+    uint4 AliveCount;
+};
+
+StructuredBuffer<uint> AliveIn : register( t0 );
+StructuredBuffer<Particle> ParticlesIn : register( t1 );
+Texture2D<float> SceneDepth : register( t2 );
+StructuredBuffer<SortEntry> SortedIn : register( t3 );
+
+RWStructuredBuffer<Particle> Particles : register( u0 );
+ConsumeStructuredBuffer<uint> DeadList : register( u1 );
+AppendStructuredBuffer<uint> AliveOut : register( u2 );
+RWBuffer<uint> Args : register( u3 );              // [0..3] draw, [4..6] dispatch
+RWStructuredBuffer<SortEntry> SortKeys : register( u4 );
+AppendStructuredBuffer<uint> DeadListAppend : register( u5 );
+
+#define THREAD_GROUP_SIZE 256
+#define SORT_GROUP_SIZE 512
+#define FLT_MAX 3.402823466e+38f
+
+//--------------------------------------------------------------------------------------
+// Aleatorios
+//--------------------------------------------------------------------------------------
+uint Hash( uint x )
+{
+    x ^= x >> 16;
+    x *= 0x7feb352d;
+    x ^= x >> 15;
+    x *= 0x846ca68b;
+    x ^= x >> 16;
+    return x;
+}
+
+float Random( inout uint state )
+{
+    state = Hash( state );
+    return ( state & 0x00ffffff ) / 16777216.0f;
+}
+
+// Punto uniforme en la bola unidad.
+float3 RandomInBall( inout uint state )
+{
+    float z = Random( state ) * 2.0f - 1.0f;
+    float a = Random( state ) * 6.28318531f;
+    float r = sqrt( saturate( 1.0f - z * z ) );
+    return float3( r * cos( a ), r * sin( a ), z ) * pow( Random( state ), 1.0f / 3.0f );
+}
+
+float4 UnpackColor( uint c )
+{
+    return float4( c & 0xff, ( c >> 8 ) & 0xff, ( c >> 16 ) & 0xff, c >> 24 ) / 255.0f;
+}
+
+//--------------------------------------------------------------------------------------
+// Emisión y simulación
+//--------------------------------------------------------------------------------------
+[numthreads( THREAD_GROUP_SIZE, 1, 1 )]
+void CSReset( uint3 id : SV_DispatchThreadID )
+{
+    if ( id.x < EmitInfo.z )
+        DeadListAppend.Append( id.x );
+}
+
+[numthreads( THREAD_GROUP_SIZE, 1, 1 )]
+void CSEmit( uint3 id : SV_DispatchThreadID )
+{
+    // Nunca más que los huecos libres: consumir de una lista vacía no es válido.
+    if ( id.x >= min( EmitInfo.x, DeadCount.x ) )
+        return;
+
+    uint state = Hash( id.x ^ Hash( EmitInfo.y ) );
+    Particle p;
+    p.Position = EmitPosition.xyz + RandomInBall( state ) * EmitPosition.w;
+    p.Age = 0.0f;
+    p.Velocity = EmitVelocity.xyz + RandomInBall( state ) * EmitVelocity.w;
+    p.Lifetime = max( EmitShape.z + ( Random( state ) * 2.0f - 1.0f ) * EmitShape.w, 0.01f );
+    p.Color = EmitColor.x;
+    p.ColorEnd = EmitColor.y;
+    p.Size = EmitShape.x;
+    p.SizeEnd = EmitShape.y;
+
+    uint index = DeadList.Consume();
+    Particles[index] = p;
+    AliveOut.Append( index );
+}
+
+[numthreads( 1, 1, 1 )]
+void CSPrepareArgs()
+{
+    Args[0] = 4;    // vértices por instancia (tira)
+    Args[1] = 0;    // instancias: CopyStructureCount tras la simulación
+    Args[2] = 0;
+    Args[3] = 0;
+    Args[4] = ( AliveCount.x + THREAD_GROUP_SIZE - 1 ) / THREAD_GROUP_SIZE;
+    Args[5] = 1;
+    Args[6] = 1;
+}
+
+[numthreads( THREAD_GROUP_SIZE, 1, 1 )]
+void CSSimulate( uint3 id : SV_DispatchThreadID )
+{
+    if ( id.x >= AliveCount.x )
+        return;
+
+    uint index = AliveIn[id.x];
+    Particle p = Particles[index];
+    float dt = Gravity.w;
+    p.Age += dt;
+    if ( p.Age >= p.Lifetime )
+    {
+        DeadListAppend.Append( index );
+        return;
+    }
+    p.Velocity = ( p.Velocity + Gravity.xyz * dt ) / ( 1.0f + Simulation.x * dt );
+    p.Position += p.Velocity * dt;
+    Particles[index] = p;
+    AliveOut.Append( index );
+}
+
+//--------------------------------------------------------------------------------------
+// Bitonic sort ascendente de SortKeys (SortInfo.z claves, potencia de dos)
+//--------------------------------------------------------------------------------------
+[numthreads( THREAD_GROUP_SIZE, 1, 1 )]
+void CSSortKeys( uint3 id : SV_DispatchThreadID )
+{
+    if ( id.x >= SortInfo.z )
+        return;
+
+    SortEntry entry;
+    entry.Key = FLT_MAX;
+    entry.Index = 0;
+    if ( id.x < AliveCount.x )
+    {
+        entry.Index = AliveIn[id.x];
+        entry.Key = -( dot( CameraForward.xyz, ParticlesIn[entry.Index].Position ) + CameraForward.w );
+    }
+    SortKeys[id.x] = entry;
+}
+
+groupshared SortEntry g_sort[SORT_GROUP_SIZE];
+
+// Primer elemento del par `pair` con distancia j (potencia de dos): el bit j a cero.
+uint PairLeft( uint pair, uint j )
+{
+    return ( ( pair & ~( j - 1 ) ) << 1 ) | ( pair & ( j - 1 ) );
+}
+
+// Un paso (k, j) sobre el bloque en memoria compartida; cada hilo, un par.
+void SharedStep( uint thread, uint base, uint k, uint j )
+{
+    uint left = PairLeft( thread, j );
+    uint right = left + j;
+    bool ascending = ( ( base + left ) & k ) == 0;
+    SortEntry a = g_sort[left];
+    SortEntry b = g_sort[right];
+    if ( ( a.Key > b.Key ) == ascending )
+    {
+        g_sort[left] = b;
+        g_sort[right] = a;
+    }
+    GroupMemoryBarrierWithGroupSync();
+}
+
+void LoadBlock( uint thread, uint base )
+{
+    g_sort[thread] = SortKeys[base + thread];
+    g_sort[thread + THREAD_GROUP_SIZE] = SortKeys[base + thread + THREAD_GROUP_SIZE];
+    GroupMemoryBarrierWithGroupSync();
+}
+
+void StoreBlock( uint thread, uint base )
+{
+    SortKeys[base + thread] = g_sort[thread];
+    SortKeys[base + thread + THREAD_GROUP_SIZE] = g_sort[thread + THREAD_GROUP_SIZE];
+}
+
+// Todas las etapas con k <= SORT_GROUP_SIZE, un bloque por grupo.
+[numthreads( THREAD_GROUP_SIZE, 1, 1 )]
+void CSSortLocal( uint3 group : SV_GroupID, uint3 thread : SV_GroupThreadID )
+{
+    uint base = group.x * SORT_GROUP_SIZE;
+    LoadBlock( thread.x, base );
+    for ( uint k = 2; k <= SORT_GROUP_SIZE; k <<= 1 )
+    {
+        for ( uint j = k >> 1; j > 0; j >>= 1 )
+            SharedStep( thread.x, base, k, j );
+    }
+    StoreBlock( thread.x, base );
+}
+
+// Un paso (SortInfo.x, SortInfo.y) con j >= SORT_GROUP_SIZE, en memoria global.
+[numthreads( THREAD_GROUP_SIZE, 1, 1 )]
+void CSSortStep( uint3 id : SV_DispatchThreadID )
+{
+    uint k = SortInfo.x;
+    uint j = SortInfo.y;
+    uint left = PairLeft( id.x, j );
+    uint right = left + j;
+    if ( right >= SortInfo.z )
+        return;
+    bool ascending = ( left & k ) == 0;
+    SortEntry a = SortKeys[left];
+    SortEntry b = SortKeys[right];
+    if ( ( a.Key > b.Key ) == ascending )
+    {
+        SortKeys[left] = b;
+        SortKeys[right] = a;
+    }
+}
+
+// Los pasos j < SORT_GROUP_SIZE de la etapa SortInfo.x, un bloque por grupo.
+[numthreads( THREAD_GROUP_SIZE, 1, 1 )]
+void CSSortMerge( uint3 group : SV_GroupID, uint3 thread : SV_GroupThreadID )
+{
+    uint base = group.x * SORT_GROUP_SIZE;
+    LoadBlock( thread.x, base );
+    for ( uint j = SORT_GROUP_SIZE >> 1; j > 0; j >>= 1 )
+        SharedStep( thread.x, base, SortInfo.x, j );
+    StoreBlock( thread.x, base );
+}
+
+//--------------------------------------------------------------------------------------
+// Dibujo
+//--------------------------------------------------------------------------------------
+struct PS_INPUT
+{
+    float4 Pos    : SV_POSITION;
+    float4 Color  : COLOR0;
+    float2 Corner : TEXCOORD0;   // -1..1 dentro del quad
+    float  Depth  : TEXCOORD1;   // profundidad de vista
+};
+
+PS_INPUT Billboard( uint index, uint vertexId )
+{
+    Particle p = ParticlesIn[index];
+    float t = saturate( p.Age / p.Lifetime );
+    float2 corner = float2( ( vertexId & 1 ) ? 1.0f : -1.0f, ( vertexId & 2 ) ? -1.0f : 1.0f );
+    float size = lerp( p.Size, p.SizeEnd, t ) * 0.5f;
+    float3 world = p.Position + ( CameraRight.xyz * corner.x + CameraUp.xyz * corner.y ) * size;
+
+    PS_INPUT output;
+    output.Pos = mul( float4( world, 1.0f ), ViewProj );
+    output.Color = lerp( UnpackColor( p.Color ), UnpackColor( p.ColorEnd ), t );
+    output.Corner = corner;
+    output.Depth = dot( CameraForward.xyz, world ) + CameraForward.w;
+    return output;
+}
+
+PS_INPUT VSParticles( uint vertexId : SV_VertexID, uint instanceId : SV_InstanceID )
+{
+    return Billboard( AliveIn[instanceId], vertexId );
+}
+
+PS_INPUT VSParticlesSorted( uint vertexId : SV_VertexID, uint instanceId : SV_InstanceID )
+{
+    return Billboard( SortedIn[instanceId].Index, vertexId );
+}
+
+// Color premultiplicado: el mismo resultado sirve para la suma y para "over".
+float4 PSParticles( PS_INPUT input ) : SV_Target
+{
+    float falloff = saturate( 1.0f - dot( input.Corner, input.Corner ) );
+    float fade = 1.0f;
+    if ( Simulation.y > 0.0f )
+    {
+        // Profundidad de la escena a distancia lineal, como la de la partícula.
+        float d = SceneDepth.Load( int3( input.Pos.xy, 0 ) );
+        float sceneDepth = Simulation.z * Simulation.w / ( Simulation.w - d * ( Simulation.w - Simulation.z ) );
+        fade = saturate( ( sceneDepth - input.Depth ) / Simulation.y );
+    }
+    float alpha = input.Color.a * falloff * fade;
+    return float4( input.Color.rgb * alpha, alpha );
+}
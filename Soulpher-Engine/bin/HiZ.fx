@@ -0,0 +1,52 @@
+//--------------------------------------------------------------------------------------
+// File: HiZ.fx
+//
+// Construye la pirámide Hi-Z (hierarchical Z) del depth buffer. Cada nivel guarda
+// la profundidad MÁXIMA (la más lejana) de su huella en el nivel anterior, de modo
+// que un objeto cuya profundidad mínima supere ese valor está oculto con seguridad.
+//
+// Un solo kernel sirve para todos los niveles: el primero lee el depth buffer
+// (SRV R24_UNORM_X8_TYPELESS) y los siguientes el mip anterior (R32_FLOAT).
+//--------------------------------------------------------------------------------------
+Texture2D<float> SrcDepth : register( t0 );
+RWTexture2D<float> DstDepth : register( u0 );
+
+cbuffer cbHiZ : register( b0 )
+{
+    uint2 SrcSize;
+    uint2 DstSize;
+};
+
+float LoadClamped( int2 p )
+{
+    p = min( p, int2( SrcSize ) - 1 );
+    return SrcDepth.Load( int3( p, 0 ) );
+}
+
+//--------------------------------------------------------------------------------------
+// Máximo de la huella del texel en el origen: [id, id + 1) * SrcSize / DstSize. Entre
+// niveles son 2x2 (3 donde el origen es impar); el nivel 0 lee el depth buffer, que con
+// resolución dinámica mide entre 1 y 2 veces el nivel: siempre cabe en 3x3.
+//--------------------------------------------------------------------------------------
+[numthreads( 8, 8, 1 )]
+void CSReduce( uint3 id : SV_DispatchThreadID )
+{
+    if ( id.x >= DstSize.x || id.y >= DstSize.y )
+        return;
+
+    int2 first = int2( id.xy * SrcSize / DstSize );
+    int2 last = int2( ( ( id.xy + 1 ) * SrcSize + DstSize - 1 ) / DstSize ) - 1;
+    float d = 0.0f;
+    [unroll]
+    for ( int y = 0; y < 3; ++y )
+    {
+        [unroll]
+        for ( int x = 0; x < 3; ++x )
+        {
+            if ( first.x + x <= last.x && first.y + y <= last.y )
+                d = max( d, LoadClamped( first + int2( x, y ) ) );
+        }
+    }
+
+    DstDepth[ id.xy ] = d;
+}
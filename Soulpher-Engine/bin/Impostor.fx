@@ -0,0 +1,108 @@
+//--------------------------------------------------------------------------------------
+// File: Impostor.fx
+//
+// Impostores de actores lejanos (ver ImpostorRenderer.h).
+//
+// Con BAKE definido: horneado del atlas. La malla se dibuja con la cámara ortográfica
+// de cada vista (b0/b1) y su matriz de decodificación como mundo (b2); el color sale
+// de la textura sin tinte y con alfa 1 (el fondo se limpia a alfa 0).
+//
+// Sin BAKE: un quad por instancia orientado a la cámara alrededor del eje Y. La vista
+// del atlas se elige con la dirección de la cámara en el espacio del actor (su eje X
+// en mundo llega por instancia) y el color se tiñe como en Instancing.fx.
+//--------------------------------------------------------------------------------------
+Texture2D txDiffuse : register( t0 );
+SamplerState samLinear : register( s0 );
+
+cbuffer cbNeverChanges : register( b0 )
+{
+    matrix View;
+};
+
+cbuffer cbChangeOnResize : register( b1 )
+{
+    matrix Projection;
+};
+
+#ifdef BAKE
+cbuffer cbChangesEveryFrame : register( b2 )
+{
+    matrix World;
+    float4 vMeshColor;
+};
+
+struct VS_INPUT
+{
+    float4 Pos : POSITION;
+    float2 Tex : TEXCOORD0;
+};
+#else
+cbuffer cbImpostor : register( b2 )
+{
+    float4 EyePos;     // xyz: cámara en mundo
+    float4 AtlasInfo;  // x: vistas, y: 1 / vistas
+};
+
+struct VS_INPUT
+{
+    float2 Corner : POSITION;          // esquina del quad en [-1,1]^2
+    float4 Center : IMPOSTOR_CENTER0;  // xyz: centro en mundo, w: radio
+    float4 Color  : INSTANCE_COLOR0;
+    float2 AxisX  : IMPOSTOR_AXIS0;    // eje X del actor en mundo (xz, normalizado)
+};
+#endif
+
+struct PS_INPUT
+{
+    float4 Pos   : SV_POSITION;
+    float2 Tex   : TEXCOORD0;
+    float4 Color : COLOR0;
+};
+
+//--------------------------------------------------------------------------------------
+// Vertex Shader
+//--------------------------------------------------------------------------------------
+PS_INPUT VS( VS_INPUT input )
+{
+    PS_INPUT output = (PS_INPUT)0;
+#ifdef BAKE
+    output.Pos = mul( float4( input.Pos.xyz, 1.0f ), World );
+    output.Pos = mul( output.Pos, View );
+    output.Pos = mul( output.Pos, Projection );
+    output.Tex = input.Tex;
+    output.Color = float4( 1.0f, 1.0f, 1.0f, 1.0f );
+#else
+    float3 center = input.Center.xyz;
+    float2 toEye = EyePos.xz - center.xz;
+    toEye = dot( toEye, toEye ) > 1e-8f ? normalize( toEye ) : float2( 0.0f, -1.0f );
+
+    // Dirección de la cámara en el espacio del actor: ejes X = AxisX, Z = (-AxisX.y, AxisX.x).
+    float2 local = float2( dot( toEye, input.AxisX ), dot( toEye, float2( -input.AxisX.y, input.AxisX.x ) ) );
+    const float TWO_PI = 6.28318531f;
+    float angle = atan2( local.x, local.y );
+    float view = fmod( round( angle / TWO_PI * AtlasInfo.x ) + AtlasInfo.x, AtlasInfo.x );
+
+    // Quad cilíndrico: derecha de la cámara en XZ (como XMMatrixLookAtLH) y arriba = Y.
+    float3 right = float3( -toEye.y, 0.0f, toEye.x );
+    float3 pos = center + ( right * input.Corner.x + float3( 0.0f, input.Corner.y, 0.0f ) ) * input.Center.w;
+    output.Pos = mul( float4( pos, 1.0f ), View );
+    output.Pos = mul( output.Pos, Projection );
+    output.Tex = float2( ( view + input.Corner.x * 0.5f + 0.5f ) * AtlasInfo.y, 0.5f - input.Corner.y * 0.5f );
+    output.Color = input.Color;
+#endif
+    return output;
+}
+
+//--------------------------------------------------------------------------------------
+// Pixel Shader
+//--------------------------------------------------------------------------------------
+float4 PS( PS_INPUT input ) : SV_Target
+{
+    float4 color = txDiffuse.Sample( samLinear, input.Tex );
+#ifdef BAKE
+    return float4( color.rgb, 1.0f );
+#else
+    clip( color.a - 0.5f );
+    return float4( color.rgb * input.Color.rgb, input.Color.a );
+#endif
+}
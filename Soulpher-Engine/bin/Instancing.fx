@@ -0,0 +1,136 @@
+//--------------------------------------------------------------------------------------
+// File: Instancing.fx
+//
+// Variante instanciada del shader principal. Mismos constant buffers y recursos
+// que Soulpher-Engine.fx (b0 vista, b1 proyección, t0 difusa, s0 sampler), pero la
+// matriz de mundo y el color llegan por instancia desde el vertex buffer del slot 1,
+// con el mismo layout que CBChangesEveryFrame (mundo ya transpuesto + color).
+//
+// Con TEXTURE_ARRAY definido (TextureArrayPool), t0 es un Texture2DArray y cada
+// instancia trae su capa en el slot 2: un lote puede mezclar texturas distintas.
+//
+// Con GPU_DRIVEN definido (GpuCulling) el slot 1 solo trae un índice en la lista de
+// visibles que escribe el compute shader de culling; mundo y color salen de t2/t3.
+//
+// Con ALPHA_TEST definido (MATERIAL_ALPHA_TESTED) descarta los píxeles con alfa bajo
+// el umbral del material (b4).
+//
+// Suma las luces locales de su cluster (ClusteredLights.fxh: t4-t6, b5) a la luz
+// ambiente del color.
+//--------------------------------------------------------------------------------------
+#ifdef TEXTURE_ARRAY
+Texture2DArray txDiffuse : register( t0 );
+#else
+Texture2D txDiffuse : register( t0 );
+#endif
+SamplerState samLinear : register( s0 );
+#ifdef GPU_DRIVEN
+// Camino GPU-driven (GpuCulling.fx): el slot 1 trae el hueco de la lista de visibles
+// (StartInstanceLocation + SV_InstanceID) y los datos se leen de la lista de instancias.
+struct Instance
+{
+    row_major float4x4 World;
+    float4 Color;
+    float3 BoundsMin;
+    uint   Group;
+    float3 BoundsMax;
+    uint   Pad;
+};
+StructuredBuffer<Instance> Instances : register( t2 );
+StructuredBuffer<uint> VisibleList : register( t3 );
+#endif
+
+cbuffer cbNeverChanges : register( b0 )
+{
+    matrix View;
+};
+
+cbuffer cbChangeOnResize : register( b1 )
+{
+    matrix Projection;
+};
+
+cbuffer cbMaterial : register( b4 )
+{
+    float4 vDiffuseColor;    // MaterialLibrary (inmutable, multiplica el color del objeto)
+    float4 vMaterialParams;  // x = umbral de alpha test (solo con ALPHA_TEST), y = rugosidad (G-buffer)
+};
+
+#include "ClusteredLights.fxh"
+
+//--------------------------------------------------------------------------------------
+struct VS_INPUT
+{
+    float4 Pos    : POSITION;
+    float2 Tex    : TEXCOORD0;
+#ifdef GPU_DRIVEN
+    uint   Slot   : INSTANCE_SLOT0;
+#else
+    float4 World0 : INSTANCE_WORLD0;
+    float4 World1 : INSTANCE_WORLD1;
+    float4 World2 : INSTANCE_WORLD2;
+    float4 World3 : INSTANCE_WORLD3;
+    float4 Color  : INSTANCE_COLOR0;
+#endif
+#ifdef TEXTURE_ARRAY
+    uint   Slice  : INSTANCE_SLICE0;
+#endif
+};
+
+struct PS_INPUT
+{
+    float4 Pos      : SV_POSITION;
+    float2 Tex      : TEXCOORD0;
+    float4 Color    : COLOR0;
+    float3 WorldPos : TEXCOORD2;
+    float  ViewZ    : TEXCOORD3;
+#ifdef TEXTURE_ARRAY
+    nointerpolation float Slice : TEXCOORD1;
+#endif
+};
+
+//--------------------------------------------------------------------------------------
+// Vertex Shader
+//--------------------------------------------------------------------------------------
+PS_INPUT VS( VS_INPUT input )
+{
+    PS_INPUT output = (PS_INPUT)0;
+    // Las filas recibidas son las columnas del mundo (se subió transpuesto),
+    // por eso se multiplica matriz * vector.
+#ifdef GPU_DRIVEN
+    Instance instance = Instances[ VisibleList[ input.Slot ] ];
+    float4x4 world = instance.World;
+    float4 color = instance.Color;
+#else
+    float4x4 world = float4x4( input.World0, input.World1, input.World2, input.World3 );
+    float4 color = input.Color;
+#endif
+    float4 pos = float4( input.Pos.xyz, 1.0f );
+    output.Pos = mul( world, pos );
+    output.WorldPos = output.Pos.xyz;
+    output.Pos = mul( output.Pos, View );
+    output.ViewZ = output.Pos.z;
+    output.Pos = mul( output.Pos, Projection );
+    output.Tex = input.Tex;
+    output.Color = color;
+#ifdef TEXTURE_ARRAY
+    output.Slice = (float)input.Slice;
+#endif
+    return output;
+}
+
+//--------------------------------------------------------------------------------------
+// Pixel Shader
+//--------------------------------------------------------------------------------------
+SurfaceOutput PS( PS_INPUT input )
+{
+#ifdef TEXTURE_ARRAY
+    float4 color = txDiffuse.Sample( samLinear, float3( input.Tex, input.Slice ) ) * input.Color * vDiffuseColor;
+#else
+    float4 color = txDiffuse.Sample( samLinear, input.Tex ) * input.Color * vDiffuseColor;
+#endif
+#ifdef ALPHA_TEST
+    clip( color.a - vMaterialParams.x );
+#endif
+    return ShadeSurface( input.Pos, input.WorldPos, input.ViewZ, color, 1.0f, vMaterialParams.y );
+}
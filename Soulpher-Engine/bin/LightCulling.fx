@@ -0,0 +1,68 @@
+//--------------------------------------------------------------------------------------
+// File: LightCulling.fx
+//
+// Reparte las luces locales en los clusters del frustum (ClusteredLighting.cpp).
+// Un grupo por corte de profundidad y un hilo por baldosa de pantalla: cada hilo
+// calcula la AABB en vista de su cluster; el grupo carga las luces por tandas en
+// memoria compartida (centro en vista + alcance) y cada hilo apunta las que tocan su
+// caja. Sin atómicos: cada cluster tiene sus CLUSTER_MAX_LIGHTS huecos.
+//--------------------------------------------------------------------------------------
+#define LIGHT_CULLING
+#include "ClusteredLights.fxh"
+
+#define CLUSTER_THREADS ( CLUSTER_X * CLUSTER_Y )
+
+RWBuffer<uint> LightCount : register( u0 );
+RWBuffer<uint> LightIndex : register( u1 );
+
+groupshared float4 SharedLights[ CLUSTER_THREADS ];
+
+[numthreads( CLUSTER_X, CLUSTER_Y, 1 )]
+void CSCull( uint3 groupId : SV_GroupID, uint3 threadId : SV_GroupThreadID, uint threadIndex : SV_GroupIndex )
+{
+    uint3 cell = uint3( threadId.xy, groupId.z );
+    uint cluster = ( cell.z * CLUSTER_Y + cell.y ) * CLUSTER_X + cell.x;
+
+    // Profundidades del corte (reparto logarítmico entre cerca y lejos).
+    float depthRatio = ClusterProjection.w / ClusterProjection.z;
+    float sliceNear = ClusterProjection.z * pow( depthRatio, cell.z / (float)CLUSTER_Z );
+    float sliceFar = ClusterProjection.z * pow( depthRatio, ( cell.z + 1 ) / (float)CLUSTER_Z );
+
+    // Baldosa en NDC (y hacia arriba) y, con la proyección, en vista a profundidad 1.
+    float2 pixelMin = cell.xy * ClusterScreen.zw;
+    float2 pixelMax = min( ( cell.xy + 1 ) * ClusterScreen.zw, ClusterScreen.xy );
+    float2 ndcMin = float2( pixelMin.x / ClusterScreen.x * 2.0f - 1.0f, 1.0f - pixelMax.y / ClusterScreen.y * 2.0f );
+    float2 ndcMax = float2( pixelMax.x / ClusterScreen.x * 2.0f - 1.0f, 1.0f - pixelMin.y / ClusterScreen.y * 2.0f );
+    float2 rayMin = ndcMin / ClusterProjection.xy;
+    float2 rayMax = ndcMax / ClusterProjection.xy;
+    float3 boxMin = float3( min( rayMin * sliceNear, rayMin * sliceFar ), sliceNear );
+    float3 boxMax = float3( max( rayMax * sliceNear, rayMax * sliceFar ), sliceFar );
+
+    uint count = 0;
+    uint first = cluster * CLUSTER_MAX_LIGHTS;
+    for ( uint batch = 0; batch < ClusterInfo.x; batch += CLUSTER_THREADS )
+    {
+        uint index = batch + threadIndex;
+        if ( index < ClusterInfo.x )
+        {
+            ClusterLight light = ClusterLights[ index ];
+            SharedLights[ threadIndex ] = float4( mul( float4( light.Position, 1.0f ), ClusterView ).xyz, light.Range );
+        }
+        GroupMemoryBarrierWithGroupSync();
+
+        uint batchCount = min( CLUSTER_THREADS, ClusterInfo.x - batch );
+        for ( uint i = 0; i < batchCount; ++i )
+        {
+            // Esfera contra caja: distancia del centro al punto más cercano de la caja.
+            float4 sphere = SharedLights[ i ];
+            float3 offset = clamp( sphere.xyz, boxMin, boxMax ) - sphere.xyz;
+            if ( dot( offset, offset ) <= sphere.w * sphere.w && count < CLUSTER_MAX_LIGHTS )
+            {
+                LightIndex[ first + count ] = batch + i;
+                ++count;
+            }
+        }
+        GroupMemoryBarrierWithGroupSync();
+    }
+    LightCount[ cluster ] = count;
+}
@@ -0,0 +1,88 @@
+//--------------------------------------------------------------------------------------
+// File: Lightmapped.fx
+//
+// Variante del shader principal para actores con lightmap horneado (LightmapBaker.cpp).
+// Mismos recursos que Soulpher-Engine.fx (b0 vista, b1 proyección, b2 mundo + color,
+// b4 material, t0 difusa, s0 sampler) más el lightmap: t7 página del atlas (BC6H) y
+// b9 cbLightmap con el rectángulo del actor. La UV2 llega por el slot 3.
+//
+// IMPORTANTE: la posición en pantalla se calcula igual, operación por operación, que en
+// DepthOnly.fx; el pase principal compara con EQUAL tras el pre-pase de profundidad.
+//
+// El lightmap ya contiene sol, cielo, luces locales y rebotes: no se leen las cascadas
+// ni los clusters. En diferido el píxel sale con Surface.a = 0 (ya iluminado).
+//--------------------------------------------------------------------------------------
+Texture2D txDiffuse : register( t0 );
+Texture2D txLightmap : register( t7 );
+SamplerState samLinear : register( s0 );
+
+cbuffer cbNeverChanges : register( b0 )
+{
+    matrix View;
+};
+
+cbuffer cbChangeOnResize : register( b1 )
+{
+    matrix Projection;
+};
+
+cbuffer cbChangesEveryFrame : register( b2 )
+{
+    matrix World;
+    float4 vMeshColor;
+};
+
+cbuffer cbMaterial : register( b4 )
+{
+    float4 vDiffuseColor;    // MaterialLibrary (inmutable, multiplica el color del objeto)
+    float4 vMaterialParams;  // x = umbral de alpha test, y = rugosidad (G-buffer)
+};
+
+cbuffer cbLightmap : register( b9 )
+{
+    float4 LightmapScaleOffset; // xy = escala, zw = esquina del rectángulo en la página
+};
+
+#include "ClusteredLights.fxh"
+
+//--------------------------------------------------------------------------------------
+struct VS_INPUT
+{
+    float4 Pos : POSITION;
+    float2 Tex : TEXCOORD0;
+    float2 LightmapTex : TEXCOORD1;
+};
+
+struct PS_INPUT
+{
+    float4 Pos         : SV_POSITION;
+    float2 Tex         : TEXCOORD0;
+    float2 LightmapTex : TEXCOORD1;
+};
+
+//--------------------------------------------------------------------------------------
+// Vertex Shader
+//--------------------------------------------------------------------------------------
+PS_INPUT VS( VS_INPUT input )
+{
+    PS_INPUT output = (PS_INPUT)0;
+    output.Pos = mul( input.Pos, World );
+    output.Pos = mul( output.Pos, View );
+    output.Pos = mul( output.Pos, Projection );
+    output.Tex = input.Tex;
+    output.LightmapTex = input.LightmapTex * LightmapScaleOffset.xy + LightmapScaleOffset.zw;
+    return output;
+}
+
+//--------------------------------------------------------------------------------------
+// Pixel Shader
+//--------------------------------------------------------------------------------------
+SurfaceOutput PS( PS_INPUT input )
+{
+    float4 albedo = txDiffuse.Sample( samLinear, input.Tex ) * vMeshColor * vDiffuseColor;
+    float3 irradiance = txLightmap.Sample( samLinear, input.LightmapTex ).rgb;
+    SurfaceOutput output;
+    output.Color = float4( albedo.rgb * irradiance, albedo.a );
+    output.Surface = float4( 0.0f, 0.0f, 0.0f, 0.0f );
+    return output;
+}
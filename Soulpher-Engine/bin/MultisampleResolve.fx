@@ -0,0 +1,25 @@
+//--------------------------------------------------------------------------------------
+// File: MultisampleResolve.fx
+//
+// Resolución de la profundidad multimuestra de la escena (Multisampling.cpp). El color
+// se resuelve con ResolveSubresource; la profundidad no admite promedio, así que se
+// guarda la muestra más lejana de cada píxel (Hi-Z conservadora).
+//--------------------------------------------------------------------------------------
+#define RESOLVE_TILE 8
+
+Texture2DMS<float> Depth        : register( t0 );
+RWTexture2D<float> ResolvedDepth : register( u0 );
+
+[numthreads( RESOLVE_TILE, RESOLVE_TILE, 1 )]
+void CSResolveDepth( uint3 pixelId : SV_DispatchThreadID )
+{
+    uint width, height, samples;
+    Depth.GetDimensions( width, height, samples );
+    if ( any( pixelId.xy >= uint2( width, height ) ) )
+        return;
+
+    float depth = 0.0f;
+    for ( uint i = 0; i < samples; ++i )
+        depth = max( depth, Depth.Load( int2( pixelId.xy ), i ) );
+    ResolvedDepth[ pixelId.xy ] = depth;
+}
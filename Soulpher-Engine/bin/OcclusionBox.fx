@@ -0,0 +1,40 @@
+//--------------------------------------------------------------------------------------
+// File: OcclusionBox.fx
+//
+// Caja de prueba de las occlusion queries predicadas (ver OcclusionPredicates.h).
+// Solo vertex shader (el programa se crea sin pixel shader): la caja no escribe
+// color ni profundidad, solo cuenta las muestras que pasan el depth test.
+// Vértices en [0,1]^3; World lleva la caja a la AABB en mundo del actor.
+//--------------------------------------------------------------------------------------
+cbuffer cbNeverChanges : register( b0 )
+{
+    matrix View;
+};
+
+cbuffer cbChangeOnResize : register( b1 )
+{
+    matrix Projection;
+};
+
+cbuffer cbChangesEveryFrame : register( b2 )
+{
+    matrix World;
+    float4 vMeshColor;
+};
+
+//--------------------------------------------------------------------------------------
+struct VS_INPUT
+{
+    float3 Pos : POSITION;
+};
+
+//--------------------------------------------------------------------------------------
+// Vertex Shader
+//--------------------------------------------------------------------------------------
+float4 VS( VS_INPUT input ) : SV_POSITION
+{
+    float4 pos = mul( float4( input.Pos, 1.0f ), World );
+    pos = mul( pos, View );
+    pos = mul( pos, Projection );
+    return pos;
+}
@@ -0,0 +1,48 @@
+//--------------------------------------------------------------------------------------
+// File: Picking.fx
+//
+// Picking con el ratón: escribe el identificador del actor en un target R32_UINT de
+// 1x1 (ver GpuPicking). Lee el stream compacto de posiciones, como DepthOnly.fx, y usa
+// los mismos constant buffers (b0 vista, b1 proyección del píxel, b2 mundo); el
+// identificador llega en vMeshColor.x.
+//--------------------------------------------------------------------------------------
+cbuffer cbNeverChanges : register( b0 )
+{
+    matrix View;
+};
+
+cbuffer cbChangeOnResize : register( b1 )
+{
+    matrix Projection;
+};
+
+cbuffer cbChangesEveryFrame : register( b2 )
+{
+    matrix World;
+    float4 vMeshColor;
+};
+
+//--------------------------------------------------------------------------------------
+struct VS_INPUT
+{
+    float4 Pos : POSITION;
+};
+
+//--------------------------------------------------------------------------------------
+// Vertex Shader
+//--------------------------------------------------------------------------------------
+float4 VS( VS_INPUT input ) : SV_POSITION
+{
+    float4 pos = mul( input.Pos, World );
+    pos = mul( pos, View );
+    pos = mul( pos, Projection );
+    return pos;
+}
+
+//--------------------------------------------------------------------------------------
+// Pixel Shader
+//--------------------------------------------------------------------------------------
+uint PS( float4 pos : SV_POSITION ) : SV_Target
+{
+    return (uint)vMeshColor.x;
+}
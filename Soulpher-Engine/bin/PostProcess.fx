@@ -0,0 +1,231 @@
+//--------------------------------------------------------------------------------------
+// File: PostProcess.fx
+//
+// Cadena HDR (PostProcess.cpp): bloom por pirámide en compute, exposición automática
+// por histograma y un único pase que aplica exposición, curva, gamma y compone la UI
+// sobre el back buffer.
+//--------------------------------------------------------------------------------------
+#include "Upscale.fxh"
+
+cbuffer cbPost : register( b6 )
+{
+    float4 PostSize;        // xy = destino en píxeles, zw = origen
+    float4 BloomParams;     // x = umbral, y = rodilla (fracción del umbral), z = intensidad, w = 1: prefiltro
+    float4 ExposureParams;  // x = log2 mínimo, y = rango log2, z = adaptación del frame [0, 1], w = compensación (EV)
+    float4 ToneParams;      // x = 1 / gamma, y = exposición fija, z = 1: automática, w = 1: compone la UI
+};
+
+#define BLOOM_TILE 8
+#define DOWN_TILE ( BLOOM_TILE * 2 + 2 )
+#define HISTOGRAM_BINS 256
+
+float Luminance( float3 color )
+{
+    return dot( color, float3( 0.2126f, 0.7152f, 0.0722f ) );
+}
+
+//--------------------------------------------------------------------------------------
+// Bloom
+//--------------------------------------------------------------------------------------
+Texture2D<float3> PostSource    : register( t0 );
+Texture2D<float3> PostSourceLow : register( t1 );
+RWTexture2D<float3> PostTarget  : register( u0 );
+
+groupshared float3 DownTile[ DOWN_TILE * DOWN_TILE ];
+groupshared float3 UpTile[ BLOOM_TILE * BLOOM_TILE ];
+
+// Umbral con rodilla cuadrática (sin corte brusco) y tope contra píxeles sueltos muy brillantes.
+float3 Prefilter( float3 color )
+{
+    float brightness = max( color.r, max( color.g, color.b ) );
+    float knee = BloomParams.x * BloomParams.y + 1e-4f;
+    float soft = clamp( brightness - BloomParams.x + knee, 0.0f, 2.0f * knee );
+    soft = soft * soft / ( 4.0f * knee );
+    float contribution = max( soft, brightness - BloomParams.x ) / max( brightness, 1e-4f );
+    return min( color * contribution, 64.0f );
+}
+
+// Mitad de resolución con un filtro 4x4 (1 3 3 1 por eje). El grupo carga en memoria
+// compartida los (2 * 8 + 2)^2 texels de origen que usan sus 8x8 salidas.
+[numthreads( BLOOM_TILE, BLOOM_TILE, 1 )]
+void CSBloomDown( uint3 groupId : SV_GroupID, uint3 threadId : SV_GroupThreadID, uint threadIndex : SV_GroupIndex )
+{
+    int2 sourceSize = int2( PostSize.zw );
+    int2 origin = int2( groupId.xy ) * ( BLOOM_TILE * 2 ) - 1;
+    for ( uint i = threadIndex; i < DOWN_TILE * DOWN_TILE; i += BLOOM_TILE * BLOOM_TILE )
+    {
+        float3 color = PostSource[ clamp( origin + int2( i % DOWN_TILE, i / DOWN_TILE ), 0, sourceSize - 1 ) ];
+        DownTile[ i ] = BloomParams.w > 0.5f ? Prefilter( color ) : color;
+    }
+    GroupMemoryBarrierWithGroupSync();
+
+    uint2 pixel = groupId.xy * BLOOM_TILE + threadId.xy;
+    if ( any( pixel >= uint2( PostSize.xy ) ) )
+        return;
+
+    const float weights[ 4 ] = { 0.125f, 0.375f, 0.375f, 0.125f };
+    float3 sum = float3( 0.0f, 0.0f, 0.0f );
+    for ( uint y = 0; y < 4; ++y )
+    {
+        for ( uint x = 0; x < 4; ++x )
+        {
+            sum += DownTile[ ( threadId.y * 2 + y ) * DOWN_TILE + threadId.x * 2 + x ] * ( weights[ x ] * weights[ y ] );
+        }
+    }
+    PostTarget[ pixel ] = sum;
+}
+
+float3 UpTexel( int2 local )
+{
+    local = clamp( local, 0, BLOOM_TILE - 1 );
+    return UpTile[ local.y * BLOOM_TILE + local.x ];
+}
+
+float3 UpBilinear( float2 coord )
+{
+    float2 base = floor( coord );
+    float2 f = coord - base;
+    int2 texel = int2( base );
+    return lerp( lerp( UpTexel( texel ), UpTexel( texel + int2( 1, 0 ) ), f.x ),
+                 lerp( UpTexel( texel + int2( 0, 1 ) ), UpTexel( texel + int2( 1, 1 ) ), f.x ), f.y );
+}
+
+// Doble de resolución: nivel propio (t0) + nivel grueso (t1) con un filtro tienda 3x3.
+// Los 8x8 píxeles del grupo caen en 4x4 texels gruesos; con el filtro y el bilineal
+// necesitan 8x8, uno por hilo.
+[numthreads( BLOOM_TILE, BLOOM_TILE, 1 )]
+void CSBloomUp( uint3 groupId : SV_GroupID, uint3 threadId : SV_GroupThreadID, uint threadIndex : SV_GroupIndex )
+{
+    int2 lowSize = int2( PostSize.zw );
+    int2 origin = int2( groupId.xy ) * ( BLOOM_TILE / 2 ) - 2;
+    UpTile[ threadIndex ] = PostSourceLow[ clamp( origin + int2( threadId.xy ), 0, lowSize - 1 ) ];
+    GroupMemoryBarrierWithGroupSync();
+
+    uint2 pixel = groupId.xy * BLOOM_TILE + threadId.xy;
+    if ( any( pixel >= uint2( PostSize.xy ) ) )
+        return;
+
+    // Centro del píxel en texels gruesos, relativo al origen del grupo: [1.75, 5.25].
+    float2 coord = ( float2( pixel ) + 0.5f ) * 0.5f - 0.5f - float2( origin );
+    float3 blurred = float3( 0.0f, 0.0f, 0.0f );
+    for ( int y = -1; y <= 1; ++y )
+    {
+        for ( int x = -1; x <= 1; ++x )
+        {
+            float weight = ( 2.0f - abs( x ) ) * ( 2.0f - abs( y ) ) / 16.0f;
+            blurred += UpBilinear( coord + float2( x, y ) ) * weight;
+        }
+    }
+    PostTarget[ pixel ] = PostSource[ pixel ] + blurred;
+}
+
+//--------------------------------------------------------------------------------------
+// Exposición automática
+//--------------------------------------------------------------------------------------
+RWByteAddressBuffer Histogram : register( u1 );   // HISTOGRAM_BINS contadores
+RWBuffer<float> Exposure      : register( u2 );   // [0] = exposición, [1] = luminancia media
+
+groupshared uint SharedBins[ HISTOGRAM_BINS ];
+groupshared float SharedSums[ HISTOGRAM_BINS ];
+
+// Histograma de log2( luminancia ): cada grupo cuenta en memoria compartida y suma
+// al global solo sus cubetas no vacías. La cubeta 0 son los píxeles negros.
+[numthreads( 16, 16, 1 )]
+void CSHistogram( uint3 pixelId : SV_DispatchThreadID, uint threadIndex : SV_GroupIndex )
+{
+    SharedBins[ threadIndex ] = 0;
+    GroupMemoryBarrierWithGroupSync();
+
+    if ( all( pixelId.xy < uint2( PostSize.xy ) ) )
+    {
+        float luminance = Luminance( PostSource[ pixelId.xy ] );
+        uint bin = 0;
+        if ( luminance > 1e-5f )
+        {
+            float t = saturate( ( log2( luminance ) - ExposureParams.x ) / ExposureParams.y );
+            bin = (uint)( t * ( HISTOGRAM_BINS - 2 ) + 1.0f );
+        }
+        InterlockedAdd( SharedBins[ bin ], 1 );
+    }
+    GroupMemoryBarrierWithGroupSync();
+
+    if ( SharedBins[ threadIndex ] != 0 )
+        Histogram.InterlockedAdd( threadIndex * 4, SharedBins[ threadIndex ] );
+}
+
+// Un grupo: media del histograma por reducción en memoria compartida, exposición
+// objetivo (gris medio 0.18) y adaptación hacia ella. Deja el histograma a cero.
+[numthreads( HISTOGRAM_BINS, 1, 1 )]
+void CSExposure( uint threadIndex : SV_GroupIndex )
+{
+    uint count = Histogram.Load( threadIndex * 4 );
+    Histogram.Store( threadIndex * 4, 0 );
+    SharedSums[ threadIndex ] = count * (float)threadIndex;
+    GroupMemoryBarrierWithGroupSync();
+
+    for ( uint stride = HISTOGRAM_BINS / 2; stride > 0; stride >>= 1 )
+    {
+        if ( threadIndex < stride )
+            SharedSums[ threadIndex ] += SharedSums[ threadIndex + stride ];
+        GroupMemoryBarrierWithGroupSync();
+    }
+
+    if ( threadIndex == 0 )
+    {
+        // `count` es aquí la cubeta de negros: no cuenta para la media.
+        float lit = PostSize.x * PostSize.y - (float)count;
+        if ( lit < 1.0f )
+            return;
+        float averageBin = SharedSums[ 0 ] / lit - 1.0f;
+        float average = exp2( averageBin / ( HISTOGRAM_BINS - 2 ) * ExposureParams.y + ExposureParams.x );
+        float target = 0.18f / average * exp2( ExposureParams.w );
+        float previous = Exposure[ 0 ];
+        Exposure[ 0 ] = previous + ( target - previous ) * ExposureParams.z;
+        Exposure[ 1 ] = average;
+    }
+}
+
+//--------------------------------------------------------------------------------------
+// Exposición + curva + gamma + UI en un pase (triángulo a pantalla completa)
+//--------------------------------------------------------------------------------------
+Texture2D<float3> SceneColor   : register( t0 );
+Texture2D<float3> BloomColor   : register( t1 );
+Buffer<float> ExposureValue    : register( t2 );
+Texture2D<float4> Interface    : register( t3 );  // premultiplicada (ImGui sobre negro transparente)
+SamplerState PostSampler       : register( s0 );
+
+struct TONEMAP_OUTPUT
+{
+    float4 Pos : SV_POSITION;
+    float2 Tex : TEXCOORD0;
+};
+
+TONEMAP_OUTPUT VSTonemap( uint id : SV_VertexID )
+{
+    TONEMAP_OUTPUT output;
+    output.Tex = float2( ( id << 1 ) & 2, id & 2 );
+    output.Pos = float4( output.Tex.x * 2.0f - 1.0f, 1.0f - output.Tex.y * 2.0f, 0.0f, 1.0f );
+    return output;
+}
+
+// Ajuste de la curva ACES (Narkowicz, 2015).
+float3 Filmic( float3 x )
+{
+    return saturate( ( x * ( 2.51f * x + 0.03f ) ) / ( x * ( 2.43f * x + 0.59f ) + 0.14f ) );
+}
+
+float4 PSTonemap( TONEMAP_OUTPUT input ) : SV_Target
+{
+    // La escena puede venir a menor resolución (DynamicResolution): se sube aquí.
+    int2 pixel = int2( input.Pos.xy );
+    float exposure = ToneParams.z > 0.5f ? ExposureValue[ 0 ] : ToneParams.y;
+    float3 hdr = SampleCatmullRom( SceneColor, PostSampler, input.Tex )
+               + BloomColor.SampleLevel( PostSampler, input.Tex, 0 ) * BloomParams.z;
+    float3 color = pow( Filmic( hdr * exposure ), ToneParams.x );
+    if ( ToneParams.w > 0.5f )
+    {
+        float4 ui = Interface[ pixel ];
+        color = color * ( 1.0f - ui.a ) + ui.rgb;
+    }
+    return float4( color, 1.0f );
+}
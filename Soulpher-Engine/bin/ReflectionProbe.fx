@@ -0,0 +1,90 @@
+//--------------------------------------------------------------------------------------
+// File: ReflectionProbe.fx
+//
+// Prefiltrado de una sonda de reflexión (ReflectionProbes.cpp). La cara capturada se
+// copia al mip 0 del array; cada mip siguiente integra el cubo capturado con la
+// distribución GGX de su rugosidad (muestreo por importancia, secuencia de Hammersley,
+// aproximación N = V = R). Cada muestra lee el mip del cubo cuyo texel cubre el ángulo
+// sólido que le toca, lo que evita el ruido con pocas muestras.
+// Un grupo de 8x8 texeles de una cara; z del dispatch = cara.
+//--------------------------------------------------------------------------------------
+#define PREFILTER_TILE 8
+#define PREFILTER_SAMPLES 64
+#define PI 3.14159265f
+
+TextureCube<float4> Capture : register( t0 );     // con mips (GenerateMips)
+SamplerState samCapture : register( s0 );
+RWTexture2DArray<float4> Target : register( u0 );  // un mip del array de sondas
+
+cbuffer cbPrefilter : register( b10 )
+{
+    float4 PrefilterParams;  // x = rugosidad, y = lado del mip destino, z = primer slice (sonda * 6), w = lado del cubo
+};
+
+// Dirección de mundo del centro de un texel de una cara (orden de D3D: +X, -X, +Y, -Y, +Z, -Z).
+float3 FaceDirection( uint face, float2 uv )
+{
+    float u = uv.x * 2.0f - 1.0f;
+    float v = uv.y * 2.0f - 1.0f;
+    switch ( face )
+    {
+    case 0:  return normalize( float3( 1.0f, -v, -u ) );
+    case 1:  return normalize( float3( -1.0f, -v, u ) );
+    case 2:  return normalize( float3( u, 1.0f, v ) );
+    case 3:  return normalize( float3( u, -1.0f, -v ) );
+    case 4:  return normalize( float3( u, -v, 1.0f ) );
+    default: return normalize( float3( -u, -v, -1.0f ) );
+    }
+}
+
+float2 Hammersley( uint i, uint count )
+{
+    return float2( (float)i / count, reversebits( i ) * 2.3283064365386963e-10f );
+}
+
+// Semivector H alrededor de N con la distribución GGX de `alpha` (= rugosidad^2).
+float3 ImportanceSampleGGX( float2 xi, float alpha, float3 N )
+{
+    float phi = 2.0f * PI * xi.x;
+    float cosTheta = sqrt( ( 1.0f - xi.y ) / ( 1.0f + ( alpha * alpha - 1.0f ) * xi.y ) );
+    float sinTheta = sqrt( 1.0f - cosTheta * cosTheta );
+    float3 h = float3( sinTheta * cos( phi ), sinTheta * sin( phi ), cosTheta );
+    float3 up = abs( N.y ) < 0.999f ? float3( 0.0f, 1.0f, 0.0f ) : float3( 1.0f, 0.0f, 0.0f );
+    float3 tangent = normalize( cross( up, N ) );
+    float3 bitangent = cross( N, tangent );
+    return tangent * h.x + bitangent * h.y + N * h.z;
+}
+
+[numthreads( PREFILTER_TILE, PREFILTER_TILE, 1 )]
+void CSPrefilter( uint3 id : SV_DispatchThreadID )
+{
+    uint size = (uint)PrefilterParams.y;
+    if ( any( id.xy >= size ) )
+        return;
+
+    float3 N = FaceDirection( id.z, ( id.xy + 0.5f ) / size );
+    float alpha = max( PrefilterParams.x * PrefilterParams.x, 1e-3f );
+    float alpha2 = alpha * alpha;
+    float texelSolidAngle = 4.0f * PI / ( 6.0f * PrefilterParams.w * PrefilterParams.w );
+
+    float3 sum = float3( 0.0f, 0.0f, 0.0f );
+    float weight = 0.0f;
+    for ( uint i = 0; i < PREFILTER_SAMPLES; ++i )
+    {
+        float3 H = ImportanceSampleGGX( Hammersley( i, PREFILTER_SAMPLES ), alpha, N );
+        float NdotH = saturate( dot( N, H ) );
+        float3 L = 2.0f * NdotH * H - N;
+        float NdotL = dot( N, L );
+        if ( NdotL > 0.0f )
+        {
+            // pdf = D * NdotH / ( 4 * VdotH ) con V = N: D / 4.
+            float d = NdotH * NdotH * ( alpha2 - 1.0f ) + 1.0f;
+            float pdf = alpha2 / ( PI * d * d ) * 0.25f;
+            float sampleSolidAngle = 1.0f / ( PREFILTER_SAMPLES * pdf + 1e-4f );
+            float lod = max( 0.5f * log2( sampleSolidAngle / texelSolidAngle ) + 1.0f, 0.0f );
+            sum += Capture.SampleLevel( samCapture, L, lod ).rgb * NdotL;
+            weight += NdotL;
+        }
+    }
+    Target[ uint3( id.xy, (uint)PrefilterParams.z + id.z ) ] = float4( sum / max( weight, 1e-4f ), 1.0f );
+}
@@ -0,0 +1,29 @@
+//--------------------------------------------------------------------------------------
+// File: Scalability.fx
+//
+// Micro-benchmark de arranque (Scalability.cpp): relleno con triángulos a pantalla
+// completa y rendimiento de vértices con triángulos que el rasterizador descarta.
+//--------------------------------------------------------------------------------------
+
+// Triángulo a pantalla completa con SV_VertexID (sin vertex buffer).
+float4 VSFill( uint id : SV_VertexID ) : SV_POSITION
+{
+    float2 tex = float2( ( id << 1 ) & 2, id & 2 );
+    return float4( tex.x * 2.0f - 1.0f, 1.0f - tex.y * 2.0f, 0.0f, 1.0f );
+}
+
+// Un color que depende de la posición: el driver no puede tratarlo como un clear.
+float4 PSFill( float4 pos : SV_POSITION ) : SV_Target
+{
+    return float4( frac( pos.xy * 0.0009765625f ), 0.5f, 1.0f );
+}
+
+// Algo de cálculo por vértice y todo fuera del volumen de recorte (x > w): se transforma
+// y se descarta cada triángulo sin generar píxeles.
+float4 VSVertex( uint id : SV_VertexID ) : SV_POSITION
+{
+    float angle = id * 0.001f;
+    float2 offset;
+    sincos( angle, offset.y, offset.x );
+    return float4( 2.0f + offset.x * 0.5f, offset.y, 0.5f, 1.0f );
+}
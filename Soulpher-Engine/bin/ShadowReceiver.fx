@@ -0,0 +1,126 @@
+//--------------------------------------------------------------------------------------
+// File: ShadowReceiver.fx
+//
+// Variante del shader principal para actores que reciben sombra. Mismos recursos que
+// Soulpher-Engine.fx (b0 vista, b1 proyección, b2 mundo + color, t0 difusa, s0 sampler)
+// más las cascadas de sombra de ShadowMap.cpp (b3 cbShadow, t1 array de cascadas,
+// s1 sampler de comparación).
+//
+// IMPORTANTE: la posición en pantalla se calcula igual, operación por operación, que en
+// DepthOnly.fx; el pase principal compara con EQUAL tras el pre-pase de profundidad.
+//
+// Con ALPHA_TEST definido (MATERIAL_ALPHA_TESTED) descarta los píxeles con alfa bajo
+// el umbral del material (b4).
+//
+// Suma las luces locales de su cluster (ClusteredLights.fxh: t4-t6, b5).
+//--------------------------------------------------------------------------------------
+Texture2D txDiffuse : register( t0 );
+Texture2DArray txShadow : register( t1 );
+SamplerState samLinear : register( s0 );
+SamplerComparisonState samShadow : register( s1 );
+
+cbuffer cbNeverChanges : register( b0 )
+{
+    matrix View;
+};
+
+cbuffer cbChangeOnResize : register( b1 )
+{
+    matrix Projection;
+};
+
+cbuffer cbChangesEveryFrame : register( b2 )
+{
+    matrix World;
+    float4 vMeshColor;
+};
+
+cbuffer cbShadow : register( b3 )
+{
+    matrix LightViewProj[4]; // una por cascada (ShadowMap::kCascadeCount)
+    float4 CascadeSplits;    // profundidad en vista donde termina cada cascada
+    float4 ShadowParams;     // x = 1 / tamaño de cascada, y = sesgo, z = intensidad
+};
+
+cbuffer cbMaterial : register( b4 )
+{
+    float4 vDiffuseColor;    // MaterialLibrary (inmutable, multiplica el color del objeto)
+    float4 vMaterialParams;  // x = umbral de alpha test (solo con ALPHA_TEST), y = rugosidad (G-buffer)
+};
+
+#include "ClusteredLights.fxh"
+
+//--------------------------------------------------------------------------------------
+struct VS_INPUT
+{
+    float4 Pos : POSITION;
+    float2 Tex : TEXCOORD0;
+};
+
+struct PS_INPUT
+{
+    float4 Pos      : SV_POSITION;
+    float2 Tex      : TEXCOORD0;
+    float3 WorldPos : TEXCOORD1;
+    float  ViewZ    : TEXCOORD2;
+};
+
+//--------------------------------------------------------------------------------------
+// Elige la cascada por la profundidad en vista y proyecta el píxel en su capa.
+// PCF 3x3: cada SampleCmp ya filtra 2x2 texels, así que 9 muestras cubren 4x4.
+// Devuelve 1 si el punto está iluminado y 0 si está en sombra por completo.
+//--------------------------------------------------------------------------------------
+float ShadowFactor( float3 worldPos, float viewZ )
+{
+    // Cascada = número de cortes que ya quedaron por delante del píxel.
+    float4 beyond = step( CascadeSplits, viewZ.xxxx );
+    uint cascade = (uint)dot( beyond, float4( 1.0f, 1.0f, 1.0f, 1.0f ) );
+    if ( cascade >= 4 )
+        return 1.0f; // más allá de la distancia de sombra
+
+    float4 lightPos = mul( float4( worldPos, 1.0f ), LightViewProj[cascade] );
+    float3 ndc = lightPos.xyz / lightPos.w;
+    if ( ndc.z > 1.0f )
+        return 1.0f; // más allá del volumen de la luz
+    float2 uv = float2( 0.5f * ndc.x + 0.5f, -0.5f * ndc.y + 0.5f );
+    float depth = ndc.z - ShadowParams.y;
+
+    float lit = 0.0f;
+    [unroll] for ( int y = -1; y <= 1; ++y )
+    {
+        [unroll] for ( int x = -1; x <= 1; ++x )
+        {
+            float3 coord = float3( uv + float2( x, y ) * ShadowParams.x, cascade );
+            lit += txShadow.SampleCmpLevelZero( samShadow, coord, depth );
+        }
+    }
+    return lit / 9.0f;
+}
+
+//--------------------------------------------------------------------------------------
+// Vertex Shader
+//--------------------------------------------------------------------------------------
+PS_INPUT VS( VS_INPUT input )
+{
+    PS_INPUT output = (PS_INPUT)0;
+    float4 worldPos = mul( input.Pos, World );
+    output.Pos = mul( worldPos, View );
+    output.ViewZ = output.Pos.z;
+    output.Pos = mul( output.Pos, Projection );
+    output.WorldPos = worldPos.xyz;
+    output.Tex = input.Tex;
+    return output;
+}
+
+//--------------------------------------------------------------------------------------
+// Pixel Shader
+//--------------------------------------------------------------------------------------
+SurfaceOutput PS( PS_INPUT input )
+{
+    float shade = lerp( 1.0f - ShadowParams.z, 1.0f, ShadowFactor( input.WorldPos, input.ViewZ ) );
+    float4 color = txDiffuse.Sample( samLinear, input.Tex ) * vMeshColor * vDiffuseColor;
+#ifdef ALPHA_TEST
+    clip( color.a - vMaterialParams.x );
+#endif
+    return ShadeSurface( input.Pos, input.WorldPos, input.ViewZ, color, shade, vMaterialParams.y );
+}
@@ -0,0 +1,165 @@
+//--------------------------------------------------------------------------------------
+// File: ShadowReceiverInstanced.fx
+//
+// ShadowReceiver.fx para lotes instanciados: mundo y color llegan por instancia desde
+// el vertex buffer del slot 1 (mismo layout que Instancing.fx). El resto de recursos
+// es el de ShadowReceiver.fx (b3 cbShadow, t1 array de cascadas, s1 comparación).
+// TEXTURE_ARRAY: difusa en un Texture2DArray con la capa por instancia (ver Instancing.fx).
+// GPU_DRIVEN: instancias leídas de la lista de visibles (t2/t3, ver Instancing.fx).
+// ALPHA_TEST: recorte por el umbral del material (b4, ver Instancing.fx).
+// Luces locales por clusters como ShadowReceiver.fx (ClusteredLights.fxh).
+//--------------------------------------------------------------------------------------
+#ifdef TEXTURE_ARRAY
+Texture2DArray txDiffuse : register( t0 );
+#else
+Texture2D txDiffuse : register( t0 );
+#endif
+Texture2DArray txShadow : register( t1 );
+SamplerState samLinear : register( s0 );
+SamplerComparisonState samShadow : register( s1 );
+#ifdef GPU_DRIVEN
+// Camino GPU-driven (GpuCulling.fx): el slot 1 trae el hueco de la lista de visibles
+// (StartInstanceLocation + SV_InstanceID) y los datos se leen de la lista de instancias.
+struct Instance
+{
+    row_major float4x4 World;
+    float4 Color;
+    float3 BoundsMin;
+    uint   Group;
+    float3 BoundsMax;
+    uint   Pad;
+};
+StructuredBuffer<Instance> Instances : register( t2 );
+StructuredBuffer<uint> VisibleList : register( t3 );
+#endif
+
+cbuffer cbNeverChanges : register( b0 )
+{
+    matrix View;
+};
+
+cbuffer cbChangeOnResize : register( b1 )
+{
+    matrix Projection;
+};
+
+cbuffer cbShadow : register( b3 )
+{
+    matrix LightViewProj[4]; // una por cascada (ShadowMap::kCascadeCount)
+    float4 CascadeSplits;    // profundidad en vista donde termina cada cascada
+    float4 ShadowParams;     // x = 1 / tamaño de cascada, y = sesgo, z = intensidad
+};
+
+cbuffer cbMaterial : register( b4 )
+{
+    float4 vDiffuseColor;    // MaterialLibrary (inmutable, multiplica el color del objeto)
+    float4 vMaterialParams;  // x = umbral de alpha test (solo con ALPHA_TEST), y = rugosidad (G-buffer)
+};
+
+#include "ClusteredLights.fxh"
+
+//--------------------------------------------------------------------------------------
+struct VS_INPUT
+{
+    float4 Pos    : POSITION;
+    float2 Tex    : TEXCOORD0;
+#ifdef GPU_DRIVEN
+    uint   Slot   : INSTANCE_SLOT0;
+#else
+    float4 World0 : INSTANCE_WORLD0;
+    float4 World1 : INSTANCE_WORLD1;
+    float4 World2 : INSTANCE_WORLD2;
+    float4 World3 : INSTANCE_WORLD3;
+    float4 Color  : INSTANCE_COLOR0;
+#endif
+#ifdef TEXTURE_ARRAY
+    uint   Slice  : INSTANCE_SLICE0;
+#endif
+};
+
+struct PS_INPUT
+{
+    float4 Pos      : SV_POSITION;
+    float2 Tex      : TEXCOORD0;
+    float3 WorldPos : TEXCOORD1;
+    float  ViewZ    : TEXCOORD2;
+    float4 Color    : COLOR0;
+#ifdef TEXTURE_ARRAY
+    nointerpolation float Slice : TEXCOORD3;
+#endif
+};
+
+//--------------------------------------------------------------------------------------
+// Cascada por profundidad en vista + PCF 3x3 (ver ShadowReceiver.fx).
+//--------------------------------------------------------------------------------------
+float ShadowFactor( float3 worldPos, float viewZ )
+{
+    // Cascada = número de cortes que ya quedaron por delante del píxel.
+    float4 beyond = step( CascadeSplits, viewZ.xxxx );
+    uint cascade = (uint)dot( beyond, float4( 1.0f, 1.0f, 1.0f, 1.0f ) );
+    if ( cascade >= 4 )
+        return 1.0f; // más allá de la distancia de sombra
+
+    float4 lightPos = mul( float4( worldPos, 1.0f ), LightViewProj[cascade] );
+    float3 ndc = lightPos.xyz / lightPos.w;
+    if ( ndc.z > 1.0f )
+        return 1.0f; // más allá del volumen de la luz
+    float2 uv = float2( 0.5f * ndc.x + 0.5f, -0.5f * ndc.y + 0.5f );
+    float depth = ndc.z - ShadowParams.y;
+
+    float lit = 0.0f;
+    [unroll] for ( int y = -1; y <= 1; ++y )
+    {
+        [unroll] for ( int x = -1; x <= 1; ++x )
+        {
+            float3 coord = float3( uv + float2( x, y ) * ShadowParams.x, cascade );
+            lit += txShadow.SampleCmpLevelZero( samShadow, coord, depth );
+        }
+    }
+    return lit / 9.0f;
+}
+
+//--------------------------------------------------------------------------------------
+// Vertex Shader
+//--------------------------------------------------------------------------------------
+PS_INPUT VS( VS_INPUT input )
+{
+    PS_INPUT output = (PS_INPUT)0;
+    // Igual que Instancing.fx: las filas recibidas son las columnas del mundo.
+#ifdef GPU_DRIVEN
+    Instance instance = Instances[ VisibleList[ input.Slot ] ];
+    float4x4 world = instance.World;
+    float4 color = instance.Color;
+#else
+    float4x4 world = float4x4( input.World0, input.World1, input.World2, input.World3 );
+    float4 color = input.Color;
+#endif
+    float4 worldPos = mul( world, float4( input.Pos.xyz, 1.0f ) );
+    output.Pos = mul( worldPos, View );
+    output.ViewZ = output.Pos.z;
+    output.Pos = mul( output.Pos, Projection );
+    output.WorldPos = worldPos.xyz;
+    output.Tex = input.Tex;
+    output.Color = color;
+#ifdef TEXTURE_ARRAY
+    output.Slice = (float)input.Slice;
+#endif
+    return output;
+}
+
+//--------------------------------------------------------------------------------------
+// Pixel Shader
+//--------------------------------------------------------------------------------------
+SurfaceOutput PS( PS_INPUT input )
+{
+    float shade = lerp( 1.0f - ShadowParams.z, 1.0f, ShadowFactor( input.WorldPos, input.ViewZ ) );
+#ifdef TEXTURE_ARRAY
+    float4 color = txDiffuse.Sample( samLinear, float3( input.Tex, input.Slice ) ) * input.Color * vDiffuseColor;
+#else
+    float4 color = txDiffuse.Sample( samLinear, input.Tex ) * input.Color * vDiffuseColor;
+#endif
+#ifdef ALPHA_TEST
+    clip( color.a - vMaterialParams.x );
+#endif
+    return ShadeSurface( input.Pos, input.WorldPos, input.ViewZ, color, shade, vMaterialParams.y );
+}
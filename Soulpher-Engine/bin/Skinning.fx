@@ -0,0 +1,155 @@
+//--------------------------------------------------------------------------------------
+// File: Skinning.fx
+//
+// Skinning en compute (ver SkinningSystem.h). Un hilo por vértice de una página de
+// la malla de un actor:
+// 1) Lee la posición de enlace y sus 4 huesos/pesos (UNORM8 que suman 255).
+// 2) Mezcla las matrices de la paleta (float3x4, mundo del modelo <- enlace) y
+//    transforma la posición.
+// 3) La escribe con el formato del vertex buffer (VertexFormat) en el stream
+//    completo (sin tocar las UV) y en el de solo posiciones. Los pases de
+//    sombra, pre-pase y principal leen esos buffers sin saber que hubo skinning.
+//
+// Blend shapes (CSMorph, antes que CSSkin en la misma malla): un hilo por delta de
+// las formas activas suma delta * peso en el acumulador de su vértice (punto fijo,
+// varias formas pueden mover el mismo). CSSkin lo suma a la posición de enlace
+// antes del paso 2 y lo deja a 0.
+//--------------------------------------------------------------------------------------
+
+// Mismo layout que SkinningSystem::SourceVertex.
+struct SourceVertex
+{
+    float3 Position;
+    uint   Bones;     // 4 x uint8
+    uint   Weights;   // 4 x uint8
+    uint   MorphSlot; // acumulador de blend shapes (0xFFFFFFFF = ninguno)
+};
+
+// Mismo layout que SkinningSystem::MorphBatch / MorphDelta.
+struct MorphBatch
+{
+    uint  FirstDelta;
+    uint  DeltaCount;
+    uint  FirstThread;
+    float Weight;
+};
+
+struct MorphDelta
+{
+    uint   Slot;
+    float3 Delta;
+};
+
+StructuredBuffer<float4> Palette : register( t0 );       // 3 float4 (filas) por hueso
+StructuredBuffer<SourceVertex> Sources : register( t1 );
+StructuredBuffer<MorphBatch> Batches : register( t2 );   // formas activas del frame
+StructuredBuffer<MorphDelta> Deltas : register( t3 );    // de la malla, cada forma contigua
+RWByteAddressBuffer Vertices : register( u0 );           // stream completo (slot 0)
+RWByteAddressBuffer Positions : register( u1 );          // stream de solo posiciones
+RWByteAddressBuffer MorphOffsets : register( u2 );       // int3 por acumulador
+
+// Unidades de modelo por paso del acumulador: 1/65536 deja ±32768 de rango.
+static const float kMorphFixedScale = 65536.0f;
+
+cbuffer cbSkin : register( b0 )
+{
+    uint   VertexCount;
+    uint   FirstSource;    // primer vértice de la página en Sources
+    uint   FirstJoint;     // primera fila/3 de la paleta del actor en Palette
+    uint   VertexStride;
+    uint   PositionStride;
+    uint   Snorm16;        // 1 = POSITION_SNORM16, 0 = POSITION_FLOAT32
+    uint   Morphed;        // 1 = sumar los acumuladores (CSMorph corrió)
+    uint   MorphThreads;   // deltas de las formas activas (hilos de CSMorph)
+    float4 DecodeOffset;   // centro de la AABB de cuantización (xyz)
+    float4 DecodeScale;    // semiextensión (xyz)
+    uint   FirstBatch;     // lotes de la malla en Batches
+    uint   BatchCount;
+    uint2  Pad;
+};
+
+uint PackSnorm16( float a, float b )
+{
+    int2 q = int2( round( clamp( float2( a, b ), -1.0f, 1.0f ) * 32767.0f ) );
+    return ( uint( q.x ) & 0xFFFF ) | ( uint( q.y ) << 16 );
+}
+
+void StorePosition( RWByteAddressBuffer target, uint address, float3 p )
+{
+    if ( Snorm16 != 0 )
+    {
+        float3 q = ( p - DecodeOffset.xyz ) / DecodeScale.xyz;
+        // w = 1 (32767), como VertexFormat::encode.
+        target.Store2( address, uint2( PackSnorm16( q.x, q.y ), PackSnorm16( q.z, 1.0f ) ) );
+    }
+    else
+    {
+        target.Store3( address, asuint( p ) );
+    }
+}
+
+[numthreads( 64, 1, 1 )]
+void CSSkin( uint3 id : SV_DispatchThreadID )
+{
+    if ( id.x >= VertexCount )
+        return;
+
+    SourceVertex source = Sources[ FirstSource + id.x ];
+    if ( Morphed != 0 && source.MorphSlot != 0xFFFFFFFF )
+    {
+        uint address = source.MorphSlot * 12;
+        int3 offset = asint( MorphOffsets.Load3( address ) );
+        source.Position += float3( offset ) / kMorphFixedScale;
+        MorphOffsets.Store3( address, uint3( 0, 0, 0 ) );
+    }
+    float4 weights = float4( source.Weights & 0xFF, ( source.Weights >> 8 ) & 0xFF,
+                             ( source.Weights >> 16 ) & 0xFF, source.Weights >> 24 ) / 255.0f;
+    uint4 bones = uint4( source.Bones & 0xFF, ( source.Bones >> 8 ) & 0xFF,
+                         ( source.Bones >> 16 ) & 0xFF, source.Bones >> 24 );
+
+    float3 position = source.Position;
+    // Sin influencias (peso 0) el vértice se queda en la pose de enlace.
+    if ( dot( weights, 1.0f ) > 0.0f )
+    {
+        float4 r0 = 0.0f, r1 = 0.0f, r2 = 0.0f;
+        [unroll]
+        for ( int i = 0; i < 4; ++i )
+        {
+            uint row = ( FirstJoint + bones[i] ) * 3;
+            r0 += Palette[ row + 0 ] * weights[i];
+            r1 += Palette[ row + 1 ] * weights[i];
+            r2 += Palette[ row + 2 ] * weights[i];
+        }
+        float4 p = float4( source.Position, 1.0f );
+        position = float3( dot( r0, p ), dot( r1, p ), dot( r2, p ) );
+    }
+
+    StorePosition( Vertices, id.x * VertexStride, position );
+    StorePosition( Positions, id.x * PositionStride, position );
+}
+
+[numthreads( 64, 1, 1 )]
+void CSMorph( uint3 id : SV_DispatchThreadID )
+{
+    if ( id.x >= MorphThreads )
+        return;
+
+    // Lote del hilo: el último con FirstThread <= id (búsqueda binaria, pocas formas).
+    uint lo = 0, hi = BatchCount - 1;
+    while ( lo < hi )
+    {
+        uint mid = ( lo + hi + 1 ) / 2;
+        if ( Batches[ FirstBatch + mid ].FirstThread <= id.x )
+            lo = mid;
+        else
+            hi = mid - 1;
+    }
+    MorphBatch batch = Batches[ FirstBatch + lo ];
+    MorphDelta delta = Deltas[ batch.FirstDelta + id.x - batch.FirstThread ];
+
+    int3 q = int3( round( delta.Delta * batch.Weight * kMorphFixedScale ) );
+    uint address = delta.Slot * 12;
+    MorphOffsets.InterlockedAdd( address + 0, asuint( q.x ) );
+    MorphOffsets.InterlockedAdd( address + 4, asuint( q.y ) );
+    MorphOffsets.InterlockedAdd( address + 8, asuint( q.z ) );
+}
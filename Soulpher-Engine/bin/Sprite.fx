@@ -0,0 +1,69 @@
+//--------------------------------------------------------------------------------------
+// File: Sprite.fx
+//
+// Sprites del HUD (ver SpriteBatch.h). Sin vertex buffer de geometría: la esquina del
+// quad sale de SV_VertexID (tira de 4) y el rectángulo en píxeles, las UV, el color,
+// la rotación y la capa del array llegan por instancia desde el slot 1.
+//
+// Con TEXTURE_ARRAY definido (TextureArrayPool), t0 es un Texture2DArray y cada
+// instancia muestrea su capa: un draw puede mezclar todas las texturas del array.
+//--------------------------------------------------------------------------------------
+#ifdef TEXTURE_ARRAY
+Texture2DArray txSprite : register( t0 );
+#else
+Texture2D txSprite : register( t0 );
+#endif
+SamplerState samClamp : register( s0 );
+
+cbuffer cbSprite : register( b2 )
+{
+    float4 Screen;  // x: 2 / ancho, y: 2 / alto (píxeles a NDC)
+};
+
+//--------------------------------------------------------------------------------------
+struct VS_INPUT
+{
+    float4 Rect   : SPRITE_RECT0;     // x, y, ancho, alto en píxeles
+    float4 UV     : SPRITE_UV0;       // u0, v0, u1, v1
+    float4 Color  : INSTANCE_COLOR0;
+    float4 Params : SPRITE_PARAMS0;   // x: rotación (rad), y: capa del array
+    uint VertexId : SV_VertexID;
+};
+
+struct PS_INPUT
+{
+    float4 Pos   : SV_POSITION;
+    float3 Tex   : TEXCOORD0;         // z: capa del array
+    float4 Color : COLOR0;
+};
+
+//--------------------------------------------------------------------------------------
+// Vertex Shader
+//--------------------------------------------------------------------------------------
+PS_INPUT VS( VS_INPUT input )
+{
+    const float2 corner = float2( input.VertexId & 1, input.VertexId >> 1 );
+    const float2 halfSize = input.Rect.zw * 0.5f;
+    float s, c;
+    sincos( input.Params.x, s, c );
+    const float2 local = ( corner - 0.5f ) * input.Rect.zw;
+    const float2 pixel = input.Rect.xy + halfSize + float2( local.x * c - local.y * s, local.x * s + local.y * c );
+
+    PS_INPUT output;
+    output.Pos = float4( pixel.x * Screen.x - 1.0f, 1.0f - pixel.y * Screen.y, 0.0f, 1.0f );
+    output.Tex = float3( lerp( input.UV.xy, input.UV.zw, corner ), input.Params.y );
+    output.Color = input.Color;
+    return output;
+}
+
+//--------------------------------------------------------------------------------------
+// Pixel Shader
+//--------------------------------------------------------------------------------------
+float4 PS( PS_INPUT input ) : SV_Target
+{
+#ifdef TEXTURE_ARRAY
+    return txSprite.Sample( samClamp, input.Tex ) * input.Color;
+#else
+    return txSprite.Sample( samClamp, input.Tex.xy ) * input.Color;
+#endif
+}
@@ -0,0 +1,42 @@
+//--------------------------------------------------------------------------------------
+// File: StreamConvert.fx
+//
+// Conversión del frame a NV12 para el codificador de vídeo (RemoteStream.cpp): dos
+// pases a pantalla completa sobre las vistas R8 (luma) y R8G8 (croma, a media
+// resolución) de la misma textura NV12. BT.709 de rango limitado, que es lo que
+// esperan los decodificadores H.264/HEVC por defecto.
+//--------------------------------------------------------------------------------------
+
+Texture2D<float3> StreamSource : register( t0 );
+SamplerState StreamSampler     : register( s0 );
+
+struct STREAM_OUTPUT
+{
+    float4 Pos : SV_POSITION;
+    float2 Tex : TEXCOORD0;
+};
+
+// Triángulo a pantalla completa con SV_VertexID (sin vertex buffer).
+STREAM_OUTPUT VSStream( uint id : SV_VertexID )
+{
+    STREAM_OUTPUT output;
+    output.Tex = float2( ( id << 1 ) & 2, id & 2 );
+    output.Pos = float4( output.Tex.x * 2.0f - 1.0f, 1.0f - output.Tex.y * 2.0f, 0.0f, 1.0f );
+    return output;
+}
+
+// El back buffer ya está en gamma: Y'CbCr sale directamente de sus valores.
+float PSLuma( STREAM_OUTPUT input ) : SV_Target
+{
+    float3 rgb = StreamSource.Sample( StreamSampler, input.Tex );
+    return dot( rgb, float3( 0.1826f, 0.6142f, 0.0620f ) ) + 16.0f / 255.0f;
+}
+
+// Cada texel de croma cubre 2x2 de luma: el bilineal en su centro ya es la media.
+float2 PSChroma( STREAM_OUTPUT input ) : SV_Target
+{
+    float3 rgb = StreamSource.Sample( StreamSampler, input.Tex );
+    float cb = dot( rgb, float3( -0.1006f, -0.3386f, 0.4392f ) );
+    float cr = dot( rgb, float3( 0.4392f, -0.3989f, -0.0403f ) );
+    return float2( cb, cr ) + 128.0f / 255.0f;
+}
@@ -0,0 +1,133 @@
+//--------------------------------------------------------------------------------------
+// File: TemporalAA.fx
+//
+// Antialiasing temporal (TemporalAA.cpp). CSResolve, un hilo por píxel de la ventana:
+// toma la muestra de la escena (dibujada con jitter, quizá a menor resolución) más
+// cercana, reproyecta la historia con la profundidad, la recorta a la caja de colores
+// vecinos y mezcla. El resultado es la historia del frame siguiente.
+//--------------------------------------------------------------------------------------
+cbuffer cbTemporal : register( b8 )
+{
+    matrix TemporalReprojection;    // clip actual (sin jitter) -> clip del frame anterior
+    float4 TemporalSize;            // xy = ventana (salida), zw = escena
+    float4 TemporalJitter;          // xy = jitter (píxeles de escena), z = peso del frame nuevo, w = 1: hay historia
+    float4 TemporalParams;          // x = desviaciones de la caja de vecinos
+};
+
+#include "Upscale.fxh"
+
+#define TEMPORAL_TILE 8
+
+Texture2D<float3> SceneColor      : register( t0 );
+Texture2D<float>  SceneDepth      : register( t1 );
+Texture2D<float3> History         : register( t2 );
+SamplerState      TemporalSampler : register( s0 );
+RWTexture2D<float4> Resolved      : register( u0 );
+
+float Luma( float3 color )
+{
+    return dot( color, float3( 0.2126f, 0.7152f, 0.0722f ) );
+}
+
+// Peso por brillo: en HDR un píxel muy brillante dominaría la mezcla y parpadearía.
+float3 Compress( float3 color )
+{
+    return color / ( 1.0f + Luma( color ) );
+}
+
+float3 Expand( float3 color )
+{
+    return color / max( 1.0f - Luma( color ), 1e-4f );
+}
+
+// YCoCg: la caja de vecinos se ajusta mejor que en RGB (el brillo va en un eje).
+float3 ToYCoCg( float3 color )
+{
+    return float3( dot( color, float3( 0.25f, 0.5f, 0.25f ) ),
+                   dot( color, float3( 0.5f, 0.0f, -0.5f ) ),
+                   dot( color, float3( -0.25f, 0.5f, -0.25f ) ) );
+}
+
+float3 FromYCoCg( float3 color )
+{
+    return float3( color.x + color.y - color.z, color.x + color.z, color.x - color.y - color.z );
+}
+
+// Lleva `history` hacia el centro de la caja hasta que entra: recortar por ejes
+// cambiaría el matiz.
+float3 ClipToBox( float3 history, float3 center, float3 extent )
+{
+    float3 offset = history - center;
+    float3 units = abs( offset / max( extent, 1e-4f ) );
+    float scale = max( units.x, max( units.y, units.z ) );
+    return scale > 1.0f ? center + offset / scale : history;
+}
+
+[numthreads( TEMPORAL_TILE, TEMPORAL_TILE, 1 )]
+void CSResolve( uint3 pixelId : SV_DispatchThreadID )
+{
+    if ( any( pixelId.xy >= uint2( TemporalSize.xy ) ) )
+        return;
+    float2 uv = ( pixelId.xy + 0.5f ) / TemporalSize.xy;
+    int2 sceneSize = int2( TemporalSize.zw );
+
+    // El píxel `p` de la escena se dibujó en `p + 0.5 - jitter`: la muestra más cercana
+    // al centro de este píxel de salida.
+    float2 scenePosition = uv * TemporalSize.zw + TemporalJitter.xy;
+    int2 center = clamp( int2( floor( scenePosition ) ), 0, sceneSize - 1 );
+
+    // Vecindario 3x3: media y desviación del color (caja de recorte) y el píxel más
+    // cercano, cuyo movimiento se usa para todos (el borde de un objeto se mueve con él).
+    float3 sum = 0.0f;
+    float3 sumSquares = 0.0f;
+    float closestDepth = 1.0f;
+    int2 closest = center;
+    [unroll]
+    for ( int y = -1; y <= 1; ++y )
+    {
+        [unroll]
+        for ( int x = -1; x <= 1; ++x )
+        {
+            int2 pixel = clamp( center + int2( x, y ), 0, sceneSize - 1 );
+            float3 color = ToYCoCg( Compress( SceneColor[ pixel ] ) );
+            sum += color;
+            sumSquares += color * color;
+            float depth = SceneDepth[ pixel ];
+            if ( depth < closestDepth )
+            {
+                closestDepth = depth;
+                closest = pixel;
+            }
+        }
+    }
+    float3 mean = sum / 9.0f;
+    float3 deviation = sqrt( max( sumSquares / 9.0f - mean * mean, 0.0f ) );
+
+    // Vector de movimiento de cámara: dónde estaba el punto del píxel más cercano.
+    float2 closestUv = ( closest + 0.5f - TemporalJitter.xy ) / TemporalSize.zw;
+    float4 clip = float4( closestUv.x * 2.0f - 1.0f, 1.0f - closestUv.y * 2.0f, closestDepth, 1.0f );
+    float4 previous = mul( clip, TemporalReprojection );
+    float2 previousUv = float2( previous.x / previous.w * 0.5f + 0.5f, 0.5f - previous.y / previous.w * 0.5f );
+    float2 historyUv = uv - ( closestUv - previousUv );
+
+    float3 result;
+    if ( TemporalJitter.w < 0.5f || previous.w <= 0.0f || any( historyUv < 0.0f ) || any( historyUv > 1.0f ) )
+    {
+        // Sin historia válida: la escena sin el desplazamiento del jitter.
+        result = SampleCatmullRom( SceneColor, TemporalSampler, uv + TemporalJitter.xy / TemporalSize.zw );
+    }
+    else
+    {
+        float3 current = ToYCoCg( Compress( SceneColor[ center ] ) );
+        float3 history = ToYCoCg( Compress( SampleCatmullRom( History, TemporalSampler, historyUv ) ) );
+        history = ClipToBox( history, mean, deviation * TemporalParams.x );
+
+        // Peso de la muestra nueva según su distancia (en píxeles de salida) al centro:
+        // gaussiana parecida a Blackman-Harris. Al subir, los píxeles de salida sin una
+        // muestra cerca se quedan casi con la historia.
+        float2 offset = ( ( center + 0.5f - TemporalJitter.xy ) / TemporalSize.zw - uv ) * TemporalSize.xy;
+        float weight = TemporalJitter.z * exp( -2.29f * dot( offset, offset ) );
+        result = Expand( FromYCoCg( lerp( history, current, weight ) ) );
+    }
+    Resolved[ pixelId.xy ] = float4( max( result, 0.0f ), 1.0f );
+}
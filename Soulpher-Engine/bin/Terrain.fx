@@ -0,0 +1,225 @@
+//--------------------------------------------------------------------------------------
+// File: Terrain.fx
+//
+// Clipmap de alturas (ver Terrain.h). Sin vertex buffer de geometría: la celda del
+// bloque sale de SV_VertexID y la esquina, el tamaño de celda y los mips del bloque
+// llegan por instancia desde el slot 1. La altura se lee en el VS (o en el domain con
+// TESSELLATION) del mapa R16 de t2.
+//
+// b2 cbTerrain (vista y proyección propias: también las leen hull y domain), t0 difusa
+// repetida en mundo, t2 alturas, s3 sampler de alturas (clamp), s4 sampler de la difusa
+// (wrap). Recibe sombra como ShadowReceiver.fx (b3, t1, s1) y suma las luces de su
+// cluster (ClusteredLights.fxh: t4-t6, b5).
+//
+// Con TESSELLATION definido el VS solo coloca los puntos de control; el hull subdivide
+// cada triángulo según el tamaño en pantalla de sus aristas y el domain lee la altura
+// de los vértices nuevos.
+//--------------------------------------------------------------------------------------
+Texture2D txDiffuse : register( t0 );
+Texture2DArray txShadow : register( t1 );
+Texture2D<float> txHeight : register( t2 );
+SamplerComparisonState samShadow : register( s1 );
+SamplerState samHeight : register( s3 );
+SamplerState samDiffuse : register( s4 );
+
+// Celdas por lado de un bloque (Terrain::kBlockQuads).
+#define BLOCK_QUADS 16
+// Fracción del medio lado del nivel donde empieza la transición al siguiente.
+#define MORPH_START 0.7f
+#define MORPH_RANGE 0.25f
+
+cbuffer cbTerrain : register( b2 )
+{
+    matrix View;
+    matrix Projection;
+    float4 Camera;           // xyz = posición, w = alto del viewport en píxeles
+    float4 Heights;          // x = altura base, y = escala, z = 1 / lado del mapa, w = repeticiones de la difusa
+    float4 Tessellation;     // x = factor máximo, y = píxeles por subdivisión, z = P[1][1], w = rugosidad
+};
+
+cbuffer cbShadow : register( b3 )
+{
+    matrix LightViewProj[4]; // una por cascada (ShadowMap::kCascadeCount)
+    float4 CascadeSplits;    // profundidad en vista donde termina cada cascada
+    float4 ShadowParams;     // x = 1 / tamaño de cascada, y = sesgo, z = intensidad
+};
+
+#include "ClusteredLights.fxh"
+
+//--------------------------------------------------------------------------------------
+struct VS_INPUT
+{
+    float4 Block  : TERRAIN_BLOCK0;  // xy = esquina en mundo (x, z), z = celda, w = mip del nivel
+    float4 Level  : TERRAIN_LEVEL0;  // xy = centro del nivel, z = medio lado (0 = sin transición), w = mip del siguiente
+    uint VertexId : SV_VertexID;
+};
+
+struct PS_INPUT
+{
+    float4 Pos      : SV_POSITION;
+    float3 WorldPos : TEXCOORD1;
+    float  ViewZ    : TEXCOORD2;
+};
+
+//--------------------------------------------------------------------------------------
+// Altura en mundo de un punto (x, z) con el mip dado.
+//--------------------------------------------------------------------------------------
+float TerrainHeight( float2 xz, float mip )
+{
+    float2 uv = xz * Heights.z + 0.5f;
+    return Heights.x + txHeight.SampleLevel( samHeight, uv, mip ) * Heights.y;
+}
+
+//--------------------------------------------------------------------------------------
+// Vértice del bloque en mundo (x, z) y su mip. En la franja exterior del nivel los
+// vértices impares se deslizan hasta el par anterior (la rejilla del nivel siguiente)
+// y el mip pasa al del siguiente: en el borde el nivel es igual al que lo envuelve.
+//--------------------------------------------------------------------------------------
+float3 BlockVertex( VS_INPUT input )
+{
+    uint2 grid = uint2( input.VertexId % ( BLOCK_QUADS + 1 ), input.VertexId / ( BLOCK_QUADS + 1 ) );
+    float2 xz = input.Block.xy + float2( grid ) * input.Block.z;
+
+    float morph = 0.0f;
+    if ( input.Level.z > 0.0f )
+    {
+        float2 d = abs( xz - input.Level.xy ) / input.Level.z;
+        morph = saturate( ( max( d.x, d.y ) - MORPH_START ) / MORPH_RANGE );
+    }
+    xz -= float2( grid & 1 ) * input.Block.z * morph;
+    return float3( xz, lerp( input.Block.w, input.Level.w, morph ) );
+}
+
+PS_INPUT ProjectVertex( float3 worldPos )
+{
+    PS_INPUT output;
+    float4 viewPos = mul( float4( worldPos, 1.0f ), View );
+    output.ViewZ = viewPos.z;
+    output.Pos = mul( viewPos, Projection );
+    output.WorldPos = worldPos;
+    return output;
+}
+
+#ifndef TESSELLATION
+//--------------------------------------------------------------------------------------
+// Vertex Shader
+//--------------------------------------------------------------------------------------
+PS_INPUT VS( VS_INPUT input )
+{
+    float3 vertex = BlockVertex( input );
+    return ProjectVertex( float3( vertex.x, TerrainHeight( vertex.xy, vertex.z ), vertex.y ) );
+}
+#else
+//--------------------------------------------------------------------------------------
+// Vertex Shader (puntos de control)
+//--------------------------------------------------------------------------------------
+struct CONTROL_POINT
+{
+    float3 WorldPos : POSITION;
+    float  Mip      : TEXCOORD0;
+};
+
+CONTROL_POINT VS( VS_INPUT input )
+{
+    float3 vertex = BlockVertex( input );
+    CONTROL_POINT output;
+    output.WorldPos = float3( vertex.x, TerrainHeight( vertex.xy, vertex.z ), vertex.y );
+    output.Mip = vertex.z;
+    return output;
+}
+
+//--------------------------------------------------------------------------------------
+// Hull Shader. El factor de una arista solo depende de sus extremos: los dos
+// triángulos que la comparten (también entre niveles, ya deslizados) la parten igual.
+//--------------------------------------------------------------------------------------
+struct PATCH_CONSTANTS
+{
+    float Edges[ 3 ] : SV_TessFactor;
+    float Inside     : SV_InsideTessFactor;
+};
+
+float EdgeFactor( float3 a, float3 b )
+{
+    float distanceToEdge = max( distance( 0.5f * ( a + b ), Camera.xyz ), 1e-3f );
+    float pixels = distance( a, b ) / distanceToEdge * Tessellation.z * 0.5f * Camera.w;
+    return clamp( pixels / Tessellation.y, 1.0f, Tessellation.x );
+}
+
+PATCH_CONSTANTS PatchConstants( InputPatch<CONTROL_POINT, 3> patch )
+{
+    PATCH_CONSTANTS output;
+    // La arista i es la opuesta al vértice i.
+    output.Edges[ 0 ] = EdgeFactor( patch[ 1 ].WorldPos, patch[ 2 ].WorldPos );
+    output.Edges[ 1 ] = EdgeFactor( patch[ 2 ].WorldPos, patch[ 0 ].WorldPos );
+    output.Edges[ 2 ] = EdgeFactor( patch[ 0 ].WorldPos, patch[ 1 ].WorldPos );
+    output.Inside = ( output.Edges[ 0 ] + output.Edges[ 1 ] + output.Edges[ 2 ] ) / 3.0f;
+    return output;
+}
+
+[domain( "tri" )]
+[partitioning( "fractional_odd" )]
+[outputtopology( "triangle_cw" )]
+[outputcontrolpoints( 3 )]
+[patchconstantfunc( "PatchConstants" )]
+CONTROL_POINT HS( InputPatch<CONTROL_POINT, 3> patch, uint id : SV_OutputControlPointID )
+{
+    return patch[ id ];
+}
+
+//--------------------------------------------------------------------------------------
+// Domain Shader: interpola (x, z) y el mip, y vuelve a leer la altura.
+//--------------------------------------------------------------------------------------
+[domain( "tri" )]
+PS_INPUT DS( PATCH_CONSTANTS constants, float3 uvw : SV_DomainLocation,
+             const OutputPatch<CONTROL_POINT, 3> patch )
+{
+    float3 worldPos = uvw.x * patch[ 0 ].WorldPos + uvw.y * patch[ 1 ].WorldPos + uvw.z * patch[ 2 ].WorldPos;
+    float mip = uvw.x * patch[ 0 ].Mip + uvw.y * patch[ 1 ].Mip + uvw.z * patch[ 2 ].Mip;
+    worldPos.y = TerrainHeight( worldPos.xz, mip );
+    return ProjectVertex( worldPos );
+}
+#endif
+
+//--------------------------------------------------------------------------------------
+// Cascada por profundidad en vista y PCF 3x3, como en ShadowReceiver.fx.
+// Devuelve 1 si el punto está iluminado y 0 si está en sombra por completo.
+//--------------------------------------------------------------------------------------
+float ShadowFactor( float3 worldPos, float viewZ )
+{
+    float4 beyond = step( CascadeSplits, viewZ.xxxx );
+    uint cascade = (uint)dot( beyond, float4( 1.0f, 1.0f, 1.0f, 1.0f ) );
+    if ( cascade >= 4 )
+        return 1.0f; // más allá de la distancia de sombra
+
+    float4 lightPos = mul( float4( worldPos, 1.0f ), LightViewProj[cascade] );
+    float3 ndc = lightPos.xyz / lightPos.w;
+    if ( ndc.z > 1.0f )
+        return 1.0f; // más allá del volumen de la luz
+    float2 uv = float2( 0.5f * ndc.x + 0.5f, -0.5f * ndc.y + 0.5f );
+    float depth = ndc.z - ShadowParams.y;
+
+    float lit = 0.0f;
+    [unroll] for ( int y = -1; y <= 1; ++y )
+    {
+        [unroll] for ( int x = -1; x <= 1; ++x )
+        {
+            float3 coord = float3( uv + float2( x, y ) * ShadowParams.x, cascade );
+            lit += txShadow.SampleCmpLevelZero( samShadow, coord, depth );
+        }
+    }
+    return lit / 9.0f;
+}
+
+//--------------------------------------------------------------------------------------
+// Pixel Shader. La difusa se repite en mundo (x, z) y las pendientes se oscurecen
+// con la normal de la cara, que es la misma que usa ShadeSurface.
+//--------------------------------------------------------------------------------------
+SurfaceOutput PS( PS_INPUT input )
+{
+    float shade = lerp( 1.0f - ShadowParams.z, 1.0f, ShadowFactor( input.WorldPos, input.ViewZ ) );
+    float3 normal = SurfaceNormal( input.WorldPos );
+    float4 color = txDiffuse.Sample( samDiffuse, input.WorldPos.xz * Heights.w );
+    color.rgb *= lerp( 0.55f, 1.0f, saturate( normal.y ) );
+    color.a = 1.0f;
+    return ShadeSurface( input.Pos, input.WorldPos, input.ViewZ, color, shade, Tessellation.w );
+}
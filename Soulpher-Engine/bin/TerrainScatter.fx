@@ -0,0 +1,316 @@
+//--------------------------------------------------------------------------------------
+// File: TerrainScatter.fx
+//
+// Vegetación y piedras generadas en GPU sobre el terreno (ver TerrainScatter.h).
+//
+// CSScatter: un grupo por cada 64 candidatos de un tile (SV_GroupID.y = tile). La
+// posición, la escala, el giro y el tono salen de un hash de la celda en mundo; la
+// altura y la pendiente del mapa del terreno (t9); la densidad de la capa por su canal
+// del mapa de densidad (t10), desvanecida al final del alcance. Las que quedan se
+// prueban contra el frustum y la pirámide Hi-Z (t2) como en GpuCulling.fx y se añaden
+// a la lista de su capa: el contador es InstanceCount de sus argumentos indirectos.
+// CSFinalize recorta cada contador a la capacidad de la capa.
+//
+// VS/PS: la forma de la capa (POSITION, w = peso del viento) y el hueco de la lista
+// por el slot 1 (INSTANCE_SLOT, como el camino GPU-driven); la instancia se lee de t3.
+// b0 vista, b1 proyección, b2 cbScatter. Recibe sombra como ShadowReceiver.fx (b3, t1,
+// s1) y suma las luces de su cluster (ClusteredLights.fxh: t4-t6, b5).
+//--------------------------------------------------------------------------------------
+
+// Candidatos por lado de un tile y capacidad de cada capa (TerrainScatter::kTileCandidates,
+// TerrainScatter::kLayerCapacity).
+#define TILE_CANDIDATES 32
+#define LAYER_CAPACITY 65536
+#define MAX_LAYERS 4
+
+struct Tile
+{
+    int2 Cell;               // primera celda en mundo (unidades de la separación de la capa)
+    uint Layer;
+    uint Pad;
+};
+
+// Mismo layout que TerrainScatter::InstanceData.
+struct Instance
+{
+    float3 Position;
+    float  Scale;
+    float  Rotation;
+    uint   Layer;
+    float  Tint;
+    float  Phase;
+};
+
+StructuredBuffer<Tile> Tiles : register( t0 );
+Texture2D<float> HiZ : register( t2 );
+Texture2D<float> txHeight : register( t9 );
+Texture2D<float4> txDensity : register( t10 );
+SamplerState samClamp : register( s3 );
+RWBuffer<uint> DrawArgs : register( u0 );            // 5 uint por capa
+RWStructuredBuffer<Instance> Instances : register( u1 );
+
+StructuredBuffer<Instance> ScatterInstances : register( t3 );
+Texture2DArray txShadow : register( t1 );
+SamplerComparisonState samShadow : register( s1 );
+
+cbuffer cbNeverChanges : register( b0 )
+{
+    matrix View;
+};
+
+cbuffer cbChangeOnResize : register( b1 )
+{
+    matrix Projection;
+};
+
+cbuffer cbScatter : register( b2 )
+{
+    float4 Planes[6];
+    matrix HiZViewProj;      // transpuesta (como View/Projection)
+    float4 Camera;           // xyz = posición, w = tiempo del viento
+    float4 Heights;          // x = altura base, y = escala, z = 1 / lado del mapa, w = viento
+    float4 Placement[MAX_LAYERS]; // x = separación, y = densidad, z = alcance, w = inicio del desvanecido
+    float4 Shape[MAX_LAYERS];     // xy = escala mínima y máxima, z = normal mínima, w = canal de densidad
+    float4 Bounds[MAX_LAYERS];    // x = radio, y = alto (a escala 1)
+    float4 Colors[MAX_LAYERS];    // rgb = color, w = variación
+    uint   TileCount;
+    uint   HiZMipCount;      // 0 = sin pirámide todavía
+    uint2  HiZSize;          // tamaño del mip 0
+    float  Roughness;
+};
+
+cbuffer cbShadow : register( b3 )
+{
+    matrix LightViewProj[4]; // una por cascada (ShadowMap::kCascadeCount)
+    float4 CascadeSplits;    // profundidad en vista donde termina cada cascada
+    float4 ShadowParams;     // x = 1 / tamaño de cascada, y = sesgo, z = intensidad
+};
+
+#include "ClusteredLights.fxh"
+
+//--------------------------------------------------------------------------------------
+// Generación
+//--------------------------------------------------------------------------------------
+uint Hash( uint x )
+{
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return x;
+}
+
+// Siguiente valor en [0, 1) de la secuencia de `seed`.
+float Random( inout uint seed )
+{
+    seed = Hash( seed );
+    return ( seed & 0x00ffffffU ) / 16777216.0f;
+}
+
+float TerrainHeight( float2 xz )
+{
+    return Heights.x + txHeight.SampleLevel( samClamp, xz * Heights.z + 0.5f, 0.0f ) * Heights.y;
+}
+
+bool InFrustum( float3 bmin, float3 bmax )
+{
+    [unroll]
+    for ( int i = 0; i < 6; ++i )
+    {
+        // Vértice de la caja más adentro según la normal del plano.
+        float3 p = float3( Planes[i].x >= 0.0f ? bmax.x : bmin.x,
+                           Planes[i].y >= 0.0f ? bmax.y : bmin.y,
+                           Planes[i].z >= 0.0f ? bmax.z : bmin.z );
+        if ( dot( Planes[i].xyz, p ) + Planes[i].w < 0.0f )
+            return false;
+    }
+    return true;
+}
+
+// Mismo criterio que GpuCulling.fx (y HiZBuffer::isOccluded): ante cualquier duda, visible.
+bool IsOccluded( float3 bmin, float3 bmax )
+{
+    if ( HiZMipCount == 0 )
+        return false;
+
+    float2 ndcMin = float2( 1.0f, 1.0f );
+    float2 ndcMax = float2( -1.0f, -1.0f );
+    float minZ = 1.0f;
+    [unroll]
+    for ( int i = 0; i < 8; ++i )
+    {
+        float3 corner = float3( ( i & 1 ) ? bmax.x : bmin.x,
+                                ( i & 2 ) ? bmax.y : bmin.y,
+                                ( i & 4 ) ? bmax.z : bmin.z );
+        float4 clip = mul( float4( corner, 1.0f ), HiZViewProj );
+        if ( clip.w <= 1e-4f )
+            return false; // cruza el plano de la cámara
+        float3 ndc = clip.xyz / clip.w;
+        ndcMin = min( ndcMin, ndc.xy );
+        ndcMax = max( ndcMax, ndc.xy );
+        minZ = min( minZ, ndc.z );
+    }
+    ndcMin = max( ndcMin, -1.0f );
+    ndcMax = min( ndcMax, 1.0f );
+    if ( any( ndcMin > ndcMax ) || minZ <= 0.0f )
+        return false;
+
+    float2 uvMin = float2( ndcMin.x * 0.5f + 0.5f, 0.5f - ndcMax.y * 0.5f );
+    float2 uvMax = float2( ndcMax.x * 0.5f + 0.5f, 0.5f - ndcMin.y * 0.5f );
+    float2 extent = ( uvMax - uvMin ) * float2( HiZSize );
+    uint mip = (uint)clamp( ceil( log2( max( max( extent.x, extent.y ), 1.0f ) ) ), 0.0f, (float)( HiZMipCount - 1 ) );
+
+    uint width, height, levels;
+    HiZ.GetDimensions( mip, width, height, levels );
+    int2 p0 = max( int2( floor( uvMin * float2( width, height ) ) ) - 1, int2( 0, 0 ) );
+    int2 p1 = min( int2( floor( uvMax * float2( width, height ) ) ) + 1, int2( width, height ) - 1 );
+
+    [loop]
+    for ( int y = p0.y; y <= p1.y; ++y )
+    {
+        [loop]
+        for ( int x = p0.x; x <= p1.x; ++x )
+        {
+            if ( minZ <= HiZ.Load( int3( x, y, mip ) ) )
+                return false;
+        }
+    }
+    return true;
+}
+
+[numthreads( 64, 1, 1 )]
+void CSScatter( uint3 group : SV_GroupID, uint thread : SV_GroupIndex )
+{
+    if ( group.y >= TileCount )
+        return;
+
+    Tile tile = Tiles[ group.y ];
+    uint candidate = group.x * 64 + thread;
+    int2 cell = tile.Cell + int2( candidate % TILE_CANDIDATES, candidate / TILE_CANDIDATES );
+    uint layer = tile.Layer;
+    float4 placement = Placement[ layer ];
+    float4 shape = Shape[ layer ];
+
+    // La misma celda da siempre el mismo candidato, se mueva o no la cámara.
+    uint seed = Hash( asuint( cell.x ) * 73856093U ^ asuint( cell.y ) * 19349663U ^ ( layer + 1 ) * 83492791U );
+    float2 xz = ( float2( cell ) + float2( Random( seed ), Random( seed ) ) ) * placement.x;
+
+    float fade = saturate( ( placement.z - distance( xz, Camera.xz ) ) / max( placement.z - placement.w, 1e-3f ) );
+    float4 channel = float4( (uint)shape.w == uint4( 0, 1, 2, 3 ) );
+    float density = placement.y * fade * dot( txDensity.SampleLevel( samClamp, xz * Heights.z + 0.5f, 0.0f ), channel );
+    if ( Random( seed ) >= density )
+        return;
+
+    // Pendiente por diferencias centradas (a la separación de la capa, medio metro al menos).
+    float delta = max( placement.x, 0.5f );
+    float3 normal = normalize( float3(
+        TerrainHeight( xz - float2( delta, 0.0f ) ) - TerrainHeight( xz + float2( delta, 0.0f ) ),
+        2.0f * delta,
+        TerrainHeight( xz - float2( 0.0f, delta ) ) - TerrainHeight( xz + float2( 0.0f, delta ) ) ) );
+    if ( normal.y < shape.z )
+        return;
+
+    Instance instance;
+    instance.Scale = lerp( shape.x, shape.y, Random( seed ) );
+    instance.Position = float3( xz.x, TerrainHeight( xz ), xz.y );
+    instance.Rotation = Random( seed ) * 6.2831853f;
+    instance.Layer = layer;
+    instance.Tint = ( Random( seed ) * 2.0f - 1.0f ) * Colors[ layer ].w;
+    instance.Phase = Random( seed ) * 6.2831853f;
+
+    float radius = Bounds[ layer ].x * instance.Scale + Heights.w;
+    float3 bmin = instance.Position - float3( radius, radius, radius );
+    float3 bmax = instance.Position + float3( radius, Bounds[ layer ].y * instance.Scale, radius );
+    if ( !InFrustum( bmin, bmax ) || IsOccluded( bmin, bmax ) )
+        return;
+
+    uint slot;
+    InterlockedAdd( DrawArgs[ layer * 5 + 1 ], 1, slot );
+    if ( slot < LAYER_CAPACITY )
+        Instances[ layer * LAYER_CAPACITY + slot ] = instance;
+}
+
+// El contador siguió sumando al llenarse la lista: el draw no debe pasar de la capacidad.
+[numthreads( MAX_LAYERS, 1, 1 )]
+void CSFinalize( uint3 id : SV_DispatchThreadID )
+{
+    DrawArgs[ id.x * 5 + 1 ] = min( DrawArgs[ id.x * 5 + 1 ], LAYER_CAPACITY );
+}
+
+//--------------------------------------------------------------------------------------
+// Dibujo
+//--------------------------------------------------------------------------------------
+struct VS_INPUT
+{
+    float4 Pos  : POSITION;          // w = peso del viento (0 en la base, 1 en la punta)
+    uint   Slot : INSTANCE_SLOT0;    // capa * LAYER_CAPACITY + índice en la lista
+};
+
+struct PS_INPUT
+{
+    float4 Pos      : SV_POSITION;
+    float4 Color    : COLOR0;
+    float3 WorldPos : TEXCOORD1;
+    float  ViewZ    : TEXCOORD2;
+};
+
+PS_INPUT VS( VS_INPUT input )
+{
+    Instance instance = ScatterInstances[ input.Slot ];
+    float s, c;
+    sincos( instance.Rotation, s, c );
+    float3 local = input.Pos.xyz * instance.Scale;
+    float3 worldPos = instance.Position + float3( local.x * c - local.z * s, local.y, local.x * s + local.z * c );
+
+    // Viento: la punta oscila con una fase por instancia y una onda que cruza el mundo.
+    float wave = Camera.w * 1.7f + instance.Phase + 0.15f * ( instance.Position.x + instance.Position.z );
+    worldPos.xz += input.Pos.w * Heights.w * float2( sin( wave ), 0.5f * cos( 1.3f * wave ) );
+
+    PS_INPUT output;
+    float4 viewPos = mul( float4( worldPos, 1.0f ), View );
+    output.ViewZ = viewPos.z;
+    output.Pos = mul( viewPos, Projection );
+    output.WorldPos = worldPos;
+    // Más oscuro cerca del suelo: oclusión barata entre briznas y bajo las piedras.
+    float3 color = Colors[ instance.Layer ].rgb * saturate( 1.0f + instance.Tint );
+    float ground = saturate( input.Pos.y / max( Bounds[ instance.Layer ].y, 1e-3f ) );
+    output.Color = float4( color * lerp( 0.55f, 1.0f, ground ), 1.0f );
+    return output;
+}
+
+//--------------------------------------------------------------------------------------
+// Cascada por profundidad en vista y PCF 3x3, como en ShadowReceiver.fx.
+// Devuelve 1 si el punto está iluminado y 0 si está en sombra por completo.
+//--------------------------------------------------------------------------------------
+float ShadowFactor( float3 worldPos, float viewZ )
+{
+    float4 beyond = step( CascadeSplits, viewZ.xxxx );
+    uint cascade = (uint)dot( beyond, float4( 1.0f, 1.0f, 1.0f, 1.0f ) );
+    if ( cascade >= 4 )
+        return 1.0f; // más allá de la distancia de sombra
+
+    float4 lightPos = mul( float4( worldPos, 1.0f ), LightViewProj[cascade] );
+    float3 ndc = lightPos.xyz / lightPos.w;
+    if ( ndc.z > 1.0f )
+        return 1.0f; // más allá del volumen de la luz
+    float2 uv = float2( 0.5f * ndc.x + 0.5f, -0.5f * ndc.y + 0.5f );
+    float depth = ndc.z - ShadowParams.y;
+
+    float lit = 0.0f;
+    [unroll] for ( int y = -1; y <= 1; ++y )
+    {
+        [unroll] for ( int x = -1; x <= 1; ++x )
+        {
+            float3 coord = float3( uv + float2( x, y ) * ShadowParams.x, cascade );
+            lit += txShadow.SampleCmpLevelZero( samShadow, coord, depth );
+        }
+    }
+    return lit / 9.0f;
+}
+
+SurfaceOutput PS( PS_INPUT input )
+{
+    float shade = lerp( 1.0f - ShadowParams.z, 1.0f, ShadowFactor( input.WorldPos, input.ViewZ ) );
+    return ShadeSurface( input.Pos, input.WorldPos, input.ViewZ, input.Color, shade, Roughness );
+}
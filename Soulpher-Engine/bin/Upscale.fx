@@ -0,0 +1,30 @@
+//--------------------------------------------------------------------------------------
+// File: Upscale.fx
+//
+// Pase "Upscale" (DynamicResolution.cpp): sube la escena dibujada a resolución
+// dinámica al back buffer cuando no hay HDR (con HDR lo hace el pase final).
+//--------------------------------------------------------------------------------------
+#include "Upscale.fxh"
+
+Texture2D<float3> UpscaleSource : register( t0 );
+SamplerState UpscaleSampler     : register( s0 );
+
+struct UPSCALE_OUTPUT
+{
+    float4 Pos : SV_POSITION;
+    float2 Tex : TEXCOORD0;
+};
+
+// Triángulo a pantalla completa con SV_VertexID (sin vertex buffer).
+UPSCALE_OUTPUT VSUpscale( uint id : SV_VertexID )
+{
+    UPSCALE_OUTPUT output;
+    output.Tex = float2( ( id << 1 ) & 2, id & 2 );
+    output.Pos = float4( output.Tex.x * 2.0f - 1.0f, 1.0f - output.Tex.y * 2.0f, 0.0f, 1.0f );
+    return output;
+}
+
+float4 PSUpscale( UPSCALE_OUTPUT input ) : SV_Target
+{
+    return float4( SampleCatmullRom( UpscaleSource, UpscaleSampler, input.Tex ), 1.0f );
+}
@@ -0,0 +1,135 @@
+﻿/**
+ * @file ActorCost.h
+ * @brief Coste de cada actor en el último frame: paquetes, triángulos, sombras, memoria
+ * de texturas y, en modo de depuración, tiempo de GPU del seleccionado.
+ *
+ * @details
+ * El perfilador de GPU mide pases, no actores: saber qué asset se come el presupuesto
+ * pedía una captura. Aquí el coste se reparte por actor con lo que ya pasa por el render:
+ *
+ * - **Paquetes y triángulos**: `RenderQueue::submit` apunta cada paquete en el actor que
+ *   lo envió (`DrawPacket::owner`), en la cola principal o en las de sombra (la suma de
+ *   las cascadas que dibujó). Son los paquetes antes de fusionarse en lotes instanciados.
+ * - **Memoria de texturas**: bytes residentes de las texturas del actor; una textura
+ *   compartida cuenta entera en cada actor que la usa.
+ * - **Tiempo de GPU** (@ref ActorCost::setProfiledActor): los paquetes del actor elegido
+ *   salen de los lotes y cada draw se mide con su par de timestamps (@ref GpuProfiler);
+ *   la cola se graba en el contexto inmediato. Cambia un poco lo que se mide (más draws,
+ *   sin instancing para ese actor) y gasta secciones del perfilador: solo a petición.
+ *
+ * Los contadores solo se recogen con @ref ActorCost::setTracking (panel de coste abierto
+ * u orden por coste en el "Hierarchy"): con miles de actores son miles de inserciones
+ * por frame. Los actores de la ruta GPU-driven, los impostores y los que usan occlusion
+ * query no pasan por la cola de la vista y ahí cuentan 0 (sus sombras sí cuentan).
+ *
+ * @note Para estudiantes: triángulos y paquetes son coste de CPU y de vértices; el de
+ * píxeles depende de cuánto ocupa el actor en pantalla, y solo el tiempo de GPU lo ve.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include <atomic>
+#include <mutex>
+
+class Actor;
+class DeviceContext;
+class GpuProfiler;
+
+/**
+ * @class ActorCost
+ * @brief Contadores por actor del frame y tiempo de GPU del actor medido.
+ */
+class ActorCost {
+public:
+    ActorCost() = default;
+    ~ActorCost() = default;
+    ActorCost(const ActorCost&) = delete;
+    ActorCost& operator=(const ActorCost&) = delete;
+
+    /// Secciones del perfilador con los draws del actor medido.
+    static const char* const kGpuScope;
+    static const char* const kShadowGpuScope;
+
+    /// Coste de un actor en el último frame publicado.
+    struct Cost {
+        unsigned int draws = 0;             ///< Paquetes en la vista principal (antes del instancing).
+        unsigned int triangles = 0;
+        unsigned int shadowDraws = 0;       ///< Paquetes en las cascadas de sombra.
+        unsigned int shadowTriangles = 0;
+        size_t textureBytes = 0;            ///< VRAM de sus texturas (compartidas incluidas).
+        float gpuMs = -1.0f;                ///< Vista principal; < 0 = sin medir.
+        float shadowGpuMs = -1.0f;          ///< Cascadas de sombra; < 0 = sin medir.
+    };
+
+    /// Criterio de orden del "Hierarchy".
+    enum SortKey {
+        SORT_NONE = 0,
+        SORT_TRIANGLES,
+        SORT_DRAWS,
+        SORT_SHADOW,
+        SORT_TEXTURE_MEMORY,
+        SORT_KEY_COUNT
+    };
+
+    /** @brief Recoger (o no) los contadores por actor (hilo principal). */
+    void setTracking(bool enable) { m_tracking.store(enable, std::memory_order_relaxed); }
+    bool isTracking() const { return m_tracking.load(std::memory_order_relaxed); }
+
+    /** @brief Actor cuyos draws se miden en GPU (`nullptr` = ninguno; hilo principal). */
+    void setProfiledActor(const Actor* actor) { m_requestedActor.store(actor, std::memory_order_relaxed); }
+    const Actor* getProfiledActor() const { return m_requestedActor.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Inicio del frame de render: publica los contadores del anterior, empieza
+     * otros y lee el tiempo de GPU de los resultados que acaba de recoger `profiler`.
+     * @note Después de `GpuProfiler::beginFrame`.
+     */
+    void beginFrame(GpuProfiler& profiler);
+
+    /** @brief Un paquete de `owner` (desde `RenderQueue::submit`, hilo de render). */
+    void record(const void* owner, unsigned int indexCount, bool shadow);
+
+    /** @brief `owner` es el actor medido este frame (hilo de render). */
+    bool isProfiled(const void* owner) const { return owner && owner == m_frameActor; }
+
+    /** @brief Hay actor medido este frame (la cola no usa contextos diferidos). */
+    bool isProfiling() const { return m_frameActor != nullptr; }
+
+    /** @brief Abre la sección de un draw del actor medido (índice para @ref endGpuScope). */
+    unsigned int beginGpuScope(DeviceContext& deviceContext, bool shadow);
+    void endGpuScope(DeviceContext& deviceContext, unsigned int index);
+
+    /** @brief Coste del actor en el último frame publicado (hilo principal). */
+    Cost getCost(const Actor& actor);
+
+    /** @brief Valor por el que ordena `key` (mayor = más caro). */
+    static double sortValue(const Cost& cost, SortKey key);
+
+    /** @brief Se incrementa con cada frame publicado. */
+    unsigned long long getSerial() const { return m_serial.load(std::memory_order_relaxed); }
+
+private:
+    /// Lo que se acumula por actor.
+    struct Counters {
+        unsigned int draws = 0;
+        unsigned int triangles = 0;
+        unsigned int shadowDraws = 0;
+        unsigned int shadowTriangles = 0;
+    };
+
+    std::atomic<bool> m_tracking{ false };
+    std::atomic<const Actor*> m_requestedActor{ nullptr };
+
+    std::mutex m_mutex;                         ///< Protege el mapa publicado y el tiempo de GPU.
+    EU::TMap<const void*, Counters> m_counters[2];
+    unsigned int m_write = 0;                   ///< Mapa que llena el render; el otro es el publicado.
+    std::atomic<unsigned long long> m_serial{ 0 };
+
+    GpuProfiler* m_profiler = nullptr;          ///< El del frame en curso.
+    const Actor* m_frameActor = nullptr;        ///< Actor medido en el frame en curso.
+    const Actor* m_timedActor = nullptr;        ///< Actor de `m_gpuMs`.
+    unsigned int m_settleFrames = 0;            ///< Resultados aún de la selección anterior.
+    unsigned long long m_lastResultSerial = 0;  ///< `GpuProfiler::getResultSerial` ya leído.
+    float m_gpuMs = -1.0f;
+    float m_shadowGpuMs = -1.0f;
+};
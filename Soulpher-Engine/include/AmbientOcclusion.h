@@ -0,0 +1,126 @@
+﻿/**
+ * @file AmbientOcclusion.h
+ * @brief Oclusión ambiental en espacio de pantalla (SSAO) a media resolución, con
+ * acumulación temporal, para el camino diferido.
+ *
+ * @details
+ * Se calcula después del pase "Scene", a partir del depth buffer del frame:
+ *
+ * 1. **Oclusión** (compute, media resolución): por píxel, 8 muestras en un hemisferio
+ *    alrededor de la normal que se reconstruye de la profundidad, giradas con ruido que
+ *    cambia cada frame. Escribe un target transitorio del grafo (@ref rawDesc).
+ * 2. **Acumulación**: el punto se reproyecta al frame anterior y se mezcla con la
+ *    historia si allí tenía la misma profundidad; si no (desoclusión), se usa el nuevo.
+ *    La historia son dos texturas propias que se alternan cada frame.
+ * 3. **Subida**: la hace `DeferredLighting.fx` al iluminar, con las 4 muestras vecinas
+ *    pesadas por parecido de profundidad, y oscurece el término de sol y ambiente.
+ *
+ * @note Para estudiantes: a media resolución hay la cuarta parte de píxeles y de
+ * lecturas; la AO es de baja frecuencia, así que la subida bilateral (que respeta los
+ * bordes de profundidad) no se nota, y el ruido de 8 muestras lo quita la acumulación.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "ConstantBufferLayout.h"
+#include "RenderTargetPool.h"
+
+class Device;
+class DeviceContext;
+
+/**
+ * @class AmbientOcclusion
+ * @brief Kernels, constantes e historia de la SSAO.
+ */
+class AmbientOcclusion {
+public:
+    AmbientOcclusion() = default;
+    ~AmbientOcclusion() { destroy(); }
+
+    /// Lado del grupo de hilos (`OCCLUSION_TILE`).
+    static const unsigned int kTileSize = 8;
+
+    /// Parámetros que se pueden cambiar cada frame (cvars `r.ssao*`).
+    struct Settings {
+        float radius = 0.5f;            ///< Radio del hemisferio en unidades de mundo.
+        float intensity = 1.5f;         ///< Escala de la oclusión antes de recortarla.
+        float bias = 0.02f;             ///< Margen de profundidad contra la auto-oclusión.
+        float temporalWeight = 0.1f;    ///< Peso del frame nuevo al mezclar con la historia.
+        float depthTolerance = 0.05f;   ///< Diferencia de z relativa con la que la historia vale.
+    };
+
+    /**
+     * @brief Crea kernels, constantes e historia a media resolución del depth buffer.
+     * @param width Ancho del depth buffer (de la ventana).
+     * @param height Alto.
+     * @return `S_OK`; `DXGI_ERROR_UNSUPPORTED` por debajo de 11_0 (sin AO).
+     * @note Desde `initSizeDependent`: se vuelve a llamar al redimensionar.
+     */
+    HRESULT init(Device& device, unsigned int width, unsigned int height);
+
+    /** @brief Target transitorio de la oclusión sin acumular (RG16F: oclusión, z). */
+    static RenderTargetPool::Desc rawDesc(unsigned int width, unsigned int height);
+
+    /** @brief Parámetros para los siguientes frames. */
+    void setSettings(const Settings& settings) { m_settings = settings; }
+    const Settings& getSettings() const { return m_settings; }
+
+    /**
+     * @brief Oclusión del frame y acumulación con la historia.
+     * @param depthSRV Depth buffer del pase "Scene" (R24_UNORM_X8_TYPELESS).
+     * @param raw Target de @ref rawDesc.
+     * @param width Ancho del depth buffer de este frame (como mucho el de @ref init: con
+     * resolución dinámica la historia se usa en parte; si cambia, se descarta).
+     * @param height Alto.
+     * @param view Vista con la que se dibujó el frame.
+     * @param projection Proyección (perspectiva LH).
+     * @warning Desenlaza los render targets: el depth buffer no puede ser a la vez DSV y SRV.
+     */
+    void render(DeviceContext& deviceContext, ID3D11ShaderResourceView* depthSRV,
+        const RenderTargetPool::Target& raw, unsigned int width, unsigned int height,
+        const XMMATRIX& view, const XMMATRIX& projection, float nearZ, float farZ);
+
+    /** @brief Resultado del último @ref render (RG16F a media resolución). */
+    ID3D11ShaderResourceView* getResultSRV() const { return m_historySRV[m_current]; }
+
+    /** @brief Olvida la historia: el siguiente @ref render no la mezcla. */
+    void invalidate() { m_hasHistory = false; }
+
+    /** @brief `true` si el último frame dejó historia. */
+    bool hasHistory() const { return m_hasHistory; }
+
+    /** @brief Libera kernels, constantes e historia. */
+    void destroy();
+
+    /** @brief `true` tras un @ref init correcto. */
+    bool isReady() const { return m_temporalShader != nullptr; }
+
+private:
+    /// Constantes de `cbOcclusion` (`CB_SLOT_OCCLUSION`).
+    struct OcclusionParams {
+        XMMATRIX reprojection;  ///< Vista actual -> clip del frame anterior.
+        XMFLOAT4 size;          ///< x, y = media resolución; z, w = depth buffer.
+        XMFLOAT4 projection;    ///< _11, _22, cerca, lejos.
+        XMFLOAT4 params;        ///< Radio, intensidad, sesgo, frame.
+        XMFLOAT4 temporal;      ///< Peso del frame nuevo, hay historia, tolerancia de z.
+    };
+    /// Layout de `cbOcclusion` (ver `ConstantBufferLayouts`).
+    static const ConstantBufferLayouts::Registration kParamsLayout;
+
+    Settings m_settings;
+    unsigned int m_width = 0;           ///< Depth buffer de @ref init (tamaño de la historia x2).
+    unsigned int m_height = 0;
+    unsigned int m_lastWidth = 0;       ///< Depth buffer del último @ref render.
+    unsigned int m_lastHeight = 0;
+    unsigned int m_frame = 0;           ///< Gira el ruido de las muestras.
+    unsigned int m_current = 0;         ///< Historia con el último resultado.
+    bool m_hasHistory = false;
+    XMMATRIX m_previousViewProj = XMMatrixIdentity();
+
+    ID3D11ComputeShader* m_occlusionShader = nullptr;
+    ID3D11ComputeShader* m_temporalShader = nullptr;
+    ID3D11Buffer* m_params = nullptr;
+    ID3D11Texture2D* m_history[2] = {};
+    ID3D11ShaderResourceView* m_historySRV[2] = {};
+    ID3D11UnorderedAccessView* m_historyUAV[2] = {};
+};
@@ -0,0 +1,186 @@
+﻿/**
+ * @file Animation.h
+ * @brief Esqueletos y clips de animación compactos (cuantizados y con keyframes reducidos).
+ *
+ * @details
+ * `ModelLoader` muestrea cada `FbxAnimStack` a @ref AnimationClip::kDefaultSampleRate
+ * fotogramas por segundo y lo comprime con @ref AnimationClip::build:
+ *
+ * 1. **Pistas**: tres por hueso (rotación, traslación y escala), independientes.
+ * 2. **Reducción**: de cada pista se quitan los fotogramas que la interpolación entre
+ *    sus vecinos ya reproduce dentro de la tolerancia (@ref AnimationClip::BuildSettings).
+ *    Una pista constante se queda en una clave.
+ * 3. **Cuantización**: cada clave ocupa 8 bytes, el fotograma (16 bits) y el valor (48 bits).
+ *    - Rotaciones: "smallest three" (la mayor componente se deduce de las otras).
+ *    - Traslaciones y escalas: 16 bits por eje dentro del rango de su pista.
+ *
+ * Un clip muestreado a 30 Hz con 60 huesos ocupa unos 72 KB por segundo sin comprimir
+ * (40 bytes por hueso y fotograma); la mayoría de pistas de escala y muchas de traslación
+ * quedan en una clave, y el resto suele bajar a una clave de cada tres o cuatro fotogramas.
+ *
+ * @ref AnimationClip::sample deja la pose local en unos arrays (SoA por canal): la
+ * rotación se interpola por lotes con `EU::NlerpQuaternions`. Cada instancia guarda
+ * un cursor por pista, así que reproducir hacia delante no busca claves.
+ *
+ * @note Para estudiantes: los clips y el esqueleto son datos compartidos y de solo
+ * lectura; lo que cuesta memoria por personaje es su paleta (ver @ref AnimationSystem).
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "EngineUtilities/Vectors/QuaternionBatch.h"
+
+/**
+ * @struct JointPose
+ * @brief Transformación local de un hueso respecto a su padre.
+ */
+struct JointPose {
+    EU::Quaternion rotation; ///< Cuaternión unitario (w, x, y, z).
+    EU::Vector3 translation; ///< Posición en el espacio del padre.
+    EU::Vector3 scale = EU::Vector3(1.0f, 1.0f, 1.0f); ///< Escala por eje (local).
+};
+
+/**
+ * @struct Skeleton
+ * @brief Jerarquía de huesos de un modelo, con los padres antes que los hijos.
+ */
+struct Skeleton {
+    /// Máximo de huesos: `SkinVertex` guarda los índices en 8 bits.
+    static const unsigned int kMaxJoints = 256;
+
+    std::vector<std::string> names;         ///< Nombre del nodo FBX de cada hueso.
+    std::vector<int> parents;               ///< Índice del padre (-1 = raíz); siempre menor que el propio.
+    std::vector<EU::Matrix3x4> inverseBind; ///< Espacio de la malla al del hueso en la pose de enlace.
+    std::vector<JointPose> bindPose;        ///< Pose local de enlace.
+
+    /** @brief Número de huesos. */
+    unsigned int getJointCount() const { return static_cast<unsigned int>(parents.size()); }
+
+    /** @brief Índice del hueso `name`, o -1. */
+    int find(const std::string& name) const;
+
+    /** @brief Vacía el esqueleto. */
+    void clear();
+};
+
+/**
+ * @class AnimationClip
+ * @brief Clip de animación comprimido de un esqueleto.
+ */
+class AnimationClip {
+public:
+    /// Fotogramas por segundo a los que `ModelLoader` muestrea las curvas del FBX.
+    static const unsigned int kDefaultSampleRate = 30;
+    /// Fotogramas máximos de un clip (el número de fotograma de una clave es de 16 bits).
+    static const unsigned int kMaxFrames = 0xFFFF;
+
+    /// Error máximo que la reducción de keyframes puede añadir por pista.
+    struct BuildSettings {
+        float rotationTolerance;    ///< Radianes.
+        float translationTolerance; ///< Unidades del modelo.
+        float scaleTolerance;       ///< Fracción de escala.
+
+        BuildSettings() : rotationTolerance(0.001f), translationTolerance(0.001f), scaleTolerance(0.001f) {}
+    };
+
+    /**
+     * @brief Comprime un clip muestreado.
+     * @param name Nombre del clip (el del `FbxAnimStack`).
+     * @param sampleRate Fotogramas por segundo de `frames`.
+     * @param jointCount Huesos del esqueleto.
+     * @param frames `frameCount * jointCount` poses, fotograma a fotograma.
+     * @param settings Tolerancias de la reducción.
+     * @return Clip vacío si no hay fotogramas o hay más de @ref kMaxFrames.
+     */
+    static AnimationClip build(const std::string& name, float sampleRate, unsigned int jointCount,
+        const std::vector<JointPose>& frames, const BuildSettings& settings = BuildSettings());
+
+    /**
+     * @brief Pose local del clip en un instante.
+     * @param time Segundos desde el inicio, entre 0 y @ref getDuration.
+     * @param cursors Una entrada por pista (@ref getTrackCount), a 0 la primera vez: la
+     * clave de la última llamada. Si el tiempo retrocede se buscan desde el principio.
+     * @param rotations Recibe un cuaternión por hueso.
+     * @param translations Recibe una traslación por hueso.
+     * @param scales Recibe una escala por hueso.
+     * @param scratch Al menos `2 * getJointCount()` cuaterniones de trabajo.
+     * @param weights Al menos `getJointCount()` floats de trabajo.
+     */
+    void sample(float time, uint16_t* cursors, EU::Quaternion* rotations, EU::Vector3* translations,
+        EU::Vector3* scales, EU::Quaternion* scratch, float* weights) const;
+
+    const std::string& getName() const { return m_name; }
+    float getDuration() const { return m_frameCount > 1 ? (m_frameCount - 1) / m_sampleRate : 0.0f; }
+    float getSampleRate() const { return m_sampleRate; }
+    unsigned int getFrameCount() const { return m_frameCount; }
+    unsigned int getJointCount() const { return m_jointCount; }
+    unsigned int getTrackCount() const { return m_jointCount * 3; }
+    size_t getKeyCount() const { return m_keys.size(); }
+    bool isEmpty() const { return m_frameCount == 0; }
+
+    /** @brief Bytes de datos del clip (pistas y claves). */
+    size_t getMemoryUsage() const {
+        return m_tracks.size() * sizeof(Track) + m_keys.size() * sizeof(Key) + m_name.size();
+    }
+
+    /// Canal de una pista: la pista de un hueso `j` es `j * 3 + canal`.
+    enum Channel { ROTATION = 0, TRANSLATION = 1, SCALE = 2 };
+
+    /// Pista: rango de claves y, para traslación y escala, el rango de cuantización.
+    struct Track {
+        uint32_t firstKey;
+        uint32_t keyCount;
+        float minimum[3];
+        float extent[3];
+    };
+
+    /// Clave cuantizada: fotograma y valor de 48 bits.
+    struct Key {
+        uint16_t frame;
+        uint16_t value[3];
+    };
+
+private:
+    friend class AnimationCache;
+
+    std::string m_name;
+    float m_sampleRate = 0.0f;
+    unsigned int m_frameCount = 0;
+    unsigned int m_jointCount = 0;
+    std::vector<Track> m_tracks; ///< `m_jointCount * 3`.
+    std::vector<Key> m_keys;     ///< Claves de todas las pistas, cada pista en orden de fotograma.
+};
+
+/**
+ * @class AnimationCache
+ * @brief Archivo `<modelo>.sanim`: esqueleto, clips y pesos de las mallas de un FBX.
+ *
+ * @details Acompaña al `.smesh` (@ref MeshCache) con la misma clave. Se escribe y se
+ * lee entero: los clips ya están comprimidos y se copian tal cual, sin volver a reducir.
+ */
+class AnimationCache {
+public:
+    /// Cambia cuando cambia la disposición del archivo.
+    static const unsigned int kFormatVersion = 2;
+
+    /// Lo que se guarda: todo menos la geometría.
+    struct Animations {
+        Skeleton skeleton;
+        std::vector<AnimationClip> clips;
+        std::vector<std::vector<SkinVertex>> skins; ///< Uno por malla del nivel 0 (vacío = estática).
+        std::vector<std::vector<MorphTarget>> morphs; ///< Blend shapes de cada malla del nivel 0 (vacío = sin morphs).
+    };
+
+    /** @brief Ruta del archivo de un modelo (`<origen>.sanim`). */
+    static std::string getCachePath(const std::string& sourcePath) { return sourcePath + ".sanim"; }
+
+    /**
+     * @brief Lee el archivo si existe y su clave coincide.
+     * @return `S_OK`; `E_FAIL` si no existe, `E_ABORT` si la clave o la versión no
+     * coinciden o `E_INVALIDARG` si está truncado.
+     */
+    static HRESULT load(const std::string& path, unsigned long long key, Animations& animations);
+
+    /** @brief Escribe el archivo (a un temporal que luego se renombra). */
+    static HRESULT write(const std::string& path, unsigned long long key, const Animations& animations);
+};
@@ -0,0 +1,217 @@
+﻿/**
+ * @file AnimationSystem.h
+ * @brief Reproducción de clips por personaje y cálculo de sus paletas de huesos.
+ *
+ * @details
+ * Cada personaje animado es una **instancia**: esqueleto, clip, tiempo y su paleta.
+ * @ref AnimationSystem::update avanza todas y las evalúa por lotes en el
+ * `JobSystem`. Por instancia se hace:
+ *
+ * 1. @ref AnimationClip::sample: pose local (rotaciones con `EU::NlerpQuaternions`).
+ * 2. `EU::QuaternionsToMatrices`: una `Matrix3x4` local por hueso, 4 a la vez.
+ * 3. Jerarquía: `global = global(padre) * local`, en orden (los padres van antes).
+ * 4. Paleta: `global * inverseBind`, lista para el skinning (`float3x4` en HLSL).
+ *
+ * **Coste acotado**: el esqueleto y los clips son compartidos; una instancia guarda
+ * la paleta (48 bytes por hueso) y un cursor por pista (6 bytes por hueso), unos
+ * 5 KB con 100 huesos, así que 500 personajes caben en ~2.7 MB. Evaluar no reserva
+ * memoria (el trabajo va en la pila) ni busca claves al reproducir hacia delante.
+ * Una instancia cuyo tiempo no cambió (pausada, o al final de un clip sin bucle) no
+ * se evalúa, y su @ref AnimationSystem::getPoseVersion tampoco cambia: así
+ * `SkinningSystem` sabe que no hace falta volver a deformar su malla.
+ *
+ * **Ritmo por importancia** (@ref RateSettings): en una multitud casi todos los
+ * personajes están lejos o tapados. Con lo que dibujó el último frame
+ * (@ref beginVisibility, @ref markVisible, @ref endVisibility) cada instancia elige
+ * cada cuántos pasos se evalúa, con el mismo tamaño en pantalla que el LOD de mallas:
+ *
+ * - **Cerca**: todos los pasos, como siempre.
+ * - **Media distancia**: cada `n` pasos se evalúa la pose de `n - 1` pasos más adelante
+ *   y, entre medias, la paleta se interpola de la anterior a esa (mezclar 12 floats por
+ *   hueso en lugar de muestrear, convertir y recorrer la jerarquía).
+ * - **Sin dibujar**: la pose se congela pero el tiempo sigue; al volver a verse se
+ *   evalúa entera en el primer paso, sin saltos de ritmo.
+ *
+ * @note Para estudiantes: la paleta va en el espacio de la malla; la matriz de mundo
+ * del actor se aplica después, como en una malla estática.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "Animation.h"
+
+/**
+ * @class AnimationSystem
+ * @brief Conjunto de instancias animadas con su paleta por frame.
+ */
+class AnimationSystem {
+public:
+    /// Identificador de una instancia (índice estable hasta `destroy`).
+    typedef unsigned int InstanceID;
+    /// Identificador que no corresponde a ninguna instancia.
+    static const InstanceID kInvalidInstance = 0xFFFFFFFF;
+    /// Instancias mínimas por trabajo de @ref update.
+    static const unsigned int kInstanceBatch = 8;
+
+    /// Cada cuántos pasos se evalúa una instancia según su importancia.
+    struct RateSettings {
+        bool enabled = true;                ///< Sin esto, todas en cada paso.
+        float fullRateScreenSize = 0.2f;    ///< Tamaño en pantalla desde el que se evalúa en cada paso.
+        float minRateScreenSize = 0.03f;    ///< Tamaño por debajo del cual se evalúa cada `maxInterval` pasos.
+        unsigned int maxInterval = 4;       ///< Pasos por evaluación como máximo (interpolando entre medias).
+        bool freezeHidden = true;           ///< Congelar la pose de las que no se dibujaron.
+    };
+
+    /**
+     * @brief Crea una instancia en la pose de enlace.
+     * @param skeleton Esqueleto (no se copia: debe vivir más que la instancia).
+     * @return `kInvalidInstance` si el esqueleto está vacío o pasa de `Skeleton::kMaxJoints`.
+     */
+    InstanceID create(const Skeleton* skeleton);
+
+    /** @brief Libera la instancia; su identificador se reutiliza. */
+    void destroy(InstanceID id);
+
+    /** @brief Elimina todas las instancias. */
+    void clear();
+
+    /**
+     * @brief Empieza a reproducir un clip desde el principio.
+     * @param clip Clip del mismo esqueleto (no se copia), o `nullptr` para la pose de enlace.
+     * @param loop Volver al principio al llegar al final (si no, se queda en el último fotograma).
+     * @param speed Multiplicador del tiempo (negativo = hacia atrás).
+     * @return `false` si el clip es de otro número de huesos.
+     */
+    bool play(InstanceID id, const AnimationClip* clip, bool loop = true, float speed = 1.0f);
+
+    /** @brief Salta a un instante del clip (segundos). */
+    void setTime(InstanceID id, float seconds);
+
+    /** @brief Instante actual del clip (segundos). */
+    float getTime(InstanceID id) const;
+
+    /** @brief Cambia la velocidad de reproducción. */
+    void setSpeed(InstanceID id, float speed);
+
+    /**
+     * @brief Peso de un blend shape de la instancia (índice de `SkinningSystem::findMorphTarget`).
+     * @note Solo sube la versión de la pose si el peso cambia. Fuera de @ref update.
+     */
+    void setMorphWeight(InstanceID id, unsigned int target, float weight);
+
+    /** @brief Peso de un blend shape (0 si nunca se fijó). */
+    float getMorphWeight(InstanceID id, unsigned int target) const;
+
+    /**
+     * @brief Pesos de blend shape de la instancia, por índice de objetivo.
+     * @param count Recibe cuántos hay (los que faltan valen 0).
+     */
+    const float* getMorphWeights(InstanceID id, unsigned int& count) const;
+
+    const RateSettings& getRateSettings() const { return m_rate; }
+    void setRateSettings(const RateSettings& settings) { m_rate = settings; }
+
+    /** @brief Empieza a recoger la visibilidad: todas pasan a no dibujadas. */
+    void beginVisibility();
+
+    /**
+     * @brief Un actor de la instancia se dibujó.
+     * @param screenSize Su tamaño en pantalla (`Actor::getScreenSize`); con varios
+     * actores cuenta el mayor.
+     */
+    void markVisible(InstanceID id, float screenSize);
+
+    /**
+     * @brief Fija el ritmo de cada instancia con lo recogido desde @ref beginVisibility.
+     * @note Fuera de @ref update. Reserva aquí (no en `update`) la pose de llegada de las
+     * que pasan a interpolar.
+     */
+    void endVisibility();
+
+    /**
+     * @brief Avanza el tiempo de todas las instancias y recalcula sus paletas.
+     * @param deltaTime Segundos desde la última llamada.
+     * @param parallel Repartir las instancias entre los hilos del `JobSystem`.
+     */
+    void update(float deltaTime, bool parallel = true);
+
+    /**
+     * @brief Paleta de la instancia: una matriz por hueso (malla -> malla animada).
+     * @return `nullptr` si el identificador no es válido.
+     */
+    const EU::Matrix3x4* getPalette(InstanceID id) const;
+
+    /** @brief Número de matrices de la paleta (los huesos del esqueleto). */
+    unsigned int getPaletteSize(InstanceID id) const;
+
+    /**
+     * @brief Contador que sube cada vez que cambia la paleta de la instancia.
+     * @return 0 si el identificador no es válido (una instancia viva nunca vale 0).
+     */
+    unsigned int getPoseVersion(InstanceID id) const;
+
+    /** @brief Instancias vivas. */
+    unsigned int getInstanceCount() const { return static_cast<unsigned int>(m_instances.size() - m_free.size()); }
+
+    /** @brief Bytes que ocupan las instancias (sin esqueletos ni clips, que son compartidos). */
+    size_t getMemoryUsage() const;
+
+    /** @brief Poses evaluadas (muestreo y jerarquía) en el último @ref update. */
+    unsigned int getEvaluatedCount() const { return m_evaluatedCount; }
+
+    /** @brief Paletas interpoladas sin evaluar en el último @ref update. */
+    unsigned int getInterpolatedCount() const { return m_interpolatedCount; }
+
+    /** @brief Instancias congeladas (sin dibujar) en el último @ref update. */
+    unsigned int getFrozenCount() const { return m_frozenCount; }
+
+    /**
+     * @brief Evalúa una pose y su paleta sin instancia.
+     * @param skeleton Esqueleto de la pose.
+     * @param clip Clip a muestrear, o `nullptr` para la pose de enlace.
+     * @param time Segundos desde el inicio del clip.
+     * @param cursors Cursores de las pistas del clip (ver @ref AnimationClip::sample).
+     * @param palette Recibe `skeleton.getJointCount()` matrices.
+     */
+    static void evaluate(const Skeleton& skeleton, const AnimationClip* clip, float time,
+        uint16_t* cursors, EU::Matrix3x4* palette);
+
+private:
+    struct Instance {
+        const Skeleton* skeleton = nullptr;   ///< `nullptr` = hueco libre.
+        const AnimationClip* clip = nullptr;
+        float time = 0.0f;
+        float speed = 1.0f;
+        bool loop = true;
+        float evaluatedTime = 0.0f;           ///< `time` de la paleta actual.
+        unsigned int version = 0;             ///< Ver @ref getPoseVersion.
+        std::vector<uint16_t> cursors;        ///< Una por pista del clip.
+        std::vector<EU::Matrix3x4> palette;   ///< Una por hueso.
+        float screenSize = 0.0f;              ///< Mayor tamaño en pantalla de sus actores.
+        bool visible = true;                  ///< Algún actor suyo se dibujó.
+        unsigned int interval = 1;            ///< Pasos por evaluación (0 = congelada).
+        unsigned int step = 0;                ///< Paso dentro del tramo interpolado.
+        bool resync = false;                  ///< Evaluar entera en el próximo paso.
+        std::vector<EU::Matrix3x4> keys;      ///< Con `interval > 1`: paleta de partida y de llegada del tramo.
+        std::vector<float> morphWeights;      ///< Crece con @ref setMorphWeight.
+    };
+
+    Instance* find(InstanceID id);
+    const Instance* find(InstanceID id) const;
+    void advance(Instance& instance, float deltaTime);
+    void refresh(Instance& instance);
+    /** @brief Un paso de un tramo interpolado; `true` si evaluó la pose de llegada. */
+    bool interpolate(Instance& instance, float deltaTime);
+    /** @brief `time` llevado al rango del clip (en bucle o parado en los extremos). */
+    static float wrapTime(const Instance& instance, float time);
+    /** @brief Ritmo de la instancia según @ref RateSettings. */
+    unsigned int selectInterval(const Instance& instance) const;
+    static void bumpVersion(Instance& instance);
+
+    std::vector<Instance> m_instances;
+    std::vector<InstanceID> m_free;
+    RateSettings m_rate;
+    unsigned int m_evaluatedCount = 0;
+    unsigned int m_interpolatedCount = 0;
+    unsigned int m_frozenCount = 0;
+};
@@ -0,0 +1,75 @@
+﻿/**
+ * @file AssetCooker.h
+ * @brief Cocinado offline: deja todas las cachés de runtime escritas antes de distribuir.
+ *
+ * @details
+ * El motor ya guarda en disco el resultado de cada importación la primera vez que la
+ * hace (`.smesh`/`.sanim`, DDS comprimidos, `ShaderCache/<hash>.cso`), pero eso ocurre
+ * al arrancar en la máquina del jugador. Con `-cook manifiesto.txt` la aplicación lo
+ * hace todo de una vez, sin ventana ni dispositivo, y sale:
+ *
+ * - **Shaders**: cada `.fx` de la carpeta de trabajo con sus puntos de entrada (`VS`,
+ *   `PS`, `CS...`), sin palabras clave y con las combinaciones de `ShaderVariants.txt`
+ *   (@ref ShaderLibrary::cookToDisk). Perfil de 11_0: es con el que arranca el motor.
+ * - **Modelos**: los `.fbx` y `.obj` de `ModelsFBX` pasan por `ModelLoader` con los
+ *   mismos parámetros de LOD que el runtime, así la clave de su `.smesh` coincide.
+ * - **Texturas**: los PNG/JPG/TGA de `ModelsFBX` y `Textures` se codifican a BCn (`AUTO`,
+ *   el formato que pide el cargador) con toda su cadena de mips.
+ *
+ * Lo que ya está al día no se vuelve a hacer. El manifiesto lista cada archivo cocinado
+ * (`tipo origen -> caché`); el runtime no lo lee, encuentra las cachés por las mismas
+ * rutas que si las hubiera escrito él. Con `-pack archivo.spak`, esas cachés y los
+ * fuentes de los shaders (su hash decide qué `.cso` vale) se empaquetan además en un
+ * solo archivo (@ref VirtualFileSystem::writePack), comprimidos con LZ4: rápido para
+ * texturas y mallas, nivel alto para los shaders.
+ *
+ * @note Para estudiantes: el runtime sigue sabiendo importar; cocinar solo mueve ese
+ * trabajo del arranque del jugador a la máquina de build.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+
+/**
+ * @class AssetCooker
+ * @brief Recorre las carpetas de recursos y escribe sus cachés y el manifiesto.
+ */
+class AssetCooker {
+public:
+    /// Carpeta de modelos (y de sus texturas), relativa al directorio de trabajo.
+    static const char* const kModelDirectory;
+    /// Carpeta de texturas sueltas.
+    static const char* const kTextureDirectory;
+    /// Lista de permutaciones (la misma que usa `ShaderPermutations::precompile`).
+    static const char* const kVariantList;
+
+    /// Resultado de una pasada.
+    struct Stats {
+        unsigned int cooked = 0;   ///< Archivos escritos.
+        unsigned int upToDate = 0; ///< Archivos que ya estaban al día.
+        unsigned int failed = 0;   ///< Errores (ver el log del depurador).
+    };
+
+    /**
+     * @brief Cocina shaders, modelos y texturas y escribe el manifiesto.
+     * @param manifestPath Archivo de texto con la lista de cachés.
+     * @param packPath Paquete a escribir con lo cocinado (vacío = sin paquete).
+     * @return `S_OK`, o `E_FAIL` si algún recurso falló o no se pudo escribir el
+     * manifiesto o el paquete.
+     */
+    static HRESULT run(const std::string& manifestPath, const std::string& packPath = std::string());
+
+private:
+    /// Archivos bajo `directory` (recursivo) con alguna de las extensiones dadas (minúsculas, sin punto).
+    static std::vector<std::string> findFiles(const std::string& directory,
+        const std::vector<std::string>& extensions);
+
+    /// Variantes de todos los `.fx` del directorio de trabajo.
+    static void cookShaders(std::vector<std::string>& manifest, Stats& stats);
+
+    /// `.smesh` (y `.sanim`) de un modelo.
+    static void cookModel(const std::string& path, std::vector<std::string>& manifest, Stats& stats);
+
+    /// DDS comprimido con mips de una imagen.
+    static void cookTexture(const std::string& path, std::vector<std::string>& manifest, Stats& stats);
+};
@@ -0,0 +1,114 @@
+﻿/**
+ * @file AssetHotReload.h
+ * @brief Recarga en caliente de modelos y texturas: reimporta en segundo plano lo que cambió.
+ *
+ * @details
+ * Retocar una textura o reexportar un FBX obligaba a reiniciar. Igual que
+ * `ShaderHotReload` con los `.fx`, un hilo vigila la carpeta de trabajo con
+ * `ReadDirectoryChangesW` (solo `.fbx`, `.obj`, `.png` y `.jpg`) y espera
+ * @ref AssetHotReload::kSettleMs sin escrituras antes de avisar: un exportador escribe el
+ * archivo en varias pasadas.
+ *
+ * @ref AssetHotReload::update (hilo principal, frontera de frame) reparte los cambios:
+ *
+ * - **Textura**: `AsyncTextureLoader::reload` vuelve a encolar las texturas que tienen ese
+ *   archivo entre sus candidatas. El hilo de texturas decodifica (la caché DDS ya no es
+ *   válida: su clave es la fecha del original) y el cargador cambia la textura en el
+ *   mismo handle, como con el placeholder.
+ * - **Modelo**: si la `MeshLibrary` tiene un asset con esa ruta, se reimporta en un hilo
+ *   de carga del `ResourceManager` (la caché `.smesh` se regenera por el mismo motivo) y
+ *   `MeshLibrary::replace` intercambia la geometría dentro del mismo `MeshAsset`.
+ *
+ * Solo se sustituyen los recursos afectados y los handles no cambian: cada actor que
+ * tenía la textura o la malla dibuja la nueva en el frame siguiente.
+ *
+ * @note Para estudiantes: las mallas con skinning son un asset por actor fuera de la
+ * biblioteca (con su esqueleto y sus clips); esas no se recargan, se reinicia.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include <mutex>
+
+class Device;
+class MeshLibrary;
+class AsyncTextureLoader;
+class ResourceManager;
+
+/**
+ * @class AssetHotReload
+ * @brief Hilo que vigila los archivos de modelos y texturas y los recarga al cambiar.
+ */
+class AssetHotReload {
+public:
+    AssetHotReload() = default;
+    ~AssetHotReload() { destroy(); }
+
+    /// Milisegundos sin cambios antes de recargar (un FBX grande se escribe en varias pasadas).
+    static const unsigned int kSettleMs = 300;
+
+    /**
+     * @brief Empieza a vigilar un directorio.
+     * @param device Dispositivo de las mallas nuevas.
+     * @param resources Hilos de carga para reimportar los modelos.
+     * @param meshes Biblioteca donde se sustituyen las mallas.
+     * @param textures Cargador que recarga las texturas.
+     * @param directory Carpeta de los recursos (y sus subcarpetas); las rutas se comparan
+     * relativas a ella.
+     * @return Error si no se pudo abrir la carpeta (sin recarga; el motor sigue funcionando).
+     */
+    HRESULT init(Device& device, ResourceManager& resources, MeshLibrary& meshes,
+        AsyncTextureLoader& textures, const std::string& directory = ".");
+
+    /**
+     * @brief Encola la recarga de lo que cambió y cuenta las mallas ya sustituidas.
+     * @return Mallas sustituidas desde la llamada anterior (quien tenga datos derivados de
+     * su geometría, como los lotes estáticos, debe rehacerlos).
+     * @note Hilo principal, después de `ResourceManager::update`.
+     */
+    unsigned int update();
+
+    /** @brief Para el hilo y cierra la carpeta (las reimportaciones en curso se descartan). */
+    void destroy();
+
+    /** @brief Hay un hilo vigilando. */
+    bool isWatching() const { return m_thread.joinable(); }
+
+    /** @brief Recursos recargados (mallas y texturas encoladas) desde @ref init. */
+    unsigned int getReloadCount() const { return m_reloadCount; }
+
+private:
+    /// Bucle del hilo: espera cambios en la carpeta y los agrupa.
+    void threadLoop();
+
+    /// Lee las notificaciones completadas y guarda las rutas de recursos.
+    void readChanges();
+
+    /// Vuelve a pedir notificaciones a `ReadDirectoryChangesW`.
+    bool watch();
+
+    /// Reimporta el modelo `name` de la biblioteca y lo sustituye al publicar.
+    void reimport(const std::string& name);
+
+    Device* m_device = nullptr;
+    ResourceManager* m_resources = nullptr;
+    MeshLibrary* m_meshes = nullptr;
+    AsyncTextureLoader* m_textures = nullptr;
+    std::string m_directory;
+    HANDLE m_directoryHandle = INVALID_HANDLE_VALUE;
+    HANDLE m_changeEvent = nullptr;          ///< Evento de `m_overlapped`.
+    HANDLE m_stopEvent = nullptr;            ///< `destroy` en marcha.
+    OVERLAPPED m_overlapped = {};
+    std::vector<DWORD> m_notifyBuffer;       ///< `FILE_NOTIFY_INFORMATION` (alineado a DWORD).
+    std::vector<std::string> m_settling;     ///< Rutas cambiadas desde la última espera (solo el hilo).
+    std::thread m_thread;
+
+    std::mutex m_mutex;                      ///< Protege `m_changed`.
+    std::vector<std::string> m_changed;      ///< Rutas asentadas, a la espera de @ref update.
+
+    // === Hilo principal ===
+    std::vector<std::string> m_importing;    ///< Modelos reimportándose.
+    std::vector<std::string> m_stale;        ///< Cambiaron otra vez durante su reimportación.
+    unsigned int m_replaced = 0;             ///< Mallas sustituidas sin contar aún en @ref update.
+    unsigned int m_reloadCount = 0;
+};
@@ -0,0 +1,224 @@
+﻿/**
+ * @file AssetTask.h
+ * @brief Corrutinas (C++20) para escribir cargas de varios pasos sin callbacks.
+ *
+ * @details
+ * Con @ref ResourceFuture::then, una carga de varios pasos (malla, luego su material,
+ * luego algo calculado con los dos) acaba en continuaciones anidadas. Una función que
+ * devuelve @ref Task se escribe en orden y se suspende con `co_await`:
+ *
+ * - `co_await handle` (un @ref ResourceHandle): espera a que el recurso se publique y
+ *   devuelve su valor (nulo si falló).
+ * - `co_await onLoader(resources, f)`: ejecuta `f` en un hilo de carga (puede leer disco)
+ *   y devuelve su resultado.
+ * - `co_await onJobs(resources, f)`: igual, en el `JobSystem` (CPU sin esperas, p. ej.
+ *   decodificar).
+ * - `co_await nextFrame(resources)`: sigue en el frame siguiente.
+ * - `co_await task`: espera a otra @ref Task y devuelve lo que ella devuelva.
+ *
+ * Para solapar cargas se piden todas antes del primer `co_await`: cada petición arranca
+ * al hacerse y el `co_await` solo espera a la que toque.
+ *
+ * Una corrutina siempre se reanuda en el hilo principal, dentro de
+ * `ResourceManager::update` (frontera de frame): entre dos `co_await` puede tocar actores
+ * y handles como cualquier código del frame. Lo que va a otros hilos son las funciones de
+ * `onLoader`/`onJobs`, que no deben tocar handles (cuentan referencias sin atómicos).
+ *
+ * Una @ref Task empieza a ejecutarse al llamarla. Si se descarta, la corrutina sigue sola
+ * y libera su estado al terminar.
+ *
+ * @note Para estudiantes: si el `ResourceManager` se destruye con una corrutina
+ * suspendida, esta no se reanuda (su estado se pierde al cerrar la aplicación).
+ */
+
+#pragma once
+#include "ResourceManager.h"
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <type_traits>
+
+/// Parte común de las promesas de @ref Task.
+struct TaskPromiseBase {
+    std::coroutine_handle<> continuation; ///< Corrutina que espera a esta (`co_await task`).
+    bool detached = false;                ///< La @ref Task se descartó: se libera al terminar.
+
+    /// Al terminar: sigue con quien espera o, si nadie la tiene, se libera.
+    struct FinalAwaiter {
+        bool await_ready() const noexcept { return false; }
+
+        template<typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+            TaskPromiseBase& promise = handle.promise();
+            if (promise.continuation) {
+                return promise.continuation;
+            }
+            if (promise.detached) {
+                handle.destroy();
+            }
+            return std::noop_coroutine();
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    std::suspend_never initial_suspend() const noexcept { return {}; }
+    FinalAwaiter final_suspend() const noexcept { return {}; }
+    /// El motor no usa excepciones: una que escape de una corrutina es un error de programa.
+    void unhandled_exception() const { std::terminate(); }
+};
+
+/// Promesa con el valor devuelto por `co_return`.
+template<typename T>
+struct TaskPromise : TaskPromiseBase {
+    std::optional<T> value;
+
+    void return_value(T result) { value = std::move(result); }
+    T take() { return std::move(*value); }
+};
+
+template<>
+struct TaskPromise<void> : TaskPromiseBase {
+    void return_void() const {}
+    void take() const {}
+};
+
+/**
+ * @class Task
+ * @brief Corrutina de carga; `co_await` sobre ella espera su resultado.
+ */
+template<typename T = void>
+class Task {
+public:
+    struct promise_type : TaskPromise<T> {
+        Task get_return_object() {
+            return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+    };
+
+    Task(Task&& other) noexcept : m_handle(other.m_handle) { other.m_handle = nullptr; }
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            release();
+            m_handle = other.m_handle;
+            other.m_handle = nullptr;
+        }
+        return *this;
+    }
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task() { release(); }
+
+    /** @brief `true` si la corrutina terminó (o la tarea está vacía). */
+    bool isDone() const { return !m_handle || m_handle.done(); }
+
+    bool await_ready() const noexcept { return isDone(); }
+    void await_suspend(std::coroutine_handle<> awaiting) { m_handle.promise().continuation = awaiting; }
+    /// @warning Solo sobre una tarea no vacía (no movida).
+    T await_resume() { return m_handle.promise().take(); }
+
+private:
+    explicit Task(std::coroutine_handle<promise_type> handle) : m_handle(handle) {}
+
+    void release() {
+        if (!m_handle) {
+            return;
+        }
+        if (m_handle.done()) {
+            m_handle.destroy();
+        }
+        else {
+            m_handle.promise().detached = true;
+        }
+        m_handle = nullptr;
+    }
+
+    std::coroutine_handle<promise_type> m_handle;
+};
+
+/// Espera a la publicación de un futuro del @ref ResourceManager.
+template<typename T>
+struct ResourceAwaiter {
+    ResourceHandle<T> future;
+
+    bool await_ready() const { return future.isNull() || future->isDone(); }
+    void await_suspend(std::coroutine_handle<> handle) { future->onDone([handle]() { handle.resume(); }); }
+    EU::TSharedPointer<T> await_resume() const {
+        return future.isNull() ? EU::TSharedPointer<T>() : future->get();
+    }
+};
+
+template<typename T>
+ResourceAwaiter<T> operator co_await(const ResourceHandle<T>& future) {
+    return ResourceAwaiter<T>{ future };
+}
+
+/// Ejecuta una función fuera del hilo principal y se reanuda con su resultado.
+template<typename F>
+class WorkAwaiter {
+public:
+    typedef std::invoke_result_t<F&> Result;
+
+    WorkAwaiter(ResourceManager& resources, F work, bool onJobs)
+        : m_resources(resources), m_work(std::move(work)), m_onJobs(onJobs) {}
+
+    bool await_ready() const noexcept { return false; }
+
+    void await_suspend(std::coroutine_handle<> handle) {
+        // El awaiter vive en el estado de la corrutina hasta que esta se reanude.
+        std::function<bool()> work = [this]() {
+            if constexpr (std::is_void_v<Result>) {
+                m_work();
+            }
+            else {
+                m_result.emplace(m_work());
+            }
+            return true;
+        };
+        std::function<void(bool)> done = [handle](bool) { handle.resume(); };
+        if (m_onJobs) {
+            m_resources.runOnJobs(std::move(work), std::move(done));
+        }
+        else {
+            m_resources.runOnLoader(std::move(work), std::move(done));
+        }
+    }
+
+    Result await_resume() {
+        if constexpr (!std::is_void_v<Result>) {
+            return std::move(*m_result);
+        }
+    }
+
+private:
+    ResourceManager& m_resources;
+    F m_work;
+    bool m_onJobs;
+    std::optional<std::conditional_t<std::is_void_v<Result>, bool, Result>> m_result;
+};
+
+/** @brief `co_await onLoader(resources, f)`: `f()` en un hilo de carga (disco permitido). */
+template<typename F>
+WorkAwaiter<F> onLoader(ResourceManager& resources, F work) {
+    return WorkAwaiter<F>(resources, std::move(work), false);
+}
+
+/** @brief `co_await onJobs(resources, f)`: `f()` en el `JobSystem` (solo CPU). */
+template<typename F>
+WorkAwaiter<F> onJobs(ResourceManager& resources, F work) {
+    return WorkAwaiter<F>(resources, std::move(work), true);
+}
+
+/// Cede el resto del frame.
+struct FrameAwaiter {
+    ResourceManager& resources;
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle) { resources.post([handle]() { handle.resume(); }); }
+    void await_resume() const noexcept {}
+};
+
+/** @brief `co_await nextFrame(resources)`: sigue en el siguiente `ResourceManager::update`. */
+inline FrameAwaiter nextFrame(ResourceManager& resources) {
+    return FrameAwaiter{ resources };
+}
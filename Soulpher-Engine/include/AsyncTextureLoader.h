@@ -0,0 +1,255 @@
+﻿/**
+ * @file AsyncTextureLoader.h
+ * @brief Carga de texturas en hilos de trabajo con un placeholder mientras tanto.
+ *
+ * @details
+ * `load` devuelve al instante un @ref TextureHandle que apunta a un placeholder de
+ * 1x1 (gris medio). Un hilo del pool:
+ * 1. Prueba las rutas candidatas en orden (p. ej. `axl_D.png`, `axl_wq_D.png`,
+ *    `Textures\Default.dds`) hasta que una se lee: los reintentos ya no paran el hilo
+ *    principal.
+ * 2. Decodifica (stb / D3DX) y crea la textura y su SRV desde el propio hilo: el
+ *    `ID3D11Device` es libre de hilos, solo el contexto inmediato no lo es.
+ *
+ * @ref update, en el hilo principal y una vez por frame, cambia el contenido del
+ * handle por la textura real. Como los actores y los paquetes de la `RenderQueue`
+ * guardan el mismo objeto `Texture`, el siguiente frame ya la usa.
+ *
+ * Además hace de caché: pedir otra vez las mismas candidatas (misma ruta normalizada
+ * y formato) devuelve el mismo handle, sin volver a leer el archivo ni crear otra
+ * textura en VRAM. La caché guarda una referencia; cuando es la única que queda,
+ * @ref update libera la textura.
+ *
+ * **Streaming de mips**: la primera carga sube solo los mips de hasta
+ * @ref setInitialSize texeles de lado. Cada frame el render pide con
+ * @ref requestTexels cuántos texeles necesita cada textura (tamaño en pantalla de
+ * los actores que la usan / extensión de sus UV); si hace falta un mip más
+ * detallado que el residente se encola una recarga a esa resolución. Con un
+ * presupuesto de VRAM (@ref setVramBudget) la subida solo se encola si cabe; si no,
+ * primero se bajan de resolución las texturas usadas hace más tiempo (LRU) que
+ * tienen más mips de los que piden. D3D11 no deja cambiar los mips de una textura
+ * inmutable: cada cambio de residencia crea en un hilo otra textura con los mips
+ * nuevos y @ref update la cambia en el handle, igual que con el placeholder.
+ *
+ * @note Para estudiantes: los handles (`TSharedPointer`) cuentan referencias sin
+ * atómicos, así que los hilos de trabajo nunca los tocan; solo ven un número de
+ * trabajo y devuelven una `Texture` suelta.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "Texture.h"
+#include <climits>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+class Device;
+
+/**
+ * @class AsyncTextureLoader
+ * @brief Pool de hilos que carga texturas y las sustituye en sus handles.
+ */
+class AsyncTextureLoader {
+public:
+    AsyncTextureLoader() = default;
+    ~AsyncTextureLoader() { destroy(); }
+
+    /// Hilos como máximo (leer disco y decodificar PNG escala poco más allá).
+    static const unsigned int kMaxWorkers = 4;
+
+    /// Lado máximo por defecto de la primera carga (los mips mayores llegan al pedirlos).
+    static const unsigned int kDefaultInitialSize = 256;
+
+    /// Una ruta candidata: archivo sin extensión, formato y compresión en VRAM.
+    struct Source {
+        std::string name;
+        ExtensionType extension;
+        TextureCompression compression = TEXTURE_COMPRESSION_AUTO; ///< Solo PNG/JPG (caché DDS).
+    };
+
+    /**
+     * @brief Crea el placeholder y arranca los hilos.
+     * @param device Dispositivo (su `ID3D11Device` se retiene mientras viva el cargador).
+     * @param workerCount Hilos; 0 = núcleos - 1, entre 1 y @ref kMaxWorkers.
+     * @return `S_OK` o el error al crear el placeholder.
+     */
+    HRESULT init(Device& device, unsigned int workerCount = 0);
+
+    /**
+     * @brief Evento que los hilos señalan al terminar una carga (p. ej. el de
+     * `BaseApp::requestRedraw`, para que el editor en reposo despierte y la muestre).
+     */
+    void setNotifyEvent(HANDLE event) { m_notifyEvent = event; }
+
+    /**
+     * @brief Devuelve la textura de la caché o encola su carga.
+     * @param sources Candidatas por orden de preferencia; la primera que se lea gana.
+     * @return Handle que muestra el placeholder hasta que la carga termine (o para
+     * siempre si ninguna candidata existe). Las mismas candidatas dan el mismo handle.
+     */
+    TextureHandle load(const std::vector<Source>& sources);
+
+    /** @brief Encola la carga de un único archivo. */
+    TextureHandle load(const std::string& name, ExtensionType extension) {
+        return load(std::vector<Source>{ { name, extension } });
+    }
+
+    /**
+     * @brief Sustituye en sus handles las texturas ya cargadas y libera las que solo
+     * sigue usando la caché (hilo principal).
+     * @return Texturas sustituidas en esta llamada.
+     */
+    unsigned int update();
+
+    /**
+     * @brief Bloquea hasta que no quede nada en cola ni en curso y llama a @ref update.
+     * @note Para el modo benchmark: medir sin cargas pendientes.
+     */
+    void waitIdle();
+
+    /** @brief Cargas encoladas o en curso. */
+    unsigned int getPendingCount() const;
+
+    /**
+     * @brief La primera carga de `handle` ya terminó (hilo principal, tras @ref update).
+     * @param loaded Recibe si tiene su textura; `false` si ninguna candidata se leyó y se
+     * queda el placeholder (o si el handle no es de este cargador).
+     * @return `false` mientras siga en cola o en curso.
+     */
+    bool isSettled(const TextureHandle& handle, bool& loaded) const;
+
+    /**
+     * @brief Vuelve a cargar las texturas que tienen `path` entre sus candidatas (el
+     * archivo cambió en disco; ver `AssetHotReload`).
+     * @param path Archivo con extensión (p. ej. `Textures\\piedra.png`).
+     * @return Texturas encoladas; la nueva se cambia en el mismo handle en @ref update,
+     * con la resolución residente que tenía.
+     */
+    unsigned int reload(const std::string& path);
+
+    /**
+     * @brief Pide resolución para una textura en el frame actual (hilo principal).
+     * @param handle Handle devuelto por @ref load.
+     * @param texels Texeles de lado que cubren lo que se ve en pantalla; de varias
+     * peticiones en el mismo frame se queda la mayor.
+     */
+    void requestTexels(const TextureHandle& handle, float texels);
+
+    /**
+     * @brief Presupuesto de VRAM para las texturas del cargador.
+     * @param bytes Bytes como máximo; 0 = sin límite.
+     * @note Es un objetivo, no un límite duro: los mips mínimos de cada textura
+     * siempre se quedan aunque no quepan.
+     */
+    void setVramBudget(size_t bytes) { m_vramBudget = bytes; }
+
+    /** @brief Presupuesto actual (0 = sin límite). */
+    size_t getVramBudget() const { return m_vramBudget; }
+
+    /** @brief Lado máximo de la primera carga (0 = imagen completa desde el principio). */
+    void setInitialSize(unsigned int texels) { m_initialSize = texels; }
+
+    /** @brief Bytes de VRAM de los mips residentes de todas las texturas de la caché. */
+    size_t getResidentBytes() const { return m_residentBytes; }
+
+    /** @brief Texturas distintas en la caché. */
+    unsigned int getCachedCount() const { return static_cast<unsigned int>(m_cache.size()); }
+
+    /** @brief Llamadas a @ref load resueltas con una textura ya pedida. */
+    unsigned long long getCacheHits() const { return m_cacheHits; }
+
+    /**
+     * @brief Clave de caché: rutas normalizadas (minúsculas, `\`, sin `.` ni `..`), formato
+     * y compresión.
+     * @note Las opciones de carga que afecten al resultado tienen que formar parte de la clave.
+     */
+    static std::string makeKey(const std::vector<Source>& sources);
+
+    /** @brief Para los hilos (lo pendiente se descarta) y libera el placeholder. */
+    void destroy();
+
+private:
+    /// Lo que ve un hilo de trabajo: número de trabajo, candidatas y resolución.
+    struct Job {
+        unsigned long long id;
+        std::vector<Source> sources;
+        unsigned int maxSize;            ///< Lado máximo del mip más detallado (0 = completa).
+    };
+
+    /// Resultado de un trabajo, a la espera de `update`.
+    struct Result {
+        unsigned long long id;
+        HRESULT hr;
+        Texture texture;
+    };
+
+    /// Una textura de la caché y su estado de streaming (solo hilo principal).
+    struct Entry {
+        TextureHandle handle;
+        std::vector<Source> sources;     ///< Candidatas (la recarga repite la búsqueda).
+        unsigned long long lastUsed = 0; ///< Último frame con @ref requestTexels.
+        float wantedTexels = 0.0f;       ///< Mayor petición del frame.
+        unsigned int pendingSize = 0;    ///< `maxSize` de la carga en curso.
+        unsigned int pendingMip = 0;     ///< Mip que dejará residente esa carga (si ya estaba cargada).
+        unsigned int mipFloor = UINT_MAX; ///< Mip menos detallado alcanzable (BCn: múltiplo de 4).
+        bool pending = false;            ///< Hay una carga en la cola o en curso.
+        bool loaded = false;             ///< Ya no muestra el placeholder.
+        bool failed = false;             ///< Una recarga falló: no se vuelve a intentar.
+        bool stale = false;              ///< El archivo cambió con una carga en curso: repetirla.
+    };
+
+    /// Trabajo en curso y la entrada de la caché que lo espera.
+    struct Target {
+        unsigned long long id;
+        std::string key;
+        TextureHandle handle;
+    };
+
+    /// Encola un trabajo para una entrada.
+    void enqueue(const std::string& key, Entry& entry, unsigned int maxSize);
+
+    /// Mip menos detallado que aún da `texels` de lado.
+    static unsigned int getDesiredMip(const Texture& texture, float texels);
+
+    /// Mip que deja residente una carga con `maxSize` (la misma regla que `Texture::init`).
+    static unsigned int getMipForSize(const Texture& texture, unsigned int maxSize);
+
+    /// Bytes estimados con `mip` como mip más detallado (x4 por cada mip más).
+    static size_t estimateBytes(const Texture& texture, unsigned int mip);
+
+    /// Recargas de mayor o menor resolución según las peticiones y el presupuesto.
+    void updateStreaming();
+
+    /// Bucle de cada hilo: toma trabajos de la cola hasta `destroy`.
+    void workerLoop();
+
+    /// Libera las texturas de la caché que ya nadie más referencia.
+    void releaseUnused();
+
+    ID3D11Device* m_device = nullptr;    ///< Retenido (AddRef) para los hilos.
+    HANDLE m_notifyEvent = nullptr;      ///< Se señala con cada resultado (no es propiedad del cargador).
+    Texture m_placeholder;               ///< 1x1 gris; cada handle pendiente comparte su SRV.
+    std::vector<std::thread> m_workers;  ///< Pool de hilos.
+
+    mutable std::mutex m_mutex;          ///< Protege cola, resultados, `m_busy` y `m_stopping`.
+    std::condition_variable m_wake;      ///< Hay trabajo o hay que parar.
+    std::condition_variable m_idle;      ///< Un trabajo terminó (para `waitIdle`).
+    std::deque<Job> m_queue;             ///< Trabajos sin empezar.
+    std::vector<Result> m_results;       ///< Trabajos terminados.
+    unsigned int m_busy = 0;             ///< Trabajos en curso.
+    bool m_stopping = false;             ///< `destroy` en marcha.
+
+    /// Handles pendientes, solo del hilo principal (los hilos no tocan refcounts).
+    std::vector<Target> m_targets;
+    unsigned long long m_nextId = 1;     ///< Próximo número de trabajo.
+    std::unordered_map<std::string, Entry> m_cache; ///< Clave (@ref makeKey) -> textura.
+    EU::TMap<const Texture*, Entry*> m_entries; ///< Objeto del handle -> su entrada (para @ref requestTexels).
+    unsigned long long m_cacheHits = 0;  ///< Aciertos de caché.
+
+    unsigned long long m_frame = 1;      ///< Frame actual (sube en cada @ref update).
+    size_t m_vramBudget = 0;             ///< 0 = sin límite.
+    size_t m_residentBytes = 0;          ///< Recalculado en cada @ref update.
+    unsigned int m_initialSize = kDefaultInitialSize;
+};
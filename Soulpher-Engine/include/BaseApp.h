@@ -25,15 +25,85 @@
 #include "DeviceContext.h"
 #include "SwapChain.h"
 #include "Texture.h"
+#include "AsyncTextureLoader.h"
+#include "MeshLibrary.h"
+#include "Material.h"
+#include "UploadScheduler.h"
 #include "RenderTargetView.h"
 #include "DepthStencilView.h"
+#include "DepthStencilState.h"
 #include "Viewport.h"
 #include "ShaderProgram.h"
+#include "ShaderPermutations.h"
+#include "ResourceManager.h"
+#include "AssetTask.h"
+#include "SceneFile.h"
+#include "WorldStreamer.h"
+#include "ShaderHotReload.h"
+#include "AssetHotReload.h"
 #include "Buffer.h"
+#include "ConstantBuffer.h"
 #include "MeshComponent.h"
+#include "VertexFormat.h"
+#include "VertexLayout.h"
 #include "ModelLoader.h"
 #include "UserInterface.h"
+#include "RenderQueue.h"
+#include "TextureArrayPool.h"
+#include "Frustum.h"
+#include "SceneBVH.h"
+#include "SceneQuery.h"
+#include "Broadphase.h"
+#include "RigidBodySolver.h"
+#include "HiZBuffer.h"
+#include "RenderTargetPool.h"
+#include "RenderGraph.h"
+#include "ShadowMap.h"
+#include "ClusteredLighting.h"
+#include "DeferredShading.h"
+#include "AmbientOcclusion.h"
+#include "PostProcess.h"
+#include "DynamicResolution.h"
+#include "TemporalAA.h"
+#include "Multisampling.h"
+#include "EditorViewport.h"
+#include "LightmapBaker.h"
+#include "PotentialVisibility.h"
+#include "ReflectionProbes.h"
+#include "FrameClock.h"
+#include "FrameLimiter.h"
+#include "InputSystem.h"
+#include "GpuProfiler.h"
+#include "FrameWatchdog.h"
+#include "Telemetry.h"
+#include "ActorCost.h"
+#include "GpuMemory.h"
+#include "CpuProfiler.h"
+#include "TraceCapture.h"
+#include "Screenshot.h"
+#include "FrameCapture.h"
+#include "RemoteStream.h"
+#include "FrameTimeHistory.h"
+#include "Benchmark.h"
+#include "SceneGenerator.h"
+#include "StaticBatcher.h"
+#include "GpuCulling.h"
+#include "AnimationSystem.h"
+#include "SkinningSystem.h"
+#include "OcclusionPredicates.h"
+#include "GpuPicking.h"
+#include "ImpostorRenderer.h"
+#include "DebugDraw.h"
+#include "SpriteBatch.h"
+#include "GpuParticles.h"
+#include "Terrain.h"
+#include "TerrainScatter.h"
+#include "JobSystem.h"
+#include "DeferredRecorder.h"
+#include "RenderThread.h"
 #include "ECS/Actor.h"
+#include "ECS/ActorPool.h"
+#include "ECS/Camera.h"
 #include <vector>
 
  /**
@@ -49,13 +119,57 @@ public:
 
     /** @brief Inicializa el motor y todos los recursos necesarios. */
     HRESULT init();
-    /** @brief Actualiza la lógica de la escena en cada frame. */
+    /** @brief Actualiza la lógica de la escena en cada frame (entrada, UI y cámara). */
     void update();
+    /** @brief Simula los actores (paso fijo e interpolación); solo CPU. */
+    void simulate();
+    /** @brief Copia lo que dibuja `render` (actores, vista y UI); con el render parado. */
+    void captureFrame();
     /** @brief Renderiza el contenido de la escena. */
     void render();
     /** @brief Libera los recursos utilizados por el motor. */
     void destroy();
 
+    /**
+     * @brief Adapta el render al nuevo tamaño del área de cliente (WM_SIZE).
+     * @param width Nuevo ancho (px).
+     * @param height Nuevo alto (px).
+     *
+     * @details Solo rehace lo que depende del tamaño: back buffer (`ResizeBuffers`),
+     * RTV, pool de render targets (depth buffer), pirámide Hi-Z, viewport y proyección. Dispositivo,
+     * shaders y mallas se conservan. Con tamaño 0 (minimizada) no hace nada.
+     */
+    void resize(unsigned int width, unsigned int height);
+
+    /**
+     * @brief Pide dibujar aunque no haya entrada (modo reposo del editor).
+     *
+     * @details Seguro desde cualquier hilo (p. ej. al terminar una carga en segundo
+     * plano): despierta el bucle de @ref run, que dibuja unos frames más.
+     */
+    void requestRedraw() { if (m_redrawEvent) SetEvent(m_redrawEvent); }
+
+    /**
+     * @brief Entra o sale del modo jugador (F11): sin editor ni frame de ImGui.
+     * @note Desde `WndProc`, entre frames (el render del anterior ya terminó).
+     */
+    void togglePlayerMode() { m_userInterface.setPlayerMode(!m_userInterface.isPlayerMode()); }
+
+    /** @brief `WM_INPUT` de la ventana (desde `WndProc`): se acumula hasta el siguiente frame. */
+    void onRawInput(HRAWINPUT input) { m_input.handleRawInput(input); }
+
+    /** @brief `WM_KILLFOCUS`: suelta botones y teclas (sus subidas ya no llegarán). */
+    void onFocusLost() { m_input.releaseAll(); }
+
+    /** @brief Sprites del HUD del juego; se encolan en `update`/`simulate` (hilo principal). */
+    SpriteBatch& getSprites() { return m_sprites; }
+
+    /** @brief Partículas en GPU (emisores desde el hilo principal). */
+    GpuParticles& getParticles() { return m_particles; }
+
+    /** @brief Terreno del editor (`r.terrain`); sus parámetros se cambian en el hilo principal. */
+    Terrain& getTerrain() { return m_terrain; }
+
     /**
      * @brief Ejecuta el bucle principal de la aplicación (game loop).
      * @param hInstance Instancia de la aplicación.
@@ -72,6 +186,234 @@ public:
         WNDPROC wndproc);
 
 private:
+    /** @brief Crea RTV, depth buffer (+DSV/SRV), Hi-Z y viewport con el tamaño de `m_window`. */
+    HRESULT initSizeDependent();
+
+    /** @brief Lente de `m_camera` con el aspecto de `m_window` y la proyección marcada para subir. */
+    void updateProjection();
+
+    /** @brief Mensajes de la ventana y un `Present` del fondo, mientras arranca (ver `StartupGraph`). */
+    void presentLoadingFrame();
+
+    /**
+     * @brief Ajusta el presupuesto del streaming de texturas al de vídeo del sistema:
+     * lo que deja libre el resto del proceso, sin pasar del `-texbudget` del usuario.
+     */
+    void applyTextureBudget();
+
+    /**
+     * @brief Nivel de calidad de `r.scalability` (o del benchmark de arranque si es -1)
+     * en las cvars que siguen por defecto, y presupuesto de `r.textureBudgetMB`.
+     * @note Tras crear el dispositivo y antes de los sistemas que leen esas cvars al iniciarse.
+     */
+    void applyScalability();
+
+    /// Opciones de arranque leídas de la línea de comandos.
+    struct LaunchOptions {
+        unsigned int traceFrames = 0;       ///< `-trace N` (0 = sin captura).
+        std::string tracePath;              ///< `-traceout archivo`.
+        std::string startupTracePath;       ///< `-startuptrace archivo`: línea de tiempo del arranque.
+        std::string benchmarkScene;         ///< `--benchmark <escena> <recorrido>` (vacío = sin benchmark).
+        std::string benchmarkPath;          ///< Archivo del recorrido de cámara.
+        unsigned int benchmarkFrames = Benchmark::kDefaultFrames; ///< `-benchmarkframes N`.
+        std::string benchmarkReport;        ///< `-benchmarkout ruta` (sin extensión).
+        std::vector<unsigned int> stressCounts; ///< `-stress N[,N...]`: actores generados por escena.
+        unsigned int textureBudgetMB = 0;   ///< `-texbudget MB`: VRAM para texturas (0 = sin límite).
+        std::string screenshotPath;         ///< `-screenshot archivo.png` (vacío = sin captura).
+        FrameCapture::Settings capture;     ///< `-capture ruta`, `-captureformat`, `-captureevery`, `-capturefps`.
+        VertexFormat vertexFormat = VertexFormat::compact(); ///< `-vertexformat compact|full`.
+        bool gpuDriven = false;             ///< `-gpudriven 1`: culling y draws en GPU (@ref GpuCulling).
+        bool deferredContexts = false;      ///< `-deferred 1`: draws grabados en varios hilos (@ref DeferredRecorder).
+        bool renderThread = false;          ///< `-renderthread 1`: render en su propio hilo (@ref RenderThread).
+        float impostorDistance = 0.0f;      ///< `-impostors D`: distancia de impostor de la escena de estrés.
+        unsigned int lightCount = 0;        ///< `-lights N`: luces puntuales de la escena de estrés (@ref ClusteredLighting).
+        std::string pointerBenchmark;       ///< `-ptrbench archivo.csv`: mide los punteros y sale (@ref PointerBenchmark).
+        std::string cookManifest;           ///< `-cook manifiesto.txt`: escribe las cachés de los recursos y sale (@ref AssetCooker).
+        std::string packPath;               ///< `-pack archivo.spak`: con `-cook` lo escribe; sin él lo monta (@ref VirtualFileSystem).
+        std::string scenePath;              ///< `-scene archivo.sscene`: escena guardada en lugar de la del editor; "File > Save" la escribe.
+        float autosaveSeconds = 0.0f;       ///< `-autosave S`: guarda la escena cada S segundos (0 = nunca).
+        std::string streamPath;             ///< `-stream carpeta`: nivel por celdas alrededor de la cámara (@ref WorldStreamer).
+        std::string splitScene;             ///< `-splitscene archivo.sscene`: lo parte en celdas en `-stream` (por defecto `Stream`) y sale.
+        float cellSize = WorldStreamer::kDefaultCellSize; ///< `-cellsize L`: lado de celda de `-splitscene`.
+        unsigned int streamBudgetMB = 0;    ///< `-streambudget MB`: memoria de las celdas residentes (0 = sin límite).
+        bool queryTriangles = false;        ///< `-querytriangles 1`: las mallas guardan sus triángulos para los rayos de @ref SceneQuery.
+        bool lightmapBake = false;          ///< `-lightmapbake 1`: las mallas guardan sus triángulos para "Tools > Bake lightmaps".
+        std::string logPath;                ///< `-log archivo.txt`: copia del log (@ref Logger).
+        bool physics = false;               ///< `-physics 1`: pares de cajas solapadas (@ref Broadphase) y cuerpos rígidos (@ref RigidBodySolver).
+        std::string configPath;             ///< `-config archivo.cfg`: valores de cvars tras `Engine.cfg` (@ref ConsoleVariables).
+        std::vector<std::string> cvars;     ///< `-cvar nombre=valor`, en orden; se aplican los últimos.
+        std::string adapter;                ///< `-adapter N|nombre`: GPU (vacío = la de más rendimiento).
+        bool warp = false;                  ///< `-warp 1`: dispositivo WARP (por software).
+        bool remote = false;                ///< `-remote [host]:puerto`: stream del frame (@ref RemoteStream).
+        RemoteStream::Settings remoteStream; ///< `-remotecodec`, `-remotebitrate`, `-remotesize`.
+        std::string telemetryPath;          ///< `-telemetry carpeta`: resúmenes de rendimiento (@ref Telemetry).
+        unsigned int headlessWidth = 0;     ///< `-headless AnchoxAlto` (0 = con ventana).
+        unsigned int headlessHeight = 0;
+        unsigned int turntableFrames = 1;   ///< `-turntable N`: frames de la vuelta de cámara en `-headless`.
+        bool playerMode = false;            ///< `-player 1`: arranca sin el editor (F11 lo alterna, ver `UserInterface::setPlayerMode`).
+    };
+
+    /**
+     * @brief Lee las opciones de la línea de comandos (`-opcion` o `--opcion`).
+     * @param options Recibe los valores; los no indicados quedan por defecto.
+     */
+    static void parseCommandLine(LaunchOptions& options);
+
+    /**
+     * @brief Sustituye la escena de estrés por una de `m_stressCounts[index]` actores.
+     * @param index Posición en el barrido.
+     * @return `S_OK` o el error del generador.
+     */
+    HRESULT generateStressScene(size_t index);
+
+    /**
+     * @brief Pide al streaming la resolución de las texturas del actor según su
+     * tamaño en pantalla (tras `Actor::updateLOD`).
+     */
+    void requestActorTexels(Actor& actor);
+
+    /**
+     * @brief Cierra la muestra del vigilante de presupuestos con los cvars `watchdog.*`
+     * y las estadísticas del último frame (al inicio de `update`, con el render parado).
+     */
+    void updateWatchdog();
+
+    /**
+     * @brief Da de alta, de baja o mueve el cuerpo de cada actor con caja y calcula los
+     * pares solapados en `m_contactPairs`.
+     * @note Desde @ref simulate, tras los pasos fijos (cajas de la matriz de simulación).
+     */
+    void updateBroadphase();
+
+    /**
+     * @brief Culling compartido del frame: actualiza los árboles de actores y los recorre
+     * una vez para la cámara (`m_visibleActors`) y las caras de sonda (`m_probeVisible`).
+     * @note Solo CPU; antes del grafo, para que los pases solo lean las listas.
+     */
+    void cullViews();
+
+    /** @brief Pase "Shadows" del grafo: actualiza y redibuja las cascadas que tocan. */
+    void renderShadows(DeviceContext& deviceContext);
+
+    /** @brief Elige las caras de sonda del frame (antes de @ref cullViews). */
+    void scheduleReflectionProbes();
+
+    /**
+     * @brief Pase "Reflection probes" del grafo: dibuja las caras que tocan este frame
+     * (`r.probeFacesPerFrame`) con las sombras y las luces ya preparadas.
+     */
+    void renderReflectionProbes(DeviceContext& deviceContext);
+
+    /**
+     * @brief Pase "Scene" del grafo: limpia, enlaza, cullea y dibuja los actores.
+     * @param dsv Profundidad transitoria del pase.
+     * @param target Color de la escena en forward: back buffer o target HDR (`r.hdr`).
+     * @param gbuffer Los dos render targets del G-buffer (`r.deferred`); nulo = forward
+     * sobre `target`. Con G-buffer solo dibuja las capas opacas: el resto va en
+     * @ref renderForwardLayers tras la iluminación.
+     */
+    void renderScene(DeviceContext& deviceContext, ID3D11DepthStencilView* dsv,
+        ID3D11RenderTargetView* target, ID3D11RenderTargetView* const* gbuffer);
+
+    /** @brief Impostores, actores con predicado y capa transparente (siempre en forward). */
+    void renderForwardLayers(DeviceContext& deviceContext);
+
+    /**
+     * @brief Frame sin escena (`r.editorViewport` con el panel oculto): limpia el back
+     * buffer, dibuja la UI y presenta.
+     */
+    void renderInterfaceOnly();
+
+    /**
+     * @brief Crea la malla de un modelo importado (publicador de `ResourceManager::loadMesh`).
+     * @param path Ruta del modelo (nombre en la biblioteca).
+     * @param loader Cargador con lo importado; se vacía.
+     * @return Malla deformable si el modelo tiene esqueleto (ver `SkinningSystem`), si no
+     * la compartida de la biblioteca; nula si falló.
+     */
+    MeshHandle publishModel(const std::string& path, ModelLoader& loader);
+
+    /**
+     * @brief Carga el modelo de la escena (malla, textura y material) y se lo da al actor.
+     * @param actor Actor que lo recibe (sin malla hasta entonces).
+     * @param path Modelo (FBX u OBJ).
+     * @param diffuse Candidatas de la textura difusa.
+     * @note Corrutina: vuelve en el primer `co_await`; también rellena @ref m_sceneMesh.
+     */
+    Task<> loadSceneModel(ActorHandle actor, std::string path, std::vector<AsyncTextureLoader::Source> diffuse);
+
+    /**
+     * @brief Malla del suelo del editor (procedural: se crea la primera vez que se pide).
+     * @return La malla "Ground" de `m_meshLibrary`.
+     */
+    MeshHandle createGroundMesh();
+
+    /**
+     * @brief Crea los actores de una escena guardada (@ref SceneFile).
+     * @return `S_OK`, `HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND)` si no existe o el error
+     * de lectura o de instanciación.
+     */
+    HRESULT loadScene(const std::string& path);
+
+    /**
+     * @brief Malla de un nombre de escena: la biblioteca (o el suelo procedural) y, si no,
+     * el modelo en disco con ese nombre.
+     * @return Futuro de la malla; fallido si no se encuentra.
+     */
+    ResourceHandle<MeshAsset> resolveSceneMesh(const std::string& name);
+
+    /**
+     * @brief Captura la escena y la escribe en `m_scenePath` en segundo plano.
+     * @return `false` si no hay ruta o aún se está escribiendo el guardado anterior.
+     */
+    bool saveScene();
+
+    /**
+     * @brief Hornea, carga o quita los lightmaps según la petición del editor y `r.lightmaps`.
+     * @details El horneado previo se carga una vez, cuando la escena terminó de importarse.
+     */
+    void updateLightmaps();
+
+    /**
+     * @brief Hornea, carga o quita el PVS según la petición del editor y `r.pvs`.
+     * @details Como @ref updateLightmaps: el horneado previo se carga una vez, cuando la
+     * escena terminó de importarse.
+     */
+    void updateVisibility();
+
+    /**
+     * @brief Arranca el benchmark del punto actual del barrido (o el único, sin `-stress`).
+     * @param options Opciones de arranque (recorrido, frames e informe).
+     * @return `S_OK` o `E_FAIL` si el recorrido no se pudo cargar.
+     *
+     * @note Con `-stress`, el informe de cada punto lleva el número de actores:
+     * `<informe>_<N>.csv/.json`.
+     */
+    HRESULT startBenchmark(const LaunchOptions& options);
+
+    /**
+     * @brief Cierra el punto actual del barrido y pasa al siguiente.
+     * @param options Opciones de arranque.
+     * @return `true` si empezó otro punto; `false` si no hay más (el CSV del barrido,
+     * `<informe>_sweep.csv`, ya está escrito).
+     */
+    bool advanceStressSweep(const LaunchOptions& options);
+
+    /**
+     * @brief Empieza a grabar y fija el reloj a `1 / (fps * interval)` por frame.
+     * @return Resultado de @ref FrameCapture::start.
+     */
+    HRESULT startRecording(const FrameCapture::Settings& settings);
+
+    /** @brief Termina la grabación en curso y devuelve el reloj al tiempo real. */
+    void stopRecording();
+
+    /**
+     * @brief Lote sin ventana (`-headless`): graba la vuelta de cámara y sale.
+     * @return Código de salida (0 si se escribió algún frame).
+     */
+    int runHeadless(const LaunchOptions& options);
+
     // --- Core DX11 ---
     Window          m_window;            ///< Ventana principal.
     Device          m_device;            ///< Dispositivo DirectX 11.
@@ -82,23 +424,34 @@ private:
     Texture           m_backBuffer;        ///< Textura de back buffer.
     RenderTargetView  m_renderTargetView;  ///< Vista de renderizado (RTV).
 
-    // Depth/Stencil
-    Texture           m_depthStencil;      ///< Textura de profundidad/stencil.
-    DepthStencilView  m_depthStencilView;  ///< Vista de profundidad/stencil.
+    // Pases del frame y texturas intermedias (el depth buffer es una de ellas).
+    RenderTargetPool  m_renderTargetPool;  ///< Render/depth targets por descripción; se vacía al cambiar de tamaño.
+    RenderGraph       m_renderGraph;       ///< Grafo de render: orden de pases y transitorias del pool.
 
     // Viewport y Shaders
     Viewport       m_viewport;           ///< Viewport principal.
+    Viewport       m_sceneViewport;      ///< Viewport de la escena (resolución dinámica); lo fija `render`.
     ShaderProgram  m_shaderProgram;      ///< Programa de shaders activos.
+    ShaderPermutations m_instancingVariants; ///< Instancing.fx por palabras clave (lotes, arrays, GPU-driven).
+    ShaderProgram  m_depthProgram;       ///< Pre-pase de profundidad, solo VS (DepthOnly.fx).
+    ShaderProgram  m_depthInstancedProgram; ///< Pre-pase de los lotes instanciados (DepthOnlyInstanced.fx).
+    DepthStencilState m_depthEqualState; ///< Pase principal tras el pre-pase: EQUAL, sin escribir Z.
+    bool           m_depthPrepass = true; ///< Activa el pre-pase (solo si sus shaders se crearon).
+    ShaderProgram  m_receiverProgram;    ///< Receptores de sombra (ShadowReceiver.fx).
+    ShaderPermutations m_receiverInstancingVariants; ///< Lotes receptores (ShadowReceiverInstanced.fx).
+    ShaderProgram  m_lightmapProgram;    ///< Actores con lightmap horneado (Lightmapped.fx).
+    ShaderHotReload m_shaderReload;     ///< Recompila los .fx editados y los cambia entre frames.
+    TextureArrayPool m_textureArrays;    ///< Capas de array de la variante `TEXTURE_ARRAY` ("Profile > Texture arrays").
 
     // CBuffers de cámara
-    Buffer           m_neverChanges;       ///< Buffer constante slot b0 (parámetros estáticos de cámara).
-    Buffer           m_changeOnResize;     ///< Buffer constante slot b1 (parámetros que cambian con el tamaño de ventana).
+    TConstantBuffer<CBNeverChanges>   m_neverChanges;   ///< Slot b0: vista (se sube solo si la cámara cambió).
+    TConstantBuffer<CBChangeOnResize> m_changeOnResize; ///< Slot b1: proyección (se sube solo si cambió).
     CBNeverChanges   cbNeverChanges{};     ///< Datos que casi no cambian (posición de luz, etc.).
     CBChangeOnResize cbChangesOnResize{};  ///< Datos que cambian al redimensionar.
 
-    // Matrices de cámara
-    XMMATRIX       m_View;               ///< Matriz de vista.
-    XMMATRIX       m_Projection;         ///< Matriz de proyección.
+    // Cámara
+    Camera         m_camera;             ///< Cámara orbital del editor (la mueve `update`).
+    Camera         m_renderCamera;       ///< Copia del frame (la que usa `render`).
 
     // Color de limpieza
     float          ClearColor[4] = { 0.0f, 0.125f, 0.3f, 1.0f }; ///< Color de fondo.
@@ -108,19 +461,141 @@ private:
 
     // Recursos
     ModelLoader    m_modelLoader;        ///< Cargador de modelos (FBX/OBJ).
-
-    // Plano de referencia
-    MeshComponent  planeMesh;            ///< Malla del plano.
-    Texture        m_PlaneTexture;       ///< Textura del plano.
-    EU::TSharedPointer<Actor> m_APlane;  ///< Actor que representa el plano.
+    AsyncTextureLoader m_textureLoader;  ///< Carga de texturas en hilos (placeholder mientras tanto).
+    MeshLibrary    m_meshLibrary;        ///< Geometría compartida por nombre (sin copias de CPU).
+    MaterialLibrary m_materials;         ///< Materiales compartidos (identificador de orden + b4).
+    ResourceManager m_resources;         ///< Mallas, texturas y materiales como futuros (hilos de carga).
+    AssetHotReload m_assetReload;        ///< Reimporta los FBX/OBJ/PNG/JPG editados y los cambia en sus handles.
+    ResourceHandle<MeshAsset> m_sceneMesh; ///< Malla del modelo de la escena (el benchmark espera por ella).
+    UploadScheduler m_uploads;           ///< Subidas a recursos DEFAULT repartidas entre frames.
+    ActorHandle m_APlane;  ///< Actor que representa el plano.
 
     // Interfaz y actores
     UserInterface  m_userInterface;      ///< Interfaz de usuario (ImGui).
-    std::vector<EU::TSharedPointer<Actor>> m_actors; ///< Lista de actores en la escena.
+    std::vector<ActorHandle> m_actors; ///< Lista de actores en la escena.
+    RenderQueue    m_renderQueue;        ///< Cola de draw packets ordenada por clave.
+    Frustum        m_frustum;            ///< Frustum de `m_renderCamera` (culling de meshlets de la cola).
+    SceneBVH       m_staticTree;         ///< BVH de los actores estáticos (se reconstruye si cambian).
+    SceneBVH       m_dynamicTree;        ///< BVH de los demás (reajuste incremental de los que se mueven).
+    std::vector<SceneBVH::Item> m_staticItems;  ///< Cajas de los estáticos del frame.
+    std::vector<SceneBVH::Item> m_dynamicItems; ///< Cajas de los dinámicos del frame.
+    /// Caja de un actor, guardada hasta que cambie su `Actor::getRenderVersion`.
+    struct CachedBounds {
+        uint32_t actor = 0;        ///< `ActorHandle::value` del actor que la calculó.
+        unsigned int version = 0;
+        bool bounded = false;      ///< `getWorldBounds` devolvió una caja.
+        XMFLOAT3 boundsMin;
+        XMFLOAT3 boundsMax;
+    };
+    std::vector<CachedBounds> m_actorBounds;    ///< Por índice de `m_actors`.
+    std::vector<uint64_t> m_dynamicKeys;        ///< Handle e índice de cada elemento de `m_dynamicTree`.
+    std::vector<unsigned int> m_movedItems;     ///< Elementos de `m_dynamicItems` que se movieron este frame.
+    SceneQuery     m_sceneQuery;         ///< Rayos y esferas en lote contra los dos árboles (cola resuelta en `captureFrame`).
+    uint64_t       m_staticTreeHash = 0; ///< Huella de `m_staticItems` con la que se construyó el árbol.
+    std::vector<unsigned int> m_visibleActors; ///< Índices de `m_actors` visibles este frame.
+    std::vector<unsigned int> m_untreedActors; ///< Actores fuera de los árboles (sin caja o GPU-driven).
+    std::vector<SceneBVH::ViewHit> m_viewHits; ///< Salida de `SceneBVH::cullViews` (se reutiliza).
+    unsigned int   m_culledActors = 0;   ///< Actores descartados por frustum en el último frame.
+    HiZBuffer      m_hiZ;                ///< Pirámide de profundidad para occlusion culling.
+    unsigned int   m_occludedActors = 0; ///< Actores descartados por oclusión en el último frame.
+    OcclusionPredicates m_occlusionPredicates; ///< Actores con `Actor::setOcclusionQuery` (caja + predicado).
+    GpuPicking     m_picking;            ///< Selección con clic en el viewport (IDs en GPU, lectura diferida).
+    ImpostorRenderer m_impostors;        ///< Quads horneados de los actores lejanos (`Actor::setImpostorDistance`).
+    SpriteBatch    m_sprites;            ///< HUD del juego: sprites instanciados sobre la escena.
+    GpuParticles   m_particles;          ///< Partículas simuladas en compute (pase "Particles").
+    int            m_particleDemo = -1;  ///< Emisor de `fx.particleDemo` (-1 = ninguno).
+    Terrain        m_terrain;            ///< Clipmap de alturas en lugar del plano del editor (pase "Terrain").
+    TerrainScatter m_scatter;            ///< Hierba y piedras generadas en GPU sobre el terreno.
+#if defined(PROFILE)
+    DebugDraw      m_debugDraw;          ///< Líneas y etiquetas de depuración del frame (solo con `PROFILE`).
+#endif
+    ShadowMap      m_shadowMap;          ///< Cascadas de profundidad desde `m_LightPos` para los receptores.
+    ClusteredLighting m_clusteredLighting; ///< Luces puntuales y focos repartidos en clusters (pase "Light culling").
+    DeferredShading m_deferredShading;   ///< G-buffer e iluminación por baldosas (`r.deferred`).
+    AmbientOcclusion m_ambientOcclusion; ///< SSAO a media resolución del camino diferido (`r.ssao`).
+    PostProcess    m_postProcess;        ///< Escena HDR: bloom, exposición y pase final (`r.hdr`).
+    DynamicResolution m_dynamicResolution; ///< Escala de la escena según el tiempo de GPU.
+    TemporalAA     m_temporalAA;         ///< Antialiasing y subida temporal de la escena (`r.taa`).
+    Multisampling  m_multisampling;      ///< MSAA del camino forward y su resolución (`r.msaa`).
+    LightmapBaker  m_lightmapBaker;      ///< Páginas de lightmap de la escena (`r.lightmaps`).
+    bool           m_lightmapsChecked = false; ///< Ya se intentó cargar el horneado de la escena.
+    PotentialVisibility m_visibility;    ///< PVS horneado de los estáticos (`r.pvs`).
+    bool           m_visibilityChecked = false; ///< Ya se intentó cargar el PVS de la escena.
+    RenderQueue    m_shadowQueues[ShadowMap::kCascadeCount]; ///< Casters de cada cascada (vista de la luz).
+    std::vector<unsigned int> m_shadowCascades; ///< Cascadas redibujadas este frame.
+    uint64_t       m_staticCasterHash = 0; ///< Huella de los casters estáticos (si cambia, se invalida la caché).
+    ReflectionProbes m_reflectionProbes; ///< Cubos prefiltrados de la escena (`r.reflectionProbes`).
+    RenderQueue    m_probeQueue;         ///< Actores de una cara de sonda.
+    EditorViewport m_editorViewport;     ///< Target del panel "Viewport" (`r.editorViewport`).
+    bool           m_renderToViewport = false; ///< Copia del frame: la escena termina en el panel.
+    unsigned int   m_outputWidth = 0;    ///< Salida de la escena (panel o ventana); la fija `captureFrame`.
+    unsigned int   m_outputHeight = 0;
+    std::vector<ReflectionProbes::Face> m_probeFaces; ///< Caras a dibujar este frame.
+    std::vector<Camera> m_probeCameras;  ///< Cámara de cada cara de `m_probeFaces`.
+    std::vector<std::vector<unsigned int>> m_probeVisible; ///< Actores de cada cara (de @ref cullViews).
 
-    // Parámetros de cámara orbital
-    float    m_camYawDeg = 0.0f;          ///< Ángulo de giro horizontal.
-    float    m_camPitchDeg = 15.0f;       ///< Ángulo de inclinación vertical.
-    float    m_camDistance = 10.0f;       ///< Distancia de la cámara al objetivo.
-    XMFLOAT3 m_camTarget = XMFLOAT3(0.0f, -5.0f, 0.0f); ///< Punto de enfoque de la cámara.
+    FrameClock     m_clock;              ///< Delta por frame, paso fijo de simulación e interpolación.
+    float          m_renderDeltaTime = 0.0f; ///< Delta de la copia del frame (adaptación de la exposición).
+    FrameLimiter   m_frameLimiter;       ///< Límite de FPS con esperas en waitable timer.
+    InputSystem    m_input;              ///< Raw input acumulado entre frames (lo muestrea `run`).
+    bool           m_idleThrottle = true; ///< Editor: sin entrada ni cambios, no se dibuja.
+    bool           m_starting = false;    ///< Dentro del grafo de arranque: `resize` espera a que acabe.
+    unsigned int   m_activeFrames = 0;   ///< Frames que quedan por dibujar antes de reposar.
+    HANDLE         m_redrawEvent = nullptr; ///< Evento de `requestRedraw` (auto-reset).
+    GpuProfiler    m_gpuProfiler;        ///< Tiempos de GPU por pase (panel "GPU Profiler").
+    ActorCost      m_actorCost;          ///< Coste por actor (inspector y orden del "Hierarchy").
+    GpuMemory      m_gpuMemory;          ///< Presupuesto de vídeo de DXGI y recursos por categoría (panel "GPU Memory").
+    size_t         m_userTextureBudget = 0; ///< `-texbudget` en bytes (0 = solo el presupuesto del sistema).
+    TraceCapture   m_trace;              ///< Captura a JSON (menú "Profile" o `-trace N`).
+    Screenshot     m_screenshot;         ///< Capturas PNG por readback (menú "Profile" o `-screenshot`).
+    std::string    m_startupTracePath;   ///< `-startuptrace`: se escribe cuando termina la carga.
+    std::string    m_launchScreenshot;   ///< `-screenshot`: se pide cuando no quedan texturas por cargar.
+    FrameCapture   m_frameCapture;       ///< Grabación de frames/vídeo (menú "Profile" o `-capture`).
+    RemoteStream   m_remoteStream;       ///< Vídeo por UDP y entrada remota (`-remote`).
+    FrameTimeHistory m_frameTimes;       ///< Tiempos de frame y tirones (panel "Frame Times").
+    FrameWatchdog  m_watchdog;           ///< Presupuesto por etapa y volcado de los picos.
+    Telemetry      m_telemetry;          ///< Distribuciones de rendimiento de la sesión (`-telemetry`).
+    Benchmark      m_benchmark;          ///< Recorrido de cámara y tiempos (`--benchmark`).
+    std::string    m_sceneModel;         ///< FBX de la escena (vacío = el del editor).
+    std::string    m_scenePath;          ///< `-scene`: archivo que se carga y que "File > Save" escribe.
+    bool           m_sceneUsesGround = false; ///< La escena cargada pidió la malla "Ground" (entonces no hay terreno).
+    SceneFile      m_sceneFile;          ///< Guardado de la escena en segundo plano.
+    std::vector<std::unique_ptr<Prefab>> m_scenePrefabs; ///< Prefabs de los actores de `m_scenePath`.
+    std::string    m_streamPath;         ///< `-stream`: carpeta del nivel por celdas.
+    size_t         m_streamBudget = 0;   ///< `-streambudget` en bytes.
+    WorldStreamer  m_streamer;           ///< Celdas del nivel alrededor del objetivo de `m_camera`.
+    std::unordered_map<std::string, ResourceHandle<MeshAsset>> m_sceneImports; ///< Modelos de escena importándose.
+    float          m_autosaveSeconds = 0.0f; ///< `-autosave` (0 = sin autoguardado).
+    float          m_autosaveElapsed = 0.0f; ///< Segundos desde el último guardado.
+    SceneGenerator m_stressScene;        ///< Actores sintéticos de `-stress`.
+    StaticBatcher  m_staticBatcher;      ///< Lotes de los actores estáticos (celda + material).
+    GpuCulling     m_gpuCulling;         ///< Culling en compute y draws indirectos (`-gpudriven`).
+    AnimationSystem m_animations;        ///< Clips de los actores con esqueleto.
+    SkinningSystem m_skinning;           ///< Deforma sus mallas una vez por frame (compute).
+    /// Cuerpo de la fase amplia de un actor y su caja del frame.
+    struct PhysicsBody {
+        uint32_t actor = 0;        ///< `ActorHandle::value` del actor dueño del cuerpo.
+        Broadphase::BodyID body = Broadphase::kInvalidBody;
+        bool bounded = false;      ///< `getSimulationBounds` devolvió una caja este frame.
+        XMFLOAT3 boundsMin;
+        XMFLOAT3 boundsMax;
+    };
+    bool           m_physics = false;    ///< `-physics`: fase amplia y cuerpos rígidos.
+    Broadphase     m_broadphase;         ///< Cuerpos de los actores con caja (dato libre = índice en `m_actors`).
+    std::vector<PhysicsBody> m_physicsBodies; ///< Por índice de `m_actors`.
+    std::vector<Broadphase::Pair> m_contactPairs; ///< Pares solapados del último frame simulado.
+    RigidBodySolver m_rigidBodies;      ///< Entidades con `RigidBody` (`-physics`), en cada paso fijo.
+    bool           m_gpuDriven = false;  ///< Pedido por línea de comandos; se apaga si `init` falla.
+    DeferredRecorder m_deferredRecorder; ///< Contextos diferidos de las colas (`-deferred`).
+    bool           m_deferredContexts = false; ///< Pedido por línea de comandos.
+    RenderThread   m_renderThread;       ///< Hilo de render (`-renderthread`); sin iniciar, todo va en este.
+    std::vector<unsigned int> m_stressCounts; ///< Actores de cada punto del barrido.
+    float          m_stressImpostorDistance = 0.0f; ///< `-impostors`: distancia de impostor de esos actores.
+    unsigned int   m_stressLightCount = 0; ///< `-lights`: luces puntuales sobre esa escena.
+    std::string    m_adapter;            ///< `-adapter`: GPU donde se crea el dispositivo.
+    bool           m_warp = false;       ///< `-warp 1`: dispositivo WARP.
+    bool           m_headless = false;   ///< `-headless`: sin ventana, swap chain ni ImGui.
+    bool           m_autoScalability = true; ///< Benchmark de arranque con `r.scalability -1` (no en `-benchmark` ni `-headless`).
+    size_t         m_stressIndex = 0;    ///< Punto del barrido en curso.
+    std::vector<Benchmark::SweepPoint> m_sweep; ///< Resultados de los puntos terminados.
 };
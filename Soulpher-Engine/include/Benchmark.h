@@ -0,0 +1,141 @@
+﻿/**
+ * @file Benchmark.h
+ * @brief Modo benchmark: cámara por un recorrido grabado, N frames y un informe de tiempos.
+ *
+ * @details
+ * Con `--benchmark <escena> <recorrido>` la aplicación:
+ * - Carga `<escena>` (un FBX; `default` = la escena del editor).
+ * - Mueve la cámara orbital por un spline Catmull-Rom que pasa por las claves de
+ *   `<recorrido>`; la posición depende del **número de frame**, no del reloj, así dos
+ *   ejecuciones ven exactamente las mismas imágenes.
+ * - Ignora la entrada de ratón/teclado, sin límite de FPS ni modo reposo.
+ * - Tras @ref kWarmupFrames frames de calentamiento mide @ref Benchmark::init `frames`
+ *   frames y escribe dos archivos:
+ *   - `<informe>.csv`: tiempo de cada frame (ms).
+ *   - `<informe>.json`: media, p50, p95, p99, mínimo, máximo y el tiempo medio de cada
+ *     pase de GPU (@ref GpuProfiler).
+ *
+ * Formato del recorrido: una clave por línea, `yaw pitch distancia x y z` (grados y
+ * unidades de mundo, igual que la órbita de `Camera`); las líneas con `#` son comentarios.
+ * Las claves se reparten uniformemente a lo largo de los frames medidos. El menú
+ * "Profile > Add camera key" añade la cámara actual al final del archivo.
+ *
+ * @note Para estudiantes: la media esconde los tirones; p99 es el frame que solo el 1%
+ * supera, y es lo que el jugador percibe como "stutter".
+ */
+
+#pragma once
+#include "Prerequisites.h"
+
+class GpuProfiler;
+
+/**
+ * @class Benchmark
+ * @brief Recorrido de cámara reproducible y recogida de tiempos por frame.
+ */
+class Benchmark {
+public:
+    Benchmark() = default;
+    ~Benchmark() = default;
+
+    /// Frames que se dibujan antes de medir (compilación de shaders, primeras subidas).
+    static const unsigned int kWarmupFrames = 60;
+    /// Frames medidos si no se indica otro número.
+    static const unsigned int kDefaultFrames = 1000;
+
+    /// Resumen de los tiempos de frame medidos (ms).
+    struct Summary {
+        unsigned int frames = 0;
+        double averageMs = 0.0;
+        double p50Ms = 0.0;
+        double p95Ms = 0.0;
+        double p99Ms = 0.0;
+        double minMs = 0.0;
+        double maxMs = 0.0;
+    };
+
+    /// Un punto de un barrido de escalado: escena con `actorCount` actores y sus tiempos.
+    struct SweepPoint {
+        unsigned int actorCount;
+        Summary summary;
+    };
+
+    /// Una clave del recorrido: el estado de la cámara orbital.
+    struct CameraKey {
+        float yawDeg;
+        float pitchDeg;
+        float distance;
+        XMFLOAT3 target;
+    };
+
+    /**
+     * @brief Carga el recorrido y prepara la medición.
+     * @param pathFile Archivo con las claves (al menos una).
+     * @param frames Frames a medir (sin contar el calentamiento).
+     * @param reportPath Ruta del informe sin extensión (se añaden `.csv` y `.json`).
+     * @param sceneName Nombre de la escena (solo para el informe).
+     * @return `S_OK`, o `E_FAIL` si el archivo no existe o no tiene claves válidas.
+     */
+    HRESULT init(const std::string& pathFile, unsigned int frames,
+        const std::string& reportPath, const std::string& sceneName);
+
+    /** @brief `true` entre `init` y el último frame medido. */
+    bool isRunning() const { return m_running; }
+
+    /**
+     * @brief Cámara del frame actual sobre el spline.
+     * @param key Recibe yaw, pitch, distancia y objetivo.
+     */
+    void sampleCamera(CameraKey& key) const;
+
+    /**
+     * @brief Registra un frame terminado y avanza el recorrido.
+     * @param frameSeconds Duración del frame (`FrameClock::getRawDeltaTime`).
+     * @param gpuProfiler Pases de GPU (se acumulan cuando hay resultados nuevos).
+     * @return `true` si fue el último: el informe ya está escrito.
+     */
+    bool recordFrame(double frameSeconds, const GpuProfiler& gpuProfiler);
+
+    /** @brief Media, percentiles y extremos de los frames medidos hasta ahora. */
+    Summary getSummary() const;
+
+    /**
+     * @brief Añade una clave al final de un archivo de recorrido (lo crea si no existe).
+     * @param pathFile Archivo de recorrido.
+     * @param key Cámara a guardar.
+     * @return `S_OK` o `E_FAIL` si no se pudo escribir.
+     */
+    static HRESULT appendCameraKey(const std::string& pathFile, const CameraKey& key);
+
+    /**
+     * @brief Escribe un barrido de escalado como CSV (`actors,avg,p50,p95,p99,min,max`).
+     * @param csvPath Archivo de salida (se sobrescribe).
+     * @param points Un punto por escena medida, en el orden del barrido.
+     * @return `S_OK` o `E_FAIL` si no se pudo escribir.
+     *
+     * @note Una columna por estadístico: se grafica directamente frame time vs actores.
+     */
+    static HRESULT writeSweep(const std::string& csvPath, const std::vector<SweepPoint>& points);
+
+private:
+    /// Tiempo acumulado de un pase de GPU.
+    struct PassTotal {
+        const char* name;
+        unsigned int depth;
+        double totalMs;
+        unsigned int samples;
+    };
+
+    /// Escribe el CSV y el JSON; `false` si algún archivo no se pudo abrir.
+    bool writeReport() const;
+
+    std::vector<CameraKey> m_keys;       ///< Claves del recorrido.
+    std::vector<double> m_frameMs;       ///< Tiempo de cada frame medido.
+    std::vector<PassTotal> m_passes;     ///< Tiempos de GPU por pase (en orden de aparición).
+    std::string m_reportPath;            ///< Ruta del informe sin extensión.
+    std::string m_sceneName;             ///< Escena medida.
+    unsigned int m_frames = 0;           ///< Frames a medir.
+    unsigned int m_frame = 0;            ///< Frame actual (incluye el calentamiento).
+    unsigned long long m_gpuSerial = 0;  ///< Último resultado de GPU acumulado.
+    bool m_running = false;              ///< Benchmark en curso.
+};
@@ -33,12 +33,14 @@ public:
     /**
      * @brief Inicializa el estado de blending en la GPU.
      * @param device Dispositivo de Direct3D para la creacin del estado.
+     * @param alphaBlend `true` = transparencia alfa; `false` = sin mezcla (opacos y
+     *        alpha test: no se lee el render target y no se pierde el early-Z).
      * @return HRESULT que indica xito (`S_OK`) o el tipo de error.
      *
      * @note Este mtodo suele configurarse con una descripcin (`D3D11_BLEND_DESC`)
      *       que define el tipo de mezcla.
      */
-    HRESULT init(Device& device);
+    HRESULT init(Device& device, bool alphaBlend = true);
 
     /**
      * @brief Actualiza parmetros internos (actualmente sin implementacin).
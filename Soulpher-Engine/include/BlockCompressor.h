@@ -0,0 +1,121 @@
+﻿/**
+ * @file BlockCompressor.h
+ * @brief Codificadores BC1, BC3, BC5 y BC7 (bloques de 4x4) para texturas RGBA8, y BC6H para HDR.
+ *
+ * @details
+ * Los formatos BCn guardan cada bloque de 4x4 texeles como dos colores extremos y
+ * un índice por texel que elige un punto de la recta entre ellos. La GPU los lee
+ * tal cual (sin descomprimir en memoria):
+ *
+ * | Formato | Bytes/bloque | Bits/texel | Uso                                  |
+ * |---------|--------------|------------|--------------------------------------|
+ * | BC1     | 8            | 4          | Color opaco                          |
+ * | BC3     | 16           | 8          | Color + alfa (bloque BC4 para el alfa) |
+ * | BC5     | 16           | 8          | Dos canales (R, G): mapas de normales |
+ * | BC7     | 16           | 8          | Color + alfa de alta calidad         |
+ * | BC6H    | 16           | 8          | Color HDR (half sin signo): lightmaps |
+ *
+ * Los codificadores son de "ajuste por rango": extremos a partir de la caja
+ * envolvente del bloque (con un pequeño margen hacia dentro) y después el índice más
+ * cercano para cada texel. BC7 solo usa el modo 6 (un subconjunto, RGBA, 16 niveles),
+ * que da buena calidad con un coste parecido al de BC3. BC6H solo usa el modo 11 (una
+ * región, extremos de 10 bits), suficiente para la luz suave de un lightmap.
+ *
+ * @note Para estudiantes: frente a RGBA8 (32 bits/texel) BC1 ocupa 8 veces menos y
+ * BC7 4 veces menos, tanto en VRAM como en ancho de banda al muestrear. El precio es
+ * un error pequeño por bloque y un tiempo de codificación que por eso se paga una
+ * sola vez y se guarda en disco (@ref DdsFile).
+ */
+
+#pragma once
+#include "Prerequisites.h"
+
+class MipChain;
+
+/**
+ * @enum TextureCompression
+ * @brief Formato con el que se guarda en VRAM una textura cargada desde PNG/JPG.
+ */
+enum TextureCompression {
+    TEXTURE_COMPRESSION_NONE = 0,   ///< RGBA8 sin comprimir.
+    TEXTURE_COMPRESSION_AUTO = 1,   ///< BC1 si es opaca, BC3 si tiene alfa.
+    TEXTURE_COMPRESSION_BC1 = 2,
+    TEXTURE_COMPRESSION_BC3 = 3,
+    TEXTURE_COMPRESSION_BC5 = 4,
+    TEXTURE_COMPRESSION_BC7 = 5
+};
+
+/**
+ * @struct CompressedImage
+ * @brief Cadena de mips ya codificada, lista para `CreateTexture2D` o para un DDS.
+ */
+struct CompressedImage {
+    /// Un mip dentro de `data`.
+    struct Level {
+        unsigned int width = 0;
+        unsigned int height = 0;
+        size_t offset = 0;          ///< Bytes desde el inicio de `data`.
+        unsigned int rowPitch = 0;  ///< Bytes por fila de bloques.
+        size_t size = 0;            ///< Bytes del mip.
+    };
+
+    DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+    std::vector<Level> levels;
+    std::vector<unsigned char> data;
+    /// Elementos (caras, si `cubemap`) uno tras otro en `data`; `levels` describe el primero.
+    unsigned int elementCount = 1;
+    bool cubemap = false;               ///< Seis elementos por cubo (+X, -X, +Y, -Y, +Z, -Z).
+};
+
+/**
+ * @class BlockCompressor
+ * @brief Funciones de codificación por bloque y de una cadena de mips completa.
+ */
+class BlockCompressor {
+public:
+    /**
+     * @brief Formato DXGI que corresponde a una compresión.
+     * @param compression No puede ser `AUTO` ni `NONE`.
+     */
+    static DXGI_FORMAT getFormat(TextureCompression compression);
+
+    /** @brief Bytes de cada bloque de 4x4 (8 para BC1, 16 para el resto). */
+    static unsigned int getBlockBytes(DXGI_FORMAT format);
+
+    /**
+     * @brief Elige BC1 o BC3 según el canal alfa.
+     * @return `BC1` si todos los texeles son opacos (alfa 255), si no `BC3`.
+     */
+    static TextureCompression chooseAuto(const unsigned char* rgba, unsigned int width, unsigned int height);
+
+    /**
+     * @brief Codifica todos los mips de una cadena.
+     * @param mips Cadena RGBA8; el nivel 0 debe tener ancho y alto múltiplos de 4
+     * (requisito de D3D11 para BCn). Los mips menores de 4x4 repiten sus bordes.
+     * @param compression Formato destino (no `NONE`; `AUTO` se resuelve aquí).
+     * @param out Recibe formato, mips y datos.
+     * @return `false` si el tamaño no admite BCn.
+     */
+    static bool compress(const MipChain& mips, TextureCompression compression, CompressedImage& out);
+
+    /**
+     * @brief Codifica una imagen HDR en BC6H_UF16, un solo mip.
+     * @param rgb Tres floats por texel en orden de filas; los negativos se recortan a 0.
+     * @param width Múltiplo de 4.
+     * @param height Múltiplo de 4.
+     * @param out Recibe formato, mip y datos.
+     * @return `false` si el tamaño no admite BCn.
+     */
+    static bool compressHDR(const float* rgb, unsigned int width, unsigned int height, CompressedImage& out);
+
+    /// @name Codificación de un bloque (16 texeles RGBA8 en orden de filas).
+    /// @{
+    static void encodeBC1(const unsigned char* block, unsigned char* out);
+    static void encodeBC3(const unsigned char* block, unsigned char* out);
+    static void encodeBC5(const unsigned char* block, unsigned char* out);
+    static void encodeBC7(const unsigned char* block, unsigned char* out);
+    /// @}
+
+    /** @brief Codifica un bloque BC6H_UF16 (16 texeles RGB en half, orden de filas). */
+    static void encodeBC6H(const unsigned short* block, unsigned char* out);
+};
@@ -1,10 +1,23 @@
 ﻿#pragma once
 #include "Prerequisites.h"
+#include <source_location>
 
 class Device;
 class DeviceContext;
 class MeshComponent;
 
+/**
+ * @enum BufferUsage
+ * @brief Cómo se crea un buffer y cómo se escribe después (ver `Buffer::create`).
+ */
+enum BufferUsage {
+    BUFFER_IMMUTABLE = 0,     ///< Solo datos iniciales; la GPU lee. Geometría estática.
+    BUFFER_DEFAULT,           ///< Escrito por la GPU o con `update`/`copyRegion`.
+    BUFFER_DYNAMIC_DISCARD,   ///< La CPU lo reescribe entero (`write`, `WRITE_DISCARD`).
+    BUFFER_DYNAMIC_RING,      ///< La CPU añade por detrás (`append`, `WRITE_NO_OVERWRITE`).
+    BUFFER_STAGING_READBACK   ///< Destino de copias para leer en CPU (`map` con `READ`).
+};
+
 /**
  * @file Buffer.h
  * @brief Encapsula la creación y gestión de buffers en Direct3D 11.
@@ -15,6 +28,11 @@ class MeshComponent;
  * - **Index Buffer:** Contiene índices que optimizan el renderizado.
  * - **Constant Buffer:** Contiene datos que cambian por frame o draw call (como matrices de transformación o parámetros de materiales).
  *
+ * La política de uso (`BufferUsage`) decide el `D3D11_USAGE` y el acceso de CPU;
+ * los `init*` son atajos de @ref Buffer::create para los casos comunes. Los buffers
+ * dinámicos y de staging se abren con @ref Buffer::MapScope, que hace el `Unmap` al
+ * salir del ámbito.
+ *
  * @note Para estudiantes:
  * - Los buffers son fundamentales para enviar datos de CPU a GPU.
  * - Los **Vertex/Index Buffers** suelen crearse una sola vez y usarse muchas veces.
@@ -28,16 +46,60 @@ public:
     /** @brief Destructor por defecto. */
     ~Buffer() = default;
 
+    /**
+     * @class MapScope
+     * @brief `Map` al construir y `Unmap` al destruir (si el `Map` funcionó).
+     *
+     * @note Con `D3D11_MAP_FLAG_DO_NOT_WAIT`, `getResult` puede ser
+     * `DXGI_ERROR_WAS_STILL_DRAWING`: no es un error, hay que reintentar más tarde.
+     */
+    class MapScope {
+    public:
+        MapScope(DeviceContext& deviceContext, Buffer& buffer, D3D11_MAP mapType, unsigned int mapFlags = 0,
+            const std::source_location& location = std::source_location::current());
+        ~MapScope();
+        MapScope(const MapScope&) = delete;
+        MapScope& operator=(const MapScope&) = delete;
+
+        bool isMapped() const { return SUCCEEDED(m_result); }
+        HRESULT getResult() const { return m_result; }
+        /** @brief Memoria del buffer (nula si no se pudo mapear). */
+        void* getData() const { return m_mapped.pData; }
+
+    private:
+        DeviceContext& m_deviceContext;
+        Buffer& m_buffer;
+        D3D11_MAPPED_SUBRESOURCE m_mapped = {};
+        HRESULT m_result = E_FAIL;
+    };
+
+    /**
+     * @brief Crea el buffer con una política de uso.
+     * @param device Dispositivo Direct3D.
+     * @param usage Política (ver `BufferUsage`).
+     * @param bindFlag `D3D11_BIND_*` (0 para staging).
+     * @param byteWidth Capacidad en bytes.
+     * @param stride Bytes por elemento (en un Index Buffer, 2 o 4: decide el formato).
+     * @param data Datos iniciales (`byteWidth` bytes); obligatorios si es inmutable.
+     * @return `S_OK`; `E_INVALIDARG` si la combinación no es válida.
+     */
+    HRESULT create(Device& device, BufferUsage usage, unsigned int bindFlag,
+        unsigned int byteWidth, unsigned int stride, const void* data = nullptr);
+
     /**
      * @brief Inicializa un Vertex o Index Buffer a partir de una malla.
      * @param device Dispositivo Direct3D para la creación.
      * @param mesh Datos de la malla (vértices e índices).
      * @param bindFlag Tipo de enlace del buffer (`D3D11_BIND_VERTEX_BUFFER` o `D3D11_BIND_INDEX_BUFFER`).
+     * @param usage Política de uso; por defecto inmutable (geometría estática).
      * @return `S_OK` si fue exitoso, código de error en caso contrario.
      *
-     * @note Los datos de `MeshComponent` se copian a GPU al crear el buffer.
+     * @note Los datos de `MeshComponent` se copian a GPU al crear el buffer. Un Index
+     * Buffer se sube con índices de 16 bits si la malla tiene menos de 65 536 vértices
+     * (la mitad de memoria y de ancho de banda); ver @ref getIndexFormat.
      */
-    HRESULT init(Device& device, const MeshComponent& mesh, unsigned int bindFlag);
+    HRESULT init(Device& device, const MeshComponent& mesh, unsigned int bindFlag,
+        BufferUsage usage = BUFFER_IMMUTABLE);
 
     /**
      * @brief Inicializa un Constant Buffer vacío.
@@ -49,6 +111,126 @@ public:
      */
     HRESULT init(Device& device, unsigned int ByteWidth);
 
+    /**
+     * @brief Inicializa un Vertex Buffer inmutable con vértices ya codificados.
+     * @param device Dispositivo Direct3D.
+     * @param data Vértices (`count * stride` bytes), p. ej. de `VertexFormat::encode`.
+     * @param stride Bytes por vértice.
+     * @param count Número de vértices.
+     * @return `S_OK` si fue exitoso, código de error en caso contrario.
+     *
+     * @note `MeshAsset` lo usa para el stream completo y para el de solo posiciones
+     * que leen los pases de profundidad (menos bytes por vértice, mejor caché).
+     */
+    HRESULT initVertices(Device& device, const void* data, unsigned int stride, unsigned int count);
+
+    /**
+     * @brief Inicializa un Index Buffer inmutable.
+     * @param device Dispositivo Direct3D.
+     * @param indices Índices de 32 bits.
+     * @param count Número de índices.
+     * @param narrow `true` para subirlos como `R16_UINT` (todos deben ser menores que 65 536).
+     * @return `S_OK` si fue exitoso, código de error en caso contrario.
+     */
+    HRESULT initIndices(Device& device, const unsigned int* indices, unsigned int count, bool narrow);
+
+    /**
+     * @brief Inicializa un Vertex o Index Buffer `DEFAULT` vacío, para rellenarlo por partes.
+     * @param device Dispositivo Direct3D.
+     * @param stride Bytes por elemento (2 o 4 en un Index Buffer: `R16_UINT` o `R32_UINT`).
+     * @param count Número de elementos.
+     * @param bindFlag `D3D11_BIND_VERTEX_BUFFER` o `D3D11_BIND_INDEX_BUFFER`.
+     * @return `S_OK` si fue exitoso, código de error en caso contrario.
+     *
+     * @note `GeometryPool` lo usa para sus buffers compartidos; se escribe con
+     * @ref update (con `D3D11_BOX`) y @ref copyRegion.
+     */
+    HRESULT initStorage(Device& device, unsigned int stride, unsigned int count, unsigned int bindFlag);
+
+    /**
+     * @brief Inicializa un Vertex Buffer `DEFAULT` que además puede reescribir un compute shader.
+     * @param device Dispositivo Direct3D.
+     * @param data Vértices iniciales (`count * stride` bytes).
+     * @param stride Bytes por vértice (múltiplo de 4).
+     * @param count Número de vértices.
+     * @return `S_OK` si fue exitoso, código de error en caso contrario.
+     *
+     * @note Se crea con `D3D11_RESOURCE_MISC_BUFFER_ALLOW_RAW_VIEWS`: el kernel lo
+     * escribe por una UAV sin tipo (`RWByteAddressBuffer`) creada sobre @ref getResource.
+     * `SkinningSystem` deja ahí los vértices ya deformados.
+     */
+    HRESULT initWritableVertices(Device& device, const void* data, unsigned int stride, unsigned int count);
+
+    /**
+     * @brief Copia bytes de otro buffer en la GPU (`CopySubresourceRegion`).
+     * @param deviceContext Contexto del dispositivo.
+     * @param dstOffset Byte de destino en este buffer.
+     * @param source Buffer de origen (distinto de este).
+     * @param srcOffset Byte de origen.
+     * @param bytes Bytes a copiar.
+     */
+    void copyRegion(DeviceContext& deviceContext, unsigned int dstOffset, const Buffer& source,
+        unsigned int srcOffset, unsigned int bytes);
+
+    /**
+     * @brief Inicializa un buffer dinámico (escritura de CPU cada frame).
+     * @param device Dispositivo Direct3D.
+     * @param ByteWidth Capacidad en bytes.
+     * @param stride Tamaño de cada elemento (p. ej. datos por instancia).
+     * @param bindFlag Tipo de enlace (`D3D11_BIND_VERTEX_BUFFER`, etc.).
+     * @return `S_OK` si fue exitoso, código de error en caso contrario.
+     *
+     * @note Se crea con `D3D11_USAGE_DYNAMIC` y se rellena con `write()`.
+     */
+    HRESULT initDynamic(Device& device, unsigned int ByteWidth, unsigned int stride, unsigned int bindFlag);
+
+    /**
+     * @brief Reescribe por completo un buffer dinámico (`Map` + `WRITE_DISCARD`).
+     * @param deviceContext Contexto del dispositivo.
+     * @param pSrcData Datos fuente en CPU.
+     * @param byteCount Bytes a copiar (no mayor que la capacidad).
+     * @return `S_OK` si fue exitoso, código de error en caso contrario.
+     */
+    HRESULT write(DeviceContext& deviceContext, const void* pSrcData, unsigned int byteCount);
+
+    /**
+     * @brief Añade datos a un buffer `BUFFER_DYNAMIC_RING` sin esperar a la GPU.
+     * @param deviceContext Contexto del dispositivo.
+     * @param pSrcData Datos fuente en CPU.
+     * @param byteCount Bytes a copiar (no mayor que la capacidad).
+     * @param offset Recibe el byte donde quedaron (múltiplo del stride).
+     * @return `S_OK` si fue exitoso, código de error en caso contrario.
+     *
+     * @note Cuando no caben al final, el anillo vuelve al principio con
+     * `WRITE_DISCARD`: lo escrito antes deja de ser válido para draws nuevos.
+     */
+    HRESULT append(DeviceContext& deviceContext, const void* pSrcData, unsigned int byteCount,
+        unsigned int& offset);
+
+    /**
+     * @brief `Map` del subrecurso 0 (mejor con @ref MapScope).
+     * @return El `HRESULT` de `Map`; `E_INVALIDARG` si el tipo no casa con la política.
+     * @note `location` llega a `StallDetector`: las esperas se atribuyen a quien llama.
+     */
+    HRESULT map(DeviceContext& deviceContext, D3D11_MAP mapType, unsigned int mapFlags,
+        D3D11_MAPPED_SUBRESOURCE& mapped,
+        const std::source_location& location = std::source_location::current());
+
+    /** @brief `Unmap` del subrecurso 0. */
+    void unmap(DeviceContext& deviceContext);
+
+    /** @brief Política con la que se creó. */
+    BufferUsage getUsage() const { return m_usage; }
+
+    /** @brief Recurso D3D11 (para crear vistas SRV/UAV sobre él). */
+    ID3D11Buffer* getResource() const { return m_buffer; }
+
+    /** @brief Capacidad en bytes del buffer. */
+    unsigned int getByteWidth() const { return m_byteWidth; }
+
+    /** @brief Formato de los índices (`R16_UINT` o `R32_UINT`); `UNKNOWN` si no es un Index Buffer. */
+    DXGI_FORMAT getIndexFormat() const { return m_indexFormat; }
+
     /**
      * @brief Actualiza el contenido de un Constant Buffer en memoria GPU.
      * @param deviceContext Contexto del dispositivo.
@@ -67,7 +249,8 @@ public:
         const D3D11_BOX* pDstBox,
         const void* pSrcData,
         unsigned int SrcRowPitch,
-        unsigned int SrcDepthPitch);
+        unsigned int SrcDepthPitch,
+        const std::source_location& location = std::source_location::current());
 
     /**
      * @brief Establece el buffer para su uso en el pipeline de render.
@@ -75,7 +258,8 @@ public:
      * @param StartSlot Índice inicial del slot donde enlazar el buffer.
      * @param NumBuffers Número de buffers a establecer.
      * @param setPixelShader Si es `true`, también se asigna al Pixel Shader.
-     * @param format Formato del índice (solo usado en Index Buffers).
+     * @param format Formato del índice (solo usado en Index Buffers); con `UNKNOWN`
+     * se usa el del propio buffer (@ref getIndexFormat).
      *
      * @note Este método configura el pipeline para que los shaders puedan leer el contenido del buffer.
      */
@@ -110,4 +294,8 @@ private:
     unsigned int m_stride = 0;        ///< Tamaño de cada elemento (en bytes) para Vertex Buffers.
     unsigned int m_offset = 0;        ///< Desplazamiento inicial.
     unsigned int m_bindFlag = 0;      ///< Tipo de enlace del buffer (vertex/index/constant).
+    unsigned int m_byteWidth = 0;     ///< Capacidad total en bytes.
+    DXGI_FORMAT m_indexFormat = DXGI_FORMAT_UNKNOWN; ///< Formato de los índices (Index Buffers).
+    BufferUsage m_usage = BUFFER_DEFAULT; ///< Política de creación.
+    unsigned int m_ringCursor = 0;    ///< Siguiente byte libre de un anillo dinámico.
 };
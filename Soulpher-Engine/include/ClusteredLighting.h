@@ -0,0 +1,201 @@
+﻿/**
+ * @file ClusteredLighting.h
+ * @brief Luces puntuales y focos con forward+ por clusters: un compute shader reparte
+ * las luces en una rejilla del frustum y cada píxel recorre solo las de su celda.
+ *
+ * @details
+ * Hasta ahora la única luz era la direccional de `m_LightPos` (la del shadow map). Con
+ * muchas luces locales, probarlas todas en cada píxel no escala; aquí:
+ *
+ * 1. **Lista de luces** (CPU): @ref ClusteredLighting::addPointLight y
+ *    @ref ClusteredLighting::addSpotLight desde la simulación; @ref capture copia la
+ *    lista para el render (como `Actor::capture`). Se suben a un `StructuredBuffer`
+ *    dinámico (t4) de hasta @ref kMaxLights.
+ * 2. **Culling** (GPU, @ref cull, `LightCulling.fx`): el frustum se parte en
+ *    @ref kClusterX x @ref kClusterY baldosas de pantalla y @ref kClusterZ cortes en
+ *    profundidad con reparto logarítmico (*froxels*). Un grupo por corte y un hilo por
+ *    baldosa: cada hilo calcula la AABB en vista de su cluster, el grupo carga las
+ *    luces por tandas en memoria compartida (ya en vista) y cada hilo apunta las
+ *    esferas que tocan su caja, hasta @ref kMaxLightsPerCluster.
+ * 3. **Sombreado** (`ClusteredLights.fxh`, incluido por los .fx receptores e
+ *    `Instancing.fx`): el píxel saca su cluster de `SV_Position` y su profundidad en
+ *    vista y suma solo las luces de esa lista (t5 conteos, t6 índices, b5 parámetros).
+ *
+ * Los focos se prueban con la esfera de su alcance (conservador: el cono está dentro).
+ *
+ * Con el camino diferido (`DeferredShading`) los mismos shaders escriben el G-buffer en
+ * lugar de sumar las luces (@ref setGBufferOutput) y el kernel de iluminación lee las
+ * luces y los parámetros de aquí (@ref getLightSRV, @ref getParams).
+ *
+ * @note Para estudiantes: el reparto logarítmico da cortes finos cerca de la cámara,
+ * donde un cluster ocupa más píxeles, y gruesos lejos; con cortes uniformes casi todas
+ * las luces cercanas caerían en el primero.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "ConstantBufferLayout.h"
+#include <vector>
+
+class Device;
+class DeviceContext;
+
+/**
+ * @class ClusteredLighting
+ * @brief Luces locales de la escena, su reparto en clusters y los recursos para sombrearlas.
+ */
+class ClusteredLighting {
+public:
+    ClusteredLighting() = default;
+    ~ClusteredLighting() { destroy(); }
+
+    /// Baldosas horizontales de la rejilla (deben coincidir con `ClusteredLights.fxh`).
+    static const unsigned int kClusterX = 16;
+    /// Baldosas verticales.
+    static const unsigned int kClusterY = 9;
+    /// Cortes en profundidad.
+    static const unsigned int kClusterZ = 24;
+    /// Luces como mucho por cluster (las siguientes no se apuntan).
+    static const unsigned int kMaxLightsPerCluster = 64;
+    /// Luces como mucho por frame (capacidad del buffer).
+    static const unsigned int kMaxLights = 1024;
+    /// Primer registro `t#` de los recursos del PS (luces, conteos, índices).
+    static const unsigned int kTextureSlot = 4;
+
+    /// Luz puntual (alcance esférico) o foco (cono alrededor de `direction`).
+    struct Light {
+        enum Type { POINT, SPOT };
+        Type type = POINT;
+        XMFLOAT3 position = XMFLOAT3(0.0f, 0.0f, 0.0f);
+        float range = 1.0f;                               ///< A esta distancia la luz llega a 0.
+        XMFLOAT3 color = XMFLOAT3(1.0f, 1.0f, 1.0f);
+        float intensity = 1.0f;
+        XMFLOAT3 direction = XMFLOAT3(0.0f, -1.0f, 0.0f); ///< Solo focos (normalizada).
+        float innerAngle = 0.0f;                          ///< Semiángulo (radianes) a plena intensidad.
+        float outerAngle = 0.0f;                          ///< Semiángulo donde se apaga.
+    };
+
+    /**
+     * @brief Crea el kernel de culling, el buffer de luces y los de clusters.
+     * @return `S_OK`; `DXGI_ERROR_UNSUPPORTED` por debajo de 11_0 (sin luces locales).
+     */
+    HRESULT init(Device& device);
+
+    /** @brief Añade una luz puntual. @return Su índice en @ref getLights. */
+    unsigned int addPointLight(const XMFLOAT3& position, float range, const XMFLOAT3& color, float intensity);
+
+    /**
+     * @brief Añade un foco.
+     * @param innerAngle Semiángulo (radianes) a plena intensidad.
+     * @param outerAngle Semiángulo donde se apaga.
+     * @return Su índice en @ref getLights.
+     */
+    unsigned int addSpotLight(const XMFLOAT3& position, const XMFLOAT3& direction, float range,
+        const XMFLOAT3& color, float intensity, float innerAngle, float outerAngle);
+
+    /** @brief Luces de la simulación (se pueden editar; el render ve la copia de @ref capture). */
+    std::vector<Light>& getLights() { return m_lights; }
+
+    /** @brief Quita todas las luces. */
+    void clear() { m_lights.clear(); }
+
+    /** @brief Copia las luces para el render (con el hilo de render parado). */
+    void capture() { m_renderLights = m_lights; }
+
+    /** @brief Con `false`, @ref cull deja la lista vacía y los shaders no suman nada. */
+    void setEnabled(bool enabled) { m_enabled = enabled; }
+
+    /**
+     * @brief Sube las luces y los parámetros y reparte las luces en los clusters.
+     * @param view Vista de la cámara del frame.
+     * @param projection Proyección en perspectiva (LH) del frame.
+     * @param nearZ Plano cercano (empieza el primer corte).
+     * @param farZ Plano lejano (termina el último).
+     * @param width Ancho del viewport en píxeles.
+     * @param height Alto.
+     * @note Desenlaza t4-t6 del PS: los buffers se escriben aquí por UAV.
+     */
+    void cull(DeviceContext& deviceContext, const XMMATRIX& view, const XMMATRIX& projection,
+        float nearZ, float farZ, unsigned int width, unsigned int height);
+
+    /** @brief Enlaza luces, clusters y parámetros en el PS (t4-t6, b5). */
+    void bind(DeviceContext& deviceContext);
+
+    /**
+     * @brief Como @ref bind, pero para dibujar desde otro punto de vista (las caras de
+     * las sondas de reflexión): los clusters son los de la cámara, así que los PS
+     * recorren todas las luces subidas y no leen las sondas (no se reflejan a sí mismas).
+     * @param eye Posición del punto de vista (orienta la normal de la cara).
+     * @note Llamar tras @ref cull (usa las luces de ese frame).
+     */
+    void bindCapture(DeviceContext& deviceContext, const XMFLOAT3& eye);
+
+    /**
+     * @brief Con `true`, los PS de `ClusteredLights.fxh` escriben el G-buffer (albedo y
+     * superficie en dos render targets) en lugar del color iluminado.
+     * @note Vuelve a subir b5: llamar tras @ref cull, y con `false` antes de las capas
+     * que se dibujan en forward.
+     */
+    void setGBufferOutput(DeviceContext& deviceContext, bool enabled);
+
+    /** @brief Luces del último @ref cull (`StructuredBuffer`, t4). */
+    ID3D11ShaderResourceView* getLightSRV() const { return m_lightSRV; }
+
+    /** @brief Constantes de `cbClusters` del último @ref cull (b5). */
+    ID3D11Buffer* getParams() const { return m_params; }
+
+    /** @brief Libera kernel y buffers. */
+    void destroy();
+
+    /** @brief `true` tras un @ref init correcto. */
+    bool isReady() const { return m_cullShader != nullptr; }
+
+    /** @brief Luces enviadas a la GPU en el último @ref cull. */
+    unsigned int getUploadedLightCount() const { return m_uploadedLights; }
+
+private:
+    /// Luz tal como la leen los .fx (`ClusterLight`): color ya por intensidad.
+    struct GpuLight {
+        XMFLOAT3 position;
+        float range;
+        XMFLOAT3 color;
+        float spotCosOuter;   ///< Puntuales: -2 (todo dentro del "cono").
+        XMFLOAT3 direction;
+        float spotCosInner;   ///< Puntuales: -1.
+    };
+
+    /// Constantes de `cbClusters` (`CB_SLOT_CLUSTERS`).
+    struct ClusterParams {
+        XMMATRIX view;            ///< Transpuesta, como `CBNeverChanges`.
+        XMMATRIX inverseView;     ///< Vista -> mundo (transpuesta), para reconstruir desde la profundidad.
+        XMFLOAT4 projection;      ///< x = P._11, y = P._22, z = cerca, w = lejos.
+        XMFLOAT4 slices;          ///< x, y: corte = log(z) * x + y.
+        XMFLOAT4 cameraPosition;  ///< Orienta la normal por derivadas hacia la cámara.
+        XMFLOAT4 screen;          ///< x, y = tamaño del viewport; z, w = tamaño de baldosa en píxeles.
+        uint32_t lightCount;
+        uint32_t gbuffer;         ///< 1: los PS escriben el G-buffer (@ref setGBufferOutput).
+        uint32_t capture;         ///< 1: todas las luces, sin clusters ni sondas (@ref bindCapture).
+        uint32_t pad;
+    };
+    /// Layout de `cbClusters` (ver `ConstantBufferLayouts`).
+    static const ConstantBufferLayouts::Registration kParamsLayout;
+
+    std::vector<Light> m_lights;        ///< Las de la simulación.
+    std::vector<Light> m_renderLights;  ///< Copia de @ref capture.
+    std::vector<GpuLight> m_upload;     ///< Memoria reutilizada para la subida.
+    bool m_enabled = true;
+    unsigned int m_uploadedLights = 0;
+    ClusterParams m_paramsData = {};    ///< Última subida de @ref m_params.
+
+    ID3D11ComputeShader* m_cullShader = nullptr;
+    ID3D11Buffer* m_params = nullptr;
+    ID3D11Buffer* m_captureParams = nullptr;    ///< `cbClusters` de @ref bindCapture.
+    ID3D11Buffer* m_lightBuffer = nullptr;
+    ID3D11ShaderResourceView* m_lightSRV = nullptr;
+    ID3D11Buffer* m_countBuffer = nullptr;      ///< Luces por cluster (R32_UINT).
+    ID3D11ShaderResourceView* m_countSRV = nullptr;
+    ID3D11UnorderedAccessView* m_countUAV = nullptr;
+    ID3D11Buffer* m_indexBuffer = nullptr;      ///< kMaxLightsPerCluster índices por cluster (R32_UINT).
+    ID3D11ShaderResourceView* m_indexSRV = nullptr;
+    ID3D11UnorderedAccessView* m_indexUAV = nullptr;
+};
@@ -0,0 +1,194 @@
+﻿/**
+ * @file ConsoleVariable.h
+ * @brief Variables de consola (cvars): interruptores de funciones del motor sin recompilar.
+ *
+ * @details
+ * Para comparar una función de rendimiento encendida y apagada (pre-pase de
+ * profundidad, oclusión, impostores...) en la máquina de otro hay que poder cambiarla
+ * sin recompilar. Una cvar es una variable global con nombre (`r.depthPrepass`):
+ *
+ * - **Registro en la inicialización estática**: se declara como objeto estático en el
+ *   `.cpp` que la usa; su constructor la apunta en @ref ConsoleVariables.
+ * - **Lectura sin coste**: el código que la usa lee el objeto (`cvar.get()`, una carga
+ *   atómica); desde otro módulo, @ref ConsoleVariables::find una vez y se guarda el
+ *   puntero. En ningún camino caliente se busca por nombre.
+ * - **Escritura** desde la línea de comandos (`-cvar nombre=valor`), un archivo
+ *   (`Engine.cfg` junto al ejecutable y `-config archivo`) y la ventana "Console" de la
+ *   UI. Un valor para una cvar que aún no existe se guarda y se aplica al registrarse.
+ *
+ * Los valores son atómicos: el hilo principal puede cambiarlos mientras el de render
+ * los lee.
+ *
+ * @note Para estudiantes: el prefijo agrupa (`r.` render, `sim.` simulación). El
+ * nombre es una promesa: los archivos de configuración de otros dependen de él.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include <atomic>
+#include <mutex>
+
+/**
+ * @class ConsoleVariable
+ * @brief Parte común de una cvar: nombre, ayuda, tipo y conversión a texto.
+ */
+class ConsoleVariable {
+public:
+    /// Tipo del valor.
+    enum Type {
+        CVAR_BOOL,
+        CVAR_INT,
+        CVAR_FLOAT,
+    };
+
+    ConsoleVariable(const ConsoleVariable&) = delete;
+    ConsoleVariable& operator=(const ConsoleVariable&) = delete;
+
+    const char* getName() const { return m_name; }
+    const char* getHelp() const { return m_help; }
+    Type getType() const { return m_type; }
+
+    /**
+     * @brief Cambia el valor a partir de texto (`1`/`0`/`true`/`false`, enteros, reales).
+     * @return `false` si el texto no es un valor del tipo.
+     */
+    virtual bool setFromString(const char* text) = 0;
+
+    /** @brief Valor actual como texto. */
+    virtual std::string toString() const = 0;
+
+    /** @brief Vuelve al valor por defecto. */
+    virtual void reset() = 0;
+
+    /** @brief El valor no es el de por defecto (lo que guarda @ref ConsoleVariables::saveFile). */
+    virtual bool isModified() const = 0;
+
+protected:
+    ConsoleVariable(const char* name, const char* help, Type type) : m_name(name), m_help(help), m_type(type) {}
+    /// La quita de @ref ConsoleVariables.
+    virtual ~ConsoleVariable();
+
+    /// La apunta en @ref ConsoleVariables y le aplica su valor pendiente; al final del
+    /// constructor de cada tipo (antes, `setFromString` aún no existe).
+    void registerVariable();
+
+private:
+    const char* m_name;
+    const char* m_help;
+    Type m_type;
+};
+
+/**
+ * @class TConsoleVariable
+ * @brief Cvar de tipo `T` (`bool`, `int` o `float`).
+ *
+ * @code
+ * static CVarBool cvDepthPrepass("r.depthPrepass", true, "Pre-pase de profundidad de los opacos");
+ * if (cvDepthPrepass.get()) { ... }
+ * @endcode
+ */
+template<typename T>
+class TConsoleVariable : public ConsoleVariable {
+    static_assert(std::is_same<T, bool>::value || std::is_same<T, int>::value || std::is_same<T, float>::value,
+        "Console variables hold bool, int or float");
+
+public:
+    static constexpr Type kType = std::is_same<T, bool>::value ? CVAR_BOOL : std::is_same<T, int>::value ? CVAR_INT : CVAR_FLOAT;
+
+    TConsoleVariable(const char* name, T defaultValue, const char* help)
+        : ConsoleVariable(name, help, kType), m_default(defaultValue), m_value(defaultValue) {
+        registerVariable();
+    }
+
+    /** @brief Valor actual (cualquier hilo). */
+    T get() const { return m_value.load(std::memory_order_relaxed); }
+    void set(T value) { m_value.store(value, std::memory_order_relaxed); }
+    T getDefault() const { return m_default; }
+
+    bool setFromString(const char* text) override;
+    std::string toString() const override;
+    void reset() override { set(m_default); }
+    bool isModified() const override { return get() != m_default; }
+
+private:
+    const T m_default;
+    std::atomic<T> m_value;
+};
+
+// Conversiones de cada tipo, definidas en ConsoleVariable.cpp.
+template<> bool TConsoleVariable<bool>::setFromString(const char* text);
+template<> std::string TConsoleVariable<bool>::toString() const;
+template<> bool TConsoleVariable<int>::setFromString(const char* text);
+template<> std::string TConsoleVariable<int>::toString() const;
+template<> bool TConsoleVariable<float>::setFromString(const char* text);
+template<> std::string TConsoleVariable<float>::toString() const;
+
+typedef TConsoleVariable<bool> CVarBool;
+typedef TConsoleVariable<int> CVarInt;
+typedef TConsoleVariable<float> CVarFloat;
+
+/**
+ * @class ConsoleVariables
+ * @brief Registro de todas las cvars, valores pendientes, archivos y comandos de consola.
+ */
+class ConsoleVariables {
+public:
+    /// Archivo que se lee al arrancar si existe (junto al ejecutable).
+    static const char* const kDefaultConfig;
+
+    /** @brief Registro del motor. */
+    static ConsoleVariables& getDefault();
+
+    /**
+     * @brief Cvar por nombre, para guardar el puntero (no en caminos calientes).
+     * @return `nullptr` si no existe o es de otro tipo.
+     */
+    template<typename T>
+    TConsoleVariable<T>* find(const char* name) {
+        ConsoleVariable* variable = findVariable(name);
+        if (!variable || variable->getType() != TConsoleVariable<T>::kType) {
+            return nullptr;
+        }
+        return static_cast<TConsoleVariable<T>*>(variable);
+    }
+
+    /** @brief Cvar por nombre, de cualquier tipo; `nullptr` si no existe. */
+    ConsoleVariable* findVariable(const char* name);
+
+    /**
+     * @brief Cambia una cvar por nombre.
+     * @return `S_OK`; `S_FALSE` si aún no existe (se aplicará al registrarse);
+     * `E_INVALIDARG` si el valor no es de su tipo.
+     */
+    HRESULT set(const std::string& name, const std::string& value);
+
+    /**
+     * @brief Aplica un archivo de líneas `nombre valor` (o `nombre = valor`); `#` comenta.
+     * @return `S_OK`, o `E_FAIL` si no se pudo abrir.
+     */
+    HRESULT loadFile(const std::string& path);
+
+    /** @brief Escribe las cvars cambiadas en formato de @ref loadFile. */
+    HRESULT saveFile(const std::string& path) const;
+
+    /**
+     * @brief Ejecuta una línea de la consola: `nombre`, `nombre valor`, `reset nombre`,
+     * `list [prefijo]`, `save [archivo]` o `help`.
+     * @param line Línea escrita.
+     * @param output Recibe las líneas de respuesta.
+     */
+    void execute(const std::string& line, std::vector<std::string>& output);
+
+    /** @brief Todas las cvars ordenadas por nombre. */
+    void getSorted(std::vector<ConsoleVariable*>& out) const;
+
+private:
+    friend class ConsoleVariable;
+
+    void add(ConsoleVariable* variable);
+    void remove(ConsoleVariable* variable);
+
+    mutable std::mutex m_mutex;
+    EU::TMap<std::string, ConsoleVariable*> m_variables;
+    EU::TMap<std::string, std::string> m_pending;    ///< Valores de cvars aún sin registrar.
+};
@@ -0,0 +1,100 @@
+﻿/**
+ * @file ConstantBuffer.h
+ * @brief Constant buffer tipado con seguimiento de cambios (dirty tracking).
+ *
+ * @details
+ * `TConstantBuffer<T>` guarda una copia en CPU de los datos de un cbuffer. `set()`
+ * compara el valor nuevo con el último subido y solo marca el buffer como sucio si
+ * cambió; `update()` sube a GPU únicamente cuando está sucio. Así la proyección
+ * deja de subirse cada frame y la vista solo se sube cuando la cámara se mueve.
+ *
+ * @note Para estudiantes:
+ * - La comparación es byte a byte (`memcmp`): `T` debe ser un struct POD sin relleno
+ *   indeterminado (los `CB*` de `Prerequisites.h` lo son).
+ * - Los slots de cada frecuencia están documentados en `Prerequisites.h`.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "Buffer.h"
+#include <cstring>
+
+class Device;
+class DeviceContext;
+
+/**
+ * @class TConstantBuffer
+ * @brief `Buffer` de constantes + copia en CPU + bandera de cambios.
+ * @tparam T Struct con el layout del cbuffer en HLSL.
+ */
+template<typename T>
+class TConstantBuffer {
+public:
+    TConstantBuffer() { std::memset(&m_data, 0, sizeof(T)); }
+    ~TConstantBuffer() = default;
+
+    /**
+     * @brief Crea el buffer en GPU. El contenido se considera sucio hasta el primer `update`.
+     * @param device Dispositivo Direct3D.
+     * @return HRESULT de la creación.
+     */
+    HRESULT init(Device& device) {
+        m_dirty = true;
+        return m_buffer.init(device, sizeof(T));
+    }
+
+    /**
+     * @brief Cambia los datos; solo marca sucio si difieren de los actuales.
+     * @param data Nuevo contenido.
+     */
+    void set(const T& data) {
+        if (std::memcmp(&m_data, &data, sizeof(T)) != 0) {
+            m_data = data;
+            m_dirty = true;
+        }
+    }
+
+    /**
+     * @brief Sube los datos a GPU si cambiaron desde la última subida.
+     * @param deviceContext Contexto del dispositivo.
+     * @return `true` si hubo subida.
+     */
+    bool update(DeviceContext& deviceContext) {
+        if (!m_dirty) {
+            return false;
+        }
+        m_buffer.update(deviceContext, nullptr, 0, nullptr, &m_data, 0, 0);
+        m_dirty = false;
+        return true;
+    }
+
+    /**
+     * @brief Enlaza el buffer en un slot.
+     * @param deviceContext Contexto del dispositivo.
+     * @param slot Registro `b#` del cbuffer.
+     * @param setPixelShader Enlazar también al Pixel Shader.
+     */
+    void render(DeviceContext& deviceContext, unsigned int slot, bool setPixelShader = false) {
+        m_buffer.render(deviceContext, slot, 1, setPixelShader);
+    }
+
+    /** @brief Libera el buffer de GPU. */
+    void destroy() { m_buffer.destroy(); }
+
+    /** @brief Fuerza la próxima subida (p. ej. tras recrear el dispositivo). */
+    void markDirty() { m_dirty = true; }
+
+    /** @brief Datos actuales en CPU. */
+    const T& get() const { return m_data; }
+
+    /** @brief Buffer de GPU (para enlazarlo en etapas sin `render`, como hull o domain). */
+    ID3D11Buffer* getResource() const { return m_buffer.getResource(); }
+
+    /** @brief `true` si hay cambios pendientes de subir. */
+    bool isDirty() const { return m_dirty; }
+
+private:
+    Buffer m_buffer;     ///< Constant buffer en GPU.
+    T m_data;            ///< Copia en CPU del contenido.
+    bool m_dirty = true; ///< Cambios pendientes de subir.
+};
@@ -0,0 +1,110 @@
+﻿/**
+ * @file ConstantBufferLayout.h
+ * @brief Layout de cada constant buffer en C++ y su comprobación contra la reflexión
+ * del bytecode (`ID3D11ShaderReflection`).
+ *
+ * @details
+ * Los `CB*` de `Prerequisites.h` y los parámetros de cada pase se escriben a mano dos
+ * veces: el struct en C++ y el `cbuffer` en el .fx. Si uno cambia y el otro no, el
+ * shader lee basura sin ningún error. Cada struct describe aquí su layout (nombre del
+ * `cbuffer`, registro y, por campo, variable HLSL, offset y tamaño) y `ShaderLibrary`
+ * comprueba cada variante al cargarla (compilada o de la caché), al recargarla en
+ * caliente y al cocinarla:
+ *
+ * - el `cbuffer` está enlazado en el registro de @ref ConstantBufferLayout::slot;
+ * - su tamaño es el del struct (redondeado a 16 bytes, como lo sube D3D11);
+ * - cada variable HLSL tiene campo en C++ con el mismo offset y tamaño, y al revés.
+ *
+ * Si algo no cuadra la variante no se crea (`E_INVALIDARG`) y el log dice qué campo y
+ * con qué offsets: el sistema que la pedía se desactiva como con un error de compilación.
+ * Los `cbuffer` sin layout registrado (y los que el shader no usa) no se comprueban.
+ *
+ * Un layout se registra con un @ref ConstantBufferLayouts::Registration estático (como
+ * las cvars). Para los structs privados de un pase se declara como miembro estático de
+ * su clase, que sí puede nombrar el struct:
+ * @code
+ * const ConstantBufferLayouts::Registration PostProcess::kParamsLayout({ "cbPost", CB_SLOT_POST,
+ *     sizeof(PostParams), { CB_FIELD(PostParams, size, "PostSize"), ... } });
+ * @endcode
+ *
+ * @note Para estudiantes: HLSL no deja que una variable cruce un límite de 16 bytes; un
+ * `float3` seguido de un `float4` en C++ queda a 12 bytes y en HLSL a 16. Es justo el
+ * error que esto convierte en un mensaje en lugar de un color raro.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include <cstddef>
+#include <mutex>
+
+struct ShaderKey;
+
+/**
+ * @struct ConstantBufferField
+ * @brief Un campo del struct de C++ y la variable HLSL que le corresponde.
+ */
+struct ConstantBufferField {
+    const char* name;       ///< Variable en el `cbuffer`.
+    unsigned int offset;    ///< Bytes desde el inicio del struct.
+    unsigned int size;      ///< Bytes del campo (el de la variable HLSL).
+};
+
+/// Campo `member` de `Type` leído en HLSL como `hlslName`.
+#define CB_FIELD(Type, member, hlslName) \
+    ConstantBufferField{ hlslName, static_cast<unsigned int>(offsetof(Type, member)), static_cast<unsigned int>(sizeof(Type::member)) }
+
+/// Varios campos de `Type` desde `first`, leídos en HLSL como una variable de `bytes` (p. ej. un `uint4`).
+#define CB_FIELD_RANGE(Type, first, hlslName, bytes) \
+    ConstantBufferField{ hlslName, static_cast<unsigned int>(offsetof(Type, first)), static_cast<unsigned int>(bytes) }
+
+/**
+ * @struct ConstantBufferLayout
+ * @brief Lo que C++ espera de un `cbuffer`.
+ */
+struct ConstantBufferLayout {
+    std::string name;                       ///< Nombre del `cbuffer` en HLSL.
+    unsigned int slot;                      ///< Registro `b#` (@ref ConstantBufferSlot).
+    unsigned int size;                      ///< `sizeof` del struct.
+    std::vector<ConstantBufferField> fields;
+};
+
+/**
+ * @class ConstantBufferLayouts
+ * @brief Registro de layouts y validación del bytecode contra ellos.
+ */
+class ConstantBufferLayouts {
+public:
+    /// Registra un layout al construirse (para objetos estáticos).
+    struct Registration {
+        explicit Registration(const ConstantBufferLayout& layout) { getDefault().add(layout); }
+    };
+
+    /** @brief Registro del motor. */
+    static ConstantBufferLayouts& getDefault();
+
+    /** @brief Añade un layout (o sustituye el del mismo `cbuffer`). */
+    void add(const ConstantBufferLayout& layout);
+
+    /** @brief Layout de un `cbuffer` (copia); `false` si no está registrado. */
+    bool find(const std::string& name, ConstantBufferLayout& layout) const;
+
+    /**
+     * @brief Compara los `cbuffer` enlazados en `bytecode` con sus layouts.
+     * @param key Variante (solo para los mensajes).
+     * @param bytecode Bytecode compilado.
+     * @return `S_OK`; `E_INVALIDARG` con alguna diferencia (cada una va al log); o el
+     * error de `D3DReflect`.
+     * @note Se puede llamar desde cualquier hilo.
+     */
+    HRESULT validate(const ShaderKey& key, ID3DBlob* bytecode) const;
+
+    /** @brief Layouts registrados. */
+    unsigned int getCount() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return static_cast<unsigned int>(m_layouts.size());
+    }
+
+private:
+    mutable std::mutex m_mutex;
+    std::vector<ConstantBufferLayout> m_layouts;
+};
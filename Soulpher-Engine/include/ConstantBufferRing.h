@@ -0,0 +1,79 @@
+﻿/**
+ * @file ConstantBufferRing.h
+ * @brief Anillo de constant buffers dinámicos para datos transitorios por draw.
+ *
+ * @details
+ * Subir constantes por objeto con `UpdateSubresource` sobre buffers `DEFAULT`
+ * obliga al driver a copiar y a renombrar el recurso en cada llamada. El anillo
+ * sustituye eso por un conjunto de bloques `D3D11_USAGE_DYNAMIC` de 256 bytes:
+ * cada `allocate` avanza un cursor, hace `Map(WRITE_DISCARD)` + `memcpy` sobre el
+ * bloque siguiente y devuelve ese bloque listo para enlazar.
+ *
+ * - `update()` al inicio del frame devuelve el cursor a cero (los bloques se reutilizan).
+ * - Si un frame necesita más bloques, el anillo crece y conserva esa capacidad.
+ *
+ * @note Para estudiantes: con D3D11.1 se usaría un único buffer grande y
+ * `VSSetConstantBuffers1` con desplazamientos; el motor compila contra el
+ * SDK de DirectX (junio 2010), que solo expone la interfaz 11.0, así que cada
+ * sub-asignación es un bloque propio del tamaño de la granularidad de 11.1 (256 bytes).
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "Buffer.h"
+#include <deque>
+
+class Device;
+class DeviceContext;
+
+/**
+ * @class ConstantBufferRing
+ * @brief Sub-asignador por frame de constant buffers dinámicos.
+ */
+class ConstantBufferRing {
+public:
+    ConstantBufferRing() = default;
+    ~ConstantBufferRing() = default;
+
+    /**
+     * @brief Prepara el anillo.
+     * @param device Dispositivo con el que se crean los bloques.
+     * @param blockSize Bytes por bloque (múltiplo de 16; 256 por defecto).
+     * @param initialBlocks Bloques creados por adelantado.
+     * @return HRESULT de la creación de los bloques iniciales.
+     */
+    HRESULT init(Device& device, unsigned int blockSize = 256, unsigned int initialBlocks = 64);
+
+    /** @brief Nuevo frame: el cursor vuelve al primer bloque. */
+    void update();
+
+    /**
+     * @brief Copia `bytes` de `data` al siguiente bloque libre.
+     * @param deviceContext Contexto donde se hace el `Map`.
+     * @param data Datos de CPU.
+     * @param bytes Tamaño (≤ tamaño de bloque).
+     * @return Bloque listo para `render(ctx, slot, 1, ...)`, o `nullptr` si falla.
+     *
+     * @note El puntero es válido hasta `destroy()`, pero su contenido solo hasta
+     * que el cursor vuelva a pasar por él (frame siguiente).
+     */
+    Buffer* allocate(DeviceContext& deviceContext, const void* data, unsigned int bytes);
+
+    /** @brief Libera todos los bloques. */
+    void destroy();
+
+    /** @brief Bloques usados en el frame actual. */
+    unsigned int getAllocationCount() const { return m_cursor; }
+
+    /** @brief Bloques creados en total. */
+    unsigned int getCapacity() const { return static_cast<unsigned int>(m_blocks.size()); }
+
+private:
+    /// Añade un bloque dinámico al final del anillo.
+    HRESULT addBlock();
+
+    Device* m_device = nullptr;   ///< Dispositivo para crecer.
+    std::deque<Buffer> m_blocks;  ///< Bloques (deque: direcciones estables al crecer).
+    unsigned int m_blockSize = 0; ///< Bytes por bloque.
+    unsigned int m_cursor = 0;    ///< Siguiente bloque libre.
+};
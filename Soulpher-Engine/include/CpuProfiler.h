@@ -0,0 +1,140 @@
+﻿/**
+ * @file CpuProfiler.h
+ * @brief Instrumentación de CPU por zonas (RAII) con buffers por hilo sin locks.
+ *
+ * @details
+ * - `PROFILE_ZONE("nombre")` mide el bloque que la contiene con `QueryPerformanceCounter`.
+ *   Las zonas se anidan: cada evento guarda su profundidad en la pila del hilo.
+ * - Cada hilo escribe en su propio anillo de eventos; el único punto compartido es un
+ *   índice atómico de escritura (release al escribir, acquire al leer). Registrar un
+ *   hilo nuevo toma un mutex, una sola vez por hilo.
+ * - `PROFILE_FRAME()` marca el inicio de cada frame en el hilo principal; el panel de
+ *   `UserInterface` dibuja los últimos frames como *flame graph*.
+ *
+ * Con `PROFILE` sin definir (configuración Release) las macros no generan código.
+ *
+ * @note Para estudiantes: los nombres deben ser literales (`const char*` con vida
+ * estática); el evento guarda el puntero, no copia el texto, para que medir cueste
+ * apenas dos lecturas del contador.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+/**
+ * @class CpuProfiler
+ * @brief Registro global de zonas de CPU por hilo e historial de frames.
+ */
+class CpuProfiler {
+public:
+    /// Eventos por hilo (anillo; los más antiguos se sobrescriben).
+    static const unsigned int kEventCapacity = 1 << 16;
+    /// Frames recordados para el panel.
+    static const unsigned int kFrameHistory = 64;
+
+    /// Zona terminada, tal como se guarda en el anillo de su hilo.
+    struct Event {
+        const char* name;   ///< Literal dado a `PROFILE_ZONE`.
+        LONGLONG begin;     ///< Contador al entrar.
+        LONGLONG end;       ///< Contador al salir.
+        unsigned int depth; ///< Profundidad de anidamiento (0 = zona raíz).
+    };
+
+    /// Evento devuelto por `collect`, con el hilo que lo produjo.
+    struct ThreadEvent {
+        Event event;
+        unsigned int thread; ///< Índice del hilo (orden de registro).
+    };
+
+    /// Intervalo de un frame completo.
+    struct Frame {
+        LONGLONG begin;
+        LONGLONG end;
+    };
+
+    /**
+     * @brief Medidor RAII de una zona; usar con la macro `PROFILE_ZONE`.
+     */
+    class Zone {
+    public:
+        explicit Zone(const char* name);
+        ~Zone();
+
+    private:
+        Zone(const Zone&) = delete;
+        Zone& operator=(const Zone&) = delete;
+
+        const char* m_name;
+        LONGLONG m_begin;
+    };
+
+    /** @brief Instancia global (las zonas pueden abrirse desde cualquier hilo). */
+    static CpuProfiler& instance();
+
+    /** @brief Marca el inicio de un frame; el anterior pasa al historial. */
+    void beginFrame();
+
+    /** @brief Da nombre al hilo actual en el panel (literal). */
+    void setThreadName(const char* name);
+
+    /** @brief Frames completos guardados (como mucho `kFrameHistory`). */
+    unsigned int getFrameCount() const;
+
+    /**
+     * @brief Frame completo `back` posiciones atrás (0 = el último).
+     */
+    Frame getFrame(unsigned int back) const;
+
+    /**
+     * @brief Copia los eventos de todos los hilos que empiezan en [from, to).
+     * @param from Contador inicial.
+     * @param to Contador final.
+     * @param out Eventos encontrados (se vacía antes).
+     * @return Número de hilos registrados (para reservar un carril por hilo).
+     */
+    unsigned int collect(LONGLONG from, LONGLONG to, std::vector<ThreadEvent>& out) const;
+
+    /** @brief Nombre del hilo `thread` (o "Thread N" si no se le dio uno). */
+    std::string getThreadName(unsigned int thread) const;
+
+    /** @brief Convierte ticks del contador a milisegundos. */
+    double toMs(LONGLONG ticks) const { return ticks * m_msPerTick; }
+
+private:
+    CpuProfiler();
+
+    /// Anillo de eventos de un hilo. Solo su hilo escribe; cualquiera puede leer.
+    struct ThreadBuffer {
+        Event events[kEventCapacity];
+        std::atomic<unsigned long long> writeIndex{ 0 };
+        unsigned int depth = 0;         ///< Pila de zonas abiertas (solo el hilo dueño).
+        const char* name = nullptr;
+        DWORD threadId = 0;
+    };
+
+    /// Buffer del hilo actual (lo registra la primera vez).
+    ThreadBuffer& threadBuffer();
+
+    mutable std::mutex m_threadsMutex;  ///< Protege el alta de hilos en `m_threads`.
+    std::vector<std::unique_ptr<ThreadBuffer>> m_threads;
+    Frame m_frames[kFrameHistory];      ///< Historial circular de frames.
+    unsigned int m_frameWrite = 0;      ///< Frames completos registrados.
+    LONGLONG m_frameBegin = 0;          ///< Inicio del frame en curso.
+    double m_msPerTick = 0.0;           ///< 1000 / frecuencia del contador.
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#if defined(PROFILE)
+/// Mide el bloque actual con el nombre dado (literal).
+#define PROFILE_ZONE(name) CpuProfiler::Zone PROFILE_CONCAT(profileZone_, __LINE__)(name)
+/// Marca el inicio de un frame (hilo principal).
+#define PROFILE_FRAME() CpuProfiler::instance().beginFrame()
+#else
+#define PROFILE_ZONE(name) ((void)0)
+#define PROFILE_FRAME() ((void)0)
+#endif
@@ -0,0 +1,116 @@
+﻿/**
+ * @file CpuTopology.h
+ * @brief Topología de la CPU (núcleos físicos y lógicos, P-cores y E-cores) y política
+ * de afinidad y prioridad por tipo de hilo.
+ *
+ * @details
+ * El motor tiene hilos con necesidades distintas: el principal y el de render marcan el
+ * frame, los workers del `JobSystem` reparten trabajo corto y los de carga (texturas,
+ * mallas) pueden ir despacio. En una CPU híbrida (Intel Alder Lake y posteriores) el
+ * planificador puede dejar el hilo de render en un núcleo de eficiencia y el frame
+ * tarda el doble sin motivo aparente.
+ *
+ * - **Detección** (una vez, @ref getDefault): `GetLogicalProcessorInformationEx` con
+ *   `RelationProcessorCore` da un registro por núcleo físico con sus procesadores lógicos
+ *   (más de uno con SMT) y su `EfficiencyClass`. Los núcleos de la clase más alta son de
+ *   rendimiento; si todas son iguales, la CPU no es híbrida y todos cuentan como tales.
+ * - **Política** (@ref setPolicy, al arrancar, desde las cvars `cpu.*`): cada hilo llama
+ *   a @ref applyToCurrentThread con su @ref ThreadRole al empezar. El principal y el de
+ *   render se fijan a los P-cores; los de carga, a los E-cores y con prioridad baja; los
+ *   workers quedan libres (sus trabajos caben en cualquier núcleo y robar compensa).
+ * - **Workers**: @ref getWorkerCount los cuenta por núcleos físicos; dos workers en los
+ *   dos hilos de un mismo núcleo compiten por sus unidades y apenas suman.
+ *
+ * @note Para estudiantes: la afinidad es una restricción, no una pista. Fijar un hilo
+ * a un conjunto de núcleos le impide moverse aunque estén ocupados; por eso se fija a
+ * *todos* los P-cores y no a uno concreto.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+
+/**
+ * @class CpuTopology
+ * @brief Núcleos de la máquina y afinidad y prioridad de cada tipo de hilo.
+ */
+class CpuTopology {
+public:
+    /// Tipo de hilo: decide afinidad y prioridad en @ref applyToCurrentThread.
+    enum ThreadRole {
+        THREAD_ROLE_MAIN,           ///< Hilo principal (simulación, culling, envío).
+        THREAD_ROLE_RENDER,         ///< Hilo de render (`RenderThread`).
+        THREAD_ROLE_WORKER,         ///< Workers del `JobSystem`.
+        THREAD_ROLE_BACKGROUND,     ///< Decodificación y E/S en segundo plano.
+    };
+
+    /// Qué se aplica a cada tipo de hilo.
+    struct Policy {
+        bool pinPerformance = true;         ///< Principal y render, solo en P-cores (CPU híbrida).
+        bool backgroundEfficiency = true;   ///< Segundo plano, solo en E-cores (CPU híbrida).
+        bool priorities = true;             ///< Principal y render por encima de lo normal; segundo plano, por debajo.
+    };
+
+    /// Núcleo físico detectado.
+    struct Core {
+        WORD group = 0;                     ///< Grupo de procesadores (más de 64 lógicos).
+        KAFFINITY mask = 0;                 ///< Procesadores lógicos del núcleo dentro del grupo.
+        BYTE efficiencyClass = 0;           ///< Más alto = más rendimiento.
+        unsigned int logicalCount = 0;
+        bool performance = true;            ///< De la clase más alta.
+    };
+
+    CpuTopology(const CpuTopology&) = delete;
+    CpuTopology& operator=(const CpuTopology&) = delete;
+
+    /** @brief Topología de la máquina, detectada la primera vez que se pide. */
+    static CpuTopology& getDefault();
+
+    /** @brief Procesadores lógicos (hilos de hardware). */
+    unsigned int getLogicalCount() const { return m_logicalCount; }
+
+    /** @brief Núcleos físicos. */
+    unsigned int getPhysicalCount() const { return static_cast<unsigned int>(m_cores.size()); }
+
+    /** @brief Núcleos de rendimiento (todos si no es híbrida). */
+    unsigned int getPerformanceCount() const { return m_performanceCount; }
+
+    /** @brief Núcleos de eficiencia (0 si no es híbrida). */
+    unsigned int getEfficiencyCount() const { return getPhysicalCount() - m_performanceCount; }
+
+    /** @brief `true` con núcleos de más de una clase de eficiencia. */
+    bool isHybrid() const { return m_performanceCount < m_cores.size(); }
+
+    const std::vector<Core>& getCores() const { return m_cores; }
+
+    /**
+     * @brief Workers para el `JobSystem` (además del principal).
+     * @param physical `true` = uno por núcleo físico; `false` = uno por procesador lógico.
+     */
+    unsigned int getWorkerCount(bool physical) const;
+
+    /** @brief Cambia la política; vale para los hilos que llamen a @ref applyToCurrentThread después. */
+    void setPolicy(const Policy& policy) { m_policy = policy; }
+
+    const Policy& getPolicy() const { return m_policy; }
+
+    /**
+     * @brief Aplica la afinidad y la prioridad del tipo de hilo al hilo que llama.
+     * @details Sin núcleos del tipo pedido en el grupo del hilo (o sin CPU híbrida), la
+     * afinidad no cambia; la prioridad se aplica igual.
+     */
+    void applyToCurrentThread(ThreadRole role) const;
+
+private:
+    CpuTopology();
+
+    /** @brief Rellena `m_cores`; `false` si el sistema no da la información. */
+    bool detect();
+
+    /** @brief Procesadores lógicos de los núcleos de ese tipo dentro de `group`. */
+    KAFFINITY getMask(WORD group, bool performance) const;
+
+    std::vector<Core> m_cores;
+    unsigned int m_logicalCount = 1;
+    unsigned int m_performanceCount = 0;
+    Policy m_policy;
+};
@@ -0,0 +1,84 @@
+﻿/**
+ * @file DdsFile.h
+ * @brief Lector DDS nativo (archivo mapeado en memoria) y caché de texturas comprimidas.
+ *
+ * @details
+ * **Lectura** (@ref DdsFile::load): el archivo se mapea con `MapViewOfFile` y los
+ * `D3D11_SUBRESOURCE_DATA` apuntan directamente a la vista, así que los bytes van
+ * del caché de páginas del sistema a `CreateTexture2D` sin copias intermedias.
+ * Entiende:
+ * - Cabecera clásica: `DXT1`-`DXT5`, `ATI1`/`ATI2` (BC4/BC5), los códigos numéricos
+ *   de formatos flotantes y las máscaras RGBA8, BGRA8, BGRX8, B5G6R5 y L8.
+ * - Extensión `DX10`: cualquier formato DXGI de la tabla de @ref DdsFile.cpp,
+ *   arrays de texturas y cubemaps (y arrays de cubemaps).
+ * - Cubemaps clásicos (`DDSCAPS2_CUBEMAP` con las 6 caras).
+ * Las texturas de volumen (3D) no se admiten. Sustituye a
+ * `D3DX11CreateShaderResourceViewFromFile`, que está obsoleta y copiaba el archivo.
+ *
+ * **Caché** (@ref DdsFile::write): la primera vez que se carga `piedra.jpg` con
+ * compresión se codifica a BCn (@ref BlockCompressor) y se guarda al lado como
+ * `piedra.jpg.bc1.dds`; las siguientes cargas lo leen con @ref load. Se regenera
+ * si la imagen original es más reciente o si lo escribió otra versión del codificador.
+ * También guarda los cubemaps prefiltrados de las sondas de reflexión (@ref ReflectionProbes).
+ *
+ * @note Para estudiantes: un DDS es casi un volcado de memoria de la textura; por
+ * eso cargarlo es mapear el archivo y llamar a `CreateTexture2D`.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "BlockCompressor.h"
+
+/**
+ * @class DdsFile
+ * @brief Funciones de lectura de DDS y de la caché de texturas comprimidas.
+ */
+class DdsFile {
+public:
+    /// Cambia cuando el codificador produce bloques distintos: invalida las cachés viejas.
+    static const unsigned int kEncoderVersion = 1;
+
+    /// Lo que quedó en VRAM tras @ref load (para el streaming de mips).
+    struct Info {
+        unsigned int width = 0;        ///< Ancho del mip 0 del archivo.
+        unsigned int height = 0;       ///< Alto del mip 0 del archivo.
+        unsigned int mipCount = 0;     ///< Mips del archivo.
+        unsigned int residentMip = 0;  ///< Primer mip subido (los anteriores se omitieron).
+        size_t residentBytes = 0;      ///< Bytes subidos (todos los elementos y mips).
+    };
+
+    /**
+     * @brief Crea la textura y su SRV desde un DDS mapeado en memoria.
+     * @param device Dispositivo (libre de hilos: se puede llamar desde los hilos de carga).
+     * @param path Archivo `.dds`.
+     * @param srv Recibe la vista (Texture2D, Texture2DArray, TextureCube o TextureCubeArray);
+     * mantiene viva la textura.
+     * @param engineCacheOnly Rechaza los DDS que no escribió esta versión de @ref write.
+     * @param maxSize Lado máximo del mip más detallado que se sube (0 = todos): los
+     * mayores se omiten, salvo si el que quedaría como mip 0 de un BCn no tiene lados
+     * múltiplos de 4.
+     * @param info Si no es nulo, recibe tamaño completo y residencia.
+     * @return `S_OK`, `E_FAIL` si no se puede abrir o `E_INVALIDARG` si el formato no se admite.
+     */
+    static HRESULT load(ID3D11Device* device, const std::string& path,
+        ID3D11ShaderResourceView** srv, bool engineCacheOnly = false,
+        unsigned int maxSize = 0, Info* info = nullptr);
+
+    /**
+     * @brief Ruta de la caché para una imagen y un formato.
+     * @param sourcePath Imagen original con extensión (`...\piedra.jpg`).
+     * @param compression Formato pedido (`AUTO` tiene su propio archivo).
+     */
+    static std::string getCachePath(const std::string& sourcePath, TextureCompression compression);
+
+    /** @brief `true` si la caché existe y no es más antigua que la imagen original. */
+    static bool isFresh(const std::string& cachePath, const std::string& sourcePath);
+
+    /**
+     * @brief Escribe la imagen (a un temporal que luego se renombra: dos hilos que
+     * escriban la misma caché no dejan un archivo a medias).
+     * @details Admite los formatos BCn y los sin comprimir de la tabla (para estos la
+     * cabecera lleva el `rowPitch` del mip 0), arrays (`elementCount`) y cubemaps.
+     */
+    static HRESULT write(const std::string& path, const CompressedImage& image);
+};
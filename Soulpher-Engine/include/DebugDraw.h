@@ -0,0 +1,215 @@
+﻿/**
+ * @file DebugDraw.h
+ * @brief Dibujo de depuración en modo inmediato (líneas, cajas, esferas, frustums y
+ * etiquetas) desde cualquier hilo, en un solo vertex buffer por frame.
+ *
+ * @details
+ * Para ver una AABB, un rayo de `SceneQuery` o el frustum de una sombra había que
+ * crear una malla o añadir una ventana de ImGui. Con `DebugDraw` basta una llamada
+ * estática desde cualquier punto del frame (incluidos los trabajos de @ref JobSystem):
+ * @code
+ * DebugDraw::box(boundsMin, boundsMax, DebugDraw::kGreen);
+ * DebugDraw::line(origin, hit, DebugDraw::kRed, false);   // siempre visible
+ * DebugDraw::text(position, actor->getName(), DebugDraw::kWhite);
+ * @endcode
+ *
+ * - **Grabación**: cada hilo escribe en su propio buffer (uno por hilo, registrados
+ *   como los arenas de `FrameArena`). Su mutex solo lo toca ese hilo y @ref collect, así
+ *   que en la práctica nunca se espera.
+ * - **Recogida** (@ref collect): en `BaseApp::captureFrame`, con el render parado, se
+ *   juntan los buffers de todos los hilos en las listas del frame y se vacían.
+ * - **Dibujo** (@ref render): un `Map(WRITE_DISCARD)` del vertex buffer dinámico y dos
+ *   `Draw` de líneas: las que respetan la profundidad de la escena y las que van encima.
+ *   Las etiquetas se dibujan con ImGui (@ref drawLabels), proyectadas a pantalla.
+ *
+ * Todo es de un frame: lo que no se vuelva a pedir desaparece en el siguiente.
+ *
+ * Solo existe con `PROFILE` (Debug y Profile): en Release las funciones de grabación
+ * son vacías e `inline` y ni la clase ni `DebugDraw.fx` se cargan, así que las llamadas
+ * que se queden en el código no cuestan nada en el juego publicado.
+ *
+ * @note Para estudiantes: el "modo inmediato" es una interfaz, no una forma de dibujar.
+ * Pedir líneas sueltas es cómodo; enviarlas sueltas a la GPU sería un draw por línea.
+ * Por eso se acumulan y se suben juntas una vez por frame.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "ConstantBufferLayout.h"
+#include "Buffer.h"
+#include "ConstantBuffer.h"
+#include "ShaderProgram.h"
+#include "BlendState.h"
+#include "Rasterizer.h"
+#include "DepthStencilState.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+class Device;
+class DeviceContext;
+
+/**
+ * @class DebugDraw
+ * @brief Grabación por hilo de primitivas de depuración y su dibujo por lotes.
+ */
+class DebugDraw {
+public:
+    DebugDraw() = default;
+    ~DebugDraw() { destroy(); }
+
+    /// Vértices iniciales del buffer (crece al doble).
+    static const unsigned int kInitialVertices = 16 * 1024;
+    /// Vértices como mucho por frame (lo que pase se descarta y se cuenta).
+    static const unsigned int kMaxVertices = 1024 * 1024;
+    /// Segmentos de cada círculo de @ref sphere.
+    static const unsigned int kCircleSegments = 32;
+
+    static const XMFLOAT4 kWhite;
+    static const XMFLOAT4 kRed;
+    static const XMFLOAT4 kGreen;
+    static const XMFLOAT4 kBlue;
+    static const XMFLOAT4 kYellow;
+
+#if defined(PROFILE)
+    /**
+     * @brief Segmento de `a` a `b`.
+     * @param depthTest `false` para dibujarlo encima de la escena.
+     */
+    static void line(const XMFLOAT3& a, const XMFLOAT3& b, const XMFLOAT4& color, bool depthTest = true);
+
+    /** @brief Caja alineada con los ejes. */
+    static void box(const XMFLOAT3& min, const XMFLOAT3& max, const XMFLOAT4& color, bool depthTest = true);
+
+    /** @brief Caja `[min, max]` en el espacio de `world` (p. ej. la AABB local de un actor girado). */
+    static void orientedBox(const XMMATRIX& world, const XMFLOAT3& min, const XMFLOAT3& max,
+        const XMFLOAT4& color, bool depthTest = true);
+
+    /** @brief Esfera como tres círculos, uno por plano. */
+    static void sphere(const XMFLOAT3& center, float radius, const XMFLOAT4& color, bool depthTest = true);
+
+    /** @brief Aristas del volumen que ve `viewProj` (se invierte para sacar las esquinas). */
+    static void frustum(const XMMATRIX& viewProj, const XMFLOAT4& color, bool depthTest = true);
+
+    /** @brief Texto en un punto del mundo (siempre encima; no se dibuja detrás de la cámara). */
+    static void text(const XMFLOAT3& position, const std::string& text, const XMFLOAT4& color);
+
+    /** @brief Activa o desactiva la grabación; desactivada, las llamadas vuelven enseguida. */
+    static void setEnabled(bool enabled) { s_enabled.store(enabled, std::memory_order_relaxed); }
+
+    /** @brief `true` si la grabación está activa. */
+    static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+#else
+    static void line(const XMFLOAT3&, const XMFLOAT3&, const XMFLOAT4&, bool = true) {}
+    static void box(const XMFLOAT3&, const XMFLOAT3&, const XMFLOAT4&, bool = true) {}
+    static void orientedBox(const XMMATRIX&, const XMFLOAT3&, const XMFLOAT3&, const XMFLOAT4&, bool = true) {}
+    static void sphere(const XMFLOAT3&, float, const XMFLOAT4&, bool = true) {}
+    static void frustum(const XMMATRIX&, const XMFLOAT4&, bool = true) {}
+    static void text(const XMFLOAT3&, const std::string&, const XMFLOAT4&) {}
+    static void setEnabled(bool) {}
+    static bool isEnabled() { return false; }
+#endif
+
+#if defined(PROFILE)
+    /**
+     * @brief Crea programa, buffers y estados.
+     * @return `S_OK` o el error; sin él lo grabado se descarta en cada @ref collect.
+     */
+    HRESULT init(Device& device);
+
+    /**
+     * @brief Junta lo grabado por todos los hilos en las listas del frame y vacía sus buffers.
+     * @note Solo con el render parado (`BaseApp::captureFrame`): @ref render lee las listas.
+     */
+    void collect();
+
+    /**
+     * @brief Dibuja las líneas del frame.
+     * @param deviceContext Contexto inmediato.
+     * @param rtv Target de salida.
+     * @param dsv Profundidad de la escena al mismo tamaño que `rtv`; `nullptr` dibuja
+     * también encima las líneas con profundidad.
+     * @param width,height Tamaño de `rtv`.
+     * @param viewProj Vista-proyección de la cámara del frame.
+     */
+    void render(DeviceContext& deviceContext, ID3D11RenderTargetView* rtv, ID3D11DepthStencilView* dsv,
+        unsigned int width, unsigned int height, const XMMATRIX& viewProj);
+
+    /**
+     * @brief Etiquetas del último @ref collect en la lista de primer plano de ImGui.
+     * @param viewProj Cámara con la que se dibujó ese frame.
+     * @param x,y,width,height Rectángulo de la escena en pantalla (el panel o la ventana).
+     * @note Entre `ImGui::NewFrame` y `ImGui::Render` (en el hilo principal).
+     */
+    void drawLabels(const XMMATRIX& viewProj, float x, float y, float width, float height) const;
+
+    /** @brief Libera programa, buffers y estados. */
+    void destroy();
+
+    /** @brief `true` tras un @ref init correcto. */
+    bool isReady() const { return m_device != nullptr; }
+
+    /** @brief `true` si el último @ref collect dejó algo que dibujar. */
+    bool hasLines() const { return !m_vertices[0].empty() || !m_vertices[1].empty(); }
+
+    /** @brief Líneas del último frame. */
+    unsigned int getLineCount() const {
+        return static_cast<unsigned int>((m_vertices[0].size() + m_vertices[1].size()) / 2);
+    }
+
+    /** @brief Vértices descartados por @ref kMaxVertices desde el arranque. */
+    unsigned long long getDroppedCount() const { return m_dropped; }
+
+private:
+    /// Vértice tal como lo lee `DebugDraw.fx`.
+    struct Vertex {
+        XMFLOAT3 position;
+        unsigned int color;     ///< RGBA8 (`R8G8B8A8_UNORM`).
+    };
+
+    struct Label {
+        XMFLOAT3 position;
+        unsigned int color;
+        std::string text;
+    };
+
+    /// Lo grabado por un hilo desde el último @ref collect.
+    struct ThreadBuffer {
+        std::mutex mutex;
+        std::vector<Vertex> vertices[2];    ///< [0] con profundidad, [1] encima.
+        std::vector<Label> labels;
+    };
+
+    /// Constantes de `cbDebugDraw` (b2).
+    struct CBDebugDraw {
+        XMMATRIX viewProj;
+    };
+    /// Layout de `cbDebugDraw` (ver `ConstantBufferLayouts`).
+    static const ConstantBufferLayouts::Registration kDebugDrawLayout;
+
+    /// Buffer del hilo actual (se registra en el primer uso).
+    static ThreadBuffer& local();
+    /// Buffers de todos los hilos (viven hasta el cierre; los hilos guardan un puntero).
+    static std::vector<std::unique_ptr<ThreadBuffer>>& buffers();
+    static std::mutex& buffersMutex();
+    /// Color en RGBA8.
+    static unsigned int pack(const XMFLOAT4& color);
+    /// Añade segmentos (pares de puntos) al buffer del hilo.
+    static void addLines(const XMFLOAT3* points, unsigned int count, const XMFLOAT4& color, bool depthTest);
+
+    static std::atomic<bool> s_enabled;
+
+    Device* m_device = nullptr;
+    ShaderProgram m_program;
+    Buffer m_vertexBuffer;                          ///< Dinámico, `m_vertices[0]` y luego `[1]`.
+    unsigned int m_capacity = 0;
+    TConstantBuffer<CBDebugDraw> m_constants;
+    BlendState m_blendState;
+    Rasterizer m_rasterizer;
+    DepthStencilState m_depthTest;                  ///< LESS_EQUAL sin escribir Z.
+    DepthStencilState m_noDepth;
+    std::vector<Vertex> m_vertices[2];              ///< Listas del frame.
+    std::vector<Label> m_labels;
+    unsigned long long m_dropped = 0;
+#endif
+};
@@ -0,0 +1,99 @@
+﻿/**
+ * @file DeferredShading.h
+ * @brief Camino diferido opcional (`r.deferred`): G-buffer compacto y un compute shader
+ * que ilumina por baldosas.
+ *
+ * @details
+ * El camino forward+ (`ClusteredLighting`) sombrea cada píxel al dibujarlo; con mucha
+ * sobre-escritura o muchas luces por píxel se paga varias veces. Aquí:
+ *
+ * 1. **G-buffer** (pase "Scene"): los mismos PS de `ClusteredLights.fxh` escriben dos
+ *    render targets en lugar del color (ver `ClusteredLighting::setGBufferOutput`):
+ *    - albedo (`R8G8B8A8_UNORM`): color difuso y rugosidad del material en a;
+ *    - superficie (`R10G10B10A2_UNORM`): normal en octaedro (rg), sombra de la luz
+ *      principal (b) y a = 1 para marcar que el píxel está en el G-buffer.
+ *    La profundidad es la del D24S8 de siempre: la posición se reconstruye de ella.
+ * 2. **Iluminación** (@ref light, `DeferredLighting.fx`): un grupo de
+ *    @ref kTileSize x @ref kTileSize hilos por baldosa saca el rango de profundidad de
+ *    sus píxeles, prueba las luces contra la caja de la baldosa y cada hilo suma solo
+ *    las que quedaron. El resultado va a una textura UAV que se copia al back buffer.
+ * 3. **Forward** después: impostores, actores con occlusion query y la capa
+ *    transparente se dibujan encima como siempre (forward+ por clusters).
+ *
+ * Los píxeles de shaders que no escriben el G-buffer (el programa por defecto,
+ * `Impostor.fx`, programas propios de los materiales) dejan a = 0 en la superficie y
+ * su color en el albedo: se copian sin iluminar, como en forward. Si uno de esos tapa
+ * a un píxel que sí lo escribió, la superficie del de detrás se queda; el pre-pase de
+ * profundidad (un solo sombreado por píxel) lo evita en la capa opaca.
+ *
+ * @note Para estudiantes: el G-buffer pesa 8 bytes por píxel más la profundidad. La
+ * normal en octaedro cabe en dos canales de 10 bits sin perder la dirección, y la
+ * posición no se guarda: sale de la profundidad y la inversa de la proyección.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "RenderTargetPool.h"
+
+class Device;
+class DeviceContext;
+class ClusteredLighting;
+
+/**
+ * @class DeferredShading
+ * @brief Kernel de iluminación por baldosas y formatos del G-buffer.
+ */
+class DeferredShading {
+public:
+    DeferredShading() = default;
+    ~DeferredShading() { destroy(); }
+
+    /// Píxeles por lado de una baldosa (debe coincidir con `TILE_SIZE` de `DeferredLighting.fx`).
+    static const unsigned int kTileSize = 16;
+
+    /**
+     * @brief Crea el kernel de iluminación.
+     * @return `S_OK`; `DXGI_ERROR_UNSUPPORTED` por debajo de 11_0 (solo forward).
+     */
+    HRESULT init(Device& device);
+
+    /** @brief Render target de albedo y rugosidad (RT0 del G-buffer). */
+    static RenderTargetPool::Desc albedoDesc(unsigned int width, unsigned int height);
+
+    /** @brief Render target de normal, sombra y marca (RT1 del G-buffer). */
+    static RenderTargetPool::Desc surfaceDesc(unsigned int width, unsigned int height);
+
+    /**
+     * @brief Textura UAV con el resultado.
+     * @param format El del target de la escena, donde se copia: `R8G8B8A8_UNORM` (back
+     * buffer) o el HDR de `PostProcess`.
+     */
+    static RenderTargetPool::Desc litDesc(unsigned int width, unsigned int height, DXGI_FORMAT format);
+
+    /**
+     * @brief Ilumina el G-buffer con las luces del último `ClusteredLighting::cull`.
+     * @param depthSRV Profundidad de la escena (`R24_UNORM_X8_TYPELESS`).
+     * @param albedoSRV RT0 del G-buffer.
+     * @param surfaceSRV RT1 del G-buffer.
+     * @param litUAV Destino (@ref litDesc); su formato elige la variante del kernel.
+     * @param occlusionSRV AO a media resolución (`AmbientOcclusion`); nula = sin AO.
+     * @param width Ancho del viewport en píxeles.
+     * @param height Alto.
+     * @warning Desenlaza los render targets: el depth buffer se lee como SRV.
+     */
+    void light(DeviceContext& deviceContext, const ClusteredLighting& lights,
+        ID3D11ShaderResourceView* depthSRV, ID3D11ShaderResourceView* albedoSRV,
+        ID3D11ShaderResourceView* surfaceSRV, ID3D11UnorderedAccessView* litUAV,
+        ID3D11ShaderResourceView* occlusionSRV, unsigned int width, unsigned int height);
+
+    /** @brief Libera el kernel. */
+    void destroy();
+
+    /** @brief `true` tras un @ref init correcto. */
+    bool isReady() const { return m_lightShader != nullptr && m_lightShaderFloat != nullptr; }
+
+private:
+    ID3D11ComputeShader* m_lightShader = nullptr;       ///< Destino UNORM.
+    ID3D11ComputeShader* m_lightShaderFloat = nullptr;  ///< Destino en coma flotante (`LIT_FLOAT`).
+
+};
@@ -39,8 +39,11 @@ public:
      * @note
      * - Con `enableDepth = false`, todos los píxeles se dibujan sin comparar su Z.
      * - Con `enableStencil = true`, se habilita el uso de la máscara de stencil.
+     * - `writeDepth = false` + `depthFunc = D3D11_COMPARISON_EQUAL` es el estado del
+     *   pase principal tras un pre-pase de profundidad.
      */
-    HRESULT init(Device& device, bool enableDepth = true, bool enableStencil = false);
+    HRESULT init(Device& device, bool enableDepth = true, bool enableStencil = false,
+        bool writeDepth = true, D3D11_COMPARISON_FUNC depthFunc = D3D11_COMPARISON_LESS);
 
     /**
      * @brief Actualiza parámetros internos.
@@ -16,6 +16,9 @@
 
 #pragma once
 #include "Prerequisites.h"
+#include "RenderStateCache.h"
+#include "ShaderLibrary.h"
+#include "InputLayoutCache.h"
 
  /**
   * @class Device
@@ -34,8 +37,17 @@
   */
 class Device {
 public:
-    /** @brief Constructor por defecto. */
-    Device() = default;
+    /**
+     * @brief Constructor por defecto.
+     *
+     * @note La cach de estados, la biblioteca de shaders y la cach de input
+     * layouts se comparten entre copias del `Device` (varias APIs del motor
+     * reciben el dispositivo por valor).
+     */
+    Device()
+        : m_stateCache(EU::MakeShared<RenderStateCache>()),
+          m_shaderLibrary(EU::MakeShared<ShaderLibrary>()),
+          m_inputLayouts(EU::MakeShared<InputLayoutCache>()) {}
 
     /** @brief Destructor por defecto. */
     ~Device() = default;
@@ -92,6 +104,40 @@ public:
         ID3D11ClassLinkage* pClassLinkage,
         ID3D11PixelShader** ppPixelShader);
 
+    /** @brief Crea un compute shader a partir de bytecode compilado (requiere nivel 11_0). */
+    HRESULT CreateComputeShader(const void* pShaderBytecode,
+        unsigned int BytecodeLength,
+        ID3D11ClassLinkage* pClassLinkage,
+        ID3D11ComputeShader** ppComputeShader);
+
+    /** @brief Crea un geometry shader a partir de bytecode compilado. */
+    HRESULT CreateGeometryShader(const void* pShaderBytecode,
+        unsigned int BytecodeLength,
+        ID3D11ClassLinkage* pClassLinkage,
+        ID3D11GeometryShader** ppGeometryShader);
+
+    /** @brief Crea un hull shader a partir de bytecode compilado (requiere nivel 11_0). */
+    HRESULT CreateHullShader(const void* pShaderBytecode,
+        unsigned int BytecodeLength,
+        ID3D11ClassLinkage* pClassLinkage,
+        ID3D11HullShader** ppHullShader);
+
+    /** @brief Crea un domain shader a partir de bytecode compilado (requiere nivel 11_0). */
+    HRESULT CreateDomainShader(const void* pShaderBytecode,
+        unsigned int BytecodeLength,
+        ID3D11ClassLinkage* pClassLinkage,
+        ID3D11DomainShader** ppDomainShader);
+
+    /** @brief Crea una vista de lectura para shaders (Shader Resource View, SRV). */
+    HRESULT CreateShaderResourceView(ID3D11Resource* pResource,
+        const D3D11_SHADER_RESOURCE_VIEW_DESC* pDesc,
+        ID3D11ShaderResourceView** ppSRView);
+
+    /** @brief Crea una vista de escritura aleatoria (Unordered Access View, UAV). */
+    HRESULT CreateUnorderedAccessView(ID3D11Resource* pResource,
+        const D3D11_UNORDERED_ACCESS_VIEW_DESC* pDesc,
+        ID3D11UnorderedAccessView** ppUAView);
+
     /** @brief Crea un buffer de Direct3D 11 (vertex, index o constant). */
     HRESULT CreateBuffer(const D3D11_BUFFER_DESC* pDesc,
         const D3D11_SUBRESOURCE_DATA* pInitialData,
@@ -113,6 +159,48 @@ public:
     HRESULT CreateRasterizerState(const D3D11_RASTERIZER_DESC* pRasterizerDesc,
         ID3D11RasterizerState** ppRasterizerState);
 
+    /**
+     * @brief Niveles de calidad de `SampleCount` muestras en `Format` (0: no soportado).
+     */
+    HRESULT CheckMultisampleQualityLevels(DXGI_FORMAT Format,
+        unsigned int SampleCount,
+        unsigned int* pNumQualityLevels);
+
+    // ==== Estados compartidos (cach por descriptor) ====
+
+    /**
+     * @brief Como `CreateSamplerState`, pero devuelve el objeto compartido para ese descriptor.
+     * @note El puntero devuelto tiene su propia referencia: liberarlo con `SAFE_RELEASE`.
+     */
+    HRESULT CreateSharedSamplerState(const D3D11_SAMPLER_DESC* pSamplerDesc,
+        ID3D11SamplerState** ppSamplerState);
+
+    /** @brief Blend state compartido (ver `CreateSharedSamplerState`). */
+    HRESULT CreateSharedBlendState(const D3D11_BLEND_DESC* pBlendStateDesc,
+        ID3D11BlendState** ppBlendState);
+
+    /** @brief Depth/stencil state compartido (ver `CreateSharedSamplerState`). */
+    HRESULT CreateSharedDepthStencilState(const D3D11_DEPTH_STENCIL_DESC* pDepthStencilDesc,
+        ID3D11DepthStencilState** ppDepthStencilState);
+
+    /** @brief Rasterizer state compartido (ver `CreateSharedSamplerState`). */
+    HRESULT CreateSharedRasterizerState(const D3D11_RASTERIZER_DESC* pRasterizerDesc,
+        ID3D11RasterizerState** ppRasterizerState);
+
+    /** @brief Acceso a la cach de estados (estadsticas). */
+    RenderStateCache& getStateCache() { return *m_stateCache; }
+
+    /** @brief Biblioteca de shaders compilados (una compilacin por variante). */
+    ShaderLibrary& getShaderLibrary() { return *m_shaderLibrary; }
+
+    /** @brief Input layouts compartidos por (layout, firma de entrada del VS). */
+    InputLayoutCache& getInputLayoutCache() { return *m_inputLayouts; }
+
 public:
     ID3D11Device* m_device = nullptr; ///< Puntero al dispositivo Direct3D 11.
+
+private:
+    EU::TSharedPointer<RenderStateCache> m_stateCache; ///< Estados compartidos por descriptor.
+    EU::TSharedPointer<ShaderLibrary> m_shaderLibrary; ///< Shaders compartidos por variante.
+    EU::TSharedPointer<InputLayoutCache> m_inputLayouts; ///< Input layouts compartidos.
 };
@@ -24,6 +24,30 @@
 
 #pragma once
 #include "Prerequisites.h"
+#include <source_location>
+
+struct ID3DUserDefinedAnnotation;
+
+/**
+ * @enum StateCategory
+ * @brief Tipos de cambio de estado que cuenta @ref DeviceContext (binds que llegan a D3D11).
+ */
+enum StateCategory {
+    STATE_SHADER = 0,          ///< VS/PS.
+    STATE_INPUT_LAYOUT,        ///< Input layout.
+    STATE_VERTEX_BUFFER,       ///< Vertex buffers.
+    STATE_INDEX_BUFFER,        ///< Index buffer.
+    STATE_TOPOLOGY,            ///< Topología.
+    STATE_CONSTANT_BUFFER,     ///< Constant buffers (VS+PS).
+    STATE_SHADER_RESOURCE,     ///< SRV del PS.
+    STATE_SAMPLER,             ///< Samplers del PS.
+    STATE_RASTERIZER,          ///< Rasterizer state.
+    STATE_BLEND,               ///< Blend state.
+    STATE_DEPTH_STENCIL,       ///< Depth/stencil state.
+    STATE_RENDER_TARGET,       ///< Render targets + DSV.
+    STATE_VIEWPORT,            ///< Viewports.
+    STATE_CATEGORY_COUNT
+};
 
  /**
   * @class DeviceContext
@@ -39,24 +63,147 @@
   */
 class DeviceContext {
 public:
-    /** @brief Constructor por defecto. */
-    DeviceContext() = default;
+    /** @brief Constructor por defecto (arranca con la caché de estado invalidada). */
+    DeviceContext() { invalidateStateCache(); }
 
     /** @brief Destructor por defecto. */
     ~DeviceContext() = default;
 
-    /** @brief Inicializa el contexto (placeholder). */
+    /**
+     * @struct RenderStats
+     * @brief Contadores de un frame; son sumas de enteros, baratas hasta en Release.
+     */
+    struct RenderStats {
+        unsigned int drawCalls = 0;           ///< `DrawIndexed*` emitidos.
+        unsigned long long indices = 0;       ///< Índices enviados (por instancia incluida).
+        unsigned long long primitives = 0;    ///< Primitivas según la topología enlazada.
+        unsigned int stateChanges[STATE_CATEGORY_COUNT] = {}; ///< Binds que llegaron a D3D11, por tipo.
+        unsigned int filteredCalls = 0;       ///< Binds omitidos por el filtro de redundancia.
+        unsigned int shaderResourceBinds = 0; ///< SRV enlazadas (cuenta vistas, no llamadas).
+        unsigned long long constantBufferBytes = 0; ///< Bytes subidos a constant buffers.
+        unsigned long long uploadBytes = 0;   ///< Bytes subidos en total (incluye los de constantes).
+        unsigned int commandLists = 0;        ///< Command lists de contextos diferidos ejecutadas.
+
+        /** @brief Suma de `stateChanges` de todas las categorías. */
+        unsigned int totalStateChanges() const {
+            unsigned int total = 0;
+            for (unsigned int c : stateChanges) total += c;
+            return total;
+        }
+    };
+
+    /** @brief Nombre legible de una categoría (para la UI). */
+    static const char* getStateCategoryName(StateCategory category);
+
+    /**
+     * @brief Prepara los marcadores de eventos; llamar cuando `m_deviceContext` ya existe.
+     *
+     * @details Usa `ID3DUserDefinedAnnotation` (runtime 11.1) si el contexto la expone;
+     * si no, `D3DPERF_BeginEvent/EndEvent` de d3d9.dll, que PIX y RenderDoc también leen.
+     */
     void init();
 
-    /** @brief Actualiza el estado del contexto (placeholder). */
+    /**
+     * @brief Crea un contexto **diferido** propio (graba comandos en lugar de enviarlos).
+     * @param device Dispositivo que lo crea.
+     * @return `S_OK` o el error de `CreateDeferredContext`.
+     *
+     * @note Un contexto diferido tiene su propia caché de estado y sus contadores, y lo
+     * puede usar otro hilo (uno a la vez). Sin marcadores de eventos: los pone el inmediato.
+     */
+    HRESULT initDeferred(ID3D11Device* device);
+
+    /** @brief `true` si es un contexto diferido (@ref initDeferred). */
+    bool isDeferred() const { return m_deferred; }
+
+    /**
+     * @brief Copia en este contexto (diferido) el estado de salida y de recursos compartidos
+     * del inmediato: render targets, viewports, rasterizer, blend, depth/stencil, constant
+     * buffers de VS/PS y SRV/samplers del PS.
+     * @param source Contexto inmediato (en su hilo).
+     *
+     * @note Una command list empieza con el estado por defecto: sin esto los draws grabados
+     * no tendrían cámara, sombras ni render target.
+     */
+    void inheritState(DeviceContext& source);
+
+    /**
+     * @brief Cierra la grabación de un contexto diferido.
+     * @param ppCommandList Recibe la lista (con una referencia que libera quien la ejecute).
+     * @note El contexto vuelve al estado por defecto y puede grabar otra lista.
+     */
+    HRESULT FinishCommandList(ID3D11CommandList** ppCommandList);
+
+    /**
+     * @brief Ejecuta una command list en este contexto (inmediato).
+     * @param pCommandList Lista grabada por un contexto diferido.
+     * @param restoreState `true` para conservar el estado de antes (y la caché sigue valiendo).
+     */
+    void ExecuteCommandList(ID3D11CommandList* pCommandList, bool restoreState);
+
+    /**
+     * @brief Suma a este contexto los contadores de otro (un diferido ya ejecutado) y los
+     * pone a cero en el otro.
+     */
+    void mergeStats(DeviceContext& other);
+
+    /**
+     * @brief Cierra el frame: publica los contadores del filtro e invalida la caché.
+     *
+     * @note Se llama una vez por frame, antes de empezar a enlazar estado. La caché
+     * se invalida porque código externo (p. ej. ImGui) usa `m_deviceContext` directo.
+     */
     void update();
 
     /** @brief Ejecuta el render (placeholder). */
     void render();
 
-    /** @brief Libera los recursos asociados al contexto. */
+    /** @brief Libera el contexto y la interfaz de marcadores. */
     void destroy();
 
+    // === Marcadores de eventos (PIX / RenderDoc) ===
+
+    /**
+     * @class EventScope
+     * @brief Abre un evento con nombre al construirse y lo cierra al destruirse.
+     *
+     * @code
+     * DeviceContext::EventScope event(ctx, "Shadows");
+     * @endcode
+     */
+    class EventScope {
+    public:
+        EventScope(DeviceContext& deviceContext, const char* name)
+            : m_deviceContext(deviceContext) {
+            m_deviceContext.beginEvent(name);
+        }
+        ~EventScope() { m_deviceContext.endEvent(); }
+        EventScope(const EventScope&) = delete;
+        EventScope& operator=(const EventScope&) = delete;
+
+    private:
+        DeviceContext& m_deviceContext;
+    };
+
+    /**
+     * @brief Abre un evento anidado en la captura de GPU.
+     * @param name Nombre visible en la herramienta (se copia).
+     * @note Sin herramienta conectada o con los marcadores apagados no hace nada.
+     */
+    void beginEvent(const char* name);
+
+    /** @brief Cierra el último evento abierto con @ref beginEvent. */
+    void endEvent();
+
+    /**
+     * @brief Activa o apaga los marcadores; el cambio se aplica en el próximo @ref update
+     * para no dejar eventos abiertos a mitad de frame.
+     */
+    void setEventMarkers(bool enable) { m_eventMarkersRequested = enable; }
+
+    /** @brief `true` si este frame emite marcadores (activados y hay herramienta escuchando). */
+    bool areEventMarkersActive() const { return m_eventMarkersActive; }
+
     // === Configuración del pipeline ===
 
     /** @brief Configura uno o varios viewports. */
@@ -67,9 +214,21 @@ public:
         unsigned int NumViews,
         ID3D11ShaderResourceView* const* ppShaderResourceViews);
 
-    /** @brief Define el input layout para la etapa de ensamblado de entrada (IA). */
+    /** @brief Define el input layout para la etapa de ensamblado de entrada (IA); nulo = sin vértices. */
     void IASetInputLayout(ID3D11InputLayout* pInputLayout);
 
+    /**
+     * @brief Asigna SRVs al vertex shader (sin filtro: solo los usa el camino GPU-driven).
+     */
+    void VSSetShaderResources(unsigned int StartSlot,
+        unsigned int NumViews,
+        ID3D11ShaderResourceView* const* ppShaderResourceViews);
+
+    /** @brief Configura samplers para el vertex shader (sin filtro: solo los usa `Terrain`). */
+    void VSSetSamplers(unsigned int StartSlot,
+        unsigned int NumSamplers,
+        ID3D11SamplerState* const* ppSamplers);
+
     /** @brief Asigna el vertex shader activo. */
     void VSSetShader(ID3D11VertexShader* pVertexShader,
         ID3D11ClassInstance* const* ppClassInstances,
@@ -80,13 +239,17 @@ public:
         ID3D11ClassInstance* const* ppClassInstances,
         unsigned int NumClassInstances);
 
-    /** @brief Actualiza un recurso de GPU con nuevos datos desde CPU. */
+    /**
+     * @brief Actualiza un recurso de GPU con nuevos datos desde CPU.
+     * @note Se mide con `StallDetector` (`location` es quien llama; no se pasa a mano).
+     */
     void UpdateSubresource(ID3D11Resource* pDstResource,
         unsigned int DstSubresource,
         const D3D11_BOX* pDstBox,
         const void* pSrcData,
         unsigned int SrcRowPitch,
-        unsigned int SrcDepthPitch);
+        unsigned int SrcDepthPitch,
+        const std::source_location& location = std::source_location::current());
 
     /** @brief Asigna uno o más vertex buffers. */
     void IASetVertexBuffers(unsigned int StartSlot,
@@ -108,11 +271,15 @@ public:
     /** @brief Establece el estado del rasterizador. */
     void RSSetState(ID3D11RasterizerState* pRasterizerState);
 
-    /** @brief Establece el estado de mezcla (blending). */
+    /** @brief Establece el estado de mezcla (blending). `nullptr` = estado por defecto. */
     void OMSetBlendState(ID3D11BlendState* pBlendState,
         const float BlendFactor[4],
         unsigned int SampleMask);
 
+    /** @brief Establece el estado de profundidad/stencil. `nullptr` = estado por defecto. */
+    void OMSetDepthStencilState(ID3D11DepthStencilState* pDepthStencilState,
+        unsigned int StencilRef);
+
     /** @brief Asigna render targets y depth stencil al pipeline. */
     void OMSetRenderTargets(unsigned int NumViews,
         ID3D11RenderTargetView* const* ppRenderTargetViews,
@@ -147,11 +314,287 @@ public:
 
     // === Draw calls ===
 
+    /** @brief Dibuja vértices sin index buffer. */
+    void Draw(unsigned int VertexCount, unsigned int StartVertexLocation);
+
     /** @brief Dibuja geometría usando un index buffer. */
     void DrawIndexed(unsigned int IndexCount,
         unsigned int StartIndexLocation,
         int BaseVertexLocation);
 
+    /** @brief Dibuja varias instancias de la misma geometría indexada en una sola llamada. */
+    void DrawIndexedInstanced(unsigned int IndexCountPerInstance,
+        unsigned int InstanceCount,
+        unsigned int StartIndexLocation,
+        int BaseVertexLocation,
+        unsigned int StartInstanceLocation);
+
+    /**
+     * @brief `DrawIndexedInstanced` con los argumentos leídos de un buffer de la GPU.
+     * @param pBufferForArgs Buffer con `D3D11_RESOURCE_MISC_DRAWINDIRECT_ARGS`.
+     * @param AlignedByteOffsetForArgs Desplazamiento de los 5 `UINT` del draw.
+     *
+     * @note Cuenta como un draw; índices y primitivas no se conocen en CPU.
+     */
+    void DrawIndexedInstancedIndirect(ID3D11Buffer* pBufferForArgs,
+        unsigned int AlignedByteOffsetForArgs);
+
+    /**
+     * @brief `DrawInstanced` con los argumentos leídos de un buffer de la GPU.
+     * @param pBufferForArgs Buffer con `D3D11_RESOURCE_MISC_DRAWINDIRECT_ARGS`.
+     * @param AlignedByteOffsetForArgs Desplazamiento de los 4 `UINT` del draw.
+     *
+     * @note Cuenta como un draw, como @ref DrawIndexedInstancedIndirect.
+     */
+    void DrawInstancedIndirect(ID3D11Buffer* pBufferForArgs,
+        unsigned int AlignedByteOffsetForArgs);
+
+    // === Acceso a recursos ===
+
+    /**
+     * @brief Mapea un recurso para acceso de CPU.
+     * @note Sin `DO_NOT_WAIT` se mide con `StallDetector` (`location` es quien llama).
+     */
+    HRESULT Map(ID3D11Resource* pResource,
+        unsigned int Subresource,
+        D3D11_MAP MapType,
+        unsigned int MapFlags,
+        D3D11_MAPPED_SUBRESOURCE* pMappedResource,
+        const std::source_location& location = std::source_location::current());
+
+    /** @brief Libera el mapeo de un recurso. */
+    void Unmap(ID3D11Resource* pResource, unsigned int Subresource);
+
+    /**
+     * @brief Espera (cediendo el hilo) a que la query tenga su dato y lo copia en `data`.
+     * @param query Query ya cerrada con `End`.
+     * @param data Destino (puede ser `nullptr` para un evento).
+     * @param size Bytes de `data`.
+     * @return `S_OK` o el error de `GetData`.
+     * @note Es una espera a la GPU a propósito: se mide con `StallDetector` (`GetData`).
+     */
+    HRESULT waitForQuery(ID3D11Asynchronous* query, void* data, unsigned int size,
+        const std::source_location& location = std::source_location::current());
+
+    /** @brief Copia una región de un subrecurso a otro (p. ej. GPU -> staging). */
+    void CopySubresourceRegion(ID3D11Resource* pDstResource,
+        unsigned int DstSubresource,
+        unsigned int DstX,
+        unsigned int DstY,
+        unsigned int DstZ,
+        ID3D11Resource* pSrcResource,
+        unsigned int SrcSubresource,
+        const D3D11_BOX* pSrcBox);
+
+    /** @brief Resuelve un subrecurso multimuestra en uno de una muestra (promedio). */
+    void ResolveSubresource(ID3D11Resource* pDstResource,
+        unsigned int DstSubresource,
+        ID3D11Resource* pSrcResource,
+        unsigned int SrcSubresource,
+        DXGI_FORMAT Format);
+
+    // === Compute ===
+    // Sin filtro de redundancia: los pases de cómputo son pocos y siempre
+    // terminan desenlazando sus vistas.
+
+    /** @brief Establece el compute shader (nullptr lo desactiva). */
+    void CSSetShader(ID3D11ComputeShader* pComputeShader,
+        ID3D11ClassInstance* const* ppClassInstances,
+        unsigned int NumClassInstances);
+
+    /** @brief Asigna SRVs al compute shader. */
+    void CSSetShaderResources(unsigned int StartSlot,
+        unsigned int NumViews,
+        ID3D11ShaderResourceView* const* ppShaderResourceViews);
+
+    /** @brief Asigna UAVs al compute shader. */
+    void CSSetUnorderedAccessViews(unsigned int StartSlot,
+        unsigned int NumUAVs,
+        ID3D11UnorderedAccessView* const* ppUnorderedAccessViews,
+        const unsigned int* pUAVInitialCounts);
+
+    /** @brief Asigna constant buffers al compute shader. */
+    void CSSetConstantBuffers(unsigned int StartSlot,
+        unsigned int NumBuffers,
+        ID3D11Buffer* const* ppConstantBuffers);
+
+    /** @brief Asigna samplers al compute shader. */
+    void CSSetSamplers(unsigned int StartSlot,
+        unsigned int NumSamplers,
+        ID3D11SamplerState* const* ppSamplers);
+
+    /** @brief Lanza grupos de hilos del compute shader enlazado. */
+    void Dispatch(unsigned int ThreadGroupCountX,
+        unsigned int ThreadGroupCountY,
+        unsigned int ThreadGroupCountZ);
+
+    /** @brief `Dispatch` con los 3 `UINT` de grupos leídos de un buffer de la GPU. */
+    void DispatchIndirect(ID3D11Buffer* pBufferForArgs,
+        unsigned int AlignedByteOffsetForArgs);
+
+    /**
+     * @brief Copia el contador oculto de una UAV append/consume a un buffer (p. ej. a
+     * unos argumentos indirectos o a un constant buffer), sin pasar por la CPU.
+     */
+    void CopyStructureCount(ID3D11Buffer* pDstBuffer,
+        unsigned int DstAlignedByteOffset,
+        ID3D11UnorderedAccessView* pSrcView);
+
+    // === Teselado ===
+    // Sin filtro, como el cómputo: solo los usa el terreno teselado, que desenlaza
+    // hull y domain al terminar (el resto del motor no los espera enlazados).
+
+    /** @brief Establece el hull shader (nullptr desactiva el teselado). */
+    void HSSetShader(ID3D11HullShader* pHullShader,
+        ID3D11ClassInstance* const* ppClassInstances,
+        unsigned int NumClassInstances);
+
+    /** @brief Asigna constant buffers al hull shader. */
+    void HSSetConstantBuffers(unsigned int StartSlot,
+        unsigned int NumBuffers,
+        ID3D11Buffer* const* ppConstantBuffers);
+
+    /** @brief Establece el domain shader (nullptr lo desactiva). */
+    void DSSetShader(ID3D11DomainShader* pDomainShader,
+        ID3D11ClassInstance* const* ppClassInstances,
+        unsigned int NumClassInstances);
+
+    /** @brief Asigna SRVs al domain shader. */
+    void DSSetShaderResources(unsigned int StartSlot,
+        unsigned int NumViews,
+        ID3D11ShaderResourceView* const* ppShaderResourceViews);
+
+    /** @brief Asigna constant buffers al domain shader. */
+    void DSSetConstantBuffers(unsigned int StartSlot,
+        unsigned int NumBuffers,
+        ID3D11Buffer* const* ppConstantBuffers);
+
+    /** @brief Asigna samplers al domain shader. */
+    void DSSetSamplers(unsigned int StartSlot,
+        unsigned int NumSamplers,
+        ID3D11SamplerState* const* ppSamplers);
+
+    // === Filtro de estado redundante ===
+
+    /** @brief Restablece todo el pipeline al estado por defecto (e invalida la caché). */
+    void ClearState();
+
+    /**
+     * @brief Activa o desactiva el filtro de binds redundantes.
+     * @param enable `true` para omitir binds idénticos al estado ya enlazado.
+     */
+    void setStateFiltering(bool enable) { m_filterState = enable; invalidateStateCache(); }
+
+    /** @brief Consulta si el filtro de binds redundantes está activo. */
+    bool isStateFilteringEnabled() const { return m_filterState; }
+
+    /**
+     * @brief Olvida el estado conocido; el siguiente bind de cada tipo siempre llega a D3D11.
+     *
+     * @warning Llamar siempre que alguien use `m_deviceContext` directamente para enlazar estado.
+     */
+    void invalidateStateCache();
+
+    /** @brief Contadores del frame en curso. */
+    const RenderStats& getStats() const { return m_stats; }
+
+    /** @brief Contadores del último frame completo (los publica @ref update). */
+    const RenderStats& getLastFrameStats() const { return m_lastFrameStats; }
+
+    /** @brief Llamadas omitidas por el filtro en el frame en curso. */
+    unsigned int getFilteredCallCount() const { return m_stats.filteredCalls; }
+
+    /** @brief Llamadas omitidas por el filtro en el último frame completo. */
+    unsigned int getLastFrameFilteredCallCount() const { return m_lastFrameStats.filteredCalls; }
+
+    /** @brief Draw calls (`DrawIndexed*`) del frame en curso. */
+    unsigned int getDrawCallCount() const { return m_stats.drawCalls; }
+
+    /** @brief Draw calls del último frame completo. */
+    unsigned int getLastFrameDrawCallCount() const { return m_lastFrameStats.drawCalls; }
+
+    /** @brief Bytes subidos a GPU (`UpdateSubresource` + `addUploadBytes`) en el frame en curso. */
+    unsigned long long getUploadBytes() const { return m_stats.uploadBytes; }
+
+    /** @brief Bytes subidos en el último frame completo. */
+    unsigned long long getLastFrameUploadBytes() const { return m_lastFrameStats.uploadBytes; }
+
+    /**
+     * @brief Suma bytes escritos por CPU en un recurso mapeado (el contexto no los ve).
+     * @param bytes Bytes copiados tras `Map(WRITE_DISCARD)`.
+     * @param constantBuffer `true` si el recurso es un constant buffer.
+     */
+    void addUploadBytes(unsigned long long bytes, bool constantBuffer = false) {
+        m_stats.uploadBytes += bytes;
+        if (constantBuffer) {
+            m_stats.constantBufferBytes += bytes;
+        }
+    }
+
 public:
     ID3D11DeviceContext* m_deviceContext = nullptr; ///< Puntero al contexto de dispositivo Direct3D 11.
+
+private:
+    static const unsigned int kCachedVertexBufferSlots = 8;  ///< Slots IA con caché.
+    static const unsigned int kCachedResourceSlots = 16;     ///< Slots SRV/sampler con caché.
+    static const unsigned int kCachedConstantBufferSlots = D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT;
+
+    /**
+     * @brief Copia del estado enlazado, por etapa y por slot.
+     *
+     * @note Al invalidar se rellena con 0xFF: ningún puntero real (ni nullptr)
+     * coincide con ese patrón y los floats quedan como NaN, así que nada se filtra.
+     */
+    struct BoundState {
+        ID3D11InputLayout* inputLayout;
+        ID3D11VertexShader* vertexShader;
+        ID3D11PixelShader* pixelShader;
+        ID3D11Buffer* vertexBuffers[kCachedVertexBufferSlots];
+        unsigned int vertexStrides[kCachedVertexBufferSlots];
+        unsigned int vertexOffsets[kCachedVertexBufferSlots];
+        ID3D11Buffer* indexBuffer;
+        DXGI_FORMAT indexFormat;
+        unsigned int indexOffset;
+        D3D11_PRIMITIVE_TOPOLOGY topology;
+        ID3D11ShaderResourceView* psResources[kCachedResourceSlots];
+        ID3D11SamplerState* psSamplers[kCachedResourceSlots];
+        ID3D11Buffer* vsConstantBuffers[kCachedConstantBufferSlots];
+        ID3D11Buffer* psConstantBuffers[kCachedConstantBufferSlots];
+        ID3D11RasterizerState* rasterizerState;
+        ID3D11BlendState* blendState;
+        float blendFactor[4];
+        unsigned int sampleMask;
+        ID3D11DepthStencilState* depthStencilState;
+        unsigned int stencilRef;
+    };
+
+    /**
+     * @brief Compara y actualiza un rango de slots de la caché.
+     * @return `true` si todo el rango ya estaba enlazado (el bind se puede omitir).
+     */
+    template<typename T>
+    bool filterSlots(T* cache, unsigned int cacheSize, unsigned int startSlot,
+        unsigned int count, T const* values);
+
+    /// Suma índices y primitivas de un draw según `m_topology`.
+    void countDraw(unsigned int indexCount, unsigned int instanceCount);
+
+    BoundState m_bound;                       ///< Estado conocido del pipeline.
+    bool m_filterState = true;                ///< Filtro de binds redundantes activo.
+    bool m_deferred = false;                  ///< Contexto diferido (ver `initDeferred`).
+    RenderStats m_stats;                      ///< Contadores del frame actual.
+    RenderStats m_lastFrameStats;             ///< Contadores del frame anterior.
+    D3D11_PRIMITIVE_TOPOLOGY m_topology = D3D11_PRIMITIVE_TOPOLOGY_UNDEFINED; ///< Topología real (no se invalida).
+
+    ID3DUserDefinedAnnotation* m_annotation = nullptr; ///< Marcadores del runtime 11.1 (si existe).
+    HMODULE m_d3d9 = nullptr;                 ///< d3d9.dll, para `D3DPERF_*` sin 11.1.
+    typedef int (WINAPI* PerfBeginEventFn)(DWORD color, LPCWSTR name);
+    typedef int (WINAPI* PerfEndEventFn)();
+    typedef DWORD (WINAPI* PerfGetStatusFn)();
+    PerfBeginEventFn m_perfBeginEvent = nullptr; ///< `D3DPERF_BeginEvent`.
+    PerfEndEventFn m_perfEndEvent = nullptr;  ///< `D3DPERF_EndEvent`.
+    PerfGetStatusFn m_perfGetStatus = nullptr;///< `D3DPERF_GetStatus`.
+    bool m_eventMarkersRequested = true;      ///< Valor pedido con `setEventMarkers`.
+    bool m_eventMarkersActive = false;        ///< Marcadores emitidos en este frame.
+    unsigned int m_openEvents = 0;            ///< Eventos abiertos (para no cerrar de más).
 };
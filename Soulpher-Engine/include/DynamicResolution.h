@@ -0,0 +1,108 @@
+﻿/**
+ * @file DynamicResolution.h
+ * @brief Resolución dinámica de la escena 3D según el tiempo de GPU del frame.
+ *
+ * @details
+ * Con `r.dynamicResolution` la escena (profundidad, G-buffer, SSAO, bloom...) se dibuja
+ * a una fracción del tamaño de la ventana, entre @ref Settings::minScale y
+ * @ref Settings::maxScale, y se sube al back buffer antes de la UI, que sigue a
+ * resolución completa:
+ *
+ * - **Control** (@ref update): con cada frame nuevo que lee `GpuProfiler` se compara su
+ *   tiempo con el presupuesto. El coste de la escena va con el número de píxeles, es
+ *   decir, con la escala al cuadrado: la escala que cabría es `escala * sqrt(presupuesto
+ *   / tiempo)`. Se baja deprisa (un frame largo es un salto visible) y se sube despacio
+ *   (sin oscilar); la escala aplicada va por pasos de @ref kScaleStep para que el pool
+ *   de render targets no cree texturas de un tamaño nuevo cada frame.
+ * - **Subida** (@ref upscale, `Upscale.fx`): Catmull-Rom con 9 lecturas bilineales. Con
+ *   HDR no hace falta: el pase final de `PostProcess` lee la escena con el mismo filtro.
+ *   Con `r.taa` la subida la hace `TemporalAA`, que acumula las muestras con jitter de
+ *   varios frames a tamaño de ventana; aquí solo queda la copia al back buffer.
+ *
+ * @note Para estudiantes: el tiempo de GPU llega con unos frames de retraso (queries);
+ * por eso el control amortigua en lugar de saltar directamente a la escala calculada.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "RenderTargetPool.h"
+
+class Device;
+class DeviceContext;
+class GpuProfiler;
+
+/**
+ * @class DynamicResolution
+ * @brief Escala de la escena (control por tiempo de GPU) y pase de subida.
+ */
+class DynamicResolution {
+public:
+    DynamicResolution() = default;
+    ~DynamicResolution() { destroy(); }
+
+    /// Paso de la escala aplicada (la interna es continua).
+    static constexpr float kScaleStep = 0.05f;
+
+    /// Parámetros del control (cvars `r.dynamicResolution*`).
+    struct Settings {
+        float frameBudget = 14.5f;  ///< ms de GPU objetivo (60 FPS = 16.7 ms, con margen).
+        float minScale = 0.5f;      ///< Fracción mínima de la ventana por eje.
+        float maxScale = 1.0f;
+        float downRate = 0.5f;      ///< Fracción del camino hacia la escala que cabe, al bajar.
+        float upRate = 0.05f;       ///< Igual, al subir.
+    };
+
+    /**
+     * @brief Crea los shaders y el sampler del pase de subida.
+     * @return `S_OK` o el error; sin él la escena se queda a resolución completa.
+     */
+    HRESULT init(Device& device);
+
+    /** @brief Target de la escena sin HDR a resolución reducida (RGBA8, RT + SRV). */
+    static RenderTargetPool::Desc sceneDesc(unsigned int width, unsigned int height);
+
+    void setSettings(const Settings& settings) { m_settings = settings; }
+    const Settings& getSettings() const { return m_settings; }
+
+    /**
+     * @brief Ajusta la escala con el último frame leído por el perfilador (si hay uno nuevo).
+     * @note Sin timestamps (`GpuProfiler::isEnabled` falso) no cambia.
+     */
+    void update(const GpuProfiler& profiler);
+
+    /** @brief Vuelve a resolución completa (control apagado). */
+    void reset();
+
+    /** @brief Escala aplicada este frame, múltiplo de @ref kScaleStep. */
+    float getScale() const { return m_appliedScale; }
+
+    /**
+     * @brief Tamaño de la escena para una ventana de `width` x `height`.
+     * @note Par (la SSAO y el bloom van a la mitad) y al menos 2x2.
+     */
+    void getRenderSize(unsigned int width, unsigned int height,
+        unsigned int& outWidth, unsigned int& outHeight) const;
+
+    /**
+     * @brief Sube `sourceSRV` a `target` (tamaño `width` x `height`).
+     * @note Deja enlazado `target` como único render target, sin profundidad.
+     */
+    void upscale(DeviceContext& deviceContext, ID3D11ShaderResourceView* sourceSRV,
+        ID3D11RenderTargetView* target, unsigned int width, unsigned int height);
+
+    /** @brief Libera shaders y sampler. */
+    void destroy();
+
+    /** @brief `true` tras un @ref init correcto. */
+    bool isReady() const { return m_pixelShader != nullptr; }
+
+private:
+    Settings m_settings;
+    float m_scale = 1.0f;               ///< Escala continua del control.
+    float m_appliedScale = 1.0f;        ///< `m_scale` redondeada a @ref kScaleStep.
+    unsigned long long m_resultSerial = 0; ///< Último frame del perfilador ya usado.
+
+    ID3D11VertexShader* m_vertexShader = nullptr;
+    ID3D11PixelShader* m_pixelShader = nullptr;
+    ID3D11SamplerState* m_sampler = nullptr;
+};
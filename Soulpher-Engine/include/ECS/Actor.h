@@ -1,5 +1,6 @@
 #pragma once
 #include "Prerequisites.h"
+#include "Name.h"
 #include "Entity.h"
 #include "Buffer.h"
 #include "Texture.h"
@@ -7,11 +8,14 @@
 #include "SamplerState.h"
 #include "Rasterizer.h"
 #include "BlendState.h"
-#include "ShaderProgram.h"
-#include "DepthStencilState.h"
+#include "MeshAsset.h"
+#include "Material.h"
 
 class Device;
 class MeshComponent;
+class RenderQueue;
+class Frustum;
+class Prefab;
 
 /**
  * @file Actor.h
@@ -24,7 +28,7 @@ class MeshComponent;
  * - Mallas y texturas asociadas.
  * - Buffers de vrtices e ndices para el renderizado.
  * - Estados de renderizado y sombreado.
- * - Soporte para sombras (proyeccin y recepcin).
+ * - Banderas de sombra: proyectarla (lista de casters) y recibirla (programa receptor).
  *
  * @note Para estudiantes:
  * - Este patrn ECS separa los datos (componentes) de la lgica (sistemas).
@@ -44,14 +48,24 @@ public:
      */
     Actor(Device& device);
 
-    /** @brief Destructor virtual por defecto. */
-    virtual ~Actor() = default;
+    /**
+     * @brief Constructor de instancia: comparte malla, texturas y estados del prefab.
+     * @param prefab Prefab inicializado (debe vivir ms que el actor).
+     *
+     * @note No llama a D3D: solo crea el `Transform` y copia los valores iniciales.
+     * Normalmente se usa a travs de `Prefab::instantiate`.
+     */
+    explicit Actor(Prefab& prefab);
+
+    /** @brief Destructor virtual (descuenta la instancia de su prefab). */
+    virtual ~Actor();
 
     /**
      * @brief Activa o desactiva la recepcin de sombras.
      * @param v `true` para recibir sombras, `false` para ignorarlas.
      *
-     * @note Desactivar la recepcin puede optimizar el render en objetos lejanos o poco relevantes.
+     * @note Los receptores se dibujan con el programa que lee el shadow map;
+     * desactivarla ahorra ese muestreo en objetos lejanos o poco relevantes.
      */
     void setReceiveShadow(bool v) { m_receiveShadow = v; }
 
@@ -65,13 +79,52 @@ public:
     void init() override {}
 
     /**
-     * @brief Actualiza la lgica del actor.
+     * @brief Actualiza la lgica del actor (equivale a @ref simulate).
      * @param deltaTime Tiempo en segundos desde la ltima actualizacin.
-     * @param deviceContext Contexto de dispositivo usado para operaciones grficas.
+     * @param deviceContext Contexto de dispositivo (no se usa: la subida es @ref publish).
      *
      * @note En un motor real, aqu se podran actualizar animaciones, IA o fsicas.
      */
-    void update(float deltaTime, DeviceContext& deviceContext) override;
+    void update(float deltaTime, DeviceContext& deviceContext) override { simulate(deltaTime); }
+
+    /**
+     * @brief Fase de simulacin: componentes y constantes del modelo, solo en CPU.
+     * @param deltaTime Tiempo en segundos desde la ltima actualizacin.
+     *
+     * @note Solo lee su `Transform` y escribe su propio estado: `BaseApp` la llama en
+     * paralelo (lotes de actores en el `JobSystem`). No debe tocar la GPU ni cambiar la
+     * estructura del mundo.
+     */
+    void simulate(float deltaTime);
+
+    /**
+     * @brief Fase de publicacin: sube la copia del render a su buffer si cambi (hilo del contexto).
+     * @param deviceContext Contexto inmediato.
+     */
+    void publish(DeviceContext& deviceContext);
+
+    /**
+     * @brief Copia lo que lee el render (constantes y mundo) si cambi desde la ltima copia.
+     *
+     * @details El render (`submit`, `getWorldBounds`, `publish`...) solo lee esta copia,
+     * as la simulacin del frame siguiente puede escribir `m_model` y el `Transform`
+     * mientras otro hilo dibuja el anterior (ver `RenderThread`).
+     *
+     * @note Con el render parado: `BaseApp` la llama entre los dos hilos, en paralelo
+     * para actores distintos.
+     */
+    void capture();
+
+    /**
+     * @brief Prepara la matriz de mundo del render entre los dos ltimos pasos simulados.
+     * @param alpha Fraccin del paso siguiente ya transcurrida (`FrameClock::getAlpha`).
+     *
+     * @details Descompone ambas matrices y mezcla escala y posicin linealmente y la
+     * rotacin con slerp; sin movimiento entre pasos, copia la matriz actual.
+     *
+     * @note Como @ref simulate, solo CPU: se puede llamar en paralelo para actores distintos.
+     */
+    void interpolate(float alpha);
 
     /**
      * @brief Renderiza el actor en la escena.
@@ -83,6 +136,140 @@ public:
      */
     void render(DeviceContext& deviceContext) override;
 
+    /**
+     * @brief Enva un draw packet por malla a la cola de render.
+     * @param queue Cola del frame actual (ya inicializada con la vista).
+     *
+     * @note A diferencia de `render`, aqu no se toca la GPU: la cola decide
+     * el orden y evita enlazar estado repetido entre actores.
+     *
+     * Si la cola tiene culling por clusters (`RenderQueue::setClusterCulling`), de
+     * cada malla con meshlets se envan solo los rangos visibles (frustum + cono de
+     * normales), como mucho @ref kMaxClusterDraws paquetes por malla.
+     */
+    void submit(RenderQueue& queue);
+
+    /// Paquetes mximos por malla con culling por clusters (se fusionan los rangos ms cercanos).
+    static const unsigned int kMaxClusterDraws = 8;
+
+    /**
+     * @brief AABB del actor en espacio mundo (AABB del asset transformada).
+     * @param outMin Esquina mnima.
+     * @param outMax Esquina mxima.
+     * @return `false` si el actor no tiene geometra con volumen envolvente.
+     */
+    bool getWorldBounds(XMFLOAT3& outMin, XMFLOAT3& outMax);
+
+    /**
+     * @brief Como @ref getWorldBounds, con la matriz actual del `Transform` (la de la
+     * simulacin) en lugar de la del ltimo @ref capture.
+     * @note Para la fsica, que corre en @ref simulate; el render usa @ref getWorldBounds.
+     */
+    bool getSimulationBounds(XMFLOAT3& outMin, XMFLOAT3& outMax);
+
+    /**
+     * @brief Cambia cada vez que @ref capture copia un mundo o un modelo nuevo.
+     * @details Si no cambia, `getWorldBounds` devuelve lo mismo que la ltima vez: quien
+     * guarde la caja (la BVH de la escena) solo la recalcula para los actores que se movieron.
+     */
+    unsigned int getRenderVersion() const { return m_renderVersion; }
+
+    /**
+     * @brief Prueba el actor contra la pirmide de visin.
+     * @param frustum Planos de la cmara del frame.
+     * @return `true` si puede verse (o si no tiene volumen envolvente).
+     */
+    bool isVisible(const Frustum& frustum);
+
+    /**
+     * @brief Elige el nivel de detalle segn el tamao proyectado en pantalla.
+     * @param view Matriz de vista de la cmara.
+     * @param projScaleY Trmino [1][1] de la proyeccin (cot(fovY/2)).
+     *
+     * @note El nivel elegido se conserva entre frames para aplicar la histresis
+     * de `MeshAsset::selectLOD`.
+     */
+    void updateLOD(const XMMATRIX& view, float projScaleY);
+
+    /** @brief Nivel de detalle usado en el frame actual (0 = mximo detalle). */
+    unsigned int getLODLevel() const { return m_lodLevel; }
+
+    /**
+     * @brief Dimetro proyectado / alto de pantalla calculado en `updateLOD`
+     * (1 si no tiene volumen envolvente o la cmara est dentro).
+     */
+    float getScreenSize() const { return m_screenSize; }
+
+    /** @brief Texturas del actor (para pedir su resolucin al streaming). */
+    const std::vector<TextureHandle>& getTextures() const { return m_textures; }
+
+    /**
+     * @brief Marca el actor como transparente (capa atrs -> adelante).
+     * @param v `true` para dibujarlo en la capa transparente.
+     */
+    void setTransparent(bool v) { m_transparent = v; }
+
+    /** @brief Consulta si el actor se dibuja en la capa transparente. */
+    bool isTransparent() const { return m_transparent; }
+
+    /**
+     * @brief Marca el actor como esttico (su transformacin no cambia en juego).
+     * @param v `true` para tratarlo como esttico.
+     *
+     * @note Las cascadas de sombra lejanas que solo contienen casters estticos no se
+     * redibujan mientras la luz y esos casters sigan quietos (ver `ShadowMap`).
+     */
+    void setStatic(bool v) { m_static = v; }
+
+    /** @brief Consulta si el actor es esttico. */
+    bool isStatic() const { return m_static; }
+
+    /**
+     * @brief Marca el actor como fusionado en un lote (lo gestiona `StaticBatcher`).
+     * @param v `true` para que `submit` y `render` no lo dibujen (lo dibuja el lote).
+     */
+    void setBatched(bool v) { m_batched = v; }
+
+    /** @brief Consulta si la geometra del actor la dibuja un lote esttico. */
+    bool isBatched() const { return m_batched; }
+
+    /**
+     * @brief Dibuja el actor bajo predicacin con una occlusion query de su AABB.
+     * @param v `true` para probar primero la caja (ver `OcclusionPredicates`).
+     *
+     * @note Pensado para actores caros (muchos tringulos o material pesado): la caja
+     * cuesta un draw ms, as que en objetos baratos no compensa.
+     */
+    void setOcclusionQuery(bool v) { m_occlusionQuery = v; }
+
+    /**
+     * @brief Asigna la luz horneada del actor (la da `LightmapBaker`).
+     * @param device Dispositivo para crear el buffer `CBLightmap` (inmutable).
+     * @param lightmap Pgina del atlas (no la retiene: es del baker).
+     * @param scaleOffset Rectngulo del actor en la pgina (ver `CBLightmap`).
+     * @note Solo se usa en el LOD 0, sin material propio y en la capa opaca: los dems
+     * casos siguen con la iluminacin en tiempo real.
+     */
+    HRESULT setLightmap(Device& device, ID3D11ShaderResourceView* lightmap, const XMFLOAT4& scaleOffset);
+
+    /** @brief Vuelve a la iluminacin en tiempo real. */
+    void clearLightmap();
+
+    /** @brief `true` si tiene lightmap asignado. */
+    bool hasLightmap() const { return m_lightmap != nullptr; }
+
+    /** @brief Consulta si el actor se dibuja bajo predicacin de oclusin. */
+    bool usesOcclusionQuery() const { return m_occlusionQuery; }
+
+    /**
+     * @brief Distancia a la cmara a partir de la cual se dibuja como impostor.
+     * @param distance Unidades de mundo; 0 = nunca (ver `ImpostorRenderer`).
+     */
+    void setImpostorDistance(float distance) { m_impostorDistance = distance > 0.0f ? distance : 0.0f; }
+
+    /** @brief Distancia de cambio a impostor (0 = desactivado). */
+    float getImpostorDistance() const { return m_impostorDistance; }
+
     /**
      * @brief Libera los recursos asociados al actor.
      *
@@ -94,24 +281,96 @@ public:
      * @brief Asigna las mallas al actor.
      * @param device Dispositivo de render para inicializar los buffers.
      * @param meshes Vector de componentes de malla.
+     *
+     * @note Crea buffers solo para este actor. Para geometra que usan varios
+     * actores, pedir el asset a `MeshLibrary` y pasarlo a `setMeshAsset`.
+     */
+    void setMesh(Device& device, const std::vector<MeshComponent>& meshes);
+
+    /**
+     * @brief Comparte una geometra ya creada (sin crear buffers nuevos).
+     * @param asset Geometra compartida, p. ej. la de otro actor.
+     *
+     * @note Los actores que comparten asset se dibujan con una sola llamada instanciada.
      */
-    void setMesh(Device& device, std::vector<MeshComponent> meshes);
+    void setMeshAsset(const EU::TSharedPointer<MeshAsset>& asset) { m_meshAsset = asset; m_modelStale = true; }
+
+    /** @brief Prefab del que se instanci (`nullptr` si tiene recursos propios). */
+    Prefab* getPrefab() const { return m_prefab; }
 
-    /** @brief Obtiene el nombre del actor. */
-    std::string getName() { return m_name; }
+    /** @brief Geometra que usa el actor (puede ser compartida). */
+    const EU::TSharedPointer<MeshAsset>& getMeshAsset() const { return m_meshAsset; }
 
-    /** @brief Asigna un nombre al actor. */
-    void setName(const std::string& name) { m_name = name; }
+    /** @brief Obtiene el nombre del actor (texto, para la UI y los logs). */
+    const std::string& getName() const { return m_name.str(); }
+
+    /** @brief Nombre internado: se compara y se usa como clave sin tocar el texto. */
+    Name getNameId() const { return m_name; }
+
+    /** @brief Asigna un nombre al actor (y lo mueve en el ndice de `ActorPool::findByName`). */
+    void setName(Name name);
 
     /**
      * @brief Asigna las texturas del actor.
-     * @param textures Vector de texturas a usar en el renderizado.
+     * @param textures Vector de texturas a usar en el renderizado (el actor pasa a ser su dueo).
+     * @note Sustituye a los materiales: las submallas vuelven a los estados del actor.
+     */
+    void setTextures(std::vector<Texture> textures) {
+        m_materials.clear();
+        m_textures.clear();
+        for (const Texture& texture : textures) {
+            m_textures.push_back(EU::MakeShared<Texture>(texture));
+        }
+    }
+
+    /**
+     * @brief Asigna texturas compartidas con otros actores (o pendientes de carga).
+     * @param textures Handles; la textura se libera con el ltimo actor que la usa.
+     */
+    void setTextures(const std::vector<TextureHandle>& textures) { m_materials.clear(); m_textures = textures; }
+
+    /**
+     * @brief Asigna un material por submalla (ver `MaterialLibrary`).
+     * @param materials Uno por submalla; uno nulo (o que falte) deja esa submalla con
+     * la textura y los estados del actor.
+     *
+     * @note `getTextures` pasa a devolver las texturas de los materiales, as el streaming,
+     * los lotes estticos y los impostores las siguen viendo.
      */
-    void setTextures(std::vector<Texture> textures) { m_textures = textures; }
+    void setMaterials(const std::vector<MaterialHandle>& materials);
+
+    /** @brief Materiales por submalla (vaco si el actor usa texturas sueltas). */
+    const std::vector<MaterialHandle>& getMaterials() const { return m_materials; }
+
+    /** @brief Material de una submalla (`nullptr` si no tiene). */
+    const Material* getMaterial(unsigned int submesh) const {
+        return submesh < m_materials.size() ? m_materials[submesh].get() : nullptr;
+    }
+
+    /**
+     * @brief Asigna el color con el que se tie la textura (`vMeshColor`).
+     * @param color Color RGBA; blanco por defecto (textura sin modificar).
+     */
+    void setColor(const XMFLOAT4& color) {
+        m_color = color;
+        m_model.vMeshColor = color;
+        m_modelDirty = true;
+    }
+
+    /** @brief Color con el que se tie la textura. */
+    const XMFLOAT4& getColor() const { return m_color; }
+
+    /** @brief Mundo (ya transpuesto e interpolado) y color tal como se envan a la GPU (copia del ltimo @ref capture). */
+    const CBChangesEveryFrame& getObjectData() const { return m_renderModel; }
+
+    /** @brief Matriz de mundo del `Transform` en el ltimo @ref capture (la que usa el render). */
+    const XMMATRIX& getRenderWorld() const { return m_renderWorld; }
 
     /**
      * @brief Define si el actor proyecta sombras.
      * @param v `true` para proyectar sombras, `false` para no hacerlo.
+     *
+     * @note Los casters se envan a la cola del shadow map (ver `ShadowMap`).
      */
     void setCastShadow(bool v) { castShadow = v; }
 
@@ -121,40 +380,73 @@ public:
      */
     bool canCastShadow() const { return castShadow; }
 
+private:
     /**
-     * @brief Renderiza la sombra del actor (depth pass).
-     * @param deviceContext Contexto del dispositivo.
-     *
-     * @note Suele usarse en un pase previo para mapas de sombras.
+     * @brief Matriz que se antepone al mundo en `m_model` (ver `MeshAsset::getDecodeMatrix`).
+     * @note Solo afecta a lo que se sube a GPU; el culling usa la AABB en espacio de modelo.
      */
-    void renderShadow(DeviceContext& deviceContext);
+    XMMATRIX getDecodeMatrix() const;
+
+    /// Rango de ndices que sobrevive al culling por clusters.
+    struct ClusterRange {
+        unsigned int startIndex;
+        unsigned int indexCount;
+    };
+
+    /**
+     * @brief Descarta los meshlets de `mesh` fuera del frustum o de espaldas a la cmara.
+     * @return `false` si hay que dibujar la malla entera (sin meshlets o todos visibles);
+     * si no, los rangos a dibujar quedan en `m_clusterRanges` (puede quedar vaco).
+     */
+    bool cullClusters(RenderQueue& queue, const Frustum& frustum, const XMMATRIX& world,
+        const MeshComponent& mesh);
 
-private:
     // === Geometra y texturas ===
-    std::vector<MeshComponent> m_meshes;   ///< Mallas que componen el actor.
-    std::vector<Texture> m_textures;       ///< Texturas aplicadas.
-    std::vector<Buffer> m_vertexBuffers;   ///< Buffers de vrtices (GPU).
-    std::vector<Buffer> m_indexBuffers;    ///< Buffers de ndices (GPU).
+    EU::TSharedPointer<MeshAsset> m_meshAsset; ///< Mallas y sus buffers (compartibles).
+    std::vector<TextureHandle> m_textures; ///< Texturas aplicadas (compartibles).
+    std::vector<MaterialHandle> m_materials; ///< Material por submalla (vaco = texturas y estados del actor).
 
     // === Estados de renderizado ===
+    // Las instancias de un prefab no crean los suyos: usan los del prefab.
     BlendState m_blendstate;               ///< Estado de mezcla para transparencia/opacidad.
     Rasterizer m_rasterizer;               ///< Configuracin de rasterizacin (culling, fill mode).
     SamplerState m_sampler;                ///< Estado del muestreador de texturas.
+    Prefab* m_prefab = nullptr;            ///< Prefab que aporta estados y buffer de modelo (o nulo).
+
+    BlendState& blendState();
+    Rasterizer& rasterizer();
+    SamplerState& sampler();
+    Buffer& modelBuffer();
 
     // === Constantes de modelo ===
     CBChangesEveryFrame m_model;           ///< Constantes que cambian cada frame (transformaciones).
+    XMMATRIX m_prevWorld;                  ///< Mundo del paso de simulacin anterior.
+    XMMATRIX m_currWorld;                  ///< Mundo del ltimo paso de simulacin.
+    bool m_hasWorld = false;               ///< Ya hubo al menos un paso (`m_currWorld` vlido).
+    bool m_moving = false;                 ///< `m_prevWorld` != `m_currWorld` (hay que interpolar).
+    bool m_modelStale = true;              ///< Recalcular `m_model` aunque el transform no cambie.
+    bool m_modelDirty = true;              ///< `m_model` cambi desde el ltimo `capture`.
+    CBChangesEveryFrame m_renderModel;     ///< Copia de `m_model` que lee el render.
+    XMMATRIX m_renderWorld = XMMatrixIdentity(); ///< Mundo del `Transform` en el ltimo `capture`.
+    bool m_renderDirty = true;             ///< `m_renderModel` cambi desde la ltima subida a `m_modelBuffer`.
+    unsigned int m_renderVersion = 0;      ///< Se incrementa en cada `capture` que copia algo.
+    unsigned int m_transformVersion = 0;   ///< `Transform::getVersion` del ltimo `update`.
+    XMFLOAT4 m_color = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f); ///< Tinte del material.
     Buffer m_modelBuffer;                  ///< Buffer de constantes para el modelo.
-
-    // === Sombras ===
-    ShaderProgram m_shaderShadow;          ///< Shader para renderizado de sombras.
-    Buffer m_shaderBuffer;                 ///< Buffer asociado al shader de sombras.
-    BlendState m_shadowBlendState;         ///< Estado de mezcla usado en el pase de sombras.
-    DepthStencilState m_shadowDepthStencilState; ///< Estado de profundidad para sombras.
-    CBChangesEveryFrame m_cbShadow;        ///< Buffer de constantes para sombras.
-    XMFLOAT4 m_LightPos;                    ///< Posicin de la luz que proyecta las sombras.
+    ID3D11ShaderResourceView* m_lightmap = nullptr; ///< Pgina de `LightmapBaker` (no es dueo).
+    Buffer m_lightmapBuffer;               ///< `CBLightmap` del actor (b9).
 
     // === Metadatos ===
-    std::string m_name = "Actor";          ///< Nombre identificador del actor.
+    Name m_name = "Actor";                 ///< Nombre identificador del actor.
     bool castShadow = true;                ///< Indica si el actor proyecta sombras.
     bool m_receiveShadow = true;           ///< Indica si el actor recibe sombras.
+    bool m_transparent = false;            ///< Se dibuja en la capa transparente de la cola.
+    bool m_static = false;                 ///< No se mueve: sus sombras lejanas se cachean.
+    bool m_batched = false;                ///< Lo dibuja un lote de `StaticBatcher`.
+    bool m_occlusionQuery = false;         ///< Caja de prueba + `SetPredication` antes de dibujarlo.
+    float m_impostorDistance = 0.0f;       ///< Ms lejos, se dibuja como impostor (0 = nunca).
+    unsigned int m_lodLevel = 0;           ///< Nivel de detalle actual (ver `updateLOD`).
+    float m_screenSize = 1.0f;             ///< Tamao en pantalla del ltimo `updateLOD`.
+    std::vector<ClusterRange> m_clusterRanges; ///< Rangos visibles de la malla en curso (`submit`).
+    std::vector<unsigned int> m_clusterGaps;   ///< ndices ocultos entre rangos, para fusionarlos.
 };
@@ -0,0 +1,193 @@
+﻿/**
+ * @file ActorPool.h
+ * @brief Pool de actores con almacenamiento por páginas y handles generacionales de 32 bits.
+ *
+ * @details
+ * Antes cada actor era un `EU::MakeShared<Actor>`: una reserva para el objeto y otra
+ * para el contador, actores dispersos por el heap y sin forma de saber si un puntero
+ * guardado seguía vivo. El pool guarda los actores en **páginas** contiguas de
+ * @ref ActorPool::kPageSize y los identifica con un @ref ActorHandle:
+ *
+ * - **Handle** = índice del hueco (20 bits) + **generación** (12 bits). Al destruir un
+ *   actor la generación de su hueco sube, así que cualquier handle antiguo deja de
+ *   resolver (`get()` devuelve `nullptr`) en lugar de apuntar al siguiente inquilino.
+ * - **Lista libre**: crear y destruir son O(1) (apilar/desapilar un índice). Las páginas
+ *   no se mueven nunca: los punteros a un actor vivo (p. ej. en los draw packets) valen
+ *   hasta que se destruye.
+ * - Con @ref ActorPool::reserve por delante (p. ej. la escena de estrés), crear actores
+ *   no reserva memoria del pool; la que reserve el propio actor (componentes, buffers)
+ *   es aparte.
+ *
+ * - **Índice por nombre**: id del @ref Name -> handle, mantenido al crear, destruir y
+ *   renombrar (`Actor::setName`). @ref ActorPool::findByName no recorre los actores.
+ * - **Eventos**: crear, destruir y renombrar publican @ref ActorSpawnedEvent,
+ *   @ref ActorDespawnedEvent y @ref ActorRenamedEvent en el `EventBus`.
+ *
+ * @note Para estudiantes: es el mismo esquema que `EntityID` en `World`; el handle es
+ * un valor (se copia, se compara, cabe en 4 bytes) y no mantiene vivo nada.
+ * @note Crear y destruir solo desde el hilo principal y con el render parado; `get()`
+ * solo lee y se puede llamar desde cualquier hilo mientras tanto.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "ECS/Actor.h"
+#include "EventBus.h"
+#include <unordered_map>
+
+class Device;
+class Prefab;
+
+/**
+ * @struct ActorHandle
+ * @brief Referencia débil a un actor del pool por defecto (`ActorPool::getDefault()`).
+ *
+ * @details Se usa como el puntero compartido al que sustituye (`->`, `*`, `get()`,
+ * `isNull()`), pero un handle caducado resuelve a `nullptr`.
+ */
+struct ActorHandle {
+    static const uint32_t kIndexBits = 20;                      ///< Bits del índice del hueco.
+    static const uint32_t kIndexMask = (1u << kIndexBits) - 1;  ///< Máscara del índice.
+    static const uint32_t kMaxGeneration = (1u << (32 - kIndexBits)) - 1; ///< Generación máxima (luego vuelve a 1).
+
+    uint32_t value = 0;  ///< Generación << kIndexBits | índice; 0 = handle nulo.
+
+    /** @brief Índice del hueco en el pool. */
+    uint32_t getIndex() const { return value & kIndexMask; }
+
+    /** @brief Generación del hueco cuando se creó el actor (nunca 0 en un handle creado). */
+    uint32_t getGeneration() const { return value >> kIndexBits; }
+
+    /** @brief Actor, o `nullptr` si el handle es nulo o el actor ya se destruyó. */
+    Actor* get() const;
+
+    /** @brief `true` si el handle no resuelve a un actor vivo. */
+    bool isNull() const { return get() == nullptr; }
+
+    explicit operator bool() const { return get() != nullptr; }
+    Actor* operator->() const { return get(); }
+    Actor& operator*() const { return *get(); }
+
+    bool operator==(const ActorHandle& o) const { return value == o.value; }
+    bool operator!=(const ActorHandle& o) const { return value != o.value; }
+};
+
+/// Se creó un actor en el pool.
+struct ActorSpawnedEvent {
+    ActorHandle actor;
+};
+
+/// Se destruyó un actor (el handle ya no resuelve; el nombre es el que tenía).
+struct ActorDespawnedEvent {
+    ActorHandle actor;
+    Name name;
+};
+
+/// Un actor vivo cambió de nombre.
+struct ActorRenamedEvent {
+    ActorHandle actor;
+    Name oldName;
+    Name newName;
+};
+
+/**
+ * @class ActorPool
+ * @brief Páginas de actores, generación por hueco y lista libre de huecos.
+ */
+class ActorPool {
+public:
+    /// Actores por página (una reserva alineada por página).
+    static const uint32_t kPageSize = 256;
+    /// Actores vivos como mucho (lo que cabe en el índice del handle).
+    static const uint32_t kMaxActors = ActorHandle::kIndexMask + 1;
+
+    ActorPool() = default;
+    ~ActorPool() { clear(); }
+    ActorPool(const ActorPool&) = delete;
+    ActorPool& operator=(const ActorPool&) = delete;
+
+    /** @brief Pool del proceso (el que resuelven los `ActorHandle`). */
+    static ActorPool& getDefault();
+
+    /**
+     * @brief Reserva páginas para que haya al menos `count` huecos en total.
+     * @return `E_OUTOFMEMORY` si no caben (más de @ref kMaxActors) o falla la reserva.
+     */
+    HRESULT reserve(uint32_t count);
+
+    /**
+     * @brief Construye un actor (`Actor(Device&)`) en un hueco libre.
+     * @return Su handle, o uno nulo si el pool está lleno.
+     */
+    ActorHandle spawn(Device& device);
+
+    /**
+     * @brief Construye una instancia de `prefab` (`Actor(Prefab&)`) en un hueco libre.
+     * @return Su handle, o uno nulo si el pool está lleno.
+     */
+    ActorHandle spawn(Prefab& prefab);
+
+    /**
+     * @brief Destruye el actor (llama a su destructor, no a `Actor::destroy`) y libera el hueco.
+     * @note Un handle nulo o caducado no hace nada: destruir dos veces es seguro.
+     */
+    void despawn(ActorHandle handle);
+
+    /** @brief Actor del handle, o `nullptr` si es nulo o está caducado. */
+    Actor* get(ActorHandle handle) const {
+        const uint32_t index = handle.getIndex();
+        if (handle.value == 0 || index >= m_generations.size() || m_generations[index] != handle.getGeneration()) {
+            return nullptr;
+        }
+        return slot(index);
+    }
+
+    /**
+     * @brief Un actor vivo con ese nombre (cualquiera si hay varios).
+     * @return Su handle, o uno nulo si no hay ninguno.
+     */
+    ActorHandle findByName(Name name) const;
+
+    /** @brief Añade a `out` todos los actores vivos con ese nombre. */
+    void findAllByName(Name name, std::vector<ActorHandle>& out) const;
+
+    /** @brief Mueve un actor vivo de `oldName` a `newName` en el índice (desde `Actor::setName`). */
+    void rename(uint32_t handleValue, Name oldName, Name newName);
+
+    /** @brief Actores vivos. */
+    uint32_t getCount() const { return m_count; }
+
+    /** @brief Huecos reservados (vivos + libres). */
+    uint32_t getCapacity() const { return static_cast<uint32_t>(m_pages.size()) * kPageSize; }
+
+    /** @brief Destruye todos los actores vivos y libera las páginas. */
+    void clear();
+
+private:
+    Actor* slot(uint32_t index) const {
+        return reinterpret_cast<Actor*>(m_pages[index / kPageSize] + (index % kPageSize) * sizeof(Actor));
+    }
+
+    /// Añade una página y mete sus huecos al fondo de la lista libre.
+    HRESULT addPage();
+
+    /// Saca un hueco de la lista libre (añade una página si hace falta); `kMaxActors` si no hay.
+    uint32_t acquireSlot();
+
+    /// Registra el actor ya construido en el hueco `index` y devuelve su handle.
+    ActorHandle commitSlot(uint32_t index, Actor* actor);
+
+    /// Quita `handleValue` de las entradas de `name` en el índice.
+    void unindexName(Name name, uint32_t handleValue);
+
+    std::vector<unsigned char*> m_pages;    ///< `kPageSize` actores cada una, alineadas a `alignof(Actor)`.
+    std::vector<uint16_t> m_generations;    ///< Generación actual de cada hueco.
+    std::vector<uint8_t> m_alive;           ///< Por hueco: hay un actor construido.
+    std::vector<uint32_t> m_freeList;       ///< Huecos libres (pila).
+    std::unordered_multimap<uint32_t, uint32_t> m_byName; ///< Id del nombre -> valor del handle.
+    uint32_t m_count = 0;
+};
+
+inline Actor* ActorHandle::get() const {
+    return ActorPool::getDefault().get(*this);
+}
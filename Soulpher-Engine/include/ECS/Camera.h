@@ -0,0 +1,180 @@
+﻿/**
+ * @file Camera.h
+ * @brief Componente de cámara: vista, proyección, vista-proyección y frustum en caché.
+ *
+ * @details
+ * La cámara se describe con pocos números (órbita o matriz de vista, y la lente) y el
+ * resto sale de ellos: `XMMatrixLookAtLH`, `XMMatrixPerspectiveFovLH`, el producto y los
+ * seis planos del @ref Frustum. Los setters solo marcan qué parte quedó sucia y los
+ * getters recalculan lo necesario la primera vez que se piden:
+ *
+ * - cambiar la órbita o la vista invalida vista, vista-proyección y frustum;
+ * - cambiar la lente (o el aspecto al redimensionar) invalida proyección, vista-proyección
+ *   y frustum;
+ * - un frame sin entrada no recalcula nada.
+ *
+ * Hay dos fuentes de vista: la **órbita** del editor (objetivo, yaw, pitch y distancia,
+ * en grados y unidades de mundo, como `Benchmark::CameraKey`) o una **matriz** explícita
+ * (@ref Camera::setView, @ref Camera::lookAt) para las cámaras que no orbitan: caras de
+ * sonda, vistas de la luz, picture-in-picture.
+ *
+ * @ref Camera::setViewportRect guarda la parte del target que ocupa la cámara (0..1), para
+ * repartir la pantalla entre varias.
+ *
+ * @note Para estudiantes: como todo está en caché, varias cámaras cuestan lo que cuesta
+ * cullearlas; `SceneBVH::cullViews` recorre el árbol una vez para todas.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "Component.h"
+#include "Frustum.h"
+
+class DeviceContext;
+
+/**
+ * @class Camera
+ * @brief Cámara con órbita o vista explícita, lente en perspectiva y cachés perezosas.
+ */
+class Camera : public Component {
+public:
+    /// Índice en la tabla de componentes de `Entity`.
+    static const ComponentType kType = ComponentType::CAMERA;
+
+    /** @brief Órbita por defecto y lente de 45 grados, aspecto 1, planos 0.1 y 100. */
+    Camera() : Component(ComponentType::CAMERA) {}
+    ~Camera() override = default;
+
+    /** @brief Sin recursos: la cámara es solo datos. */
+    void init() override {}
+
+    /**
+     * @brief Recalcula las cachés sucias.
+     * @note Opcional (los getters lo hacen al pedirse); sirve para pagar el cálculo en
+     * el hilo de simulación antes de copiar la cámara al frame.
+     */
+    void update(float deltaTime) override;
+
+    /** @brief No dibuja nada. */
+    void render(DeviceContext& deviceContext) override {}
+
+    /** @brief Sin recursos. */
+    void destroy() override {}
+
+    /**
+     * @brief Vista orbital: el ojo mira a `target` desde `distance`, girado `yawDeg`
+     * alrededor de Y e inclinado `pitchDeg`.
+     */
+    void setOrbit(const XMFLOAT3& target, float yawDeg, float pitchDeg, float distance);
+
+    /** @brief Cambia el objetivo de la órbita. */
+    void setTarget(const XMFLOAT3& target);
+
+    /** @brief Cambia el giro y la inclinación de la órbita (grados). */
+    void setAngles(float yawDeg, float pitchDeg);
+
+    /** @brief Cambia la distancia de la órbita. */
+    void setDistance(float distance);
+
+    /** @brief Objetivo de la órbita. */
+    const XMFLOAT3& getTarget() const { return m_target; }
+    /** @brief Giro de la órbita (grados). */
+    float getYaw() const { return m_yawDeg; }
+    /** @brief Inclinación de la órbita (grados). */
+    float getPitch() const { return m_pitchDeg; }
+    /** @brief Distancia de la órbita. */
+    float getDistance() const { return m_distance; }
+
+    /**
+     * @brief Vista explícita (deja de orbitar hasta el siguiente setter de órbita).
+     * @param view Matriz de vista LH (vector fila).
+     */
+    void setView(const XMMATRIX& view);
+
+    /** @brief Vista explícita desde `eye` hacia `target`. */
+    void lookAt(const XMFLOAT3& eye, const XMFLOAT3& target, const XMFLOAT3& up);
+
+    /** @brief `true` si la vista sale de la órbita. */
+    bool isOrbiting() const { return m_orbiting; }
+
+    /**
+     * @brief Lente en perspectiva.
+     * @param fovY Campo de visión vertical (radianes).
+     * @param aspect Ancho / alto.
+     * @param nearZ Plano cercano.
+     * @param farZ Plano lejano.
+     */
+    void setPerspective(float fovY, float aspect, float nearZ, float farZ);
+
+    /** @brief Cambia solo el aspecto (al redimensionar). */
+    void setAspect(float aspect);
+
+    /**
+     * @brief Proyección explícita (p. ej. las caras de 90 grados de una sonda).
+     * @param nearZ Plano cercano de `projection` (lo usan los clusters y las sombras).
+     * @param farZ Plano lejano de `projection`.
+     */
+    void setProjection(const XMMATRIX& projection, float nearZ, float farZ);
+
+    /** @brief Campo de visión vertical (radianes; 0 con proyección explícita). */
+    float getFovY() const { return m_fovY; }
+    /** @brief Ancho / alto. */
+    float getAspect() const { return m_aspect; }
+    /** @brief Plano cercano. */
+    float getNearZ() const { return m_nearZ; }
+    /** @brief Plano lejano. */
+    float getFarZ() const { return m_farZ; }
+
+    /** @brief Rectángulo del target que ocupa la cámara (x, y, ancho, alto en 0..1). */
+    void setViewportRect(const XMFLOAT4& rect) { m_viewportRect = rect; }
+    /** @brief Rectángulo del target que ocupa la cámara. */
+    const XMFLOAT4& getViewportRect() const { return m_viewportRect; }
+
+    /** @brief Matriz de vista. */
+    XMMATRIX getView() const;
+    /** @brief Matriz de proyección. */
+    XMMATRIX getProjection() const;
+    /** @brief `view * projection`. */
+    XMMATRIX getViewProjection() const;
+    /** @brief Planos de `view * projection`. */
+    const Frustum& getFrustum() const;
+    /** @brief Posición del ojo en mundo. */
+    XMFLOAT3 getPosition() const;
+
+    /**
+     * @brief Se incrementa cada vez que se recalcula la vista-proyección: quien guarde
+     * algo derivado de la cámara puede comparar la versión en lugar de las matrices.
+     */
+    unsigned int getVersion() const;
+
+private:
+    /// Recalcula lo que esté sucio.
+    void refresh() const;
+
+    // Órbita
+    XMFLOAT3 m_target = XMFLOAT3(0.0f, 0.0f, 0.0f);
+    float m_yawDeg = 0.0f;
+    float m_pitchDeg = 0.0f;
+    float m_distance = 10.0f;
+    bool m_orbiting = true;
+
+    // Lente
+    float m_fovY = XM_PIDIV4;
+    float m_aspect = 1.0f;
+    float m_nearZ = 0.1f;
+    float m_farZ = 100.0f;
+    bool m_perspective = true;  ///< `false` tras @ref setProjection.
+
+    XMFLOAT4 m_viewportRect = XMFLOAT4(0.0f, 0.0f, 1.0f, 1.0f);
+
+    // Cachés (se rellenan en los getters)
+    mutable XMFLOAT4X4 m_view;
+    mutable XMFLOAT4X4 m_projection;
+    mutable XMFLOAT4X4 m_viewProjection;
+    mutable XMFLOAT3 m_position = XMFLOAT3(0.0f, 0.0f, 0.0f);
+    mutable Frustum m_frustum;
+    mutable unsigned int m_version = 0;
+    mutable bool m_viewDirty = true;
+    mutable bool m_projectionDirty = true;
+    mutable bool m_viewProjectionDirty = true;
+};
@@ -60,9 +60,12 @@ public:
 
     /**
      * @brief Agrega un componente a la entidad.
-     * @tparam T Tipo de componente (debe heredar de `Component`).
+     * @tparam T Tipo de componente (debe heredar de `Component` y declarar `kType`).
      * @param component Puntero compartido al componente.
      *
+     * @note Una entidad tiene como mucho un componente de cada `ComponentType`: uno nuevo
+     * del mismo tipo sustituye al anterior.
+     *
      * @code
      * auto transform = EU::MakeShared<TransformComponent>();
      * myEntity.addComponent(transform);
@@ -71,13 +74,29 @@ public:
     template <typename T>
     void addComponent(EU::TSharedPointer<T> component) {
         static_assert(std::is_base_of<Component, T>::value, "T must be derived from Component");
-        m_components.push_back(component.template dynamic_pointer_cast<Component>());
+        static_assert(T::kType < COMPONENT_TYPE_COUNT, "T::kType must be a ComponentType");
+        EU::TSharedPointer<Component> base = component.template dynamic_pointer_cast<Component>();
+        Component*& slot = m_slots[T::kType];
+        if (slot) {
+            for (auto& existing : m_components) {
+                if (existing.get() == slot) { existing = base; }
+            }
+        }
+        else {
+            m_components.push_back(base);
+        }
+        slot = component.get();
+        m_mask |= 1u << T::kType;
     }
 
     /**
      * @brief Obtiene un componente por tipo.
      * @tparam T Tipo del componente deseado.
-     * @return Puntero compartido al componente, o `nullptr` si no se encuentra.
+     * @return Puntero al componente (sin propiedad: vive lo que la entidad), o `nullptr`
+     * si la entidad no lo tiene.
+     *
+     * @note Es un acceso a la tabla por `T::kType`, resuelto en compilacin: sin recorrer
+     * la lista, sin RTTI y sin tocar contadores de referencias.
      *
      * @code
      * auto transform = myEntity.getComponent<TransformComponent>();
@@ -85,18 +104,24 @@ public:
      * @endcode
      */
     template<typename T>
-    EU::TSharedPointer<T> getComponent() {
-        for (auto& component : m_components) {
-            EU::TSharedPointer<T> specificComponent = component.template dynamic_pointer_cast<T>();
-            if (specificComponent) {
-                return specificComponent;
-            }
-        }
-        return EU::TSharedPointer<T>();
+    T* getComponent() const {
+        static_assert(T::kType < COMPONENT_TYPE_COUNT, "T::kType must be a ComponentType");
+        return static_cast<T*>(m_slots[T::kType]);
     }
 
+    /** @brief Consulta si la entidad tiene un componente del tipo `T`. */
+    template<typename T>
+    bool hasComponent() const { return (m_mask >> T::kType) & 1u; }
+
+    /** @brief Identificador de la entidad: valor de su handle en `ActorPool` (0 = fuera del pool). */
+    uint32_t getId() const { return m_id; }
+
 protected:
-    bool m_isActive; ///< Indica si la entidad est activa en el juego.
-    int m_id; ///< Identificador nico de la entidad.
-    std::vector<EU::TSharedPointer<Component>> m_components; ///< Lista de componentes asociados.
+    friend class ActorPool; ///< Asigna `m_id` al crear la entidad en su pool.
+
+    bool m_isActive = true; ///< Indica si la entidad est activa en el juego.
+    uint32_t m_id = 0; ///< Identificador nico de la entidad (ver `getId`).
+    std::vector<EU::TSharedPointer<Component>> m_components; ///< Lista de componentes asociados (propiedad).
+    Component* m_slots[COMPONENT_TYPE_COUNT] = {}; ///< Componente de cada `ComponentType` (nulo si no hay).
+    unsigned int m_mask = 0; ///< Bit `ComponentType` de cada componente presente.
 };
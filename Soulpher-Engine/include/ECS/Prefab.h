@@ -0,0 +1,142 @@
+﻿/**
+ * @file Prefab.h
+ * @brief Plantilla de actor: recursos GPU compartidos una vez, instancias baratas.
+ *
+ * @details
+ * `Actor(Device&)` crea por actor su constant buffer de modelo, sus tres estados y un
+ * `MeshComponent` vacío. Con oleadas de miles de actores iguales eso son miles de
+ * llamadas a D3D y, como cada actor tiene sus propios objetos de estado, la
+ * `RenderQueue` no puede instanciarlos juntos (compara los punteros de estado).
+ *
+ * Un `Prefab` describe una vez lo compartido: malla, texturas, estados, color y banderas.
+ * @ref Prefab::instantiate crea un actor en el `ActorPool` que solo reserva lo suyo: el
+ * `Transform` (su entidad en `World`) y sus constantes en CPU. Sin llamadas a D3D; los
+ * datos por instancia llegan a la GPU con el anillo de constantes o el buffer de
+ * instancias de la cola, como los de cualquier actor.
+ *
+ * Las instancias se pueden cambiar después como cualquier actor (`setColor`,
+ * `setStatic`...); el prefab solo da los valores iniciales.
+ *
+ * @note Para estudiantes: es el patrón *flyweight*; lo que comparten todas las copias se
+ * guarda una vez y cada copia apunta a ello.
+ * @note El prefab debe vivir más que sus instancias (ver @ref Prefab::getInstanceCount).
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "ECS/ActorPool.h"
+#include "Buffer.h"
+#include "BlendState.h"
+#include "Rasterizer.h"
+#include "SamplerState.h"
+
+/**
+ * @class Prefab
+ * @brief Recursos y valores iniciales compartidos por un grupo de actores.
+ */
+class Prefab {
+public:
+    /// Colocación de una instancia (mismos parámetros que `Transform::setTransform`).
+    struct Placement {
+        EU::Vector3 position = EU::Vector3(0.0f, 0.0f, 0.0f);
+        EU::Vector3 rotation = EU::Vector3(0.0f, 0.0f, 0.0f); ///< Euler en radianes.
+        EU::Vector3 scale = EU::Vector3(1.0f, 1.0f, 1.0f);
+    };
+
+    Prefab() = default;
+    ~Prefab() { destroy(); }
+    Prefab(const Prefab&) = delete;
+    Prefab& operator=(const Prefab&) = delete;
+
+    /**
+     * @brief Crea los estados compartidos y el buffer de modelo del camino directo.
+     * @return `S_OK` o el primer error.
+     */
+    HRESULT init(Device& device);
+
+    /**
+     * @brief Libera los recursos compartidos.
+     * @note Las instancias se deben haber destruido antes (si no, se avisa y no libera).
+     */
+    void destroy();
+
+    /**
+     * @brief Crea una instancia en `ActorPool::getDefault()`.
+     * @return Su handle, o uno nulo si el prefab no está inicializado o el pool está lleno.
+     */
+    ActorHandle instantiate(const Placement& placement);
+
+    /**
+     * @brief Crea una oleada de instancias (una por colocación) y las añade a `out`.
+     * @return `S_OK`, o `E_OUTOFMEMORY` si el pool no tiene sitio para todas (no crea ninguna).
+     */
+    HRESULT instantiate(const std::vector<Placement>& placements, std::vector<ActorHandle>& out);
+
+    /** @brief Instancias vivas creadas desde este prefab. */
+    unsigned int getInstanceCount() const { return m_instanceCount; }
+
+    /** @brief `true` tras un @ref init correcto. */
+    bool isReady() const { return m_ready; }
+
+    // === Valores compartidos / iniciales ===
+    void setMeshAsset(const EU::TSharedPointer<MeshAsset>& asset) { m_meshAsset = asset; }
+    const EU::TSharedPointer<MeshAsset>& getMeshAsset() const { return m_meshAsset; }
+
+    void setTextures(const std::vector<TextureHandle>& textures) { m_textures = textures; }
+    const std::vector<TextureHandle>& getTextures() const { return m_textures; }
+
+    /// Materiales por submalla (ver `Actor::setMaterials`); sus texturas sustituyen a `setTextures`.
+    void setMaterials(const std::vector<MaterialHandle>& materials);
+    const std::vector<MaterialHandle>& getMaterials() const { return m_materials; }
+
+    void setName(Name name) { m_name = name; }
+    const std::string& getName() const { return m_name.str(); }
+    Name getNameId() const { return m_name; }
+
+    void setColor(const XMFLOAT4& color) { m_color = color; }
+    const XMFLOAT4& getColor() const { return m_color; }
+
+    void setCastShadow(bool v) { m_castShadow = v; }
+    bool canCastShadow() const { return m_castShadow; }
+
+    void setReceiveShadow(bool v) { m_receiveShadow = v; }
+    bool getReceiveShadow() const { return m_receiveShadow; }
+
+    void setStatic(bool v) { m_static = v; }
+    bool isStatic() const { return m_static; }
+
+    void setTransparent(bool v) { m_transparent = v; }
+    bool isTransparent() const { return m_transparent; }
+
+    void setImpostorDistance(float distance) { m_impostorDistance = distance > 0.0f ? distance : 0.0f; }
+    float getImpostorDistance() const { return m_impostorDistance; }
+
+    // === Recursos compartidos (los usan las instancias al dibujarse) ===
+    BlendState& getBlendState() { return m_blendState; }
+    Rasterizer& getRasterizer() { return m_rasterizer; }
+    SamplerState& getSampler() { return m_sampler; }
+
+    /// Constant buffer de modelo del camino directo (`Actor::render`), reescrito en cada draw.
+    Buffer& getModelBuffer() { return m_modelBuffer; }
+
+private:
+    friend class Actor; ///< Cuenta sus instancias al construirse y destruirse.
+
+    EU::TSharedPointer<MeshAsset> m_meshAsset;
+    std::vector<TextureHandle> m_textures;
+    std::vector<MaterialHandle> m_materials;
+    Name m_name = "Actor";
+    XMFLOAT4 m_color = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
+    bool m_castShadow = true;
+    bool m_receiveShadow = true;
+    bool m_static = false;
+    bool m_transparent = false;
+    float m_impostorDistance = 0.0f;
+
+    BlendState m_blendState;
+    Rasterizer m_rasterizer;
+    SamplerState m_sampler;
+    Buffer m_modelBuffer;
+    bool m_ready = false;
+    unsigned int m_instanceCount = 0;
+};
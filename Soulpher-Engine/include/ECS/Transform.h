@@ -1,26 +1,70 @@
 #pragma once
 #include "Prerequisites.h"
 #include "EngineUtilities\Vectors\Vector3.h"
+#include "EngineUtilities\Vectors\Quaternion.h"
 #include "Component.h"
+#include "World.h"
+
+/**
+ * @struct LocalTransform
+ * @brief Posicin, rotacin y escala tal como se guardan en `World` (componente de datos).
+ *
+ * La rotacin es un cuaternin unitario: componer la matriz es una conversin directa
+ * (sin los senos y cosenos de tres ngulos) y girar es multiplicar, sin bloqueo de
+ * cardn. Los ngulos de Euler solo existen para el editor (@ref Transform::getEulerAngles).
+ *
+ * @note Quien escriba directamente en el chunk (p. ej. una consulta del mundo) debe poner
+ * `dirty`; los setters de `Transform` ya lo hacen.
+ */
+struct LocalTransform {
+    EU::Vector3 position; ///< Posicin del objeto en coordenadas del mundo.
+    EU::Quaternion rotation; ///< Orientacin (cuaternin unitario).
+    EU::Vector3 scale;       ///< Escala relativa en X, Y, Z.
+    bool dirty;              ///< Cambi desde la ltima matriz calculada.
+};
+
+/**
+ * @struct WorldTransform
+ * @brief Matriz de mundo calculada a partir de `LocalTransform` (componente de datos).
+ */
+struct WorldTransform {
+    XMMATRIX matrix;      ///< Escala * rotacin * traslacin.
+    unsigned int version; ///< Se incrementa cada vez que `matrix` se recalcula.
+};
 
+/**
+ * @class Transform
+ * @brief Fachada de componente sobre una entidad de `World` con `LocalTransform` y `WorldTransform`.
+ *
+ * @details
+ * El `Transform` no guarda los datos: los tiene la entidad, en los chunks contiguos
+ * del mundo. As @ref updateAll recalcula las matrices de todos los actores con un
+ * recorrido lineal, y el resto del motor sigue usando `getComponent<Transform>()`.
+ */
 class Transform : public Component {
 public:
+    /// ndice en la tabla de componentes de `Entity`.
+    static const ComponentType kType = ComponentType::TRANSFORM;
+
     /**
-     * @brief Constructor que inicializa posicin, rotacin y escala por defecto.
+     * @brief Constructor: crea la entidad en `World::getDefault()`.
      *
      * @details
-     * - La posicin, rotacin y escala se inicializan en `(0,0,0)` y `(1,1,1)` segn el valor por defecto de `EU::Vector3`.
-     * - La matriz de transformacin (`matrix`) comienza como identidad.
+     * - La posicin, rotacin y escala se inicializan en `(0,0,0)` segn el valor por defecto de `EU::Vector3`.
+     * - La matriz de transformacin comienza como identidad.
      * - El tipo de componente se establece como `ComponentType::TRANSFORM`.
      *
      * @note Para estudiantes:
      * - Este es uno de los componentes ms comunes en un motor ECS.
      * - Un `Transform` define dnde y cmo est orientada una entidad en el mundo.
      */
-    Transform()
-        : position(), rotation(), scale(), matrix(),
-        Component(ComponentType::TRANSFORM) {
-    }
+    Transform();
+
+    /** @brief Destruye la entidad del mundo. */
+    ~Transform() override;
+
+    Transform(const Transform&) = delete;
+    Transform& operator=(const Transform&) = delete;
 
     /**
      * @brief Inicializa el componente de transformacin.
@@ -33,11 +77,61 @@ public:
      * @brief Actualiza el estado del objeto Transform.
      * @param deltaTime Tiempo transcurrido desde la ltima actualizacin (en segundos).
      *
-     * @note Usualmente este mtodo recalcula la matriz de transformacin
-     * combinando posicin, rotacin y escala.
+     * @note Recalcula solo la matriz de este transform, y solo si cambi; para todos los
+     * actores a la vez usar @ref updateAll.
      */
     void update(float deltaTime) override;
 
+    /**
+     * @brief Sistema de transforms: recalcula la matriz de las entidades del mundo con
+     * `LocalTransform` y `WorldTransform` marcadas como sucias, chunk a chunk.
+     * @param world Mundo a recorrer (normalmente `World::getDefault()`).
+     * @param parallel Propagar la jerarqua con trabajos (ver `TransformHierarchy::update`).
+     *
+     * @details Primero un pase plano por las entidades sin `Parent`; despus la
+     * jerarqua por defecto propaga los mundos a los hijos en orden topolgico.
+     *
+     * @note Los transforms que no cambiaron cuestan una lectura de `dirty`.
+     */
+    static void updateAll(World& world, bool parallel = false);
+
+    /** @brief Matriz local: escala * rotacin (cuaternin) * traslacin. */
+    static XMMATRIX composeLocal(const LocalTransform& local);
+
+    /**
+     * @brief Cuaternin equivalente a unos ngulos de Euler.
+     * @param euler Radianes: pitch = X, yaw = Y, roll = Z (orden de `XMMatrixRotationRollPitchYaw`).
+     */
+    static EU::Quaternion eulerToQuaternion(const EU::Vector3& euler);
+
+    /**
+     * @brief ngulos de Euler (radianes) de un cuaternin; inversa de @ref eulerToQuaternion
+     * con el pitch en [-pi/2, pi/2].
+     */
+    static EU::Vector3 quaternionToEuler(const EU::Quaternion& rotation);
+
+    /**
+     * @brief Aplica un giro alrededor de un eje del mundo tras la orientacin dada.
+     * @param rotation Orientacin actual.
+     * @param axis Eje de giro (no hace falta normalizarlo).
+     * @param radians ngulo de giro.
+     * @return Orientacin resultante, renormalizada para que no acumule error.
+     */
+    static EU::Quaternion rotated(const EU::Quaternion& rotation, const EU::Vector3& axis, float radians);
+
+    /**
+     * @brief Cuelga este transform de otro (su mundo pasa a ser local * mundo del padre).
+     * @param parent Nuevo padre, o `nullptr` para dejarlo suelto.
+     * @return `false` si creara un ciclo.
+     *
+     * @note Los valores locales no se tocan: al emparentar, el objeto salta a su posicin
+     * relativa al padre.
+     */
+    bool setParent(const Transform* parent);
+
+    /** @brief Entidad padre (handle invlido si no tiene). */
+    EntityID getParent() const;
+
     /**
      * @brief Renderiza el objeto Transform.
      * @param deviceContext Contexto del dispositivo de renderizado.
@@ -57,27 +151,51 @@ public:
     // ==== Mtodos de acceso y modificacin ====
 
     /** @brief Obtiene la posicin actual. */
-    const EU::Vector3& getPosition() const { return position; }
+    const EU::Vector3& getPosition() const { return local().position; }
 
     /** @brief Establece una nueva posicin. */
-    void setPosition(const EU::Vector3& newPos) { position = newPos; }
+    void setPosition(const EU::Vector3& newPos) { LocalTransform& data = local(); data.position = newPos; data.dirty = true; }
 
     /** @brief Obtiene la rotacin actual. */
-    const EU::Vector3& getRotation() const { return rotation; }
+    const EU::Quaternion& getRotation() const { return local().rotation; }
 
-    /** @brief Establece una nueva rotacin. */
-    void setRotation(const EU::Vector3& newRot) { rotation = newRot; }
+    /** @brief Establece una nueva rotacin (cuaternin unitario). */
+    void setRotation(const EU::Quaternion& newRot) { LocalTransform& data = local(); data.rotation = newRot; data.dirty = true; }
+
+    /** @brief Rotacin como ngulos de Euler en radianes (para el editor). */
+    EU::Vector3 getEulerAngles() const { return quaternionToEuler(local().rotation); }
+
+    /** @brief Establece la rotacin a partir de ngulos de Euler en radianes. */
+    void setEulerAngles(const EU::Vector3& euler) { setRotation(eulerToQuaternion(euler)); }
+
+    /** @brief Gira alrededor de un eje del mundo (ver @ref rotated). */
+    void rotate(const EU::Vector3& axis, float radians) { setRotation(rotated(local().rotation, axis, radians)); }
 
     /** @brief Obtiene la escala actual. */
-    const EU::Vector3& getScale() const { return scale; }
+    const EU::Vector3& getScale() const { return local().scale; }
 
     /** @brief Establece una nueva escala. */
-    void setScale(const EU::Vector3& newScale) { scale = newScale; }
+    void setScale(const EU::Vector3& newScale) { LocalTransform& data = local(); data.scale = newScale; data.dirty = true; }
+
+    /** @brief Matriz de mundo del ltimo `update` / `updateAll`. */
+    const XMMATRIX& getMatrix() const { return m_world->get<WorldTransform>(m_entity)->matrix; }
+
+    /**
+     * @brief Versin de la matriz: cambia cada vez que se recalcula.
+     * @note Permite a quien la copia (p. ej. `Actor`) saltarse el trabajo si no cambi.
+     */
+    unsigned int getVersion() const { return m_world->get<WorldTransform>(m_entity)->version; }
+
+    /** @brief Consulta si hay cambios pendientes de llevar a la matriz. */
+    bool isDirty() const { return local().dirty; }
+
+    /** @brief Entidad del mundo que guarda los datos (para aadirle componentes). */
+    EntityID getEntity() const { return m_entity; }
 
     /**
      * @brief Establece posicin, rotacin y escala en una sola llamada.
      * @param newPos Nueva posicin.
-     * @param newRot Nueva rotacin.
+     * @param newRot Nueva rotacin en ngulos de Euler (radianes).
      * @param newSca Nueva escala.
      *
      * @note til para inicializar transformaciones rpidamente.
@@ -86,6 +204,11 @@ public:
         const EU::Vector3& newRot,
         const EU::Vector3& newSca);
 
+    /** @brief Como @ref setTransform, con la rotacin ya en cuaternin. */
+    void setTransform(const EU::Vector3& newPos,
+        const EU::Quaternion& newRot,
+        const EU::Vector3& newSca);
+
     /**
      * @brief Traslada la posicin del objeto.
      * @param translation Vector que representa el desplazamiento en cada eje.
@@ -95,10 +218,12 @@ public:
     void translate(const EU::Vector3& translation);
 
 private:
-    EU::Vector3 position; ///< Posicin del objeto en coordenadas del mundo.
-    EU::Vector3 rotation; ///< Rotacin en ejes X, Y, Z (en grados o radianes segn convencin).
-    EU::Vector3 scale;    ///< Escala relativa en X, Y, Z.
+    /// Datos en el chunk; la referencia vale hasta el siguiente cambio estructural del mundo.
+    LocalTransform& local() const { return *m_world->get<LocalTransform>(m_entity); }
 
-public:
-    XMMATRIX matrix; ///< Matriz de transformacin combinada (posicin, rotacin, escala).
+    World* m_world;    ///< Mundo dueo de los datos.
+    EntityID m_entity; ///< Entidad con `LocalTransform` y `WorldTransform`.
 };
+
+/// Se crean y destruyen con cada actor: sus `MakeShared` salen de un pool de bloques.
+namespace EU { template<> struct TUsePool<Transform> : std::true_type {}; }
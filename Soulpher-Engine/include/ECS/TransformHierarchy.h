@@ -0,0 +1,111 @@
+﻿/**
+ * @file TransformHierarchy.h
+ * @brief Jerarquía padre-hijo de transforms con propagación incremental del mundo.
+ *
+ * @details
+ * Un hijo (arma en la mano de un personaje, props agrupados) guarda en `World` un
+ * componente `Parent`; su `WorldTransform` es su matriz local por el mundo del padre.
+ *
+ * La jerarquía mantiene un array de nodos en **preorden** (cada padre antes que sus
+ * hijos y cada subárbol contiguo), que se reconstruye solo cuando cambia algún
+ * parentesco. @ref update lo recorre una vez:
+ * - La raíz de cada árbol es un transform normal (su matriz la calcula el pase plano de
+ *   `Transform::updateAll`); el nodo guarda la versión que vio la última vez.
+ * - Un hijo se recalcula si su `LocalTransform` está sucio o si su padre cambió en este
+ *   pase; si no, se salta (un árbol quieto cuesta una lectura por nodo).
+ * - Los árboles son rangos independientes del array: con `parallel` y bastantes nodos
+ *   se reparten como trabajos del `JobSystem` sin sincronización.
+ *
+ * @note Para estudiantes: el orden topológico es lo que permite hacerlo en una pasada;
+ * al llegar a un hijo, el mundo de su padre ya es el de este frame.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "World.h"
+#include <unordered_map>
+
+struct LocalTransform;
+struct WorldTransform;
+
+/**
+ * @struct Parent
+ * @brief Componente de datos (`World`): entidad padre de un transform hijo.
+ */
+struct Parent {
+    EntityID entity;
+};
+
+/**
+ * @class TransformHierarchy
+ * @brief Orden topológico de los transforms emparentados y su actualización.
+ */
+class TransformHierarchy {
+public:
+    /// Nodos a partir de los cuales @ref update reparte árboles entre hilos.
+    static const unsigned int kMinParallelNodes = 4096;
+
+    /** @brief Jerarquía del mundo por defecto (`World::getDefault()`). */
+    static TransformHierarchy& getDefault();
+
+    /**
+     * @brief Cambia el padre de una entidad.
+     * @param world Mundo de ambas entidades.
+     * @param child Entidad hija (con `LocalTransform` y `WorldTransform`).
+     * @param parent Nuevo padre; un handle inválido la deja sin padre.
+     * @return `false` si el padre no existe o crearía un ciclo (no cambia nada).
+     */
+    bool setParent(World& world, EntityID child, EntityID parent);
+
+    /** @brief Padre de la entidad (handle inválido si no tiene). */
+    EntityID getParent(World& world, EntityID child) const;
+
+    /**
+     * @brief Quita la entidad de la jerarquía antes de destruirla: sus hijos pasan a ser raíces.
+     * @note Los hijos conservan su matriz local; saltan a donde indique por sí sola.
+     */
+    void remove(World& world, EntityID entity);
+
+    /**
+     * @brief Propaga los mundos de los hijos cuyo local o cuyo padre cambió.
+     * @param world Mundo (tras el pase plano de las raíces).
+     * @param parallel Repartir árboles con `JobSystem::getDefault()` (solo desde un hilo con cola).
+     */
+    void update(World& world, bool parallel = false);
+
+    /** @brief Nodos del orden actual (raíces de árbol incluidas). */
+    unsigned int getNodeCount() const { return static_cast<unsigned int>(m_nodes.size()); }
+
+    /** @brief Hijos recalculados en el último @ref update. */
+    unsigned int getUpdatedCount() const { return m_updatedCount; }
+
+private:
+    static const uint32_t kNoParent = UINT32_MAX;
+
+    struct Node {
+        EntityID entity;
+        uint32_t parent = kNoParent;  ///< Índice del padre en `m_nodes` (kNoParent = raíz).
+        uint32_t end = 0;             ///< Uno más allá del último nodo de su subárbol.
+        unsigned int seenVersion = 0; ///< Versión del mundo de la raíz vista en el último pase.
+        LocalTransform* local = nullptr;  ///< Cache de componentes (ver `m_cachedStructure`).
+        WorldTransform* world = nullptr;
+    };
+
+    /// Recalcula el preorden a partir de los componentes `Parent`.
+    void rebuild(World& world);
+
+    /// Vuelve a tomar los punteros a componentes tras un cambio estructural del mundo.
+    void refreshPointers(World& world);
+
+    /// Actualiza los nodos `[begin, end)` (uno o varios árboles completos).
+    unsigned int updateRange(uint32_t begin, uint32_t end);
+
+    std::vector<Node> m_nodes;
+    std::vector<uint8_t> m_changed;                    ///< Por nodo: su mundo cambió en este pase.
+    std::vector<uint32_t> m_roots;                     ///< Índice de la raíz de cada árbol.
+    std::unordered_map<uint32_t, uint32_t> m_childCounts; ///< Hijos por índice de entidad.
+    bool m_orderDirty = false;
+    bool m_forceAll = false;                           ///< Recalcular todos los hijos (orden nuevo).
+    uint64_t m_cachedStructure = UINT64_MAX;           ///< `World::getStructureVersion` de los punteros.
+    unsigned int m_updatedCount = 0;
+};
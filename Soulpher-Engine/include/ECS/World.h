@@ -0,0 +1,290 @@
+﻿/**
+ * @file World.h
+ * @brief Almacenamiento de componentes por arquetipos (ECS orientado a datos).
+ *
+ * @details
+ * `Entity` guarda sus componentes como `TSharedPointer` sueltos: cada uno es una
+ * reserva de heap con su contador, y recorrer los transforms de todos los actores es
+ * saltar de puntero en puntero. `World` guarda los componentes de datos de otra forma:
+ *
+ * - **Arquetipo**: conjunto exacto de tipos de componente (una máscara de bits). Todas
+ *   las entidades con los mismos tipos viven en el mismo arquetipo.
+ * - **Chunk**: bloque de @ref World::kChunkBytes del arquetipo con una columna contigua
+ *   por tipo (SoA) más la columna de `EntityID`. Los chunks se mantienen llenos salvo el
+ *   último: al borrar, la última fila ocupa el hueco.
+ * - **EntityID**: índice + generación. Al destruir una entidad su índice se recicla con
+ *   otra generación, así un handle viejo deja de ser válido en lugar de apuntar a otra.
+ * - **Consultas**: @ref World::forEachChunk / @ref World::each recorren linealmente los
+ *   chunks de los arquetipos que tienen todos los tipos pedidos.
+ *
+ * Los componentes son datos planos: se copian con `memcpy` al cambiar de arquetipo o de
+ * fila y no se llama a su destructor (`static_assert` de destructor trivial).
+ *
+ * @note Para estudiantes: añadir o quitar un componente mueve la entidad de arquetipo
+ * (copia sus datos); es barato pero no gratis, así que conviene decidir los componentes
+ * al crearla. Durante una consulta no se pueden crear, destruir ni cambiar entidades.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <new>
+#include <type_traits>
+
+/**
+ * @struct EntityID
+ * @brief Handle generacional de una entidad de `World`.
+ */
+struct EntityID {
+    uint32_t index = UINT32_MAX;  ///< Registro en el mundo.
+    uint32_t generation = 0;      ///< Cambia cada vez que el registro se recicla.
+
+    /** @brief `false` para el handle por defecto (nunca creado). */
+    bool isValid() const { return index != UINT32_MAX; }
+
+    bool operator==(const EntityID& o) const { return index == o.index && generation == o.generation; }
+    bool operator!=(const EntityID& o) const { return !(*this == o); }
+};
+
+/**
+ * @class World
+ * @brief Entidades y componentes de datos agrupados por arquetipo.
+ */
+class World {
+public:
+    /// Tipos de componente distintos como mucho (bits de la máscara).
+    static const unsigned int kMaxComponentTypes = 64;
+    /// Tamaño de cada chunk (bytes).
+    static const size_t kChunkBytes = 16 * 1024;
+    /// Alineación del inicio de cada chunk (línea de caché).
+    static const size_t kChunkAlignment = 64;
+
+    World() = default;
+    ~World() { clear(); }
+    World(const World&) = delete;
+    World& operator=(const World&) = delete;
+
+    /**
+     * @brief Mundo del proceso, el que usan `Transform` y los actores.
+     * @note Se crea con el primer uso y se destruye al salir, después de la aplicación.
+     */
+    static World& getDefault();
+
+    /** @brief Crea una entidad sin componentes. */
+    EntityID create();
+
+    /** @brief Destruye la entidad (no hace nada si el handle ya no es válido). */
+    void destroy(EntityID id);
+
+    /** @brief `true` si el handle apunta a una entidad viva. */
+    bool isAlive(EntityID id) const {
+        return id.index < m_records.size() && m_records[id.index].alive &&
+            m_records[id.index].generation == id.generation;
+    }
+
+    /**
+     * @brief Añade (o sobrescribe) un componente.
+     * @return Su valor en el chunk (válido hasta el siguiente cambio estructural), o
+     * `nullptr` si la entidad no está viva.
+     */
+    template<typename T>
+    T* add(EntityID id, const T& value = T()) {
+        checkType<T>();
+        const unsigned int type = typeIndex<T>();
+        if (!isAlive(id)) {
+            ERROR("World", "add", "Entity is not alive");
+            return nullptr;
+        }
+        const ComponentMask bit = ComponentMask(1) << type;
+        const ComponentMask mask = m_archetypes[m_records[id.index].archetype]->mask;
+        if ((mask & bit) == 0) {
+            move(id, mask | bit);
+        }
+        return new (componentAt(m_records[id.index], type)) T(value);
+    }
+
+    /** @brief Quita un componente (no hace nada si no lo tiene). */
+    template<typename T>
+    void remove(EntityID id) {
+        checkType<T>();
+        const ComponentMask bit = ComponentMask(1) << typeIndex<T>();
+        if (isAlive(id) && (m_archetypes[m_records[id.index].archetype]->mask & bit) != 0) {
+            move(id, m_archetypes[m_records[id.index].archetype]->mask & ~bit);
+        }
+    }
+
+    /** @brief Componente de la entidad, o `nullptr` si no lo tiene o no está viva. */
+    template<typename T>
+    T* get(EntityID id) {
+        checkType<T>();
+        const unsigned int type = typeIndex<T>();
+        if (!isAlive(id) || (m_archetypes[m_records[id.index].archetype]->mask & (ComponentMask(1) << type)) == 0) {
+            return nullptr;
+        }
+        return static_cast<T*>(componentAt(m_records[id.index], type));
+    }
+
+    /** @brief `true` si la entidad está viva y tiene el componente. */
+    template<typename T>
+    bool has(EntityID id) { return get<T>(id) != nullptr; }
+
+    /**
+     * @brief Recorre los chunks con todos los tipos `Ts`.
+     * @param f Llamada como `f(count, const EntityID* ids, Ts* columnas...)`; cada columna
+     * tiene `count` elementos contiguos.
+     */
+    template<typename... Ts, typename F>
+    void forEachChunk(F&& f) {
+        forEachChunkMasked<Ts...>(0, f);
+    }
+
+    /**
+     * @brief Como @ref forEachChunk, pero saltando los arquetipos que tienen `Excluded`.
+     * @code
+     * world.forEachChunkWithout<Parent, LocalTransform>([](unsigned int n, const EntityID*, LocalTransform* l) {});
+     * @endcode
+     */
+    template<typename Excluded, typename... Ts, typename F>
+    void forEachChunkWithout(F&& f) {
+        checkType<Excluded>();
+        forEachChunkMasked<Ts...>(ComponentMask(1) << typeIndex<Excluded>(), f);
+    }
+
+    /**
+     * @brief Recorre una a una las entidades con todos los tipos `Ts`.
+     * @param f Llamada como `f(EntityID, Ts&...)`.
+     */
+    template<typename... Ts, typename F>
+    void each(F&& f) {
+        forEachChunk<Ts...>([&f](unsigned int count, const EntityID* ids, Ts*... columns) {
+            for (unsigned int i = 0; i < count; ++i) {
+                f(ids[i], columns[i]...);
+            }
+        });
+    }
+
+    /** @brief Destruye todas las entidades y libera los chunks. */
+    void clear();
+
+    /** @brief Entidades vivas. */
+    unsigned int getEntityCount() const { return m_entityCount; }
+
+    /** @brief Arquetipos creados (incluido el vacío). */
+    unsigned int getArchetypeCount() const { return static_cast<unsigned int>(m_archetypes.size()); }
+
+    /** @brief Chunks reservados en todos los arquetipos. */
+    unsigned int getChunkCount() const;
+
+    /**
+     * @brief Contador de cambios estructurales (crear, destruir, añadir o quitar componentes).
+     * @note Mientras no cambie, los punteros a componentes obtenidos con @ref get siguen valiendo.
+     */
+    uint64_t getStructureVersion() const { return m_structureVersion; }
+
+private:
+    typedef uint64_t ComponentMask;
+
+    /// Tamaño y alineación de un tipo registrado.
+    struct TypeInfo {
+        size_t size;
+        size_t align;
+    };
+
+    struct Chunk {
+        unsigned char* data = nullptr;
+        unsigned int count = 0;
+    };
+
+    struct Archetype {
+        ComponentMask mask = 0;
+        unsigned int capacity = 0;                   ///< Filas por chunk.
+        size_t chunkBytes = kChunkBytes;             ///< Más solo si una fila no cabe en un chunk.
+        size_t offsets[kMaxComponentTypes] = {};     ///< Inicio de la columna de cada tipo.
+        std::vector<unsigned int> types;             ///< Tipos presentes, de menor a mayor.
+        std::vector<Chunk> chunks;
+    };
+
+    /// Dónde vive cada entidad.
+    struct Record {
+        uint32_t generation = 0;
+        uint32_t archetype = 0;
+        uint32_t chunk = 0;
+        uint32_t row = 0;
+        bool alive = false;
+    };
+
+    template<typename T>
+    static void checkType() {
+        static_assert(std::is_trivially_destructible<T>::value, "World components must be plain data");
+        static_assert(alignof(T) <= kChunkAlignment, "Component alignment exceeds the chunk alignment");
+    }
+
+    /// Índice del tipo `T` (se registra en el primer uso, compartido por todos los mundos).
+    template<typename T>
+    static unsigned int typeIndex() {
+        static const unsigned int s_index = registerType(sizeof(T), alignof(T));
+        return s_index;
+    }
+
+    template<typename... Ts, typename F>
+    void forEachChunkMasked(ComponentMask excluded, F& f) {
+        const ComponentMask required = maskOf<Ts...>();
+        for (Archetype* archetype : m_archetypes) {
+            if ((archetype->mask & required) != required || (archetype->mask & excluded) != 0) {
+                continue;
+            }
+            for (Chunk& chunk : archetype->chunks) {
+                f(chunk.count, entitiesOf(chunk), columnOf<Ts>(*archetype, chunk)...);
+            }
+        }
+    }
+
+    template<typename... Ts>
+    static ComponentMask maskOf() {
+        const unsigned int types[] = { typeIndex<Ts>()..., kMaxComponentTypes };
+        ComponentMask mask = 0;
+        for (unsigned int type : types) {
+            if (type < kMaxComponentTypes) { mask |= ComponentMask(1) << type; }
+        }
+        return mask;
+    }
+
+    static unsigned int registerType(size_t size, size_t align);
+    static std::vector<TypeInfo>& typeRegistry();
+
+    static EntityID* entitiesOf(Chunk& chunk) {
+        return reinterpret_cast<EntityID*>(chunk.data);
+    }
+
+    template<typename T>
+    static T* columnOf(Archetype& archetype, Chunk& chunk) {
+        return reinterpret_cast<T*>(chunk.data + archetype.offsets[typeIndex<T>()]);
+    }
+
+    void* componentAt(const Record& record, unsigned int type) {
+        Archetype& archetype = *m_archetypes[record.archetype];
+        return archetype.chunks[record.chunk].data + archetype.offsets[type] +
+            record.row * typeRegistry()[type].size;
+    }
+
+    /// Arquetipo con exactamente `mask` (lo crea si no existe).
+    uint32_t findArchetype(ComponentMask mask);
+
+    /// Reserva una fila al final del arquetipo para `id` y actualiza su registro.
+    void allocateRow(uint32_t archetypeIndex, EntityID id);
+
+    /// Quita una fila rellenando el hueco con la última del arquetipo.
+    void freeRow(uint32_t archetypeIndex, uint32_t chunkIndex, uint32_t row);
+
+    /// Lleva la entidad al arquetipo `mask`, copiando los componentes en común.
+    void move(EntityID id, ComponentMask mask);
+
+    std::vector<Archetype*> m_archetypes;
+    std::map<ComponentMask, uint32_t> m_archetypeByMask;
+    std::vector<Record> m_records;
+    std::vector<uint32_t> m_freeRecords;             ///< Índices reciclables.
+    unsigned int m_entityCount = 0;
+    uint64_t m_structureVersion = 0;
+};
@@ -0,0 +1,84 @@
+﻿/**
+ * @file EditorViewport.h
+ * @brief Target de la escena para el panel "Viewport" del editor.
+ *
+ * @details
+ * Sin él, la escena se dibuja en el back buffer entero y los paneles acoplados de la UI
+ * tapan parte de lo dibujado. Con `r.editorViewport`, la escena termina en esta textura,
+ * del tamaño del área del panel, y la UI la muestra con `ImGui::Image`
+ * (`UserInterface::Renderer`):
+ *
+ * - La escena se dibuja a `tamaño del panel * r.viewportScale` (y, encima, la escala de
+ *   `DynamicResolution`); los pases finales (TAA, tonemap o upscale) escriben aquí a
+ *   tamaño del panel.
+ * - Con el panel oculto (pestaña de atrás, plegado o cerrado) no se dibuja la escena:
+ *   solo la UI sobre el back buffer limpio.
+ * - @ref EditorViewport::resize se llama cada frame desde `captureFrame` (render parado).
+ *   La lista de la UI de ese frame ya apunta al SRV anterior: el target viejo se suelta
+ *   por `GpuReleaseQueue`, que lo libera cuando la GPU ha terminado ese frame.
+ *
+ * @note Para estudiantes: el back buffer sigue siendo del tamaño de la ventana; lo que
+ * baja es lo que se sombrea: solo los píxeles del panel, no los tapados por la UI.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "Texture.h"
+#include "RenderTargetPool.h"
+
+class Device;
+
+/**
+ * @class EditorViewport
+ * @brief Textura (RTV + SRV) del panel de la escena, su tamaño y su visibilidad.
+ */
+class EditorViewport {
+public:
+    EditorViewport() = default;
+    ~EditorViewport() { destroy(); }
+    EditorViewport(const EditorViewport&) = delete;
+    EditorViewport& operator=(const EditorViewport&) = delete;
+
+    /// Formato del target (el del back buffer: los pases finales escriben igual en los dos).
+    static const DXGI_FORMAT kFormat = DXGI_FORMAT_R8G8B8A8_UNORM;
+
+    /**
+     * @brief Ajusta el target al área del panel; una vez por frame, con el render parado.
+     * @param width Ancho del área (0 = sin target).
+     * @param height Alto del área.
+     * @return `S_OK` o el error de crear la textura (queda sin target).
+     *
+     * @details Si el tamaño cambia, el actual se suelta en diferido (la UI del frame aún
+     * lo muestra) y se crea otro.
+     */
+    HRESULT resize(Device& device, unsigned int width, unsigned int height);
+
+    /** @brief El panel se ve este frame (si no, no se dibuja la escena). */
+    void setVisible(bool visible) { m_visible = visible; }
+    /** @brief El panel se ve y tiene target. */
+    bool isVisible() const { return m_visible && m_rtv != nullptr; }
+
+    /** @brief Ancho del target. */
+    unsigned int getWidth() const { return m_width; }
+    /** @brief Alto del target. */
+    unsigned int getHeight() const { return m_height; }
+
+    /** @brief Textura y vistas, para importarlas en el grafo. */
+    RenderTargetPool::Target getViews() const;
+
+    /** @brief SRV que muestra el panel (nulo sin target). */
+    ID3D11ShaderResourceView* getSRV() const { return m_texture.srv(); }
+
+    /** @brief Textura del target (capturas y grabación). */
+    Texture& getTexture() { return m_texture; }
+
+    /** @brief Libera el target. */
+    void destroy();
+
+private:
+    Texture m_texture;                          ///< Textura y SRV.
+    ID3D11RenderTargetView* m_rtv = nullptr;
+    unsigned int m_width = 0;
+    unsigned int m_height = 0;
+    bool m_visible = false;
+};
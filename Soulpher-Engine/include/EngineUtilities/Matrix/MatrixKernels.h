@@ -0,0 +1,371 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Roberto Charreton
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * In addition, any project or software that uses this library or class must include
+ * the following acknowledgment in the credits:
+ *
+ * "This project uses software developed by Roberto Charreton and Attribute Overload."
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#pragma once
+#include <cstddef>
+#include "EngineUtilities/Utilities/CpuFeatures.h"
+
+namespace EU {
+	/**
+	 * @brief Ncleos de @ref Matrix4x4 sobre floats en filas (`m[fila][columna]`, 16
+	 * seguidos), con la convencin de vector fila de DirectX: `p' = p * M`.
+	 *
+	 * Hay una tabla por @ref SimdLevel; @ref GetMatrixKernels() elige la mejor para la
+	 * CPU la primera vez y las siguientes llamadas solo leen un puntero. Las versiones
+	 * escalares son la referencia: las SIMD dan el mismo resultado salvo el redondeo
+	 * (el orden de las sumas y FMA cambian el ltimo bit).
+	 *
+	 * - `Multiply`: `Out = A * B`. `Out` puede ser `A` o `B`.
+	 * - `Transpose`: `Out` puede ser `In`.
+	 * - `Inverse`: devuelve `false` y escribe la identidad si la matriz es singular.
+	 * - `TransformPoints`: `Count` puntos `(x, y, z)` con `w = 1`, divididos por la `w`
+	 *   resultante (como `XMVector3TransformCoordStream`). `Out` puede ser `In`.
+	 * - `TransformVectors4`: `Count` vectores `(x, y, z, w)` sin dividir.
+	 *
+	 * @note Para estudiantes: las matrices de `Matrix4x4` no estn alineadas a 16 bytes,
+	 * as que se cargan con `loadu`; en CPUs actuales cuesta lo mismo si no cruza lnea.
+	 */
+	struct MatrixKernels {
+		SimdLevel Level;
+		void (*Multiply)(const float* A, const float* B, float* Out);
+		void (*Transpose)(const float* In, float* Out);
+		bool (*Inverse)(const float* In, float* Out);
+		void (*TransformPoints)(const float* M, const float* In, float* Out, size_t Count);
+		void (*TransformVectors4)(const float* M, const float* In, float* Out, size_t Count);
+	};
+
+	namespace MatrixScalar {
+		inline void Multiply(const float* A, const float* B, float* Out) {
+			float R[16];
+			for (int Row = 0; Row < 4; ++Row) {
+				for (int Col = 0; Col < 4; ++Col) {
+					R[Row * 4 + Col] = A[Row * 4 + 0] * B[0 * 4 + Col] + A[Row * 4 + 1] * B[1 * 4 + Col] +
+						A[Row * 4 + 2] * B[2 * 4 + Col] + A[Row * 4 + 3] * B[3 * 4 + Col];
+				}
+			}
+			for (int i = 0; i < 16; ++i) Out[i] = R[i];
+		}
+
+		inline void Transpose(const float* In, float* Out) {
+			float R[16];
+			for (int Row = 0; Row < 4; ++Row) {
+				for (int Col = 0; Col < 4; ++Col) {
+					R[Col * 4 + Row] = In[Row * 4 + Col];
+				}
+			}
+			for (int i = 0; i < 16; ++i) Out[i] = R[i];
+		}
+
+		/// Adjunta por cofactores (los menores 2x2 de las filas 0-1 y 2-3 se reutilizan).
+		inline bool Inverse(const float* In, float* Out) {
+			const float* m = In;
+			const float S0 = m[0] * m[5] - m[1] * m[4];
+			const float S1 = m[0] * m[6] - m[2] * m[4];
+			const float S2 = m[0] * m[7] - m[3] * m[4];
+			const float S3 = m[1] * m[6] - m[2] * m[5];
+			const float S4 = m[1] * m[7] - m[3] * m[5];
+			const float S5 = m[2] * m[7] - m[3] * m[6];
+			const float C5 = m[10] * m[15] - m[11] * m[14];
+			const float C4 = m[9] * m[15] - m[11] * m[13];
+			const float C3 = m[9] * m[14] - m[10] * m[13];
+			const float C2 = m[8] * m[15] - m[11] * m[12];
+			const float C1 = m[8] * m[14] - m[10] * m[12];
+			const float C0 = m[8] * m[13] - m[9] * m[12];
+			const float Det = S0 * C5 - S1 * C4 + S2 * C3 + S3 * C2 - S4 * C1 + S5 * C0;
+			if (Det == 0.0f) {
+				for (int i = 0; i < 16; ++i) Out[i] = (i % 5 == 0) ? 1.0f : 0.0f;
+				return false;
+			}
+			const float InvDet = 1.0f / Det;
+			float R[16];
+			R[0] = (m[5] * C5 - m[6] * C4 + m[7] * C3) * InvDet;
+			R[1] = (-m[1] * C5 + m[2] * C4 - m[3] * C3) * InvDet;
+			R[2] = (m[13] * S5 - m[14] * S4 + m[15] * S3) * InvDet;
+			R[3] = (-m[9] * S5 + m[10] * S4 - m[11] * S3) * InvDet;
+			R[4] = (-m[4] * C5 + m[6] * C2 - m[7] * C1) * InvDet;
+			R[5] = (m[0] * C5 - m[2] * C2 + m[3] * C1) * InvDet;
+			R[6] = (-m[12] * S5 + m[14] * S2 - m[15] * S1) * InvDet;
+			R[7] = (m[8] * S5 - m[10] * S2 + m[11] * S1) * InvDet;
+			R[8] = (m[4] * C4 - m[5] * C2 + m[7] * C0) * InvDet;
+			R[9] = (-m[0] * C4 + m[1] * C2 - m[3] * C0) * InvDet;
+			R[10] = (m[12] * S4 - m[13] * S2 + m[15] * S0) * InvDet;
+			R[11] = (-m[8] * S4 + m[9] * S2 - m[11] * S0) * InvDet;
+			R[12] = (-m[4] * C3 + m[5] * C1 - m[6] * C0) * InvDet;
+			R[13] = (m[0] * C3 - m[1] * C1 + m[2] * C0) * InvDet;
+			R[14] = (-m[12] * S3 + m[13] * S1 - m[14] * S0) * InvDet;
+			R[15] = (m[8] * S3 - m[9] * S1 + m[10] * S0) * InvDet;
+			for (int i = 0; i < 16; ++i) Out[i] = R[i];
+			return true;
+		}
+
+		inline void TransformPoints(const float* M, const float* In, float* Out, size_t Count) {
+			for (size_t i = 0; i < Count; ++i, In += 3, Out += 3) {
+				const float X = In[0], Y = In[1], Z = In[2];
+				const float W = X * M[3] + Y * M[7] + Z * M[11] + M[15];
+				const float InvW = 1.0f / W;
+				Out[0] = (X * M[0] + Y * M[4] + Z * M[8] + M[12]) * InvW;
+				Out[1] = (X * M[1] + Y * M[5] + Z * M[9] + M[13]) * InvW;
+				Out[2] = (X * M[2] + Y * M[6] + Z * M[10] + M[14]) * InvW;
+			}
+		}
+
+		inline void TransformVectors4(const float* M, const float* In, float* Out, size_t Count) {
+			for (size_t i = 0; i < Count; ++i, In += 4, Out += 4) {
+				const float X = In[0], Y = In[1], Z = In[2], W = In[3];
+				Out[0] = X * M[0] + Y * M[4] + Z * M[8] + W * M[12];
+				Out[1] = X * M[1] + Y * M[5] + Z * M[9] + W * M[13];
+				Out[2] = X * M[2] + Y * M[6] + Z * M[10] + W * M[14];
+				Out[3] = X * M[3] + Y * M[7] + Z * M[11] + W * M[15];
+			}
+		}
+	}
+
+#if defined(EU_SIMD_X86)
+	namespace MatrixSSE41 {
+		/// Fila de `p * M`: combinacin de las filas de `M` con los componentes de `p`.
+		EU_TARGET("sse4.1") inline __m128 Combine(__m128 V, const __m128 Rows[4]) {
+			__m128 R = _mm_mul_ps(_mm_shuffle_ps(V, V, _MM_SHUFFLE(0, 0, 0, 0)), Rows[0]);
+			R = _mm_add_ps(R, _mm_mul_ps(_mm_shuffle_ps(V, V, _MM_SHUFFLE(1, 1, 1, 1)), Rows[1]));
+			R = _mm_add_ps(R, _mm_mul_ps(_mm_shuffle_ps(V, V, _MM_SHUFFLE(2, 2, 2, 2)), Rows[2]));
+			return _mm_add_ps(R, _mm_mul_ps(_mm_shuffle_ps(V, V, _MM_SHUFFLE(3, 3, 3, 3)), Rows[3]));
+		}
+
+		EU_TARGET("sse4.1") inline void Multiply(const float* A, const float* B, float* Out) {
+			const __m128 Rows[4] = { _mm_loadu_ps(B), _mm_loadu_ps(B + 4), _mm_loadu_ps(B + 8), _mm_loadu_ps(B + 12) };
+			const __m128 R0 = Combine(_mm_loadu_ps(A), Rows);
+			const __m128 R1 = Combine(_mm_loadu_ps(A + 4), Rows);
+			const __m128 R2 = Combine(_mm_loadu_ps(A + 8), Rows);
+			const __m128 R3 = Combine(_mm_loadu_ps(A + 12), Rows);
+			_mm_storeu_ps(Out, R0);
+			_mm_storeu_ps(Out + 4, R1);
+			_mm_storeu_ps(Out + 8, R2);
+			_mm_storeu_ps(Out + 12, R3);
+		}
+
+		EU_TARGET("sse4.1") inline void Transpose(const float* In, float* Out) {
+			__m128 R0 = _mm_loadu_ps(In), R1 = _mm_loadu_ps(In + 4);
+			__m128 R2 = _mm_loadu_ps(In + 8), R3 = _mm_loadu_ps(In + 12);
+			_MM_TRANSPOSE4_PS(R0, R1, R2, R3);
+			_mm_storeu_ps(Out, R0);
+			_mm_storeu_ps(Out + 4, R1);
+			_mm_storeu_ps(Out + 8, R2);
+			_mm_storeu_ps(Out + 12, R3);
+		}
+
+#define EU_SHUFFLE(A, B, X, Y, Z, W) _mm_shuffle_ps(A, B, _MM_SHUFFLE(W, Z, Y, X))
+#define EU_SWIZZLE(V, X, Y, Z, W) _mm_shuffle_ps(V, V, _MM_SHUFFLE(W, Z, Y, X))
+		// Bloques 2x2 guardados como (m00, m01, m10, m11).
+		EU_TARGET("sse4.1") inline __m128 Mat2Mul(__m128 A, __m128 B) {
+			return _mm_add_ps(_mm_mul_ps(A, EU_SWIZZLE(B, 0, 3, 0, 3)),
+				_mm_mul_ps(EU_SWIZZLE(A, 1, 0, 3, 2), EU_SWIZZLE(B, 2, 1, 2, 1)));
+		}
+		/// adj(A) * B
+		EU_TARGET("sse4.1") inline __m128 Mat2AdjMul(__m128 A, __m128 B) {
+			return _mm_sub_ps(_mm_mul_ps(EU_SWIZZLE(A, 3, 3, 0, 0), B),
+				_mm_mul_ps(EU_SWIZZLE(A, 1, 1, 2, 2), EU_SWIZZLE(B, 2, 3, 0, 1)));
+		}
+		/// A * adj(B)
+		EU_TARGET("sse4.1") inline __m128 Mat2MulAdj(__m128 A, __m128 B) {
+			return _mm_sub_ps(_mm_mul_ps(A, EU_SWIZZLE(B, 3, 0, 3, 0)),
+				_mm_mul_ps(EU_SWIZZLE(A, 1, 0, 3, 2), EU_SWIZZLE(B, 2, 1, 2, 1)));
+		}
+
+		/**
+		 * Inversa por bloques 2x2 (A B; C D): los cuatro bloques de la inversa salen de
+		 * adjuntas y productos 2x2, que caben en un registro cada uno.
+		 */
+		EU_TARGET("sse4.1") inline bool Inverse(const float* In, float* Out) {
+			const __m128 R0 = _mm_loadu_ps(In), R1 = _mm_loadu_ps(In + 4);
+			const __m128 R2 = _mm_loadu_ps(In + 8), R3 = _mm_loadu_ps(In + 12);
+			const __m128 A = _mm_movelh_ps(R0, R1);
+			const __m128 B = _mm_movehl_ps(R1, R0);
+			const __m128 C = _mm_movelh_ps(R2, R3);
+			const __m128 D = _mm_movehl_ps(R3, R2);
+
+			// Determinantes de los bloques: (|A|, |B|, |C|, |D|).
+			const __m128 DetSub = _mm_sub_ps(
+				_mm_mul_ps(EU_SHUFFLE(R0, R2, 0, 2, 0, 2), EU_SHUFFLE(R1, R3, 1, 3, 1, 3)),
+				_mm_mul_ps(EU_SHUFFLE(R0, R2, 1, 3, 1, 3), EU_SHUFFLE(R1, R3, 0, 2, 0, 2)));
+			const __m128 DetA = EU_SWIZZLE(DetSub, 0, 0, 0, 0);
+			const __m128 DetB = EU_SWIZZLE(DetSub, 1, 1, 1, 1);
+			const __m128 DetC = EU_SWIZZLE(DetSub, 2, 2, 2, 2);
+			const __m128 DetD = EU_SWIZZLE(DetSub, 3, 3, 3, 3);
+
+			const __m128 DC = Mat2AdjMul(D, C);
+			const __m128 AB = Mat2AdjMul(A, B);
+			__m128 X = _mm_sub_ps(_mm_mul_ps(DetD, A), Mat2Mul(B, DC));
+			__m128 W = _mm_sub_ps(_mm_mul_ps(DetA, D), Mat2Mul(C, AB));
+			__m128 Y = _mm_sub_ps(_mm_mul_ps(DetB, C), Mat2MulAdj(D, AB));
+			__m128 Z = _mm_sub_ps(_mm_mul_ps(DetC, B), Mat2MulAdj(A, DC));
+
+			// |M| = |A||D| + |B||C| - traza(adj(A)B adj(D)C)
+			__m128 Trace = _mm_mul_ps(AB, EU_SWIZZLE(DC, 0, 2, 1, 3));
+			Trace = _mm_hadd_ps(Trace, Trace);
+			Trace = _mm_hadd_ps(Trace, Trace);
+			const __m128 Det = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(DetA, DetD), _mm_mul_ps(DetB, DetC)), Trace);
+			if (_mm_cvtss_f32(Det) == 0.0f) {
+				MatrixScalar::Inverse(In, Out);	// Escribe la identidad.
+				return false;
+			}
+			const __m128 RDet = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), Det);
+			X = _mm_mul_ps(X, RDet);
+			Y = _mm_mul_ps(Y, RDet);
+			Z = _mm_mul_ps(Z, RDet);
+			W = _mm_mul_ps(W, RDet);
+			_mm_storeu_ps(Out, EU_SHUFFLE(X, Y, 3, 1, 3, 1));
+			_mm_storeu_ps(Out + 4, EU_SHUFFLE(X, Y, 2, 0, 2, 0));
+			_mm_storeu_ps(Out + 8, EU_SHUFFLE(Z, W, 3, 1, 3, 1));
+			_mm_storeu_ps(Out + 12, EU_SHUFFLE(Z, W, 2, 0, 2, 0));
+			return true;
+		}
+#undef EU_SHUFFLE
+#undef EU_SWIZZLE
+
+		/// Guarda x, y, z sin tocar el float siguiente (`Out` puede ser la entrada).
+		EU_TARGET("sse4.1") inline void StorePoint(float* Out, __m128 V) {
+			_mm_storel_pi(reinterpret_cast<__m64*>(Out), V);
+			_mm_store_ss(Out + 2, _mm_movehl_ps(V, V));
+		}
+
+		EU_TARGET("sse4.1") inline void TransformPoints(const float* M, const float* In, float* Out, size_t Count) {
+			const __m128 M0 = _mm_loadu_ps(M), M1 = _mm_loadu_ps(M + 4);
+			const __m128 M2 = _mm_loadu_ps(M + 8), M3 = _mm_loadu_ps(M + 12);
+			for (size_t i = 0; i < Count; ++i, In += 3, Out += 3) {
+				__m128 R = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(In[0]), M0), M3);
+				R = _mm_add_ps(R, _mm_mul_ps(_mm_set1_ps(In[1]), M1));
+				R = _mm_add_ps(R, _mm_mul_ps(_mm_set1_ps(In[2]), M2));
+				StorePoint(Out, _mm_div_ps(R, _mm_shuffle_ps(R, R, _MM_SHUFFLE(3, 3, 3, 3))));
+			}
+		}
+
+		EU_TARGET("sse4.1") inline void TransformVectors4(const float* M, const float* In, float* Out, size_t Count) {
+			const __m128 Rows[4] = { _mm_loadu_ps(M), _mm_loadu_ps(M + 4), _mm_loadu_ps(M + 8), _mm_loadu_ps(M + 12) };
+			for (size_t i = 0; i < Count; ++i, In += 4, Out += 4) {
+				_mm_storeu_ps(Out, Combine(_mm_loadu_ps(In), Rows));
+			}
+		}
+	}
+
+	namespace MatrixAVX2 {
+		/// Dos filas de `A * B` a la vez: cada mitad del registro de 256 bits es una fila.
+		EU_TARGET("avx2,fma") inline void Multiply(const float* A, const float* B, float* Out) {
+			const __m256 B0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(B));
+			const __m256 B1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(B + 4));
+			const __m256 B2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(B + 8));
+			const __m256 B3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(B + 12));
+			const __m256 A01 = _mm256_loadu_ps(A);
+			const __m256 A23 = _mm256_loadu_ps(A + 8);
+			__m256 R01 = _mm256_mul_ps(_mm256_shuffle_ps(A01, A01, _MM_SHUFFLE(0, 0, 0, 0)), B0);
+			__m256 R23 = _mm256_mul_ps(_mm256_shuffle_ps(A23, A23, _MM_SHUFFLE(0, 0, 0, 0)), B0);
+			R01 = _mm256_fmadd_ps(_mm256_shuffle_ps(A01, A01, _MM_SHUFFLE(1, 1, 1, 1)), B1, R01);
+			R23 = _mm256_fmadd_ps(_mm256_shuffle_ps(A23, A23, _MM_SHUFFLE(1, 1, 1, 1)), B1, R23);
+			R01 = _mm256_fmadd_ps(_mm256_shuffle_ps(A01, A01, _MM_SHUFFLE(2, 2, 2, 2)), B2, R01);
+			R23 = _mm256_fmadd_ps(_mm256_shuffle_ps(A23, A23, _MM_SHUFFLE(2, 2, 2, 2)), B2, R23);
+			R01 = _mm256_fmadd_ps(_mm256_shuffle_ps(A01, A01, _MM_SHUFFLE(3, 3, 3, 3)), B3, R01);
+			R23 = _mm256_fmadd_ps(_mm256_shuffle_ps(A23, A23, _MM_SHUFFLE(3, 3, 3, 3)), B3, R23);
+			_mm256_storeu_ps(Out, R01);
+			_mm256_storeu_ps(Out + 8, R23);
+			_mm256_zeroupper();
+		}
+
+		/// `Low` repetido en la mitad baja y `High` en la alta.
+		EU_TARGET("avx2,fma") inline __m256 Pair(float Low, float High) {
+			return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_set1_ps(Low)), _mm_set1_ps(High), 1);
+		}
+
+		/// Dos puntos por vuelta (uno en cada mitad), con FMA.
+		EU_TARGET("avx2,fma") inline void TransformPoints(const float* M, const float* In, float* Out, size_t Count) {
+			const __m256 M0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(M));
+			const __m256 M1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(M + 4));
+			const __m256 M2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(M + 8));
+			const __m256 M3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(M + 12));
+			size_t i = 0;
+			for (; i + 2 <= Count; i += 2, In += 6, Out += 6) {
+				const __m256 X = Pair(In[0], In[3]);
+				const __m256 Y = Pair(In[1], In[4]);
+				const __m256 Z = Pair(In[2], In[5]);
+				__m256 R = _mm256_fmadd_ps(X, M0, M3);
+				R = _mm256_fmadd_ps(Y, M1, R);
+				R = _mm256_fmadd_ps(Z, M2, R);
+				R = _mm256_div_ps(R, _mm256_shuffle_ps(R, R, _MM_SHUFFLE(3, 3, 3, 3)));
+				MatrixSSE41::StorePoint(Out, _mm256_castps256_ps128(R));
+				MatrixSSE41::StorePoint(Out + 3, _mm256_extractf128_ps(R, 1));
+			}
+			_mm256_zeroupper();
+			MatrixSSE41::TransformPoints(M, In, Out, Count - i);
+		}
+
+		EU_TARGET("avx2,fma") inline void TransformVectors4(const float* M, const float* In, float* Out, size_t Count) {
+			const __m256 M0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(M));
+			const __m256 M1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(M + 4));
+			const __m256 M2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(M + 8));
+			const __m256 M3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(M + 12));
+			size_t i = 0;
+			for (; i + 2 <= Count; i += 2, In += 8, Out += 8) {
+				const __m256 V = _mm256_loadu_ps(In);
+				__m256 R = _mm256_mul_ps(_mm256_shuffle_ps(V, V, _MM_SHUFFLE(0, 0, 0, 0)), M0);
+				R = _mm256_fmadd_ps(_mm256_shuffle_ps(V, V, _MM_SHUFFLE(1, 1, 1, 1)), M1, R);
+				R = _mm256_fmadd_ps(_mm256_shuffle_ps(V, V, _MM_SHUFFLE(2, 2, 2, 2)), M2, R);
+				R = _mm256_fmadd_ps(_mm256_shuffle_ps(V, V, _MM_SHUFFLE(3, 3, 3, 3)), M3, R);
+				_mm256_storeu_ps(Out, R);
+			}
+			_mm256_zeroupper();
+			MatrixSSE41::TransformVectors4(M, In, Out, Count - i);
+		}
+	}
+#endif
+
+	/**
+	 * @brief Tabla de un nivel concreto (para comparar niveles en pruebas y benchmarks).
+	 * @note Pedir un nivel que la CPU no tiene es responsabilidad de quien llama.
+	 */
+	inline const MatrixKernels& GetMatrixKernels(SimdLevel Level) {
+		static const MatrixKernels Scalar = { SimdLevel::Scalar, &MatrixScalar::Multiply, &MatrixScalar::Transpose,
+			&MatrixScalar::Inverse, &MatrixScalar::TransformPoints, &MatrixScalar::TransformVectors4 };
+#if defined(EU_SIMD_X86)
+		// Trasponer e invertir no ganan nada con 256 bits: AVX2 reutiliza los de SSE4.1.
+		static const MatrixKernels Sse41 = { SimdLevel::SSE41, &MatrixSSE41::Multiply, &MatrixSSE41::Transpose,
+			&MatrixSSE41::Inverse, &MatrixSSE41::TransformPoints, &MatrixSSE41::TransformVectors4 };
+		static const MatrixKernels Avx2 = { SimdLevel::AVX2, &MatrixAVX2::Multiply, &MatrixSSE41::Transpose,
+			&MatrixSSE41::Inverse, &MatrixAVX2::TransformPoints, &MatrixAVX2::TransformVectors4 };
+		switch (Level) {
+		case SimdLevel::SSE41: return Sse41;
+		case SimdLevel::AVX2: return Avx2;
+		default: break;
+		}
+#endif
+		(void)Level;
+		return Scalar;
+	}
+
+	/** @brief Tabla del mejor nivel de esta CPU (la que usa @ref Matrix4x4). */
+	inline const MatrixKernels& GetMatrixKernels() {
+		static const MatrixKernels& Best = GetMatrixKernels(GetSimdLevel());
+		return Best;
+	}
+}
@@ -0,0 +1,468 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Roberto Charreton
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * In addition, any project or software that uses this library or class must include
+ * the following acknowledgment in the credits:
+ *
+ * "This project uses software developed by Roberto Charreton and Attribute Overload."
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#pragma once
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include "EngineUtilities/Matrix/MatrixKernels.h"
+#include "EngineUtilities/Vectors/Vector3.h"
+#include "EngineUtilities/Vectors/Vector4.h"
+
+namespace EU {
+	/*
+	 * Ncleo comn de vectores y matrices de tamao fijo.
+	 *
+	 * Todas las operaciones se despliegan en tiempo de compilacin: cada elemento sale de
+	 * una expansin de `std::index_sequence`, sin bucles, y son `constexpr`, as que una
+	 * identidad, una traslacin o una proyeccin escritas como constantes se calculan al
+	 * compilar. La excepcin es `TMatrix<4, 4, float>`: producto, traspuesta e inversa
+	 * van a @ref GetMatrixKernels (SSE4.1/AVX2) y no son `constexpr`; su construccin y
+	 * sus sumas s lo son.
+	 *
+	 * Convencin de DirectX: `m[fila][columna]` y vector fila, `p' = p * M`.
+	 *
+	 * `Matrix2x2`, `Matrix3x3` y `Matrix4x4` son alias de `TMatrix`. `Vector2/3/4`
+	 * siguen siendo clases propias por sus miembros `x, y, z, w`; `TVector` es el vector
+	 * genrico para los productos con `TMatrix`.
+	 */
+
+	template<size_t Rows, size_t Cols, typename T>
+	class TMatrix;
+
+	/**
+	 * @brief Vector de `N` componentes (agregado: `TVector<3> V{ 1, 2, 3 };`).
+	 */
+	template<size_t N, typename T = float>
+	struct TVector {
+		T v[N];
+
+		constexpr T& operator[](size_t I) { return v[I]; }
+		constexpr const T& operator[](size_t I) const { return v[I]; }
+
+		T* data() { return v; }
+		const T* data() const { return v; }
+
+		constexpr TVector operator+(const TVector& O) const { return Add(O, std::make_index_sequence<N>()); }
+		constexpr TVector operator-(const TVector& O) const { return Sub(O, std::make_index_sequence<N>()); }
+		constexpr TVector operator*(T S) const { return Scale(S, std::make_index_sequence<N>()); }
+
+		constexpr bool operator==(const TVector& O) const { return Equal(O, 0); }
+		constexpr bool operator!=(const TVector& O) const { return !(*this == O); }
+
+	private:
+		template<size_t... I>
+		constexpr TVector Add(const TVector& O, std::index_sequence<I...>) const { return TVector{ { (v[I] + O.v[I])... } }; }
+		template<size_t... I>
+		constexpr TVector Sub(const TVector& O, std::index_sequence<I...>) const { return TVector{ { (v[I] - O.v[I])... } }; }
+		template<size_t... I>
+		constexpr TVector Scale(T S, std::index_sequence<I...>) const { return TVector{ { (v[I] * S)... } }; }
+		constexpr bool Equal(const TVector& O, size_t I) const { return I == N || (v[I] == O.v[I] && Equal(O, I + 1)); }
+	};
+
+	namespace Detail {
+		/// Suma de `A[R][k] * B[k][C]` para `k < K`, desplegada por recursin.
+		template<size_t R, size_t C, size_t K>
+		struct RowColumn {
+			template<typename MA, typename MB>
+			static constexpr auto Dot(const MA& A, const MB& B) -> decltype(A.m[0][0] * B.m[0][0]) {
+				return RowColumn<R, C, K - 1>::Dot(A, B) + A.m[R][K - 1] * B.m[K - 1][C];
+			}
+		};
+
+		template<size_t R, size_t C>
+		struct RowColumn<R, C, 1> {
+			template<typename MA, typename MB>
+			static constexpr auto Dot(const MA& A, const MB& B) -> decltype(A.m[0][0] * B.m[0][0]) {
+				return A.m[R][0] * B.m[0][C];
+			}
+		};
+
+		/// Producto genrico (escalar desplegado); 4x4 float se especializa abajo.
+		template<size_t R, size_t C, size_t K, typename T>
+		struct MatrixProduct {
+			template<size_t... I>
+			static constexpr TMatrix<R, K, T> Unrolled(const TMatrix<R, C, T>& A, const TMatrix<C, K, T>& B,
+				std::index_sequence<I...>) {
+				return TMatrix<R, K, T>(RowColumn<I / K, I % K, C>::Dot(A, B)...);
+			}
+
+			static constexpr TMatrix<R, K, T> Apply(const TMatrix<R, C, T>& A, const TMatrix<C, K, T>& B) {
+				return Unrolled(A, B, std::make_index_sequence<R * K>());
+			}
+		};
+
+		template<size_t R, size_t C, typename T>
+		struct MatrixTranspose {
+			template<size_t... I>
+			static constexpr TMatrix<C, R, T> Unrolled(const TMatrix<R, C, T>& A, std::index_sequence<I...>) {
+				return TMatrix<C, R, T>(A.m[I % R][I / R]...);
+			}
+
+			static constexpr TMatrix<C, R, T> Apply(const TMatrix<R, C, T>& A) {
+				return Unrolled(A, std::make_index_sequence<R * C>());
+			}
+		};
+
+		/// Inversa por adjunta para 2x2 y 3x3; identidad si es singular.
+		template<size_t N, typename T>
+		struct MatrixInverse;
+
+		template<typename T>
+		struct MatrixInverse<2, T> {
+			static constexpr TMatrix<2, 2, T> Apply(const TMatrix<2, 2, T>& A) {
+				const T Det = A.determinant();
+				return Det == T(0) ? TMatrix<2, 2, T>() : TMatrix<2, 2, T>(
+					A.m[1][1] / Det, -A.m[0][1] / Det,
+					-A.m[1][0] / Det, A.m[0][0] / Det);
+			}
+		};
+
+		template<typename T>
+		struct MatrixInverse<3, T> {
+			static constexpr TMatrix<3, 3, T> Apply(const TMatrix<3, 3, T>& A) {
+				const T Det = A.determinant();
+				if (Det == T(0)) {
+					return TMatrix<3, 3, T>();
+				}
+				const T Inv = T(1) / Det;
+				const auto& m = A.m;
+				return TMatrix<3, 3, T>(
+					(m[1][1] * m[2][2] - m[1][2] * m[2][1]) * Inv,
+					(m[0][2] * m[2][1] - m[0][1] * m[2][2]) * Inv,
+					(m[0][1] * m[1][2] - m[0][2] * m[1][1]) * Inv,
+					(m[1][2] * m[2][0] - m[1][0] * m[2][2]) * Inv,
+					(m[0][0] * m[2][2] - m[0][2] * m[2][0]) * Inv,
+					(m[0][2] * m[1][0] - m[0][0] * m[1][2]) * Inv,
+					(m[1][0] * m[2][1] - m[1][1] * m[2][0]) * Inv,
+					(m[0][1] * m[2][0] - m[0][0] * m[2][1]) * Inv,
+					(m[0][0] * m[1][1] - m[0][1] * m[1][0]) * Inv);
+			}
+		};
+
+		template<size_t N, typename T>
+		struct MatrixDeterminant;
+
+		template<typename T>
+		struct MatrixDeterminant<2, T> {
+			static constexpr T Apply(const TMatrix<2, 2, T>& A) {
+				return A.m[0][0] * A.m[1][1] - A.m[0][1] * A.m[1][0];
+			}
+		};
+
+		template<typename T>
+		struct MatrixDeterminant<3, T> {
+			static constexpr T Apply(const TMatrix<3, 3, T>& A) {
+				const auto& m = A.m;
+				return m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1])
+					- m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0])
+					+ m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+			}
+		};
+
+		template<typename T>
+		struct MatrixDeterminant<4, T> {
+			static constexpr T Apply(const TMatrix<4, 4, T>& A) {
+				const auto& m = A.m;
+				// Menores 2x2 de las dos ltimas filas, compartidos por los cuatro cofactores.
+				const T S0 = m[2][2] * m[3][3] - m[2][3] * m[3][2];
+				const T S1 = m[2][1] * m[3][3] - m[2][3] * m[3][1];
+				const T S2 = m[2][1] * m[3][2] - m[2][2] * m[3][1];
+				const T S3 = m[2][0] * m[3][3] - m[2][3] * m[3][0];
+				const T S4 = m[2][0] * m[3][2] - m[2][2] * m[3][0];
+				const T S5 = m[2][0] * m[3][1] - m[2][1] * m[3][0];
+				return m[0][0] * (m[1][1] * S0 - m[1][2] * S1 + m[1][3] * S2)
+					- m[0][1] * (m[1][0] * S0 - m[1][2] * S3 + m[1][3] * S4)
+					+ m[0][2] * (m[1][0] * S1 - m[1][1] * S3 + m[1][3] * S5)
+					- m[0][3] * (m[1][0] * S2 - m[1][1] * S4 + m[1][2] * S5);
+			}
+		};
+
+		template<typename T>
+		constexpr T Identity(size_t I, size_t Cols) {
+			return I / Cols == I % Cols ? T(1) : T(0);
+		}
+	}
+
+	/**
+	 * @brief Matriz de `Rows` x `Cols` elementos de tipo `T`, en filas.
+	 *
+	 * El constructor por defecto da la identidad (ceros fuera de la diagonal si no es
+	 * cuadrada), como las matrices anteriores de la librera. El constructor con
+	 * `Rows * Cols` valores los toma fila a fila.
+	 */
+	template<size_t Rows, size_t Cols, typename T = float>
+	class TMatrix {
+	public:
+		T m[Rows][Cols]; /**< Elementos: `m[fila][columna]`. */
+
+		/** @brief Identidad. */
+		constexpr TMatrix() : TMatrix(std::make_index_sequence<Rows * Cols>()) {}
+
+		/**
+		 * @brief Elementos fila a fila: `Matrix2x2(a11, a12, a21, a22)`.
+		 */
+		template<typename... Values,
+			typename = typename std::enable_if<sizeof...(Values) == Rows * Cols && (Rows * Cols > 1)>::type>
+		constexpr TMatrix(Values... values) : m{ static_cast<T>(values)... } {}
+
+		/** @brief Matriz de ceros. */
+		static constexpr TMatrix Zero() { return Fill(T(0), std::make_index_sequence<Rows * Cols>()); }
+
+		/** @brief Identidad (igual que el constructor por defecto). */
+		static constexpr TMatrix Identity() { return TMatrix(); }
+
+		constexpr T& operator()(size_t Row, size_t Col) { return m[Row][Col]; }
+		constexpr const T& operator()(size_t Row, size_t Col) const { return m[Row][Col]; }
+
+		/** @brief Suma elemento a elemento. */
+		constexpr TMatrix operator+(const TMatrix& other) const {
+			return Add(other, std::make_index_sequence<Rows * Cols>());
+		}
+
+		/** @brief Resta elemento a elemento. */
+		constexpr TMatrix operator-(const TMatrix& other) const {
+			return Sub(other, std::make_index_sequence<Rows * Cols>());
+		}
+
+		/** @brief Multiplica cada elemento por `scalar`. */
+		constexpr TMatrix operator*(T scalar) const {
+			return Scale(scalar, std::make_index_sequence<Rows * Cols>());
+		}
+
+		/**
+		 * @brief Producto `this * other`.
+		 * @note 4x4 float usa los ncleos SIMD (no `constexpr`).
+		 */
+		template<size_t K>
+		constexpr TMatrix<Rows, K, T> operator*(const TMatrix<Cols, K, T>& other) const {
+			return Detail::MatrixProduct<Rows, Cols, K, T>::Apply(*this, other);
+		}
+
+		constexpr bool operator==(const TMatrix& other) const { return Equal(other, 0); }
+		constexpr bool operator!=(const TMatrix& other) const { return !(*this == other); }
+
+		/** @brief Filas por columnas. */
+		constexpr TMatrix<Cols, Rows, T> transpose() const {
+			return Detail::MatrixTranspose<Rows, Cols, T>::Apply(*this);
+		}
+
+		/** @brief Determinante (2x2, 3x3 y 4x4). */
+		constexpr T determinant() const {
+			static_assert(Rows == Cols, "determinant() needs a square matrix");
+			return Detail::MatrixDeterminant<Rows, T>::Apply(*this);
+		}
+
+		/**
+		 * @brief Inversa (2x2, 3x3 y 4x4 float); la identidad si la matriz es singular.
+		 */
+		constexpr TMatrix inverse() const {
+			static_assert(Rows == Cols, "inverse() needs a square matrix");
+			return Detail::MatrixInverse<Rows, T>::Apply(*this);
+		}
+
+		// ==== Solo 4x4 float: transformaciones con los ncleos SIMD ====
+
+		/** @brief Transforma un punto (w = 1) y divide por la w resultante. */
+		Vector3 transformPoint(const Vector3& point) const {
+			static_assert(Rows == 4 && Cols == 4 && std::is_same<T, float>::value, "4x4 float only");
+			Vector3 result;
+			GetMatrixKernels().TransformPoints(&m[0][0], point.data(), result.data(), 1);
+			return result;
+		}
+
+		/** @brief Transforma un vector 4D (sin dividir por w). */
+		Vector4 transform(const Vector4& vector) const {
+			static_assert(Rows == 4 && Cols == 4 && std::is_same<T, float>::value, "4x4 float only");
+			Vector4 result;
+			GetMatrixKernels().TransformVectors4(&m[0][0], vector.data(), result.data(), 1);
+			return result;
+		}
+
+		/**
+		 * @brief Como transformPoint() en cada punto del array.
+		 * @param output Puede ser el mismo array que `input`.
+		 */
+		void transformPoints(const Vector3* input, Vector3* output, size_t count) const {
+			static_assert(Rows == 4 && Cols == 4 && std::is_same<T, float>::value, "4x4 float only");
+			static_assert(sizeof(Vector3) == 3 * sizeof(float), "Vector3 must be tightly packed");
+			GetMatrixKernels().TransformPoints(&m[0][0], reinterpret_cast<const float*>(input),
+				reinterpret_cast<float*>(output), count);
+		}
+
+		/**
+		 * @brief Como transform() en cada vector del array.
+		 * @param output Puede ser el mismo array que `input`.
+		 */
+		void transformVectors(const Vector4* input, Vector4* output, size_t count) const {
+			static_assert(Rows == 4 && Cols == 4 && std::is_same<T, float>::value, "4x4 float only");
+			static_assert(sizeof(Vector4) == 4 * sizeof(float), "Vector4 must be tightly packed");
+			GetMatrixKernels().TransformVectors4(&m[0][0], reinterpret_cast<const float*>(input),
+				reinterpret_cast<float*>(output), count);
+		}
+
+	private:
+		template<size_t... I>
+		constexpr explicit TMatrix(std::index_sequence<I...>) : m{ Detail::Identity<T>(I, Cols)... } {}
+
+		template<size_t... I>
+		static constexpr TMatrix Fill(T value, std::index_sequence<I...>) {
+			return TMatrix(((void)I, value)...);
+		}
+
+		template<size_t... I>
+		constexpr TMatrix Add(const TMatrix& o, std::index_sequence<I...>) const {
+			return TMatrix((m[I / Cols][I % Cols] + o.m[I / Cols][I % Cols])...);
+		}
+
+		template<size_t... I>
+		constexpr TMatrix Sub(const TMatrix& o, std::index_sequence<I...>) const {
+			return TMatrix((m[I / Cols][I % Cols] - o.m[I / Cols][I % Cols])...);
+		}
+
+		template<size_t... I>
+		constexpr TMatrix Scale(T s, std::index_sequence<I...>) const {
+			return TMatrix((m[I / Cols][I % Cols] * s)...);
+		}
+
+		constexpr bool Equal(const TMatrix& o, size_t I) const {
+			return I == Rows * Cols || (m[I / Cols][I % Cols] == o.m[I / Cols][I % Cols] && Equal(o, I + 1));
+		}
+	};
+
+	namespace Detail {
+		/// Suma de `V[k] * A[k][C]` para `k < K`.
+		template<size_t C, size_t K>
+		struct VectorColumn {
+			template<typename V, typename M>
+			static constexpr auto Dot(const V& Vec, const M& A) -> decltype(Vec.v[0] * A.m[0][0]) {
+				return VectorColumn<C, K - 1>::Dot(Vec, A) + Vec.v[K - 1] * A.m[K - 1][C];
+			}
+		};
+
+		template<size_t C>
+		struct VectorColumn<C, 1> {
+			template<typename V, typename M>
+			static constexpr auto Dot(const V& Vec, const M& A) -> decltype(Vec.v[0] * A.m[0][0]) {
+				return Vec.v[0] * A.m[0][C];
+			}
+		};
+
+		template<size_t R, size_t C, typename T, size_t... I>
+		constexpr TVector<C, T> RowTimesMatrix(const TVector<R, T>& V, const TMatrix<R, C, T>& A,
+			std::index_sequence<I...>) {
+			return TVector<C, T>{ { VectorColumn<I, R>::Dot(V, A)... } };
+		}
+	}
+
+	/**
+	 * @brief Vector fila por matriz: `V * A` (convencin de DirectX).
+	 */
+	template<size_t R, size_t C, typename T>
+	constexpr TVector<C, T> operator*(const TVector<R, T>& V, const TMatrix<R, C, T>& A) {
+		return Detail::RowTimesMatrix(V, A, std::make_index_sequence<C>());
+	}
+
+	// ==== 4x4 float: los ncleos SIMD ====
+
+	namespace Detail {
+		template<>
+		struct MatrixProduct<4, 4, 4, float> {
+			static TMatrix<4, 4, float> Apply(const TMatrix<4, 4, float>& A, const TMatrix<4, 4, float>& B) {
+				TMatrix<4, 4, float> Result;
+				GetMatrixKernels().Multiply(&A.m[0][0], &B.m[0][0], &Result.m[0][0]);
+				return Result;
+			}
+		};
+
+		template<>
+		struct MatrixTranspose<4, 4, float> {
+			static TMatrix<4, 4, float> Apply(const TMatrix<4, 4, float>& A) {
+				TMatrix<4, 4, float> Result;
+				GetMatrixKernels().Transpose(&A.m[0][0], &Result.m[0][0]);
+				return Result;
+			}
+		};
+
+		template<>
+		struct MatrixInverse<4, float> {
+			static TMatrix<4, 4, float> Apply(const TMatrix<4, 4, float>& A) {
+				TMatrix<4, 4, float> Result;
+				GetMatrixKernels().Inverse(&A.m[0][0], &Result.m[0][0]);
+				return Result;
+			}
+		};
+	}
+
+	// ==== Constantes 4x4 que se pueden calcular al compilar ====
+
+	/** @brief Traslacin (fila 4). */
+	constexpr TMatrix<4, 4, float> Translation(float X, float Y, float Z) {
+		return TMatrix<4, 4, float>(
+			1, 0, 0, 0,
+			0, 1, 0, 0,
+			0, 0, 1, 0,
+			X, Y, Z, 1);
+	}
+
+	/** @brief Escala por eje. */
+	constexpr TMatrix<4, 4, float> Scaling(float X, float Y, float Z) {
+		return TMatrix<4, 4, float>(
+			X, 0, 0, 0,
+			0, Y, 0, 0,
+			0, 0, Z, 0,
+			0, 0, 0, 1);
+	}
+
+	/**
+	 * @brief Proyeccin ortogrfica de mano izquierda (como `XMMatrixOrthographicLH`).
+	 * @param Width,Height Tamao del volumen visible.
+	 * @param NearZ,FarZ Planos cercano y lejano.
+	 */
+	constexpr TMatrix<4, 4, float> OrthographicLH(float Width, float Height, float NearZ, float FarZ) {
+		return TMatrix<4, 4, float>(
+			2.0f / Width, 0, 0, 0,
+			0, 2.0f / Height, 0, 0,
+			0, 0, 1.0f / (FarZ - NearZ), 0,
+			0, 0, -NearZ / (FarZ - NearZ), 1);
+	}
+
+	/**
+	 * @brief Perspectiva de mano izquierda (como `XMMatrixPerspectiveLH`).
+	 * @param Width,Height Tamao de la ventana en el plano cercano.
+	 * @param NearZ,FarZ Planos cercano y lejano.
+	 * @note A partir del campo de visin hace falta `tan`, que no es `constexpr`.
+	 */
+	constexpr TMatrix<4, 4, float> PerspectiveLH(float Width, float Height, float NearZ, float FarZ) {
+		return TMatrix<4, 4, float>(
+			2.0f * NearZ / Width, 0, 0, 0,
+			0, 2.0f * NearZ / Height, 0, 0,
+			0, 0, FarZ / (FarZ - NearZ), 1,
+			0, 0, -NearZ * FarZ / (FarZ - NearZ), 0);
+	}
+}
@@ -0,0 +1,209 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Roberto Charreton
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * In addition, any project or software that uses this library or class must include
+ * the following acknowledgment in the credits:
+ *
+ * "This project uses software developed by Roberto Charreton and Attribute Overload."
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <type_traits>
+#if defined(_MSC_VER)
+#include <malloc.h>
+#endif
+
+namespace EU {
+	/**
+	 * @brief Reserva alineada del montn (la comn a todos los asignadores).
+	 */
+	inline void* AlignedAlloc(size_t Bytes, size_t Alignment) {
+#if defined(_MSC_VER)
+		return _aligned_malloc(Bytes, Alignment);
+#else
+		return ::aligned_alloc(Alignment, (Bytes + Alignment - 1) / Alignment * Alignment);
+#endif
+	}
+
+	inline void AlignedFree(void* Ptr) {
+#if defined(_MSC_VER)
+		_aligned_free(Ptr);
+#else
+		::free(Ptr);
+#endif
+	}
+
+	/**
+	 * @brief Asignador por defecto de los contenedores: memoria del montn.
+	 *
+	 * Un asignador es un objeto que vive dentro del contenedor y ofrece:
+	 * - `Allocate(Bytes, Alignment)` / `Deallocate(Ptr, Bytes)`.
+	 * - `CanSteal(Ptr)`: si un bloque suyo puede pasar a otro contenedor al moverlo
+	 *   (`false` para memoria que vive dentro del propio asignador).
+	 */
+	class HeapAllocator {
+	public:
+		void* Allocate(size_t Bytes, size_t Alignment) { return AlignedAlloc(Bytes, Alignment); }
+		void Deallocate(void* Ptr, size_t) { AlignedFree(Ptr); }
+		bool CanSteal(const void*) const { return true; }
+	};
+
+	/**
+	 * @brief Bloque de memoria lineal: reservar es sumar un desplazamiento y se libera
+	 * todo de golpe con @ref Reset (p. ej. una vez por frame).
+	 *
+	 * @note Para estudiantes: no llama destructores. Los contenedores que lo usen deben
+	 * destruirse (o vaciarse) antes del `Reset`.
+	 */
+	class LinearArena {
+	public:
+		explicit LinearArena(size_t Bytes)
+			: Buffer(static_cast<unsigned char*>(AlignedAlloc(Bytes, 64))), Capacity(Buffer ? Bytes : 0), Offset(0),
+			Peak(0), Failures(0) {}
+		~LinearArena() { AlignedFree(Buffer); }
+		LinearArena(const LinearArena&) = delete;
+		LinearArena& operator=(const LinearArena&) = delete;
+
+		/**
+		 * @brief Reserva `Bytes` alineados.
+		 * @return El bloque, o `nullptr` si no cabe (el arena no crece).
+		 */
+		void* Allocate(size_t Bytes, size_t Alignment) {
+			const size_t Start = (Offset + Alignment - 1) & ~(Alignment - 1);
+			if (!Buffer || Start + Bytes > Capacity) {
+				++Failures;
+				return nullptr;
+			}
+			Offset = Start + Bytes;
+			Peak = Offset > Peak ? Offset : Peak;
+			return Buffer + Start;
+		}
+
+		/**
+		 * @brief Devuelve el bloque solo si es el ltimo reservado (lo habitual al crecer un
+		 * array); cualquier otro se recupera en el siguiente @ref Reset.
+		 */
+		void Deallocate(void* Ptr, size_t Bytes) {
+			if (static_cast<unsigned char*>(Ptr) + Bytes == Buffer + Offset) {
+				Offset = static_cast<size_t>(static_cast<unsigned char*>(Ptr) - Buffer);
+			}
+		}
+
+		/** @brief `true` si `Ptr` apunta a lo ya reservado del arena. */
+		bool Owns(const void* Ptr) const {
+			const unsigned char* Bytes = static_cast<const unsigned char*>(Ptr);
+			return Buffer && Bytes >= Buffer && Bytes < Buffer + Offset;
+		}
+
+		/** @brief Libera todo lo reservado. */
+		void Reset() { Offset = 0; }
+
+		/** @brief Libera lo reservado despus de `Mark` (un @ref GetUsed anterior). */
+		void Rewind(size_t Mark) { Offset = Mark < Offset ? Mark : Offset; }
+
+		size_t GetUsed() const { return Offset; }
+		size_t GetCapacity() const { return Capacity; }
+
+		/** @brief Mayor ocupacin desde la creacin. */
+		size_t GetPeak() const { return Peak; }
+
+		/** @brief Reservas que no cupieron (sus dueos tiraron del montn). */
+		size_t GetFailures() const { return Failures; }
+
+	private:
+		unsigned char* Buffer;
+		size_t Capacity;
+		size_t Offset;
+		size_t Peak;
+		size_t Failures;
+	};
+
+	/**
+	 * @brief Asignador que reserva de un @ref LinearArena; si no cabe, del montn.
+	 */
+	class ArenaAllocator {
+	public:
+		ArenaAllocator() : Arena(nullptr) {}
+		explicit ArenaAllocator(LinearArena& InArena) : Arena(&InArena) {}
+
+		void* Allocate(size_t Bytes, size_t Alignment) {
+			void* Ptr = Arena ? Arena->Allocate(Bytes, Alignment) : nullptr;
+			return Ptr ? Ptr : AlignedAlloc(Bytes, Alignment);
+		}
+
+		void Deallocate(void* Ptr, size_t Bytes) {
+			if (Arena && Arena->Owns(Ptr)) {
+				Arena->Deallocate(Ptr, Bytes);
+			}
+			else {
+				AlignedFree(Ptr);
+			}
+		}
+
+		bool CanSteal(const void*) const { return true; }
+
+	private:
+		LinearArena* Arena;
+	};
+
+	/**
+	 * @brief Asignador con sitio para `InlineBytes` dentro del propio contenedor; lo que
+	 * no cabe va al montn.
+	 *
+	 * til para listas que casi siempre son cortas (p. ej. submallas o texturas de un
+	 * actor): sin reserva alguna en el caso comn.
+	 */
+	template<size_t InlineBytes, size_t InlineAlignment = 16>
+	class TInlineAllocator {
+	public:
+		TInlineAllocator() : InUse(false) {}
+		TInlineAllocator(const TInlineAllocator&) : InUse(false) {}
+		TInlineAllocator& operator=(const TInlineAllocator&) { return *this; }
+
+		void* Allocate(size_t Bytes, size_t Alignment) {
+			if (!InUse && Bytes <= InlineBytes && Alignment <= InlineAlignment) {
+				InUse = true;
+				return &Storage;
+			}
+			return AlignedAlloc(Bytes, Alignment);
+		}
+
+		void Deallocate(void* Ptr, size_t) {
+			if (Ptr == &Storage) {
+				InUse = false;
+			}
+			else {
+				AlignedFree(Ptr);
+			}
+		}
+
+		/// El bloque interno no puede pasar a otro contenedor: al mover se mueven los elementos.
+		bool CanSteal(const void* Ptr) const { return Ptr != &Storage; }
+
+	private:
+		typename std::aligned_storage<InlineBytes, InlineAlignment>::type Storage;
+		bool InUse;
+	};
+}
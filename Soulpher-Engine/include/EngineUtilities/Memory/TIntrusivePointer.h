@@ -0,0 +1,125 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Roberto Charreton
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * In addition, any project or software that uses this library or class must include
+ * the following acknowledgment in the credits:
+ *
+ * "This project uses software developed by Roberto Charreton and Attribute Overload."
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#pragma once
+#include "TSharedPointer.h"
+
+namespace EU {
+	/**
+	 * @brief Base de los objetos con recuento intrusivo (el contador vive en el objeto).
+	 *
+	 * Frente a TSharedPointer no hay bloque de control: el puntero ocupa 8 bytes, el
+	 * recuento est junto a los datos del objeto y un `T*` crudo se puede volver a
+	 * envolver en un TIntrusivePointer sin perder la cuenta (til para objetos del motor
+	 * que se pasan como punteros crudos, p. ej. en los draw packets).
+	 *
+	 * @tparam Policy @ref SingleThreadRefCount o @ref AtomicRefCount.
+	 *
+	 * @note El objeto se destruye con `delete` al llegar a cero: cralo con `new`.
+	 */
+	template<typename Policy = SingleThreadRefCount>
+	class TRefCounted {
+	public:
+		void addRef() const { Policy::increment(m_refCount); }
+
+		void release() const {
+			if (Policy::decrement(m_refCount)) {
+				delete this;
+			}
+		}
+
+		/** @brief Referencias actuales. */
+		int getRefCount() const { return Policy::load(m_refCount); }
+
+	protected:
+		TRefCounted() = default;
+		// Copiar un objeto no copia sus referencias.
+		TRefCounted(const TRefCounted&) {}
+		TRefCounted& operator=(const TRefCounted&) { return *this; }
+		virtual ~TRefCounted() = default;
+
+	private:
+		mutable typename Policy::Counter m_refCount{ 0 };
+	};
+
+	/**
+	 * @brief Puntero a un objeto derivado de TRefCounted: suma y resta en el propio objeto.
+	 */
+	template<typename T>
+	class TIntrusivePointer {
+	public:
+		TIntrusivePointer() : ptr(nullptr) {}
+
+		/**
+		 * @brief Toma una referencia al objeto (tambin si ya la tenan otros punteros).
+		 */
+		TIntrusivePointer(T* rawPtr) : ptr(rawPtr) {
+			if (ptr) { ptr->addRef(); }
+		}
+
+		TIntrusivePointer(const TIntrusivePointer& other) : TIntrusivePointer(other.ptr) {}
+
+		TIntrusivePointer(TIntrusivePointer&& other) noexcept : ptr(other.ptr) { other.ptr = nullptr; }
+
+		~TIntrusivePointer() {
+			if (ptr) { ptr->release(); }
+		}
+
+		TIntrusivePointer& operator=(const TIntrusivePointer& other) {
+			TIntrusivePointer(other).swap(*this);
+			return *this;
+		}
+
+		TIntrusivePointer& operator=(TIntrusivePointer&& other) noexcept {
+			TIntrusivePointer(std::move(other)).swap(*this);
+			return *this;
+		}
+
+		T& operator*() const { return *ptr; }
+		T* operator->() const { return ptr; }
+		operator bool() const { return ptr != nullptr; }
+		T* get() const { return ptr; }
+		bool isNull() const { return ptr == nullptr; }
+
+		void swap(TIntrusivePointer& other) noexcept { std::swap(ptr, other.ptr); }
+
+		void reset(T* newPtr = nullptr) { TIntrusivePointer(newPtr).swap(*this); }
+
+	private:
+		T* ptr; ///< Objeto apuntado (con una referencia de este puntero).
+	};
+
+	/**
+	 * @brief Crea un objeto con recuento intrusivo y devuelve el primer puntero.
+	 */
+	template<typename T, typename... Args>
+	TIntrusivePointer<T> MakeIntrusive(Args&&... args)
+	{
+		return TIntrusivePointer<T>(new T(std::forward<Args>(args)...));
+	}
+}
@@ -0,0 +1,243 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Roberto Charreton
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * In addition, any project or software that uses this library or class must include
+ * the following acknowledgment in the credits:
+ *
+ * "This project uses software developed by Roberto Charreton and Attribute Overload."
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#pragma once
+#include <cstddef>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+#include "TAllocators.h"
+
+namespace EU {
+	/**
+	 * @brief Pool de bloques de tamao fijo para objetos de vida larga que se crean y
+	 * destruyen a menudo (componentes, bloques de `MakeShared`).
+	 *
+	 * - **Pginas** de `BlocksPerPage` bloques alineados a `Alignment` (64 por defecto: cada
+	 *   bloque empieza en su propia lnea de cach). Las pginas no se devuelven hasta
+	 *   destruir el pool: la rotacin de objetos no fragmenta el montn general.
+	 * - **Lista libre intrusiva**: un bloque libre guarda en sus primeros bytes el puntero
+	 *   al siguiente; no hay memoria aparte para llevar la cuenta.
+	 * - **Cach por hilo** (@ref Cache): cada hilo reserva y libera en su propia lista sin
+	 *   locks; solo cuando se vaca (o crece demasiado) mueve un lote de @ref kBatchBlocks
+	 *   bloques con la lista global, bajo un mutex.
+	 *
+	 * Se usa a travs de @ref TBlockPool (un pool por tamao de bloque) y @ref TUsePool.
+	 *
+	 * @note Para estudiantes: un bloque liberado en otro hilo va a la cach de ese hilo;
+	 * los bloques son intercambiables, as que da igual quin lo reserv.
+	 */
+	class FixedBlockPool {
+		struct FreeBlock {
+			FreeBlock* Next;
+		};
+
+	public:
+		/// Bloques que se mueven de una vez entre una cach de hilo y la lista global.
+		static const size_t kBatchBlocks = 32;
+
+		explicit FixedBlockPool(size_t InBlockBytes, size_t InAlignment = 64, size_t InBlocksPerPage = 256)
+			: Alignment(InAlignment < alignof(FreeBlock) ? alignof(FreeBlock) : InAlignment),
+			BlockBytes(RoundUp(InBlockBytes < sizeof(FreeBlock) ? sizeof(FreeBlock) : InBlockBytes, Alignment)),
+			BlocksPerPage(InBlocksPerPage), GlobalHead(nullptr) {}
+
+		~FixedBlockPool() {
+			for (void* Page : Pages) {
+				AlignedFree(Page);
+			}
+		}
+
+		FixedBlockPool(const FixedBlockPool&) = delete;
+		FixedBlockPool& operator=(const FixedBlockPool&) = delete;
+
+		/**
+		 * @brief Lista libre de un hilo; al terminar el hilo vuelve entera a la global.
+		 */
+		class Cache {
+		public:
+			explicit Cache(FixedBlockPool& InPool) : Pool(InPool), Head(nullptr), Count(0) {}
+			~Cache() { Pool.PushGlobal(Head); }
+			Cache(const Cache&) = delete;
+			Cache& operator=(const Cache&) = delete;
+
+			/** @brief Un bloque sin construir, o `nullptr` si no queda memoria. */
+			void* Allocate() {
+				if (!Head) {
+					Count = Pool.PopGlobal(Head);
+					if (!Head) {
+						return nullptr;
+					}
+				}
+				FreeBlock* Block = Head;
+				Head = Block->Next;
+				--Count;
+				return Block;
+			}
+
+			/** @brief Devuelve un bloque ya destruido. */
+			void Deallocate(void* Ptr) {
+				FreeBlock* Block = static_cast<FreeBlock*>(Ptr);
+				Block->Next = Head;
+				Head = Block;
+				if (++Count >= 2 * kBatchBlocks) {
+					// Se queda con un lote y pasa el resto a la global.
+					FreeBlock* Last = Head;
+					for (size_t i = 1; i < kBatchBlocks; ++i) {
+						Last = Last->Next;
+					}
+					Pool.PushGlobal(Last->Next);
+					Last->Next = nullptr;
+					Count = kBatchBlocks;
+				}
+			}
+
+		private:
+			FixedBlockPool& Pool;
+			FreeBlock* Head;
+			size_t Count;
+		};
+
+		size_t GetBlockSize() const { return BlockBytes; }
+		size_t GetAlignment() const { return Alignment; }
+
+		/** @brief Memoria reservada en pginas (bloques vivos y libres). */
+		size_t GetReservedBytes() {
+			std::lock_guard<std::mutex> Lock(Mutex);
+			return Pages.size() * BlocksPerPage * BlockBytes;
+		}
+
+	private:
+		static size_t RoundUp(size_t Value, size_t Multiple) {
+			return (Value + Multiple - 1) / Multiple * Multiple;
+		}
+
+		/// Saca hasta un lote de la lista global (aade una pgina si est vaca).
+		size_t PopGlobal(FreeBlock*& OutHead) {
+			std::lock_guard<std::mutex> Lock(Mutex);
+			if (!GlobalHead && !AddPage()) {
+				OutHead = nullptr;
+				return 0;
+			}
+			OutHead = GlobalHead;
+			FreeBlock* Last = GlobalHead;
+			size_t Count = 1;
+			while (Count < kBatchBlocks && Last->Next) {
+				Last = Last->Next;
+				++Count;
+			}
+			GlobalHead = Last->Next;
+			Last->Next = nullptr;
+			return Count;
+		}
+
+		/// Encadena una lista terminada en `nullptr` delante de la global.
+		void PushGlobal(FreeBlock* First) {
+			if (!First) {
+				return;
+			}
+			FreeBlock* Last = First;
+			while (Last->Next) {
+				Last = Last->Next;
+			}
+			std::lock_guard<std::mutex> Lock(Mutex);
+			Last->Next = GlobalHead;
+			GlobalHead = First;
+		}
+
+		/// Reserva una pgina y encadena sus bloques en orden de direccin (con `Mutex` tomado).
+		bool AddPage() {
+			unsigned char* Page = static_cast<unsigned char*>(AlignedAlloc(BlockBytes * BlocksPerPage, Alignment));
+			if (!Page) {
+				return false;
+			}
+			Pages.push_back(Page);
+			for (size_t i = BlocksPerPage; i-- > 0;) {
+				FreeBlock* Block = reinterpret_cast<FreeBlock*>(Page + i * BlockBytes);
+				Block->Next = GlobalHead;
+				GlobalHead = Block;
+			}
+			return true;
+		}
+
+		const size_t Alignment;
+		const size_t BlockBytes;
+		const size_t BlocksPerPage;
+		std::mutex Mutex;
+		FreeBlock* GlobalHead;
+		std::vector<void*> Pages;
+	};
+
+	/**
+	 * @brief Pool del proceso para bloques de `BlockBytes` (uno por tamao y alineacin).
+	 *
+	 * @note La cach de cada hilo es un `thread_local`. Los del hilo principal se destruyen
+	 * antes que los estticos, as que una cach siempre vuelve a un pool vivo.
+	 */
+	template<size_t BlockBytes, size_t Alignment = 64>
+	class TBlockPool {
+	public:
+		static FixedBlockPool& Get() {
+			static FixedBlockPool Pool(BlockBytes, Alignment);
+			return Pool;
+		}
+
+		static void* Allocate() { return LocalCache().Allocate(); }
+		static void Deallocate(void* Ptr) { LocalCache().Deallocate(Ptr); }
+
+	private:
+		static FixedBlockPool::Cache& LocalCache() {
+			static thread_local FixedBlockPool::Cache Cache(Get());
+			return Cache;
+		}
+	};
+
+	/**
+	 * @brief Pool con bloques del tamao de `T` redondeado a su alineacin (mnimo 64):
+	 * tipos de tamao parecido comparten pool.
+	 */
+	template<typename T>
+	struct TObjectPool {
+		static const size_t Alignment = alignof(T) > 64 ? alignof(T) : 64;
+		typedef TBlockPool<(sizeof(T) + Alignment - 1) / Alignment * Alignment, Alignment> Pool;
+
+		static void* Allocate() { return Pool::Allocate(); }
+		static void Deallocate(void* Ptr) { Pool::Deallocate(Ptr); }
+	};
+
+	/**
+	 * @brief Hace que `MakeShared<T>` reserve objeto y recuento de un @ref TObjectPool en
+	 * lugar del montn.
+	 *
+	 * Se especializa junto al tipo, para los que se crean y destruyen a menudo:
+	 * @code
+	 * namespace EU { template<> struct TUsePool<Transform> : std::true_type {}; }
+	 * @endcode
+	 */
+	template<typename T>
+	struct TUsePool : std::false_type {};
+}
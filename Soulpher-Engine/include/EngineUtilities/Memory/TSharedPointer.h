@@ -27,147 +27,293 @@
  * SOFTWARE.
 */
 #pragma once
+#include <atomic>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "TPoolAllocator.h"
 
 namespace EU {
+	/**
+	 * @brief Poltica de recuento sin atmicos (la de siempre).
+	 *
+	 * Es la ms barata, pero el puntero y sus copias solo se pueden tocar desde un hilo
+	 * a la vez. Para compartir entre hilos (p. ej. trabajos del `JobSystem`) usar
+	 * @ref AtomicRefCount.
+	 */
+	struct SingleThreadRefCount {
+		typedef int Counter;
+
+		static void increment(Counter& count) { ++count; }
+
+		/// @return true si el recuento lleg a cero.
+		static bool decrement(Counter& count) { return --count == 0; }
+
+		/// Incrementa salvo que ya sea cero (para `TWeakPointer::lock`).
+		static bool incrementIfNotZero(Counter& count) {
+			if (count == 0) { return false; }
+			++count;
+			return true;
+		}
+
+		static int load(const Counter& count) { return count; }
+	};
+
+	/**
+	 * @brief Poltica de recuento atmica: copias y destrucciones seguras desde varios hilos.
+	 *
+	 * @note El incremento es `relaxed` (quien copia ya tiene una referencia); el decremento
+	 * es `acq_rel` para que el hilo que destruye vea todas las escrituras de los dems.
+	 */
+	struct AtomicRefCount {
+		typedef std::atomic<int> Counter;
+
+		static void increment(Counter& count) { count.fetch_add(1, std::memory_order_relaxed); }
+
+		static bool decrement(Counter& count) { return count.fetch_sub(1, std::memory_order_acq_rel) == 1; }
+
+		static bool incrementIfNotZero(Counter& count) {
+			int current = count.load(std::memory_order_relaxed);
+			while (current != 0) {
+				if (count.compare_exchange_weak(current, current + 1, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+					return true;
+				}
+			}
+			return false;
+		}
+
+		static int load(const Counter& count) { return count.load(std::memory_order_acquire); }
+	};
+
+	/**
+	 * @brief Bloque de control de un TSharedPointer: recuentos y cmo destruir el objeto.
+	 *
+	 * `weak` cuenta los TWeakPointer ms uno mientras quede algn puntero fuerte; el
+	 * objeto se destruye cuando `strong` llega a cero y el bloque cuando lo hace `weak`.
+	 */
+	template<typename Policy>
+	struct TRefBlock {
+		typename Policy::Counter strong{ 1 };
+		typename Policy::Counter weak{ 1 };
+		void (*destroyObject)(TRefBlock*) = nullptr;
+		void (*freeBlock)(TRefBlock*) = nullptr;
+
+		void addRef() { Policy::increment(strong); }
+
+		void release() {
+			if (Policy::decrement(strong)) {
+				destroyObject(this);
+				releaseWeak();
+			}
+		}
+
+		void releaseWeak() {
+			if (Policy::decrement(weak)) {
+				freeBlock(this);
+			}
+		}
+	};
+
+	/**
+	 * @brief Bloque de un objeto creado aparte (constructor desde puntero crudo): dos reservas.
+	 */
+	template<typename T, typename Policy>
+	struct TPointerRefBlock : TRefBlock<Policy> {
+		T* object;
+
+		explicit TPointerRefBlock(T* rawPtr) : object(rawPtr) {
+			this->destroyObject = &TPointerRefBlock::destroy;
+			this->freeBlock = &TPointerRefBlock::free;
+		}
+
+		static void destroy(TRefBlock<Policy>* block) { delete static_cast<TPointerRefBlock*>(block)->object; }
+		static void free(TRefBlock<Policy>* block) { delete static_cast<TPointerRefBlock*>(block); }
+	};
+
+	/**
+	 * @brief Bloque de un objeto con un borrador propio (p. ej. liberar recursos de GPU
+	 * antes del `delete`).
+	 */
+	template<typename T, typename Policy, typename Deleter>
+	struct TDeleterRefBlock : TRefBlock<Policy> {
+		T* object;
+		Deleter deleter;
+
+		TDeleterRefBlock(T* rawPtr, Deleter d) : object(rawPtr), deleter(std::move(d)) {
+			this->destroyObject = &TDeleterRefBlock::destroy;
+			this->freeBlock = &TDeleterRefBlock::free;
+		}
+
+		static void destroy(TRefBlock<Policy>* block) {
+			TDeleterRefBlock* self = static_cast<TDeleterRefBlock*>(block);
+			self->deleter(self->object);
+		}
+		static void free(TRefBlock<Policy>* block) { delete static_cast<TDeleterRefBlock*>(block); }
+	};
+
+	/**
+	 * @brief Bloque con el objeto dentro (MakeShared): una sola reserva y una lnea de cach
+	 * para el recuento y el principio del objeto.
+	 */
+	template<typename T, typename Policy>
+	struct TInlineRefBlock : TRefBlock<Policy> {
+		typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+
+		TInlineRefBlock() {
+			this->destroyObject = &TInlineRefBlock::destroy;
+			this->freeBlock = &TInlineRefBlock::free;
+		}
+
+		T* object() { return reinterpret_cast<T*>(&storage); }
+
+		static void destroy(TRefBlock<Policy>* block) { static_cast<TInlineRefBlock*>(block)->object()->~T(); }
+		static void free(TRefBlock<Policy>* block) { delete static_cast<TInlineRefBlock*>(block); }
+	};
+
+	/**
+	 * @brief Como @ref TInlineRefBlock, pero el bloque sale de un @ref TObjectPool
+	 * (tipos marcados con @ref TUsePool).
+	 */
+	template<typename T, typename Policy>
+	struct TPooledRefBlock : TRefBlock<Policy> {
+		typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+
+		TPooledRefBlock() {
+			this->destroyObject = &TPooledRefBlock::destroy;
+			this->freeBlock = &TPooledRefBlock::free;
+		}
+
+		T* object() { return reinterpret_cast<T*>(&storage); }
+
+		static void destroy(TRefBlock<Policy>* block) { static_cast<TPooledRefBlock*>(block)->object()->~T(); }
+		static void free(TRefBlock<Policy>* block) {
+			TPooledRefBlock* self = static_cast<TPooledRefBlock*>(block);
+			self->~TPooledRefBlock();
+			TObjectPool<TPooledRefBlock>::Deallocate(self);
+		}
+	};
+
 	/**
 	 * @brief Clase TSharedPointer para manejar la gestin de memoria compartida.
 	 *
 	 * La clase TSharedPointer gestiona la memoria de un objeto de tipo T y lleva un
 	 * recuento de referencias para permitir la comparticin segura de un mismo objeto
 	 * en mltiples instancias de TSharedPointer.
+	 *
+	 * @tparam T Tipo del objeto gestionado.
+	 * @tparam Policy Recuento: @ref SingleThreadRefCount (por defecto) o @ref AtomicRefCount
+	 * (ver @ref TAtomicSharedPointer).
 	 */
-	template<typename T>
+	template<typename T, typename Policy = SingleThreadRefCount>
 	class TSharedPointer
 	{
 	public:
+		typedef TRefBlock<Policy> Block;
+
 		/**
 		 * @brief Constructor por defecto.
 		 *
-		 * Inicializa el puntero y el recuento de referencias a nullptr.
+		 * Inicializa el puntero y el bloque de control a nullptr.
 		 */
-		TSharedPointer() : ptr(nullptr), refCount(nullptr) {}
+		TSharedPointer() : ptr(nullptr), block(nullptr) {}
 
 		/**
 		 * @brief Constructor que toma un puntero crudo.
 		 *
 		 * @param rawPtr Puntero crudo al objeto que se va a gestionar.
+		 *
+		 * @note Reserva aparte el bloque de control; MakeShared evita esa segunda reserva.
 		 */
-		explicit TSharedPointer(T* rawPtr) : ptr(rawPtr), refCount(new int(1)) {}
+		explicit TSharedPointer(T* rawPtr)
+			: ptr(rawPtr), block(rawPtr ? new TPointerRefBlock<T, Policy>(rawPtr) : nullptr) {}
 
 		/**
-		 * @brief Constructor desde un puntero crudo y un recuento de referencias.
+		 * @brief Constructor que toma un puntero crudo y cmo destruirlo.
 		 *
-		 * @param rawPtr Puntero crudo al objeto gestionado.
-		 * @param existingRefCount Puntero al recuento de referencias existente.
+		 * @param rawPtr Puntero crudo al objeto que se va a gestionar.
+		 * @param deleter Funcin `void(T*)` que se llama en lugar de `delete` cuando se
+		 * suelta el ltimo puntero fuerte (los TWeakPointer no lo retrasan).
 		 */
-		TSharedPointer(T* rawPtr, int* existingRefCount) : ptr(rawPtr), refCount(existingRefCount)
+		template<typename Deleter, typename = typename std::enable_if<!std::is_convertible<Deleter, Block*>::value>::type>
+		TSharedPointer(T* rawPtr, Deleter deleter)
+			: ptr(rawPtr), block(rawPtr ? new TDeleterRefBlock<T, Policy, Deleter>(rawPtr, std::move(deleter)) : nullptr) {}
+
+		/**
+		 * @brief Constructor desde un puntero crudo y un bloque de control existente.
+		 *
+		 * @param rawPtr Puntero crudo al objeto gestionado (puede ser una base o derivada).
+		 * @param existingBlock Bloque de control del objeto; se le suma una referencia.
+		 */
+		TSharedPointer(T* rawPtr, Block* existingBlock) : ptr(rawPtr), block(existingBlock)
 		{
-			if (refCount)
+			if (block)
 			{
-				++(*refCount);
+				block->addRef();
 			}
 		}
 
 		/**
 		 * @brief Constructor de copia.
 		 *
-		 * Copia el puntero y el recuento de referencias del otro TSharedPointer y
-		 * aumenta el recuento de referencias.
+		 * Copia el puntero y el bloque del otro TSharedPointer y aumenta el recuento.
 		 *
 		 * @param other Otro objeto TSharedPointer del mismo tipo T.
 		 */
-		TSharedPointer(const TSharedPointer<T>& other) : ptr(other.ptr), refCount(other.refCount)
-		{
-			if (refCount)
-			{
-				++(*refCount);
-			}
-		}
+		TSharedPointer(const TSharedPointer& other) : TSharedPointer(other.ptr, other.block) {}
+
+		/**
+		 * @brief Conversin desde un TSharedPointer de un tipo derivado (U* -> T*).
+		 */
+		template<typename U, typename = typename std::enable_if<std::is_convertible<U*, T*>::value>::type>
+		TSharedPointer(const TSharedPointer<U, Policy>& other) : TSharedPointer(other.ptr, other.block) {}
 
 		/**
 		 * @brief Constructor de movimiento.
 		 *
-		 * Transfiere la propiedad del puntero y el recuento de referencias del otro
-		 * TSharedPointer al nuevo objeto TSharedPointer.
+		 * Transfiere la propiedad del puntero y del bloque del otro TSharedPointer.
 		 *
 		 * @param other Otro objeto TSharedPointer del mismo tipo T.
 		 */
-		TSharedPointer(TSharedPointer<T>&& other) noexcept : ptr(other.ptr), refCount(other.refCount)
+		TSharedPointer(TSharedPointer&& other) noexcept : ptr(other.ptr), block(other.block)
 		{
 			other.ptr = nullptr;
-			other.refCount = nullptr;
+			other.block = nullptr;
 		}
 
 		/**
 		 * @brief Operador de asignacin de copia.
 		 *
-		 * Libera el objeto actual, copia el puntero y el recuento de referencias del otro
-		 * TSharedPointer, y aumenta el recuento de referencias.
-		 *
 		 * @param other Otro objeto TSharedPointer del mismo tipo T.
 		 * @return Referencia al objeto TSharedPointer actual.
 		 */
-		TSharedPointer<T>& operator=(const TSharedPointer<T>& other)
+		TSharedPointer& operator=(const TSharedPointer& other)
 		{
-			if (this != &other)
-			{
-				// Disminuir el recuento de referencias del objeto actual
-				if (refCount && --(*refCount) == 0)
-				{
-					delete ptr;
-					delete refCount;
-				}
-				// Copiar datos del otro puntero compartido
-				ptr = other.ptr;
-				refCount = other.refCount;
-				if (refCount)
-				{
-					++(*refCount);
-				}
-			}
+			TSharedPointer(other).swap(*this);
 			return *this;
 		}
 
 		/**
 		 * @brief Operador de asignacin de movimiento.
 		 *
-		 * Libera el objeto actual, transfiere la propiedad del puntero y el recuento de
-		 * referencias del otro TSharedPointer al actual.
-		 *
 		 * @param other Otro objeto TSharedPointer del mismo tipo T.
 		 * @return Referencia al objeto TSharedPointer actual.
 		 */
-		TSharedPointer<T>& operator=(TSharedPointer<T>&& other) noexcept
+		TSharedPointer& operator=(TSharedPointer&& other) noexcept
 		{
-			if (this != &other)
-			{
-				// Liberar el objeto actual
-				if (refCount && --(*refCount) == 0)
-				{
-					delete ptr;
-					delete refCount;
-				}
-				// Transferir los datos del otro puntero compartido
-				ptr = other.ptr;
-				refCount = other.refCount;
-				other.ptr = nullptr;
-				other.refCount = nullptr;
-			}
+			TSharedPointer(std::move(other)).swap(*this);
 			return *this;
 		}
 
 		/**
 		 * @brief Destructor.
 		 *
-		 * Disminuye el recuento de referencias y libera la memoria del objeto
-		 * gestionado si el recuento de referencias llega a cero.
+		 * Disminuye el recuento de referencias y libera el objeto gestionado si llega a cero.
 		 */
 		~TSharedPointer()
 		{
-			if (refCount && --(*refCount) == 0)
+			if (block)
 			{
-				delete ptr;
-				delete refCount;
+				block->release();
 			}
 		}
 
@@ -204,10 +350,21 @@ namespace EU {
 		 */
 		bool isNull() const { return ptr == nullptr; }
 
+		/**
+		 * @brief Punteros fuertes que comparten el objeto (0 si es nulo).
+		 *
+		 * @note Con @ref AtomicRefCount el valor puede cambiar justo despus de leerlo.
+		 */
+		int useCount() const { return block ? Policy::load(block->strong) : 0; }
+
+		/**
+		 * @brief Comprobar si este es el nico puntero al objeto.
+		 */
+		bool unique() const { return useCount() == 1; }
 
 	public:
 		T* ptr;       ///< Puntero al objeto gestionado.
-		int* refCount; ///< Puntero al recuento de referencias.
+		Block* block; ///< Bloque de control (recuentos); nullptr si es nulo.
 
 		/**
 		 * @brief Mtodo swap.
@@ -216,62 +373,106 @@ namespace EU {
 		 *
 		 * @param other Otro objeto TSharedPointer del mismo tipo T.
 		 */
-		void swap(TSharedPointer<T>& other) noexcept
+		void swap(TSharedPointer& other) noexcept
 		{
-			T* tempPtr = other.ptr;
-			int* tempRefCount = other.refCount;
-
-			other.ptr = this->ptr;
-			other.refCount = this->refCount;
-
-			this->ptr = tempPtr;
-			this->refCount = tempRefCount;
+			std::swap(ptr, other.ptr);
+			std::swap(block, other.block);
 		}
 
 		/**
-				 * @brief Libera el objeto actual y opcionalmente asigna un nuevo objeto.
-				 *
-				 * @param newPtr Nuevo puntero crudo al objeto que se va a gestionar (por defecto es nullptr).
-				 */
+		 * @brief Libera el objeto actual y opcionalmente asigna un nuevo objeto.
+		 *
+		 * @param newPtr Nuevo puntero crudo al objeto que se va a gestionar (por defecto es nullptr).
+		 */
 		void reset(T* newPtr = nullptr)
 		{
-			// Disminuir el recuento de referencias del objeto actual
-			if (refCount && --(*refCount) == 0)
-			{
-				delete ptr;
-				delete refCount;
-			}
-
-			// Si newPtr es nullptr, asignar nullptr al puntero y recuento de referencias
-			if (newPtr == nullptr)
-			{
-				ptr = nullptr;
-				refCount = nullptr;
-			}
-			else
-			{
-				// Asignar nuevo objeto y manejar el recuento de referencias
-				ptr = newPtr;
-				refCount = new int(1);
-			}
+			TSharedPointer(newPtr).swap(*this);
 		}
 
 		// Mtodo de conversin para hacer cast dinmico
 		template<typename U>
-		TSharedPointer<U> dynamic_pointer_cast() const {
+		TSharedPointer<U, Policy> dynamic_pointer_cast() const {
 			// Intenta convertir el puntero de tipo T a U
 			U* castedPtr = dynamic_cast<U*>(ptr);
 			if (castedPtr) {
-				// Si la conversin es exitosa, devuelve un nuevo TSharedPointer<U>
-				return TSharedPointer<U>(castedPtr, refCount);
+				// Si la conversin es exitosa, comparte el bloque de control
+				return TSharedPointer<U, Policy>(castedPtr, block);
 			}
 			else {
 				// Si falla la conversin, devuelve un TSharedPointer<U> nulo
-				return TSharedPointer<U>();
+				return TSharedPointer<U, Policy>();
 			}
 		}
 	};
 
+	/**
+	 * @brief TSharedPointer con recuento atmico, para compartir entre hilos.
+	 */
+	template<typename T>
+	using TAtomicSharedPointer = TSharedPointer<T, AtomicRefCount>;
+
+	/**
+	 * @brief Crea un objeto y su bloque de control en una sola reserva del montn.
+	 *
+	 * @tparam T Tipo del objeto gestionado.
+	 * @tparam Policy Poltica de recuento.
+	 * @param args Argumentos del constructor del objeto (reenviados tal cual).
+	 */
+	template<typename T, typename Policy, typename... Args>
+	TSharedPointer<T, Policy> AllocateShared(std::false_type, Args&&... args)
+	{
+		// `new` solo garantiza 16 bytes de alineacin antes de C++17.
+		static_assert(alignof(T) <= 16, "AllocateShared: over-aligned type, use TSharedPointer<T>(new T(...))");
+		TInlineRefBlock<T, Policy>* block = new TInlineRefBlock<T, Policy>();
+		try {
+			new (block->object()) T(std::forward<Args>(args)...);
+		}
+		catch (...) {
+			delete block;
+			throw;
+		}
+		TSharedPointer<T, Policy> result;
+		result.ptr = block->object();
+		result.block = block;
+		return result;
+	}
+
+	/**
+	 * @brief Versin de @ref AllocateShared con el bloque del pool del tipo (ver @ref TUsePool).
+	 */
+	template<typename T, typename Policy, typename... Args>
+	TSharedPointer<T, Policy> AllocateShared(std::true_type, Args&&... args)
+	{
+		typedef TPooledRefBlock<T, Policy> PooledBlock;
+		void* memory = TObjectPool<PooledBlock>::Allocate();
+		if (!memory) {
+			throw std::bad_alloc();
+		}
+		PooledBlock* block = new (memory) PooledBlock();
+		try {
+			new (block->object()) T(std::forward<Args>(args)...);
+		}
+		catch (...) {
+			block->~PooledBlock();
+			TObjectPool<PooledBlock>::Deallocate(memory);
+			throw;
+		}
+		TSharedPointer<T, Policy> result;
+		result.ptr = block->object();
+		result.block = block;
+		return result;
+	}
+
+	/**
+	 * @brief Crea un objeto y su bloque de control en una sola reserva: del pool del tipo
+	 * si est marcado con @ref TUsePool, del montn si no.
+	 */
+	template<typename T, typename Policy, typename... Args>
+	TSharedPointer<T, Policy> AllocateShared(Args&&... args)
+	{
+		return AllocateShared<T, Policy>(std::integral_constant<bool, TUsePool<T>::value>(), std::forward<Args>(args)...);
+	}
+
 	/**
 	 * @brief Funcin de utilidad para crear un TSharedPointer.
 	 *
@@ -279,11 +480,22 @@ namespace EU {
 	 * @tparam Args Tipos de los argumentos del constructor del objeto gestionado.
 	 * @param args Argumentos del constructor del objeto gestionado.
 	 * @return Un objeto TSharedPointer gestionando un nuevo objeto de tipo T.
+	 *
+	 * @note Objeto y recuento van en la misma reserva (ver @ref AllocateShared); los tipos
+	 * marcados con @ref TUsePool la toman de su pool.
 	 */
 	template<typename T, typename... Args>
-	TSharedPointer<T> MakeShared(Args... args)
+	TSharedPointer<T> MakeShared(Args&&... args)
 	{
-		return TSharedPointer<T>(new T(args...));
+		return AllocateShared<T, SingleThreadRefCount>(std::forward<Args>(args)...);
 	}
-}
 
+	/**
+	 * @brief Como MakeShared, pero con recuento atmico (@ref TAtomicSharedPointer).
+	 */
+	template<typename T, typename... Args>
+	TAtomicSharedPointer<T> MakeAtomicShared(Args&&... args)
+	{
+		return AllocateShared<T, AtomicRefCount>(std::forward<Args>(args)...);
+	}
+}
@@ -38,21 +38,48 @@ namespace
 		 * sin tener influencia sobre el recuento de referencias del objeto. Permite acceder al objeto solo si
 		 * an existe.
 		 */
-	template<typename T>
+	template<typename T, typename Policy = SingleThreadRefCount>
 	class TWeakPointer {
 	public:
+		typedef TRefBlock<Policy> Block;
+
 		/**
 		 * @brief Constructor por defecto.
 		 */
-		TWeakPointer() : ptr(nullptr), refCount(nullptr) {}
+		TWeakPointer() : ptr(nullptr), block(nullptr) {}
 
 		/**
 		 * @brief Constructor que toma un TSharedPointer.
 		 *
 		 * @param sharedPtr TSharedPointer desde el cual se observar el objeto.
+		 *
+		 * @note Mantiene vivo el bloque de control (no el objeto): as `lock` puede
+		 * comprobar el recuento aunque el objeto ya se haya destruido.
 		 */
-		TWeakPointer(const TSharedPointer<T>& sharedPtr)
-			: ptr(sharedPtr.ptr), refCount(sharedPtr.refCount) {
+		TWeakPointer(const TSharedPointer<T, Policy>& sharedPtr)
+			: ptr(sharedPtr.ptr), block(sharedPtr.block) {
+			if (block) {
+				Policy::increment(block->weak);
+			}
+		}
+
+		TWeakPointer(const TWeakPointer& other) : ptr(other.ptr), block(other.block) {
+			if (block) {
+				Policy::increment(block->weak);
+			}
+		}
+
+		TWeakPointer& operator=(const TWeakPointer& other) {
+			TWeakPointer copy(other);
+			std::swap(ptr, copy.ptr);
+			std::swap(block, copy.block);
+			return *this;
+		}
+
+		~TWeakPointer() {
+			if (block) {
+				block->releaseWeak();
+			}
 		}
 
 		/**
@@ -60,21 +87,24 @@ namespace
 		 *
 		 * @return Un TSharedPointer al objeto gestionado, o nullptr si el objeto ha sido destruido.
 		 */
-		TSharedPointer<T>
+		TSharedPointer<T, Policy>
 			lock() const {
-			if (refCount && *refCount > 0) {
-				return TSharedPointer<T>(ptr, refCount);
+			TSharedPointer<T, Policy> result;
+			if (block && Policy::incrementIfNotZero(block->strong)) {
+				result.ptr = ptr;
+				result.block = block;
 			}
-			return TSharedPointer<T>();
+			return result;
 		}
 
-		// Hacer que TSharedPointer sea un amigo para acceder a los miembros privados.
-		template<typename U>
-		friend class TSharedPointer;
+		/**
+		 * @brief Comprobar si el objeto observado ya se destruy.
+		 */
+		bool expired() const { return !block || Policy::load(block->strong) == 0; }
 
 	private:
 		T* ptr;       ///< Puntero al objeto observado.
-		int* refCount; ///< Puntero al recuento de referencias del TSharedPointer original.
+		Block* block; ///< Bloque de control del TSharedPointer original.
 	};
 
 	/*
@@ -26,8 +26,14 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
  * SOFTWARE.
 */
-
 #pragma once
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "../Memory/TAllocators.h"
+
 namespace EU {
 	/**
 	 * @brief TArray es una clase de array dinmica para almacenar elementos de tipo T.
@@ -36,62 +42,233 @@ namespace EU {
 	 * colecciones de elementos, con operaciones bsicas como agregar, eliminar y acceder a elementos.
 	 * La memoria se gestiona dinmicamente, aumentando la capacidad del array segn sea necesario.
 	 *
+	 * Los elementos viven en memoria sin construir: solo existen los `Num()` primeros
+	 * (se crean con `new` de colocacin y se destruyen uno a uno). Crecer **mueve** los
+	 * elementos en lugar de construir por defecto toda la capacidad y copiarlos, y quitar
+	 * del medio desplaza moviendo.
+	 *
 	 * @tparam T El tipo de elementos almacenados en el array.
+	 * @tparam Allocator De dnde sale la memoria: @ref HeapAllocator (por defecto),
+	 * @ref ArenaAllocator o @ref TInlineAllocator (ver TAllocators.h).
+	 *
+	 * @note El acceso con `[]` solo comprueba el ndice en Debug.
 	 */
-	template<typename T>
+	template<typename T, typename Allocator = HeapAllocator>
 	class TArray
 	{
 	private:
 		T* Data;           ///< Puntero a la memoria donde se almacenan los elementos del array.
 		size_t Capacity;   ///< Capacidad actual del array (nmero de elementos que puede almacenar).
 		size_t Size;       ///< Nmero de elementos actualmente en el array.
+		Allocator Alloc;   ///< Origen de la memoria de `Data`.
+
+		/// Alineacin de las reservas (al menos la de un puntero).
+		static const size_t Alignment = alignof(T) > alignof(void*) ? alignof(T) : alignof(void*);
+
+		/**
+		 * @brief Mueve (o copia, si mover puede lanzar) `Count` elementos a memoria sin construir
+		 * y destruye los originales.
+		 */
+		static void Relocate(T* Dest, T* Source, size_t Count)
+		{
+			for (size_t i = 0; i < Count; ++i)
+			{
+				new (Dest + i) T(std::move_if_noexcept(Source[i]));
+				Source[i].~T();
+			}
+		}
 
 		/**
 		 * @brief Redimensiona el array para tener una nueva capacidad.
 		 *
-		 * @param NewCapacity La nueva capacidad del array.
+		 * @param NewCapacity La nueva capacidad del array (al menos `Num()`).
 		 */
 		void Resize(size_t NewCapacity)
 		{
-			T* NewData = new T[NewCapacity];  ///< Crear un nuevo bloque de memoria con la nueva capacidad.
-			for (size_t i = 0; i < Size; ++i)
+			T* NewData = static_cast<T*>(Alloc.Allocate(NewCapacity * sizeof(T), Alignment));
+			if (!NewData)
+			{
+				throw std::bad_alloc();
+			}
+			Relocate(NewData, Data, Size);
+			Free();
+			Data = NewData;
+			Capacity = NewCapacity;
+		}
+
+		/// Capacidad para un elemento ms (duplicando).
+		size_t GrowCapacity() const
+		{
+			return Capacity == 0 ? 4 : Capacity * 2;
+		}
+
+		/// Devuelve el bloque actual al asignador (los elementos ya destruidos o movidos).
+		void Free()
+		{
+			if (Data)
+			{
+				Alloc.Deallocate(Data, Capacity * sizeof(T));
+			}
+			Data = nullptr;
+			Capacity = 0;
+		}
+
+		/// Toma los elementos de `Other`: su bloque si el asignador lo permite, si no uno a uno.
+		void MoveFrom(TArray& Other)
+		{
+			if (Other.Data && Other.Alloc.CanSteal(Other.Data))
+			{
+				Data = Other.Data;
+				Capacity = Other.Capacity;
+				Size = Other.Size;
+				Other.Data = nullptr;
+				Other.Capacity = 0;
+				Other.Size = 0;
+				return;
+			}
+			Reserve(Other.Size);
+			Relocate(Data, Other.Data, Other.Size);
+			Size = Other.Size;
+			Other.Size = 0;
+		}
+
+		static void CheckIndex(size_t Index, size_t Size)
+		{
+#if defined(_DEBUG)
+			if (Index >= Size)
 			{
-				NewData[i] = Data[i];  ///< Copiar los elementos existentes al nuevo bloque de memoria.
+				std::cerr << "Index out of range" << std::endl;  ///< Manejar el caso de ndice fuera de rango.
+				exit(1);  ///< Salir del programa en caso de error.
 			}
-			delete[] Data;  ///< Liberar la memoria del array antiguo.
-			Data = NewData; ///< Actualizar el puntero Data para que apunte al nuevo bloque de memoria.
-			Capacity = NewCapacity;  ///< Actualizar la capacidad del array.
+#else
+			(void)Index;
+			(void)Size;
+#endif
 		}
 
 	public:
+		typedef T* Iterator;
+		typedef const T* ConstIterator;
+
 		/**
 		 * @brief Constructor por defecto que inicializa el array con capacidad y tamao cero.
 		 */
-		TArray() : Data(nullptr), Capacity(0), Size(0)	{}
+		TArray() : Data(nullptr), Capacity(0), Size(0) {}
+
+		/**
+		 * @brief Constructor con un asignador concreto (p. ej. `ArenaAllocator(frameArena)`).
+		 */
+		explicit TArray(const Allocator& InAlloc) : Data(nullptr), Capacity(0), Size(0), Alloc(InAlloc) {}
+
+		TArray(const TArray& Other) : Data(nullptr), Capacity(0), Size(0), Alloc(Other.Alloc)
+		{
+			Reserve(Other.Size);
+			for (; Size < Other.Size; ++Size)
+			{
+				new (Data + Size) T(Other.Data[Size]);
+			}
+		}
+
+		TArray(TArray&& Other) noexcept : Data(nullptr), Capacity(0), Size(0), Alloc(Other.Alloc)
+		{
+			MoveFrom(Other);
+		}
+
+		TArray& operator=(const TArray& Other)
+		{
+			if (this != &Other)
+			{
+				TArray Copy(Other);
+				*this = std::move(Copy);
+			}
+			return *this;
+		}
+
+		TArray& operator=(TArray&& Other) noexcept
+		{
+			if (this != &Other)
+			{
+				Clear();
+				Free();
+				Alloc = Other.Alloc;
+				MoveFrom(Other);
+			}
+			return *this;
+		}
 
 		/**
-		 * @brief Destructor que libera la memoria asignada al array.
+		 * @brief Destructor que destruye los elementos y libera la memoria asignada al array.
 		 */
-		~TArray()	{
-			delete[] Data;  ///< Liberar la memoria del array.
+		~TArray()
+		{
+			Clear();
+			Free();
 		}
 
 		/**
-		 * @brief Aade un nuevo elemento al final del array.
+		 * @brief Reserva sitio para `NewCapacity` elementos sin crearlos.
 		 *
-		 * @param Element El elemento a aadir al array.
+		 * @param NewCapacity Capacidad mnima; si ya la tiene no hace nada.
 		 */
-		void Add(const T& Element)
+		void Reserve(size_t NewCapacity)
+		{
+			if (NewCapacity > Capacity)
+			{
+				Resize(NewCapacity);
+			}
+		}
+
+		/**
+		 * @brief Construye un elemento al final con los argumentos dados (sin copias).
+		 *
+		 * @return Referencia al elemento creado.
+		 */
+		template<typename... Args>
+		T& EmplaceBack(Args&&... args)
 		{
 			if (Size == Capacity)
 			{
-				Resize(Capacity == 0 ? 1 : Capacity * 2);  ///< Redimensionar si es necesario.
+				// El nuevo elemento se crea antes de mover los viejos: `args` puede apuntar
+				// a un elemento de este mismo array.
+				const size_t NewCapacity = GrowCapacity();
+				T* NewData = static_cast<T*>(Alloc.Allocate(NewCapacity * sizeof(T), Alignment));
+				if (!NewData)
+				{
+					throw std::bad_alloc();
+				}
+				new (NewData + Size) T(std::forward<Args>(args)...);
+				Relocate(NewData, Data, Size);
+				Free();
+				Data = NewData;
+				Capacity = NewCapacity;
+			}
+			else
+			{
+				new (Data + Size) T(std::forward<Args>(args)...);
 			}
-			Data[Size++] = Element;  ///< Aadir el nuevo elemento y aumentar el tamao.
+			return Data[Size++];
+		}
+
+		/**
+		 * @brief Aade un nuevo elemento al final del array.
+		 *
+		 * @param Element El elemento a aadir al array.
+		 */
+		void Add(const T& Element)
+		{
+			EmplaceBack(Element);
 		}
 
 		/**
-		 * @brief Elimina el elemento en la posicin especificada.
+		 * @brief Aade un elemento al final movindolo.
+		 */
+		void Add(T&& Element)
+		{
+			EmplaceBack(std::move(Element));
+		}
+
+		/**
+		 * @brief Elimina el elemento en la posicin especificada, conservando el orden.
 		 *
 		 * @param Index La posicin del elemento a eliminar.
 		 */
@@ -104,9 +281,40 @@ namespace EU {
 			}
 			for (size_t i = Index; i < Size - 1; ++i)
 			{
-				Data[i] = Data[i + 1];  ///< Desplazar los elementos hacia la izquierda para llenar el hueco.
+				Data[i] = std::move(Data[i + 1]);  ///< Desplazar los elementos hacia la izquierda para llenar el hueco.
+			}
+			Data[--Size].~T();
+		}
+
+		/**
+		 * @brief Elimina el elemento moviendo el ltimo a su sitio: O(1), pero cambia el orden.
+		 *
+		 * @param Index La posicin del elemento a eliminar.
+		 */
+		void RemoveAtSwap(size_t Index)
+		{
+			if (Index >= Size)
+			{
+				std::cerr << "Index out of range" << std::endl;
+				return;
+			}
+			if (Index != Size - 1)
+			{
+				Data[Index] = std::move(Data[Size - 1]);
+			}
+			Data[--Size].~T();
+		}
+
+		/**
+		 * @brief Destruye todos los elementos; conserva la capacidad.
+		 */
+		void Clear()
+		{
+			for (size_t i = 0; i < Size; ++i)
+			{
+				Data[i].~T();
 			}
-			--Size;  ///< Disminuir el tamao del array.
+			Size = 0;
 		}
 
 		/**
@@ -117,11 +325,7 @@ namespace EU {
 		 */
 		T& operator[](size_t Index)
 		{
-			if (Index >= Size)
-			{
-				std::cerr << "Index out of range" << std::endl;  ///< Manejar el caso de ndice fuera de rango.
-				exit(1);  ///< Salir del programa en caso de error.
-			}
+			CheckIndex(Index, Size);
 			return Data[Index];  ///< Devolver el elemento en la posicin especificada.
 		}
 
@@ -133,11 +337,7 @@ namespace EU {
 		 */
 		const T& operator[](size_t Index) const
 		{
-			if (Index >= Size)
-			{
-				std::cerr << "Index out of range" << std::endl;  ///< Manejar el caso de ndice fuera de rango.
-				exit(1);  ///< Salir del programa en caso de error.
-			}
+			CheckIndex(Index, Size);
 			return Data[Index];  ///< Devolver el elemento en la posicin especificada.
 		}
 
@@ -151,6 +351,9 @@ namespace EU {
 			return Size;  ///< Devolver el tamao actual del array.
 		}
 
+		/** @brief `true` si no tiene elementos. */
+		bool IsEmpty() const { return Size == 0; }
+
 		/**
 		 * @brief Devuelve la capacidad actual del array.
 		 *
@@ -160,6 +363,16 @@ namespace EU {
 		{
 			return Capacity;  ///< Devolver la capacidad actual del array.
 		}
+
+		/** @brief Puntero a los elementos (contiguos). */
+		T* GetData() { return Data; }
+		const T* GetData() const { return Data; }
+
+		// Iteradores para `for (auto& x : array)`.
+		Iterator begin() { return Data; }
+		Iterator end() { return Data + Size; }
+		ConstIterator begin() const { return Data; }
+		ConstIterator end() const { return Data + Size; }
 	};
 
 	// EXAMPLE
@@ -169,24 +382,30 @@ namespace EU {
 
 		// TArray Example
 		TArray<int> MyArray;
+		MyArray.Reserve(8);
 		MyArray.Add(1);
 		MyArray.Add(2);
 		MyArray.Add(3);
 		MyArray.Add(4);
 		MyArray.Add(5);
 
-		MyArray.Add(6);
+		MyArray.EmplaceBack(6);
 		MyArray.RemoveAt(2);
+		MyArray.RemoveAtSwap(0);
 
-		for (size_t i = 0; i < MyArray.Num(); ++i)
+		for (int Value : MyArray)
 		{
-			std::cout << MyArray[i] << " ";
+			std::cout << Value << " ";
 		}
 		std::cout << std::endl;
 
 		std::cout << "Size: " << MyArray.Num() << ", Capacity: " << MyArray.GetCapacity() << std::endl;
 
+		// Hasta 8 enteros sin reservar memoria.
+		TArray<int, TInlineAllocator<8 * sizeof(int)>> Small;
+		Small.Add(7);
+
 		return 0;
 	}
 	*/
-}
\ No newline at end of file
+}
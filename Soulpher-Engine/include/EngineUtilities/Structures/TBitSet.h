@@ -0,0 +1,205 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Roberto Charreton
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * In addition, any project or software that uses this library or class must include
+ * the following acknowledgment in the credits:
+ *
+ * "This project uses software developed by Roberto Charreton and Attribute Overload."
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace EU {
+	/**
+	 * @brief Conjunto de enteros densos: un bit por id.
+	 *
+	 * Para identificadores pequeos y contiguos (ndices de entidad o de actor, ids de
+	 * material) es mucho ms compacto y rpido que un TSet: aadir y comprobar son un
+	 * desplazamiento y una mscara, y unin e interseccin van de 64 en 64.
+	 *
+	 * - Crece solo al aadir un id mayor que los anteriores (@ref Reserve lo evita).
+	 * - @ref ForEach recorre los ids en orden creciente saltando palabras vacas.
+	 *
+	 * @note Para estudiantes: la memoria depende del id ms alto, no de cuntos hay. Para
+	 * ids dispersos (hashes, punteros) usa TSet.
+	 */
+	class TBitSet
+	{
+	public:
+		TBitSet() : Count(0) {}
+
+		/** @brief Prepara sitio para los ids `[0, MaxId)` sin volver a crecer. */
+		void Reserve(size_t MaxId)
+		{
+			const size_t NeededWords = (MaxId + 63) / 64;
+			if (NeededWords > Words.size())
+			{
+				Words.resize(NeededWords, 0);
+			}
+		}
+
+		/** @return `false` si ya estaba. */
+		bool Add(uint32_t Id)
+		{
+			Reserve(static_cast<size_t>(Id) + 1);
+			uint64_t& Word = Words[Id >> 6];
+			const uint64_t Bit = 1ull << (Id & 63);
+			if (Word & Bit)
+			{
+				return false;
+			}
+			Word |= Bit;
+			++Count;
+			return true;
+		}
+
+		/** @return `false` si no estaba. */
+		bool Remove(uint32_t Id)
+		{
+			if ((Id >> 6) >= Words.size())
+			{
+				return false;
+			}
+			uint64_t& Word = Words[Id >> 6];
+			const uint64_t Bit = 1ull << (Id & 63);
+			if (!(Word & Bit))
+			{
+				return false;
+			}
+			Word &= ~Bit;
+			--Count;
+			return true;
+		}
+
+		bool Contains(uint32_t Id) const
+		{
+			return (Id >> 6) < Words.size() && (Words[Id >> 6] >> (Id & 63)) & 1ull;
+		}
+
+		/** @brief Vaca el conjunto; conserva la memoria (para reconstruirlo cada frame). */
+		void Clear()
+		{
+			std::fill(Words.begin(), Words.end(), 0ull);
+			Count = 0;
+		}
+
+		/** @brief Aade todos los ids de `[First, Last)`. */
+		template<typename It>
+		void Append(It First, It Last)
+		{
+			for (; First != Last; ++First)
+			{
+				Add(static_cast<uint32_t>(*First));
+			}
+		}
+
+		/** @brief Unin: aade los ids de `Other`. */
+		void UnionWith(const TBitSet& Other)
+		{
+			if (Other.Words.size() > Words.size())
+			{
+				Words.resize(Other.Words.size(), 0);
+			}
+			Count = 0;
+			for (size_t i = 0; i < Words.size(); ++i)
+			{
+				if (i < Other.Words.size())
+				{
+					Words[i] |= Other.Words[i];
+				}
+				Count += PopCount(Words[i]);
+			}
+		}
+
+		/** @brief Interseccin: quita los ids que no estn en `Other`. */
+		void IntersectWith(const TBitSet& Other)
+		{
+			Count = 0;
+			for (size_t i = 0; i < Words.size(); ++i)
+			{
+				Words[i] &= i < Other.Words.size() ? Other.Words[i] : 0ull;
+				Count += PopCount(Words[i]);
+			}
+		}
+
+		/**
+		 * @brief Llama a `Function(uint32_t Id)` por cada id, en orden creciente.
+		 */
+		template<typename F>
+		void ForEach(const F& Function) const
+		{
+			for (size_t i = 0; i < Words.size(); ++i)
+			{
+				for (uint64_t Word = Words[i]; Word; Word &= Word - 1)
+				{
+					Function(static_cast<uint32_t>(i * 64 + LowestBit(Word)));
+				}
+			}
+		}
+
+		/** @brief Ids en el conjunto. */
+		size_t Num() const { return Count; }
+
+		bool IsEmpty() const { return Count == 0; }
+
+		/** @brief Ids que caben sin crecer. */
+		size_t GetCapacity() const { return Words.size() * 64; }
+
+	private:
+		static unsigned int PopCount(uint64_t Word)
+		{
+#if defined(_MSC_VER) && defined(_M_X64)
+			return static_cast<unsigned int>(__popcnt64(Word));
+#elif defined(__GNUC__)
+			return static_cast<unsigned int>(__builtin_popcountll(Word));
+#else
+			unsigned int Bits = 0;
+			for (; Word; Word &= Word - 1) { ++Bits; }
+			return Bits;
+#endif
+		}
+
+		static unsigned int LowestBit(uint64_t Word)
+		{
+#if defined(_MSC_VER) && defined(_M_X64)
+			unsigned long Index;
+			_BitScanForward64(&Index, Word);
+			return static_cast<unsigned int>(Index);
+#elif defined(__GNUC__)
+			return static_cast<unsigned int>(__builtin_ctzll(Word));
+#else
+			unsigned int Bit = 0;
+			while (!(Word & 1ull)) { Word >>= 1; ++Bit; }
+			return Bit;
+#endif
+		}
+
+		std::vector<uint64_t> Words;
+		size_t Count;
+	};
+}
@@ -0,0 +1,443 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Roberto Charreton
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * In addition, any project or software that uses this library or class must include
+ * the following acknowledgment in the credits:
+ *
+ * "This project uses software developed by Roberto Charreton and Attribute Overload."
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <string>
+#include <utility>
+#include "../Memory/TAllocators.h"
+#include "../Utilities/Hash.h"
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define EU_HASHTABLE_SSE2 1
+#endif
+
+namespace EU {
+	/**
+	 * @brief Hash por defecto de TMap y TSet: `std::hash`.
+	 */
+	template<typename K>
+	struct THash {
+		size_t operator()(const K& Key) const { return std::hash<K>()(Key); }
+	};
+
+	/**
+	 * @brief Hash de cadenas: FNV-1a sobre los caracteres, igual para `std::string` y
+	 * `const char*`, as se puede buscar con un literal sin crear un `std::string`.
+	 */
+	template<>
+	struct THash<std::string> {
+		size_t operator()(const std::string& Key) const { return Bytes(Key.data(), Key.size()); }
+		size_t operator()(const char* Key) const { return Bytes(Key, strlen(Key)); }
+
+		static size_t Bytes(const char* Data, size_t Size) {
+			uint64_t Hash = kFnv1aSeed;
+			Fnv1a(Hash, Data, Size);
+			return static_cast<size_t>(Hash);
+		}
+	};
+
+	/**
+	 * @brief Ncleo comn de TMap y TSet: tabla hash de direccionamiento abierto al estilo
+	 * SwissTable.
+	 *
+	 * Los elementos viven en un array plano (sin un nodo por elemento) y al lado hay un
+	 * byte de control por hueco: vaco, borrado o los 7 bits bajos del hash de su clave.
+	 * Los huecos van en grupos de 16; buscar compara los 16 bytes de control de un grupo
+	 * de una vez (SSE2) y solo compara claves donde coinciden esos 7 bits. Si el grupo
+	 * tiene algn hueco vaco la clave no est; si no, se pasa al siguiente grupo de la
+	 * secuencia.
+	 *
+	 * - Carga mxima de 7/8: crece al doble cuando se llena (los borrados cuentan).
+	 * - Las bsquedas aceptan cualquier tipo que el hash y el `==` de la clave admitan
+	 *   (p. ej. `const char*` con claves `std::string`).
+	 *
+	 * @tparam E Elemento guardado (el par de TMap, el propio valor en TSet).
+	 * @tparam KeyOf Funcin esttica `KeyOf::Get(const E&)` que devuelve la clave.
+	 * @tparam Hasher Hash de las claves.
+	 *
+	 * @note Para estudiantes: aadir puede mover los elementos (al crecer); no guardes
+	 * punteros a ellos entre inserciones.
+	 */
+	template<typename E, typename KeyOf, typename Hasher>
+	class THashTable
+	{
+	public:
+		THashTable()
+			: Control(nullptr), Slots(nullptr), Capacity(0), Size(0), Tombstones(0)
+		{
+		}
+
+		THashTable(const THashTable& Other) : THashTable()
+		{
+			Hash = Other.Hash;
+			Reserve(Other.Size);
+			for (const E& Element : Other)
+			{
+				const size_t H = HashOf(KeyOf::Get(Element));
+				const size_t Index = PrepareInsert(H);
+				new (Slots + Index) E(Element);
+				CommitInsert(Index, H);
+			}
+		}
+
+		THashTable(THashTable&& Other) noexcept
+			: Control(Other.Control), Slots(Other.Slots), Capacity(Other.Capacity), Size(Other.Size),
+			Tombstones(Other.Tombstones), Hash(Other.Hash)
+		{
+			Other.Control = nullptr;
+			Other.Slots = nullptr;
+			Other.Capacity = Other.Size = Other.Tombstones = 0;
+		}
+
+		THashTable& operator=(THashTable Other) noexcept
+		{
+			std::swap(Control, Other.Control);
+			std::swap(Slots, Other.Slots);
+			std::swap(Capacity, Other.Capacity);
+			std::swap(Size, Other.Size);
+			std::swap(Tombstones, Other.Tombstones);
+			std::swap(Hash, Other.Hash);
+			return *this;
+		}
+
+		~THashTable()
+		{
+			Clear();
+			delete[] Control;
+			AlignedFree(Slots);
+		}
+
+		/**
+		 * @brief Prepara sitio para `Count` elementos sin volver a crecer.
+		 */
+		void Reserve(size_t Count)
+		{
+			size_t NewCapacity = GroupSize;
+			while (NewCapacity * 7 < Count * 8)
+			{
+				NewCapacity *= 2;
+			}
+			if (NewCapacity > Capacity)
+			{
+				Resize(NewCapacity);
+			}
+		}
+
+		/**
+		 * @brief Elimina el elemento con la clave dada.
+		 *
+		 * @return `false` si no estaba.
+		 */
+		template<typename Q>
+		bool Remove(const Q& Key)
+		{
+			const size_t Index = FindIndex(Key);
+			if (Index == Capacity)
+			{
+				return false;
+			}
+			RemoveIndex(Index);
+			return true;
+		}
+
+		/** @brief `true` si la clave est. */
+		template<typename Q>
+		bool Contains(const Q& Key) const
+		{
+			return FindIndex(Key) != Capacity;
+		}
+
+		/**
+		 * @brief Destruye todos los elementos; conserva la capacidad.
+		 */
+		void Clear()
+		{
+			if (Size > 0)
+			{
+				for (size_t i = 0; i < Capacity; ++i)
+				{
+					if (Control[i] >= 0)
+					{
+						Slots[i].~E();
+					}
+				}
+			}
+			if (Control)
+			{
+				memset(Control, Empty, Capacity);
+			}
+			Size = 0;
+			Tombstones = 0;
+		}
+
+		/** @brief Elementos actuales. */
+		size_t Num() const { return Size; }
+
+		/** @brief `true` si no tiene elementos. */
+		bool IsEmpty() const { return Size == 0; }
+
+		/** @brief Huecos de la tabla (caben 7/8 antes de crecer). */
+		size_t GetCapacity() const { return Capacity; }
+
+		/**
+		 * @brief Iterador sobre los elementos (orden sin especificar). Quitar el elemento
+		 * actual con `Remove` no invalida el iterador.
+		 */
+		template<typename ElementT, typename TableT>
+		class TIterator
+		{
+		public:
+			TIterator(TableT* InTable, size_t InIndex) : Table(InTable), Index(InIndex) { Skip(); }
+			ElementT& operator*() const { return Table->Slots[Index]; }
+			ElementT* operator->() const { return &Table->Slots[Index]; }
+			TIterator& operator++() { ++Index; Skip(); return *this; }
+			bool operator!=(const TIterator& Other) const { return Index != Other.Index; }
+			bool operator==(const TIterator& Other) const { return Index == Other.Index; }
+
+		private:
+			void Skip()
+			{
+				while (Index < Table->Capacity && Table->Control[Index] < 0)
+				{
+					++Index;
+				}
+			}
+
+			TableT* Table;
+			size_t Index;
+		};
+
+		typedef TIterator<E, THashTable> Iterator;
+		typedef TIterator<const E, const THashTable> ConstIterator;
+
+		Iterator begin() { return Iterator(this, 0); }
+		Iterator end() { return Iterator(this, Capacity); }
+		ConstIterator begin() const { return ConstIterator(this, 0); }
+		ConstIterator end() const { return ConstIterator(this, Capacity); }
+
+	protected:
+		static const size_t GroupSize = 16;
+		static const int8_t Empty = -128;   ///< Hueco libre (corta las bsquedas).
+		static const int8_t Deleted = -2;   ///< Hueco borrado (las bsquedas siguen).
+
+		int8_t* Control;   ///< Un byte por hueco: `Empty`, `Deleted` o 7 bits del hash.
+		E* Slots;          ///< Elementos; solo estn construidos los huecos con control >= 0.
+		size_t Capacity;   ///< Huecos (0 o potencia de dos, mltiplo de `GroupSize`).
+		size_t Size;       ///< Elementos construidos.
+		size_t Tombstones; ///< Huecos `Deleted`.
+		Hasher Hash;
+
+		/// Hash mezclado de una clave (los de enteros de `std::hash` son la identidad).
+		template<typename Q>
+		size_t HashOf(const Q& Key) const
+		{
+			const uint64_t Mixed = static_cast<uint64_t>(Hash(Key)) * 0x9E3779B97F4A7C15ull;
+			return static_cast<size_t>(Mixed ^ (Mixed >> 32));
+		}
+
+		/**
+		 * @brief ndice del hueco con la clave, o `Capacity` si no est.
+		 *
+		 * Los grupos se recorren en secuencia triangular (g, g+1, g+3, g+6...), que con un
+		 * nmero de grupos potencia de dos visita todos.
+		 */
+		template<typename Q>
+		size_t FindIndex(const Q& Key) const
+		{
+			if (Size == 0)
+			{
+				return Capacity;
+			}
+			const size_t H = HashOf(Key);
+			const int8_t Tag = static_cast<int8_t>(H & 0x7F);
+			const size_t GroupMask = Capacity / GroupSize - 1;
+			size_t Group = (H >> 7) & GroupMask;
+			for (size_t Step = 1; Step <= GroupMask + 1; ++Step)
+			{
+				const int8_t* Ctrl = Control + Group * GroupSize;
+				for (uint32_t Mask = Match(Ctrl, Tag); Mask; Mask &= Mask - 1)
+				{
+					const size_t Index = Group * GroupSize + LowestBit(Mask);
+					if (KeyOf::Get(Slots[Index]) == Key)
+					{
+						return Index;
+					}
+				}
+				if (Match(Ctrl, Empty))
+				{
+					return Capacity;
+				}
+				Group = (Group + Step) & GroupMask;
+			}
+			return Capacity;
+		}
+
+		/**
+		 * @brief Hueco libre para un hash nuevo (crece o limpia borrados si hace falta).
+		 * El llamador construye el elemento en `Slots[Index]` y llama a @ref CommitInsert.
+		 */
+		size_t PrepareInsert(size_t H)
+		{
+			if ((Size + Tombstones + 1) * 8 > Capacity * 7)
+			{
+				// Con muchos borrados basta con reconstruir al mismo tamao.
+				Resize(Capacity == 0 ? GroupSize : ((Size + 1) * 16 > Capacity * 7 ? Capacity * 2 : Capacity));
+			}
+			return FindFree(H);
+		}
+
+		/// Marca como ocupado el hueco de @ref PrepareInsert una vez construido el elemento.
+		void CommitInsert(size_t Index, size_t H)
+		{
+			if (Control[Index] == Deleted)
+			{
+				--Tombstones;
+			}
+			Control[Index] = static_cast<int8_t>(H & 0x7F);
+			++Size;
+		}
+
+		/// Destruye el elemento del hueco y lo libera.
+		void RemoveIndex(size_t Index)
+		{
+			Slots[Index].~E();
+			// Si el grupo tiene un vaco ninguna bsqueda lo ha cruzado: el hueco puede
+			// volver a estar vaco en lugar de dejar un borrado.
+			if (Match(Control + (Index & ~(GroupSize - 1)), Empty))
+			{
+				Control[Index] = Empty;
+			}
+			else
+			{
+				Control[Index] = Deleted;
+				++Tombstones;
+			}
+			--Size;
+		}
+
+	private:
+		/// Bit i a 1 si el control i del grupo es `Value`.
+		static uint32_t Match(const int8_t* Group, int8_t Value)
+		{
+#if defined(EU_HASHTABLE_SSE2)
+			const __m128i Bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Group));
+			return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(Bytes, _mm_set1_epi8(Value))));
+#else
+			uint32_t Mask = 0;
+			for (size_t i = 0; i < GroupSize; ++i)
+			{
+				Mask |= static_cast<uint32_t>(Group[i] == Value) << i;
+			}
+			return Mask;
+#endif
+		}
+
+		/// Bit i a 1 si el hueco i del grupo est vaco o borrado (bit alto del control).
+		static uint32_t MatchFree(const int8_t* Group)
+		{
+#if defined(EU_HASHTABLE_SSE2)
+			return static_cast<uint32_t>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(Group))));
+#else
+			uint32_t Mask = 0;
+			for (size_t i = 0; i < GroupSize; ++i)
+			{
+				Mask |= static_cast<uint32_t>(Group[i] < 0) << i;
+			}
+			return Mask;
+#endif
+		}
+
+		/// ndice del bit 1 ms bajo (`Mask` != 0). Un bucle bit a bit falla el salto en cada bsqueda.
+		static unsigned int LowestBit(uint32_t Mask)
+		{
+#if defined(_MSC_VER)
+			unsigned long Bit;
+			_BitScanForward(&Bit, Mask);
+			return static_cast<unsigned int>(Bit);
+#else
+			return static_cast<unsigned int>(__builtin_ctz(Mask));
+#endif
+		}
+
+		/// Primer hueco libre (vaco o borrado) para un hash; la tabla debe tener sitio.
+		size_t FindFree(size_t H) const
+		{
+			const size_t GroupMask = Capacity / GroupSize - 1;
+			size_t Group = (H >> 7) & GroupMask;
+			for (size_t Step = 1;; ++Step)
+			{
+				const uint32_t Mask = MatchFree(Control + Group * GroupSize);
+				if (Mask)
+				{
+					return Group * GroupSize + LowestBit(Mask);
+				}
+				Group = (Group + Step) & GroupMask;
+			}
+		}
+
+		/**
+		 * @brief Cambia la capacidad (potencia de dos, >= `GroupSize`) y quita los borrados.
+		 */
+		void Resize(size_t NewCapacity)
+		{
+			E* NewSlots = static_cast<E*>(AlignedAlloc(NewCapacity * sizeof(E), alignof(E) > 16 ? alignof(E) : 16));
+			if (!NewSlots)
+			{
+				throw std::bad_alloc();
+			}
+			int8_t* OldControl = Control;
+			E* OldSlots = Slots;
+			const size_t OldCapacity = Capacity;
+			Control = new int8_t[NewCapacity];
+			memset(Control, Empty, NewCapacity);
+			Slots = NewSlots;
+			Capacity = NewCapacity;
+			Tombstones = 0;
+			for (size_t i = 0; i < OldCapacity; ++i)
+			{
+				if (OldControl[i] >= 0)
+				{
+					const size_t H = HashOf(KeyOf::Get(OldSlots[i]));
+					const size_t Index = FindFree(H);
+					Control[Index] = static_cast<int8_t>(H & 0x7F);
+					new (Slots + Index) E(std::move(OldSlots[i]));
+					OldSlots[i].~E();
+				}
+			}
+			delete[] OldControl;
+			AlignedFree(OldSlots);
+		}
+	};
+}
@@ -27,169 +27,110 @@
  * SOFTWARE.
 */
 #pragma once
+#include "THashTable.h"
+
 namespace EU {
+	/// Clave de un par de TMap.
+	struct TMapKeyOf {
+		template<typename PairT>
+		static const decltype(PairT::Key)& Get(const PairT& Pair) { return Pair.Key; }
+	};
+
+	/**
+	 * @brief Par clave-valor guardado en un TMap.
+	 */
+	template<typename K, typename V>
+	struct TMapPair
+	{
+		K Key;
+		V Value;
+	};
+
 	/**
 	 * @brief TMap es una clase de mapa (diccionario) dinmica para almacenar pares clave-valor.
 	 *
-	 * Esta implementacin de TMap proporciona una forma sencilla de almacenar y gestionar
-	 * colecciones de pares clave-valor, con operaciones bsicas como agregar, eliminar y acceder a valores.
-	 * La memoria se gestiona dinmicamente, aumentando la capacidad del mapa segn sea necesario.
+	 * Tabla hash de direccionamiento abierto (ver @ref THashTable): bsquedas en O(1)
+	 * comparando grupos de 16 bytes de control, con los pares en un array plano.
 	 *
 	 * @tparam K El tipo de las claves.
 	 * @tparam V El tipo de los valores.
+	 * @tparam Hasher Hash de las claves (@ref THash por defecto).
+	 *
+	 * @note Para estudiantes: aadir puede mover los pares (al crecer); no guardes
+	 * punteros de @ref Find entre inserciones.
 	 */
-	template<typename K, typename V>
-	class TMap
+	template<typename K, typename V, typename Hasher = THash<K>>
+	class TMap : public THashTable<TMapPair<K, V>, TMapKeyOf, Hasher>
 	{
-	private:
-		struct Pair
-		{
-			K Key;
-			V Value;
-
-			Pair() : Key(), Value() {}
-			Pair(const K& Key, const V& Value) : Key(Key), Value(Value) {}
-		};
-
-		Pair* Data;        ///< Puntero a la memoria donde se almacenan los pares clave-valor.
-		size_t Capacity;   ///< Capacidad actual del mapa (nmero de pares que puede almacenar).
-		size_t Size;       ///< Nmero de pares actualmente en el mapa.
-
-		/**
-		 * @brief Redimensiona el mapa para tener una nueva capacidad.
-		 *
-		 * @param NewCapacity La nueva capacidad del mapa.
-		 */
-		void Resize(size_t NewCapacity)
-		{
-			Pair* NewData = new Pair[NewCapacity];  ///< Crear un nuevo bloque de memoria con la nueva capacidad.
-			for (size_t i = 0; i < Size; ++i)
-			{
-				NewData[i] = Data[i];  ///< Copiar los pares existentes al nuevo bloque de memoria.
-			}
-			delete[] Data;  ///< Liberar la memoria del mapa antiguo.
-			Data = NewData; ///< Actualizar el puntero Data para que apunte al nuevo bloque de memoria.
-			Capacity = NewCapacity;  ///< Actualizar la capacidad del mapa.
-		}
+		typedef THashTable<TMapPair<K, V>, TMapKeyOf, Hasher> Super;
 
 	public:
-		/**
-		 * @brief Constructor por defecto que inicializa el mapa con capacidad y tamao cero.
-		 */
-		TMap()
-			: Data(nullptr), Capacity(0), Size(0)
-		{
-		}
-
-		/**
-		 * @brief Destructor que libera la memoria asignada al mapa.
-		 */
-		~TMap()
-		{
-			delete[] Data;  ///< Liberar la memoria del mapa.
-		}
+		typedef TMapPair<K, V> Pair;
 
 		/**
 		 * @brief Aade un nuevo par clave-valor al mapa.
 		 *
 		 * @param Key La clave del nuevo par.
-		 * @param Value El valor del nuevo par.
+		 * @param Value El valor del nuevo par (sustituye al anterior si la clave ya existe).
 		 */
 		void Add(const K& Key, const V& Value)
 		{
-			for (size_t i = 0; i < Size; ++i)
-			{
-				if (Data[i].Key == Key)
-				{
-					Data[i].Value = Value;  ///< Actualizar el valor si la clave ya existe.
-					return;
-				}
-			}
-			if (Size == Capacity)
-			{
-				Resize(Capacity == 0 ? 1 : Capacity * 2);  ///< Redimensionar si es necesario.
-			}
-			Data[Size++] = Pair(Key, Value);  ///< Aadir el nuevo par y aumentar el tamao.
+			Emplace(Key, Value);
 		}
 
 		/**
-		 * @brief Elimina el par clave-valor en la posicin especificada.
+		 * @brief Inserta o sustituye construyendo el valor con `args`.
 		 *
-		 * @param Key La clave del par a eliminar.
-		 */
-		void Remove(const K& Key)
-		{
-			for (size_t i = 0; i < Size; ++i)
-			{
-				if (Data[i].Key == Key)
-				{
-					for (size_t j = i; j < Size - 1; ++j)
-					{
-						Data[j] = Data[j + 1];  ///< Desplazar los pares hacia la izquierda para llenar el hueco.
-					}
-					--Size;  ///< Disminuir el tamao del mapa.
-					return;
-				}
-			}
-			std::cerr << "Key not found" << std::endl;  ///< Manejar el caso de clave no encontrada.
-		}
-
-		/**
-		 * @brief Sobrecarga del operador [] para acceder a valores por clave.
-		 *
-		 * @param Key La clave del valor a acceder.
-		 * @return Referencia al valor asociado con la clave especificada.
+		 * @return Referencia al valor.
 		 */
-		V& operator[](const K& Key)
+		template<typename Q, typename... Args>
+		V& Emplace(Q&& Key, Args&&... args)
 		{
-			for (size_t i = 0; i < Size; ++i)
+			const size_t Found = this->FindIndex(Key);
+			if (Found != this->Capacity)
 			{
-				if (Data[i].Key == Key)
-				{
-					return Data[i].Value;  ///< Devolver el valor si la clave se encuentra.
-				}
+				this->Slots[Found].Value = V(std::forward<Args>(args)...);
+				return this->Slots[Found].Value;
 			}
-			std::cerr << "Key not found" << std::endl;  ///< Manejar el caso de clave no encontrada.
-			exit(1);  ///< Salir del programa en caso de error.
+			const size_t H = this->HashOf(Key);
+			const size_t Index = this->PrepareInsert(H);
+			new (this->Slots + Index) Pair{ K(std::forward<Q>(Key)), V(std::forward<Args>(args)...) };
+			this->CommitInsert(Index, H);
+			return this->Slots[Index].Value;
 		}
 
 		/**
-		 * @brief Versin constante de la sobrecarga del operador [] para acceder a valores por clave.
+		 * @brief Busca un valor por clave.
 		 *
-		 * @param Key La clave del valor a acceder.
-		 * @return Referencia constante al valor asociado con la clave especificada.
+		 * @return Puntero al valor, o `nullptr` si la clave no est.
 		 */
-		const V& operator[](const K& Key) const
+		template<typename Q>
+		V* Find(const Q& Key)
 		{
-			for (size_t i = 0; i < Size; ++i)
-			{
-				if (Data[i].Key == Key)
-				{
-					return Data[i].Value;  ///< Devolver el valor si la clave se encuentra.
-				}
-			}
-			std::cerr << "Key not found" << std::endl;  ///< Manejar el caso de clave no encontrada.
-			exit(1);  ///< Salir del programa en caso de error.
+			const size_t Index = this->FindIndex(Key);
+			return Index != this->Capacity ? &this->Slots[Index].Value : nullptr;
 		}
 
-		/**
-		 * @brief Devuelve el nmero de pares actualmente en el mapa.
-		 *
-		 * @return El nmero de pares en el mapa.
-		 */
-		size_t Num() const
+		template<typename Q>
+		const V* Find(const Q& Key) const
 		{
-			return Size;  ///< Devolver el tamao actual del mapa.
+			const size_t Index = this->FindIndex(Key);
+			return Index != this->Capacity ? &this->Slots[Index].Value : nullptr;
 		}
 
 		/**
-		 * @brief Devuelve la capacidad actual del mapa.
+		 * @brief Sobrecarga del operador [] para acceder a valores por clave.
 		 *
-		 * @return La capacidad del mapa.
+		 * @param Key La clave del valor a acceder.
+		 * @return Referencia al valor; si la clave no estaba se aade con un valor por defecto.
 		 */
-		size_t GetCapacity() const
+		V& operator[](const K& Key)
 		{
-			return Capacity;  ///< Devolver la capacidad actual del mapa.
+			if (V* Value = Find(Key))
+			{
+				return *Value;
+			}
+			return Emplace(Key);
 		}
 	};
 
@@ -205,12 +146,19 @@ namespace EU {
 
 		MyMap.Remove(2);  ///< Eliminar el par con clave 2.
 
-		std::cout << "Key 1: " << MyMap[1] << std::endl;  ///< Acceder e imprimir el valor asociado con la clave 1.
-		std::cout << "Key 3: " << MyMap[3] << std::endl;  ///< Acceder e imprimir el valor asociado con la clave 3.
+		if (std::string* One = MyMap.Find(1))
+		{
+			std::cout << "Key 1: " << *One << std::endl;
+		}
+		std::cout << "Has 2: " << MyMap.Contains(2) << std::endl;
+
+		TMap<std::string, int> Ids;
+		Ids.Add("Martis", 7);
+		int* Id = Ids.Find("Martis");  ///< Busca con el literal, sin crear un std::string.
 
 		std::cout << "Size: " << MyMap.Num() << ", Capacity: " << MyMap.GetCapacity() << std::endl;  ///< Imprimir el tamao y la capacidad del mapa.
 
 		return 0;
 	}
 	*/
-}
\ No newline at end of file
+}
@@ -27,136 +27,149 @@
  * SOFTWARE.
 */
 #pragma once
+#include "THashTable.h"
+#include <initializer_list>
+#include <iterator>
 
 namespace EU {
+	/// Clave de un elemento de TSet: el propio elemento.
+	struct TSetKeyOf {
+		template<typename T>
+		static const T& Get(const T& Element) { return Element; }
+	};
+
 	/**
 	 * @brief TSet es una clase de conjunto dinmica para almacenar elementos nicos.
 	 *
-	 * Esta implementacin de TSet proporciona una forma sencilla de almacenar y gestionar
-	 * colecciones de elementos nicos, con operaciones bsicas como agregar, eliminar y verificar la existencia de elementos.
-	 * La memoria se gestiona dinmicamente, aumentando la capacidad del conjunto segn sea necesario.
+	 * Tabla hash de direccionamiento abierto (ver @ref THashTable): aadir y comprobar
+	 * son O(1), as que construir un conjunto de N elementos es O(N). Para identificadores
+	 * enteros densos (ndices de entidad, de material) @ref TBitSet ocupa un bit por id.
 	 *
 	 * @tparam T El tipo de los elementos almacenados en el conjunto.
+	 * @tparam Hasher Hash de los elementos (@ref THash por defecto).
 	 */
-	template<typename T>
-	class TSet
+	template<typename T, typename Hasher = THash<T>>
+	class TSet : public THashTable<T, TSetKeyOf, Hasher>
 	{
-	private:
-		T* Data;        ///< Puntero a la memoria donde se almacenan los elementos.
-		size_t Capacity;   ///< Capacidad actual del conjunto (nmero de elementos que puede almacenar).
-		size_t Size;       ///< Nmero de elementos actualmente en el conjunto.
+		typedef THashTable<T, TSetKeyOf, Hasher> Super;
+
+	public:
+		typedef typename Super::ConstIterator ConstIterator;
+
+		TSet() = default;
+
+		TSet(std::initializer_list<T> Elements)
+		{
+			Append(Elements.begin(), Elements.end());
+		}
 
 		/**
-		 * @brief Redimensiona el conjunto para tener una nueva capacidad.
+		 * @brief Aade un nuevo elemento al conjunto.
 		 *
-		 * @param NewCapacity La nueva capacidad del conjunto.
+		 * @param Element El elemento a aadir.
+		 * @return `false` si ya estaba (no se aaden duplicados).
 		 */
-		void Resize(size_t NewCapacity)
+		template<typename Q>
+		bool Add(Q&& Element)
 		{
-			T* NewData = new T[NewCapacity];  ///< Crear un nuevo bloque de memoria con la nueva capacidad.
-			for (size_t i = 0; i < Size; ++i)
+			if (this->FindIndex(Element) != this->Capacity)
 			{
-				NewData[i] = Data[i];  ///< Copiar los elementos existentes al nuevo bloque de memoria.
+				return false;
 			}
-			delete[] Data;  ///< Liberar la memoria del conjunto antiguo.
-			Data = NewData; ///< Actualizar el puntero Data para que apunte al nuevo bloque de memoria.
-			Capacity = NewCapacity;  ///< Actualizar la capacidad del conjunto.
+			const size_t H = this->HashOf(Element);
+			const size_t Index = this->PrepareInsert(H);
+			new (this->Slots + Index) T(std::forward<Q>(Element));
+			this->CommitInsert(Index, H);
+			return true;
 		}
 
-	public:
 		/**
-		 * @brief Constructor por defecto que inicializa el conjunto con capacidad y tamao cero.
+		 * @brief Aade todos los elementos de `[First, Last)` (reserva antes si puede contarlos).
 		 */
-		TSet()
-			: Data(nullptr), Capacity(0), Size(0)
+		template<typename It>
+		void Append(It First, It Last)
 		{
+			AppendRange(First, Last, typename std::iterator_traits<It>::iterator_category());
 		}
 
-		/**
-		 * @brief Destructor que libera la memoria asignada al conjunto.
-		 */
-		~TSet()
+		/** @brief Aade todos los elementos de un contenedor con `begin`/`end`. */
+		template<typename Range>
+		void Append(const Range& Elements)
 		{
-			delete[] Data;  ///< Liberar la memoria del conjunto.
+			Append(std::begin(Elements), std::end(Elements));
 		}
 
 		/**
-		 * @brief Aade un nuevo elemento al conjunto.
-		 *
-		 * @param Element El elemento a aadir.
+		 * @brief Unin: aade los elementos de `Other`.
 		 */
-		void Add(const T& Element)
+		void UnionWith(const TSet& Other)
 		{
-			if (Contains(Element))
-			{
-				return;  ///< No aadir duplicados.
-			}
-			if (Size == Capacity)
+			this->Reserve(this->Num() + Other.Num());
+			for (const T& Element : Other)
 			{
-				Resize(Capacity == 0 ? 1 : Capacity * 2);  ///< Redimensionar si es necesario.
+				Add(Element);
 			}
-			Data[Size++] = Element;  ///< Aadir el nuevo elemento y aumentar el tamao.
 		}
 
 		/**
-		 * @brief Elimina el elemento especificado del conjunto.
-		 *
-		 * @param Element El elemento a eliminar.
+		 * @brief Interseccin: quita los elementos que no estn en `Other`.
 		 */
-		void Remove(const T& Element)
+		void IntersectWith(const TSet& Other)
 		{
-			for (size_t i = 0; i < Size; ++i)
+			for (ConstIterator It = begin(); It != end(); ++It)
 			{
-				if (Data[i] == Element)
+				if (!Other.Contains(*It))
 				{
-					for (size_t j = i; j < Size - 1; ++j)
-					{
-						Data[j] = Data[j + 1];  ///< Desplazar los elementos hacia la izquierda para llenar el hueco.
-					}
-					--Size;  ///< Disminuir el tamao del conjunto.
-					return;
+					this->Remove(*It);
 				}
 			}
-			std::cerr << "Element not found" << std::endl;  ///< Manejar el caso de elemento no encontrado.
 		}
 
-		/**
-		 * @brief Verifica si el conjunto contiene el elemento especificado.
-		 *
-		 * @param Element El elemento a verificar.
-		 * @return true Si el conjunto contiene el elemento.
-		 * @return false Si el conjunto no contiene el elemento.
-		 */
-		bool Contains(const T& Element) const
+		/** @brief Conjunto con los elementos de `A` o de `B`. */
+		static TSet Union(const TSet& A, const TSet& B)
 		{
-			for (size_t i = 0; i < Size; ++i)
+			const bool ALarger = A.Num() >= B.Num();
+			TSet Result(ALarger ? A : B);
+			Result.UnionWith(ALarger ? B : A);
+			return Result;
+		}
+
+		/** @brief Conjunto con los elementos de `A` que tambin estn en `B`. */
+		static TSet Intersect(const TSet& A, const TSet& B)
+		{
+			// Se recorre el menor y se busca en el mayor.
+			const TSet& Smaller = A.Num() <= B.Num() ? A : B;
+			const TSet& Larger = A.Num() <= B.Num() ? B : A;
+			TSet Result;
+			for (const T& Element : Smaller)
 			{
-				if (Data[i] == Element)
+				if (Larger.Contains(Element))
 				{
-					return true;  ///< Devolver true si el elemento se encuentra.
+					Result.Add(Element);
 				}
 			}
-			return false;  ///< Devolver false si el elemento no se encuentra.
+			return Result;
 		}
 
-		/**
-		 * @brief Devuelve el nmero de elementos actualmente en el conjunto.
-		 *
-		 * @return El nmero de elementos en el conjunto.
-		 */
-		size_t Num() const
+		// Solo iteradores constantes: cambiar un elemento cambiara su hash.
+		ConstIterator begin() const { return Super::begin(); }
+		ConstIterator end() const { return Super::end(); }
+
+	private:
+		template<typename It>
+		void AppendRange(It First, It Last, std::forward_iterator_tag)
 		{
-			return Size;  ///< Devolver el tamao actual del conjunto.
+			this->Reserve(this->Num() + static_cast<size_t>(std::distance(First, Last)));
+			AppendRange(First, Last, std::input_iterator_tag());
 		}
 
-		/**
-		 * @brief Devuelve la capacidad actual del conjunto.
-		 *
-		 * @return La capacidad del conjunto.
-		 */
-		size_t GetCapacity() const
+		template<typename It>
+		void AppendRange(It First, It Last, std::input_iterator_tag)
 		{
-			return Capacity;  ///< Devolver la capacidad actual del conjunto.
+			for (; First != Last; ++First)
+			{
+				Add(*First);
+			}
 		}
 	};
 
@@ -175,9 +188,13 @@ namespace EU {
 		std::cout << "Contains 1: " << MySet.Contains(1) << std::endl;  ///< Verificar e imprimir si el conjunto contiene el elemento 1.
 		std::cout << "Contains 2: " << MySet.Contains(2) << std::endl;  ///< Verificar e imprimir si el conjunto contiene el elemento 2.
 
+		std::vector<int> More = { 3, 4, 5 };
+		MySet.Append(More);  ///< Reserva una vez y aade los tres.
+		TSet<int> Common = TSet<int>::Intersect(MySet, TSet<int>{ 4, 5, 6 });
+
 		std::cout << "Size: " << MySet.Num() << ", Capacity: " << MySet.GetCapacity() << std::endl;  ///< Imprimir el tamao y la capacidad del conjunto.
 
 		return 0;
 	}
 	*/
-}
\ No newline at end of file
+}
@@ -0,0 +1,115 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Roberto Charreton
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * In addition, any project or software that uses this library or class must include
+ * the following acknowledgment in the credits:
+ *
+ * "This project uses software developed by Roberto Charreton and Attribute Overload."
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <emmintrin.h>
+
+namespace EU {
+	/**
+	 * @brief Mutex que gira un poco antes de dormir el hilo.
+	 *
+	 * Las secciones crticas del motor son cortas (meter un puntero en una lista, sumar un
+	 * contador): casi siempre el dueo suelta el lock antes de lo que cuesta dormir y
+	 * despertar un hilo. As que:
+	 *
+	 * 1. **Sin contencin**: un `compare_exchange` de 0 a 1, nada ms.
+	 * 2. **Giro**: hasta @ref kSpinCount intentos con `_mm_pause` entre medias (cede el
+	 *    ncleo al otro hilo lgico y no satura el bus).
+	 * 3. **Aparcado**: marca el estado 2 ("hay alguien esperando") y duerme con
+	 *    `std::atomic::wait` (en Windows, `WaitOnAddress`). `unlock` solo despierta a
+	 *    alguien si vio ese 2; sin esperas no hay llamada al sistema.
+	 *
+	 * Los mtodos van en minsculas para cumplir *BasicLockable* y poder usarlo con
+	 * `std::lock_guard` y `std::unique_lock`.
+	 *
+	 * @note Para estudiantes: no es recursivo ni justo. Para una seccin larga (disco,
+	 * crear recursos de GPU) sirve igual `std::mutex`; lo que se gana aqu es en las cortas.
+	 */
+	class SpinMutex
+	{
+	public:
+		/// Intentos girando antes de aparcar el hilo.
+		static const unsigned int kSpinCount = 128;
+
+		SpinMutex() = default;
+		SpinMutex(const SpinMutex&) = delete;
+		SpinMutex& operator=(const SpinMutex&) = delete;
+
+		void lock()
+		{
+			uint32_t Expected = Unlocked;
+			if (!State.compare_exchange_strong(Expected, Locked, std::memory_order_acquire, std::memory_order_relaxed))
+			{
+				LockContended();
+			}
+		}
+
+		bool try_lock()
+		{
+			uint32_t Expected = Unlocked;
+			return State.compare_exchange_strong(Expected, Locked, std::memory_order_acquire, std::memory_order_relaxed);
+		}
+
+		void unlock()
+		{
+			if (State.exchange(Unlocked, std::memory_order_release) == LockedWithWaiters)
+			{
+				State.notify_one();
+			}
+		}
+
+	private:
+		static const uint32_t Unlocked = 0;
+		static const uint32_t Locked = 1;
+		static const uint32_t LockedWithWaiters = 2;
+
+		void LockContended()
+		{
+			for (unsigned int i = 0; i < kSpinCount; ++i)
+			{
+				_mm_pause();
+				// Solo se intenta el `compare_exchange` cuando parece libre: leer no roba la lnea.
+				uint32_t Expected = Unlocked;
+				if (State.load(std::memory_order_relaxed) == Unlocked &&
+					State.compare_exchange_weak(Expected, Locked, std::memory_order_acquire, std::memory_order_relaxed))
+				{
+					return;
+				}
+			}
+			// Quien lo coja desde aqu lo coge "con esperas": al soltarlo despertar a otro.
+			while (State.exchange(LockedWithWaiters, std::memory_order_acquire) != Unlocked)
+			{
+				State.wait(LockedWithWaiters, std::memory_order_relaxed);
+			}
+		}
+
+		std::atomic<uint32_t> State{ Unlocked };
+	};
+}
@@ -0,0 +1,146 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Roberto Charreton
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * In addition, any project or software that uses this library or class must include
+ * the following acknowledgment in the credits:
+ *
+ * "This project uses software developed by Roberto Charreton and Attribute Overload."
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include "TPaddedAtomic.h"
+
+namespace EU {
+	/**
+	 * @brief Cola circular acotada, sin bloqueos, de varios productores y un consumidor.
+	 *
+	 * Variante de la cola acotada de Dmitry Vyukov: cada celda lleva un nmero de
+	 * secuencia que dice de qu vuelta del anillo es y si ya est escrita.
+	 *
+	 * - **Empujar**: el productor reserva la celda de `Tail` con un `compare_exchange`,
+	 *   escribe el valor y publica la celda subiendo su secuencia. Dos productores nunca
+	 *   escriben la misma celda y ninguno espera al otro para reservar.
+	 * - **Sacar**: el consumidor es nico, as que `Head` avanza sin atmicas RMW; la
+	 *   celda se devuelve al anillo sumando `Capacity` a su secuencia.
+	 * - Una celda reservada pero an sin publicar corta la cola: el consumidor la ve vaca
+	 *   hasta que el productor termina (nunca lee un valor a medio escribir).
+	 *
+	 * Para recoger datos de muchos hilos en uno solo: mensajes del log, eventos del
+	 * profiler, peticiones de carga.
+	 *
+	 * @note Para estudiantes: acotada a propsito. Si se llena, `Push` devuelve `false` y
+	 * quien empuja decide (descartar, esperar, contar); una cola que crece sin lmite
+	 * esconde que el consumidor no da abasto.
+	 */
+	template<typename T, size_t Capacity>
+	class TMpscQueue
+	{
+		static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+	public:
+		TMpscQueue()
+		{
+			for (size_t i = 0; i < Capacity; ++i)
+			{
+				Cells[i].Sequence.store(i, std::memory_order_relaxed);
+			}
+		}
+		TMpscQueue(const TMpscQueue&) = delete;
+		TMpscQueue& operator=(const TMpscQueue&) = delete;
+
+		/** @brief Cualquier hilo. @return `false` si est llena (el valor no se mueve). */
+		template<typename U>
+		bool Push(U&& Value)
+		{
+			size_t Position = Tail.Load(std::memory_order_relaxed);
+			Cell* Target;
+			for (;;)
+			{
+				Target = &Cells[Position & (Capacity - 1)];
+				const size_t Sequence = Target->Sequence.load(std::memory_order_acquire);
+				const intptr_t Diff = static_cast<intptr_t>(Sequence) - static_cast<intptr_t>(Position);
+				if (Diff == 0)
+				{
+					// Celda libre en esta vuelta: reservarla (si otro se adelanta, `Position` se recarga).
+					if (Tail.CompareExchange(Position, Position + 1, std::memory_order_relaxed))
+					{
+						break;
+					}
+				}
+				else if (Diff < 0)
+				{
+					// La celda an tiene el valor de la vuelta anterior: llena.
+					return false;
+				}
+				else
+				{
+					Position = Tail.Load(std::memory_order_relaxed);
+				}
+			}
+			Target->Value = std::forward<U>(Value);
+			Target->Sequence.store(Position + 1, std::memory_order_release);
+			return true;
+		}
+
+		/** @brief Solo el consumidor. @return `false` si est vaca (o la siguiente celda no est publicada). */
+		bool Pop(T& OutValue)
+		{
+			const size_t Position = Head.Load(std::memory_order_relaxed);
+			Cell& Source = Cells[Position & (Capacity - 1)];
+			if (Source.Sequence.load(std::memory_order_acquire) != Position + 1)
+			{
+				return false;
+			}
+			OutValue = std::move(Source.Value);
+			Source.Sequence.store(Position + Capacity, std::memory_order_release);
+			Head.Store(Position + 1, std::memory_order_relaxed);
+			return true;
+		}
+
+		/** @brief Elementos reservados en la cola; aproximado con productores trabajando. */
+		size_t Num() const
+		{
+			const size_t H = Head.Load(std::memory_order_relaxed);
+			const size_t T0 = Tail.Load(std::memory_order_relaxed);
+			return T0 > H ? T0 - H : 0;
+		}
+
+		bool IsEmpty() const { return Num() == 0; }
+
+		static constexpr size_t GetCapacity() { return Capacity; }
+
+	private:
+		struct Cell
+		{
+			std::atomic<size_t> Sequence;
+			T Value;
+		};
+
+		TPaddedAtomic<size_t> Head;    ///< Siguiente a sacar (consumidor).
+		TPaddedAtomic<size_t> Tail;    ///< Siguiente celda a reservar (productores).
+		alignas(kCacheLineSize) Cell Cells[Capacity];
+	};
+}
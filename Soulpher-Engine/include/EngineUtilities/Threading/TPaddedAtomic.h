@@ -0,0 +1,76 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Roberto Charreton
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * In addition, any project or software that uses this library or class must include
+ * the following acknowledgment in the credits:
+ *
+ * "This project uses software developed by Roberto Charreton and Attribute Overload."
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace EU {
+	/// Tamao de lnea de cach que se asume para separar datos de hilos distintos.
+	static const size_t kCacheLineSize = 64;
+
+	/**
+	 * @brief Atmico que ocupa una lnea de cach entera.
+	 *
+	 * Dos contadores que escriben hilos distintos y caen en la misma lnea se roban la
+	 * lnea en cada escritura (*false sharing*) aunque no compartan ningn dato. Un
+	 * arreglo de `TPaddedAtomic` (un contador por hilo, las dos puntas de una cola) pone
+	 * cada valor en su propia lnea.
+	 *
+	 * @note Para estudiantes: solo compensa en datos que se escriben mucho desde varios
+	 * hilos; para un contador que se lee casi siempre, 64 bytes por valor es desperdicio.
+	 */
+	template<typename T>
+	struct alignas(kCacheLineSize) TPaddedAtomic
+	{
+		static_assert(sizeof(std::atomic<T>) <= kCacheLineSize, "TPaddedAtomic holds one cache line");
+
+		TPaddedAtomic() : Value(T()) {}
+		explicit TPaddedAtomic(T Initial) : Value(Initial) {}
+		TPaddedAtomic(const TPaddedAtomic&) = delete;
+		TPaddedAtomic& operator=(const TPaddedAtomic&) = delete;
+
+		T Load(std::memory_order Order = std::memory_order_seq_cst) const { return Value.load(Order); }
+		void Store(T NewValue, std::memory_order Order = std::memory_order_seq_cst) { Value.store(NewValue, Order); }
+
+		/** @return El valor anterior. */
+		T FetchAdd(T Delta, std::memory_order Order = std::memory_order_seq_cst) { return Value.fetch_add(Delta, Order); }
+		T FetchSub(T Delta, std::memory_order Order = std::memory_order_seq_cst) { return Value.fetch_sub(Delta, Order); }
+
+		bool CompareExchange(T& Expected, T Desired, std::memory_order Order = std::memory_order_seq_cst)
+		{
+			return Value.compare_exchange_strong(Expected, Desired, Order);
+		}
+
+		std::atomic<T> Value;
+	};
+
+	/// Contador de estadsticas en su propia lnea (sumas `relaxed` desde cualquier hilo).
+	typedef TPaddedAtomic<uint64_t> TPaddedCounter;
+}
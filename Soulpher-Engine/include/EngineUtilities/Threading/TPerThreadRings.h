@@ -0,0 +1,283 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Roberto Charreton
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * In addition, any project or software that uses this library or class must include
+ * the following acknowledgment in the credits:
+ *
+ * "This project uses software developed by Roberto Charreton and Attribute Overload."
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include "TSpscQueue.h"
+
+namespace EU {
+	/**
+	 * @brief Un anillo SPSC por hilo productor y un nico consumidor que los vaca todos.
+	 *
+	 * Para los sistemas en los que muchos hilos publican y uno solo recoge (el log, los
+	 * canales de eventos): cada hilo empuja en su propio TSpscQueue, sin locks ni
+	 * `compare_exchange`.
+	 *
+	 * - **Toma**: el primer @ref Push de un hilo toma un anillo con un mutex; los
+	 *   siguientes lo encuentran en una lista `thread_local` (una entrada por registro
+	 *   que el hilo ha usado).
+	 * - **Reutilizacin**: cuando el hilo termina, su anillo queda libre y lo toma el
+	 *   siguiente hilo nuevo en cuanto est vaco.
+	 * - **Vaciado**: los anillos se publican en un array fijo de `MaxRings` punteros, as
+	 *   que @ref Drain los recorre sin lock mientras otros hilos toman anillos nuevos.
+	 * - **Hilo saliendo**: si un hilo publica despus de destruir su lista (destructores
+	 *   estticos en el hilo principal), toma un anillo que ya no devuelve y lo recuerda
+	 *   en @ref kExitSlots huecos triviales, que siguen vlidos hasta el final.
+	 *
+	 * @tparam T Elemento (copiable).
+	 * @tparam N Elementos por anillo (potencia de dos).
+	 * @tparam MaxRings Hilos que pueden tener anillo a la vez; a partir de ah @ref Push
+	 * devuelve `false`.
+	 *
+	 * @note Para estudiantes: al destruir el registro no se liberan los anillos de hilos
+	 * que siguen vivos (su hilo los devolver al terminar); es una fuga acotada al cierre
+	 * del proceso a cambio de no escribir nunca en memoria liberada.
+	 */
+	template<typename T, size_t N, unsigned int MaxRings>
+	class TPerThreadRings
+	{
+	public:
+		/// Registros que recuerda un hilo que ya destruy su lista.
+		static const unsigned int kExitSlots = 8;
+
+		TPerThreadRings() : Id(NextRegistryId()) {}
+		TPerThreadRings(const TPerThreadRings&) = delete;
+		TPerThreadRings& operator=(const TPerThreadRings&) = delete;
+
+		~TPerThreadRings()
+		{
+			// El anillo del hilo que destruye se libera aqu: su lista ya no lo devolver.
+			if (IsThreadExiting())
+			{
+				ThreadSlot* Exit = GetExitSlots();
+				for (unsigned int i = 0; i < kExitSlots; ++i)
+				{
+					if (Exit[i].Owner == Id)
+					{
+						Exit[i].Owned->Owned.store(false, std::memory_order_release);
+						Exit[i] = ThreadSlot{ 0, nullptr };
+					}
+				}
+			}
+			else
+			{
+				std::vector<ThreadSlot>& Slots = GetThreadSlots().Slots;
+				for (size_t i = 0; i < Slots.size(); ++i)
+				{
+					if (Slots[i].Owner == Id)
+					{
+						Slots[i].Owned->Owned.store(false, std::memory_order_release);
+						Slots.erase(Slots.begin() + i);
+						break;
+					}
+				}
+			}
+			const unsigned int Count = RingCount.load(std::memory_order_acquire);
+			for (unsigned int i = 0; i < Count; ++i)
+			{
+				Ring* R = Rings[i].load(std::memory_order_relaxed);
+				if (!R->Owned.load(std::memory_order_acquire))
+				{
+					delete R;
+				}
+			}
+		}
+
+		/**
+		 * @brief Empuja en el anillo del hilo actual (lo toma si an no tiene).
+		 * @return `false` si el anillo est lleno o ya hay `MaxRings` anillos ocupados.
+		 */
+		bool Push(const T& Value)
+		{
+			Ring* R = GetThreadRing();
+			return R && R->Queue.Push(Value);
+		}
+
+		/**
+		 * @brief Saca todo lo que hay en los anillos y llama a `Func(T&)` con cada elemento.
+		 * @return Elementos entregados.
+		 * @note Un solo consumidor a la vez. El orden se respeta dentro de cada hilo.
+		 */
+		template<typename F>
+		unsigned int Drain(F&& Func)
+		{
+			unsigned int Delivered = 0;
+			const unsigned int Count = RingCount.load(std::memory_order_acquire);
+			T Value;
+			for (unsigned int i = 0; i < Count; ++i)
+			{
+				Ring* R = Rings[i].load(std::memory_order_acquire);
+				while (R->Queue.Pop(Value))
+				{
+					Func(Value);
+					++Delivered;
+				}
+			}
+			return Delivered;
+		}
+
+		/** @brief Anillos creados (ocupados o libres). */
+		unsigned int GetRingCount() const { return RingCount.load(std::memory_order_acquire); }
+
+		static constexpr size_t GetRingCapacity() { return N; }
+
+	private:
+		/// Anillo de un hilo: lo llena ese hilo y lo vaca quien llame a `Drain`.
+		struct Ring
+		{
+			TSpscQueue<T, N> Queue;
+			std::atomic<bool> Owned{ true };    ///< Un hilo vivo lo usa.
+		};
+
+		/// Anillo de este hilo en el registro `Owner`.
+		struct ThreadSlot
+		{
+			uint64_t Owner;
+			Ring* Owned;
+		};
+
+		/// Anillos del hilo actual; los devuelve cuando el hilo termina.
+		struct ThreadSlots
+		{
+			std::vector<ThreadSlot> Slots;
+			~ThreadSlots()
+			{
+				for (const ThreadSlot& Slot : Slots)
+				{
+					Slot.Owned->Owned.store(false, std::memory_order_release);
+				}
+				IsThreadExiting() = true;
+			}
+		};
+
+		/// Identificador nico (las direcciones se repiten entre registros destruidos y nuevos).
+		static uint64_t NextRegistryId()
+		{
+			static std::atomic<uint64_t> s_NextId{ 1 };
+			return s_NextId.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		static ThreadSlots& GetThreadSlots()
+		{
+			static thread_local ThreadSlots s_Slots;
+			return s_Slots;
+		}
+
+		/// `true` cuando la lista del hilo ya se destruy (trivial: sigue siendo legible).
+		static bool& IsThreadExiting()
+		{
+			static thread_local bool s_Exiting = false;
+			return s_Exiting;
+		}
+
+		/// Anillos que toma un hilo que ya destruy su lista; nunca se devuelven.
+		static ThreadSlot* GetExitSlots()
+		{
+			static thread_local ThreadSlot s_Exit[kExitSlots] = {};
+			return s_Exit;
+		}
+
+		/// Anillo del hilo actual; `nullptr` si no quedan.
+		Ring* GetThreadRing()
+		{
+			if (IsThreadExiting())
+			{
+				ThreadSlot* Exit = GetExitSlots();
+				for (unsigned int i = 0; i < kExitSlots; ++i)
+				{
+					if (Exit[i].Owner == Id)
+					{
+						return Exit[i].Owned;
+					}
+				}
+				for (unsigned int i = 0; i < kExitSlots; ++i)
+				{
+					if (!Exit[i].Owned)
+					{
+						Ring* R = AcquireRing();
+						Exit[i] = ThreadSlot{ R ? Id : 0, R };
+						return R;
+					}
+				}
+				return nullptr;
+			}
+			ThreadSlots& Local = GetThreadSlots();
+			for (const ThreadSlot& Slot : Local.Slots)
+			{
+				if (Slot.Owner == Id)
+				{
+					return Slot.Owned;
+				}
+			}
+			Ring* Found = AcquireRing();
+			if (Found)
+			{
+				Local.Slots.push_back(ThreadSlot{ Id, Found });
+			}
+			return Found;
+		}
+
+		/// Anillo libre y vaco, o uno nuevo; `nullptr` con `MaxRings` ocupados.
+		Ring* AcquireRing()
+		{
+			std::lock_guard<std::mutex> Lock(AcquireMutex);
+			const unsigned int Count = RingCount.load(std::memory_order_relaxed);
+			Ring* Found = nullptr;
+			for (unsigned int i = 0; i < Count && !Found; ++i)
+			{
+				// Anillo de un hilo que ya termin, ya vaciado.
+				Ring* R = Rings[i].load(std::memory_order_relaxed);
+				if (!R->Owned.load(std::memory_order_acquire) && R->Queue.IsEmpty())
+				{
+					R->Owned.store(true, std::memory_order_relaxed);
+					Found = R;
+				}
+			}
+			if (!Found)
+			{
+				if (Count == MaxRings)
+				{
+					return nullptr;
+				}
+				Found = new Ring();
+				Rings[Count].store(Found, std::memory_order_release);
+				RingCount.store(Count + 1, std::memory_order_release);
+			}
+			return Found;
+		}
+
+		const uint64_t Id;
+		std::atomic<Ring*> Rings[MaxRings] = {};    ///< Se publican al final: `Drain` los lee sin lock.
+		std::atomic<unsigned int> RingCount{ 0 };
+		std::mutex AcquireMutex;                    ///< Solo para tomar un anillo.
+	};
+}
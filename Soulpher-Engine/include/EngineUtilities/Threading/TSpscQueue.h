@@ -0,0 +1,115 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Roberto Charreton
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * In addition, any project or software that uses this library or class must include
+ * the following acknowledgment in the credits:
+ *
+ * "This project uses software developed by Roberto Charreton and Attribute Overload."
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include "TPaddedAtomic.h"
+
+namespace EU {
+	/**
+	 * @brief Cola circular acotada, sin bloqueos, de un productor y un consumidor.
+	 *
+	 * - El productor solo escribe `Tail` y el consumidor solo escribe `Head`, cada uno en
+	 *   su lnea de cach: ninguna operacin necesita `compare_exchange`.
+	 * - Cada lado guarda una copia del ndice del otro y solo la refresca cuando la cola
+	 *   le parece llena (o vaca); en rgimen normal, empujar y sacar no leen la lnea
+	 *   del otro hilo.
+	 * - `Capacity` es potencia de dos (ndice = contador & mscara) y los contadores no se
+	 *   reinician, as que lleno y vaco no se confunden.
+	 *
+	 * Para hilos dedicados que se pasan datos en una sola direccin (el hilo de render y
+	 * el principal, un hilo de carga y quien lo atiende).
+	 *
+	 * @note Para estudiantes: con dos productores se corrompe sin avisar. Si hay ms de
+	 * uno, TMpscQueue.
+	 */
+	template<typename T, size_t Capacity>
+	class TSpscQueue
+	{
+		static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+	public:
+		TSpscQueue() = default;
+		TSpscQueue(const TSpscQueue&) = delete;
+		TSpscQueue& operator=(const TSpscQueue&) = delete;
+
+		/** @brief Solo el productor. @return `false` si est llena (el valor no se mueve). */
+		template<typename U>
+		bool Push(U&& Value)
+		{
+			const size_t T0 = Tail.Load(std::memory_order_relaxed);
+			if (T0 - CachedHead >= Capacity)
+			{
+				CachedHead = Head.Load(std::memory_order_acquire);
+				if (T0 - CachedHead >= Capacity)
+				{
+					return false;
+				}
+			}
+			Items[T0 & (Capacity - 1)] = std::forward<U>(Value);
+			Tail.Store(T0 + 1, std::memory_order_release);
+			return true;
+		}
+
+		/** @brief Solo el consumidor. @return `false` si est vaca. */
+		bool Pop(T& OutValue)
+		{
+			const size_t H0 = Head.Load(std::memory_order_relaxed);
+			if (H0 == CachedTail)
+			{
+				CachedTail = Tail.Load(std::memory_order_acquire);
+				if (H0 == CachedTail)
+				{
+					return false;
+				}
+			}
+			OutValue = std::move(Items[H0 & (Capacity - 1)]);
+			Head.Store(H0 + 1, std::memory_order_release);
+			return true;
+		}
+
+		/** @brief Elementos en la cola; aproximado si el otro hilo est trabajando. */
+		size_t Num() const
+		{
+			return Tail.Load(std::memory_order_acquire) - Head.Load(std::memory_order_acquire);
+		}
+
+		bool IsEmpty() const { return Num() == 0; }
+
+		static constexpr size_t GetCapacity() { return Capacity; }
+
+	private:
+		TPaddedAtomic<size_t> Head;    ///< Siguiente a sacar (consumidor).
+		TPaddedAtomic<size_t> Tail;    ///< Siguiente hueco libre (productor).
+		alignas(kCacheLineSize) size_t CachedHead = 0; ///< Copia del productor.
+		alignas(kCacheLineSize) size_t CachedTail = 0; ///< Copia del consumidor.
+		alignas(kCacheLineSize) T Items[Capacity];
+	};
+}
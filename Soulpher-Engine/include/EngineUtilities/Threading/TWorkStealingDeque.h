@@ -0,0 +1,141 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Roberto Charreton
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * In addition, any project or software that uses this library or class must include
+ * the following acknowledgment in the credits:
+ *
+ * "This project uses software developed by Roberto Charreton and Attribute Overload."
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+#include "TPaddedAtomic.h"
+
+namespace EU {
+	/**
+	 * @brief Cola de dos extremos de Chase-Lev de capacidad fija (versin C11 de L et al.).
+	 *
+	 * Base de un planificador con robo de tareas: cada hilo tiene la suya.
+	 *
+	 * - **Dueo** (un solo hilo): @ref Push y @ref Pop por abajo, LIFO. Lo ltimo que
+	 *   encol an est en su cach, y en el caso normal no hay ninguna atmica RMW.
+	 * - **Ladrones** (cualquier hilo): @ref Steal por arriba, FIFO, con un
+	 *   `compare_exchange` sobre `Top`. Roban lo ms antiguo, que suele ser lo ms grande.
+	 * - Dueo y ladrones solo compiten por el ltimo elemento; lo resuelve el mismo
+	 *   `compare_exchange`.
+	 *
+	 * `T` tiene que ser trivialmente copiable (en la prctica, un puntero o un ndice): un
+	 * ladrn puede leer una celda que el dueo est a punto de sobrescribir y descartarla
+	 * si pierde la carrera.
+	 *
+	 * @note Para estudiantes: las barreras `seq_cst` de `Pop` y `Steal` no sobran. Sin
+	 * ellas, en x86 el dueo y un ladrn pueden llevarse el mismo ltimo elemento.
+	 */
+	template<typename T, size_t Capacity>
+	class TWorkStealingDeque
+	{
+		static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+		static_assert(std::is_trivially_copyable<T>::value, "TWorkStealingDeque holds trivially copyable values");
+
+	public:
+		TWorkStealingDeque() = default;
+		TWorkStealingDeque(const TWorkStealingDeque&) = delete;
+		TWorkStealingDeque& operator=(const TWorkStealingDeque&) = delete;
+
+		/** @brief Solo el dueo. @return `false` si est llena. */
+		bool Push(T Value)
+		{
+			const long long B = Bottom.Load(std::memory_order_relaxed);
+			const long long T0 = Top.Load(std::memory_order_acquire);
+			if (B - T0 >= static_cast<long long>(Capacity))
+			{
+				return false;
+			}
+			Items[B & Mask].store(Value, std::memory_order_relaxed);
+			Bottom.Store(B + 1, std::memory_order_release);
+			return true;
+		}
+
+		/** @brief Solo el dueo: el ltimo encolado. @return `false` si est vaca. */
+		bool Pop(T& OutValue)
+		{
+			const long long B = Bottom.Load(std::memory_order_relaxed) - 1;
+			Bottom.Store(B, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			long long T0 = Top.Load(std::memory_order_relaxed);
+			if (T0 > B)
+			{
+				Bottom.Store(B + 1, std::memory_order_relaxed);
+				return false;
+			}
+			OutValue = Items[B & Mask].load(std::memory_order_relaxed);
+			if (T0 == B)
+			{
+				// ltimo elemento: se compite con los ladrones por l.
+				const bool Won = Top.CompareExchange(T0, T0 + 1, std::memory_order_seq_cst);
+				Bottom.Store(B + 1, std::memory_order_relaxed);
+				return Won;
+			}
+			return true;
+		}
+
+		/** @brief Cualquier hilo: el ms antiguo. @return `false` si est vaca o se perdi la carrera. */
+		bool Steal(T& OutValue)
+		{
+			long long T0 = Top.Load(std::memory_order_acquire);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			const long long B = Bottom.Load(std::memory_order_acquire);
+			if (T0 >= B)
+			{
+				return false;
+			}
+			const T Value = Items[T0 & Mask].load(std::memory_order_relaxed);
+			if (!Top.CompareExchange(T0, T0 + 1, std::memory_order_seq_cst))
+			{
+				return false;
+			}
+			OutValue = Value;
+			return true;
+		}
+
+		/** @brief Elementos en la cola; aproximado con otros hilos trabajando. */
+		size_t Num() const
+		{
+			const long long B = Bottom.Load(std::memory_order_relaxed);
+			const long long T0 = Top.Load(std::memory_order_relaxed);
+			return B > T0 ? static_cast<size_t>(B - T0) : 0;
+		}
+
+		bool IsEmpty() const { return Num() == 0; }
+
+		static constexpr size_t GetCapacity() { return Capacity; }
+
+	private:
+		static const long long Mask = static_cast<long long>(Capacity) - 1;
+
+		TPaddedAtomic<long long> Top;     ///< Siguiente a robar (ladrones).
+		TPaddedAtomic<long long> Bottom;  ///< Siguiente hueco del dueo.
+		std::atomic<T> Items[Capacity];
+	};
+}
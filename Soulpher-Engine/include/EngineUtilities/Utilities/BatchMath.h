@@ -0,0 +1,567 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Roberto Charreton
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * In addition, any project or software that uses this library or class must include
+ * the following acknowledgment in the credits:
+ *
+ * "This project uses software developed by Roberto Charreton and Attribute Overload."
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#pragma once
+#include <algorithm>
+#include <cfloat>
+#include <cstddef>
+#include "EngineUtilities/Utilities/CpuFeatures.h"
+#include "EngineUtilities/Matrix/Matrix4x4.h"
+#include "EngineUtilities/Vectors/Vector3.h"
+
+namespace EU {
+	/**
+	 * @brief Caja alineada con los ejes.
+	 *
+	 * La caja vaca tiene `Min` en `+FLT_MAX` y `Max` en `-FLT_MAX`: unirla con cualquier
+	 * punto da el punto.
+	 */
+	struct AABB {
+		Vector3 Min = Vector3(FLT_MAX, FLT_MAX, FLT_MAX);		///< Esquina mnima.
+		Vector3 Max = Vector3(-FLT_MAX, -FLT_MAX, -FLT_MAX);	///< Esquina mxima.
+
+		/** @brief `true` si no contiene ningn punto. */
+		bool IsEmpty() const { return Min.x > Max.x || Min.y > Max.y || Min.z > Max.z; }
+	};
+
+	/*
+	 * Operaciones sobre muchos puntos a la vez (importacin, culling, lotes estticos).
+	 *
+	 * Dos formas de pasar los datos:
+	 * - SoA: tres arrays `Xs`, `Ys`, `Zs`. Es la forma rpida: cada instruccin procesa 4
+	 *   (SSE) u 8 (AVX2) puntos sin reordenar nada.
+	 * - Con paso (`Stride`): el `float[3]` de la posicin al principio de cada elemento de
+	 *   un array de vrtices (p. ej. `SimpleVertex::Pos`). Se procesa un punto por
+	 *   instruccin SSE; sirve para no copiar los vrtices a SoA solo para una pasada.
+	 *
+	 * Las funciones de abajo eligen la versin con @ref GetSimdLevel: AVX2 + FMA si la
+	 * CPU la tiene y SSE2 en cualquier otra x86 (la base de x64). `BatchScalar`,
+	 * `BatchSSE` y `BatchAVX2` quedan a la vista para los benchmarks.
+	 *
+	 * Las transformaciones son afines: se ignora la cuarta columna de la matriz y no se
+	 * divide por w (para proyecciones, Matrix4x4::transformPoints).
+	 */
+
+#if defined(EU_SIMD_X86)
+	/**
+	 * @brief 4 puntos o vectores en SoA: una componente por registro SSE.
+	 */
+	struct Vector3x4 {
+		__m128 X, Y, Z;
+
+		/** @brief Carga 4 puntos de los arrays (sin alineacin). */
+		static Vector3x4 Load(const float* Xs, const float* Ys, const float* Zs) {
+			return { _mm_loadu_ps(Xs), _mm_loadu_ps(Ys), _mm_loadu_ps(Zs) };
+		}
+
+		/** @brief El mismo vector en los 4 carriles. */
+		static Vector3x4 Splat(const Vector3& V) {
+			return { _mm_set1_ps(V.x), _mm_set1_ps(V.y), _mm_set1_ps(V.z) };
+		}
+
+		/** @brief Guarda los 4 puntos en los arrays (sin alineacin). */
+		void Store(float* Xs, float* Ys, float* Zs) const {
+			_mm_storeu_ps(Xs, X);
+			_mm_storeu_ps(Ys, Y);
+			_mm_storeu_ps(Zs, Z);
+		}
+
+		Vector3x4 operator+(const Vector3x4& O) const {
+			return { _mm_add_ps(X, O.X), _mm_add_ps(Y, O.Y), _mm_add_ps(Z, O.Z) };
+		}
+
+		Vector3x4 operator-(const Vector3x4& O) const {
+			return { _mm_sub_ps(X, O.X), _mm_sub_ps(Y, O.Y), _mm_sub_ps(Z, O.Z) };
+		}
+
+		/** @brief Escala cada carril por su escalar. */
+		Vector3x4 operator*(__m128 S) const {
+			return { _mm_mul_ps(X, S), _mm_mul_ps(Y, S), _mm_mul_ps(Z, S) };
+		}
+	};
+
+	/** @brief Producto escalar carril a carril. */
+	inline __m128 Dot(const Vector3x4& A, const Vector3x4& B) {
+		return _mm_add_ps(_mm_add_ps(_mm_mul_ps(A.X, B.X), _mm_mul_ps(A.Y, B.Y)), _mm_mul_ps(A.Z, B.Z));
+	}
+
+	inline Vector3x4 Min(const Vector3x4& A, const Vector3x4& B) {
+		return { _mm_min_ps(A.X, B.X), _mm_min_ps(A.Y, B.Y), _mm_min_ps(A.Z, B.Z) };
+	}
+
+	inline Vector3x4 Max(const Vector3x4& A, const Vector3x4& B) {
+		return { _mm_max_ps(A.X, B.X), _mm_max_ps(A.Y, B.Y), _mm_max_ps(A.Z, B.Z) };
+	}
+
+	/** @brief `P * M` para 4 puntos (w = 1, sin dividir). */
+	inline Vector3x4 TransformPoint(const Matrix4x4& M, const Vector3x4& P) {
+		Vector3x4 R;
+		__m128* Out[3] = { &R.X, &R.Y, &R.Z };
+		for (int c = 0; c < 3; ++c) {
+			*Out[c] = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(P.X, _mm_set1_ps(M.m[0][c])), _mm_mul_ps(P.Y, _mm_set1_ps(M.m[1][c]))),
+				_mm_add_ps(_mm_mul_ps(P.Z, _mm_set1_ps(M.m[2][c])), _mm_set1_ps(M.m[3][c])));
+		}
+		return R;
+	}
+
+	/** @brief `V * M` para 4 vectores (w = 0: sin traslacin). */
+	inline Vector3x4 TransformVector(const Matrix4x4& M, const Vector3x4& V) {
+		Vector3x4 R;
+		__m128* Out[3] = { &R.X, &R.Y, &R.Z };
+		for (int c = 0; c < 3; ++c) {
+			*Out[c] = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(V.X, _mm_set1_ps(M.m[0][c])), _mm_mul_ps(V.Y, _mm_set1_ps(M.m[1][c]))),
+				_mm_mul_ps(V.Z, _mm_set1_ps(M.m[2][c])));
+		}
+		return R;
+	}
+
+	/**
+	 * @brief 8 puntos o vectores en SoA (AVX2). Solo tras comprobar @ref GetSimdLevel.
+	 */
+	struct Vector3x8 {
+		__m256 X, Y, Z;
+
+		EU_TARGET("avx2,fma") static Vector3x8 Load(const float* Xs, const float* Ys, const float* Zs) {
+			return { _mm256_loadu_ps(Xs), _mm256_loadu_ps(Ys), _mm256_loadu_ps(Zs) };
+		}
+
+		EU_TARGET("avx2,fma") static Vector3x8 Splat(const Vector3& V) {
+			return { _mm256_set1_ps(V.x), _mm256_set1_ps(V.y), _mm256_set1_ps(V.z) };
+		}
+
+		EU_TARGET("avx2,fma") void Store(float* Xs, float* Ys, float* Zs) const {
+			_mm256_storeu_ps(Xs, X);
+			_mm256_storeu_ps(Ys, Y);
+			_mm256_storeu_ps(Zs, Z);
+		}
+
+		EU_TARGET("avx2,fma") Vector3x8 operator+(const Vector3x8& O) const {
+			return { _mm256_add_ps(X, O.X), _mm256_add_ps(Y, O.Y), _mm256_add_ps(Z, O.Z) };
+		}
+
+		EU_TARGET("avx2,fma") Vector3x8 operator-(const Vector3x8& O) const {
+			return { _mm256_sub_ps(X, O.X), _mm256_sub_ps(Y, O.Y), _mm256_sub_ps(Z, O.Z) };
+		}
+
+		EU_TARGET("avx2,fma") Vector3x8 operator*(__m256 S) const {
+			return { _mm256_mul_ps(X, S), _mm256_mul_ps(Y, S), _mm256_mul_ps(Z, S) };
+		}
+	};
+
+	EU_TARGET("avx2,fma") inline __m256 Dot(const Vector3x8& A, const Vector3x8& B) {
+		return _mm256_fmadd_ps(A.Z, B.Z, _mm256_fmadd_ps(A.Y, B.Y, _mm256_mul_ps(A.X, B.X)));
+	}
+
+	EU_TARGET("avx2,fma") inline Vector3x8 Min(const Vector3x8& A, const Vector3x8& B) {
+		return { _mm256_min_ps(A.X, B.X), _mm256_min_ps(A.Y, B.Y), _mm256_min_ps(A.Z, B.Z) };
+	}
+
+	EU_TARGET("avx2,fma") inline Vector3x8 Max(const Vector3x8& A, const Vector3x8& B) {
+		return { _mm256_max_ps(A.X, B.X), _mm256_max_ps(A.Y, B.Y), _mm256_max_ps(A.Z, B.Z) };
+	}
+
+	/** @brief `P * M` para 8 puntos (w = 1, sin dividir). */
+	EU_TARGET("avx2,fma") inline Vector3x8 TransformPoint(const Matrix4x4& M, const Vector3x8& P) {
+		Vector3x8 R;
+		__m256* Out[3] = { &R.X, &R.Y, &R.Z };
+		for (int c = 0; c < 3; ++c) {
+			__m256 Acc = _mm256_fmadd_ps(P.X, _mm256_set1_ps(M.m[0][c]), _mm256_set1_ps(M.m[3][c]));
+			Acc = _mm256_fmadd_ps(P.Y, _mm256_set1_ps(M.m[1][c]), Acc);
+			*Out[c] = _mm256_fmadd_ps(P.Z, _mm256_set1_ps(M.m[2][c]), Acc);
+		}
+		return R;
+	}
+
+	/** @brief `V * M` para 8 vectores (w = 0: sin traslacin). */
+	EU_TARGET("avx2,fma") inline Vector3x8 TransformVector(const Matrix4x4& M, const Vector3x8& V) {
+		Vector3x8 R;
+		__m256* Out[3] = { &R.X, &R.Y, &R.Z };
+		for (int c = 0; c < 3; ++c) {
+			__m256 Acc = _mm256_mul_ps(V.X, _mm256_set1_ps(M.m[0][c]));
+			Acc = _mm256_fmadd_ps(V.Y, _mm256_set1_ps(M.m[1][c]), Acc);
+			*Out[c] = _mm256_fmadd_ps(V.Z, _mm256_set1_ps(M.m[2][c]), Acc);
+		}
+		return R;
+	}
+#endif
+
+	namespace BatchScalar {
+		inline void TransformPoints(const Matrix4x4& M, const float* Xs, const float* Ys, const float* Zs,
+			size_t Count, float* OutXs, float* OutYs, float* OutZs) {
+			for (size_t i = 0; i < Count; ++i) {
+				const float X = Xs[i], Y = Ys[i], Z = Zs[i];
+				OutXs[i] = X * M.m[0][0] + Y * M.m[1][0] + Z * M.m[2][0] + M.m[3][0];
+				OutYs[i] = X * M.m[0][1] + Y * M.m[1][1] + Z * M.m[2][1] + M.m[3][1];
+				OutZs[i] = X * M.m[0][2] + Y * M.m[1][2] + Z * M.m[2][2] + M.m[3][2];
+			}
+		}
+
+		inline void TransformVectors(const Matrix4x4& M, const float* Xs, const float* Ys, const float* Zs,
+			size_t Count, float* OutXs, float* OutYs, float* OutZs) {
+			for (size_t i = 0; i < Count; ++i) {
+				const float X = Xs[i], Y = Ys[i], Z = Zs[i];
+				OutXs[i] = X * M.m[0][0] + Y * M.m[1][0] + Z * M.m[2][0];
+				OutYs[i] = X * M.m[0][1] + Y * M.m[1][1] + Z * M.m[2][1];
+				OutZs[i] = X * M.m[0][2] + Y * M.m[1][2] + Z * M.m[2][2];
+			}
+		}
+
+		inline void TransformPoints(const Matrix4x4& M, const void* Input, size_t InputStride,
+			void* Output, size_t OutputStride, size_t Count) {
+			const char* In = static_cast<const char*>(Input);
+			char* Out = static_cast<char*>(Output);
+			for (size_t i = 0; i < Count; ++i, In += InputStride, Out += OutputStride) {
+				const float* P = reinterpret_cast<const float*>(In);
+				const float X = P[0], Y = P[1], Z = P[2];
+				float* R = reinterpret_cast<float*>(Out);
+				R[0] = X * M.m[0][0] + Y * M.m[1][0] + Z * M.m[2][0] + M.m[3][0];
+				R[1] = X * M.m[0][1] + Y * M.m[1][1] + Z * M.m[2][1] + M.m[3][1];
+				R[2] = X * M.m[0][2] + Y * M.m[1][2] + Z * M.m[2][2] + M.m[3][2];
+			}
+		}
+
+		inline AABB ComputeAABB(const float* Xs, const float* Ys, const float* Zs, size_t Count) {
+			AABB Box;
+			for (size_t i = 0; i < Count; ++i) {
+				Box.Min = Vector3((std::min)(Box.Min.x, Xs[i]), (std::min)(Box.Min.y, Ys[i]), (std::min)(Box.Min.z, Zs[i]));
+				Box.Max = Vector3((std::max)(Box.Max.x, Xs[i]), (std::max)(Box.Max.y, Ys[i]), (std::max)(Box.Max.z, Zs[i]));
+			}
+			return Box;
+		}
+
+		inline AABB ComputeAABB(const void* Positions, size_t Stride, size_t Count) {
+			AABB Box;
+			const char* In = static_cast<const char*>(Positions);
+			for (size_t i = 0; i < Count; ++i, In += Stride) {
+				const float* P = reinterpret_cast<const float*>(In);
+				Box.Min = Vector3((std::min)(Box.Min.x, P[0]), (std::min)(Box.Min.y, P[1]), (std::min)(Box.Min.z, P[2]));
+				Box.Max = Vector3((std::max)(Box.Max.x, P[0]), (std::max)(Box.Max.y, P[1]), (std::max)(Box.Max.z, P[2]));
+			}
+			return Box;
+		}
+
+		/** @brief AABB de la caja transformada: centro transformado y extensin por |M|. */
+		inline AABB TransformAABB(const Matrix4x4& M, const AABB& Box) {
+			const float C[3] = { (Box.Min.x + Box.Max.x) * 0.5f, (Box.Min.y + Box.Max.y) * 0.5f, (Box.Min.z + Box.Max.z) * 0.5f };
+			const float E[3] = { (Box.Max.x - Box.Min.x) * 0.5f, (Box.Max.y - Box.Min.y) * 0.5f, (Box.Max.z - Box.Min.z) * 0.5f };
+			float Wc[3], We[3];
+			for (int c = 0; c < 3; ++c) {
+				Wc[c] = C[0] * M.m[0][c] + C[1] * M.m[1][c] + C[2] * M.m[2][c] + M.m[3][c];
+				We[c] = E[0] * fabs(M.m[0][c]) + E[1] * fabs(M.m[1][c]) + E[2] * fabs(M.m[2][c]);
+			}
+			AABB Result;
+			Result.Min = Vector3(Wc[0] - We[0], Wc[1] - We[1], Wc[2] - We[2]);
+			Result.Max = Vector3(Wc[0] + We[0], Wc[1] + We[1], Wc[2] + We[2]);
+			return Result;
+		}
+	}
+
+#if defined(EU_SIMD_X86)
+	namespace BatchSSE {
+		namespace Detail {
+			/// Lee `float[3]` sin pasarse del tercer float (el cuarto carril queda a 0).
+			inline __m128 Load3(const float* P) {
+				const __m128 XY = _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double*>(P)));
+				return _mm_movelh_ps(XY, _mm_load_ss(P + 2));
+			}
+
+			/// Escribe los tres primeros carriles en `float[3]`.
+			inline void Store3(float* P, __m128 V) {
+				_mm_store_sd(reinterpret_cast<double*>(P), _mm_castps_pd(V));
+				_mm_store_ss(P + 2, _mm_movehl_ps(V, V));
+			}
+
+			/// Mnimo (o mximo) de los 4 carriles.
+			inline float ReduceMin(__m128 V) {
+				V = _mm_min_ps(V, _mm_movehl_ps(V, V));
+				return _mm_cvtss_f32(_mm_min_ss(V, _mm_shuffle_ps(V, V, 1)));
+			}
+
+			inline float ReduceMax(__m128 V) {
+				V = _mm_max_ps(V, _mm_movehl_ps(V, V));
+				return _mm_cvtss_f32(_mm_max_ss(V, _mm_shuffle_ps(V, V, 1)));
+			}
+
+			/// Filas 1 a 4 de la matriz (la cuarta columna no se usa).
+			struct Rows {
+				__m128 R0, R1, R2, R3;
+				explicit Rows(const Matrix4x4& M)
+					: R0(_mm_loadu_ps(M.m[0])), R1(_mm_loadu_ps(M.m[1])),
+					R2(_mm_loadu_ps(M.m[2])), R3(_mm_loadu_ps(M.m[3])) {}
+			};
+		}
+
+		inline void TransformPoints(const Matrix4x4& M, const float* Xs, const float* Ys, const float* Zs,
+			size_t Count, float* OutXs, float* OutYs, float* OutZs) {
+			size_t i = 0;
+			for (; i + 4 <= Count; i += 4) {
+				TransformPoint(M, Vector3x4::Load(Xs + i, Ys + i, Zs + i)).Store(OutXs + i, OutYs + i, OutZs + i);
+			}
+			BatchScalar::TransformPoints(M, Xs + i, Ys + i, Zs + i, Count - i, OutXs + i, OutYs + i, OutZs + i);
+		}
+
+		inline void TransformVectors(const Matrix4x4& M, const float* Xs, const float* Ys, const float* Zs,
+			size_t Count, float* OutXs, float* OutYs, float* OutZs) {
+			size_t i = 0;
+			for (; i + 4 <= Count; i += 4) {
+				TransformVector(M, Vector3x4::Load(Xs + i, Ys + i, Zs + i)).Store(OutXs + i, OutYs + i, OutZs + i);
+			}
+			BatchScalar::TransformVectors(M, Xs + i, Ys + i, Zs + i, Count - i, OutXs + i, OutYs + i, OutZs + i);
+		}
+
+		inline void TransformPoints(const Matrix4x4& M, const void* Input, size_t InputStride,
+			void* Output, size_t OutputStride, size_t Count) {
+			const Detail::Rows Rows(M);
+			const char* In = static_cast<const char*>(Input);
+			char* Out = static_cast<char*>(Output);
+			for (size_t i = 0; i < Count; ++i, In += InputStride, Out += OutputStride) {
+				const __m128 P = Detail::Load3(reinterpret_cast<const float*>(In));
+				__m128 R = _mm_add_ps(_mm_mul_ps(_mm_shuffle_ps(P, P, 0x00), Rows.R0), Rows.R3);
+				R = _mm_add_ps(R, _mm_mul_ps(_mm_shuffle_ps(P, P, 0x55), Rows.R1));
+				R = _mm_add_ps(R, _mm_mul_ps(_mm_shuffle_ps(P, P, 0xAA), Rows.R2));
+				Detail::Store3(reinterpret_cast<float*>(Out), R);
+			}
+		}
+
+		inline AABB ComputeAABB(const float* Xs, const float* Ys, const float* Zs, size_t Count) {
+			if (Count < 4) {
+				return BatchScalar::ComputeAABB(Xs, Ys, Zs, Count);
+			}
+			Vector3x4 Lo = Vector3x4::Load(Xs, Ys, Zs), Hi = Lo;
+			size_t i = 4;
+			for (; i + 4 <= Count; i += 4) {
+				const Vector3x4 P = Vector3x4::Load(Xs + i, Ys + i, Zs + i);
+				Lo = Min(Lo, P);
+				Hi = Max(Hi, P);
+			}
+			AABB Box = BatchScalar::ComputeAABB(Xs + i, Ys + i, Zs + i, Count - i);
+			Box.Min = Vector3((std::min)(Box.Min.x, Detail::ReduceMin(Lo.X)), (std::min)(Box.Min.y, Detail::ReduceMin(Lo.Y)),
+				(std::min)(Box.Min.z, Detail::ReduceMin(Lo.Z)));
+			Box.Max = Vector3((std::max)(Box.Max.x, Detail::ReduceMax(Hi.X)), (std::max)(Box.Max.y, Detail::ReduceMax(Hi.Y)),
+				(std::max)(Box.Max.z, Detail::ReduceMax(Hi.Z)));
+			return Box;
+		}
+
+		inline AABB ComputeAABB(const void* Positions, size_t Stride, size_t Count) {
+			AABB Box;
+			if (Count == 0) {
+				return Box;
+			}
+			// Dos pares de acumuladores: min/max encadenados esperan cada uno al anterior.
+			const char* In = static_cast<const char*>(Positions);
+			__m128 Lo = Detail::Load3(reinterpret_cast<const float*>(In)), Hi = Lo;
+			__m128 Lo2 = Lo, Hi2 = Hi;
+			size_t i = 1;
+			for (; i + 2 <= Count; i += 2) {
+				const __m128 P = Detail::Load3(reinterpret_cast<const float*>(In + Stride));
+				const __m128 Q = Detail::Load3(reinterpret_cast<const float*>(In + 2 * Stride));
+				In += 2 * Stride;
+				Lo = _mm_min_ps(Lo, P);
+				Hi = _mm_max_ps(Hi, P);
+				Lo2 = _mm_min_ps(Lo2, Q);
+				Hi2 = _mm_max_ps(Hi2, Q);
+			}
+			if (i < Count) {
+				const __m128 P = Detail::Load3(reinterpret_cast<const float*>(In + Stride));
+				Lo = _mm_min_ps(Lo, P);
+				Hi = _mm_max_ps(Hi, P);
+			}
+			Detail::Store3(Box.Min.data(), _mm_min_ps(Lo, Lo2));
+			Detail::Store3(Box.Max.data(), _mm_max_ps(Hi, Hi2));
+			return Box;
+		}
+
+		inline void TransformAABBs(const Matrix4x4* Matrices, size_t MatrixStep, const AABB* Input,
+			AABB* Output, size_t Count) {
+			const __m128 Half = _mm_set1_ps(0.5f);
+			const __m128 AbsMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+			const Matrix4x4* M = Matrices;
+			for (size_t i = 0; i < Count; ++i, M += MatrixStep) {
+				const Detail::Rows Rows(*M);
+				const __m128 Lo = Detail::Load3(Input[i].Min.data());
+				const __m128 Hi = Detail::Load3(Input[i].Max.data());
+				const __m128 C = _mm_mul_ps(_mm_add_ps(Lo, Hi), Half);
+				const __m128 E = _mm_mul_ps(_mm_sub_ps(Hi, Lo), Half);
+				__m128 Wc = _mm_add_ps(_mm_mul_ps(_mm_shuffle_ps(C, C, 0x00), Rows.R0), Rows.R3);
+				Wc = _mm_add_ps(Wc, _mm_mul_ps(_mm_shuffle_ps(C, C, 0x55), Rows.R1));
+				Wc = _mm_add_ps(Wc, _mm_mul_ps(_mm_shuffle_ps(C, C, 0xAA), Rows.R2));
+				__m128 We = _mm_mul_ps(_mm_shuffle_ps(E, E, 0x00), _mm_and_ps(Rows.R0, AbsMask));
+				We = _mm_add_ps(We, _mm_mul_ps(_mm_shuffle_ps(E, E, 0x55), _mm_and_ps(Rows.R1, AbsMask)));
+				We = _mm_add_ps(We, _mm_mul_ps(_mm_shuffle_ps(E, E, 0xAA), _mm_and_ps(Rows.R2, AbsMask)));
+				// Output puede ser Input: se escribe despus de leer la caja entera.
+				Detail::Store3(Output[i].Min.data(), _mm_sub_ps(Wc, We));
+				Detail::Store3(Output[i].Max.data(), _mm_add_ps(Wc, We));
+			}
+		}
+	}
+
+	namespace BatchAVX2 {
+		namespace Detail {
+			EU_TARGET("avx2,fma") inline __m128 Fold(__m256 V, bool Maximum) {
+				const __m128 Low = _mm256_castps256_ps128(V), High = _mm256_extractf128_ps(V, 1);
+				return Maximum ? _mm_max_ps(Low, High) : _mm_min_ps(Low, High);
+			}
+		}
+
+		EU_TARGET("avx2,fma") inline void TransformPoints(const Matrix4x4& M, const float* Xs, const float* Ys,
+			const float* Zs, size_t Count, float* OutXs, float* OutYs, float* OutZs) {
+			size_t i = 0;
+			for (; i + 8 <= Count; i += 8) {
+				TransformPoint(M, Vector3x8::Load(Xs + i, Ys + i, Zs + i)).Store(OutXs + i, OutYs + i, OutZs + i);
+			}
+			BatchSSE::TransformPoints(M, Xs + i, Ys + i, Zs + i, Count - i, OutXs + i, OutYs + i, OutZs + i);
+		}
+
+		EU_TARGET("avx2,fma") inline void TransformVectors(const Matrix4x4& M, const float* Xs, const float* Ys,
+			const float* Zs, size_t Count, float* OutXs, float* OutYs, float* OutZs) {
+			size_t i = 0;
+			for (; i + 8 <= Count; i += 8) {
+				TransformVector(M, Vector3x8::Load(Xs + i, Ys + i, Zs + i)).Store(OutXs + i, OutYs + i, OutZs + i);
+			}
+			BatchSSE::TransformVectors(M, Xs + i, Ys + i, Zs + i, Count - i, OutXs + i, OutYs + i, OutZs + i);
+		}
+
+		EU_TARGET("avx2,fma") inline AABB ComputeAABB(const float* Xs, const float* Ys, const float* Zs, size_t Count) {
+			if (Count < 8) {
+				return BatchSSE::ComputeAABB(Xs, Ys, Zs, Count);
+			}
+			Vector3x8 Lo = Vector3x8::Load(Xs, Ys, Zs), Hi = Lo;
+			size_t i = 8;
+			for (; i + 8 <= Count; i += 8) {
+				const Vector3x8 P = Vector3x8::Load(Xs + i, Ys + i, Zs + i);
+				Lo = Min(Lo, P);
+				Hi = Max(Hi, P);
+			}
+			AABB Box = BatchScalar::ComputeAABB(Xs + i, Ys + i, Zs + i, Count - i);
+			Box.Min = Vector3(
+				(std::min)(Box.Min.x, BatchSSE::Detail::ReduceMin(Detail::Fold(Lo.X, false))),
+				(std::min)(Box.Min.y, BatchSSE::Detail::ReduceMin(Detail::Fold(Lo.Y, false))),
+				(std::min)(Box.Min.z, BatchSSE::Detail::ReduceMin(Detail::Fold(Lo.Z, false))));
+			Box.Max = Vector3(
+				(std::max)(Box.Max.x, BatchSSE::Detail::ReduceMax(Detail::Fold(Hi.X, true))),
+				(std::max)(Box.Max.y, BatchSSE::Detail::ReduceMax(Detail::Fold(Hi.Y, true))),
+				(std::max)(Box.Max.z, BatchSSE::Detail::ReduceMax(Detail::Fold(Hi.Z, true))));
+			return Box;
+		}
+	}
+#endif
+
+	/**
+	 * @brief Transforma puntos SoA: `(Xs[i], Ys[i], Zs[i], 1) * M`.
+	 * @note La salida puede ser la misma que la entrada.
+	 */
+	inline void TransformPoints(const Matrix4x4& M, const float* Xs, const float* Ys, const float* Zs,
+		size_t Count, float* OutXs, float* OutYs, float* OutZs) {
+#if defined(EU_SIMD_X86)
+		if (GetSimdLevel() == SimdLevel::AVX2) {
+			BatchAVX2::TransformPoints(M, Xs, Ys, Zs, Count, OutXs, OutYs, OutZs);
+		} else {
+			BatchSSE::TransformPoints(M, Xs, Ys, Zs, Count, OutXs, OutYs, OutZs);
+		}
+#else
+		BatchScalar::TransformPoints(M, Xs, Ys, Zs, Count, OutXs, OutYs, OutZs);
+#endif
+	}
+
+	/**
+	 * @brief Transforma direcciones SoA (w = 0: sin traslacin).
+	 * @note Para normales con escala no uniforme, pasar la inversa traspuesta.
+	 */
+	inline void TransformVectors(const Matrix4x4& M, const float* Xs, const float* Ys, const float* Zs,
+		size_t Count, float* OutXs, float* OutYs, float* OutZs) {
+#if defined(EU_SIMD_X86)
+		if (GetSimdLevel() == SimdLevel::AVX2) {
+			BatchAVX2::TransformVectors(M, Xs, Ys, Zs, Count, OutXs, OutYs, OutZs);
+		} else {
+			BatchSSE::TransformVectors(M, Xs, Ys, Zs, Count, OutXs, OutYs, OutZs);
+		}
+#else
+		BatchScalar::TransformVectors(M, Xs, Ys, Zs, Count, OutXs, OutYs, OutZs);
+#endif
+	}
+
+	/**
+	 * @brief Transforma el `float[3]` del principio de cada elemento de un array.
+	 * @param Input Primer elemento de entrada; los siguientes a `InputStride` bytes.
+	 * @param Output Primer elemento de salida (puede ser `Input`); solo se escriben los
+	 *   tres floats de la posicin, el resto del elemento no se toca.
+	 */
+	inline void TransformPoints(const Matrix4x4& M, const void* Input, size_t InputStride,
+		void* Output, size_t OutputStride, size_t Count) {
+#if defined(EU_SIMD_X86)
+		BatchSSE::TransformPoints(M, Input, InputStride, Output, OutputStride, Count);
+#else
+		BatchScalar::TransformPoints(M, Input, InputStride, Output, OutputStride, Count);
+#endif
+	}
+
+	/** @brief Caja que contiene los puntos SoA (vaca si `Count == 0`). */
+	inline AABB ComputeAABB(const float* Xs, const float* Ys, const float* Zs, size_t Count) {
+#if defined(EU_SIMD_X86)
+		if (GetSimdLevel() == SimdLevel::AVX2) {
+			return BatchAVX2::ComputeAABB(Xs, Ys, Zs, Count);
+		}
+		return BatchSSE::ComputeAABB(Xs, Ys, Zs, Count);
+#else
+		return BatchScalar::ComputeAABB(Xs, Ys, Zs, Count);
+#endif
+	}
+
+	/** @brief Caja que contiene el `float[3]` del principio de cada elemento (paso en bytes). */
+	inline AABB ComputeAABB(const void* Positions, size_t Stride, size_t Count) {
+#if defined(EU_SIMD_X86)
+		return BatchSSE::ComputeAABB(Positions, Stride, Count);
+#else
+		return BatchScalar::ComputeAABB(Positions, Stride, Count);
+#endif
+	}
+
+	/**
+	 * @brief Transforma cajas con la misma matriz (la caja resultante contiene la caja
+	 * transformada; con rotaciones crece).
+	 * @note La salida puede ser la misma que la entrada.
+	 */
+	inline void TransformAABBs(const Matrix4x4& M, const AABB* Input, AABB* Output, size_t Count) {
+#if defined(EU_SIMD_X86)
+		BatchSSE::TransformAABBs(&M, 0, Input, Output, Count);
+#else
+		for (size_t i = 0; i < Count; ++i) Output[i] = BatchScalar::TransformAABB(M, Input[i]);
+#endif
+	}
+
+	/** @brief Transforma cada caja `Input[i]` con su matriz `Matrices[i]` (culling por objeto). */
+	inline void TransformAABBs(const Matrix4x4* Matrices, const AABB* Input, AABB* Output, size_t Count) {
+#if defined(EU_SIMD_X86)
+		BatchSSE::TransformAABBs(Matrices, 1, Input, Output, Count);
+#else
+		for (size_t i = 0; i < Count; ++i) Output[i] = BatchScalar::TransformAABB(Matrices[i], Input[i]);
+#endif
+	}
+}
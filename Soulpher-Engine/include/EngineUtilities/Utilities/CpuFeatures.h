@@ -0,0 +1,127 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Roberto Charreton
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * In addition, any project or software that uses this library or class must include
+ * the following acknowledgment in the credits:
+ *
+ * "This project uses software developed by Roberto Charreton and Attribute Overload."
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#pragma once
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define EU_SIMD_X86 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#include <immintrin.h>
+#endif
+
+/**
+ * @def EU_TARGET
+ * @brief Permite usar intrnsecos de un conjunto de instrucciones en una sola funcin.
+ *
+ * MSVC deja usar cualquier intrnseco sin `/arch`; GCC y Clang necesitan marcar la
+ * funcin con el conjunto que usa. El cdigo de esas funciones solo debe ejecutarse
+ * tras comprobar la CPU con @ref EU::DetectSimdLevel.
+ */
+#if defined(EU_SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+#define EU_TARGET(Isa) __attribute__((target(Isa)))
+#else
+#define EU_TARGET(Isa)
+#endif
+
+namespace EU {
+	/**
+	 * @brief Mejor conjunto de instrucciones vectoriales que usa la librera.
+	 */
+	enum class SimdLevel {
+		Scalar,	///< Sin SIMD (otras arquitecturas o CPU sin SSE4.1).
+		SSE41,	///< SSE4.1: 4 floats por instruccin.
+		AVX2	///< AVX2 + FMA: 8 floats por instruccin y multiplicacin-suma fusionada.
+	};
+
+	/**
+	 * @brief Consulta `cpuid` (y `xgetbv`: el sistema tiene que guardar los registros
+	 * YMM en los cambios de contexto) y devuelve el mejor nivel disponible.
+	 */
+	inline SimdLevel DetectSimdLevel() {
+#if defined(EU_SIMD_X86)
+		unsigned int Regs[4] = {};	// eax, ebx, ecx, edx
+		unsigned int MaxLeaf = 0;
+#if defined(_MSC_VER)
+		int Info[4];
+		__cpuid(Info, 0);
+		MaxLeaf = static_cast<unsigned int>(Info[0]);
+		__cpuid(Info, 1);
+		for (int i = 0; i < 4; ++i) Regs[i] = static_cast<unsigned int>(Info[i]);
+#else
+		MaxLeaf = __get_cpuid_max(0, nullptr);
+		__get_cpuid(1, &Regs[0], &Regs[1], &Regs[2], &Regs[3]);
+#endif
+		const bool Sse41 = (Regs[2] & (1u << 19)) != 0;
+		const bool Fma = (Regs[2] & (1u << 12)) != 0;
+		const bool OsXsave = (Regs[2] & (1u << 27)) != 0;
+		const bool Avx = (Regs[2] & (1u << 28)) != 0;
+		if (!Sse41) {
+			return SimdLevel::Scalar;
+		}
+		if (!OsXsave || !Avx || !Fma || MaxLeaf < 7) {
+			return SimdLevel::SSE41;
+		}
+#if defined(_MSC_VER)
+		const unsigned long long Xcr0 = _xgetbv(0);
+		__cpuidex(Info, 7, 0);
+		const unsigned int Leaf7Ebx = static_cast<unsigned int>(Info[1]);
+#else
+		unsigned int XcrLow = 0, XcrHigh = 0;
+		__asm__("xgetbv" : "=a"(XcrLow), "=d"(XcrHigh) : "c"(0));
+		const unsigned long long Xcr0 = (static_cast<unsigned long long>(XcrHigh) << 32) | XcrLow;
+		unsigned int Eax = 0, Leaf7Ebx = 0, Ecx = 0, Edx = 0;
+		__cpuid_count(7, 0, Eax, Leaf7Ebx, Ecx, Edx);
+#endif
+		const bool YmmSaved = (Xcr0 & 0x6) == 0x6;	// Estado XMM e YMM.
+		const bool Avx2 = (Leaf7Ebx & (1u << 5)) != 0;
+		return YmmSaved && Avx2 ? SimdLevel::AVX2 : SimdLevel::SSE41;
+#else
+		return SimdLevel::Scalar;
+#endif
+	}
+
+	/**
+	 * @brief Nivel detectado una vez por proceso (la primera llamada consulta la CPU).
+	 */
+	inline SimdLevel GetSimdLevel() {
+		static const SimdLevel Level = DetectSimdLevel();
+		return Level;
+	}
+
+	/** @brief Nombre del nivel para registros y benchmarks. */
+	inline const char* GetSimdLevelName(SimdLevel Level) {
+		switch (Level) {
+		case SimdLevel::SSE41: return "SSE4.1";
+		case SimdLevel::AVX2: return "AVX2";
+		default: return "Scalar";
+		}
+	}
+}
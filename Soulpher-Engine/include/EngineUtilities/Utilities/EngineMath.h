@@ -27,6 +27,8 @@
  * SOFTWARE.
 */
 #pragma once
+#include "EngineUtilities/Utilities/FastMath.h"
+
 namespace EU {
 
   // Constantes matemticas
@@ -34,23 +36,16 @@ namespace EU {
   constexpr float E = 2.71828182845904523536f;
 
 	/**
-		 * @brief Computes the square root using the Newton-Raphson method.
+		 * @brief Computes the square root with the CPU instruction (see FastMath::Sqrt).
 		 *
 		 * @param value The value to compute the square root of.
-		 * @return The computed square root.
+		 * @return The computed square root, or 0 for negative input.
 		 */
 	inline float sqrt(float value) {
 		if (value < 0) {
 			return 0; // Handle negative input gracefully.
 		}
-		float x = value;
-		float y = 1.0f;
-		float epsilon = 0.00001f; // Desired precision.
-		while (x - y > epsilon) {
-			x = (x + y) / 2.0f;
-			y = value / x;
-		}
-		return x;
+		return FastMath::Sqrt(value);
 	}
 
   /**
@@ -170,18 +165,10 @@ namespace EU {
    * Calcula el seno de un ngulo en radianes.
    * @param angle ngulo en radianes.
    * @return Valor del seno del ngulo.
+   * @note Precisin y dominio en FastMath::Sin (nivel preciso).
    */
   inline float sin(float angle) {
-    float result = 0.0f;
-    float term = angle;
-    float angle_squared = angle * angle;
-    int n = 1;
-    while (term > 1e-6f || term < -1e-6f) {
-      result += term;
-      term *= -angle_squared / ((2 * n) * (2 * n + 1));
-      ++n;
-    }
-    return result;
+    return FastMath::Sin(angle);
   }
 
   /**
@@ -190,7 +177,7 @@ namespace EU {
    * @return Valor del coseno del ngulo.
    */
   inline float cos(float angle) {
-    return sin(angle + PI / 2);
+    return FastMath::Cos(angle);
   }
 
   /**
@@ -252,7 +239,7 @@ namespace EU {
    * @return Seno hiperblico.
    */
   inline float sinh(float value) {
-    return (exp(value) - exp(-value)) / 2;
+    return (FastMath::Exp(value) - FastMath::Exp(-value)) / 2;
   }
 
   /**
@@ -261,7 +248,7 @@ namespace EU {
    * @return Coseno hiperblico.
    */
   inline float cosh(float value) {
-    return (exp(value) + exp(-value)) / 2;
+    return (FastMath::Exp(value) + FastMath::Exp(-value)) / 2;
   }
 
   /**
@@ -299,13 +286,7 @@ namespace EU {
    * @return Valor de e^x.
    */
   inline float exp(float value) {
-    float result = 1.0f;
-    float term = 1.0f;
-    for (int n = 1; n < 20; ++n) {
-      term *= value / n;
-      result += term;
-    }
-    return result;
+    return FastMath::Exp(value);
   }
 
   /**
@@ -314,17 +295,8 @@ namespace EU {
    * @return Logaritmo natural.
    */
   inline float log(float value) {
-    // Aproximacin usando la serie de Taylor
     if (value <= 0) return 0;
-    float x = (value - 1) / (value + 1);
-    float x2 = x * x;
-    float result = 0.0f;
-    float term = x;
-    for (int n = 1; n < 20; ++n) {
-      result += term / (2 * n - 1);
-      term *= x2;
-    }
-    return 2 * result;
+    return FastMath::Log(value);
   }
 
   /**
@@ -333,7 +305,7 @@ namespace EU {
    * @return Logaritmo en base 10.
    */
   inline float log10(float value) {
-    return log(value) / log(10);
+    return log(value) * 0.434294481903251828f; // 1 / ln(10)
   }
 
   // Operaciones de Redondeo Avanzadas
@@ -0,0 +1,559 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Roberto Charreton
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * In addition, any project or software that uses this library or class must include
+ * the following acknowledgment in the credits:
+ *
+ * "This project uses software developed by Roberto Charreton and Attribute Overload."
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include "EngineUtilities/Utilities/CpuFeatures.h"
+
+namespace EU {
+	/**
+	 * @brief Funciones trascendentes por polinomios minimax, sin bucles: el coste no
+	 * depende del valor de entrada.
+	 *
+	 * Cada funcin tiene dos niveles (@ref Tier) y tres anchos: `float`, `__m128` (4
+	 * valores, SSE2) y `__m256` (8 valores, AVX2 + FMA; solo tras comprobar
+	 * @ref GetSimdLevel). El esquema es siempre el mismo: reducir el argumento a un
+	 * intervalo pequeo con operaciones exactas, evaluar ah un polinomio y deshacer la
+	 * reduccin.
+	 *
+	 * - `Sin`, `Cos`, `SinCos`: reduccin a `[-pi/4, pi/4]` en tres pasos (Cody-Waite) y
+	 *   cuadrante para elegir seno o coseno y el signo.
+	 * - `Exp2`, `Exp`: parte entera al exponente del float y `2^f` con `|f| <= 1/2`.
+	 * - `Log2`, `Log`: exponente del float y `log2(m)` con `m` en `[sqrt(1/2), sqrt(2))`.
+	 * - `Rsqrt`, `Sqrt`: instruccin de la CPU; el nivel rpido usa la estimacin de 12
+	 *   bits de `rsqrtps` con un paso de Newton.
+	 *
+	 * Error mximo medido frente a `double` en 20 millones de valores del dominio (ULP =
+	 * unidad en el ltimo bit del float; en seno y coseno el error es absoluto, porque
+	 * cerca de los ceros de la funcin el ULP del resultado no tiene sentido):
+	 *
+	 * | Funcin | Dominio             | Precise                           | Fast            |
+	 * |---------|---------------------|-----------------------------------|-----------------|
+	 * | Sin/Cos | `|x| <= 8192`       | 9.4e-8 abs. (1.5 ULP en [-pi, pi]) | 1.4e-5 abs.     |
+	 * | Exp2    | `[-126, 128)`       | 1.2 ULP                           | 1.0e-4 rel.     |
+	 * | Exp     | `[-87.3, 88.7]`     | 1.5 ULP                           | 1.1e-4 rel.     |
+	 * | Log2    | normales `> 0`      | 2.1 ULP                           | 2.9e-5 abs.     |
+	 * | Log     | normales `> 0`      | 2.4 ULP                           | 2.4e-5 abs.     |
+	 * | Rsqrt   | normales `> 0`      | 1.5 ULP                           | 4.2 ULP         |
+	 * | Sqrt    | `>= 0`              | 0.5 ULP (la instruccin)          | 3.9 ULP         |
+	 *
+	 * Fuera del dominio el resultado no est definido (sin comprobaciones de NaN ni
+	 * infinito: es lo que las hace baratas). `Exp2`/`Exp` saturan a los extremos en vez
+	 * de dar 0 o infinito. La versin de 8 valores usa FMA y puede diferir de las otras
+	 * en el ltimo bit.
+	 *
+	 * @note Para estudiantes: el nivel rpido sirve para lo que se ve y no se acumula
+	 * (animacin procedural, partculas, atenuaciones); para fsica o transformaciones
+	 * que se encadenan, el preciso.
+	 */
+	namespace FastMath {
+		/// Nivel de precisin.
+		enum class Tier {
+			Precise,	///< Error de pocos ULP.
+			Fast		///< Polinomios ms cortos, unos 4-5 dgitos correctos.
+		};
+
+		namespace Detail {
+			// pi/2 en tres partes: las dos primeras tienen pocos bits, as que `k * parte`
+			// es exacto y la resta no pierde precisin (Cody-Waite).
+			const float kPiOver2Hi = 1.5703125f;
+			const float kPiOver2Mid = 4.837512969970703125e-4f;
+			const float kPiOver2Lo = 7.54978995489188216e-8f;
+			const float kTwoOverPi = 0.636619772367581343f;
+
+			// ln(2) en dos partes para reducir `Exp`.
+			const float kLn2Hi = 0.693359375f;
+			const float kLn2Lo = -2.12194440e-4f;
+			const float kLn2 = 0.693147180559945309f;
+			const float kLog2E = 1.44269504088896341f;
+			const float kSqrtHalf = 0.707106781186547524f;
+
+			// Seno y coseno en [-pi/4, pi/4] (z = r^2). Precise: coeficientes de Cephes.
+			const float kSinP1 = -1.6666654611e-1f, kSinP2 = 8.3321608736e-3f, kSinP3 = -1.9515295891e-4f;
+			const float kCosP1 = 4.166664568298827e-2f, kCosP2 = -1.388731625493765e-3f, kCosP3 = 2.443315711809948e-5f;
+			const float kSinF1 = -1.666339038e-1f, kSinF2 = 8.163281903e-3f;
+			const float kCosF1 = -4.997605570e-1f, kCosF2 = 4.045845214e-2f;
+
+			// 2^f - 1 en [-1/2, 1/2], sin trmino constante.
+			const float kExp2P[6] = { 6.931472029e-1f, 2.402264791e-1f, 5.550332471e-2f,
+				9.618437358e-3f, 1.339887441e-3f, 1.535336191e-4f };
+			const float kExp2F[3] = { 6.932829272e-1f, 2.422109595e-1f, 5.500893049e-2f };
+
+			// log2(1 + u) / u en [sqrt(1/2) - 1, sqrt(2) - 1].
+			const float kLog2P[9] = { 1.442695004f, -7.213473468e-1f, 4.809106429e-1f, -3.607036828e-1f,
+				2.879162481e-1f, -2.389448218e-1f, 2.157156068e-1f, -2.072697431e-1f, 1.258370128e-1f };
+			const float kLog2F[5] = { 1.442646251f, -7.205549733e-1f, 4.853065216e-1f, -3.908924257e-1f,
+				2.547518050e-1f };
+
+			inline uint32_t AsBits(float Value) {
+				uint32_t Bits;
+				std::memcpy(&Bits, &Value, sizeof(Bits));
+				return Bits;
+			}
+
+			inline float AsFloat(uint32_t Bits) {
+				float Value;
+				std::memcpy(&Value, &Bits, sizeof(Value));
+				return Value;
+			}
+
+			/// Redondeo al entero ms cercano (los empates dan igual: el polinomio cubre ambos lados).
+			inline int RoundToInt(float Value) {
+				return static_cast<int>(Value + (Value >= 0.0f ? 0.5f : -0.5f));
+			}
+
+			template<Tier T>
+			inline float SinPoly(float R, float Z) {
+				return T == Tier::Precise
+					? R + R * Z * (kSinP1 + Z * (kSinP2 + Z * kSinP3))
+					: R + R * Z * (kSinF1 + Z * kSinF2);
+			}
+
+			template<Tier T>
+			inline float CosPoly(float Z) {
+				return T == Tier::Precise
+					? 1.0f - 0.5f * Z + Z * Z * (kCosP1 + Z * (kCosP2 + Z * kCosP3))
+					: 1.0f + Z * (kCosF1 + Z * kCosF2);
+			}
+
+			/// 2^f con |f| <= 1/2.
+			template<Tier T>
+			inline float Exp2Poly(float F) {
+				if (T == Tier::Precise) {
+					return 1.0f + F * (kExp2P[0] + F * (kExp2P[1] + F * (kExp2P[2] + F * (kExp2P[3] +
+						F * (kExp2P[4] + F * kExp2P[5])))));
+				}
+				return 1.0f + F * (kExp2F[0] + F * (kExp2F[1] + F * kExp2F[2]));
+			}
+
+			/// log2(1 + u).
+			template<Tier T>
+			inline float Log2Poly(float U) {
+				if (T == Tier::Precise) {
+					return U * (kLog2P[0] + U * (kLog2P[1] + U * (kLog2P[2] + U * (kLog2P[3] + U * (kLog2P[4] +
+						U * (kLog2P[5] + U * (kLog2P[6] + U * (kLog2P[7] + U * kLog2P[8]))))))));
+				}
+				return U * (kLog2F[0] + U * (kLog2F[1] + U * (kLog2F[2] + U * (kLog2F[3] + U * kLog2F[4]))));
+			}
+
+			/// 2^k como float (k en [-126, 127]).
+			inline float Pow2(int K) {
+				return AsFloat(static_cast<uint32_t>(K + 127) << 23);
+			}
+		}
+
+		// ==== Escalar ====
+
+		/** @brief `1 / sqrt(x)`. */
+		template<Tier T = Tier::Precise>
+		inline float Rsqrt(float X) {
+#if defined(EU_SIMD_X86)
+			if (T == Tier::Precise) {
+				return 1.0f / _mm_cvtss_f32(_mm_sqrt_ss(_mm_set_ss(X)));
+			}
+			const float Y = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(X)));
+			return Y * (1.5f - 0.5f * X * Y * Y);
+#else
+			// Estimacin por bits y Newton (dos pasos en el nivel preciso).
+			float Y = Detail::AsFloat(0x5f375a86u - (Detail::AsBits(X) >> 1));
+			Y = Y * (1.5f - 0.5f * X * Y * Y);
+			Y = Y * (1.5f - 0.5f * X * Y * Y);
+			if (T == Tier::Precise) {
+				Y = Y * (1.5f - 0.5f * X * Y * Y);
+			}
+			return Y;
+#endif
+		}
+
+		/** @brief Raz cuadrada (`Sqrt(0) == 0`). */
+		template<Tier T = Tier::Precise>
+		inline float Sqrt(float X) {
+#if defined(EU_SIMD_X86)
+			if (T == Tier::Precise) {
+				return _mm_cvtss_f32(_mm_sqrt_ss(_mm_set_ss(X)));
+			}
+#endif
+			return X > 0.0f ? X * Rsqrt<T>(X) : 0.0f;
+		}
+
+		/** @brief Seno y coseno a la vez (comparten la reduccin). */
+		template<Tier T = Tier::Precise>
+		inline void SinCos(float X, float& OutSin, float& OutCos) {
+			const int K = Detail::RoundToInt(X * Detail::kTwoOverPi);
+			const float Kf = static_cast<float>(K);
+			const float R = ((X - Kf * Detail::kPiOver2Hi) - Kf * Detail::kPiOver2Mid) - Kf * Detail::kPiOver2Lo;
+			const float Z = R * R;
+			const float S = Detail::SinPoly<T>(R, Z);
+			const float C = Detail::CosPoly<T>(Z);
+			// Cuadrante: sin(x) = sin(r), cos(r), -sin(r), -cos(r); el coseno va uno por delante.
+			const unsigned int Q = static_cast<unsigned int>(K) & 3u;
+			OutSin = (Q & 1u) ? C : S;
+			OutCos = (Q & 1u) ? S : C;
+			if (Q == 2u || Q == 3u) OutSin = -OutSin;
+			if (Q == 1u || Q == 2u) OutCos = -OutCos;
+		}
+
+		template<Tier T = Tier::Precise>
+		inline float Sin(float X) {
+			float S, C;
+			SinCos<T>(X, S, C);
+			return S;
+		}
+
+		template<Tier T = Tier::Precise>
+		inline float Cos(float X) {
+			float S, C;
+			SinCos<T>(X, S, C);
+			return C;
+		}
+
+		/** @brief `2^x`. */
+		template<Tier T = Tier::Precise>
+		inline float Exp2(float X) {
+			X = X < -126.0f ? -126.0f : (X > 127.99999f ? 127.99999f : X);
+			const int K = Detail::RoundToInt(X);
+			// K puede valer 128: se escala en dos pasos para no salirse del exponente.
+			const int Half = K / 2;
+			return Detail::Exp2Poly<T>(X - static_cast<float>(K)) * Detail::Pow2(Half) * Detail::Pow2(K - Half);
+		}
+
+		/** @brief `e^x`. El nivel preciso reduce con ln(2) partido para no perder bits en `x * log2(e)`. */
+		template<Tier T = Tier::Precise>
+		inline float Exp(float X) {
+			if (T == Tier::Fast) {
+				return Exp2<T>(X * Detail::kLog2E);
+			}
+			X = X < -87.3f ? -87.3f : (X > 88.7f ? 88.7f : X);
+			const int K = Detail::RoundToInt(X * Detail::kLog2E);
+			const float Kf = static_cast<float>(K);
+			const float R = (X - Kf * Detail::kLn2Hi) - Kf * Detail::kLn2Lo;
+			const int Half = K / 2;
+			return Detail::Exp2Poly<T>(R * Detail::kLog2E) * Detail::Pow2(Half) * Detail::Pow2(K - Half);
+		}
+
+		/** @brief `log2(x)`. */
+		template<Tier T = Tier::Precise>
+		inline float Log2(float X) {
+			const uint32_t Bits = Detail::AsBits(X);
+			int E = static_cast<int>((Bits >> 23) & 0xffu) - 127;
+			float M = Detail::AsFloat((Bits & 0x007fffffu) | 0x3f800000u);	// [1, 2)
+			if (M > 2.0f * Detail::kSqrtHalf) {
+				M *= 0.5f;
+				++E;
+			}
+			return static_cast<float>(E) + Detail::Log2Poly<T>(M - 1.0f);
+		}
+
+		/** @brief Logaritmo natural. */
+		template<Tier T = Tier::Precise>
+		inline float Log(float X) {
+			return Log2<T>(X) * Detail::kLn2;
+		}
+
+#if defined(EU_SIMD_X86)
+		// ==== 4 valores (SSE2) ====
+
+		namespace Detail {
+			template<Tier T>
+			inline __m128 SinPoly4(__m128 R, __m128 Z) {
+				__m128 P;
+				if (T == Tier::Precise) {
+					P = _mm_add_ps(_mm_set1_ps(kSinP2), _mm_mul_ps(Z, _mm_set1_ps(kSinP3)));
+					P = _mm_add_ps(_mm_set1_ps(kSinP1), _mm_mul_ps(Z, P));
+				}
+				else {
+					P = _mm_add_ps(_mm_set1_ps(kSinF1), _mm_mul_ps(Z, _mm_set1_ps(kSinF2)));
+				}
+				return _mm_add_ps(R, _mm_mul_ps(_mm_mul_ps(R, Z), P));
+			}
+
+			template<Tier T>
+			inline __m128 CosPoly4(__m128 Z) {
+				const __m128 One = _mm_set1_ps(1.0f);
+				if (T == Tier::Precise) {
+					__m128 P = _mm_add_ps(_mm_set1_ps(kCosP2), _mm_mul_ps(Z, _mm_set1_ps(kCosP3)));
+					P = _mm_add_ps(_mm_set1_ps(kCosP1), _mm_mul_ps(Z, P));
+					const __m128 Base = _mm_sub_ps(One, _mm_mul_ps(_mm_set1_ps(0.5f), Z));
+					return _mm_add_ps(Base, _mm_mul_ps(_mm_mul_ps(Z, Z), P));
+				}
+				const __m128 P = _mm_add_ps(_mm_set1_ps(kCosF1), _mm_mul_ps(Z, _mm_set1_ps(kCosF2)));
+				return _mm_add_ps(One, _mm_mul_ps(Z, P));
+			}
+
+			template<Tier T>
+			inline __m128 Exp2Poly4(__m128 F) {
+				const float* C = T == Tier::Precise ? kExp2P : kExp2F;
+				const int N = T == Tier::Precise ? 6 : 3;
+				__m128 P = _mm_set1_ps(C[N - 1]);
+				for (int i = N - 2; i >= 0; --i) {
+					P = _mm_add_ps(_mm_set1_ps(C[i]), _mm_mul_ps(F, P));
+				}
+				return _mm_add_ps(_mm_set1_ps(1.0f), _mm_mul_ps(F, P));
+			}
+
+			template<Tier T>
+			inline __m128 Log2Poly4(__m128 U) {
+				const float* C = T == Tier::Precise ? kLog2P : kLog2F;
+				const int N = T == Tier::Precise ? 9 : 5;
+				__m128 P = _mm_set1_ps(C[N - 1]);
+				for (int i = N - 2; i >= 0; --i) {
+					P = _mm_add_ps(_mm_set1_ps(C[i]), _mm_mul_ps(U, P));
+				}
+				return _mm_mul_ps(U, P);
+			}
+
+			/// 2^k por carriles (k en [-126, 127]).
+			inline __m128 Pow2(__m128i K) {
+				return _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(K, _mm_set1_epi32(127)), 23));
+			}
+		}
+
+		template<Tier T = Tier::Precise>
+		inline __m128 Rsqrt(__m128 X) {
+			if (T == Tier::Precise) {
+				return _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(X));
+			}
+			const __m128 Y = _mm_rsqrt_ps(X);
+			const __m128 XYY = _mm_mul_ps(_mm_mul_ps(X, Y), Y);
+			return _mm_mul_ps(Y, _mm_sub_ps(_mm_set1_ps(1.5f), _mm_mul_ps(_mm_set1_ps(0.5f), XYY)));
+		}
+
+		template<Tier T = Tier::Precise>
+		inline __m128 Sqrt(__m128 X) {
+			if (T == Tier::Precise) {
+				return _mm_sqrt_ps(X);
+			}
+			// x * rsqrt(x) da NaN en 0 (0 * inf): los carriles que no son > 0 quedan a 0.
+			return _mm_and_ps(_mm_mul_ps(X, Rsqrt<T>(X)), _mm_cmpgt_ps(X, _mm_setzero_ps()));
+		}
+
+		template<Tier T = Tier::Precise>
+		inline void SinCos(__m128 X, __m128& OutSin, __m128& OutCos) {
+			const __m128i K = _mm_cvtps_epi32(_mm_mul_ps(X, _mm_set1_ps(Detail::kTwoOverPi)));
+			const __m128 Kf = _mm_cvtepi32_ps(K);
+			__m128 R = _mm_sub_ps(X, _mm_mul_ps(Kf, _mm_set1_ps(Detail::kPiOver2Hi)));
+			R = _mm_sub_ps(R, _mm_mul_ps(Kf, _mm_set1_ps(Detail::kPiOver2Mid)));
+			R = _mm_sub_ps(R, _mm_mul_ps(Kf, _mm_set1_ps(Detail::kPiOver2Lo)));
+			const __m128 Z = _mm_mul_ps(R, R);
+			const __m128 S = Detail::SinPoly4<T>(R, Z);
+			const __m128 C = Detail::CosPoly4<T>(Z);
+			// Bit 0 del cuadrante: intercambia; bit 1 (y bit 1 de q + 1 para el coseno): signo.
+			const __m128 Swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(K, _mm_set1_epi32(1)), _mm_set1_epi32(1)));
+			const __m128 SinSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(K, _mm_set1_epi32(2)), 30));
+			const __m128 CosSign = _mm_castsi128_ps(_mm_slli_epi32(
+				_mm_and_si128(_mm_add_epi32(K, _mm_set1_epi32(1)), _mm_set1_epi32(2)), 30));
+			const __m128 SinValue = _mm_or_ps(_mm_and_ps(Swap, C), _mm_andnot_ps(Swap, S));
+			const __m128 CosValue = _mm_or_ps(_mm_and_ps(Swap, S), _mm_andnot_ps(Swap, C));
+			OutSin = _mm_xor_ps(SinValue, SinSign);
+			OutCos = _mm_xor_ps(CosValue, CosSign);
+		}
+
+		template<Tier T = Tier::Precise>
+		inline __m128 Sin(__m128 X) {
+			__m128 S, C;
+			SinCos<T>(X, S, C);
+			return S;
+		}
+
+		template<Tier T = Tier::Precise>
+		inline __m128 Cos(__m128 X) {
+			__m128 S, C;
+			SinCos<T>(X, S, C);
+			return C;
+		}
+
+		template<Tier T = Tier::Precise>
+		inline __m128 Exp2(__m128 X) {
+			X = _mm_min_ps(_mm_max_ps(X, _mm_set1_ps(-126.0f)), _mm_set1_ps(127.99999f));
+			const __m128i K = _mm_cvtps_epi32(X);
+			const __m128 F = _mm_sub_ps(X, _mm_cvtepi32_ps(K));
+			const __m128i Half = _mm_srai_epi32(K, 1);
+			return _mm_mul_ps(_mm_mul_ps(Detail::Exp2Poly4<T>(F), Detail::Pow2(Half)), Detail::Pow2(_mm_sub_epi32(K, Half)));
+		}
+
+		template<Tier T = Tier::Precise>
+		inline __m128 Exp(__m128 X) {
+			if (T == Tier::Fast) {
+				return Exp2<T>(_mm_mul_ps(X, _mm_set1_ps(Detail::kLog2E)));
+			}
+			X = _mm_min_ps(_mm_max_ps(X, _mm_set1_ps(-87.3f)), _mm_set1_ps(88.7f));
+			const __m128i K = _mm_cvtps_epi32(_mm_mul_ps(X, _mm_set1_ps(Detail::kLog2E)));
+			const __m128 Kf = _mm_cvtepi32_ps(K);
+			__m128 R = _mm_sub_ps(X, _mm_mul_ps(Kf, _mm_set1_ps(Detail::kLn2Hi)));
+			R = _mm_sub_ps(R, _mm_mul_ps(Kf, _mm_set1_ps(Detail::kLn2Lo)));
+			const __m128i Half = _mm_srai_epi32(K, 1);
+			const __m128 P = Detail::Exp2Poly4<T>(_mm_mul_ps(R, _mm_set1_ps(Detail::kLog2E)));
+			return _mm_mul_ps(_mm_mul_ps(P, Detail::Pow2(Half)), Detail::Pow2(_mm_sub_epi32(K, Half)));
+		}
+
+		template<Tier T = Tier::Precise>
+		inline __m128 Log2(__m128 X) {
+			const __m128i Bits = _mm_castps_si128(X);
+			__m128i E = _mm_sub_epi32(_mm_srli_epi32(Bits, 23), _mm_set1_epi32(127));
+			__m128 M = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(Bits, _mm_set1_epi32(0x007fffff)),
+				_mm_set1_epi32(0x3f800000)));
+			// m > sqrt(2): m / 2 y un exponente ms (la mscara vale -1, de ah la resta).
+			const __m128 Big = _mm_cmpgt_ps(M, _mm_set1_ps(2.0f * Detail::kSqrtHalf));
+			M = _mm_or_ps(_mm_and_ps(Big, _mm_mul_ps(M, _mm_set1_ps(0.5f))), _mm_andnot_ps(Big, M));
+			E = _mm_sub_epi32(E, _mm_castps_si128(Big));
+			return _mm_add_ps(_mm_cvtepi32_ps(E), Detail::Log2Poly4<T>(_mm_sub_ps(M, _mm_set1_ps(1.0f))));
+		}
+
+		template<Tier T = Tier::Precise>
+		inline __m128 Log(__m128 X) {
+			return _mm_mul_ps(Log2<T>(X), _mm_set1_ps(Detail::kLn2));
+		}
+
+		// ==== 8 valores (AVX2 + FMA) ====
+
+		namespace Detail {
+			EU_TARGET("avx2,fma") inline __m256 Horner8(__m256 X, const float* C, int N) {
+				__m256 P = _mm256_set1_ps(C[N - 1]);
+				for (int i = N - 2; i >= 0; --i) {
+					P = _mm256_fmadd_ps(X, P, _mm256_set1_ps(C[i]));
+				}
+				return P;
+			}
+
+			EU_TARGET("avx2,fma") inline __m256 Pow2(__m256i K) {
+				return _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(K, _mm256_set1_epi32(127)), 23));
+			}
+		}
+
+		template<Tier T = Tier::Precise>
+		EU_TARGET("avx2,fma") inline __m256 Rsqrt(__m256 X) {
+			if (T == Tier::Precise) {
+				return _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_sqrt_ps(X));
+			}
+			const __m256 Y = _mm256_rsqrt_ps(X);
+			const __m256 XYY = _mm256_mul_ps(_mm256_mul_ps(X, Y), Y);
+			return _mm256_mul_ps(Y, _mm256_fnmadd_ps(_mm256_set1_ps(0.5f), XYY, _mm256_set1_ps(1.5f)));
+		}
+
+		template<Tier T = Tier::Precise>
+		EU_TARGET("avx2,fma") inline __m256 Sqrt(__m256 X) {
+			if (T == Tier::Precise) {
+				return _mm256_sqrt_ps(X);
+			}
+			return _mm256_and_ps(_mm256_mul_ps(X, Rsqrt<T>(X)), _mm256_cmp_ps(X, _mm256_setzero_ps(), _CMP_GT_OQ));
+		}
+
+		template<Tier T = Tier::Precise>
+		EU_TARGET("avx2,fma") inline void SinCos(__m256 X, __m256& OutSin, __m256& OutCos) {
+			const __m256i K = _mm256_cvtps_epi32(_mm256_mul_ps(X, _mm256_set1_ps(Detail::kTwoOverPi)));
+			const __m256 Kf = _mm256_cvtepi32_ps(K);
+			__m256 R = _mm256_fnmadd_ps(Kf, _mm256_set1_ps(Detail::kPiOver2Hi), X);
+			R = _mm256_fnmadd_ps(Kf, _mm256_set1_ps(Detail::kPiOver2Mid), R);
+			R = _mm256_fnmadd_ps(Kf, _mm256_set1_ps(Detail::kPiOver2Lo), R);
+			const __m256 Z = _mm256_mul_ps(R, R);
+			__m256 S, C;
+			if (T == Tier::Precise) {
+				const float SinC[3] = { Detail::kSinP1, Detail::kSinP2, Detail::kSinP3 };
+				const float CosC[3] = { Detail::kCosP1, Detail::kCosP2, Detail::kCosP3 };
+				S = _mm256_fmadd_ps(_mm256_mul_ps(R, Z), Detail::Horner8(Z, SinC, 3), R);
+				const __m256 Base = _mm256_fnmadd_ps(_mm256_set1_ps(0.5f), Z, _mm256_set1_ps(1.0f));
+				C = _mm256_fmadd_ps(_mm256_mul_ps(Z, Z), Detail::Horner8(Z, CosC, 3), Base);
+			}
+			else {
+				const float SinC[2] = { Detail::kSinF1, Detail::kSinF2 };
+				const float CosC[2] = { Detail::kCosF1, Detail::kCosF2 };
+				S = _mm256_fmadd_ps(_mm256_mul_ps(R, Z), Detail::Horner8(Z, SinC, 2), R);
+				C = _mm256_fmadd_ps(Z, Detail::Horner8(Z, CosC, 2), _mm256_set1_ps(1.0f));
+			}
+			const __m256i One = _mm256_set1_epi32(1);
+			const __m256i Two = _mm256_set1_epi32(2);
+			const __m256 Swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(K, One), One));
+			const __m256 SinSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(K, Two), 30));
+			const __m256 CosSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(K, One), Two), 30));
+			OutSin = _mm256_xor_ps(_mm256_blendv_ps(S, C, Swap), SinSign);
+			OutCos = _mm256_xor_ps(_mm256_blendv_ps(C, S, Swap), CosSign);
+		}
+
+		template<Tier T = Tier::Precise>
+		EU_TARGET("avx2,fma") inline __m256 Sin(__m256 X) {
+			__m256 S, C;
+			SinCos<T>(X, S, C);
+			return S;
+		}
+
+		template<Tier T = Tier::Precise>
+		EU_TARGET("avx2,fma") inline __m256 Cos(__m256 X) {
+			__m256 S, C;
+			SinCos<T>(X, S, C);
+			return C;
+		}
+
+		template<Tier T = Tier::Precise>
+		EU_TARGET("avx2,fma") inline __m256 Exp2(__m256 X) {
+			X = _mm256_min_ps(_mm256_max_ps(X, _mm256_set1_ps(-126.0f)), _mm256_set1_ps(127.99999f));
+			const __m256i K = _mm256_cvtps_epi32(X);
+			const __m256 F = _mm256_sub_ps(X, _mm256_cvtepi32_ps(K));
+			const __m256 P = T == Tier::Precise ? Detail::Horner8(F, Detail::kExp2P, 6) : Detail::Horner8(F, Detail::kExp2F, 3);
+			const __m256i Half = _mm256_srai_epi32(K, 1);
+			return _mm256_mul_ps(_mm256_mul_ps(_mm256_fmadd_ps(F, P, _mm256_set1_ps(1.0f)), Detail::Pow2(Half)),
+				Detail::Pow2(_mm256_sub_epi32(K, Half)));
+		}
+
+		template<Tier T = Tier::Precise>
+		EU_TARGET("avx2,fma") inline __m256 Exp(__m256 X) {
+			if (T == Tier::Fast) {
+				return Exp2<T>(_mm256_mul_ps(X, _mm256_set1_ps(Detail::kLog2E)));
+			}
+			X = _mm256_min_ps(_mm256_max_ps(X, _mm256_set1_ps(-87.3f)), _mm256_set1_ps(88.7f));
+			const __m256i K = _mm256_cvtps_epi32(_mm256_mul_ps(X, _mm256_set1_ps(Detail::kLog2E)));
+			const __m256 Kf = _mm256_cvtepi32_ps(K);
+			__m256 R = _mm256_fnmadd_ps(Kf, _mm256_set1_ps(Detail::kLn2Hi), X);
+			R = _mm256_fnmadd_ps(Kf, _mm256_set1_ps(Detail::kLn2Lo), R);
+			const __m256 F = _mm256_mul_ps(R, _mm256_set1_ps(Detail::kLog2E));
+			const __m256 P = _mm256_fmadd_ps(F, Detail::Horner8(F, Detail::kExp2P, 6), _mm256_set1_ps(1.0f));
+			const __m256i Half = _mm256_srai_epi32(K, 1);
+			return _mm256_mul_ps(_mm256_mul_ps(P, Detail::Pow2(Half)), Detail::Pow2(_mm256_sub_epi32(K, Half)));
+		}
+
+		template<Tier T = Tier::Precise>
+		EU_TARGET("avx2,fma") inline __m256 Log2(__m256 X) {
+			const __m256i Bits = _mm256_castps_si256(X);
+			__m256i E = _mm256_sub_epi32(_mm256_srli_epi32(Bits, 23), _mm256_set1_epi32(127));
+			__m256 M = _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(Bits, _mm256_set1_epi32(0x007fffff)),
+				_mm256_set1_epi32(0x3f800000)));
+			const __m256 Big = _mm256_cmp_ps(M, _mm256_set1_ps(2.0f * Detail::kSqrtHalf), _CMP_GT_OQ);
+			M = _mm256_blendv_ps(M, _mm256_mul_ps(M, _mm256_set1_ps(0.5f)), Big);
+			E = _mm256_sub_epi32(E, _mm256_castps_si256(Big));
+			const __m256 U = _mm256_sub_ps(M, _mm256_set1_ps(1.0f));
+			const __m256 P = T == Tier::Precise ? Detail::Horner8(U, Detail::kLog2P, 9) : Detail::Horner8(U, Detail::kLog2F, 5);
+			return _mm256_fmadd_ps(U, P, _mm256_cvtepi32_ps(E));
+		}
+
+		template<Tier T = Tier::Precise>
+		EU_TARGET("avx2,fma") inline __m256 Log(__m256 X) {
+			return _mm256_mul_ps(Log2<T>(X), _mm256_set1_ps(Detail::kLn2));
+		}
+#endif
+	}
+}
@@ -0,0 +1,53 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Roberto Charreton
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * In addition, any project or software that uses this library or class must include
+ * the following acknowledgment in the credits:
+ *
+ * "This project uses software developed by Roberto Charreton and Attribute Overload."
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace EU {
+	/// Estado inicial de @ref Fnv1a (offset basis de 64 bits).
+	const uint64_t kFnv1aSeed = 14695981039346656037ull;
+
+	/**
+	 * @brief FNV-1a de 64 bits, incremental: `Hash` es el estado acumulado.
+	 *
+	 * Es el hash de las claves de cach del motor (shaders, estados, layouts, horneados,
+	 * `.smesh`, paquete) y de las cadenas de TMap/TSet. Se empieza con @ref kFnv1aSeed y
+	 * se encadenan llamadas: el resultado es el mismo que con todos los bytes seguidos.
+	 *
+	 * @note Para estudiantes: no es criptogrfico ni resistente a colisiones buscadas;
+	 * sirve para detectar cambios, no para verificar datos ajenos.
+	 */
+	inline void Fnv1a(uint64_t& Hash, const void* Data, size_t Size) {
+		const unsigned char* Bytes = static_cast<const unsigned char*>(Data);
+		for (size_t i = 0; i < Size; ++i) {
+			Hash = (Hash ^ Bytes[i]) * 1099511628211ull;
+		}
+	}
+}
@@ -28,8 +28,9 @@
 */
 #pragma once
 
-#include "Utilities/EngineMath.h"
+#include "EngineUtilities/Utilities/EngineMath.h"
 #include "Vector3.h"
+#include "EngineUtilities/Matrix/Matrix4x4.h"
 namespace EU {
 	/**
  * @brief A quaternion class.
@@ -213,23 +214,25 @@ namespace EU {
 		}
 
 		/**
-		 * @brief Converts the quaternion to a 4x4 rotation matrix.
+		 * @brief Converts the (unit) quaternion to a 4x4 rotation matrix.
+		 *
+		 * Uses the row-vector convention of Matrix4x4 (`p' = p * M`), so it matches
+		 * XMMatrixRotationQuaternion. For arrays use EU::QuaternionsToMatrices.
 		 *
 		 * @return The 4x4 matrix representing the rotation.
 		 */
-		/*Matrix4x4 toMatrix() const {
+		Matrix4x4 toMatrix() const {
 			Matrix4x4 result;
-			result[0][0] = 1 - 2 * (y * y + z * z);
-			result[0][1] = 2 * (x * y - z * w);
-			result[0][2] = 2 * (x * z + y * w);
-			result[1][0] = 2 * (x * y + z * w);
-			result[1][1] = 1 - 2 * (x * x + z * z);
-			result[1][2] = 2 * (y * z - x * w);
-			result[2][0] = 2 * (x * z - y * w);
-			result[2][1] = 2 * (y * z + x * w);
-			result[2][2] = 1 - 2 * (x * x + y * y);
-			result[3][3] = 1;
+			result.m[0][0] = 1 - 2 * (y * y + z * z);
+			result.m[0][1] = 2 * (x * y + z * w);
+			result.m[0][2] = 2 * (x * z - y * w);
+			result.m[1][0] = 2 * (x * y - z * w);
+			result.m[1][1] = 1 - 2 * (x * x + z * z);
+			result.m[1][2] = 2 * (y * z + x * w);
+			result.m[2][0] = 2 * (x * z + y * w);
+			result.m[2][1] = 2 * (y * z - x * w);
+			result.m[2][2] = 1 - 2 * (x * x + y * y);
 			return result;
-		}*/
+		}
 	};
 }
@@ -0,0 +1,489 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Roberto Charreton
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * In addition, any project or software that uses this library or class must include
+ * the following acknowledgment in the credits:
+ *
+ * "This project uses software developed by Roberto Charreton and Attribute Overload."
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#pragma once
+#include <cstddef>
+#include "EngineUtilities/Utilities/CpuFeatures.h"
+#include "EngineUtilities/Utilities/FastMath.h"
+#include "EngineUtilities/Matrix/TMatrix.h"
+#include "EngineUtilities/Vectors/Quaternion.h"
+#include "EngineUtilities/Vectors/Vector3.h"
+
+namespace EU {
+	/**
+	 * @brief Matriz afn de 3 filas por 4 columnas en forma de columna: `p' = M * (p, 1)`.
+	 *
+	 * Es la traspuesta de las tres primeras columnas de una @ref Matrix4x4 (vector fila)
+	 * y el formato habitual de las paletas de huesos (`float3x4` en HLSL): 48 bytes en
+	 * lugar de 64. La columna 4 es la traslacin.
+	 */
+	using Matrix3x4 = TMatrix<3, 4, float>;
+
+	/*
+	 * Operaciones sobre arrays de cuaterniones (animacin, `LocalTransform`).
+	 *
+	 * Los cuaterniones se guardan como `Quaternion` (w, x, y, z). Las versiones SIMD
+	 * cargan 4 (SSE) u 8 (AVX2 + FMA) seguidos, los trasponen a un registro por
+	 * componente, calculan y los devuelven a su sitio; el resto del array va por la
+	 * versin escalar. Las funciones de abajo eligen con @ref GetSimdLevel.
+	 *
+	 * - Normalizar: `rsqrt` + un paso de Newton (@ref FastMath::Rsqrt, nivel rpido),
+	 *   ~4 ULP. El cuaternin nulo queda nulo.
+	 * - `Nlerp`: camino corto (se invierte `B` si el producto escalar es negativo),
+	 *   interpolacin lineal y normalizacin. Velocidad angular no constante, pero
+	 *   para los pasos pequeos de una animacin no se nota.
+	 * - `Slerp`: camino corto y el polinomio de Eberly ("A Fast and Accurate Algorithm for
+	 *   Computing SLERP", 2011): sin `acos`, `sin` ni ramas. Error < 1e-6 si la rotacin
+	 *   entre `A` y `B` es menor de 120, hasta 2e-5 cerca de 180. No se renormaliza.
+	 * - A matriz: rotacin, escala opcional por eje (en espacio local) y traslacin
+	 *   opcional, en @ref Matrix3x4.
+	 *
+	 * Las salidas pueden coincidir con las entradas. `T` es el parmetro de interpolacin
+	 * en [0, 1], uno para todo el lote o uno por elemento.
+	 */
+
+	namespace QuaternionScalar {
+		namespace Detail {
+			/// Coeficientes del polinomio de Eberly con 8 trminos (correccin mu en el ltimo).
+			static const float kSlerpMu = 1.85298109240830f;
+			static const float kSlerpU[8] = { 1.0f / (1 * 3), 1.0f / (2 * 5), 1.0f / (3 * 7), 1.0f / (4 * 9),
+				1.0f / (5 * 11), 1.0f / (6 * 13), 1.0f / (7 * 15), kSlerpMu / (8 * 17) };
+			static const float kSlerpV[8] = { 1.0f / 3, 2.0f / 5, 3.0f / 7, 4.0f / 9,
+				5.0f / 11, 6.0f / 13, 7.0f / 15, kSlerpMu * 8 / 17 };
+
+			/// `sin(T * theta) / sin(theta)` con `Xm1 = cos(theta) - 1`.
+			inline float SlerpWeight(float T, float Xm1) {
+				const float SqrT = T * T;
+				float C = 1.0f;
+				for (int i = 7; i >= 0; --i) {
+					C = 1.0f + (kSlerpU[i] * SqrT - kSlerpV[i]) * Xm1 * C;
+				}
+				return T * C;
+			}
+		}
+
+		inline Quaternion Normalize(const Quaternion& Q) {
+			const float LengthSq = Q.w * Q.w + Q.x * Q.x + Q.y * Q.y + Q.z * Q.z;
+			if (LengthSq == 0.0f) {
+				return Quaternion(0, 0, 0, 0);
+			}
+			const float Inv = FastMath::Rsqrt<FastMath::Tier::Fast>(LengthSq);
+			return Quaternion(Q.w * Inv, Q.x * Inv, Q.y * Inv, Q.z * Inv);
+		}
+
+		inline Quaternion Nlerp(const Quaternion& A, const Quaternion& B, float T) {
+			const float Dot = A.w * B.w + A.x * B.x + A.y * B.y + A.z * B.z;
+			const float Tb = Dot < 0.0f ? -T : T;
+			const float Ta = 1.0f - T;
+			return Normalize(Quaternion(A.w * Ta + B.w * Tb, A.x * Ta + B.x * Tb, A.y * Ta + B.y * Tb, A.z * Ta + B.z * Tb));
+		}
+
+		inline Quaternion Slerp(const Quaternion& A, const Quaternion& B, float T) {
+			float Dot = A.w * B.w + A.x * B.x + A.y * B.y + A.z * B.z;
+			const float Sign = Dot < 0.0f ? -1.0f : 1.0f;
+			Dot *= Sign;
+			const float Xm1 = Dot - 1.0f;
+			const float Ta = Detail::SlerpWeight(1.0f - T, Xm1);
+			const float Tb = Detail::SlerpWeight(T, Xm1) * Sign;
+			return Quaternion(A.w * Ta + B.w * Tb, A.x * Ta + B.x * Tb, A.y * Ta + B.y * Tb, A.z * Ta + B.z * Tb);
+		}
+
+		/**
+		 * @brief Rotacin (unitaria), escala local y traslacin a @ref Matrix3x4.
+		 */
+		inline Matrix3x4 ToMatrix(const Quaternion& Q, const Vector3& Scale, const Vector3& Translation) {
+			const float X2 = Q.x + Q.x, Y2 = Q.y + Q.y, Z2 = Q.z + Q.z;
+			const float XX = Q.x * X2, YY = Q.y * Y2, ZZ = Q.z * Z2;
+			const float XY = Q.x * Y2, XZ = Q.x * Z2, YZ = Q.y * Z2;
+			const float WX = Q.w * X2, WY = Q.w * Y2, WZ = Q.w * Z2;
+			return Matrix3x4(
+				(1.0f - YY - ZZ) * Scale.x, (XY - WZ) * Scale.y, (XZ + WY) * Scale.z, Translation.x,
+				(XY + WZ) * Scale.x, (1.0f - XX - ZZ) * Scale.y, (YZ - WX) * Scale.z, Translation.y,
+				(XZ - WY) * Scale.x, (YZ + WX) * Scale.y, (1.0f - XX - YY) * Scale.z, Translation.z);
+		}
+
+		inline void Normalize(const Quaternion* In, Quaternion* Out, size_t Count) {
+			for (size_t i = 0; i < Count; ++i) Out[i] = Normalize(In[i]);
+		}
+
+		inline void Nlerp(const Quaternion* A, const Quaternion* B, const float* T, size_t TStep,
+			Quaternion* Out, size_t Count) {
+			for (size_t i = 0; i < Count; ++i) Out[i] = Nlerp(A[i], B[i], T[i * TStep]);
+		}
+
+		inline void Slerp(const Quaternion* A, const Quaternion* B, const float* T, size_t TStep,
+			Quaternion* Out, size_t Count) {
+			for (size_t i = 0; i < Count; ++i) Out[i] = Slerp(A[i], B[i], T[i * TStep]);
+		}
+
+		inline void ToMatrices(const Quaternion* Rotations, const Vector3* Scales, const Vector3* Translations,
+			Matrix3x4* Out, size_t Count) {
+			for (size_t i = 0; i < Count; ++i) {
+				Out[i] = ToMatrix(Rotations[i], Scales ? Scales[i] : Vector3(1, 1, 1),
+					Translations ? Translations[i] : Vector3(0, 0, 0));
+			}
+		}
+	}
+
+#if defined(EU_SIMD_X86)
+	/**
+	 * @brief 4 cuaterniones en SoA: una componente por registro.
+	 */
+	struct QuaternionX4 {
+		__m128 W, X, Y, Z;
+
+		/** @brief Carga `Q[0..3]` y traspone. */
+		static QuaternionX4 Load(const Quaternion* Q) {
+			static_assert(sizeof(Quaternion) == 4 * sizeof(float), "Quaternion must be tightly packed");
+			__m128 R0 = _mm_loadu_ps(Q[0].data()), R1 = _mm_loadu_ps(Q[1].data());
+			__m128 R2 = _mm_loadu_ps(Q[2].data()), R3 = _mm_loadu_ps(Q[3].data());
+			_MM_TRANSPOSE4_PS(R0, R1, R2, R3);
+			return { R0, R1, R2, R3 };
+		}
+
+		/** @brief Traspone y guarda en `Q[0..3]`. */
+		void Store(Quaternion* Q) const {
+			__m128 R0 = W, R1 = X, R2 = Y, R3 = Z;
+			_MM_TRANSPOSE4_PS(R0, R1, R2, R3);
+			_mm_storeu_ps(&Q[0].w, R0);
+			_mm_storeu_ps(&Q[1].w, R1);
+			_mm_storeu_ps(&Q[2].w, R2);
+			_mm_storeu_ps(&Q[3].w, R3);
+		}
+	};
+
+	/**
+	 * @brief 8 cuaterniones en SoA (AVX2). Solo tras comprobar @ref GetSimdLevel.
+	 */
+	struct QuaternionX8 {
+		__m256 W, X, Y, Z;
+
+		/** @brief Carga `Q[0..7]`: `Q[0..3]` en la mitad baja y `Q[4..7]` en la alta. */
+		EU_TARGET("avx2,fma") static QuaternionX8 Load(const Quaternion* Q) {
+			__m256 R[4];
+			for (int i = 0; i < 4; ++i) {
+				R[i] = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(Q[i].data())),
+					_mm_loadu_ps(Q[i + 4].data()), 1);
+			}
+			const __m256 T0 = _mm256_unpacklo_ps(R[0], R[1]), T1 = _mm256_unpackhi_ps(R[0], R[1]);
+			const __m256 T2 = _mm256_unpacklo_ps(R[2], R[3]), T3 = _mm256_unpackhi_ps(R[2], R[3]);
+			return {
+				_mm256_shuffle_ps(T0, T2, _MM_SHUFFLE(1, 0, 1, 0)), _mm256_shuffle_ps(T0, T2, _MM_SHUFFLE(3, 2, 3, 2)),
+				_mm256_shuffle_ps(T1, T3, _MM_SHUFFLE(1, 0, 1, 0)), _mm256_shuffle_ps(T1, T3, _MM_SHUFFLE(3, 2, 3, 2)) };
+		}
+
+		EU_TARGET("avx2,fma") void Store(Quaternion* Q) const {
+			const __m256 T0 = _mm256_unpacklo_ps(W, X), T1 = _mm256_unpackhi_ps(W, X);
+			const __m256 T2 = _mm256_unpacklo_ps(Y, Z), T3 = _mm256_unpackhi_ps(Y, Z);
+			const __m256 R[4] = {
+				_mm256_shuffle_ps(T0, T2, _MM_SHUFFLE(1, 0, 1, 0)), _mm256_shuffle_ps(T0, T2, _MM_SHUFFLE(3, 2, 3, 2)),
+				_mm256_shuffle_ps(T1, T3, _MM_SHUFFLE(1, 0, 1, 0)), _mm256_shuffle_ps(T1, T3, _MM_SHUFFLE(3, 2, 3, 2)) };
+			for (int i = 0; i < 4; ++i) {
+				_mm_storeu_ps(&Q[i].w, _mm256_castps256_ps128(R[i]));
+				_mm_storeu_ps(&Q[i + 4].w, _mm256_extractf128_ps(R[i], 1));
+			}
+		}
+	};
+
+	namespace QuaternionSSE {
+		namespace Detail {
+			inline __m128 Dot(const QuaternionX4& A, const QuaternionX4& B) {
+				return _mm_add_ps(_mm_add_ps(_mm_mul_ps(A.W, B.W), _mm_mul_ps(A.X, B.X)),
+					_mm_add_ps(_mm_mul_ps(A.Y, B.Y), _mm_mul_ps(A.Z, B.Z)));
+			}
+
+			inline QuaternionX4 Normalize(const QuaternionX4& Q) {
+				const QuaternionX4& A = Q;
+				const __m128 LengthSq = Dot(A, A);
+				// Nulo: rsqrt(0) = inf; la mscara deja el cuaternin a 0.
+				const __m128 Valid = _mm_cmpgt_ps(LengthSq, _mm_setzero_ps());
+				const __m128 Inv = _mm_and_ps(FastMath::Rsqrt<FastMath::Tier::Fast>(LengthSq), Valid);
+				return { _mm_mul_ps(Q.W, Inv), _mm_mul_ps(Q.X, Inv), _mm_mul_ps(Q.Y, Inv), _mm_mul_ps(Q.Z, Inv) };
+			}
+
+			inline QuaternionX4 Blend(const QuaternionX4& A, const QuaternionX4& B, __m128 Ta, __m128 Tb) {
+				return {
+					_mm_add_ps(_mm_mul_ps(A.W, Ta), _mm_mul_ps(B.W, Tb)), _mm_add_ps(_mm_mul_ps(A.X, Ta), _mm_mul_ps(B.X, Tb)),
+					_mm_add_ps(_mm_mul_ps(A.Y, Ta), _mm_mul_ps(B.Y, Tb)), _mm_add_ps(_mm_mul_ps(A.Z, Ta), _mm_mul_ps(B.Z, Tb)) };
+			}
+
+			inline __m128 LoadT(const float* T, size_t TStep) {
+				return TStep == 0 ? _mm_set1_ps(T[0]) : _mm_loadu_ps(T);
+			}
+
+			inline __m128 SlerpWeight(__m128 T, __m128 Xm1) {
+				const __m128 SqrT = _mm_mul_ps(T, T);
+				__m128 C = _mm_set1_ps(1.0f);
+				for (int i = 7; i >= 0; --i) {
+					const __m128 B = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(_mm_set1_ps(QuaternionScalar::Detail::kSlerpU[i]), SqrT),
+						_mm_set1_ps(QuaternionScalar::Detail::kSlerpV[i])), Xm1);
+					C = _mm_add_ps(_mm_set1_ps(1.0f), _mm_mul_ps(B, C));
+				}
+				return _mm_mul_ps(T, C);
+			}
+		}
+
+		inline void Normalize(const Quaternion* In, Quaternion* Out, size_t Count) {
+			size_t i = 0;
+			for (; i + 4 <= Count; i += 4) {
+				Detail::Normalize(QuaternionX4::Load(In + i)).Store(Out + i);
+			}
+			QuaternionScalar::Normalize(In + i, Out + i, Count - i);
+		}
+
+		inline void Nlerp(const Quaternion* A, const Quaternion* B, const float* T, size_t TStep,
+			Quaternion* Out, size_t Count) {
+			const __m128 SignMask = _mm_set1_ps(-0.0f);
+			size_t i = 0;
+			for (; i + 4 <= Count; i += 4) {
+				const QuaternionX4 Qa = QuaternionX4::Load(A + i), Qb = QuaternionX4::Load(B + i);
+				const __m128 Tv = Detail::LoadT(T + i * TStep, TStep);
+				// Camino corto: el signo del producto escalar pasa al peso de B.
+				const __m128 Tb = _mm_xor_ps(Tv, _mm_and_ps(Detail::Dot(Qa, Qb), SignMask));
+				const __m128 Ta = _mm_sub_ps(_mm_set1_ps(1.0f), Tv);
+				Detail::Normalize(Detail::Blend(Qa, Qb, Ta, Tb)).Store(Out + i);
+			}
+			QuaternionScalar::Nlerp(A + i, B + i, T + i * TStep, TStep, Out + i, Count - i);
+		}
+
+		inline void Slerp(const Quaternion* A, const Quaternion* B, const float* T, size_t TStep,
+			Quaternion* Out, size_t Count) {
+			const __m128 SignMask = _mm_set1_ps(-0.0f);
+			const __m128 One = _mm_set1_ps(1.0f);
+			size_t i = 0;
+			for (; i + 4 <= Count; i += 4) {
+				const QuaternionX4 Qa = QuaternionX4::Load(A + i), Qb = QuaternionX4::Load(B + i);
+				const __m128 Tv = Detail::LoadT(T + i * TStep, TStep);
+				const __m128 Dot = Detail::Dot(Qa, Qb);
+				const __m128 Sign = _mm_and_ps(Dot, SignMask);
+				const __m128 Xm1 = _mm_sub_ps(_mm_xor_ps(Dot, Sign), One);
+				const __m128 Ta = Detail::SlerpWeight(_mm_sub_ps(One, Tv), Xm1);
+				const __m128 Tb = _mm_xor_ps(Detail::SlerpWeight(Tv, Xm1), Sign);
+				Detail::Blend(Qa, Qb, Ta, Tb).Store(Out + i);
+			}
+			QuaternionScalar::Slerp(A + i, B + i, T + i * TStep, TStep, Out + i, Count - i);
+		}
+
+		inline void ToMatrices(const Quaternion* Rotations, const Vector3* Scales, const Vector3* Translations,
+			Matrix3x4* Out, size_t Count) {
+			const __m128 One = _mm_set1_ps(1.0f);
+			size_t i = 0;
+			for (; i + 4 <= Count; i += 4) {
+				const QuaternionX4 Q = QuaternionX4::Load(Rotations + i);
+				const __m128 X2 = _mm_add_ps(Q.X, Q.X), Y2 = _mm_add_ps(Q.Y, Q.Y), Z2 = _mm_add_ps(Q.Z, Q.Z);
+				const __m128 XX = _mm_mul_ps(Q.X, X2), YY = _mm_mul_ps(Q.Y, Y2), ZZ = _mm_mul_ps(Q.Z, Z2);
+				const __m128 XY = _mm_mul_ps(Q.X, Y2), XZ = _mm_mul_ps(Q.X, Z2), YZ = _mm_mul_ps(Q.Y, Z2);
+				const __m128 WX = _mm_mul_ps(Q.W, X2), WY = _mm_mul_ps(Q.W, Y2), WZ = _mm_mul_ps(Q.W, Z2);
+				__m128 M[3][4] = {
+					{ _mm_sub_ps(One, _mm_add_ps(YY, ZZ)), _mm_sub_ps(XY, WZ), _mm_add_ps(XZ, WY), _mm_setzero_ps() },
+					{ _mm_add_ps(XY, WZ), _mm_sub_ps(One, _mm_add_ps(XX, ZZ)), _mm_sub_ps(YZ, WX), _mm_setzero_ps() },
+					{ _mm_sub_ps(XZ, WY), _mm_add_ps(YZ, WX), _mm_sub_ps(One, _mm_add_ps(XX, YY)), _mm_setzero_ps() } };
+				if (Scales) {
+					// Escala local: columna c por la escala del eje c (4 vectores de 3 floats).
+					const float* S = Scales[i].data();
+					for (int c = 0; c < 3; ++c) {
+						const __m128 Sc = _mm_setr_ps(S[c], S[3 + c], S[6 + c], S[9 + c]);
+						for (int r = 0; r < 3; ++r) M[r][c] = _mm_mul_ps(M[r][c], Sc);
+					}
+				}
+				if (Translations) {
+					const float* P = Translations[i].data();
+					for (int r = 0; r < 3; ++r) M[r][3] = _mm_setr_ps(P[r], P[3 + r], P[6 + r], P[9 + r]);
+				}
+				for (int r = 0; r < 3; ++r) {
+					__m128 C0 = M[r][0], C1 = M[r][1], C2 = M[r][2], C3 = M[r][3];
+					_MM_TRANSPOSE4_PS(C0, C1, C2, C3);
+					_mm_storeu_ps(Out[i].m[r], C0);
+					_mm_storeu_ps(Out[i + 1].m[r], C1);
+					_mm_storeu_ps(Out[i + 2].m[r], C2);
+					_mm_storeu_ps(Out[i + 3].m[r], C3);
+				}
+			}
+			QuaternionScalar::ToMatrices(Rotations + i, Scales ? Scales + i : nullptr,
+				Translations ? Translations + i : nullptr, Out + i, Count - i);
+		}
+	}
+
+	namespace QuaternionAVX2 {
+		namespace Detail {
+			EU_TARGET("avx2,fma") inline __m256 Dot(const QuaternionX8& A, const QuaternionX8& B) {
+				return _mm256_fmadd_ps(A.Z, B.Z, _mm256_fmadd_ps(A.Y, B.Y, _mm256_fmadd_ps(A.X, B.X, _mm256_mul_ps(A.W, B.W))));
+			}
+
+			EU_TARGET("avx2,fma") inline QuaternionX8 Normalize(const QuaternionX8& Q) {
+				const __m256 LengthSq = Dot(Q, Q);
+				const __m256 Valid = _mm256_cmp_ps(LengthSq, _mm256_setzero_ps(), _CMP_GT_OQ);
+				const __m256 Inv = _mm256_and_ps(FastMath::Rsqrt<FastMath::Tier::Fast>(LengthSq), Valid);
+				return { _mm256_mul_ps(Q.W, Inv), _mm256_mul_ps(Q.X, Inv), _mm256_mul_ps(Q.Y, Inv), _mm256_mul_ps(Q.Z, Inv) };
+			}
+
+			EU_TARGET("avx2,fma") inline QuaternionX8 Blend(const QuaternionX8& A, const QuaternionX8& B, __m256 Ta, __m256 Tb) {
+				return {
+					_mm256_fmadd_ps(B.W, Tb, _mm256_mul_ps(A.W, Ta)), _mm256_fmadd_ps(B.X, Tb, _mm256_mul_ps(A.X, Ta)),
+					_mm256_fmadd_ps(B.Y, Tb, _mm256_mul_ps(A.Y, Ta)), _mm256_fmadd_ps(B.Z, Tb, _mm256_mul_ps(A.Z, Ta)) };
+			}
+
+			EU_TARGET("avx2,fma") inline __m256 LoadT(const float* T, size_t TStep) {
+				return TStep == 0 ? _mm256_set1_ps(T[0]) : _mm256_loadu_ps(T);
+			}
+
+			EU_TARGET("avx2,fma") inline __m256 SlerpWeight(__m256 T, __m256 Xm1) {
+				const __m256 SqrT = _mm256_mul_ps(T, T);
+				const __m256 One = _mm256_set1_ps(1.0f);
+				__m256 C = One;
+				for (int i = 7; i >= 0; --i) {
+					const __m256 B = _mm256_mul_ps(_mm256_fmsub_ps(_mm256_set1_ps(QuaternionScalar::Detail::kSlerpU[i]), SqrT,
+						_mm256_set1_ps(QuaternionScalar::Detail::kSlerpV[i])), Xm1);
+					C = _mm256_fmadd_ps(B, C, One);
+				}
+				return _mm256_mul_ps(T, C);
+			}
+		}
+
+		EU_TARGET("avx2,fma") inline void Normalize(const Quaternion* In, Quaternion* Out, size_t Count) {
+			size_t i = 0;
+			for (; i + 8 <= Count; i += 8) {
+				Detail::Normalize(QuaternionX8::Load(In + i)).Store(Out + i);
+			}
+			QuaternionSSE::Normalize(In + i, Out + i, Count - i);
+		}
+
+		EU_TARGET("avx2,fma") inline void Nlerp(const Quaternion* A, const Quaternion* B, const float* T, size_t TStep,
+			Quaternion* Out, size_t Count) {
+			const __m256 SignMask = _mm256_set1_ps(-0.0f);
+			size_t i = 0;
+			for (; i + 8 <= Count; i += 8) {
+				const QuaternionX8 Qa = QuaternionX8::Load(A + i), Qb = QuaternionX8::Load(B + i);
+				const __m256 Tv = Detail::LoadT(T + i * TStep, TStep);
+				const __m256 Tb = _mm256_xor_ps(Tv, _mm256_and_ps(Detail::Dot(Qa, Qb), SignMask));
+				const __m256 Ta = _mm256_sub_ps(_mm256_set1_ps(1.0f), Tv);
+				Detail::Normalize(Detail::Blend(Qa, Qb, Ta, Tb)).Store(Out + i);
+			}
+			QuaternionSSE::Nlerp(A + i, B + i, T + i * TStep, TStep, Out + i, Count - i);
+		}
+
+		EU_TARGET("avx2,fma") inline void Slerp(const Quaternion* A, const Quaternion* B, const float* T, size_t TStep,
+			Quaternion* Out, size_t Count) {
+			const __m256 SignMask = _mm256_set1_ps(-0.0f);
+			const __m256 One = _mm256_set1_ps(1.0f);
+			size_t i = 0;
+			for (; i + 8 <= Count; i += 8) {
+				const QuaternionX8 Qa = QuaternionX8::Load(A + i), Qb = QuaternionX8::Load(B + i);
+				const __m256 Tv = Detail::LoadT(T + i * TStep, TStep);
+				const __m256 Dot = Detail::Dot(Qa, Qb);
+				const __m256 Sign = _mm256_and_ps(Dot, SignMask);
+				const __m256 Xm1 = _mm256_sub_ps(_mm256_xor_ps(Dot, Sign), One);
+				const __m256 Ta = Detail::SlerpWeight(_mm256_sub_ps(One, Tv), Xm1);
+				const __m256 Tb = _mm256_xor_ps(Detail::SlerpWeight(Tv, Xm1), Sign);
+				Detail::Blend(Qa, Qb, Ta, Tb).Store(Out + i);
+			}
+			QuaternionSSE::Slerp(A + i, B + i, T + i * TStep, TStep, Out + i, Count - i);
+		}
+	}
+#endif
+
+	/** @brief Normaliza `Count` cuaterniones (rpido: ~4 ULP). */
+	inline void NormalizeQuaternions(const Quaternion* In, Quaternion* Out, size_t Count) {
+#if defined(EU_SIMD_X86)
+		if (GetSimdLevel() == SimdLevel::AVX2) {
+			QuaternionAVX2::Normalize(In, Out, Count);
+		} else {
+			QuaternionSSE::Normalize(In, Out, Count);
+		}
+#else
+		QuaternionScalar::Normalize(In, Out, Count);
+#endif
+	}
+
+	/** @brief `Out[i] = nlerp(A[i], B[i], T)` con el mismo `T` para todos. */
+	inline void NlerpQuaternions(const Quaternion* A, const Quaternion* B, float T, Quaternion* Out, size_t Count) {
+#if defined(EU_SIMD_X86)
+		if (GetSimdLevel() == SimdLevel::AVX2) {
+			QuaternionAVX2::Nlerp(A, B, &T, 0, Out, Count);
+		} else {
+			QuaternionSSE::Nlerp(A, B, &T, 0, Out, Count);
+		}
+#else
+		QuaternionScalar::Nlerp(A, B, &T, 0, Out, Count);
+#endif
+	}
+
+	/** @brief `Out[i] = nlerp(A[i], B[i], T[i])`. */
+	inline void NlerpQuaternions(const Quaternion* A, const Quaternion* B, const float* T, Quaternion* Out, size_t Count) {
+#if defined(EU_SIMD_X86)
+		if (GetSimdLevel() == SimdLevel::AVX2) {
+			QuaternionAVX2::Nlerp(A, B, T, 1, Out, Count);
+		} else {
+			QuaternionSSE::Nlerp(A, B, T, 1, Out, Count);
+		}
+#else
+		QuaternionScalar::Nlerp(A, B, T, 1, Out, Count);
+#endif
+	}
+
+	/** @brief `Out[i] = slerp(A[i], B[i], T)` con el mismo `T` para todos. */
+	inline void SlerpQuaternions(const Quaternion* A, const Quaternion* B, float T, Quaternion* Out, size_t Count) {
+#if defined(EU_SIMD_X86)
+		if (GetSimdLevel() == SimdLevel::AVX2) {
+			QuaternionAVX2::Slerp(A, B, &T, 0, Out, Count);
+		} else {
+			QuaternionSSE::Slerp(A, B, &T, 0, Out, Count);
+		}
+#else
+		QuaternionScalar::Slerp(A, B, &T, 0, Out, Count);
+#endif
+	}
+
+	/** @brief `Out[i] = slerp(A[i], B[i], T[i])`. */
+	inline void SlerpQuaternions(const Quaternion* A, const Quaternion* B, const float* T, Quaternion* Out, size_t Count) {
+#if defined(EU_SIMD_X86)
+		if (GetSimdLevel() == SimdLevel::AVX2) {
+			QuaternionAVX2::Slerp(A, B, T, 1, Out, Count);
+		} else {
+			QuaternionSSE::Slerp(A, B, T, 1, Out, Count);
+		}
+#else
+		QuaternionScalar::Slerp(A, B, T, 1, Out, Count);
+#endif
+	}
+
+	/**
+	 * @brief Rotacin, escala y traslacin a @ref Matrix3x4 (p. ej. la pose de un esqueleto).
+	 * @param Scales Escala por eje de cada elemento, o `nullptr` para (1, 1, 1).
+	 * @param Translations Traslacin de cada elemento, o `nullptr` para el origen.
+	 * @note Cuatro a la vez tambin con AVX2: el coste est en trasponer la salida.
+	 */
+	inline void QuaternionsToMatrices(const Quaternion* Rotations, const Vector3* Scales,
+		const Vector3* Translations, Matrix3x4* Out, size_t Count) {
+#if defined(EU_SIMD_X86)
+		QuaternionSSE::ToMatrices(Rotations, Scales, Translations, Out, Count);
+#else
+		QuaternionScalar::ToMatrices(Rotations, Scales, Translations, Out, Count);
+#endif
+	}
+}
@@ -48,7 +48,7 @@ namespace EU {
 		 *
 		 * Initializes the vector to (0, 0, 0).
 		 */
-		Vector3() : x(0), y(0), z(0) {}
+		constexpr Vector3() : x(0), y(0), z(0) {}
 
 		/**
 		 * @brief Parameterized constructor.
@@ -59,7 +59,7 @@ namespace EU {
 		 * @param y The y-coordinate.
 		 * @param z The z-coordinate.
 		 */
-		Vector3(float x, float y, float z) : x(x), y(y), z(z) {}
+		constexpr Vector3(float x, float y, float z) : x(x), y(y), z(z) {}
 
 		/**
 		 * @brief Adds another vector to this vector.
@@ -67,7 +67,7 @@ namespace EU {
 		 * @param other The vector to add.
 		 * @return The result of the addition.
 		 */
-		Vector3 operator+(const Vector3& other) const {
+		constexpr Vector3 operator+(const Vector3& other) const {
 			return Vector3(x + other.x, y + other.y, z + other.z);
 		}
 
@@ -77,7 +77,7 @@ namespace EU {
 		 * @param other The vector to subtract.
 		 * @return The result of the subtraction.
 		 */
-		Vector3 operator-(const Vector3& other) const {
+		constexpr Vector3 operator-(const Vector3& other) const {
 			return Vector3(x - other.x, y - other.y, z - other.z);
 		}
 
@@ -87,7 +87,7 @@ namespace EU {
 		 * @param scalar The scalar to multiply by.
 		 * @return The result of the multiplication.
 		 */
-		Vector3 operator*(float scalar) const {
+		constexpr Vector3 operator*(float scalar) const {
 			return Vector3(x * scalar, y * scalar, z * scalar);
 		}
 
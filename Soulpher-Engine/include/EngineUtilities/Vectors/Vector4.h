@@ -28,7 +28,7 @@
 */
 #pragma once
 
-#include "Utilities/EngineMath.h"
+#include "EngineUtilities/Utilities/EngineMath.h"
 namespace EU {
   /**
  * @brief A 4D vector class.
@@ -49,7 +49,7 @@ namespace EU {
      *
      * Initializes the vector to (0, 0, 0, 0).
      */
-    Vector4() : x(0), y(0), z(0), w(0) {}
+    constexpr Vector4() : x(0), y(0), z(0), w(0) {}
 
     /**
      * @brief Parameterized constructor.
@@ -61,7 +61,7 @@ namespace EU {
      * @param z The z-coordinate.
      * @param w The w-coordinate.
      */
-    Vector4(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+    constexpr Vector4(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
 
     /**
      * @brief Adds another vector to this vector.
@@ -69,7 +69,7 @@ namespace EU {
      * @param other The vector to add.
      * @return The result of the addition.
      */
-    Vector4 operator+(const Vector4& other) const {
+    constexpr Vector4 operator+(const Vector4& other) const {
       return Vector4(x + other.x, y + other.y, z + other.z, w + other.w);
     }
 
@@ -79,7 +79,7 @@ namespace EU {
      * @param other The vector to subtract.
      * @return The result of the subtraction.
      */
-    Vector4 operator-(const Vector4& other) const {
+    constexpr Vector4 operator-(const Vector4& other) const {
       return Vector4(x - other.x, y - other.y, z - other.z, w - other.w);
     }
 
@@ -89,7 +89,7 @@ namespace EU {
      * @param scalar The scalar to multiply by.
      * @return The result of the multiplication.
      */
-    Vector4 operator*(float scalar) const {
+    constexpr Vector4 operator*(float scalar) const {
       return Vector4(x * scalar, y * scalar, z * scalar, w * scalar);
     }
 
@@ -120,6 +120,10 @@ namespace EU {
      *
      * @return Pointer to the first element (x, y, z, w).
      */
+    float* data() {
+      return &x;
+    }
+
     const float* data() const {
       return &x;
     }
@@ -0,0 +1,124 @@
+﻿/**
+ * @file EventBus.h
+ * @brief Bus de eventos tipados: cada hilo publica en su propio anillo sin bloqueos y
+ * un único consumidor los vacía por lotes en un punto de sincronización del frame.
+ *
+ * @details
+ * Para enterarse de que algo cambió (un actor nuevo, uno destruido, uno renombrado) los
+ * sistemas preguntaban cada frame (p. ej. la UI comparando el número de actores), y un
+ * observer clásico (lista de callbacks virtuales con un mutex) haría que cada hilo que
+ * publica compita por el mismo lock y salte a otro sistema en mitad de su trabajo. Aquí:
+ *
+ * - **Un canal por tipo** (@ref EventChannel<T>): los eventos son structs pequeños que se
+ *   copian; no hay clase base ni `virtual`.
+ * - **Un anillo por hilo** (`EU::TPerThreadRings`, el mismo registro que usa el
+ *   `Logger`): @ref EventBus::publish empuja en el `EU::TSpscQueue` del hilo que publica
+ *   (productor único), sin locks ni `compare_exchange`. El anillo se toma en el primer
+ *   evento del hilo y vuelve al canal cuando el hilo termina.
+ * - **Vaciado por lotes**: @ref EventBus::drain, desde el punto de sincronización
+ *   (`BaseApp::update`, frontera de frame), recorre los anillos y llama a la función
+ *   con cada evento. Es un template: la llamada por evento se inlinea.
+ *
+ * Si un anillo se llena (un hilo publica más de @ref EventChannel::kRingEvents entre dos
+ * vaciados) el evento va a una lista con mutex; no se pierde, pero puede salir después
+ * de eventos posteriores del mismo hilo.
+ *
+ * @note Para estudiantes: cada tipo de evento que alguien publique tiene que vaciarse en
+ * algún punto de sincronización cada frame (si no, los anillos se llenan y todo acaba en
+ * la lista con mutex). Solo un hilo vacía un canal a la vez; el orden está garantizado
+ * dentro de un hilo, no entre hilos.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "EngineUtilities\Threading\TPerThreadRings.h"
+#include <atomic>
+#include <mutex>
+
+/**
+ * @class EventChannel
+ * @brief Anillos por hilo y lista de desbordamiento de un tipo de evento.
+ * @tparam T Evento (struct copiable).
+ */
+template<typename T>
+class EventChannel {
+public:
+    /// Eventos por anillo (potencia de dos).
+    static const size_t kRingEvents = 1024;
+    /// Anillos como mucho (hilos que han publicado a la vez).
+    static const unsigned int kMaxRings = 128;
+
+    /** @brief Canal del proceso para `T`. */
+    static EventChannel& get() {
+        static EventChannel s_channel;
+        return s_channel;
+    }
+
+    /** @brief Publica `event` desde cualquier hilo. */
+    void publish(const T& event) {
+        if (m_rings.Push(event)) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(m_overflowMutex);
+        m_overflow.push_back(event);
+        m_hasOverflow.store(true, std::memory_order_release);
+        ++m_spilled;
+    }
+
+    /**
+     * @brief Llama a `f(const T&)` con cada evento publicado hasta ahora.
+     * @return Eventos entregados.
+     * @note Un solo hilo a la vez (el del punto de sincronización).
+     */
+    template<typename F>
+    unsigned int drain(F&& f) {
+        unsigned int delivered = m_rings.Drain([&f](T& event) { f(static_cast<const T&>(event)); });
+        if (m_hasOverflow.load(std::memory_order_acquire)) {
+            std::vector<T> overflow;
+            {
+                std::lock_guard<std::mutex> lock(m_overflowMutex);
+                overflow.swap(m_overflow);
+                m_hasOverflow.store(false, std::memory_order_relaxed);
+            }
+            for (const T& spilled : overflow) {
+                f(spilled);
+                ++delivered;
+            }
+        }
+        return delivered;
+    }
+
+    /** @brief Eventos que no cupieron en su anillo desde el arranque. */
+    unsigned long long getSpilledCount() const { return m_spilled; }
+
+private:
+    EventChannel() = default;
+    ~EventChannel() = default;
+    EventChannel(const EventChannel&) = delete;
+    EventChannel& operator=(const EventChannel&) = delete;
+
+    EU::TPerThreadRings<T, kRingEvents, kMaxRings> m_rings;
+    std::vector<T> m_overflow;                      ///< Eventos de anillos llenos.
+    std::mutex m_overflowMutex;
+    std::atomic<bool> m_hasOverflow{ false };
+    unsigned long long m_spilled = 0;               ///< Con `m_overflowMutex`.
+};
+
+/**
+ * @class EventBus
+ * @brief Atajos a los canales por tipo: `EventBus::publish(e)` y `EventBus::drain<T>(f)`.
+ */
+class EventBus {
+public:
+    /** @brief Publica un evento desde cualquier hilo. */
+    template<typename T>
+    static void publish(const T& event) {
+        EventChannel<T>::get().publish(event);
+    }
+
+    /** @brief Vacía los eventos `T` llamando a `f(const T&)`; devuelve cuántos hubo. */
+    template<typename T, typename F>
+    static unsigned int drain(F&& f) {
+        return EventChannel<T>::get().drain(std::forward<F>(f));
+    }
+};
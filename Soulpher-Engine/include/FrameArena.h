@@ -0,0 +1,83 @@
+﻿/**
+ * @file FrameArena.h
+ * @brief Memoria temporal por hilo que se libera de golpe al final de cada frame.
+ *
+ * @details
+ * Los temporales del frame (listas auxiliares, nombres para la UI, salidas intermedias
+ * de culling) se reservaban con `std::vector`/`std::string` locales: una reserva y una
+ * liberación del montón por frame y por uso. `FrameArena` da a cada hilo un
+ * `EU::LinearArena` propio (sin locks): reservar es sumar un desplazamiento y todo se
+ * libera con un @ref FrameArena::reset.
+ *
+ * - **Hilo principal**: `BaseApp::run` llama a @ref FrameArena::reset al empezar cada
+ *   frame, cuando el render del anterior ya terminó.
+ * - **Hilo de render**: `RenderThread` la resetea antes de cada frame que dibuja.
+ * - **Trabajos** (`JobSystem`): no tienen un inicio de frame propio; quien reserve en un
+ *   trabajo abre un @ref FrameArena::Scope, que devuelve lo reservado al salir.
+ *
+ * Con `EU::TArray<T, EU::ArenaAllocator>` y @ref FrameArena::allocator un contenedor
+ * temporal crece sin tocar el montón; si el arena se llena, el asignador tira del montón
+ * (nunca falla) y @ref FrameArena::getFailureCount lo cuenta para subir @ref kBytesPerThread.
+ *
+ * @note Para estudiantes: nada reservado aquí puede sobrevivir al frame (ni pasarse a
+ * otro hilo que lo use después): tras el reset la memoria se reutiliza.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "EngineUtilities\Memory\TAllocators.h"
+#include <memory>
+#include <mutex>
+
+/**
+ * @class FrameArena
+ * @brief Arena lineal por hilo para datos que solo viven un frame.
+ */
+class FrameArena {
+public:
+    /// Tamaño del arena de cada hilo.
+    static const size_t kBytesPerThread = 1 << 20;
+
+    /** @brief Arena del hilo actual (se crea en el primer uso). */
+    static EU::LinearArena& local();
+
+    /** @brief Asignador para contenedores temporales del hilo actual. */
+    static EU::ArenaAllocator allocator() { return EU::ArenaAllocator(local()); }
+
+    /**
+     * @brief Copia `text` en el arena del hilo (con `'\0'`); para etiquetas de un frame.
+     * @return La copia, o `text` si no cabe.
+     */
+    static const char* copy(const std::string& text);
+
+    /** @brief Libera todo lo reservado por el hilo actual (fin de su frame). */
+    static void reset();
+
+    /** @brief Mayor ocupación de un arena desde el arranque. */
+    static size_t getPeakBytes();
+
+    /** @brief Reservas que no cupieron en su arena desde el arranque (fueron al montón). */
+    static size_t getFailureCount();
+
+    /**
+     * @class Scope
+     * @brief Devuelve al salir todo lo que el hilo reservó dentro (para trabajos y
+     * funciones que no esperan al reset del frame).
+     */
+    class Scope {
+    public:
+        Scope() : m_arena(local()), m_mark(m_arena.GetUsed()) {}
+        ~Scope() { m_arena.Rewind(m_mark); }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        EU::LinearArena& m_arena;
+        size_t m_mark;
+    };
+
+private:
+    /// Arenas de todos los hilos (viven hasta el cierre; los hilos guardan un puntero).
+    static std::vector<std::unique_ptr<EU::LinearArena>>& arenas();
+    static std::mutex& arenasMutex();
+};
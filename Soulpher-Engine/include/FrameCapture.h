@@ -0,0 +1,179 @@
+﻿/**
+ * @file FrameCapture.h
+ * @brief Grabación de secuencias de frames (PNG) o de vídeo H.264 sin parar el render.
+ *
+ * @details
+ * Es la versión continua de @ref Screenshot: cada frame grabado (uno de cada
+ * `interval`) se copia en la GPU a una textura `STAGING` de un anillo de
+ * @ref kRingSize y se lee @ref kLatencyFrames frames después, siempre en orden.
+ * Los frames leídos pasan a una cola que vacían hilos de trabajo:
+ *
+ * - **PNG**: varios hilos (PNG con WIC, @ref Screenshot::writePng), un archivo por frame.
+ * - **H.264**: un hilo que alimenta un `IMFSinkWriter` de Media Foundation (el
+ *   codificador ya usa varios núcleos por dentro) y escribe un `.mp4`.
+ *
+ * **Contrapresión**: si la codificación se queda atrás, la cola llega a
+ * @ref kMaxQueued frames y @ref update espera a que haya hueco en vez de descartar
+ * frames; si todo el anillo sigue en vuelo, se espera a la copia más antigua. Con el
+ * reloj bloqueado (@ref FrameClock::setLockedDelta) el resultado es el mismo vaya el
+ * codificador rápido o lento: solo cambia lo que tarda la grabación.
+ *
+ * @note Para estudiantes: el codificador H.264 de Windows exige ancho y alto pares;
+ * si la ventana es impar, la última fila o columna no entra en el vídeo.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+class Device;
+class DeviceContext;
+class Texture;
+struct IMFSinkWriter;
+
+/**
+ * @enum CaptureFormat
+ * @brief Salida de la grabación.
+ */
+enum CaptureFormat {
+    CAPTURE_FORMAT_PNG = 0,  ///< Secuencia `<ruta>_000000.png`, `<ruta>_000001.png`...
+    CAPTURE_FORMAT_H264 = 1  ///< Vídeo `.mp4` (Media Foundation).
+};
+
+/**
+ * @class FrameCapture
+ * @brief Anillo de readback y codificadores en hilos para grabar frames.
+ */
+class FrameCapture {
+public:
+    FrameCapture() = default;
+    ~FrameCapture() { destroy(); }
+
+    /// Texturas de staging del anillo.
+    static const unsigned int kRingSize = 6;
+    /// Frames entre la copia y el primer intento de lectura.
+    static const unsigned int kLatencyFrames = 2;
+    /// Frames leídos que pueden esperar a los codificadores antes de frenar el render.
+    static const unsigned int kMaxQueued = 8;
+    /// Hilos de codificación PNG como máximo.
+    static const unsigned int kMaxPngWorkers = 4;
+
+    /// Parámetros de una grabación.
+    struct Settings {
+        std::string path;                 ///< PNG: prefijo de los archivos; H.264: archivo `.mp4`.
+        CaptureFormat format = CAPTURE_FORMAT_PNG;
+        unsigned int interval = 1;        ///< Se graba 1 de cada `interval` frames.
+        unsigned int fps = 60;            ///< Frecuencia del vídeo resultante.
+        unsigned int bitrate = 20000000;  ///< H.264: bits por segundo.
+    };
+
+    /**
+     * @brief Guarda el dispositivo.
+     * @return `E_POINTER` si el dispositivo es nulo.
+     */
+    HRESULT init(Device& device);
+
+    /**
+     * @brief Empieza a grabar (el tamaño se toma del primer frame).
+     * @return `E_INVALIDARG` con ruta vacía o `fps`/`interval` a 0; `E_FAIL` si ya
+     * se está grabando; o el error de `MFStartup`.
+     */
+    HRESULT start(const Settings& settings);
+
+    /**
+     * @brief Lee los frames listos y copia el actual si toca (una vez por frame).
+     * @param deviceContext Contexto inmediato.
+     * @param backBuffer Back buffer del frame (antes de la UI y de `Present`).
+     */
+    void update(DeviceContext& deviceContext, Texture& backBuffer);
+
+    /**
+     * @brief Lee lo que quede en vuelo, espera a los codificadores y cierra los archivos.
+     */
+    void stop(DeviceContext& deviceContext);
+
+    /** @brief `true` entre @ref start y @ref stop. */
+    bool isRecording() const { return m_recording; }
+
+    /** @brief Parámetros de la grabación en curso (o de la última). */
+    const Settings& getSettings() const { return m_settings; }
+
+    /** @brief Frames copiados en la grabación actual. */
+    unsigned long long getCapturedCount() const { return m_captured; }
+
+    /** @brief Frames ya escritos (PNG en disco o muestra entregada al vídeo). */
+    unsigned long long getEncodedCount() const;
+
+    /** @brief Veces que el render esperó a los codificadores o a la GPU. */
+    unsigned long long getBackPressureCount() const { return m_backPressure; }
+
+    /** @brief Para la grabación si la hay (sin leer lo que siga en vuelo) y libera el anillo. */
+    void destroy();
+
+private:
+    /// Una textura del anillo y el frame que contiene.
+    struct Slot {
+        ID3D11Texture2D* staging = nullptr;
+        D3D11_TEXTURE2D_DESC desc = {};
+        unsigned long long frame = 0;  ///< Frame de la copia.
+        unsigned long long index = 0;  ///< Número de frame dentro de la grabación.
+        bool busy = false;
+    };
+
+    /// Frame leído, a la espera de un codificador.
+    struct Frame {
+        unsigned long long index;
+        unsigned int width;
+        unsigned int height;
+        std::vector<unsigned char> pixels; ///< RGBA, `width * 4` bytes por fila.
+    };
+
+    /// Lee los slots en orden de grabación. `waitOldest`: el primero aunque haya que
+    /// esperar a la GPU; `waitAll`: todos.
+    void readbackInOrder(DeviceContext& deviceContext, bool waitOldest, bool waitAll);
+
+    /// Mapea un slot y encola el frame. `false` si la GPU aún no terminó.
+    bool readback(DeviceContext& deviceContext, Slot& slot, bool wait);
+
+    /// Bucle de los hilos PNG.
+    void pngLoop();
+
+    /// Bucle del hilo de vídeo.
+    void videoLoop();
+
+    /// Crea el sink writer con el tamaño del primer frame (hilo de vídeo).
+    HRESULT openVideo(unsigned int width, unsigned int height);
+
+    /// Convierte un frame a RGB32 y lo entrega al sink writer (hilo de vídeo).
+    HRESULT writeVideoFrame(const Frame& frame);
+
+    /// Para los hilos tras vaciar la cola.
+    void stopWorkers();
+
+    ID3D11Device* m_device = nullptr;    ///< Retenido (AddRef).
+    Slot m_slots[kRingSize];
+    Settings m_settings;
+    bool m_recording = false;
+    bool m_mediaFoundation = false;      ///< `MFStartup` hecho (se cierra en @ref stop).
+    unsigned long long m_frame = 0;      ///< Frames vistos desde @ref start.
+    unsigned long long m_captured = 0;
+    unsigned long long m_nextReadback = 0; ///< Próximo índice a leer (orden de grabación).
+    unsigned long long m_backPressure = 0;
+
+    mutable std::mutex m_mutex;          ///< Protege la cola y los contadores de abajo.
+    std::condition_variable m_wake;      ///< Hay frame o hay que parar.
+    std::condition_variable m_space;     ///< La cola bajó de @ref kMaxQueued.
+    std::vector<std::thread> m_workers;
+    std::deque<Frame> m_frames;
+    bool m_stopping = false;
+    unsigned long long m_encoded = 0;
+
+    // Solo del hilo de vídeo.
+    IMFSinkWriter* m_writer = nullptr;
+    unsigned long m_stream = 0;
+    unsigned int m_videoWidth = 0;
+    unsigned int m_videoHeight = 0;
+    bool m_videoFailed = false;          ///< El sink writer no se pudo crear: se descarta lo que llegue.
+};
@@ -0,0 +1,92 @@
+﻿/**
+ * @file FrameClock.h
+ * @brief Reloj de frame de alta resolución y acumulador de paso fijo.
+ *
+ * @details
+ * Mide el tiempo con `QueryPerformanceCounter` (resolución de microsegundos, frente a
+ * los ~15.6 ms de `GetTickCount`). Cada frame:
+ * 1. `tick()` mide el tiempo real desde el frame anterior y lo suma al acumulador.
+ * 2. `while (stepFixed())` simula pasos de duración constante (`getFixedStep`).
+ * 3. `getAlpha()` indica cuánto del siguiente paso ya ha transcurrido, en [0, 1):
+ *    el render interpola entre los dos últimos estados simulados con ese factor.
+ *
+ * El tiempo de un frame se limita a @ref FrameClock::kMaxFrameTime: tras una pausa
+ * (depurador, arrastre de ventana) no se simulan cientos de pasos de golpe.
+ *
+ * @note Para estudiantes: con paso fijo la simulación da el mismo resultado a 30 o a
+ * 144 FPS; la interpolación evita que el movimiento "salte" cuando el refresco no es
+ * múltiplo del paso.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+
+/**
+ * @class FrameClock
+ * @brief Delta por frame, pasos fijos de simulación y factor de interpolación.
+ */
+class FrameClock {
+public:
+    FrameClock() = default;
+    ~FrameClock() = default;
+
+    /// Paso de simulación por defecto (60 Hz).
+    static const double kDefaultFixedStep;
+    /// Tiempo máximo que se acepta de un solo frame (s).
+    static const double kMaxFrameTime;
+
+    /**
+     * @brief Arranca el reloj.
+     * @param fixedStep Duración de cada paso de simulación (s).
+     *
+     * @note El acumulador empieza con un paso completo: el primer frame siempre
+     * simula una vez y los actores tienen estado antes del primer render.
+     */
+    void init(double fixedStep = kDefaultFixedStep);
+
+    /** @brief Mide el frame actual; llamar una vez al principio de cada frame. */
+    void tick();
+
+    /**
+     * @brief Consume un paso fijo del acumulador.
+     * @return `true` si había tiempo para un paso más (simularlo); `false` al terminar.
+     */
+    bool stepFixed();
+
+    /** @brief Tiempo del último frame en segundos (limitado a `kMaxFrameTime`). */
+    float getDeltaTime() const { return static_cast<float>(m_deltaTime); }
+
+    /** @brief Tiempo real del último frame, sin limitar (para mediciones). */
+    double getRawDeltaTime() const { return m_rawDeltaTime; }
+
+    /** @brief Duración del paso de simulación en segundos. */
+    float getFixedStep() const { return static_cast<float>(m_fixedStep); }
+
+    /** @brief Fracción del siguiente paso ya transcurrida, en [0, 1). */
+    float getAlpha() const { return static_cast<float>(m_accumulator / m_fixedStep); }
+
+    /** @brief Segundos transcurridos desde `init` (suma de deltas limitados). */
+    double getTotalTime() const { return m_totalTime; }
+
+    /** @brief Frames medidos desde `init`. */
+    unsigned long long getFrameCount() const { return m_frameCount; }
+
+    /**
+     * @brief Fija el delta de cada frame, se tarde lo que se tarde en dibujarlo.
+     * @param seconds Delta por frame; 0 vuelve al tiempo real.
+     * @note Para grabar a frecuencia fija (@ref FrameCapture): la animación avanza
+     * igual aunque codificar frene el render. `getRawDeltaTime` sigue midiendo.
+     */
+    void setLockedDelta(double seconds) { m_lockedDelta = seconds; }
+
+private:
+    LARGE_INTEGER m_frequency = {};     ///< Ticks por segundo del contador.
+    LARGE_INTEGER m_lastCounter = {};   ///< Lectura del contador en el último `tick`.
+    double m_fixedStep = kDefaultFixedStep; ///< Paso de simulación (s).
+    double m_accumulator = 0.0;         ///< Tiempo pendiente de simular (s).
+    double m_deltaTime = 0.0;           ///< Último frame, limitado (s).
+    double m_rawDeltaTime = 0.0;        ///< Último frame, sin limitar (s).
+    double m_totalTime = 0.0;           ///< Tiempo acumulado (s).
+    unsigned long long m_frameCount = 0; ///< Frames medidos.
+    double m_lockedDelta = 0.0;         ///< Delta fijo por frame (0 = tiempo real).
+};
@@ -0,0 +1,67 @@
+﻿/**
+ * @file FrameLimiter.h
+ * @brief Limitador de FPS con esperas precisas sobre un waitable timer.
+ *
+ * @details
+ * `wait()` se llama una vez por frame y bloquea hasta que se cumple el periodo de
+ * 1/targetFps desde el frame anterior:
+ * - La mayor parte de la espera se duerme en un *waitable timer* (sin gastar CPU).
+ *   Si el sistema lo permite se crea con `CREATE_WAITABLE_TIMER_HIGH_RESOLUTION`
+ *   (Windows 10 1803+); si no, se usa un timer clásico y `timeBeginPeriod(1)`.
+ * - El último tramo (@ref FrameLimiter::kSpinTime, o más con el timer clásico) se completa
+ *   girando sobre `QueryPerformanceCounter`, para no despertar tarde.
+ * - Los frames se programan sobre una cadencia fija (`anterior + periodo`); si un
+ *   frame llega tarde, la cadencia se reinicia en lugar de intentar recuperar.
+ *
+ * @note Para estudiantes: `Sleep(1)` puede dormir hasta 15.6 ms con la resolución
+ * por defecto del sistema; por eso se duerme "casi todo" y se remata esperando activamente.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+
+/**
+ * @class FrameLimiter
+ * @brief Acota la tasa de frames a un objetivo configurable.
+ */
+class FrameLimiter {
+public:
+    FrameLimiter() = default;
+    ~FrameLimiter() = default;
+
+    /// Tramo final que se espera activamente con el timer de alta resolución (s).
+    static const double kSpinTime;
+    /// Tramo final con el timer clásico (resolución de ~1 ms tras `timeBeginPeriod`).
+    static const double kLegacySpinTime;
+
+    /**
+     * @brief Crea el timer y fija el objetivo.
+     * @param targetFps Frames por segundo objetivo; 0 desactiva el límite.
+     * @return `S_OK`, o el error de creación del timer (entonces solo se espera girando).
+     */
+    HRESULT init(double targetFps);
+
+    /** @brief Cambia el objetivo (0 = sin límite). */
+    void setTargetFps(double targetFps);
+
+    /** @brief FPS objetivo actual (0 = sin límite). */
+    double getTargetFps() const { return m_targetFps; }
+
+    /** @brief Bloquea hasta el inicio del siguiente frame según el objetivo. */
+    void wait();
+
+    /** @brief Reinicia la cadencia (p. ej. tras una pausa larga). */
+    void reset();
+
+    /** @brief Cierra el timer y restaura la resolución del sistema. */
+    void destroy();
+
+private:
+    HANDLE m_timer = nullptr;           ///< Waitable timer para la espera gruesa.
+    bool m_highResolution = false;      ///< Timer creado con alta resolución.
+    bool m_raisedPeriod = false;        ///< Se llamó a `timeBeginPeriod(1)`.
+    double m_targetFps = 0.0;           ///< Objetivo (0 = sin límite).
+    LONGLONG m_periodTicks = 0;         ///< Periodo del frame en ticks del contador.
+    LARGE_INTEGER m_frequency = {};     ///< Ticks por segundo del contador.
+    LARGE_INTEGER m_nextFrame = {};     ///< Momento objetivo del próximo frame.
+};
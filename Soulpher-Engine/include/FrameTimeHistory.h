@@ -0,0 +1,131 @@
+﻿/**
+ * @file FrameTimeHistory.h
+ * @brief Historial de tiempos de frame, percentiles y captura automática de tirones.
+ *
+ * @details
+ * Guarda los últimos @ref FrameTimeHistory::kCapacity tiempos de frame en un anillo y
+ * calcula p50, p95 y p99 sobre ellos (el panel "Frame Times" los muestra con un
+ * histograma). Cuando un frame supera el umbral (@ref setHitchThreshold) se queda
+ * con lo que los perfiladores saben de **ese** frame:
+ * - Las zonas de CPU del frame (@ref CpuProfiler), copiadas en cuanto termina: el
+ *   anillo del perfilador se sobrescribe en unos pocos frames.
+ * - Los pases de GPU (@ref GpuProfiler), que llegan `GpuProfiler::kFrameLatency`
+ *   frames más tarde; hasta entonces el tirón queda "pendiente de GPU".
+ *
+ * Se guardan los últimos @ref kMaxHitches tirones; @ref writeHitchTrace exporta uno
+ * en formato Chrome `trace_event`, igual que @ref TraceCapture.
+ *
+ * @note Para estudiantes: el FPS medio esconde los tirones (carga de una textura,
+ * compilación de un shader a mitad de partida); un solo frame de 80 ms entre mil de
+ * 8 ms apenas mueve la media, pero el jugador lo nota.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "CpuProfiler.h"
+#include "GpuProfiler.h"
+#include <deque>
+
+/**
+ * @class FrameTimeHistory
+ * @brief Anillo de tiempos de frame con detección y captura de tirones.
+ */
+class FrameTimeHistory {
+public:
+    FrameTimeHistory() = default;
+    ~FrameTimeHistory() = default;
+
+    /// Frames recordados (unos 8 s a 120 FPS).
+    static const unsigned int kCapacity = 1024;
+    /// Tirones guardados (los más antiguos se descartan).
+    static const unsigned int kMaxHitches = 8;
+    /// Umbral inicial de tirón (ms): dos frames a 60 Hz.
+    static const double kDefaultHitchMs;
+
+    /// p50, p95 y p99 del historial (ms).
+    struct Percentiles {
+        float p50 = 0.0f;
+        float p95 = 0.0f;
+        float p99 = 0.0f;
+    };
+
+    /// Lo capturado de un frame que superó el umbral.
+    struct Hitch {
+        unsigned long long frame = 0;   ///< Número de frame (desde el arranque o `clear`).
+        float ms = 0.0f;                ///< Duración del frame.
+        LONGLONG cpuBegin = 0;          ///< Inicio del frame (ticks de QPC; 0 sin `PROFILE`).
+        LONGLONG cpuEnd = 0;            ///< Fin del frame.
+        std::vector<CpuProfiler::ThreadEvent> cpuEvents; ///< Zonas del frame.
+        std::vector<std::string> threadNames;            ///< Nombre de cada hilo de `cpuEvents`.
+        std::vector<GpuProfiler::Result> gpuPasses;      ///< Pases de GPU de ese frame.
+        UINT64 gpuFrameBegin = 0;       ///< Timestamp de GPU del inicio de ese frame.
+        UINT64 gpuFrequency = 0;        ///< Ticks/s de los timestamps de GPU.
+        unsigned int gpuFramesLeft = 0; ///< Frames hasta que lleguen sus pases de GPU.
+        bool gpuMissing = false;        ///< La GPU descartó ese frame (o no hay perfilador).
+    };
+
+    /**
+     * @brief Registra el frame recién terminado; llamar una vez por frame tras `FrameClock::tick`.
+     * @param frameSeconds Duración del frame (`FrameClock::getRawDeltaTime`).
+     * @param cpuProfiler Su frame 0 es el que acaba de terminar.
+     * @param gpuProfiler Completa los tirones pendientes cuando llegan sus resultados.
+     */
+    void recordFrame(double frameSeconds, const CpuProfiler& cpuProfiler, const GpuProfiler& gpuProfiler);
+
+    /**
+     * @brief Ignora el próximo frame: tras dormir en reposo (`WaitMessage`, modo idle)
+     * su duración es la espera, no trabajo, y no debe contar como tirón.
+     */
+    void skipNextFrame() { m_skipNext = true; }
+
+    /** @brief Umbral de tirón en ms. */
+    void setHitchThreshold(double ms) { m_hitchMs = ms; }
+    double getHitchThreshold() const { return m_hitchMs; }
+
+    /** @brief Frames en el historial (como mucho `kCapacity`). */
+    unsigned int getCount() const { return static_cast<unsigned int>((std::min)(m_written, static_cast<unsigned long long>(kCapacity))); }
+
+    /** @brief Tiempo del frame `back` posiciones atrás (0 = el último), en ms. */
+    float getFrameMs(unsigned int back) const;
+
+    /** @brief Percentiles sobre todo el historial. */
+    Percentiles getPercentiles() const;
+
+    /**
+     * @brief Reparte el historial en `binCount` intervalos iguales de [0, maxMs].
+     * @param bins Recibe la cuenta de cada intervalo (el último acumula todo lo que pase de `maxMs`).
+     * @param binCount Número de intervalos.
+     * @param maxMs Límite superior del histograma.
+     */
+    void buildHistogram(float* bins, unsigned int binCount, float maxMs) const;
+
+    /** @brief Tirones guardados, del más antiguo al más reciente. */
+    const std::deque<Hitch>& getHitches() const { return m_hitches; }
+
+    /** @brief Tirones detectados desde el arranque o `clear` (incluidos los descartados). */
+    unsigned long long getHitchCount() const { return m_hitchCount; }
+
+    /** @brief Borra historial y tirones. */
+    void clear();
+
+    /**
+     * @brief Escribe un tirón como Chrome `trace_event` (chrome://tracing, Perfetto).
+     * @param index Posición en @ref getHitches.
+     * @param path Archivo de salida (.json).
+     * @param cpuProfiler Para convertir ticks a microsegundos.
+     * @return `S_OK`, `E_INVALIDARG` si el índice no existe o `E_FAIL` si no se pudo escribir.
+     *
+     * @note Los pases de GPU no se alinean con el reloj de CPU (eso requiere
+     * calibrar, ver `TraceCapture`): van en su propio carril empezando en 0.
+     */
+    HRESULT writeHitchTrace(size_t index, const std::string& path, const CpuProfiler& cpuProfiler) const;
+
+private:
+    float m_frames[kCapacity] = {};     ///< Anillo de duraciones (ms).
+    unsigned long long m_written = 0;   ///< Frames registrados.
+    double m_hitchMs = kDefaultHitchMs; ///< Umbral de tirón.
+    bool m_skipNext = false;            ///< Descartar el próximo frame (venía de reposo).
+    std::deque<Hitch> m_hitches;        ///< Últimos tirones.
+    unsigned long long m_hitchCount = 0;///< Tirones detectados.
+    unsigned long long m_gpuSerial = 0; ///< Último resultado de GPU visto.
+};
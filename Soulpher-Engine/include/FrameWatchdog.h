@@ -0,0 +1,154 @@
+﻿/**
+ * @file FrameWatchdog.h
+ * @brief Presupuesto por subsistema (update, culling, envío, GPU) y volcado automático
+ * a disco cuando uno se pasa varios frames seguidos.
+ *
+ * @details
+ * Un tirón en la máquina de un cliente no se puede reproducir después: hay que guardar
+ * lo que pasaba mientras ocurría. El vigilante funciona en Release (sin `PROFILE`):
+ *
+ * - @ref FrameWatchdog::Scope mide con dos `QueryPerformanceCounter` las partes del frame
+ *   de cada etapa (@ref BudgetStage); el tiempo de GPU sale de @ref GpuProfiler.
+ * - @ref FrameWatchdog::endFrame guarda los tiempos del frame en un anillo de
+ *   @ref FrameWatchdog::kHistory muestras (unos 8 s a 120 FPS) y los compara con su
+ *   presupuesto.
+ * - Si una etapa pasa de su presupuesto `consecutiveFrames` frames seguidos, escribe
+ *   `watchdog_<frame>.json` (Chrome `trace_event`, como @ref FrameTimeHistory): los
+ *   últimos `dumpSeconds` segundos como contadores por etapa, las zonas de CPU de ese
+ *   intervalo (solo con `PROFILE`), los últimos pases de GPU y las estadísticas de la
+ *   escena en `otherData`. Tras un volcado espera `cooldownSeconds` antes del siguiente:
+ *   un nivel que se pasa siempre no llena el disco.
+ *
+ * Cada etapa la mide un solo hilo (update en el principal; culling y envío en el de
+ * render) y @ref FrameWatchdog::endFrame se llama con ambos parados (tras
+ * `RenderThread::wait`): no hace falta sincronizar. Con `-renderthread 1` una muestra
+ * junta el update de un frame con el render del anterior.
+ *
+ * @note Para estudiantes: "K frames seguidos" separa un presupuesto roto de un frame
+ * suelto (un GC, una página de memoria); para esos ya está @ref FrameTimeHistory.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+
+class CpuProfiler;
+class GpuProfiler;
+
+/**
+ * @enum BudgetStage
+ * @brief Parte del frame con presupuesto propio.
+ */
+enum BudgetStage {
+    BUDGET_UPDATE = 0,      ///< Lógica, UI y simulación (hilo principal).
+    BUDGET_CULLING,         ///< Culling de las vistas y oclusión.
+    BUDGET_SUBMISSION,      ///< Paquetes y grabación de draws (vista y sombras).
+    BUDGET_GPU,             ///< Frame de GPU (@ref GpuProfiler, con su retraso).
+    BUDGET_STAGE_COUNT
+};
+
+/**
+ * @class FrameWatchdog
+ * @brief Anillo de tiempos por etapa, detección de presupuestos rotos y volcado.
+ */
+class FrameWatchdog {
+public:
+    FrameWatchdog();
+    ~FrameWatchdog() = default;
+
+    /// Muestras guardadas (unos 8 s a 120 FPS).
+    static const unsigned int kHistory = 1024;
+
+    /// Presupuestos y volcado.
+    struct Settings {
+        bool enabled = true;
+        float budgetMs[BUDGET_STAGE_COUNT] = { 4.0f, 2.0f, 4.0f, 16.0f };
+        unsigned int consecutiveFrames = 5; ///< Frames seguidos sobre el presupuesto (K).
+        float dumpSeconds = 5.0f;           ///< Historia que se escribe.
+        float cooldownSeconds = 30.0f;      ///< Mínimo entre dos volcados.
+    };
+
+    /// Estado de la escena en el momento del volcado (lo rellena quien llama).
+    struct SceneStats {
+        unsigned int actors = 0;
+        unsigned int visibleActors = 0;     ///< Tras frustum y oclusión.
+        unsigned int occludedActors = 0;
+        unsigned int drawCalls = 0;
+        unsigned long long primitives = 0;
+        unsigned int stateChanges = 0;
+        unsigned long long uploadBytes = 0;
+        unsigned int commandLists = 0;
+        unsigned int stalls = 0;            ///< Esperas a la GPU sobre el umbral (@ref StallDetector).
+        size_t gpuMemoryBytes = 0;
+    };
+
+    /**
+     * @class Scope
+     * @brief Suma su vida al tiempo de `stage` en el frame en curso.
+     */
+    class Scope {
+    public:
+        Scope(FrameWatchdog& watchdog, BudgetStage stage);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        FrameWatchdog& m_watchdog;
+        BudgetStage m_stage;
+        LONGLONG m_start;
+    };
+
+    void setSettings(const Settings& settings) { m_settings = settings; }
+    const Settings& getSettings() const { return m_settings; }
+
+    /**
+     * @brief Cierra el frame: guarda la muestra, cuenta las etapas sobre el presupuesto
+     * y, si alguna llega a `consecutiveFrames`, escribe el volcado.
+     * @param frameMs Duración del frame.
+     * @param gpuProfiler Tiempo de GPU del último resultado; últimos pases del volcado.
+     * @param cpuProfiler Zonas de CPU del volcado (vacías sin `PROFILE`).
+     * @param scene Estadísticas de la escena; solo se leen si hay volcado.
+     * @return `true` si se escribió un volcado.
+     */
+    bool endFrame(double frameMs, const GpuProfiler& gpuProfiler, const CpuProfiler& cpuProfiler,
+        const SceneStats& scene);
+
+    /** @brief Tiempo de `stage` en la última muestra (ms). */
+    float getLastMs(BudgetStage stage) const;
+
+    /** @brief Frames seguidos que `stage` lleva sobre su presupuesto. */
+    unsigned int getOverBudgetFrames(BudgetStage stage) const { return m_overBudget[stage]; }
+
+    /** @brief Volcados escritos desde el arranque. */
+    unsigned int getDumpCount() const { return m_dumpCount; }
+
+    /** @brief Archivo del último volcado (vacío si no hubo). */
+    const std::string& getLastDumpPath() const { return m_lastDumpPath; }
+
+    /** @brief Nombre legible de una etapa (para la UI y el volcado). */
+    static const char* getStageName(BudgetStage stage);
+
+private:
+    /// Un frame del anillo.
+    struct Sample {
+        unsigned long long frame = 0;
+        LONGLONG end = 0;                   ///< Fin del frame (ticks de QPC).
+        float frameMs = 0.0f;
+        float stageMs[BUDGET_STAGE_COUNT] = {};
+    };
+
+    /// Escribe el volcado; `trigger` es la etapa que lo disparó.
+    HRESULT writeDump(const std::string& path, BudgetStage trigger, const GpuProfiler& gpuProfiler,
+        const CpuProfiler& cpuProfiler, const SceneStats& scene) const;
+
+    Settings m_settings;
+    double m_ticksToMs = 0.0;
+    double m_current[BUDGET_STAGE_COUNT] = {};  ///< Frame en curso (ms).
+    Sample m_samples[kHistory];
+    unsigned long long m_written = 0;           ///< Muestras guardadas.
+    unsigned int m_overBudget[BUDGET_STAGE_COUNT] = {};
+    unsigned long long m_gpuSerial = 0;         ///< Último resultado de GPU contado.
+    LONGLONG m_lastDump = 0;                    ///< Ticks del último volcado (0 = ninguno).
+    unsigned int m_dumpCount = 0;
+    std::string m_lastDumpPath;
+};
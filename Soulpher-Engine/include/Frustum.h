@@ -0,0 +1,82 @@
+﻿/**
+ * @file Frustum.h
+ * @brief Pirámide de visión (6 planos) para descartar objetos fuera de cámara.
+ *
+ * @details
+ * Los planos se extraen directamente de la matriz `view * projection`
+ * (método de Gribb/Hartmann). Con la convención de XNA Math (vector fila,
+ * `v * M`) cada plano es una combinación de columnas de la matriz:
+ * - izquierda = c3 + c0, derecha = c3 - c0
+ * - abajo     = c3 + c1, arriba  = c3 - c1
+ * - cerca     = c2 (z de D3D en [0, 1]), lejos = c3 - c2
+ *
+ * Los planos se normalizan y apuntan hacia dentro: un punto es visible si
+ * `dot(n, p) + d >= 0` para los seis.
+ *
+ * @note Para estudiantes: las pruebas son conservadoras. Un objeto puede
+ * declararse visible sin estarlo (cerca de las esquinas), pero nunca al revés.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+
+/**
+ * @enum FrustumPlane
+ * @brief Índice de cada plano en `Frustum::m_planes`.
+ */
+enum FrustumPlane {
+    FRUSTUM_LEFT = 0,
+    FRUSTUM_RIGHT = 1,
+    FRUSTUM_BOTTOM = 2,
+    FRUSTUM_TOP = 3,
+    FRUSTUM_NEAR = 4,
+    FRUSTUM_FAR = 5,
+    FRUSTUM_PLANE_COUNT = 6
+};
+
+/**
+ * @class Frustum
+ * @brief Conjunto de planos de recorte y pruebas contra esferas y AABB.
+ */
+class Frustum {
+public:
+    Frustum() = default;
+    ~Frustum() = default;
+
+    /**
+     * @brief Extrae los planos de una matriz de vista-proyección.
+     * @param viewProjection `view * projection` (sin transponer).
+     */
+    void update(const XMMATRIX& viewProjection);
+
+    /**
+     * @brief Prueba una esfera en espacio mundo.
+     * @return `false` solo si la esfera está completamente fuera.
+     */
+    bool intersectsSphere(const XMFLOAT3& center, float radius) const;
+
+    /**
+     * @brief Prueba una AABB en espacio mundo (vértice positivo por plano).
+     * @return `false` solo si la caja está completamente fuera.
+     */
+    bool intersectsAABB(const XMFLOAT3& boundsMin, const XMFLOAT3& boundsMax) const;
+
+    /**
+     * @brief Lleva una AABB local a espacio mundo (AABB de la caja transformada).
+     * @param localMin Esquina mínima local.
+     * @param localMax Esquina máxima local.
+     * @param world Matriz de mundo (vector fila).
+     * @param outMin Esquina mínima en mundo.
+     * @param outMax Esquina máxima en mundo.
+     *
+     * @note Método de Arvo: extensión' = |M| * extensión, centro' = centro * M.
+     */
+    static void transformAABB(const XMFLOAT3& localMin, const XMFLOAT3& localMax,
+        const XMMATRIX& world, XMFLOAT3& outMin, XMFLOAT3& outMax);
+
+    /** @brief Plano `i` como (nx, ny, nz, d). */
+    const XMFLOAT4& getPlane(unsigned int i) const { return m_planes[i]; }
+
+private:
+    XMFLOAT4 m_planes[FRUSTUM_PLANE_COUNT]; ///< Planos normalizados (n, d), normales hacia dentro.
+};
@@ -0,0 +1,200 @@
+﻿/**
+ * @file GeometryPool.h
+ * @brief Vertex/Index Buffers de toda la escena repartidos por rangos.
+ *
+ * @details
+ * Con páginas propias (ver `MeshAsset`) cada asset enlaza su VB e IB, y con mallas
+ * que entran y salen del streaming se crean y destruyen buffers todo el rato. El
+ * pool mantiene **un** VB, un stream de posiciones y un IB de 16 bits para toda la
+ * escena; un asset es un bloque dentro de ellos (vértice base e índice inicial), así
+ * que la `RenderQueue` enlaza el estado de IA una vez y cada draw solo cambia sus
+ * desplazamientos (lo que también necesitaría un futuro camino de draws indirectos).
+ *
+ * - Reparto: @ref RangeAllocator, mejor ajuste con fusión de huecos vecinos, uno
+ *   para vértices y otro para índices.
+ * - Crecimiento: si un bloque no cabe, los buffers se recrean al doble (hasta
+ *   @ref kMaxBufferBytes) copiando el contenido en la GPU a los **mismos**
+ *   desplazamientos, así que lo ya enviado a la cola sigue siendo válido.
+ * - Liberación diferida: @ref free no devuelve el rango hasta el siguiente
+ *   @ref update; los paquetes del frame en curso pueden seguir apuntando a él y una
+ *   subida nueva lo sobrescribiría antes de dibujarlos.
+ * - Desfragmentación: en @ref update (inicio de frame, cola vacía), si los huecos
+ *   están muy repartidos, los bloques se compactan en buffers nuevos. Los bloques
+ *   se leen siempre por handle (@ref getRange), nunca guardando desplazamientos.
+ *
+ * Los índices de un bloque son relativos a su submalla (se dibujan con
+ * `BaseVertexLocation`), por eso caben en 16 bits y moverlos no obliga a reescribirlos.
+ *
+ * @note Para estudiantes: las subidas usan `UpdateSubresource` en el hilo principal.
+ * No pasan por `UploadScheduler` porque una compactación copia los buffers al
+ * momento y las subidas todavía en cola llegarían al buffer viejo.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "Buffer.h"
+#include <map>
+
+class Device;
+class DeviceContext;
+
+/**
+ * @class RangeAllocator
+ * @brief Reparte [0, capacidad) en rangos contiguos (mejor ajuste, huecos fusionados).
+ */
+class RangeAllocator {
+public:
+    /** @brief Deja un único hueco de `capacity` unidades. */
+    void reset(unsigned int capacity);
+
+    /** @brief Amplía la capacidad; lo nuevo queda libre al final. */
+    void grow(unsigned int capacity);
+
+    /**
+     * @brief Reserva `size` unidades en el hueco más pequeño donde quepan.
+     * @return `false` si ningún hueco es suficiente.
+     */
+    bool allocate(unsigned int size, unsigned int& offset);
+
+    /** @brief Devuelve un rango y lo fusiona con los huecos contiguos. */
+    void free(unsigned int offset, unsigned int size);
+
+    unsigned int getCapacity() const { return m_capacity; }
+    unsigned int getFreeUnits() const { return m_free; }
+
+    /** @brief Tamaño del mayor hueco. */
+    unsigned int getLargestFree() const { return m_bySize.empty() ? 0 : m_bySize.rbegin()->first; }
+
+private:
+    void insertFree(unsigned int offset, unsigned int size);
+    void eraseFree(std::map<unsigned int, unsigned int>::iterator hole);
+
+    std::map<unsigned int, unsigned int> m_byOffset;    ///< Huecos: inicio -> tamaño.
+    std::multimap<unsigned int, unsigned int> m_bySize; ///< Huecos: tamaño -> inicio.
+    unsigned int m_capacity = 0;
+    unsigned int m_free = 0;
+};
+
+/**
+ * @class GeometryPool
+ * @brief VB, posiciones e IB compartidos por todos los assets, repartidos en bloques.
+ */
+class GeometryPool {
+public:
+    GeometryPool() = default;
+    ~GeometryPool() { destroy(); }
+
+    /// Identificador de un bloque (estable aunque el bloque se mueva).
+    typedef unsigned int Handle;
+    static const Handle kNullHandle = 0;
+
+    /// Vértices iniciales del pool.
+    static const unsigned int kInitialVertices = 256u << 10;
+    /// Índices iniciales del pool.
+    static const unsigned int kInitialIndices = 768u << 10;
+    /// Tamaño máximo de cada buffer (mínimo que D3D11 garantiza por recurso).
+    static const unsigned int kMaxBufferBytes = 128u << 20;
+    /// Fracción de la memoria libre que debe estar fuera del mayor hueco para compactar.
+    static const float kFragmentationThreshold;
+
+    /// Posición de un bloque dentro de los buffers.
+    struct Range {
+        int baseVertex = 0;           ///< Primer vértice del bloque.
+        unsigned int vertexCount = 0;
+        unsigned int startIndex = 0;  ///< Primer índice del bloque.
+        unsigned int indexCount = 0;
+    };
+
+    /**
+     * @brief Crea los buffers vacíos.
+     * @param device Dispositivo (se guarda para crecer).
+     * @param deviceContext Contexto inmediato para subidas y copias (se guarda).
+     * @param vertexStride Bytes por vértice del stream completo.
+     * @param positionStride Bytes por vértice del stream de posiciones.
+     * @return `S_OK` o el error al crear los buffers.
+     */
+    HRESULT init(Device& device, DeviceContext& deviceContext, unsigned int vertexStride,
+        unsigned int positionStride, unsigned int vertexCapacity = kInitialVertices,
+        unsigned int indexCapacity = kInitialIndices);
+
+    /**
+     * @brief Reserva un bloque y sube sus datos (hilo principal).
+     * @param vertices `vertexCount` vértices con el stride del pool.
+     * @param positions `vertexCount` posiciones con el stride de posiciones.
+     * @param indices Índices de 32 bits; todos deben ser menores que 65 536.
+     * @return Handle del bloque, o @ref kNullHandle si no cabe o los datos no valen.
+     */
+    Handle allocate(const void* vertices, const void* positions, unsigned int vertexCount,
+        const unsigned int* indices, unsigned int indexCount);
+
+    /** @brief Libera un bloque en el próximo @ref update (ignora handles no válidos). */
+    void free(Handle handle);
+
+    /** @brief Posición actual de un bloque (vacía si el handle no es válido). */
+    Range getRange(Handle handle) const;
+
+    /** @brief Inicio de frame: devuelve los bloques liberados y compacta si hace falta. */
+    void update();
+
+    /**
+     * @brief Compacta los bloques al principio de los buffers.
+     * @warning Cambia los desplazamientos: solo con la cola vacía (lo hace @ref update).
+     * @return `false` si no se pudieron crear los buffers nuevos (se conservan los viejos).
+     */
+    bool defragment();
+
+    /** @brief Libera buffers y bloques. */
+    void destroy();
+
+    /** @brief `true` tras un @ref init correcto. */
+    bool isReady() const { return m_device != nullptr; }
+
+    unsigned int getVertexStride() const { return m_vertexStride; }
+    unsigned int getPositionStride() const { return m_positionStride; }
+
+    Buffer& getVertexBuffer() { return m_vertices; }
+    Buffer& getPositionBuffer() { return m_positions; }
+    Buffer& getIndexBuffer() { return m_indices; }
+
+    /** @brief Bloques vivos. */
+    unsigned int getBlockCount() const { return m_liveBlocks; }
+
+    /** @brief Bytes ocupados por bloques (vivos o pendientes de liberar). */
+    size_t getUsedBytes() const;
+
+    /** @brief Bytes reservados en GPU por los tres buffers. */
+    size_t getCapacityBytes() const;
+
+    /** @brief Compactaciones hechas desde @ref init. */
+    unsigned int getDefragmentCount() const { return m_defragmentCount; }
+
+private:
+    struct Block {
+        Range range;
+        bool used = false;
+    };
+
+    /// Crea buffers de la capacidad dada y copia en ellos el contenido actual.
+    HRESULT resize(unsigned int vertexCapacity, unsigned int indexCapacity, bool compact);
+
+    /// Crece lo justo (al doble, o más) para que quepa un bloque de este tamaño.
+    bool reserve(unsigned int vertexCount, unsigned int indexCount);
+
+    Device* m_device = nullptr;
+    DeviceContext* m_deviceContext = nullptr;
+    unsigned int m_vertexStride = 0;
+    unsigned int m_positionStride = 0;
+
+    Buffer m_vertices;  ///< Stream completo (slot 0).
+    Buffer m_positions; ///< Solo posiciones, para pases de profundidad.
+    Buffer m_indices;   ///< `R16_UINT`.
+    RangeAllocator m_vertexSpace; ///< En vértices.
+    RangeAllocator m_indexSpace;  ///< En índices.
+
+    std::vector<Block> m_blocks;       ///< Handle - 1 -> bloque.
+    std::vector<Handle> m_freeHandles; ///< Handles reutilizables.
+    std::vector<Handle> m_pendingFree; ///< Liberados en este frame.
+    std::vector<unsigned short> m_narrowed; ///< Conversión de índices (reutilizado).
+    unsigned int m_liveBlocks = 0;
+    unsigned int m_defragmentCount = 0;
+};
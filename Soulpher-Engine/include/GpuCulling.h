@@ -0,0 +1,209 @@
+﻿/**
+ * @file GpuCulling.h
+ * @brief Camino GPU-driven: culling en un compute shader y draws indirectos.
+ *
+ * @details
+ * Con la geometría en el @ref GeometryPool todas las mallas comparten VB/IB, así que
+ * lo único que distingue dos draws es su rango y su textura. Este camino (opcional,
+ * `-gpudriven 1`) saca de la CPU el culling y la construcción de lotes:
+ *
+ * 1. **Recogida** (CPU, @ref submit): cada submalla de un actor apto es una instancia
+ *    (mundo + color + AABB en mundo) de un **grupo** = (submalla del pool, textura,
+ *    recibe sombra). No se prueba nada en CPU.
+ * 2. **Culling** (GPU, @ref cull, `GpuCulling.fx`): un hilo por instancia la prueba
+ *    contra el frustum y contra la pirámide Hi-Z del frame anterior (`HiZBuffer`), y
+ *    las visibles se apuntan en la lista de su grupo con un `InterlockedAdd` sobre el
+ *    `InstanceCount` de sus argumentos de `DrawIndexedInstancedIndirect`.
+ * 3. **Dibujo** (@ref render): un draw indirecto por grupo, sin leer nada en CPU. El
+ *    slot 1 es un buffer identidad (0, 1, 2...) por instancia; como los atributos por
+ *    instancia sí suman `StartInstanceLocation`, el VS recibe directamente el hueco
+ *    de la lista de visibles y de ahí el índice de la instancia (`Instancing.fx` con
+ *    `GPU_DRIVEN`).
+ *
+ * Son aptos los actores opacos, no fusionados (`Actor::isBatched`), con volumen, con
+ * el nivel de detalle actual en el pool y cuyos materiales usan el pipeline por defecto
+ * (`Material::usesDefaultPipeline`); las constantes del material (b4) separan grupos. Los demás siguen por la `RenderQueue`, igual
+ * que las colas de sombra (lo que la cámara no ve también proyecta sombra).
+ *
+ * @note Para estudiantes: la CPU sigue recorriendo los actores para copiar sus datos;
+ * lo que deja de crecer con el número de objetos es el número de draws y el trabajo
+ * de culling y ordenación.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "Buffer.h"
+#include "BlendState.h"
+#include "Rasterizer.h"
+#include "SamplerState.h"
+#include <cstdint>
+#include <unordered_map>
+
+class Device;
+class DeviceContext;
+class Actor;
+class Texture;
+class Material;
+class ShaderProgram;
+class Frustum;
+class HiZBuffer;
+class GeometryPool;
+
+/**
+ * @class GpuCulling
+ * @brief Instancias de la escena culleadas en GPU y dibujadas con draws indirectos.
+ */
+class GpuCulling {
+public:
+    GpuCulling() = default;
+    ~GpuCulling() { destroy(); }
+
+    /// Instancias iniciales (los buffers crecen al doble).
+    static const unsigned int kInitialInstances = 4096;
+    /// Grupos iniciales (argumentos indirectos).
+    static const unsigned int kInitialGroups = 64;
+    /// Hilos por grupo de `CSCull`.
+    static const unsigned int kThreadGroupSize = 64;
+
+    /// Instancia tal como la lee la GPU (`Instance` en los .fx).
+    struct InstanceData {
+        XMFLOAT4X4 world;     ///< Mundo ya transpuesto (como `CBChangesEveryFrame::mWorld`).
+        XMFLOAT4 color;
+        XMFLOAT3 boundsMin;   ///< AABB en mundo del actor.
+        uint32_t group;       ///< Grupo (draw indirecto) al que pertenece.
+        XMFLOAT3 boundsMax;
+        uint32_t pad;
+    };
+
+    /**
+     * @brief Crea el kernel de culling, estados y buffers iniciales.
+     * @param device Dispositivo (se guarda para crecer).
+     * @param pool Pool cuyas mallas se pueden dibujar por este camino.
+     * @param program `Instancing.fx` con `GPU_DRIVEN` (geometría + `INSTANCE_SLOT`).
+     * @param receiverProgram Igual para los receptores de sombra; `nullptr` = esos
+     * actores siguen por la cola.
+     * @return `S_OK`; `DXGI_ERROR_UNSUPPORTED` por debajo de 11_0 (camino desactivado).
+     */
+    HRESULT init(Device& device, GeometryPool& pool, ShaderProgram* program, ShaderProgram* receiverProgram);
+
+    /**
+     * @brief Material de las submallas sin material propio (sus constantes van a b4).
+     * @note Sin él, esas submallas dejan b4 como esté.
+     */
+    void setDefaultMaterial(const Material* material) { m_defaultMaterial = material; }
+
+    /** @brief Inicio de frame: vacía instancias y grupos. */
+    void begin();
+
+    /**
+     * @brief Añade las submallas del actor si es apto (ver descripción del archivo).
+     * @return `true` si el actor queda en este camino (no enviarlo a la cola).
+     */
+    bool submit(Actor& actor);
+
+    /**
+     * @brief Sube instancias y argumentos y lanza el culling.
+     * @param deviceContext Contexto inmediato.
+     * @param frustum Frustum de la cámara de este frame.
+     * @param hiZ Pirámide del frame anterior (sin pirámide, solo frustum).
+     */
+    void cull(DeviceContext& deviceContext, const Frustum& frustum, const HiZBuffer& hiZ);
+
+    /**
+     * @brief Un `DrawIndexedInstancedIndirect` por grupo.
+     * @note Con las constantes de cámara (b0/b1) y el shadow map ya enlazados.
+     */
+    void render(DeviceContext& deviceContext);
+
+    /** @brief Libera kernel, buffers y estados. */
+    void destroy();
+
+    /** @brief `true` tras un @ref init correcto. */
+    bool isReady() const { return m_cullShader != nullptr; }
+
+    /** @brief Instancias enviadas a la GPU este frame. */
+    unsigned int getInstanceCount() const { return static_cast<unsigned int>(m_instances.size()); }
+
+    /** @brief Draws indirectos de este frame. */
+    unsigned int getDrawCount() const { return static_cast<unsigned int>(m_groups.size()); }
+
+private:
+    /// Argumentos de `DrawIndexedInstancedIndirect`.
+    struct DrawArgs {
+        unsigned int indexCount;
+        unsigned int instanceCount;
+        unsigned int startIndex;
+        int baseVertex;
+        unsigned int startInstance;
+    };
+
+    /// Constantes de `cbCull` en GpuCulling.fx.
+    struct CullParams {
+        XMFLOAT4 planes[6];
+        XMMATRIX hiZViewProj;
+        unsigned int instanceCount;
+        unsigned int hiZMipCount;
+        unsigned int hiZSize[2];
+    };
+
+    /// Draw indirecto: submalla del pool + textura + constantes de material + programa.
+    struct Group {
+        DrawArgs args;
+        Texture* texture;
+        Buffer* constants;
+        bool receiveShadow;
+    };
+
+    struct GroupKey {
+        int baseVertex;
+        unsigned int startIndex;
+        Texture* texture;
+        Buffer* constants;
+        bool receiveShadow;
+        bool operator==(const GroupKey& o) const {
+            return baseVertex == o.baseVertex && startIndex == o.startIndex &&
+                texture == o.texture && constants == o.constants && receiveShadow == o.receiveShadow;
+        }
+    };
+
+    struct GroupKeyHash {
+        size_t operator()(const GroupKey& k) const {
+            size_t h = std::hash<const void*>()(k.texture);
+            h ^= std::hash<const void*>()(k.constants) + 0x9e3779b9 + (h << 6) + (h >> 2);
+            h ^= std::hash<unsigned int>()(k.startIndex) + 0x9e3779b9 + (h << 6) + (h >> 2);
+            h ^= std::hash<int>()(k.baseVertex) + 0x9e3779b9 + (h << 6) + (h >> 2);
+            return h ^ (k.receiveShadow ? 0x5bd1e995u : 0u);
+        }
+    };
+
+    /// Recrea los buffers de instancias (y lista e identidad) o de argumentos si no caben.
+    HRESULT reserve(unsigned int instanceCount, unsigned int groupCount);
+
+    Device* m_device = nullptr;
+    GeometryPool* m_pool = nullptr;
+    ShaderProgram* m_program = nullptr;
+    ShaderProgram* m_receiverProgram = nullptr;
+    ID3D11ComputeShader* m_cullShader = nullptr;
+
+    ID3D11Buffer* m_instanceBuffer = nullptr;          ///< `StructuredBuffer<Instance>` dinámico.
+    ID3D11ShaderResourceView* m_instanceSRV = nullptr;
+    ID3D11Buffer* m_visibleBuffer = nullptr;           ///< Índices visibles por grupo.
+    ID3D11ShaderResourceView* m_visibleSRV = nullptr;
+    ID3D11UnorderedAccessView* m_visibleUAV = nullptr;
+    ID3D11Buffer* m_argsBuffer = nullptr;              ///< `DrawArgs` por grupo.
+    ID3D11UnorderedAccessView* m_argsUAV = nullptr;
+    ID3D11Buffer* m_params = nullptr;                  ///< Constant buffer `cbCull`.
+    Buffer m_slotBuffer;                               ///< 0..capacidad-1 por instancia (slot 1).
+    unsigned int m_instanceCapacity = 0;
+    unsigned int m_groupCapacity = 0;
+
+    BlendState m_blendState;
+    Rasterizer m_rasterizer;
+    SamplerState m_sampler;
+    const Material* m_defaultMaterial = nullptr;
+
+    std::vector<InstanceData> m_instances;             ///< Instancias del frame.
+    std::vector<Group> m_groups;                       ///< Grupos del frame.
+    std::vector<DrawArgs> m_args;                      ///< Argumentos iniciales (conteo a 0).
+    std::unordered_map<GroupKey, unsigned int, GroupKeyHash> m_groupLookup;
+};
@@ -0,0 +1,128 @@
+﻿/**
+ * @file GpuMemory.h
+ * @brief Memoria de vídeo: presupuesto del sistema (DXGI) y lo que reserva el motor por categoría.
+ *
+ * @details
+ * En tarjetas con poca VRAM, al pasarse del presupuesto el sistema empieza a mover
+ * recursos a memoria del sistema (paginación) y el frame se dispara sin aviso. Esta
+ * clase da dos vistas:
+ *
+ * - **Sistema**: con `IDXGIAdapter3` (Windows 10+), `QueryVideoMemoryInfo` da el
+ *   presupuesto y el uso del proceso en memoria local (VRAM) y no local (compartida).
+ *   El aviso de cambio de presupuesto (`RegisterVideoMemoryBudgetChangeNotificationEvent`)
+ *   hace que @ref GpuMemory::update devuelva `true` para reajustar el streaming. Sin
+ *   `IDXGIAdapter3` el presupuesto es la VRAM dedicada del adaptador, fija.
+ * - **Motor**: @ref GpuMemory::track apunta un recurso en su categoría (texturas,
+ *   render targets, vértices, índices, constantes, staging) con su tamaño estimado.
+ *   `Device::CreateBuffer`/`CreateTexture2D` lo hacen solos; quien crea con el
+ *   `ID3D11Device` directamente (p. ej. los cargadores en hilos) lo llama después.
+ *
+ * El tamaño se resta cuando D3D destruye el recurso, no en cada `Release`: `track`
+ * cuelga del recurso un objeto COM como dato privado (`SetPrivateDataInterface`) y
+ * D3D lo libera junto con él.
+ *
+ * @note Para estudiantes: el tamaño es una estimación (texeles y mips sin el relleno ni
+ * la alineación del driver); sirve para ver qué categoría crece, no para cuadrar bytes.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+
+class Device;
+struct IDXGIAdapter3;
+
+/**
+ * @enum GpuMemoryCategory
+ * @brief Categoría de un recurso apuntado con @ref GpuMemory::track.
+ */
+enum GpuMemoryCategory {
+    GPU_MEMORY_TEXTURE = 0,     ///< Texturas de solo lectura (materiales, atlas, arrays).
+    GPU_MEMORY_RENDER_TARGET,   ///< Texturas con RTV, DSV o UAV (back buffers propios, sombras, Hi-Z).
+    GPU_MEMORY_VERTEX,          ///< Vertex buffers.
+    GPU_MEMORY_INDEX,           ///< Index buffers.
+    GPU_MEMORY_CONSTANT,        ///< Constant buffers.
+    GPU_MEMORY_STAGING,         ///< Copias para leer o subir desde CPU (memoria del sistema).
+    GPU_MEMORY_OTHER,           ///< Buffers estructurados, de argumentos, etc.
+    GPU_MEMORY_CATEGORY_COUNT
+};
+
+/**
+ * @class GpuMemory
+ * @brief Consulta del presupuesto de vídeo y recuento de los recursos del motor.
+ */
+class GpuMemory {
+public:
+    /// Presupuesto y uso de un segmento de memoria (bytes).
+    struct Segment {
+        unsigned long long budget = 0;  ///< Lo que el sistema deja usar al proceso (0 = desconocido).
+        unsigned long long usage = 0;   ///< Lo que usa ahora el proceso.
+    };
+
+    GpuMemory() = default;
+    ~GpuMemory() { destroy(); }
+    GpuMemory(const GpuMemory&) = delete;
+    GpuMemory& operator=(const GpuMemory&) = delete;
+
+    /**
+     * @brief Busca `IDXGIAdapter3` y se registra para los avisos de presupuesto.
+     * @param device Dispositivo ya creado.
+     * @return `S_OK` también sin `IDXGIAdapter3` (ver @ref hasBudgetQueries).
+     */
+    HRESULT init(Device& device);
+
+    /** @brief Anula el registro de avisos y suelta el adaptador. */
+    void destroy();
+
+    /**
+     * @brief Relee el presupuesto (hilo principal, una vez por frame).
+     * @return `true` si el sistema avisó de un presupuesto nuevo desde la última llamada.
+     */
+    bool update();
+
+    /** @brief `true` si el sistema informa de presupuesto y uso (`IDXGIAdapter3`). */
+    bool hasBudgetQueries() const { return m_adapter != nullptr; }
+
+    /** @brief VRAM: presupuesto y uso del proceso (sin `IDXGIAdapter3`, VRAM dedicada y bytes apuntados). */
+    const Segment& getLocal() const { return m_local; }
+
+    /** @brief Memoria compartida con la CPU (solo con `IDXGIAdapter3`). */
+    const Segment& getNonLocal() const { return m_nonLocal; }
+
+    /** @brief `true` si el uso local pasa del presupuesto (el sistema está paginando). */
+    bool isOverBudget() const { return m_local.budget != 0 && m_local.usage > m_local.budget; }
+
+    // ==== Recuento del motor (cualquier hilo) ====
+
+    /**
+     * @brief Apunta `resource` (buffer o textura 2D) en su categoría hasta que se destruya.
+     * @note Apuntarlo otra vez sustituye la entrada anterior; no cuenta dos veces.
+     */
+    static void track(ID3D11Resource* resource);
+
+    /** @brief Bytes vivos estimados de la categoría. */
+    static unsigned long long getTrackedBytes(GpuMemoryCategory category);
+
+    /** @brief Recursos vivos de la categoría. */
+    static unsigned int getTrackedCount(GpuMemoryCategory category);
+
+    /** @brief Bytes vivos de todas las categorías salvo staging (lo que ocupa VRAM). */
+    static unsigned long long getTrackedVideoBytes();
+
+    /** @brief Nombre de la categoría para el panel. */
+    static const char* getCategoryName(GpuMemoryCategory category);
+
+    /** @brief Bytes estimados de una textura 2D (todos los mips, elementos y muestras). */
+    static unsigned long long estimateBytes(const D3D11_TEXTURE2D_DESC& desc);
+
+private:
+    /// Lee presupuesto y uso de ambos segmentos.
+    void query();
+
+    IDXGIAdapter3* m_adapter = nullptr;
+    HANDLE m_budgetEvent = nullptr;
+    DWORD m_budgetCookie = 0;
+    unsigned long long m_dedicatedBytes = 0;    ///< VRAM dedicada del adaptador (sin `IDXGIAdapter3`).
+    Segment m_local;
+    Segment m_nonLocal;
+    bool m_wasOverBudget = false;               ///< Para avisar solo al cruzar el presupuesto.
+};
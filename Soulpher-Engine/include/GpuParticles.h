@@ -0,0 +1,257 @@
+﻿/**
+ * @file GpuParticles.h
+ * @brief Partículas simuladas enteras en GPU: emisión, simulación y compactación en
+ * compute sobre listas append/consume, orden opcional y dibujo indirecto.
+ *
+ * @details
+ * Con partículas en CPU cada frame se simulan, ordenan y suben todas; a partir de
+ * unas decenas de miles el coste es la simulación y el ancho de banda. Aquí la CPU
+ * solo dice cuántas nacen en cada emisor (@ref capture) y nada vuelve de la GPU:
+ *
+ * 1. **Emisión** (`CSEmit`, un dispatch por emisor): cada hilo saca un índice libre de
+ *    la lista de muertas (`ConsumeStructuredBuffer`), inicializa la partícula y la
+ *    apunta en la lista de vivas. Antes, `CopyStructureCount` copia cuántas quedan
+ *    libres a `cbDeadCount`: nunca se consume más de lo que hay.
+ * 2. **Simulación** (`CSSimulate`, `DispatchIndirect`): un hilo por viva envejece,
+ *    integra y la vuelve a apuntar en la otra lista de vivas, o devuelve su índice a
+ *    las muertas. Las listas de vivas se alternan cada frame, así que compactar es
+ *    gratis: lo que no se apunta desaparece.
+ * 3. **Orden** (opcional, `Settings::sorted`): bitonic sort de (profundidad, índice)
+ *    de atrás adelante, para la mezcla alfa.
+ * 4. **Dibujo** (`DrawInstancedIndirect`): una instancia (tira de 4 vértices) por viva;
+ *    el número de instancias lo escribe `CopyStructureCount` en los argumentos.
+ *
+ * El fundido suave contra la escena lee su profundidad como SRV (no hay DSV enlazado),
+ * así que funciona igual con MSAA (la profundidad resuelta de `Multisampling`).
+ *
+ * Necesita nivel 11_0 (UAVs en compute y argumentos indirectos); sin él @ref init
+ * devuelve `DXGI_ERROR_UNSUPPORTED` y los emisores se ignoran.
+ *
+ * @note Para estudiantes: sin ordenar, la mezcla es aditiva y el orden da igual. El
+ * bitonic sort recorre toda la capacidad (potencia de dos), no solo las vivas: su
+ * coste es fijo, O(n log² n) en la capacidad, y por eso es opcional.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "ConstantBufferLayout.h"
+#include "Rasterizer.h"
+#include "DepthStencilState.h"
+#include <cstdint>
+
+class Device;
+class DeviceContext;
+
+/**
+ * @class GpuParticles
+ * @brief Emisores en CPU y todas sus partículas en GPU.
+ */
+class GpuParticles {
+public:
+    GpuParticles() = default;
+    ~GpuParticles() { destroy(); }
+
+    /// Partículas por defecto (la capacidad se redondea a potencia de dos).
+    static const unsigned int kDefaultCapacity = 1u << 20;
+    /// Hilos por grupo de emisión, simulación y claves de orden.
+    static const unsigned int kThreadGroupSize = 256;
+    /// Claves que ordena cada grupo en memoria compartida (y capacidad mínima).
+    static const unsigned int kSortGroupSize = 512;
+    /// Emisores a la vez.
+    static const unsigned int kMaxEmitters = 64;
+
+    /// Emisor: una esfera que suelta partículas a un ritmo.
+    struct Emitter {
+        XMFLOAT3 position = XMFLOAT3(0.0f, 0.0f, 0.0f);
+        float rate = 100.0f;                ///< Partículas por segundo.
+        XMFLOAT3 velocity = XMFLOAT3(0.0f, 1.0f, 0.0f); ///< Velocidad inicial media.
+        float spread = 0.5f;                ///< Velocidad aleatoria añadida (en una esfera de ese radio).
+        float radius = 0.0f;                ///< Radio de la esfera de nacimiento.
+        XMFLOAT4 color = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);      ///< Al nacer.
+        XMFLOAT4 colorEnd = XMFLOAT4(1.0f, 1.0f, 1.0f, 0.0f);   ///< Al morir.
+        float lifetime = 2.0f;              ///< Segundos.
+        float lifetimeVariance = 0.5f;      ///< +- segundos.
+        float size = 0.1f;                  ///< Lado del quad al nacer (unidades de mundo).
+        float sizeEnd = 0.1f;               ///< Al morir.
+        bool enabled = true;
+    };
+
+    /// Parámetros comunes a todas las partículas.
+    struct Settings {
+        XMFLOAT3 gravity = XMFLOAT3(0.0f, -9.8f, 0.0f);
+        float drag = 0.0f;                  ///< Frenado por segundo (0 = ninguno).
+        float softDistance = 0.25f;         ///< Distancia de fundido contra la escena (0 = bordes duros).
+        bool sorted = false;                ///< De atrás adelante con mezcla alfa (si no, aditiva).
+    };
+
+    /**
+     * @brief Crea buffers, kernels, programa y estados.
+     * @param capacity Partículas vivas como mucho (se redondea a potencia de dos, mínimo
+     * @ref kSortGroupSize).
+     * @return `S_OK`, `DXGI_ERROR_UNSUPPORTED` por debajo de 11_0, o el error.
+     */
+    HRESULT init(Device& device, unsigned int capacity = kDefaultCapacity);
+
+    /**
+     * @brief Añade un emisor (hilo principal).
+     * @return Su identificador, o -1 si ya hay @ref kMaxEmitters.
+     */
+    int addEmitter(const Emitter& emitter);
+
+    /** @brief Cambia un emisor; las partículas que ya soltó siguen como estaban. */
+    void setEmitter(int id, const Emitter& emitter);
+
+    /** @brief Quita un emisor (sus partículas viven hasta el final de su vida). */
+    void removeEmitter(int id);
+
+    /** @brief Emisor `id`, o `nullptr` si no existe. */
+    const Emitter* getEmitter(int id) const;
+
+    const Settings& getSettings() const { return m_settings; }
+    void setSettings(const Settings& settings) { m_settings = settings; }
+
+    /**
+     * @brief Calcula cuántas nacen en cada emisor en este frame y lo entrega al render.
+     * @param deltaTime Segundos simulados desde la última captura.
+     * @note Con el render parado (`BaseApp::captureFrame`).
+     */
+    void capture(float deltaTime);
+
+    /**
+     * @brief Emite, simula y (si toca) ordena las partículas del frame capturado.
+     * @param view Vista de la cámara (para la profundidad del orden).
+     * @param cameraPosition Posición de la cámara.
+     */
+    void simulate(DeviceContext& deviceContext, const XMMATRIX& view, const XMFLOAT3& cameraPosition);
+
+    /**
+     * @brief Dibuja las vivas sobre el color de la escena.
+     * @param rtv Color de la escena.
+     * @param depthSRV Profundidad de la escena de una muestra (fundido suave).
+     * @param width,height Tamaño de `rtv`.
+     * @param view,projection Cámara del frame.
+     * @param nearZ,farZ Planos de la proyección (para linealizar la profundidad).
+     */
+    void render(DeviceContext& deviceContext, ID3D11RenderTargetView* rtv, ID3D11ShaderResourceView* depthSRV,
+        unsigned int width, unsigned int height, const XMMATRIX& view, const XMMATRIX& projection,
+        float nearZ, float farZ);
+
+    /** @brief Mata todas las partículas (al cambiar de escena). */
+    void clear() { m_needsReset = true; }
+
+    /** @brief Libera todo. */
+    void destroy();
+
+    /** @brief `true` tras un @ref init correcto. */
+    bool isReady() const { return m_device != nullptr; }
+
+    /** @brief `true` si hay algún emisor o pudo quedar alguna partícula viva. */
+    bool isActive() const { return isReady() && (m_activeEmitters > 0 || m_liveSeconds > 0.0f); }
+
+    unsigned int getCapacity() const { return m_capacity; }
+
+private:
+    /// Partícula tal como la leen los kernels (`Particle` en GpuParticles.fx).
+    struct Particle {
+        XMFLOAT3 position;
+        float age;
+        XMFLOAT3 velocity;
+        float lifetime;
+        uint32_t color;         ///< RGBA8 al nacer.
+        uint32_t colorEnd;      ///< RGBA8 al morir.
+        float size;
+        float sizeEnd;
+    };
+
+    /// Constantes de `cbParticles` (b11).
+    struct CBParticles {
+        XMFLOAT4 emitPosition;  ///< xyz posición, w radio.
+        XMFLOAT4 emitVelocity;  ///< xyz velocidad, w dispersión.
+        uint32_t emitColor[4];  ///< Color inicial y final (RGBA8).
+        XMFLOAT4 emitShape;     ///< Tamaño inicial y final, vida y su variación.
+        uint32_t emitInfo[4];   ///< Partículas a emitir, semilla, capacidad.
+        uint32_t sortInfo[4];   ///< k, j, capacidad del orden (w sin uso).
+        XMFLOAT4 gravity;       ///< xyz gravedad, w delta.
+        XMFLOAT4 simulation;    ///< Frenado, distancia suave, cerca, lejos.
+        XMFLOAT4 cameraRight;   ///< Eje x de la vista en mundo (billboard).
+        XMFLOAT4 cameraUp;      ///< Eje y de la vista en mundo.
+        XMFLOAT4 cameraForward; ///< w: -dot(adelante, ojo) (profundidad = dot + w).
+        XMMATRIX viewProj;
+    };
+    /// Contador copiado por `CopyStructureCount` (`cbDeadCount` / `cbAliveCount`).
+    struct CBCount {
+        uint32_t count[4];      ///< Solo `x`; el resto, relleno hasta 16 bytes.
+    };
+    static const ConstantBufferLayouts::Registration kParticlesLayout;
+    static const ConstantBufferLayouts::Registration kDeadCountLayout;
+    static const ConstantBufferLayouts::Registration kAliveCountLayout;
+
+    /// Emisor registrado y lo que lleva acumulado entre frames.
+    struct EmitterSlot {
+        Emitter emitter;
+        float carry = 0.0f;     ///< Fracción de partícula pendiente.
+        bool used = false;
+    };
+
+    /// Emisión del frame capturado.
+    struct Emission {
+        Emitter emitter;
+        unsigned int count;
+    };
+
+    HRESULT createSortBuffers();
+    void dispatchSort(DeviceContext& deviceContext, ID3D11ShaderResourceView* aliveSRV);
+    void upload(DeviceContext& deviceContext);
+    void unbindCompute(DeviceContext& deviceContext);
+
+    Device* m_device = nullptr;
+    unsigned int m_capacity = 0;
+    Settings m_settings;
+    Settings m_frameSettings;               ///< Los de la última @ref capture (los lee el render).
+    EmitterSlot m_emitters[kMaxEmitters];
+    unsigned int m_activeEmitters = 0;
+    std::vector<Emission> m_emissions;      ///< Frame capturado (lo lee @ref simulate).
+    float m_deltaTime = 0.0f;               ///< Delta del frame capturado.
+    float m_liveSeconds = 0.0f;             ///< Vida máxima que le queda a alguna partícula.
+    uint32_t m_seed = 0;
+    bool m_needsReset = true;
+    unsigned int m_alive = 0;               ///< Lista de vivas que lee la simulación.
+    bool m_sortedFrame = false;             ///< @ref simulate dejó las claves ordenadas.
+    bool m_sortFailed = false;              ///< No se pudo crear el buffer del orden (no se reintenta).
+
+    CBParticles m_constants = {};
+    ID3D11Buffer* m_params = nullptr;       ///< `cbParticles`.
+    ID3D11Buffer* m_deadCount = nullptr;    ///< `cbDeadCount`.
+    ID3D11Buffer* m_aliveCount = nullptr;   ///< `cbAliveCount`.
+
+    ID3D11Buffer* m_particleBuffer = nullptr;
+    ID3D11UnorderedAccessView* m_particleUAV = nullptr;
+    ID3D11ShaderResourceView* m_particleSRV = nullptr;
+    ID3D11Buffer* m_deadBuffer = nullptr;
+    ID3D11UnorderedAccessView* m_deadUAV = nullptr;   ///< Con contador (append/consume).
+    ID3D11Buffer* m_aliveBuffer[2] = {};
+    ID3D11UnorderedAccessView* m_aliveUAV[2] = {};    ///< Con contador.
+    ID3D11ShaderResourceView* m_aliveSRV[2] = {};
+    ID3D11Buffer* m_sortBuffer = nullptr;             ///< (clave, índice); se crea al ordenar por primera vez.
+    ID3D11UnorderedAccessView* m_sortUAV = nullptr;
+    ID3D11ShaderResourceView* m_sortSRV = nullptr;
+    ID3D11Buffer* m_argsBuffer = nullptr;             ///< [0..3] draw, [4..6] dispatch de la simulación.
+    ID3D11UnorderedAccessView* m_argsUAV = nullptr;
+
+    ID3D11ComputeShader* m_resetShader = nullptr;
+    ID3D11ComputeShader* m_emitShader = nullptr;
+    ID3D11ComputeShader* m_prepareShader = nullptr;
+    ID3D11ComputeShader* m_simulateShader = nullptr;
+    ID3D11ComputeShader* m_sortKeysShader = nullptr;
+    ID3D11ComputeShader* m_sortLocalShader = nullptr;
+    ID3D11ComputeShader* m_sortStepShader = nullptr;
+    ID3D11ComputeShader* m_sortMergeShader = nullptr;
+
+    ID3D11VertexShader* m_vertexShader = nullptr;       ///< Lee la lista de vivas.
+    ID3D11VertexShader* m_sortedVertexShader = nullptr; ///< Lee las claves ordenadas.
+    ID3D11PixelShader* m_pixelShader = nullptr;
+    ID3D11BlendState* m_additive = nullptr; ///< ONE, ONE (premultiplicado, sin orden).
+    ID3D11BlendState* m_premultiplied = nullptr; ///< ONE, INV_SRC_ALPHA (ordenado).
+    Rasterizer m_rasterizer;
+    DepthStencilState m_noDepth;
+};
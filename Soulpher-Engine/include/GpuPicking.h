@@ -0,0 +1,141 @@
+﻿/**
+ * @file GpuPicking.h
+ * @brief Selección de actores con el ratón: buffer de identificadores y readback diferido.
+ *
+ * @details
+ * El clic en el viewport se resuelve en la GPU, con la misma geometría que se ve
+ * (LOD actual, posiciones del asset), en lugar de con cajas:
+ *
+ * 1. @ref GpuPicking::request guarda el píxel bajo el cursor (cualquier hilo).
+ * 2. En el render, la proyección se amplía para que ese píxel ocupe un target de 1x1
+ *    `R32_UINT` (con su propio depth buffer). Los candidatos salen de los árboles de la
+ *    escena con el frustum de ese píxel, así que se dibujan unos pocos actores y no la
+ *    escena entera. Cada uno escribe su posición en la lista de candidatos + 1
+ *    (`Picking.fx`); el depth test deja el más cercano.
+ * 3. El texel se copia a una textura `STAGING` del anillo y se lee
+ *    @ref GpuPicking::kLatencyFrames frames después con `DO_NOT_WAIT`, como las
+ *    capturas de `Screenshot`: la CPU nunca espera a la GPU.
+ *
+ * - Los candidatos se guardan como handles: si el actor se destruye antes de leer el
+ *   resultado, el handle queda nulo y el clic no selecciona nada.
+ * - Solo entran los actores de los árboles: los que no tienen caja y los del camino
+ *   GPU-driven no se pueden seleccionar con el ratón (sí desde el outliner).
+ *
+ * @note Para estudiantes: el resultado llega unos frames tarde. Para seleccionar da
+ * igual; para algo que deba responder en el mismo frame, mejor `SceneQuery`.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "ConstantBuffer.h"
+#include "ShaderProgram.h"
+#include "ECS/ActorPool.h"
+#include <mutex>
+
+class Device;
+class DeviceContext;
+class SceneBVH;
+
+/**
+ * @class GpuPicking
+ * @brief Pase de identificadores de 1x1 bajo el cursor y anillo de lecturas.
+ */
+class GpuPicking {
+public:
+    GpuPicking() = default;
+    ~GpuPicking() { destroy(); }
+    GpuPicking(const GpuPicking&) = delete;
+    GpuPicking& operator=(const GpuPicking&) = delete;
+
+    /// Frames entre la copia y el primer intento de lectura.
+    static const unsigned int kLatencyFrames = 2;
+    /// Texturas de staging del anillo (clics en vuelo a la vez).
+    static const unsigned int kMaxInFlight = 3;
+
+    /**
+     * @brief Crea el target de 1x1, su depth buffer, el programa y el anillo.
+     * @param device Dispositivo.
+     * @param layout Layout del stream de posiciones (el del pre-pase de profundidad).
+     * @return `S_OK` o el error; sin él no hay selección con el ratón.
+     */
+    HRESULT init(Device& device, const std::vector<D3D11_INPUT_ELEMENT_DESC>& layout);
+
+    /**
+     * @brief Pide el actor bajo un píxel del viewport (sustituye a la petición sin atender).
+     * @param x Columna del píxel (cliente de la ventana).
+     * @param y Fila del píxel.
+     * @param width Ancho del viewport.
+     * @param height Alto del viewport.
+     */
+    void request(int x, int y, unsigned int width, unsigned int height);
+
+    /**
+     * @brief Lee los clics ya copiados y, si hay petición, dibuja su pase.
+     * @param deviceContext Contexto inmediato, con la cámara del frame en b0.
+     * @param view Vista del frame.
+     * @param projection Proyección del frame.
+     * @param staticTree Árbol de los actores estáticos.
+     * @param dynamicTree Árbol de los demás.
+     * @param actors Actores a los que apuntan los identificadores de los árboles.
+     * @return `true` si dibujó el pase: quedan enlazados su target, su viewport y su
+     * proyección en b1, y el llamador tiene que volver a enlazar los suyos.
+     */
+    bool render(DeviceContext& deviceContext, const XMMATRIX& view, const XMMATRIX& projection,
+        const SceneBVH& staticTree, const SceneBVH& dynamicTree, const std::vector<ActorHandle>& actors);
+
+    /**
+     * @brief Recoge el resultado del último clic resuelto (una sola vez).
+     * @param outActor Actor bajo el cursor; nulo si no había ninguno.
+     * @return `true` si había un resultado nuevo.
+     */
+    bool consumeResult(ActorHandle& outActor);
+
+    /** @brief Hay un clic pedido o en vuelo. */
+    bool isPending() const;
+
+    /** @brief Libera el target, el anillo y el programa. */
+    void destroy();
+
+    /** @brief `true` tras un @ref init correcto. */
+    bool isReady() const { return m_target != nullptr; }
+
+private:
+    /// Una textura de staging del anillo y los candidatos del clic que contiene.
+    struct Slot {
+        ID3D11Texture2D* staging = nullptr;
+        std::vector<ActorHandle> candidates; ///< Identificador `i + 1` = `candidates[i]`.
+        unsigned long long frame = 0;        ///< Frame de la copia.
+        bool busy = false;                   ///< Copia hecha, aún sin leer.
+    };
+
+    /// Petición de clic.
+    struct Request {
+        int x = 0;
+        int y = 0;
+        unsigned int width = 0;
+        unsigned int height = 0;
+    };
+
+    /// Mapea un slot y publica su resultado. `false` si la GPU aún no terminó.
+    bool readback(DeviceContext& deviceContext, Slot& slot);
+
+    ID3D11Device* m_device = nullptr;
+    ID3D11Texture2D* m_target = nullptr;          ///< 1x1 `R32_UINT`.
+    ID3D11RenderTargetView* m_targetView = nullptr;
+    ID3D11Texture2D* m_depth = nullptr;           ///< 1x1 `D32_FLOAT`.
+    ID3D11DepthStencilView* m_depthView = nullptr;
+    ID3D11RasterizerState* m_rasterizer = nullptr;
+    ShaderProgram m_program;                      ///< `Picking.fx`.
+    TConstantBuffer<CBChangeOnResize> m_projection; ///< Proyección del píxel (b1).
+    TConstantBuffer<CBChangesEveryFrame> m_object;  ///< Mundo del actor + identificador (b2).
+    Slot m_slots[kMaxInFlight];
+    std::vector<unsigned int> m_ids;              ///< Identificadores de los árboles (reutilizado).
+    unsigned long long m_frame = 0;
+
+    mutable std::mutex m_mutex;                   ///< Protege la petición y el resultado.
+    Request m_request;
+    bool m_requested = false;
+    ActorHandle m_result;
+    bool m_hasResult = false;
+    unsigned int m_inFlight = 0;                  ///< Slots copiados sin leer.
+};
@@ -0,0 +1,211 @@
+﻿/**
+ * @file GpuProfiler.h
+ * @brief Perfilador de GPU con queries de timestamp por pase.
+ *
+ * @details
+ * Cada frame abre una query `D3D11_QUERY_TIMESTAMP_DISJOINT` (da la frecuencia del
+ * contador y avisa si el reloj de la GPU cambió a mitad de frame) y cada sección
+ * medida escribe dos `D3D11_QUERY_TIMESTAMP`, al empezar y al terminar.
+ *
+ * Los resultados llegan con retraso: hay @ref GpuProfiler::kFrameLatency juegos de
+ * queries en anillo y un juego solo se lee cuando se va a reutilizar, tres frames
+ * después. Se lee con `D3D11_ASYNC_GETDATA_DONOTFLUSH`: si la GPU aún no terminó, ese
+ * frame se descarta en lugar de esperar.
+ *
+ * Uso:
+ * @code
+ * m_gpuProfiler.beginFrame(ctx);
+ * {
+ *     GpuProfiler::Scope scope(m_gpuProfiler, ctx, "Shadows");
+ *     ... // draws del pase
+ * }
+ * m_gpuProfiler.endFrame(ctx);
+ * @endcode
+ *
+ * Opcionalmente (@ref setPipelineStatistics) cada sección abre también una query
+ * `D3D11_QUERY_PIPELINE_STATISTICS`, leída con el mismo retraso: vértices leídos por el
+ * IA, invocaciones de VS y PS y primitivas rasterizadas. Dividir las invocaciones de PS
+ * entre los píxeles del render target da el *overdraw* medio del pase.
+ *
+ * @note Para estudiantes: la CPU solo *encola* comandos; medir con el reloj de la CPU
+ * alrededor de un draw no dice cuánto tarda la GPU. Los timestamps los escribe la
+ * propia GPU cuando llega a ese punto del command buffer.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+
+class Device;
+class DeviceContext;
+
+/**
+ * @class GpuProfiler
+ * @brief Secciones con nombre medidas en GPU, con lectura sin bloqueos.
+ */
+class GpuProfiler {
+public:
+    GpuProfiler() = default;
+    ~GpuProfiler() = default;
+
+    /// Juegos de queries en vuelo (frames que se tarda en leer un resultado).
+    static const unsigned int kFrameLatency = 3;
+    /// Secciones como máximo por frame (las que sobren no se miden).
+    static const unsigned int kMaxScopes = 32;
+
+    /// Resultado de una sección en el último frame leído.
+    struct Result {
+        const char* name;   ///< Nombre dado en `beginScope` (literal, no se copia).
+        unsigned int depth; ///< Nivel de anidamiento (0 = sección de primer nivel).
+        float ms;           ///< Tiempo de GPU en milisegundos.
+        UINT64 begin;       ///< Timestamp de GPU al abrir (ticks de `getFrequency`).
+        UINT64 end;         ///< Timestamp de GPU al cerrar.
+        bool hasStatistics; ///< `statistics` es válido (estadísticas activas y leídas).
+        D3D11_QUERY_DATA_PIPELINE_STATISTICS statistics; ///< Contadores del pipeline del pase.
+    };
+
+    /**
+     * @brief Medidor RAII: abre una sección al construirse y la cierra al destruirse.
+     *
+     * @note También abre un evento con el mismo nombre (`DeviceContext::beginEvent`),
+     * así cada pase medido aparece agrupado en PIX y RenderDoc.
+     */
+    class Scope {
+    public:
+        Scope(GpuProfiler& profiler, DeviceContext& deviceContext, const char* name)
+            : m_profiler(profiler), m_deviceContext(deviceContext),
+            m_index(profiler.beginScope(deviceContext, name)) {}
+        ~Scope() { m_profiler.endScope(m_deviceContext, m_index); }
+
+    private:
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        GpuProfiler& m_profiler;
+        DeviceContext& m_deviceContext;
+        unsigned int m_index;
+    };
+
+    /**
+     * @brief Crea todas las queries del anillo.
+     * @param device Dispositivo Direct3D.
+     * @return `S_OK` o el error; con error el perfilador no mide nada.
+     */
+    HRESULT init(Device& device);
+
+    /**
+     * @brief Empieza el frame: recoge el juego más antiguo (si está listo) y lo reutiliza.
+     * @param deviceContext Contexto inmediato.
+     */
+    void beginFrame(DeviceContext& deviceContext);
+
+    /** @brief Cierra la sección de frame y la query disjoint. */
+    void endFrame(DeviceContext& deviceContext);
+
+    /**
+     * @brief Abre una sección (y su evento de depuración, aunque el perfilador esté apagado).
+     * @param deviceContext Contexto inmediato.
+     * @param name Nombre (debe vivir mientras se muestren resultados: usar literales).
+     * @return Índice para `endScope` (o `kMaxScopes` si no quedan huecos).
+     */
+    unsigned int beginScope(DeviceContext& deviceContext, const char* name);
+
+    /** @brief Cierra la sección `index` devuelta por `beginScope`. */
+    void endScope(DeviceContext& deviceContext, unsigned int index);
+
+    /** @brief Secciones del último frame leído, en orden de apertura. */
+    const std::vector<Result>& getResults() const { return m_results; }
+
+    /** @brief Tiempo de GPU del último frame leído (ms). */
+    float getFrameTime() const { return m_frameTime; }
+
+    /** @brief Frecuencia del reloj de GPU del último frame leído (ticks/s). */
+    UINT64 getFrequency() const { return m_frequency; }
+
+    /** @brief Timestamps de inicio y fin del último frame leído. */
+    UINT64 getFrameBegin() const { return m_frameBegin; }
+    UINT64 getFrameEnd() const { return m_frameEnd; }
+
+    /** @brief Se incrementa con cada frame leído: permite saber si hay resultados nuevos. */
+    unsigned long long getResultSerial() const { return m_resultSerial; }
+
+    /**
+     * @brief Toma un par (reloj de CPU, reloj de GPU) del mismo instante.
+     * @param deviceContext Contexto inmediato.
+     * @param outCpuTicks Lectura de `QueryPerformanceCounter`.
+     * @param outGpuTicks Timestamp de GPU equivalente.
+     * @param outGpuFrequency Frecuencia del reloj de GPU.
+     * @return `false` si no se pudo (reloj disjunto o perfilador desactivado).
+     *
+     * @warning Bloquea hasta vaciar la GPU: usar solo al empezar una captura, nunca por frame.
+     */
+    bool calibrate(DeviceContext& deviceContext, LONGLONG& outCpuTicks,
+        UINT64& outGpuTicks, UINT64& outGpuFrequency);
+
+    /**
+     * @brief Activa las estadísticas de pipeline por sección (tienen coste: van apagadas).
+     * @note Se aplica desde el próximo `beginFrame`; los resultados tardan `kFrameLatency` frames.
+     */
+    void setPipelineStatistics(bool enable) { m_statisticsRequested = enable; }
+
+    /** @brief `true` si se pidieron estadísticas de pipeline. */
+    bool isPipelineStatisticsEnabled() const { return m_statisticsRequested; }
+
+    /** @brief `true` si el dispositivo creó las queries de estadísticas. */
+    bool hasPipelineStatistics() const { return m_statisticsSupported; }
+
+    /**
+     * @brief Píxeles del render target principal (para calcular overdraw).
+     * @param pixels Ancho por alto del back buffer.
+     */
+    void setTargetPixelCount(unsigned int pixels) { m_targetPixels = pixels; }
+
+    /** @brief Píxeles dados en `setTargetPixelCount`. */
+    unsigned int getTargetPixelCount() const { return m_targetPixels; }
+
+    /** @brief Frames descartados (no listos o reloj disjunto) desde `init`. */
+    unsigned int getDroppedFrames() const { return m_droppedFrames; }
+
+    /** @brief `true` si las queries se crearon. */
+    bool isEnabled() const { return m_enabled; }
+
+    /** @brief Libera todas las queries. */
+    void destroy();
+
+private:
+    /// Queries de un frame del anillo.
+    struct FrameQueries {
+        ID3D11Query* disjoint = nullptr;
+        ID3D11Query* frameBegin = nullptr;
+        ID3D11Query* frameEnd = nullptr;
+        ID3D11Query* begin[kMaxScopes] = {};
+        ID3D11Query* end[kMaxScopes] = {};
+        ID3D11Query* statistics[kMaxScopes] = {};
+        bool statisticsIssued = false;  ///< Este frame abrió las queries de estadísticas.
+        const char* names[kMaxScopes] = {};
+        unsigned int depths[kMaxScopes] = {};
+        unsigned int scopeCount = 0;
+        bool pending = false;           ///< Emitido y aún sin leer.
+    };
+
+    /// Lee un juego emitido; `false` si aún no está listo o el reloj fue disjunto.
+    bool collect(DeviceContext& deviceContext, FrameQueries& frame);
+
+    FrameQueries m_frames[kFrameLatency];
+    unsigned int m_current = 0;         ///< Juego del frame en curso.
+    unsigned int m_depth = 0;           ///< Anidamiento actual.
+    bool m_inFrame = false;             ///< Entre `beginFrame` y `endFrame`.
+    bool m_enabled = false;             ///< Queries creadas.
+    std::vector<Result> m_results;      ///< Último frame leído.
+    float m_frameTime = 0.0f;           ///< Total del último frame leído (ms).
+    UINT64 m_frequency = 0;             ///< Frecuencia del último frame leído.
+    UINT64 m_frameBegin = 0;            ///< Timestamp de inicio del último frame leído.
+    UINT64 m_frameEnd = 0;              ///< Timestamp de fin del último frame leído.
+    unsigned long long m_resultSerial = 0; ///< Frames leídos con éxito.
+    ID3D11Query* m_calibrationEvent = nullptr;     ///< Espera a GPU vacía.
+    ID3D11Query* m_calibrationDisjoint = nullptr;  ///< Frecuencia para la calibración.
+    ID3D11Query* m_calibrationTimestamp = nullptr; ///< Timestamp de la calibración.
+    unsigned int m_droppedFrames = 0;   ///< Frames sin resultado.
+    bool m_statisticsRequested = false; ///< Pedido con `setPipelineStatistics`.
+    bool m_statisticsSupported = false; ///< Queries de estadísticas creadas.
+    unsigned int m_targetPixels = 0;    ///< Píxeles del render target principal.
+};
@@ -0,0 +1,84 @@
+﻿/**
+ * @file GpuReleaseQueue.h
+ * @brief Liberación diferida de recursos de GPU hasta que la GPU termina el frame en que
+ * se soltaron.
+ *
+ * @details
+ * `Texture::destroy` y `Buffer::destroy` hacían `Release` en el acto. Con varios frames
+ * en vuelo, el hilo de render y el streaming, el recurso suele seguir referenciado por
+ * comandos que la GPU aún no ha ejecutado: el driver tiene que parar o aplazar la
+ * liberación por su cuenta (y a veces lo hace dentro de otra llamada del frame). Aquí:
+ *
+ * - @ref GpuReleaseQueue::release (desde cualquier hilo: principal, render o carga) anota
+ *   el objeto con el frame en curso.
+ * - @ref GpuReleaseQueue::collect, una vez por frame justo después de
+ *   `SwapChain::waitForFrame` (render parado), recibe cuántos frames terminó la GPU
+ *   según las queries de evento del swap chain (@ref SwapChain::pollCompletedFrames) y
+ *   hace el `Release` de lo que se soltó en esos frames.
+ *
+ * Antes del primer @ref GpuReleaseQueue::collect y después de @ref GpuReleaseQueue::flush
+ * (cierre) no hay frames que esperar y `release` libera en el acto.
+ *
+ * Crear recursos ya se puede desde cualquier hilo (`ID3D11Device` es thread-safe y las
+ * subidas van por `UploadScheduler`); con esta cola, soltarlos también.
+ *
+ * @note Para estudiantes: lo que tiene que soltarse **ya** no pasa por aquí. Un ejemplo
+ * es el back buffer antes de `ResizeBuffers` (`SwapChain::resize` lo libera directamente).
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include <atomic>
+#include <deque>
+#include <mutex>
+
+/**
+ * @class GpuReleaseQueue
+ * @brief Objetos COM pendientes de `Release`, con el frame en que se soltaron.
+ */
+class GpuReleaseQueue {
+public:
+    GpuReleaseQueue() = default;
+    ~GpuReleaseQueue() { flush(); }
+    GpuReleaseQueue(const GpuReleaseQueue&) = delete;
+    GpuReleaseQueue& operator=(const GpuReleaseQueue&) = delete;
+
+    /** @brief Cola del proceso (la que usan `Texture` y `Buffer`). */
+    static GpuReleaseQueue& getDefault();
+
+    /**
+     * @brief Suelta una referencia a `object` cuando la GPU termine el frame en curso.
+     * @note Cualquier hilo; `nullptr` no hace nada.
+     */
+    void release(IUnknown* object);
+
+    /**
+     * @brief Abre el frame `currentFrame` y libera lo soltado en frames ya terminados.
+     * @param currentFrame Frame que empieza (`SwapChain::getFrameIndex() - 1`).
+     * @param completedFrames La GPU terminó todos los frames anteriores a este.
+     * @note Hilo principal, una vez por frame, con el render parado.
+     */
+    void collect(unsigned long long currentFrame, unsigned long long completedFrames);
+
+    /** @brief Libera todo lo pendiente y vuelve a liberar en el acto (cierre). */
+    void flush();
+
+    /** @brief Objetos esperando a su frame. */
+    size_t getPendingCount() const;
+
+    /** @brief Objetos liberados por @ref collect desde el arranque. */
+    unsigned long long getDeferredCount() const { return m_deferred.load(std::memory_order_relaxed); }
+
+private:
+    struct Pending {
+        IUnknown* object;
+        unsigned long long frame;   ///< Frame en que se soltó.
+    };
+
+    mutable std::mutex m_mutex;
+    std::deque<Pending> m_pending;      ///< En orden de frame (se lee `m_frame` con el mutex).
+    std::vector<IUnknown*> m_ready;     ///< Lo que `collect` libera fuera del mutex (reutilizado).
+    unsigned long long m_frame = 0;     ///< Frame en curso (con `m_mutex`).
+    std::atomic<bool> m_active{ false }; ///< Hay frames en marcha: `release` difiere.
+    std::atomic<unsigned long long> m_deferred{ 0 };
+};
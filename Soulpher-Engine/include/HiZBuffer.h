@@ -0,0 +1,149 @@
+﻿/**
+ * @file HiZBuffer.h
+ * @brief Pirámide Hi-Z (hierarchical Z) del depth buffer para occlusion culling.
+ *
+ * @details
+ * Tras dibujar la escena, un compute shader (`HiZ.fx`) reduce el depth buffer a una
+ * cadena de mips en la que cada texel guarda la profundidad **máxima** (la más lejana)
+ * de su huella. Un objeto cuya profundidad mínima supera ese máximo en todo el
+ * rectángulo que cubre en pantalla está detrás de lo ya dibujado: oculto.
+ *
+ * La prueba se hace en CPU, antes de enviar draw packets:
+ * - Uno de los mips gruesos (ancho <= @ref kReadbackMaxWidth) se copia a una textura
+ *   *staging* y se lee un frame después con `D3D11_MAP_FLAG_DO_NOT_WAIT`, así la CPU
+ *   nunca espera a la GPU.
+ * - Junto al mip se guarda la `viewProj` con la que se generó; las cajas se proyectan
+ *   con esa matriz, de modo que la prueba es coherente aunque la cámara se haya movido.
+ * - Con un frame de latencia un objeto puede descartarse por error justo cuando deja de
+ *   estar tapado; al siguiente frame su profundidad ya está en la pirámide y reaparece.
+ *
+ * El camino GPU-driven (`GpuCulling`) lee la pirámide completa en la GPU
+ * (@ref getPyramidSRV) con la `viewProj` del frame que la generó (@ref getPyramidViewProj).
+ *
+ * Si el hardware no soporta compute shaders (nivel 10.x), `init` falla y la prueba
+ * responde siempre "visible": el frustum culling sigue funcionando igual.
+ *
+ * @note Para estudiantes: se guarda el máximo (no el mínimo) porque queremos saber
+ * cuál es el punto MÁS lejano ya dibujado en una zona; si algo está aún más lejos,
+ * no se verá.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+
+class Device;
+class DeviceContext;
+
+/**
+ * @class HiZBuffer
+ * @brief Construye la pirámide de profundidad en GPU y responde pruebas de oclusión en CPU.
+ */
+class HiZBuffer {
+public:
+    HiZBuffer() = default;
+    ~HiZBuffer() = default;
+
+    /// Ancho máximo del mip que se lee en CPU (el primer nivel que cabe).
+    static const unsigned int kReadbackMaxWidth = 128;
+
+    /**
+     * @brief Crea la pirámide (a media resolución del depth buffer) y el kernel de reducción.
+     * @param device Dispositivo Direct3D.
+     * @param width Ancho del depth buffer.
+     * @param height Alto del depth buffer.
+     * @return `S_OK` o el error; con error el objeto queda desactivado (todo visible).
+     */
+    HRESULT init(Device& device, unsigned int width, unsigned int height);
+
+    /**
+     * @brief Reduce el depth buffer del frame y programa la lectura del mip grueso.
+     * @param deviceContext Contexto del dispositivo.
+     * @param depthSRV Vista de lectura del depth buffer (R24_UNORM_X8_TYPELESS).
+     * @param viewProj Matriz vista*proyección con la que se dibujó el frame.
+     * @param depthWidth Ancho del depth buffer de este frame: con resolución dinámica,
+     * entre la mitad y el tamaño de @ref init (la pirámide no cambia de tamaño).
+     * @param depthHeight Alto.
+     *
+     * @warning Desenlaza los render targets (el depth buffer no puede ser a la vez
+     * DSV y SRV); vuelve a enlazarlos antes de seguir dibujando.
+     */
+    void build(DeviceContext& deviceContext,
+        ID3D11ShaderResourceView* depthSRV,
+        const XMMATRIX& viewProj,
+        unsigned int depthWidth,
+        unsigned int depthHeight);
+
+    /**
+     * @brief Indica si una caja en espacio de mundo está oculta según la última pirámide leída.
+     * @param boundsMin Esquina mínima de la AABB.
+     * @param boundsMax Esquina máxima de la AABB.
+     * @return `true` solo si está oculta con seguridad; ante cualquier duda, `false`.
+     */
+    bool isOccluded(const XMFLOAT3& boundsMin, const XMFLOAT3& boundsMax) const;
+
+    /** @brief Libera texturas, vistas, shader y buffer. */
+    void destroy();
+
+    /**
+     * @brief Olvida la pirámide y las lecturas pendientes (sin liberar nada).
+     *
+     * Mientras no se construye, la última pirámide se queda vieja; al volver a
+     * construirla no debe usarse la de antes hasta que llegue una lectura nueva.
+     */
+    void invalidate();
+
+    /** @brief `true` si la pirámide se creó (hay soporte de compute shaders). */
+    bool isEnabled() const { return m_reduceShader != nullptr; }
+
+    /** @brief `true` si ya hay datos leídos en CPU para probar oclusión. */
+    bool hasData() const { return m_hasData; }
+
+    /** @brief Vista de todos los mips (para probar oclusión en un compute shader). */
+    ID3D11ShaderResourceView* getPyramidSRV() const { return m_pyramidSRV; }
+
+    /** @brief `true` si la pirámide ya se construyó al menos una vez. */
+    bool hasPyramid() const { return m_hasPyramid; }
+
+    /** @brief `viewProj` del último @ref build (la de la pirámide en GPU). */
+    const XMMATRIX& getPyramidViewProj() const { return m_pyramidViewProj; }
+
+    /** @brief Número de mips de la pirámide. */
+    unsigned int getMipCount() const { return static_cast<unsigned int>(m_mipWidths.size()); }
+
+    /** @brief Ancho del mip 0 (media resolución del depth buffer). */
+    unsigned int getPyramidWidth() const { return m_mipWidths.empty() ? 0 : m_mipWidths[0]; }
+
+    /** @brief Alto del mip 0. */
+    unsigned int getPyramidHeight() const { return m_mipHeights.empty() ? 0 : m_mipHeights[0]; }
+
+private:
+    /// Constantes de `cbHiZ` en HiZ.fx.
+    struct HiZParams {
+        unsigned int srcSize[2];
+        unsigned int dstSize[2];
+    };
+
+    /// Copia el mip de lectura de la staging del frame anterior (si la GPU ya terminó).
+    void readBack(DeviceContext& deviceContext);
+
+    ID3D11Texture2D* m_pyramid = nullptr;                  ///< Cadena de mips R32_FLOAT.
+    std::vector<ID3D11ShaderResourceView*> m_mipSRVs;      ///< Una SRV por mip.
+    ID3D11ShaderResourceView* m_pyramidSRV = nullptr;     ///< SRV de la cadena completa.
+    XMMATRIX m_pyramidViewProj;                            ///< viewProj del último `build`.
+    bool m_hasPyramid = false;                             ///< Ya se construyó una vez.
+    std::vector<ID3D11UnorderedAccessView*> m_mipUAVs;     ///< Una UAV por mip.
+    std::vector<unsigned int> m_mipWidths;                 ///< Ancho de cada mip.
+    std::vector<unsigned int> m_mipHeights;                ///< Alto de cada mip.
+    ID3D11ComputeShader* m_reduceShader = nullptr;         ///< Kernel CSReduce.
+    ID3D11Buffer* m_params = nullptr;                      ///< Constant buffer `cbHiZ`.
+
+    unsigned int m_readbackMip = 0;                        ///< Mip que se copia a CPU.
+    ID3D11Texture2D* m_staging[2] = { nullptr, nullptr };  ///< Copias staging alternas.
+    XMMATRIX m_stagingViewProj[2];                         ///< viewProj de cada copia.
+    bool m_stagingPending[2] = { false, false };           ///< Copia pendiente de leer.
+    unsigned int m_frame = 0;                              ///< Índice de la staging de este frame.
+
+    std::vector<float> m_cpuDepth;                         ///< Mip leído (ancho*alto).
+    XMMATRIX m_cpuViewProj;                                ///< Matriz con la que se generó.
+    bool m_hasData = false;                                ///< Hay un mip válido en CPU.
+};
@@ -0,0 +1,104 @@
+﻿/**
+ * @file ImageDecoder.h
+ * @brief Decodificación de PNG, JPG, TGA y HDR (stb_image) con detección por contenido.
+ *
+ * @details
+ * Un único punto de entrada para las imágenes que no son DDS:
+ * - El formato se detecta por los primeros bytes (firma PNG, marcador SOI de JPEG,
+ *   cabecera `#?RADIANCE` de HDR, cabecera/pie de TGA), no por la extensión: un
+ *   `.png` que en realidad es un JPEG se carga igual.
+ * - El archivo se lee desde un @ref MappedFile, sin el `fread` a búfer de `stbi_load`.
+ * - La salida se queda en el búfer de stb y es ese búfer el que se sube como mip 0
+ *   (`MipChain::build` con `copyLevel0 = false`): no hay una segunda copia.
+ * - PNG/JPG/TGA salen en RGBA8; HDR en RGBA de 32 bits flotantes.
+ *
+ * Es la única unidad que compila la implementación de stb_image, limitada a esos
+ * cuatro formatos.
+ *
+ * @note Para estudiantes: stb_image guarda el motivo del último error por hilo, así
+ * que se puede decodificar desde varios hilos de carga a la vez.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+
+/**
+ * @enum ImageFormat
+ * @brief Formatos de imagen que reconoce @ref ImageDecoder.
+ */
+enum ImageFormat {
+    IMAGE_FORMAT_UNKNOWN = 0,
+    IMAGE_FORMAT_PNG = 1,
+    IMAGE_FORMAT_JPG = 2,
+    IMAGE_FORMAT_TGA = 3,
+    IMAGE_FORMAT_HDR = 4
+};
+
+/**
+ * @class DecodedImage
+ * @brief Texeles decodificados; libera el búfer de stb al destruirse.
+ */
+class DecodedImage {
+public:
+    DecodedImage() = default;
+    DecodedImage(const DecodedImage&) = delete;
+    DecodedImage& operator=(const DecodedImage&) = delete;
+    ~DecodedImage() { release(); }
+
+    /** @brief Libera los texeles. */
+    void release();
+
+    unsigned int getWidth() const { return m_width; }
+    unsigned int getHeight() const { return m_height; }
+    ImageFormat getFormat() const { return m_format; }
+
+    /** @brief `true` para HDR (texeles `float` RGBA); si no, RGBA8. */
+    bool isHdr() const { return m_format == IMAGE_FORMAT_HDR; }
+
+    /** @brief Bytes por texel: 16 en HDR, 4 en el resto. */
+    unsigned int getBytesPerPixel() const { return isHdr() ? 16 : 4; }
+
+    /** @brief Formato DXGI con el que subir los texeles tal cual. */
+    DXGI_FORMAT getDxgiFormat() const { return isHdr() ? DXGI_FORMAT_R32G32B32A32_FLOAT : DXGI_FORMAT_R8G8B8A8_UNORM; }
+
+    /** @brief Primer texel (filas seguidas, sin relleno). */
+    const unsigned char* getPixels() const { return static_cast<const unsigned char*>(m_pixels); }
+
+private:
+    friend class ImageDecoder;
+
+    void* m_pixels = nullptr;            ///< Búfer de stb (`stbi_image_free`).
+    unsigned int m_width = 0;
+    unsigned int m_height = 0;
+    ImageFormat m_format = IMAGE_FORMAT_UNKNOWN;
+};
+
+/**
+ * @class ImageDecoder
+ * @brief Detección de formato y decodificación desde memoria o archivo.
+ */
+class ImageDecoder {
+public:
+    /**
+     * @brief Reconoce el formato por el contenido.
+     * @return `IMAGE_FORMAT_UNKNOWN` si ninguna firma coincide.
+     */
+    static ImageFormat detect(const unsigned char* bytes, size_t size);
+
+    /**
+     * @brief Decodifica una imagen completa en memoria.
+     * @param bytes Contenido del archivo.
+     * @param size Bytes de `bytes`.
+     * @param out Recibe los texeles (RGBA8 o RGBA float).
+     * @param errorText Si no es nulo, recibe el motivo del fallo.
+     * @return `S_OK`, `E_INVALIDARG` si el formato no se reconoce o `E_FAIL` si stb falla.
+     */
+    static HRESULT decode(const unsigned char* bytes, size_t size, DecodedImage& out,
+        std::string* errorText = nullptr);
+
+    /** @brief Igual que @ref decode, leyendo el archivo mapeado en memoria. */
+    static HRESULT decodeFile(const std::string& path, DecodedImage& out, std::string* errorText = nullptr);
+
+    /** @brief Nombre corto ("PNG", "JPG", ...) para mensajes. */
+    static const char* getFormatName(ImageFormat format);
+};
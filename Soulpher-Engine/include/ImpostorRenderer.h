@@ -0,0 +1,191 @@
+﻿/**
+ * @file ImpostorRenderer.h
+ * @brief Impostores (billboards horneados) para actores lejanos.
+ *
+ * @details
+ * Más allá del último nivel de detalle, un actor a cientos de metros sigue costando sus
+ * draws y sus vértices. Con `Actor::setImpostorDistance` el actor se sustituye, a partir
+ * de esa distancia a la cámara, por un quad:
+ *
+ * 1. **Horneado** (@ref bake): por cada combinación (asset, texturas) se dibuja el LOD 0
+ *    desde @ref kViewCount direcciones horizontales, con cámara ortográfica ajustada a la
+ *    esfera envolvente, en un atlas de `kViewCount x 1` celdas de @ref kTileSize texels
+ *    (con mips). Se hornea la primera vez que algún actor lo necesita, como mucho
+ *    @ref kMaxBakesPerFrame por frame y solo sin texturas pendientes de carga; mientras
+ *    tanto el actor se sigue dibujando con su malla.
+ * 2. **Dibujo** (@ref render): un `DrawIndexedInstanced` por atlas. Cada instancia es
+ *    centro + radio, tinte y el eje X del actor en mundo; el VS (`Impostor.fx`) orienta
+ *    el quad a la cámara alrededor de Y y elige la celda más cercana a la dirección de
+ *    la cámara en el espacio del actor. El PS descarta por alfa, así que el impostor
+ *    escribe profundidad como un opaco más.
+ *
+ * Limitaciones: solo se tiene en cuenta el giro en Y del actor (vale para árboles,
+ * personajes y props apoyados en el suelo) y la iluminación es la del horneado.
+ * Los impostores no proyectan sombra propia: el actor sigue en las colas de sombra.
+ *
+ * @note Para estudiantes: es la misma idea que un LOD más, pero con 2 triángulos fijos;
+ * lo que se paga es memoria de textura (un atlas por malla) y algo de "salto" al cambiar
+ * de celda, que se nota menos cuanto más lejos está el actor.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "ConstantBufferLayout.h"
+#include "Buffer.h"
+#include "ConstantBuffer.h"
+#include "ShaderProgram.h"
+#include "SamplerState.h"
+#include "Rasterizer.h"
+#include "BlendState.h"
+#include <map>
+
+class Device;
+class DeviceContext;
+class Actor;
+class Texture;
+class MeshAsset;
+
+/**
+ * @class ImpostorRenderer
+ * @brief Atlas de impostores por malla y su dibujo instanciado.
+ */
+class ImpostorRenderer {
+public:
+    ImpostorRenderer() = default;
+    ~ImpostorRenderer() { destroy(); }
+
+    /// Direcciones horneadas alrededor del eje Y.
+    static const unsigned int kViewCount = 8;
+    /// Lado de cada celda del atlas (texels).
+    static const unsigned int kTileSize = 128;
+    /// Mips del atlas (la celda más pequeña mide `kTileSize >> (kMipCount - 1)`).
+    static const unsigned int kMipCount = 5;
+    /// Atlas horneados como mucho por frame (cada uno son `kViewCount` pasadas de la malla).
+    static const unsigned int kMaxBakesPerFrame = 2;
+    /// Instancias iniciales del buffer (crece al doble).
+    static const unsigned int kInitialInstances = 1024;
+
+    /**
+     * @brief Crea programas, quad, buffers y estados.
+     * @param device Dispositivo (se guarda para crear atlas).
+     * @param layout Layout de geometría del formato activo (horneado de las mallas).
+     * @return `S_OK` o el error; sin él los actores se dibujan siempre con su malla.
+     */
+    HRESULT init(Device& device, const std::vector<D3D11_INPUT_ELEMENT_DESC>& layout);
+
+    /** @brief Inicio de frame: vacía las instancias. */
+    void begin();
+
+    /**
+     * @brief Sustituye el actor por su impostor si está más lejos que su distancia.
+     * @param actor Actor visible este frame.
+     * @param eye Cámara en mundo.
+     * @return `true` si se dibujará como impostor (no enviarlo a la cola).
+     *
+     * @note Si su atlas aún no existe se encola para hornearlo y devuelve `false`.
+     */
+    bool add(Actor& actor, const XMFLOAT3& eye);
+
+    /**
+     * @brief Hornea atlas pendientes (como mucho @ref kMaxBakesPerFrame).
+     * @param deviceContext Contexto inmediato. Deja enlazados sus propios RT, viewport y
+     * constantes b0-b2: llamar antes de preparar el pase que dibuja.
+     * @param allowed `false` para esperar (p. ej. con texturas aún cargándose).
+     */
+    void bake(DeviceContext& deviceContext, bool allowed);
+
+    /**
+     * @brief Dibuja las instancias del frame.
+     * @param deviceContext Contexto con cámara (b0/b1) enlazada y profundidad por defecto.
+     * @param eye Cámara en mundo.
+     * @note Deja enlazado su programa y su constant buffer en b2.
+     */
+    void render(DeviceContext& deviceContext, const XMFLOAT3& eye);
+
+    /**
+     * @brief Olvida todos los atlas (p. ej. al cambiar de escena); se vuelven a hornear
+     * cuando se necesiten.
+     */
+    void clear();
+
+    /** @brief Libera atlas, buffers y programas. */
+    void destroy();
+
+    /** @brief `true` tras un @ref init correcto. */
+    bool isReady() const { return m_device != nullptr; }
+
+    /** @brief Atlas horneados. */
+    unsigned int getAtlasCount() const;
+
+    /** @brief Actores dibujados como impostor en el último frame. */
+    unsigned int getInstanceCount() const { return m_instanceCount; }
+
+    /** @brief Bytes de GPU de los atlas horneados. */
+    size_t getAtlasBytes() const;
+
+private:
+    /// Instancia tal como la lee `Impostor.fx` (slot 1).
+    struct InstanceData {
+        XMFLOAT4 center;  ///< xyz: centro en mundo; w: radio en mundo.
+        XMFLOAT4 color;
+        XMFLOAT2 axisX;   ///< Eje X del actor en mundo (xz normalizado).
+    };
+
+    /// Constantes de `cbImpostor` (b2).
+    struct CBImpostor {
+        XMFLOAT4 eyePos;
+        XMFLOAT4 atlasInfo;
+    };
+    /// Layout de `cbImpostor` (ver `ConstantBufferLayouts`).
+    static const ConstantBufferLayouts::Registration kImpostorLayout;
+
+    /// Malla + texturas: lo que cambia la imagen horneada.
+    struct Key {
+        const MeshAsset* asset;
+        std::vector<const Texture*> textures;
+        bool operator<(const Key& o) const {
+            if (asset != o.asset) { return asset < o.asset; }
+            return textures < o.textures;
+        }
+    };
+
+    struct Atlas {
+        EU::TSharedPointer<MeshAsset> asset;   ///< Se conserva hasta hornear (y para la clave).
+        std::vector<TextureHandle> textures;
+        XMFLOAT3 center = XMFLOAT3(0.0f, 0.0f, 0.0f); ///< Centro de la esfera (espacio de modelo).
+        float radius = 0.0f;                   ///< Radio de la esfera (espacio de modelo).
+        ID3D11Texture2D* texture = nullptr;
+        ID3D11ShaderResourceView* srv = nullptr;
+        bool baked = false;
+        bool queued = false;
+        std::vector<InstanceData> instances;   ///< Instancias del frame.
+    };
+
+    /// Dibuja las `kViewCount` vistas de un atlas.
+    HRESULT bakeAtlas(DeviceContext& deviceContext, Atlas& atlas);
+
+    /// Libera los recursos de GPU de un atlas.
+    static void releaseAtlas(Atlas& atlas);
+
+    Device* m_device = nullptr;
+    ShaderProgram m_bakeProgram;                        ///< Impostor.fx con `BAKE`.
+    ShaderProgram m_program;                            ///< Impostor.fx (quads instanciados).
+    Buffer m_quadVertices;                              ///< 4 esquinas en [-1,1]^2.
+    Buffer m_quadIndices;                               ///< 2 triángulos.
+    Buffer m_instanceBuffer;                            ///< `InstanceData` del frame (dinámico).
+    unsigned int m_instanceCapacity = 0;
+    TConstantBuffer<CBNeverChanges> m_bakeView;         ///< Vista de cada celda (b0).
+    TConstantBuffer<CBChangeOnResize> m_bakeProjection; ///< Ortográfica de cada atlas (b1).
+    TConstantBuffer<CBChangesEveryFrame> m_bakeObject;  ///< Decodificación de la malla (b2).
+    TConstantBuffer<CBImpostor> m_constants;            ///< Cámara y celdas (b2 al dibujar).
+    ID3D11Texture2D* m_depthTexture = nullptr;          ///< Profundidad de una celda.
+    ID3D11DepthStencilView* m_depthView = nullptr;
+    SamplerState m_sampler;
+    Rasterizer m_rasterizer;
+    BlendState m_blendState;                            ///< Sin mezcla: el PS ya recorta con `clip`.
+
+    std::map<Key, Atlas> m_atlases;
+    std::vector<Atlas*> m_pending;                      ///< Atlas por hornear, en orden de petición.
+    std::vector<InstanceData> m_upload;                 ///< Instancias de todos los atlas, contiguas.
+    unsigned int m_instanceCount = 0;
+};
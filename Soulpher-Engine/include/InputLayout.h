@@ -21,6 +21,8 @@ class DeviceContext;
  * - Si el Input Layout no coincide con la estructura de vrtices usada o con las entradas declaradas en el Vertex Shader, **el render fallar**.
  * - Este es uno de los pasos clave en la configuracin inicial del pipeline grfico.
  * - Cambiar de Input Layout puede ser costoso en rendimiento, as que agrupa el render de objetos con el mismo formato de vrtice.
+ * - `init` pasa por la `InputLayoutCache` del `Device`: los programas con el mismo layout y la
+ *   misma firma de entrada comparten un nico `ID3D11InputLayout`.
  */
 class InputLayout {
 public:
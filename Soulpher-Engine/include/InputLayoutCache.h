@@ -0,0 +1,78 @@
+﻿/**
+ * @file InputLayoutCache.h
+ * @brief Input layouts compartidos por (layout, firma de entrada del VS).
+ *
+ * @details
+ * Cada `ShaderProgram` creaba su propio `ID3D11InputLayout`, aunque varios
+ * programas declaren exactamente las mismas entradas (p. ej. `Soulpher-Engine.fx` y
+ * `ShadowReceiver.fx`, o las variantes con y sin `TEXTURE_ARRAY` de un mismo .fx).
+ *
+ * Un input layout solo depende de dos cosas: los descriptores de elementos y la
+ * **firma de entrada** del vertex shader (el bloque `ISGN` del bytecode), no del
+ * resto del shader. La caché usa como clave el hash de ambas y entrega el mismo
+ * objeto (con `AddRef`) a todos los programas que coincidan; además, como dos
+ * programas con el mismo layout comparten puntero, el cambio entre ellos no
+ * vuelve a enlazar el input layout.
+ *
+ * - Quien recibe un layout lo libera con `SAFE_RELEASE` como siempre.
+ * - La caché conserva su propia referencia hasta `destroy()`.
+ * - Se puede pedir desde varios hilos (un cerrojo cubre búsqueda y creación).
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include <cstdint>
+#include <map>
+#include <mutex>
+
+class Device;
+
+/**
+ * @class InputLayoutCache
+ * @brief Crea cada input layout distinto una sola vez.
+ */
+class InputLayoutCache {
+public:
+    InputLayoutCache() = default;
+    ~InputLayoutCache() = default;
+
+    /**
+     * @brief Devuelve el input layout de `layout` para el VS de `vertexShaderData`.
+     * @param device Dispositivo con el que se crea si no existe.
+     * @param layout Descriptores de elementos.
+     * @param vertexShaderData Bytecode del vertex shader (se usa su firma de entrada).
+     * @param ppInputLayout Recibe el layout (con su propia referencia).
+     * @return HRESULT de `CreateInputLayout`, o `S_OK` si ya estaba en la caché.
+     */
+    HRESULT getInputLayout(Device& device,
+        const std::vector<D3D11_INPUT_ELEMENT_DESC>& layout,
+        ID3DBlob* vertexShaderData,
+        ID3D11InputLayout** ppInputLayout);
+
+    /**
+     * @brief Hash de la firma de entrada de un bytecode DXBC.
+     * @note Si no encuentra el bloque `ISGN`, usa el bytecode completo (la caché
+     * solo pierde aciertos, nunca mezcla layouts).
+     */
+    static uint64_t hashInputSignature(const void* bytecode, size_t size);
+
+    /**
+     * @brief Suelta las referencias de la caché.
+     * @warning Llamar antes de liberar el `ID3D11Device`.
+     */
+    void destroy();
+
+    /** @brief Número de input layouts distintos creados. */
+    unsigned int getLayoutCount() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return static_cast<unsigned int>(m_layouts.size());
+    }
+
+    /** @brief Peticiones servidas sin crear un layout. */
+    unsigned int getHitCount() const { return m_hits; }
+
+private:
+    std::map<uint64_t, ID3D11InputLayout*> m_layouts; ///< Layouts por hash (layout + firma).
+    unsigned int m_hits = 0;                          ///< Aciertos de la caché.
+    mutable std::mutex m_mutex;                       ///< Protege `m_layouts` y `m_hits`.
+};
@@ -0,0 +1,143 @@
+﻿/**
+ * @file InputSystem.h
+ * @brief Ratón y teclado por raw input (`WM_INPUT`), acumulados entre frames y leídos
+ * una vez por frame.
+ *
+ * @details
+ * Preguntar cada frame por `GetAsyncKeyState` y `GetCursorPos` pierde lo que pasó entre
+ * dos frames: un clic más corto que un frame no existe y el movimiento es la diferencia
+ * entre dos posiciones muestreadas, que depende de cuándo cae el muestreo. Aquí:
+ *
+ * 1. `RegisterRawInputDevices` pide `WM_INPUT` de ratón y teclado (sin `RIDEV_NOLEGACY`:
+ *    ImGui y `WndProc` siguen recibiendo `WM_MOUSEMOVE` y `WM_KEYDOWN`).
+ * 2. @ref InputSystem::handleRawInput, desde `WndProc`, suma cada desplazamiento y rueda y
+ *    anota cada botón o tecla como evento con su `GetMessageTime`. Los botones pulsados
+ *    y soltados se guardan como flancos, así que no se pierden aunque pasen en el mismo frame.
+ * 3. @ref InputSystem::sample, una vez por frame justo después de la espera del swap
+ *    chain y de vaciar la cola de mensajes, congela todo en un @ref InputSystem::Frame
+ *    y empieza a acumular el siguiente. El frame lee solo esa copia.
+ *
+ * Sin raw input (p. ej. el registro falla), @ref InputSystem::sample rellena el frame con
+ * el sondeo de antes, como respaldo.
+ *
+ * @note Para estudiantes: los deltas del raw input son los del sensor, sin la aceleración
+ * del puntero de Windows; la sensibilidad ya no depende de la velocidad del gesto.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include <bitset>
+#include <vector>
+
+/**
+ * @class InputSystem
+ * @brief Entrada acumulada entre frames y su copia del frame actual.
+ */
+class InputSystem {
+public:
+    InputSystem() = default;
+    ~InputSystem() { destroy(); }
+    InputSystem(const InputSystem&) = delete;
+    InputSystem& operator=(const InputSystem&) = delete;
+
+    /// Botones de ratón que se siguen.
+    enum MouseButton : uint8_t {
+        MOUSE_LEFT = 0,
+        MOUSE_RIGHT,
+        MOUSE_MIDDLE,
+        MOUSE_BUTTON_COUNT
+    };
+
+    /// Eventos guardados por frame como mucho (los deltas y estados se acumulan igual).
+    static const unsigned int kMaxEvents = 1024;
+
+    /// Un cambio discreto de entrada, en orden de llegada.
+    struct Event {
+        enum Type : uint8_t { BUTTON_DOWN, BUTTON_UP, WHEEL, KEY_DOWN, KEY_UP };
+        Type type = BUTTON_DOWN;
+        uint8_t code = 0;       ///< `MouseButton` o tecla virtual (`VK_*`).
+        float wheel = 0.0f;     ///< Muescas (`WHEEL`).
+        DWORD time = 0;         ///< `GetMessageTime` (ms del reloj de `GetTickCount`).
+    };
+
+    /// Entrada de un frame (lo que pasó desde el @ref sample anterior).
+    struct Frame {
+        long mouseDeltaX = 0;   ///< Desplazamiento acumulado (unidades del sensor).
+        long mouseDeltaY = 0;
+        float wheel = 0.0f;     ///< Muescas de rueda acumuladas (positivo = hacia delante).
+        POINT cursor = {};      ///< Cursor en coordenadas de cliente al muestrear.
+        uint8_t buttons = 0;    ///< Botones pulsados al muestrear (bit = `MouseButton`).
+        uint8_t pressed = 0;    ///< Botones pulsados durante el frame.
+        uint8_t released = 0;   ///< Botones soltados durante el frame.
+        std::bitset<256> keys;         ///< Teclas pulsadas al muestrear.
+        std::bitset<256> keysPressed;  ///< Teclas pulsadas durante el frame.
+        std::vector<Event> events;     ///< Eventos del frame, en orden.
+        unsigned int droppedEvents = 0; ///< Eventos que no cupieron en `events`.
+        DWORD oldestEventAge = 0;      ///< ms entre el evento más antiguo y el muestreo (latencia de entrada).
+    };
+
+    /**
+     * @brief Registra ratón y teclado para que `hwnd` reciba `WM_INPUT`.
+     * @return `S_OK`, o el error de `RegisterRawInputDevices` (se usa el sondeo).
+     */
+    HRESULT init(HWND hwnd);
+
+    /** @brief Procesa un `WM_INPUT` (desde `WndProc`, en el hilo de la ventana). */
+    void handleRawInput(HRAWINPUT input);
+
+    /** @brief Suelta botones y teclas (al perder el foco no llegan sus `WM_INPUT` de subida). */
+    void releaseAll();
+
+    /**
+     * @name Entrada inyectada
+     * Entrada que no llega por `WM_INPUT` (p. ej. la de un cliente de `RemoteStream`):
+     * se acumula igual que el raw input, antes de @ref sample. Las marcas de tiempo son
+     * las de la llamada.
+     */
+    ///@{
+    void injectMouseMove(long deltaX, long deltaY);
+    void injectButton(MouseButton button, bool down);
+    /** @param notches Muescas (positivo = hacia delante). */
+    void injectWheel(float notches);
+    void injectKey(uint8_t key, bool down);
+    ///@}
+
+    /** @brief Cierra lo acumulado en la copia del frame; una vez por frame. */
+    void sample(HWND hwnd);
+
+    /** @brief Entrada del frame (la de @ref sample). */
+    const Frame& getFrame() const { return m_frame; }
+
+    /** @brief El botón está pulsado al muestrear. */
+    bool isDown(MouseButton button) const { return (m_frame.buttons & (1u << button)) != 0; }
+    /** @brief El botón se pulsó durante el frame (aunque ya esté suelto). */
+    bool wasPressed(MouseButton button) const { return (m_frame.pressed & (1u << button)) != 0; }
+    /** @brief La tecla está pulsada al muestrear. */
+    bool isKeyDown(uint8_t key) const { return m_frame.keys.test(key); }
+    /** @brief La tecla se pulsó durante el frame. */
+    bool wasKeyPressed(uint8_t key) const { return m_frame.keysPressed.test(key); }
+
+    /** @brief Deja de recibir `WM_INPUT`. */
+    void destroy();
+
+    /** @brief `true` con raw input registrado (si no, @ref sample sondea). */
+    bool isRawInput() const { return m_registered; }
+
+private:
+    /// Flanco de botón (estado, flanco y evento).
+    void setButton(MouseButton button, bool down, DWORD time);
+    /// Flanco de tecla; las bajadas repetidas no cuentan.
+    void setKey(uint8_t key, bool down, DWORD time);
+    /// Guarda un evento (o lo cuenta como perdido).
+    void pushEvent(Event::Type type, uint8_t code, float wheel, DWORD time);
+    /// Sin raw input: estados de `GetAsyncKeyState` y delta de `GetCursorPos`.
+    void poll();
+
+    Frame m_pending;            ///< Lo acumulado desde el último @ref sample.
+    Frame m_frame;              ///< Copia del frame.
+    POINT m_lastCursor = {};    ///< Sondeo: posición del muestreo anterior.
+    long m_lastAbsoluteX = 0;   ///< Ratones absolutos (escritorio remoto, tabletas).
+    long m_lastAbsoluteY = 0;
+    bool m_hasAbsolute = false;
+    bool m_registered = false;
+};
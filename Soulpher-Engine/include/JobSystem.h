@@ -0,0 +1,185 @@
+﻿/**
+ * @file JobSystem.h
+ * @brief Sistema de trabajos con robo de tareas: un hilo por núcleo para todo el motor.
+ *
+ * @details
+ * Hasta ahora cada sistema que quería hilos creaba los suyos (`std::thread` por llamada)
+ * y el resto del frame iba en un solo núcleo. `JobSystem` mantiene un hilo por núcleo
+ * (el principal cuenta como uno) y reparte **trabajos** pequeños entre ellos:
+ *
+ * - **Trabajo** (@ref Job): función + hasta @ref JobSystem::kJobDataBytes de datos
+ *   copiados. Se reservan de un anillo por hilo, sin `new`.
+ * - **Colas**: cada hilo tiene una cola de dos extremos sin bloqueos (Chase-Lev,
+ *   `EU::TWorkStealingDeque`). El dueño apila y desapila por abajo (lo último que
+ *   encoló, aún en caché); los hilos sin trabajo **roban** por arriba de la cola de otro.
+ * - **Dependencias**: un trabajo hijo (@ref JobSystem::createChild) suma uno al contador
+ *   de su padre; el padre no termina hasta que terminan él y todos sus hijos, así que
+ *   esperar al padre espera al árbol completo.
+ * - **Esperar ayuda**: @ref JobSystem::wait no bloquea el hilo, ejecuta trabajos
+ *   pendientes (de cualquier cola) hasta que el esperado termina.
+ * - @ref JobSystem::parallelFor divide un rango por mitades como trabajos hijos hasta un
+ *   tamaño de lote calculado a partir del rango y del número de hilos.
+ *
+ * Solo el hilo que llamó a @ref JobSystem::init y los propios workers tienen cola. Desde
+ * otro hilo (p. ej. un hilo de carga) `run` ejecuta el trabajo en el acto y
+ * `parallelFor` recorre el rango en serie.
+ *
+ * @note Para estudiantes: un trabajo no debe bloquearse esperando a un mutex o a disco;
+ * ocupa un núcleo del que dependen los demás trabajos del frame.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "EngineUtilities\Threading\TWorkStealingDeque.h"
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+
+struct Job;
+
+/// Función de un trabajo: recibe el trabajo (para crear hijos) y sus datos copiados.
+typedef void (*JobFunction)(Job& job, const void* data);
+
+/**
+ * @struct Job
+ * @brief Unidad de trabajo: 64 bytes alineados, una línea de caché por trabajo.
+ */
+struct alignas(64) Job {
+    JobFunction function = nullptr;
+    Job* parent = nullptr;
+    std::atomic<int> unfinished{ 0 };   ///< Él mismo más los hijos sin terminar.
+    unsigned char data[40];             ///< Copia de los datos de `createJob`.
+};
+
+/**
+ * @class JobSystem
+ * @brief Hilos de trabajo con colas de robo, dependencias padre-hijo y `parallelFor`.
+ */
+class JobSystem {
+public:
+    /// Bytes de datos que caben dentro de un trabajo.
+    static const size_t kJobDataBytes = sizeof(Job::data);
+    /// Trabajos del anillo de cada hilo (potencia de dos); también capacidad de su cola.
+    static const unsigned int kJobsPerThread = 4096;
+    /// Hilos como máximo (principal incluido).
+    static const unsigned int kMaxThreads = 64;
+    /// Lotes por hilo que busca `parallelFor` (más lotes = mejor reparto, más coste fijo).
+    static const unsigned int kBatchesPerThread = 4;
+
+    JobSystem() = default;
+    ~JobSystem() { destroy(); }
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    /** @brief Sistema del proceso (el que usan los sistemas del motor). */
+    static JobSystem& getDefault();
+
+    /**
+     * @brief Arranca los workers; el hilo que llama pasa a ser el hilo 0.
+     * @param workerCount Workers además del hilo actual; 0 = núcleos - 1.
+     * @return `S_OK`, o `E_OUTOFMEMORY` si no se pudieron reservar los anillos.
+     */
+    HRESULT init(unsigned int workerCount = 0);
+
+    /** @brief Para y une los workers (los trabajos encolados deben haber terminado). */
+    void destroy();
+
+    /**
+     * @brief Reserva un trabajo sin padre.
+     * @param function Función a ejecutar.
+     * @param data Datos a copiar dentro del trabajo (puede ser `nullptr`).
+     * @param size Bytes de `data`, como mucho @ref kJobDataBytes.
+     * @return El trabajo, o `nullptr` desde un hilo sin cola o con datos demasiado grandes.
+     *
+     * @note El puntero vale hasta que el mismo hilo reserve `kJobsPerThread` trabajos más.
+     */
+    Job* createJob(JobFunction function, const void* data = nullptr, size_t size = 0) {
+        return allocate(function, nullptr, data, size);
+    }
+
+    /** @brief Como @ref createJob, pero el padre no termina hasta que termine este. */
+    Job* createChild(Job& parent, JobFunction function, const void* data = nullptr, size_t size = 0) {
+        return allocate(function, &parent, data, size);
+    }
+
+    /** @brief Encola el trabajo en la cola del hilo actual (`nullptr` no hace nada). */
+    void run(Job* job);
+
+    /** @brief Ejecuta trabajos hasta que `job` y sus hijos terminen (`nullptr` no espera). */
+    void wait(const Job* job);
+
+    /**
+     * @brief Ejecuta `f(begin, end)` sobre lotes de `[0, count)` en todos los hilos y espera.
+     * @param count Elementos.
+     * @param f Función `void(unsigned int begin, unsigned int end)`; se llama en paralelo
+     * con lotes disjuntos.
+     * @param minBatch Elementos como mínimo por lote (sube si cada elemento es barato).
+     *
+     * @details El lote es `max(minBatch, count / (hilos * kBatchesPerThread))`: con pocos
+     * elementos no se paga el coste de repartir; con muchos, los hilos que acaban antes
+     * roban mitades a los que van más lentos.
+     */
+    template<typename F>
+    void parallelFor(unsigned int count, const F& f, unsigned int minBatch = 1) {
+        struct Invoker {
+            static void call(const void* context, unsigned int begin, unsigned int end) {
+                (*static_cast<const F*>(context))(begin, end);
+            }
+        };
+        parallelFor(count, minBatch, &Invoker::call, &f);
+    }
+
+    /** @brief Hilos que ejecutan trabajos (principal incluido); 1 sin inicializar. */
+    unsigned int getThreadCount() const { return m_threads.empty() ? 1u : static_cast<unsigned int>(m_threads.size()); }
+
+    /** @brief `true` si el hilo actual tiene cola en este sistema. */
+    bool isJobThread() const;
+
+    /** @brief Trabajos robados de la cola de otro hilo desde el arranque. */
+    unsigned long long getStealCount() const { return m_stealCount.load(std::memory_order_relaxed); }
+
+private:
+    typedef void (*RangeFunction)(const void* context, unsigned int begin, unsigned int end);
+
+    /// Cola del hilo: solo el dueño llama a `Push`/`Pop`; cualquier hilo puede llamar a `Steal`.
+    typedef EU::TWorkStealingDeque<Job*, kJobsPerThread> WorkQueue;
+
+    /// Estado de un hilo: su cola y su anillo de trabajos.
+    struct ThreadState {
+        WorkQueue queue;
+        Job* jobs = nullptr;                ///< `kJobsPerThread` trabajos alineados a 64.
+        unsigned int nextJob = 0;
+        std::thread thread;                 ///< Vacío para el hilo 0 (el que llamó a `init`).
+    };
+
+    /// Datos de un trabajo de `parallelFor`.
+    struct RangeData {
+        RangeFunction function;
+        const void* context;
+        unsigned int begin;
+        unsigned int end;
+        unsigned int batch;
+    };
+
+    Job* allocate(JobFunction function, Job* parent, const void* data, size_t size);
+    void parallelFor(unsigned int count, unsigned int minBatch, RangeFunction function, const void* context);
+    static void rangeJob(Job& job, const void* data);
+
+    /// Índice del hilo actual en `m_threads`, o `kMaxThreads` si no tiene cola.
+    unsigned int currentThread() const;
+    /// Trabajo de la cola propia o robado de otra.
+    Job* findJob(unsigned int thread);
+    void execute(Job* job);
+    void finish(Job* job);
+    void workerLoop(unsigned int thread);
+
+    std::vector<std::unique_ptr<ThreadState>> m_threads;
+    std::atomic<bool> m_stopping{ false };
+    std::atomic<int> m_queued{ 0 };         ///< Trabajos en alguna cola (para dormir o no).
+    std::atomic<int> m_sleeping{ 0 };       ///< Workers esperando en `m_wake`.
+    std::mutex m_sleepMutex;
+    std::condition_variable m_wake;
+    std::atomic<unsigned long long> m_stealCount{ 0 };
+};
@@ -0,0 +1,102 @@
+﻿/**
+ * @file LightmapBaker.h
+ * @brief Horneado de la luz de los actores estáticos en atlas de lightmaps BC6H.
+ *
+ * @details
+ * La luz de una escena estática no cambia entre frames, pero el camino de tiempo real
+ * la recalcula en cada píxel (sombra del sol con PCF, luces del cluster) y no tiene luz
+ * indirecta. "Tools > Bake lightmaps" la calcula una vez, con trazado de rayos en CPU:
+ *
+ * 1. **Candidatos**: actores estáticos y opacos cuyo `MeshAsset` trae UV2
+ *    (`MeshAsset::hasLightmapUV`, ver `LightmapUV`). Hornear exige además la copia de CPU
+ *    de los triángulos (opción `-lightmapbake 1`).
+ * 2. **Atlas**: cada actor recibe un rectángulo proporcional a su superficie en mundo
+ *    (@ref Settings::texelsPerUnit), de lado múltiplo de 4 y con 4 texeles de separación:
+ *    ningún bloque BC6H mezcla dos actores. Los rectángulos se colocan por filas en
+ *    páginas de @ref Settings::atlasSize.
+ * 3. **Texeles**: los triángulos se rasterizan en el espacio UV2 del rectángulo; cada
+ *    texel guarda su posición y normal de cara en mundo.
+ * 4. **Trazado** (`JobSystem::parallelFor` por filas, BVH de triángulos del mundo):
+ *    - cielo: `1 - fuerza de sombra` por la fracción de rayos (coseno) que escapan;
+ *      en campo abierto da lo mismo que el término sin sombra del tiempo real;
+ *    - sol: `fuerza de sombra` si el rayo hacia la luz no choca (sombra dura);
+ *    - luces locales con la atenuación de `EvaluateLight` y rayo de sombra;
+ *    - rebotes: en cada choque se suma sol + luces del punto por el albedo.
+ * 5. **Bordes**: los texeles vacíos alrededor de las islas copian la media de sus
+ *    vecinos, para que el filtrado bilineal no lea negro.
+ * 6. **Disco**: cada página se codifica en BC6H (`BlockCompressor::compressHDR`) y se
+ *    escribe como DDS; un índice guarda la huella de la escena y el rectángulo de cada
+ *    actor. @ref load solo lo aplica si la huella coincide.
+ *
+ * @note Para estudiantes: el lightmap guarda irradiancia (luz que llega), no color; el
+ * shader la multiplica por el albedo de la textura, así que las texturas pueden cambiar
+ * sin volver a hornear. Mover un actor, en cambio, invalida el horneado entero.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "ClusteredLighting.h"
+#include "ECS/ActorPool.h"
+
+class Device;
+
+/**
+ * @class LightmapBaker
+ * @brief Hornea, guarda y carga los lightmaps de la escena (es dueño de las páginas).
+ */
+class LightmapBaker {
+public:
+    LightmapBaker() = default;
+    ~LightmapBaker() { destroy(); }
+    LightmapBaker(const LightmapBaker&) = delete;
+    LightmapBaker& operator=(const LightmapBaker&) = delete;
+
+    /// Cambia cuando cambia el formato del índice.
+    static const unsigned int kFormatVersion = 1;
+
+    /// Calidad y tamaño del horneado.
+    struct Settings {
+        float texelsPerUnit = 8.0f;      ///< Densidad: texeles por unidad de mundo.
+        unsigned int minRectSize = 8;    ///< Lado mínimo del rectángulo de un actor (múltiplo de 4).
+        unsigned int maxRectSize = 256;  ///< Lado máximo (múltiplo de 4, menor que `atlasSize`).
+        unsigned int atlasSize = 1024;   ///< Lado de cada página.
+        unsigned int samples = 64;       ///< Rayos de cielo y rebote por texel.
+        unsigned int bounces = 1;        ///< Rebotes de la luz indirecta (0 = solo directa y cielo).
+        float albedo = 0.5f;             ///< Reflectancia de las superficies en los rebotes.
+    };
+
+    /// Luz de la escena en el momento del horneado.
+    struct Lighting {
+        XMFLOAT3 sunDirection = XMFLOAT3(0.0f, 1.0f, 0.0f); ///< Hacia el sol (normalizada).
+        float shadowStrength = 0.6f;     ///< Como `ShadowMap::setStrength`.
+        std::vector<ClusteredLighting::Light> lights; ///< Luces locales.
+    };
+
+    /**
+     * @brief Hornea los candidatos de `actors`, escribe los archivos y aplica el resultado.
+     * @param basePath Ruta sin extensión: `<basePath>.slmap` y `<basePath>_<página>.dds`.
+     * @return `S_OK`; `S_FALSE` sin candidatos; `E_FAIL` si algún candidato no tiene
+     * copia de CPU o no se puede escribir.
+     * @warning Bloquea el hilo que llama hasta terminar (reparte el trazado en el `JobSystem`).
+     */
+    HRESULT bake(Device& device, const std::vector<ActorHandle>& actors, const Lighting& lighting,
+        const std::string& basePath, const Settings& settings);
+
+    /**
+     * @brief Carga un horneado previo y lo asigna a los actores.
+     * @return `S_OK`; `E_FAIL` si no existe; `E_ABORT` si la escena cambió desde el horneado.
+     */
+    HRESULT load(Device& device, const std::vector<ActorHandle>& actors, const std::string& basePath);
+
+    /** @brief Quita el lightmap de los actores y libera las páginas. */
+    void clear(const std::vector<ActorHandle>& actors);
+
+    /** @brief Libera las páginas (los actores que las usen deben haberse limpiado). */
+    void destroy();
+
+    /** @brief Páginas cargadas. */
+    unsigned int getPageCount() const { return static_cast<unsigned int>(m_pages.size()); }
+
+private:
+    std::vector<ID3D11ShaderResourceView*> m_pages; ///< Una por página del atlas.
+};
@@ -0,0 +1,51 @@
+﻿/**
+ * @file LightmapUV.h
+ * @brief Generación del segundo juego de UV (UV2) para los lightmaps.
+ *
+ * @details
+ * Las UV de las texturas se repiten (el suelo usa 0..6) y se solapan (dos caras con la
+ * misma parte de la textura); un lightmap necesita lo contrario: cada punto del modelo
+ * con su propio texel. Al importar, las submallas estáticas del LOD 0 reciben
+ * `m_lightmapUV`, todas en el mismo cuadrado 0..1 (el actor ocupa un solo rectángulo del
+ * atlas):
+ *
+ * 1. **Charts**: los triángulos vecinos (vértices soldados por posición) cuya normal
+ *    mira al mismo eje dominante (+-X, +-Y, +-Z) forman una isla.
+ * 2. **Proyección**: cada isla se proyecta en el plano de su eje, en unidades de
+ *    modelo; así la densidad de texeles es la misma en toda la malla.
+ * 3. **Empaquetado**: las islas de todas las submallas, de mayor a menor alto, se colocan por filas en el
+ *    cuadrado 0..1 con la mayor escala que cabe, separadas @ref LightmapUV::kPadding
+ *    texeles de un lightmap de @ref LightmapUV::kReferenceSize.
+ * 4. **Costuras**: un vértice que comparten dos islas se duplica (misma posición y UV,
+ *    otra UV2); los índices se renumeran en el mismo orden, así los meshlets siguen
+ *    valiendo.
+ *
+ * @note Para estudiantes: el margen entre islas evita que el filtrado bilineal mezcle
+ * la luz de dos caras que no se tocan. Si el actor recibe en el atlas menos texeles que
+ * la referencia, el margen real es menor; lo compensa el relleno de bordes del baker.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "MeshComponent.h"
+
+/**
+ * @class LightmapUV
+ * @brief Islas, proyección y empaquetado de las UV2 de una malla.
+ */
+class LightmapUV {
+public:
+    /// Lado del lightmap con el que se calcula el margen entre islas.
+    static const unsigned int kReferenceSize = 128;
+    /// Texeles de margen entre islas (y hasta el borde) a @ref kReferenceSize.
+    static const unsigned int kPadding = 2;
+
+    /**
+     * @brief Rellena `m_lightmapUV` de cada submalla (y duplica los vértices de las costuras).
+     * @param meshes Submallas de un modelo. Las que tienen skinning o blend shapes, no tienen triángulos o
+     * tienen índices inválidos se quedan con `m_lightmapUV` vacío: se iluminan siempre en
+     * tiempo real.
+     * @return `false` si ninguna submalla recibió UV2.
+     */
+    static bool generate(std::vector<MeshComponent>& meshes);
+};
@@ -0,0 +1,301 @@
+﻿/**
+ * @file Logger.h
+ * @brief Log asíncrono: registros de tamaño fijo en anillos por hilo y salida en un hilo aparte.
+ *
+ * @details
+ * `ERROR` y `MESSAGE` montaban un `std::wostringstream` (con su memoria y su locale) y
+ * llamaban a `OutputDebugStringW` en el acto. Con el depurador enganchado cada llamada
+ * es un viaje al depurador, y los errores que se repiten cada frame (un contexto nulo,
+ * un shader sin compilar) hundían el frame. Ahora:
+ *
+ * 1. **En el hilo que registra**: @ref LogStream escribe el texto en un @ref LogRecord
+ *    de tamaño fijo en la pila (nivel, marca de tiempo, hilo, texto UTF-8 truncado), sin
+ *    reservar memoria, y lo empuja al anillo de su hilo (`EU::TSpscQueue`). Nada de
+ *    locks ni de llamadas al sistema.
+ * 2. **En el hilo del log**: cada @ref Logger::kFlushIntervalMs (o en cuanto llega un
+ *    error) vacía todos los anillos, ordena por marca de tiempo y reparte cada línea
+ *    a las salidas: depurador, archivo (`-log`), la ventana "Output" de la UI y las que
+ *    se añadan con @ref Logger::addSink.
+ *
+ * - Un anillo lleno no bloquea: el registro se descarta y se cuenta; el hilo del log
+ *   escribe cuántos se perdieron.
+ * - Los anillos (`EU::TPerThreadRings`, como los del `EventBus`) se reutilizan: cuando
+ *   un hilo termina, su anillo pasa al siguiente hilo nuevo una vez vaciado.
+ * - El log se crea con el primer registro. Después de destruirlo (destructores
+ *   estáticos), los registros van directos al depurador, como antes.
+ *
+ * **Niveles**: `LOG_TRACE` < `LOG_DEBUG` < `LOG_INFO` (`MESSAGE`) < `LOG_WARNING` <
+ * `LOG_ERROR` (`ERROR`). Por debajo de `LOG_MIN_LEVEL` la llamada desaparece al
+ * compilar, argumentos incluidos (`if constexpr`); por defecto todo en Debug y desde
+ * `LOG_LEVEL_WARNING` en Release. Lo que queda compilado pasa además por un filtro en
+ * ejecución: un nivel global y uno por categoría (la clase de `MESSAGE`/`ERROR`),
+ * @ref Logger::setLevel y @ref Logger::setCategoryLevel (`-loglevel`, `-logfilter`).
+ *
+ * @note Para estudiantes: el texto se sigue formateando en el hilo que registra (las
+ * macros aceptan cualquier cadena `<<`), pero en un buffer fijo y sin `locale`; lo caro
+ * (depurador, disco, UI) ya no está en el frame.
+ */
+
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "EngineUtilities\Threading\TPerThreadRings.h"
+
+/// Gravedad de un registro.
+enum LogLevel : uint8_t {
+    LOG_LEVEL_TRACE = 0,
+    LOG_LEVEL_DEBUG = 1,
+    LOG_LEVEL_INFO = 2,
+    LOG_LEVEL_WARNING = 3,
+    LOG_LEVEL_ERROR = 4,
+    LOG_LEVEL_COUNT
+};
+
+/// Nivel mínimo compilado; se puede fijar en el proyecto (`LOG_MIN_LEVEL=LOG_LEVEL_ERROR`).
+#ifndef LOG_MIN_LEVEL
+#if defined(_DEBUG)
+#define LOG_MIN_LEVEL LOG_LEVEL_TRACE
+#else
+#define LOG_MIN_LEVEL LOG_LEVEL_WARNING
+#endif
+#endif
+
+/**
+ * @brief Registra `text` (una expresión `<<`) con nivel y categoría.
+ * @note Por debajo de `LOG_MIN_LEVEL` no se genera código ni se evalúa `text`; por
+ * encima, `text` solo se evalúa si el filtro de ejecución lo deja pasar.
+ */
+#define LOG(level, category, text) \
+do { if constexpr ((level) >= LOG_MIN_LEVEL) { if (Logger::isEnabled((level), (category))) { \
+    LogStream os_((level), (category)); os_ << text; } } } while (0)
+
+#define LOG_TRACE(category, text) LOG(LOG_LEVEL_TRACE, category, text)
+#define LOG_DEBUG(category, text) LOG(LOG_LEVEL_DEBUG, category, text)
+#define LOG_INFO(category, text) LOG(LOG_LEVEL_INFO, category, text)
+#define LOG_WARNING(category, text) LOG(LOG_LEVEL_WARNING, category, text)
+#define LOG_ERROR(category, text) LOG(LOG_LEVEL_ERROR, category, text)
+
+/**
+ * @struct LogRecord
+ * @brief Registro binario de tamaño fijo (256 bytes) que viaja por los anillos.
+ */
+struct LogRecord {
+    static const unsigned int kTextBytes = 232;
+    uint64_t timestamp;      ///< `QueryPerformanceCounter`.
+    const char* category;    ///< Literal de la llamada (vive todo el programa).
+    uint32_t threadId;
+    uint8_t level;           ///< @ref LogLevel.
+    uint8_t truncated;       ///< El texto no cupo entero.
+    uint16_t length;         ///< Bytes usados de `text` (sin terminador).
+    char text[kTextBytes];   ///< UTF-8.
+};
+
+/**
+ * @class LogStream
+ * @brief Formatea un registro con `<<` en un buffer fijo y lo envía al destruirse.
+ *
+ * Acepta cadenas estrechas y anchas (`const char*`, `const wchar_t*`, `std::string`,
+ * `std::wstring`), caracteres, enteros, enums, coma flotante y punteros.
+ */
+class LogStream {
+public:
+    LogStream(uint8_t level, const char* category);
+    ~LogStream();
+    LogStream(const LogStream&) = delete;
+    LogStream& operator=(const LogStream&) = delete;
+
+    LogStream& operator<<(const char* text);
+    LogStream& operator<<(const wchar_t* text);
+    LogStream& operator<<(const std::string& text) { append(text.data(), text.size()); return *this; }
+    LogStream& operator<<(const std::wstring& text) { appendWide(text.data(), text.size()); return *this; }
+    LogStream& operator<<(char c) { append(&c, 1); return *this; }
+    LogStream& operator<<(wchar_t c) { appendWide(&c, 1); return *this; }
+    LogStream& operator<<(double value);
+    LogStream& operator<<(const void* pointer);
+
+    template<typename T>
+    typename std::enable_if<std::is_integral<T>::value, LogStream&>::type operator<<(T value) {
+        if (std::is_signed<T>::value) {
+            appendSigned(static_cast<long long>(value));
+        }
+        else {
+            appendUnsigned(static_cast<unsigned long long>(value));
+        }
+        return *this;
+    }
+
+    template<typename T>
+    typename std::enable_if<std::is_enum<T>::value, LogStream&>::type operator<<(T value) {
+        return *this << static_cast<typename std::underlying_type<T>::type>(value);
+    }
+
+private:
+    void append(const char* text, size_t length);
+    void appendWide(const wchar_t* text, size_t length);
+    void appendSigned(long long value);
+    void appendUnsigned(unsigned long long value);
+
+    LogRecord m_record;
+};
+
+/**
+ * @class Logger
+ * @brief Anillos por hilo, hilo de salida y salidas registradas.
+ */
+class Logger {
+public:
+    /// Registros por anillo (uno por hilo que registra): 64 KB.
+    static const unsigned int kRingRecords = 256;
+    /// Anillos como mucho (hilos que registran a la vez); los demás pierden sus registros.
+    static const unsigned int kMaxRings = 128;
+    /// Cada cuánto vacía los anillos el hilo del log si no llega ningún error.
+    static constexpr unsigned int kFlushIntervalMs = 10;
+    /// Líneas que guarda para la ventana "Output".
+    static const unsigned int kRecentLines = 512;
+
+    /**
+     * @brief Salida de registros; se llama en el hilo del log, en orden de marca de tiempo.
+     * @param record Registro.
+     * @param line Texto terminado en nulo (sin salto de línea).
+     * @param user Dato de @ref addSink.
+     */
+    typedef void (*Sink)(const LogRecord& record, const char* line, void* user);
+
+    Logger();
+    ~Logger();
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    /// Categorías con nivel propio como mucho.
+    static const unsigned int kMaxCategories = 32;
+    /// Longitud máxima del nombre de una categoría con nivel propio.
+    static const unsigned int kCategoryBytes = 48;
+
+    /** @brief Log del motor (se crea en el primer uso, con su hilo). */
+    static Logger& getDefault();
+
+    /**
+     * @brief Pasa el filtro de ejecución (nivel de la categoría si tiene, si no el global).
+     * @note Sin categorías configuradas es una carga atómica y una comparación.
+     */
+    static bool isEnabled(uint8_t level, const char* category) {
+        if (s_categoryCount.load(std::memory_order_acquire) == 0) {
+            return level >= s_level.load(std::memory_order_relaxed);
+        }
+        return level >= categoryLevel(category);
+    }
+
+    /** @brief Nivel mínimo global en ejecución (por encima de `LOG_MIN_LEVEL`). */
+    static void setLevel(uint8_t level) { s_level.store(level, std::memory_order_relaxed); }
+    static uint8_t getLevel() { return s_level.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Nivel propio de una categoría (la clase que pasa `MESSAGE`/`ERROR`).
+     * @return `false` si ya hay @ref kMaxCategories o el nombre es demasiado largo.
+     */
+    static bool setCategoryLevel(const char* category, uint8_t level);
+
+    /**
+     * @brief Lee un nivel por nombre: `trace`, `debug`, `info`, `warn`/`warning` o `error`.
+     * @return `false` si no es ninguno.
+     */
+    static bool parseLevel(const char* name, uint8_t& outLevel);
+
+    /** @brief Nombre corto de un nivel (`"info"`...). */
+    static const char* getLevelName(uint8_t level);
+
+    /**
+     * @brief Encola un registro en el anillo del hilo actual (sin bloqueos).
+     * @note Tras destruir el log va directo al depurador.
+     */
+    static void submit(const LogRecord& record);
+
+    /** @brief Vacía los anillos ahora y espera a que todas las salidas lo hayan escrito. */
+    void flush();
+
+    /**
+     * @brief Copia además todas las líneas a un archivo (sustituye al anterior).
+     * @return `false` si no se pudo abrir.
+     */
+    bool openFile(const std::string& path);
+
+    /** @brief Añade una salida. */
+    void addSink(Sink sink, void* user);
+
+    /** @brief Quita una salida añadida con los mismos `sink` y `user`. */
+    void removeSink(Sink sink, void* user);
+
+    /**
+     * @brief Recorre las últimas @ref kRecentLines líneas, de la más antigua a la más nueva.
+     * @param f Llamada como `f(uint8_t level, const std::string& line)`, con el log bloqueado.
+     */
+    template<typename F>
+    void forEachRecent(F&& f) const {
+        std::lock_guard<std::mutex> lock(m_recentMutex);
+        const size_t count = m_recent.size();
+        for (size_t i = 0; i < count; ++i) {
+            const Recent& entry = m_recent[(m_recentFirst + i) % count];
+            f(entry.level, entry.line);
+        }
+    }
+
+    /** @brief Cambia cada vez que llega una línea nueva a @ref forEachRecent. */
+    uint64_t getRecentVersion() const { return m_recentVersion.load(std::memory_order_relaxed); }
+
+    /** @brief Registros perdidos por anillos llenos desde el arranque. */
+    unsigned long long getDroppedCount() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    /** @brief Segundos desde la creación del log para la marca de tiempo de un registro. */
+    double toSeconds(uint64_t timestamp) const;
+
+private:
+    /// Nivel de una categoría; el global si no tiene uno propio.
+    static uint8_t categoryLevel(const char* category);
+
+    static inline std::atomic<uint8_t> s_level{ LOG_MIN_LEVEL };
+    static inline std::atomic<unsigned int> s_categoryCount{ 0 };
+
+    /// Línea guardada para la UI.
+    struct Recent {
+        uint8_t level = LOG_LEVEL_INFO;
+        std::string line;
+    };
+
+    void run();
+    /// Vacía los anillos y escribe en las salidas. Solo con `m_drainMutex`.
+    void drain();
+    void write(const LogRecord& record);
+
+    EU::TPerThreadRings<LogRecord, kRingRecords, kMaxRings> m_rings; ///< Uno por hilo que registra (reutilizables).
+    std::vector<LogRecord> m_pending;        ///< Registros de un vaciado (reutilizado).
+    std::mutex m_drainMutex;                 ///< Un solo vaciado a la vez (hilo del log o `flush`).
+    std::thread m_thread;
+    std::atomic<bool> m_stopping{ false };
+    std::atomic<bool> m_urgent{ false };     ///< Llegó un error: vaciar sin esperar al intervalo.
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wake;
+    std::atomic<unsigned long long> m_dropped{ 0 };
+    unsigned long long m_reportedDrops = 0;
+
+    struct SinkEntry {
+        Sink sink;
+        void* user;
+    };
+    std::vector<SinkEntry> m_sinks;          ///< Con `m_drainMutex`.
+    FILE* m_file = nullptr;                  ///< Con `m_drainMutex`.
+
+    mutable std::mutex m_recentMutex;
+    std::vector<Recent> m_recent;            ///< Anillo de `kRecentLines`.
+    size_t m_recentFirst = 0;
+    std::atomic<uint64_t> m_recentVersion{ 0 };
+
+    uint64_t m_start = 0;                    ///< Marca de tiempo de la creación.
+    double m_secondsPerTick = 0.0;
+};
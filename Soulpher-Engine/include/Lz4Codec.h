@@ -0,0 +1,49 @@
+﻿/**
+ * @file Lz4Codec.h
+ * @brief Compresión y descompresión en formato de bloque LZ4.
+ *
+ * @details
+ * Un bloque LZ4 es una serie de secuencias: un token (longitud de literales y de la
+ * coincidencia en 4 bits cada una, con bytes extra de 255 si no caben), los literales,
+ * y el desplazamiento de 16 bits hacia atrás de la coincidencia. Descomprimir es copiar
+ * memoria, por eso se usa en los paquetes: leer menos del disco cuesta casi nada de CPU.
+ *
+ * Dos niveles de compresión con el mismo formato (y el mismo descompresor):
+ *
+ * - **Rápido**: una sola posición candidata por hash, como el LZ4 por defecto.
+ * - **Alto**: cadenas de hash sobre la ventana de 64 KB y se queda con la coincidencia
+ *   más larga (la idea de LZ4HC). Comprime más despacio y descomprime igual de rápido.
+ *
+ * @note Para estudiantes: el descompresor comprueba cada longitud contra los dos búferes;
+ * un paquete corrupto da error, nunca una escritura fuera de rango.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+
+/**
+ * @class Lz4Codec
+ * @brief Funciones de bloque LZ4 sobre memoria.
+ */
+class Lz4Codec {
+public:
+    /**
+     * @brief Comprime un bloque.
+     * @param source Datos de entrada.
+     * @param sourceSize Bytes de entrada.
+     * @param destination Búfer de salida.
+     * @param capacity Bytes disponibles en `destination`.
+     * @param high Nivel alto (cadenas de hash) en lugar del rápido.
+     * @return Bytes escritos, o 0 si no cabe en `capacity` (datos incompresibles).
+     */
+    static size_t compress(const unsigned char* source, size_t sourceSize,
+        unsigned char* destination, size_t capacity, bool high);
+
+    /**
+     * @brief Descomprime un bloque entero.
+     * @param destinationSize Bytes que debe producir exactamente.
+     * @return `false` si el bloque está corrupto o no produce `destinationSize` bytes.
+     */
+    static bool decompress(const unsigned char* source, size_t sourceSize,
+        unsigned char* destination, size_t destinationSize);
+};
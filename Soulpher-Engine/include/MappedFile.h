@@ -0,0 +1,72 @@
+﻿/**
+ * @file MappedFile.h
+ * @brief Archivo de solo lectura mapeado en memoria (`MapViewOfFile`).
+ *
+ * @details
+ * Los lectores (@ref DdsFile, @ref ImageDecoder) leen directamente de la vista: el
+ * sistema trae las páginas del disco según se tocan y no hay un `fread` a un búfer
+ * propio. La vista se cierra en el destructor. Los cargadores la reciben a través del
+ * @ref VirtualFileSystem, que para un archivo suelto usa esta misma clase.
+ *
+ * @note Para estudiantes: el puntero de @ref getData solo es válido mientras viva el
+ * objeto; lo que se quiera conservar (p. ej. los texeles ya subidos a la GPU) tiene
+ * que estar copiado o usado antes.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+
+/**
+ * @class MappedFile
+ * @brief Vista de solo lectura de un archivo completo.
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() { close(); }
+
+    /**
+     * @brief Abre y mapea el archivo.
+     * @return `false` si no existe, está vacío o no se puede mapear.
+     */
+    bool open(const std::string& path) {
+        close();
+        m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        LARGE_INTEGER fileSize;
+        if (m_file == INVALID_HANDLE_VALUE || !GetFileSizeEx(m_file, &fileSize) || fileSize.QuadPart == 0) {
+            close();
+            return false;
+        }
+        m_size = static_cast<size_t>(fileSize.QuadPart);
+        m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        m_view = m_mapping ? static_cast<const unsigned char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+        if (!m_view) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    /** @brief Desmapea y cierra (se llama también desde el destructor). */
+    void close() {
+        if (m_view) UnmapViewOfFile(m_view);
+        if (m_mapping) CloseHandle(m_mapping);
+        if (m_file != INVALID_HANDLE_VALUE) CloseHandle(m_file);
+        m_view = nullptr;
+        m_mapping = nullptr;
+        m_file = INVALID_HANDLE_VALUE;
+        m_size = 0;
+    }
+
+    const unsigned char* getData() const { return m_view; }
+    size_t getSize() const { return m_size; }
+
+private:
+    HANDLE m_file = INVALID_HANDLE_VALUE;
+    HANDLE m_mapping = nullptr;
+    const unsigned char* m_view = nullptr;
+    size_t m_size = 0;
+};
@@ -0,0 +1,242 @@
+﻿/**
+ * @file Material.h
+ * @brief Materiales compartidos con identificador compacto y constantes inmutables.
+ *
+ * @details
+ * Un material reúne lo que decide cómo se sombrea una submalla: la permutación de
+ * shader, la textura difusa, los estados (blend, rasterizer, sampler) y sus constantes
+ * (`CBMaterial`, slot b4). Antes todo eso vivía suelto en cada `Actor` (un vector de
+ * texturas por submalla y un juego de estados propio), y la `RenderQueue` solo podía
+ * agrupar por un hash de 16 bits del puntero de la textura.
+ *
+ * @ref MaterialLibrary crea cada material **una vez por descripción** y le da un
+ * identificador de 16 bits (1..65535) que va tal cual en la clave de orden de la cola:
+ * los draws del mismo material quedan seguidos sin colisiones de hash, y entre ellos
+ * solo se enlaza lo que cambia.
+ *
+ * - Las constantes se suben una sola vez a un buffer **inmutable**; los materiales con
+ *   los mismos valores (p. ej. mismo color y distinta textura) comparten el buffer, así
+ *   la cola puede seguir fusionándolos en un lote con array de texturas.
+ * - Los estados son de la biblioteca: todos los materiales con la misma configuración
+ *   comparten el objeto, y la cola compara punteros.
+ * - El modo de mezcla (@ref MaterialBlendMode) decide la capa: solo los `MATERIAL_BLENDED`
+ *   activan el blending; opacos y alpha test escriben el color tal cual.
+ *
+ * @note Para estudiantes: es el mismo *flyweight* que `Prefab` o `MeshLibrary`; un
+ * material es barato de compartir y caro de duplicar.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "Buffer.h"
+#include "Texture.h"
+#include "BlendState.h"
+#include "Rasterizer.h"
+#include "SamplerState.h"
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+
+class Device;
+class ShaderProgram;
+
+/**
+ * @enum MaterialBlendMode
+ * @brief Cómo se combina el material con lo ya dibujado (y en qué capa de la cola va).
+ */
+enum MaterialBlendMode {
+    MATERIAL_OPAQUE = 0,       ///< Capa opaca, sin mezcla, adelante -> atrás y en el pre-pase de Z.
+    MATERIAL_ALPHA_TESTED = 1, ///< Capa de alpha test: sin mezcla, descarta bajo `alphaCutoff`.
+    MATERIAL_BLENDED = 2       ///< Capa transparente: alfa no premultiplicado, atrás -> adelante.
+};
+
+/**
+ * @struct MaterialDesc
+ * @brief Lo que define un material; dos descripciones iguales dan el mismo material.
+ */
+struct MaterialDesc {
+    TextureHandle diffuse;             ///< Textura difusa (t0); nula = sin textura.
+    XMFLOAT4 diffuseColor = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f); ///< Multiplica la textura (`CBMaterial`).
+    ShaderProgram* shader = nullptr;   ///< Permutación propia; nula = la de la cola (receptor, lote, array).
+    MaterialBlendMode blendMode = MATERIAL_OPAQUE; ///< Capa y estado de mezcla.
+    float alphaCutoff = 0.5f;          ///< Umbral de `MATERIAL_ALPHA_TESTED` (`CBMaterial::vMaterialParams.x`).
+    float roughness = 0.5f;            ///< Rugosidad [0, 1] que se guarda en el G-buffer (`vMaterialParams.y`).
+    bool twoSided = false;             ///< Sin culling de caras traseras.
+};
+
+/**
+ * @class Material
+ * @brief Material inmutable creado por @ref MaterialLibrary.
+ */
+class Material {
+public:
+    /// Identificador compacto (clave de orden de la cola).
+    typedef uint16_t ID;
+    /// Ningún material (`DrawPacket` sin material).
+    static const ID kNoMaterial = 0;
+
+    /** @brief Identificador en su biblioteca (estable mientras viva el material). */
+    ID getID() const { return m_id; }
+
+    /** @brief Descripción con la que se creó. */
+    const MaterialDesc& getDesc() const { return m_desc; }
+
+    /** @brief Textura difusa (nula si no tiene). */
+    Texture* getTexture() const { return m_desc.diffuse.get(); }
+
+    /** @brief Programa propio (nulo = el que elija la cola). */
+    ShaderProgram* getShader() const { return m_desc.shader; }
+
+    /** @brief Constantes (b4), compartidas con los materiales de los mismos valores. */
+    Buffer* getConstants() const { return m_constants.get(); }
+
+    BlendState* getBlendState() const { return m_blendState; }
+    Rasterizer* getRasterizer() const { return m_rasterizer; }
+    SamplerState* getSampler() const { return m_sampler; }
+
+    /** @brief Modo de mezcla. */
+    MaterialBlendMode getBlendMode() const { return m_desc.blendMode; }
+
+    /** @brief Se dibuja en la capa transparente (con blending). */
+    bool isTransparent() const { return m_desc.blendMode == MATERIAL_BLENDED; }
+
+    /**
+     * @brief Descarta píxeles por alfa.
+     * @note Necesita un `shader` con `ALPHA_TEST`; sin él se dibuja como opaco en su capa.
+     */
+    bool isAlphaTested() const { return m_desc.blendMode == MATERIAL_ALPHA_TESTED; }
+
+    /**
+     * @brief Usa el programa y los estados por defecto (ni shader propio, ni
+     * mezcla, ni alpha test, ni dos caras): lo pueden dibujar caminos con pipeline
+     * fijo como `GpuCulling`.
+     */
+    bool usesDefaultPipeline() const {
+        return !m_desc.shader && m_desc.blendMode == MATERIAL_OPAQUE && !m_desc.twoSided;
+    }
+
+private:
+    friend class MaterialLibrary;
+
+    MaterialDesc m_desc;
+    ID m_id = kNoMaterial;
+    EU::TSharedPointer<Buffer> m_constants;
+    BlendState* m_blendState = nullptr;
+    Rasterizer* m_rasterizer = nullptr;
+    SamplerState* m_sampler = nullptr;
+};
+
+/// Material compartido (se libera con el último usuario).
+typedef EU::TSharedPointer<Material> MaterialHandle;
+
+/**
+ * @class MaterialLibrary
+ * @brief Crea cada material una vez por descripción y le asigna su identificador.
+ */
+class MaterialLibrary {
+public:
+    /// Materiales vivos como máximo (los identificadores son de 16 bits y 0 está reservado).
+    static const unsigned int kMaxMaterials = 0xFFFF;
+
+    MaterialLibrary() = default;
+    ~MaterialLibrary() = default;
+
+    /**
+     * @brief Crea los estados compartidos y el material por defecto (blanco, sin textura).
+     * @return `S_OK` o el primer error.
+     */
+    HRESULT init(Device& device);
+
+    /**
+     * @brief Devuelve el material de `desc`, creándolo si es la primera vez.
+     * @return Nulo si la biblioteca no está lista, se agotaron los identificadores o
+     * falló el buffer de constantes.
+     */
+    MaterialHandle get(const MaterialDesc& desc);
+
+    /**
+     * @brief Material de los draws sin material propio.
+     * @note La cola y `GpuCulling` lo enlazan para que b4 nunca quede con las constantes
+     * del último material dibujado.
+     */
+    const Material* getDefault() const { return m_default.get(); }
+
+    /**
+     * @brief Libera los identificadores y buffers de los materiales que ya no usa nadie.
+     * @return Materiales olvidados.
+     */
+    unsigned int releaseUnused();
+
+    /** @brief Libera estados, buffers y la tabla (al cerrar, después de los actores). */
+    void destroy();
+
+    /** @brief Materiales registrados (los liberados cuentan hasta @ref releaseUnused). */
+    unsigned int getMaterialCount() const { return static_cast<unsigned int>(m_lookup.size()); }
+
+    /** @brief Buffers de constantes distintos. */
+    unsigned int getConstantBufferCount() const { return static_cast<unsigned int>(m_constants.size()); }
+
+private:
+    /// Campos de `MaterialDesc` que lo identifican.
+    struct Key {
+        const Texture* texture;
+        XMFLOAT4 color;
+        const ShaderProgram* shader;
+        MaterialBlendMode blendMode;
+        float alphaCutoff;
+        float roughness;
+        bool twoSided;
+        bool operator==(const Key& o) const {
+            return texture == o.texture && shader == o.shader && blendMode == o.blendMode &&
+                alphaCutoff == o.alphaCutoff && roughness == o.roughness && twoSided == o.twoSided &&
+                memcmp(&color, &o.color, sizeof(color)) == 0;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& k) const {
+            size_t h = std::hash<const void*>()(k.texture);
+            h ^= std::hash<const void*>()(k.shader) + 0x9e3779b9 + (h << 6) + (h >> 2);
+            const float* color = &k.color.x;
+            for (int i = 0; i < 4; ++i) {
+                h ^= std::hash<float>()(color[i]) + 0x9e3779b9 + (h << 6) + (h >> 2);
+            }
+            h ^= std::hash<float>()(k.alphaCutoff) + 0x9e3779b9 + (h << 6) + (h >> 2);
+            h ^= std::hash<float>()(k.roughness) + 0x9e3779b9 + (h << 6) + (h >> 2);
+            return h ^ (static_cast<size_t>(k.blendMode) * 0x5bd1e995u) ^ (k.twoSided ? 0x27d4eb2du : 0u);
+        }
+    };
+
+    /// Buffer de constantes que comparten los materiales con los mismos valores.
+    struct Constants {
+        CBMaterial values;
+        EU::TWeakPointer<Buffer> buffer;
+    };
+
+    /// Borrador de los buffers de constantes: libera la GPU antes del `delete`.
+    struct ReleaseBuffer {
+        void operator()(Buffer* buffer) const {
+            buffer->destroy();
+            delete buffer;
+        }
+    };
+
+    static Key makeKey(const MaterialDesc& desc);
+
+    /// Buffer inmutable con `values` (reutiliza uno vivo con los mismos bytes).
+    EU::TSharedPointer<Buffer> constantsFor(const CBMaterial& values);
+
+    Device* m_device = nullptr;
+    BlendState m_opaqueBlend;              ///< Sin mezcla (opacos y alpha test).
+    BlendState m_alphaBlend;               ///< Alpha no premultiplicado (`MATERIAL_BLENDED`).
+    Rasterizer m_rasterizer;               ///< Culling de caras traseras.
+    Rasterizer m_twoSidedRasterizer;       ///< Sin culling.
+    SamplerState m_sampler;                ///< Lineal, repetición.
+    MaterialHandle m_default;              ///< Ver @ref getDefault.
+
+    std::vector<EU::TWeakPointer<Material>> m_materials; ///< Por identificador (el 0 no se usa).
+    std::vector<Key> m_keys;                             ///< Clave de cada identificador.
+    std::vector<Material::ID> m_freeIDs;                 ///< Identificadores liberados.
+    std::unordered_map<Key, Material::ID, KeyHash> m_lookup;
+    std::vector<Constants> m_constants;
+};
@@ -0,0 +1,120 @@
+﻿/**
+ * @file MemoryTracker.h
+ * @brief Recuento de reservas del montón por frame y por subsistema (builds con `PROFILE`).
+ *
+ * @details
+ * Con `PROFILE` definido, `MemoryTracker.cpp` sustituye el `operator new`/`delete`
+ * global: cada reserva lleva delante una cabecera de 16 bytes (tamaño y etiqueta) y
+ * suma en contadores atómicos de su etiqueta. Así se ve cuánto reserva cada parte del
+ * motor en un frame y se puede perseguir un frame sin reservas.
+ *
+ * - `MEMORY_SCOPE(MEMORY_TAG_RENDER)` etiqueta las reservas del hilo actual hasta el
+ *   final del bloque (las etiquetas se anidan; un trabajo del `JobSystem` en otro hilo
+ *   no hereda la del que lo lanzó y necesita su propio `MEMORY_SCOPE`).
+ * - `MEMORY_NO_ALLOC_SCOPE()` marca un bloque que no debe reservar: cada reserva dentro
+ *   cuenta como infracción y, si se activó @ref MemoryTracker::setBreakOnViolation y hay
+ *   un depurador, lo detiene en la propia reserva (la pila dice quién fue).
+ * - `MEMORY_FRAME()`, junto a `PROFILE_FRAME()`, cierra el frame: los contadores pasan a
+ *   @ref MemoryTracker::getFrameStats y vuelven a cero.
+ *
+ * Sin `PROFILE` no hay sustitución y las macros no generan código.
+ *
+ * @note Para estudiantes: solo se ve lo que pasa por `new` (contenedores de la STL,
+ * `MakeShared`...). `_aligned_malloc`, `malloc` (ImGui) y la memoria del driver van por
+ * otro lado; los arenas y pools del motor cuentan una vez, al reservar su página.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "CpuProfiler.h"
+
+/**
+ * @enum MemoryTag
+ * @brief Subsistema al que se cargan las reservas del hilo actual.
+ */
+enum MemoryTag {
+    MEMORY_TAG_UNTAGGED = 0,    ///< Fuera de cualquier `MEMORY_SCOPE`.
+    MEMORY_TAG_RENDER,          ///< Render del frame (cola, culling, sombras).
+    MEMORY_TAG_ECS,             ///< Simulación de actores y transforms.
+    MEMORY_TAG_LOADER,          ///< Hilos de carga de texturas y mallas.
+    MEMORY_TAG_UI,              ///< Paneles de ImGui.
+    MEMORY_TAG_COUNT
+};
+
+/**
+ * @class MemoryTracker
+ * @brief Contadores globales de reservas; el estado vive en el .cpp con inicialización
+ * estática, porque `new` puede llamarse antes de `main`.
+ */
+class MemoryTracker {
+public:
+    /// Reservas de una etiqueta.
+    struct TagStats {
+        unsigned long long allocations = 0; ///< Llamadas a `new` en el frame.
+        unsigned long long bytes = 0;       ///< Bytes pedidos en el frame.
+        long long liveBytes = 0;            ///< Bytes vivos ahora (todas las reservas aún sin liberar).
+    };
+
+    /**
+     * @brief Etiqueta RAII del hilo actual; usar con `MEMORY_SCOPE`.
+     */
+    class TagScope {
+    public:
+        explicit TagScope(MemoryTag tag);
+        ~TagScope();
+        TagScope(const TagScope&) = delete;
+        TagScope& operator=(const TagScope&) = delete;
+
+    private:
+        MemoryTag m_previous;
+    };
+
+    /**
+     * @brief Bloque sin reservas del hilo actual; usar con `MEMORY_NO_ALLOC_SCOPE`.
+     */
+    class NoAllocScope {
+    public:
+        NoAllocScope();
+        ~NoAllocScope();
+        NoAllocScope(const NoAllocScope&) = delete;
+        NoAllocScope& operator=(const NoAllocScope&) = delete;
+    };
+
+    /** @brief Cierra el frame (hilo principal): guarda sus contadores y los pone a cero. */
+    static void beginFrame();
+
+    /** @brief Contadores de `tag` en el último frame cerrado. */
+    static TagStats getFrameStats(MemoryTag tag);
+
+    /** @brief Reservas de todas las etiquetas en el último frame cerrado. */
+    static unsigned long long getFrameAllocations();
+
+    /** @brief Mayor número de reservas en un frame desde el arranque. */
+    static unsigned long long getPeakFrameAllocations();
+
+    /** @brief Reservas hechas dentro de un `MEMORY_NO_ALLOC_SCOPE` desde el arranque. */
+    static unsigned long long getViolationCount();
+
+    /** @brief Detener el depurador (si hay uno) en cada reserva dentro de un bloque sin reservas. */
+    static void setBreakOnViolation(bool enabled);
+    static bool getBreakOnViolation();
+
+    /** @brief Nombre de la etiqueta para el panel. */
+    static const char* getTagName(MemoryTag tag);
+
+    /** @brief `true` si este build sustituye `new`/`delete` (compilado con `PROFILE`). */
+    static bool isEnabled();
+};
+
+#if defined(PROFILE)
+/// Carga a `tag` las reservas del hilo actual hasta el final del bloque.
+#define MEMORY_SCOPE(tag) MemoryTracker::TagScope PROFILE_CONCAT(memoryScope_, __LINE__)(tag)
+/// Marca el bloque actual como libre de reservas (las que haya cuentan como infracción).
+#define MEMORY_NO_ALLOC_SCOPE() MemoryTracker::NoAllocScope PROFILE_CONCAT(noAllocScope_, __LINE__)
+/// Cierra el frame de memoria (hilo principal, junto a `PROFILE_FRAME`).
+#define MEMORY_FRAME() MemoryTracker::beginFrame()
+#else
+#define MEMORY_SCOPE(tag) ((void)0)
+#define MEMORY_NO_ALLOC_SCOPE() ((void)0)
+#define MEMORY_FRAME() ((void)0)
+#endif
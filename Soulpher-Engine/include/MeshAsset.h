@@ -0,0 +1,272 @@
+﻿/**
+ * @file MeshAsset.h
+ * @brief Geometría de GPU compartible entre varios actores.
+ *
+ * @details
+ * Un `MeshAsset` agrupa las submallas (`MeshComponent`) de un modelo junto con
+ * sus Vertex/Index Buffers. Las submallas no tienen buffers propios: se concatenan
+ * en **páginas** (un VB, un IB y un stream de posiciones compartidos) y cada una
+ * guarda su rango (`SubmeshRange`: primer índice, número de índices y vértice base).
+ * Dibujar varias submallas seguidas no vuelve a enlazar nada; la `RenderQueue`
+ * filtra los binds repetidos. Con un @ref GeometryPool (lo que usa `MeshLibrary`)
+ * el asset no tiene páginas: es un bloque de los buffers de toda la escena y sus
+ * rangos se suman al desplazamiento actual del bloque (@ref MeshAsset::getDraw).
+ * Varios `Actor` pueden referenciar el mismo asset
+ * mediante `EU::TSharedPointer`, de modo que 500 copias de un prop comparten
+ * **un solo** par de buffers en memoria de vídeo. La `RenderQueue` usa la
+ * identidad de estos buffers para agrupar los draws en llamadas instanciadas.
+ *
+ * Niveles de detalle (LOD): el asset puede llevar versiones simplificadas de sí
+ * mismo (`addLOD`), cada una con el tamaño en pantalla por debajo del cual se usa.
+ * Cada LOD es otro `MeshAsset` con sus propios buffers, así los actores que
+ * comparten asset y nivel se siguen agrupando en una llamada instanciada.
+ *
+ * Los vertex buffers se codifican con el formato activo (@ref setVertexFormat); con
+ * posiciones cuantizadas, el asset guarda la AABB usada (@ref getDecodeMatrix) y sus
+ * LOD la heredan, para que todos los niveles se dibujen con la misma matriz de mundo.
+ *
+ * Mallas con skinning (@ref initSkinned): cada actor animado tiene su propio asset, cuyo
+ * VB y stream de posiciones reescribe `SkinningSystem` con la pose del frame. Los pases
+ * (principal, pre-pase y sombras) los leen como los de cualquier malla estática.
+ *
+ * Copias de CPU: los vértices e índices solo hacen falta para crear los buffers. Con
+ * `keepCpuData = false` (lo que usa @ref MeshLibrary) el asset los suelta tras la
+ * subida y en `m_meshes` quedan solo nombre, recuentos, volúmenes y meshlets.
+ *
+ * UV2 de lightmap: si alguna submalla las trae, cada página lleva un tercer stream
+ * (slot 3, `VERTEX_STREAM_LIGHTMAP`) alineado con el de vértices; las submallas sin UV2
+ * ocupan ceros.
+ *
+ * @note Para estudiantes:
+ * - Compartir geometría es el primer paso para el *instancing*: misma malla,
+ *   distinta matriz de mundo por instancia.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "Buffer.h"
+#include "MeshComponent.h"
+#include "VertexFormat.h"
+#include "GeometryPool.h"
+
+class Device;
+class DeviceContext;
+
+/**
+ * @struct SubmeshRange
+ * @brief Dónde está una submalla dentro de las páginas de su asset.
+ */
+struct SubmeshRange {
+    unsigned int page = 0;        ///< Índice en `MeshAsset::m_pages`.
+    unsigned int startIndex = 0;  ///< `StartIndexLocation` del draw.
+    unsigned int indexCount = 0;  ///< Índices de la submalla.
+    int baseVertex = 0;           ///< `BaseVertexLocation` (los índices son relativos a la submalla).
+    unsigned int vertexCount = 0; ///< Vértices de la submalla.
+};
+
+/**
+ * @struct GeometryPage
+ * @brief Buffers compartidos por varias submallas consecutivas.
+ */
+struct GeometryPage {
+    Buffer vertices;  ///< Stream completo (slot 0).
+    Buffer indices;   ///< Índices de 16 bits si cabe cada submalla, si no de 32.
+    Buffer positions; ///< Solo posiciones, para pases de profundidad.
+    Buffer lightmapUVs; ///< UV2 en R16G16_UNORM (slot 3); vacío si ninguna submalla tiene.
+};
+
+/**
+ * @struct SubmeshDraw
+ * @brief Buffers y desplazamientos con los que se dibuja una submalla.
+ */
+struct SubmeshDraw {
+    Buffer* vertices = nullptr;   ///< VB (slot 0).
+    Buffer* indices = nullptr;    ///< IB (su formato, en `getIndexFormat`).
+    Buffer* positions = nullptr;  ///< Stream de posiciones.
+    Buffer* lightmapUVs = nullptr; ///< Stream de UV2 (`nullptr` si el asset no tiene).
+    unsigned int startIndex = 0;
+    unsigned int indexCount = 0;
+    int baseVertex = 0;
+};
+
+/**
+ * @class MeshAsset
+ * @brief Submallas de un modelo y sus buffers de GPU.
+ */
+class MeshAsset {
+public:
+    /// Tamaño máximo del VB o IB de una página (mínimo que D3D11 garantiza por recurso).
+    static const unsigned int kMaxPageBytes = 128u << 20;
+
+    MeshAsset() = default;
+    ~MeshAsset() = default;
+
+    /**
+     * @brief Copia las submallas y las sube concatenadas en páginas de VB/IB compartidos.
+     * @param device Dispositivo para crear los buffers.
+     * @param meshes Submallas del modelo.
+     * @param keepCpuData `false` = descartar vértices e índices de CPU tras subirlos
+     * (también en los LOD que se añadan después).
+     * @param pool Pool de la escena donde subir la geometría (también la de los LOD).
+     * Si no cabe, alguna submalla pasa de 65 535 vértices o el formato de vértice no
+     * coincide, se usan páginas propias.
+     * @return `S_OK` si todos los buffers se crearon; el primer error en caso contrario.
+     */
+    HRESULT init(Device& device, const std::vector<MeshComponent>& meshes, bool keepCpuData = true,
+        GeometryPool* pool = nullptr);
+
+    /**
+     * @brief Como @ref init, pero con buffers que reescribe `SkinningSystem` (un asset por actor).
+     * @param device Dispositivo para crear los buffers.
+     * @param meshes Submallas en la pose de enlace (con `m_skin`).
+     *
+     * @details Sin pool, sin meshlets (sus conos y esferas son de la pose de enlace) y
+     * con CPU data (`SkinningSystem` la necesita y la suelta después). La AABB del asset,
+     * que es también la de cuantización, se amplía en @ref kSkinnedBoundsMargin veces
+     * la mayor semiextensión (más el mayor delta de sus blend shapes) por cada lado: las
+     * poses que se salgan se recortan en `POSITION_SNORM16` y el culling puede
+     * descartarlas antes de tiempo. El
+     * desplazamiento del personaje debe ir en su `Transform`, no en el hueso raíz.
+     */
+    HRESULT initSkinned(Device& device, const std::vector<MeshComponent>& meshes);
+
+    /// Margen de la AABB de una malla con skinning (fracción de su mayor semiextensión).
+    static const float kSkinnedBoundsMargin;
+
+    /** @brief `true` si sus vértices los escribe `SkinningSystem`. */
+    bool isSkinned() const { return m_skinned; }
+
+    /** @brief Sin lógica por frame (geometría estática). */
+    void update() {}
+
+    /**
+     * @brief Enlaza el VB (slot 0) y el IB de la página de una submalla.
+     * @note Dibujar después con el rango de @ref m_submeshes.
+     * @param deviceContext Contexto del dispositivo.
+     * @param submesh Índice de la submalla.
+     */
+    void render(DeviceContext& deviceContext, unsigned int submesh);
+
+    /**
+     * @brief Buffers y rango de una submalla para este frame.
+     * @note Con pool, el bloque puede moverse entre frames: no guardar el resultado.
+     */
+    SubmeshDraw getDraw(unsigned int submesh);
+
+    /** @brief `true` si la geometría vive en un @ref GeometryPool. */
+    bool isPooled() const { return m_allocation != GeometryPool::kNullHandle; }
+
+    /** @brief Libera los buffers de todas las submallas (y de sus LOD). */
+    void destroy();
+
+    /**
+     * @brief Añade un nivel de detalle más simple que el último.
+     * @param device Dispositivo para crear los buffers.
+     * @param meshes Submallas del nivel (mismo orden que las del nivel 0).
+     * @param screenSize Tamaño en pantalla (diámetro / alto de pantalla) por debajo del cual se usa.
+     * @return `S_OK` o el error de creación de buffers.
+     */
+    HRESULT addLOD(Device& device, const std::vector<MeshComponent>& meshes, float screenSize);
+
+    /** @brief Niveles disponibles (el nivel 0 es este mismo asset). */
+    unsigned int getLODCount() const { return 1 + static_cast<unsigned int>(m_lods.size()); }
+
+    /**
+     * @brief Geometría de un nivel.
+     * @param level Nivel pedido; se acota al último disponible.
+     */
+    MeshAsset& getLOD(unsigned int level);
+
+    /**
+     * @brief Elige el nivel para un tamaño en pantalla, con histéresis.
+     * @param screenSize Diámetro proyectado de la esfera envolvente / alto de pantalla.
+     * @param currentLevel Nivel usado en el frame anterior.
+     * @return Nivel a usar este frame.
+     *
+     * @note Para cambiar de nivel hay que cruzar el umbral por más de
+     * @ref kLODHysteresis; así un objeto justo en el límite no alterna cada frame.
+     */
+    unsigned int selectLOD(float screenSize, unsigned int currentLevel) const;
+
+    /// Margen relativo alrededor de cada umbral de LOD.
+    static const float kLODHysteresis;
+
+    /** @brief `true` si alguna submalla tiene volumen envolvente. */
+    bool hasBounds() const { return m_hasBounds; }
+
+    /**
+     * @brief Mayor extensión de las UV (máx - mín en U o V) de todas las submallas.
+     * @note Con UV de 0 a 1 vale 1; una textura repetida 4 veces da 4. El streaming de
+     * texturas la usa para estimar cuántos texeles caben en el tamaño en pantalla.
+     */
+    float getUVSpan() const { return m_uvSpan; }
+
+    /**
+     * @brief `true` si alguna submalla trae UV2 de lightmap (`MeshComponent::m_lightmapUV`).
+     * @note Esos assets no entran en el pool: el pool no tiene stream de UV2.
+     */
+    bool hasLightmapUV() const { return m_hasLightmapUV; }
+
+    /**
+     * @brief Formato de los vertex buffers de los assets que se creen a partir de ahora.
+     * @note Debe coincidir con el input layout de los programas (`VertexFormat::getInputLayout`).
+     */
+    static void setVertexFormat(const VertexFormat& format) { s_vertexFormat = format; }
+
+    /** @brief Formato activo de los vertex buffers. */
+    static const VertexFormat& getVertexFormat() { return s_vertexFormat; }
+
+    /**
+     * @brief Matriz de espacio cuantizado a espacio de modelo (identidad sin cuantizar).
+     * @note Se antepone a la matriz de mundo del actor (ver `Actor::update`).
+     */
+    XMMATRIX getDecodeMatrix() const { return s_vertexFormat.getDecodeMatrix(m_decode); }
+
+    /** @brief `true` si `m_meshes` conserva vértices e índices de CPU. */
+    bool hasCpuData() const { return m_keepCpuData; }
+
+    /** @brief Descarta vértices e índices de CPU de todas las submallas (y de sus LOD). */
+    void releaseCpuData();
+
+    /** @brief Bytes de vértices e índices de CPU que aún guarda (con sus LOD). */
+    size_t getCpuBytes() const;
+
+    /** @brief Número de submallas con buffers válidos. */
+    unsigned int getSubmeshCount() const { return static_cast<unsigned int>(m_submeshes.size()); }
+
+    /**
+     * @brief Nombre con el que se puede volver a pedir (ruta del modelo o clave de
+     * `MeshLibrary`); vacío si es procedural y no está registrado.
+     * @note Es lo que guarda `SceneFile` como referencia de la malla.
+     */
+    void setSourceName(const std::string& name) { m_sourceName = name; }
+    const std::string& getSourceName() const { return m_sourceName; }
+
+public:
+    std::vector<MeshComponent> m_meshes;   ///< Datos de CPU de cada submalla.
+    std::vector<SubmeshRange> m_submeshes; ///< Rango de cada submalla (alineado con `m_meshes`); con pool, relativo al bloque.
+    std::vector<GeometryPage> m_pages;     ///< Buffers de GPU; casi siempre uno solo (ninguno con pool).
+    XMFLOAT3 m_boundsMin = XMFLOAT3(0.0f, 0.0f, 0.0f); ///< AABB local de todo el asset (mínimo).
+    XMFLOAT3 m_boundsMax = XMFLOAT3(0.0f, 0.0f, 0.0f); ///< AABB local de todo el asset (máximo).
+
+private:
+    /// Crea los buffers de una página con los datos acumulados y los vacía.
+    HRESULT addPage(Device& device, std::vector<unsigned char>& vertices,
+        std::vector<unsigned char>& positions, std::vector<unsigned int>& indices,
+        std::vector<uint32_t>& lightmapUVs, bool narrow);
+
+    bool m_hasBounds = false;              ///< La AABB del asset es válida.
+    float m_uvSpan = 1.0f;                 ///< Ver @ref getUVSpan.
+    bool m_hasLightmapUV = false;          ///< Ver @ref hasLightmapUV.
+    std::vector<EU::TSharedPointer<MeshAsset>> m_lods; ///< Niveles 1..N.
+    std::vector<float> m_lodScreenSizes;   ///< Umbral de entrada de cada nivel de `m_lods`.
+    VertexFormat::PositionDecode m_decode; ///< AABB de cuantización de las posiciones.
+    bool m_hasDecode = false;              ///< `m_decode` viene del nivel 0 (LOD): no recalcular.
+    bool m_keepCpuData = true;             ///< Ver @ref hasCpuData.
+    bool m_skinned = false;                ///< Ver @ref initSkinned.
+    std::string m_sourceName;              ///< Ver @ref getSourceName.
+    GeometryPool* m_pool = nullptr;        ///< Pool de la escena (también para los LOD).
+    GeometryPool::Handle m_allocation = GeometryPool::kNullHandle; ///< Bloque en `m_pool`.
+
+    static VertexFormat s_vertexFormat;    ///< Ver @ref setVertexFormat.
+};
@@ -0,0 +1,143 @@
+﻿/**
+ * @file MeshCache.h
+ * @brief Caché binaria de modelos importados (`.smesh`) para no pasar por el FBX SDK en cada arranque.
+ *
+ * @details
+ * La primera vez que se importa `hero.fbx`, @ref ModelLoader::LoadCachedFBXModel
+ * guarda al lado `hero.fbx.smesh` con todo lo que produjo la importación: submallas
+ * (nombre, rangos de vértices e índices, AABB, esfera, meshlets y UV2 del lightmap), niveles de detalle con su
+ * tamaño en pantalla y la tabla de texturas de los materiales. Las cargas siguientes
+ * mapean el archivo (@ref MappedFile) y rellenan los `MeshComponent` directamente
+ * desde la vista: sin parseo ni simplificación, solo la decodificación de los streams
+ * (@ref MeshCodec, una submalla por trabajo del `JobSystem`).
+ *
+ * Disposición (todo little-endian, secciones alineadas a 16 bytes):
+ *
+ * | Sección     | Contenido                                              |
+ * |-------------|--------------------------------------------------------|
+ * | `Header`    | firma `SMSH`, versión, clave, recuentos y desplazamientos |
+ * | niveles     | `LevelEntry[levelCount]` (el 0 son las mallas originales) |
+ * | submallas   | `SubmeshEntry[submeshCount]` (de todos los niveles, en orden) |
+ * | materiales  | `StringEntry[materialCount]` (nombres de textura)      |
+ * | cadenas     | nombres sin terminador, referenciados por desplazamiento |
+ * | vértices    | un bloque de `MeshCodec` por submalla (`SimpleVertex`) |
+ * | índices     | un bloque de `MeshCodec` por submalla, relativos a ella |
+ * | meshlets    | `Meshlet[meshletCount]`, rangos relativos a cada submalla |
+ * | UV2         | un bloque de `MeshCodec` (`XMFLOAT2`) por submalla que las tiene |
+ *
+ * **Clave**: hash FNV-1a de 64 bits del archivo original mezclado con la versión del
+ * importador y los parámetros de LOD (@ref makeKey). Si el FBX cambia (aunque conserve
+ * la fecha), si cambia el importador o si se piden otros LODs, la caché no vale y se
+ * vuelve a importar.
+ *
+ * @note Para estudiantes: la caché guarda el *resultado* de la importación, no el
+ * formato de origen; por eso, si se cambia `SimpleVertex` o el procesado del FBX,
+ * hay que subir @ref ModelLoader::kImporterVersion (o @ref MeshCache::kFormatVersion).
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "MeshComponent.h"
+#include <memory>
+
+/**
+ * @class MeshCache
+ * @brief Lectura y escritura de archivos `.smesh`.
+ */
+class MeshCache {
+public:
+    /// Cambia cuando cambia la disposición del archivo.
+    static const unsigned int kFormatVersion = 4;
+
+    /// Lo que se guarda de un modelo importado.
+    struct Model {
+        std::string name;                              ///< `ModelLoader::modelName`.
+        std::vector<MeshComponent> meshes;             ///< Nivel 0.
+        std::vector<std::vector<MeshComponent>> lods;  ///< Niveles 1..N.
+        std::vector<float> lodScreenSizes;             ///< Uno por nivel de `lods`.
+        std::vector<std::string> textureFileNames;     ///< Tabla de materiales.
+    };
+
+    /** @brief Ruta de la caché de un modelo (`<origen>.smesh`). */
+    static std::string getCachePath(const std::string& sourcePath) { return sourcePath + ".smesh"; }
+
+    /**
+     * @brief Calcula la clave de caché de un archivo de origen.
+     * @param sourcePath Modelo original (se lee entero, mapeado).
+     * @param importerVersion Versión del código que lo importa.
+     * @param lodLevels Niveles de LOD pedidos.
+     * @param lodRatio Fracción de triángulos por nivel.
+     * @param key Recibe la clave.
+     * @return `false` si el archivo no se puede abrir.
+     */
+    static bool makeKey(const std::string& sourcePath, unsigned int importerVersion,
+        unsigned int lodLevels, float lodRatio, unsigned long long& key);
+
+    /**
+     * @brief Clave guardada en una caché, sin compararla con nada.
+     * @details Para un `.smesh` empaquetado sin su original: el cocinado ya la calculó
+     * con los parámetros del runtime.
+     * @return `false` si no existe o no es un `.smesh` de esta versión.
+     */
+    static bool readKey(const std::string& path, unsigned long long& key);
+
+    /**
+     * @brief Lee una caché si existe y su clave coincide.
+     * @param path Archivo `.smesh`.
+     * @param key Clave esperada (@ref makeKey).
+     * @param model Recibe el modelo; no se toca si la caché no vale.
+     * @return `S_OK`; `E_FAIL` si no existe, `E_ABORT` si la clave no coincide
+     * (caché obsoleta) o `E_INVALIDARG` si el archivo está truncado o no es un `.smesh`.
+     */
+    static HRESULT load(const std::string& path, unsigned long long key, Model& model);
+
+    /**
+     * @brief Escribe la caché (a un temporal que luego se renombra, como @ref DdsFile::write).
+     * @return `S_OK`, `E_INVALIDARG` si faltan tamaños de LOD o `E_FAIL` si no se puede escribir.
+     */
+    static HRESULT write(const std::string& path, unsigned long long key, const Model& model);
+
+    /**
+     * @class Writer
+     * @brief Escritura incremental de un `.smesh`, submalla a submalla.
+     *
+     * @details
+     * Los vértices e índices de cada `addMesh` se codifican y van a dos archivos
+     * auxiliares en el momento; en memoria solo quedan las tablas (una entrada por submalla). `finish`
+     * escribe cabecera y tablas y copia los auxiliares por bloques, así que la memoria
+     * usada no depende del tamaño del modelo (ver @ref MeshStreamer).
+     */
+    class Writer {
+    public:
+        Writer();
+        ~Writer();
+        Writer(const Writer&) = delete;
+        Writer& operator=(const Writer&) = delete;
+
+        /**
+         * @brief Empieza un archivo; el nivel 0 queda abierto.
+         * @return `E_FAIL` si no se pueden crear los archivos auxiliares.
+         */
+        HRESULT begin(const std::string& path, unsigned long long key, const std::string& name,
+            const std::vector<std::string>& textureFileNames);
+
+        /** @brief Cierra el nivel actual y empieza el siguiente LOD. */
+        void beginLevel(float screenSize);
+
+        /** @brief Añade una submalla al nivel actual (calcula su AABB si no la tiene). */
+        HRESULT addMesh(const MeshComponent& mesh);
+
+        /** @brief Escribe el archivo final y lo renombra sobre `path`. */
+        HRESULT finish();
+
+        /** @brief Descarta lo escrito (también desde el destructor si no se llamó a `finish`). */
+        void abort();
+
+        /** @brief Submallas añadidas hasta ahora. */
+        size_t getMeshCount() const;
+
+    private:
+        struct State;
+        std::unique_ptr<State> m_state;
+    };
+};
@@ -0,0 +1,71 @@
+﻿/**
+ * @file MeshCodec.h
+ * @brief Codificación sin pérdidas de índices y vértices para la caché `.smesh`.
+ *
+ * @details
+ * LZ4 sobre un `SimpleVertex[]` o un `uint32[]` en crudo apenas gana nada: los bytes
+ * que se repiten no están juntos. Este códec prepara cada stream para que lo estén
+ * (en la línea de los códecs de meshoptimizer) y después pasa LZ4 de nivel alto:
+ *
+ * - **Índices**: un byte de código por triángulo y, aparte, enteros de longitud
+ *   variable. Se simulan dos FIFO de @ref MeshCodec::kFifoSize entradas: aristas
+ *   recientes (en el sentido en que las recorre el vecino) y vértices recientes. Un
+ *   triángulo que comparte arista con uno reciente se codifica como índice de la FIFO,
+ *   giro (0-2) y un tercer vértice; cada vértice es "el siguiente nuevo" (0), una entrada
+ *   de la FIFO de vértices (1-16) o un salto respecto al último explícito en zigzag.
+ *   Con el orden que deja `MeshOptimizer` (caché de vértices y lectura en orden de
+ *   primer uso) casi todo son aristas compartidas y vértices nuevos: unos 2 bytes por
+ *   triángulo en lugar de 12.
+ * - **Vértices** (y cualquier stream de canales de 32 bits, como las UV2): cada canal
+ *   se guarda como diferencia entera con el vértice anterior en zigzag, y los bytes se
+ *   transponen en planos (todos los bytes 0 del canal, luego los 1...). Los vértices
+ *   vecinos se parecen, así que los planos altos son casi todo ceros y LZ4 los aplasta.
+ *
+ * Decodificar es LZ4, una suma prefija y una FIFO: se hace por submalla en los hilos
+ * del `JobSystem` (ver `MeshCache::load`). El resultado es idéntico bit a bit al
+ * original, también el orden de los triángulos (los meshlets apuntan a rangos).
+ *
+ * @note Para estudiantes: el primer byte de cada bloque dice cómo se guardó (crudo,
+ * codificado o codificado + LZ4): si codificar no compensa, se guarda tal cual.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+
+/**
+ * @class MeshCodec
+ * @brief Funciones de codificación de streams de malla sobre memoria.
+ */
+class MeshCodec {
+public:
+    /// Entradas de las FIFO de aristas y vértices del códec de índices.
+    static const unsigned int kFifoSize = 16;
+
+    /**
+     * @brief Codifica un stream de vértices.
+     * @param vertices `count` elementos de `stride` bytes (múltiplo de 4 para codificar;
+     * si no, se guardan en crudo).
+     * @param out Recibe el bloque (se reemplaza su contenido).
+     */
+    static void encodeVertices(const void* vertices, size_t count, size_t stride, std::vector<unsigned char>& out);
+
+    /**
+     * @brief Decodifica un bloque de @ref encodeVertices.
+     * @param vertices Destino de `count * stride` bytes.
+     * @return `false` si el bloque está corrupto o no es de ese tamaño.
+     */
+    static bool decodeVertices(const unsigned char* data, size_t size, void* vertices, size_t count, size_t stride);
+
+    /**
+     * @brief Codifica una lista de índices (de triángulos si `count` es múltiplo de 3;
+     * si no, en crudo).
+     * @param out Recibe el bloque (se reemplaza su contenido).
+     */
+    static void encodeIndices(const unsigned int* indices, size_t count, std::vector<unsigned char>& out);
+
+    /**
+     * @brief Decodifica un bloque de @ref encodeIndices.
+     * @return `false` si el bloque está corrupto o no produce `count` índices.
+     */
+    static bool decodeIndices(const unsigned char* data, size_t size, unsigned int* indices, size_t count);
+};
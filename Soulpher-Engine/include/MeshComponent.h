@@ -1,6 +1,9 @@
 #pragma once
 #include "Prerequisites.h"
+#include "Name.h"
 #include "ECS\Component.h"
+#include "Meshlet.h"
+#include "EngineUtilities\Utilities\BatchMath.h"
 
 class DeviceContext;
 
@@ -14,6 +17,9 @@ class DeviceContext;
  * - Lista de vrtices (`m_vertex`).
  * - Lista de ndices (`m_index`).
  * - Cantidad de vrtices e ndices.
+ * - Volmenes envolventes en espacio local (AABB y esfera) para el culling.
+ * - Meshlets (`m_meshlets`): rangos de `m_index` con esfera y cono para descartar
+ *   partes de la malla (ver `MeshletBuilder`).
  *
  * @note
  * - Este componente **no realiza el render por s mismo**; solo expone la informacin.
@@ -26,6 +32,9 @@ class DeviceContext;
  */
 class MeshComponent : public Component {
 public:
+    /// ndice en la tabla de componentes de `Entity`.
+    static const ComponentType kType = ComponentType::MESH;
+
     /**
      * @brief Constructor por defecto.
      *
@@ -33,7 +42,7 @@ public:
      *       El tipo de componente se establece como `ComponentType::MESH`.
      */
     MeshComponent()
-        : m_numVertex(0), m_numIndex(0), Component(ComponentType::MESH) {
+        : m_numVertex(0), m_numIndex(0), Component(kType) {
     }
 
     /** @brief Destructor virtual por defecto. */
@@ -62,10 +71,56 @@ public:
     /** @brief Libera recursos asociados al componente (actualmente sin implementacin). */
     void destroy() override {}
 
+    /**
+     * @brief Calcula la AABB y la esfera envolvente a partir de `m_vertex`.
+     *
+     * @note Se llama al cargar la malla (ModelLoader / geometra procedural).
+     * La esfera se centra en la AABB; no es la mnima, pero es barata y conservadora.
+     */
+    void computeBounds() {
+        if (m_vertex.empty()) {
+            m_boundsMin = m_boundsMax = m_sphereCenter = XMFLOAT3(0.0f, 0.0f, 0.0f);
+            m_sphereRadius = 0.0f;
+            m_hasBounds = false;
+            return;
+        }
+
+        const EU::AABB box = EU::ComputeAABB(&m_vertex[0].Pos, sizeof(SimpleVertex), m_vertex.size());
+        const XMFLOAT3 mn(box.Min.x, box.Min.y, box.Min.z);
+        const XMFLOAT3 mx(box.Max.x, box.Max.y, box.Max.z);
+        m_boundsMin = mn;
+        m_boundsMax = mx;
+        m_sphereCenter = XMFLOAT3((mn.x + mx.x) * 0.5f, (mn.y + mx.y) * 0.5f, (mn.z + mx.z) * 0.5f);
+
+        float radiusSq = 0.0f;
+        for (const SimpleVertex& v : m_vertex) {
+            const float dx = v.Pos.x - m_sphereCenter.x;
+            const float dy = v.Pos.y - m_sphereCenter.y;
+            const float dz = v.Pos.z - m_sphereCenter.z;
+            radiusSq = std::max(radiusSq, dx * dx + dy * dy + dz * dz);
+        }
+        m_sphereRadius = sqrtf(radiusSq);
+        m_hasBounds = true;
+    }
+
 public:
-    std::string m_name;                  ///< Nombre identificador de la malla.
+    Name m_name;                         ///< Nombre identificador de la malla (internado).
     std::vector<SimpleVertex> m_vertex;  ///< Lista de vrtices que definen la geometra.
     std::vector<unsigned int> m_index;   ///< Lista de ndices que referencian los vrtices.
     int m_numVertex;                      ///< Cantidad de vrtices.
     int m_numIndex;                       ///< Cantidad de ndices.
+
+    // === Volmenes envolventes (espacio local) ===
+    XMFLOAT3 m_boundsMin = XMFLOAT3(0.0f, 0.0f, 0.0f);    ///< Esquina mnima de la AABB.
+    XMFLOAT3 m_boundsMax = XMFLOAT3(0.0f, 0.0f, 0.0f);    ///< Esquina mxima de la AABB.
+    XMFLOAT3 m_sphereCenter = XMFLOAT3(0.0f, 0.0f, 0.0f); ///< Centro de la esfera envolvente.
+    float m_sphereRadius = 0.0f;                          ///< Radio de la esfera envolvente.
+    bool m_hasBounds = false;                             ///< `computeBounds()` ya se ejecut.
+    std::vector<Meshlet> m_meshlets;                      ///< Clusters en orden de `m_index` (vaco = sin partir).
+    std::vector<SkinVertex> m_skin;                       ///< Influencias por vrtice, paralelo a `m_vertex` (vaco = esttica).
+    std::vector<MorphTarget> m_morphs;                    ///< Blend shapes (deltas dispersos sobre `m_vertex`).
+    std::vector<XMFLOAT2> m_lightmapUV;                   ///< UV2 del lightmap, paralelo a `m_vertex` (vaco = sin lightmap; ver `LightmapUV`).
 };
+
+/// Uno por actor e instancia de prefab: `EU::MakeShared<MeshComponent>` reserva de su pool.
+namespace EU { template<> struct TUsePool<MeshComponent> : std::true_type {}; }
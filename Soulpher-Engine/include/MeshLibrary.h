@@ -0,0 +1,142 @@
+﻿/**
+ * @file MeshLibrary.h
+ * @brief Registro de geometría compartida: un `MeshAsset` por nombre.
+ *
+ * @details
+ * Antes cada `Actor::setMesh` creaba sus propios buffers a partir de una copia de
+ * las mallas, y los vértices seguían en CPU tres veces (`ModelLoader::meshes`, el
+ * argumento y el asset). La biblioteca hace de `AsyncTextureLoader` para la
+ * geometría:
+ *
+ * - Cada nombre (ruta del modelo o identificador de una malla procedural) se sube
+ *   una sola vez; los actores reciben un @ref MeshHandle (puntero con recuento) al
+ *   mismo asset, inmutable tras la subida.
+ * - Por defecto los assets sueltan los vértices e índices de CPU al terminar la
+ *   subida (@ref MeshAsset::hasCpuData); @ref setKeepCpuData lo evita para quien los
+ *   necesite (p. ej. herramientas que lean la geometría).
+ * - @ref adopt toma la salida de un `ModelLoader` (nivel 0 y LOD) y la vacía.
+ * - La biblioteca solo guarda referencias débiles (`TWeakPointer`): cuando el último
+ *   actor suelta un asset se liberan sus buffers y su bloque del pool en el acto, sin
+ *   esperar a un barrido. @ref update quita de la tabla los nombres ya liberados; pedir
+ *   uno de nuevo lo vuelve a subir.
+ * - Tras @ref init, los assets se suben a un @ref GeometryPool común: todos comparten
+ *   VB e IB y la cola los enlaza una sola vez. @ref update (una vez por frame, antes
+ *   de llenar las colas) devuelve los bloques liberados y compacta el pool.
+ *
+ * @note Para estudiantes: compartir un asset también permite que la `RenderQueue`
+ * agrupe los actores que lo usan en una llamada instanciada.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "MeshAsset.h"
+#include <unordered_map>
+
+class Device;
+class DeviceContext;
+class ModelLoader;
+
+/// Referencia compartida a una geometría de la biblioteca.
+typedef EU::TSharedPointer<MeshAsset> MeshHandle;
+
+/**
+ * @class MeshLibrary
+ * @brief Crea cada `MeshAsset` una vez y lo comparte por nombre.
+ */
+class MeshLibrary {
+public:
+    MeshLibrary() = default;
+    ~MeshLibrary() = default;
+
+    /**
+     * @brief Crea el pool de geometría con el formato de vértice activo.
+     * @note Sin llamarlo, cada asset crea sus propios buffers.
+     * @return `S_OK` o el error al crear los buffers del pool.
+     */
+    HRESULT init(Device& device, DeviceContext& deviceContext);
+
+    /**
+     * @brief Inicio de frame: olvida los assets liberados y compacta el pool (ver
+     * `GeometryPool::update`).
+     */
+    void update();
+
+    /** @brief Pool compartido (estadísticas). */
+    const GeometryPool& getGeometryPool() const { return m_geometryPool; }
+
+    /** @brief Pool compartido, para subir geometría generada o dibujar desde él. */
+    GeometryPool& getGeometryPool() { return m_geometryPool; }
+
+    /**
+     * @brief Conservar (o no) las copias de CPU de los assets que se creen a partir de ahora.
+     * @param keep `false` por defecto: solo quedan los buffers de GPU.
+     */
+    void setKeepCpuData(bool keep) { m_keepCpuData = keep; }
+
+    /** @brief Asset registrado con `name` (nulo si no existe o ya se liberó). */
+    MeshHandle find(const std::string& name) const;
+
+    /**
+     * @brief Devuelve el asset de `name`, creándolo con `meshes` si es la primera vez.
+     * @param device Dispositivo para crear los buffers.
+     * @param name Clave del asset.
+     * @param meshes Submallas del nivel 0 (se ignoran si `name` ya existe).
+     * @return Handle al asset; nulo si no se pudo crear ningún buffer.
+     */
+    MeshHandle create(Device& device, const std::string& name, const std::vector<MeshComponent>& meshes);
+
+    /**
+     * @brief Registra lo último que cargó `loader` (nivel 0 y LOD) con el nombre `name`.
+     * @param device Dispositivo para crear los buffers.
+     * @param name Clave del asset (normalmente la ruta del modelo).
+     * @param loader Cargador con `meshes`, `lods` y `lodScreenSizes`; se vacían.
+     * @return Handle al asset; nulo si el cargador no tenía mallas o falló la subida.
+     */
+    MeshHandle adopt(Device& device, const std::string& name, ModelLoader& loader);
+
+    /**
+     * @brief Sustituye la geometría del asset `name` por la de `loader` (recarga en caliente).
+     * @param device Dispositivo para crear los buffers.
+     * @param name Clave de un asset registrado.
+     * @param loader Cargador con la importación nueva; se vacía.
+     * @return `true` si se sustituyó. El objeto es el mismo: los actores que lo tienen
+     * dibujan la malla nueva sin tocar sus handles. Si la subida falla, se queda la anterior.
+     * @note Hilo principal, en la frontera de frame (el bloque anterior se libera diferido).
+     */
+    bool replace(Device& device, const std::string& name, ModelLoader& loader);
+
+    /** @brief Nombres registrados cuyo asset sigue vivo. */
+    std::vector<std::string> getNames() const;
+
+    /**
+     * @brief Quita de la tabla los nombres cuyo asset ya no usa nadie.
+     * @return Entradas quitadas.
+     * @note El asset se liberó al soltar su último handle; esto solo limpia la tabla.
+     */
+    unsigned int releaseUnused();
+
+    /**
+     * @brief Libera todos los assets y el pool (al cerrar, después de los actores).
+     * @note Un handle que siga vivo conserva el objeto, pero ya sin buffers.
+     */
+    void destroy();
+
+    /** @brief Assets registrados (los liberados cuentan hasta el siguiente @ref update). */
+    unsigned int getMeshCount() const { return static_cast<unsigned int>(m_meshes.size()); }
+
+    /** @brief Bytes de vértices e índices que aún quedan en CPU. */
+    size_t getCpuBytes() const;
+
+private:
+    /// Borrador de los assets de la biblioteca: libera la GPU antes del `delete`.
+    struct ReleaseAsset {
+        void operator()(MeshAsset* asset) const {
+            asset->destroy();
+            delete asset;
+        }
+    };
+
+    std::unordered_map<std::string, EU::TWeakPointer<MeshAsset>> m_meshes; ///< Nombre -> asset.
+    bool m_keepCpuData = false;                            ///< Ver @ref setKeepCpuData.
+    GeometryPool m_geometryPool;                           ///< VB/IB de toda la escena.
+};
@@ -0,0 +1,43 @@
+﻿/**
+ * @file MeshSimplifier.h
+ * @brief Simplificación de mallas por colapso de aristas con métrica de error cuádrica.
+ *
+ * @details
+ * Implementa el algoritmo de Garland-Heckbert (1997) en su variante de
+ * *half-edge collapse*: cada arista (u, v) se colapsa moviendo `u` sobre `v`, de modo
+ * que los vértices supervivientes conservan su posición y UV originales.
+ *
+ * - Cada vértice acumula una cuádrica `Q` (suma de los planos de sus triángulos,
+ *   ponderados por área). El coste de colapsar u->v es `v^T (Qu + Qv) v`.
+ * - Las aristas de borde (una sola cara) reciben un plano perpendicular de peso alto:
+ *   así se preservan siluetas abiertas y las costuras de UV (que en OBJ/FBX son
+ *   vértices duplicados y, por tanto, bordes).
+ * - Se descartan colapsos que invertirían la normal de algún triángulo.
+ *
+ * @note Para estudiantes: la cuádrica mide la suma de distancias al cuadrado a los
+ * planos originales; colapsar en zonas planas cuesta casi cero y en aristas vivas
+ * cuesta mucho, por eso la silueta se mantiene aunque se quite la mitad de triángulos.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "MeshComponent.h"
+
+/**
+ * @class MeshSimplifier
+ * @brief Genera versiones con menos triángulos de un `MeshComponent`.
+ */
+class MeshSimplifier {
+public:
+    /// Peso de los planos de borde relativo al de los triángulos.
+    static const float kBoundaryWeight;
+
+    /**
+     * @brief Simplifica una malla de triángulos.
+     * @param mesh Malla original (lista de triángulos; `m_index.size()` múltiplo de 3).
+     * @param ratio Fracción de triángulos a conservar, en (0, 1].
+     * @return Malla simplificada con sus límites calculados; copia de `mesh` si no
+     * es una lista de triángulos o `ratio >= 1`.
+     */
+    static MeshComponent simplify(const MeshComponent& mesh, float ratio);
+};
@@ -0,0 +1,65 @@
+﻿/**
+ * @file MeshStreamer.h
+ * @brief Importación de OBJ muy grandes a `.smesh` con memoria acotada.
+ *
+ * @details
+ * `ObjParser` y el FBX SDK construyen la malla entera en RAM. Para mallas de
+ * fotogrametría de cientos de millones de triángulos (más grandes que la memoria)
+ * la importación se hace fuera de núcleo, escribiendo directamente la caché:
+ *
+ * 1. **Escaneo**: una pasada por el OBJ mapeado vuelca posiciones y UV a dos
+ *    archivos binarios auxiliares y cuenta los triángulos.
+ * 2. **Partición**: con un histograma de las posiciones se corta el eje más largo
+ *    de la AABB en franjas con un número parecido de vértices (una por cada
+ *    @ref MeshStreamer::kBucketTriangles triángulos). Una segunda pasada triangula
+ *    las caras y escribe cada triángulo (6 índices) en el archivo de la franja de
+ *    su centroide. Las posiciones se leen del auxiliar mapeado: el sistema pagina.
+ * 3. **Clusters**: cada franja se carga sola, sus triángulos se ordenan por el
+ *    código Morton del centroide y se cortan en clusters de como mucho
+ *    @ref MeshStreamer::kClusterTriangles triángulos y 65535 vértices (índices de
+ *    16 bits al subirlos). Cada cluster se suelda, se optimiza (`MeshOptimizer`) y
+ *    se añade con @ref MeshCache::Writer, que lo manda a disco al momento.
+ *
+ * En memoria solo están las franja actual, el cluster actual y las tablas de la
+ * caché; el resto vive en archivos mapeados o auxiliares junto a la caché, que se
+ * borran al terminar. Cada cluster queda como una submalla del nivel 0 con su
+ * propia AABB, así que el culling descarta los que no se ven.
+ *
+ * @note El FBX SDK carga la escena entera antes de poder recorrerla, así que este
+ * modo solo existe para OBJ (ver `ModelLoader::LoadCachedOBJModel`).
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include <cstdint>
+
+/**
+ * @class MeshStreamer
+ * @brief Importador fuera de núcleo de OBJ a `.smesh` por clusters espaciales.
+ */
+class MeshStreamer {
+public:
+    /// Triángulos por franja en disco (unos 100 MB de registros al cargarla).
+    static const size_t kBucketTriangles = 4u << 20;
+    /// Máximo de franjas (archivos auxiliares abiertos a la vez).
+    static const unsigned int kMaxBuckets = 256;
+    /// Triángulos por cluster.
+    static const unsigned int kClusterTriangles = 32768;
+
+    /// Resumen de una importación.
+    struct Stats {
+        uint64_t triangles = 0;    ///< Triángulos escritos.
+        uint64_t vertices = 0;     ///< Vértices soldados (los de borde se repiten por cluster).
+        unsigned int clusters = 0; ///< Submallas de la caché.
+        unsigned int buckets = 0;  ///< Franjas de la partición.
+    };
+
+    /**
+     * @brief Importa `sourcePath` y escribe la caché `cachePath` con clave `key`.
+     * @param stats Opcional: recibe el resumen.
+     * @return `S_OK`; `E_FAIL` si no se puede leer o escribir, `E_INVALIDARG` si el OBJ
+     * está mal formado o no tiene caras.
+     */
+    static HRESULT importOBJ(const std::string& sourcePath, const std::string& cachePath,
+        unsigned long long key, Stats* stats = nullptr);
+};
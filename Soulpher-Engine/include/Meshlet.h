@@ -0,0 +1,45 @@
+﻿/**
+ * @file Meshlet.h
+ * @brief Cluster de triángulos de una submalla con sus volúmenes para el culling.
+ *
+ * @details
+ * Un meshlet es un rango contiguo de `MeshComponent::m_index` (unos 64-124
+ * triángulos vecinos, ver @ref MeshletBuilder) con:
+ * - Una **esfera envolvente**, para probarlo contra el frustum.
+ * - Un **cono de normales** (eje y corte), para descartarlo si todos sus
+ *   triángulos dan la espalda a la cámara.
+ *
+ * Prueba del cono (en el espacio de la malla, con `c` la posición de la cámara):
+ * `dot(center - c, coneAxis) >= coneCutoff * |center - c| + radius` ⇒ todos los
+ * triángulos son traseros. Con `coneCutoff >= 1` el cono está degenerado (normales
+ * demasiado dispersas) y la prueba nunca descarta.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include <cstdint>
+
+/**
+ * @struct Meshlet
+ * @brief Rango de índices y volúmenes de culling de un cluster (espacio local).
+ */
+struct Meshlet {
+    uint32_t firstIndex = 0;                         ///< Primer índice en `m_index`.
+    uint32_t indexCount = 0;                         ///< Índices del cluster (3 por triángulo).
+    XMFLOAT3 center = XMFLOAT3(0.0f, 0.0f, 0.0f);    ///< Centro de la esfera envolvente.
+    float radius = 0.0f;                             ///< Radio de la esfera envolvente.
+    XMFLOAT3 coneAxis = XMFLOAT3(0.0f, 0.0f, 0.0f);  ///< Normal media (cara frontal), normalizada.
+    float coneCutoff = 1.0f;                         ///< Seno del semiángulo del cono; 1 = sin cono.
+
+    /**
+     * @brief `true` si, vistos desde `viewPosition`, todos los triángulos son traseros.
+     * @param viewPosition Posición de la cámara en el espacio de la malla.
+     */
+    bool isBackFacing(const XMFLOAT3& viewPosition) const {
+        const float dx = center.x - viewPosition.x;
+        const float dy = center.y - viewPosition.y;
+        const float dz = center.z - viewPosition.z;
+        const float distance = sqrtf(dx * dx + dy * dy + dz * dz);
+        return dx * coneAxis.x + dy * coneAxis.y + dz * coneAxis.z >= coneCutoff * distance + radius;
+    }
+};
@@ -0,0 +1,59 @@
+﻿/**
+ * @file MeshletBuilder.h
+ * @brief Partición de una submalla en meshlets con esfera y cono de normales.
+ *
+ * @details
+ * El culling por actor no sirve para mallas grandes (un edificio, un terreno): casi
+ * siempre hay algo en pantalla, aunque la mayor parte quede fuera o de espaldas. Al
+ * importar, cada `MeshComponent` se corta en clusters de triángulos vecinos
+ * (@ref Meshlet) y sus índices se reordenan para que cada cluster sea un rango
+ * contiguo; así `Actor::submit` puede descartar clusters y dibujar solo los rangos
+ * que quedan.
+ *
+ * Construcción voraz (como `meshopt_buildMeshlets`):
+ * 1. Los vértices se sueldan por posición solo para la adyacencia (las costuras de
+ *    UV no cortan los clusters).
+ * 2. Se empieza por el primer triángulo libre en el orden actual (el de
+ *    `MeshOptimizer`, que ya es local) y se añade cada vez el triángulo vecino que
+ *    trae menos vértices nuevos; a igualdad, el más cercano al centro del cluster.
+ * 3. El cluster se cierra al llegar a @ref MeshletBuilder::kMaxTriangles triángulos,
+ *    a @ref MeshletBuilder::kMaxVertices vértices o cuando no quedan vecinos.
+ *
+ * Después se renumeran los vértices por primer uso y se calculan los volúmenes.
+ *
+ * @note Para estudiantes: clusters pequeños descartan más, pero cada rango visible
+ * es un draw; por eso `Actor::submit` fusiona los rangos cercanos.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "MeshComponent.h"
+
+/**
+ * @class MeshletBuilder
+ * @brief Genera los meshlets de una malla y sus volúmenes de culling.
+ */
+class MeshletBuilder {
+public:
+    /// Vértices distintos (por posición) de un meshlet.
+    static const unsigned int kMaxVertices = 64;
+    /// Triángulos de un meshlet.
+    static const unsigned int kMaxTriangles = 124;
+    /// Coseno mínimo entre el eje y las normales; por debajo el cono no se usa.
+    static const float kMinConeCosine;
+
+    /**
+     * @brief Reordena índices y vértices por meshlets y rellena `m_meshlets`.
+     * @param mesh Lista de triángulos; conserva la geometría (solo cambia el orden).
+     *
+     * @note Con índices inválidos o sin triángulos deja `m_meshlets` vacío.
+     */
+    static void build(MeshComponent& mesh);
+
+    /**
+     * @brief Calcula la esfera y el cono de normales de un rango de la malla.
+     * @param mesh Malla con los índices del meshlet ya en su sitio.
+     * @param meshlet Rango (`firstIndex`, `indexCount`); recibe los volúmenes.
+     */
+    static void computeBounds(const MeshComponent& mesh, Meshlet& meshlet);
+};
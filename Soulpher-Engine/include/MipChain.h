@@ -0,0 +1,68 @@
+﻿/**
+ * @file MipChain.h
+ * @brief Cadena de mips RGBA8 generada en CPU con un filtro de caja 2x2 en SSE2.
+ *
+ * @details
+ * Cada nivel promedia bloques de 2x2 texeles del anterior hasta llegar a 1x1:
+ *
+ * @code
+ * dst(x, y) = (src(2x, 2y) + src(2x+1, 2y) + src(2x, 2y+1) + src(2x+1, 2y+1) + 2) / 4
+ * @endcode
+ *
+ * El kernel SSE2 produce 2 texeles por iteración (lee 4 de cada fila en 16 bytes y
+ * suma en 16 bits para no perder precisión); los bordes impares van por la versión
+ * escalar, que repite la última fila/columna.
+ *
+ * Se genera en la CPU (y no con `GenerateMips`) porque las texturas se cargan en los
+ * hilos de @ref AsyncTextureLoader, que no pueden usar el contexto inmediato: así la
+ * textura se crea inmutable y completa de una vez.
+ *
+ * @note Para estudiantes: sin mips, un suelo lejano muestrea texeles muy separados
+ * entre sí (aliasing, "brillos") y cada acceso cae en una línea de caché distinta.
+ * Con mips la GPU lee el nivel cuyo tamaño se parece al de la pantalla y la cadena
+ * completa solo ocupa 1/3 más de memoria.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+
+/**
+ * @class MipChain
+ * @brief Todos los niveles de una imagen RGBA8 (del 1 en adelante, contiguos en memoria).
+ */
+class MipChain {
+public:
+    /// Un nivel de la cadena.
+    struct Level {
+        unsigned int width = 0;
+        unsigned int height = 0;
+        size_t offset = 0;      ///< Bytes dentro del búfer propio (sin uso en el nivel 0 prestado).
+    };
+
+    /**
+     * @brief Genera los niveles hasta 1x1 a partir del nivel 0.
+     * @param rgba `width * height` texeles de 4 bytes.
+     * @param width Ancho del nivel 0.
+     * @param height Alto del nivel 0.
+     * @param copyLevel0 `false` usa `rgba` como nivel 0 sin copiarlo (p. ej. la salida
+     * del decodificador, que así se sube tal cual); debe seguir vivo mientras se use la cadena.
+     */
+    void build(const unsigned char* rgba, unsigned int width, unsigned int height, bool copyLevel0 = true);
+
+    /** @brief Número de mips que tiene una imagen de ese tamaño (hasta 1x1). */
+    static unsigned int levelCount(unsigned int width, unsigned int height);
+
+    /** @brief Reduce `src` a la mitad (redondeando hacia abajo, mínimo 1). */
+    static void downsample(const unsigned char* src, unsigned int srcWidth, unsigned int srcHeight,
+        unsigned char* dst);
+
+    const std::vector<Level>& getLevels() const { return m_levels; }
+    const unsigned char* getLevelPixels(unsigned int level) const {
+        return level == 0 && m_borrowed ? m_borrowed : m_pixels.data() + m_levels[level].offset;
+    }
+
+private:
+    std::vector<Level> m_levels;          ///< Nivel 0 primero.
+    std::vector<unsigned char> m_pixels;  ///< Niveles propios seguidos.
+    const unsigned char* m_borrowed = nullptr; ///< Nivel 0 prestado (`copyLevel0 = false`).
+};
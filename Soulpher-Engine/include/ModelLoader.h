@@ -1,7 +1,9 @@
 #pragma once
 #include "Prerequisites.h"
 #include "MeshComponent.h"
+#include "Animation.h"
 #include "fbxsdk.h"
+#include <unordered_map>
 
 /**
  * @file ModelLoader.h
@@ -13,19 +15,32 @@
  * - Extraer geometra (vrtices, ndices) y materiales.
  * - Cargar informacin de texturas.
  * - Generar `MeshComponent` listos para su uso en el renderizado.
+ * - Obtener niveles de detalle (LOD): de los nodos `FbxLODGroup` del archivo o,
+ *   si no los hay, generndolos con `GenerateLODs` (colapso de aristas, ver `MeshSimplifier`).
+ * - Importar el esqueleto, los pesos de skinning (`MeshComponent::m_skin`), los blend
+ *   shapes (`MeshComponent::m_morphs`) y cada `FbxAnimStack` como un `AnimationClip`
+ *   comprimido (ver `Animation.h`).
  *
  * @note Para estudiantes:
  * - Los modelos OBJ son simples: solo contienen geometra y referencias a materiales (MTL).
  * - Los modelos FBX son ms complejos: pueden incluir jerarquas de nodos, animaciones, esqueleto, materiales y mltiples UVs.
- * - Este loader se enfoca en obtener **mallas estticas** listas para usar, pero se puede ampliar para animaciones.
+ * - Las mallas se importan en su pose de enlace; para verlas animadas hay que aplicar la
+ *   paleta de `AnimationSystem` en el shader (skinning).
  */
 class ModelLoader {
 public:
     /** @brief Constructor por defecto. */
     ModelLoader() = default;
 
-    /** @brief Destructor por defecto. */
-    ~ModelLoader() = default;
+    /** @brief Libera el FBX SDK si sigue vivo (ver `ReleaseFBXManager`). */
+    ~ModelLoader() { ReleaseFBXManager(); }
+
+    ModelLoader(const ModelLoader&) = delete;
+    ModelLoader& operator=(const ModelLoader&) = delete;
+
+    /// Cambia cuando la importacin o la generacin de LODs producen otro resultado:
+    /// invalida las cachs `.smesh` (ver `MeshCache`) y `.sanim` (ver `AnimationCache`).
+    static const unsigned int kImporterVersion = 7;
 
     /**
      * @brief Carga un modelo en formato OBJ.
@@ -34,18 +49,30 @@ public:
      *
      * @note
      * - No soporta animaciones ni jerarquas, solo mallas estticas.
-     * - Busca un archivo `.mtl` asociado para materiales.
+     * - Solo lee geometra (`v`, `vt`, `f`); el `.mtl` y las normales se ignoran.
+     * - Archivos grandes se analizan en paralelo (ver `ObjParser`).
      */
     MeshComponent LoadOBJModel(const std::string& filePath);
 
     /**
      * @brief Inicializa el administrador de FBX SDK.
-     * @return `true` si la inicializacin fue exitosa.
+     * @return `true` si la inicializacin fue exitosa (o ya estaba inicializado).
      *
-     * @note El FBX SDK debe estar inicializado antes de cargar modelos FBX.
+     * @note
+     * - Crea `FbxManager`, `FbxIOSettings` y `FbxScene` una sola vez; las importaciones
+     *   siguientes reutilizan los tres, as que el arranque del SDK se paga una vez.
+     * - El FBX SDK no es seguro entre hilos: usar un `ModelLoader` por hilo importador.
      */
     bool InitializeFBXManager();
 
+    /**
+     * @brief Destruye el `FbxManager` (y con l la escena y los ajustes de E/S).
+     *
+     * @note Las mallas ya extradas se conservan. Llamarlo al acabar de importar;
+     * la siguiente `LoadFBXModel` volvera a inicializar el SDK.
+     */
+    void ReleaseFBXManager();
+
     /**
      * @brief Carga un modelo en formato FBX.
      * @param filePath Ruta del archivo FBX.
@@ -53,25 +80,94 @@ public:
      *
      * @note
      * - Puede contener mltiples nodos y mallas.
-     * - Requiere haber llamado antes a `InitializeFBXManager()`.
+     * - Inicializa el SDK si hace falta y vaca la escena al terminar.
+     * - Sustituye el resultado de la carga anterior (`meshes`, `lods`, texturas).
      */
     bool LoadFBXModel(const std::string& filePath);
 
+    /**
+     * @brief Carga un FBX con sus LODs pasando por la cach `<archivo>.smesh`.
+     * @param filePath Ruta del archivo FBX.
+     * @param lodLevels Niveles a generar si el archivo no trae LODs (ver `GenerateLODs`).
+     * @param lodRatio Fraccin de tringulos por nivel generado.
+     * @return `true` si hay mallas (de la cach o importadas).
+     *
+     * @note
+     * - Si la cach existe y su clave (hash del FBX, `kImporterVersion` y parmetros
+     *   de LOD) coincide, no se toca el FBX SDK.
+     * - Si no, se importa con `LoadFBXModel`, se generan los LODs y se escribe la cach.
+     * - Los modelos con esqueleto o blend shapes guardan adems `<archivo>.sanim`
+     *   (esqueleto, clips, pesos y blend shapes), con la misma clave.
+     */
+    bool LoadCachedFBXModel(const std::string& filePath, unsigned int lodLevels = 3, float lodRatio = 0.5f);
+
+    /// Tamao a partir del cual `LoadCachedOBJModel` importa por streaming (`MeshStreamer`).
+    static const unsigned long long kStreamingImportBytes = 256ull << 20;
+
+    /**
+     * @brief Carga un OBJ pasando por la cach `<archivo>.smesh`.
+     * @param filePath Ruta del archivo OBJ.
+     * @return `true` si hay mallas (de la cach o importadas).
+     *
+     * @note
+     * - Hasta `kStreamingImportBytes` se importa en memoria con `ObjParser` (una malla).
+     * - Por encima, `MeshStreamer` escribe la cach por clusters con memoria acotada y
+     *   las mallas se leen despus de la cach (una por cluster). Sin LODs en ambos casos.
+     */
+    bool LoadCachedOBJModel(const std::string& filePath);
+
     /**
      * @brief Procesa recursivamente un nodo de la escena FBX.
      * @param node Puntero al nodo FBX.
      *
-     * @note Recorre jerarquas para encontrar mallas y materiales.
+     * @note Recorre jerarquas para encontrar mallas y materiales. Las mallas no se
+     * convierten aqu: se apuntan en orden de recorrido para `ExtractFBXMeshes`.
      */
     void ProcessFBXNode(FbxNode* node);
 
+    /**
+     * @brief Convierte en paralelo las mallas apuntadas por `ProcessFBXNode`.
+     *
+     * @note Cada hilo escribe en su propia posicin de un vector ya dimensionado; luego
+     * se aaden a `meshes`/`lods` en el orden del recorrido, as que el resultado no
+     * depende del nmero de hilos.
+     */
+    void ExtractFBXMeshes();
+
+    /// Hueso de `skeleton` de cada nodo FBX.
+    typedef std::unordered_map<FbxNode*, int> JointMap;
+
     /**
      * @brief Procesa una malla asociada a un nodo FBX.
      * @param node Puntero al nodo que contiene la malla.
+     * @param meshData Recibe la malla convertida.
+     * @param joints Huesos del esqueleto; si la malla tiene `FbxSkin`, rellena `m_skin`.
+     * Los `FbxBlendShape` van siempre a `m_morphs` (deltas dispersos).
      *
-     * @note Extrae vrtices, normales, UVs e ndices para generar un `MeshComponent`.
+     * @note Triangula, separa vrtices en las costuras de UV, suelda los repetidos y
+     * reordena el resultado con `MeshOptimizer` y lo parte en meshlets (`MeshletBuilder`).
+     * Solo usa accesores de lectura del FBX SDK, as que puede llamarse desde varios hilos.
      */
-    void ProcessFBXMesh(FbxNode* node);
+    static void ProcessFBXMesh(FbxNode* node, MeshComponent& meshData, const JointMap* joints = nullptr);
+
+    /**
+     * @brief Construye `skeleton` con los nodos `eSkeleton` y los enlazados por los
+     * clusters de las mallas apuntadas (en orden de recorrido: padres antes que hijos).
+     * @param root Nodo raz de la escena.
+     *
+     * @note La matriz inversa de enlace sale del cluster; un hueso sin cluster usa la
+     * inversa de su transformacin global en la pose por defecto.
+     */
+    void ProcessFBXSkeleton(FbxNode* root);
+
+    /**
+     * @brief Muestrea cada `FbxAnimStack` a `AnimationClip::kDefaultSampleRate` y lo
+     * comprime en `clips`.
+     *
+     * @note Se evala la transformacin global de cada hueso y se pasa a local respecto
+     * a su padre en `skeleton`: los nodos intermedios que no son huesos quedan dentro.
+     */
+    void ProcessFBXAnimations();
 
     /**
      * @brief Procesa los materiales asociados a un modelo FBX.
@@ -81,6 +177,23 @@ public:
      */
     void ProcessFBXMaterials(FbxSurfaceMaterial* material);
 
+    /**
+     * @brief Procesa un nodo `FbxLODGroup`: el hijo 0 va a `meshes` y el hijo i a `lods[i-1]`.
+     * @param node Nodo con atributo `eLODGroup`.
+     *
+     * @note Si el grupo usa umbrales en porcentaje de pantalla se guardan en `lodScreenSizes`.
+     */
+    void ProcessFBXLODGroup(FbxNode* node);
+
+    /**
+     * @brief Genera niveles de detalle simplificando `meshes` (si el archivo no traa LODs).
+     * @param levelCount Niveles a generar adems del original.
+     * @param ratio Fraccin de tringulos que conserva cada nivel respecto al anterior.
+     *
+     * @note El nivel i se usa por debajo de `0.5 * ratio^(i-1)` de alto de pantalla.
+     */
+    void GenerateLODs(unsigned int levelCount = 3, float ratio = 0.5f);
+
     /**
      * @brief Obtiene los nombres de archivos de texturas extrados.
      * @return Vector con rutas o nombres de archivos de textura.
@@ -91,8 +204,22 @@ private:
     FbxManager* lSdkManager = nullptr; ///< Administrador principal del FBX SDK.
     FbxScene* lScene = nullptr;        ///< Escena FBX cargada en memoria.
     std::vector<std::string> textureFileNames; ///< Lista de texturas encontradas durante el procesamiento.
+    int m_lodLevel = 0;                ///< Nivel al que van las mallas procesadas (dentro de un FbxLODGroup).
+
+    /// Malla encontrada en el recorrido, pendiente de `ExtractFBXMeshes`.
+    struct PendingMesh {
+        FbxNode* node;  ///< Nodo con atributo `eMesh`.
+        int lodLevel;   ///< 0 = `meshes`; i = `lods[i-1]`.
+    };
+    std::vector<PendingMesh> m_pendingMeshes; ///< En orden de recorrido.
+    std::vector<FbxNode*> m_jointNodes;       ///< Nodo de cada hueso de `skeleton` (solo durante la importacin).
+    JointMap m_jointIndex;                    ///< Inversa de `m_jointNodes`.
 
 public:
     std::string modelName; ///< Nombre del modelo cargado.
     std::vector<MeshComponent> meshes; ///< Lista de mallas extradas del modelo.
+    std::vector<std::vector<MeshComponent>> lods; ///< Niveles de detalle 1..N (mismo orden de submallas que `meshes`).
+    std::vector<float> lodScreenSizes; ///< Tamao en pantalla por debajo del cual se usa cada nivel de `lods`.
+    Skeleton skeleton;                 ///< Esqueleto (vaco si el modelo no tiene huesos).
+    std::vector<AnimationClip> clips;  ///< Un clip por `FbxAnimStack`.
 };
@@ -0,0 +1,111 @@
+﻿/**
+ * @file Multisampling.h
+ * @brief MSAA configurable de la escena con resolución explícita.
+ *
+ * @details
+ * El back buffer es siempre de una muestra (el flip model no admite otra cosa, ver
+ * `SwapChain::init`). Con `r.msaa` > 1 el camino forward dibuja la escena en un color y
+ * un depth buffer multimuestra del grafo, y el pase "MSAA resolve" los lleva a una
+ * muestra antes de todo lo que lee la escena (Hi-Z, TAA, postproceso):
+ *
+ * - **Color**: `ResolveSubresource` (promedio de las muestras) al color de la escena o,
+ *   si no hay ningún target intermedio, directamente al back buffer.
+ * - **Profundidad**: no se puede resolver con `ResolveSubresource`; un compute shader
+ *   guarda la muestra más lejana de cada píxel en un target R32F. La más lejana deja la
+ *   pirámide Hi-Z conservadora (no oculta nada que se vea en alguna muestra).
+ *
+ * @ref configure elige el modo con `CheckMultisampleQualityLevels`: las muestras pedidas
+ * o, si el formato no las admite, el siguiente número menor; la calidad se recorta a la
+ * que da el driver.
+ *
+ * @note Para estudiantes: el MSAA solo reparte la cobertura y la profundidad por
+ * muestra; el pixel shader se ejecuta una vez por píxel, así que suaviza los bordes de
+ * los triángulos pero no el aliasing dentro de ellos (texturas, brillos). El camino
+ * diferido no lo usa: iluminar un G-buffer multimuestra exigiría hacerlo por muestra.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "RenderTargetPool.h"
+
+class Device;
+class DeviceContext;
+
+/**
+ * @class Multisampling
+ * @brief Modo MSAA de la escena, descripciones de sus targets y pase de resolución.
+ */
+class Multisampling {
+public:
+    Multisampling() = default;
+    ~Multisampling() { destroy(); }
+
+    /// Lado del grupo de hilos de la resolución de profundidad (`RESOLVE_TILE`).
+    static const unsigned int kTileSize = 8;
+    /// Máximo de muestras por píxel que se piden (D3D11 garantiza hasta 8 en 11_0).
+    static const unsigned int kMaxSamples = 8;
+    /// Formato del depth buffer resuelto.
+    static const DXGI_FORMAT kResolvedDepthFormat = DXGI_FORMAT_R32_FLOAT;
+
+    /**
+     * @brief Crea el kernel de la resolución de profundidad.
+     * @return `S_OK`; `DXGI_ERROR_UNSUPPORTED` por debajo de 11_0 (sin MSAA).
+     */
+    HRESULT init(Device& device);
+
+    /**
+     * @brief Elige el modo soportado más cercano a `samples` x `quality` para la escena
+     * en `colorFormat` (y el depth buffer D24S8).
+     * @note Barato si nada cambió desde la última llamada: se llama cada frame.
+     */
+    void configure(Device& device, unsigned int samples, unsigned int quality, DXGI_FORMAT colorFormat);
+
+    /** @brief Muestras del modo elegido (1: sin MSAA). */
+    unsigned int getSampleCount() const { return m_sampleCount; }
+
+    /** @brief Nivel de calidad del modo elegido. */
+    unsigned int getSampleQuality() const { return m_sampleQuality; }
+
+    /** @brief `true` si hay kernel y el modo elegido tiene más de una muestra. */
+    bool isEnabled() const { return isReady() && m_sampleCount > 1; }
+
+    /** @brief Color multimuestra de la escena (solo RT: se lee con `ResolveSubresource`). */
+    RenderTargetPool::Desc colorDesc(unsigned int width, unsigned int height, DXGI_FORMAT format) const;
+
+    /**
+     * @brief Aplica el modo a la descripción del depth buffer de la escena (typeless
+     * con SRV: el compute shader lee cada muestra).
+     */
+    void applyTo(RenderTargetPool::Desc& depthDesc) const;
+
+    /** @brief Profundidad resuelta (R32F, SRV + UAV): la leen Hi-Z y TAA. */
+    static RenderTargetPool::Desc resolvedDepthDesc(unsigned int width, unsigned int height);
+
+    /**
+     * @brief Resuelve el color y la profundidad de la escena.
+     * @param color Textura de @ref colorDesc.
+     * @param target Textura de una muestra que recibe el color (mismo formato).
+     * @param format Formato del color.
+     * @param depthSRV Depth buffer multimuestra (SRV R24_UNORM_X8_TYPELESS).
+     * @param resolvedDepth Target de @ref resolvedDepthDesc.
+     * @warning Desenlaza los render targets: el depth buffer no puede ser a la vez DSV y SRV.
+     */
+    void resolve(DeviceContext& deviceContext, ID3D11Texture2D* color, ID3D11Texture2D* target,
+        DXGI_FORMAT format, ID3D11ShaderResourceView* depthSRV, const RenderTargetPool::Target& resolvedDepth,
+        unsigned int width, unsigned int height);
+
+    /** @brief Libera el kernel. */
+    void destroy();
+
+    /** @brief `true` tras un @ref init correcto. */
+    bool isReady() const { return m_resolveDepthShader != nullptr; }
+
+private:
+    unsigned int m_requestedSamples = 1;    ///< Última petición de @ref configure.
+    unsigned int m_requestedQuality = 0;
+    DXGI_FORMAT m_colorFormat = DXGI_FORMAT_UNKNOWN;
+    unsigned int m_sampleCount = 1;         ///< Modo elegido.
+    unsigned int m_sampleQuality = 0;
+
+    ID3D11ComputeShader* m_resolveDepthShader = nullptr;
+};
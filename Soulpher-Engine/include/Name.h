@@ -0,0 +1,122 @@
+﻿/**
+ * @file Name.h
+ * @brief Nombres internados: un id de 32 bits por cadena distinta, para comparar e
+ * indexar sin copiar ni recorrer texto.
+ *
+ * @details
+ * Los nombres de actores, prefabs y mallas eran `std::string`: cada asignación copiaba
+ * la cadena y cada comparación (p. ej. buscar un actor por nombre) recorría el texto.
+ * Aquí la cadena se guarda **una vez** en @ref NameTable y los objetos llevan solo su
+ * @ref Name (el índice de la entrada):
+ *
+ * - Comparar, copiar o usar un `Name` como clave es trabajar con un `uint32_t`.
+ * - Internar (construir un `Name` desde texto) calcula el hash FNV-1a y busca en una
+ *   tabla de direccionamiento abierto; solo la primera vez copia la cadena. Va con un
+ *   mutex: se hace al cargar o al renombrar, no por frame.
+ * - Las entradas viven en bloques de tamaño fijo que no se mueven nunca, así que
+ *   @ref Name::str (la UI, los logs) resuelve sin bloquear desde cualquier hilo.
+ *
+ * @note Para estudiantes: los ids dependen del orden en que se internan; valen dentro
+ * del proceso pero no se guardan en disco (las cachés en disco siguen usando el texto).
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include <atomic>
+#include <mutex>
+
+/**
+ * @class NameTable
+ * @brief Cadenas internadas del proceso, indexadas por id (0 = cadena vacía).
+ */
+class NameTable {
+public:
+    /// Entradas por bloque (los bloques no se mueven al crecer).
+    static const uint32_t kChunkSize = 4096;
+    /// Bloques como mucho (`kChunkSize * kMaxChunks` nombres distintos).
+    static const uint32_t kMaxChunks = 1024;
+
+    /** @brief Tabla del proceso. */
+    static NameTable& get();
+
+    /**
+     * @brief Id de la cadena; la añade si es nueva.
+     * @return 0 para la cadena vacía o si la tabla está llena.
+     */
+    uint32_t intern(const char* text, size_t length);
+
+    /** @brief Cadena del id (la vacía si el id no existe). Sin bloqueo. */
+    const std::string& resolve(uint32_t id) const;
+
+    /** @brief Hash FNV-1a de la cadena del id (0 si no existe). */
+    uint32_t getHash(uint32_t id) const;
+
+    /** @brief Nombres distintos internados (sin contar el vacío). */
+    uint32_t getCount() const { return m_count.load(std::memory_order_acquire) - 1; }
+
+private:
+    NameTable();
+    ~NameTable();
+    NameTable(const NameTable&) = delete;
+    NameTable& operator=(const NameTable&) = delete;
+
+    struct Entry {
+        std::string text;
+        uint32_t hash = 0;
+    };
+
+    const Entry* entry(uint32_t id) const {
+        if (id >= m_count.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        return &m_chunks[id / kChunkSize].load(std::memory_order_acquire)[id % kChunkSize];
+    }
+
+    /// Duplica `m_slots` y recoloca los ids (con el mutex tomado).
+    void grow();
+
+    std::atomic<Entry*> m_chunks[kMaxChunks] = {}; ///< Bloques de `kChunkSize` entradas.
+    std::atomic<uint32_t> m_count{ 0 };            ///< Entradas publicadas (la 0 es la vacía).
+    std::vector<uint32_t> m_slots;                 ///< Hash abierto: id o 0 si el hueco está libre.
+    std::mutex m_mutex;                            ///< Protege `intern`.
+};
+
+/**
+ * @class Name
+ * @brief Id de una cadena de @ref NameTable; se compara y copia como un entero.
+ *
+ * @details Se construye implícitamente desde texto, así que sustituye a un
+ * `std::string` en asignaciones (`actor->setName("Player")`). `<` ordena por id, no
+ * alfabéticamente: sirve para contenedores ordenados, no para mostrar listas.
+ */
+class Name {
+public:
+    Name() = default;
+    Name(const char* text) : m_id(text ? NameTable::get().intern(text, strlen(text)) : 0) {}
+    Name(const std::string& text) : m_id(NameTable::get().intern(text.data(), text.size())) {}
+    Name(const char* text, size_t length) : m_id(NameTable::get().intern(text, length)) {}
+
+    /** @brief Id en la tabla (0 = vacío). */
+    uint32_t getId() const { return m_id; }
+
+    /** @brief `true` para el nombre vacío. */
+    bool isNone() const { return m_id == 0; }
+
+    /** @brief Texto del nombre (sin copia; vale mientras viva el proceso). */
+    const std::string& str() const { return NameTable::get().resolve(m_id); }
+
+    /** @brief Texto como cadena C. */
+    const char* c_str() const { return str().c_str(); }
+
+    bool operator==(const Name& o) const { return m_id == o.m_id; }
+    bool operator!=(const Name& o) const { return m_id != o.m_id; }
+    bool operator<(const Name& o) const { return m_id < o.m_id; }
+
+    /// Hash para contenedores (el id ya es único).
+    struct Hash {
+        size_t operator()(const Name& name) const { return name.m_id; }
+    };
+
+private:
+    uint32_t m_id = 0;
+};
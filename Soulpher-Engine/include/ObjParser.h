@@ -0,0 +1,164 @@
+﻿/**
+ * @file ObjParser.h
+ * @brief Lector de Wavefront OBJ sobre el archivo mapeado, en paralelo por tramos.
+ *
+ * @details
+ * `OBJ_Loader` lee línea a línea con `std::getline` y crea cadenas para cada token,
+ * así que un OBJ escaneado de cientos de MB tardaba minutos. Este lector:
+ *
+ * 1. Mapea el archivo (@ref MappedFile) y tokeniza sobre la vista, sin copias.
+ * 2. Corta el archivo en tramos por saltos de línea y los analiza en paralelo
+ *    (`v`, `vt` y `f`; lo demás se ignora). Los números se leen con
+ *    `std::from_chars`, sin locale ni cadenas intermedias.
+ * 3. Une los tramos en orden: los índices negativos (relativos) se resuelven con el
+ *    número de posiciones/UV de los tramos anteriores.
+ * 4. Triangula los polígonos en abanico y suelda las esquinas con el mismo par
+ *    (posición, UV), escribiendo directamente en el `MeshComponent`.
+ *
+ * Las UV se invierten en Y (1 - v), como hacía `LoadOBJModel` con `OBJ_Loader`.
+ *
+ * El tokenizador (@ref ObjParser::parse) es una plantilla sobre un *visitante*, así
+ * que la importación por streaming (@ref MeshStreamer) recorre el mismo archivo
+ * con otro visitante sin guardar nada en memoria.
+ *
+ * @note Para estudiantes: el paralelismo solo compensa con archivos grandes; por
+ * debajo de @ref ObjParser::kMinChunkBytes por hilo se analiza en un solo tramo.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "MeshComponent.h"
+#include <charconv>
+
+/**
+ * @class ObjParser
+ * @brief Carga la geometría de un OBJ (posiciones, UV y caras) en una malla.
+ */
+class ObjParser {
+public:
+    /// Tamaño mínimo de un tramo para repartirlo a otro hilo.
+    static const size_t kMinChunkBytes = 4u << 20;
+
+    /**
+     * @brief Lee `path` y rellena `mesh` (vértices soldados, índices y AABB).
+     * @param path Archivo .obj.
+     * @param mesh Recibe la malla; queda vacía si falla.
+     * @param threadCount Hilos a usar (0 = uno por núcleo).
+     * @return `false` si el archivo no se puede abrir, no tiene caras o tiene
+     * índices fuera de rango.
+     */
+    static bool load(const std::string& path, MeshComponent& mesh, unsigned int threadCount = 0);
+
+    /// Esquina de una cara tal como aparece en el OBJ: base 1, negativo = relativo, 0 = sin UV.
+    struct Corner {
+        int position = 0;
+        int texcoord = 0;
+    };
+
+    /**
+     * @brief Recorre las líneas `v`, `vt` y `f` de [begin, end).
+     * @param visitor Objeto con `position(const XMFLOAT3&)`, `texcoord(const XMFLOAT2&)`
+     * y `face(const Corner*, unsigned int)`; las caras de menos de 3 esquinas se omiten.
+     * @return `false` en la primera línea mal formada.
+     */
+    template<class Visitor>
+    static bool parse(const char* begin, const char* end, Visitor& visitor) {
+        std::vector<Corner> corners;
+        const char* p = begin;
+        while (p < end) {
+            p = skipBlanks(p, end);
+            if (p + 1 < end && p[0] == 'v' && isBlank(p[1])) {
+                XMFLOAT3 v;
+                p += 1;
+                if (!parseFloat(p, end, v.x) || !parseFloat(p, end, v.y) || !parseFloat(p, end, v.z)) {
+                    return false;
+                }
+                visitor.position(v);
+            }
+            else if (p + 2 < end && p[0] == 'v' && p[1] == 't' && isBlank(p[2])) {
+                XMFLOAT2 t(0.0f, 0.0f);
+                p += 2;
+                if (!parseFloat(p, end, t.x)) {
+                    return false;
+                }
+                // La segunda coordenada es opcional (texturas 1D).
+                const char* q = p;
+                if (parseFloat(q, end, t.y)) {
+                    p = q;
+                }
+                else {
+                    t.y = 0.0f;
+                }
+                visitor.texcoord(t);
+            }
+            else if (p + 1 < end && p[0] == 'f' && isBlank(p[1])) {
+                p += 1;
+                corners.clear();
+                for (;;) {
+                    p = skipBlanks(p, end);
+                    if (p >= end || *p == '\r' || *p == '\n' || *p == '#') {
+                        break;
+                    }
+                    // v, v/vt, v//vn o v/vt/vn (la normal se ignora).
+                    Corner corner;
+                    if (!parseIndex(p, end, corner.position)) {
+                        return false;
+                    }
+                    if (p < end && *p == '/') {
+                        ++p;
+                        if (p < end && *p != '/' && !parseIndex(p, end, corner.texcoord)) {
+                            return false;
+                        }
+                        if (p < end && *p == '/') {
+                            ++p;
+                            int normal = 0;
+                            p = std::from_chars(p, end, normal).ptr;
+                        }
+                    }
+                    corners.push_back(corner);
+                }
+                if (corners.size() >= 3) {
+                    visitor.face(corners.data(), static_cast<unsigned int>(corners.size()));
+                }
+            }
+            p = skipLine(p, end);
+        }
+        return true;
+    }
+
+    /** @brief Primer byte después del siguiente salto de línea (o `end`). */
+    static const char* skipLine(const char* p, const char* end) {
+        while (p < end && *p != '\n') ++p;
+        return p < end ? p + 1 : end;
+    }
+
+private:
+    static bool isBlank(char c) { return c == ' ' || c == '\t'; }
+
+    static const char* skipBlanks(const char* p, const char* end) {
+        while (p < end && isBlank(*p)) ++p;
+        return p;
+    }
+
+    /// Lee un float tras los espacios; `from_chars` no admite '+' inicial.
+    static bool parseFloat(const char*& p, const char* end, float& value) {
+        p = skipBlanks(p, end);
+        if (p < end && *p == '+') ++p;
+        const std::from_chars_result result = std::from_chars(p, end, value);
+        if (result.ec != std::errc()) {
+            return false;
+        }
+        p = result.ptr;
+        return true;
+    }
+
+    /// Lee un índice OBJ (distinto de 0).
+    static bool parseIndex(const char*& p, const char* end, int& index) {
+        const std::from_chars_result result = std::from_chars(p, end, index);
+        if (result.ec != std::errc() || index == 0) {
+            return false;
+        }
+        p = result.ptr;
+        return true;
+    }
+};
@@ -0,0 +1,105 @@
+﻿/**
+ * @file OcclusionPredicates.h
+ * @brief Dibujo predicado de actores caros con occlusion queries de su AABB.
+ *
+ * @details
+ * Alternativa barata a la pirámide Hi-Z para unos pocos actores pesados (muchos
+ * triángulos o material caro), marcados con `Actor::setOcclusionQuery`:
+ *
+ * 1. Tras el pase opaco, la AABB en mundo de cada actor marcado se dibuja dentro de
+ *    un `ID3D11Predicate` (`D3D11_QUERY_OCCLUSION_PREDICATE`), sin color ni escritura
+ *    de profundidad (`OcclusionBox.fx`, solo VS).
+ * 2. Después cada actor se dibuja bajo `SetPredication(predicado, FALSE)`: si ninguna
+ *    muestra de su caja pasó el depth test, la GPU descarta sus draws.
+ *
+ * La CPU nunca lee el resultado (no hay `GetData` ni esperas); el predicado se crea
+ * con `D3D11_QUERY_MISC_PREDICATEHINT`, así que si la query aún no terminó el
+ * driver puede dibujar igualmente. Con la cámara dentro de la caja (o a menos del
+ * plano cercano) no se lanza query y el actor se dibuja sin predicación.
+ *
+ * Los actores marcados no pasan por la `RenderQueue` en la vista principal (ni por
+ * su pre-pase de profundidad); en las colas de sombra siguen como siempre.
+ *
+ * @note Para estudiantes: solo tapa lo dibujado antes en el frame. Las cajas se prueban
+ * contra el resto de opacos, así que funciona bien con oclusores grandes (edificios,
+ * terreno) y mal entre dos actores marcados.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "Buffer.h"
+#include "ConstantBuffer.h"
+#include "DepthStencilState.h"
+#include "ShaderProgram.h"
+
+class Device;
+class DeviceContext;
+class Actor;
+
+/**
+ * @class OcclusionPredicates
+ * @brief Cajas de prueba y predicados de los actores con `Actor::usesOcclusionQuery`.
+ */
+class OcclusionPredicates {
+public:
+    OcclusionPredicates() = default;
+    ~OcclusionPredicates() { destroy(); }
+
+    /**
+     * @brief Crea la caja unidad, su programa y los estados de la prueba.
+     * @param device Dispositivo (se guarda para crear predicados según se necesiten).
+     * @return `S_OK` o el error; sin él los actores marcados se dibujan por la cola.
+     */
+    HRESULT init(Device& device);
+
+    /** @brief Inicio de frame: vacía la lista de actores. */
+    void begin() { m_actors.clear(); }
+
+    /**
+     * @brief Añade un actor visible a la lista del frame.
+     * @return `true` si lo dibujará este objeto (no enviarlo a la cola).
+     */
+    bool add(Actor& actor);
+
+    /**
+     * @brief Lanza las queries de todas las cajas y dibuja los actores predicados.
+     * @param deviceContext Contexto inmediato, con cámara (b0/b1) y shadow map enlazados.
+     * @param eye Posición de la cámara en mundo.
+     * @param nearPlane Distancia al plano cercano (margen de "cámara dentro de la caja").
+     * @param program Programa de los actores que no reciben sombra.
+     * @param receiverProgram Programa de los receptores (`nullptr` = `program`).
+     *
+     * @note Llamar tras el pase opaco de la cola, con el estado de profundidad por defecto.
+     */
+    void render(DeviceContext& deviceContext, const XMFLOAT3& eye, float nearPlane,
+        ShaderProgram& program, ShaderProgram* receiverProgram);
+
+    /** @brief Libera predicados, caja, programa y estados. */
+    void destroy();
+
+    /** @brief `true` tras un @ref init correcto. */
+    bool isReady() const { return m_device != nullptr; }
+
+    /** @brief Actores dibujados por este camino en el último frame. */
+    unsigned int getActorCount() const { return static_cast<unsigned int>(m_actors.size()); }
+
+    /** @brief Queries lanzadas en el último frame (sin contar los que tenían la cámara dentro). */
+    unsigned int getQueryCount() const { return m_queryCount; }
+
+private:
+    /// Crea predicados hasta tener `count`.
+    HRESULT reserve(unsigned int count);
+
+    Device* m_device = nullptr;
+    ShaderProgram m_boxProgram;                        ///< OcclusionBox.fx (sin pixel shader).
+    Buffer m_boxVertices;                              ///< 8 esquinas de [0,1]^3.
+    Buffer m_boxIndices;                               ///< 12 triángulos.
+    TConstantBuffer<CBChangesEveryFrame> m_boxConstants; ///< Mundo de la caja (slot b2).
+    DepthStencilState m_testState;                     ///< LESS_EQUAL sin escribir Z.
+    ID3D11RasterizerState* m_boxRasterizer = nullptr;  ///< Sin culling de caras.
+
+    std::vector<ID3D11Predicate*> m_predicates;        ///< Uno por actor del frame (se reutilizan).
+    std::vector<Actor*> m_actors;                      ///< Actores del frame.
+    std::vector<ID3D11Predicate*> m_framePredicates;   ///< Predicado de cada actor (nulo = sin prueba).
+    unsigned int m_queryCount = 0;
+};
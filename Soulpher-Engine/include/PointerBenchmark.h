@@ -0,0 +1,48 @@
+﻿/**
+ * @file PointerBenchmark.h
+ * @brief Microbenchmark de los punteros con recuento del motor frente a `std::shared_ptr`.
+ *
+ * @details
+ * Con `-ptrbench archivo.csv` la aplicación mide y sale sin abrir la escena. Para cada
+ * tipo de puntero (`TSharedPointer` de dos reservas, `MakeShared` del montón y de un
+ * pool, `MakeAtomicShared`, `TIntrusivePointer` y `std::make_shared`) mide en nanosegundos por operación:
+ * - **create**: crear y destruir un objeto pequeño (reservas + recuento).
+ * - **copy**: copiar y destruir un puntero a un objeto vivo (incremento + decremento).
+ * - **read**: leer un campo del objeto a través de un vector de punteros (cachés).
+ *
+ * @note Para estudiantes: las cifras dependen del allocator y de la CPU; lo que importa
+ * es la comparación dentro de la misma ejecución (p. ej. atómico frente a no atómico).
+ */
+
+#pragma once
+#include "Prerequisites.h"
+
+/**
+ * @class PointerBenchmark
+ * @brief Ejecuta las mediciones y escribe el CSV.
+ */
+class PointerBenchmark {
+public:
+    /// Operaciones por medición si no se indica otro número.
+    static const unsigned int kDefaultIterations = 1000000;
+
+    /// Resultado de una medición.
+    struct Result {
+        const char* test;       ///< `create`, `copy` o `read`.
+        const char* pointer;    ///< Tipo de puntero.
+        double nsPerOp;
+    };
+
+    /**
+     * @brief Mide todos los casos.
+     * @param iterations Operaciones por caso.
+     * @return Un resultado por caso y tipo de puntero.
+     */
+    static std::vector<Result> measure(unsigned int iterations = kDefaultIterations);
+
+    /**
+     * @brief Mide y escribe `test,pointer,ns` en `csvPath` (y lo muestra en la consola).
+     * @return `S_OK`, o `E_FAIL` si no se pudo escribir el archivo.
+     */
+    static HRESULT run(const std::string& csvPath, unsigned int iterations = kDefaultIterations);
+};
@@ -0,0 +1,148 @@
+﻿/**
+ * @file PostProcess.h
+ * @brief Escena en HDR (`R11G11B10_FLOAT`) y su cadena de post-proceso: bloom,
+ * exposición automática y un único pase final al back buffer.
+ *
+ * @details
+ * Hasta ahora la escena se dibujaba directamente en el back buffer `R8G8B8A8_UNORM`:
+ * todo lo que pasaba de 1 se recortaba. Con `r.hdr` la escena va a un target
+ * transitorio de coma flotante (@ref sceneDesc) y al final del frame:
+ *
+ * 1. **Bloom** (@ref bloom, compute): pirámide de @ref kBloomLevels niveles. Bajando,
+ *    cada grupo carga su bloque de origen en memoria compartida y filtra 4x4 (el primer
+ *    nivel se queda solo con lo que pasa del umbral); subiendo, cada nivel suma el
+ *    grueso con un filtro tienda 3x3, también desde memoria compartida.
+ * 2. **Exposición** (@ref exposure, compute): histograma de log2(luminancia) con
+ *    contadores en memoria compartida por grupo y una reducción en un solo grupo que
+ *    adapta la exposición hacia el gris medio. Se queda en la GPU (sin lecturas a CPU).
+ * 3. **Resolución** (@ref resolve, triángulo a pantalla completa): escena + bloom,
+ *    exposición, curva filmic, gamma y composición de la UI en una sola pasada por el
+ *    back buffer. La UI se dibuja antes en su propio target (@ref interfaceDesc).
+ *
+ * @note Para estudiantes: `R11G11B10_FLOAT` ocupa lo mismo que RGBA8 (32 bits) y guarda
+ * valores muy por encima de 1; a cambio no tiene alfa ni signo, que la escena no usa.
+ * Juntar curva, gamma y UI en un pase ahorra leer y escribir el back buffer dos veces.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "ConstantBufferLayout.h"
+#include "RenderTargetPool.h"
+
+class Device;
+class DeviceContext;
+
+/**
+ * @class PostProcess
+ * @brief Kernels, constantes y buffers persistentes de la cadena HDR.
+ */
+class PostProcess {
+public:
+    PostProcess() = default;
+    ~PostProcess() { destroy(); }
+
+    /// Niveles de la pirámide de bloom (el primero a media resolución).
+    static const unsigned int kBloomLevels = 5;
+    /// Cubetas del histograma de luminancia (debe coincidir con `HISTOGRAM_BINS`).
+    static const unsigned int kHistogramBins = 256;
+    /// Formato de la escena y del bloom.
+    static const DXGI_FORMAT kSceneFormat = DXGI_FORMAT_R11G11B10_FLOAT;
+
+    /// Parámetros que se pueden cambiar cada frame (cvars `r.bloom*`, `r.exposure`...).
+    struct Settings {
+        float bloomThreshold = 1.0f;    ///< Luminancia (tras la escena, antes de exponer) desde la que hay bloom.
+        float bloomKnee = 0.5f;         ///< Ancho de la transición, como fracción del umbral.
+        float bloomIntensity = 0.05f;   ///< Peso de la pirámide al sumarla a la escena.
+        bool autoExposure = true;
+        float exposure = 0.0f;          ///< EV: compensación con automática, exposición fija sin ella.
+        float adaptationSpeed = 1.5f;   ///< Por segundo; cuanto mayor, antes se adapta.
+        float minLogLuminance = -10.0f; ///< Rango del histograma en log2.
+        float maxLogLuminance = 6.0f;
+        float gamma = 2.2f;
+    };
+
+    /**
+     * @brief Crea kernels, shaders del pase final, sampler, histograma y exposición.
+     * @return `S_OK`; `DXGI_ERROR_UNSUPPORTED` por debajo de 11_0 (la escena sigue en LDR).
+     */
+    HRESULT init(Device& device);
+
+    /** @brief Target de la escena (RTV para dibujar, SRV para el post-proceso). */
+    static RenderTargetPool::Desc sceneDesc(unsigned int width, unsigned int height);
+
+    /** @brief Nivel `level` de la pirámide de bloom (escena / 2^(level+1)). */
+    static RenderTargetPool::Desc bloomDesc(unsigned int width, unsigned int height, unsigned int level);
+
+    /** @brief Target de la UI que compone @ref resolve (RGBA8, alfa premultiplicado). */
+    static RenderTargetPool::Desc interfaceDesc(unsigned int width, unsigned int height);
+
+    /** @brief Parámetros para los siguientes pases. */
+    void setSettings(const Settings& settings) { m_settings = settings; }
+    const Settings& getSettings() const { return m_settings; }
+
+    /**
+     * @brief Construye la pirámide de bloom.
+     * @param sceneSRV Escena HDR.
+     * @param down Los @ref kBloomLevels niveles de bajada (@ref bloomDesc).
+     * @param up Los @ref kBloomLevels - 1 de subida; el resultado queda en `up[0]`.
+     * @param width Ancho de la escena.
+     * @param height Alto.
+     */
+    void bloom(DeviceContext& deviceContext, ID3D11ShaderResourceView* sceneSRV,
+        const RenderTargetPool::Target* down, const RenderTargetPool::Target* up,
+        unsigned int width, unsigned int height);
+
+    /**
+     * @brief Histograma de la escena y adaptación de la exposición.
+     * @param deltaTime Segundos desde el frame anterior (velocidad de adaptación).
+     */
+    void exposure(DeviceContext& deviceContext, ID3D11ShaderResourceView* sceneSRV,
+        unsigned int width, unsigned int height, float deltaTime);
+
+    /**
+     * @brief Pase final: escena + bloom, exposición, curva, gamma y UI en `target`.
+     * @param bloomSRV `up[0]` de @ref bloom; nulo = sin bloom.
+     * @param interfaceSRV UI ya dibujada (@ref interfaceDesc); nula = sin UI.
+     * @note Deja enlazado `target` como único render target, sin profundidad.
+     */
+    void resolve(DeviceContext& deviceContext, ID3D11ShaderResourceView* sceneSRV,
+        ID3D11ShaderResourceView* bloomSRV, ID3D11ShaderResourceView* interfaceSRV,
+        ID3D11RenderTargetView* target, unsigned int width, unsigned int height);
+
+    /** @brief Libera kernels, shaders y buffers. */
+    void destroy();
+
+    /** @brief `true` tras un @ref init correcto. */
+    bool isReady() const { return m_pixelShader != nullptr; }
+
+private:
+    /// Constantes de `cbPost` (`CB_SLOT_POST`).
+    struct PostParams {
+        XMFLOAT4 size;      ///< x, y = destino; z, w = origen.
+        XMFLOAT4 bloom;     ///< Umbral, rodilla, intensidad, prefiltro.
+        XMFLOAT4 exposure;  ///< log2 mínimo, rango log2, adaptación, compensación.
+        XMFLOAT4 tone;      ///< 1 / gamma, exposición fija, automática, compone la UI.
+    };
+    /// Layout de `cbPost` (ver `ConstantBufferLayouts`).
+    static const ConstantBufferLayouts::Registration kParamsLayout;
+
+    /// Rellena @ref m_paramsData con @ref m_settings (prefiltro, adaptación y UI a 0).
+    void fillParams(unsigned int dstWidth, unsigned int dstHeight, unsigned int srcWidth, unsigned int srcHeight);
+
+    Settings m_settings;
+    PostParams m_paramsData = {};
+
+    ID3D11ComputeShader* m_downShader = nullptr;
+    ID3D11ComputeShader* m_upShader = nullptr;
+    ID3D11ComputeShader* m_histogramShader = nullptr;
+    ID3D11ComputeShader* m_exposureShader = nullptr;
+    ID3D11VertexShader* m_vertexShader = nullptr;
+    ID3D11PixelShader* m_pixelShader = nullptr;
+    ID3D11SamplerState* m_sampler = nullptr;
+    ID3D11Buffer* m_params = nullptr;
+    ID3D11Buffer* m_histogram = nullptr;              ///< kHistogramBins contadores (raw).
+    ID3D11UnorderedAccessView* m_histogramUAV = nullptr;
+    ID3D11Buffer* m_exposure = nullptr;               ///< [0] exposición, [1] luminancia media (R32_FLOAT).
+    ID3D11ShaderResourceView* m_exposureSRV = nullptr;
+    ID3D11UnorderedAccessView* m_exposureUAV = nullptr;
+};
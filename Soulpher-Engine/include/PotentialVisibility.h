@@ -0,0 +1,192 @@
+﻿/**
+ * @file PotentialVisibility.h
+ * @brief Visibilidad precalculada (PVS) entre celdas del mundo estático y portales que la
+ * recortan en tiempo de ejecución.
+ *
+ * @details
+ * En un interior (salas, pasillos, gradas) casi todo lo que está dentro del frustum
+ * queda detrás de una pared. El culling por frustum no lo sabe y la oclusión en tiempo
+ * real (Hi-Z) lo descubre cada frame con la GPU. Para la geometría estática la respuesta
+ * no cambia, así que "Tools > Bake visibility" la calcula una vez:
+ *
+ * 1. **Celdas**: la caja de los actores estáticos se divide en una rejilla uniforme de
+ *    @ref Settings::cellSize (se agranda hasta no pasar de @ref kMaxCells celdas). Las
+ *    celdas que toca la caja de algún estático son *destinos*.
+ * 2. **Muestreo** (`JobSystem::parallelFor` por celda de cámara, `TriangleBvh` con los
+ *    estáticos opacos): entre una celda de cámara y cada destino se lanzan hasta
+ *    @ref Settings::samples segmentos entre puntos al azar de las dos. Si alguno llega
+ *    sin chocar, el destino es visible. La celda de cámara se muestrea agrandada media
+ *    celda por lado: cubre la cámara pegada al borde, donde el muestreo falla más. Las
+ *    vecinas (y la propia) siempre se ven.
+ * 3. **Portales** (opcionales, `<basePath>.portals`): cajas finas sobre los huecos (puertas,
+ *    arcos). Un segmento libre que cruza portales marca el destino como visible *solo a
+ *    través* de ellos; basta uno que no cruce ninguno para que sea visible sin más.
+ * 4. **Disco**: cada fila (una por celda de cámara) es un bitset de destinos comprimido
+ *    por carreras alternas de ceros y unos (enteros de longitud variable), más la lista
+ *    de destinos que solo se ven por portales. Un índice guarda la huella de la escena.
+ *
+ * En ejecución (@ref update, una vez por frame con la cámara del frame):
+ *
+ * - Se busca la celda de la cámara; fuera de la rejilla no se descarta nada.
+ * - Al cambiar de celda se descomprime su fila y cada estático se clasifica por las
+ *   celdas que toca su caja: oculto, visible o visible por ciertos portales.
+ * - Los que dependen de portales se prueban cada frame contra la pirámide que va de la
+ *   cámara al rectángulo de cada portal abierto (@ref setPortalOpen); un portal cerrado
+ *   los oculta.
+ *
+ * @note Para estudiantes: el muestreo no es conservador (un hueco pequeño puede no
+ * recibir rayos); más muestras o celdas más pequeñas reducen los fallos a cambio de un
+ * horneado más largo. Los actores dinámicos nunca se descartan por el PVS.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "ECS/ActorPool.h"
+
+/**
+ * @class PotentialVisibility
+ * @brief Hornea, guarda y consulta el PVS de la escena estática.
+ */
+class PotentialVisibility {
+public:
+    PotentialVisibility() = default;
+    ~PotentialVisibility() = default;
+    PotentialVisibility(const PotentialVisibility&) = delete;
+    PotentialVisibility& operator=(const PotentialVisibility&) = delete;
+
+    /// Cambia cuando cambia el formato del archivo.
+    static const unsigned int kFormatVersion = 1;
+    /// Celdas como máximo (la fila descomprimida es un bit por celda).
+    static const unsigned int kMaxCells = 32768;
+    /// Portales como máximo (uno por bit de la máscara).
+    static const unsigned int kMaxPortals = 32;
+    /// Índice de celda o de portal que no existe.
+    static const unsigned int kInvalid = 0xFFFFFFFFu;
+
+    /// Tamaño y calidad del horneado.
+    struct Settings {
+        float cellSize = 4.0f;          ///< Lado de la celda (unidades de mundo).
+        unsigned int samples = 64;      ///< Segmentos por par de celdas como máximo.
+        float maxDistance = 0.0f;       ///< Destinos más lejos que esto, ocultos (0 = sin límite).
+    };
+
+    /// Hueco entre zonas que puede abrirse y cerrarse.
+    struct Portal {
+        std::string name;
+        XMFLOAT3 boundsMin = XMFLOAT3(0.0f, 0.0f, 0.0f);
+        XMFLOAT3 boundsMax = XMFLOAT3(0.0f, 0.0f, 0.0f); ///< Caja del hueco (fina en un eje).
+        bool open = true;
+    };
+
+    /**
+     * @brief Hornea el PVS de los estáticos de `actors`, lo escribe y lo carga.
+     * @param basePath Ruta sin extensión: `<basePath>.spvs`; los portales, de `<basePath>.portals`
+     * (una línea por portal: `nombre minX minY minZ maxX maxY maxZ`, `#` comenta).
+     * @return `S_OK`; `S_FALSE` sin estáticos; `E_FAIL` si algún estático opaco no tiene
+     * copia de CPU (opción `-lightmapbake 1`) o no se puede escribir.
+     * @warning Bloquea el hilo que llama hasta terminar (reparte el muestreo en el `JobSystem`).
+     */
+    HRESULT bake(const std::vector<ActorHandle>& actors, const std::string& basePath, const Settings& settings);
+
+    /**
+     * @brief Carga un horneado previo.
+     * @return `S_OK`; `E_FAIL` si no existe; `E_ABORT` si los estáticos cambiaron desde el horneado.
+     */
+    HRESULT load(const std::vector<ActorHandle>& actors, const std::string& basePath);
+
+    /** @brief Olvida el horneado (nada se descarta hasta el siguiente @ref load). */
+    void clear();
+
+    /** @brief `true` con un horneado cargado. */
+    bool isLoaded() const { return !m_rowOffsets.empty(); }
+
+    /**
+     * @brief Clasifica los actores desde la cámara del frame.
+     * @param actors La lista del frame: @ref isHidden usa sus posiciones.
+     * @param portals `false` = los portales no recortan (todos abiertos y sin pirámide).
+     */
+    void update(const std::vector<ActorHandle>& actors, const XMFLOAT3& cameraPosition, bool portals);
+
+    /** @brief `true` si el PVS descarta el actor `index` de la lista del último @ref update. */
+    bool isHidden(unsigned int index) const { return index < m_hidden.size() && m_hidden[index] != 0; }
+
+    /** @brief Actores descartados en el último @ref update. */
+    unsigned int getHiddenCount() const { return m_hiddenCount; }
+
+    /** @brief Celda de la cámara en el último @ref update (@ref kInvalid fuera de la rejilla). */
+    unsigned int getCameraCell() const { return m_cameraCell; }
+
+    unsigned int getCellCount() const { return m_dims[0] * m_dims[1] * m_dims[2]; }
+
+    /** @brief Bytes de las filas comprimidas. */
+    size_t getCompressedSize() const { return m_rows.size(); }
+
+    unsigned int getPortalCount() const { return static_cast<unsigned int>(m_portals.size()); }
+    const Portal& getPortal(unsigned int index) const { return m_portals[index]; }
+
+    /** @brief Índice del portal con ese nombre, o @ref kInvalid. */
+    unsigned int findPortal(const std::string& name) const;
+
+    /** @brief Abre o cierra un portal (puertas): cerrado, lo que solo se ve por él se oculta. */
+    void setPortalOpen(unsigned int index, bool open);
+
+private:
+    /// Estático del horneado: rango de celdas que toca su caja.
+    struct Entry {
+        uint32_t handle = 0;        ///< `ActorHandle::value`.
+        unsigned int cellMin[3] = {};
+        unsigned int cellMax[3] = {};
+    };
+
+    /// Destino que solo se ve por portales.
+    struct PortalCell {
+        uint32_t cell;
+        uint32_t mask;              ///< Bit `p`: visible a través del portal `p`.
+    };
+
+    /// Clasificación de un estático desde la celda actual.
+    enum EntryState : uint8_t {
+        ENTRY_HIDDEN = 0,
+        ENTRY_VISIBLE = 1,
+        ENTRY_PORTAL = 2,           ///< Visible solo por los portales de `m_entryMasks`.
+    };
+
+    /** @brief Celda que contiene `position`, o @ref kInvalid. */
+    unsigned int findCell(const XMFLOAT3& position) const;
+
+    /** @brief Celdas que toca la caja, recortadas a la rejilla. */
+    void getCellRange(const XMFLOAT3& boundsMin, const XMFLOAT3& boundsMax,
+        unsigned int first[3], unsigned int last[3]) const;
+
+    /** @brief Descomprime la fila de `m_cameraCell` y clasifica los estáticos. */
+    void classify();
+
+    /** @brief `true` si la caja se ve desde `cameraPosition` a través del portal. */
+    bool throughPortal(unsigned int portal, const XMFLOAT3& cameraPosition,
+        const XMFLOAT3& boundsMin, const XMFLOAT3& boundsMax) const;
+
+    // Horneado cargado.
+    XMFLOAT3 m_origin = XMFLOAT3(0.0f, 0.0f, 0.0f);
+    float m_cellSize = 1.0f;
+    unsigned int m_dims[3] = {};
+    std::vector<uint32_t> m_rowOffsets;         ///< Inicio de cada fila en `m_rows` (una más al final).
+    std::vector<uint8_t> m_rows;                ///< Carreras de cada fila.
+    std::vector<uint32_t> m_portalOffsets;      ///< Inicio de cada fila en `m_portalCells`.
+    std::vector<PortalCell> m_portalCells;
+    std::vector<Portal> m_portals;
+    std::vector<Entry> m_entries;
+    EU::TMap<uint32_t, unsigned int> m_entryByHandle; ///< `ActorHandle::value` -> entrada.
+
+    // Estado de la celda actual.
+    unsigned int m_cameraCell = kInvalid;
+    std::vector<uint8_t> m_rowBits;             ///< Fila descomprimida (un bit por celda).
+    std::vector<uint32_t> m_cellMasks;          ///< Máscara de portales de cada destino de la fila.
+    std::vector<uint8_t> m_entryStates;         ///< @ref EntryState de cada entrada.
+    std::vector<uint32_t> m_entryMasks;
+
+    // Resultado por actor de la lista del frame.
+    std::vector<uint32_t> m_actorKeys;          ///< `ActorHandle::value` de la lista clasificada.
+    std::vector<unsigned int> m_actorEntries;   ///< Entrada de cada actor (@ref kInvalid = no estático).
+    std::vector<uint8_t> m_hidden;
+    unsigned int m_hiddenCount = 0;
+};
@@ -36,8 +36,14 @@
 // === Librerías de utilidades propias del motor ===
 #include "EngineUtilities\Memory\TSharedPointer.h" ///< Puntero inteligente compartido.
 #include "EngineUtilities\Memory\TWeakPointer.h"   ///< Puntero inteligente débil.
+#include "EngineUtilities\Memory\TIntrusivePointer.h" ///< Puntero con recuento en el objeto.
 #include "EngineUtilities\Memory\TStaticPtr.h"     ///< Puntero estático.
 #include "EngineUtilities\Memory\TUniquePtr.h"     ///< Puntero inteligente único.
+#include "EngineUtilities\Structures\TMap.h"     ///< Mapa hash (direccionamiento abierto).
+#include "EngineUtilities\Structures\TSet.h"     ///< Conjunto hash.
+#include "EngineUtilities\Structures\TBitSet.h"  ///< Conjunto de ids densos (un bit por id).
+#include "EngineUtilities\Utilities\Hash.h"     ///< FNV-1a incremental de las claves de caché.
+#include "Logger.h"                              ///< Log asíncrono de `MESSAGE` y `ERROR`.
 
 // === Macros de utilidad ===
 
@@ -50,25 +56,25 @@
 #define SAFE_RELEASE(x) if(x != nullptr) x->Release(); x = nullptr;
 
  /**
-  * @brief Muestra un mensaje de creación de recurso en el depurador.
+  * @brief Registra un mensaje de creación de recurso (depurador, `-log` y ventana "Output").
   * @param classObj Nombre de la clase que crea el recurso.
   * @param method Nombre del método.
   * @param state Estado o descripción del recurso creado.
+  *
+  * @note Nivel `LOG_LEVEL_INFO`: en Release (`LOG_MIN_LEVEL` = warning) no se compila.
+  * Se formatea en un buffer fijo y sale en el hilo del log (@ref Logger).
   */
 #define MESSAGE(classObj, method, state) \
-{ std::wostringstream os_; os_ << classObj << "::" << method << " : [CREATION OF RESOURCE : " << state << "]\n"; \
-  OutputDebugStringW(os_.str().c_str()); }
+LOG(LOG_LEVEL_INFO, classObj, classObj << "::" << method << " : [CREATION OF RESOURCE : " << state << "]")
 
   /**
-   * @brief Muestra un mensaje de error en el depurador.
+   * @brief Registra un mensaje de error; despierta al hilo del log sin esperar al intervalo.
    * @param classObj Nombre de la clase que genera el error.
    * @param method Nombre del método.
    * @param errorMSG Mensaje descriptivo del error.
    */
 #define ERROR(classObj, method, errorMSG) \
-{ try { std::wostringstream os_; os_ << L"ERROR : " << classObj << L"::" << method << L" : " << errorMSG << L"\n"; \
-  OutputDebugStringW(os_.str().c_str()); } \
-  catch (...) { OutputDebugStringW(L"Failed to log error message.\n"); } }
+LOG(LOG_LEVEL_ERROR, classObj, "ERROR : " << classObj << "::" << method << " : " << errorMSG)
 
    // === Estructuras comunes ===
 
@@ -80,17 +86,87 @@
 	*/
 struct SimpleVertex { XMFLOAT3 Pos; XMFLOAT2 Tex; };
 
+   /**
+	* @struct SkinVertex
+	* @brief Influencias de hueso de un vértice (stream paralelo a `SimpleVertex`).
+	*
+	* @note Hasta 4 huesos por vértice; los pesos en UNORM8 suman 255 y los índices son
+	* de `Skeleton` (8 bits, por eso `Skeleton::kMaxJoints` es 256).
+	*/
+struct SkinVertex { unsigned char Bones[4]; unsigned char Weights[4]; };
+
+   /**
+	* @struct MorphTarget
+	* @brief Blend shape de una submalla: desplazamiento de la posición solo de los vértices que mueve.
+	*
+	* @note Disperso a propósito: una expresión de la cara mueve unos cientos de vértices de
+	* decenas de miles, así que se guarda (y se evalúa en `SkinningSystem`) solo esa parte.
+	*/
+struct MorphTarget {
+    std::string name;                   ///< Canal del `FbxBlendShape` (el nombre que se anima).
+    std::vector<unsigned int> vertices; ///< Índices en `m_vertex`, crecientes.
+    std::vector<XMFLOAT3> deltas;       ///< Paralelo a `vertices`: desplazamiento con peso 1.
+};
+
+// === Constant buffers por frecuencia de actualización ===
+//
+//  Slot | Struct              | Frecuencia  | Quién lo sube
+//  -----+---------------------+-------------+------------------------------------------
+//  b0   | CBNeverChanges      | por vista   | BaseApp, solo si la cámara se movió
+//  b1   | CBChangeOnResize    | por resize  | BaseApp, solo si cambió la proyección
+//  b2   | CBChangesEveryFrame | por objeto  | RenderQueue (anillo dinámico) / Actor (camino directo)
+//  b3   | CBShadow            | por cascada | ShadowMap, solo cuando se redibuja alguna cascada
+//  b4   | CBMaterial          | por material| MaterialLibrary, una vez al crearlo (inmutable)
+//  b5   | cbClusters          | por frame   | ClusteredLighting, en el pase de culling de luces
+//  b6   | cbPost              | por dispatch| PostProcess, en cada nivel de bloom y en el pase final
+//  b7   | cbOcclusion         | por frame   | AmbientOcclusion, en el pase "SSAO"
+//  b8   | cbTemporal          | por frame   | TemporalAA, en el pase "TAA"
+//  b9   | CBLightmap          | por actor   | Actor, al asignarle su rectángulo del atlas (inmutable)
+//  b10  | cbReflectionProbes  | por sonda   | ReflectionProbes, al completar o cargar una sonda
+//       | cbPrefilter         | por mip     | ReflectionProbes, en su compute de prefiltrado
+//  b11  | cbParticles         | por dispatch| GpuParticles, en emisión, simulación, orden y dibujo
+//  b12  | cbDeadCount         | por emisor  | GpuParticles, con `CopyStructureCount` (lo escribe la GPU)
+//  b13  | cbAliveCount        | por frame   | GpuParticles, con `CopyStructureCount` (lo escribe la GPU)
+//
+// El color de malla viaja con el objeto en b2 (y en el stream de instancias) para
+// mantener el layout que esperan los .fx del motor; el del material (b4) lo multiplica. Los buffers con frecuencia
+// baja usan `TConstantBuffer` (ConstantBuffer.h), que no sube nada si el
+// contenido no cambió. Cada struct de la tabla declara su layout en
+// `ConstantBufferLayout.cpp` (o en su pase) y `ShaderLibrary` lo compara con el
+// `cbuffer` de cada shader al cargarlo.
+
+/**
+ * @enum ConstantBufferSlot
+ * @brief Registros `b#` de cada constant buffer (ver tabla anterior).
+ */
+enum ConstantBufferSlot {
+    CB_SLOT_VIEW = 0,       ///< CBNeverChanges.
+    CB_SLOT_PROJECTION = 1, ///< CBChangeOnResize.
+    CB_SLOT_OBJECT = 2,     ///< CBChangesEveryFrame.
+    CB_SLOT_SHADOW = 3,     ///< CBShadow.
+    CB_SLOT_MATERIAL = 4,   ///< CBMaterial.
+    CB_SLOT_CLUSTERS = 5,   ///< Rejilla de luces (`ClusteredLighting`).
+    CB_SLOT_POST = 6,       ///< Bloom, exposición y pase final (`PostProcess`).
+    CB_SLOT_OCCLUSION = 7,  ///< SSAO a media resolución (`AmbientOcclusion`).
+    CB_SLOT_TEMPORAL = 8,   ///< Antialiasing temporal (`TemporalAA`).
+    CB_SLOT_LIGHTMAP = 9,   ///< Rectángulo del actor en el atlas de lightmaps (`LightmapBaker`).
+    CB_SLOT_PROBES = 10,    ///< Esferas de las sondas de reflexión y prefiltrado (`ReflectionProbes`).
+    CB_SLOT_PARTICLES = 11, ///< Emisor, paso de simulación, orden y cámara (`GpuParticles`).
+    CB_SLOT_DEAD_COUNT = 12,  ///< Huecos libres de la lista de partículas muertas (`GpuParticles`).
+    CB_SLOT_ALIVE_COUNT = 13  ///< Partículas vivas (`GpuParticles`).
+};
+
 /**
  * @struct CBNeverChanges
- * @brief Buffer constante con la matriz de vista.
+ * @brief Buffer constante con la matriz de vista (slot b0, frecuencia por vista).
  *
- * @note "NeverChanges" implica que este buffer se actualiza muy rara vez (p.ej., cámara fija).
+ * @note El nombre es histórico: se sube cuando la cámara cambia, no nunca.
  */
 struct CBNeverChanges { XMMATRIX mView; };
 
 /**
  * @struct CBChangeOnResize
- * @brief Buffer constante con la matriz de proyección.
+ * @brief Buffer constante con la matriz de proyección (slot b1).
  *
  * @note Se actualiza al cambiar el tamaño de la ventana.
  */
@@ -98,28 +174,66 @@ struct CBChangeOnResize { XMMATRIX mProjection; };
 
 /**
  * @struct CBChangesEveryFrame
- * @brief Buffer constante con matriz de mundo y color de malla.
+ * @brief Buffer constante con matriz de mundo y color de malla (slot b2, por objeto).
  *
- * @note Este se actualiza cada frame, por ejemplo, para animar objetos.
+ * @note Varía por draw; no lleva dirty tracking porque cada objeto escribe el suyo.
  */
 struct CBChangesEveryFrame { XMMATRIX mWorld; XMFLOAT4 vMeshColor; };
 
+/**
+ * @struct CBShadow
+ * @brief Buffer constante de las cascadas de sombra para los receptores (slot b3, VS+PS).
+ *
+ * @note
+ * - `mLightViewProj[i]`: matriz con la que se dibujó la cascada `i` (ShadowMap::kCascadeCount).
+ * - `vCascadeSplits`: profundidad en vista donde termina cada cascada.
+ * - `vShadowParams` = (1 / tamaño de cascada, sesgo de profundidad, intensidad, 0).
+ */
+struct CBShadow { XMMATRIX mLightViewProj[4]; XMFLOAT4 vCascadeSplits; XMFLOAT4 vShadowParams; };
+
+/**
+ * @struct CBMaterial
+ * @brief Constantes de un material (slot b4, PS).
+ *
+ * @note
+ * - Inmutable: los materiales con los mismos valores comparten el buffer (ver `MaterialLibrary`).
+ * - `vMaterialParams` = (umbral de alpha test, rugosidad, 0, 0); el umbral solo lo leen las
+ *   permutaciones `ALPHA_TEST` y la rugosidad solo se usa al escribir el G-buffer.
+ */
+struct CBMaterial { XMFLOAT4 vDiffuseColor; XMFLOAT4 vMaterialParams; };
+
+/**
+ * @struct CBLightmap
+ * @brief Dónde está el actor en su página de lightmaps (slot b9, VS).
+ *
+ * @note `vLightmapScaleOffset` = (escala u, escala v, desplazamiento u, desplazamiento v):
+ * lleva las UV2 de la malla (0..1) a su rectángulo del atlas.
+ */
+struct CBLightmap { XMFLOAT4 vLightmapScaleOffset; };
+
 // === Enumeraciones ===
 
 /**
  * @enum ExtensionType
  * @brief Tipos de extensión de texturas soportadas por el motor.
  */
-enum ExtensionType { DDS = 0, PNG = 1, JPG = 2 };
+enum ExtensionType { DDS = 0, PNG = 1, JPG = 2, TGA = 3, HDR = 4 };
 
 /**
  * @enum ShaderType
- * @brief Tipos de shader soportados.
+ * @brief Etapas de shader soportadas.
+ * @note Hull y domain solo existen en SM5 (feature level 11_0).
  */
-enum ShaderType { VERTEX_SHADER = 0, PIXEL_SHADER = 1 };
+enum ShaderType {
+    VERTEX_SHADER = 0, PIXEL_SHADER = 1, COMPUTE_SHADER = 2,
+    GEOMETRY_SHADER = 3, HULL_SHADER = 4, DOMAIN_SHADER = 5
+};
 
 /**
  * @enum ComponentType
  * @brief Tipos de componentes en el sistema ECS.
+ *
+ * @note También es el índice del componente en la tabla de cada `Entity`: cada clase
+ * de componente declara el suyo en `static const ComponentType kType`.
  */
-enum ComponentType { NONE = 0, TRANSFORM = 1, MESH = 2, MATERIAL = 3 };
+enum ComponentType { NONE = 0, TRANSFORM = 1, MESH = 2, MATERIAL = 3, CAMERA = 4, COMPONENT_TYPE_COUNT = 5 };
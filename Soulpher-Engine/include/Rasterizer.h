@@ -36,14 +36,19 @@ public:
     /**
      * @brief Inicializa el estado de rasterización.
      * @param device Dispositivo Direct3D donde se creará el estado.
+     * @param depthBias Sesgo de profundidad constante (unidades del formato del depth buffer).
+     * @param slopeScaledDepthBias Sesgo proporcional a la pendiente del triángulo.
+     * @param cullMode Caras que se descartan (`D3D11_CULL_NONE` para materiales de dos caras).
      * @return HRESULT que indica éxito o error de la operación.
      *
      * @note Aquí es donde defines el `D3D11_RASTERIZER_DESC` con parámetros como:
      *  - `FillMode` → D3D11_FILL_SOLID o D3D11_FILL_WIREFRAME.
      *  - `CullMode` → D3D11_CULL_BACK, D3D11_CULL_FRONT o D3D11_CULL_NONE.
      *  - `FrontCounterClockwise` → Orientación de las caras.
+     *  - `DepthBias` / `SlopeScaledDepthBias` → evitan el *shadow acne* al dibujar shadow maps.
      */
-    HRESULT init(Device device);
+    HRESULT init(Device& device, int depthBias = 0, float slopeScaledDepthBias = 0.0f,
+        D3D11_CULL_MODE cullMode = D3D11_CULL_BACK);
 
     /**
      * @brief Actualiza parámetros internos si es necesario.
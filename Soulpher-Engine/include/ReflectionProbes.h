@@ -0,0 +1,203 @@
+﻿/**
+ * @file ReflectionProbes.h
+ * @brief Sondas de reflexión: cubemaps de la escena capturados por partes, prefiltrados
+ * por rugosidad y, los estáticos, guardados en disco.
+ *
+ * @details
+ * Sin sondas, el único término especular es el de las luces; el cielo y los objetos
+ * vecinos no se reflejan. Cada sonda es un punto con una esfera de influencia:
+ *
+ * 1. **Captura por partes** (@ref schedule, @ref beginFace, @ref endFace): cada frame se
+ *    dibujan como mucho `faceBudget` caras de 128x128 (`r.probeFacesPerFrame`) en un
+ *    cubo de captura, con los mismos shaders de la escena, las cascadas de sombra y
+ *    todas las luces locales (`ClusteredLighting::bindCapture`). Una sonda se termina
+ *    antes de empezar otra; las dinámicas se recapturan en bucle.
+ * 2. **Prefiltrado** (al terminar la sexta cara, `ReflectionProbe.fx`): `GenerateMips`
+ *    del cubo de captura y, por cada mip del array de sondas, un compute shader que
+ *    integra la distribución GGX de la rugosidad de ese mip (mip 0 = espejo, último =
+ *    rugosidad 1). El sombreado elige el mip por la rugosidad del píxel
+ *    (`ReflectionProbes.fxh`).
+ * 3. **Caché** (solo estáticas, @ref setCachePath): las sondas estáticas dibujan solo los
+ *    actores estáticos; al terminar se leen a CPU sin esperar (staging) y se escriben
+ *    como DDS de cubo en coma flotante, con un nombre que sale de la huella de la escena
+ *    (@ref setSceneHash) y de la sonda. La siguiente ejecución las carga sin capturar.
+ *
+ * @note Para estudiantes: repartir la captura en frames cambia latencia por coste fijo:
+ * una cara por frame son 6 frames por sonda, y el frame nunca paga las seis a la vez.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "ConstantBuffer.h"
+#include <vector>
+
+class Device;
+class DeviceContext;
+
+/**
+ * @class ReflectionProbes
+ * @brief Sondas de la escena, su array de cubos prefiltrados y el reparto de capturas.
+ */
+class ReflectionProbes {
+public:
+    ReflectionProbes() = default;
+    ~ReflectionProbes() { destroy(); }
+    ReflectionProbes(const ReflectionProbes&) = delete;
+    ReflectionProbes& operator=(const ReflectionProbes&) = delete;
+
+    /// Sondas como mucho (deben coincidir con `PROBE_MAX` de `ReflectionProbes.fxh`).
+    static const unsigned int kMaxProbes = 8;
+    /// Lado de cada cara en el mip 0.
+    static const unsigned int kFaceSize = 128;
+    /// Mips de cada cubo (el último, de rugosidad 1, mide `kFaceSize >> (kMipCount - 1)`).
+    static const unsigned int kMipCount = 6;
+    /// Formato de captura, del array y de la caché.
+    static const DXGI_FORMAT kFormat = DXGI_FORMAT_R16G16B16A16_FLOAT;
+    /// Cambia cuando cambia lo que se guarda: invalida las cachés viejas.
+    static const unsigned int kFormatVersion = 1;
+    /// Planos de la proyección de las caras.
+    static constexpr float kNearZ = 0.1f;
+    static constexpr float kFarZ = 500.0f;
+
+    /// Una sonda y su estado.
+    struct Probe {
+        XMFLOAT3 position = XMFLOAT3(0.0f, 0.0f, 0.0f);
+        float radius = 1.0f;       ///< Esfera de influencia (gana la más pequeña que contiene el punto).
+        bool isStatic = false;     ///< Solo actores estáticos; se captura una vez y se guarda.
+        bool ready = false;        ///< Su cubo tiene contenido (se usa al sombrear).
+        bool dirty = true;         ///< Hay que capturarla (las dinámicas, siempre).
+        bool cacheTried = false;   ///< Ya se buscó en la caché con la huella actual.
+    };
+
+    /// Cara que hay que dibujar este frame.
+    struct Face {
+        unsigned int probe = 0;
+        unsigned int face = 0;     ///< 0..5 = +X, -X, +Y, -Y, +Z, -Z.
+    };
+
+    /**
+     * @brief Crea el cubo de captura, el array de sondas, el kernel y los buffers.
+     * @return `S_OK`; `DXGI_ERROR_UNSUPPORTED` por debajo de 11_0 (arrays de cubos y UAV).
+     */
+    HRESULT init(Device& device);
+
+    /**
+     * @brief Añade una sonda.
+     * @return Su índice, o -1 si ya hay @ref kMaxProbes o el radio no es positivo.
+     */
+    int add(const XMFLOAT3& position, float radius, bool isStatic);
+
+    /** @brief Quita todas las sondas. */
+    void clear();
+
+    /** @brief Carpeta de la caché de sondas estáticas (vacía = sin caché). */
+    void setCachePath(const std::string& directory) { m_cachePath = directory; }
+
+    /**
+     * @brief Huella de lo que ven las sondas estáticas (actores estáticos, sol...). Si
+     * cambia, se buscan en la caché con la nueva y, si no están, se recapturan.
+     */
+    void setSceneHash(uint64_t hash);
+
+    /** @brief Con `false` los shaders no leen ninguna sonda (y no hay que capturar). */
+    void setEnabled(DeviceContext& deviceContext, bool enabled);
+
+    /** @brief Recaptura todas las sondas (las estáticas, sin mirar la caché). */
+    void invalidate();
+
+    /**
+     * @brief Termina las lecturas pendientes, carga las estáticas de la caché y elige
+     * las caras del frame.
+     * @param faceBudget Caras como mucho.
+     * @param allowStatic `false` para no capturar estáticas (p. ej. con texturas aún
+     * cargándose: se guardaría el placeholder).
+     * @param faces Recibe las caras, en orden de dibujo.
+     */
+    void schedule(DeviceContext& deviceContext, unsigned int faceBudget, bool allowStatic, std::vector<Face>& faces);
+
+    /** @brief Sonda `index` (válido hasta @ref getProbeCount). */
+    const Probe& getProbe(unsigned int index) const { return m_probes[index]; }
+
+    /** @brief Sondas añadidas. */
+    unsigned int getProbeCount() const { return static_cast<unsigned int>(m_probes.size()); }
+
+    /** @brief Vista de una cara (LH, ejes de las caras de D3D). */
+    XMMATRIX getFaceView(const Face& face) const;
+
+    /** @brief Proyección de las caras: 90 grados, cuadrada. */
+    static XMMATRIX getFaceProjection();
+
+    /**
+     * @brief Enlaza la cara como render target con su profundidad, viewport y cámara
+     * (b0, b1) y la limpia.
+     * @note Los recursos de sombreado (sombras, luces) los enlaza quien dibuja.
+     */
+    void beginFace(DeviceContext& deviceContext, const Face& face, const float clearColor[4]);
+
+    /**
+     * @brief Tras la sexta cara de una sonda: prefiltra al array y, si es estática,
+     * empieza su lectura para la caché. Desenlaza el render target.
+     */
+    void endFace(DeviceContext& deviceContext, const Face& face);
+
+    /** @brief Enlaza el array (t8), las esferas (b10) y el muestreador (s2) en PS y CS. */
+    void bind(DeviceContext& deviceContext);
+
+    /** @brief Libera los recursos de GPU (las sondas se conservan). */
+    void destroy();
+
+    /** @brief `true` tras un @ref init correcto. */
+    bool isReady() const { return m_prefilterShader != nullptr; }
+
+private:
+    /// Constantes de `cbReflectionProbes` (`CB_SLOT_PROBES`).
+    struct ProbeParams {
+        XMFLOAT4 spheres[kMaxProbes];   ///< xyz = centro, w = radio (0 sin contenido).
+        XMFLOAT4 info;                  ///< x = sondas, y = último mip, z = intensidad.
+    };
+
+    /// Constantes de `cbPrefilter` (`ReflectionProbe.fx`, también en b10).
+    struct PrefilterParams {
+        XMFLOAT4 params;                ///< x = rugosidad, y = lado del mip, z = primer slice, w = lado del cubo.
+    };
+
+    /// Sube las esferas de las sondas con contenido.
+    void uploadParams(DeviceContext& deviceContext);
+
+    /// Ruta de la caché de una sonda con la huella actual.
+    std::string getCacheFile(unsigned int index) const;
+
+    /// Copia un DDS de la caché al array. `false` si no existe o no encaja.
+    bool loadCached(DeviceContext& deviceContext, unsigned int index);
+
+    /// Escribe la lectura pendiente si ya llegó. `false` mientras siga en vuelo.
+    bool finishReadback(DeviceContext& deviceContext);
+
+    std::vector<Probe> m_probes;
+    std::string m_cachePath;
+    uint64_t m_sceneHash = 0;
+    int m_current = -1;                 ///< Sonda a medio capturar.
+    unsigned int m_nextFace = 0;        ///< Siguiente cara de @ref m_current.
+    unsigned int m_nextDynamic = 0;     ///< Turno de las sondas dinámicas.
+    int m_readbackProbe = -1;           ///< Sonda estática en @ref m_staging.
+    ProbeParams m_paramsData = {};
+    bool m_paramsDirty = false;         ///< Sondas añadidas o quitadas desde la última subida.
+    bool m_enabled = true;
+
+    Device* m_device = nullptr;
+    ID3D11Texture2D* m_captureTexture = nullptr;        ///< Cubo de captura (mips para el prefiltrado).
+    ID3D11ShaderResourceView* m_captureSRV = nullptr;
+    ID3D11RenderTargetView* m_captureRTV[6] = {};       ///< Mip 0 de cada cara.
+    ID3D11Texture2D* m_depthTexture = nullptr;
+    ID3D11DepthStencilView* m_depthView = nullptr;
+    ID3D11Texture2D* m_probeTexture = nullptr;          ///< `kMaxProbes` cubos (6 slices cada uno).
+    ID3D11ShaderResourceView* m_probeSRV = nullptr;     ///< TextureCubeArray (t8).
+    ID3D11UnorderedAccessView* m_probeUAV[kMipCount] = {}; ///< Un mip de todos los slices.
+    ID3D11Texture2D* m_staging = nullptr;               ///< Un cubo con sus mips, para la caché.
+    ID3D11ComputeShader* m_prefilterShader = nullptr;
+    ID3D11Buffer* m_params = nullptr;                   ///< `ProbeParams`.
+    ID3D11Buffer* m_prefilterParams = nullptr;          ///< `PrefilterParams`.
+    ID3D11SamplerState* m_sampler = nullptr;            ///< Trilineal, clamp.
+    TConstantBuffer<CBNeverChanges> m_faceView;         ///< Vista de la cara (b0).
+    TConstantBuffer<CBChangeOnResize> m_faceProjection; ///< Proyección de las caras (b1).
+};
@@ -0,0 +1,207 @@
+﻿/**
+ * @file RemoteStream.h
+ * @brief Salida del frame por red: codificación H.264/HEVC en la GPU, paquetes UDP y
+ * entrada remota de vuelta.
+ *
+ * @details
+ * Para instalaciones que se ven desde otra máquina. El camino del frame no pasa por la
+ * CPU (a diferencia de @ref FrameCapture, que lee a memoria para escribir archivos):
+ *
+ * 1. @ref RemoteStream::submit, al final del frame, copia la imagen en la GPU y la
+ *    convierte a NV12 (`StreamConvert.fx`) en una de @ref RemoteStream::kSlots texturas,
+ *    escalándola al tamaño del stream.
+ * 2. Esa textura va tal cual (`MFCreateDXGISurfaceBuffer`) al codificador de hardware
+ *    de Media Foundation (NVENC, AMF o Quick Sync detrás de su MFT asíncrono), que
+ *    comparte el dispositivo por un `IMFDXGIDeviceManager`. Modo de baja latencia, CBR,
+ *    sin frames B.
+ * 3. Un hilo recoge cada frame codificado y lo manda por UDP en trozos de como mucho
+ *    @ref RemoteStream::kMaxPayload bytes con una cabecera @ref RemoteStream::PacketHeader.
+ *    El cliente los junta por `frame` y pasa los NAL (Annex B) a su decodificador.
+ *
+ * **Latencia**: si el codificador aún no pidió otro frame, el de ahora se descarta en
+ * vez de encolarse: un frame viejo en cola es latencia pura. Se mide el tiempo desde
+ * @ref RemoteStream::submit hasta el envío del último trozo (la parte de "cristal a
+ * cristal" que pasa en esta máquina).
+ *
+ * **Entrada**: el cliente manda al mismo puerto paquetes @ref RemoteStream::InputPacket
+ * (ratón, botones, rueda, teclas), que @ref RemoteStream::receiveInput mete en el
+ * @ref InputSystem antes del muestreo del frame. El primer paquete de un cliente nuevo
+ * fija el destino del vídeo y pide un frame clave.
+ *
+ * @note Para estudiantes: el dispositivo pasa a ser "multithread protected" (el MFT usa
+ * el contexto inmediato desde sus hilos); cada llamada al contexto toma un cerrojo, por
+ * eso solo se activa con `-remote`. WebRTC (SRTP, ICE, control de congestión) queda
+ * fuera: aquí es UDP en red local, sin retransmisiones.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include <atomic>
+#include <mutex>
+
+class Device;
+class DeviceContext;
+class Texture;
+class InputSystem;
+struct IMFTransform;
+struct IMFMediaEventGenerator;
+struct IMFDXGIDeviceManager;
+struct ICodecAPI;
+
+/**
+ * @enum StreamCodec
+ * @brief Códec del stream.
+ */
+enum StreamCodec {
+    STREAM_CODEC_H264 = 0,
+    STREAM_CODEC_HEVC = 1
+};
+
+/**
+ * @class RemoteStream
+ * @brief Codificador de hardware alimentado desde la GPU y transporte UDP.
+ */
+class RemoteStream {
+public:
+    RemoteStream() = default;
+    ~RemoteStream() { destroy(); }
+    RemoteStream(const RemoteStream&) = delete;
+    RemoteStream& operator=(const RemoteStream&) = delete;
+
+    /// Texturas NV12 que pueden estar en el codificador a la vez.
+    static const unsigned int kSlots = 4;
+    /// Bytes de vídeo por datagrama (cabecera aparte; cabe en una MTU de 1500).
+    static const unsigned int kMaxPayload = 1200;
+
+    /// Parámetros del stream.
+    struct Settings {
+        std::string host;               ///< Destino inicial (vacío = el primer cliente que escriba).
+        unsigned short port = 9000;     ///< Puerto de destino y de escucha de la entrada.
+        unsigned int width = 1920;      ///< Tamaño codificado (pares).
+        unsigned int height = 1080;
+        unsigned int fps = 60;
+        unsigned int bitrate = 12000000; ///< Bits por segundo (CBR).
+        StreamCodec codec = STREAM_CODEC_H264;
+    };
+
+    /// Cabecera de cada datagrama de vídeo (little-endian).
+    struct PacketHeader {
+        uint32_t frame;                 ///< Número de frame codificado.
+        uint16_t fragment;              ///< Índice del trozo dentro del frame.
+        uint16_t fragmentCount;         ///< Trozos del frame.
+        uint8_t keyframe;               ///< 1 si el frame es clave (IDR).
+        uint8_t reserved[3];
+    };
+
+    /// Paquete de entrada del cliente (little-endian).
+    struct InputPacket {
+        enum Type : uint8_t {
+            HELLO = 0,      ///< Cliente nuevo: fija el destino y pide un frame clave.
+            MOUSE_MOVE,     ///< `x`, `y`: desplazamiento.
+            MOUSE_BUTTON,   ///< `code`: `InputSystem::MouseButton`; `down`.
+            WHEEL,          ///< `x`: muescas * 120.
+            KEY,            ///< `code`: tecla virtual; `down`.
+            KEYFRAME        ///< El cliente perdió paquetes: pide un frame clave.
+        };
+        uint8_t type;
+        uint8_t code;
+        uint8_t down;
+        uint8_t reserved;
+        int16_t x;
+        int16_t y;
+    };
+
+    /// Contadores del stream.
+    struct Stats {
+        unsigned long long submitted = 0;   ///< Frames entregados al codificador.
+        unsigned long long dropped = 0;     ///< Frames descartados (codificador ocupado).
+        unsigned long long sent = 0;        ///< Frames codificados y enviados.
+        unsigned long long bytes = 0;       ///< Bytes de vídeo enviados.
+        double averageLatencyMs = 0.0;      ///< `submit` -> último trozo enviado (media móvil).
+        double maxLatencyMs = 0.0;          ///< Máximo desde el último @ref getStats.
+    };
+
+    /**
+     * @brief Busca un codificador de hardware, lo configura y abre el socket.
+     * @return `MF_E_TOPO_CODEC_NOT_FOUND` sin codificador de hardware para el códec,
+     * `E_INVALIDARG` con un tamaño impar o nulo, o el error de Media Foundation/Winsock.
+     */
+    HRESULT init(Device& device, const Settings& settings);
+
+    /**
+     * @brief Convierte y entrega el frame (hilo de render, tras el último pase).
+     * @param source Imagen del frame (back buffer o target del panel), de cualquier tamaño.
+     */
+    void submit(DeviceContext& deviceContext, Texture& source);
+
+    /** @brief Lee los paquetes de entrada pendientes y los pasa a `input` (hilo principal). */
+    void receiveInput(InputSystem& input);
+
+    /** @brief Vacía el codificador, para el hilo y cierra el socket. */
+    void destroy();
+
+    /** @brief `true` entre @ref init y @ref destroy. */
+    bool isRunning() const { return m_encoder != nullptr; }
+
+    /** @brief Copia de los contadores; reinicia `maxLatencyMs`. */
+    Stats getStats();
+
+private:
+    /// Textura NV12 con sus vistas por plano.
+    struct Slot {
+        ID3D11Texture2D* texture = nullptr;
+        ID3D11RenderTargetView* luma = nullptr;     ///< R8, tamaño completo.
+        ID3D11RenderTargetView* chroma = nullptr;   ///< R8G8, mitad de ancho y alto.
+    };
+
+    HRESULT createEncoder(Device& device);
+    HRESULT createConversion(Device& device);
+    HRESULT openSocket();
+    /// Copia intermedia con SRV del tamaño de la imagen (el back buffer no se puede leer).
+    HRESULT ensureSourceCopy(ID3D11Texture2D* source);
+    /// Hilo de eventos del MFT: peticiones de entrada y frames codificados.
+    void eventLoop();
+    /// Saca un frame del codificador y lo envía.
+    void drainOutput();
+    void sendFrame(const BYTE* data, DWORD size, bool keyframe, LONGLONG sampleTime);
+    void setCodecValue(const GUID& property, unsigned long value);
+
+    Settings m_settings;
+    ID3D11Device* m_device = nullptr;
+    IMFTransform* m_encoder = nullptr;
+    IMFMediaEventGenerator* m_events = nullptr;
+    IMFDXGIDeviceManager* m_deviceManager = nullptr;
+    ICodecAPI* m_codecApi = nullptr;
+    UINT m_resetToken = 0;
+    DWORD m_inputStreamId = 0;
+    DWORD m_outputStreamId = 0;
+    bool m_mediaFoundation = false;
+    bool m_providesSamples = true;          ///< El MFT crea sus muestras de salida.
+    DWORD m_outputBufferSize = 0;
+
+    Slot m_slots[kSlots];
+    unsigned int m_nextSlot = 0;
+    ID3D11Texture2D* m_sourceCopy = nullptr;
+    ID3D11ShaderResourceView* m_sourceSRV = nullptr;
+    ID3D11VertexShader* m_vertexShader = nullptr;
+    ID3D11PixelShader* m_lumaShader = nullptr;
+    ID3D11PixelShader* m_chromaShader = nullptr;
+    ID3D11SamplerState* m_sampler = nullptr;
+
+    unsigned long long m_socket = ~0ull;    ///< `SOCKET` (INVALID_SOCKET sin abrir).
+    bool m_winsock = false;
+    std::mutex m_destinationMutex;
+    unsigned char m_destination[16] = {};   ///< `sockaddr_in` del cliente (solo IPv4).
+    int m_destinationSize = 0;              ///< 0 = sin cliente todavía.
+
+    std::thread m_thread;
+    std::atomic<int> m_inputRequests{ 0 };  ///< `METransformNeedInput` sin atender.
+    std::atomic<bool> m_keyframeRequested{ false };
+    unsigned long long m_frameIndex = 0;    ///< Frames entregados (tiempo de muestra).
+    uint32_t m_sentFrames = 0;
+    LONGLONG m_submitTicks[64] = {};        ///< QPC de cada `submit`, por frame % 64.
+    double m_ticksToMs = 0.0;
+
+    std::mutex m_statsMutex;
+    Stats m_stats;
+};
@@ -0,0 +1,194 @@
+﻿/**
+ * @file RenderGraph.h
+ * @brief Grafo de render: pases que declaran lo que leen y escriben, ordenados y con
+ * texturas intermedias sacadas de un pool.
+ *
+ * @details
+ * Cada frame se describe de nuevo (es barato: unos pocos pases):
+ *
+ * 1. **Declarar**: @ref RenderGraph::importTexture para lo que vive fuera del frame
+ *    (back buffer, shadow map, pirámide Hi-Z) y @ref RenderGraph::addPass para cada
+ *    pase. En su `setup` el pase crea las texturas transitorias que escribe
+ *    (@ref RenderGraph::PassBuilder::create) y declara lo que lee y escribe.
+ * 2. **Compilar** (@ref RenderGraph::compile):
+ *    - *Descarte*: un pase sobrevive si tiene efectos fuera del grafo
+ *      (@ref RenderGraph::PassBuilder::sideEffect), escribe algo importado o escribe
+ *      algo que lee un pase que sobrevive. Lo demás no se ejecuta ni reserva memoria.
+ *    - *Orden*: cada lectura depende de la última escritura anterior del recurso y
+ *      cada escritura de las lecturas y la escritura anteriores. Los pases salen en
+ *      orden topológico; entre los listos, el que se declaró antes.
+ *    - *Memoria*: cada transitoria vive del primer al último pase que la usa. Al
+ *      terminar, su textura queda libre y la siguiente transitoria con la misma
+ *      descripción reutiliza la misma memoria. Las texturas salen de un
+ *      @ref RenderTargetPool y vuelven a él al acabar @ref RenderGraph::execute.
+ * 3. **Ejecutar** (@ref RenderGraph::execute): cada pase recibe el contexto y el grafo
+ *    para pedir las vistas de sus recursos (@ref RenderGraph::getTexture).
+ *
+ * En D3D11 no hay heaps: "aliasing" aquí es compartir la textura física entre
+ * transitorias de igual formato y tamaño cuyas vidas no se solapan. El pool dura entre
+ * frames, así que en régimen estable no se crea nada.
+ *
+ * @note Para estudiantes: el contenido de una transitoria no está definido al crearla
+ * (puede venir de otra): el primer pase que la escribe la limpia o la cubre entera.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "RenderTargetPool.h"
+#include <functional>
+
+class Device;
+class DeviceContext;
+
+/**
+ * @class RenderGraph
+ * @brief Pases del frame, su orden y las texturas transitorias que usan.
+ */
+class RenderGraph {
+public:
+    typedef uint32_t ResourceHandle;
+    static const ResourceHandle kInvalidResource = ~0u;
+
+    /// Descripción de una textura transitoria (la clave del pool).
+    typedef RenderTargetPool::Desc TextureDesc;
+    /// Textura y sus vistas.
+    typedef RenderTargetPool::Target TextureViews;
+
+    /**
+     * @class PassBuilder
+     * @brief Lo que un pase declara en su `setup`.
+     */
+    class PassBuilder {
+    public:
+        /** @brief Nueva textura transitoria que escribe este pase. */
+        ResourceHandle create(const char* name, const TextureDesc& desc);
+
+        /** @brief El pase lee `resource`: se ejecuta después de quien lo escribió. */
+        ResourceHandle read(ResourceHandle resource);
+
+        /** @brief El pase escribe `resource` (o lo modifica). */
+        ResourceHandle write(ResourceHandle resource);
+
+        /** @brief El pase tiene efectos fuera del grafo (Present, lecturas a CPU, UI): no se descarta. */
+        void sideEffect();
+
+    private:
+        friend class RenderGraph;
+        PassBuilder(RenderGraph& graph, uint32_t pass) : m_graph(graph), m_pass(pass) {}
+
+        RenderGraph& m_graph;
+        uint32_t m_pass;
+    };
+
+    typedef std::function<void(PassBuilder&)> SetupFunction;
+    typedef std::function<void(DeviceContext&, const RenderGraph&)> ExecuteFunction;
+
+    RenderGraph() = default;
+    ~RenderGraph() { destroy(); }
+    RenderGraph(const RenderGraph&) = delete;
+    RenderGraph& operator=(const RenderGraph&) = delete;
+
+    /** @brief Empieza un frame nuevo: olvida pases y recursos (el pool se queda). */
+    void reset();
+
+    /**
+     * @brief Recurso que vive fuera del frame. Quien lo escribe nunca se descarta.
+     * @param views Sus vistas; sin ellas (otra sobrecarga), los pases lo usan por su cuenta.
+     */
+    ResourceHandle importTexture(const char* name, const TextureViews& views);
+    ResourceHandle importTexture(const char* name) { return importTexture(name, TextureViews()); }
+
+    /**
+     * @brief Añade un pase; `setup` se llama en el acto y `execute` en @ref execute.
+     * @param name Nombre (literal: se guarda el puntero).
+     */
+    void addPass(const char* name, const SetupFunction& setup, const ExecuteFunction& execute);
+
+    /**
+     * @brief Descarta, ordena y asigna memoria a las transitorias.
+     * @param pool De donde salen las texturas; se devuelven al final de @ref execute.
+     * @return `S_OK`, o el error de crear una textura (el frame se dibuja sin esos pases).
+     */
+    HRESULT compile(Device& device, RenderTargetPool& pool);
+
+    /** @brief Ejecuta los pases compilados, en orden, y devuelve las texturas al pool. */
+    void execute(DeviceContext& deviceContext);
+
+    /** @brief Vistas de un recurso (solo durante @ref execute para las transitorias). */
+    const TextureViews& getTexture(ResourceHandle resource) const;
+
+    /** @brief Olvida el frame y devuelve lo que tuviera prestado. */
+    void destroy() { reset(); }
+
+    // ==== Estadísticas del último `compile` ====
+
+    /** @brief Pases declarados. */
+    unsigned int getPassCount() const { return static_cast<unsigned int>(m_passes.size()); }
+
+    /** @brief Pases descartados por no contribuir a nada. */
+    unsigned int getCulledPassCount() const { return m_culledPasses; }
+
+    /** @brief Texturas transitorias vivas (de pases no descartados). */
+    unsigned int getTransientCount() const { return m_transientCount; }
+
+    /** @brief Texturas físicas que usó el frame. */
+    unsigned int getPhysicalCount() const { return m_physicalCount; }
+
+    /** @brief Bytes que ocuparían las transitorias cada una con su memoria. */
+    unsigned long long getRequestedBytes() const { return m_requestedBytes; }
+
+    /** @brief Bytes de las texturas físicas que usó el frame (lo que se ahorra es la diferencia). */
+    unsigned long long getAllocatedBytes() const { return m_allocatedBytes; }
+
+private:
+    struct Resource {
+        const char* name = nullptr;
+        bool imported = false;
+        TextureDesc desc;                   ///< Solo transitorias.
+        TextureViews views;                 ///< Importadas: las dadas; transitorias: del pool al compilar.
+        uint32_t producer = ~0u;            ///< Pase que la crea (transitorias).
+        uint32_t lastWriter = ~0u;          ///< Última escritura declarada (para las dependencias).
+        std::vector<uint32_t> readersSinceWrite; ///< Lecturas desde esa escritura.
+        uint32_t firstUse = ~0u;            ///< Posición en `m_order` del primer pase que la usa.
+        uint32_t lastUse = 0;               ///< Posición del último.
+        uint32_t lease = ~0u;               ///< Textura física asignada (índice en `m_leases`).
+    };
+
+    struct Pass {
+        const char* name = nullptr;
+        ExecuteFunction execute;
+        std::vector<ResourceHandle> reads;
+        std::vector<ResourceHandle> writes;
+        std::vector<uint32_t> dependencies; ///< Pases que deben ir antes.
+        bool sideEffect = false;
+        bool alive = false;
+    };
+
+    /// Textura física prestada por el pool durante el frame.
+    struct Lease {
+        TextureDesc desc;
+        TextureViews target;
+        uint32_t busyUntil = 0;             ///< Último pase (en `m_order`) de su transitoria actual.
+    };
+
+    /// Apunta la dependencia de `pass` con la escritura o lecturas previas de `resource`.
+    void addAccess(uint32_t pass, ResourceHandle resource, bool write);
+
+    /// Textura prestada libre desde `firstUse` (o una nueva del pool); `~0u` si no se pudo crear.
+    uint32_t acquire(Device& device, const TextureDesc& desc, uint32_t firstUse, uint32_t lastUse, HRESULT& hr);
+
+    /// Devuelve al pool todo lo prestado.
+    void releaseLeases();
+
+    std::vector<Pass> m_passes;
+    std::vector<Resource> m_resources;
+    std::vector<uint32_t> m_order;          ///< Pases vivos en el orden de ejecución.
+    std::vector<Lease> m_leases;
+    RenderTargetPool* m_pool = nullptr;     ///< Pool del último `compile`.
+
+    unsigned int m_culledPasses = 0;
+    unsigned int m_transientCount = 0;
+    unsigned int m_physicalCount = 0;
+    unsigned long long m_requestedBytes = 0;
+    unsigned long long m_allocatedBytes = 0;
+};
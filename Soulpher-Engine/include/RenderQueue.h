@@ -0,0 +1,413 @@
+﻿/**
+ * @file RenderQueue.h
+ * @brief Cola de render ordenada por clave de 64 bits.
+ *
+ * @details
+ * En lugar de que cada `Actor` dibuje directamente, los actores envían
+ * **draw packets** a la cola. Al final del frame la cola ordena los paquetes
+ * de cada capa por su clave y los envía a la GPU, evitando binds redundantes
+ * cuando dos paquetes consecutivos comparten estado.
+ *
+ * Distribución de la clave (bit 63 = más significativo):
+ * - Capas opaca y de alpha test:
+ *                     [63..62] capa | [61..46] shader | [45..30] material | [29..0] profundidad.
+ * - Capa transparente:[63..62] capa | [61..32] profundidad invertida | [31..16] shader | [15..0] material.
+ *
+ * El campo material es el identificador compacto de `Material` (sin colisiones); los
+ * paquetes sin material usan un hash de su textura y los lotes con array, el del array.
+ *
+ * Así los opacos se agrupan por estado y se dibujan de adelante hacia atrás
+ * (aprovechando el early-Z), y los transparentes se dibujan de atrás hacia adelante
+ * para que el blending sea correcto.
+ *
+ * Mezcla: la capa opaca y la de alpha test se dibujan **siempre sin blending** (se
+ * ignora el `blendState` de sus paquetes); solo la transparente enlaza el de cada
+ * paquete. Mezclar un píxel opaco cuesta una lectura del render target y, en algunas
+ * GPU, la compresión de color. La capa de alpha test (`discard` en el PS) queda fuera
+ * del pre-pase de profundidad: se dibuja después de los opacos con el depth test normal.
+ *
+ * Instancing: en la capa opaca, los paquetes que comparten geometría, textura y
+ * estados (p. ej. actores con el mismo `MeshAsset`) se fusionan en un único
+ * `DrawIndexedInstanced`. Sus `CBChangesEveryFrame` se copian a un vertex buffer
+ * dinámico por instancia (slot 1) que lee el programa de instancing.
+ *
+ * Arrays de texturas (opcional, @ref setTextureArrays): antes de agrupar, la
+ * textura de cada paquete instanciable se busca en un @ref TextureArrayPool. Los
+ * paquetes cuya textura tiene capa se agrupan por el array y no por la textura, y la
+ * capa de cada instancia va en un segundo stream (slot 2). Así un lote puede mezclar
+ * texturas distintas del mismo tamaño y formato.
+ *
+ * Materiales: cada paquete enlaza las constantes de su material en b4 (las del
+ * material por defecto si no tiene, ver @ref RenderQueue::setDefaultMaterial) solo si
+ * cambian respecto al anterior. Los lotes agrupan por el buffer de constantes, no por
+ * el material: dos materiales con los mismos valores y texturas en el mismo array
+ * siguen siendo un solo draw.
+ *
+ * Constantes por objeto: los paquetes sueltos con `objectData` no usan el
+ * `modelBuffer` del actor; sus datos se copian a un bloque del
+ * `ConstantBufferRing` de la cola (Map + memcpy) y ese bloque se enlaza en b2.
+ *
+ * Pre-pase de profundidad: `renderDepthOnly` dibuja la capa opaca con el stream
+ * de posiciones (`positionBuffer`) y programas sin Pixel Shader. El orden, los
+ * lotes y los bloques de constantes se calculan una vez y los reutiliza el pase
+ * principal, que solo tiene que sombrear los píxeles que ganaron la prueba de Z.
+ *
+ * Culling por clusters (opcional, @ref setClusterCulling): `Actor::submit` prueba
+ * los meshlets de cada malla contra el frustum y el cono de normales y envía solo
+ * los rangos de índices visibles. Las colas de sombra no lo activan: lo que la
+ * cámara no ve puede seguir proyectando sombra.
+ *
+ * Grabación en varios hilos (opcional, @ref setDeferredRecorder): con muchas entradas,
+ * cada capa se parte en trozos que se graban en contextos diferidos y se ejecutan en
+ * orden. Las constantes por objeto se suben antes en el inmediato.
+ *
+ * Sombras: el shadow map usa una segunda cola (vista de la luz) y solo su
+ * `renderDepthOnly`. En la cola principal, los paquetes sin shader propio con
+ * `receiveShadow` reciben al enviarse el programa receptor, de modo que se ordenan
+ * y agrupan en lotes aparte de los que no reciben sombra.
+ *
+ * @note Para estudiantes:
+ * - Ordenar por estado reduce llamadas a la API; ordenar por profundidad reduce overdraw.
+ * - Los paquetes solo guardan punteros: los recursos siguen perteneciendo al `Actor`.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "Buffer.h"
+#include "ConstantBufferRing.h"
+#include "TextureArrayPool.h"
+#include <cstdint>
+
+class Device;
+class DeviceContext;
+class Texture;
+class ShaderProgram;
+class BlendState;
+class Rasterizer;
+class SamplerState;
+class Frustum;
+class DeferredRecorder;
+class Material;
+class ActorCost;
+
+/**
+ * @enum RenderLayer
+ * @brief Capas (buckets) de la cola. Cada capa se ordena y envía por separado.
+ */
+enum RenderLayer {
+    RENDER_LAYER_OPAQUE = 0,       ///< Geometría opaca (adelante → atrás), sin blending.
+    RENDER_LAYER_ALPHA_TESTED = 1, ///< Opaca con `discard` (adelante → atrás), sin blending ni pre-pase.
+    RENDER_LAYER_TRANSPARENT = 2,  ///< Geometría con blending (atrás → adelante).
+    RENDER_LAYER_COUNT = 3
+};
+
+/**
+ * @struct DrawPacket
+ * @brief Todo lo necesario para emitir un `DrawIndexed` de una malla.
+ *
+ * @note Los punteros nulos significan "no cambiar el estado actual".
+ */
+struct DrawPacket {
+    Buffer* vertexBuffer = nullptr;     ///< Buffer de vértices (slot 0).
+    Buffer* positionBuffer = nullptr;   ///< Stream solo-posición para pases de profundidad (opcional).
+    Buffer* indexBuffer = nullptr;      ///< Buffer de índices.
+    DXGI_FORMAT indexFormat = DXGI_FORMAT_R32_UINT; ///< Formato de los índices.
+    Buffer* modelBuffer = nullptr;      ///< Constant buffer del objeto (slot b2, VS+PS); solo sin `objectData`.
+    const CBChangesEveryFrame* objectData = nullptr; ///< Mundo + color en CPU (fuente de los datos por instancia).
+    Texture* texture = nullptr;         ///< Textura difusa (slot t0).
+    const Material* material = nullptr; ///< Constantes (b4) e identificador de orden; nulo = el de `setDefaultMaterial`.
+    ID3D11ShaderResourceView* textureArray = nullptr; ///< Solo lotes: array del pool en t0 (sustituye a `texture`).
+    ShaderProgram* shader = nullptr;    ///< Programa de shaders; nulo = el ya enlazado.
+    BlendState* blendState = nullptr;   ///< Estado de mezcla (solo en la capa transparente).
+    Rasterizer* rasterizer = nullptr;   ///< Estado del rasterizador.
+    SamplerState* sampler = nullptr;    ///< Sampler (slot s0).
+    unsigned int indexCount = 0;        ///< Número de índices a dibujar.
+    unsigned int startIndex = 0;        ///< Primer índice.
+    int baseVertex = 0;                 ///< Desplazamiento de vértice base.
+    unsigned int instanceCount = 1;     ///< > 1 solo en lotes instanciados creados por la cola.
+    unsigned int firstInstance = 0;     ///< Primer elemento del lote en el buffer de instancias.
+    float depth = 0.0f;                 ///< Profundidad en espacio de vista (z).
+    bool receiveShadow = false;         ///< Usar el programa receptor de sombras (si la cola tiene uno).
+    Buffer* lightmapUVs = nullptr;      ///< Stream de UV2 (slot 3); solo con `lightmap`.
+    ID3D11ShaderResourceView* lightmap = nullptr; ///< Página de lightmaps (t7); no nulo = programa de lightmaps.
+    Buffer* lightmapConstants = nullptr; ///< Rectángulo del actor en la página (b9, `CBLightmap`).
+    RenderLayer layer = RENDER_LAYER_OPAQUE; ///< Capa de destino.
+    const char* name = nullptr;         ///< Nombre del evento en capturas de GPU (el del actor).
+    const void* owner = nullptr;        ///< Actor que lo envió (coste por actor, @ref ActorCost).
+};
+
+/**
+ * @class RenderQueue
+ * @brief Recolecta draw packets por frame, los ordena y los envía.
+ *
+ * Uso típico por frame:
+ * @code
+ * queue.update(view);                          // limpia buckets
+ * actor->submit(queue);                        // cada actor envía paquetes
+ * queue.render(ctx, RENDER_LAYER_OPAQUE);       // ordena y dibuja opacos
+ * queue.render(ctx, RENDER_LAYER_ALPHA_TESTED); // opacos con discard
+ * queue.render(ctx, RENDER_LAYER_TRANSPARENT);  // ordena y dibuja transparentes
+ * @endcode
+ */
+class RenderQueue {
+public:
+    RenderQueue() = default;
+    ~RenderQueue() = default;
+
+    /**
+     * @brief Reserva memoria para los buckets.
+     * @param device Dispositivo (crea y hace crecer el buffer de instancias).
+     * @param reservePackets Paquetes esperados por capa.
+     */
+    void init(Device& device, unsigned int reservePackets = 1024);
+
+    /**
+     * @brief Inicia un nuevo frame: vacía los buckets y guarda la vista actual.
+     * @param view Matriz de vista usada para calcular la profundidad de los paquetes.
+     */
+    void update(const XMMATRIX& view);
+
+    /**
+     * @brief Ordena y envía los paquetes de una capa.
+     * @param deviceContext Contexto donde se emiten los draws.
+     * @param layer Capa a dibujar.
+     */
+    void render(DeviceContext& deviceContext, RenderLayer layer);
+
+    /**
+     * @brief Pre-pase de profundidad de la capa opaca (sin Pixel Shader).
+     * @param deviceContext Contexto con el DSV enlazado y un estado que escriba Z.
+     * @param alphaTested Dibuja también la capa de alpha test, como sólida (pases de
+     * sombra); el pre-pase de la cámara no debe: escribiría Z en los huecos.
+     *
+     * @note Requiere `setDepthPrograms`. Después, `render(RENDER_LAYER_OPAQUE)`
+     * reutiliza el orden y los datos subidos aquí.
+     */
+    void renderDepthOnly(DeviceContext& deviceContext, bool alphaTested = false);
+
+    /** @brief Libera la memoria de los buckets. */
+    void destroy();
+
+    /**
+     * @brief Añade un paquete a su capa y calcula su clave de orden.
+     * @param packet Paquete a dibujar este frame.
+     */
+    void submit(const DrawPacket& packet);
+
+    /**
+     * @brief Calcula la profundidad en espacio de vista de un punto del mundo.
+     * @param worldPosition Posición en espacio mundo (w = 1).
+     * @return Coordenada z en espacio de vista (mayor = más lejos).
+     */
+    float computeViewDepth(const XMVECTOR& worldPosition) const;
+
+    /**
+     * @brief Construye la clave de 64 bits de un paquete.
+     * @param packet Paquete ya relleno (capa, shader, textura, profundidad).
+     */
+    static uint64_t makeSortKey(const DrawPacket& packet);
+
+    /**
+     * @brief Programa usado por los paquetes sin shader propio.
+     * @param program Programa principal de la escena.
+     */
+    void setDefaultProgram(ShaderProgram* program) { m_defaultProgram = program; }
+
+    /**
+     * @brief Material de los paquetes sin material propio.
+     * @param material Normalmente `MaterialLibrary::getDefault()`; `nullptr` = no tocar b4.
+     */
+    void setDefaultMaterial(const Material* material) { m_defaultMaterial = material; }
+
+    /**
+     * @brief Programa que lee el stream por instancia (slot 1). `nullptr` desactiva el instancing.
+     * @param program Programa con input layout POSITION/TEXCOORD + INSTANCE_WORLD[0..3]/INSTANCE_COLOR.
+     */
+    void setInstancingProgram(ShaderProgram* program) { m_instancingProgram = program; }
+
+    /**
+     * @brief Programas solo-profundidad del pre-pase.
+     * @param program Entrada POSITION (slot 0).
+     * @param instancedProgram Igual + INSTANCE_WORLD[0..3]/INSTANCE_COLOR (slot 1) para los lotes.
+     */
+    void setDepthPrograms(ShaderProgram* program, ShaderProgram* instancedProgram) {
+        m_depthProgram = program;
+        m_depthInstancedProgram = instancedProgram;
+    }
+
+    /** @brief `true` si hay programas para `renderDepthOnly`. */
+    bool hasDepthPrograms() const { return m_depthProgram != nullptr; }
+
+    /**
+     * @brief Rasterizer que sustituye al de cada paquete en `renderDepthOnly`.
+     * @param rasterizer Estado con sesgo de profundidad (pase de sombra); `nullptr` = el del paquete.
+     */
+    void setDepthRasterizer(Rasterizer* rasterizer) { m_depthRasterizer = rasterizer; }
+
+    /**
+     * @brief Programas de los paquetes con `receiveShadow` (se asignan en `submit`).
+     * @param program Variante de `setDefaultProgram` que lee el shadow map; `nullptr` desactiva.
+     * @param instancedProgram Variante de `setInstancingProgram` para sus lotes.
+     */
+    void setShadowReceiverPrograms(ShaderProgram* program, ShaderProgram* instancedProgram) {
+        m_receiverProgram = program;
+        m_receiverInstancedProgram = instancedProgram;
+    }
+
+    /**
+     * @brief Programa de los paquetes con `lightmap` (se asigna en `submit`, antes que el receptor).
+     * @param program Lee la luz horneada en lugar de la de tiempo real; `nullptr` = esos
+     * paquetes se iluminan como los demás.
+     */
+    void setLightmapProgram(ShaderProgram* program) { m_lightmapProgram = program; }
+
+    /**
+     * @brief Graba los draws de cada capa en contextos diferidos.
+     * @param recorder Grabador (debe vivir mientras se use); `nullptr` = todo en el inmediato.
+     */
+    void setDeferredRecorder(DeferredRecorder* recorder) { m_recorder = recorder; }
+
+    /**
+     * @brief Apunta el coste de cada paquete en su actor y mide los del actor elegido.
+     * @param costs Contadores (deben vivir mientras se usen); `nullptr` desactiva.
+     * @param shadow Los paquetes de esta cola cuentan como sombra.
+     */
+    void setActorCost(ActorCost* costs, bool shadow) {
+        m_costs = costs;
+        m_shadowCosts = shadow;
+    }
+
+    /** @brief Activa o desactiva la fusión de paquetes en draws instanciados. */
+    void setInstancing(bool enable) { m_instancing = enable; }
+
+    /**
+     * @brief Lotes que mezclan texturas a través de arrays.
+     * @param pool Pool de arrays; `nullptr` desactiva (un lote por textura).
+     * @param program Variante `TEXTURE_ARRAY` de `setInstancingProgram` (capa en el slot 2).
+     * @param receiverProgram Igual para los receptores de sombra; `nullptr` = sus
+     * lotes siguen agrupándose por textura.
+     */
+    void setTextureArrays(TextureArrayPool* pool, ShaderProgram* program, ShaderProgram* receiverProgram) {
+        m_textureArrays = program ? pool : nullptr;
+        m_arrayProgram = program;
+        m_receiverArrayProgram = receiverProgram;
+    }
+
+    /**
+     * @brief Culling de meshlets en `Actor::submit`.
+     * @param frustum Frustum de la cámara de esta cola (debe vivir mientras se use);
+     * `nullptr` desactiva y cada malla se envía entera.
+     */
+    void setClusterCulling(const Frustum* frustum) { m_clusterFrustum = frustum; }
+
+    /** @brief Frustum para el culling de meshlets (`nullptr` = desactivado). */
+    const Frustum* getClusterFrustum() const { return m_clusterFrustum; }
+
+    /** @brief Posición de la cámara en mundo (de la vista de `update`). */
+    const XMFLOAT3& getViewPosition() const { return m_viewPosition; }
+
+    /** @brief Acumula las estadísticas de culling de meshlets del frame. */
+    void addClusterStats(unsigned int tested, unsigned int culled) {
+        m_clustersTested += tested;
+        m_clustersCulled += culled;
+    }
+
+    /** @brief Meshlets probados en el frame actual. */
+    unsigned int getTestedClusterCount() const { return m_clustersTested; }
+
+    /** @brief De esos, los descartados (frustum o cono). */
+    unsigned int getCulledClusterCount() const { return m_clustersCulled; }
+
+    /** @brief Anillo de constantes por objeto (estadísticas). */
+    const ConstantBufferRing& getObjectConstants() const { return m_objectConstants; }
+
+    /** @brief Draws instanciados emitidos en el último `render` de la capa opaca. */
+    unsigned int getInstancedDrawCount() const { return m_instancedDraws; }
+
+    /** @brief De esos, los que leen la textura de un array (@ref setTextureArrays). */
+    unsigned int getTextureArrayDrawCount() const { return m_arrayDraws; }
+
+    /** @brief Número de paquetes enviados a una capa en el frame actual. */
+    unsigned int getPacketCount(RenderLayer layer) const {
+        return static_cast<unsigned int>(m_buckets[layer].size());
+    }
+
+private:
+    /// Entrada ligera de ordenamiento: ordenar 16 bytes es más barato que mover paquetes.
+    struct SortEntry {
+        uint64_t key;
+        unsigned int index;
+    };
+
+    /// Bit alto del índice de `SortEntry`: la entrada apunta a `m_batches`, no al bucket.
+    static const unsigned int kBatchFlag = 0x80000000u;
+    /// Tamaño mínimo de grupo para que compense un draw instanciado.
+    static const unsigned int kMinInstanceBatch = 2;
+
+    /// Cuantiza un puntero a un identificador de 16 bits para agrupar estado.
+    static uint64_t stateId(const void* ptr);
+
+    /// Ordena la capa y (en opacos) crea los lotes; una sola vez por frame y capa.
+    void prepare(DeviceContext& deviceContext, RenderLayer layer);
+
+    /// Emite los draws de una capa ya preparada (completos o solo profundidad).
+    void draw(DeviceContext& deviceContext, RenderLayer layer, bool depthOnly);
+
+    /// Emite las entradas `[begin, end)` del orden de la capa en `deviceContext`.
+    void drawRange(DeviceContext& deviceContext, RenderLayer layer, bool depthOnly,
+        unsigned int begin, unsigned int end);
+
+    /// Bloque de constantes del paquete `index` de `layer` (se sube la primera vez).
+    Buffer* objectConstants(DeviceContext& deviceContext, RenderLayer layer,
+        unsigned int index, const DrawPacket& packet);
+
+    /// Agrupa paquetes instanciables, sube sus datos y crea las entradas de lote.
+    void buildInstanceBatches(DeviceContext& deviceContext, std::vector<DrawPacket>& bucket);
+
+    /// Garantiza que el buffer de instancias tenga al menos `bytes` de capacidad.
+    HRESULT reserveInstanceBuffer(unsigned int bytes);
+
+    /// Igual para el stream de capas (slot 2).
+    HRESULT reserveSliceBuffer(unsigned int bytes);
+
+    /// Variante `TEXTURE_ARRAY` del programa de lote de un paquete (nula = sin array).
+    ShaderProgram* arrayProgramFor(const DrawPacket& packet) const;
+
+    std::vector<DrawPacket> m_buckets[RENDER_LAYER_COUNT]; ///< Paquetes por capa.
+    std::vector<SortEntry> m_sortEntries[RENDER_LAYER_COUNT]; ///< Orden de cada capa en el frame.
+    std::vector<Buffer*> m_objectBlocks[RENDER_LAYER_COUNT];  ///< Constantes ya subidas por paquete.
+    bool m_prepared[RENDER_LAYER_COUNT] = { false, false, false }; ///< Capa ya ordenada este frame.
+    std::vector<DrawPacket> m_batches;                     ///< Lotes instanciados del frame.
+    std::vector<unsigned int> m_groupScratch;              ///< Índices ordenados por geometría.
+    std::vector<char> m_consumed;                          ///< Paquetes absorbidos por un lote.
+    std::vector<CBChangesEveryFrame> m_instanceData;       ///< Datos por instancia en CPU.
+    Buffer m_instanceBuffer;                               ///< Vertex buffer dinámico por instancia.
+    std::vector<TextureArrayPool::Slot> m_slots;           ///< Capa de la textura de cada paquete.
+    std::vector<unsigned int> m_sliceData;                 ///< Capa por instancia (paralelo a `m_instanceData`).
+    Buffer m_sliceBuffer;                                  ///< Vertex buffer dinámico de capas (slot 2).
+    TextureArrayPool* m_textureArrays = nullptr;           ///< Pool activo (nulo = sin arrays).
+    ShaderProgram* m_arrayProgram = nullptr;               ///< Lotes con array.
+    ShaderProgram* m_receiverArrayProgram = nullptr;       ///< Lotes con array que reciben sombra.
+    ConstantBufferRing m_objectConstants;                  ///< Constantes transitorias por paquete (b2).
+    Device* m_device = nullptr;                            ///< Dispositivo para recrear el buffer.
+    ShaderProgram* m_defaultProgram = nullptr;             ///< Programa de los paquetes sin shader.
+    const Material* m_defaultMaterial = nullptr;           ///< Constantes de los paquetes sin material.
+    ShaderProgram* m_instancingProgram = nullptr;          ///< Programa de los lotes instanciados.
+    ShaderProgram* m_depthProgram = nullptr;               ///< Pre-pase: paquetes sueltos.
+    ShaderProgram* m_depthInstancedProgram = nullptr;      ///< Pre-pase: lotes instanciados.
+    Rasterizer* m_depthRasterizer = nullptr;               ///< Rasterizer forzado en solo-profundidad.
+    ShaderProgram* m_receiverProgram = nullptr;            ///< Paquetes que reciben sombra.
+    ShaderProgram* m_receiverInstancedProgram = nullptr;   ///< Lotes que reciben sombra.
+    ShaderProgram* m_lightmapProgram = nullptr;            ///< Paquetes con lightmap (nunca instanciados).
+    bool m_instancing = true;                              ///< Fusión de paquetes activa.
+    unsigned int m_instancedDraws = 0;                     ///< Lotes emitidos en la capa opaca.
+    unsigned int m_arrayDraws = 0;                         ///< Lotes con array de texturas.
+    XMMATRIX m_view = XMMatrixIdentity();                  ///< Vista del frame actual.
+    XMFLOAT3 m_viewPosition = XMFLOAT3(0.0f, 0.0f, 0.0f);  ///< Cámara en mundo (inversa de `m_view`).
+    const Frustum* m_clusterFrustum = nullptr;             ///< Culling de meshlets (nulo = desactivado).
+    DeferredRecorder* m_recorder = nullptr;                ///< Grabación en varios hilos (nulo = inmediato).
+    ActorCost* m_costs = nullptr;                          ///< Coste por actor (nulo = sin contar).
+    bool m_shadowCosts = false;                            ///< Los paquetes cuentan como sombra.
+    unsigned int m_clustersTested = 0;                     ///< Meshlets probados este frame.
+    unsigned int m_clustersCulled = 0;                     ///< Meshlets descartados este frame.
+};
@@ -0,0 +1,100 @@
+﻿/**
+ * @file RenderStateCache.h
+ * @brief Caché de objetos de estado D3D11 compartidos, indexada por hash del descriptor.
+ *
+ * @details
+ * Sampler, blend, depth/stencil y rasterizer states son **inmutables**: dos objetos
+ * creados con el mismo descriptor son intercambiables. Esta caché guarda un único
+ * objeto por descriptor distinto y devuelve siempre ese puntero (con `AddRef`),
+ * de modo que crear miles de actores no crea ningún estado nuevo.
+ *
+ * - La clave es un hash FNV-1a de los bytes del descriptor; las colisiones se
+ *   resuelven comparando el descriptor completo.
+ * - El conteo de referencias es el propio de COM: cada usuario libera su puntero
+ *   con `SAFE_RELEASE` como siempre; la caché conserva una referencia hasta `destroy()`.
+ * - Al compartir punteros, el filtro de `DeviceContext` detecta binds repetidos
+ *   comparando punteros en lugar de descriptores.
+ *
+ * Se puede pedir desde varios hilos (el arranque inicializa sistemas en paralelo): un
+ * cerrojo cubre la búsqueda y la creación, que es barata.
+ *
+ * @note Los descriptores deben inicializarse con `= {}` (como hace todo el motor)
+ * para que los bytes de relleno sean cero y el hash sea estable.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
+class Device;
+
+/**
+ * @class RenderStateCache
+ * @brief Entrega objetos de estado compartidos creados una sola vez por descriptor.
+ */
+class RenderStateCache {
+public:
+    RenderStateCache() = default;
+    ~RenderStateCache() = default;
+
+    /** @brief Devuelve (creándolo si hace falta) el sampler para `desc`. */
+    HRESULT getSamplerState(Device& device, const D3D11_SAMPLER_DESC& desc,
+        ID3D11SamplerState** ppState);
+
+    /** @brief Devuelve (creándolo si hace falta) el blend state para `desc`. */
+    HRESULT getBlendState(Device& device, const D3D11_BLEND_DESC& desc,
+        ID3D11BlendState** ppState);
+
+    /** @brief Devuelve (creándolo si hace falta) el depth/stencil state para `desc`. */
+    HRESULT getDepthStencilState(Device& device, const D3D11_DEPTH_STENCIL_DESC& desc,
+        ID3D11DepthStencilState** ppState);
+
+    /** @brief Devuelve (creándolo si hace falta) el rasterizer state para `desc`. */
+    HRESULT getRasterizerState(Device& device, const D3D11_RASTERIZER_DESC& desc,
+        ID3D11RasterizerState** ppState);
+
+    /**
+     * @brief Suelta las referencias de la caché.
+     *
+     * @warning Llamar antes de liberar el `ID3D11Device`.
+     */
+    void destroy();
+
+    /** @brief Número de objetos de estado distintos creados. */
+    unsigned int getStateCount() const;
+
+    /** @brief Peticiones servidas sin crear un objeto nuevo. */
+    unsigned int getHitCount() const { return m_hits; }
+
+private:
+    /// Un bucket por hash; varias entradas solo si hay colisión.
+    template<typename DescT, typename StateT>
+    struct Cache {
+        struct Entry {
+            DescT desc;
+            StateT* state;
+        };
+        std::unordered_map<uint64_t, std::vector<Entry>> buckets;
+        unsigned int count = 0;
+    };
+
+    /// Busca `desc` en `cache`; si no existe lo crea con `create`. Devuelve el estado con AddRef.
+    template<typename DescT, typename StateT, typename CreateFn>
+    HRESULT acquire(Cache<DescT, StateT>& cache, const DescT& desc, StateT** ppState, CreateFn create);
+
+    /// Libera todas las entradas de una caché.
+    template<typename DescT, typename StateT>
+    static void release(Cache<DescT, StateT>& cache);
+
+    /// FNV-1a de 64 bits sobre los bytes del descriptor.
+    static uint64_t hashBytes(const void* data, size_t size);
+
+    Cache<D3D11_SAMPLER_DESC, ID3D11SamplerState> m_samplers;            ///< Samplers.
+    Cache<D3D11_BLEND_DESC, ID3D11BlendState> m_blendStates;             ///< Blend states.
+    Cache<D3D11_DEPTH_STENCIL_DESC, ID3D11DepthStencilState> m_depthStates; ///< Depth/stencil states.
+    Cache<D3D11_RASTERIZER_DESC, ID3D11RasterizerState> m_rasterizers;   ///< Rasterizer states.
+    unsigned int m_hits = 0;                                             ///< Aciertos de caché.
+    mutable std::mutex m_mutex;                                          ///< Protege las cachés.
+};
@@ -0,0 +1,108 @@
+﻿/**
+ * @file RenderTargetPool.h
+ * @brief Pool de render targets y depth targets indexado por su descripción.
+ *
+ * @details
+ * Un pase que necesita una textura intermedia no hace `Texture::init` +
+ * `RenderTargetView::init`: pide a @ref RenderTargetPool::acquire una con la
+ * descripción que quiere (ancho, alto, formato, vistas, muestras) y la devuelve con
+ * @ref RenderTargetPool::release cuando termina. Si hay una libre igual se reutiliza;
+ * si no, se crea y queda en el pool.
+ *
+ * - @ref RenderTargetPool::update, una vez por frame, libera las que llevan
+ *   @ref RenderTargetPool::kRetainFrames frames sin pedirse.
+ * - @ref RenderTargetPool::clear (al cambiar de tamaño) las libera todas de una vez.
+ *
+ * @note Para estudiantes: lo que sale del pool trae el contenido de su uso anterior;
+ * el pase la limpia o la cubre entera.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+
+class Device;
+
+/**
+ * @class RenderTargetPool
+ * @brief Texturas con RTV/DSV/SRV/UAV reutilizables entre pases y frames.
+ */
+class RenderTargetPool {
+public:
+    /// Frames que una textura libre puede pasar sin pedirse antes de liberarla.
+    static const unsigned int kRetainFrames = 30;
+
+    /// Clave del pool (un solo mip).
+    struct Desc {
+        unsigned int width = 0;
+        unsigned int height = 0;
+        DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;    ///< Formato de la textura (typeless si sus vistas difieren).
+        unsigned int bindFlags = 0;                  ///< `D3D11_BIND_*`: decide qué vistas se crean.
+        unsigned int sampleCount = 1;                ///< Muestras por píxel (MSAA).
+        unsigned int sampleQuality = 0;              ///< Nivel de calidad MSAA (`CheckMultisampleQualityLevels`).
+        DXGI_FORMAT rtvFormat = DXGI_FORMAT_UNKNOWN; ///< Formato de cada vista (`UNKNOWN` = el de la textura).
+        DXGI_FORMAT dsvFormat = DXGI_FORMAT_UNKNOWN;
+        DXGI_FORMAT srvFormat = DXGI_FORMAT_UNKNOWN;
+        DXGI_FORMAT uavFormat = DXGI_FORMAT_UNKNOWN;
+
+        bool operator==(const Desc& other) const;
+    };
+
+    /// Textura y sus vistas; las que no pidió `bindFlags` quedan a `nullptr`.
+    struct Target {
+        ID3D11Texture2D* texture = nullptr;
+        ID3D11RenderTargetView* rtv = nullptr;
+        ID3D11DepthStencilView* dsv = nullptr;
+        ID3D11ShaderResourceView* srv = nullptr;
+        ID3D11UnorderedAccessView* uav = nullptr;
+    };
+
+    RenderTargetPool() = default;
+    ~RenderTargetPool() { clear(); }
+    RenderTargetPool(const RenderTargetPool&) = delete;
+    RenderTargetPool& operator=(const RenderTargetPool&) = delete;
+
+    /**
+     * @brief Una textura libre con esa descripción, o una nueva.
+     * @param out Recibe la textura y sus vistas (siguen siendo del pool).
+     * @return `S_OK` o el error de crearla.
+     */
+    HRESULT acquire(Device& device, const Desc& desc, Target& out);
+
+    /** @brief Devuelve una textura de @ref acquire; queda libre para el siguiente. */
+    void release(const Target& target);
+
+    /** @brief Avanza un frame y libera las libres que llevan tiempo sin pedirse. */
+    void update();
+
+    /**
+     * @brief Libera todas las texturas (cambio de tamaño, cierre).
+     * @note Las que estén prestadas también: nadie debe seguir usándolas.
+     */
+    void clear();
+
+    /** @brief Texturas en el pool, libres o prestadas. */
+    unsigned int getTargetCount() const { return static_cast<unsigned int>(m_entries.size()); }
+
+    /** @brief Texturas prestadas ahora. */
+    unsigned int getLeasedCount() const;
+
+    /** @brief Bytes estimados de todas las texturas del pool. */
+    unsigned long long getAllocatedBytes() const;
+
+    /** @brief Bytes estimados de una textura con esa descripción. */
+    static unsigned long long estimateBytes(const Desc& desc);
+
+private:
+    struct Entry {
+        Desc desc;
+        Target target;
+        uint64_t lastFrame = 0;    ///< Último frame en que se pidió.
+        bool leased = false;
+    };
+
+    static HRESULT create(Device& device, const Desc& desc, Target& out);
+    static void destroyTarget(Target& target);
+
+    std::vector<Entry> m_entries;
+    uint64_t m_frame = 0;
+};
@@ -0,0 +1,74 @@
+﻿/**
+ * @file RenderThread.h
+ * @brief Hilo dedicado al render: dibuja un frame mientras el principal simula el siguiente.
+ *
+ * @details
+ * Con todo en un hilo, `update(); render();` van seguidos: mientras el driver valida y
+ * encola los draws, la simulación espera, y al revés. Con `RenderThread` el frame se
+ * parte en dos fases que se solapan:
+ *
+ * | Hilo principal                        | Hilo de render            |
+ * |---------------------------------------|---------------------------|
+ * | entrada, UI y cámara del frame N      | (espera)                  |
+ * | copia del estado a dibujar (snapshot) | (espera)                  |
+ * | simulación del frame N                | culling, draws y Present  |
+ *
+ * El hilo principal solo toca el contexto de D3D11, la ventana y las listas de actores
+ * entre @ref RenderThread::wait y @ref RenderThread::kick; fuera de ese tramo el render
+ * solo lee la copia (`Actor::capture`, la vista del frame y la UI ya cerrada).
+ *
+ * @note Para estudiantes: el precio es un frame más de latencia (se ve la simulación
+ * del frame anterior); a cambio, el frame cuesta el máximo de las dos fases y no su suma.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include <condition_variable>
+#include <mutex>
+
+/**
+ * @class RenderThread
+ * @brief Un hilo que ejecuta una función por cada @ref kick, de uno en uno.
+ */
+class RenderThread {
+public:
+    /// Función del hilo: dibuja un frame completo.
+    typedef void (*Function)(void* context);
+
+    RenderThread() = default;
+    ~RenderThread() { destroy(); }
+    RenderThread(const RenderThread&) = delete;
+    RenderThread& operator=(const RenderThread&) = delete;
+
+    /**
+     * @brief Arranca el hilo (queda esperando al primer @ref kick).
+     * @param function Función a ejecutar en cada frame.
+     * @param context Argumento de `function` (p. ej. la aplicación).
+     * @return `S_OK`, o `E_INVALIDARG` sin función.
+     */
+    HRESULT init(Function function, void* context);
+
+    /** @brief Espera al frame en curso y une el hilo. */
+    void destroy();
+
+    /** @brief `true` entre @ref init y @ref destroy. */
+    bool isRunning() const { return m_thread.joinable(); }
+
+    /** @brief Lanza un frame; antes hay que haber esperado al anterior con @ref wait. */
+    void kick();
+
+    /** @brief Bloquea hasta que el frame lanzado termine (sin hilo o sin frame, vuelve ya). */
+    void wait();
+
+private:
+    void loop();
+
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_kicked;     ///< Hay frame que dibujar (o hay que salir).
+    std::condition_variable m_done;       ///< El frame terminó.
+    Function m_function = nullptr;
+    void* m_context = nullptr;
+    bool m_pending = false;               ///< Frame lanzado y sin terminar.
+    bool m_stopping = false;
+};
@@ -0,0 +1,275 @@
+﻿/**
+ * @file ResourceManager.h
+ * @brief Carga asíncrona de mallas, texturas y materiales con futuros y dependencias.
+ *
+ * @details
+ * `BaseApp::init` cargaba en serie: el FBX, luego las texturas, luego el plano. Aquí
+ * cada petición devuelve al instante un @ref ResourceHandle (un futuro) y se convierte
+ * en un nodo de un grafo:
+ *
+ * - **Malla** (@ref ResourceManager::loadMesh): se importa en un hilo de carga con su
+ *   propio `ModelLoader` (caché `.smesh` o FBX SDK). Publicarla (subir a la GPU, p. ej.
+ *   `MeshLibrary::adopt`) se hace en el hilo principal.
+ * - **Textura** (@ref ResourceManager::loadTexture): la carga el `AsyncTextureLoader`,
+ *   que ya lee y decodifica en sus hilos; el nodo termina cuando su handle deja el
+ *   placeholder.
+ * - **Material** (@ref ResourceManager::loadMaterial): depende de su textura y,
+ *   opcionalmente, de una variante de shader. El VS/PS de la variante se compila a la
+ *   caché de disco en un hilo de carga; al publicar, `ShaderPermutations::get` ya solo
+ *   lee el bytecode. El material se crea cuando todo eso terminó.
+ *
+ * Un nodo pasa a los hilos en cuanto sus dependencias terminan, así la importación del
+ * FBX, la decodificación de texturas y la compilación de shaders se solapan.
+ * @ref ResourceManager::update, en la frontera de frame (render parado), publica lo
+ * terminado: rellena cada futuro y llama a sus continuaciones (@ref ResourceFuture::then),
+ * que es donde se le da al actor su malla o su material.
+ *
+ * Los nodos no van al `JobSystem`: un trabajo no debe esperar a disco, porque
+ * `JobSystem::wait` ejecuta lo que haya en cola y un `parallelFor` del frame se quedaría
+ * esperando a una importación. Van a un pool de hilos propio, como las texturas.
+ *
+ * @note Para estudiantes: los futuros y sus continuaciones solo se tocan en el hilo
+ * principal (los handles cuentan referencias sin atómicos); los hilos de carga solo ven
+ * funciones que trabajan sobre datos que nadie más toca hasta que terminan.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "Material.h"
+#include "MeshLibrary.h"
+#include "AsyncTextureLoader.h"
+#include "ShaderPermutations.h"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+class Device;
+class ModelLoader;
+
+/**
+ * @enum ResourceState
+ * @brief Estado de un futuro.
+ */
+enum ResourceState {
+    RESOURCE_PENDING = 0, ///< En cola, en curso o esperando dependencias.
+    RESOURCE_READY = 1,   ///< Publicado: @ref ResourceFuture::get tiene el recurso.
+    RESOURCE_FAILED = 2   ///< No se pudo cargar (el motivo está en el log).
+};
+
+/**
+ * @class ResourceFuture
+ * @brief Resultado de una carga que se rellena al publicarla.
+ */
+template<typename T>
+class ResourceFuture {
+public:
+    typedef EU::TSharedPointer<T> Value;
+    typedef std::function<void(const Value&)> Continuation;
+
+    ResourceState getState() const { return m_state; }
+    bool isReady() const { return m_state == RESOURCE_READY; }
+    bool isDone() const { return m_state != RESOURCE_PENDING; }
+
+    /** @brief Recurso publicado (nulo mientras esté pendiente o si falló). */
+    const Value& get() const { return m_value; }
+
+    /**
+     * @brief Llama a `continuation` con el recurso al publicarlo (en el acto si ya lo está).
+     * @note No se llama si la carga falla.
+     */
+    void then(Continuation continuation) {
+        if (m_state == RESOURCE_READY) {
+            continuation(m_value);
+        }
+        else if (m_state == RESOURCE_PENDING) {
+            m_continuations.push_back(std::move(continuation));
+        }
+    }
+
+    /** @brief Llama a `callback` al terminar, haya cargado o no (en el acto si ya terminó). */
+    void onDone(std::function<void()> callback) {
+        if (m_state == RESOURCE_PENDING) {
+            m_doneCallbacks.push_back(std::move(callback));
+        }
+        else {
+            callback();
+        }
+    }
+
+private:
+    friend class ResourceManager;
+
+    void publish(const Value& value) {
+        m_state = value.isNull() ? RESOURCE_FAILED : RESOURCE_READY;
+        m_value = value;
+        std::vector<Continuation> continuations;
+        continuations.swap(m_continuations);
+        std::vector<std::function<void()>> doneCallbacks;
+        doneCallbacks.swap(m_doneCallbacks);
+        if (m_state == RESOURCE_READY) {
+            for (const Continuation& continuation : continuations) {
+                continuation(m_value);
+            }
+        }
+        for (const std::function<void()>& callback : doneCallbacks) {
+            callback();
+        }
+    }
+
+    ResourceState m_state = RESOURCE_PENDING;
+    Value m_value;
+    std::vector<Continuation> m_continuations;
+    std::vector<std::function<void()>> m_doneCallbacks;
+};
+
+/// Futuro compartido de un recurso.
+template<typename T>
+using ResourceHandle = EU::TSharedPointer<ResourceFuture<T>>;
+
+/**
+ * @class ResourceManager
+ * @brief Grafo de cargas con hilos propios y publicación en la frontera de frame.
+ */
+class ResourceManager {
+public:
+    ResourceManager() = default;
+    ~ResourceManager() { destroy(); }
+
+    /// Hilos de carga como máximo (importar y compilar ocupan un núcleo cada uno).
+    static const unsigned int kMaxWorkers = 2;
+
+    /// Sube al dispositivo lo que importó un `ModelLoader` (hilo principal).
+    typedef std::function<MeshHandle(ModelLoader&)> MeshPublisher;
+
+    /**
+     * @brief Arranca los hilos de carga.
+     * @param device Dispositivo con el que se publica.
+     * @param meshes Biblioteca donde se registran las mallas (publicador por defecto).
+     * @param materials Biblioteca de materiales.
+     * @param textures Cargador de texturas.
+     * @param workerCount Hilos; 0 = @ref kMaxWorkers.
+     * @return `S_OK`, o `E_FAIL` si no arrancó ningún hilo.
+     */
+    HRESULT init(Device& device, MeshLibrary& meshes, MaterialLibrary& materials,
+        AsyncTextureLoader& textures, unsigned int workerCount = 0);
+
+    /**
+     * @brief Importa un modelo (`.fbx` u `.obj`, por su caché `.smesh`) en un hilo.
+     * @param path Ruta del modelo.
+     * @param publisher Crea el asset a partir del cargador; por defecto `MeshLibrary::adopt`
+     * con `path` como nombre. Un handle nulo marca el futuro como fallido.
+     */
+    ResourceHandle<MeshAsset> loadMesh(const std::string& path, MeshPublisher publisher = MeshPublisher());
+
+    /** @brief Futuro ya publicado con `value` (p. ej. un recurso que ya estaba cargado). */
+    template<typename T>
+    static ResourceHandle<T> makeReady(const EU::TSharedPointer<T>& value) {
+        ResourceHandle<T> future = EU::MakeShared<ResourceFuture<T>>();
+        future->publish(value);
+        return future;
+    }
+
+    /** @brief Textura con candidatas, como `AsyncTextureLoader::load`. */
+    ResourceHandle<Texture> loadTexture(const std::vector<AsyncTextureLoader::Source>& sources);
+
+    /**
+     * @brief Material cuando su textura (y su variante de shader) estén listas.
+     * @param desc Descripción; `diffuse` y `shader` se rellenan al publicar.
+     * @param diffuse Textura difusa (nula = sin textura). Si no carga, el material se
+     * crea igualmente con el placeholder, como antes.
+     * @param shaders Conjunto de la variante (nulo = programa de la cola).
+     * @param features Variante de `shaders`. Si no compila, se usa el programa de la cola.
+     */
+    ResourceHandle<Material> loadMaterial(const MaterialDesc& desc, const ResourceHandle<Texture>& diffuse,
+        ShaderPermutations* shaders = nullptr, ShaderPermutations::Features features = 0);
+
+    /**
+     * @brief Forma genérica: `load<MeshAsset>("hero.fbx")` o `load<Texture>("Textures\\Default.dds")`
+     * (formato por la extensión). Los materiales no tienen archivo: @ref loadMaterial.
+     */
+    template<typename T>
+    ResourceHandle<T> load(const std::string& path);
+
+    /**
+     * @brief Ejecuta `work` en un hilo de carga (puede leer disco) y `done` con su
+     * resultado en el siguiente @ref update.
+     * @note Base de las corrutinas de AssetTask.h; `work` no debe tocar handles.
+     */
+    void runOnLoader(std::function<bool()> work, std::function<void(bool)> done);
+
+    /**
+     * @brief Como @ref runOnLoader, pero `work` va al `JobSystem` (decodificar, procesar:
+     * CPU sin esperas). Desde un hilo sin cola del `JobSystem` se ejecuta en el acto.
+     */
+    void runOnJobs(std::function<bool()> work, std::function<void(bool)> done);
+
+    /** @brief Llama a `callback` en el siguiente @ref update (hilo principal). */
+    void post(std::function<void()> callback);
+
+    /**
+     * @brief Publica lo terminado y encola lo que ya no espera a nadie (hilo principal,
+     * en la frontera de frame y después de `AsyncTextureLoader::update`).
+     * @return Recursos publicados en esta llamada.
+     */
+    unsigned int update();
+
+    /**
+     * @brief Espera a que no quede nada pendiente, publicándolo (y las texturas).
+     * @note Para el benchmark y las capturas: empezar con la escena completa.
+     */
+    void waitIdle();
+
+    /** @brief Nodos sin publicar (en cola, en curso o esperando dependencias). */
+    unsigned int getPendingCount() const { return static_cast<unsigned int>(m_nodes.size()); }
+
+    /** @brief Para los hilos (tras terminar lo que tengan en curso) y descarta lo pendiente. */
+    void destroy();
+
+private:
+    /// Nodo del grafo (solo hilo principal).
+    struct Node {
+        unsigned long long id;
+        std::vector<std::function<bool()>> dependencies; ///< Cada una: ¿terminó?
+        std::function<bool()> work;                      ///< En un hilo; nula = nada que hacer.
+        std::function<void(bool)> publish;               ///< Con el resultado de `work`.
+        bool nextUpdate = false;                         ///< De `post`: nunca en la llamada que lo creó.
+        bool onJobs = false;                             ///< Espera a un trabajo del `JobSystem`.
+        bool queued = false;
+        bool worked = false;
+        bool succeeded = true;
+    };
+
+    /// Lo que ve un hilo de carga.
+    struct Task {
+        unsigned long long id;
+        std::function<bool()> work;
+    };
+
+    /// Añade un nodo y lo devuelve para completarlo.
+    Node& addNode();
+
+    /// Bucle de cada hilo: toma tareas de la cola hasta `destroy`.
+    void workerLoop();
+
+    Device* m_device = nullptr;
+    MeshLibrary* m_meshes = nullptr;
+    MaterialLibrary* m_materials = nullptr;
+    AsyncTextureLoader* m_textures = nullptr;
+    std::vector<std::thread> m_workers;
+
+    std::mutex m_mutex;                  ///< Protege cola, resultados, `m_busy` y `m_stopping`.
+    std::condition_variable m_wake;      ///< Hay tareas o hay que parar.
+    std::condition_variable m_idle;      ///< Una tarea terminó (para `waitIdle`).
+    std::deque<Task> m_queue;
+    std::vector<std::pair<unsigned long long, bool>> m_results; ///< Id y éxito.
+    unsigned int m_busy = 0;
+    bool m_stopping = false;
+
+    std::vector<std::unique_ptr<Node>> m_nodes; ///< Sin publicar, en orden de petición.
+    unsigned long long m_nextId = 1;
+};
+
+template<> ResourceHandle<MeshAsset> ResourceManager::load<MeshAsset>(const std::string& path);
+template<> ResourceHandle<Texture> ResourceManager::load<Texture>(const std::string& path);
@@ -0,0 +1,206 @@
+﻿/**
+ * @file RigidBodySolver.h
+ * @brief Cuerpos rígidos: contactos de cajas, impulsos secuenciales por islas y reposo.
+ *
+ * @details
+ * Segunda pieza del módulo de física, detrás de `Broadphase`. Cada cuerpo es un
+ * componente de datos de `World` (@ref RigidBody) junto al `LocalTransform` de su
+ * entidad; @ref RigidBodySolver::step avanza todos en un paso fijo:
+ *
+ * 1. **Recogida**: una pasada por los chunks (`forEachChunk`) copia posición,
+ *    velocidad y caja a arreglos del solver. Nada de llamadas virtuales por actor.
+ * 2. **Gravedad** en los cuerpos despiertos y **fase amplia** con sus cajas.
+ * 3. **Contactos**: caja contra caja alineadas a los ejes; la normal es el eje de menor
+ *    penetración, así que masa efectiva, normal y tangentes salen por componentes.
+ * 4. **Islas**: union-find sobre los contactos entre cuerpos dinámicos (los estáticos
+ *    no unen islas). Una isla con algún cuerpo despierto despierta entera; las islas
+ *    dormidas no se resuelven ni se integran.
+ * 5. **Impulsos secuenciales** con **warm starting**: cada contacto arranca con el
+ *    impulso acumulado del paso anterior (caché por par de cuerpos), y la fricción se
+ *    limita por el impulso normal. Las islas pequeñas se reparten enteras entre los
+ *    hilos del `JobSystem`; en las grandes (@ref RigidBodySolver::kLargeIsland) los
+ *    contactos se **colorean** para que ninguno de un mismo color comparta un cuerpo
+ *    dinámico, y cada color se resuelve en paralelo.
+ * 6. **Integración** y **reposo**: un cuerpo lento acumula tiempo; una isla entera por
+ *    encima de @ref RigidBodySolver::kTimeToSleep se duerme con velocidad cero.
+ * 7. **Escritura**: otra pasada por los mismos chunks, en el mismo orden, deja las
+ *    posiciones en `LocalTransform` (marcadas `dirty` para `Transform::updateAll`).
+ *
+ * @note Para estudiantes: esta primera versión no rota los cuerpos (cajas alineadas,
+ * sin inercia angular) y pone un punto de contacto por par. Apilar cajas y empujarlas
+ * funciona; que vuelquen pide la parte angular.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "Broadphase.h"
+
+class World;
+class Actor;
+
+/**
+ * @struct RigidBody
+ * @brief Componente de datos (`World`) de un cuerpo rígido; crearlo con
+ * @ref RigidBodySolver::makeBody.
+ */
+struct RigidBody {
+    EU::Vector3 velocity;      ///< Velocidad lineal (m/s).
+    EU::Vector3 halfExtents;   ///< Media caja, centrada en la posición del `Transform`.
+    float inverseMass;         ///< 0 = estático (no se mueve ni se despierta).
+    float friction;            ///< Coeficiente de Coulomb.
+    float sleepTimer;          ///< Segundos seguidos por debajo de la velocidad de reposo.
+    uint32_t proxy;            ///< Cuerpo en la fase amplia del solver (`Broadphase::kInvalidBody` al crearlo).
+    bool sleeping;
+};
+
+/**
+ * @class RigidBodySolver
+ * @brief Paso fijo de los `RigidBody` del mundo: contactos, islas, impulsos y reposo.
+ */
+class RigidBodySolver {
+public:
+    RigidBodySolver() = default;
+    ~RigidBodySolver() = default;
+    RigidBodySolver(const RigidBodySolver&) = delete;
+    RigidBodySolver& operator=(const RigidBodySolver&) = delete;
+
+    /// Pasadas de impulsos por paso.
+    static const unsigned int kIterations = 8;
+    /// Contactos a partir de los cuales una isla se colorea y se resuelve por colores.
+    static const unsigned int kLargeIsland = 256;
+    /// Colores como mucho; los contactos que no caben van a un último grupo en serie.
+    static const unsigned int kMaxColors = 32;
+    /// Contactos mínimos por trabajo al resolver un color.
+    static const unsigned int kColorBatch = 64;
+    /// Velocidad por debajo de la cual un cuerpo cuenta tiempo de reposo (m/s).
+    static constexpr float kSleepSpeed = 0.05f;
+    /// Segundos de reposo de toda la isla para dormirla.
+    static constexpr float kTimeToSleep = 0.5f;
+    /// Fracción de la penetración que se corrige por paso (Baumgarte).
+    static constexpr float kBaumgarte = 0.2f;
+    /// Penetración tolerada sin corregir (evita temblores en reposo).
+    static constexpr float kSlop = 0.005f;
+
+    /**
+     * @brief Componente de un cuerpo listo para `World::add`.
+     * @param mass Masa en kg; 0 = estático.
+     * @param halfExtents Media caja.
+     * @param friction Coeficiente de fricción.
+     */
+    static RigidBody makeBody(float mass, const EU::Vector3& halfExtents, float friction = 0.5f);
+
+    /**
+     * @brief Añade un cuerpo a la entidad del `Transform` de un actor, con su caja actual.
+     * @return `false` si el actor no tiene `Transform` o geometría con caja.
+     */
+    static bool attach(Actor& actor, float mass, float friction = 0.5f);
+
+    /** @brief Gravedad (m/s²); por defecto (0, -9.8, 0). */
+    void setGravity(const XMFLOAT3& gravity) { m_gravity = gravity; }
+
+    /**
+     * @brief Avanza todos los cuerpos del mundo un paso fijo.
+     * @param world Mundo con las entidades `LocalTransform` + `RigidBody`.
+     * @param deltaTime Paso (s).
+     * @param parallel Repartir fase amplia, islas y colores entre los hilos del `JobSystem`.
+     * @note Antes de `Transform::updateAll`: las posiciones quedan marcadas `dirty`.
+     */
+    void step(World& world, float deltaTime, bool parallel = true);
+
+    /** @brief Olvida cuerpos, contactos y caché. */
+    void clear();
+
+    /** @brief Cuerpos del último paso. */
+    unsigned int getBodyCount() const { return static_cast<unsigned int>(m_position.size()); }
+
+    /** @brief Contactos resueltos en el último paso (los de islas dormidas no cuentan). */
+    unsigned int getContactCount() const { return static_cast<unsigned int>(m_order.size()); }
+
+    /** @brief Islas despiertas con contactos en el último paso. */
+    unsigned int getIslandCount() const { return static_cast<unsigned int>(m_islands.size()); }
+
+    /** @brief Cuerpos dinámicos dormidos tras el último paso. */
+    unsigned int getSleepingCount() const { return m_sleepingCount; }
+
+private:
+    /// Sin cuerpo (índices de solver y de isla).
+    static const uint32_t kNone = 0xFFFFFFFFu;
+
+    /// Contacto de un par de cajas; normal = `sign` en el eje `axis`, de `a` hacia `b`.
+    struct Contact {
+        uint32_t a;
+        uint32_t b;
+        uint64_t key;         ///< Par de cuerpos de la fase amplia (caché de warm starting).
+        uint8_t axis;
+        float sign;
+        float bias;           ///< Velocidad de separación que corrige la penetración.
+        float mass;           ///< 1 / (inversa de a + inversa de b).
+        float friction;
+        float normalImpulse;  ///< Acumulado (>= 0).
+        float tangentImpulse[2];
+    };
+
+    /// Impulsos de un contacto que sobreviven al paso.
+    struct WarmStart {
+        uint8_t axis;
+        float sign;
+        float normalImpulse;
+        float tangentImpulse[2];
+    };
+
+    /// Contactos de una isla despierta en `m_order`.
+    struct Island {
+        uint32_t first;
+        uint32_t count;
+    };
+
+    /// Raíz de la isla del cuerpo (con compresión de camino).
+    uint32_t findRoot(uint32_t body);
+
+    /// Aplica el impulso acumulado de un contacto a sus dos cuerpos.
+    void warmStart(const Contact& contact);
+
+    /// Una pasada de impulsos normal y de fricción sobre un contacto.
+    void solveContact(Contact& contact);
+
+    /// Islas pequeñas: cada una entera, en un solo hilo.
+    void solveIsland(const Island& island);
+
+    /// Isla grande: colores en paralelo.
+    void solveColored(const Island& island, bool parallel);
+
+    // === Cuerpos del paso (en el orden de los chunks) ===
+    std::vector<XMFLOAT3> m_position;
+    std::vector<XMFLOAT3> m_velocity;
+    std::vector<XMFLOAT3> m_halfExtents;
+    std::vector<float> m_inverseMass;
+    std::vector<float> m_friction;
+    std::vector<float> m_sleepTimer;
+    std::vector<uint8_t> m_sleeping;
+    std::vector<uint32_t> m_parent;     ///< Union-find de islas.
+    std::vector<uint8_t> m_rootAwake;   ///< La isla de esta raíz tiene algún cuerpo despierto.
+    std::vector<float> m_rootTimer;     ///< Menor tiempo de reposo de la isla de esta raíz.
+    unsigned int m_sleepingCount = 0;
+
+    // === Fase amplia ===
+    Broadphase m_broadphase;
+    std::vector<Broadphase::Pair> m_pairs;
+    std::vector<uint32_t> m_proxyBody;  ///< Cuerpo de cada proxy en este paso (`kNone` = ya no existe).
+    std::vector<uint8_t> m_proxyAlive;
+
+    // === Contactos e islas ===
+    std::vector<Contact> m_contacts;
+    std::vector<uint32_t> m_order;      ///< Contactos agrupados por isla (y por color en las grandes).
+    std::vector<Island> m_islands;
+    std::vector<uint32_t> m_smallIslands; ///< Islas de menos de `kLargeIsland` contactos.
+    std::vector<uint32_t> m_islandOf;   ///< Isla densa de cada raíz (`kNone` = dormida o sin contactos).
+    std::vector<uint32_t> m_colorMask;  ///< Colores usados por cada cuerpo (islas grandes).
+    std::vector<uint32_t> m_colorStart; ///< Inicio de cada color en `m_order` (isla grande en curso).
+    std::vector<uint8_t> m_contactColor; ///< Color de cada contacto de la isla grande en curso.
+    std::vector<uint32_t> m_scratch;    ///< Reordenación por colores.
+    EU::TMap<uint64_t, WarmStart> m_cache[2]; ///< Impulsos del paso anterior / de este.
+    unsigned int m_cacheIndex = 0;
+
+    XMFLOAT3 m_gravity = XMFLOAT3(0.0f, -9.8f, 0.0f);
+    float m_invDeltaTime = 0.0f;
+};
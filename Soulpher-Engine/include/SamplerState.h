@@ -39,6 +39,18 @@ public:
      */
     HRESULT init(Device& device);
 
+    /**
+     * @brief Inicializa un sampler de comparacin para leer shadow maps con PCF.
+     * @param device Dispositivo Direct3D donde se crear el estado.
+     * @return HRESULT que indica xito o error de la operacin.
+     *
+     * @note
+     * Con `SampleCmp` el hardware compara la profundidad de cada texel con la
+     * referencia y filtra los resultados (0/1) bilinealmente: cada muestra ya es
+     * un PCF 2x2. Fuera del mapa devuelve 1 (iluminado).
+     */
+    HRESULT initComparison(Device& device);
+
     /**
      * @brief Actualiza parmetros internos si es necesario.
      *
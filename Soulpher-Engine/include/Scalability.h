@@ -0,0 +1,139 @@
+﻿/**
+ * @file Scalability.h
+ * @brief Nivel de calidad automático según el hardware, con un micro-benchmark de
+ * arranque (relleno, vértices y trabajos) que se guarda en disco.
+ *
+ * @details
+ * Los valores por defecto de las cvars están pensados para una GPU de escritorio; en un
+ * portátil con gráfica integrada el primer arranque iba a 15 FPS hasta que alguien
+ * tocaba la consola. @ref Scalability::detect mide en menos de un segundo:
+ *
+ * - **Relleno** (`Scalability.fx`, `PSFill`): triángulos a pantalla completa sobre un
+ *   target RGBA8 de @ref Scalability::kFillSize², en Gpíxeles/s.
+ * - **Vértices** (`VSVertex`): un `Draw` de millones de vértices sin vertex buffer cuyos
+ *   triángulos caen fuera de la pantalla (el rasterizador los descarta), en Mvértices/s.
+ * - **CPU** (@ref JobSystem): lotes de trabajos pequeños con algo de cálculo, en
+ *   trabajos/ms; junta núcleos, velocidad de cada uno y coste de repartir.
+ *
+ * Los tiempos de GPU salen de un par de timestamps dentro de una query disjoint; se
+ * espera a propósito por ellos (solo en el arranque). Cada medida da un nivel con
+ * @ref Scalability::kThresholds y se queda el menor: el cuello de botella manda.
+ *
+ * El resultado va a @ref Scalability::kDefaultPath con la clave del adaptador (vendor,
+ * device y versión del driver): con otra GPU u otro driver se vuelve a medir.
+ * @ref Scalability::apply pone las cvars del nivel (`r.shadowMapSize`, `r.renderScale`,
+ * `r.taa`, `r.msaa`, `r.lodBias`, `r.textureBudgetMB`) solo si siguen en su valor por
+ * defecto: lo que venga de Engine.cfg, `-config` o `-cvar` manda sobre el nivel.
+ *
+ * @note Para estudiantes: un benchmark tan corto no dice cuántos FPS dará un nivel
+ * concreto; solo sitúa la máquina en una gama. El ajuste fino lo sigue haciendo
+ * `r.dynamicResolution` con el tiempo de GPU real.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+
+class Device;
+class DeviceContext;
+
+/**
+ * @enum ScalabilityTier
+ * @brief Gama de calidad, de menos a más exigente.
+ */
+enum ScalabilityTier {
+    SCALABILITY_LOW = 0,
+    SCALABILITY_MEDIUM,
+    SCALABILITY_HIGH,
+    SCALABILITY_EPIC,
+    SCALABILITY_TIER_COUNT
+};
+
+/**
+ * @class Scalability
+ * @brief Micro-benchmark de arranque, elección del nivel y su persistencia.
+ */
+class Scalability {
+public:
+    /// Archivo con el último resultado (junto a Engine.cfg).
+    static const char* const kDefaultPath;
+    /// Lado del target de la prueba de relleno.
+    static const unsigned int kFillSize = 2048;
+    /// Triángulos a pantalla completa de la prueba de relleno.
+    static const unsigned int kFillDraws = 16;
+    /// Vértices de cada draw de la prueba de vértices (múltiplo de 3).
+    static const unsigned int kVertexCount = 3 * 1000 * 1000;
+    /// Draws de la prueba de vértices.
+    static const unsigned int kVertexDraws = 4;
+    /// Trabajos de cada lote de la prueba de CPU (por debajo de `JobSystem::kJobsPerThread`).
+    static const unsigned int kJobsPerRound = 1024;
+    /// Tiempo máximo de la prueba de CPU (ms).
+    static const double kCpuMilliseconds;
+
+    /// Medidas del benchmark.
+    enum Metric {
+        METRIC_FILL = 0,        ///< Gpíxeles/s.
+        METRIC_VERTEX,          ///< Mvértices/s.
+        METRIC_JOBS,            ///< Trabajos/ms.
+        METRIC_COUNT
+    };
+
+    /// Mínimo de cada medida para llegar a Medium, High y Epic.
+    static const float kThresholds[METRIC_COUNT][SCALABILITY_TIER_COUNT - 1];
+
+    /// Valores de un nivel.
+    struct Settings {
+        unsigned int shadowMapSize;     ///< `r.shadowMapSize`.
+        float renderScale;              ///< `r.renderScale`, fracción de la ventana por eje.
+        bool taa;                       ///< `r.taa`.
+        int msaa;                       ///< `r.msaa` (solo en forward).
+        float lodBias;                  ///< `r.lodBias`: < 1 cambia antes a LODs más simples.
+        int textureBudgetMB;            ///< `r.textureBudgetMB` (0 = solo el del sistema).
+    };
+
+    /// Resultado del benchmark (o el leído de disco).
+    struct Result {
+        ScalabilityTier tier = SCALABILITY_HIGH;
+        float metrics[METRIC_COUNT] = {};
+        double milliseconds = 0.0;      ///< Duración del benchmark.
+        std::string adapterKey;         ///< `vendor:device driver` del adaptador medido.
+        bool measured = false;          ///< `false` = leído de @ref kDefaultPath.
+    };
+
+    /**
+     * @brief Lee el resultado guardado si es del mismo adaptador; si no, mide y lo guarda.
+     * @param device Dispositivo ya creado.
+     * @param deviceContext Contexto inmediato (el benchmark espera por sus queries).
+     * @param result Nivel y medidas.
+     * @param path Archivo del resultado.
+     * @return `S_OK`, o el error de la prueba de GPU (`result` queda en High).
+     */
+    static HRESULT detect(Device& device, DeviceContext& deviceContext, Result& result,
+        const std::string& path = kDefaultPath);
+
+    /** @brief Valores del nivel `tier`. */
+    static const Settings& getSettings(ScalabilityTier tier);
+
+    /**
+     * @brief Pone los valores de `tier` en sus cvars, salvo en las que ya no están en su
+     * valor por defecto (las ha fijado el usuario).
+     * @return Cvars que se cambiaron.
+     */
+    static unsigned int apply(ScalabilityTier tier);
+
+    /** @brief Nivel para unas medidas: el menor de los de cada una. */
+    static ScalabilityTier selectTier(const float metrics[METRIC_COUNT]);
+
+    /** @brief Nombre legible de un nivel. */
+    static const char* getTierName(ScalabilityTier tier);
+
+private:
+    /// Relleno y vértices; deja las medidas en `result`.
+    static HRESULT measureGpu(Device& device, DeviceContext& deviceContext, Result& result);
+    /// Trabajos por ms del sistema por defecto.
+    static float measureJobs();
+    /// Clave del adaptador del dispositivo (vacía si DXGI no responde).
+    static std::string getAdapterKey(Device& device);
+
+    static HRESULT load(const std::string& path, Result& result);
+    static HRESULT save(const std::string& path, const Result& result);
+};
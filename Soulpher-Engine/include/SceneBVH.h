@@ -0,0 +1,271 @@
+﻿/**
+ * @file SceneBVH.h
+ * @brief Jerarquía de volúmenes (BVH) de la escena: culling jerárquico y consultas espaciales.
+ *
+ * @details
+ * Probar cada actor contra el frustum es lineal en el número de actores, aunque casi
+ * todos estén detrás de la cámara. La BVH agrupa las cajas de los actores en un árbol
+ * binario de AABBs: si un nodo queda fuera, se descarta todo su subárbol con una prueba.
+ *
+ * - **Construcción SAH por bins**: en cada nodo, los centroides se reparten en
+ *   @ref SceneBVH::kBinCount cubetas por eje y se evalúa el coste de cortar entre cada par
+ *   (`área(izq) * n(izq) + área(der) * n(der)`). Se queda el corte más barato; si ninguno
+ *   mejora la hoja, el nodo se queda como hoja. O(n log n) y sin ordenar.
+ * - **Nodos compactos**: un arreglo plano de nodos de 32 bytes (dos por línea de caché).
+ *   Los dos hijos son consecutivos, así que un nodo solo guarda el índice del hijo
+ *   izquierdo (o el primer elemento y cuántos, en las hojas). Los padres van aparte: solo
+ *   los usa el reajuste.
+ * - **Culling jerárquico**: cada nodo se prueba solo contra los planos que su padre
+ *   cortaba. Un nodo completamente dentro de un plano lo quita de la máscara; con la
+ *   máscara vacía, el subárbol entero se acepta sin más pruebas.
+ * - **Varias vistas**: @ref SceneBVH::cullViews recorre el árbol una sola vez para hasta
+ *   @ref SceneBVH::kMaxViews frustums (pantalla partida, caras de sonda...). Cada nodo
+ *   lleva la máscara de vistas que aún lo ven y la de planos de cada una; un subárbol se
+ *   descarta cuando ninguna vista lo ve.
+ *
+ * Para los actores que se mueven, el árbol no se reconstruye cada frame:
+ *
+ * - @ref SceneBVH::setBounds marca la hoja del elemento que cambió y
+ *   @ref SceneBVH::update sube desde cada hoja marcada hasta que una caja deja de
+ *   cambiar. Mil actores quietos no cuestan nada.
+ * - En cada nodo reajustado se prueban las **rotaciones** que cambian un hijo por un
+ *   nieto del otro lado; se aplica la que más reduce el área del nodo intermedio. Así el
+ *   árbol se adapta a grupos que se separan o se juntan sin reconstruirlo.
+ * - El coste SAH se mantiene incremental. Si aun así pasa de
+ *   @ref SceneBVH::kRebuildRatio veces el de la última construcción, se reconstruye en un
+ *   hilo a partir de una copia de las cajas; mientras tanto se sigue reajustando el árbol
+ *   viejo y, al terminar, el nuevo se reajusta una vez con las cajas actuales.
+ *
+ * @note Para estudiantes: los identificadores son libres (el motor usa el índice en
+ * `m_actors`); la BVH no sabe nada de actores, solo de cajas.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include <atomic>
+#include <memory>
+#include <thread>
+
+class Frustum;
+
+/**
+ * @class SceneBVH
+ * @brief BVH de AABBs con construcción SAH, reajuste incremental, culling y consultas.
+ */
+class SceneBVH {
+public:
+    SceneBVH() = default;
+    ~SceneBVH() { cancelRebuild(); }
+    SceneBVH(const SceneBVH&) = delete;
+    SceneBVH& operator=(const SceneBVH&) = delete;
+
+    /// Cubetas por eje de la construcción SAH.
+    static const unsigned int kBinCount = 12;
+    /// Elementos por hoja a partir de los cuales ya no se prueba a cortar.
+    static const unsigned int kMaxLeafItems = 4;
+    /// Coste SAH (relativo al de la construcción) a partir del cual se reconstruye.
+    static constexpr float kRebuildRatio = 1.5f;
+    /// Vistas como mucho en @ref cullViews (un byte de máscara de planos por vista).
+    static const unsigned int kMaxViews = 8;
+
+    /// Elemento del árbol: una caja con un identificador.
+    struct Item {
+        unsigned int id = 0;
+        XMFLOAT3 boundsMin;
+        XMFLOAT3 boundsMax;
+    };
+
+    /// Resultado de @ref cullViews: un elemento y las vistas que lo ven.
+    struct ViewHit {
+        unsigned int id = 0;
+        uint32_t viewMask = 0;  ///< Bit `v` = lo ve `frusta[v]`.
+    };
+
+    /**
+     * @brief Prueba fina de un elemento para @ref raycastPacket.
+     * @param context Puntero que se pasó a `raycastPacket`.
+     * @param id Identificador del elemento.
+     * @param origin Origen del rayo.
+     * @param direction Dirección del rayo.
+     * @param boxT Entrada del rayo en la caja del elemento.
+     * @param inOutT Mejor impacto hasta ahora; se acorta si hay uno más cercano.
+     * @return `true` si acortó `inOutT`.
+     */
+    typedef bool (*RayItemTest)(const void* context, unsigned int id, const XMFLOAT3& origin,
+        const XMFLOAT3& direction, float boxT, float& inOutT);
+
+    /// Nodo compacto (32 bytes).
+    struct Node {
+        XMFLOAT3 boundsMin;
+        uint32_t leftFirst = 0; ///< Hijo izquierdo (el derecho es el siguiente) o primer elemento si es hoja.
+        XMFLOAT3 boundsMax;
+        uint32_t count = 0;     ///< Elementos de la hoja; 0 en los nodos interiores.
+    };
+
+    /**
+     * @brief Construye el árbol (descarta el anterior y una reconstrucción en curso).
+     * @param items Cajas en espacio mundo; se copian.
+     */
+    void build(const std::vector<Item>& items);
+
+    /**
+     * @brief Actualiza todas las cajas sin cambiar la topología.
+     * @param items Los mismos identificadores, en el mismo orden, que en @ref build.
+     * @return `false` si el conjunto cambió (hay que llamar a @ref build).
+     */
+    bool refit(const std::vector<Item>& items);
+
+    /**
+     * @brief Cambia la caja de un elemento; el árbol se reajusta en @ref update.
+     * @param item Posición del elemento en la lista de @ref build.
+     */
+    void setBounds(unsigned int item, const XMFLOAT3& boundsMin, const XMFLOAT3& boundsMax);
+
+    /**
+     * @brief Reajusta los nodos de las cajas cambiadas, rota y gestiona la reconstrucción.
+     * @details Adopta la reconstrucción en segundo plano si terminó; si no, sube desde
+     * las hojas marcadas por @ref setBounds. Lanza otra reconstrucción si el coste SAH
+     * pasa de @ref kRebuildRatio veces el de la última.
+     */
+    void update();
+
+    /** @brief Vacía el árbol. */
+    void clear();
+
+    /**
+     * @brief Identificadores de las cajas que tocan el frustum.
+     * @param frustum Planos de la cámara.
+     * @param outIds Se añaden al final (no se vacía).
+     * @return Nodos visitados (para las estadísticas).
+     */
+    unsigned int cull(const Frustum& frustum, std::vector<unsigned int>& outIds) const;
+
+    /**
+     * @brief Culling de varias vistas en un solo recorrido.
+     * @param frusta Planos de cada vista.
+     * @param viewCount Vistas (como mucho @ref kMaxViews; las demás se ignoran).
+     * @param outHits Cajas que ve alguna vista, con su máscara; se añaden al final.
+     * @return Nodos visitados (una vez por nodo, no por vista).
+     */
+    unsigned int cullViews(const Frustum* const* frusta, unsigned int viewCount, std::vector<ViewHit>& outHits) const;
+
+    /**
+     * @brief Identificadores de las cajas que se solapan con una AABB.
+     * @param outIds Se añaden al final (no se vacía).
+     */
+    void queryAABB(const XMFLOAT3& boundsMin, const XMFLOAT3& boundsMax, std::vector<unsigned int>& outIds) const;
+
+    /**
+     * @brief Caja más cercana que corta un rayo.
+     * @param origin Origen del rayo.
+     * @param direction Dirección (no hace falta normalizarla; `outT` va en sus unidades).
+     * @param maxT Distancia máxima.
+     * @param outId Identificador de la caja.
+     * @param outT Parámetro de entrada en la caja.
+     * @return `true` si hay impacto antes de `maxT`.
+     */
+    bool raycast(const XMFLOAT3& origin, const XMFLOAT3& direction, float maxT,
+        unsigned int& outId, float& outT) const;
+
+    /**
+     * @brief Recorre el árbol con cuatro rayos a la vez (un carril SSE por rayo).
+     * @param origins Orígenes de los cuatro rayos.
+     * @param directions Direcciones (sin normalizar; las distancias van en sus unidades).
+     * @param laneMask Carriles con rayo (bit `i` = rayo `i`).
+     * @param inOutT Distancia máxima de cada rayo; sale la del impacto más cercano.
+     * @param outIds Identificador del impacto de cada carril (sin tocar si no hay).
+     * @param test Prueba fina por elemento; `nullptr` = basta con la caja.
+     * @param context Se pasa tal cual a `test`.
+     * @return Máscara de carriles con un impacto nuevo.
+     *
+     * @details Un nodo se visita si algún carril activo lo corta antes de su mejor
+     * impacto; los rayos coherentes (línea de visión desde un mismo punto, picking de
+     * un área) comparten casi todo el recorrido y la prueba de caja cuesta una vez.
+     */
+    unsigned int raycastPacket(const XMFLOAT3 origins[4], const XMFLOAT3 directions[4], unsigned int laneMask,
+        float inOutT[4], unsigned int outIds[4], RayItemTest test = nullptr, const void* context = nullptr) const;
+
+    /**
+     * @brief Coste SAH del árbol, relativo al área de la raíz.
+     * @details Sube al reajustar cajas que se han separado; comparado con el de la última
+     * construcción indica cuándo compensa reconstruir.
+     */
+    float getCost() const;
+
+    /** @brief Coste SAH justo después de la última construcción. */
+    float getBuildCost() const { return m_buildCost; }
+
+    /** @brief Elementos del árbol. */
+    unsigned int getItemCount() const { return static_cast<unsigned int>(m_items.size()); }
+
+    /** @brief Nodos del árbol. */
+    unsigned int getNodeCount() const { return static_cast<unsigned int>(m_nodes.size()); }
+
+    /** @brief Número de construcciones completas (síncronas o en segundo plano) desde el arranque. */
+    unsigned int getBuildCount() const { return m_buildCount; }
+
+    /** @brief Nodos reajustados en el último @ref update. */
+    unsigned int getRefitCount() const { return m_refitCount; }
+
+    /** @brief Rotaciones aplicadas en el último @ref update. */
+    unsigned int getRotationCount() const { return m_rotationCount; }
+
+    /** @brief Hay una reconstrucción en segundo plano en curso. */
+    bool isRebuilding() const { return m_rebuildThread.joinable(); }
+
+private:
+    /// Padre de la raíz.
+    static const uint32_t kNoParent = 0xFFFFFFFFu;
+
+    /// Recalcula la caja de un nodo a partir de sus elementos o de sus hijos.
+    void computeBounds(const Node& node, XMFLOAT3& outMin, XMFLOAT3& outMax) const;
+
+    /// Corta el nodo por el mejor plano SAH y sigue por sus hijos.
+    void subdivide(uint32_t nodeIndex, const std::vector<XMFLOAT3>& centroids);
+
+    /// Padres, hoja de cada elemento y suma de áreas a partir de los nodos.
+    void linkNodes();
+
+    /// Reajusta todos los nodos (hijos antes que padres) y recalcula la suma de áreas.
+    void refitAll();
+
+    /// Sube desde las hojas marcadas; devuelve los nodos interiores tocados en `m_touched`.
+    void refitDirty();
+
+    /// Prueba las cuatro rotaciones hijo-nieto de un nodo interior y aplica la mejor.
+    bool rotate(uint32_t nodeIndex);
+
+    /// Intercambia el contenido de dos huecos y corrige padres y hojas.
+    void swapSlots(uint32_t a, uint32_t b);
+
+    /// Peso SAH de un nodo (coste de visitarlo por unidad de área).
+    static float getWeight(const Node& node);
+
+    /// Lanza la reconstrucción en un hilo con una copia de las cajas actuales.
+    void startRebuild();
+
+    /// Espera a la reconstrucción en curso y la descarta.
+    void cancelRebuild();
+
+    std::vector<Item> m_items;       ///< Cajas en el orden de entrada.
+    std::vector<uint32_t> m_indices; ///< Elementos ordenados por hoja (índices en `m_items`).
+    std::vector<Node> m_nodes;       ///< Raíz en 0; hijos consecutivos.
+    std::vector<uint32_t> m_parents; ///< Padre de cada nodo (`kNoParent` en la raíz).
+    std::vector<uint32_t> m_itemLeaf; ///< Hoja de cada elemento.
+    float m_areaSum = 0.0f;          ///< Suma SAH sin normalizar (área por peso de cada nodo).
+    float m_buildCost = 0.0f;
+    unsigned int m_buildCount = 0;
+
+    // === Reajuste incremental ===
+    std::vector<uint32_t> m_dirtyLeaves; ///< Hojas con elementos cambiados desde el último `update`.
+    std::vector<uint32_t> m_touched;     ///< Nodos interiores reajustados (candidatos a rotar).
+    std::vector<uint32_t> m_stamps;      ///< Último `m_epoch` en que se tocó cada nodo.
+    uint32_t m_epoch = 0;
+    unsigned int m_refitCount = 0;
+    unsigned int m_rotationCount = 0;
+
+    // === Reconstrucción en segundo plano ===
+    std::thread m_rebuildThread;
+    std::atomic<bool> m_rebuildDone{ false };
+    std::unique_ptr<SceneBVH> m_rebuilt; ///< Árbol que construye el hilo (solo lo toca él hasta `m_rebuildDone`).
+};
@@ -0,0 +1,211 @@
+﻿/**
+ * @file SceneFile.h
+ * @brief Escena binaria (`.sscene`): tablas SoA que se leen con un `memcpy` por sección.
+ *
+ * @details
+ * Hasta ahora la escena solo existía como código en `BaseApp::init`. Un `.sscene`
+ * guarda una instantánea de los actores con el mismo orden que `World`: **una columna
+ * por campo** (posiciones, rotaciones, escalas, padres, malla, material, color,
+ * banderas...), todas con una fila por entidad.
+ *
+ * - **Cabecera** + **tabla de secciones** (identificador, tamaño de elemento, posición y
+ *   bytes). Cada sección empieza alineada a 64 bytes. Las secciones desconocidas se
+ *   ignoran, así un archivo con secciones nuevas se sigue leyendo.
+ * - **Referencias**: la malla es su nombre (@ref MeshAsset::getSourceName: ruta del
+ *   modelo o clave de `MeshLibrary`) y el material, una fila de la tabla de materiales
+ *   cuya textura es una ruta. Todos los textos van a una tabla de cadenas sin repetidos.
+ * - **Componentes de datos** de `World` (p. ej. `Spin`): un blob por tipo con las
+ *   entidades que lo tienen y sus valores tal cual (son datos planos).
+ *
+ * Leer (@ref SceneFile::read) es mapear el archivo (a través de `VirtualFileSystem`,
+ * también desde un paquete) y copiar cada sección a su vector: con 50k entidades el
+ * coste es el de la lectura, no el de interpretar nada. @ref SceneFile::instantiate crea
+ * los actores como instancias de un `Prefab` por pareja malla/material y pide las
+ * mallas y texturas al `ResourceManager`.
+ *
+ * Guardar se parte en dos: @ref SceneFile::capture copia el estado de los actores en el
+ * hilo principal (solo lectura, sin tocar la GPU) y @ref SceneFile::saveAsync serializa y
+ * escribe en un hilo propio, a un temporal que se renombra al terminar. El autoguardado
+ * del editor no congela el frame y un cierre a medias no deja un archivo roto.
+ *
+ * @note Para estudiantes: guardar columnas en lugar de "un registro por actor" es lo que
+ * permite copiar en bloque; es el mismo motivo por el que `World` guarda SoA.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "ResourceManager.h"
+#include "ECS/ActorPool.h"
+#include "ECS/Prefab.h"
+#include "ECS/Transform.h"
+#include <atomic>
+#include <thread>
+#include <memory>
+
+/**
+ * @enum SceneEntityFlags
+ * @brief Bits de la columna de banderas.
+ */
+enum SceneEntityFlags {
+    SCENE_CAST_SHADOW = 1 << 0,
+    SCENE_RECEIVE_SHADOW = 1 << 1,
+    SCENE_STATIC = 1 << 2,
+    SCENE_TRANSPARENT = 1 << 3
+};
+
+/**
+ * @struct SceneMaterial
+ * @brief Fila de la tabla de materiales (los campos de `MaterialDesc` sin punteros).
+ */
+struct SceneMaterial {
+    uint32_t diffuse;       ///< Ruta de la textura en la tabla de cadenas (`SceneData::kNone` = sin textura).
+    XMFLOAT4 diffuseColor;
+    uint32_t blendMode;     ///< `MaterialBlendMode`.
+    float alphaCutoff;
+    uint32_t twoSided;
+};
+
+/**
+ * @struct SceneBlob
+ * @brief Valores de un componente de datos de `World` para las entidades que lo tienen.
+ */
+struct SceneBlob {
+    std::string type;                ///< Nombre con el que se registró (@ref SceneComponent).
+    uint32_t elementSize = 0;        ///< `sizeof` del componente al guardarlo.
+    std::vector<uint32_t> entities;  ///< Fila de cada valor.
+    std::vector<unsigned char> data; ///< `entities.size() * elementSize` bytes.
+};
+
+/**
+ * @struct SceneData
+ * @brief Escena en memoria: columnas por entidad y tablas compartidas.
+ */
+struct SceneData {
+    /// Referencia vacía (sin padre, sin malla, sin material).
+    static const uint32_t kNone = 0xFFFFFFFFu;
+
+    // === Columnas (una fila por entidad) ===
+    std::vector<EU::Vector3> positions;
+    std::vector<EU::Quaternion> rotations;
+    std::vector<EU::Vector3> scales;
+    std::vector<uint32_t> parents;          ///< Fila del padre o `kNone`.
+    std::vector<uint32_t> meshes;           ///< Nombre de la malla en `strings` o `kNone`.
+    std::vector<uint32_t> materials;        ///< Fila de `materialTable` o `kNone`.
+    std::vector<XMFLOAT4> colors;
+    std::vector<uint32_t> flags;            ///< @ref SceneEntityFlags.
+    std::vector<float> impostorDistances;
+    std::vector<uint32_t> names;            ///< Nombre del actor en `strings`.
+
+    // === Tablas ===
+    std::vector<std::string> strings;
+    std::vector<SceneMaterial> materialTable;
+    std::vector<SceneBlob> blobs;
+
+    /** @brief Entidades de la escena. */
+    uint32_t getEntityCount() const { return static_cast<uint32_t>(positions.size()); }
+
+    /** @brief Cambia el número de filas de todas las columnas. */
+    void resize(uint32_t count);
+
+    /** @brief Vacía columnas y tablas. */
+    void clear();
+};
+
+/**
+ * @struct SceneComponent
+ * @brief Componente de datos de `World` que viaja en la escena como blob.
+ *
+ * @code
+ * std::vector<SceneComponent> components = { SceneComponent::of<Spin>("Spin") };
+ * @endcode
+ */
+struct SceneComponent {
+    std::string type;
+    uint32_t elementSize = 0;
+    std::function<const void*(EntityID)> get;        ///< Valor de la entidad o `nullptr`.
+    std::function<void(EntityID, const void*)> add;  ///< Añade el componente con ese valor.
+
+    template<typename T>
+    static SceneComponent of(const std::string& type) {
+        SceneComponent component;
+        component.type = type;
+        component.elementSize = sizeof(T);
+        component.get = [](EntityID id) -> const void* { return World::getDefault().get<T>(id); };
+        component.add = [](EntityID id, const void* value) {
+            World::getDefault().add<T>(id, *static_cast<const T*>(value));
+        };
+        return component;
+    }
+};
+
+/**
+ * @class SceneFile
+ * @brief Captura, lectura, escritura (también en segundo plano) e instanciación de escenas.
+ */
+class SceneFile {
+public:
+    /// Pide la malla de un nombre de la escena (biblioteca, modelo en disco...).
+    typedef std::function<ResourceHandle<MeshAsset>(const std::string& name)> MeshResolver;
+
+    SceneFile() = default;
+    ~SceneFile() { waitSave(); }
+    SceneFile(const SceneFile&) = delete;
+    SceneFile& operator=(const SceneFile&) = delete;
+
+    /**
+     * @brief Copia el estado de los actores (hilo principal, con la simulación parada).
+     * @param actors Actores; los nulos se saltan (la fila es la posición entre los vivos).
+     * @param components Componentes de datos a guardar como blobs.
+     * @param scene Recibe la instantánea (se vacía antes).
+     * @note Las mallas sin nombre (procedurales) se guardan sin malla.
+     */
+    static void capture(const std::vector<ActorHandle>& actors,
+        const std::vector<SceneComponent>& components, SceneData& scene);
+
+    /**
+     * @brief Escribe la escena (a un temporal que se renombra al terminar).
+     * @return `S_OK`, o `E_FAIL` si no se pudo escribir.
+     */
+    static HRESULT write(const std::string& path, const SceneData& scene);
+
+    /**
+     * @brief Lee una escena (suelta o de un paquete montado).
+     * @return `S_OK`; `HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND)` si no existe, o `E_FAIL`
+     * si no es una escena de esta versión o está truncada.
+     */
+    static HRESULT read(const std::string& path, SceneData& scene);
+
+    /**
+     * @brief Crea los actores de la escena y pide sus recursos.
+     * @param device Dispositivo de los prefabs.
+     * @param scene Escena leída.
+     * @param resources Cargas de texturas y materiales (las mallas, con `meshes`).
+     * @param meshes Resuelve cada nombre de malla distinto una vez.
+     * @param components Componentes de datos que se restauran de los blobs.
+     * @param prefabs Recibe un prefab por pareja malla/material (debe vivir más que los actores).
+     * @param actors Recibe los actores, en el orden de las filas.
+     * @return `S_OK`, o el error del pool o de un prefab (los actores creados se quedan en `actors`).
+     *
+     * @note Cada actor recibe su malla y su material al publicarse (hasta entonces no se dibuja).
+     */
+    static HRESULT instantiate(Device& device, const SceneData& scene, ResourceManager& resources,
+        const MeshResolver& meshes, const std::vector<SceneComponent>& components,
+        std::vector<std::unique_ptr<Prefab>>& prefabs, std::vector<ActorHandle>& actors);
+
+    /**
+     * @brief Escribe `scene` en un hilo propio.
+     * @return `false` (y no hace nada) si aún hay un guardado en curso.
+     */
+    bool saveAsync(const std::string& path, SceneData&& scene);
+
+    /** @brief `true` mientras el hilo de guardado está escribiendo. */
+    bool isSaving() const { return m_saving.load(std::memory_order_acquire); }
+
+    /** @brief Espera al guardado en curso (si lo hay) y devuelve el resultado del último. */
+    HRESULT waitSave();
+
+private:
+    std::thread m_saver;
+    std::atomic<bool> m_saving{ false };
+    HRESULT m_lastResult = S_OK; ///< Lo escribe el hilo; se lee tras unirlo.
+};
@@ -0,0 +1,115 @@
+﻿/**
+ * @file SceneGenerator.h
+ * @brief Escenas sintéticas de N actores para medir cómo escala el render.
+ *
+ * @details
+ * Con `-stress N` (o `-stress 1000,10000,100000` para un barrido) se añaden a la
+ * escena N actores generados con una mezcla configurable (@ref SceneGenerator::Config):
+ * - **Mallas**: cajas procedurales de varias proporciones y teselados. Una fracción
+ *   (`uniqueMeshRatio`) recibe buffers propios; el resto son instancias de un `Prefab`
+ *   por variante y textura (malla y estados compartidos), así la `RenderQueue` puede
+ *   agruparlos en llamadas instanciadas.
+ * - **Texturas**: tableros de ajedrez generados en memoria, repartidos como
+ *   `TextureHandle` (una sola copia en GPU y un mismo `Texture*` para la cola).
+ * - **Materiales**: tintes (`Actor::setColor`) elegidos de una paleta.
+ * - **Estáticos / dinámicos** (`staticRatio`): los dinámicos giran cada paso de
+ *   simulación (@ref update) y obligan a redibujar sus cascadas de sombra.
+ * - **Casters** (`casterRatio`): fracción que proyecta sombra.
+ * - **Luces** (`lightCount`, `-lights N`): luces puntuales de colores repartidas sobre
+ *   la rejilla (@ref ClusteredLighting), para medir el sombreado por clusters.
+ *
+ * Los actores se colocan en una rejilla cuadrada sobre el suelo (y = -5) con una
+ * pequeña variación; el generador usa una semilla fija, así dos ejecuciones con la
+ * misma configuración producen exactamente la misma escena.
+ *
+ * @note Para estudiantes: un `Actor` suelto crea su propio constant buffer y estados;
+ * con 100k actores ese coste por objeto (y no la GPU) suele ser lo primero que se ve
+ * en la gráfica de frame time frente a número de actores. Las instancias de prefab
+ * no lo pagan; la fracción única sí, a propósito.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "Texture.h"
+#include "MeshAsset.h"
+#include "ECS/Actor.h"
+#include "ECS/ActorPool.h"
+#include "ECS/Prefab.h"
+#include <memory>
+
+class Device;
+class GeometryPool;
+class ClusteredLighting;
+
+/**
+ * @struct Spin
+ * @brief Componente de datos (`World`) de los actores dinámicos: giro en Y en rad/s.
+ */
+struct Spin {
+    float radiansPerSecond;
+};
+
+/**
+ * @class SceneGenerator
+ * @brief Crea, anima y libera los actores de una escena de estrés.
+ */
+class SceneGenerator {
+public:
+    SceneGenerator() = default;
+    ~SceneGenerator() = default;
+
+    /// Mezcla de la escena generada.
+    struct Config {
+        unsigned int actorCount = 1000;   ///< Actores a generar.
+        unsigned int meshVariants = 8;    ///< Cajas distintas (proporción y teselado).
+        float uniqueMeshRatio = 0.1f;     ///< Fracción con buffers propios (no instanciables).
+        unsigned int textureCount = 4;    ///< Texturas procedurales distintas.
+        unsigned int materialCount = 8;   ///< Tintes distintos.
+        float staticRatio = 0.75f;        ///< Fracción de actores estáticos.
+        float casterRatio = 0.5f;         ///< Fracción que proyecta sombra.
+        float spacing = 1.5f;             ///< Separación de la rejilla (unidades de mundo).
+        unsigned int seed = 1;            ///< Semilla: misma semilla, misma escena.
+        GeometryPool* pool = nullptr;     ///< Pool de las variantes compartidas (nulo = buffers propios).
+        float impostorDistance = 0.0f;    ///< `Actor::setImpostorDistance` de todos los actores (0 = sin impostor).
+        unsigned int lightCount = 0;      ///< Luces puntuales sobre la escena (sustituyen a las de `lights`).
+        ClusteredLighting* lights = nullptr; ///< Dónde se añaden (nulo = sin luces).
+    };
+
+    /**
+     * @brief Genera la escena y añade sus actores al final de `actors`.
+     * @param device Dispositivo para crear buffers y texturas.
+     * @param config Mezcla de la escena.
+     * @param actors Lista de actores de la aplicación.
+     * @return `S_OK`, o el primer error al crear mallas o texturas compartidas.
+     *
+     * @note Si ya había una escena generada, se libera antes (ver @ref destroy).
+     */
+    HRESULT generate(Device& device, const Config& config,
+        std::vector<ActorHandle>& actors);
+
+    /**
+     * @brief Gira los actores dinámicos un paso de simulación.
+     * @param deltaTime Duración del paso (s).
+     *
+     * @note Es una consulta `LocalTransform` + `Spin` sobre `World::getDefault()`: recorre
+     * los chunks de los dinámicos sin pasar por sus actores.
+     */
+    void update(float deltaTime);
+
+    /**
+     * @brief Quita de `actors` los actores generados y libera sus recursos.
+     * @param actors Lista de actores de la aplicación.
+     */
+    void destroy(std::vector<ActorHandle>& actors);
+
+    /** @brief Actores de la escena generada actual (0 si no hay). */
+    unsigned int getActorCount() const { return static_cast<unsigned int>(m_actors.size()); }
+
+private:
+    std::vector<ActorHandle> m_actors;                        ///< Actores generados.
+    std::vector<EU::TSharedPointer<MeshAsset>> m_sharedMeshes; ///< Un asset por variante.
+    std::vector<MeshComponent> m_meshes;                      ///< Geometría de cada variante (CPU).
+    std::vector<TextureHandle> m_textures;                    ///< Texturas procedurales.
+    std::vector<std::unique_ptr<Prefab>> m_prefabs;           ///< Uno por variante y textura.
+    unsigned int m_dynamicCount = 0;                          ///< Actores con `Spin`.
+};
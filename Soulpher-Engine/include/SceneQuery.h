@@ -0,0 +1,172 @@
+﻿﻿/**
+ * @file SceneQuery.h
+ * @brief Consultas espaciales en lote sobre la BVH de la escena: rayos y esferas.
+ *
+ * @details
+ * Línea de visión de la IA, colocación de objetos y picking piden lo mismo: "qué actor
+ * corta este rayo" o "qué actores tocan esta esfera", miles de veces por frame.
+ * @ref SceneQuery las resuelve en lote contra los dos árboles de la escena
+ * (`SceneBVH` estático y dinámico):
+ *
+ * - **Rayos**: de cuatro en cuatro (`SceneBVH::raycastPacket`, un carril SSE por rayo).
+ *   La caja del actor es solo el filtro: si su malla conserva los datos de CPU
+ *   (`MeshLibrary::setKeepCpuData`), el rayo se lleva al espacio del modelo y se prueba
+ *   contra los triángulos, descartando antes cada meshlet por su esfera. Sin datos de CPU,
+ *   el impacto es la caja (@ref SceneQuery::RayHit::triangle a `false`).
+ * - **Esferas**: `SceneBVH::queryAABB` con la caja de la esfera y, después, distancia
+ *   exacta de la esfera a la caja de cada actor.
+ *
+ * Los lotes se reparten entre los hilos del `JobSystem` (paquetes de rayos y esferas).
+ *
+ * Dos formas de pedirlas:
+ *
+ * - **Síncrona** (@ref SceneQuery::raycast, @ref SceneQuery::overlap): responde al
+ *   momento. Los árboles son los del último render: solo con el render parado.
+ * - **Asíncrona** (@ref SceneQuery::queueRay, @ref SceneQuery::queueOverlap): devuelve un
+ *   ticket desde cualquier hilo; `BaseApp::captureFrame` resuelve la cola con
+ *   @ref SceneQuery::execute y el resultado se lee en el frame siguiente con
+ *   @ref SceneQuery::getRayHit o @ref SceneQuery::getOverlap. Se conservan los dos
+ *   últimos lotes: quien pregunta un frame tarde aún lo encuentra.
+ *
+ * @note Para estudiantes: los árboles guardan índices de `m_actors`; la consulta trabaja
+ * con una copia de los handles del mismo frame (@ref SceneQuery::setScene), así los
+ * actores que se creen o destruyan entretanto no desordenan los índices.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "ECS/ActorPool.h"
+#include <cfloat>
+#include <mutex>
+
+class SceneBVH;
+class Actor;
+
+/**
+ * @class SceneQuery
+ * @brief Rayos y esferas contra los actores de la escena, en lote y en paralelo.
+ */
+class SceneQuery {
+public:
+    SceneQuery() = default;
+    ~SceneQuery() = default;
+    SceneQuery(const SceneQuery&) = delete;
+    SceneQuery& operator=(const SceneQuery&) = delete;
+
+    /// Paquetes de cuatro rayos (o esferas) como mínimo por lote del `JobSystem`.
+    static const unsigned int kMinBatch = 16;
+
+    /// Identificador de una consulta asíncrona (0 = ninguna).
+    typedef uint32_t Ticket;
+
+    /// Rayo en espacio mundo.
+    struct Ray {
+        XMFLOAT3 origin = XMFLOAT3(0.0f, 0.0f, 0.0f);
+        XMFLOAT3 direction = XMFLOAT3(0.0f, 0.0f, 1.0f); ///< Normalizada: las distancias van en unidades de mundo.
+        float maxDistance = FLT_MAX;
+    };
+
+    /// Impacto más cercano de un rayo.
+    struct RayHit {
+        bool hit = false;
+        bool triangle = false;      ///< Contra un triángulo (si no, contra la caja del actor).
+        ActorHandle actor;
+        float distance = FLT_MAX;
+        XMFLOAT3 position = XMFLOAT3(0.0f, 0.0f, 0.0f);
+        XMFLOAT3 normal = XMFLOAT3(0.0f, 0.0f, 0.0f); ///< Normal de la cara impactada (mundo).
+    };
+
+    /// Esfera en espacio mundo.
+    struct Sphere {
+        XMFLOAT3 center = XMFLOAT3(0.0f, 0.0f, 0.0f);
+        float radius = 0.0f;
+    };
+
+    /**
+     * @brief Fija los árboles y los actores a los que apuntan sus identificadores.
+     * @param staticTree Árbol de los actores estáticos.
+     * @param dynamicTree Árbol de los demás.
+     * @param actors Actores del frame (se copian los handles).
+     * @note Donde se actualizan los árboles (culling del render).
+     */
+    void setScene(const SceneBVH& staticTree, const SceneBVH& dynamicTree, const std::vector<ActorHandle>& actors);
+
+    /**
+     * @brief Lanza `count` rayos y espera sus impactos.
+     * @param rays Rayos.
+     * @param count Número de rayos.
+     * @param outHits Recibe `count` impactos, en el mismo orden.
+     */
+    void raycast(const Ray* rays, unsigned int count, RayHit* outHits) const;
+
+    /**
+     * @brief Actores que tocan cada esfera.
+     * @param spheres Esferas.
+     * @param count Número de esferas.
+     * @param outOffsets Recibe `count + 1` posiciones: los de la esfera `i` están en
+     * `[outOffsets[i], outOffsets[i + 1])` de `outActors`.
+     * @param outActors Actores de todas las esferas, seguidos.
+     */
+    void overlap(const Sphere* spheres, unsigned int count, std::vector<uint32_t>& outOffsets,
+        std::vector<ActorHandle>& outActors) const;
+
+    /** @brief Encola un rayo (cualquier hilo); se resuelve en el próximo @ref execute. */
+    Ticket queueRay(const Ray& ray);
+
+    /** @brief Encola una esfera (cualquier hilo); se resuelve en el próximo @ref execute. */
+    Ticket queueOverlap(const Sphere& sphere);
+
+    /**
+     * @brief Resultado de un rayo encolado.
+     * @return `false` si aún no se resolvió o ya se descartó (más de dos lotes atrás).
+     */
+    bool getRayHit(Ticket ticket, RayHit& outHit) const;
+
+    /**
+     * @brief Resultado de una esfera encolada.
+     * @return `false` si aún no se resolvió o ya se descartó.
+     */
+    bool getOverlap(Ticket ticket, std::vector<ActorHandle>& outActors) const;
+
+    /**
+     * @brief Resuelve la cola con los árboles de @ref setScene.
+     * @note Hilo principal, con el render parado (ver `BaseApp::captureFrame`).
+     */
+    void execute();
+
+    /** @brief Rayos y esferas resueltos en el último @ref execute. */
+    unsigned int getExecutedCount() const { return m_executedCount; }
+
+private:
+    /// Cola o resultados de un lote asíncrono (tickets crecientes).
+    struct Batch {
+        std::vector<Ticket> rayTickets;
+        std::vector<Ray> rays;
+        std::vector<RayHit> hits;
+        std::vector<Ticket> overlapTickets;
+        std::vector<Sphere> spheres;
+        std::vector<uint32_t> offsets;
+        std::vector<ActorHandle> actors;
+
+        void clear();
+    };
+
+    /// Impacto exacto de un rayo con un actor (triángulos o caja); con `outHit`, normal y tipo.
+    bool intersectActor(unsigned int id, const XMFLOAT3& origin, const XMFLOAT3& direction,
+        float boxT, float& inOutT, RayHit* outHit) const;
+
+    /// `SceneBVH::RayItemTest` sobre @ref intersectActor.
+    static bool testActor(const void* context, unsigned int id, const XMFLOAT3& origin,
+        const XMFLOAT3& direction, float boxT, float& inOutT);
+
+    const SceneBVH* m_trees[2] = {};
+    std::vector<ActorHandle> m_actors; ///< Handles por identificador de los árboles.
+
+    mutable std::mutex m_mutex;        ///< Protege `m_pending`, `m_completed` y `m_nextTicket`.
+    Batch m_pending;
+    Batch m_completed[2];              ///< Los dos últimos lotes resueltos.
+    unsigned int m_newest = 0;         ///< Lote de `m_completed` resuelto el último.
+    Ticket m_nextTicket = 1;
+    Batch m_running;                   ///< Lote que resuelve @ref execute (fuera del cerrojo).
+    unsigned int m_executedCount = 0;
+};
@@ -1,57 +1,133 @@
-﻿#pragma once
+﻿/**
+ * @file Screenshot.h
+ * @brief Capturas del back buffer leídas de la GPU sin parar el pipeline.
+ *
+ * @details
+ * Leer el back buffer en el mismo frame en que se dibuja obliga a la CPU a esperar
+ * a que la GPU termine todo lo encolado. En su lugar:
+ *
+ * 1. @ref update copia el back buffer (en la GPU) a una textura `STAGING` libre
+ *    del anillo.
+ * 2. @ref kLatencyFrames frames después se mapea con `DO_NOT_WAIT`; si la copia aún
+ *    no terminó, se reintenta el frame siguiente.
+ * 3. Las filas pasan a un hilo que convierte RGBA -> BGR y codifica el PNG con WIC
+ *    (Windows Imaging Component): el hilo principal solo hace un `memcpy` por captura.
+ *
+ * - La captura se toma antes de dibujar la UI: la imagen es la escena sola (lo que
+ *   necesitan las pruebas de regresión visual).
+ * - Varias capturas seguidas ocupan varias texturas del anillo; si no queda ninguna,
+ *   la petición espera al siguiente frame.
+ *
+ * @note Para estudiantes: un `Map` sobre una textura de staging que la GPU aún está
+ * escribiendo bloquea hasta que termina. Esperar unos frames (y pedir `DO_NOT_WAIT`)
+ * convierte esa espera en latencia, que para una captura no importa.
+ */
+
+#pragma once
 #include "Prerequisites.h"
-#include "UserInterface.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 
-class Window;
-class SwapChain;
+class Device;
+class DeviceContext;
 class Texture;
 
 /**
  * @class Screenshot
- * @brief Gestiona la captura de pantallas del contenido renderizado.
- *
- * @details
- * Esta clase permite capturar el contenido del **back buffer** y guardarlo como una imagen.
- * También ofrece una interfaz gráfica (UI) para que el usuario pueda
- * realizar capturas directamente desde el motor.
- *
- * 🔹 **Conceptos clave para estudiantes de videojuegos:**
- * - El **back buffer** es la imagen que se está renderizando en la GPU antes de mostrarse en pantalla.
- * - Capturarlo permite guardar "frames" exactos del renderizado.
- * - El proceso suele implicar copiar datos desde la GPU a la CPU y luego guardarlos en un formato de imagen.
- *
- * @note
- * En motores de juegos, la captura de pantalla puede usarse para depuración, marketing, o generar
- * imágenes de referencia para comparar mejoras gráficas.
+ * @brief Anillo de texturas de staging para capturas y un hilo que escribe los PNG.
  */
 class Screenshot {
 public:
-    Screenshot() = default;  ///< Constructor por defecto.
-    ~Screenshot() = default; ///< Destructor por defecto.
+    Screenshot() = default;
+    ~Screenshot() { destroy(); }
+
+    /// Frames entre la copia y el primer intento de lectura.
+    static const unsigned int kLatencyFrames = 2;
+    /// Texturas de staging del anillo (capturas en vuelo a la vez).
+    static const unsigned int kMaxInFlight = 4;
+
+    /**
+     * @brief Guarda el dispositivo y arranca el hilo de codificación.
+     * @return `E_POINTER` si el dispositivo es nulo.
+     */
+    HRESULT init(Device& device);
 
     /**
-     * @brief Captura una imagen del contenido actual del back buffer.
-     *
-     * @param window Ventana activa desde la cual se captura la imagen.
-     * @param swapChain Cadena de intercambio asociada (contiene el back buffer).
-     * @param backBuffer Textura que representa el contenido actual renderizado.
-     *
-     * @note
-     * El back buffer normalmente es una textura de la GPU; para guardarla como imagen,
-     * debe copiarse a una textura accesible por la CPU.
+     * @brief Pide una captura del próximo frame.
+     * @param path Archivo PNG de salida (se sobrescribe).
      */
-    void captureScreenshot(Window window, SwapChain swapChain, Texture& backBuffer);
+    void request(const std::string& path);
 
     /**
-     * @brief Dibuja la interfaz de usuario para la captura de pantalla.
-     *
-     * @param window Ventana activa.
-     * @param swapChain Cadena de intercambio asociada.
-     * @param backBuffer Textura actual que puede mostrarse o capturarse.
-     *
-     * @details
-     * Este método renderiza botones y opciones en la UI para que el usuario
-     * pueda capturar imágenes sin necesidad de comandos externos.
+     * @brief Copia el back buffer si hay peticiones y lee las capturas ya listas.
+     * @param deviceContext Contexto inmediato.
+     * @param backBuffer Back buffer del frame (antes de dibujar la UI y de `Present`).
      */
-    void ui(Window window, SwapChain swapChain, Texture& backBuffer);
+    void update(DeviceContext& deviceContext, Texture& backBuffer);
+
+    /**
+     * @brief Lee (esperando a la GPU) las capturas en vuelo y las pasa al hilo.
+     * @note Para el cierre: sin esto, las capturas de los últimos frames se perderían.
+     */
+    void flush(DeviceContext& deviceContext);
+
+    /** @brief Capturas pedidas que aún no están en disco. */
+    unsigned int getPendingCount() const;
+
+    /** @brief PNG escritos desde @ref init. */
+    unsigned long long getWrittenCount() const;
+
+    /**
+     * @brief Codifica una imagen RGBA8 como PNG (24 bits, sin alfa) con WIC.
+     * @param path Archivo de salida.
+     * @param width Ancho en píxeles.
+     * @param height Alto en píxeles.
+     * @param rgba Píxeles RGBA, fila a fila.
+     * @param rowPitch Bytes por fila de `rgba`.
+     * @return `S_OK` o el error de COM/WIC.
+     * @note El hilo que la llame tiene que haber inicializado COM (`CoInitializeEx`).
+     */
+    static HRESULT writePng(const std::string& path, unsigned int width, unsigned int height,
+        const unsigned char* rgba, unsigned int rowPitch);
+
+    /** @brief Termina de escribir lo pendiente, para el hilo y libera el anillo. */
+    void destroy();
+
+private:
+    /// Una textura de staging del anillo y la captura que contiene.
+    struct Slot {
+        ID3D11Texture2D* staging = nullptr;
+        D3D11_TEXTURE2D_DESC desc = {};
+        std::string path;
+        unsigned long long frame = 0; ///< Frame de la copia.
+        bool busy = false;            ///< Copia hecha, aún sin leer.
+    };
+
+    /// Imagen leída, a la espera del hilo.
+    struct Image {
+        std::string path;
+        unsigned int width;
+        unsigned int height;
+        std::vector<unsigned char> pixels; ///< RGBA, `width * 4` bytes por fila.
+    };
+
+    /// Copia un slot en una `Image` para el hilo. `false` si la GPU aún no terminó.
+    bool readback(DeviceContext& deviceContext, Slot& slot, bool wait);
+
+    /// Bucle del hilo: codifica imágenes hasta `destroy`.
+    void encoderLoop();
+
+    ID3D11Device* m_device = nullptr;     ///< Retenido (AddRef).
+    Slot m_slots[kMaxInFlight];
+    std::deque<std::string> m_requests;   ///< Peticiones sin copiar (hilo principal).
+    unsigned long long m_frame = 0;
+
+    mutable std::mutex m_mutex;           ///< Protege lo de abajo.
+    std::condition_variable m_wake;       ///< Hay imagen o hay que parar.
+    std::thread m_encoder;
+    std::deque<Image> m_images;           ///< Leídas, sin codificar.
+    unsigned int m_encoding = 0;          ///< Imágenes en codificación.
+    unsigned long long m_written = 0;
+    bool m_stopping = false;
 };
@@ -0,0 +1,139 @@
+﻿/**
+ * @file ShaderHotReload.h
+ * @brief Recarga en caliente de shaders: vigila los .fx y recompila en segundo plano.
+ *
+ * @details
+ * Cambiar un `.fx` obligaba a reiniciar la aplicación. Este sistema tiene un hilo que:
+ *
+ * 1. **Vigila** el directorio de los shaders con `ReadDirectoryChangesW` (solo le
+ *    interesan `.fx`, `.fxh`, `.hlsl` y `.hlsli`). Los editores guardan en varias
+ *    escrituras, así que espera @ref ShaderHotReload::kSettleMs sin cambios antes de avisar.
+ * 2. **Recompila** lo afectado: el hilo principal le pasa las variantes cargadas en la
+ *    `ShaderLibrary` (@ref ShaderLibrary::getVariants) y el hilo vuelve a calcular el
+ *    hash de cada fuente, includes incluidos. Solo las que cambiaron pasan por
+ *    `D3DCompile`; así una edición de `Instancing.fx` recompila sus permutaciones y no
+ *    las de otros archivos.
+ * 3. **Sustituye** en @ref ShaderHotReload::update, que el bucle llama con el render
+ *    parado (frontera de frame): el bytecode nuevo se convierte en objeto shader y
+ *    @ref ShaderLibrary::replace cambia los punteros de los `ShaderProgram` que lo usan.
+ *
+ * Si una variante no compila, se queda el shader anterior y el error del compilador
+ * va al registro (@ref ShaderHotReload::getLog), que el panel "Shaders" muestra en pantalla.
+ * El hilo principal nunca espera al compilador: solo crea objetos a partir de bytecode.
+ *
+ * Solo se recargan vertex y pixel shaders (los de `ShaderProgram`); los kernels de
+ * cómputo guardan su propio puntero y se recompilan al reiniciar.
+ *
+ * @note Para estudiantes: `ID3D11Device` se puede usar desde cualquier hilo, pero los
+ * programas los lee el render; por eso el cambio se hace entre frames y no al compilar.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "ShaderLibrary.h"
+#include <deque>
+#include <mutex>
+
+class Device;
+
+/**
+ * @class ShaderHotReload
+ * @brief Hilo que vigila los shaders y recompila las variantes cuyo fuente cambió.
+ */
+class ShaderHotReload {
+public:
+    ShaderHotReload() = default;
+    ~ShaderHotReload() { destroy(); }
+
+    /// Milisegundos sin cambios antes de recompilar (un guardado son varias escrituras).
+    static const unsigned int kSettleMs = 150;
+    /// Líneas del registro como máximo (las más antiguas se descartan).
+    static const unsigned int kMaxLogLines = 64;
+
+    /// Línea del registro de recargas.
+    struct LogLine {
+        std::string text;
+        bool error;
+    };
+
+    /**
+     * @brief Empieza a vigilar un directorio.
+     * @param device Dispositivo con la `ShaderLibrary` que se recarga.
+     * @param directory Carpeta de los shaders (y sus subcarpetas).
+     * @return Error si no se pudo abrir la carpeta o crear el hilo (sin recarga; el motor
+     * sigue funcionando).
+     */
+    HRESULT init(Device& device, const std::string& directory = ".");
+
+    /**
+     * @brief Sustituye las variantes ya recompiladas y, si hubo cambios, encarga la
+     * comparación de fuentes al hilo.
+     * @return Variantes sustituidas en esta llamada.
+     * @note Hilo principal, con el render parado.
+     */
+    unsigned int update();
+
+    /** @brief Para el hilo y cierra la carpeta (lo pendiente se descarta). */
+    void destroy();
+
+    /** @brief Hay un hilo vigilando. */
+    bool isWatching() const { return m_thread.joinable(); }
+
+    /** @brief El hilo está comparando o compilando. */
+    bool isCompiling() const;
+
+    /** @brief Registro de recargas y errores, del más antiguo al más reciente. */
+    const std::deque<LogLine>& getLog() const { return m_log; }
+
+    /** @brief Vacía el registro. */
+    void clearLog() { m_log.clear(); }
+
+    /** @brief Variantes sustituidas desde @ref init. */
+    unsigned int getReloadCount() const { return m_reloadCount; }
+
+    /** @brief Carpeta vigilada. */
+    const std::string& getDirectory() const { return m_directory; }
+
+private:
+    /// Variante recompilada (o que no compiló), a la espera de @ref update.
+    struct Result {
+        ShaderKey key;
+        uint64_t sourceHash;
+        ID3DBlob* bytecode;      ///< Nulo si falló.
+        std::string errors;      ///< Mensaje del compilador si falló.
+    };
+
+    /// Bucle del hilo: espera cambios en la carpeta o peticiones de comparación.
+    void threadLoop();
+
+    /// Lee las notificaciones completadas; true si alguna es de un shader.
+    bool readChanges();
+
+    /// Vuelve a pedir notificaciones a `ReadDirectoryChangesW`.
+    bool watch();
+
+    /// Compara las variantes pedidas con su fuente y compila las que cambiaron.
+    void compileChanged(const std::vector<ShaderLibrary::Variant>& variants);
+
+    /// Añade una línea al registro (hilo principal).
+    void log(const std::string& text, bool error);
+
+    Device* m_device = nullptr;
+    std::string m_directory;
+    HANDLE m_directoryHandle = INVALID_HANDLE_VALUE;
+    HANDLE m_changeEvent = nullptr;          ///< Evento de `m_overlapped`.
+    HANDLE m_requestEvent = nullptr;         ///< Hay variantes que comparar.
+    HANDLE m_stopEvent = nullptr;            ///< `destroy` en marcha.
+    OVERLAPPED m_overlapped = {};
+    std::vector<DWORD> m_notifyBuffer;       ///< `FILE_NOTIFY_INFORMATION` (alineado a DWORD).
+    std::thread m_thread;
+
+    mutable std::mutex m_mutex;              ///< Protege lo que sigue hasta `m_busy`.
+    std::vector<ShaderLibrary::Variant> m_requests; ///< Variantes a comparar.
+    std::vector<Result> m_results;           ///< Compilaciones terminadas.
+    bool m_changed = false;                  ///< La carpeta cambió y nadie ha pedido comparar.
+    bool m_busy = false;                     ///< Hay una petición en curso.
+
+    std::deque<LogLine> m_log;               ///< Solo hilo principal.
+    unsigned int m_reloadCount = 0;
+};
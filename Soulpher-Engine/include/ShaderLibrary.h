@@ -0,0 +1,296 @@
+﻿/**
+ * @file ShaderLibrary.h
+ * @brief Biblioteca de shaders compilados, compartida por todo el motor.
+ *
+ * @details
+ * Compilar HLSL con `D3DCompile` es lento (decenas de ms por shader).
+ * Antes cada `Actor` recompilaba `HybridEngine.fx` en su constructor; con cientos
+ * de actores eso sumaba segundos al arranque.
+ *
+ * La biblioteca compila cada combinación única de
+ * **(archivo, punto de entrada, perfil, defines)** una sola vez y entrega el mismo
+ * `ID3D11VertexShader`/`ID3D11PixelShader` (con `AddRef`) a todos los que lo pidan.
+ *
+ * - Quien recibe un shader lo libera con `SAFE_RELEASE` como siempre.
+ * - La biblioteca conserva su propia referencia hasta `destroy()`.
+ * - Para los vertex shaders también se conserva el bytecode, necesario para crear
+ *   Input Layouts.
+ *
+ * Caché en disco: antes de compilar se calcula un hash del código fuente (incluyendo
+ * los `#include "..."` de forma recursiva), de la clave y de los flags de compilación.
+ * Si `<directorio>/<hash>.cso` existe, el bytecode se lee de disco y se pasa directo a
+ * `CreateVertexShader`/`CreatePixelShader`; si no, se compila y se guarda ahí.
+ * Como la clave es el contenido, una carpeta de caché generada en otra máquina
+ * (p. ej. en el build) puede distribuirse tal cual junto a los `.fx`.
+ *
+ * Perfiles: @ref ShaderLibrary::profile elige el modelo del feature level del
+ * dispositivo (SM5 en 11_0, SM4.x en 10_x). Los `#include "..."` los resuelve la
+ * biblioteca, relativos al archivo que los contiene (igual que el hash de la caché).
+ * En Release se compila con `D3DCOMPILE_OPTIMIZATION_LEVEL3`.
+ *
+ * Recarga en caliente: cada variante recuerda el hash de su fuente y los
+ * `ShaderProgram` se registran en la biblioteca. @ref ShaderLibrary::replace cambia el
+ * objeto de una variante por uno recompilado (ver `ShaderHotReload`) y avisa a los
+ * programas que la usan; debe llamarse con el render parado.
+ *
+ * Layouts: antes de crear una variante (y al recargarla o cocinarla) sus `cbuffer` se
+ * comparan con los structs de C++ (@ref ConstantBufferLayouts); si no cuadran, la
+ * variante falla como si no compilara.
+ *
+ * Hilos: las peticiones (`get*Shader`) se pueden hacer desde varios hilos a la vez (el
+ * arranque compila en paralelo, ver `StartupGraph`). La compilación va fuera del cerrojo;
+ * si dos hilos piden la misma variante, los dos compilan y se queda la primera.
+ *
+ * @note Para estudiantes: los objetos shader de D3D11 son inmutables, así que
+ * compartirlos entre objetos es seguro.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <set>
+
+class Device;
+class ShaderProgram;
+
+/**
+ * @struct ShaderDefine
+ * @brief Macro de preprocesador pasada al compilador HLSL (`#define name value`).
+ */
+struct ShaderDefine {
+    std::string name;  ///< Nombre de la macro.
+    std::string value; ///< Valor (puede ser vacío).
+};
+
+/**
+ * @struct ShaderKey
+ * @brief Identifica una variante compilada de un shader.
+ */
+struct ShaderKey {
+    std::string fileName;              ///< Archivo HLSL.
+    std::string entryPoint;            ///< Función de entrada (p. ej. "VS").
+    std::string profile;               ///< Perfil (p. ej. "vs_5_0", ver `ShaderLibrary::profile`).
+    std::vector<ShaderDefine> defines; ///< Macros de la variante.
+
+    /**
+     * @brief Cadena canónica de la clave (defines ordenados por nombre).
+     * @return "archivo|entrada|perfil|A=1;B=2;".
+     */
+    std::string toString() const;
+};
+
+/**
+ * @class ShaderLibrary
+ * @brief Compila cada variante de shader una vez y comparte el objeto resultante.
+ */
+class ShaderLibrary {
+public:
+    ShaderLibrary() = default;
+    ~ShaderLibrary() = default;
+
+    /**
+     * @brief Devuelve el vertex shader de `key`, compilándolo si es la primera vez.
+     * @param device Dispositivo con el que se crea el shader.
+     * @param key Variante pedida.
+     * @param ppShader Recibe el shader (con su propia referencia).
+     * @param ppBytecode Opcional: recibe el bytecode (con referencia) para crear un Input Layout.
+     * @return HRESULT de la compilación o creación.
+     */
+    HRESULT getVertexShader(Device& device,
+        const ShaderKey& key,
+        ID3D11VertexShader** ppShader,
+        ID3DBlob** ppBytecode = nullptr);
+
+    /**
+     * @brief Devuelve el pixel shader de `key`, compilándolo si es la primera vez.
+     * @param device Dispositivo con el que se crea el shader.
+     * @param key Variante pedida.
+     * @param ppShader Recibe el shader (con su propia referencia).
+     * @return HRESULT de la compilación o creación.
+     */
+    HRESULT getPixelShader(Device& device,
+        const ShaderKey& key,
+        ID3D11PixelShader** ppShader);
+
+    /**
+     * @brief Devuelve el compute shader de `key` (perfil cs_5_0), compilándolo si es la primera vez.
+     * @param device Dispositivo con el que se crea el shader.
+     * @param key Variante pedida.
+     * @param ppShader Recibe el shader (con su propia referencia).
+     * @return HRESULT de la compilación o creación.
+     */
+    HRESULT getComputeShader(Device& device,
+        const ShaderKey& key,
+        ID3D11ComputeShader** ppShader);
+
+    /**
+     * @brief Devuelve el geometry shader de `key`, compilándolo si es la primera vez.
+     * @param device Dispositivo con el que se crea el shader.
+     * @param key Variante pedida.
+     * @param ppShader Recibe el shader (con su propia referencia).
+     * @return HRESULT de la compilación o creación.
+     */
+    HRESULT getGeometryShader(Device& device,
+        const ShaderKey& key,
+        ID3D11GeometryShader** ppShader);
+
+    /**
+     * @brief Devuelve el hull shader de `key` (solo 11_0), compilándolo si es la primera vez.
+     * @param device Dispositivo con el que se crea el shader.
+     * @param key Variante pedida.
+     * @param ppShader Recibe el shader (con su propia referencia).
+     * @return HRESULT de la compilación o creación.
+     */
+    HRESULT getHullShader(Device& device,
+        const ShaderKey& key,
+        ID3D11HullShader** ppShader);
+
+    /**
+     * @brief Devuelve el domain shader de `key` (solo 11_0), compilándolo si es la primera vez.
+     * @param device Dispositivo con el que se crea el shader.
+     * @param key Variante pedida.
+     * @param ppShader Recibe el shader (con su propia referencia).
+     * @return HRESULT de la compilación o creación.
+     */
+    HRESULT getDomainShader(Device& device,
+        const ShaderKey& key,
+        ID3D11DomainShader** ppShader);
+
+    /**
+     * @brief Compila HLSL desde archivo con las macros de `key`.
+     * @param key Archivo, entrada, perfil y defines.
+     * @param ppBlobOut Recibe el bytecode.
+     * @param errors Opcional: recibe los mensajes del compilador si falla.
+     * @return HRESULT de `D3DCompile` (o el de leer el archivo).
+     * @note No toca la biblioteca: se puede llamar desde cualquier hilo.
+     */
+    static HRESULT compile(const ShaderKey& key, ID3DBlob** ppBlobOut, std::string* errors = nullptr);
+
+    /**
+     * @brief Hash del fuente (con sus includes), la clave y los flags de compilación.
+     * @return Falso si no se pudo leer algún archivo.
+     * @note Sin estado: se puede llamar desde cualquier hilo.
+     */
+    static bool hashSource(const ShaderKey& key, uint64_t& hash);
+
+    /// Variante compilada tal como la ve la recarga en caliente.
+    struct Variant {
+        ShaderKey key;
+        ShaderType type;
+        uint64_t sourceHash; ///< Hash del fuente con el que se compiló.
+    };
+
+    /**
+     * @brief Deja el bytecode de `key` en la caché de disco sin crear ningún objeto
+     * (para `AssetCooker`: no necesita dispositivo).
+     * @param key Variante; el perfil decide para qué feature level queda cocinada.
+     * @param cachePath Recibe el archivo `.cso` de la variante.
+     * @return `S_OK` si se compiló, `S_FALSE` si ya estaba en la caché, o el error.
+     */
+    HRESULT cookToDisk(const ShaderKey& key, std::string& cachePath);
+
+    /** @brief Variantes cargadas (copia, para comparar su fuente en otro hilo). */
+    std::vector<Variant> getVariants() const;
+
+    /**
+     * @brief Sustituye el objeto de una variante cargada por el de `bytecode` y recarga
+     * los programas registrados que la usan.
+     * @param device Dispositivo con el que se crea el shader.
+     * @param key Variante (tiene que estar cargada).
+     * @param bytecode Bytecode nuevo (la biblioteca toma su propia referencia).
+     * @param sourceHash Hash del fuente de ese bytecode (también su nombre en la caché de disco).
+     * @return Error si no se pudo crear el objeto; la variante se queda como estaba.
+     * @warning Con el render parado: los programas cambian sus punteros.
+     */
+    HRESULT replace(Device& device, const ShaderKey& key, ID3DBlob* bytecode, uint64_t sourceHash);
+
+    /** @brief Registra un programa para que @ref replace lo recargue. */
+    void addProgram(ShaderProgram* program);
+
+    /** @brief Quita un programa del registro (en su `destroy`). */
+    void removeProgram(ShaderProgram* program);
+
+    /**
+     * @brief Perfil de una etapa para un feature level: `_5_0` en 11_0, `_4_1` en 10_1
+     * y `_4_0` por debajo (p. ej. "vs_5_0").
+     * @return Vacío si la etapa no existe en ese nivel (hull/domain por debajo de 11_0).
+     */
+    static std::string profile(ShaderType type, D3D_FEATURE_LEVEL featureLevel);
+
+    /**
+     * @brief Carpeta de la caché de bytecode (por defecto "ShaderCache").
+     * @param directory Ruta relativa al directorio de trabajo o absoluta.
+     */
+    void setCacheDirectory(const std::string& directory) { m_cacheDirectory = directory; }
+
+    /** @brief Activa o desactiva la caché en disco (la caché en memoria siempre está activa). */
+    void setDiskCacheEnabled(bool enable) { m_diskCache = enable; }
+
+    /** @brief Variantes cargadas desde disco sin compilar. */
+    unsigned int getDiskHitCount() const { return m_diskHits; }
+
+    /**
+     * @brief Suelta las referencias de la biblioteca.
+     * @warning Llamar antes de liberar el `ID3D11Device`.
+     */
+    void destroy();
+
+    /** @brief Número de variantes compiladas. */
+    unsigned int getShaderCount() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return static_cast<unsigned int>(m_entries.size());
+    }
+
+    /** @brief Peticiones servidas sin compilar. */
+    unsigned int getHitCount() const { return m_hits; }
+
+private:
+    /// Variante compilada: bytecode + objeto shader del tipo correspondiente.
+    struct Entry {
+        ShaderKey key;
+        ShaderType type = VERTEX_SHADER;
+        uint64_t sourceHash = 0;
+        ID3DBlob* bytecode = nullptr;
+        ID3D11VertexShader* vertexShader = nullptr;
+        ID3D11PixelShader* pixelShader = nullptr;
+        ID3D11ComputeShader* computeShader = nullptr;
+        ID3D11GeometryShader* geometryShader = nullptr;
+        ID3D11HullShader* hullShader = nullptr;
+        ID3D11DomainShader* domainShader = nullptr;
+    };
+
+    /// Busca la variante o la compila; devuelve nullptr si falla.
+    Entry* acquire(Device& device, const ShaderKey& key, ShaderType type, HRESULT& hr);
+
+    /// Crea en `entry` el objeto de su tipo a partir de `entry.bytecode`.
+    static HRESULT createShader(Device& device, Entry& entry);
+
+    /// Suelta los objetos y el bytecode de una variante.
+    static void release(Entry& entry);
+
+    /// Lee el bytecode de la caché en disco o compila y lo guarda; `hash` recibe el del fuente.
+    HRESULT loadOrCompile(const ShaderKey& key, ID3DBlob** ppBlobOut, uint64_t& hash);
+
+    /// Archivo de la caché en disco para un hash de fuente.
+    std::string getCachePath(uint64_t hash) const;
+
+    /// Guarda el bytecode en `<directorio>/<hash>.cso` (un fallo no es fatal).
+    void saveToCache(uint64_t hash, ID3DBlob* bytecode) const;
+
+    /// Añade al hash el archivo `path` y, recursivamente, sus `#include "..."`.
+    static bool hashFile(const std::string& path, uint64_t& hash, std::set<std::string>& visited);
+
+    /// Flags de compilación: depuración en Debug, `OPTIMIZATION_LEVEL3` en Release.
+    static DWORD compileFlags();
+
+    mutable std::mutex m_mutex;                    ///< Protege `m_entries` y `m_programs`.
+    std::map<std::string, Entry> m_entries;        ///< Variantes por clave canónica.
+    std::vector<ShaderProgram*> m_programs;        ///< Programas que @ref replace recarga.
+    std::string m_cacheDirectory = "ShaderCache";  ///< Carpeta de bytecode en disco.
+    bool m_diskCache = true;                       ///< Caché en disco activa.
+    std::atomic<unsigned int> m_hits{ 0 };         ///< Aciertos de la biblioteca.
+    std::atomic<unsigned int> m_diskHits{ 0 };     ///< Variantes leídas de disco.
+};
@@ -0,0 +1,111 @@
+﻿/**
+ * @file ShaderPermutations.h
+ * @brief Variantes de un .fx elegidas por palabras clave y compiladas al pedirlas.
+ *
+ * @details
+ * Un mismo .fx tiene varias versiones según lo que el draw necesite (`TEXTURE_ARRAY`,
+ * `GPU_DRIVEN`, `ALPHA_TEST`...). Cada palabra clave es un `#define` y el código de
+ * cada característica va entre `#ifdef`, así una variante solo lleva lo que usa: sin
+ * ramas en tiempo de ejecución y sin copiar el archivo.
+ *
+ * Este conjunto asigna un bit a cada palabra clave de su archivo. Una combinación de
+ * bits (@ref ShaderPermutations::Features) es una variante:
+ *
+ * - **Bajo demanda** (@ref ShaderPermutations::get): se compila la primera vez que se
+ *   pide; las siguientes devuelven el mismo `ShaderProgram`. Una variante que no compila
+ *   se recuerda y no se reintenta en cada frame.
+ * - **Layout**: cada variante puede leer streams distintos (p. ej. `TEXTURE_ARRAY` añade
+ *   la capa en el slot 2), así que el input layout lo construye una función del conjunto.
+ * - **Caché**: debajo está la `ShaderLibrary`, que reutiliza el bytecode en memoria y en
+ *   disco (`ShaderCache/<hash>.cso`).
+ * - **Lista de precompilación** (@ref ShaderPermutations::precompile): en Release las
+ *   variantes conocidas se compilan al arrancar (`ShaderVariants.txt`) para que ninguna
+ *   lo haga en mitad de una partida; con la caché de disco distribuida, solo se leen.
+ *
+ * @note Para estudiantes: el número de variantes crece como 2^palabras clave; por eso
+ * se compilan solo las que se piden, no todas las combinaciones.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "ShaderProgram.h"
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <set>
+
+class Device;
+
+/**
+ * @class ShaderPermutations
+ * @brief Variantes de un archivo HLSL por combinación de palabras clave.
+ */
+class ShaderPermutations {
+public:
+    /// Bits de palabras clave (el bit `i` es la palabra clave `i` de @ref init).
+    typedef uint32_t Features;
+    /// Palabras clave como máximo por archivo.
+    static const unsigned int kMaxKeywords = 32;
+    /// Input layout de una variante.
+    typedef std::function<std::vector<D3D11_INPUT_ELEMENT_DESC>(Features)> LayoutBuilder;
+
+    ShaderPermutations() = default;
+    ~ShaderPermutations() { destroy(); }
+
+    /**
+     * @brief Declara el archivo y sus palabras clave (no compila nada).
+     * @param device Dispositivo con el que se compilarán las variantes.
+     * @param fileName Archivo HLSL con las entradas "VS" y "PS".
+     * @param keywords Macros que activan cada característica, en orden de bit.
+     * @param layout Input layout de cada combinación.
+     * @return `E_INVALIDARG` con más de @ref kMaxKeywords palabras clave o sin layout.
+     */
+    HRESULT init(Device& device, const std::string& fileName,
+        const std::vector<std::string>& keywords, LayoutBuilder layout);
+
+    /** @brief Bit de `keyword` (0 si el archivo no la declara). */
+    Features feature(const std::string& keyword) const;
+
+    /**
+     * @brief Variante con las características `features`, compilándola si es la primera vez.
+     * @return Nulo si no compila (el error se registra una sola vez).
+     */
+    ShaderProgram* get(Features features);
+
+    /**
+     * @brief Compila las variantes de este archivo que aparecen en una lista.
+     * @param listPath Archivo de texto: una variante por línea, `<archivo.fx> [PALABRA...]`;
+     * `#` empieza un comentario. Las líneas de otros archivos se ignoran.
+     * @return Variantes compiladas (las que ya lo estaban no cuentan).
+     */
+    unsigned int precompile(const std::string& listPath);
+
+    /**
+     * @brief Claves del VS y el PS de una variante (las mismas que pedirá su
+     * `ShaderProgram`), para compilarlas antes en otro hilo (@ref ResourceManager).
+     */
+    std::vector<ShaderKey> getKeys(Features features) const;
+
+    /** @brief Libera todas las variantes. */
+    void destroy();
+
+    /** @brief Archivo HLSL del conjunto. */
+    const std::string& getFileName() const { return m_fileName; }
+
+    /** @brief Variantes compiladas. */
+    unsigned int getVariantCount() const { return static_cast<unsigned int>(m_variants.size()); }
+
+    /** @brief Variantes que no compilaron. */
+    unsigned int getFailedCount() const { return static_cast<unsigned int>(m_failed.size()); }
+
+private:
+    /// `#define` de cada bit activo.
+    std::vector<ShaderDefine> definesFor(Features features) const;
+
+    Device* m_device = nullptr;
+    std::string m_fileName;
+    std::vector<std::string> m_keywords;
+    LayoutBuilder m_layout;
+    std::map<Features, ShaderProgram> m_variants; ///< Nodos estables: los punteros no cambian.
+    std::set<Features> m_failed;
+};
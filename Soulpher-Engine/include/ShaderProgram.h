@@ -1,6 +1,7 @@
 ﻿#pragma once
 #include "Prerequisites.h"
 #include "InputLayout.h"
+#include "ShaderLibrary.h"
 
 class Device;
 class DeviceContext;
@@ -41,6 +42,33 @@ public:
         const std::string& fileName,
         std::vector<D3D11_INPUT_ELEMENT_DESC> Layout);
 
+    /**
+     * @brief Igual que @ref init, compilando una variante con macros de preprocesador.
+     * @param defines Macros (p. ej. `TEXTURE_ARRAY`); forman parte de la clave de la
+     * `ShaderLibrary`, así cada variante se compila una sola vez.
+     */
+    HRESULT init(Device& device,
+        const std::string& fileName,
+        std::vector<D3D11_INPUT_ELEMENT_DESC> Layout,
+        const std::vector<ShaderDefine>& defines);
+
+    /**
+     * @brief Inicializa un programa solo con Vertex Shader e Input Layout (sin Pixel Shader).
+     * @param device Dispositivo Direct3D para la creación de recursos.
+     * @param fileName Archivo HLSL con la entrada "VS".
+     * @param Layout Descriptores del formato de vértices (Input Layout).
+     * @return HRESULT con el estado de la operación.
+     *
+     * @note `render()` enlaza un Pixel Shader nulo: la GPU solo escribe profundidad,
+     * que es lo que necesitan el pre-pase de profundidad y los mapas de sombra.
+     */
+    HRESULT initVertexOnly(Device& device,
+        const std::string& fileName,
+        std::vector<D3D11_INPUT_ELEMENT_DESC> Layout);
+
+    /** @brief `true` si el programa no tiene Pixel Shader (solo profundidad). */
+    bool isVertexOnly() const { return m_vertexOnly; }
+
     /** @brief Actualiza el estado del programa de shaders (actualmente no realiza cambios). */
     void update();
 
@@ -63,6 +91,16 @@ public:
     /** @brief Libera los recursos asociados a los shaders e Input Layout. */
     void destroy();
 
+    /**
+     * @brief Vuelve a pedir a la biblioteca la etapa que usa la variante `variant`.
+     * @param device Dispositivo Direct3D.
+     * @param variant Clave canónica (`ShaderKey::toString`) de la variante recompilada.
+     * @return `S_FALSE` si el programa no la usa. Si el VS nuevo no encaja con el
+     * Input Layout, el programa conserva el anterior.
+     * @note Lo llama `ShaderLibrary::replace`, con el render parado.
+     */
+    HRESULT reload(Device& device, const std::string& variant);
+
     /**
      * @brief Crea el Input Layout del programa.
      * @param device Dispositivo Direct3D.
@@ -76,6 +114,9 @@ public:
      * @param device Dispositivo Direct3D.
      * @param type Tipo de shader a crear.
      * @return HRESULT con el estado de la operación.
+     *
+     * @note Pasa por la `ShaderLibrary` del dispositivo: cada (archivo, entrada, perfil)
+     * se compila una sola vez y todos los programas comparten el mismo objeto.
      */
     HRESULT CreateShader(Device& device, ShaderType type);
 
@@ -110,7 +151,14 @@ public:
     ID3D11PixelShader* m_PixelShader = nullptr;   ///< Shader de píxeles.
     InputLayout m_inputLayout;                    ///< Input Layout asociado.
 private:
+    /// Clave de la etapa `type` con el perfil del dispositivo.
+    ShaderKey makeKey(Device& device, ShaderType type) const;
+
     std::string m_shaderFileName;                 ///< Nombre del archivo del shader.
+    std::vector<D3D11_INPUT_ELEMENT_DESC> m_layout; ///< Para recrear el Input Layout al recargar.
+    ShaderLibrary* m_library = nullptr;           ///< Donde está registrado (recarga en caliente).
+    std::vector<ShaderDefine> m_defines;          ///< Macros de la variante.
     ID3DBlob* m_vertexShaderData = nullptr;       ///< Bytecode del Vertex Shader.
     ID3DBlob* m_pixelShaderData = nullptr;        ///< Bytecode del Pixel Shader.
+    bool m_vertexOnly = false;                    ///< Creado con `initVertexOnly` (PS nulo).
 };
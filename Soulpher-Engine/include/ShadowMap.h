@@ -0,0 +1,181 @@
+﻿/**
+ * @file ShadowMap.h
+ * @brief Cascaded shadow maps de la luz principal con cascadas estáticas en caché.
+ *
+ * @details
+ * Sustituye a la sombra plana por actor (que redibujaba cada malla aplastada contra
+ * el suelo). Ahora:
+ * - La distancia de sombra de la cámara se divide en @ref kCascadeCount tramos
+ *   (mezcla de reparto logarítmico y uniforme). Cada tramo tiene su propia
+ *   ortográfica, ajustada a la esfera que envuelve ese trozo del frustum, y su
+ *   capa en un `Texture2DArray` D32.
+ * - Los *casters* se envían a una `RenderQueue` por cascada con la vista de la luz y
+ *   se dibujan con los programas solo-profundidad (lotes instanciados incluidos).
+ * - Los *receptores* usan los programas `ShadowReceiver*.fx`: eligen la cascada por
+ *   su profundidad en vista y comparan con esa capa (`SampleCmp`, 3x3 muestras).
+ *
+ * Coste acotado:
+ * - La cascada 0 (la más cercana) se redibuja cada frame.
+ * - De las lejanas se redibuja **como mucho una por frame**, por turnos, y solo si lo
+ *   necesita: contiene casters dinámicos, cambió su ajuste (la luz o la cámara se
+ *   movió lo suficiente) o se invalidó porque un caster estático se movió.
+ * - Para que la caché sirva, las lejanas se ajustan con margen (@ref kCachePadding)
+ *   y su centro se redondea a una rejilla: la cámara puede moverse dentro del margen
+ *   sin cambiar la matriz. Cada cascada conserva la matriz con la que se dibujó, de
+ *   modo que los receptores siempre la leen de forma coherente.
+ *
+ * La luz es direccional: su dirección va de `m_LightPos` hacia el origen.
+ *
+ * Recursos de los receptores: t1 (array de cascadas), s1 (comparación), b3 (`CBShadow`).
+ *
+ * @note Para estudiantes: el *shadow acne* (franjas en superficies iluminadas) aparece
+ * porque el mapa tiene resolución finita; se corrige con sesgo de profundidad en el
+ * rasterizador del pase de sombra y un pequeño sesgo extra al comparar.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "Viewport.h"
+#include "Rasterizer.h"
+#include "SamplerState.h"
+#include "ConstantBuffer.h"
+#include "Frustum.h"
+
+class Device;
+class DeviceContext;
+
+/**
+ * @class ShadowMap
+ * @brief Array de cascadas de profundidad desde la luz + constantes y estados para usarlo.
+ */
+class ShadowMap {
+public:
+    ShadowMap() = default;
+    ~ShadowMap() = default;
+
+    /// Número de cascadas (debe coincidir con `CBShadow` y los .fx receptores).
+    static const unsigned int kCascadeCount = 4;
+    /// Resolución por defecto de cada cascada (texels por lado).
+    static const unsigned int kDefaultSize = 1024;
+    /// Registro `t#` del array en los shaders receptores.
+    static const unsigned int kTextureSlot = 1;
+    /// Registro `s#` del sampler de comparación.
+    static const unsigned int kSamplerSlot = 1;
+    /// Distancia máxima (en vista) con sombra.
+    static const float kShadowDistance;
+    /// Mezcla del reparto: 0 = uniforme, 1 = logarítmico.
+    static const float kSplitLambda;
+    /// Margen relativo al radio de las cascadas cacheables.
+    static const float kCachePadding;
+
+    /**
+     * @brief Crea el array (R32_TYPELESS, una DSV D32_FLOAT por capa, SRV R32_FLOAT) y sus estados.
+     * @param device Dispositivo Direct3D.
+     * @param size Texels por lado de cada cascada.
+     * @return `S_OK` o el error; con error el objeto queda desactivado (sin sombras).
+     */
+    HRESULT init(Device& device, unsigned int size = kDefaultSize);
+
+    /**
+     * @brief Reparte el frustum de la cámara y reajusta las cascadas.
+     * @param lightPos Posición de la luz; la dirección es `lightPos -> origen`.
+     * @param view Vista de la cámara.
+     * @param projection Proyección en perspectiva de la cámara.
+     * @param nearZ Plano cercano de la cámara.
+     * @param farZ Plano lejano de la cámara.
+     * @param sceneMin Esquina mínima de la AABB de los casters (alarga el volumen hacia la luz).
+     * @param sceneMax Esquina máxima.
+     *
+     * @note Una cascada cuyo ajuste cambia queda pendiente de redibujar.
+     */
+    void update(const XMFLOAT4& lightPos, const XMMATRIX& view, const XMMATRIX& projection,
+        float nearZ, float farZ, const XMFLOAT3& sceneMin, const XMFLOAT3& sceneMax);
+
+    /** @brief Marca todas las cascadas para redibujar (p. ej. se movió un caster estático). */
+    void invalidate();
+
+    /**
+     * @brief Indica si una AABB de mundo cae dentro del volumen de una cascada.
+     * @param cascade Índice de cascada.
+     * @param boundsMin Esquina mínima.
+     * @param boundsMax Esquina máxima.
+     */
+    bool intersects(unsigned int cascade, const XMFLOAT3& boundsMin, const XMFLOAT3& boundsMax) const;
+
+    /**
+     * @brief Decide qué cascadas se dibujan este frame.
+     * @param hasDynamicCasters Por cascada, si algún caster dinámico la toca.
+     * @param outCascades Salida: la 0 y, como mucho, una lejana.
+     */
+    void schedule(const bool hasDynamicCasters[kCascadeCount], std::vector<unsigned int>& outCascades);
+
+    /**
+     * @brief Prepara el pase de una cascada: su DSV (sin RTV), viewport y cámara de la luz.
+     * @param deviceContext Contexto del dispositivo.
+     * @param cascade Índice de cascada.
+     *
+     * @warning Sustituye los render targets, el viewport y los cbuffers b0/b1: quien
+     * dibuje después debe volver a enlazar los de la cámara.
+     */
+    void begin(DeviceContext& deviceContext, unsigned int cascade);
+
+    /**
+     * @brief Enlaza el array, el sampler y `CBShadow` para los receptores.
+     * @param deviceContext Contexto del dispositivo.
+     */
+    void bind(DeviceContext& deviceContext);
+
+    /** @brief Libera la textura, las vistas, los estados y los buffers. */
+    void destroy();
+
+    /** @brief `true` si el mapa se creó correctamente. */
+    bool isEnabled() const { return m_enabled; }
+
+    /** @brief Vista de la luz (para ordenar las colas de casters). */
+    const XMMATRIX& getLightView() const { return m_lightView; }
+
+    /** @brief Rasterizer con sesgo de profundidad para el pase de casters. */
+    Rasterizer& getRasterizer() { return m_rasterizer; }
+
+    /** @brief Cascadas redibujadas en el último `schedule` (estadísticas). */
+    unsigned int getRenderedCount() const { return m_renderedCount; }
+
+    /**
+     * @brief Oscuridad de la sombra.
+     * @param strength 0 = sin sombra, 1 = negro.
+     */
+    void setStrength(float strength) { m_strength = strength; }
+
+    /** @brief Oscuridad de la sombra (la que usa el horneado de lightmaps). */
+    float getStrength() const { return m_strength; }
+
+private:
+    /// Estado de una cascada.
+    struct Cascade {
+        XMMATRIX viewProj = XMMatrixIdentity();   ///< Vista de la luz * ortográfica del ajuste actual.
+        Frustum volume;                           ///< Planos de `viewProj` (casters que la tocan).
+        ID3D11DepthStencilView* view = nullptr;   ///< DSV de su capa.
+        TConstantBuffer<CBNeverChanges> viewBuffer;   ///< b0 durante su pase.
+        TConstantBuffer<CBChangeOnResize> projBuffer; ///< b1 durante su pase.
+        bool dirty = true;                        ///< Su capa no corresponde al ajuste actual.
+    };
+
+    /// Ortográfica (en espacio de luz) que envuelve una esfera de mundo.
+    XMMATRIX fitCascade(unsigned int cascade, const XMVECTOR& center, float radius,
+        float casterNearZ) const;
+
+    ID3D11Texture2D* m_depthArray = nullptr;          ///< Una capa R32_TYPELESS por cascada.
+    ID3D11ShaderResourceView* m_arraySRV = nullptr;   ///< Lectura de todas las capas (R32_FLOAT).
+    Cascade m_cascades[kCascadeCount];                ///< Ajuste y vistas por cascada.
+    Viewport m_viewport;                              ///< Viewport de `size` x `size`.
+    Rasterizer m_rasterizer;                          ///< Con sesgo de profundidad.
+    SamplerState m_comparisonSampler;                 ///< PCF por hardware.
+    TConstantBuffer<CBShadow> m_shadowBuffer;         ///< b3 para los receptores.
+    CBShadow m_shadowData;                            ///< Matrices con las que se dibujó cada capa.
+    XMMATRIX m_lightView = XMMatrixIdentity();        ///< Vista de la luz (común a las cascadas).
+    unsigned int m_size = 0;                          ///< Texels por lado.
+    unsigned int m_nextFarCascade = 1;                ///< Turno de las cascadas lejanas.
+    unsigned int m_renderedCount = 0;                 ///< Cascadas del último `schedule`.
+    float m_strength = 0.6f;                          ///< Oscuridad de la sombra.
+    bool m_enabled = false;                           ///< Recursos creados.
+};
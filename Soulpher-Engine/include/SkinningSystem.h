@@ -0,0 +1,250 @@
+﻿/**
+ * @file SkinningSystem.h
+ * @brief Skinning en compute shader con la malla deformada guardada para todos los pases.
+ *
+ * @details
+ * Un personaje se dibuja varias veces por frame: en cada cascada de sombra que toca,
+ * en el pre-pase de profundidad y en el pase principal. Deformarlo en el vertex shader
+ * repetiría el mismo trabajo en cada una (y obligaría a tener variantes con skinning
+ * de todos los programas). Aquí se deforma **una vez por frame** en un compute shader
+ * (`Skinning.fx`) que escribe directamente en los vertex buffers del actor:
+ *
+ * 1. **Alta** (@ref add): el actor recibe su propio `MeshAsset` (@ref MeshAsset::initSkinned)
+ *    con buffers escribibles por UAV; aquí se guarda la pose de enlace y los pesos
+ *    (`SourceVertex`) en un buffer de solo lectura.
+ * 2. **Copia** (@ref capture, con el render parado): solo se copian las paletas cuya
+ *    `AnimationSystem::getPoseVersion` cambió desde la última deformación.
+ * 3. **Deformación** (@ref dispatch, al empezar el render): se suben esas paletas y se
+ *    lanza un dispatch por página de cada malla pendiente. Un personaje quieto (pausado
+ *    o al final de un clip) no cuesta nada en GPU.
+ *
+ * Después, los pases no saben que hubo skinning: leen el VB y el stream de posiciones
+ * del asset como los de una malla estática, con el mismo formato (`VertexFormat`).
+ *
+ * **Blend shapes** (`MeshComponent::m_morphs`): una cara con 50 formas y decenas de
+ * miles de vértices haría imposible sumarlas todas en cada vértice. Aquí cada forma es
+ * una lista dispersa de deltas (solo los vértices que mueve) y el trabajo es
+ * proporcional a lo que está activo:
+ *
+ * - En @ref capture solo se apuntan las formas con peso distinto de 0
+ *   (`AnimationSystem::setMorphWeight`), como lotes de `MorphBatch`.
+ * - `CSMorph` lanza un hilo por delta de esos lotes y suma `delta * peso` en el
+ *   acumulador del vértice (punto fijo con `InterlockedAdd`: varias formas pueden mover
+ *   el mismo vértice). Solo los vértices que alguna forma mueve tienen acumulador.
+ * - `CSSkin` suma el acumulador a la posición de enlace antes de aplicar los huesos y lo
+ *   deja a 0 para la siguiente vez.
+ *
+ * @note Para estudiantes: es el patrón "skinning cache": se cambia memoria (una copia
+ * de los vértices por personaje) por no repetir la deformación en cada pase.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "AnimationSystem.h"
+#include "MeshAsset.h"
+
+class Device;
+class DeviceContext;
+
+/**
+ * @class SkinningSystem
+ * @brief Mallas con skinning de los actores y el kernel que las deforma.
+ */
+class SkinningSystem {
+public:
+    SkinningSystem() = default;
+    ~SkinningSystem() { destroy(); }
+
+    /// Identificador de una malla con skinning (estable hasta `remove`).
+    typedef unsigned int SkinID;
+    /// Identificador que no corresponde a ninguna malla.
+    static const SkinID kInvalidSkin = 0xFFFFFFFF;
+    /// Hilos por grupo de `CSSkin`.
+    static const unsigned int kThreadGroupSize = 64;
+    /// Huesos iniciales del buffer de paletas (crece al doble).
+    static const unsigned int kInitialPaletteJoints = 1024;
+
+    /// Objetivo de blend shape que no existe en la malla.
+    static const unsigned int kInvalidMorph = 0xFFFFFFFF;
+    /// Lotes de blend shape iniciales del buffer de lotes (crece al doble).
+    static const unsigned int kInitialMorphBatches = 256;
+
+    /// Vértice de enlace tal como lo lee el kernel (`SourceVertex` en Skinning.fx).
+    struct SourceVertex {
+        XMFLOAT3 position;      ///< Espacio del modelo, sin cuantizar.
+        unsigned int bones;     ///< `SkinVertex::Bones` empaquetados.
+        unsigned int weights;   ///< `SkinVertex::Weights` empaquetados.
+        unsigned int morphSlot; ///< Su acumulador de blend shapes (@ref kInvalidMorph = ninguno).
+    };
+
+    /// Delta de un blend shape tal como lo lee `CSMorph`.
+    struct MorphDelta {
+        unsigned int slot;      ///< Acumulador del vértice (`SourceVertex::morphSlot`).
+        XMFLOAT3 delta;         ///< Desplazamiento con peso 1.
+    };
+
+    /// Forma activa en un dispatch de `CSMorph`: sus deltas y su peso.
+    struct MorphBatch {
+        unsigned int firstDelta;  ///< En los deltas de la malla.
+        unsigned int deltaCount;
+        unsigned int firstThread; ///< Primer hilo del dispatch que le toca.
+        float weight;
+    };
+
+    /**
+     * @brief Carga el kernel y crea las constantes.
+     * @return `S_OK`; `DXGI_ERROR_UNSUPPORTED` por debajo de 11_0 (sin skinning: los
+     * personajes se quedan en la pose de enlace).
+     */
+    HRESULT init(Device& device);
+
+    /**
+     * @brief Crea la malla deformable de un actor.
+     * @param device Dispositivo para los buffers.
+     * @param meshes Submallas del modelo con `m_skin` (las que no lo tengan no se deforman).
+     * @param instance Instancia de `AnimationSystem` cuya paleta la deforma.
+     * @return `kInvalidSkin` si falla; si no, el asset está en @ref getMeshAsset.
+     */
+    SkinID add(Device& device, const std::vector<MeshComponent>& meshes, AnimationSystem::InstanceID instance);
+
+    /** @brief Libera los buffers de la malla (el asset vive mientras algún actor lo use). */
+    void remove(SkinID id);
+
+    /** @brief Asset deformable para `Actor::setMeshAsset` (nulo si el id no es válido). */
+    EU::TSharedPointer<MeshAsset> getMeshAsset(SkinID id) const;
+
+    /**
+     * @brief Índice de un blend shape de la malla para `AnimationSystem::setMorphWeight`.
+     * @return @ref kInvalidMorph si no hay ninguno con ese nombre. Las submallas con un
+     * canal del mismo nombre comparten índice.
+     */
+    unsigned int findMorphTarget(SkinID id, const std::string& name) const;
+
+    /** @brief Blend shapes de la malla. */
+    unsigned int getMorphTargetCount(SkinID id) const;
+
+    /**
+     * @brief Instancia de animación que deforma un asset (la del actor que lo dibuja).
+     * @return `AnimationSystem::kInvalidInstance` si el asset no es de este sistema.
+     */
+    AnimationSystem::InstanceID getInstance(const MeshAsset* asset) const;
+
+    /**
+     * @brief Copia las paletas que cambiaron desde la última deformación.
+     * @note Con el render parado (`BaseApp::captureFrame`): después `dispatch` ya no lee
+     * `animations`, que la simulación puede seguir actualizando.
+     */
+    void capture(const AnimationSystem& animations);
+
+    /**
+     * @brief Deforma las mallas copiadas en @ref capture.
+     * @note Antes de cualquier pase que las dibuje (sombras incluidas).
+     */
+    void dispatch(DeviceContext& deviceContext);
+
+    /** @brief Libera kernel, buffers y mallas. */
+    void destroy();
+
+    /** @brief `true` tras un @ref init correcto. */
+    bool isReady() const { return m_shader != nullptr; }
+
+    /** @brief Mallas registradas. */
+    unsigned int getMeshCount() const { return static_cast<unsigned int>(m_meshes.size() - m_free.size()); }
+
+    /** @brief Mallas deformadas en el último @ref dispatch. */
+    unsigned int getSkinnedCount() const { return m_skinnedCount; }
+
+    /** @brief Mallas que no se deformaron en el último @ref capture porque su pose no cambió. */
+    unsigned int getSkippedCount() const { return m_skippedCount; }
+
+    /** @brief Deltas de blend shape sumados en el último @ref dispatch (solo formas activas). */
+    unsigned int getMorphDeltaCount() const { return m_morphDeltaCount; }
+
+private:
+    /// Constantes de `cbSkin` en Skinning.fx.
+    struct SkinParams {
+        unsigned int vertexCount;
+        unsigned int firstSource;
+        unsigned int firstJoint;
+        unsigned int vertexStride;
+        unsigned int positionStride;
+        unsigned int snorm16;
+        unsigned int morphed;         ///< 1 = sumar los acumuladores de blend shapes.
+        unsigned int morphThreads;    ///< Hilos de `CSMorph` (deltas de las formas activas).
+        XMFLOAT4 decodeOffset;
+        XMFLOAT4 decodeScale;
+        unsigned int firstBatch;      ///< Lotes de la malla en el buffer de lotes.
+        unsigned int batchCount;
+        unsigned int pad[2];
+    };
+
+    /// Deltas de un blend shape de la malla.
+    struct MorphRange {
+        unsigned int firstDelta = 0;
+        unsigned int deltaCount = 0;
+    };
+
+    /// Página del asset: sus dos vistas de escritura y su primer vértice en `sources`.
+    struct Page {
+        ID3D11UnorderedAccessView* vertices = nullptr;
+        ID3D11UnorderedAccessView* positions = nullptr;
+        unsigned int firstSource = 0;
+        unsigned int vertexCount = 0;
+    };
+
+    struct SkinnedMesh {
+        EU::TSharedPointer<MeshAsset> asset;        ///< Nulo = hueco libre.
+        AnimationSystem::InstanceID instance = AnimationSystem::kInvalidInstance;
+        ID3D11Buffer* sources = nullptr;            ///< `SourceVertex` de todas las páginas.
+        ID3D11ShaderResourceView* sourcesSRV = nullptr;
+        std::vector<Page> pages;
+        unsigned int version = 0;                   ///< Versión de la pose ya deformada.
+        unsigned int firstJoint = 0;                ///< Su paleta en `m_palettes` (si `pending`).
+        bool pending = false;                       ///< Copiada y aún sin deformar.
+        std::vector<std::string> morphNames;        ///< Blend shapes (índice de `setMorphWeight`).
+        std::vector<MorphRange> morphRanges;        ///< Paralelo a `morphNames`.
+        ID3D11Buffer* morphDeltas = nullptr;        ///< `MorphDelta`, cada forma contigua.
+        ID3D11ShaderResourceView* morphDeltasSRV = nullptr;
+        ID3D11Buffer* morphOffsets = nullptr;       ///< Acumuladores (3 enteros por vértice movible).
+        ID3D11UnorderedAccessView* morphOffsetsUAV = nullptr;
+        unsigned int firstBatch = 0;                ///< Sus formas activas en `m_batches` (si `pending`).
+        unsigned int batchCount = 0;
+        unsigned int morphThreads = 0;
+    };
+
+    /**
+     * @brief Une los blend shapes de las submallas por nombre y crea sus buffers.
+     * @param submeshFirstSource Primer `SourceVertex` de cada submalla del asset.
+     */
+    HRESULT createMorphs(Device& device, SkinnedMesh& mesh, const std::vector<unsigned int>& submeshFirstSource,
+        std::vector<SourceVertex>& sources);
+
+    /// Recrea el buffer de lotes si no caben `batchCount`.
+    HRESULT reserveBatches(unsigned int batchCount);
+
+    /// Recrea el buffer de paletas si no caben `jointCount` huesos.
+    HRESULT reserve(unsigned int jointCount);
+
+    /// Libera las vistas y buffers de una malla.
+    static void release(SkinnedMesh& mesh);
+
+    Device* m_device = nullptr;
+    ID3D11ComputeShader* m_shader = nullptr;
+    ID3D11ComputeShader* m_morphShader = nullptr;     ///< `CSMorph`.
+    ID3D11Buffer* m_params = nullptr;                 ///< Constant buffer `cbSkin`.
+    ID3D11Buffer* m_paletteBuffer = nullptr;          ///< `StructuredBuffer<float4>` dinámico.
+    ID3D11ShaderResourceView* m_paletteSRV = nullptr;
+    unsigned int m_paletteCapacity = 0;               ///< En huesos.
+
+    std::vector<SkinnedMesh> m_meshes;
+    std::vector<SkinID> m_free;
+    EU::TMap<const MeshAsset*, AnimationSystem::InstanceID> m_instanceByAsset; ///< Para @ref getInstance.
+    std::vector<EU::Matrix3x4> m_palettes;            ///< Paletas copiadas en `capture`.
+    std::vector<MorphBatch> m_batches;                ///< Formas activas copiadas en `capture`.
+    ID3D11Buffer* m_batchBuffer = nullptr;            ///< `StructuredBuffer<MorphBatch>` dinámico.
+    ID3D11ShaderResourceView* m_batchSRV = nullptr;
+    unsigned int m_batchCapacity = 0;
+    unsigned int m_skinnedCount = 0;
+    unsigned int m_skippedCount = 0;
+    unsigned int m_morphDeltaCount = 0;
+};
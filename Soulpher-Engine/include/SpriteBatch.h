@@ -0,0 +1,174 @@
+﻿/**
+ * @file SpriteBatch.h
+ * @brief Sprites 2D del HUD del juego (marcadores, iconos, efectos de pantalla) en un
+ * draw instanciado por textura o por array de texturas.
+ *
+ * @details
+ * ImGui es la UI del editor; el HUD del juego necesita capas propias, texturas de
+ * atlas y decenas de miles de quads (números de un marcador, partículas 2D) sin que
+ * cada uno sea una ventana. `SpriteBatch` recibe sprites en píxeles de la salida:
+ * @code
+ * SpriteBatch::Sprite sprite;
+ * sprite.texture = icon.get();
+ * sprite.position = XMFLOAT2(32.0f, 32.0f);
+ * sprite.size = XMFLOAT2(64.0f, 64.0f);
+ * m_sprites.add(sprite);
+ * @endcode
+ *
+ * - **Grabación** (@ref add): en el hilo principal, durante `update`/`simulate`; es un
+ *   `push_back` de 64 bytes, sin ordenar ni tocar la GPU.
+ * - **Captura** (@ref capture): en `BaseApp::captureFrame` los sprites pasan a la copia
+ *   que lee el render, como el resto del estado del frame.
+ * - **Dibujo** (@ref render): cada textura se resuelve a su capa de
+ *   @ref TextureArrayPool (si entra) o a su SRV suelta, y los sprites se reparten por
+ *   (capa de dibujo, textura) con un conteo (O(n), sin ordenar y conservando el orden
+ *   de llegada) directamente sobre el buffer de instancias mapeado. Luego un
+ *   `DrawInstanced` de 4 vértices por grupo: con el pool, todas las texturas de un
+ *   array son un solo draw.
+ *
+ * Las capas (@ref Sprite::layer) se dibujan de menor a mayor; dentro de una capa y una
+ * textura, en el orden de @ref add. Entre texturas de la misma capa no hay orden
+ * garantizado: lo que deba quedar encima va en otra capa.
+ *
+ * @note Para estudiantes: el quad no tiene vertex buffer; el VS saca la esquina de
+ * `SV_VertexID` (tira de 4) y todo lo demás llega por instancia. El coste por sprite en
+ * CPU es escribir sus 64 bytes dos veces (al grabar y al repartir).
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "ConstantBufferLayout.h"
+#include "Buffer.h"
+#include "ConstantBuffer.h"
+#include "ShaderProgram.h"
+#include "BlendState.h"
+#include "Rasterizer.h"
+#include "DepthStencilState.h"
+#include <unordered_map>
+
+class Device;
+class DeviceContext;
+class Texture;
+class TextureArrayPool;
+
+/**
+ * @class SpriteBatch
+ * @brief Cola de sprites del frame y su dibujo instanciado.
+ */
+class SpriteBatch {
+public:
+    SpriteBatch() = default;
+    ~SpriteBatch() { destroy(); }
+
+    /// Capas de dibujo (@ref Sprite::layer se recorta a este rango).
+    static const unsigned int kLayerCount = 16;
+    /// Instancias iniciales del buffer (crece al doble).
+    static const unsigned int kInitialSprites = 4096;
+
+    /// Un quad en píxeles de la salida (origen arriba a la izquierda).
+    struct Sprite {
+        const Texture* texture = nullptr;   ///< Nula = color sólido. Debe vivir hasta que se dibuje el frame.
+        XMFLOAT2 position = XMFLOAT2(0.0f, 0.0f); ///< Esquina superior izquierda.
+        XMFLOAT2 size = XMFLOAT2(0.0f, 0.0f);
+        XMFLOAT4 uv = XMFLOAT4(0.0f, 0.0f, 1.0f, 1.0f); ///< Rectángulo de la textura (u0, v0, u1, v1), p. ej. una celda de un atlas.
+        XMFLOAT4 color = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f); ///< Tinte (alfa incluido).
+        float rotation = 0.0f;              ///< Radianes alrededor del centro.
+        unsigned int layer = 0;             ///< Orden de dibujo (0 primero).
+    };
+
+    /**
+     * @brief Crea programas, buffer de instancias y estados.
+     * @return `S_OK` o el error; sin él los sprites se descartan.
+     */
+    HRESULT init(Device& device);
+
+    /** @brief Encola un sprite para el frame actual (hilo principal). */
+    void add(const Sprite& sprite);
+
+    /** @brief Sprites encolados en el frame actual. */
+    unsigned int getPendingCount() const { return static_cast<unsigned int>(m_pending.size()); }
+
+    /**
+     * @brief Entrega lo encolado al render y empieza un frame vacío.
+     * @note Con el render parado (`BaseApp::captureFrame`).
+     */
+    void capture();
+
+    /** @brief `true` si el frame capturado tiene algo que dibujar. */
+    bool hasSprites() const { return isReady() && !m_frame.empty(); }
+
+    /**
+     * @brief Dibuja el frame capturado.
+     * @param deviceContext Contexto inmediato.
+     * @param textureArrays Pool para agrupar texturas por array (nulo = una SRV por draw).
+     * @param rtv Target de salida (sin profundidad).
+     * @param width,height Tamaño de `rtv` (el espacio de las coordenadas de los sprites).
+     */
+    void render(DeviceContext& deviceContext, TextureArrayPool* textureArrays,
+        ID3D11RenderTargetView* rtv, unsigned int width, unsigned int height);
+
+    /** @brief Libera programas, buffers y estados. */
+    void destroy();
+
+    /** @brief `true` tras un @ref init correcto. */
+    bool isReady() const { return m_device != nullptr; }
+
+    /** @brief Sprites del último @ref render. */
+    unsigned int getSpriteCount() const { return m_lastSprites; }
+
+    /** @brief Draws del último @ref render. */
+    unsigned int getDrawCount() const { return m_lastDraws; }
+
+private:
+    /// Instancia tal como la lee `Sprite.fx` (slot 1).
+    struct InstanceData {
+        XMFLOAT4 rect;          ///< x, y, ancho, alto (píxeles).
+        XMFLOAT4 uv;
+        XMFLOAT4 color;
+        float rotation;
+        float slice;            ///< Capa del array (0 sin array).
+        float padding[2];
+    };
+
+    /// Constantes de `cbSprite` (b2).
+    struct CBSprite {
+        XMFLOAT4 screen;        ///< x: 2 / ancho, y: 2 / alto.
+    };
+    /// Layout de `cbSprite` (ver `ConstantBufferLayouts`).
+    static const ConstantBufferLayouts::Registration kSpriteLayout;
+
+    /// Textura resuelta para dibujar: la SRV enlazada y si es un array.
+    struct Binding {
+        ID3D11ShaderResourceView* srv;
+        bool array;
+    };
+
+    /// Textura ya resuelta en este frame.
+    struct Resolved {
+        unsigned int binding;   ///< Índice en `m_bindings`.
+        float slice;
+    };
+
+    Device* m_device = nullptr;
+    ShaderProgram m_program;                ///< `Sprite.fx`, Texture2D.
+    ShaderProgram m_arrayProgram;           ///< `Sprite.fx` con `TEXTURE_ARRAY`.
+    Buffer m_instanceBuffer;
+    unsigned int m_instanceCapacity = 0;
+    TConstantBuffer<CBSprite> m_constants;
+    BlendState m_blendState;                ///< Mezcla alfa.
+    Rasterizer m_rasterizer;                ///< Sin culling (un tamaño negativo voltea el quad).
+    DepthStencilState m_noDepth;
+    ID3D11SamplerState* m_sampler = nullptr; ///< Lineal con clamp (sin sangrado entre celdas).
+    ID3D11Texture2D* m_whiteTexture = nullptr; ///< 1x1 blanca para los sprites sin textura.
+    ID3D11ShaderResourceView* m_whiteSRV = nullptr;
+
+    std::vector<Sprite> m_pending;          ///< Frame en curso (hilo principal).
+    std::vector<Sprite> m_frame;            ///< Frame capturado (lo lee @ref render).
+    std::vector<Binding> m_bindings;        ///< Texturas distintas del frame, ya resueltas.
+    std::unordered_map<const Texture*, Resolved> m_resolved;
+    std::vector<unsigned int> m_spriteBinding; ///< Índice en `m_bindings` de cada sprite.
+    std::vector<float> m_spriteSlice;       ///< Capa del array de cada sprite.
+    std::vector<unsigned int> m_offsets;    ///< Conteo y luego inicio de cada grupo (capa, binding).
+    unsigned int m_lastSprites = 0;
+    unsigned int m_lastDraws = 0;
+};
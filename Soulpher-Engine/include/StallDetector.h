@@ -0,0 +1,132 @@
+﻿/**
+ * @file StallDetector.h
+ * @brief Mide las llamadas en las que la CPU puede quedarse esperando a la GPU y avisa,
+ * con el sitio de la llamada y el recurso, cuando pasan de un umbral.
+ *
+ * @details
+ * Un `Map` de un recurso que la GPU aún usa, un bucle de `GetData`, un `Present` que
+ * bloquea o un `UpdateSubresource` que obliga al driver a copiar el recurso no salen
+ * como error: el frame simplemente tarda más y el perfilador muestra la zona que los
+ * contiene. Aquí se mide cada una:
+ *
+ * - `DeviceContext::Map`, `DeviceContext::UpdateSubresource`,
+ *   `DeviceContext::waitForQuery` (los bucles de `GetData`) y `SwapChain::present`
+ *   abren un @ref StallDetector::Scope (dos `QueryPerformanceCounter`).
+ * - Si tarda más de `r.stallThresholdMs`, se cuenta en el frame (panel "Render stats") y
+ *   se avisa por el log con el archivo y la línea de quien llamó (`std::source_location`,
+ *   sin tocar las llamadas existentes) y el recurso: su nombre de depuración
+ *   (`WKPDID_D3DDebugObjectName`) o, si no tiene, tipo y tamaño.
+ * - Un sitio que se repite avisa la primera vez y luego a la 2.ª, 4.ª, 8.ª...: un fallo que
+ *   cae en cada frame no inunda el log.
+ *
+ * Los `Map` con `DO_NOT_WAIT` no se miden (no esperan por definición), ni tampoco la
+ * espera de latencia de `SwapChain::waitForFrame`: ese es el punto de sincronización
+ * previsto del frame. `Present` solo se mide sin vsync (con vsync esperar al refresco
+ * es lo esperado).
+ *
+ * @note Para estudiantes: con `r.stallThresholdMs 0` no se mide nada. Un aviso apunta a
+ * dónde se espera; el arreglo suele ser leer un frame más tarde (`DO_NOT_WAIT`, anillo
+ * de staging) o escribir en otro recurso (`WRITE_DISCARD`, `UploadScheduler`).
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include <atomic>
+#include <mutex>
+#include <source_location>
+#include <unordered_map>
+
+/**
+ * @enum StallKind
+ * @brief Llamada que se midió.
+ */
+enum StallKind {
+    STALL_MAP = 0,              ///< `Map` (lectura de staging o escritura sobre un recurso en uso).
+    STALL_UPDATE_SUBRESOURCE,   ///< `UpdateSubresource` (copia o renombrado del driver).
+    STALL_GET_DATA,             ///< Bucle de `GetData` hasta que la query tiene el dato.
+    STALL_PRESENT,              ///< `Present` bloqueado (cola de frames llena).
+    STALL_KIND_COUNT
+};
+
+/**
+ * @class StallDetector
+ * @brief Umbral, contadores por frame y avisos de esperas de la CPU a la GPU.
+ */
+class StallDetector {
+public:
+    /// Esperas recientes guardadas para la UI.
+    static const unsigned int kRecentStalls = 16;
+
+    /// Una espera que pasó del umbral.
+    struct Stall {
+        StallKind kind = STALL_MAP;
+        double ms = 0.0;
+        const char* file = "";      ///< Archivo de quien llamó (literal del compilador).
+        unsigned int line = 0;
+        char resource[64] = {};     ///< Nombre de depuración o descripción del recurso.
+    };
+
+    /// Contadores de un frame.
+    struct FrameStats {
+        unsigned int count[STALL_KIND_COUNT] = {};  ///< Esperas sobre el umbral, por tipo.
+        double ms[STALL_KIND_COUNT] = {};           ///< Tiempo que sumaron.
+    };
+
+    /**
+     * @class Scope
+     * @brief Mide su vida y, si pasa del umbral, la registra como espera.
+     */
+    class Scope {
+    public:
+        Scope(StallKind kind, ID3D11Resource* resource,
+            const std::source_location& location = std::source_location::current());
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        StallKind m_kind;
+        ID3D11Resource* m_resource;
+        std::source_location m_location;
+        LONGLONG m_start = 0;   ///< 0 = detector apagado.
+    };
+
+    /** @brief Detector del proceso. */
+    static StallDetector& getDefault();
+
+    /** @brief Umbral en ms (0 = no se mide). */
+    void setThreshold(double ms) { m_thresholdMs.store(ms, std::memory_order_relaxed); }
+    double getThreshold() const { return m_thresholdMs.load(std::memory_order_relaxed); }
+
+    /** @brief Cierra el frame: sus contadores pasan a @ref getLastFrame. Una vez por frame. */
+    void endFrame();
+
+    /** @brief Esperas del último frame completo. */
+    const FrameStats& getLastFrame() const { return m_lastFrame; }
+
+    /** @brief Copia las esperas recientes (la más nueva primero); devuelve cuántas hay. */
+    unsigned int getRecent(Stall* out, unsigned int capacity) const;
+
+    /** @brief Nombre legible de un tipo (para la UI y el log). */
+    static const char* getKindName(StallKind kind);
+
+private:
+    StallDetector();
+
+    /// Apunta una espera sobre el umbral (contadores, recientes y log).
+    void report(StallKind kind, double ms, ID3D11Resource* resource, const std::source_location& location);
+
+    /// Nombre de depuración del recurso o, si no tiene, tipo y tamaño.
+    static void describe(ID3D11Resource* resource, char* out, size_t size);
+
+    std::atomic<double> m_thresholdMs{ 0.0 };
+    double m_ticksToMs = 0.0;
+
+    mutable std::mutex m_mutex;                 ///< Protege lo de abajo (solo esperas sobre el umbral).
+    FrameStats m_frame;                         ///< Frame en curso.
+    FrameStats m_lastFrame;
+    Stall m_recent[kRecentStalls];
+    unsigned int m_recentCount = 0;
+    unsigned int m_recentNext = 0;
+    std::unordered_map<uint64_t, unsigned long long> m_siteCounts; ///< Avisos por sitio (archivo y línea).
+};
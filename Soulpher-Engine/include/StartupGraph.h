@@ -0,0 +1,116 @@
+﻿/**
+ * @file StartupGraph.h
+ * @brief Pasos del arranque como grafo de dependencias, ejecutado en el `JobSystem`
+ * mientras la ventana muestra un frame de carga.
+ *
+ * @details
+ * `BaseApp::init` hacía todo en serie: compilar los shaders de cada sistema, crear los
+ * buffers, los cargadores... Muchos de esos pasos solo necesitan el dispositivo (que es
+ * free-threaded) y no dependen entre sí, así que el tiempo hasta el primer frame era la
+ * suma de todos. Aquí cada paso es una tarea con sus dependencias:
+ *
+ * - Las tareas normales van como trabajos del `JobSystem` en cuanto sus dependencias
+ *   terminan; solo pueden usar el dispositivo, nunca el contexto inmediato.
+ * - Las tareas con @ref StartupGraph::TASK_MAIN_THREAD se ejecutan en el hilo que llama
+ *   a @ref StartupGraph::run (contexto inmediato, ventana, ImGui).
+ * - Mientras espera, el hilo principal llama a `idle` cada `idleIntervalMs` (el frame
+ *   de carga: mensajes de la ventana y un `Present`).
+ * - Una tarea que devuelve error para el arranque: no se lanzan más, se espera a las que
+ *   están en marcha y @ref StartupGraph::run devuelve ese error. Los pasos opcionales
+ *   tratan su fallo dentro de la tarea (avisan y devuelven `S_OK`).
+ *
+ * Al terminar se registra el tiempo total, la suma de las tareas (lo que costaba en
+ * serie) y el camino crítico (el mínimo posible con hilos de sobra).
+ *
+ * @note Para estudiantes: las tareas comparten cachés del dispositivo (`ShaderLibrary`,
+ * `InputLayoutCache`, `RenderStateCache`), que por eso tienen su cerrojo. Un miembro que
+ * escriben dos tareas tiene que ir en una sola o con una dependencia entre ellas.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include <atomic>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+
+struct Job;
+
+/**
+ * @class StartupGraph
+ * @brief Tareas de arranque con dependencias, repartidas entre hilo principal y workers.
+ */
+class StartupGraph {
+public:
+    /// Índice de una tarea (lo devuelve @ref add).
+    typedef unsigned int Task;
+
+    /// Opciones de una tarea.
+    enum TaskFlags : unsigned int {
+        TASK_MAIN_THREAD = 1 << 0   ///< Contexto inmediato o ventana: en el hilo de @ref run.
+    };
+
+    StartupGraph() = default;
+    ~StartupGraph();
+    StartupGraph(const StartupGraph&) = delete;
+    StartupGraph& operator=(const StartupGraph&) = delete;
+
+    /**
+     * @brief Añade una tarea.
+     * @param name Nombre para el log (literal).
+     * @param function Paso; un error para el arranque.
+     * @param dependencies Tareas que deben terminar antes (ya añadidas).
+     * @param flags @ref TaskFlags.
+     * @return El índice de la tarea.
+     */
+    Task add(const char* name, std::function<HRESULT()> function,
+        std::initializer_list<Task> dependencies = {}, unsigned int flags = 0);
+
+    /**
+     * @brief Ejecuta todas las tareas y espera a que terminen.
+     * @param idle Se llama en el hilo principal mientras espera (puede ser vacía).
+     * @param idleIntervalMs Cada cuánto como mucho se llama a `idle`.
+     * @return `S_OK` o el error de la primera tarea que falló.
+     */
+    HRESULT run(const std::function<void()>& idle, unsigned int idleIntervalMs = 16);
+
+    /** @brief Tiempo de @ref run, en ms. */
+    double getWallMs() const { return m_wallMs; }
+    /** @brief Suma de las tareas, en ms (lo que costaría en serie). */
+    double getTotalMs() const { return m_totalMs; }
+    /** @brief Cadena de dependencias más larga, en ms. */
+    double getCriticalPathMs() const { return m_criticalPathMs; }
+
+private:
+    struct Node {
+        const char* name = "";
+        std::function<HRESULT()> function;
+        std::vector<Task> dependencies;
+        unsigned int flags = 0;
+        bool started = false;
+        std::atomic<bool> finished{ false };
+        HRESULT result = S_OK;
+        double ms = 0.0;
+        double pathMs = 0.0;    ///< `ms` más el camino más largo de sus dependencias.
+    };
+
+    /// Datos del trabajo (caben en `Job::data`).
+    struct JobData {
+        StartupGraph* graph;
+        Task task;
+    };
+
+    /// Ejecuta la tarea, mide su tiempo y la marca como terminada.
+    void execute(Task task);
+    static void taskJob(Job& job, const void* data);
+
+    /// Todas sus dependencias terminaron.
+    bool isReady(const Node& node) const;
+
+    std::vector<std::unique_ptr<Node>> m_nodes;
+    HANDLE m_finishedEvent = nullptr;   ///< Lo señala cada tarea de un worker al terminar.
+    double m_ticksToMs = 0.0;
+    double m_wallMs = 0.0;
+    double m_totalMs = 0.0;
+    double m_criticalPathMs = 0.0;
+};
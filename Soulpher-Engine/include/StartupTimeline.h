@@ -0,0 +1,131 @@
+﻿/**
+ * @file StartupTimeline.h
+ * @brief Tiempos del arranque (dispositivo, tareas, shaders, modelos, texturas) como
+ * línea de tiempo Chrome `trace_event` y resumen de arranque en frío o en caliente.
+ *
+ * @details
+ * El tiempo hasta el primer frame es una métrica de servicio (un quiosco que se
+ * reinicia), pero el perfilador de CPU solo ve frames. Aquí, desde que arranca el
+ * proceso hasta que la escena termina de cargar:
+ *
+ * - Cada etapa abre un @ref StartupTimeline::Scope (categoría + nombre): el swap chain,
+ *   cada tarea de `StartupGraph`, cada shader compilado o leído de la caché, cada modelo
+ *   y cada textura. Vale desde cualquier hilo; un `tid` por hilo del sistema.
+ * - Las cachés apuntan aciertos y fallos (@ref StartupTimeline::recordCache): bytecode
+ *   de `ShaderLibrary` en disco y `.smesh` de `ModelLoader`. Sin ningún fallo el
+ *   arranque cuenta como "en caliente".
+ * - @ref StartupTimeline::markFirstFrame, tras el primer `Present`, escribe en el log el
+ *   resumen: tiempo desde la creación del proceso, camino crítico del grafo y aciertos.
+ * - @ref StartupTimeline::finish, cuando ya no quedan cargas, deja de grabar y escribe
+ *   el JSON (se abre igual que las capturas de `TraceCapture`).
+ *
+ * Los tiempos cuentan desde la creación del proceso (`GetProcessTimes`), no desde
+ * `main`: incluyen la carga de DLLs y lo que pasa antes de la ventana.
+ *
+ * @note Para estudiantes: comparar "serie" con "camino crítico" dice cuánto ganaría más
+ * paralelismo; comparar dos arranques en frío y en caliente, cuánto pesan las cachés.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include <atomic>
+#include <mutex>
+
+/**
+ * @enum StartupCache
+ * @brief Cachés de disco cuyos aciertos se cuentan en el arranque.
+ */
+enum StartupCache {
+    STARTUP_CACHE_SHADER = 0,   ///< Bytecode `.cso` de `ShaderLibrary`.
+    STARTUP_CACHE_MESH,         ///< `.smesh` de `ModelLoader`.
+    STARTUP_CACHE_COUNT
+};
+
+/**
+ * @class StartupTimeline
+ * @brief Intervalos y contadores del arranque del proceso.
+ */
+class StartupTimeline {
+public:
+    /// Intervalos guardados como mucho (los siguientes se descartan).
+    static const size_t kMaxSpans = 8192;
+
+    /**
+     * @class Scope
+     * @brief Mide su vida y la guarda como intervalo (nada si ya no se graba).
+     */
+    class Scope {
+    public:
+        Scope(const char* category, const std::string& name);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        const char* m_category;
+        std::string m_name;
+        LONGLONG m_begin = 0;   ///< 0 = no se graba.
+    };
+
+    /** @brief Línea de tiempo del proceso (la primera llamada fija el reloj). */
+    static StartupTimeline& getDefault();
+
+    /** @brief `true` hasta @ref finish. */
+    bool isRecording() const { return m_recording.load(std::memory_order_relaxed); }
+
+    /** @brief Guarda un intervalo medido con QPC (cualquier hilo). */
+    void record(const char* category, const std::string& name, LONGLONG begin, LONGLONG end);
+
+    /** @brief Apunta un acierto o un fallo de caché (cualquier hilo). */
+    void recordCache(StartupCache cache, bool hit);
+
+    /** @brief Tiempos del grafo de arranque (de `StartupGraph`). */
+    void setGraphTimes(double wallMs, double serialMs, double criticalPathMs);
+
+    /** @brief Primer frame presentado: calcula y escribe el resumen (una vez). */
+    void markFirstFrame();
+
+    /**
+     * @brief Deja de grabar y escribe la línea de tiempo.
+     * @param path Archivo `.json` (vacío = solo el resumen en el log).
+     * @return `S_OK`, `S_FALSE` si ya había terminado, o el error al escribir.
+     */
+    HRESULT finish(const std::string& path);
+
+    /** @brief ms desde la creación del proceso hasta ahora. */
+    double getProcessMs() const;
+    /** @brief ms desde la creación del proceso hasta el primer frame (0 si aún no hubo). */
+    double getFirstFrameMs() const { return m_firstFrameMs.load(std::memory_order_relaxed); }
+    /** @brief Sin fallos de caché hasta ahora. */
+    bool isWarmStart() const;
+
+private:
+    StartupTimeline();
+
+    /// Un intervalo guardado.
+    struct Span {
+        const char* category;
+        std::string name;
+        LONGLONG begin;
+        LONGLONG end;
+        DWORD thread;
+    };
+
+    /// ms desde la creación del proceso para una lectura de QPC.
+    double toProcessMs(LONGLONG ticks) const;
+
+    std::atomic<bool> m_recording{ true };
+    std::atomic<unsigned int> m_hits[STARTUP_CACHE_COUNT] = {};
+    std::atomic<unsigned int> m_misses[STARTUP_CACHE_COUNT] = {};
+    LONGLONG m_originTicks = 0;         ///< QPC al construir.
+    double m_originProcessMs = 0.0;     ///< ms de proceso al construir.
+    double m_ticksToMs = 0.0;
+    DWORD m_mainThread = 0;             ///< Hilo que construyó (el principal).
+
+    std::mutex m_mutex;                 ///< Protege `m_spans`.
+    std::vector<Span> m_spans;
+    std::atomic<double> m_firstFrameMs{ 0.0 };  ///< Lo escribe el hilo de render.
+    double m_graphWallMs = 0.0;
+    double m_graphSerialMs = 0.0;
+    double m_graphCriticalMs = 0.0;
+};
@@ -0,0 +1,102 @@
+﻿/**
+ * @file StaticBatcher.h
+ * @brief Fusión de actores estáticos con el mismo material en lotes por celda.
+ *
+ * @details
+ * Un prop estático cuesta un paquete (y un draw si no se instancia) aunque nunca se
+ * mueva. El batcher hornea los actores marcados con `Actor::setStatic`:
+ *
+ * 1. **Candidatos**: estáticos, opacos, sin lightmap (`Actor::hasLightmap`), con un solo nivel de detalle y con copia de
+ *    CPU de su geometría (`MeshAsset::hasCpuData`). Los demás se siguen dibujando solos.
+ * 2. **Agrupación**: por celda de una rejilla en XZ (la del centro de la AABB del
+ *    actor, de lado @ref StaticBatcher::kDefaultCellSize) y por material: textura de
+ *    la submalla, tinte y banderas de sombra. Así el culling por actor sigue
+ *    descartando celdas enteras fuera de cámara.
+ * 3. **Fusión**: los vértices se pasan a espacio mundo y se concatenan; cada lote
+ *    es un `Actor` nuevo con transform identidad y un `MeshAsset` propio, partido en
+ *    submallas de como mucho 65 535 vértices (índices de 16 bits) con sus meshlets.
+ *
+ * Los actores fusionados siguen en la escena (inspector, sombras en caché) pero
+ * `Actor::submit` no envía nada de ellos (`Actor::isBatched`). @ref update compara una
+ * huella de los estáticos (transform, malla, tinte, texturas) y vuelve a hornear si
+ * alguno cambió, se añadió o dejó de ser estático.
+ *
+ * @note Para estudiantes: fusionar gasta memoria (una copia en mundo de cada prop) y
+ * pierde el instancing y los LOD; compensa con muchos objetos pequeños y quietos.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "ECS/Actor.h"
+#include "ECS/ActorPool.h"
+
+class Device;
+class DeviceContext;
+
+/**
+ * @class StaticBatcher
+ * @brief Hornea y mantiene los lotes de geometría estática de la escena.
+ */
+class StaticBatcher {
+public:
+    StaticBatcher() = default;
+    ~StaticBatcher() = default;
+
+    /// Lado de la celda de agrupación (unidades de mundo).
+    static const float kDefaultCellSize;
+    /// Vértices máximos por submalla de un lote (índices de 16 bits).
+    static const unsigned int kMaxBatchVertices = 0xFFFF;
+
+    /// Resultado del último horneado.
+    struct Stats {
+        unsigned int sourceActors = 0; ///< Actores fusionados.
+        unsigned int sourceDraws = 0;  ///< Submallas que ya no se envían sueltas.
+        unsigned int batches = 0;      ///< Actores de lote creados.
+        unsigned int triangles = 0;    ///< Triángulos de todos los lotes.
+    };
+
+    /**
+     * @brief Vuelve a hornear si los estáticos cambiaron desde la última vez.
+     * @param device Dispositivo para crear los buffers de los lotes.
+     * @param deviceContext Contexto con el que se prepara el primer frame de cada lote.
+     * @param actors Actores de la escena; los lotes se añaden (y quitan) al final.
+     * @return `true` si se horneó en esta llamada.
+     */
+    bool update(Device& device, DeviceContext& deviceContext, std::vector<ActorHandle>& actors);
+
+    /**
+     * @brief Hornea los lotes de los estáticos actuales (deshaciendo los anteriores).
+     * @return `S_OK`, o el primer error al crear un lote (ese grupo se dibuja suelto).
+     */
+    HRESULT bake(Device& device, DeviceContext& deviceContext, std::vector<ActorHandle>& actors);
+
+    /**
+     * @brief Quita los lotes de `actors` y devuelve los originales al render normal.
+     * @param actors Lista de actores de la aplicación.
+     */
+    void destroy(std::vector<ActorHandle>& actors);
+
+    /** @brief Cambia el lado de celda (se aplica en el próximo horneado). */
+    void setCellSize(float size) { m_cellSize = size > 0.0f ? size : kDefaultCellSize; m_fingerprint = 0; }
+
+    /** @brief Activa o desactiva la fusión (desactivada, los estáticos se dibujan sueltos). */
+    void setEnabled(bool enabled) { m_enabled = enabled; m_fingerprint = 0; }
+
+    bool isEnabled() const { return m_enabled; }
+
+    const Stats& getStats() const { return m_stats; }
+
+private:
+    /// Huella de los candidatos actuales (0 = nada que fusionar).
+    uint64_t computeFingerprint(const std::vector<ActorHandle>& actors) const;
+
+    /// `true` si el actor puede entrar en un lote.
+    static bool isCandidate(Actor& actor);
+
+    std::vector<ActorHandle> m_batches;               ///< Actores de lote (también en la escena).
+    std::vector<ActorHandle> m_sources;               ///< Actores fusionados (pueden haberse destruido).
+    uint64_t m_fingerprint = 0;                       ///< Huella del último horneado.
+    float m_cellSize = kDefaultCellSize;
+    bool m_enabled = true;
+    Stats m_stats;
+};
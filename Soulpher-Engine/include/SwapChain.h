@@ -14,6 +14,21 @@
  * - **Present()**: Envía el back buffer a la pantalla.
  * - **MSAA (Multi-Sample Anti-Aliasing)**: Mejora la calidad visual suavizando bordes.
  * - El Swap Chain se conecta a una **ventana** (HWND) y a un **back buffer** (textura).
+ *
+ * **Modo de presentación** (@ref SwapChain::PresentConfig):
+ * - *Flip model* (`FLIP_DISCARD` en Windows 10, `FLIP_SEQUENTIAL` en Windows 8): el DWM
+ *   compone directamente el back buffer, sin la copia extra del modelo *blit*. Si el
+ *   sistema no lo admite se cae al `DISCARD` clásico.
+ * - *Tearing*: con flip model, `vsync` apagado y soporte del sistema, `Present` usa
+ *   `DXGI_PRESENT_ALLOW_TEARING` para monitores de refresco variable (VRR).
+ * - *Latencia*: @ref SwapChain::waitForFrame bloquea al inicio del frame hasta que la GPU
+ *   tiene hueco (como mucho `maxFrameLatency` frames en vuelo), así la entrada se lee lo
+ *   más tarde posible.
+ *
+ * @note El SDK de DirectX (junio 2010) solo trae DXGI 1.1: no hay `IDXGISwapChain2` ni su
+ * *waitable object*. Los valores de flip/tearing se pasan como constantes numéricas (el
+ * runtime del sistema sí los entiende) y la espera se hace con queries de evento por frame
+ * más `IDXGIDevice1::SetMaximumFrameLatency`, que da el mismo efecto.
  */
 
 #pragma once
@@ -33,6 +48,21 @@ class Texture;
  */
 class SwapChain {
 public:
+    /** @brief Opciones de presentación; los valores por defecto priorizan la latencia. */
+    struct PresentConfig {
+        bool flipModel = true;            ///< Intentar flip model (si falla, blit clásico).
+        unsigned int bufferCount = 2;     ///< Back buffers (2-3 con flip model).
+        unsigned int maxFrameLatency = 1; ///< Frames que la CPU puede adelantarse a la GPU.
+        bool vsync = false;               ///< Sincronizar `Present` con el refresco.
+        bool allowTearing = true;         ///< Tearing para VRR (solo sin vsync y con flip model).
+    };
+
+    /** @brief Opciones del dispositivo. */
+    struct DeviceConfig {
+        std::string adapter;              ///< Índice o parte del nombre (`-adapter`); vacío = el de más rendimiento.
+        bool warp = false;                ///< Rasterizador por software WARP (`-warp 1`), sin buscar adaptador.
+    };
+
     /** @brief Constructor por defecto. */
     SwapChain() = default;
 
@@ -45,6 +75,8 @@ public:
      * @param deviceContext Contexto de dispositivo para operaciones gráficas.
      * @param backBuffer Textura que actuará como back buffer.
      * @param window Ventana donde se presentará el contenido.
+     * @param config Modo de presentación, buffers y latencia.
+     * @param deviceConfig Adaptador donde crear el dispositivo.
      * @return HRESULT indicando el resultado de la operación.
      *
      * @note También configura el **MSAA** y las propiedades de sincronización vertical (VSync).
@@ -52,7 +84,34 @@ public:
     HRESULT init(Device& device,
         DeviceContext& deviceContext,
         Texture& backBuffer,
-        Window window);
+        Window window,
+        const PresentConfig& config = PresentConfig(),
+        const DeviceConfig& deviceConfig = DeviceConfig());
+
+    /**
+     * @brief Dispositivo sin ventana: el back buffer es una textura offscreen.
+     * @param device Dispositivo a crear.
+     * @param deviceContext Contexto inmediato a crear.
+     * @param backBuffer Recibe la textura RGBA8 donde se dibuja.
+     * @param width Ancho (px), cualquiera.
+     * @param height Alto (px), cualquiera.
+     * @param maxFrameLatency Frames en vuelo de @ref waitForFrame.
+     * @param deviceConfig Adaptador o WARP.
+     * @return HRESULT de la creación.
+     *
+     * @note Para lotes (`-headless`): sin `Present` la CPU solo espera a la GPU en
+     * @ref waitForFrame, así que conviene una latencia de 2-3 frames.
+     */
+    HRESULT initHeadless(Device& device,
+        DeviceContext& deviceContext,
+        Texture& backBuffer,
+        unsigned int width,
+        unsigned int height,
+        unsigned int maxFrameLatency,
+        const DeviceConfig& deviceConfig = DeviceConfig());
+
+    /** @brief `true` si se creó con @ref initHeadless. */
+    bool isHeadless() const { return m_headless; }
 
     /** @brief Actualiza el estado del swap chain (en caso de cambios de ventana o configuración). */
     void update();
@@ -72,18 +131,73 @@ public:
      */
     void present();
 
+    /**
+     * @brief Cambia el tamaño de los back buffers sin recrear el dispositivo.
+     * @param backBuffer Textura del back buffer: se libera y se vuelve a obtener.
+     * @param width Nuevo ancho (px).
+     * @param height Nuevo alto (px).
+     * @return HRESULT de `ResizeBuffers`/`GetBuffer`.
+     *
+     * @warning Antes hay que liberar toda vista sobre el back buffer (RTV) y desenlazarla
+     * del contexto; si queda alguna referencia, `ResizeBuffers` falla.
+     */
+    HRESULT resize(Texture& backBuffer, unsigned int width, unsigned int height);
+
+    /**
+     * @brief Espera a que haya hueco para un frame más (latencia acotada).
+     * @param deviceContext Contexto inmediato (marca el final del frame anterior).
+     *
+     * @details Llamar al principio de cada frame, antes de procesar la entrada.
+     */
+    void waitForFrame(DeviceContext& deviceContext);
+
+    /**
+     * @brief Frames que la GPU ya terminó según las queries de evento (todos los anteriores
+     * al valor devuelto). Sin esperar; después de @ref waitForFrame.
+     */
+    unsigned long long pollCompletedFrames(DeviceContext& deviceContext);
+
+    /** @brief Frames comenzados con @ref waitForFrame (el en curso es este menos uno). */
+    unsigned long long getFrameIndex() const { return m_frameIndex; }
+
+    /** @brief `true` si se creó con flip model. */
+    bool isFlipModel() const { return m_flipModel; }
+
+    /** @brief `true` si `Present` puede hacer tearing. */
+    bool isTearingEnabled() const { return m_tearing; }
+
+    /** @brief Nivel de características del dispositivo creado (11_1 si el runtime lo da). */
+    D3D_FEATURE_LEVEL getFeatureLevel() const { return m_featureLevel; }
+
+    /** @brief Nombre del adaptador en uso. */
+    const std::string& getAdapterName() const { return m_adapterName; }
+
 public:
     IDXGISwapChain* m_swapChain = nullptr; ///< Puntero al swap chain de DXGI.
     D3D_DRIVER_TYPE m_driverType = D3D_DRIVER_TYPE_NULL; ///< Tipo de driver utilizado (hardware, referencia, etc.).
 
 private:
+    /// Dispositivo, contexto, `IDXGIDevice` y adaptador (común a las dos inicializaciones).
+    HRESULT createDevice(Device& device, DeviceContext& deviceContext, const DeviceConfig& deviceConfig);
+    /// Latencia máxima de DXGI y queries de `waitForFrame`.
+    HRESULT createFrameQueries(Device& device, unsigned int maxFrameLatency);
+
     D3D_FEATURE_LEVEL m_featureLevel = D3D_FEATURE_LEVEL_11_0; ///< Nivel de características de D3D.
 
-    unsigned int m_sampleCount = 1;   ///< Número de muestras para MSAA.
-    unsigned int m_qualityLevels = 0; ///< Niveles de calidad soportados para MSAA.
+    unsigned int m_sampleCount = 1;   ///< Muestras del back buffer (siempre 1, ver `Multisampling`).
+    unsigned int m_qualityLevels = 0; ///< Calidad MSAA del back buffer (siempre 0).
 
     // Punteros a interfaces DXGI usadas para crear el swap chain
     IDXGIDevice* m_dxgiDevice = nullptr;   ///< Dispositivo DXGI.
     IDXGIAdapter* m_dxgiAdapter = nullptr; ///< Adaptador DXGI (GPU).
     IDXGIFactory* m_dxgiFactory = nullptr; ///< Fábrica DXGI para crear recursos.
+    std::string m_adapterName;             ///< Descripción del adaptador (para el log).
+
+    bool m_headless = false;                 ///< Sin swap chain (`initHeadless`).
+    bool m_flipModel = false;                ///< Swap effect flip activo.
+    bool m_tearing = false;                  ///< Swap chain creado con ALLOW_TEARING.
+    bool m_vsync = false;                    ///< Intervalo de sincronización 1 en vez de 0.
+    std::vector<ID3D11Query*> m_frameQueries; ///< Una query de evento por frame en vuelo.
+    unsigned long long m_frameIndex = 0;     ///< Frames comenzados con `waitForFrame`.
+    unsigned long long m_completedFrames = 0; ///< Frames que la GPU terminó (ver `pollCompletedFrames`).
 };
@@ -0,0 +1,151 @@
+﻿/**
+ * @file Telemetry.h
+ * @brief Telemetría de rendimiento en campo (opcional): distribución de tiempos de frame,
+ * tirones y VRAM por escena, con el adaptador y el driver, en un resumen por sesión.
+ *
+ * @details
+ * Con `-telemetry carpeta` cada sesión escribe `carpeta/session_<fecha>_<pid>.json`, que
+ * recoge la herramienta de la flota. Nada sale de la máquina desde aquí: solo se escribe
+ * el archivo.
+ *
+ * - **Histogramas en vez de muestras**: el tiempo de frame (CPU) y el de GPU van a
+ *   @ref Telemetry::kBins intervalos logarítmicos (de @ref Telemetry::kFirstBinMs en
+ *   pasos de un @ref Telemetry::kBinRatio, hasta unos 2 s). El resumen trae p50, p90,
+ *   p95, p99 y p99.9 y los intervalos no vacíos, que se pueden sumar entre instalaciones
+ *   para sacar la distribución de la flota (los percentiles no se pueden promediar).
+ * - **Por escena**: @ref Telemetry::setScene abre otro agregado (archivo de escena,
+ *   carpeta de streaming o benchmark); cambiar a una escena ya vista sigue sumando en el suyo.
+ * - **Tirones**: frames sobre el umbral de @ref FrameTimeHistory.
+ * - **VRAM**: media y pico del uso del proceso (@ref GpuMemory), con el presupuesto.
+ *
+ * El hilo principal solo suma en arrays fijos. Cada @ref Telemetry::Settings::flushSeconds
+ * se copia el agregado y un hilo lo escribe (archivo temporal y `MoveFileEx`: el de la
+ * flota nunca lee uno a medias); @ref Telemetry::destroy escribe el final.
+ *
+ * @note Para estudiantes: la media de FPS de cientos de máquinas esconde justo lo que
+ * interesa (las de gama baja, los tirones); una distribución por percentiles no.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include <atomic>
+
+class Device;
+class GpuProfiler;
+
+/**
+ * @class Telemetry
+ * @brief Agregados por escena de una sesión y su escritura en segundo plano.
+ */
+class Telemetry {
+public:
+    Telemetry() = default;
+    ~Telemetry() { destroy(); }
+    Telemetry(const Telemetry&) = delete;
+    Telemetry& operator=(const Telemetry&) = delete;
+
+    /// Intervalos del histograma.
+    static const unsigned int kBins = 256;
+    /// Límite superior del primer intervalo (ms).
+    static const double kFirstBinMs;
+    /// Cociente entre los límites de dos intervalos consecutivos.
+    static const double kBinRatio;
+    /// Versión del formato del resumen.
+    static const unsigned int kFormatVersion = 1;
+
+    /// Configuración de la sesión.
+    struct Settings {
+        std::string directory;          ///< Carpeta de los resúmenes (se crea si no existe).
+        float flushSeconds = 60.0f;     ///< Cada cuánto se reescribe el resumen.
+    };
+
+    /**
+     * @brief Abre la sesión: adaptador y driver del dispositivo, carpeta e identificador.
+     * @return `E_INVALIDARG` sin carpeta, o el error de DXGI o de `CreateDirectory`.
+     */
+    HRESULT init(Device& device, const Settings& settings);
+
+    /** @brief Escena de los frames siguientes (identificador libre, p. ej. su ruta). */
+    void setScene(const std::string& sceneId);
+
+    /**
+     * @brief Suma un frame (hilo principal, tras `FrameClock::tick`).
+     * @param frameMs Duración del frame.
+     * @param gpuProfiler Su tiempo de frame cuenta solo cuando trae un resultado nuevo.
+     * @param hitchMs Umbral de tirón.
+     * @param vramUsage Bytes de VRAM que usa el proceso.
+     * @param vramBudget Presupuesto de VRAM (0 = desconocido).
+     */
+    void recordFrame(double frameMs, const GpuProfiler& gpuProfiler, double hitchMs,
+        unsigned long long vramUsage, unsigned long long vramBudget);
+
+    /** @brief Ignora el próximo frame (tras dormir en reposo su duración no es trabajo). */
+    void skipNextFrame() { m_skipNext = true; }
+
+    /** @brief Escribe el resumen final y espera al hilo. */
+    void destroy();
+
+    /** @brief `true` entre @ref init y @ref destroy. */
+    bool isRunning() const { return m_running; }
+
+    /** @brief Archivo de la sesión. */
+    const std::string& getPath() const { return m_path; }
+
+private:
+    /// Distribución de un tiempo.
+    struct Histogram {
+        unsigned int bins[kBins] = {};
+        unsigned long long count = 0;
+
+        void add(double ms);
+        /// Valor del percentil `p` (0..1): límite superior de su intervalo.
+        double percentile(double p) const;
+    };
+
+    /// Agregado de una escena.
+    struct SceneAggregate {
+        std::string id;
+        Histogram frame;
+        Histogram gpu;
+        double seconds = 0.0;
+        unsigned long long hitches = 0;
+        double hitchMs = 0.0;           ///< Último umbral usado.
+        double vramSum = 0.0;           ///< Suma de bytes por frame (para la media).
+        unsigned long long vramPeak = 0;
+        unsigned long long vramBudget = 0;
+    };
+
+    /// Lo que se escribe: copia de los agregados y datos fijos de la sesión.
+    struct Snapshot {
+        std::vector<SceneAggregate> scenes;
+        double durationSeconds = 0.0;
+        bool final = false;
+    };
+
+    /// Copia los agregados y, si el hilo está libre, lo lanza a escribirlos.
+    void flush(bool final);
+
+    /// Serializa y reemplaza el archivo de la sesión (hilo de escritura).
+    HRESULT write(const Snapshot& snapshot) const;
+
+    Settings m_settings;
+    std::string m_path;
+    std::string m_session;              ///< Identificador: fecha UTC y pid.
+    std::string m_started;              ///< Inicio en ISO 8601 (UTC).
+    std::string m_adapterName;
+    std::string m_driverVersion;        ///< `a.b.c.d` de la UMD (vacío si no se pudo leer).
+    unsigned int m_vendorId = 0;
+    unsigned int m_deviceId = 0;
+    unsigned long long m_dedicatedVideoMemory = 0;
+
+    std::vector<SceneAggregate> m_scenes;
+    size_t m_current = 0;               ///< Escena de los frames (índice en `m_scenes`).
+    double m_seconds = 0.0;             ///< Duración de la sesión (frames sumados).
+    double m_sinceFlush = 0.0;
+    unsigned long long m_gpuSerial = 0; ///< Último resultado de GPU sumado.
+    bool m_skipNext = false;
+    bool m_running = false;
+
+    std::thread m_writer;
+    std::atomic<bool> m_writing{ false };
+};
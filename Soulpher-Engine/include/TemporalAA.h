@@ -0,0 +1,147 @@
+﻿/**
+ * @file TemporalAA.h
+ * @brief Antialiasing temporal (TAA) y subida temporal de la escena a la ventana.
+ *
+ * @details
+ * El swap chain no usa MSAA (`SwapChain::init`), así que los bordes se suavizan
+ * repartiendo las muestras en el tiempo:
+ *
+ * - **Jitter** (@ref nextJitter, @ref jitterProjection): cada frame la proyección se
+ *   desplaza menos de un píxel de la escena, siguiendo la secuencia de Halton (2, 3) de
+ *   @ref kJitterPhases fases. El culling sigue usando la proyección sin desplazar.
+ * - **Movimiento**: el píxel más cercano de su vecindario 3x3 se lleva con la
+ *   profundidad al clip del frame anterior (movimiento de cámara). Los objetos que se
+ *   mueven solos no escriben su vector; los cubre el recorte del punto siguiente.
+ * - **Historia**: el resultado anterior se lee con Catmull-Rom (`Upscale.fxh`) en el
+ *   punto reproyectado y se recorta a la caja (media +- desviación, en YCoCg) de los
+ *   colores vecinos de este frame: lo que ya no está en la escena no deja estela.
+ * - **Mezcla**: el frame nuevo pesa según la distancia de su muestra al centro del
+ *   píxel de salida. Con resolución dinámica la salida es del tamaño de la ventana y las
+ *   muestras desplazadas de varios frames reconstruyen el detalle: el TAA hace de subida
+ *   y sustituye al Catmull-Rom de `DynamicResolution`.
+ *
+ * La historia son dos texturas RGBA16F del tamaño de la ventana que se alternan; la que
+ * escribe el frame es también la entrada de bloom, exposición y pase final.
+ *
+ * @note Para estudiantes: con el brillo HDR sin acotar, un píxel muy brillante
+ * dominaría la mezcla y parpadearía; por eso se mezcla en un espacio comprimido
+ * (`c / (1 + luma)`) y se vuelve a expandir al final.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "ConstantBufferLayout.h"
+#include "RenderTargetPool.h"
+
+class Device;
+class DeviceContext;
+
+/**
+ * @class TemporalAA
+ * @brief Secuencia de jitter, kernel de resolución e historia del TAA.
+ */
+class TemporalAA {
+public:
+    TemporalAA() = default;
+    ~TemporalAA() { destroy(); }
+
+    /// Lado del grupo de hilos (`TEMPORAL_TILE`).
+    static const unsigned int kTileSize = 8;
+    /// Fases de la secuencia de jitter antes de repetirse.
+    static const unsigned int kJitterPhases = 8;
+    /// Formato de la historia (y de la escena que sale del TAA).
+    static const DXGI_FORMAT kHistoryFormat = DXGI_FORMAT_R16G16B16A16_FLOAT;
+
+    /// Parámetros que se pueden cambiar cada frame (cvars `r.taa*`).
+    struct Settings {
+        float blend = 0.1f;         ///< Peso del frame nuevo con su muestra en el centro del píxel.
+        float clipScale = 1.25f;    ///< Desviaciones de la caja de colores vecinos.
+    };
+
+    /**
+     * @brief Crea el kernel, las constantes y la historia del tamaño de la ventana.
+     * @return `S_OK`; `DXGI_ERROR_UNSUPPORTED` por debajo de 11_0 (sin TAA).
+     * @note Desde `initSizeDependent`: se vuelve a llamar al redimensionar.
+     */
+    HRESULT init(Device& device, unsigned int width, unsigned int height);
+
+    void setSettings(const Settings& settings) { m_settings = settings; }
+    const Settings& getSettings() const { return m_settings; }
+
+    /**
+     * @brief Avanza la secuencia y devuelve el jitter del frame, en píxeles de la escena.
+     * @note Cada componente en (-0.5, 0.5); @ref resolve usa el último devuelto.
+     */
+    XMFLOAT2 nextJitter();
+
+    /**
+     * @brief `projection` desplazada `jitter` píxeles en una escena de `width` x `height`.
+     * @note Perspectiva LH con vectores fila: basta con sumar a la tercera fila, que es
+     * la que multiplica la z de la vista (el w del clip).
+     */
+    static XMMATRIX jitterProjection(const XMMATRIX& projection, const XMFLOAT2& jitter,
+        unsigned int width, unsigned int height);
+
+    /**
+     * @brief Vistas de la historia que escribirá el próximo @ref resolve (para importarla
+     * en el grafo antes de que se ejecute).
+     */
+    RenderTargetPool::Target getOutput() const;
+
+    /**
+     * @brief Mezcla la escena del frame con la historia y deja el resultado en @ref getOutput.
+     * @param sceneSRV Color de la escena dibujada con el jitter de @ref nextJitter.
+     * @param depthSRV Su depth buffer (R24_UNORM_X8_TYPELESS).
+     * @param sceneWidth Ancho de la escena (con resolución dinámica, menor que la ventana).
+     * @param sceneHeight Alto.
+     * @param viewProj Vista por proyección sin jitter.
+     * @warning Desenlaza los render targets: el depth buffer no puede ser a la vez DSV y SRV.
+     */
+    void resolve(DeviceContext& deviceContext, ID3D11ShaderResourceView* sceneSRV,
+        ID3D11ShaderResourceView* depthSRV, unsigned int sceneWidth, unsigned int sceneHeight,
+        const XMMATRIX& viewProj);
+
+    /** @brief Olvida la historia: el siguiente @ref resolve usa solo el frame nuevo. */
+    void invalidate() { m_hasHistory = false; }
+
+    /** @brief `true` si el último frame dejó historia. */
+    bool hasHistory() const { return m_hasHistory; }
+
+    /** @brief Ancho de la historia (el de la salida del @ref init). */
+    unsigned int getWidth() const { return m_width; }
+    /** @brief Alto de la historia. */
+    unsigned int getHeight() const { return m_height; }
+
+    /** @brief Libera kernel, constantes, sampler e historia. */
+    void destroy();
+
+    /** @brief `true` tras un @ref init correcto. */
+    bool isReady() const { return m_resolveShader != nullptr; }
+
+private:
+    /// Constantes de `cbTemporal` (`CB_SLOT_TEMPORAL`).
+    struct TemporalParams {
+        XMMATRIX reprojection;  ///< Clip actual (sin jitter) -> clip del frame anterior.
+        XMFLOAT4 size;          ///< x, y = ventana (salida); z, w = escena.
+        XMFLOAT4 jitter;        ///< x, y = jitter (píxeles de escena); z = mezcla; w = hay historia.
+        XMFLOAT4 params;        ///< x = desviaciones de la caja.
+    };
+    /// Layout de `cbTemporal` (ver `ConstantBufferLayouts`).
+    static const ConstantBufferLayouts::Registration kParamsLayout;
+
+    Settings m_settings;
+    unsigned int m_width = 0;           ///< Ventana de @ref init (tamaño de la historia).
+    unsigned int m_height = 0;
+    unsigned int m_frame = 0;           ///< Fase de la secuencia de jitter.
+    unsigned int m_current = 0;         ///< Historia con el último resultado.
+    bool m_hasHistory = false;
+    XMFLOAT2 m_jitter = XMFLOAT2(0.0f, 0.0f);
+    XMMATRIX m_previousViewProj = XMMatrixIdentity();
+
+    ID3D11ComputeShader* m_resolveShader = nullptr;
+    ID3D11Buffer* m_params = nullptr;
+    ID3D11SamplerState* m_sampler = nullptr;
+    ID3D11Texture2D* m_history[2] = {};
+    ID3D11ShaderResourceView* m_historySRV[2] = {};
+    ID3D11UnorderedAccessView* m_historyUAV[2] = {};
+};
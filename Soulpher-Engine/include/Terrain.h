@@ -0,0 +1,207 @@
+﻿/**
+ * @file Terrain.h
+ * @brief Terreno con geometry clipmaps: anillos anidados de un mismo bloque de rejilla,
+ * dibujados en un draw instanciado, con las alturas leídas de un mapa en el VS.
+ *
+ * @details
+ * El suelo del editor es un quad de 40x40 con la textura repetida: plano y con un
+ * borde a la vista. Un terreno de verdad no cabe en una malla (ni en memoria ni en
+ * vértices por frame), así que aquí la geometría no depende del tamaño del mundo:
+ *
+ * - **Niveles**: el nivel `l` es un cuadrado de @ref kBlocksPerSide x @ref kBlocksPerSide
+ *   bloques de @ref kBlockQuads celdas, con celdas de `cellSize * 2^l`. Cada nivel se
+ *   centra en la cámara y deja un hueco de 3x3 bloques donde está el nivel anterior
+ *   (que mide lo mismo en celdas y la mitad en mundo). Con 8 niveles y celdas de 0.5 m
+ *   el último mide 6 km; cada nivel más duplica el alcance por 27 bloques más.
+ * - **Encaje**: el centro de cada nivel se elige de grueso a fino, a medio bloque del
+ *   centro del siguiente, así el hueco coincide con bordes de bloque (nunca hay bloques
+ *   a medias) y entre un nivel y el que envuelve siempre queda al menos un bloque grueso.
+ * - **Dibujo**: un único bloque de rejilla (solo índices; el VS saca la celda de
+ *   `SV_VertexID`) y un `DrawIndexedInstanced` con una instancia por bloque visible
+ *   (frustum en CPU con el rango de alturas como caja).
+ * - **Sin grietas**: en el último 30 % de cada nivel los vértices impares se deslizan
+ *   hasta el vértice par (la rejilla del nivel siguiente) y la altura pasa al mip de
+ *   ese nivel. En el borde el nivel fino es idéntico al grueso: no hay T-juntas visibles.
+ *
+ * Las alturas (R16, `[0, 1]` por `Settings::heightScale`) vienen de un DDS por el
+ * `AsyncTextureLoader` (con streaming de mips: @ref requestTexels pide tantos texeles
+ * como celdas del nivel 0 caben en el mapa). Mientras el mapa no llega, o si no
+ * existe, se usa uno procedural generado al iniciar (colinas con un valle plano en el
+ * origen, donde el editor coloca la escena).
+ *
+ * Con `Settings::tessellation` (y nivel 11_0) los bloques pasan por hull y domain:
+ * cada triángulo se subdivide según su tamaño en pantalla y el domain lee la altura de
+ * los nuevos vértices. El factor de una arista solo depende de sus dos extremos, así
+ * que dos triángulos vecinos la subdividen igual.
+ *
+ * @note Para estudiantes: el terreno no está en el pre-pase de profundidad ni proyecta
+ * sombras (como el plano al que sustituye); sí las recibe y escribe el G-buffer.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "ConstantBufferLayout.h"
+#include "Buffer.h"
+#include "ConstantBuffer.h"
+#include "ShaderProgram.h"
+#include "Rasterizer.h"
+#include "Texture.h"
+
+class Device;
+class DeviceContext;
+class Frustum;
+class AsyncTextureLoader;
+
+/**
+ * @class Terrain
+ * @brief Clipmap de alturas alrededor de la cámara.
+ */
+class Terrain {
+public:
+    Terrain() = default;
+    ~Terrain() { destroy(); }
+
+    /// Celdas por lado de un bloque (par: los vértices impares son los que se deslizan).
+    static const unsigned int kBlockQuads = 16;
+    /// Bloques por lado de un nivel (el hueco del nivel fino es el 3x3 central).
+    static const unsigned int kBlocksPerSide = 6;
+    /// Niveles como máximo.
+    static const unsigned int kMaxLevels = 12;
+    /// Lado del mapa procedural de respaldo.
+    static const unsigned int kProceduralSize = 512;
+
+    /// Parámetros del terreno (hilo principal; el render usa la copia de @ref capture).
+    struct Settings {
+        float cellSize = 0.5f;          ///< Lado de la celda del nivel 0 (unidades de mundo).
+        unsigned int levels = 8;        ///< Niveles del clipmap (1 a @ref kMaxLevels).
+        float baseHeight = -5.0f;       ///< Altura del valor 0 del mapa (la del suelo del editor).
+        float heightScale = 40.0f;      ///< Altura del valor 1.
+        float extent = 2048.0f;         ///< Lado que cubre el mapa, centrado en el origen (fuera se estira el borde).
+        float textureScale = 0.25f;     ///< Repeticiones de la difusa por unidad de mundo.
+        float roughness = 0.9f;         ///< Rugosidad escrita en el G-buffer.
+        bool tessellation = false;      ///< Hull/domain (solo si @ref supportsTessellation).
+        float tessellationFactor = 8.0f; ///< Subdivisiones como máximo por arista.
+        float tessellationPixels = 16.0f; ///< Píxeles de arista por subdivisión.
+    };
+
+    /**
+     * @brief Crea la rejilla, el buffer de instancias, los programas y el mapa procedural.
+     * @return `S_OK` o el error; sin él el editor sigue con el plano.
+     * @note El camino teselado es opcional: si no compila (o el nivel es menor que
+     * 11_0) se avisa y @ref supportsTessellation devuelve `false`.
+     */
+    HRESULT init(Device& device);
+
+    /**
+     * @brief Texturas del terreno.
+     * @param heightmap Alturas (R16 con mips); placeholder o nula = el mapa procedural.
+     * @param diffuse Textura de color repetida en mundo; nula = blanca.
+     */
+    void setTextures(const TextureHandle& heightmap, const TextureHandle& diffuse);
+
+    /** @brief Activa el terreno (el editor lo hace al no cargar una escena). */
+    void setEnabled(bool enabled) { m_enabled = enabled; }
+
+    /** @brief `true` si se dibuja este frame. */
+    bool isActive() const { return isReady() && m_enabled; }
+
+    const Settings& getSettings() const { return m_settings; }
+    void setSettings(const Settings& settings) { m_settings = settings; }
+
+    /**
+     * @brief Entrega los parámetros al render.
+     * @note Con el render parado (`BaseApp::captureFrame`).
+     */
+    void capture() { m_frameSettings = m_settings; }
+
+    /** @brief Parámetros del frame capturado (los que usa @ref render). */
+    const Settings& getFrameSettings() const { return m_frameSettings; }
+
+    /**
+     * @brief Mapa de alturas del frame: el del cargador o, mientras no llega, el procedural.
+     * @param size Si no es nulo, recibe el lado del mip residente más fino.
+     */
+    ID3D11ShaderResourceView* getHeightSRV(unsigned int* size = nullptr) const;
+
+    /**
+     * @brief Pide al streaming la resolución del mapa que usa el nivel 0 (hilo principal).
+     */
+    void requestTexels(AsyncTextureLoader& loader) const;
+
+    /**
+     * @brief Dibuja los bloques visibles sobre los targets y la profundidad enlazados.
+     * @param frustum Frustum del frame (culling de bloques).
+     * @param view,projection Cámara del frame (la proyección con el jitter del TAA).
+     * @param cameraPosition Centro de los niveles.
+     * @param viewportHeight Alto del viewport en píxeles (factores de teselado).
+     * @note Espera los recursos de la escena enlazados (sombras, clusters, sondas) y
+     * usa b2 (`cbTerrain`) como `SpriteBatch`: la cola vuelve a subir sus objetos.
+     */
+    void render(DeviceContext& deviceContext, const Frustum& frustum, const XMMATRIX& view,
+        const XMMATRIX& projection, const XMFLOAT3& cameraPosition, float viewportHeight);
+
+    /** @brief Libera programas, buffers y texturas. */
+    void destroy();
+
+    /** @brief `true` tras un @ref init correcto. */
+    bool isReady() const { return m_device != nullptr; }
+
+    /** @brief `true` si hay hull y domain compilados. */
+    bool supportsTessellation() const { return m_hullShader != nullptr && m_domainShader != nullptr; }
+
+    /** @brief Bloques dibujados en el último @ref render. */
+    unsigned int getBlockCount() const { return m_lastBlocks; }
+
+    /** @brief Bloques descartados por el frustum en el último @ref render. */
+    unsigned int getCulledCount() const { return m_lastCulled; }
+
+private:
+    /// Instancia tal como la lee `Terrain.fx` (slot 1).
+    struct InstanceData {
+        XMFLOAT4 block;         ///< xy: esquina del bloque en mundo (x, z), z: celda, w: mip del nivel.
+        XMFLOAT4 level;         ///< xy: centro del nivel, z: medio lado (0 = sin transición), w: mip del siguiente.
+    };
+
+    /// Constantes de `cbTerrain` (b2).
+    struct CBTerrain {
+        XMMATRIX view;
+        XMMATRIX projection;
+        XMFLOAT4 camera;        ///< xyz: posición, w: alto del viewport.
+        XMFLOAT4 heights;       ///< x: altura base, y: escala, z: 1 / lado del mapa, w: repeticiones de la difusa.
+        XMFLOAT4 tessellation;  ///< x: factor máximo, y: píxeles por subdivisión, z: P[1][1], w: rugosidad.
+    };
+    /// Layout de `cbTerrain` (ver `ConstantBufferLayouts`).
+    static const ConstantBufferLayouts::Registration kTerrainLayout;
+
+    /** @brief Mapa de alturas de respaldo: ruido por octavas y un valle plano en el origen. */
+    HRESULT createProceduralHeightmap(Device& device);
+
+    /** @brief Centros de cada nivel (de grueso a fino) y bloques visibles en `m_instances`. */
+    void buildInstances(const Frustum& frustum, const XMFLOAT3& cameraPosition, unsigned int heightmapSize);
+
+    Device* m_device = nullptr;
+    ShaderProgram m_program;                ///< `Terrain.fx`, VS + PS.
+    ShaderProgram m_tessProgram;            ///< `Terrain.fx` con `TESSELLATION` (VS de control + PS).
+    ID3D11HullShader* m_hullShader = nullptr;
+    ID3D11DomainShader* m_domainShader = nullptr;
+    Buffer m_gridIndices;                   ///< Un bloque (índices de 16 bits).
+    unsigned int m_gridIndexCount = 0;
+    Buffer m_instanceBuffer;                ///< Dinámico, @ref kMaxLevels * 36 bloques.
+    TConstantBuffer<CBTerrain> m_constants;
+    Rasterizer m_rasterizer;
+    ID3D11SamplerState* m_heightSampler = nullptr;  ///< Lineal con clamp (fuera del mapa, el borde).
+    ID3D11SamplerState* m_diffuseSampler = nullptr; ///< Anisótropo con wrap.
+    ID3D11Texture2D* m_proceduralTexture = nullptr;
+    ID3D11ShaderResourceView* m_proceduralSRV = nullptr;
+    ID3D11Texture2D* m_whiteTexture = nullptr;
+    ID3D11ShaderResourceView* m_whiteSRV = nullptr;
+
+    TextureHandle m_heightmap;
+    TextureHandle m_diffuse;
+    Settings m_settings;
+    Settings m_frameSettings;               ///< Copia del frame capturado.
+    bool m_enabled = false;
+    std::vector<InstanceData> m_instances;
+    unsigned int m_lastBlocks = 0;
+    unsigned int m_lastCulled = 0;
+};
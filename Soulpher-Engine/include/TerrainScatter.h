@@ -0,0 +1,247 @@
+﻿/**
+ * @file TerrainScatter.h
+ * @brief Vegetación y piedras sobre el terreno colocadas en GPU: un compute shader
+ * genera las instancias cada frame a partir de mapas de densidad y las dibuja con
+ * argumentos indirectos; la CPU no guarda ni una.
+ *
+ * @details
+ * Hierba y piedras suman cientos de miles de objetos en cuanto el terreno llega lejos:
+ * como actores no caben en la cola ni en memoria. Aquí la posición de cada una es una
+ * función del mundo y se recalcula al vuelo:
+ *
+ * - **Capas**: cada @ref Layer es una forma (brizna o piedra) con su separación entre
+ *   candidatos, densidad, distancia máxima, escala, pendiente y color. El mundo se
+ *   divide por capa en tiles de @ref kTileCandidates x @ref kTileCandidates candidatos.
+ * - **Tiles (CPU)**: solo los que están a menos de la distancia de la capa, dentro del
+ *   frustum (con el rango de alturas del terreno como caja) y no ocultos en la lectura
+ *   de Hi-Z de la CPU. Lo único que se sube por frame es su celda de origen.
+ * - **Candidatos (GPU)**: un hilo por candidato. La posición dentro de su celda, la
+ *   escala, el giro y el tono salen de un hash de la celda en mundo (estables al mover
+ *   la cámara); la altura y la pendiente del mapa del terreno; la densidad del canal de
+ *   la capa en el mapa de densidad (@ref setDensityMap) por la de la capa, atenuada al
+ *   final de la distancia. Los que sobreviven se prueban contra el frustum y la
+ *   pirámide Hi-Z (como `GpuCulling.fx`) y se añaden a la lista de su capa.
+ * - **Dibujo**: un `DrawIndexedInstancedIndirect` por capa con el conteo que dejó el
+ *   kernel (recortado a @ref kLayerCapacity). El VS lee la instancia de la lista con el
+ *   hueco del slot 1, como el camino GPU-driven.
+ *
+ * @note Para estudiantes: como el terreno, no entra en el pre-pase ni proyecta sombras;
+ * las recibe y escribe el G-buffer. Las instancias son del frame: nada que reservar al
+ * cargar ni que liberar al alejarse.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "ConstantBufferLayout.h"
+#include "Buffer.h"
+#include "ConstantBuffer.h"
+#include "Rasterizer.h"
+#include "ShaderProgram.h"
+#include "Texture.h"
+
+class Device;
+class DeviceContext;
+class Frustum;
+class HiZBuffer;
+class Terrain;
+
+/// Malla de una capa de @ref TerrainScatter.
+enum ScatterShape {
+    SCATTER_GRASS = 0,  ///< Mata de tres briznas (dos caras, se mece con el viento).
+    SCATTER_ROCK = 1,   ///< Icosaedro achatado.
+    SCATTER_SHAPE_COUNT
+};
+
+/**
+ * @class TerrainScatter
+ * @brief Instancias de vegetación y piedras generadas en GPU sobre el @ref Terrain.
+ */
+class TerrainScatter {
+public:
+    TerrainScatter() = default;
+    ~TerrainScatter() { destroy(); }
+
+    /// Capas como máximo (una por canal del mapa de densidad).
+    static const unsigned int kMaxLayers = 4;
+    /// Candidatos por lado de un tile (un grupo del kernel por cada 64).
+    static const unsigned int kTileCandidates = 32;
+    /// Tiles por frame como máximo, entre todas las capas.
+    static const unsigned int kMaxTiles = 1024;
+    /// Instancias por capa y frame como máximo.
+    static const unsigned int kLayerCapacity = 65536;
+
+    /// Una capa de instancias.
+    struct Layer {
+        ScatterShape shape = SCATTER_GRASS;
+        float spacing = 0.35f;          ///< Distancia entre candidatos (lado del tile: 32 veces esta).
+        float density = 0.8f;           ///< Fracción de candidatos que se quedan con densidad 1.
+        float maxDistance = 60.0f;      ///< Alcance desde la cámara (el último 30 % se va aclarando).
+        float minScale = 0.6f;
+        float maxScale = 1.1f;
+        float minUp = 0.8f;             ///< Y mínima de la normal del terreno (1 = solo en llano).
+        unsigned int densityChannel = 0; ///< Canal del mapa de densidad (0 a 3).
+        XMFLOAT4 color = XMFLOAT4(0.32f, 0.52f, 0.18f, 1.0f);
+        float colorVariation = 0.3f;    ///< Variación de tono entre instancias.
+    };
+
+    /// Parámetros del scatter (hilo principal; el render usa la copia de @ref capture).
+    struct Settings {
+        Layer layers[kMaxLayers];
+        unsigned int layerCount = 2;
+        float densityScale = 1.0f;      ///< Multiplica la densidad de todas las capas (0 = nada).
+        float wind = 0.15f;             ///< Desplazamiento de la punta de las briznas (unidades de mundo).
+        float roughness = 0.85f;        ///< Rugosidad escrita en el G-buffer.
+
+        Settings();
+    };
+
+    /**
+     * @brief Crea las mallas, las listas de instancias, los argumentos y los kernels.
+     * @return `S_OK`; `DXGI_ERROR_UNSUPPORTED` por debajo de 11_0 (sin scatter).
+     */
+    HRESULT init(Device& device);
+
+    /**
+     * @brief Mapa de densidad: un canal por capa sobre el `extent` del terreno.
+     * @param densityMap RGBA en `[0, 1]`; nulo o placeholder = densidad 1 en todas.
+     */
+    void setDensityMap(const TextureHandle& densityMap) { m_densityMap = densityMap; }
+
+    void setEnabled(bool enabled) { m_enabled = enabled; }
+
+    /** @brief `true` si se genera y dibuja este frame. */
+    bool isActive() const { return isReady() && m_enabled; }
+
+    const Settings& getSettings() const { return m_settings; }
+    void setSettings(const Settings& settings) { m_settings = settings; }
+
+    /**
+     * @brief Entrega los parámetros al render y avanza el tiempo del viento.
+     * @note Con el render parado (`BaseApp::captureFrame`).
+     */
+    void capture(float deltaTime);
+
+    /**
+     * @brief Elige los tiles visibles y lanza el kernel que llena las listas.
+     * @param terrain Terreno activo (mapa de alturas y parámetros del frame).
+     * @param frustum Frustum del frame (tiles en CPU, instancias en GPU).
+     * @param hiZ Lectura en CPU (tiles) y pirámide (instancias) del frame anterior.
+     * @note Antes de @ref render, fuera de cualquier pase que lea las listas.
+     */
+    void generate(DeviceContext& deviceContext, const Terrain& terrain, const Frustum& frustum,
+        const HiZBuffer& hiZ, const XMFLOAT3& cameraPosition);
+
+    /**
+     * @brief Dibuja las capas generadas sobre los targets y la profundidad enlazados.
+     * @note Espera b0/b1 y los recursos de la escena enlazados (sombras, clusters,
+     * sondas); usa b2 (`cbScatter`) como el terreno.
+     */
+    void render(DeviceContext& deviceContext);
+
+    /** @brief Libera kernels, mallas, listas y estados. */
+    void destroy();
+
+    /** @brief `true` tras un @ref init correcto. */
+    bool isReady() const { return m_device != nullptr; }
+
+    /** @brief Tiles enviados al kernel en el último @ref generate. */
+    unsigned int getTileCount() const { return m_lastTiles; }
+
+    /** @brief Tiles descartados en CPU (distancia, frustum u oclusión) en el último @ref generate. */
+    unsigned int getCulledTileCount() const { return m_lastCulledTiles; }
+
+private:
+    /// Tile tal como lo lee `TerrainScatter.fx` (t0).
+    struct TileData {
+        int cellX;              ///< Primera celda del tile en mundo (unidades de `spacing`).
+        int cellZ;
+        unsigned int layer;
+        unsigned int pad;
+    };
+
+    /// Instancia tal como la escribe el kernel (solo GPU; aquí para el tamaño).
+    struct InstanceData {
+        XMFLOAT3 position;
+        float scale;
+        float rotation;
+        unsigned int layer;
+        float tint;
+        float phase;
+    };
+
+    /// Argumentos de `DrawIndexedInstancedIndirect`.
+    struct DrawArgs {
+        unsigned int indexCount;
+        unsigned int instanceCount;
+        unsigned int startIndex;
+        int baseVertex;
+        unsigned int startInstance;
+    };
+
+    /// Constantes de `cbScatter` (b2, en el kernel y en el dibujo).
+    struct CBScatter {
+        XMFLOAT4 planes[6];
+        XMMATRIX hiZViewProj;                ///< Transpuesta.
+        XMFLOAT4 camera;                     ///< xyz: posición, w: tiempo del viento.
+        XMFLOAT4 heights;                    ///< x: altura base, y: escala, z: 1 / lado del mapa, w: viento.
+        XMFLOAT4 placement[kMaxLayers];      ///< x: separación, y: densidad, z: distancia, w: inicio del desvanecido.
+        XMFLOAT4 shape[kMaxLayers];          ///< x, y: escala mínima y máxima, z: normal mínima, w: canal.
+        XMFLOAT4 bounds[kMaxLayers];         ///< x: radio, y: alto (a escala 1).
+        XMFLOAT4 color[kMaxLayers];          ///< rgb: color, w: variación.
+        unsigned int tileCount;
+        unsigned int hiZMipCount;            ///< 0 = sin pirámide.
+        unsigned int hiZSize[2];
+        float roughness;
+        float pad[3];
+    };
+    /// Layout de `cbScatter` (ver `ConstantBufferLayouts`).
+    static const ConstantBufferLayouts::Registration kScatterLayout;
+
+    /// Rango de índices de una forma en la malla compartida.
+    struct ShapeRange {
+        unsigned int indexCount = 0;
+        unsigned int startIndex = 0;
+        int baseVertex = 0;
+        float radius = 0.0f;    ///< Medio ancho a escala 1.
+        float height = 0.0f;    ///< Alto a escala 1.
+    };
+
+    /** @brief Briznas y piedra en un vertex e index buffer compartidos. */
+    HRESULT createMeshes(Device& device);
+
+    /** @brief Tiles visibles de cada capa en `m_tiles`. */
+    void buildTiles(const Terrain& terrain, const Frustum& frustum, const HiZBuffer& hiZ,
+        const XMFLOAT3& cameraPosition);
+
+    Device* m_device = nullptr;
+    ID3D11ComputeShader* m_scatterShader = nullptr;
+    ID3D11ComputeShader* m_finalizeShader = nullptr;
+    ShaderProgram m_program;                ///< `TerrainScatter.fx`, VS + PS.
+    Buffer m_vertices;                      ///< Formas (posición + peso del viento).
+    Buffer m_indices;
+    ShapeRange m_shapes[SCATTER_SHAPE_COUNT];
+    Buffer m_slotBuffer;                    ///< 0..N-1 por instancia (hueco en la lista).
+    ID3D11Buffer* m_tileBuffer = nullptr;   ///< Dinámico, @ref kMaxTiles.
+    ID3D11ShaderResourceView* m_tileSRV = nullptr;
+    ID3D11Buffer* m_instanceBuffer = nullptr; ///< @ref kMaxLayers * @ref kLayerCapacity.
+    ID3D11ShaderResourceView* m_instanceSRV = nullptr;
+    ID3D11UnorderedAccessView* m_instanceUAV = nullptr;
+    ID3D11Buffer* m_argsBuffer = nullptr;   ///< Un `DrawArgs` por capa.
+    ID3D11UnorderedAccessView* m_argsUAV = nullptr;
+    TConstantBuffer<CBScatter> m_constants;
+    Rasterizer m_rasterizer;
+    Rasterizer m_twoSidedRasterizer;        ///< Briznas.
+    ID3D11SamplerState* m_sampler = nullptr; ///< Lineal con clamp (alturas y densidad).
+    ID3D11Texture2D* m_whiteTexture = nullptr;
+    ID3D11ShaderResourceView* m_whiteSRV = nullptr;
+
+    TextureHandle m_densityMap;
+    Settings m_settings;
+    Settings m_frameSettings;               ///< Copia del frame capturado.
+    float m_frameTime = 0.0f;
+    bool m_enabled = false;
+    std::vector<TileData> m_tiles;
+    unsigned int m_generatedLayers = 0;     ///< Capas con argumentos listos para @ref render.
+    unsigned int m_lastTiles = 0;
+    unsigned int m_lastCulledTiles = 0;
+};
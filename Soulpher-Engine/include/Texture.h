@@ -18,6 +18,8 @@
 
 #pragma once
 #include "Prerequisites.h"
+#include "BlockCompressor.h"
+#include "DdsFile.h"
 
 class Device;
 class DeviceContext;
@@ -42,13 +44,36 @@ public:
      * @param device Dispositivo Direct3D usado para la creación.
      * @param textureName Ruta del archivo de textura.
      * @param extensionType Tipo de extensión de la imagen (para elegir el método de carga).
+     * @param compression Formato BCn para PNG/JPG; la primera carga lo codifica y lo
+     * guarda como DDS junto al original (@ref DdsFile), las siguientes leen ese DDS.
      * @return HRESULT que indica éxito o error de la operación.
      *
      * @note Ideal para cargar texturas difusas, normales o especulares desde disco.
+     * PNG/JPG se crean con todos sus mips (@ref MipChain); los DDS traen los suyos.
      */
     HRESULT init(Device device,
         const std::string& textureName,
-        ExtensionType extensionType);
+        ExtensionType extensionType,
+        TextureCompression compression = TEXTURE_COMPRESSION_NONE);
+
+    /**
+     * @brief Igual que la carga desde archivo, pero con el dispositivo nativo.
+     * @param device Dispositivo Direct3D (libre de hilos: crear recursos es seguro desde cualquier hilo).
+     * @param textureName Ruta del archivo sin extensión.
+     * @param extensionType DDS, PNG o JPG.
+     * @param compression Igual que en la variante con `Device`.
+     * @param maxSize Lado máximo del mip más detallado que se sube a VRAM (streaming;
+     * 0 = imagen completa). Los mips mayores se omiten (ver @ref m_residentMip).
+     * @return HRESULT que indica éxito o error de la operación.
+     *
+     * @note No copia `Device` (sus miembros compartidos no cuentan referencias de forma
+     * atómica): es la variante que se puede llamar desde hilos de trabajo.
+     */
+    HRESULT init(ID3D11Device* device,
+        const std::string& textureName,
+        ExtensionType extensionType,
+        TextureCompression compression = TEXTURE_COMPRESSION_NONE,
+        unsigned int maxSize = 0);
 
     /**
      * @brief Crea una textura 2D vacía (generalmente para render targets o depth buffers).
@@ -82,6 +107,27 @@ public:
      */
     HRESULT init(Device& device, Texture& textureRef, DXGI_FORMAT format);
 
+    /**
+     * @brief Crea una textura RGBA8 inmutable con su SRV a partir de píxeles en memoria.
+     * @param device Dispositivo Direct3D.
+     * @param width Ancho en píxeles.
+     * @param height Alto en píxeles.
+     * @param rgba `width * height` píxeles de 4 bytes (R, G, B, A).
+     * @return HRESULT que indica éxito o error de la operación.
+     *
+     * @note Útil para texturas procedurales (patrones de prueba, escenas sintéticas).
+     */
+    HRESULT init(Device& device, unsigned int width, unsigned int height, const void* rgba);
+
+    /**
+     * @brief Copia que comparte los recursos de esta textura (sube su contador COM).
+     * @return Textura con los mismos punteros; cada copia se libera con su `destroy`.
+     *
+     * @note `Actor::destroy` libera sus texturas: pasar copias compartidas permite
+     * que muchos actores usen la misma textura sin liberarla dos veces.
+     */
+    Texture share() const;
+
     /**
      * @brief Adjunta un recurso nativo de textura existente.
      * @param tex Puntero a la textura ID3D11Texture2D.
@@ -109,11 +155,33 @@ public:
      */
     void render(DeviceContext& deviceContext, unsigned int StartSlot, unsigned int NumViews);
 
-    /** @brief Libera todos los recursos asociados a la textura. */
+    /**
+     * @brief Libera todos los recursos asociados a la textura.
+     * @note El `Release` se difiere hasta que la GPU termina el frame (@ref GpuReleaseQueue).
+     */
     void destroy();
 
 public:
     ID3D11Texture2D* m_texture = nullptr;                 ///< Recurso de textura 2D.
     ID3D11ShaderResourceView* m_textureFromImg = nullptr; ///< Vista SRV asociada (si aplica).
     std::string m_textureName;                            ///< Nombre o ruta del archivo original.
+
+    // === Residencia (texturas de archivo) ===
+    unsigned int m_width = 0;          ///< Ancho del mip 0 completo, esté o no en VRAM.
+    unsigned int m_height = 0;         ///< Alto del mip 0 completo.
+    unsigned int m_mipCount = 1;       ///< Mips de la imagen completa.
+    unsigned int m_residentMip = 0;    ///< Mip más detallado en VRAM (0 = completa).
+    size_t m_residentBytes = 0;        ///< Bytes de VRAM que ocupan los mips residentes.
+
+private:
+    /// Copia tamaño completo y residencia tras una carga desde archivo.
+    void setResidency(const DdsFile::Info& info);
 };
+
+/**
+ * @brief Textura compartida: varios actores apuntan al **mismo** objeto `Texture`.
+ *
+ * @note Al compartir el objeto (y no solo la SRV) se puede cambiar su contenido en un
+ * único sitio: @ref AsyncTextureLoader sustituye ahí el placeholder por la textura real.
+ */
+typedef EU::TSharedPointer<Texture> TextureHandle;
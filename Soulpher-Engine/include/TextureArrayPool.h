@@ -0,0 +1,107 @@
+﻿/**
+ * @file TextureArrayPool.h
+ * @brief Agrupa texturas del mismo tamaño y formato en `Texture2DArray`s.
+ *
+ * @details
+ * Cada textura enlazada en t0 obliga a la `RenderQueue` a cortar el lote
+ * instanciado: cien actores con la misma malla y cien texturas distintas son cien
+ * draws. El pool copia (con `CopySubresourceRegion`, en la GPU) cada textura en una
+ * capa de un array con su mismo ancho, alto, formato y número de mips; la cola
+ * agrupa entonces por array y pasa la capa por instancia (slot 2), y el shader
+ * instanciado con `TEXTURE_ARRAY` muestrea `float3(uv, capa)`.
+ *
+ * - La identidad de una textura es su SRV: los actores que comparten textura
+ *   comparten capa, y cuando @ref AsyncTextureLoader cambia el contenido de un
+ *   handle (placeholder, streaming de mips) la SRV nueva ocupa otra capa.
+ * - Las capas que nadie pide durante @ref kUnusedFrames se liberan (y con ellas
+ *   la referencia a la SRV original).
+ * - Arrays, cubemaps y texturas MSAA no entran: siguen enlazándose sueltas.
+ *
+ * @note Para estudiantes: la copia duplica la memoria de la textura mientras está
+ * en el pool; a cambio, un lote puede mezclar tantas texturas como capas tenga el array.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include <unordered_map>
+
+class Device;
+class DeviceContext;
+class Texture;
+
+/**
+ * @class TextureArrayPool
+ * @brief Capas de `Texture2DArray` para texturas compatibles, creadas bajo demanda.
+ */
+class TextureArrayPool {
+public:
+    TextureArrayPool() = default;
+    ~TextureArrayPool() { destroy(); }
+
+    /// Capas por array (los arrays llenos se complementan con otro del mismo formato).
+    static const unsigned int kSlicesPerArray = 32;
+    /// Frames sin uso tras los que una capa se libera.
+    static const unsigned int kUnusedFrames = 120;
+
+    /// Dónde está una textura dentro del pool.
+    struct Slot {
+        ID3D11ShaderResourceView* srv = nullptr; ///< SRV del array (nula = la textura no entra).
+        unsigned int slice = 0;                  ///< Capa dentro del array.
+    };
+
+    /**
+     * @brief Guarda el dispositivo con el que se crean los arrays.
+     * @return `E_POINTER` si el dispositivo es nulo.
+     */
+    HRESULT init(Device& device);
+
+    /** @brief Nuevo frame: libera las capas sin uso durante @ref kUnusedFrames. */
+    void update();
+
+    /**
+     * @brief Capa de una textura; la primera vez la copia en un array.
+     * @param deviceContext Contexto donde se hace la copia.
+     * @param texture Textura con SRV 2D (sin array ni MSAA).
+     * @return Slot con la SRV del array, o un slot vacío si la textura no entra.
+     */
+    Slot resolve(DeviceContext& deviceContext, const Texture* texture);
+
+    /** @brief Libera arrays y referencias. */
+    void destroy();
+
+    /** @brief `true` tras un @ref init correcto. */
+    bool isReady() const { return m_device != nullptr; }
+
+    /** @brief Arrays creados. */
+    unsigned int getArrayCount() const { return static_cast<unsigned int>(m_arrays.size()); }
+
+    /** @brief Texturas con capa asignada. */
+    unsigned int getSliceCount() const;
+
+private:
+    /// Un `Texture2DArray` y sus capas libres.
+    struct Array {
+        ID3D11Texture2D* texture = nullptr;
+        ID3D11ShaderResourceView* srv = nullptr;
+        D3D11_TEXTURE2D_DESC desc = {};      ///< `ArraySize` = @ref kSlicesPerArray.
+        std::vector<unsigned int> freeSlices;
+    };
+
+    /// Capa ocupada (o textura descartada, con `array` = `kNoArray`).
+    struct Member {
+        unsigned int array = 0;
+        unsigned int slice = 0;
+        unsigned long long lastUsed = 0;
+    };
+
+    static const unsigned int kNoArray = ~0u;
+
+    /// Busca (o crea) un array con el formato de `desc` y una capa libre.
+    unsigned int acquireSlice(const D3D11_TEXTURE2D_DESC& desc, unsigned int& slice);
+
+    ID3D11Device* m_device = nullptr;    ///< Retenido (AddRef) mientras viva el pool.
+    std::vector<Array> m_arrays;
+    /// SRV de la textura original (retenida) -> su capa.
+    std::unordered_map<ID3D11ShaderResourceView*, Member> m_members;
+    unsigned long long m_frame = 0;
+};
@@ -0,0 +1,116 @@
+﻿/**
+ * @file TraceCapture.h
+ * @brief Captura de N frames a un archivo Chrome `trace_event` (chrome://tracing, Perfetto).
+ *
+ * @details
+ * Mientras graba, cada frame se convierten a eventos:
+ * - Zonas de CPU del @ref CpuProfiler (un `tid` por hilo).
+ * - Secciones del @ref GpuProfiler, en un carril "GPU". Sus timestamps se pasan al
+ *   reloj de CPU con un par (QPC, timestamp) tomado al empezar (`GpuProfiler::calibrate`).
+ *   Los resultados de GPU llegan tres frames tarde, así que la captura sigue unos
+ *   frames más tras el último para recogerlos.
+ * - Contadores por frame: draw calls y bytes subidos (de `DeviceContext`).
+ *
+ * El hilo del render solo copia eventos (nombres literales, sin texto) a una cola;
+ * un hilo escritor les da formato JSON y los escribe en disco, así la captura no
+ * alarga el frame por E/S.
+ *
+ * @note Para estudiantes: el formato es un JSON con un array `traceEvents`; "X" es un
+ * evento con duración, "C" un contador y "M" metadatos (nombre de cada hilo).
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "CpuProfiler.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+class GpuProfiler;
+class DeviceContext;
+
+/**
+ * @class TraceCapture
+ * @brief Graba los próximos N frames y los vuelca a JSON en un hilo aparte.
+ */
+class TraceCapture {
+public:
+    TraceCapture() = default;
+    ~TraceCapture() { destroy(); }
+
+    /// Frames extra tras la captura para recoger los resultados retrasados de GPU.
+    static const unsigned int kGpuDrainFrames = 4;
+    /// `tid` del carril de GPU (lejos de los índices de hilo de CPU).
+    static const unsigned int kGpuThreadId = 1000;
+
+    /**
+     * @brief Empieza a grabar.
+     * @param path Archivo de salida (.json).
+     * @param frames Frames a grabar.
+     * @param gpuProfiler Perfilador de GPU (se calibra su reloj; puede estar desactivado).
+     * @param deviceContext Contexto inmediato.
+     * @return `S_OK`, `E_PENDING` si ya hay una captura o el error al abrir el archivo.
+     */
+    HRESULT start(const std::string& path, unsigned int frames,
+        GpuProfiler& gpuProfiler, DeviceContext& deviceContext);
+
+    /**
+     * @brief Registra el frame recién terminado; llamar una vez por frame tras `PROFILE_FRAME`.
+     * @param cpuProfiler Zonas de CPU (el frame 0 del historial es el que terminó).
+     * @param gpuProfiler Resultados de GPU (si hay nuevos desde la última llamada).
+     * @param deviceContext Contadores del frame (draw calls, bytes).
+     */
+    void recordFrame(const CpuProfiler& cpuProfiler, const GpuProfiler& gpuProfiler,
+        const DeviceContext& deviceContext);
+
+    /** @brief `true` mientras graba o recoge resultados de GPU. */
+    bool isRecording() const { return m_framesLeft > 0 || m_drainLeft > 0; }
+
+    /** @brief Archivo de la última captura. */
+    const std::string& getPath() const { return m_path; }
+
+    /** @brief Termina la captura en curso (si hay) y espera al hilo escritor. */
+    void destroy();
+
+private:
+    /// Evento sin formato: lo que el hilo del render entrega al escritor.
+    struct TraceEvent {
+        char phase;          ///< 'X' (duración), 'C' (contador) o 'M' (nombre de hilo).
+        const char* name;    ///< Literal (zona, sección o contador).
+        double timestamp;    ///< Microsegundos desde el inicio de la captura.
+        double duration;     ///< Microsegundos ('X').
+        unsigned int thread; ///< `tid` del evento.
+        double value;        ///< Valor del contador ('C').
+    };
+
+    /// Bucle del hilo escritor: vacía la cola a disco hasta que se cierra la captura.
+    void writerLoop();
+
+    /// Microsegundos desde el inicio de la captura para una lectura de QPC.
+    double cpuToUs(LONGLONG ticks) const;
+
+    /// Encola un lote para el escritor.
+    void push(std::vector<TraceEvent>& batch);
+
+    std::string m_path;                  ///< Archivo de salida.
+    FILE* m_file = nullptr;              ///< Abierto por `start`, escrito solo por el escritor.
+    std::thread m_writer;                ///< Hilo escritor.
+    std::mutex m_queueMutex;             ///< Protege `m_queue` y `m_closing`.
+    std::condition_variable m_queueReady;///< Avisa al escritor de lotes nuevos.
+    std::vector<std::vector<TraceEvent>> m_queue; ///< Lotes pendientes de escribir.
+    bool m_closing = false;              ///< No habrá más lotes: cerrar el archivo.
+
+    unsigned int m_framesLeft = 0;       ///< Frames de CPU por grabar.
+    unsigned int m_drainLeft = 0;        ///< Frames extra para resultados de GPU.
+    LONGLONG m_cpuOrigin = 0;            ///< QPC del inicio (t = 0 en el archivo).
+    double m_usPerCpuTick = 0.0;         ///< Microsegundos por tick de QPC.
+    bool m_gpuAligned = false;           ///< La calibración de GPU funcionó.
+    LONGLONG m_calibrationCpu = 0;       ///< QPC de la calibración.
+    UINT64 m_calibrationGpu = 0;         ///< Timestamp de GPU de la calibración.
+    UINT64 m_gpuFrequency = 0;           ///< Frecuencia de la calibración.
+    unsigned long long m_gpuSerial = 0;  ///< Último resultado de GPU registrado.
+    std::vector<TraceEvent> m_batch;     ///< Lote del frame (se reutiliza la memoria).
+    std::vector<CpuProfiler::ThreadEvent> m_cpuEvents; ///< Zonas del frame (se reutiliza la memoria).
+    std::vector<char> m_seenThreads;     ///< Hilos de CPU cuyo nombre ya se escribió.
+    std::deque<std::string> m_threadNames; ///< Copias de los nombres (direcciones estables).
+};
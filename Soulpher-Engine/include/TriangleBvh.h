@@ -0,0 +1,80 @@
+﻿/**
+ * @file TriangleBvh.h
+ * @brief BVH binaria de triángulos de mundo para los horneados por trazado de rayos en CPU.
+ *
+ * @details
+ * La usan los horneados que necesitan rayos contra la geometría real y no contra cajas
+ * (`LightmapBaker`, `PotentialVisibility`):
+ *
+ * - **Construcción**: partición por la mediana del eje más largo de los centros, con
+ *   hojas de hasta @ref TriangleBvh::kLeafSize triángulos. Los triángulos se reordenan
+ *   para que cada hoja sea un rango contiguo.
+ * - **Trazado**: pila fija, slabs contra las cajas y Möller-Trumbore de dos caras; con
+ *   `anyHit` se sale en el primer choque (rayos de sombra o de visibilidad).
+ *
+ * @note Para estudiantes: a diferencia de `SceneBVH` (cajas de actores, reajuste en cada
+ * frame), esta se construye una vez por horneado y nunca cambia.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "ECS/ActorPool.h"
+
+/// Triángulo de mundo preparado para Möller-Trumbore.
+struct Triangle {
+    XMFLOAT3 v0, e1, e2;
+    XMFLOAT3 normal;   ///< Normal de cara (orden de los vértices), unitaria.
+};
+
+/**
+ * @class TriangleBvh
+ * @brief BVH de triángulos de solo lectura tras @ref build.
+ */
+class TriangleBvh {
+public:
+    static const unsigned int kLeafSize = 4;
+
+    /** @brief Construye el árbol (se queda con los triángulos, reordenados). */
+    void build(std::vector<Triangle> triangles);
+
+    /**
+     * @brief Choque más cercano antes de `maxT` (o cualquiera con `anyHit`).
+     * @param hitT Distancia del choque (en unidades de `direction`).
+     * @param hitTriangle Índice del triángulo (ver @ref getTriangle).
+     */
+    bool trace(const XMFLOAT3& origin, const XMFLOAT3& direction, float maxT, bool anyHit,
+        float& hitT, unsigned int& hitTriangle) const;
+
+    const Triangle& getTriangle(unsigned int index) const { return m_triangles[index]; }
+
+    /** @brief Triángulos del árbol. */
+    size_t getTriangleCount() const { return m_triangles.size(); }
+
+    /**
+     * @brief Triángulos de mundo de los actores estáticos y opacos con copia de CPU.
+     * @param boundsMin,boundsMax Caja de los triángulos añadidos (se amplía, no se reinicia).
+     * @note Los que no tienen copia de CPU (`MeshAsset::hasCpuData`) se saltan: el que
+     * llama decide si eso es un error (opción `-lightmapbake 1`).
+     */
+    static void gatherStatic(const std::vector<ActorHandle>& actors, std::vector<Triangle>& triangles,
+        XMFLOAT3& boundsMin, XMFLOAT3& boundsMax);
+
+private:
+    struct Node {
+        XMFLOAT3 min, max;
+        unsigned int first;  ///< Hoja: primer triángulo; interior: primer hijo (el otro va detrás).
+        unsigned int count;  ///< Triángulos de la hoja (0 = interior).
+    };
+
+    /// Rellena el nodo `index` (ya reservado) con los triángulos `order[begin, end)`.
+    void buildNode(unsigned int index, std::vector<unsigned int>& order, const std::vector<XMFLOAT3>& centers,
+        unsigned int begin, unsigned int end);
+
+    static bool intersectsBox(const Node& node, const XMFLOAT3& origin, const XMFLOAT3& inverse, float maxT);
+
+    /// Möller-Trumbore de dos caras.
+    static bool intersectTriangle(const Triangle& t, const XMFLOAT3& origin, const XMFLOAT3& direction, float& hitT);
+
+    std::vector<Node> m_nodes;
+    std::vector<Triangle> m_triangles;
+};
@@ -0,0 +1,163 @@
+﻿/**
+ * @file UploadScheduler.h
+ * @brief Subidas de buffers y texturas repartidas entre frames con un anillo de staging.
+ *
+ * @details
+ * Crear un recurso con datos iniciales sube todo de golpe, y `UpdateSubresource`
+ * sobre algo grande obliga al driver a copiar en el momento: las dos cosas dan
+ * picos en el frame en que ocurren. El planificador recibe los datos (desde
+ * cualquier hilo), los guarda en CPU y cada @ref update copia como mucho
+ * @ref setFrameBudget bytes:
+ *
+ * 1. Los datos de buffers se escriben en el segmento del frame de un anillo de
+ *    @ref kRingFrames buffers `STAGING`; las texturas, en texturas `STAGING` de su
+ *    mismo tamaño y formato (recicladas cuando la GPU ya no puede estar leyéndolas).
+ * 2. Tras el `Unmap`, un `CopySubresourceRegion` por subida lleva cada bloque a su
+ *    destino. La copia la hace la GPU en orden con el resto del frame.
+ *
+ * - Los `Map` usan `DO_NOT_WAIT`: si un staging sigue en uso, las subidas esperan
+ *   al frame siguiente en vez de parar el contexto inmediato.
+ * - Un buffer grande se trocea entre frames; un subrecurso de textura va entero
+ *   (si no cabe en lo que queda del presupuesto, espera; si es lo primero del
+ *   frame, pasa aunque supere el presupuesto, para que siempre haya progreso).
+ * - Los mips BCn de menos de 4 texeles de lado no se pueden copiar desde una
+ *   textura de staging propia (BCn exige lados múltiplos de 4): esos pocos bytes
+ *   van con `UpdateSubresource`.
+ * - Las subidas se atienden en orden (FIFO): @ref isComplete con el número que
+ *   devolvió la subida dice si ya se copió.
+ *
+ * @note Para estudiantes: el destino tiene que ser `D3D11_USAGE_DEFAULT` (no
+ * `IMMUTABLE`: esas solo aceptan datos iniciales). Los constant buffers de D3D11.0
+ * no admiten copias parciales, así que para ellos hay que subir el buffer entero.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include <deque>
+#include <mutex>
+
+class Device;
+class DeviceContext;
+
+/**
+ * @class UploadScheduler
+ * @brief Cola de subidas a GPU con presupuesto de bytes por frame.
+ */
+class UploadScheduler {
+public:
+    UploadScheduler() = default;
+    ~UploadScheduler() { destroy(); }
+
+    /// Segmentos del anillo: un staging no se reutiliza hasta pasados estos frames.
+    static const unsigned int kRingFrames = 3;
+    /// Presupuesto por defecto (bytes por frame).
+    static const unsigned int kDefaultFrameBudget = 4 * 1024 * 1024;
+    /// Frames sin uso tras los que una textura de staging se libera.
+    static const unsigned int kStagingIdleFrames = 120;
+
+    /**
+     * @brief Crea el anillo de staging de buffers.
+     * @param device Dispositivo (su `ID3D11Device` se retiene mientras viva el planificador).
+     * @param frameBudget Bytes copiados como máximo por frame (y tamaño de cada segmento).
+     * @return `E_POINTER` si el dispositivo es nulo, o el error al crear el anillo.
+     */
+    HRESULT init(Device& device, unsigned int frameBudget = kDefaultFrameBudget);
+
+    /**
+     * @brief Encola una subida a un buffer (cualquier hilo).
+     * @param destination Buffer `DEFAULT` (se retiene hasta que la copia termine).
+     * @param offset Byte del destino donde empieza la copia.
+     * @param data Datos (se copian al encolar).
+     * @param bytes Tamaño de los datos.
+     * @return Número de la subida (para @ref isComplete), o 0 si no se encoló.
+     */
+    unsigned long long uploadBuffer(ID3D11Buffer* destination, unsigned int offset,
+        const void* data, unsigned int bytes);
+
+    /**
+     * @brief Encola una subida a un subrecurso de textura 2D (cualquier hilo).
+     * @param destination Textura `DEFAULT` (se retiene hasta que la copia termine).
+     * @param subresource `D3D11CalcSubresource(mip, capa, mips)`.
+     * @param data Filas del subrecurso (se copian al encolar).
+     * @param rowPitch Bytes por fila (por fila de bloques 4x4 en BCn).
+     * @param rows Filas (filas de bloques en BCn).
+     * @return Número de la subida, o 0 si no se encoló.
+     */
+    unsigned long long uploadTexture(ID3D11Texture2D* destination, unsigned int subresource,
+        const void* data, unsigned int rowPitch, unsigned int rows);
+
+    /**
+     * @brief Copia lo que quepa en el presupuesto del frame (hilo principal, una vez por frame).
+     * @return Bytes copiados en esta llamada.
+     */
+    unsigned int update(DeviceContext& deviceContext);
+
+    /** @brief `true` si la subida `ticket` ya se copió (o si `ticket` es 0). */
+    bool isComplete(unsigned long long ticket) const;
+
+    /** @brief Cambia el presupuesto por frame (el anillo se recrea en el próximo @ref update). */
+    void setFrameBudget(unsigned int bytes);
+
+    /** @brief Presupuesto actual. */
+    unsigned int getFrameBudget() const { return m_frameBudget; }
+
+    /** @brief Bytes encolados que aún no se han copiado. */
+    unsigned long long getPendingBytes() const;
+
+    /** @brief Texturas de staging vivas. */
+    unsigned int getStagingTextureCount() const { return static_cast<unsigned int>(m_staging.size()); }
+
+    /** @brief Libera staging, destinos retenidos y subidas pendientes. */
+    void destroy();
+
+private:
+    /// Una subida encolada.
+    struct Request {
+        unsigned long long ticket = 0;
+        ID3D11Resource* destination = nullptr; ///< Retenido (AddRef).
+        bool texture = false;
+        unsigned int subresource = 0;
+        unsigned int offset = 0;         ///< Buffers: byte de destino.
+        unsigned int rowPitch = 0;       ///< Texturas: bytes por fila.
+        unsigned int rows = 0;           ///< Texturas: filas.
+        std::vector<unsigned char> data;
+        size_t consumed = 0;             ///< Buffers: bytes ya copiados.
+    };
+
+    /// Una textura de staging y el último frame que se escribió.
+    struct Staging {
+        ID3D11Texture2D* texture = nullptr;
+        D3D11_TEXTURE2D_DESC desc = {};
+        unsigned long long lastUsed = 0;
+    };
+
+    /// Copia pendiente de emitir tras el `Unmap`.
+    struct Copy {
+        ID3D11Resource* destination;
+        unsigned int subresource;
+        unsigned int dstX;
+        ID3D11Resource* source;
+        D3D11_BOX box;
+    };
+
+    /// Crea (o recrea) los segmentos del anillo con el presupuesto actual.
+    HRESULT createRing();
+
+    /// Textura de staging libre con el tamaño y formato de un subrecurso de `desc`.
+    Staging* acquireStaging(const D3D11_TEXTURE2D_DESC& desc, unsigned int width, unsigned int height);
+
+    ID3D11Device* m_device = nullptr;     ///< Retenido (AddRef).
+    ID3D11Buffer* m_ring[kRingFrames] = {}; ///< Segmentos `STAGING` de buffers.
+    unsigned int m_ringBytes = 0;         ///< Tamaño de cada segmento.
+    unsigned int m_frameBudget = kDefaultFrameBudget;
+    std::vector<Staging> m_staging;       ///< Texturas de staging (solo hilo principal).
+    std::vector<Copy> m_copies;           ///< Copias del frame en curso.
+    std::deque<Request> m_active;         ///< Subidas en proceso (solo hilo principal).
+    unsigned long long m_frame = 0;
+
+    mutable std::mutex m_mutex;           ///< Protege lo de abajo.
+    std::deque<Request> m_incoming;       ///< Subidas recién encoladas.
+    unsigned long long m_nextTicket = 1;
+    unsigned long long m_completed = 0;   ///< Última subida copiada (FIFO: las anteriores también).
+    unsigned long long m_pendingBytes = 0;
+};
@@ -32,7 +32,15 @@ class Window;
 class SwapChain;
 class Texture;
 class Actor;
+struct ActorHandle;
 class ModelComponent;
+class GpuProfiler;
+class ActorCost;
+class CpuProfiler;
+class DeviceContext;
+class FrameTimeHistory;
+class GpuMemory;
+class ShaderHotReload;
 
 /**
  * @class UserInterface
@@ -61,10 +69,51 @@ public:
      */
     void init(void* window, ID3D11Device* device, ID3D11DeviceContext* deviceContext);
 
-    /** @brief Actualiza la lógica de la interfaz (input, estados, ventanas). */
+    /**
+     * @brief Sin ventana (`-headless`): un contexto de ImGui sin backends, para que
+     * `ImGui::GetIO` siga valiendo. No se abre ningún frame ni se dibuja nada.
+     */
+    void initHeadless();
+
+    /**
+     * @brief Empieza el frame de ImGui: dockspace, barra de menús y popup de salida.
+     * @note En modo jugador no empieza ningún frame, salvo la superposición mínima
+     * (@ref setPlayerStats): entonces solo hay frame para @ref playerStats.
+     */
     void update();
 
-    /** @brief Dibuja la interfaz gráfica en pantalla. */
+    /**
+     * @brief Modo jugador: sin editor. No hay frame de ImGui (ni `NewFrame` ni `Render`
+     * ni listas que dibujar), así que la UI no cuesta nada en CPU ni en GPU.
+     * @note Entre frames (F11, `-player 1`). Al entrar se cierran las ventanas secundarias.
+     */
+    void setPlayerMode(bool playerMode);
+
+    /** @brief `true` en modo jugador (la app no debe dibujar paneles del editor). */
+    bool isPlayerMode() const { return m_playerMode; }
+
+    /** @brief Superposición mínima del modo jugador (`ui.playerStats`). */
+    void setPlayerStats(bool enabled) { m_playerStats = enabled; }
+
+    /**
+     * @brief Superposición del modo jugador: FPS y tiempos de CPU y GPU del último frame.
+     * @note No hace nada sin frame de ImGui (modo jugador sin @ref setPlayerStats).
+     */
+    void playerStats(const FrameTimeHistory& frameTimes, const GpuProfiler& gpuProfiler);
+
+    /** @brief Hay listas de ImGui que dibujar (las de @ref prepareRender). */
+    bool hasDrawData() const { return m_drawData.Valid && m_drawData.CmdListsCount > 0; }
+
+    /**
+     * @brief Cierra el frame de ImGui: copia la lista de dibujo de la ventana principal y
+     * dibuja las ventanas secundarias (hilo principal, con el render parado).
+     *
+     * @note La copia es la que dibuja @ref render, así el siguiente `update` puede empezar
+     * otro frame de ImGui mientras el hilo de render dibuja este.
+     */
+    void prepareRender();
+
+    /** @brief Dibuja la interfaz de la ventana principal (la copia de @ref prepareRender). */
     void render();
 
     /** @brief Libera todos los recursos asociados a ImGui. */
@@ -93,21 +142,56 @@ public:
     void menuBar(Window window, SwapChain swapChain, Texture& backBuffer);
 
     /**
-     * @brief Ventana de vista previa del framebuffer/render.
-     * @param window Ventana de aplicación.
-     * @param renderTexture Textura a mostrar.
+     * @brief Panel "Viewport": muestra la escena (`EditorViewport`) y mide su área.
+     * @param renderTexture Target de la escena (nulo el primer frame: solo se mide).
+     *
+     * @details La primera vez se acopla en el nodo central del dockspace. El área libre
+     * del panel es el tamaño que pide la escena (@ref getViewportSize); plegado, en una
+     * pestaña de atrás o cerrado ("Window > Viewport") cuenta como oculto.
      */
-    void Renderer(Window window, ID3D11ShaderResourceView* renderTexture);
+    void Renderer(ID3D11ShaderResourceView* renderTexture);
+
+    /** @brief El panel "Viewport" se dibujó este frame (visible y con área). */
+    bool isViewportVisible() const { return m_viewportVisible; }
+
+    /** @brief Área del panel "Viewport" en píxeles (la del último frame visible). */
+    void getViewportSize(unsigned int& width, unsigned int& height) const {
+        width = m_viewportWidth;
+        height = m_viewportHeight;
+    }
+
+    /** @brief Esquina superior izquierda de la imagen del panel en pantalla (la del último frame visible). */
+    void getViewportOrigin(float& x, float& y) const {
+        x = m_viewportOriginX;
+        y = m_viewportOriginY;
+    }
 
-    /** @brief Inspector general de propiedades de un actor. */
-    void inspectorGeneral(EU::TSharedPointer<Actor> actor);
+    /** @brief Ratón relativo a la esquina superior izquierda de la imagen (píxeles del panel). */
+    void getViewportMouse(int& x, int& y) const {
+        x = m_viewportMouseX;
+        y = m_viewportMouseY;
+    }
+
+    /** @brief El ratón está sobre la imagen del panel o arrastra desde ella (cámara y selección). */
+    bool isViewportHovered() const { return m_viewportHovered; }
+
+    /**
+     * @brief Inspector general de propiedades de un actor.
+     * @details El nombre se edita en un buffer propio que solo se rellena al cambiar de
+     * actor (o si el nombre cambia fuera) y se aplica con `setName` al terminar la edición.
+     * @param costs Coste por actor (sección "Cost"); `nullptr` = sin sección.
+     */
+    void inspectorGeneral(ActorHandle actor, ActorCost* costs = nullptr);
 
     /** @brief Inspector para componentes contenedores de un actor. */
-    void inspectorContainer(EU::TSharedPointer<Actor> actor);
+    void inspectorContainer(ActorHandle actor);
 
-    /** @brief Ventana de consola/log de salida. */
+    /** @brief Ventana "Output": últimas líneas del log (@ref Logger) y su nivel en ejecución; avisos en amarillo, errores en rojo. */
     void output();
 
+    /** @brief Ventana "Console": cvars editables (@ref ConsoleVariables) y una línea de comandos. */
+    void console();
+
     /** @brief Aplica estilo oscuro. */
     void darkStyle();
 
@@ -138,13 +222,119 @@ public:
     /** @brief Ventana transparente que cubre toda la pantalla. */
     void RenderFullScreenTransparentWindow();
 
-    /** @brief Muestra la lista jerárquica de actores en escena. */
-    void outliner(const std::vector<EU::TSharedPointer<Actor>>& actors);
+    /**
+     * @brief Panel "Hierarchy": los actores de la escena, virtualizado.
+     *
+     * @details Con más de @ref kOutlinerGroupSize actores se agrupan en nodos de ese
+     * tamaño que se expanden bajo demanda; cabeceras y filas de los grupos abiertos forman
+     * una sola lista que `ImGuiListClipper` recorta, así que solo se emiten las filas
+     * visibles. Con filtro, los índices que pasan se recalculan solo al cambiar el texto,
+     * el número de actores o un nombre (@ref markOutlinerDirty). Un frame sin cambios
+     * cuesta las filas visibles y no reserva memoria.
+     *
+     * Con `costs`, "Sort by" ordena una lista plana (con el filtro aplicado) del actor
+     * más caro al más barato; el orden se rehace cada @ref kOutlinerSortFrames frames.
+     * También decide si se recogen los contadores (@ref ActorCost::setTracking).
+     */
+    void outliner(const std::vector<ActorHandle>& actors, ActorCost* costs = nullptr);
+
+    /** @brief Recalcula el filtro del "Hierarchy" (un actor se creó, destruyó o renombró). */
+    void markOutlinerDirty() { m_outlinerDirty = true; }
+
+    /**
+     * @brief Panel con el tiempo de GPU de cada pase del último frame medido.
+     * @param profiler Perfilador del render (resultados con tres frames de retraso).
+     * Desde el panel se activan sus estadísticas de pipeline (VS/PS, primitivas, overdraw).
+     */
+    void gpuProfiler(GpuProfiler& profiler);
+
+    /**
+     * @brief Flame graph de las zonas de CPU de los últimos frames, un carril por hilo.
+     * @param profiler Registro de zonas (solo tiene datos si se compiló con `PROFILE`).
+     */
+    void cpuProfiler(const CpuProfiler& profiler);
+
+    /**
+     * @brief Superposición con los contadores del último frame (draws, binds, bytes).
+     * @param deviceContext Contexto inmediato (`getLastFrameStats`).
+     * @note Se oculta o muestra desde "Profile > Stats overlay".
+     */
+    void renderStats(const DeviceContext& deviceContext);
+
+    /**
+     * @brief Panel "Frame Times": historial, histograma, p50/p95/p99 y tirones capturados.
+     * @param history Tiempos de frame (el panel cambia su umbral de tirón y puede vaciarlo).
+     * @param profiler Para dibujar las zonas de CPU del tirón seleccionado.
+     */
+    void frameTimes(FrameTimeHistory& history, const CpuProfiler& profiler);
+
+    /**
+     * @brief Panel "Memory": reservas del último frame por subsistema (`MemoryTracker`),
+     * infracciones de los bloques sin reservas y ocupación de los arenas de frame.
+     */
+    void memoryStats();
+
+    /**
+     * @brief Panel "GPU Memory": presupuesto y uso de vídeo según DXGI (en rojo si se
+     * pasa) y lo que ha creado el motor por categoría.
+     * @param memory Estado leído en el último @ref GpuMemory::update.
+     */
+    void gpuMemory(const GpuMemory& memory);
+
+    /**
+     * @brief Panel "Shaders": estado de la recarga en caliente y su registro, con los
+     * errores de compilación en rojo.
+     * @param reload Recarga de shaders (el panel puede vaciar su registro).
+     */
+    void shaderReload(ShaderHotReload& reload);
+
+    /**
+     * @brief Devuelve (una vez) el tirón que se pidió guardar con "Save trace".
+     * @param index Recibe su posición en `FrameTimeHistory::getHitches`.
+     */
+    bool consumeHitchExportRequest(size_t& index);
+
+    /**
+     * @brief Devuelve (una vez) la captura de traza pedida desde el menú "Profile".
+     * @param frames Recibe los frames a grabar si hay petición.
+     * @return `true` si el usuario pidió una captura desde la última llamada.
+     */
+    bool consumeTraceRequest(unsigned int& frames);
+
+    /** @brief Devuelve (una vez) si se pidió "Profile > Add camera key" (recorrido de benchmark). */
+    bool consumeCameraKeyRequest();
+
+    /** @brief Devuelve (una vez) si se pidió "Profile > Capture screenshot". */
+    bool consumeScreenshotRequest();
+
+    /** @brief Devuelve (una vez) si se pidió "File > Save" (escena, ver `SceneFile`). */
+    bool consumeSaveSceneRequest();
+
+    /** @brief Devuelve (una vez) si se pidió "Tools > Bake lightmaps" (ver `LightmapBaker`). */
+    bool consumeBakeLightmapsRequest();
+
+    /** @brief Devuelve (una vez) si se pidió "Tools > Bake visibility" (ver `PotentialVisibility`). */
+    bool consumeBakeVisibilityRequest();
+
+    /** @brief Devuelve (una vez) si se pidió "Profile > Start/Stop recording". */
+    bool consumeRecordToggleRequest();
+
+    /** @brief Estado que muestra el menú de grabación (lo fija la app cada frame). */
+    void setRecording(bool recording) { m_recording = recording; }
+
+    /** @brief Estado de "Profile > GPU event markers" (eventos para PIX/RenderDoc). */
+    bool eventMarkersEnabled() const { return m_eventMarkers; }
+
+    /** @brief Estado de "Profile > Texture arrays" (lotes instanciados con `Texture2DArray`). */
+    bool textureArraysEnabled() const { return m_textureArrays; }
 
 public:
     int selectedActorIndex = -1; ///< Índice del actor actualmente seleccionado.
 
 private:
+    /// Libera las listas clonadas de `m_drawData`.
+    void releaseDrawData();
+
     bool checkboxValue = true;   ///< Ejemplo de valor booleano para UI.
     bool checkboxValue2 = false; ///< Segundo valor booleano.
     std::vector<const char*> m_objectsNames; ///< Lista de nombres de objetos.
@@ -152,4 +342,60 @@ private:
 
     bool show_exit_popup = false; ///< Control para mostrar popup de salida.
     bool m_imguiInitialized = false; ///< Bandera de inicialización de ImGui.
+    ImDrawData m_drawData;           ///< Copia del último `prepareRender` (apunta a `m_drawLists`).
+    std::vector<ImDrawList*> m_drawLists; ///< Listas clonadas de la ventana principal.
+    int m_flameFrames = 4;           ///< Frames que muestra el flame graph de CPU.
+    int m_traceFrames = 120;         ///< Frames de la próxima captura de traza.
+    bool m_traceRequested = false;   ///< Captura pedida y aún no atendida.
+    bool m_cameraKeyRequested = false; ///< Clave de cámara pedida y aún no guardada.
+    bool m_screenshotRequested = false; ///< Captura de pantalla pedida y aún no atendida.
+    bool m_saveSceneRequested = false; ///< "File > Save" pulsado y aún no atendido.
+    bool m_recordToggleRequested = false; ///< Empezar/terminar grabación pedido y no atendido.
+    bool m_bakeLightmapsRequested = false; ///< "Tools > Bake lightmaps" pulsado y aún no atendido.
+    bool m_bakeVisibilityRequested = false; ///< "Tools > Bake visibility" pulsado y aún no atendido.
+    bool m_recording = false;        ///< Hay una grabación en curso (para el texto del menú).
+    bool m_eventMarkers = true;      ///< Emitir marcadores de eventos de GPU.
+    bool m_textureArrays = false;    ///< Agrupar texturas compatibles en arrays (duplica su VRAM).
+    bool m_showStats = true;         ///< Mostrar la superposición de estadísticas.
+    bool m_showViewport = true;      ///< "Window > Viewport".
+    bool m_playerMode = false;       ///< Sin editor (@ref setPlayerMode).
+    bool m_playerStats = false;      ///< Superposición mínima en modo jugador.
+    bool m_headless = false;         ///< Creado con `initHeadless`: nunca hay frame.
+    bool m_frameActive = false;      ///< `update` empezó un frame de ImGui.
+
+    /// Actores por grupo del panel "Hierarchy" (escenas grandes).
+    static const int kOutlinerGroupSize = 1024;
+    /// Dibuja la fila del actor `index` del panel "Hierarchy".
+    void outlinerRow(const std::vector<ActorHandle>& actors, int index);
+    ImGuiTextFilter m_outlinerFilter;        ///< Búsqueda del panel "Hierarchy".
+    std::vector<int> m_outlinerMatches;      ///< Actores que pasan el filtro.
+    std::vector<int> m_outlinerOpenGroups;   ///< Grupos expandidos, ordenados.
+    size_t m_outlinerActorCount = 0;         ///< Actores al calcular `m_outlinerMatches`.
+    bool m_outlinerDirty = true;             ///< Hay que recalcular `m_outlinerMatches`.
+    /// Frames publicados entre dos ordenaciones por coste (el orden no salta cada frame).
+    static const unsigned long long kOutlinerSortFrames = 30;
+    int m_outlinerSort = 0;                  ///< `ActorCost::SortKey` del "Hierarchy".
+    std::vector<int> m_outlinerSorted;       ///< Actores ordenados por coste.
+    unsigned long long m_outlinerSortSerial = 0; ///< `ActorCost::getSerial` de `m_outlinerSorted`.
+    bool m_costPanelOpen = false;            ///< La sección "Cost" del inspector se dibujó abierta.
+    char m_nameBuffer[128] = {};             ///< Nombre en edición del inspector.
+    uint32_t m_nameActor = 0;                ///< Handle del actor de `m_nameBuffer`.
+    bool m_nameEditing = false;              ///< El campo del nombre tiene el foco.
+    bool m_viewportVisible = false;  ///< El panel se dibujó en el último `Renderer`.
+    bool m_viewportHovered = false;  ///< Ratón sobre la imagen del panel.
+    unsigned int m_viewportWidth = 0; ///< Área del panel.
+    unsigned int m_viewportHeight = 0;
+    float m_viewportOriginX = 0.0f;  ///< Esquina de la imagen en pantalla.
+    float m_viewportOriginY = 0.0f;
+    int m_viewportMouseX = 0;        ///< Ratón relativo a la imagen.
+    int m_viewportMouseY = 0;
+    unsigned int m_dockspaceId = 0;  ///< Dockspace de la ventana (el panel se acopla en su centro).
+    float m_frameTimeRangeMs = 50.0f; ///< Escala de la gráfica y el histograma de "Frame Times".
+    static const unsigned long long kNoHitch = ~0ull; ///< `m_selectedHitchFrame` sin selección.
+    unsigned long long m_selectedHitchFrame = kNoHitch; ///< Frame del tirón mostrado en detalle.
+    bool m_hitchExportRequested = false; ///< "Save trace" pulsado y aún no atendido.
+    size_t m_hitchExportIndex = 0;   ///< Tirón a guardar.
+    static const size_t kConsoleHistory = 256; ///< Líneas que guarda la consola.
+    char m_consoleInput[256] = {};   ///< Línea que se está escribiendo en "Console".
+    std::vector<std::string> m_consoleOutput; ///< Comandos y respuestas de "Console".
 };
@@ -0,0 +1,118 @@
+﻿/**
+ * @file VertexFormat.h
+ * @brief Codificación de los vértices en GPU y su input layout.
+ *
+ * @details
+ * En CPU los vértices son siempre `SimpleVertex` (20 bytes). Al crear los buffers
+ * (`MeshAsset::init`), `VertexFormat` los codifica según la configuración activa:
+ *
+ * | Atributo  | Codificación         | Formato DXGI            | Bytes |
+ * |-----------|----------------------|-------------------------|-------|
+ * | posición  | `POSITION_FLOAT32`   | `R32G32B32_FLOAT`       | 12    |
+ * | posición  | `POSITION_SNORM16`   | `R16G16B16A16_SNORM`    | 8     |
+ * | UV        | `TEXCOORD_FLOAT32`   | `R32G32_FLOAT`          | 8     |
+ * | UV        | `TEXCOORD_FLOAT16`   | `R16G16_FLOAT`          | 4     |
+ * | UV        | `TEXCOORD_UNORM16`   | `R16G16_UNORM`          | 4     |
+ *
+ * El formato compacto (`SNORM16` + `FLOAT16`) ocupa 12 bytes por vértice frente a 20,
+ * y el stream de posiciones de los pases de profundidad 8 frente a 12.
+ *
+ * **Posiciones cuantizadas**: se guardan en [-1, 1] respecto a la AABB del asset
+ * (@ref PositionDecode) con `w = 1`. La vuelta a espacio de modelo es una escala y
+ * una traslación, así que se pliega en la matriz de mundo del actor
+ * (@ref getDecodeMatrix): los shaders no cambian y el pre-pase de profundidad sigue
+ * haciendo exactamente las mismas operaciones que el pase principal.
+ *
+ * @note Para estudiantes: `TEXCOORD_UNORM16` solo representa UV en [0, 1] (se
+ * recortan las demás); con UV repetidas (el suelo usa 0..kTiling) hay que usar `FLOAT16`.
+ * `SimpleVertex` no tiene normales ni tangentes; cuando las tenga, este es el sitio
+ * para añadir su codificación (p. ej. octaédrica en `R16G16_SNORM`).
+ */
+
+#pragma once
+#include "Prerequisites.h"
+
+class MeshComponent;
+
+/// Codificación de la posición en el vertex buffer.
+enum PositionEncoding {
+    POSITION_FLOAT32 = 0, ///< Sin comprimir.
+    POSITION_SNORM16,     ///< 16 bits por eje respecto a la AABB del asset.
+};
+
+/// Codificación de las coordenadas de textura.
+enum TexcoordEncoding {
+    TEXCOORD_FLOAT32 = 0, ///< Sin comprimir.
+    TEXCOORD_FLOAT16,     ///< Medio float: admite UV repetidas (fuera de [0, 1]).
+    TEXCOORD_UNORM16,     ///< 16 bits en [0, 1].
+};
+
+/**
+ * @class VertexFormat
+ * @brief Describe cómo se codifican los vértices en GPU y genera su input layout.
+ */
+class VertexFormat {
+public:
+    /// Paso de espacio cuantizado a espacio de modelo: `pos = offset + q * scale`.
+    struct PositionDecode {
+        XMFLOAT3 offset = XMFLOAT3(0.0f, 0.0f, 0.0f); ///< Centro de la AABB.
+        XMFLOAT3 scale = XMFLOAT3(1.0f, 1.0f, 1.0f);  ///< Semiextensión de la AABB.
+    };
+
+    VertexFormat() = default;
+    VertexFormat(PositionEncoding position, TexcoordEncoding texcoord)
+        : m_position(position), m_texcoord(texcoord) {}
+
+    /** @brief Formato sin comprimir (el `SimpleVertex` tal cual). */
+    static VertexFormat full() { return VertexFormat(POSITION_FLOAT32, TEXCOORD_FLOAT32); }
+
+    /** @brief Formato comprimido por defecto: posición `SNORM16` y UV `FLOAT16`. */
+    static VertexFormat compact() { return VertexFormat(POSITION_SNORM16, TEXCOORD_FLOAT16); }
+
+    PositionEncoding getPositionEncoding() const { return m_position; }
+    TexcoordEncoding getTexcoordEncoding() const { return m_texcoord; }
+
+    /** @brief Bytes por vértice del stream completo (slot 0). */
+    unsigned int getStride() const;
+
+    /** @brief Bytes por vértice del stream de solo posiciones. */
+    unsigned int getPositionStride() const;
+
+    /**
+     * @brief Elementos `POSITION` y `TEXCOORD` del slot 0.
+     * @note Los programas instanciados añaden detrás sus elementos por instancia.
+     */
+    std::vector<D3D11_INPUT_ELEMENT_DESC> getInputLayout() const;
+
+    /** @brief Elemento `POSITION` solo (stream de los pases de profundidad). */
+    D3D11_INPUT_ELEMENT_DESC getPositionElement() const;
+
+    /**
+     * @brief AABB común de varias submallas como transformación de descuantizado.
+     * @note Los ejes planos (extensión 0) usan escala 1 para no dividir por cero.
+     */
+    static PositionDecode computeDecode(const std::vector<MeshComponent>& meshes);
+
+    /**
+     * @brief Matriz que lleva de espacio cuantizado a espacio de modelo.
+     * @return Identidad con `POSITION_FLOAT32`; si no, escala + traslación de `decode`.
+     */
+    XMMATRIX getDecodeMatrix(const PositionDecode& decode) const;
+
+    /**
+     * @brief Codifica los vértices (posición + UV) para el stream del slot 0.
+     * @param vertices Vértices en espacio de modelo.
+     * @param decode Transformación del asset (se ignora con `POSITION_FLOAT32`).
+     * @param out Recibe `vertices.size() * getStride()` bytes.
+     */
+    void encode(const std::vector<SimpleVertex>& vertices, const PositionDecode& decode,
+        std::vector<unsigned char>& out) const;
+
+    /** @brief Como @ref encode, pero solo posiciones (`getPositionStride()` bytes cada una). */
+    void encodePositions(const std::vector<SimpleVertex>& vertices, const PositionDecode& decode,
+        std::vector<unsigned char>& out) const;
+
+private:
+    PositionEncoding m_position = POSITION_FLOAT32; ///< Codificación de la posición.
+    TexcoordEncoding m_texcoord = TEXCOORD_FLOAT32; ///< Codificación de las UV.
+};
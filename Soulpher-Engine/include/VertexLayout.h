@@ -0,0 +1,121 @@
+﻿/**
+ * @file VertexLayout.h
+ * @brief Descripción declarativa de los streams de vértices de un programa.
+ *
+ * @details
+ * Un `VertexLayout` es una lista de elementos (semántica, formato, slot y si avanza
+ * por vértice o por instancia) a partir de la cual se generan los
+ * `D3D11_INPUT_ELEMENT_DESC`. Los streams del motor son fijos:
+ *
+ * | Slot | Stream                    | Contenido                                  |
+ * |------|---------------------------|--------------------------------------------|
+ * | 0    | `VERTEX_STREAM_GEOMETRY`  | Vértices del `MeshAsset` (o solo posiciones) |
+ * | 1    | `VERTEX_STREAM_INSTANCE`  | Mundo + color por instancia (o `INSTANCE_SLOT`) |
+ * | 2    | `VERTEX_STREAM_SLICE`     | Capa del Texture2DArray por instancia      |
+ * | 3    | `VERTEX_STREAM_LIGHTMAP`  | UV2 del lightmap (`MeshAsset` con UV2)     |
+ *
+ * Los programas componen sus layouts con `append` a partir de las piezas estáticas
+ * (`geometry`, `positions`, `instanceWorld`, ...), y `select` se queda con los
+ * streams indicados; así el pre-pase de profundidad y el shadow map enlazan solo el
+ * stream de posiciones sin repetir la descripción a mano.
+ *
+ * El hash (`getHash`) usa el texto de las semánticas, no sus punteros, y es la mitad
+ * de la clave de la @ref InputLayoutCache.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include <cstdint>
+
+class VertexFormat;
+
+/// Slots de vertex buffer que usa el motor.
+enum VertexStream {
+    VERTEX_STREAM_GEOMETRY = 0, ///< Vértices de la malla.
+    VERTEX_STREAM_INSTANCE = 1, ///< Datos por instancia (`CBChangesEveryFrame`).
+    VERTEX_STREAM_SLICE = 2,    ///< Capa del array de texturas por instancia.
+    VERTEX_STREAM_LIGHTMAP = 3, ///< Segundo juego de UV (lightmaps).
+};
+
+/**
+ * @struct VertexElement
+ * @brief Un atributo de un stream.
+ *
+ * @note `semantic` debe vivir tanto como el layout (en la práctica, un literal).
+ */
+struct VertexElement {
+    const char* semantic = nullptr;           ///< Nombre semántico HLSL.
+    unsigned int semanticIndex = 0;           ///< Índice semántico.
+    DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN; ///< Formato en el buffer.
+    unsigned int slot = VERTEX_STREAM_GEOMETRY; ///< Slot del Input Assembler.
+    bool perInstance = false;                 ///< Avanza por instancia en vez de por vértice.
+};
+
+/**
+ * @class VertexLayout
+ * @brief Elementos de uno o varios streams; genera el input layout de D3D11.
+ */
+class VertexLayout {
+public:
+    VertexLayout() = default;
+
+    /**
+     * @brief Añade un elemento al final de su stream (offset alineado automático).
+     * @return El propio layout, para encadenar.
+     */
+    VertexLayout& add(const char* semantic, unsigned int semanticIndex, DXGI_FORMAT format,
+        unsigned int slot = VERTEX_STREAM_GEOMETRY, bool perInstance = false);
+
+    /** @brief Añade todos los elementos de `other` detrás de los propios. */
+    VertexLayout& append(const VertexLayout& other);
+
+    /**
+     * @brief Copia con solo los elementos de los slots pedidos.
+     * @param slotMask Bit `1 << slot` por cada stream que se conserva.
+     */
+    VertexLayout select(unsigned int slotMask) const;
+
+    /** @brief Stream 0 completo (posición + UV) del formato de vértices. */
+    static VertexLayout geometry(const VertexFormat& format);
+
+    /** @brief Stream 0 solo con la posición (pases de profundidad). */
+    static VertexLayout positions(const VertexFormat& format);
+
+    /** @brief Stream 1: mundo por instancia (`INSTANCE_WORLD0..3`). */
+    static VertexLayout instanceWorld();
+
+    /** @brief Stream 1: mundo + `INSTANCE_COLOR` (el `CBChangesEveryFrame` entero). */
+    static VertexLayout instanceData();
+
+    /** @brief Stream 2: capa del Texture2DArray (`INSTANCE_SLICE`). */
+    static VertexLayout instanceSlice();
+
+    /** @brief Stream 1 del camino GPU-driven: hueco en la lista de visibles (`INSTANCE_SLOT`). */
+    static VertexLayout instanceSlot();
+
+    /** @brief Stream 3: UV2 del lightmap (`TEXCOORD1`, R16G16_UNORM). */
+    static VertexLayout lightmapUV();
+
+    /** @brief Descriptores para `CreateInputLayout`. */
+    std::vector<D3D11_INPUT_ELEMENT_DESC> getDesc() const;
+
+    /** @brief Elementos del layout en orden. */
+    const std::vector<VertexElement>& getElements() const { return m_elements; }
+
+    /** @brief Bytes por elemento del stream `slot` (suma de sus formatos). */
+    unsigned int getStride(unsigned int slot) const;
+
+    /** @brief Máscara `1 << slot` de los streams que usa el layout. */
+    unsigned int getSlotMask() const;
+
+    /** @brief Hash FNV-1a de los elementos (semánticas por contenido). */
+    uint64_t getHash() const;
+
+    /** @brief Hash de una lista de descriptores (mismo criterio que `getHash`). */
+    static uint64_t hashDesc(const std::vector<D3D11_INPUT_ELEMENT_DESC>& desc);
+
+    bool empty() const { return m_elements.empty(); }
+
+private:
+    std::vector<VertexElement> m_elements; ///< Elementos en orden de declaración.
+};
@@ -0,0 +1,218 @@
+﻿/**
+ * @file VirtualFileSystem.h
+ * @brief Sistema de archivos virtual: paquetes `.spak` mapeados una vez y archivos sueltos.
+ *
+ * @details
+ * Los recursos se leían de cientos de archivos sueltos (`ModelsFBX\\...\\axl_D.png`,
+ * sus `.auto.dds`, los `.smesh`...), cada uno con su `CreateFile` y su mapeo. Un
+ * paquete junta todos en un solo archivo que se mapea al montarlo; abrir un recurso
+ * es buscar su ruta en una tabla y devolver un puntero dentro de esa vista.
+ *
+ * Disposición de un `.spak` (little-endian):
+ *
+ * | Sección  | Contenido                                                   |
+ * |----------|-------------------------------------------------------------|
+ * | `Header` | firma `SPAK`, versión, número de entradas y desplazamientos |
+ * | datos    | cada archivo alineado a @ref VirtualFileSystem::kAlignment   |
+ * | tabla    | `Entry[entryCount]` ordenadas por hash de la ruta            |
+ * | nombres  | rutas normalizadas sin terminador (para descartar colisiones) |
+ *
+ * La tabla va detrás de los datos: así el paquete se escribe en una pasada, sabiendo ya
+ * lo que ocupa cada entrada comprimida. Las rutas se normalizan
+ * (@ref VirtualFileSystem::normalizePath) y se buscan por su FNV-1a de 64 bits con
+ * búsqueda binaria; el nombre guardado confirma el acierto.
+ *
+ * **Compresión por entrada** (@ref PackCompression): una entrada comprimida se divide en
+ * bloques de @ref VirtualFileSystem::kBlockSize que se comprimen por separado con
+ * @ref Lz4Codec. Sus datos empiezan por el tamaño comprimido de cada bloque (`uint32`;
+ * igual al original si ese bloque no se comprimía y va tal cual) seguido de los bloques.
+ * Al abrirla, los bloques se descomprimen en paralelo en el `JobSystem` directamente
+ * sobre el búfer de la @ref FileView. El disco es lo lento en frío (máquinas con HDD):
+ * leer la mitad de bytes compensa de sobra copiar memoria al descomprimir.
+ *
+ * **Archivos sueltos**: siguen funcionando. Con @ref VirtualFileSystem::setLooseOverride
+ * (activo en Debug) un archivo suelto tapa al del paquete, así se edita un recurso sin
+ * volver a empaquetar; sin él se mira antes el paquete y lo suelto es el último recurso.
+ *
+ * Los lectores reciben una @ref FileView con `getData`/`getSize`, la misma interfaz
+ * que @ref MappedFile: C++14 no tiene `std::span`, y así el cambio en cada lector es
+ * solo el tipo del objeto.
+ *
+ * @note Para estudiantes: montar y desmontar se hace al arrancar y al cerrar, sin
+ * cargas en marcha; entre medias la tabla es de solo lectura y los hilos de carga
+ * (@ref AsyncTextureLoader) la consultan sin bloqueos. Desde esos hilos (que no son del
+ * `JobSystem`) los bloques se descomprimen en serie; el paralelismo ya lo dan sus workers.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "MappedFile.h"
+#include <cstdint>
+#include <memory>
+
+/**
+ * @enum PackCompression
+ * @brief Cómo se guarda una entrada en el paquete.
+ */
+enum PackCompression {
+    PACK_COMPRESSION_NONE = 0, ///< Tal cual: la vista apunta al mapeo, sin copia.
+    PACK_COMPRESSION_FAST = 1, ///< LZ4 rápido: recursos que se leen al arrancar.
+    PACK_COMPRESSION_HIGH = 2  ///< LZ4 con cadenas de hash: más lento de escribir, igual de leer.
+};
+
+/**
+ * @class FileView
+ * @brief Contenido de un archivo abierto por el @ref VirtualFileSystem.
+ *
+ * @details
+ * Si viene de un paquete sin comprimir, la vista apunta dentro de su mapeo y vale
+ * mientras el paquete siga montado; si está comprimida, apunta a un búfer propio con lo
+ * descomprimido; si es suelto, es un @ref MappedFile propio. Los dos últimos se liberan
+ * con el objeto.
+ */
+class FileView {
+public:
+    FileView() = default;
+    FileView(const FileView&) = delete;
+    FileView& operator=(const FileView&) = delete;
+
+    /** @brief Suelta la vista (el paquete sigue mapeado). */
+    void close() {
+        m_loose.close();
+        std::vector<unsigned char>().swap(m_decoded);
+        m_data = nullptr;
+        m_size = 0;
+        m_packed = false;
+    }
+
+    const unsigned char* getData() const { return m_data; }
+    size_t getSize() const { return m_size; }
+
+    /** @brief El contenido está dentro de un paquete. */
+    bool isPacked() const { return m_packed; }
+
+private:
+    friend class VirtualFileSystem;
+
+    MappedFile m_loose;
+    std::vector<unsigned char> m_decoded;    ///< Entrada comprimida ya descomprimida.
+    const unsigned char* m_data = nullptr;
+    size_t m_size = 0;
+    bool m_packed = false;
+};
+
+/**
+ * @class VirtualFileSystem
+ * @brief Resuelve rutas contra los paquetes montados y el disco.
+ */
+class VirtualFileSystem {
+public:
+    VirtualFileSystem() = default;
+    VirtualFileSystem(const VirtualFileSystem&) = delete;
+    VirtualFileSystem& operator=(const VirtualFileSystem&) = delete;
+
+    /// Cambia cuando cambia la disposición del paquete.
+    static const unsigned int kFormatVersion = 2;
+    /// Alineación del contenido de cada entrada (línea de caché; cubre los 16 de `.smesh`).
+    static const unsigned int kAlignment = 64;
+    /// Bytes sin comprimir por bloque (el último puede ser menor).
+    static const unsigned int kBlockSize = 256 * 1024;
+    /// Paquete que el motor monta al arrancar si existe.
+    static const char* const kDefaultPack;
+
+    /** @brief Instancia que usan los cargadores del motor. */
+    static VirtualFileSystem& getDefault();
+
+    /**
+     * @brief Forma canónica de una ruta: minúsculas, `\\` como separador, sin `.` ni
+     * `..` resolubles. Es la que se guarda en los paquetes.
+     */
+    static std::string normalizePath(const std::string& path);
+
+    /**
+     * @brief Mapea un paquete y añade sus entradas.
+     * @details Los paquetes montados después tienen prioridad (parches).
+     * @return `E_FAIL` si no se puede abrir, `E_INVALIDARG` si no es un `.spak` válido.
+     */
+    HRESULT mount(const std::string& packPath);
+
+    /** @brief Desmonta todos los paquetes (las @ref FileView empaquetadas dejan de valer). */
+    void unmountAll();
+
+    /**
+     * @brief Abre un archivo.
+     * @return `false` si no existe, está vacío o no se puede mapear (como @ref MappedFile::open).
+     */
+    bool open(const std::string& path, FileView& view) const;
+
+    /** @brief El archivo existe, suelto o empaquetado. */
+    bool exists(const std::string& path) const;
+
+    /** @brief El archivo está en algún paquete montado. */
+    bool isPacked(const std::string& path) const;
+
+    /** @brief Los archivos sueltos tienen prioridad sobre los paquetes. */
+    void setLooseOverride(bool enabled) { m_looseOverride = enabled; }
+    bool getLooseOverride() const { return m_looseOverride; }
+
+    /** @brief Paquetes montados. */
+    unsigned int getPackCount() const { return static_cast<unsigned int>(m_packs.size()); }
+
+    /** @brief Entradas de todos los paquetes montados. */
+    unsigned int getEntryCount() const;
+
+    /// Archivo a empaquetar.
+    struct PackFile {
+        std::string path;                                   ///< Relativa al directorio de trabajo.
+        PackCompression compression = PACK_COMPRESSION_NONE;
+    };
+
+    /**
+     * @brief Escribe un paquete con los archivos dados (se guardan con la ruta
+     * normalizada y los repetidos se escriben una vez).
+     * @details Una entrada que al comprimirla no ahorra al menos 1/16 se guarda sin
+     * comprimir: no compensa descomprimirla.
+     * @return `E_FAIL` si algún archivo no se puede leer o el paquete no se puede escribir;
+     * `E_INVALIDARG` si dos rutas distintas tienen el mismo hash.
+     */
+    static HRESULT writePack(const std::string& packPath, const std::vector<PackFile>& files);
+
+private:
+    /// Entrada de la tabla de un paquete.
+    struct Entry {
+        uint64_t pathHash;
+        uint64_t offset;      ///< Desde el principio del paquete.
+        uint64_t size;        ///< Sin comprimir.
+        uint64_t storedSize;  ///< En el paquete (tabla de bloques incluida).
+        uint32_t nameOffset;  ///< En la sección de nombres.
+        uint32_t nameLength;
+        uint32_t compression; ///< @ref PackCompression.
+        uint32_t blockCount;  ///< 0 si no está comprimida.
+    };
+
+    /// Paquete montado.
+    struct Pack {
+        std::string path;
+        MappedFile file;
+        const Entry* entries = nullptr;
+        uint32_t entryCount = 0;
+        const char* names = nullptr;
+        uint32_t blockSize = 0;
+    };
+
+    /// FNV-1a de 64 bits de una ruta ya normalizada.
+    static uint64_t hashPath(const std::string& normalized);
+
+    /// Entrada de `normalized` en el paquete de más prioridad que la tenga, o nulo.
+    const Entry* find(const std::string& normalized, const Pack** pack) const;
+
+    /// Descomprime los bloques de una entrada en el búfer de `view`.
+    static bool decode(const Pack& pack, const Entry& entry, FileView& view);
+
+#ifdef _DEBUG
+    bool m_looseOverride = true;
+#else
+    bool m_looseOverride = false;
+#endif
+    std::vector<std::unique_ptr<Pack>> m_packs; ///< En orden de montaje.
+};
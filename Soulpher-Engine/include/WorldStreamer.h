@@ -0,0 +1,164 @@
+﻿/**
+ * @file WorldStreamer.h
+ * @brief Streaming del mundo por celdas de rejilla alrededor de la cámara.
+ *
+ * @details
+ * Un nivel grande no cabe entero en memoria ni se carga en un tiempo razonable. Con
+ * @ref WorldStreamer::split se parte una escena (`.sscene`) en **celdas** cuadradas del
+ * plano XZ, cada una en su propio `.sscene` (`cell_<x>_<z>.sscene`, con solo las
+ * cadenas y materiales que usa), más un `level.sstream` con el lado de celda. Un actor
+ * va a la celda de su raíz: una jerarquía nunca queda partida.
+ *
+ * Cada frame, @ref WorldStreamer::update mira el punto de enfoque (objetivo de la órbita de la cámara):
+ *
+ * - **Carga** las celdas que existen a menos de `loadRadius` (distancia al rectángulo
+ *   de la celda, no a su centro). Leer el archivo va a un hilo de carga del
+ *   `ResourceManager`; crear los actores (`SceneFile::instantiate`), al hilo principal.
+ *   Como mucho `maxInFlight` lecturas a la vez y siempre la más cercana primero: esa es
+ *   la prioridad. Las mallas y texturas de la celda se piden al instanciarla y llegan
+ *   como cualquier otro futuro.
+ * - **Descarga** las que quedan a más de `unloadRadius`. Entre los dos radios
+ *   (histéresis) una celda se queda como está: ir y volver por el borde no la recarga
+ *   cada frame.
+ * - **Presupuesto** (`budgetBytes`): si las celdas residentes lo pasan, se descargan las
+ *   más lejanas (nunca la más cercana) y no se empieza otra carga hasta que quepa una
+ *   celda media.
+ *
+ * Solo hay residentes las celdas cercanas: memoria y tiempo de carga dependen del radio,
+ * no del tamaño del nivel. Las mallas y texturas son compartidas y las liberan sus
+ * bibliotecas cuando la última celda que las usaba se descarga.
+ *
+ * @note Para estudiantes: el coste en memoria de una celda se estima (actores y sus
+ * datos), no se mide; sirve para comparar celdas entre sí, no para contar la VRAM.
+ */
+
+#pragma once
+#include "Prerequisites.h"
+#include "SceneFile.h"
+#include <unordered_map>
+
+/**
+ * @class WorldStreamer
+ * @brief Carga y descarga celdas de un nivel según la distancia al punto de enfoque.
+ */
+class WorldStreamer {
+public:
+    WorldStreamer() = default;
+    ~WorldStreamer() = default;
+    WorldStreamer(const WorldStreamer&) = delete;
+    WorldStreamer& operator=(const WorldStreamer&) = delete;
+
+    /// Lado de celda por defecto de @ref split (unidades de mundo).
+    static constexpr float kDefaultCellSize = 32.0f;
+
+    /// Radios, lecturas simultáneas y presupuesto.
+    struct Settings {
+        float loadRadius = 0.0f;     ///< 0 = 1,5 lados de celda.
+        float unloadRadius = 0.0f;   ///< 0 = `loadRadius` + medio lado (nunca menos que `loadRadius`).
+        unsigned int maxInFlight = 2; ///< Celdas leyéndose a la vez.
+        size_t budgetBytes = 0;      ///< Memoria estimada de las celdas residentes (0 = sin límite).
+    };
+
+    /// Estado de una celda.
+    enum CellState {
+        CELL_MISSING = 0,  ///< No hay archivo (se comprobó una vez).
+        CELL_UNLOADED = 1,
+        CELL_LOADING = 2,  ///< Leyéndose en un hilo de carga.
+        CELL_RESIDENT = 3
+    };
+
+    /**
+     * @brief Abre un nivel partido con @ref split.
+     * @param device Dispositivo de los prefabs de cada celda.
+     * @param resources Hilos de lectura y cargas de texturas y materiales.
+     * @param meshes Resuelve los nombres de malla de las celdas.
+     * @param components Componentes de datos que se restauran.
+     * @param directory Carpeta del nivel (con `level.sstream`).
+     * @param settings Radios y presupuesto.
+     * @return `S_OK`, `HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND)` sin `level.sstream` o
+     * `E_FAIL` si no se puede leer.
+     */
+    HRESULT init(Device& device, ResourceManager& resources, const SceneFile::MeshResolver& meshes,
+        const std::vector<SceneComponent>& components, const std::string& directory, const Settings& settings);
+
+    /**
+     * @brief Descarga y encola celdas según `focus` e instancia las que terminaron de leerse.
+     * @param focus Punto de enfoque de la cámara.
+     * @param actors Actores de la escena: se añaden los de las celdas cargadas y se quitan
+     * los de las descargadas.
+     * @note Hilo principal, una vez por frame.
+     */
+    void update(const XMFLOAT3& focus, std::vector<ActorHandle>& actors);
+
+    /** @brief Descarga todas las celdas y quita sus actores de `actors` (al cerrar). */
+    void destroy(std::vector<ActorHandle>& actors);
+
+    /** @brief Hay un nivel abierto. */
+    bool isActive() const { return m_resources != nullptr; }
+
+    /** @brief Celdas residentes. */
+    unsigned int getResidentCount() const { return m_residentCount; }
+
+    /** @brief Celdas leyéndose. */
+    unsigned int getLoadingCount() const { return m_loadingCount; }
+
+    /** @brief Memoria estimada de las celdas residentes. */
+    size_t getResidentBytes() const { return m_residentBytes; }
+
+    /** @brief Lado de celda del nivel abierto. */
+    float getCellSize() const { return m_cellSize; }
+
+    /**
+     * @brief Parte una escena en celdas y escribe el nivel.
+     * @param scene Escena completa.
+     * @param cellSize Lado de celda.
+     * @param directory Carpeta de salida (se crea si no existe).
+     * @return `S_OK` o el primer error de escritura.
+     */
+    static HRESULT split(const SceneData& scene, float cellSize, const std::string& directory);
+
+private:
+    /// Celda conocida (comprobada o residente).
+    struct Cell {
+        int x = 0;
+        int z = 0;
+        CellState state = CELL_UNLOADED;
+        bool cancelled = false;   ///< Se alejó mientras se leía: se descarta al terminar.
+        size_t bytes = 0;         ///< Estimación con la celda residente.
+        std::vector<ActorHandle> actors;
+        std::vector<std::unique_ptr<Prefab>> prefabs; ///< Viven más que los actores de la celda.
+    };
+
+    /// Clave de `m_cells` a partir de las coordenadas de celda.
+    static int64_t makeKey(int x, int z) { return (static_cast<int64_t>(x) << 32) | static_cast<uint32_t>(z); }
+
+    /// Ruta del archivo de la celda.
+    std::string getCellPath(int x, int z) const;
+
+    /// Distancia en XZ de `focus` al rectángulo de la celda.
+    float getDistance(const Cell& cell, const XMFLOAT3& focus) const;
+
+    /// Lanza la lectura de la celda en un hilo de carga.
+    void load(Cell& cell);
+
+    /// Crea los actores de una celda leída.
+    void instantiate(Cell& cell, const SceneData& scene, std::vector<ActorHandle>& actors);
+
+    /// Destruye los actores de la celda y los quita de `actors`.
+    void unload(Cell& cell, std::vector<ActorHandle>& actors);
+
+    Device* m_device = nullptr;
+    ResourceManager* m_resources = nullptr;
+    SceneFile::MeshResolver m_meshes;
+    std::vector<SceneComponent> m_components;
+    std::string m_directory;
+    Settings m_settings;
+    float m_cellSize = kDefaultCellSize;
+
+    std::unordered_map<int64_t, Cell> m_cells;
+    /// Celdas leídas a la espera de `update` (las rellena `load` al publicar).
+    std::vector<std::pair<int64_t, std::shared_ptr<SceneData>>> m_loaded;
+    unsigned int m_residentCount = 0;
+    unsigned int m_loadingCount = 0;
+    size_t m_residentBytes = 0;
+};
@@ -0,0 +1,133 @@
+﻿/**
+ * @file ActorCost.cpp
+ * @brief Contadores por actor, su publicación por frame y el tiempo de GPU del medido.
+ */
+
+#include "ActorCost.h"
+#include "GpuProfiler.h"
+#include "Texture.h"
+#include "ECS/Actor.h"
+
+const char* const ActorCost::kGpuScope = "Profiled actor";
+const char* const ActorCost::kShadowGpuScope = "Profiled actor (shadow)";
+
+/**
+ * @details Los resultados del perfilador llegan `GpuProfiler::kFrameLatency` frames tarde:
+ * al cambiar de actor se ignoran esos frames, que aún son del anterior (o de ninguno).
+ */
+void ActorCost::beginFrame(GpuProfiler& profiler) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_write ^= 1u;
+        m_counters[m_write].Clear();
+    }
+    m_serial.fetch_add(1, std::memory_order_relaxed);
+
+    const Actor* requested = m_requestedActor.load(std::memory_order_relaxed);
+    const unsigned long long resultSerial = profiler.getResultSerial();
+    if (requested != m_timedActor) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_timedActor = requested;
+        m_settleFrames = GpuProfiler::kFrameLatency;
+        m_gpuMs = -1.0f;
+        m_shadowGpuMs = -1.0f;
+    }
+    else if (requested && resultSerial != m_lastResultSerial) {
+        if (m_settleFrames > 0) {
+            --m_settleFrames;
+        }
+        else {
+            float gpuMs = 0.0f;
+            float shadowGpuMs = 0.0f;
+            for (const GpuProfiler::Result& result : profiler.getResults()) {
+                if (result.name == kGpuScope) {
+                    gpuMs += result.ms;
+                }
+                else if (result.name == kShadowGpuScope) {
+                    shadowGpuMs += result.ms;
+                }
+            }
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_gpuMs = gpuMs;
+            m_shadowGpuMs = shadowGpuMs;
+        }
+    }
+    m_lastResultSerial = resultSerial;
+    m_profiler = profiler.isEnabled() ? &profiler : nullptr;
+    m_frameActor = m_profiler ? requested : nullptr;
+}
+
+void ActorCost::record(const void* owner, unsigned int indexCount, bool shadow) {
+    if (!owner) {
+        return;
+    }
+    Counters& counters = m_counters[m_write][owner];
+    if (shadow) {
+        ++counters.shadowDraws;
+        counters.shadowTriangles += indexCount / 3;
+    }
+    else {
+        ++counters.draws;
+        counters.triangles += indexCount / 3;
+    }
+}
+
+unsigned int ActorCost::beginGpuScope(DeviceContext& deviceContext, bool shadow) {
+    return m_profiler ? m_profiler->beginScope(deviceContext, shadow ? kShadowGpuScope : kGpuScope)
+        : GpuProfiler::kMaxScopes;
+}
+
+void ActorCost::endGpuScope(DeviceContext& deviceContext, unsigned int index) {
+    if (m_profiler) {
+        m_profiler->endScope(deviceContext, index);
+    }
+}
+
+ActorCost::Cost ActorCost::getCost(const Actor& actor) {
+    Cost cost;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (const Counters* counters = m_counters[m_write ^ 1u].Find(static_cast<const void*>(&actor))) {
+            cost.draws = counters->draws;
+            cost.triangles = counters->triangles;
+            cost.shadowDraws = counters->shadowDraws;
+            cost.shadowTriangles = counters->shadowTriangles;
+        }
+        if (&actor == m_timedActor) {
+            cost.gpuMs = m_gpuMs;
+            cost.shadowGpuMs = m_shadowGpuMs;
+        }
+    }
+    for (const TextureHandle& texture : actor.getTextures()) {
+        if (texture.isNull()) {
+            continue;
+        }
+        size_t bytes = texture->m_residentBytes;
+        if (bytes == 0 && texture->m_texture) {
+            // Sin residencia (texturas creadas en código): RGBA8 con su cadena de mips.
+            D3D11_TEXTURE2D_DESC desc;
+            texture->m_texture->GetDesc(&desc);
+            bytes = static_cast<size_t>(desc.Width) * desc.Height * 4 * desc.ArraySize;
+            if (desc.MipLevels != 1) {
+                bytes += bytes / 3;
+            }
+        }
+        cost.textureBytes += bytes;
+    }
+    return cost;
+}
+
+double ActorCost::sortValue(const Cost& cost, SortKey key) {
+    switch (key) {
+    case SORT_TRIANGLES:
+        return static_cast<double>(cost.triangles);
+    case SORT_DRAWS:
+        return static_cast<double>(cost.draws);
+    case SORT_SHADOW:
+        return static_cast<double>(cost.shadowTriangles);
+    case SORT_TEXTURE_MEMORY:
+        return static_cast<double>(cost.textureBytes);
+    default:
+        return 0.0;
+    }
+}
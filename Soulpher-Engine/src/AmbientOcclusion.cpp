@@ -0,0 +1,164 @@
+﻿/**
+ * @file AmbientOcclusion.cpp
+ * @brief Implementación de la SSAO a media resolución con acumulación temporal.
+ */
+
+#include "AmbientOcclusion.h"
+#include "Device.h"
+#include "DeviceContext.h"
+#include "ShaderLibrary.h"
+
+namespace {
+    unsigned int halfSize(unsigned int size) {
+        return (size + 1) / 2;
+    }
+
+    unsigned int groups(unsigned int size) {
+        return (size + AmbientOcclusion::kTileSize - 1) / AmbientOcclusion::kTileSize;
+    }
+}
+
+const ConstantBufferLayouts::Registration AmbientOcclusion::kParamsLayout({ "cbOcclusion", CB_SLOT_OCCLUSION, sizeof(OcclusionParams), {
+    CB_FIELD(OcclusionParams, reprojection, "OcclusionReprojection"),
+    CB_FIELD(OcclusionParams, size, "OcclusionSize"),
+    CB_FIELD(OcclusionParams, projection, "OcclusionProjection"),
+    CB_FIELD(OcclusionParams, params, "OcclusionParams"),
+    CB_FIELD(OcclusionParams, temporal, "OcclusionTemporal") } });
+
+HRESULT AmbientOcclusion::init(Device& device, unsigned int width, unsigned int height) {
+    if (!device.m_device) {
+        ERROR("AmbientOcclusion", "init", "Device is null.");
+        return E_POINTER;
+    }
+    destroy();
+
+    // UAV de texturas en compute: nivel 11_0.
+    if (device.m_device->GetFeatureLevel() < D3D_FEATURE_LEVEL_11_0) {
+        MESSAGE("AmbientOcclusion", "init", "Feature level < 11_0: SSAO disabled.");
+        return DXGI_ERROR_UNSUPPORTED;
+    }
+    m_width = width;
+    m_height = height;
+
+    D3D11_BUFFER_DESC paramsDesc = {};
+    paramsDesc.Usage = D3D11_USAGE_DEFAULT;
+    paramsDesc.ByteWidth = sizeof(OcclusionParams);
+    paramsDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+    HRESULT hr = device.CreateBuffer(&paramsDesc, nullptr, &m_params);
+
+    D3D11_TEXTURE2D_DESC historyDesc = {};
+    historyDesc.Width = halfSize(width);
+    historyDesc.Height = halfSize(height);
+    historyDesc.MipLevels = 1;
+    historyDesc.ArraySize = 1;
+    historyDesc.Format = DXGI_FORMAT_R16G16_FLOAT;
+    historyDesc.SampleDesc.Count = 1;
+    historyDesc.Usage = D3D11_USAGE_DEFAULT;
+    historyDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_UNORDERED_ACCESS;
+    for (unsigned int i = 0; i < 2 && SUCCEEDED(hr); ++i) {
+        hr = device.CreateTexture2D(&historyDesc, nullptr, &m_history[i]);
+        if (SUCCEEDED(hr)) { hr = device.CreateShaderResourceView(m_history[i], nullptr, &m_historySRV[i]); }
+        if (SUCCEEDED(hr)) { hr = device.CreateUnorderedAccessView(m_history[i], nullptr, &m_historyUAV[i]); }
+    }
+    if (FAILED(hr)) {
+        ERROR("AmbientOcclusion", "init", ("Failed to create the SSAO history. hr=" + std::to_string(hr)).c_str());
+        destroy();
+        return hr;
+    }
+
+    ShaderLibrary& library = device.getShaderLibrary();
+    ShaderKey key;
+    key.fileName = "AmbientOcclusion.fx";
+    key.profile = "cs_5_0";
+    key.entryPoint = "CSOcclusion";
+    hr = library.getComputeShader(device, key, &m_occlusionShader);
+    if (SUCCEEDED(hr)) {
+        key.entryPoint = "CSTemporal";
+        hr = library.getComputeShader(device, key, &m_temporalShader);
+    }
+    if (FAILED(hr)) {
+        destroy();
+        return hr;
+    }
+    return S_OK;
+}
+
+RenderTargetPool::Desc AmbientOcclusion::rawDesc(unsigned int width, unsigned int height) {
+    RenderTargetPool::Desc desc;
+    desc.width = halfSize(width);
+    desc.height = halfSize(height);
+    desc.format = DXGI_FORMAT_R16G16_FLOAT;
+    desc.bindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_UNORDERED_ACCESS;
+    return desc;
+}
+
+void AmbientOcclusion::render(DeviceContext& deviceContext, ID3D11ShaderResourceView* depthSRV,
+    const RenderTargetPool::Target& raw, unsigned int depthWidth, unsigned int depthHeight,
+    const XMMATRIX& view, const XMMATRIX& projection, float nearZ, float farZ) {
+    if (!isReady() || !depthSRV || !raw.srv || !raw.uav || depthWidth > m_width || depthHeight > m_height) {
+        return;
+    }
+    // Con otro tamaño los texels de la historia ya no corresponden a los de ahora.
+    if (depthWidth != m_lastWidth || depthHeight != m_lastHeight) {
+        m_hasHistory = false;
+        m_lastWidth = depthWidth;
+        m_lastHeight = depthHeight;
+    }
+    const unsigned int width = halfSize(depthWidth);
+    const unsigned int height = halfSize(depthHeight);
+    const unsigned int previous = m_current;
+    const unsigned int next = 1 - m_current;
+
+    // Vista actual -> mundo -> clip del frame anterior.
+    const XMMATRIX viewProj = XMMatrixMultiply(view, projection);
+    const XMMATRIX reprojection = XMMatrixMultiply(XMMatrixInverse(nullptr, view), m_previousViewProj);
+    OcclusionParams params;
+    params.reprojection = XMMatrixTranspose(reprojection);
+    params.size = XMFLOAT4(static_cast<float>(width), static_cast<float>(height),
+        static_cast<float>(depthWidth), static_cast<float>(depthHeight));
+    params.projection = XMFLOAT4(XMVectorGetX(projection.r[0]), XMVectorGetY(projection.r[1]), nearZ, farZ);
+    params.params = XMFLOAT4(m_settings.radius, m_settings.intensity, m_settings.bias, static_cast<float>(m_frame % 64));
+    params.temporal = XMFLOAT4(m_settings.temporalWeight, m_hasHistory ? 1.0f : 0.0f, m_settings.depthTolerance, 0.0f);
+    deviceContext.UpdateSubresource(m_params, 0, nullptr, &params, 0, 0);
+
+    // La profundidad sigue enlazada como DSV del pase "Scene".
+    deviceContext.OMSetRenderTargets(0, nullptr, nullptr);
+    deviceContext.CSSetConstantBuffers(CB_SLOT_OCCLUSION, 1, &m_params);
+
+    ID3D11ShaderResourceView* nullSRVs[3] = { nullptr, nullptr, nullptr };
+    ID3D11UnorderedAccessView* nullUAV = nullptr;
+    ID3D11UnorderedAccessView* rawUAV = raw.uav;
+    deviceContext.CSSetShader(m_occlusionShader, nullptr, 0);
+    deviceContext.CSSetShaderResources(0, 1, &depthSRV);
+    deviceContext.CSSetUnorderedAccessViews(0, 1, &rawUAV, nullptr);
+    deviceContext.Dispatch(groups(width), groups(height), 1);
+    deviceContext.CSSetUnorderedAccessViews(0, 1, &nullUAV, nullptr);
+
+    ID3D11ShaderResourceView* sources[3] = { depthSRV, raw.srv, m_historySRV[previous] };
+    deviceContext.CSSetShader(m_temporalShader, nullptr, 0);
+    deviceContext.CSSetShaderResources(0, 3, sources);
+    deviceContext.CSSetUnorderedAccessViews(0, 1, &m_historyUAV[next], nullptr);
+    deviceContext.Dispatch(groups(width), groups(height), 1);
+
+    deviceContext.CSSetShaderResources(0, 3, nullSRVs);
+    deviceContext.CSSetUnorderedAccessViews(0, 1, &nullUAV, nullptr);
+    deviceContext.CSSetShader(nullptr, nullptr, 0);
+
+    m_current = next;
+    m_hasHistory = true;
+    m_previousViewProj = viewProj;
+    ++m_frame;
+}
+
+void AmbientOcclusion::destroy() {
+    SAFE_RELEASE(m_occlusionShader);
+    SAFE_RELEASE(m_temporalShader);
+    SAFE_RELEASE(m_params);
+    for (unsigned int i = 0; i < 2; ++i) {
+        SAFE_RELEASE(m_historyUAV[i]);
+        SAFE_RELEASE(m_historySRV[i]);
+        SAFE_RELEASE(m_history[i]);
+    }
+    m_current = 0;
+    m_hasHistory = false;
+}
@@ -0,0 +1,498 @@
+﻿/**
+ * @file Animation.cpp
+ * @brief Compresión y muestreo de clips, y el archivo `.sanim`.
+ *
+ * @details
+ * La reducción de keyframes es voraz: desde la última clave guardada se alarga el
+ * tramo mientras todos los fotogramas intermedios queden dentro de la tolerancia al
+ * interpolar entre sus extremos (nlerp para las rotaciones, como al reproducir). Se
+ * trabaja con los valores sin cuantizar; la cuantización añade su propio error, por
+ * debajo de 1e-4 rad en rotación y de `extent / 65535` en traslación y escala.
+ */
+
+#include "Animation.h"
+#include "VirtualFileSystem.h"
+#include <cmath>
+#include <cstring>
+
+namespace {
+    /// Tramo máximo entre dos claves: acota el coste de la reducción (cuadrático en el tramo).
+    const unsigned int kMaxKeyGap = 128;
+
+    /// Las tres componentes menores de un cuaternión unitario están en [-1/sqrt(2), 1/sqrt(2)].
+    const float kSmallestThreeRange = 0.707106781f;
+
+    uint16_t quantize(float value, float minimum, float extent, unsigned int maxValue) {
+        if (extent <= 0.0f) {
+            return 0;
+        }
+        const float normalized = (value - minimum) / extent * maxValue + 0.5f;
+        return static_cast<uint16_t>((std::max)(0.0f, (std::min)(normalized, static_cast<float>(maxValue))));
+    }
+
+    float dequantize(unsigned int value, float minimum, float extent, unsigned int maxValue) {
+        return minimum + extent * (static_cast<float>(value) / maxValue);
+    }
+
+    /**
+     * "Smallest three": se guarda el índice de la mayor componente (2 bits) y las otras
+     * tres con el signo que la hace positiva (15, 15 y 16 bits).
+     */
+    void packRotation(const EU::Quaternion& rotation, uint16_t value[3]) {
+        const EU::Quaternion q = EU::QuaternionScalar::Normalize(rotation);
+        const float c[4] = { q.w, q.x, q.y, q.z };
+        unsigned int largest = 0;
+        for (unsigned int i = 1; i < 4; ++i) {
+            if (std::fabs(c[i]) > std::fabs(c[largest])) {
+                largest = i;
+            }
+        }
+        const float sign = c[largest] < 0.0f ? -1.0f : 1.0f;
+        float rest[3];
+        for (unsigned int i = 0, k = 0; i < 4; ++i) {
+            if (i != largest) {
+                rest[k++] = c[i] * sign;
+            }
+        }
+        const float range = 2.0f * kSmallestThreeRange;
+        value[0] = static_cast<uint16_t>(quantize(rest[0], -kSmallestThreeRange, range, 0x7FFF) << 1 | (largest & 1));
+        value[1] = static_cast<uint16_t>(quantize(rest[1], -kSmallestThreeRange, range, 0x7FFF) << 1 | (largest >> 1));
+        value[2] = quantize(rest[2], -kSmallestThreeRange, range, 0xFFFF);
+    }
+
+    EU::Quaternion unpackRotation(const uint16_t value[3]) {
+        const float range = 2.0f * kSmallestThreeRange;
+        const unsigned int largest = (value[0] & 1) | (value[1] & 1) << 1;
+        const float rest[3] = {
+            dequantize(value[0] >> 1, -kSmallestThreeRange, range, 0x7FFF),
+            dequantize(value[1] >> 1, -kSmallestThreeRange, range, 0x7FFF),
+            dequantize(value[2], -kSmallestThreeRange, range, 0xFFFF) };
+        float c[4];
+        for (unsigned int i = 0, k = 0; i < 4; ++i) {
+            c[i] = i == largest ? 0.0f : rest[k++];
+        }
+        c[largest] = std::sqrt((std::max)(0.0f, 1.0f - rest[0] * rest[0] - rest[1] * rest[1] - rest[2] * rest[2]));
+        return EU::Quaternion(c[0], c[1], c[2], c[3]);
+    }
+
+    EU::Vector3 unpackVector(const AnimationClip::Track& track, const uint16_t value[3]) {
+        return EU::Vector3(
+            dequantize(value[0], track.minimum[0], track.extent[0], 0xFFFF),
+            dequantize(value[1], track.minimum[1], track.extent[1], 0xFFFF),
+            dequantize(value[2], track.minimum[2], track.extent[2], 0xFFFF));
+    }
+
+    EU::Vector3 lerp(const EU::Vector3& a, const EU::Vector3& b, float t) {
+        return EU::Vector3(a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, a.z + (b.z - a.z) * t);
+    }
+
+    /**
+     * @brief Fotogramas que se conservan de una pista.
+     * @param fits `fits(a, b, f)`: el fotograma `f` queda dentro de la tolerancia al
+     * interpolar entre `a` y `b`.
+     */
+    template<typename Fits>
+    void reduceTrack(unsigned int frameCount, const Fits& fits, std::vector<uint16_t>& keep) {
+        keep.assign(1, 0);
+        bool constant = true;
+        for (unsigned int f = 1; f < frameCount && constant; ++f) {
+            constant = fits(0, 0, f);
+        }
+        if (constant) {
+            return;
+        }
+
+        unsigned int start = 0;
+        while (start + 1 < frameCount) {
+            unsigned int end = start + 1;
+            while (end + 1 < frameCount && end + 1 - start <= kMaxKeyGap) {
+                bool ok = true;
+                for (unsigned int f = start + 1; f <= end && ok; ++f) {
+                    ok = fits(start, end + 1, f);
+                }
+                if (!ok) {
+                    break;
+                }
+                ++end;
+            }
+            keep.push_back(static_cast<uint16_t>(end));
+            start = end;
+        }
+    }
+
+    /**
+     * @brief Avanza el cursor de una pista hasta la clave de `frame` o la anterior.
+     * @return Peso de la siguiente clave (0 si no hay siguiente).
+     */
+    float seek(const AnimationClip::Key* keys, unsigned int keyCount, float frame, uint16_t& cursor) {
+        unsigned int k = cursor < keyCount && keys[cursor].frame <= frame ? cursor : 0;
+        while (k + 1 < keyCount && keys[k + 1].frame <= frame) {
+            ++k;
+        }
+        cursor = static_cast<uint16_t>(k);
+        if (k + 1 >= keyCount) {
+            return 0.0f;
+        }
+        const float a = keys[k].frame;
+        return (frame - a) / (keys[k + 1].frame - a);
+    }
+}
+
+// ============================================================================
+//  Skeleton
+// ============================================================================
+
+int Skeleton::find(const std::string& name) const {
+    for (size_t i = 0; i < names.size(); ++i) {
+        if (names[i] == name) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+void Skeleton::clear() {
+    names.clear();
+    parents.clear();
+    inverseBind.clear();
+    bindPose.clear();
+}
+
+// ============================================================================
+//  AnimationClip
+// ============================================================================
+
+AnimationClip AnimationClip::build(const std::string& name, float sampleRate, unsigned int jointCount,
+    const std::vector<JointPose>& frames, const BuildSettings& settings) {
+    AnimationClip clip;
+    const size_t frameCount = jointCount > 0 ? frames.size() / jointCount : 0;
+    if (frameCount == 0 || frameCount > kMaxFrames || sampleRate <= 0.0f) {
+        return clip;
+    }
+    clip.m_name = name;
+    clip.m_sampleRate = sampleRate;
+    clip.m_frameCount = static_cast<unsigned int>(frameCount);
+    clip.m_jointCount = jointCount;
+    clip.m_tracks.resize(jointCount * 3);
+
+    // Distancia máxima entre cuaterniones unitarios para un error angular dado:
+    // |q - r| = 2 sin(ángulo / 4). Con `acos` del producto escalar, en float, no se
+    // distinguen errores por debajo de ~1e-3 radianes.
+    const float maxChord = 2.0f * std::sin(settings.rotationTolerance * 0.25f);
+    std::vector<uint16_t> keep;
+    for (unsigned int joint = 0; joint < jointCount; ++joint) {
+        auto at = [&](unsigned int frame) -> const JointPose& { return frames[frame * jointCount + joint]; };
+
+        for (unsigned int channel = 0; channel < 3; ++channel) {
+            Track& track = clip.m_tracks[joint * 3 + channel];
+            track.firstKey = static_cast<uint32_t>(clip.m_keys.size());
+
+            if (channel == ROTATION) {
+                reduceTrack(clip.m_frameCount, [&](unsigned int a, unsigned int b, unsigned int f) {
+                    const float t = a == b ? 0.0f : static_cast<float>(f - a) / (b - a);
+                    const EU::Quaternion q = EU::QuaternionScalar::Nlerp(at(a).rotation, at(b).rotation, t);
+                    const EU::Quaternion r = EU::QuaternionScalar::Normalize(at(f).rotation);
+                    const float sign = q.w * r.w + q.x * r.x + q.y * r.y + q.z * r.z < 0.0f ? -1.0f : 1.0f;
+                    const float dw = q.w - sign * r.w, dx = q.x - sign * r.x;
+                    const float dy = q.y - sign * r.y, dz = q.z - sign * r.z;
+                    return dw * dw + dx * dx + dy * dy + dz * dz <= maxChord * maxChord;
+                }, keep);
+                for (size_t i = 0; i < 3; ++i) {
+                    track.minimum[i] = 0.0f;
+                    track.extent[i] = 0.0f;
+                }
+            }
+            else {
+                const bool translation = channel == TRANSLATION;
+                const float tolerance = translation ? settings.translationTolerance : settings.scaleTolerance;
+                auto value = [&](unsigned int frame) -> const EU::Vector3& {
+                    return translation ? at(frame).translation : at(frame).scale;
+                };
+                reduceTrack(clip.m_frameCount, [&](unsigned int a, unsigned int b, unsigned int f) {
+                    const float t = a == b ? 0.0f : static_cast<float>(f - a) / (b - a);
+                    const EU::Vector3 v = lerp(value(a), value(b), t);
+                    const EU::Vector3& r = value(f);
+                    return std::fabs(v.x - r.x) <= tolerance && std::fabs(v.y - r.y) <= tolerance &&
+                        std::fabs(v.z - r.z) <= tolerance;
+                }, keep);
+
+                // Rango de cuantización: el de las claves que quedan.
+                for (size_t i = 0; i < 3; ++i) {
+                    float low = value(keep[0]).data()[i];
+                    float high = low;
+                    for (uint16_t frame : keep) {
+                        low = (std::min)(low, value(frame).data()[i]);
+                        high = (std::max)(high, value(frame).data()[i]);
+                    }
+                    track.minimum[i] = low;
+                    track.extent[i] = high - low;
+                }
+            }
+
+            for (uint16_t frame : keep) {
+                Key key;
+                key.frame = frame;
+                if (channel == ROTATION) {
+                    packRotation(at(frame).rotation, key.value);
+                }
+                else {
+                    const float* v = (channel == TRANSLATION ? at(frame).translation : at(frame).scale).data();
+                    for (size_t i = 0; i < 3; ++i) {
+                        key.value[i] = quantize(v[i], track.minimum[i], track.extent[i], 0xFFFF);
+                    }
+                }
+                clip.m_keys.push_back(key);
+            }
+            track.keyCount = static_cast<uint32_t>(keep.size());
+        }
+    }
+    return clip;
+}
+
+void AnimationClip::sample(float time, uint16_t* cursors, EU::Quaternion* rotations, EU::Vector3* translations,
+    EU::Vector3* scales, EU::Quaternion* scratch, float* weights) const {
+    const float frame = (std::max)(0.0f, (std::min)(time * m_sampleRate, static_cast<float>(m_frameCount - 1)));
+    EU::Quaternion* from = scratch;
+    EU::Quaternion* to = scratch + m_jointCount;
+
+    for (unsigned int joint = 0; joint < m_jointCount; ++joint) {
+        const Track* tracks = &m_tracks[joint * 3];
+        uint16_t* cursor = &cursors[joint * 3];
+
+        // Rotación: se recogen los extremos y se interpolan después, todos a la vez.
+        const Key* keys = &m_keys[tracks[ROTATION].firstKey];
+        weights[joint] = seek(keys, tracks[ROTATION].keyCount, frame, cursor[ROTATION]);
+        from[joint] = unpackRotation(keys[cursor[ROTATION]].value);
+        to[joint] = weights[joint] > 0.0f ? unpackRotation(keys[cursor[ROTATION] + 1].value) : from[joint];
+
+        for (unsigned int channel = TRANSLATION; channel <= SCALE; ++channel) {
+            const Track& track = tracks[channel];
+            keys = &m_keys[track.firstKey];
+            const float t = seek(keys, track.keyCount, frame, cursor[channel]);
+            EU::Vector3 value = unpackVector(track, keys[cursor[channel]].value);
+            if (t > 0.0f) {
+                value = lerp(value, unpackVector(track, keys[cursor[channel] + 1].value), t);
+            }
+            (channel == TRANSLATION ? translations : scales)[joint] = value;
+        }
+    }
+    EU::NlerpQuaternions(from, to, weights, rotations, m_jointCount);
+}
+
+// ============================================================================
+//  AnimationCache (.sanim)
+// ============================================================================
+//
+//  Secuencial, sin alinear: cabecera, huesos, clips, pesos y blend shapes, cada array
+//  precedido de su número de elementos (uint32). Las cadenas son longitud + bytes.
+//  Un blend shape es su nombre, sus índices de vértice y sus deltas.
+
+namespace {
+    const uint32_t kMagic = 0x4D4E4153; // "SANM"
+
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t key;
+        uint32_t keySize;  ///< `sizeof(AnimationClip::Key)` al escribir.
+        uint32_t jointCount;
+        uint32_t clipCount;
+        uint32_t skinCount;
+        uint32_t morphCount;  ///< Mallas con su lista de blend shapes (0 o `skinCount`).
+    };
+
+    struct Writer {
+        FILE* file;
+        bool ok;
+
+        void bytes(const void* data, size_t size) {
+            ok = ok && (size == 0 || fwrite(data, 1, size, file) == size);
+        }
+        template<typename T>
+        void value(const T& v) { bytes(&v, sizeof(T)); }
+        template<typename T>
+        void array(const std::vector<T>& v) {
+            value(static_cast<uint32_t>(v.size()));
+            bytes(v.data(), v.size() * sizeof(T));
+        }
+        void string(const std::string& s) {
+            value(static_cast<uint32_t>(s.size()));
+            bytes(s.data(), s.size());
+        }
+    };
+
+    struct Reader {
+        const unsigned char* data;
+        size_t size;
+        size_t position;
+
+        bool bytes(void* out, size_t count) {
+            if (count > size - position) {
+                return false;
+            }
+            if (count == 0) {
+                return true; // `out` puede ser el data() de un vector vacío
+            }
+            std::memcpy(out, data + position, count);
+            position += count;
+            return true;
+        }
+        template<typename T>
+        bool value(T& v) { return bytes(&v, sizeof(T)); }
+        template<typename T>
+        bool array(std::vector<T>& v) {
+            uint32_t count = 0;
+            if (!value(count) || count > (size - position) / sizeof(T)) {
+                return false;
+            }
+            v.resize(count);
+            return bytes(v.data(), count * sizeof(T));
+        }
+        bool string(std::string& s) {
+            uint32_t count = 0;
+            if (!value(count) || count > size - position) {
+                return false;
+            }
+            s.assign(reinterpret_cast<const char*>(data + position), count);
+            position += count;
+            return true;
+        }
+    };
+}
+
+HRESULT AnimationCache::load(const std::string& path, unsigned long long key, Animations& animations) {
+    FileView file;
+    if (!VirtualFileSystem::getDefault().open(path, file)) {
+        return E_FAIL;
+    }
+    Reader reader = { file.getData(), file.getSize(), 0 };
+    Header header;
+    if (!reader.value(header) || header.magic != kMagic) {
+        return E_INVALIDARG;
+    }
+    if (header.version != kFormatVersion || header.keySize != sizeof(AnimationClip::Key) || header.key != key) {
+        return E_ABORT;
+    }
+
+    Animations loaded;
+    Skeleton& skeleton = loaded.skeleton;
+    skeleton.names.resize(header.jointCount);
+    for (std::string& name : skeleton.names) {
+        if (!reader.string(name)) {
+            return E_INVALIDARG;
+        }
+    }
+    if (!reader.array(skeleton.parents) || !reader.array(skeleton.inverseBind) || !reader.array(skeleton.bindPose) ||
+        skeleton.parents.size() != header.jointCount || skeleton.inverseBind.size() != header.jointCount ||
+        skeleton.bindPose.size() != header.jointCount) {
+        return E_INVALIDARG;
+    }
+    for (uint32_t i = 0; i < header.jointCount; ++i) {
+        if (skeleton.parents[i] >= static_cast<int>(i)) {
+            return E_INVALIDARG;
+        }
+    }
+
+    loaded.clips.resize(header.clipCount);
+    for (AnimationClip& clip : loaded.clips) {
+        if (!reader.string(clip.m_name) || !reader.value(clip.m_sampleRate) || !reader.value(clip.m_frameCount) ||
+            !reader.value(clip.m_jointCount) || !reader.array(clip.m_tracks) || !reader.array(clip.m_keys) ||
+            clip.m_jointCount != header.jointCount || clip.m_tracks.size() != clip.m_jointCount * 3 ||
+            clip.m_frameCount == 0 || clip.m_frameCount > AnimationClip::kMaxFrames) {
+            return E_INVALIDARG;
+        }
+        for (const AnimationClip::Track& track : clip.m_tracks) {
+            if (track.keyCount == 0 || uint64_t(track.firstKey) + track.keyCount > clip.m_keys.size()) {
+                return E_INVALIDARG;
+            }
+        }
+    }
+
+    loaded.skins.resize(header.skinCount);
+    for (std::vector<SkinVertex>& skin : loaded.skins) {
+        if (!reader.array(skin)) {
+            return E_INVALIDARG;
+        }
+        for (const SkinVertex& vertex : skin) {
+            for (unsigned char bone : vertex.Bones) {
+                if (bone >= header.jointCount) {
+                    return E_INVALIDARG;
+                }
+            }
+        }
+    }
+
+    loaded.morphs.resize(header.morphCount);
+    for (std::vector<MorphTarget>& targets : loaded.morphs) {
+        uint32_t count = 0;
+        if (!reader.value(count) || count > reader.size - reader.position) {
+            return E_INVALIDARG;
+        }
+        targets.resize(count);
+        for (MorphTarget& target : targets) {
+            if (!reader.string(target.name) || !reader.array(target.vertices) || !reader.array(target.deltas) ||
+                target.vertices.size() != target.deltas.size()) {
+                return E_INVALIDARG;
+            }
+        }
+    }
+
+    animations = std::move(loaded);
+    return S_OK;
+}
+
+HRESULT AnimationCache::write(const std::string& path, unsigned long long key, const Animations& animations) {
+    const std::string temp = path + ".tmp" + std::to_string(GetCurrentThreadId());
+    FILE* file = nullptr;
+    if (fopen_s(&file, temp.c_str(), "wb") != 0 || !file) {
+        ERROR("AnimationCache", "write", ("Cannot write " + temp).c_str());
+        return E_FAIL;
+    }
+
+    const Skeleton& skeleton = animations.skeleton;
+    Header header = {};
+    header.magic = kMagic;
+    header.version = kFormatVersion;
+    header.key = key;
+    header.keySize = sizeof(AnimationClip::Key);
+    header.jointCount = skeleton.getJointCount();
+    header.clipCount = static_cast<uint32_t>(animations.clips.size());
+    header.skinCount = static_cast<uint32_t>(animations.skins.size());
+    header.morphCount = static_cast<uint32_t>(animations.morphs.size());
+
+    Writer writer = { file, true };
+    writer.value(header);
+    for (const std::string& name : skeleton.names) {
+        writer.string(name);
+    }
+    writer.array(skeleton.parents);
+    writer.array(skeleton.inverseBind);
+    writer.array(skeleton.bindPose);
+    for (const AnimationClip& clip : animations.clips) {
+        writer.string(clip.m_name);
+        writer.value(clip.m_sampleRate);
+        writer.value(clip.m_frameCount);
+        writer.value(clip.m_jointCount);
+        writer.array(clip.m_tracks);
+        writer.array(clip.m_keys);
+    }
+    for (const std::vector<SkinVertex>& skin : animations.skins) {
+        writer.array(skin);
+    }
+    for (const std::vector<MorphTarget>& targets : animations.morphs) {
+        writer.value(static_cast<uint32_t>(targets.size()));
+        for (const MorphTarget& target : targets) {
+            writer.string(target.name);
+            writer.array(target.vertices);
+            writer.array(target.deltas);
+        }
+    }
+
+    const bool ok = fclose(file) == 0 && writer.ok;
+    if (!ok || !MoveFileExA(temp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+        ERROR("AnimationCache", "write", ("Cannot write " + path).c_str());
+        DeleteFileA(temp.c_str());
+        return E_FAIL;
+    }
+    return S_OK;
+}
@@ -0,0 +1,366 @@
+﻿/**
+ * @file AnimationSystem.cpp
+ * @brief Avance de las instancias y evaluación de paletas por lotes.
+ */
+
+#include "AnimationSystem.h"
+#include "JobSystem.h"
+#include "CpuProfiler.h"
+#include "MemoryTracker.h"
+#include <atomic>
+#include <cmath>
+
+namespace {
+    /**
+     * @brief `out = a * b` con matrices afines en forma de columna (fila implícita 0 0 0 1).
+     * @note `out` puede ser `b`: se leen sus filas antes de escribir.
+     */
+    void multiplyAffine(const EU::Matrix3x4& a, const EU::Matrix3x4& b, EU::Matrix3x4& out) {
+        const XMVECTOR b0 = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(b.m[0]));
+        const XMVECTOR b1 = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(b.m[1]));
+        const XMVECTOR b2 = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(b.m[2]));
+        XMVECTOR rows[3];
+        for (int r = 0; r < 3; ++r) {
+            XMVECTOR row = XMVectorMultiply(XMVectorReplicate(a.m[r][0]), b0);
+            row = XMVectorMultiplyAdd(XMVectorReplicate(a.m[r][1]), b1, row);
+            row = XMVectorMultiplyAdd(XMVectorReplicate(a.m[r][2]), b2, row);
+            rows[r] = XMVectorMultiplyAdd(XMVectorReplicate(a.m[r][3]), g_XMIdentityR3, row);
+        }
+        for (int r = 0; r < 3; ++r) {
+            XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(out.m[r]), rows[r]);
+        }
+    }
+}
+
+AnimationSystem::InstanceID AnimationSystem::create(const Skeleton* skeleton) {
+    if (!skeleton || skeleton->getJointCount() == 0 || skeleton->getJointCount() > Skeleton::kMaxJoints) {
+        ERROR("AnimationSystem", "create", "Skeleton is empty or has too many joints");
+        return kInvalidInstance;
+    }
+
+    InstanceID id;
+    if (!m_free.empty()) {
+        id = m_free.back();
+        m_free.pop_back();
+    }
+    else {
+        id = static_cast<InstanceID>(m_instances.size());
+        m_instances.push_back(Instance());
+    }
+    Instance& instance = m_instances[id];
+    instance.skeleton = skeleton;
+    instance.palette.resize(skeleton->getJointCount());
+    play(id, nullptr);
+    return id;
+}
+
+void AnimationSystem::destroy(InstanceID id) {
+    if (Instance* instance = find(id)) {
+        // Suelta paleta y cursores; la versión sigue subiendo si se reutiliza el hueco.
+        const unsigned int version = instance->version;
+        *instance = Instance();
+        instance->version = version;
+        m_free.push_back(id);
+    }
+}
+
+void AnimationSystem::clear() {
+    m_instances.clear();
+    m_free.clear();
+}
+
+bool AnimationSystem::play(InstanceID id, const AnimationClip* clip, bool loop, float speed) {
+    Instance* instance = find(id);
+    if (!instance) {
+        return false;
+    }
+    if (clip && (clip->isEmpty() || clip->getJointCount() != instance->skeleton->getJointCount())) {
+        ERROR("AnimationSystem", "play", ("Clip " + clip->getName() + " does not match the skeleton").c_str());
+        return false;
+    }
+    instance->clip = clip;
+    instance->loop = loop;
+    instance->speed = speed;
+    instance->time = clip && speed < 0.0f ? clip->getDuration() : 0.0f;
+    instance->cursors.assign(clip ? clip->getTrackCount() : 0, 0);
+    refresh(*instance);
+    return true;
+}
+
+void AnimationSystem::setTime(InstanceID id, float seconds) {
+    if (Instance* instance = find(id)) {
+        instance->time = seconds;
+        advance(*instance, 0.0f); // solo ajusta al rango del clip
+        instance->resync = true;  // la pose de llegada del tramo ya no vale
+    }
+}
+
+float AnimationSystem::getTime(InstanceID id) const {
+    const Instance* instance = find(id);
+    return instance ? instance->time : 0.0f;
+}
+
+void AnimationSystem::setSpeed(InstanceID id, float speed) {
+    if (Instance* instance = find(id)) {
+        instance->speed = speed;
+        instance->resync = true;
+    }
+}
+
+float AnimationSystem::wrapTime(const Instance& instance, float time) {
+    const float duration = instance.clip ? instance.clip->getDuration() : 0.0f;
+    if (duration <= 0.0f) {
+        return 0.0f;
+    }
+    if (instance.loop) {
+        time = std::fmod(time, duration);
+        return time < 0.0f ? time + duration : time;
+    }
+    return (std::max)(0.0f, (std::min)(time, duration));
+}
+
+void AnimationSystem::advance(Instance& instance, float deltaTime) {
+    instance.time = wrapTime(instance, instance.time + deltaTime * instance.speed);
+}
+
+void AnimationSystem::bumpVersion(Instance& instance) {
+    if (++instance.version == 0) {
+        instance.version = 1; // 0 queda para "sin instancia"
+    }
+}
+
+void AnimationSystem::refresh(Instance& instance) {
+    evaluate(*instance.skeleton, instance.clip, instance.time, instance.cursors.data(), instance.palette.data());
+    instance.evaluatedTime = instance.time;
+    instance.step = 0;
+    instance.resync = false;
+    bumpVersion(instance);
+}
+
+/**
+ * @details Un tramo son `interval` pasos. En el primero se guarda la paleta actual
+ * (la del paso anterior) y se evalúa la del último paso del tramo, `interval - 1`
+ * pasos por delante; el paso `k` mezcla las dos con peso `(k + 1) / interval`, así que
+ * el último deja la pose exacta. La mezcla lineal de matrices no es una rotación pura,
+ * pero entre poses a pocos pasos la diferencia no se ve a ese tamaño en pantalla.
+ */
+bool AnimationSystem::interpolate(Instance& instance, float deltaTime) {
+    const size_t jointCount = instance.palette.size();
+    EU::Matrix3x4* from = instance.keys.data();
+    EU::Matrix3x4* to = from + jointCount;
+    const bool evaluated = instance.step == 0;
+    if (evaluated) {
+        std::copy(instance.palette.begin(), instance.palette.end(), from);
+        const float ahead = deltaTime * instance.speed * static_cast<float>(instance.interval - 1);
+        evaluate(*instance.skeleton, instance.clip, wrapTime(instance, instance.time + ahead),
+            instance.cursors.data(), to);
+    }
+
+    const float weight = static_cast<float>(instance.step + 1) / static_cast<float>(instance.interval);
+    for (size_t j = 0; j < jointCount; ++j) {
+        for (int r = 0; r < 3; ++r) {
+            const XMVECTOR a = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(from[j].m[r]));
+            const XMVECTOR b = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(to[j].m[r]));
+            XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(instance.palette[j].m[r]), XMVectorLerp(a, b, weight));
+        }
+    }
+    instance.evaluatedTime = instance.time;
+    if (++instance.step >= instance.interval) {
+        instance.step = 0;
+    }
+    bumpVersion(instance);
+    return evaluated;
+}
+
+unsigned int AnimationSystem::selectInterval(const Instance& instance) const {
+    const unsigned int maxInterval = (std::max)(m_rate.maxInterval, 1u);
+    if (!m_rate.enabled) {
+        return 1;
+    }
+    if (!instance.visible) {
+        return m_rate.freezeHidden ? 0 : maxInterval;
+    }
+    if (instance.screenSize >= m_rate.fullRateScreenSize) {
+        return 1;
+    }
+    if (instance.screenSize <= m_rate.minRateScreenSize || m_rate.fullRateScreenSize <= m_rate.minRateScreenSize) {
+        return maxInterval;
+    }
+    const float t = (m_rate.fullRateScreenSize - instance.screenSize) / (m_rate.fullRateScreenSize - m_rate.minRateScreenSize);
+    return 1 + static_cast<unsigned int>(t * static_cast<float>(maxInterval - 1) + 0.5f);
+}
+
+void AnimationSystem::beginVisibility() {
+    for (Instance& instance : m_instances) {
+        instance.visible = false;
+        instance.screenSize = 0.0f;
+    }
+}
+
+void AnimationSystem::markVisible(InstanceID id, float screenSize) {
+    if (Instance* instance = find(id)) {
+        instance->visible = true;
+        instance->screenSize = (std::max)(instance->screenSize, screenSize);
+    }
+}
+
+void AnimationSystem::endVisibility() {
+    for (Instance& instance : m_instances) {
+        if (!instance.skeleton) {
+            continue;
+        }
+        const unsigned int interval = selectInterval(instance);
+        if (interval == instance.interval) {
+            continue;
+        }
+        // Al dejar de estar congelada su pose es vieja: la primera se evalúa entera.
+        if (instance.interval == 0) {
+            instance.resync = true;
+        }
+        if (interval > 1 && instance.keys.empty()) {
+            instance.keys.resize(instance.palette.size() * 2);
+        }
+        // Tramo nuevo con el nuevo ritmo, desde la paleta actual (sin saltos).
+        instance.step = 0;
+        instance.interval = interval;
+    }
+}
+
+void AnimationSystem::update(float deltaTime, bool parallel) {
+    PROFILE_ZONE("AnimationSystem::update");
+    const unsigned int count = static_cast<unsigned int>(m_instances.size());
+    std::atomic<unsigned int> evaluatedCount(0), interpolatedCount(0), frozenCount(0);
+    auto work = [&, this, deltaTime](unsigned int begin, unsigned int end) {
+        // Solo matemáticas sobre memoria ya reservada (ver `evaluate` y `endVisibility`).
+        MEMORY_NO_ALLOC_SCOPE();
+        unsigned int evaluated = 0, interpolated = 0, frozen = 0;
+        for (unsigned int i = begin; i < end; ++i) {
+            Instance& instance = m_instances[i];
+            if (!instance.skeleton || !instance.clip) {
+                continue; // libre, o quieta en la pose de enlace ya calculada
+            }
+            // El tiempo avanza siempre: al volver a evaluar, la pose es la de ahora.
+            advance(instance, deltaTime);
+            if (instance.time == instance.evaluatedTime) {
+                continue;
+            }
+            if (instance.interval == 0) {
+                ++frozen;
+            }
+            else if (instance.interval == 1 || instance.resync || instance.keys.empty()) {
+                refresh(instance);
+                ++evaluated;
+            }
+            else if (interpolate(instance, deltaTime)) {
+                ++evaluated;
+            }
+            else {
+                ++interpolated;
+            }
+        }
+        evaluatedCount += evaluated;
+        interpolatedCount += interpolated;
+        frozenCount += frozen;
+    };
+    if (parallel) {
+        JobSystem::getDefault().parallelFor(count, work, kInstanceBatch);
+    }
+    else {
+        work(0, count);
+    }
+    m_evaluatedCount = evaluatedCount;
+    m_interpolatedCount = interpolatedCount;
+    m_frozenCount = frozenCount;
+}
+
+const EU::Matrix3x4* AnimationSystem::getPalette(InstanceID id) const {
+    const Instance* instance = find(id);
+    return instance ? instance->palette.data() : nullptr;
+}
+
+unsigned int AnimationSystem::getPaletteSize(InstanceID id) const {
+    const Instance* instance = find(id);
+    return instance ? static_cast<unsigned int>(instance->palette.size()) : 0;
+}
+
+void AnimationSystem::setMorphWeight(InstanceID id, unsigned int target, float weight) {
+    Instance* instance = find(id);
+    if (!instance || getMorphWeight(id, target) == weight) {
+        return;
+    }
+    if (target >= instance->morphWeights.size()) {
+        instance->morphWeights.resize(target + 1, 0.0f);
+    }
+    instance->morphWeights[target] = weight;
+    bumpVersion(*instance); // la malla se vuelve a deformar aunque la paleta no cambie
+}
+
+float AnimationSystem::getMorphWeight(InstanceID id, unsigned int target) const {
+    const Instance* instance = find(id);
+    return instance && target < instance->morphWeights.size() ? instance->morphWeights[target] : 0.0f;
+}
+
+const float* AnimationSystem::getMorphWeights(InstanceID id, unsigned int& count) const {
+    const Instance* instance = find(id);
+    count = instance ? static_cast<unsigned int>(instance->morphWeights.size()) : 0;
+    return count > 0 ? instance->morphWeights.data() : nullptr;
+}
+
+unsigned int AnimationSystem::getPoseVersion(InstanceID id) const {
+    const Instance* instance = find(id);
+    return instance ? instance->version : 0;
+}
+
+size_t AnimationSystem::getMemoryUsage() const {
+    size_t bytes = m_instances.capacity() * sizeof(Instance) + m_free.capacity() * sizeof(InstanceID);
+    for (const Instance& instance : m_instances) {
+        bytes += instance.cursors.capacity() * sizeof(uint16_t) +
+            (instance.palette.capacity() + instance.keys.capacity()) * sizeof(EU::Matrix3x4) +
+            instance.morphWeights.capacity() * sizeof(float);
+    }
+    return bytes;
+}
+
+/**
+ * @details Todo el trabajo va en arrays de tamaño `Skeleton::kMaxJoints` en la pila
+ * (~32 KB): sin reservas, así que se puede llamar desde cualquier trabajo. La matriz
+ * global de cada hueso se escribe encima de la local, que ya no hace falta.
+ */
+void AnimationSystem::evaluate(const Skeleton& skeleton, const AnimationClip* clip, float time,
+    uint16_t* cursors, EU::Matrix3x4* palette) {
+    const unsigned int jointCount = (std::min)(skeleton.getJointCount(), static_cast<unsigned int>(Skeleton::kMaxJoints));
+    EU::Quaternion rotations[Skeleton::kMaxJoints];
+    EU::Vector3 translations[Skeleton::kMaxJoints];
+    EU::Vector3 scales[Skeleton::kMaxJoints];
+    EU::Matrix3x4 globals[Skeleton::kMaxJoints];
+
+    if (clip) {
+        EU::Quaternion scratch[Skeleton::kMaxJoints * 2];
+        float weights[Skeleton::kMaxJoints];
+        clip->sample(time, cursors, rotations, translations, scales, scratch, weights);
+    }
+    else {
+        for (unsigned int j = 0; j < jointCount; ++j) {
+            rotations[j] = skeleton.bindPose[j].rotation;
+            translations[j] = skeleton.bindPose[j].translation;
+            scales[j] = skeleton.bindPose[j].scale;
+        }
+    }
+
+    EU::QuaternionsToMatrices(rotations, scales, translations, globals, jointCount);
+    for (unsigned int j = 0; j < jointCount; ++j) {
+        const int parent = skeleton.parents[j];
+        if (parent >= 0) {
+            multiplyAffine(globals[parent], globals[j], globals[j]);
+        }
+        multiplyAffine(globals[j], skeleton.inverseBind[j], palette[j]);
+    }
+}
+
+AnimationSystem::Instance* AnimationSystem::find(InstanceID id) {
+    return id < m_instances.size() && m_instances[id].skeleton ? &m_instances[id] : nullptr;
+}
+
+const AnimationSystem::Instance* AnimationSystem::find(InstanceID id) const {
+    return id < m_instances.size() && m_instances[id].skeleton ? &m_instances[id] : nullptr;
+}
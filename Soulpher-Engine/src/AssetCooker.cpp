@@ -0,0 +1,301 @@
+﻿/**
+ * @file AssetCooker.cpp
+ * @brief Cocinado de shaders, modelos y texturas a las cachés que lee el runtime.
+ */
+
+#include "AssetCooker.h"
+#include "ShaderLibrary.h"
+#include "ModelLoader.h"
+#include "MeshCache.h"
+#include "Animation.h"
+#include "ImageDecoder.h"
+#include "MipChain.h"
+#include "BlockCompressor.h"
+#include "DdsFile.h"
+#include "VirtualFileSystem.h"
+#include "JobSystem.h"
+#include <fstream>
+#include <sstream>
+
+const char* const AssetCooker::kModelDirectory = "ModelsFBX";
+const char* const AssetCooker::kTextureDirectory = "Textures";
+const char* const AssetCooker::kVariantList = "ShaderVariants.txt";
+
+namespace {
+    std::string lowerExtension(const std::string& path) {
+        const size_t dot = path.find_last_of('.');
+        const size_t slash = path.find_last_of("/\\");
+        if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+            return std::string();
+        }
+        std::string extension = path.substr(dot + 1);
+        for (char& c : extension) {
+            c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+        }
+        return extension;
+    }
+
+    bool getWriteTime(const std::string& path, ULONGLONG& time) {
+        WIN32_FILE_ATTRIBUTE_DATA attributes;
+        if (!GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &attributes)) {
+            return false;
+        }
+        time = (static_cast<ULONGLONG>(attributes.ftLastWriteTime.dwHighDateTime) << 32) |
+            attributes.ftLastWriteTime.dwLowDateTime;
+        return true;
+    }
+
+    /**
+     * Puntos de entrada que usa el motor: una definición `tipo NOMBRE(` al principio de
+     * línea con `VS`, `PS` o un nombre que empieza por `CS`. Devuelve (nombre, etapa).
+     */
+    std::vector<std::pair<std::string, ShaderType>> findEntryPoints(const std::string& path) {
+        std::vector<std::pair<std::string, ShaderType>> entries;
+        std::ifstream file(path.c_str());
+        std::string line;
+        while (std::getline(file, line)) {
+            std::istringstream words(line);
+            std::string type, name;
+            if (!(words >> type >> name)) {
+                continue;
+            }
+            const size_t paren = name.find('(');
+            if (paren != std::string::npos) {
+                name = name.substr(0, paren);
+            }
+            else {
+                // `float4 PS (` también es una definición.
+                char next = 0;
+                if (!(words >> next) || next != '(') {
+                    continue;
+                }
+            }
+            ShaderType stage;
+            if (name == "VS") {
+                stage = VERTEX_SHADER;
+            }
+            else if (name == "PS") {
+                stage = PIXEL_SHADER;
+            }
+            else if (name.compare(0, 2, "CS") == 0) {
+                stage = COMPUTE_SHADER;
+            }
+            else {
+                continue;
+            }
+            bool known = false;
+            for (const auto& entry : entries) {
+                known = known || entry.first == name;
+            }
+            if (!known) {
+                entries.push_back(std::make_pair(name, stage));
+            }
+        }
+        return entries;
+    }
+}
+
+std::vector<std::string> AssetCooker::findFiles(const std::string& directory,
+    const std::vector<std::string>& extensions) {
+    std::vector<std::string> files;
+    WIN32_FIND_DATAA data;
+    HANDLE find = FindFirstFileA((directory + "\\*").c_str(), &data);
+    if (find == INVALID_HANDLE_VALUE) {
+        return files;
+    }
+    do {
+        const std::string name = data.cFileName;
+        if (name == "." || name == "..") {
+            continue;
+        }
+        const std::string path = directory == "." ? name : directory + "\\" + name;
+        if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+            const std::vector<std::string> nested = findFiles(path, extensions);
+            files.insert(files.end(), nested.begin(), nested.end());
+        }
+        else if (std::find(extensions.begin(), extensions.end(), lowerExtension(name)) != extensions.end()) {
+            files.push_back(path);
+        }
+    } while (FindNextFileA(find, &data));
+    FindClose(find);
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+void AssetCooker::cookShaders(std::vector<std::string>& manifest, Stats& stats) {
+    // Palabras clave por archivo: cada línea de la lista es una permutación más.
+    std::vector<std::pair<std::string, std::vector<std::string>>> listed;
+    std::ifstream list(kVariantList);
+    std::string line;
+    while (std::getline(list, line)) {
+        std::istringstream words(line.substr(0, line.find('#')));
+        std::string fileName, keyword;
+        if (!(words >> fileName)) {
+            continue;
+        }
+        std::vector<std::string> keywords;
+        while (words >> keyword) {
+            keywords.push_back(keyword);
+        }
+        listed.push_back(std::make_pair(fileName, keywords));
+    }
+
+    ShaderLibrary library;
+    // Solo se busca en la carpeta de trabajo: es donde el runtime abre los .fx.
+    WIN32_FIND_DATAA data;
+    std::vector<std::string> shaderFiles;
+    HANDLE find = FindFirstFileA("*.fx", &data);
+    if (find != INVALID_HANDLE_VALUE) {
+        do {
+            shaderFiles.push_back(data.cFileName);
+        } while (FindNextFileA(find, &data));
+        FindClose(find);
+    }
+    std::sort(shaderFiles.begin(), shaderFiles.end());
+
+    for (const std::string& fileName : shaderFiles) {
+        std::vector<std::vector<std::string>> variants(1); // sin palabras clave
+        for (const auto& entry : listed) {
+            if (_stricmp(entry.first.c_str(), fileName.c_str()) == 0 && !entry.second.empty()) {
+                variants.push_back(entry.second);
+            }
+        }
+        for (const auto& entryPoint : findEntryPoints(fileName)) {
+            for (const std::vector<std::string>& keywords : variants) {
+                ShaderKey key;
+                key.fileName = fileName;
+                key.entryPoint = entryPoint.first;
+                key.profile = ShaderLibrary::profile(entryPoint.second, D3D_FEATURE_LEVEL_11_0);
+                for (const std::string& keyword : keywords) {
+                    key.defines.push_back({ keyword, "1" });
+                }
+                std::string cachePath;
+                const HRESULT hr = library.cookToDisk(key, cachePath);
+                if (FAILED(hr)) {
+                    ++stats.failed;
+                    continue;
+                }
+                if (hr == S_FALSE) {
+                    ++stats.upToDate;
+                }
+                else {
+                    ++stats.cooked;
+                }
+                manifest.push_back("shader " + key.toString() + " -> " + cachePath);
+            }
+        }
+    }
+}
+
+void AssetCooker::cookModel(const std::string& path, std::vector<std::string>& manifest, Stats& stats) {
+    const std::string cachePath = MeshCache::getCachePath(path);
+    ULONGLONG before = 0, after = 0;
+    const bool existed = getWriteTime(cachePath, before);
+
+    // Una instancia por modelo: al salir libera el FBX SDK y las mallas importadas.
+    ModelLoader loader;
+    const bool loaded = lowerExtension(path) == "obj"
+        ? loader.LoadCachedOBJModel(path) : loader.LoadCachedFBXModel(path);
+    if (!loaded || !getWriteTime(cachePath, after)) {
+        ERROR("AssetCooker", "cookModel", ("Failed to cook " + path).c_str());
+        ++stats.failed;
+        return;
+    }
+    if (existed && after == before) {
+        ++stats.upToDate;
+    }
+    else {
+        ++stats.cooked;
+    }
+    manifest.push_back("mesh " + path + " -> " + cachePath);
+    const std::string animationPath = AnimationCache::getCachePath(path);
+    if (getWriteTime(animationPath, after)) {
+        manifest.push_back("animation " + path + " -> " + animationPath);
+    }
+}
+
+void AssetCooker::cookTexture(const std::string& path, std::vector<std::string>& manifest, Stats& stats) {
+    const std::string cachePath = DdsFile::getCachePath(path, TEXTURE_COMPRESSION_AUTO);
+    if (DdsFile::isFresh(cachePath, path)) {
+        ++stats.upToDate;
+        manifest.push_back("texture " + path + " -> " + cachePath);
+        return;
+    }
+
+    // El mismo camino que `Texture::init` cuando no hay caché.
+    DecodedImage image;
+    std::string reason;
+    if (FAILED(ImageDecoder::decodeFile(path, image, &reason)) || image.isHdr()) {
+        ERROR("AssetCooker", "cookTexture", ("Cannot cook " + path + ": " + reason).c_str());
+        ++stats.failed;
+        return;
+    }
+    MipChain mips;
+    mips.build(image.getPixels(), image.getWidth(), image.getHeight(), false);
+    CompressedImage compressed;
+    if (!BlockCompressor::compress(mips, TEXTURE_COMPRESSION_AUTO, compressed)) {
+        // BCn exige lados múltiplos de 4: el runtime la sube en RGBA8 y tampoco la cachea.
+        // Su "caché" es el propio original, que así también entra en el paquete.
+        MESSAGE("AssetCooker", "cookTexture", ("Not block-compressible, left as is: " + path).c_str());
+        manifest.push_back("texture " + path + " -> " + path);
+        return;
+    }
+    if (FAILED(DdsFile::write(cachePath, compressed))) {
+        ERROR("AssetCooker", "cookTexture", ("Cannot write " + cachePath).c_str());
+        ++stats.failed;
+        return;
+    }
+    ++stats.cooked;
+    manifest.push_back("texture " + path + " -> " + cachePath);
+}
+
+HRESULT AssetCooker::run(const std::string& manifestPath, const std::string& packPath) {
+    std::vector<std::string> manifest;
+    Stats stats;
+
+    cookShaders(manifest, stats);
+    for (const std::string& model : findFiles(kModelDirectory, { "fbx", "obj" })) {
+        cookModel(model, manifest, stats);
+    }
+    const std::vector<std::string> imageExtensions = { "png", "jpg", "tga" };
+    for (const char* directory : { kModelDirectory, kTextureDirectory }) {
+        for (const std::string& texture : findFiles(directory, imageExtensions)) {
+            cookTexture(texture, manifest, stats);
+        }
+    }
+
+    std::ofstream file(manifestPath.c_str(), std::ios::trunc);
+    if (!file) {
+        ERROR("AssetCooker", "run", ("Cannot write " + manifestPath).c_str());
+        return E_FAIL;
+    }
+    file << "# Cachés cocinadas: tipo origen -> archivo (ver AssetCooker.h)\n";
+    for (const std::string& line : manifest) {
+        file << line << '\n';
+    }
+    MESSAGE("AssetCooker", "run", ("Cooked " + std::to_string(stats.cooked) + ", up to date " +
+        std::to_string(stats.upToDate) + ", failed " + std::to_string(stats.failed)).c_str());
+
+    if (!packPath.empty()) {
+        // Lo de la derecha de cada línea, más los fuentes de shader (con sus includes).
+        // Lo que se lee al cargar la escena, LZ4 rápido; los shaders (texto y bytecode
+        // pequeños, se leen una vez) con el nivel alto.
+        std::vector<VirtualFileSystem::PackFile> packed;
+        for (const std::string& source : findFiles(".", { "fx", "fxh", "hlsl", "hlsli" })) {
+            packed.push_back({ source, PACK_COMPRESSION_HIGH });
+        }
+        for (const std::string& line : manifest) {
+            const bool shader = line.compare(0, 7, "shader ") == 0;
+            packed.push_back({ line.substr(line.find(" -> ") + 4),
+                shader ? PACK_COMPRESSION_HIGH : PACK_COMPRESSION_FAST });
+        }
+        // Sin ventana no hay JobSystem: se arranca para comprimir los bloques en paralelo.
+        JobSystem::getDefault().init();
+        const HRESULT hr = VirtualFileSystem::writePack(packPath, packed);
+        JobSystem::getDefault().destroy();
+        if (FAILED(hr)) {
+            return E_FAIL;
+        }
+    }
+    return stats.failed == 0 ? S_OK : E_FAIL;
+}
@@ -0,0 +1,239 @@
+﻿/**
+ * @file AssetHotReload.cpp
+ * @brief Vigilancia de modelos y texturas, reimportación en los hilos de carga y sustitución.
+ */
+
+#include "AssetHotReload.h"
+#include "Device.h"
+#include "MeshLibrary.h"
+#include "AsyncTextureLoader.h"
+#include "ResourceManager.h"
+#include "ModelLoader.h"
+#include "VirtualFileSystem.h"
+#include <algorithm>
+#include <memory>
+
+namespace {
+    /// Tamaño del buffer de notificaciones (en DWORDs).
+    const size_t kNotifyBufferWords = 16 * 1024;
+
+    /// Extensión en minúsculas (vacía si no tiene).
+    std::string lowerExtension(const std::string& path) {
+        const size_t dot = path.find_last_of('.');
+        const size_t slash = path.find_last_of("/\\");
+        if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+            return std::string();
+        }
+        std::string extension = path.substr(dot + 1);
+        for (char& c : extension) {
+            c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+        }
+        return extension;
+    }
+
+    bool isModel(const std::string& extension) { return extension == "fbx" || extension == "obj"; }
+    bool isTexture(const std::string& extension) { return extension == "png" || extension == "jpg"; }
+}
+
+HRESULT AssetHotReload::init(Device& device, ResourceManager& resources, MeshLibrary& meshes,
+    AsyncTextureLoader& textures, const std::string& directory) {
+    destroy();
+
+    m_directoryHandle = CreateFileA(directory.c_str(), FILE_LIST_DIRECTORY,
+        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+        FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+    if (m_directoryHandle == INVALID_HANDLE_VALUE) {
+        const HRESULT hr = HRESULT_FROM_WIN32(GetLastError());
+        ERROR("AssetHotReload", "init", ("Cannot open asset directory: " + directory).c_str());
+        return hr;
+    }
+    m_changeEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+    m_stopEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+    m_notifyBuffer.assign(kNotifyBufferWords, 0);
+    m_overlapped = OVERLAPPED();
+    m_overlapped.hEvent = m_changeEvent;
+    if (!m_changeEvent || !m_stopEvent || !watch()) {
+        ERROR("AssetHotReload", "init", "Cannot watch the asset directory.");
+        destroy();
+        return E_FAIL;
+    }
+
+    m_device = &device;
+    m_resources = &resources;
+    m_meshes = &meshes;
+    m_textures = &textures;
+    m_directory = directory;
+    m_thread = std::thread(&AssetHotReload::threadLoop, this);
+    MESSAGE("AssetHotReload", "init", ("Watching models and textures in " + directory).c_str());
+    return S_OK;
+}
+
+bool AssetHotReload::watch() {
+    ResetEvent(m_changeEvent);
+    return ReadDirectoryChangesW(m_directoryHandle, m_notifyBuffer.data(),
+        static_cast<DWORD>(m_notifyBuffer.size() * sizeof(DWORD)), TRUE,
+        FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME, nullptr,
+        &m_overlapped, nullptr) != FALSE;
+}
+
+void AssetHotReload::readChanges() {
+    DWORD bytes = 0;
+    if (!GetOverlappedResult(m_directoryHandle, &m_overlapped, &bytes, FALSE)) {
+        return;
+    }
+    // 0 bytes: el buffer se desbordó y no se sabe qué archivos fueron.
+    if (bytes == 0) {
+        ERROR("AssetHotReload", "readChanges", "Change notifications overflowed; save the asset again to reload it.");
+        return;
+    }
+    const unsigned char* cursor = reinterpret_cast<const unsigned char*>(m_notifyBuffer.data());
+    for (;;) {
+        const FILE_NOTIFY_INFORMATION* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(cursor);
+        const int length = static_cast<int>(info->FileNameLength / sizeof(WCHAR));
+        const int size = WideCharToMultiByte(CP_ACP, 0, info->FileName, length, nullptr, 0, nullptr, nullptr);
+        if (size > 0) {
+            std::string name(static_cast<size_t>(size), '\0');
+            WideCharToMultiByte(CP_ACP, 0, info->FileName, length, &name[0], size, nullptr, nullptr);
+            const std::string extension = lowerExtension(name);
+            if (isModel(extension) || isTexture(extension)) {
+                const std::string path = VirtualFileSystem::normalizePath(m_directory + "\\" + name);
+                if (std::find(m_settling.begin(), m_settling.end(), path) == m_settling.end()) {
+                    m_settling.push_back(path);
+                }
+            }
+        }
+        if (info->NextEntryOffset == 0) {
+            break;
+        }
+        cursor += info->NextEntryOffset;
+    }
+}
+
+void AssetHotReload::threadLoop() {
+    HANDLE events[2] = { m_stopEvent, m_changeEvent };
+    for (;;) {
+        const DWORD signaled = WaitForMultipleObjects(2, events, FALSE, m_settling.empty() ? INFINITE : kSettleMs);
+        if (signaled == WAIT_OBJECT_0) {
+            break;
+        }
+        if (signaled == WAIT_TIMEOUT) {
+            // Ya no llegan escrituras: el hilo principal recarga en su próximo frame.
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (const std::string& path : m_settling) {
+                if (std::find(m_changed.begin(), m_changed.end(), path) == m_changed.end()) {
+                    m_changed.push_back(path);
+                }
+            }
+            m_settling.clear();
+            continue;
+        }
+        if (signaled == WAIT_OBJECT_0 + 1) {
+            readChanges();
+            if (!watch()) {
+                ERROR("AssetHotReload", "threadLoop", "ReadDirectoryChangesW failed; hot reload stopped.");
+                break;
+            }
+            continue;
+        }
+        ERROR("AssetHotReload", "threadLoop", "Wait failed; hot reload stopped.");
+        break;
+    }
+}
+
+/**
+ * @details
+ * Los nombres de la biblioteca son las rutas con las que se cargaron los modelos (ver
+ * `MeshLibrary::adopt`); se comparan normalizadas con la del archivo cambiado.
+ */
+unsigned int AssetHotReload::update() {
+    if (!m_device) {
+        return 0;
+    }
+    std::vector<std::string> changed;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        changed.swap(m_changed);
+    }
+
+    for (const std::string& path : changed) {
+        const std::string extension = lowerExtension(path);
+        if (isTexture(extension)) {
+            const unsigned int queued = m_textures->reload(path);
+            if (queued > 0) {
+                MESSAGE("AssetHotReload", "update", ("Reloading " + path).c_str());
+                m_reloadCount += queued;
+            }
+            continue;
+        }
+        for (const std::string& name : m_meshes->getNames()) {
+            if (VirtualFileSystem::normalizePath(name) != path) {
+                continue;
+            }
+            if (std::find(m_importing.begin(), m_importing.end(), name) != m_importing.end()) {
+                if (std::find(m_stale.begin(), m_stale.end(), name) == m_stale.end()) {
+                    m_stale.push_back(name);
+                }
+                continue;
+            }
+            reimport(name);
+        }
+    }
+
+    const unsigned int replaced = m_replaced;
+    m_replaced = 0;
+    return replaced;
+}
+
+void AssetHotReload::reimport(const std::string& name) {
+    MESSAGE("AssetHotReload", "update", ("Reimporting " + name).c_str());
+    m_importing.push_back(name);
+    std::shared_ptr<ModelLoader> loader = std::make_shared<ModelLoader>();
+    m_resources->runOnLoader([loader, name]() {
+        const bool loaded = lowerExtension(name) == "obj"
+            ? loader->LoadCachedOBJModel(name) : loader->LoadCachedFBXModel(name);
+        return loaded && !loader->meshes.empty();
+    }, [this, loader, name](bool succeeded) {
+        m_importing.erase(std::find(m_importing.begin(), m_importing.end(), name));
+        if (!succeeded) {
+            // A medio exportar o roto: la malla anterior se queda hasta el próximo guardado.
+            ERROR("AssetHotReload", "update", ("Failed to reimport " + name + "; keeping the old mesh").c_str());
+        }
+        else if (m_meshes->replace(*m_device, name, *loader)) {
+            ++m_replaced;
+            ++m_reloadCount;
+        }
+        auto stale = std::find(m_stale.begin(), m_stale.end(), name);
+        if (stale != m_stale.end()) {
+            m_stale.erase(stale);
+            reimport(name);
+        }
+    });
+}
+
+void AssetHotReload::destroy() {
+    if (m_thread.joinable()) {
+        SetEvent(m_stopEvent);
+        m_thread.join();
+    }
+    if (m_directoryHandle != INVALID_HANDLE_VALUE) {
+        // La lectura pendiente escribe en `m_notifyBuffer`: se cancela antes de soltarlo.
+        if (CancelIoEx(m_directoryHandle, &m_overlapped)) {
+            DWORD bytes = 0;
+            GetOverlappedResult(m_directoryHandle, &m_overlapped, &bytes, TRUE);
+        }
+        CloseHandle(m_directoryHandle);
+        m_directoryHandle = INVALID_HANDLE_VALUE;
+    }
+    if (m_changeEvent) { CloseHandle(m_changeEvent); m_changeEvent = nullptr; }
+    if (m_stopEvent) { CloseHandle(m_stopEvent); m_stopEvent = nullptr; }
+    m_notifyBuffer.clear();
+    m_settling.clear();
+    m_changed.clear();
+    m_importing.clear();
+    m_stale.clear();
+    m_replaced = 0;
+    m_device = nullptr;
+    m_resources = nullptr;
+    m_meshes = nullptr;
+    m_textures = nullptr;
+}
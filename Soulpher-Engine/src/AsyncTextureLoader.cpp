@@ -0,0 +1,398 @@
+﻿/**
+ * @file AsyncTextureLoader.cpp
+ * @brief Pool de carga de texturas, caché por ruta y sustitución del placeholder.
+ */
+
+#include "AsyncTextureLoader.h"
+#include "CpuTopology.h"
+#include "Device.h"
+#include "MemoryTracker.h"
+#include "StartupTimeline.h"
+#include "VirtualFileSystem.h"
+
+std::string AsyncTextureLoader::makeKey(const std::vector<Source>& sources) {
+    std::string key;
+    for (const Source& source : sources) {
+        key += VirtualFileSystem::normalizePath(source.name) + '|' + std::to_string(static_cast<int>(source.extension)) +
+            '|' + std::to_string(static_cast<int>(source.compression)) + ';';
+    }
+    return key;
+}
+
+HRESULT AsyncTextureLoader::init(Device& device, unsigned int workerCount) {
+    if (!device.m_device) {
+        ERROR("AsyncTextureLoader", "init", "Device is null.");
+        return E_POINTER;
+    }
+    destroy();
+
+    const unsigned char grey[4] = { 128, 128, 128, 255 };
+    HRESULT hr = m_placeholder.init(device, 1, 1, grey);
+    if (FAILED(hr)) {
+        ERROR("AsyncTextureLoader", "init", "Failed to create placeholder texture");
+        return hr;
+    }
+    m_placeholder.m_textureName = "placeholder";
+
+    m_device = device.m_device;
+    m_device->AddRef();
+    m_stopping = false;
+    if (workerCount == 0) {
+        const unsigned int cores = std::thread::hardware_concurrency();
+        workerCount = cores > 1 ? cores - 1 : 1;
+    }
+    workerCount = (std::min)(workerCount, kMaxWorkers);
+    for (unsigned int i = 0; i < workerCount; ++i) {
+        m_workers.push_back(std::thread(&AsyncTextureLoader::workerLoop, this));
+    }
+    MESSAGE("AsyncTextureLoader", "init", ("Started " + std::to_string(workerCount) + " texture workers").c_str());
+    return S_OK;
+}
+
+TextureHandle AsyncTextureLoader::load(const std::vector<Source>& sources) {
+    const std::string key = makeKey(sources);
+    auto cached = m_cache.find(key);
+    if (cached != m_cache.end()) {
+        ++m_cacheHits;
+        return cached->second.handle;
+    }
+
+    TextureHandle handle = EU::MakeShared<Texture>(m_placeholder.share());
+    if (sources.empty() || m_workers.empty()) {
+        ERROR("AsyncTextureLoader", "load", "No sources or loader not initialized.");
+        return handle;
+    }
+
+    Entry& entry = m_cache[key];
+    entry.handle = handle;
+    entry.sources = sources;
+    entry.lastUsed = m_frame;
+    m_entries[handle.get()] = &entry;
+    enqueue(key, entry, m_initialSize);
+    return handle;
+}
+
+void AsyncTextureLoader::enqueue(const std::string& key, Entry& entry, unsigned int maxSize) {
+    const unsigned long long id = m_nextId++;
+    Target target = { id, key, entry.handle };
+    m_targets.push_back(target);
+    entry.pending = true;
+    entry.pendingSize = maxSize;
+    entry.pendingMip = entry.loaded ? getMipForSize(*entry.handle, maxSize) : 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Job job = { id, entry.sources, maxSize };
+        m_queue.push_back(job);
+    }
+    m_wake.notify_one();
+}
+
+unsigned int AsyncTextureLoader::update() {
+    std::vector<Result> finished;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        finished.swap(m_results);
+    }
+
+    unsigned int swapped = 0;
+    for (Result& result : finished) {
+        auto target = std::find_if(m_targets.begin(), m_targets.end(),
+            [&result](const Target& t) { return t.id == result.id; });
+        if (target == m_targets.end()) {
+            result.texture.destroy();
+            continue;
+        }
+        const Target done = *target;
+        m_targets.erase(target);
+        auto cached = m_cache.find(done.key);
+        Entry* entry = cached != m_cache.end() ? &cached->second : nullptr;
+        if (entry) {
+            entry->pending = false;
+            if (entry->stale) {
+                // Leyó el archivo de antes del cambio: se repite y esta se descarta.
+                entry->stale = false;
+                result.texture.destroy();
+                enqueue(done.key, *entry, entry->pendingSize);
+                continue;
+            }
+        }
+        if (FAILED(result.hr)) {
+            if (entry && entry->loaded) {
+                ERROR("AsyncTextureLoader", "update", "Mip streaming reload failed; keeping resident mips.");
+                entry->failed = true;
+            }
+            else {
+                ERROR("AsyncTextureLoader", "update", "No source could be loaded; keeping placeholder.");
+            }
+            continue;
+        }
+        if (entry) {
+            // En BCn el mip 0 tiene que ser múltiplo de 4: si la carga se quedó con más
+            // detalle del pedido, ese es el mínimo al que se puede bajar.
+            const unsigned int asked = getMipForSize(result.texture, entry->pendingSize);
+            const unsigned int last = result.texture.m_mipCount > 0 ? result.texture.m_mipCount - 1 : 0;
+            entry->mipFloor = (std::min)(entry->mipFloor,
+                result.texture.m_residentMip < asked ? result.texture.m_residentMip : last);
+            entry->loaded = true;
+        }
+        done.handle->destroy();        // suelta la referencia al placeholder (o a los mips anteriores)
+        *done.handle = result.texture; // toma la de la textura nueva
+        ++swapped;
+    }
+    releaseUnused();
+    updateStreaming();
+    ++m_frame;
+    return swapped;
+}
+
+bool AsyncTextureLoader::isSettled(const TextureHandle& handle, bool& loaded) const {
+    Entry* const* found = m_entries.Find(handle.get());
+    loaded = found && (*found)->loaded;
+    return !found || loaded || !(*found)->pending;
+}
+
+/**
+ * @details
+ * Solo cuentan las candidatas con la misma ruta normalizada y formato. Una textura que
+ * cargó otra candidata (p. ej. `Default`) también se recarga: la búsqueda se repite en
+ * orden y puede que ahora la primera sí se lea.
+ */
+unsigned int AsyncTextureLoader::reload(const std::string& path) {
+    static const char* const kExtensions[] = { "dds", "png", "jpg", "tga", "hdr" };
+    const std::string changed = VirtualFileSystem::normalizePath(path);
+    unsigned int queued = 0;
+    for (auto& pair : m_cache) {
+        Entry& entry = pair.second;
+        bool uses = false;
+        for (const Source& source : entry.sources) {
+            uses = uses || VirtualFileSystem::normalizePath(source.name) + '.' + kExtensions[source.extension] == changed;
+        }
+        if (!uses) {
+            continue;
+        }
+        if (entry.pending) {
+            entry.stale = true;
+            continue;
+        }
+        const Texture& texture = *entry.handle;
+        const unsigned int side = entry.loaded
+            ? (std::max)((std::max)(texture.m_width, texture.m_height) >> texture.m_residentMip, 1u)
+            : m_initialSize;
+        entry.failed = false;
+        entry.mipFloor = UINT_MAX; // la imagen nueva puede tener otro tamaño
+        enqueue(pair.first, entry, side);
+        ++queued;
+    }
+    return queued;
+}
+
+void AsyncTextureLoader::requestTexels(const TextureHandle& handle, float texels) {
+    Entry* const* found = m_entries.Find(handle.get());
+    if (!found) {
+        return;
+    }
+    Entry& entry = **found;
+    if (entry.lastUsed != m_frame) {
+        entry.lastUsed = m_frame;
+        entry.wantedTexels = 0.0f;
+    }
+    entry.wantedTexels = (std::max)(entry.wantedTexels, texels);
+}
+
+unsigned int AsyncTextureLoader::getDesiredMip(const Texture& texture, float texels) {
+    const unsigned int maxSide = (std::max)(texture.m_width, texture.m_height);
+    unsigned int mip = 0;
+    while (mip + 1 < texture.m_mipCount && static_cast<float>(maxSide >> (mip + 1)) >= texels) {
+        ++mip;
+    }
+    return mip;
+}
+
+unsigned int AsyncTextureLoader::getMipForSize(const Texture& texture, unsigned int maxSize) {
+    const unsigned int maxSide = (std::max)(texture.m_width, texture.m_height);
+    unsigned int mip = 0;
+    while (maxSize && mip + 1 < texture.m_mipCount && (maxSide >> mip) > maxSize) {
+        ++mip;
+    }
+    return mip;
+}
+
+size_t AsyncTextureLoader::estimateBytes(const Texture& texture, unsigned int mip) {
+    // Cada mip tiene 1/4 de los texeles del anterior: la cadena desde `mip` escala igual.
+    const int levels = static_cast<int>(texture.m_residentMip) - static_cast<int>(mip);
+    const double scale = levels >= 0 ? static_cast<double>(1ull << (2 * levels)) : 1.0 / static_cast<double>(1ull << (-2 * levels));
+    return static_cast<size_t>(static_cast<double>(texture.m_residentBytes) * scale);
+}
+
+/**
+ * Una pasada por frame, con las peticiones de @ref requestTexels del frame anterior:
+ * 1. Residencia actual y la que dejarán las recargas en curso.
+ * 2. Subidas (la textura pide un mip más detallado que el residente), de mayor a menor
+ *    petición. Si no caben en el presupuesto se bajan antes las texturas menos
+ *    recientes que tienen más mips de los que piden; si aun así no caben, se esperan.
+ * 3. Si se sigue por encima (p. ej. con un presupuesto nuevo más bajo), más bajadas.
+ */
+void AsyncTextureLoader::updateStreaming() {
+    struct Candidate {
+        const std::string* key;
+        Entry* entry;
+        unsigned int mip;
+    };
+    std::vector<Candidate> upgrades;
+    std::vector<Candidate> evictable;
+    m_residentBytes = 0;
+    size_t projected = 0;
+    for (auto& cached : m_cache) {
+        Entry& entry = cached.second;
+        if (!entry.loaded) {
+            continue;
+        }
+        const Texture& texture = *entry.handle;
+        m_residentBytes += texture.m_residentBytes;
+        if (entry.pending) {
+            projected += estimateBytes(texture, entry.pendingMip);
+            continue;
+        }
+        projected += texture.m_residentBytes;
+        if (entry.failed) {
+            continue;
+        }
+        const bool used = entry.lastUsed == m_frame;
+        const unsigned int desired = used ? getDesiredMip(texture, entry.wantedTexels) : texture.m_mipCount - 1;
+        if (desired < texture.m_residentMip) {
+            upgrades.push_back({ &cached.first, &entry, desired });
+        }
+        else if (desired > texture.m_residentMip && texture.m_residentMip < entry.mipFloor) {
+            // Bajar directamente a lo que pide, sin pasar del mínimo alcanzable.
+            evictable.push_back({ &cached.first, &entry, (std::min)(desired, entry.mipFloor) });
+        }
+    }
+    if (upgrades.empty() && (m_vramBudget == 0 || projected <= m_vramBudget)) {
+        return;
+    }
+
+    std::sort(upgrades.begin(), upgrades.end(),
+        [](const Candidate& a, const Candidate& b) { return a.entry->wantedTexels > b.entry->wantedTexels; });
+    std::sort(evictable.begin(), evictable.end(),
+        [](const Candidate& a, const Candidate& b) { return a.entry->lastUsed < b.entry->lastUsed; });
+    size_t nextEviction = 0;
+    auto evictUntil = [&](size_t limit) {
+        while (projected > limit && nextEviction < evictable.size()) {
+            const Candidate& victim = evictable[nextEviction++];
+            const Texture& texture = *victim.entry->handle;
+            projected -= texture.m_residentBytes - (std::min)(texture.m_residentBytes, estimateBytes(texture, victim.mip));
+            enqueue(*victim.key, *victim.entry, (std::max)((std::max)(texture.m_width, texture.m_height) >> victim.mip, 1u));
+        }
+    };
+
+    for (const Candidate& upgrade : upgrades) {
+        const Texture& texture = *upgrade.entry->handle;
+        const size_t extra = estimateBytes(texture, upgrade.mip) - texture.m_residentBytes;
+        if (m_vramBudget != 0) {
+            evictUntil(extra < m_vramBudget ? m_vramBudget - extra : 0);
+            if (projected + extra > m_vramBudget) {
+                break; // no cabe: se reintenta en otro frame, cuando quizá se liberó algo
+            }
+        }
+        projected += extra;
+        enqueue(*upgrade.key, *upgrade.entry, (std::max)((std::max)(texture.m_width, texture.m_height) >> upgrade.mip, 1u));
+    }
+    if (m_vramBudget != 0) {
+        evictUntil(m_vramBudget);
+    }
+}
+
+void AsyncTextureLoader::releaseUnused() {
+    for (auto it = m_cache.begin(); it != m_cache.end();) {
+        // Con la carga pendiente `m_targets` también la referencia: se libera al terminar.
+        TextureHandle& handle = it->second.handle;
+        if (handle.unique()) {
+            m_entries.Remove(handle.get());
+            handle->destroy();
+            it = m_cache.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+void AsyncTextureLoader::waitIdle() {
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_idle.wait(lock, [this] { return m_queue.empty() && m_busy == 0; });
+    }
+    update();
+}
+
+unsigned int AsyncTextureLoader::getPendingCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return static_cast<unsigned int>(m_queue.size()) + m_busy;
+}
+
+void AsyncTextureLoader::workerLoop() {
+    MEMORY_SCOPE(MEMORY_TAG_LOADER);
+    CpuTopology::getDefault().applyToCurrentThread(CpuTopology::THREAD_ROLE_BACKGROUND);
+    for (;;) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this] { return m_stopping || !m_queue.empty(); });
+            if (m_stopping) {
+                return;
+            }
+            job = m_queue.front();
+            m_queue.pop_front();
+            ++m_busy;
+        }
+
+        Result result = { job.id, E_FAIL, Texture() };
+        for (const Source& source : job.sources) {
+            StartupTimeline::Scope timelineScope("Texture", source.name);
+            result.hr = result.texture.init(m_device, source.name, source.extension, source.compression,
+                job.maxSize);
+            if (SUCCEEDED(result.hr)) {
+                break;
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_results.push_back(result);
+            --m_busy;
+        }
+        m_idle.notify_all();
+        if (m_notifyEvent) {
+            SetEvent(m_notifyEvent);
+        }
+    }
+}
+
+void AsyncTextureLoader::destroy() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+        m_queue.clear();
+    }
+    m_wake.notify_all();
+    for (std::thread& worker : m_workers) {
+        worker.join();
+    }
+    m_workers.clear();
+    m_notifyEvent = nullptr;
+
+    // Cargas terminadas que nadie recogió; los handles pendientes se quedan con el placeholder.
+    for (Result& result : m_results) {
+        result.texture.destroy();
+    }
+    m_results.clear();
+    m_targets.clear();
+    // Las que siguen en uso las liberará su último dueño (`Actor::destroy`).
+    releaseUnused();
+    m_cache.clear();
+    m_entries.Clear();
+    m_cacheHits = 0;
+    m_residentBytes = 0;
+    m_placeholder.destroy();
+    SAFE_RELEASE(m_device);
+}
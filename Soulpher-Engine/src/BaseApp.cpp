@@ -21,11 +21,129 @@
 
 #include "BaseApp.h"
 #include "ECS/Transform.h"
+#include "PointerBenchmark.h"
+#include "AssetCooker.h"
+#include "VirtualFileSystem.h"
+#include "GpuReleaseQueue.h"
+#include "StallDetector.h"
+#include "StartupGraph.h"
+#include "StartupTimeline.h"
+#include "FrameArena.h"
+#include "MemoryTracker.h"
+#include "ConsoleVariable.h"
+#include "CpuTopology.h"
+#include "LightmapUV.h"
+#include "Scalability.h"
 #include "imgui.h"
+#include <shellapi.h>
+#include <cmath>
 
  // Color de limpieza por defecto (RGBA)
 static const float kClear[4] = { 0.0f, 0.125f, 0.30f, 1.0f };
 
+// Ritmo de frames: objetivo del limitador y frames que se siguen dibujando tras cada
+// mensaje en modo reposo (ImGui necesita un par para asentar hover/animaciones).
+static const double kTargetFps = 120.0;
+static const unsigned int kIdleSettleFrames = 3;
+
+// Planos de recorte de la cámara (también reparten las cascadas de sombra)
+static const float kCameraNear = 0.01f;
+static const float kCameraFar = 100.0f;
+
+// Actores por lote como mínimo al simular/interpolar en paralelo (cada uno cuesta poco)
+static const unsigned int kActorBatch = 64;
+
+// Archivo de las capturas de traza si no se pasa `-traceout`
+static const char* kDefaultTracePath = "trace.json";
+
+// Informe del benchmark (sin extensión) y recorrido al que añade "Add camera key"
+static const char* kDefaultBenchmarkReport = "benchmark";
+static const char* kDefaultCameraPath = "camera_path.txt";
+
+// `-headless`: prefijo de los PNG sin `-capture` y frames en vuelo (sin `Present` que
+// frene, la CPU prepara el siguiente mientras la GPU dibuja y se lee el anterior)
+static const char* kDefaultHeadlessPath = "render";
+static const unsigned int kHeadlessFrameLatency = 3;
+
+// Variantes de Instancing.fx y ShadowReceiverInstanced.fx (bit = posición en la lista)
+// y lista de las que se compilan al arrancar en Release.
+static const std::vector<std::string> kInstancingKeywords = { "TEXTURE_ARRAY", "GPU_DRIVEN", "ALPHA_TEST" };
+static const ShaderPermutations::Features kVariantTextureArray = 1u << 0;
+static const ShaderPermutations::Features kVariantGpuDriven = 1u << 1;
+static const char* kShaderVariantList = "ShaderVariants.txt";
+
+// Horneado de lightmaps de la escena sin `-scene` (con ella, junto al archivo).
+static const char* kDefaultLightmapPath = "Lightmaps\\Scene";
+static const char* kDefaultVisibilityPath = "Lightmaps\\Scene_visibility";
+// Caché de las sondas de reflexión estáticas (un DDS por sonda y huella de escena).
+static const char* kProbeCachePath = "ReflectionProbes";
+
+// Interruptores de las optimizaciones de render, para compararlas sin recompilar
+// (`-cvar`, Engine.cfg o la ventana "Console").
+static CVarBool cvDepthPrepass("r.depthPrepass", true, "Pre-pase de profundidad de los opacos");
+static CVarBool cvOcclusionCulling("r.occlusionCulling", true, "Descarta en CPU los actores ocultos según el Hi-Z");
+static CVarBool cvImpostors("r.impostors", true, "Sustituye los actores lejanos por impostores");
+static CVarBool cvClusteredLighting("r.clusteredLighting", true, "Luces puntuales y focos por clusters");
+static CVarBool cvDeferred("r.deferred", false, "Capas opacas al G-buffer e iluminación por baldosas");
+static CVarBool cvSsao("r.ssao", true, "Oclusión ambiental a media resolución (con r.deferred)");
+static CVarFloat cvSsaoRadius("r.ssaoRadius", 0.5f, "Radio de la SSAO en unidades de mundo");
+static CVarFloat cvSsaoIntensity("r.ssaoIntensity", 1.5f, "Intensidad de la SSAO");
+static CVarBool cvDynamicResolution("r.dynamicResolution", true, "Escala la escena según el tiempo de GPU del frame");
+static CVarFloat cvDynamicResolutionBudget("r.dynamicResolutionBudget", 14.5f, "Tiempo de GPU objetivo (ms) de r.dynamicResolution");
+static CVarFloat cvDynamicResolutionMin("r.dynamicResolutionMin", 0.5f, "Escala mínima de la escena por eje");
+static CVarBool cvEditorViewport("r.editorViewport", true, "La escena se dibuja en el panel \"Viewport\", a su tamaño");
+static CVarFloat cvViewportScale("r.viewportScale", 1.0f, "Escala de la escena en el panel \"Viewport\" (0.25..1)");
+static CVarBool cvPlayerStats("ui.playerStats", false, "FPS y tiempos de CPU/GPU en modo jugador (F11, -player 1)");
+static CVarBool cvTaa("r.taa", true, "Antialiasing temporal (jitter de la proyección e historia a tamaño de ventana)");
+static CVarInt cvMsaa("r.msaa", 1, "Muestras MSAA de la escena en forward (1, 2, 4 u 8; sin r.deferred)");
+static CVarInt cvMsaaQuality("r.msaaQuality", 0, "Nivel de calidad MSAA (se recorta al que admite el driver)");
+static CVarBool cvLightmaps("r.lightmaps", true, "Luz horneada en los estáticos (\"Tools > Bake lightmaps\")");
+static CVarBool cvPvs("r.pvs", true, "Descarta los estáticos que no ve la celda de la cámara (\"Tools > Bake visibility\")");
+static CVarBool cvPvsPortals("r.pvsPortals", true, "Los portales del PVS recortan lo que solo se ve a través de ellos");
+static CVarBool cvReflectionProbes("r.reflectionProbes", true, "Reflejos de las sondas de la escena (cubos prefiltrados)");
+static CVarInt cvProbeFacesPerFrame("r.probeFacesPerFrame", 1, "Caras de sonda capturadas por frame (6 = una sonda)");
+static CVarFloat cvTaaBlend("r.taaBlend", 0.1f, "Peso del frame nuevo en r.taa (menos: más suave, más estela)");
+static CVarBool cvHdr("r.hdr", true, "Escena en coma flotante con bloom, exposición y curva filmic");
+static CVarBool cvBloom("r.bloom", true, "Bloom de lo que pasa del umbral (con r.hdr)");
+static CVarFloat cvBloomThreshold("r.bloomThreshold", 1.0f, "Luminancia desde la que hay bloom");
+static CVarFloat cvBloomIntensity("r.bloomIntensity", 0.05f, "Peso del bloom sobre la escena");
+static CVarBool cvAutoExposure("r.autoExposure", true, "Exposición por histograma de luminancia (con r.hdr)");
+static CVarFloat cvExposure("r.exposure", 0.0f, "EV: compensación con r.autoExposure, exposición fija sin ella");
+static CVarFloat cvGamma("r.gamma", 2.2f, "Gamma del pase final (con r.hdr)");
+static CVarInt cvScalability("r.scalability", -1, "Nivel de calidad: -1 = según el benchmark de arranque, 0 Low, 1 Medium, 2 High, 3 Epic (al arrancar)");
+static CVarInt cvShadowMapSize("r.shadowMapSize", 1024, "Texels por lado de cada cascada de sombra (al arrancar)");
+static CVarFloat cvRenderScale("r.renderScale", 1.0f, "Escala fija de la escena por eje (0.5..1), antes de r.dynamicResolution");
+static CVarFloat cvLodBias("r.lodBias", 1.0f, "Factor del tamaño en pantalla al elegir LOD (< 1: LODs simples antes)");
+static CVarInt cvTextureBudget("r.textureBudgetMB", 0, "VRAM para texturas (MB) si no hay -texbudget (0 = la del sistema; al arrancar)");
+static CVarBool cvWatchdog("watchdog.enable", true, "Vigila el presupuesto de cada etapa y vuelca watchdog_<frame>.json si se rompe");
+static CVarFloat cvWatchdogUpdate("watchdog.updateMs", 4.0f, "Presupuesto de update + simulación (ms, 0 = sin vigilar)");
+static CVarFloat cvWatchdogCulling("watchdog.cullingMs", 2.0f, "Presupuesto del culling (ms, 0 = sin vigilar)");
+static CVarFloat cvWatchdogSubmission("watchdog.submissionMs", 4.0f, "Presupuesto del envío de draws, vista y sombras (ms, 0 = sin vigilar)");
+static CVarFloat cvWatchdogGpu("watchdog.gpuMs", 16.0f, "Presupuesto del frame de GPU (ms, 0 = sin vigilar)");
+static CVarInt cvWatchdogFrames("watchdog.frames", 5, "Frames seguidos sobre el presupuesto que disparan el volcado");
+static CVarFloat cvWatchdogSeconds("watchdog.seconds", 5.0f, "Segundos de historia en el volcado");
+static CVarFloat cvWatchdogCooldown("watchdog.cooldown", 30.0f, "Segundos mínimos entre dos volcados");
+static CVarFloat cvStallThreshold("r.stallThresholdMs", 1.0f, "ms desde los que un Map/GetData/Present cuenta como espera a la GPU (0 = no se mide)");
+static CVarBool cvDebugDraw("r.debugDraw", true, "Dibuja las líneas y etiquetas de DebugDraw (solo con PROFILE)");
+static CVarInt cvSpriteStress("hud.spriteStress", 0, "Sprites de prueba por frame (0 = ninguno)");
+static CVarBool cvDebugBounds("r.debugBounds", false, "Caja y nombre del actor seleccionado con DebugDraw");
+static CVarInt cvParticleCapacity("fx.particleCapacity", static_cast<int>(GpuParticles::kDefaultCapacity), "Partículas vivas como mucho (potencia de dos; al arrancar)");
+static CVarBool cvParticleSort("fx.particleSort", false, "Ordena las partículas de atrás adelante (mezcla alfa; el coste crece con fx.particleCapacity)");
+static CVarInt cvParticleDemo("fx.particleDemo", 0, "Partículas por segundo de un emisor de prueba en el origen (0 = ninguno)");
+static CVarBool cvTerrain("r.terrain", true, "Terreno con clipmaps en lugar del plano del editor (al arrancar)");
+static CVarBool cvTerrainTessellation("r.terrainTessellation", false, "Teselado del terreno por tamaño en pantalla (nivel 11_0)");
+static CVarInt cvTerrainLevels("r.terrainLevels", 8, "Niveles del clipmap del terreno (cada uno duplica el alcance)");
+static CVarBool cvScatter("r.scatter", true, "Hierba y piedras generadas en GPU sobre el terreno (al arrancar, nivel 11_0)");
+static CVarFloat cvScatterDensity("r.scatterDensity", 1.0f, "Multiplicador de la densidad de hierba y piedras (0 = ninguna)");
+static CVarBool cvAnimUpdateLOD("anim.updateLOD", true, "Ritmo de animación por tamaño en pantalla y poses congeladas fuera de la vista");
+static CVarFloat cvAnimFullRateSize("anim.fullRateSize", 0.2f, "Tamaño en pantalla desde el que un personaje se evalúa cada paso");
+static CVarInt cvAnimMaxInterval("anim.maxInterval", 4, "Pasos entre evaluaciones de los personajes más pequeños (interpolados entre medias)");
+static CVarInt cvCpuWorkers("cpu.workers", 0, "Workers del JobSystem además del principal (0 = según cpu.workersPerCore; al arrancar)");
+static CVarBool cvCpuWorkersPerCore("cpu.workersPerCore", true, "Sin cpu.workers, un worker por núcleo físico y no por hilo lógico (al arrancar)");
+static CVarBool cvCpuPinPerformance("cpu.pinPerformance", true, "En CPU híbrida, hilo principal y de render solo en P-cores (al arrancar)");
+static CVarBool cvCpuBackgroundEfficiency("cpu.backgroundEfficiency", true, "En CPU híbrida, carga y decodificación en segundo plano solo en E-cores (al arrancar)");
+static CVarBool cvCpuPriorities("cpu.priorities", true, "Principal y render con prioridad alta; segundo plano, baja (al arrancar)");
+
 /**
  * @brief Inicializa todos los subsistemas gráficos y la escena.
  *
@@ -34,11 +152,15 @@ static const float kClear[4] = { 0.0f, 0.125f, 0.30f, 1.0f };
  *  - BackBuffer y su RenderTargetView.
  *  - DepthStencil (textura + vista) con sample count = 1 (igual al swap chain).
  *  - Viewport.
- *  - Shaders (.fx) e InputLayout (POSITION, TEXCOORD).
+ *  - Shaders (.fx) e InputLayout (POSITION, TEXCOORD) según el `VertexFormat` activo.
  *  - Constant buffers de cámara (b0 y b1).
  *  - Escena: carga modelo FBX (Martis Ashura King) + plano de referencia con textura.
  *  - Inicialización de ImGui.
  *
+ * Tras el swap chain, el resto va como grafo de tareas (`StartupGraph`): los shaders de
+ * cada sistema se compilan en paralelo en el `JobSystem` y la ventana muestra un frame
+ * de carga; el arranque dura la cadena más larga, no la suma de los pasos.
+ *
  * @return HRESULT Código de resultado:
  *  - @c S_OK en caso de éxito.
  *  - Código de error DirectX/Win32 en caso de fallo.
@@ -47,477 +169,3572 @@ HRESULT BaseApp::init()
 {
     HRESULT hr = S_OK;
 
-    // 1) SwapChain + Device + Context + BackBuffer (sin MSAA para evitar mismatches)
-    hr = m_swapChain.init(m_device, m_deviceContext, m_backBuffer, m_window);
+    // 0) Hilos de trabajo (uno por núcleo, el principal incluido) para los sistemas del motor.
+    //    Antes, la política de núcleos: cada hilo la aplica al arrancar (ver CpuTopology).
+    CpuTopology& topology = CpuTopology::getDefault();
+    CpuTopology::Policy cpuPolicy;
+    cpuPolicy.pinPerformance = cvCpuPinPerformance.get();
+    cpuPolicy.backgroundEfficiency = cvCpuBackgroundEfficiency.get();
+    cpuPolicy.priorities = cvCpuPriorities.get();
+    topology.setPolicy(cpuPolicy);
+    topology.applyToCurrentThread(CpuTopology::THREAD_ROLE_MAIN);
+    const unsigned int workers = cvCpuWorkers.get() > 0 ? static_cast<unsigned int>(cvCpuWorkers.get()) :
+        topology.getWorkerCount(cvCpuWorkersPerCore.get());
+    hr = JobSystem::getDefault().init(workers);
     if (FAILED(hr)) {
-        ERROR("Main", "InitDevice", ("Failed to initialize SwapChain. hr=" + std::to_string(hr)).c_str());
+        ERROR("Main", "InitDevice", ("Failed to initialize job system. hr=" + std::to_string(hr)).c_str());
         return hr;
     }
 
-    // 2) RenderTargetView sobre el backbuffer
-    hr = m_renderTargetView.init(m_device, m_backBuffer, DXGI_FORMAT_R8G8B8A8_UNORM);
-    if (FAILED(hr)) {
-        ERROR("Main", "InitDevice", ("Failed to initialize RenderTargetView. hr=" + std::to_string(hr)).c_str());
-        return hr;
+    // 1) SwapChain + Device + Context + BackBuffer (sin MSAA para evitar mismatches)
+    //    Flip model, 2 buffers y un solo frame en vuelo: mínima latencia entrada-pantalla.
+    SwapChain::PresentConfig presentConfig;
+    presentConfig.bufferCount = 2;
+    presentConfig.maxFrameLatency = 1;
+    SwapChain::DeviceConfig deviceConfig;
+    deviceConfig.adapter = m_adapter;
+    deviceConfig.warp = m_warp;
+    {
+        StartupTimeline::Scope timelineScope("Device", "SwapChain::init");
+        if (m_headless) {
+            hr = m_swapChain.initHeadless(m_device, m_deviceContext, m_backBuffer,
+                m_window.m_width, m_window.m_height, kHeadlessFrameLatency, deviceConfig);
+        }
+        else {
+            hr = m_swapChain.init(m_device, m_deviceContext, m_backBuffer, m_window, presentConfig, deviceConfig);
+        }
     }
-
-    // 3) DepthStencil (textura + view) con sampleCount=1 (igual al swapchain)
-    hr = m_depthStencil.init(
-        m_device,
-        m_window.m_width,
-        m_window.m_height,
-        DXGI_FORMAT_D24_UNORM_S8_UINT,
-        D3D11_BIND_DEPTH_STENCIL,
-        1,      // <- IMPORTANTE: igual que swap chain
-        0
-    );
     if (FAILED(hr)) {
-        ERROR("Main", "InitDevice", ("Failed to initialize DepthStencil texture. hr=" + std::to_string(hr)).c_str());
+        ERROR("Main", "InitDevice", ("Failed to initialize SwapChain. hr=" + std::to_string(hr)).c_str());
         return hr;
     }
+    m_deviceContext.init(); // Marcadores de eventos para PIX/RenderDoc.
 
-    hr = m_depthStencilView.init(m_device, m_depthStencil, DXGI_FORMAT_D24_UNORM_S8_UINT);
-    if (FAILED(hr)) {
-        ERROR("Main", "InitDevice", ("Failed to initialize DepthStencilView. hr=" + std::to_string(hr)).c_str());
-        return hr;
-    }
+    // 1b) Nivel de calidad (Scalability): con el dispositivo ya creado y antes del shadow
+    //     map y del streaming de texturas, que leen sus cvars al iniciarse.
+    applyScalability();
 
-    // 4) Viewport
-    hr = m_viewport.init(m_window);
+    // 2-4) Recursos que dependen del tamaño: RTV, depth buffer, Hi-Z y viewport
+    hr = initSizeDependent();
     if (FAILED(hr)) {
-        ERROR("Main", "InitDevice", ("Failed to initialize Viewport. hr=" + std::to_string(hr)).c_str());
         return hr;
     }
 
-    // 5) InputLayout (POSITION, TEXCOORD)
-    std::vector<D3D11_INPUT_ELEMENT_DESC> layout;
-    {
-        D3D11_INPUT_ELEMENT_DESC pos{};
-        pos.SemanticName = "POSITION";
-        pos.SemanticIndex = 0;
-        pos.Format = DXGI_FORMAT_R32G32B32_FLOAT;
-        pos.InputSlot = 0;
-        pos.AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;
-        pos.InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
-        pos.InstanceDataStepRate = 0;
-        layout.push_back(pos);
-
-        D3D11_INPUT_ELEMENT_DESC uv{};
-        uv.SemanticName = "TEXCOORD";
-        uv.SemanticIndex = 0;
-        uv.Format = DXGI_FORMAT_R32G32_FLOAT;
-        uv.InputSlot = 0;
-        uv.AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;
-        uv.InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
-        uv.InstanceDataStepRate = 0;
-        layout.push_back(uv);
-    }
+    // 5) Layouts por streams: slot 0 geometría (formato activo, `-vertexformat`),
+    //    slot 1 datos por instancia, slot 2 capa del array de texturas.
+    const VertexLayout geometry = VertexLayout::geometry(MeshAsset::getVertexFormat());
+    const VertexLayout positions = VertexLayout::positions(MeshAsset::getVertexFormat());
+    std::vector<D3D11_INPUT_ELEMENT_DESC> layout = geometry.getDesc();
+    // Variantes instanciadas: `GPU_DRIVEN` lee un índice (slot 1) en vez de los datos de
+    // la instancia; `TEXTURE_ARRAY` añade la capa (slot 2).
+    const ShaderPermutations::LayoutBuilder instancedLayout = [geometry](ShaderPermutations::Features features) {
+        VertexLayout instanced(geometry);
+        if (features & kVariantGpuDriven) {
+            return instanced.append(VertexLayout::instanceSlot()).getDesc();
+        }
+        instanced.append(VertexLayout::instanceData());
+        if (features & kVariantTextureArray) {
+            instanced.append(VertexLayout::instanceSlice());
+        }
+        return instanced.getDesc();
+    };
 
-    // 6) Shaders (.fx)
-    hr = m_shaderProgram.init(m_device, "Soulpher-Engine.fx", layout);  // <- usa aquí el .fx real en tu bin
-    if (FAILED(hr)) {
-        ERROR("Main", "InitDevice", ("Failed to initialize ShaderProgram. hr=" + std::to_string(hr)).c_str());
-        return hr;
-    }
+    // Del 6) al 12) es un grafo (ver StartupGraph): los shaders de cada sistema se compilan
+    // en los workers a la vez, mientras el hilo principal crea cargadores y escena y
+    // presenta el frame de carga. Las tareas sin `TASK_MAIN_THREAD` solo usan `m_device`.
+    StartupGraph startup;
+    ShaderProgram* instancedProgram = nullptr;
+    ShaderProgram* receiverInstanced = nullptr;
 
-    // 7) Constant Buffers (cámara)
-    hr = m_neverChanges.init(m_device, sizeof(CBNeverChanges));
-    if (FAILED(hr)) {
-        ERROR("Main", "InitDevice", ("Failed to create CB NeverChanges. hr=" + std::to_string(hr)).c_str());
-        return hr;
-    }
-    hr = m_changeOnResize.init(m_device, sizeof(CBChangeOnResize));
-    if (FAILED(hr)) {
-        ERROR("Main", "InitDevice", ("Failed to create CB ChangeOnResize. hr=" + std::to_string(hr)).c_str());
-        return hr;
-    }
+    // 6) Shaders (.fx)
+    const StartupGraph::Task sceneShader = startup.add("Scene shader", [&]() {
+        HRESULT hrTask = m_shaderProgram.init(m_device, "Soulpher-Engine.fx", layout);  // <- usa aquí el .fx real en tu bin
+        if (FAILED(hrTask)) {
+            ERROR("Main", "InitDevice", ("Failed to initialize ShaderProgram. hr=" + std::to_string(hrTask)).c_str());
+        }
+        return hrTask;
+    });
+
+    // 6b) Programa de instancing: geometría + stream por instancia en el slot 1
+    //     (CBChangesEveryFrame: 4 filas de mundo + color). Es opcional: si falla,
+    //     la cola dibuja cada paquete por separado. El resto de variantes se compila
+    //     al pedirlas (o aquí mismo en Release, con la lista de precompilación).
+    const StartupGraph::Task instancing = startup.add("Instancing shaders", [&]() {
+        m_instancingVariants.init(m_device, "Instancing.fx", kInstancingKeywords, instancedLayout);
+        m_receiverInstancingVariants.init(m_device, "ShadowReceiverInstanced.fx", kInstancingKeywords, instancedLayout);
+#if !defined( DEBUG ) && !defined( _DEBUG )
+        m_instancingVariants.precompile(kShaderVariantList);
+#endif
+        instancedProgram = m_instancingVariants.get(0);
+        if (!instancedProgram) {
+            ERROR("Main", "InitDevice", "Instancing.fx not available, instancing disabled.");
+        }
 
-    // 8) Matrices de cámara (vista/proyección)
-    {
-        XMVECTOR Eye = XMVectorSet(0.0f, 3.0f, -6.0f, 0.0f);
-        XMVECTOR At = XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f);
-        XMVECTOR Up = XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f);
+        // 6b') Pool de arrays para la variante `TEXTURE_ARRAY` (la capa de cada instancia
+        //      llega por el slot 2); el shader se compila al activarlos en el Profile.
+        if (instancedProgram && FAILED(m_textureArrays.init(m_device))) {
+            ERROR("Main", "InitDevice", "Texture array pool not available, texture arrays disabled.");
+        }
+        return S_OK;
+    });
+
+    // 6c) Pre-pase de profundidad: solo el stream de posiciones (compacto del MeshAsset)
+    //     y sin pixel shader. Opcional: si algo falla se dibuja sin pre-pase.
+    const StartupGraph::Task depth = startup.add("Depth shaders", [&]() {
+        HRESULT hrDepth = m_depthProgram.initVertexOnly(m_device, "DepthOnly.fx", positions.getDesc());
+
+        // Los lotes instanciados necesitan su propia variante (mundo por instancia, slot 1).
+        bool instancedOk = true;
+        if (SUCCEEDED(hrDepth) && instancedProgram) {
+            instancedOk = SUCCEEDED(m_depthInstancedProgram.initVertexOnly(m_device, "DepthOnlyInstanced.fx",
+                VertexLayout(positions).append(VertexLayout::instanceWorld()).getDesc()));
+        }
 
-        m_View = XMMatrixLookAtLH(Eye, At, Up);
-        cbNeverChanges.mView = XMMatrixTranspose(m_View);
+        if (SUCCEEDED(hrDepth) && instancedOk &&
+            SUCCEEDED(m_depthEqualState.init(m_device, true, false, false, D3D11_COMPARISON_EQUAL))) {
+            m_renderQueue.setDepthPrograms(&m_depthProgram,
+                m_depthInstancedProgram.m_VertexShader ? &m_depthInstancedProgram : nullptr);
+        }
+        else {
+            ERROR("Main", "InitDevice", "Depth pre-pass shaders not available, pre-pass disabled.");
+            m_depthPrepass = false;
+        }
+        return S_OK;
+    }, { instancing });
+
+    // 6d) Shadow map: los casters se dibujan con los programas de profundidad anteriores
+    //     y los receptores con ShadowReceiver*.fx. Opcional: si algo falla, sin sombras.
+    const StartupGraph::Task shadows = startup.add("Shadow map", [&]() {
+        HRESULT hrShadow = m_renderQueue.hasDepthPrograms() ? S_OK : E_FAIL;
+        if (SUCCEEDED(hrShadow)) {
+            hrShadow = m_receiverProgram.init(m_device, "ShadowReceiver.fx", layout);
+        }
+        // Con instancing activo, los lotes receptores necesitan su variante.
+        if (SUCCEEDED(hrShadow) && instancedProgram) {
+#if !defined( DEBUG ) && !defined( _DEBUG )
+            m_receiverInstancingVariants.precompile(kShaderVariantList);
+#endif
+            receiverInstanced = m_receiverInstancingVariants.get(0);
+            hrShadow = receiverInstanced ? S_OK : E_FAIL;
+        }
+        if (SUCCEEDED(hrShadow)) {
+            hrShadow = m_shadowMap.init(m_device, static_cast<unsigned int>(std::clamp(cvShadowMapSize.get(), 256, 8192)));
+        }
 
-        m_Projection = XMMatrixPerspectiveFovLH(
-            XM_PIDIV4,
-            m_window.m_width / (FLOAT)m_window.m_height,
-            0.01f, 100.0f
-        );
-        cbChangesOnResize.mProjection = XMMatrixTranspose(m_Projection);
-    }
+        if (SUCCEEDED(hrShadow)) {
+            m_renderQueue.setShadowReceiverPrograms(&m_receiverProgram, receiverInstanced);
+
+            for (RenderQueue& queue : m_shadowQueues) {
+                queue.init(m_device, 256);
+                queue.setActorCost(&m_actorCost, true);
+                queue.setDepthPrograms(&m_depthProgram,
+                    m_depthInstancedProgram.m_VertexShader ? &m_depthInstancedProgram : nullptr);
+                queue.setDepthRasterizer(&m_shadowMap.getRasterizer());
+                // Solo agrupa en lotes si hay variante instanciada de profundidad.
+                if (m_depthInstancedProgram.m_VertexShader) {
+                    queue.setInstancingProgram(&m_depthInstancedProgram);
+                }
+            }
+        }
+        else {
+            ERROR("Main", "InitDevice", "Shadow map not available, shadows disabled.");
+            m_shadowMap.destroy();
+        }
+        return S_OK;
+    }, { depth });
+
+    // 6e) Luces locales por clusters (t4-t6, b5 de los .fx que sombrean). Opcional: sin
+    //     compute shaders b5 queda sin enlazar, se lee a cero y no se suma ninguna luz.
+    startup.add("Clustered lighting", [&]() {
+        if (FAILED(m_clusteredLighting.init(m_device))) {
+            MESSAGE("Main", "InitDevice", "Clustered lighting unavailable.");
+        }
+        return S_OK;
+    });
+    // 6f) Camino diferido (`r.deferred`): usa las luces y b5 de 6e). Sin él, solo forward.
+    startup.add("Deferred shading", [&]() {
+        if (FAILED(m_deferredShading.init(m_device))) {
+            MESSAGE("Main", "InitDevice", "Deferred shading unavailable.");
+        }
+        return S_OK;
+    });
+    // 6g) Post-proceso HDR (`r.hdr`, b6). Sin él la escena va directa al back buffer.
+    startup.add("Post-processing", [&]() {
+        if (FAILED(m_postProcess.init(m_device))) {
+            MESSAGE("Main", "InitDevice", "HDR post-processing unavailable.");
+        }
+        return S_OK;
+    });
+    // 6h) Resolución dinámica (`r.dynamicResolution`). Sin ella, escena a tamaño de ventana.
+    startup.add("Dynamic resolution", [&]() {
+        if (FAILED(m_dynamicResolution.init(m_device))) {
+            MESSAGE("Main", "InitDevice", "Dynamic resolution unavailable.");
+        }
+        return S_OK;
+    });
+    // 6i) MSAA de la escena (`r.msaa`); el modo se elige cada frame con `configure`.
+    startup.add("MSAA", [&]() {
+        if (FAILED(m_multisampling.init(m_device))) {
+            MESSAGE("Main", "InitDevice", "MSAA unavailable.");
+        }
+        return S_OK;
+    });
+    // 6j) Actores con lightmap: geometría + UV2 (slot 3). Sin él, todo en tiempo real.
+    const StartupGraph::Task lightmaps = startup.add("Lightmap shader", [&]() {
+        if (SUCCEEDED(m_lightmapProgram.init(m_device, "Lightmapped.fx",
+            VertexLayout(geometry).append(VertexLayout::lightmapUV()).getDesc()))) {
+            m_renderQueue.setLightmapProgram(&m_lightmapProgram);
+        }
+        else {
+            MESSAGE("Main", "InitDevice", "Lightmaps unavailable.");
+        }
+        return S_OK;
+    });
+    // 6k) Sondas de reflexión (t8, b10, s2 de los .fx que sombrean). Sin ellas, sin reflejos.
+    const StartupGraph::Task probes = startup.add("Reflection probes", [&]() {
+        if (SUCCEEDED(m_reflectionProbes.init(m_device))) {
+            CreateDirectoryA(kProbeCachePath, nullptr);
+            m_reflectionProbes.setCachePath(kProbeCachePath);
+        }
+        else {
+            MESSAGE("Main", "InitDevice", "Reflection probes unavailable.");
+        }
+        return S_OK;
+    });
+
+    // 7-8) Constant Buffers (cámara) y cámara orbital del editor (vista/proyección)
+    startup.add("Camera", [&]() {
+        HRESULT hrTask = m_neverChanges.init(m_device);
+        if (FAILED(hrTask)) {
+            ERROR("Main", "InitDevice", ("Failed to create CB NeverChanges. hr=" + std::to_string(hrTask)).c_str());
+            return hrTask;
+        }
+        hrTask = m_changeOnResize.init(m_device);
+        if (FAILED(hrTask)) {
+            ERROR("Main", "InitDevice", ("Failed to create CB ChangeOnResize. hr=" + std::to_string(hrTask)).c_str());
+            return hrTask;
+        }
 
-    // 9) Actor: Martis Ashura King (FBX)
-    {
-        auto martis = EU::MakeShared<Actor>(m_device);
-        if (martis.isNull()) {
-            ERROR("Main", "InitDevice", "Failed to create Martis Actor.");
-            return E_FAIL;
+        m_camera.setOrbit(XMFLOAT3(0.0f, -5.0f, 0.0f), 0.0f, 15.0f, 10.0f);
+        cbNeverChanges.mView = XMMatrixTranspose(m_camera.getView());
+        m_neverChanges.set(cbNeverChanges);
+
+        updateProjection();
+        return S_OK;
+    }, {}, StartupGraph::TASK_MAIN_THREAD);
+
+    // 8b) Cargador de texturas: los actores arrancan con un placeholder y los hilos
+    //     de trabajo leen y decodifican los archivos mientras la app ya dibuja.
+    const StartupGraph::Task loaders = startup.add("Loaders", [&]() {
+        HRESULT hrTask = m_textureLoader.init(m_device);
+        if (FAILED(hrTask)) {
+            ERROR("Main", "InitDevice", ("Failed to initialize texture loader. hr=" + std::to_string(hrTask)).c_str());
+            return hrTask;
         }
 
-        // FBX (ruta relativa a /bin)
-        const std::string kFBX =
-            "ModelsFBX\\martis-ashura-king\\Martis\\hero_asura.fbx";
+        // 8b'') Presupuesto de vídeo del sistema: limita también el streaming de texturas.
+        m_gpuMemory.init(m_device);
+        applyTextureBudget();
+
+        // 8b''') Recarga en caliente de los .fx (directorio de trabajo). Sin ella el motor
+        //        sigue funcionando: solo hay que reiniciar para ver los cambios.
+        m_shaderReload.init(m_device);
 
-        if (!m_modelLoader.LoadFBXModel(kFBX) || m_modelLoader.meshes.empty()) {
-            ERROR("Main", "InitDevice", ("Failed to load FBX: " + kFBX).c_str());
-            return E_FAIL;
+        // 8b') Capturas de pantalla (readback asíncrono + PNG en su hilo)
+        hrTask = m_screenshot.init(m_device);
+        if (SUCCEEDED(hrTask)) {
+            hrTask = m_frameCapture.init(m_device);
+        }
+        if (FAILED(hrTask)) {
+            ERROR("Main", "InitDevice", ("Failed to initialize screenshots. hr=" + std::to_string(hrTask)).c_str());
+            return hrTask;
         }
 
-        // Malla(s)
-        martis->setMesh(m_device, m_modelLoader.meshes);
+        // 8c) Subidas diferidas: quien encole datos (cualquier hilo) los ve copiados
+        //     poco a poco, sin picos ni esperas en el contexto inmediato.
+        hrTask = m_uploads.init(m_device);
+        if (FAILED(hrTask)) {
+            ERROR("Main", "InitDevice", ("Failed to initialize upload scheduler. hr=" + std::to_string(hrTask)).c_str());
+            return hrTask;
+        }
 
-        // Textura difusa principal (PNG). Intentamos axl_D y, si falla, axl_wq_D.
-        Texture diffuse;
-        HRESULT th = diffuse.init(
-            m_device,
-            "ModelsFBX\\martis-ashura-king\\Martis\\axl_D",
-            PNG);
+        // 8d) Pool de geometría: las mallas de la biblioteca comparten un VB/IB.
+        hrTask = m_meshLibrary.init(m_device, m_deviceContext);
+        if (FAILED(hrTask)) {
+            ERROR("Main", "InitDevice", ("Failed to initialize geometry pool. hr=" + std::to_string(hrTask)).c_str());
+            return hrTask;
+        }
 
-        if (FAILED(th)) {
-            th = diffuse.init(
-                m_device,
-                "ModelsFBX\\martis-ashura-king\\Martis\\axl_wq_D",
-                PNG);
+        // 8d') Materiales: estados compartidos y el material por defecto (b4 de los draws sin material).
+        hrTask = m_materials.init(m_device);
+        if (FAILED(hrTask)) {
+            ERROR("Main", "InitDevice", ("Failed to initialize material library. hr=" + std::to_string(hrTask)).c_str());
+            return hrTask;
         }
 
-        std::vector<Texture> mats;
-        if (SUCCEEDED(th)) {
-            mats.push_back(diffuse);
+        // 8d'-bis) Cargas asíncronas: mallas, texturas y materiales como futuros (ver ResourceManager).
+        hrTask = m_resources.init(m_device, m_meshLibrary, m_materials, m_textureLoader);
+        if (FAILED(hrTask)) {
+            ERROR("Main", "InitDevice", ("Failed to initialize resource manager. hr=" + std::to_string(hrTask)).c_str());
+            return hrTask;
         }
-        else {
-            // Fallback a textura por defecto si existe
-            Texture fallback;
-            if (SUCCEEDED(fallback.init(m_device, "Textures\\Default", DDS)) ||
-                SUCCEEDED(fallback.init(m_device, "Textures\\Default", PNG))) {
-                mats.push_back(fallback);
-            }
-            else {
-                ERROR("Main", "InitDevice", "No diffuse texture found for Martis.");
-            }
+        // Recarga en caliente de modelos y texturas (opcional, como la de shaders).
+        m_assetReload.init(m_device, m_resources, m_meshLibrary, m_textureLoader);
+        return S_OK;
+    }, {}, StartupGraph::TASK_MAIN_THREAD);
+
+    // 8d'') Occlusion queries predicadas para los actores marcados en el Inspector.
+    //      Opcional: sin ellas esos actores van por la cola como los demás.
+    startup.add("Occlusion predicates", [&]() {
+        if (FAILED(m_occlusionPredicates.init(m_device))) {
+            ERROR("Main", "InitDevice", "Occlusion predicates not available, flagged actors use the render queue.");
+        }
+        return S_OK;
+    });
+
+    // Picking con el ratón (stream de posiciones, como el pre-pase).
+    // Opcional: sin él se selecciona solo desde el outliner.
+    startup.add("GPU picking", [&]() {
+        if (FAILED(m_picking.init(m_device, positions.getDesc()))) {
+            ERROR("Main", "InitDevice", "GPU picking not available, select actors from the outliner.");
         }
-        martis->setTextures(mats);
+        return S_OK;
+    });
 
-        // Transform (FBX suele venir en cm; escala típica)
-        martis->getComponent<Transform>()->setTransform(
-            EU::Vector3(-0.50f, -5.00f, 0.00f), // Position
-            EU::Vector3(-1.50f, 0.00f, 0.00f), // Rotation (grados)
-            EU::Vector3(5.00f, 5.00f, 5.00f)  // Scale
-        );
-        martis->setCastShadow(false);
+    // 8d''') Impostores de los actores con distancia de impostor (atlas horneados al usarse).
+    startup.add("Impostors", [&]() {
+        if (FAILED(m_impostors.init(m_device, layout))) {
+            ERROR("Main", "InitDevice", "Impostors not available, distant actors keep their meshes.");
+        }
+        return S_OK;
+    });
 
-        m_actors.push_back(martis);
-    }
+    // Sprites del HUD. Opcional: sin ellos el juego no tiene HUD propio.
+    startup.add("Sprites", [&]() {
+        if (FAILED(m_sprites.init(m_device))) {
+            ERROR("Main", "InitDevice", "Sprite batch not available, HUD sprites are dropped.");
+        }
+        return S_OK;
+    });
 
-    // 10) ACTOR: Plano simple (suelo con piedra.jpg)
-    {
-        const float kSize = 20.0f; // mitad del tamaño (=> 40x40)
-        const float kTiling = 6.0f;  // repetición UV
+    // Terreno (`r.terrain`). Opcional: si falla, el editor vuelve al plano.
+    const StartupGraph::Task terrain = startup.add("Terrain", [&]() {
+        if (cvTerrain.get() && FAILED(m_terrain.init(m_device))) {
+            ERROR("Main", "InitDevice", "Terrain not available, using the ground plane.");
+        }
+        return S_OK;
+    });
 
-        m_APlane = EU::MakeShared<Actor>(m_device);
-        if (m_APlane.isNull()) {
-            ERROR("Main", "InitDevice", "Failed to create Plane Actor.");
-            return E_FAIL;
+    // Vegetación del terreno (`r.scatter`). Opcional: sin ella el terreno va desnudo.
+    const StartupGraph::Task scatter = startup.add("Terrain scatter", [&]() {
+        if (cvTerrain.get() && cvScatter.get() && FAILED(m_scatter.init(m_device))) {
+            ERROR("Main", "InitDevice", "Terrain scatter not available, the terrain is drawn bare.");
+        }
+        return S_OK;
+    });
+
+    // Partículas en GPU. Opcional (y solo con 11_0): sin ellas los emisores no sueltan nada.
+    startup.add("GPU particles", [&]() {
+        const unsigned int capacity = static_cast<unsigned int>((std::max)(cvParticleCapacity.get(), 1));
+        if (FAILED(m_particles.init(m_device, capacity))) {
+            ERROR("Main", "InitDevice", "GPU particles not available, emitters are ignored.");
+        }
+        return S_OK;
+    });
+
+#if defined(PROFILE)
+    // Dibujo de depuración (`DebugDraw`). Opcional: sin él lo grabado se descarta.
+    startup.add("Debug draw", [&]() {
+        if (FAILED(m_debugDraw.init(m_device))) {
+            ERROR("Main", "InitDevice", "Debug draw not available.");
         }
+        return S_OK;
+    });
+#endif
+
+    // 8e) Camino GPU-driven (`-gpudriven 1`): las mallas del pool se cullean en un
+    //     compute shader y se dibujan con draws indirectos. Opcional: si falla, cola normal.
+    if (m_gpuDriven) {
+        startup.add("GPU-driven path", [&]() {
+            ShaderProgram* program = m_instancingVariants.get(kVariantGpuDriven);
+            HRESULT hrGpu = program ? S_OK : E_FAIL;
+            // Sin shadow map, los receptores se dibujan como el resto (igual que en la cola).
+            ShaderProgram* receiver = program;
+            if (SUCCEEDED(hrGpu) && m_shadowMap.isEnabled()) {
+                receiver = m_receiverInstancingVariants.get(kVariantGpuDriven);
+                hrGpu = receiver ? S_OK : E_FAIL;
+            }
+            if (SUCCEEDED(hrGpu)) {
+                hrGpu = m_gpuCulling.init(m_device, m_meshLibrary.getGeometryPool(), program, receiver);
+                m_gpuCulling.setDefaultMaterial(m_materials.getDefault());
+            }
+            if (FAILED(hrGpu)) {
+                ERROR("Main", "InitDevice", "GPU-driven path not available, using the render queue.");
+                m_gpuCulling.destroy();
+                m_gpuDriven = false;
+            }
+            return S_OK;
+        }, { instancing, shadows, loaders });
+    }
 
-        // Malla del plano (UVs preparados para tiling)
-        SimpleVertex planeVertices[] =
-        {
-            { XMFLOAT3(-kSize, 0.0f, -kSize), XMFLOAT2(0.0f,    0.0f) },
-            { XMFLOAT3(kSize, 0.0f, -kSize), XMFLOAT2(kTiling, 0.0f) },
-            { XMFLOAT3(kSize, 0.0f,  kSize), XMFLOAT2(kTiling, kTiling) },
-            { XMFLOAT3(-kSize, 0.0f,  kSize), XMFLOAT2(0.0f,    kTiling) },
-        };
-        WORD planeIndices[] = { 0,2,1, 0,3,2 };
-
-        planeMesh.m_vertex.assign(std::begin(planeVertices), std::end(planeVertices));
-        planeMesh.m_index.assign(std::begin(planeIndices), std::end(planeIndices));
-        planeMesh.m_numVertex = 4;
-        planeMesh.m_numIndex = 6;
-
-        std::vector<MeshComponent> planeMeshes{ planeMesh };
-        m_APlane->setMesh(m_device, planeMeshes);
-
-        // Textura del piso: ModelsFBX\martis-ashura-king\Martis\piedra.jpg (con fallback a .png / Default)
-        HRESULT hrTx = m_PlaneTexture.init(
-            m_device,
-            "ModelsFBX\\martis-ashura-king\\Martis\\piedra",
-            JPG
-        );
-        if (FAILED(hrTx)) {
-            hrTx = m_PlaneTexture.init(m_device, "ModelsFBX\\martis-ashura-king\\Martis\\piedra", PNG);
+    // 8f-10) Escena: guardada, por celdas o la del editor (Martis y el suelo). Las mallas
+    //        y texturas ya se cargan en segundo plano (ResourceManager): aquí solo se piden.
+    startup.add("Scene", [&]() {
+        // 8f) Escena guardada (`-scene`): sustituye a Martis y al suelo. Si aún no existe se
+        //     arranca con la del editor y "File > Save" la crea.
+        bool sceneLoaded = false;
+        if (!m_scenePath.empty()) {
+            const HRESULT hrScene = loadScene(m_scenePath);
+            sceneLoaded = SUCCEEDED(hrScene);
+            if (hrScene == HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND)) {
+                MESSAGE("Main", "InitDevice", (m_scenePath + " not found, starting from the default scene.").c_str());
+            }
+            else if (FAILED(hrScene)) {
+                ERROR("Main", "InitDevice", ("Failed to load " + m_scenePath + ", starting from the default scene.").c_str());
+            }
         }
-        if (FAILED(hrTx)) {
-            if (FAILED(m_PlaneTexture.init(m_device, "Textures\\Default", DDS)))
-                m_PlaneTexture.init(m_device, "Textures\\Default", PNG);
+        // 8f') Nivel por celdas (`-stream`): se cargan alrededor de la cámara en `update`.
+        if (!m_streamPath.empty()) {
+            WorldStreamer::Settings settings;
+            settings.budgetBytes = m_streamBudget;
+            const HRESULT hrStream = m_streamer.init(m_device, m_resources,
+                [this](const std::string& name) { return resolveSceneMesh(name); },
+                { SceneComponent::of<Spin>("Spin") }, m_streamPath, settings);
+            if (SUCCEEDED(hrStream)) {
+                sceneLoaded = true;
+            }
+            else {
+                ERROR("Main", "InitDevice", ("Cannot stream " + m_streamPath + " (no level.sstream?).").c_str());
+            }
         }
 
-        std::vector<Texture> planeTextures{ m_PlaneTexture };
-        m_APlane->setTextures(planeTextures);
+        // 9) Actor: Martis Ashura King (FBX)
+        if (!sceneLoaded) {
+            ActorHandle martis = ActorPool::getDefault().spawn(m_device);
+            if (martis.isNull()) {
+                ERROR("Main", "InitDevice", "Failed to create Martis Actor.");
+                return E_FAIL;
+            }
+            // En la escena desde ya: si algo falla después, `destroy` lo devuelve al pool.
+            m_actors.push_back(martis);
+
+            // FBX (ruta relativa a /bin); `--benchmark <escena>` puede sustituirlo.
+            const std::string kFBX = m_sceneModel.empty()
+                ? "ModelsFBX\\martis-ashura-king\\Martis\\hero_asura.fbx"
+                : m_sceneModel;
+
+            // Textura difusa principal (PNG): axl_D, axl_wq_D y, si no, la textura por defecto.
+            std::vector<AsyncTextureLoader::Source> diffuse;
+            if (m_sceneModel.empty()) {
+                diffuse.push_back({ "ModelsFBX\\martis-ashura-king\\Martis\\axl_D", PNG });
+                diffuse.push_back({ "ModelsFBX\\martis-ashura-king\\Martis\\axl_wq_D", PNG });
+            }
+            diffuse.push_back({ "Textures\\Default", DDS });
+            diffuse.push_back({ "Textures\\Default", PNG });
+            // Corrutina: arranca las cargas y vuelve; el actor recibe malla y material al publicarse.
+            loadSceneModel(martis, kFBX, diffuse);
+
+            // Transform (FBX suele venir en cm; escala típica)
+            martis->getComponent<Transform>()->setTransform(
+                EU::Vector3(-0.50f, -5.00f, 0.00f), // Position
+                EU::Vector3(-1.50f, 0.00f, 0.00f), // Rotation (radianes)
+                EU::Vector3(5.00f, 5.00f, 5.00f)  // Scale
+            );
+            martis->setCastShadow(true);
+        }
 
-        // Coloca el suelo a Y = -5 (donde tienes al personaje)
-        m_APlane->getComponent<Transform>()->setTransform(
-            EU::Vector3(0.0f, -5.0f, 0.0f),   // posición
-            EU::Vector3(0.0f, 0.0f, 0.0f),   // rotación
-            EU::Vector3(1.0f, 1.0f, 1.0f)    // escala
+        // 10) Suelo: el terreno con piedra.jpg repetida y las alturas de
+        //     Textures\Terrain\Height.dds (hasta que llegue, o si no existe, el mapa
+        //     procedural). Una escena que trae el plano ("Ground") se queda con el suyo.
+        if (m_terrain.isReady() && !m_sceneUsesGround) {
+            m_terrain.setTextures(m_textureLoader.load("Textures\\Terrain\\Height", DDS),
+                m_textureLoader.load({
+                    { "ModelsFBX\\martis-ashura-king\\Martis\\piedra", JPG },
+                    { "ModelsFBX\\martis-ashura-king\\Martis\\piedra", PNG },
+                    { "Textures\\Default", DDS },
+                    { "Textures\\Default", PNG } }));
+            m_terrain.setEnabled(true);
+            m_scatter.setEnabled(true);
+        }
+        // 10') ACTOR: Plano simple (suelo con piedra.jpg), sin terreno
+        else if (!sceneLoaded) {
+            m_APlane = ActorPool::getDefault().spawn(m_device);
+            if (m_APlane.isNull()) {
+                ERROR("Main", "InitDevice", "Failed to create Plane Actor.");
+                return E_FAIL;
+            }
+            m_actors.push_back(m_APlane);
+
+            m_APlane->setMeshAsset(createGroundMesh());
+
+            // Textura del piso: ModelsFBX\martis-ashura-king\Martis\piedra.jpg (con fallback a .png / Default)
+            ResourceHandle<Texture> planeTexture = m_resources.loadTexture({
+                { "ModelsFBX\\martis-ashura-king\\Martis\\piedra", JPG },
+                { "ModelsFBX\\martis-ashura-king\\Martis\\piedra", PNG },
+                { "Textures\\Default", DDS },
+                { "Textures\\Default", PNG } });
+            ActorHandle plane = m_APlane;
+            m_resources.loadMaterial(MaterialDesc(), planeTexture)->then([plane](const MaterialHandle& material) {
+                plane->setMaterials(std::vector<MaterialHandle>{ material });
+            });
+
+            // Coloca el suelo a Y = -5 (donde tienes al personaje)
+            m_APlane->getComponent<Transform>()->setTransform(
+                EU::Vector3(0.0f, -5.0f, 0.0f),   // posición
+                EU::Vector3(0.0f, 0.0f, 0.0f),   // rotación
+                EU::Vector3(1.0f, 1.0f, 1.0f)    // escala
+            );
+
+            m_APlane->setCastShadow(false);
+            m_APlane->setReceiveShadow(true);
+            m_APlane->setStatic(true);
+        }
+        return S_OK;
+    }, { loaders, terrain, scatter }, StartupGraph::TASK_MAIN_THREAD);
+
+    // 11) Cola de render (reserva para escenas con cientos de actores): junta los
+    //     programas de las tareas anteriores.
+    startup.add("Render queues", [&]() {
+        m_renderQueue.init(m_device, 1024);
+        m_renderQueue.setDefaultProgram(&m_shaderProgram);
+        m_renderQueue.setDefaultMaterial(m_materials.getDefault());
+        m_renderQueue.setClusterCulling(&m_frustum); // meshlets contra el frustum del frame (ver "Culling")
+        m_renderQueue.setActorCost(&m_actorCost, false);
+        if (instancedProgram) {
+            m_renderQueue.setInstancingProgram(instancedProgram);
+        }
+        // Caras de las sondas: los mismos programas, sin meshlets contra el frustum de la cámara.
+        m_probeQueue.init(m_device, 256);
+        m_probeQueue.setDefaultProgram(&m_shaderProgram);
+        m_probeQueue.setDefaultMaterial(m_materials.getDefault());
+        if (instancedProgram) {
+            m_probeQueue.setInstancingProgram(instancedProgram);
+        }
+        if (m_shadowMap.isEnabled()) {
+            // La variante de la tarea de sombras: `m_receiverInstancingVariants` puede estar
+            // compilando la de GPU-driven en otro hilo.
+            m_probeQueue.setShadowReceiverPrograms(&m_receiverProgram, receiverInstanced);
+        }
+        if (m_lightmapProgram.m_VertexShader) {
+            m_probeQueue.setLightmapProgram(&m_lightmapProgram);
+        }
+        // Una sonda estática que cubre la escena y una dinámica cerca del personaje.
+        m_reflectionProbes.add(XMFLOAT3(0.0f, -3.0f, 0.0f), 30.0f, true);
+        m_reflectionProbes.add(XMFLOAT3(0.0f, -3.0f, 0.0f), 6.0f, false);
+        // Grabación en contextos diferidos (`-deferred 1`); si falla, todo sigue en el inmediato.
+        if (m_deferredContexts && SUCCEEDED(m_deferredRecorder.init(m_device))) {
+            m_renderQueue.setDeferredRecorder(&m_deferredRecorder);
+            for (RenderQueue& queue : m_shadowQueues) {
+                queue.setDeferredRecorder(&m_deferredRecorder);
+            }
+        }
+        return S_OK;
+    }, { sceneShader, instancing, depth, shadows, lightmaps, probes, loaders }, StartupGraph::TASK_MAIN_THREAD);
+
+    // 12) ImGui (ventana y contexto inmediato)
+    startup.add("ImGui", [&]() {
+        if (m_headless) {
+            m_userInterface.initHeadless();
+            return S_OK;
+        }
+        m_userInterface.init(
+            m_window.m_hWnd,
+            m_device.m_device,
+            m_deviceContext.m_deviceContext
         );
-
-        m_APlane->setCastShadow(false);
-        m_APlane->setReceiveShadow(true);
-
-        m_actors.push_back(m_APlane);
+        return S_OK;
+    }, {}, StartupGraph::TASK_MAIN_THREAD);
+
+    // Mientras los workers compilan, la ventana responde y muestra el frame de carga.
+    // Un WM_SIZE a mitad del arranque se aplica al terminar (ver `resize`).
+    m_starting = true;
+    hr = startup.run([this]() { presentLoadingFrame(); });
+    m_starting = false;
+    if (FAILED(hr)) {
+        return hr;
+    }
+    StartupTimeline::getDefault().setGraphTimes(startup.getWallMs(), startup.getTotalMs(),
+        startup.getCriticalPathMs());
+    RECT client;
+    if (GetClientRect(m_window.m_hWnd, &client)) {
+        resize(static_cast<unsigned int>(client.right - client.left),
+            static_cast<unsigned int>(client.bottom - client.top));
     }
 
-    // 11) Luz
+    // Luz
     m_LightPos = XMFLOAT4(2.0f, 4.0f, -2.0f, 1.0f);
 
-    // 12) ImGui (al final del init gráfico)
-    m_userInterface.init(
-        m_window.m_hWnd,
-        m_device.m_device,
-        m_deviceContext.m_deviceContext
-    );
+    // 13) Reloj y ritmo de frames: se arrancan al final para que el primer delta no
+    //     incluya la carga. Un fallo del timer no es fatal (el limitador gira).
+    m_clock.init();
+    m_frameLimiter.init(kTargetFps);
+    if (FAILED(m_gpuProfiler.init(m_device))) {
+        MESSAGE("Main", "InitDevice", "GPU profiler unavailable.");
+    }
+    m_redrawEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    if (!m_redrawEvent) {
+        ERROR("Main", "InitDevice", "Cannot create redraw event, idle throttling disabled.");
+        m_idleThrottle = false;
+    }
+    m_activeFrames = kIdleSettleFrames; // Dibujar la escena recién cargada.
+    m_textureLoader.setNotifyEvent(m_redrawEvent); // Cada textura cargada despierta al editor.
 
     return S_OK;
 }
 
 /**
- * @brief Actualiza la lógica de la aplicación en cada frame.
+ * @brief Crea los recursos que dependen del tamaño de la ventana.
  *
- * Tareas:
- *  - Avanza el frame de ImGui y muestra paneles (inspector / outliner).
- *  - Gestión de selección de actores.
- *  - Cálculo de tiempo simple.
- *  - Controles de cámara orbital:
- *      - RMB (botón derecho): orbitar yaw/pitch.
- *      - Rueda: zoom.
- *      - MMB (botón medio): pan.
- *  - Recalcula la vista y sube buffers de cámara (b0: View, b1: Projection).
- *  - Llama a update() de todos los actores.
+ * @details Lo usan @ref init y @ref resize; el back buffer ya debe estar en `m_backBuffer`.
  */
-void BaseApp::update()
+HRESULT BaseApp::initSizeDependent()
 {
-    // --- UI frame ---
-    m_userInterface.update();
+    HRESULT hr = S_OK;
+    m_gpuProfiler.setTargetPixelCount(m_window.m_width * m_window.m_height);
 
-    // Inspector + Outliner
-    if (!m_actors.empty())
-    {
-        if (m_userInterface.selectedActorIndex < 0 ||
-            m_userInterface.selectedActorIndex >= (int)m_actors.size())
-        {
-            m_userInterface.selectedActorIndex = 0;
-        }
-        m_userInterface.inspectorGeneral(m_actors[m_userInterface.selectedActorIndex]);
+    // 2) RenderTargetView sobre el backbuffer
+    hr = m_renderTargetView.init(m_device, m_backBuffer, DXGI_FORMAT_R8G8B8A8_UNORM);
+    if (FAILED(hr)) {
+        ERROR("Main", "InitDevice", ("Failed to initialize RenderTargetView. hr=" + std::to_string(hr)).c_str());
+        return hr;
     }
-    m_userInterface.outliner(m_actors);
-
-    // --- Tiempo ---
-    static float t = 0.0f;
-    static DWORD t0 = 0;
-    DWORD tNow = GetTickCount();
-    if (t0 == 0) t0 = tNow;
-    t = (tNow - t0) / 1000.0f;
-
-    // ----------------------------------------------------
-    // CONTROLES DE CÁMARA (RMB orbitar, rueda zoom, MMB pan)
-    // ----------------------------------------------------
-    {
-        ImGuiIO& io = ImGui::GetIO();
-        bool uiCapturaMouse = io.WantCaptureMouse;
-
-        static bool orbitando = false, paneando = false;
-        static POINT ultimo{};
-
-        if (!uiCapturaMouse)
-        {
-            // ORBIT (RMB)
-            if (GetAsyncKeyState(VK_RBUTTON) & 0x8000)
-            {
-                POINT p; GetCursorPos(&p);
-                if (!orbitando) { orbitando = true; ultimo = p; }
-                float dx = float(p.x - ultimo.x);
-                float dy = float(p.y - ultimo.y);
-                m_camYawDeg += dx * 0.25f;
-                m_camPitchDeg -= dy * 0.25f;
-                m_camPitchDeg = std::clamp(m_camPitchDeg, -89.0f, 89.0f);
-                ultimo = p;
-            }
-            else orbitando = false;
-
-            // ZOOM (rueda)
-            if (io.MouseWheel != 0.0f)
-            {
-                m_camDistance *= (io.MouseWheel > 0 ? 0.9f : 1.1f);
-                m_camDistance = std::clamp(m_camDistance, 2.0f, 50.0f);
-            }
-
-            // PAN (MMB)
-            if (GetAsyncKeyState(VK_MBUTTON) & 0x8000)
-            {
-                POINT p; GetCursorPos(&p);
-                if (!paneando) { paneando = true; ultimo = p; }
-                float dx = float(p.x - ultimo.x);
-                float dy = float(p.y - ultimo.y);
-                ultimo = p;
 
-                float yaw = XMConvertToRadians(m_camYawDeg);
-                float pitch = XMConvertToRadians(m_camPitchDeg);
+    // 3) El depth buffer es una textura transitoria del grafo de render (pase "Scene"):
+    //    sale de `m_renderTargetPool` con el tamaño de la ventana la primera vez que se pide.
 
-                XMVECTOR forward = XMVectorSet(sinf(yaw) * cosf(pitch), sinf(pitch),
-                    cosf(yaw) * cosf(pitch), 0);
-                XMVECTOR right = XMVector3Normalize(XMVector3Cross(XMVectorSet(0, 1, 0, 0), forward));
-                XMVECTOR up = XMVectorSet(0, 1, 0, 0);
-
-                float panSpeed = m_camDistance * 0.0025f;
-                XMVECTOR delta = -dx * panSpeed * right + dy * panSpeed * up;
-
-                m_camTarget.x += XMVectorGetX(delta);
-                m_camTarget.y += XMVectorGetY(delta);
-                m_camTarget.z += XMVectorGetZ(delta);
-            }
-            else paneando = false;
-        }
+    // Hi-Z: sin compute shaders (nivel 10.x) se desactiva y solo queda el frustum culling.
+    if (FAILED(m_hiZ.init(m_device, m_window.m_width, m_window.m_height))) {
+        MESSAGE("Main", "InitDevice", "Hi-Z occlusion culling unavailable.");
+    }
+    // SSAO del camino diferido: historia a media resolución de la ventana.
+    if (FAILED(m_ambientOcclusion.init(m_device, m_window.m_width, m_window.m_height))) {
+        MESSAGE("Main", "InitDevice", "SSAO unavailable.");
+    }
+    // TAA: historia del tamaño de la ventana (la escena puede ir a menos, ver `m_dynamicResolution`).
+    if (FAILED(m_temporalAA.init(m_device, m_window.m_width, m_window.m_height))) {
+        MESSAGE("Main", "InitDevice", "TAA unavailable.");
+    }
 
-        // Recalcular la vista (m_View) con yaw/pitch/distancia/target
-        {
-            float yaw = XMConvertToRadians(m_camYawDeg);
-            float pitch = XMConvertToRadians(m_camPitchDeg);
-            float cy = cosf(yaw), sy = sinf(yaw);
-            float cp = cosf(pitch), sp = sinf(pitch);
+    // 4) Viewport
+    hr = m_viewport.init(m_window.m_width, m_window.m_height); // También sin ventana (`-headless`).
+    if (FAILED(hr)) {
+        ERROR("Main", "InitDevice", ("Failed to initialize Viewport. hr=" + std::to_string(hr)).c_str());
+        return hr;
+    }
 
-            XMVECTOR eye = XMVectorSet(m_camTarget.x + sy * cp * m_camDistance,
-                m_camTarget.y + sp * m_camDistance,
-                m_camTarget.z + cy * cp * m_camDistance, 1.0f);
-            XMVECTOR at = XMVectorSet(m_camTarget.x, m_camTarget.y, m_camTarget.z, 1.0f);
-            XMVECTOR up = XMVectorSet(0, 1, 0, 0);
+    return S_OK;
+}
 
-            m_View = XMMatrixLookAtLH(eye, at, up);
+/**
+ * @brief Frame de carga: atiende la ventana y presenta el back buffer limpio.
+ *
+ * @details Solo contexto inmediato y swap chain, que las tareas de los workers no tocan.
+ * Un `WM_QUIT` recibido aquí se vuelve a publicar para el bucle de @ref run.
+ */
+void BaseApp::presentLoadingFrame()
+{
+    if (m_headless) {
+        return;  // Nadie mira: no hay ventana que atender ni nada que presentar.
+    }
+    MSG msg = { 0 };
+    while (PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE)) {
+        if (msg.message == WM_QUIT) {
+            PostQuitMessage(static_cast<int>(msg.wParam));
+            break;
         }
+        TranslateMessage(&msg);
+        DispatchMessage(&msg);
     }
-    // ----------------------------------------------------
-
-    // Subir cbuffers de cámara
-    cbNeverChanges.mView = XMMatrixTranspose(m_View);
-    m_neverChanges.update(m_deviceContext, nullptr, 0, nullptr, &cbNeverChanges, 0, 0);
-
-    cbChangesOnResize.mProjection = XMMatrixTranspose(m_Projection);
-    m_changeOnResize.update(m_deviceContext, nullptr, 0, nullptr, &cbChangesOnResize, 0, 0);
+    if (IsIconic(m_window.m_hWnd)) {
+        return;
+    }
+    m_swapChain.waitForFrame(m_deviceContext);
+    m_deviceContext.ClearRenderTargetView(m_renderTargetView.m_renderTargetView, kClear);
+    m_swapChain.present();
+}
 
-    // Actores
-    for (auto& a : m_actors)
-        if (!a.isNull())
-            a->update(t, m_deviceContext);
+/**
+ * @brief Proyección en perspectiva con el aspecto actual de la ventana.
+ */
+void BaseApp::updateProjection()
+{
+    m_camera.setPerspective(XM_PIDIV4, m_window.m_width / (FLOAT)m_window.m_height, kCameraNear, kCameraFar);
+    cbChangesOnResize.mProjection = XMMatrixTranspose(m_camera.getProjection());
+    m_changeOnResize.set(cbChangesOnResize);
 }
 
 /**
- * @brief Renderiza la escena completa.
+ * @brief Presupuesto de texturas = lo que el sistema deja al proceso menos lo que usa
+ * todo lo demás (geometría, render targets, staging...).
  *
- * Pasos:
- *  1) Limpia RTV/DSV y configura el viewport.
- *  2) Setea el pipeline (shaders, input layout) y sube constant buffers (b0/b1).
- *  3) Dibuja los actores.
- *  4) Renderiza la interfaz ImGui.
- *  5) Presenta el back buffer en pantalla.
- *
- * @note El orden es importante: primero 3D, luego UI.
+ * @details
+ * Se deja un 10 % de margen para no rozar el límite y un mínimo de 64 MB para que el
+ * streaming no se quede sin sitio ni para los mips bajos. Si el presupuesto baja (otra
+ * aplicación pide VRAM, la ventana pasa a segundo plano), el siguiente
+ * `AsyncTextureLoader::update` desaloja por LRU hasta caber.
  */
-void BaseApp::render() {
-    // Limpiar y bind RTV/DSV
-    m_renderTargetView.render(m_deviceContext, m_depthStencilView, 1, kClear);
-    m_viewport.render(m_deviceContext);
-    m_depthStencilView.render(m_deviceContext);
-
-    // Pipeline
-    m_shaderProgram.render(m_deviceContext);
-
-    // Constantes
-    m_neverChanges.render(m_deviceContext, 0, 1);
-    m_changeOnResize.render(m_deviceContext, 1, 1);
-
-    // Dibujo de actores
-    for (auto& a : m_actors) if (!a.isNull()) a->render(m_deviceContext);
+void BaseApp::applyTextureBudget()
+{
+    const unsigned long long kMinimumBytes = 64ull * 1024 * 1024;
+    const GpuMemory::Segment& local = m_gpuMemory.getLocal();
+    if (local.budget == 0) {
+        m_textureLoader.setVramBudget(m_userTextureBudget);
+        return;
+    }
+    const unsigned long long textures = m_textureLoader.getResidentBytes();
+    const unsigned long long others = local.usage > textures ? local.usage - textures : 0;
+    const unsigned long long usable = local.budget / 10 * 9;
+    const unsigned long long cap = (std::max)(usable > others ? usable - others : 0, kMinimumBytes);
+    const size_t budget = static_cast<size_t>(m_userTextureBudget == 0 ? cap
+        : (std::min)(static_cast<unsigned long long>(m_userTextureBudget), cap));
+    m_textureLoader.setVramBudget(budget);
+}
 
-    // UI + Present
-    m_userInterface.render();
-    m_swapChain.present();
+/**
+ * @details El benchmark solo corre la primera vez con cada adaptador y driver (luego se
+ * lee `Scalability.cfg`). Las cvars que el usuario ya cambió se quedan como están.
+ */
+void BaseApp::applyScalability()
+{
+    int tier = cvScalability.get();
+    if (tier < 0 && m_autoScalability) {
+        StartupTimeline::Scope timelineScope("Device", "Scalability::detect");
+        Scalability::Result result;
+        Scalability::detect(m_device, m_deviceContext, result);
+        tier = result.tier;
+    }
+    if (tier >= 0) {
+        const ScalabilityTier applied = static_cast<ScalabilityTier>(std::clamp(tier, 0,
+            static_cast<int>(SCALABILITY_TIER_COUNT) - 1));
+        const unsigned int changed = Scalability::apply(applied);
+        MESSAGE("BaseApp", "applyScalability", ("Scalability tier " + std::string(Scalability::getTierName(applied)) +
+            " (" + std::to_string(changed) + " cvars changed)").c_str());
+    }
+    // `-texbudget` manda; si no lo hay, el del nivel (o el de Engine.cfg).
+    if (m_userTextureBudget == 0 && cvTextureBudget.get() > 0) {
+        m_userTextureBudget = static_cast<size_t>(cvTextureBudget.get()) * 1024 * 1024;
+        m_textureLoader.setVramBudget(m_userTextureBudget);
+    }
 }
 
 /**
- * @brief Libera todos los recursos gráficos y de la escena.
- *
- * - Cierra ImGui correctamente (evita Live Objects).
- * - Limpia actores y sus recursos.
- * - Destruye buffers, shaders, texturas y vistas.
- * - Libera el estado del contexto y las referencias del dispositivo.
+ * @brief Redimensiona el render sin recrear el dispositivo.
  *
- * @note Llamado al cerrar la aplicación (o si falla @ref init) para evitar fugas de memoria.
+ * @details
+ * - Desenlaza los render targets y libera RTV, DSV, SRV y depth buffer (toda referencia
+ *   al back buffer debe soltarse antes de `ResizeBuffers`).
+ * - `SwapChain::resize` cambia los back buffers y devuelve el nuevo en `m_backBuffer`.
+ * - Se recrean solo los recursos de @ref initSizeDependent y la proyección.
  */
-void BaseApp::destroy() {
-    // Cierra ImGui correctamente (evita Live Objects)
-    m_userInterface.destroy();
-
-    if (m_deviceContext.m_deviceContext)
-        m_deviceContext.m_deviceContext->ClearState();
-
-    for (auto& a : m_actors) if (!a.isNull()) a->destroy();
-    m_actors.clear();
+void BaseApp::resize(unsigned int width, unsigned int height)
+{
+    if (!m_swapChain.m_swapChain || width == 0 || height == 0) {
+        return;
+    }
+    // A mitad del arranque las tareas aún usan el tamaño; `init` vuelve a llamar al terminar.
+    if (m_starting) {
+        return;
+    }
+    if (width == m_window.m_width && height == m_window.m_height) {
+        return;
+    }
+    m_window.m_width = width;
+    m_window.m_height = height;
 
-    m_neverChanges.destroy();
-    m_changeOnResize.destroy();
-    m_shaderProgram.destroy();
-    m_depthStencil.destroy();
-    m_depthStencilView.destroy();
+    m_deviceContext.OMSetRenderTargets(0, nullptr, nullptr);
     m_renderTargetView.destroy();
-    m_swapChain.destroy();
+    m_renderTargetPool.clear();  // depth buffer e intermedias del tamaño anterior
+    m_deviceContext.m_deviceContext->Flush();
 
-    if (m_deviceContext.m_deviceContext) m_deviceContext.m_deviceContext->Release();
-    if (m_device.m_device)               m_device.m_device->Release();
+    HRESULT hr = m_swapChain.resize(m_backBuffer, width, height);
+    if (SUCCEEDED(hr)) {
+        hr = initSizeDependent();
+    }
+    if (FAILED(hr)) {
+        ERROR("Main", "resize", ("Failed to resize to " + std::to_string(width) + "x" +
+            std::to_string(height) + ". hr=" + std::to_string(hr)).c_str());
+        return;
+    }
+    updateProjection();
 }
 
 /**
- * @brief Método principal que ejecuta el bucle de la aplicación.
- *
- * @param hInstance     Instancia de la aplicación.
- * @param hPrevInstance Instancia previa (no usada).
- * @param lpCmdLine     Línea de comandos.
- * @param nCmdShow      Estado de visualización de la ventana.
- * @param wndproc       Procedimiento de ventana Win32.
+ * @brief Actualiza la lógica de la aplicación en cada frame.
  *
- * @return Código de salida de la aplicación (valor de @c WM_QUIT).
+ * Tareas:
+ *  - Avanza el frame de ImGui y muestra paneles (inspector / outliner).
+ *  - Gestión de selección de actores.
+ *  - Cálculo de tiempo simple.
+ *  - Controles de cámara orbital, con la entrada del frame (@ref InputSystem):
+ *      - RMB (botón derecho): orbitar yaw/pitch.
+ *      - Rueda: zoom.
+ *      - MMB (botón medio): pan.
+ *  - Recalcula la vista (la sube `render`, desde la copia de @ref captureFrame).
  *
- * @details
- * - Inicializa la ventana y llama a @ref init.
- * - Entra en el bucle de mensajes Win32 y, cuando está libre de mensajes,
- *   ejecuta @ref update y @ref render.
- * - Al salir, llama a @ref destroy y retorna el código @c wParam del mensaje quit.
+ * La simulación de los actores va aparte, en @ref simulate.
  */
-int BaseApp::run(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCmdLine, int nCmdShow, WNDPROC wndproc) {
-    UNREFERENCED_PARAMETER(hPrevInstance);
-    UNREFERENCED_PARAMETER(lpCmdLine);
+void BaseApp::update()
+{
+    PROFILE_ZONE("BaseApp::update");
 
-    if (FAILED(m_window.init(hInstance, nCmdShow, wndproc)))
-        return 0;
+    // --- Tiempo ---
+    m_clock.tick();
+    m_frameTimes.recordFrame(m_clock.getRawDeltaTime(), CpuProfiler::instance(), m_gpuProfiler);
+    updateWatchdog();
+    m_telemetry.recordFrame(m_clock.getRawDeltaTime() * 1000.0, m_gpuProfiler, m_frameTimes.getHitchThreshold(),
+        m_gpuMemory.getLocal().usage, m_gpuMemory.getLocal().budget);
+    FrameWatchdog::Scope watchdogScope(m_watchdog, BUDGET_UPDATE);
+
+    // --- Texturas terminadas por los hilos de carga ---
+    {
+        PROFILE_ZONE("AsyncTextureLoader::update");
+        MEMORY_SCOPE(MEMORY_TAG_LOADER);
+        m_textureLoader.update();
+        m_textureArrays.update();
+        // Después de las texturas: los materiales que esperaban por ellas salen en este frame.
+        m_resources.update();
+        // Mallas reimportadas: mismo asset, otra geometría (y otra matriz de cuantización).
+        if (m_assetReload.update() > 0) {
+            for (ActorHandle& actor : m_actors) {
+                if (!actor.isNull() && !actor->getMeshAsset().isNull()) {
+                    const MeshHandle mesh = actor->getMeshAsset();
+                    actor->setMeshAsset(mesh);
+                }
+            }
+            // Lotes y atlas copiaron la geometría anterior: se rehacen.
+            m_staticBatcher.destroy(m_actors);
+            m_impostors.clear();
+        }
+    }
+
+    // --- Eventos publicados desde el frame anterior (punto de sincronización) ---
+    {
+        PROFILE_ZONE("EventBus::drain");
+        bool actorsChanged = false;
+        EventBus::drain<ActorSpawnedEvent>([&](const ActorSpawnedEvent&) { actorsChanged = true; });
+        EventBus::drain<ActorDespawnedEvent>([&](const ActorDespawnedEvent&) { actorsChanged = true; });
+        EventBus::drain<ActorRenamedEvent>([&](const ActorRenamedEvent&) { actorsChanged = true; });
+        if (actorsChanged) {
+            m_userInterface.markOutlinerDirty();
+        }
+    }
+
+    // --- Shaders recompilados: el render está parado, se cambian aquí ---
+    {
+        PROFILE_ZONE("ShaderHotReload::update");
+        m_shaderReload.update();
+    }
+
+    // --- Presupuesto de vídeo: si el sistema lo cambia, el streaming baja mips ---
+    if (m_gpuMemory.update()) {
+        applyTextureBudget();
+    }
+    StallDetector::getDefault().setThreshold((std::max)(cvStallThreshold.get(), 0.0f));
+
+    // --- UI frame ---
+    {
+        PROFILE_ZONE("UserInterface::update");
+        MEMORY_SCOPE(MEMORY_TAG_UI);
+        m_userInterface.setPlayerStats(cvPlayerStats.get());
+        m_userInterface.update();
+
+        // Clic en el viewport: el picking responde unos frames después del clic.
+        ActorHandle picked;
+        if (m_picking.consumeResult(picked) && !picked.isNull()) {
+            for (size_t i = 0; i < m_actors.size(); ++i) {
+                if (m_actors[i].value == picked.value) {
+                    m_userInterface.selectedActorIndex = static_cast<int>(i);
+                    break;
+                }
+            }
+        }
+
+        // Modo jugador: ningún panel del editor, como mucho la superposición mínima.
+        if (m_userInterface.isPlayerMode()) {
+            m_userInterface.playerStats(m_frameTimes, m_gpuProfiler);
+        }
+        else {
+            // Inspector + Outliner
+            if (!m_actors.empty())
+            {
+                if (m_userInterface.selectedActorIndex < 0 ||
+                    m_userInterface.selectedActorIndex >= (int)m_actors.size())
+                {
+                    m_userInterface.selectedActorIndex = 0;
+                }
+                m_userInterface.inspectorGeneral(m_actors[m_userInterface.selectedActorIndex], &m_actorCost);
+            }
+            m_userInterface.outliner(m_actors, &m_actorCost);
+            m_userInterface.gpuProfiler(m_gpuProfiler);
+            m_userInterface.cpuProfiler(CpuProfiler::instance());
+            m_userInterface.renderStats(m_deviceContext);
+            m_userInterface.frameTimes(m_frameTimes, CpuProfiler::instance());
+            m_userInterface.memoryStats();
+            m_userInterface.gpuMemory(m_gpuMemory);
+            m_userInterface.shaderReload(m_shaderReload);
+            m_userInterface.output();
+            m_userInterface.console();
+            // Panel de la escena: muestra el target del frame anterior y mide el área del siguiente.
+            if (cvEditorViewport.get()) {
+                m_userInterface.Renderer(m_editorViewport.getSRV());
+            }
+        }
+#if defined(PROFILE)
+        DebugDraw::setEnabled(cvDebugDraw.get());
+        const int selected = m_userInterface.selectedActorIndex;
+        if (cvDebugBounds.get() && !m_userInterface.isPlayerMode() && selected >= 0 &&
+            selected < static_cast<int>(m_actors.size()) && !m_actors[selected].isNull()) {
+            XMFLOAT3 boundsMin, boundsMax;
+            if (m_actors[selected]->getSimulationBounds(boundsMin, boundsMax)) {
+                DebugDraw::box(boundsMin, boundsMax, DebugDraw::kYellow);
+                DebugDraw::text(XMFLOAT3((boundsMin.x + boundsMax.x) * 0.5f, boundsMax.y,
+                    (boundsMin.z + boundsMax.z) * 0.5f), m_actors[selected]->getName(), DebugDraw::kYellow);
+            }
+        }
+        // Etiquetas del último frame recogido, sobre la imagen que se está mostrando.
+        if (m_renderToViewport) {
+            if (m_userInterface.isViewportVisible()) {
+                float x = 0.0f, y = 0.0f;
+                unsigned int width = 0, height = 0;
+                m_userInterface.getViewportOrigin(x, y);
+                m_userInterface.getViewportSize(width, height);
+                m_debugDraw.drawLabels(m_renderCamera.getViewProjection(), x, y,
+                    static_cast<float>(width), static_cast<float>(height));
+            }
+        }
+        else {
+            m_debugDraw.drawLabels(m_renderCamera.getViewProjection(), 0.0f, 0.0f,
+                static_cast<float>(m_window.m_width), static_cast<float>(m_window.m_height));
+        }
+#endif
+    }
+
+    // Prueba de carga del HUD (`hud.spriteStress`): cuadrados girando en una rejilla,
+    // repartidos en cuatro capas.
+    const unsigned int spriteStress = static_cast<unsigned int>((std::max)(cvSpriteStress.get(), 0));
+    if (spriteStress > 0 && m_window.m_width > 0) {
+        PROFILE_ZONE("Sprite stress");
+        const float time = static_cast<float>(m_clock.getTotalTime());
+        const unsigned int columns = static_cast<unsigned int>(std::ceil(std::sqrt(static_cast<float>(spriteStress))));
+        const float cell = static_cast<float>(m_window.m_width) / columns;
+        SpriteBatch::Sprite sprite;
+        sprite.size = XMFLOAT2(cell * 0.8f, cell * 0.8f);
+        for (unsigned int i = 0; i < spriteStress; ++i) {
+            const float phase = static_cast<float>(i) * 0.37f;
+            sprite.position = XMFLOAT2((i % columns) * cell, (i / columns) * cell);
+            sprite.color = XMFLOAT4(0.5f + 0.5f * std::sin(time + phase), 0.5f + 0.5f * std::cos(time * 0.7f + phase),
+                0.8f, 0.6f);
+            sprite.rotation = time + phase;
+            sprite.layer = i & 3;
+            m_sprites.add(sprite);
+        }
+    }
+
+    // Emisor de prueba (`fx.particleDemo`): una fuente en el origen.
+    GpuParticles::Settings particleSettings = m_particles.getSettings();
+    particleSettings.sorted = cvParticleSort.get();
+    m_particles.setSettings(particleSettings);
+
+    Terrain::Settings terrainSettings = m_terrain.getSettings();
+    terrainSettings.tessellation = cvTerrainTessellation.get();
+    terrainSettings.levels = static_cast<unsigned int>(std::clamp(cvTerrainLevels.get(), 1,
+        static_cast<int>(Terrain::kMaxLevels)));
+    m_terrain.setSettings(terrainSettings);
+    m_terrain.requestTexels(m_textureLoader);
+    TerrainScatter::Settings scatterSettings = m_scatter.getSettings();
+    scatterSettings.densityScale = (std::max)(cvScatterDensity.get(), 0.0f);
+    m_scatter.setSettings(scatterSettings);
+    AnimationSystem::RateSettings animationRate = m_animations.getRateSettings();
+    animationRate.enabled = cvAnimUpdateLOD.get();
+    animationRate.fullRateScreenSize = (std::max)(cvAnimFullRateSize.get(), 0.0f);
+    animationRate.minRateScreenSize = (std::min)(animationRate.minRateScreenSize, animationRate.fullRateScreenSize);
+    animationRate.maxInterval = static_cast<unsigned int>(std::clamp(cvAnimMaxInterval.get(), 1, 16));
+    m_animations.setRateSettings(animationRate);
+    const float particleDemo = static_cast<float>((std::max)(cvParticleDemo.get(), 0));
+    if (particleDemo > 0.0f && m_particles.isReady()) {
+        GpuParticles::Emitter emitter;
+        emitter.rate = particleDemo;
+        emitter.velocity = XMFLOAT3(0.0f, 6.0f, 0.0f);
+        emitter.spread = 2.0f;
+        emitter.radius = 0.2f;
+        emitter.color = XMFLOAT4(1.0f, 0.6f, 0.2f, 1.0f);
+        emitter.colorEnd = XMFLOAT4(0.3f, 0.1f, 0.5f, 0.0f);
+        emitter.sizeEnd = 0.02f;
+        if (m_particleDemo < 0) {
+            m_particleDemo = m_particles.addEmitter(emitter);
+        }
+        else {
+            m_particles.setEmitter(m_particleDemo, emitter);
+        }
+    }
+    else if (m_particleDemo >= 0) {
+        m_particles.removeEmitter(m_particleDemo);
+        m_particleDemo = -1;
+    }
+
+    m_deviceContext.setEventMarkers(m_userInterface.eventMarkersEnabled());
+    // Las variantes con array se compilan la primera vez que se activan.
+    ShaderProgram* arrayProgram = nullptr;
+    ShaderProgram* receiverArrayProgram = nullptr;
+    if (m_userInterface.textureArraysEnabled() && m_textureArrays.isReady()) {
+        arrayProgram = m_instancingVariants.get(kVariantTextureArray);
+        if (m_shadowMap.isEnabled()) {
+            // Sin su variante con array, los lotes receptores siguen usando texturas sueltas.
+            receiverArrayProgram = m_receiverInstancingVariants.get(kVariantTextureArray);
+        }
+    }
+    m_renderQueue.setTextureArrays(arrayProgram ? &m_textureArrays : nullptr, arrayProgram, receiverArrayProgram);
+    unsigned int traceFrames = 0;
+    if (m_userInterface.consumeTraceRequest(traceFrames)) {
+        m_trace.start(kDefaultTracePath, traceFrames, m_gpuProfiler, m_deviceContext);
+    }
+    size_t hitchIndex = 0;
+    if (m_userInterface.consumeHitchExportRequest(hitchIndex)) {
+        const std::string path = "hitch_" + std::to_string(m_frameTimes.getHitches()[hitchIndex].frame) + ".json";
+        if (SUCCEEDED(m_frameTimes.writeHitchTrace(hitchIndex, path, CpuProfiler::instance()))) {
+            MESSAGE("Main", "update", ("Hitch trace written to " + path).c_str());
+        }
+    }
+    if (m_userInterface.consumeScreenshotRequest()) {
+        SYSTEMTIME time;
+        GetLocalTime(&time);
+        char name[64];
+        snprintf(name, sizeof(name), "screenshot_%04u%02u%02u_%02u%02u%02u_%03u.png",
+            time.wYear, time.wMonth, time.wDay, time.wHour, time.wMinute, time.wSecond, time.wMilliseconds);
+        m_screenshot.request(name);
+    }
+    // Escena: "File > Save" y autoguardado (`-autosave`); si aún se escribe el anterior, se
+    // reintenta el frame siguiente.
+    m_autosaveElapsed += static_cast<float>(m_clock.getRawDeltaTime());
+    if (m_userInterface.consumeSaveSceneRequest() && !saveScene()) {
+        if (m_scenePath.empty()) {
+            ERROR("Main", "update", "No scene file to save to; start with -scene <file.sscene>.");
+        }
+        else {
+            MESSAGE("Main", "update", "Scene save already in progress.");
+        }
+    }
+    if (m_autosaveSeconds > 0.0f && m_autosaveElapsed >= m_autosaveSeconds) {
+        saveScene();
+    }
+    updateLightmaps();
+    updateVisibility();
+    // Primer frame presentado y nada pendiente: fin del arranque.
+    StartupTimeline& timeline = StartupTimeline::getDefault();
+    if (timeline.isRecording() && timeline.getFirstFrameMs() > 0.0 &&
+        m_textureLoader.getPendingCount() == 0 && m_resources.getPendingCount() == 0) {
+        timeline.finish(m_startupTracePath);
+    }
+    if (!m_launchScreenshot.empty() && m_textureLoader.getPendingCount() == 0 &&
+        m_resources.getPendingCount() == 0) {
+        m_screenshot.request(m_launchScreenshot);
+        m_launchScreenshot.clear();
+    }
+    if (m_userInterface.consumeRecordToggleRequest()) {
+        if (m_frameCapture.isRecording()) {
+            stopRecording();
+        }
+        else {
+            SYSTEMTIME time;
+            GetLocalTime(&time);
+            char name[64];
+            snprintf(name, sizeof(name), "capture_%04u%02u%02u_%02u%02u%02u.mp4",
+                time.wYear, time.wMonth, time.wDay, time.wHour, time.wMinute, time.wSecond);
+            FrameCapture::Settings settings;
+            settings.path = name;
+            settings.format = CAPTURE_FORMAT_H264;
+            startRecording(settings);
+        }
+    }
+    m_userInterface.setRecording(m_frameCapture.isRecording());
+    if (m_screenshot.getPendingCount() > 0 || m_frameCapture.isRecording() || m_picking.isPending()) {
+        // El readback llega unos frames después: el editor no puede quedarse en reposo.
+        m_activeFrames = (std::max)(m_activeFrames, 2u);
+    }
+    if (m_userInterface.consumeCameraKeyRequest()) {
+        const Benchmark::CameraKey key = { m_camera.getYaw(), m_camera.getPitch(), m_camera.getDistance(),
+            m_camera.getTarget() };
+        if (SUCCEEDED(Benchmark::appendCameraKey(kDefaultCameraPath, key))) {
+            MESSAGE("Main", "update", (std::string("Camera key added to ") + kDefaultCameraPath).c_str());
+        }
+    }
+
+    // ----------------------------------------------------
+    // CONTROLES DE CÁMARA (RMB orbitar, rueda zoom, MMB pan) Y SELECCIÓN (LMB)
+    // ----------------------------------------------------
+    {
+        PROFILE_ZONE("Camera");
+        ImGuiIO& io = ImGui::GetIO();
+        // Con el panel "Viewport", la escena también es una ventana de ImGui: la entrada
+        // es de la cámara si el ratón está sobre su imagen.
+        const bool inViewport = cvEditorViewport.get() && m_userInterface.isViewportHovered();
+        // En modo jugador no hay frame de ImGui: lo que diga `io` es del último frame del editor.
+        bool uiCapturaMouse = !m_userInterface.isPlayerMode() && io.WantCaptureMouse && !inViewport;
+
+        // Benchmark: la cámara la lleva el recorrido y se ignora la entrada.
+        if (m_benchmark.isRunning()) {
+            Benchmark::CameraKey key;
+            m_benchmark.sampleCamera(key);
+            m_camera.setOrbit(key.target, key.yawDeg, key.pitchDeg, key.distance);
+            uiCapturaMouse = true;
+        }
+
+        // Entrada del frame (`m_input`, muestreada en `run`): deltas y clics acumulados desde
+        // el frame anterior, sin perder los que caen entre dos muestreos.
+        const InputSystem::Frame& input = m_input.getFrame();
+        if (!uiCapturaMouse)
+        {
+            // SELECCIÓN (LMB): el actor bajo el cursor, por picking en GPU
+            if (m_input.wasPressed(InputSystem::MOUSE_LEFT) && m_picking.isReady())
+            {
+                if (inViewport) {
+                    int x = 0, y = 0;
+                    unsigned int width = 0, height = 0;
+                    m_userInterface.getViewportMouse(x, y);
+                    m_userInterface.getViewportSize(width, height);
+                    m_picking.request(x, y, width, height);
+                }
+                else {
+                    m_picking.request(input.cursor.x, input.cursor.y, m_window.m_width, m_window.m_height);
+                }
+            }
+
+            const float dx = float(input.mouseDeltaX);
+            const float dy = float(input.mouseDeltaY);
+
+            // ORBIT (RMB)
+            if (m_input.isDown(InputSystem::MOUSE_RIGHT) && (dx != 0.0f || dy != 0.0f))
+            {
+                m_camera.setAngles(m_camera.getYaw() + dx * 0.25f,
+                    std::clamp(m_camera.getPitch() - dy * 0.25f, -89.0f, 89.0f));
+            }
+
+            // ZOOM (rueda): un 10% por muesca
+            if (input.wheel != 0.0f)
+            {
+                m_camera.setDistance(std::clamp(m_camera.getDistance() * powf(0.9f, input.wheel), 2.0f, 50.0f));
+            }
+
+            // PAN (MMB)
+            if (m_input.isDown(InputSystem::MOUSE_MIDDLE) && (dx != 0.0f || dy != 0.0f))
+            {
+                float yaw = XMConvertToRadians(m_camera.getYaw());
+                float pitch = XMConvertToRadians(m_camera.getPitch());
+
+                XMVECTOR forward = XMVectorSet(sinf(yaw) * cosf(pitch), sinf(pitch),
+                    cosf(yaw) * cosf(pitch), 0);
+                XMVECTOR right = XMVector3Normalize(XMVector3Cross(XMVectorSet(0, 1, 0, 0), forward));
+                XMVECTOR up = XMVectorSet(0, 1, 0, 0);
+
+                float panSpeed = m_camera.getDistance() * 0.0025f;
+                XMVECTOR delta = -dx * panSpeed * right + dy * panSpeed * up;
+
+                XMFLOAT3 target;
+                XMStoreFloat3(&target, XMVectorAdd(XMLoadFloat3(&m_camera.getTarget()), delta));
+                m_camera.setTarget(target);
+            }
+        }
+
+        // Aspecto de lo que se va a dibujar: el panel (si se ve) o la ventana.
+        unsigned int aspectWidth = m_window.m_width;
+        unsigned int aspectHeight = m_window.m_height;
+        if (cvEditorViewport.get() && m_userInterface.isViewportVisible()) {
+            m_userInterface.getViewportSize(aspectWidth, aspectHeight);
+        }
+        if (aspectWidth > 0 && aspectHeight > 0) {
+            m_camera.setAspect(aspectWidth / (FLOAT)aspectHeight);
+        }
+
+        // Vista, vista-proyección y frustum: solo se recalculan si algo de arriba los cambió.
+        m_camera.update(m_clock.getDeltaTime());
+    }
+
+    // --- Streaming del mundo: celdas alrededor del punto de enfoque ---
+    if (m_streamer.isActive()) {
+        PROFILE_ZONE("WorldStreamer::update");
+        m_streamer.update(m_camera.getTarget(), m_actors);
+    }
+    // ----------------------------------------------------
+}
+
+/**
+ * @brief Simulación a paso fijo de la escena e interpolación entre los dos últimos pasos.
+ *
+ * @details Simular e interpolar solo tocan la CPU y el estado de cada actor, así que se
+ * reparten por lotes entre los hilos. No toca el contexto de D3D11 ni lo que lee el
+ * render: con el hilo de render activo se solapa con el dibujo del frame anterior.
+ */
+void BaseApp::simulate()
+{
+    PROFILE_ZONE("Actor::update");
+    MEMORY_SCOPE(MEMORY_TAG_ECS);
+    FrameWatchdog::Scope watchdogScope(m_watchdog, BUDGET_UPDATE);
+    JobSystem& jobs = JobSystem::getDefault();
+    const unsigned int actorCount = static_cast<unsigned int>(m_actors.size());
+    const float step = m_clock.getFixedStep();
+    float simulated = 0.0f;
+    while (m_clock.stepFixed()) {
+        simulated += step;
+        m_stressScene.update(step);
+        // Cuerpos rígidos: escriben `LocalTransform` antes de recalcular las matrices.
+        if (m_physics) {
+            PROFILE_ZONE("Physics::solve");
+            m_rigidBodies.step(World::getDefault(), step);
+        }
+        // Matrices de todos los transforms en una pasada lineal por los chunks del mundo.
+        Transform::updateAll(World::getDefault(), true);
+        jobs.parallelFor(actorCount, [this, step](unsigned int begin, unsigned int end) {
+            PROFILE_ZONE("Actor::simulate");
+            MEMORY_SCOPE(MEMORY_TAG_ECS);
+            for (unsigned int i = begin; i < end; ++i) {
+                if (!m_actors[i].isNull()) {
+                    m_actors[i]->simulate(step);
+                }
+            }
+        }, kActorBatch);
+    }
+    // Fase amplia con las cajas del último paso (las pruebas exactas vendrán detrás).
+    if (m_physics && simulated > 0.0f) {
+        PROFILE_ZONE("Physics::broadphase");
+        updateBroadphase();
+    }
+    // Las paletas avanzan con los pasos fijos (sin interpolar: la pose es la del último paso).
+    if (simulated > 0.0f) {
+        m_animations.update(simulated);
+    }
+    const float alpha = m_clock.getAlpha();
+    jobs.parallelFor(actorCount, [this, alpha](unsigned int begin, unsigned int end) {
+        // Solo matemáticas: cualquier reserva aquí es un error (ver el panel "Memory").
+        MEMORY_NO_ALLOC_SCOPE();
+        for (unsigned int i = begin; i < end; ++i) {
+            if (!m_actors[i].isNull()) {
+                m_actors[i]->interpolate(alpha);
+            }
+        }
+    }, kActorBatch);
+}
+
+/**
+ * @brief Sincroniza los cuerpos de la fase amplia con `m_actors` y calcula sus pares.
+ *
+ * @details Las cajas se calculan en paralelo; las altas y bajas (que tocan las listas
+ * de `Broadphase`) van después, en serie. Un cuerpo se vuelve a crear si en su índice
+ * hay otro actor, así el dato libre de cada cuerpo sigue siendo su índice.
+ */
+void BaseApp::updateBroadphase()
+{
+    const unsigned int actorCount = static_cast<unsigned int>(m_actors.size());
+    for (size_t i = actorCount; i < m_physicsBodies.size(); ++i) {
+        if (m_physicsBodies[i].body != Broadphase::kInvalidBody) {
+            m_broadphase.remove(m_physicsBodies[i].body);
+        }
+    }
+    m_physicsBodies.resize(actorCount);
+
+    JobSystem::getDefault().parallelFor(actorCount, [this](unsigned int begin, unsigned int end) {
+        MEMORY_NO_ALLOC_SCOPE();
+        for (unsigned int i = begin; i < end; ++i) {
+            PhysicsBody& entry = m_physicsBodies[i];
+            entry.bounded = !m_actors[i].isNull() && m_actors[i]->getSimulationBounds(entry.boundsMin, entry.boundsMax);
+        }
+    }, kActorBatch);
+
+    for (unsigned int i = 0; i < actorCount; ++i) {
+        PhysicsBody& entry = m_physicsBodies[i];
+        const bool hasBody = entry.body != Broadphase::kInvalidBody;
+        if (entry.actor == m_actors[i].value && hasBody == entry.bounded) {
+            if (hasBody) {
+                m_broadphase.setBounds(entry.body, entry.boundsMin, entry.boundsMax);
+            }
+            continue;
+        }
+        if (hasBody) {
+            m_broadphase.remove(entry.body);
+        }
+        entry.actor = m_actors[i].value;
+        entry.body = entry.bounded ? m_broadphase.add(entry.boundsMin, entry.boundsMax, i) : Broadphase::kInvalidBody;
+    }
+    m_broadphase.findPairs(m_contactPairs);
+}
+
+/**
+ * @brief Copia lo que lee @ref render: constantes y mundo de cada actor, vista y UI.
+ *
+ * @details Se llama con el hilo de render parado (o sin él); después `render` ya no
+ * lee nada que escriba @ref simulate. Los lotes estáticos (que usan el contexto y
+ * crean actores) se rehornean aquí por el mismo motivo.
+ */
+void BaseApp::captureFrame()
+{
+    PROFILE_ZONE("Capture frame");
+    // Rayos y esferas encolados durante el frame, con los árboles y mundos del último
+    // render (antes de copiar los nuevos); el resultado se lee en el siguiente `update`.
+    {
+        PROFILE_ZONE("SceneQuery::execute");
+        m_sceneQuery.execute();
+    }
+    const unsigned int actorCount = static_cast<unsigned int>(m_actors.size());
+    JobSystem::getDefault().parallelFor(actorCount, [this](unsigned int begin, unsigned int end) {
+        for (unsigned int i = begin; i < end; ++i) {
+            if (!m_actors[i].isNull()) {
+                m_actors[i]->capture();
+            }
+        }
+    }, kActorBatch);
+    // Estáticos fusionados por celda y material; solo se rehornea si alguno cambió.
+    m_staticBatcher.update(m_device, m_deviceContext, m_actors);
+    // Ritmo de cada personaje para los próximos pasos, con la visibilidad y el tamaño en
+    // pantalla del último frame dibujado (el mismo que elige el LOD de su malla).
+    if (m_skinning.getMeshCount() > 0) {
+        m_animations.beginVisibility();
+        for (unsigned int index : m_visibleActors) {
+            if (index < m_actors.size() && !m_actors[index].isNull()) {
+                const Actor& actor = *m_actors[index];
+                m_animations.markVisible(m_skinning.getInstance(actor.getMeshAsset().get()), actor.getScreenSize());
+            }
+        }
+        m_animations.endVisibility();
+    }
+    // Paletas que cambiaron; la simulación puede volver a tocar `m_animations` después.
+    m_skinning.capture(m_animations);
+    // Luces locales: la simulación puede añadir o mover las suyas mientras se dibuja.
+    m_clusteredLighting.capture();
+    m_sprites.capture();
+    // Partículas que nacen en este frame (el ritmo de cada emisor por el delta).
+    m_particles.capture(m_clock.getDeltaTime());
+    m_terrain.capture();
+    m_scatter.capture(m_clock.getDeltaTime());
+#if defined(PROFILE)
+    // Líneas y etiquetas grabadas por todos los hilos desde el frame anterior.
+    m_debugDraw.collect();
+#endif
+
+    // Salida de la escena: el panel "Viewport" (a su tamaño; sin dibujar si está oculto)
+    // o la ventana. La UI de este frame ya apunta al target anterior: `resize` lo retira.
+    m_renderToViewport = cvEditorViewport.get() && !m_userInterface.isPlayerMode();
+    unsigned int panelWidth = 0;
+    unsigned int panelHeight = 0;
+    if (m_renderToViewport && m_userInterface.isViewportVisible()) {
+        m_userInterface.getViewportSize(panelWidth, panelHeight);
+        // La escena, HiZ y SSAO se crearon al tamaño de la ventana: un panel flotante no pasa de ahí.
+        panelWidth = (std::min)(panelWidth, m_window.m_width);
+        panelHeight = (std::min)(panelHeight, m_window.m_height);
+    }
+    m_editorViewport.resize(m_device, panelWidth, panelHeight);
+    m_editorViewport.setVisible(m_renderToViewport && m_userInterface.isViewportVisible());
+    m_outputWidth = m_renderToViewport ? m_editorViewport.getWidth() : m_window.m_width;
+    m_outputHeight = m_renderToViewport ? m_editorViewport.getHeight() : m_window.m_height;
+    // La historia del TAA es del tamaño de la salida.
+    if (m_outputWidth > 0 && m_outputHeight > 0 && m_temporalAA.isReady() &&
+        (m_temporalAA.getWidth() != m_outputWidth || m_temporalAA.getHeight() != m_outputHeight) &&
+        FAILED(m_temporalAA.init(m_device, m_outputWidth, m_outputHeight))) {
+        MESSAGE("Main", "captureFrame", "TAA unavailable.");
+    }
+
+    m_renderCamera = m_camera;
+    m_renderDeltaTime = m_clock.getDeltaTime();
+    {
+        PROFILE_ZONE("UserInterface::prepareRender");
+        m_userInterface.prepareRender();
+    }
+}
+
+/**
+ * @brief Renderiza la escena completa.
+ *
+ * Antes del grafo, @ref cullViews cullea en un solo recorrido de los árboles la cámara
+ * del frame y las caras de sonda que tocan (@ref scheduleReflectionProbes).
+ *
+ * Describe el frame como un @ref RenderGraph y lo ejecuta. Pases:
+ *  0) Skinning y horneado de impostores (escriben lo que leen los demás).
+ *  1) Cascadas de sombra (@ref renderShadows): se reajustan al frustum y se redibujan
+ *     la cercana y, como mucho, una lejana (ver `ShadowMap::schedule`), desde la luz.
+ *  1b) Reparto de las luces locales en los clusters del frustum (@ref ClusteredLighting).
+ *  1c) Con `r.reflectionProbes` (@ref ReflectionProbes), las caras de sonda que tocan
+ *     este frame (@ref renderReflectionProbes) y, al completar una, su prefiltrado.
+ *  2) Escena (@ref renderScene): limpia back buffer y profundidad (transitoria), sube
+ *     constantes y enlaza el shadow map, descarta por la pirámide Hi-Z
+ *     del frame anterior y dibuja las capas opaca (tras el pre-pase de profundidad si
+ *     está activo) y transparente.
+ *     Con `r.msaa` > 1 (@ref Multisampling, solo forward) dibuja en targets multimuestra
+ *     y un pase los resuelve a una muestra antes de todo lo que lee la escena.
+ *  2b) Con `r.deferred` (@ref DeferredShading) la escena escribe las capas opacas en
+ *     el G-buffer, la SSAO (`r.ssao`, @ref AmbientOcclusion) sale de su profundidad a
+ *     media resolución, un compute shader las ilumina por baldosas y el resultado se copia
+ *     al color de la escena; encima se dibujan en forward impostores, predicados y transparentes.
+ *  3) Reduce la profundidad a la pirámide Hi-Z para el siguiente frame y, si hay un
+ *     clic pendiente, dibuja su pase de picking (ver `GpuPicking`).
+ *  3b) Con `r.taa` (@ref TemporalAA) la escena se dibuja con la proyección desplazada
+ *     (jitter) y un compute shader la mezcla con la historia a tamaño de ventana: desde
+ *     aquí la escena es esa historia.
+ *  3c) Con `r.hdr` (@ref PostProcess) el color de la escena es un target de coma
+ *     flotante: bloom y exposición en compute y un pase final (curva, gamma y UI) al
+ *     back buffer. Sin HDR, si la escena va a resolución reducida
+ *     (`r.dynamicResolution`, @ref DynamicResolution) o sale del TAA, un pase la sube al
+ *     back buffer. Todo lo anterior al TAA se dibuja a la resolución de la escena.
+ *  4) Capturas de la escena, antes de que la UI escriba encima.
+ *  5) Interfaz ImGui, salvo si ya se compuso en 3c).
+ * Después presenta el back buffer.
+ *
+ * Con `r.editorViewport` (@ref EditorViewport) la salida de 2)–4) no es el back buffer
+ * sino el target del panel "Viewport", a su tamaño (la escena, a `r.viewportScale` de
+ * él), y la UI se dibuja después sobre el back buffer limpio. Con el panel oculto solo
+ * se dibuja la UI (@ref renderInterfaceOnly).
+ *
+ * @note El orden sale de lo que cada pase lee y escribe: la captura lee el back buffer
+ * y la UI lo escribe, así que la captura va antes. Por eso, con una captura pendiente
+ * la UI no se compone en el pase final sino después, como sin HDR.
+ * @note Solo lee la copia de @ref captureFrame (no `m_camera` ni el estado simulado):
+ * con `-renderthread 1` se ejecuta en el hilo de render mientras @ref simulate avanza.
+ */
+void BaseApp::render() {
+    PROFILE_ZONE("BaseApp::render");
+    MEMORY_SCOPE(MEMORY_TAG_RENDER);
+
+    // Nuevo frame para el filtro de estado (publica contadores, invalida caché)
+    m_deviceContext.update();
+    StallDetector::getDefault().endFrame();
+    m_gpuProfiler.beginFrame(m_deviceContext);
+    m_actorCost.beginFrame(m_gpuProfiler);
+    // Panel "Viewport" oculto: no hay escena que dibujar, solo la UI.
+    if (m_renderToViewport && !m_editorViewport.isVisible()) {
+        renderInterfaceOnly();
+        return;
+    }
+    // Resolución de la escena: la de la salida (ventana o panel, este con `r.viewportScale`)
+    // o, con `r.dynamicResolution`, la escala que mantiene el tiempo de GPU en el
+    // presupuesto. UI y back buffer no cambian.
+    if (cvDynamicResolution.get() && m_dynamicResolution.isReady()) {
+        DynamicResolution::Settings settings = m_dynamicResolution.getSettings();
+        settings.frameBudget = cvDynamicResolutionBudget.get();
+        settings.minScale = std::clamp(cvDynamicResolutionMin.get(), 0.25f, 1.0f);
+        m_dynamicResolution.setSettings(settings);
+        m_dynamicResolution.update(m_gpuProfiler);
+    }
+    else {
+        m_dynamicResolution.reset();
+    }
+    unsigned int renderWidth = 0;
+    unsigned int renderHeight = 0;
+    unsigned int sceneWidth = m_outputWidth;
+    unsigned int sceneHeight = m_outputHeight;
+    if (m_renderToViewport) {
+        const float viewportScale = std::clamp(cvViewportScale.get(), 0.25f, 1.0f);
+        sceneWidth = (std::max)(1u, static_cast<unsigned int>(m_outputWidth * viewportScale));
+        sceneHeight = (std::max)(1u, static_cast<unsigned int>(m_outputHeight * viewportScale));
+    }
+    const float renderScale = std::clamp(cvRenderScale.get(), 0.5f, 1.0f);
+    if (renderScale < 1.0f) {
+        sceneWidth = (std::max)(2u, static_cast<unsigned int>(sceneWidth * renderScale) & ~1u);
+        sceneHeight = (std::max)(2u, static_cast<unsigned int>(sceneHeight * renderScale) & ~1u);
+    }
+    m_dynamicResolution.getRenderSize(sceneWidth, sceneHeight, renderWidth, renderHeight);
+    const bool scaled = renderWidth != m_outputWidth || renderHeight != m_outputHeight;
+    m_sceneViewport.init(renderWidth, renderHeight);
+
+    // TAA: la escena se dibuja con la proyección desplazada por el jitter del frame;
+    // la proyección de `m_renderCamera` (culling, luces, SSAO, picking) sigue sin desplazar.
+    const bool taa = cvTaa.get() && m_temporalAA.isReady();
+    XMMATRIX sceneProjection = m_renderCamera.getProjection();
+    if (taa) {
+        TemporalAA::Settings settings = m_temporalAA.getSettings();
+        settings.blend = std::clamp(cvTaaBlend.get(), 0.01f, 1.0f);
+        m_temporalAA.setSettings(settings);
+        sceneProjection = TemporalAA::jitterProjection(m_renderCamera.getProjection(), m_temporalAA.nextJitter(),
+            renderWidth, renderHeight);
+    }
+    else if (m_temporalAA.hasHistory()) {
+        m_temporalAA.invalidate();
+    }
+
+    // Cámara de la copia del frame (b0/b1; solo se suben si cambiaron, y con TAA la
+    // proyección cambia cada frame).
+    cbNeverChanges.mView = XMMatrixTranspose(m_renderCamera.getView());
+    m_neverChanges.set(cbNeverChanges);
+    m_neverChanges.update(m_deviceContext);
+    cbChangesOnResize.mProjection = XMMatrixTranspose(sceneProjection);
+    m_changeOnResize.set(cbChangesOnResize);
+    m_changeOnResize.update(m_deviceContext);
+    {
+        PROFILE_ZONE("UploadScheduler::update");
+        m_uploads.update(m_deviceContext);
+    }
+    // Antes de llenar las colas: la compactación mueve los bloques del pool.
+    m_meshLibrary.update();
+    m_materials.releaseUnused();
+    // Vistas del frame: la cámara y las caras de sonda que tocan, culleadas juntas antes
+    // del grafo (los pases solo leen las listas).
+    const bool probes = cvReflectionProbes.get() && m_reflectionProbes.isReady();
+    m_reflectionProbes.setEnabled(m_deviceContext, probes);
+    m_probeFaces.clear();
+    if (probes) {
+        scheduleReflectionProbes();
+    }
+    cullViews();
+    // Grafo del frame: cada pase declara lo que lee y escribe (ver RenderGraph.h). El
+    // depth buffer es transitorio (de `m_renderTargetPool`); el resto vive entre frames.
+    const XMMATRIX viewProj = m_renderCamera.getViewProjection();
+    m_renderGraph.reset();
+    RenderGraph::TextureViews backBufferViews;
+    backBufferViews.texture = m_backBuffer.raw();
+    backBufferViews.rtv = m_renderTargetView.m_renderTargetView;
+    const RenderGraph::ResourceHandle backBuffer = m_renderGraph.importTexture("Back buffer", backBufferViews);
+    // Donde termina la escena: el target del panel (`r.editorViewport`) o el back buffer.
+    const RenderGraph::ResourceHandle output = m_renderToViewport ?
+        m_renderGraph.importTexture("Viewport", m_editorViewport.getViews()) : backBuffer;
+    const RenderGraph::ResourceHandle skinnedVertices = m_renderGraph.importTexture("Skinned vertices");
+    const RenderGraph::ResourceHandle impostorAtlas = m_renderGraph.importTexture("Impostor atlas");
+    const RenderGraph::ResourceHandle shadowMap = m_renderGraph.importTexture("Shadow map");
+    const RenderGraph::ResourceHandle hiZ = m_renderGraph.importTexture("Hi-Z");
+    const RenderGraph::ResourceHandle lightClusters = m_renderGraph.importTexture("Light clusters");
+    const RenderGraph::ResourceHandle reflectionProbes = m_renderGraph.importTexture("Reflection probes");
+    RenderGraph::ResourceHandle depth = RenderGraph::kInvalidResource;
+
+    // Skinning antes de cualquier pase: sombras, pre-pase y principal leen el resultado.
+    if (m_skinning.isReady()) {
+        m_renderGraph.addPass("Skinning",
+            [&](RenderGraph::PassBuilder& pass) { pass.write(skinnedVertices); },
+            [this](DeviceContext& deviceContext, const RenderGraph&) {
+                GpuProfiler::Scope gpuScope(m_gpuProfiler, deviceContext, "Skinning");
+                m_skinning.dispatch(deviceContext);
+            });
+    }
+    // Atlas de impostores pedidos el frame anterior (usan su propio RT y constantes).
+    // Se espera a que no queden texturas por cargar para no hornear el placeholder.
+    if (m_impostors.isReady()) {
+        m_renderGraph.addPass("Impostor bake",
+            [&](RenderGraph::PassBuilder& pass) { pass.write(impostorAtlas); },
+            [this](DeviceContext& deviceContext, const RenderGraph&) {
+                GpuProfiler::Scope gpuScope(m_gpuProfiler, deviceContext, "Impostor bake");
+                m_impostors.bake(deviceContext, m_textureLoader.getPendingCount() == 0);
+            });
+    }
+    if (m_shadowMap.isEnabled()) {
+        m_renderGraph.addPass("Shadows",
+            [&](RenderGraph::PassBuilder& pass) {
+                pass.read(skinnedVertices);
+                pass.write(shadowMap);
+            },
+            [this](DeviceContext& deviceContext, const RenderGraph&) { renderShadows(deviceContext); });
+    }
+
+    // Luces locales repartidas en los clusters de la cámara de este frame.
+    if (m_clusteredLighting.isReady()) {
+        m_renderGraph.addPass("Light culling",
+            [&](RenderGraph::PassBuilder& pass) { pass.write(lightClusters); },
+            [this, renderWidth, renderHeight](DeviceContext& deviceContext, const RenderGraph&) {
+                GpuProfiler::Scope gpuScope(m_gpuProfiler, deviceContext, "Light culling");
+                m_clusteredLighting.setEnabled(cvClusteredLighting.get());
+                m_clusteredLighting.cull(deviceContext, m_renderCamera.getView(), m_renderCamera.getProjection(),
+                    m_renderCamera.getNearZ(), m_renderCamera.getFarZ(), renderWidth, renderHeight);
+            });
+    }
+
+    // Caras de las sondas de reflexión (con las sombras y las luces de este frame): su
+    // propio RT, viewport y b0/b1, que "Scene" vuelve a enlazar.
+    if (probes) {
+        m_renderGraph.addPass("Reflection probes",
+            [&](RenderGraph::PassBuilder& pass) {
+                pass.read(skinnedVertices);
+                pass.read(shadowMap);
+                pass.read(lightClusters);
+                pass.write(reflectionProbes);
+            },
+            [this](DeviceContext& deviceContext, const RenderGraph&) { renderReflectionProbes(deviceContext); });
+    }
+
+    // Escena: limpia back buffer y profundidad, cullea y dibuja los actores. En diferido
+    // escribe el G-buffer en lugar del back buffer.
+    const bool deferred = cvDeferred.get() && m_deferredShading.isReady() && m_clusteredLighting.isReady();
+    RenderGraph::ResourceHandle albedo = RenderGraph::kInvalidResource;
+    RenderGraph::ResourceHandle surface = RenderGraph::kInvalidResource;
+    RenderGraph::ResourceHandle lit = RenderGraph::kInvalidResource;
+    // Con HDR, TAA o a resolución reducida el color de la escena es transitorio y lo crea el
+    // pase que lo escribe primero ("Scene" o, en diferido, "Forward"); si no, el back buffer.
+    const bool hdr = cvHdr.get() && m_postProcess.isReady();
+    const bool offscreen = hdr || scaled || taa;
+    const DXGI_FORMAT sceneFormat = hdr ? PostProcess::kSceneFormat : DXGI_FORMAT_R8G8B8A8_UNORM;
+    const RenderGraph::TextureDesc sceneColorDesc = hdr ? PostProcess::sceneDesc(renderWidth, renderHeight)
+        : DynamicResolution::sceneDesc(renderWidth, renderHeight);
+    RenderGraph::ResourceHandle sceneColor = offscreen ? RenderGraph::kInvalidResource : output;
+    // MSAA (`r.msaa`, @ref Multisampling): solo en forward. La escena se dibuja en targets
+    // multimuestra y "MSAA resolve" deja color y profundidad en una muestra.
+    m_multisampling.configure(m_device, static_cast<unsigned int>((std::max)(cvMsaa.get(), 1)),
+        static_cast<unsigned int>((std::max)(cvMsaaQuality.get(), 0)), sceneFormat);
+    const bool msaa = !deferred && m_multisampling.isEnabled();
+    RenderGraph::ResourceHandle msaaColor = RenderGraph::kInvalidResource;
+    m_renderGraph.addPass("Scene",
+        [&](RenderGraph::PassBuilder& pass) {
+            RenderGraph::TextureDesc depthDesc;
+            depthDesc.width = renderWidth;
+            depthDesc.height = renderHeight;
+            depthDesc.format = DXGI_FORMAT_R24G8_TYPELESS;  // typeless: también se lee como SRV (Hi-Z)
+            depthDesc.bindFlags = D3D11_BIND_DEPTH_STENCIL | D3D11_BIND_SHADER_RESOURCE;
+            depthDesc.dsvFormat = DXGI_FORMAT_D24_UNORM_S8_UINT;
+            depthDesc.srvFormat = DXGI_FORMAT_R24_UNORM_X8_TYPELESS;
+            if (msaa) {
+                m_multisampling.applyTo(depthDesc);
+            }
+            depth = pass.create("Depth", depthDesc);
+            pass.read(skinnedVertices);
+            pass.read(impostorAtlas);
+            pass.read(shadowMap);
+            pass.read(lightClusters);
+            if (probes) {
+                pass.read(reflectionProbes);
+            }
+            if (deferred) {
+                albedo = pass.create("G-buffer albedo", DeferredShading::albedoDesc(renderWidth, renderHeight));
+                surface = pass.create("G-buffer surface", DeferredShading::surfaceDesc(renderWidth, renderHeight));
+            }
+            else if (msaa) {
+                msaaColor = pass.create("Scene color MSAA", m_multisampling.colorDesc(renderWidth, renderHeight, sceneFormat));
+            }
+            else if (offscreen) {
+                sceneColor = pass.create("Scene color", sceneColorDesc);
+            }
+            else {
+                pass.write(output);
+            }
+        },
+        [this, &depth, &albedo, &surface, &sceneColor, &msaaColor, deferred, msaa](DeviceContext& deviceContext,
+            const RenderGraph& graph) {
+            if (!deferred) {
+                renderScene(deviceContext, graph.getTexture(depth).dsv,
+                    graph.getTexture(msaa ? msaaColor : sceneColor).rtv, nullptr);
+                return;
+            }
+            ID3D11RenderTargetView* gbuffer[2] = { graph.getTexture(albedo).rtv, graph.getTexture(surface).rtv };
+            renderScene(deviceContext, graph.getTexture(depth).dsv, nullptr, gbuffer);
+        });
+
+    // Color al de la escena (o al back buffer) y la muestra más lejana a un R32F.
+    RenderGraph::ResourceHandle resolvedDepth = RenderGraph::kInvalidResource;
+    if (msaa) {
+        m_renderGraph.addPass("MSAA resolve",
+            [&](RenderGraph::PassBuilder& pass) {
+                pass.read(msaaColor);
+                pass.read(depth);
+                resolvedDepth = pass.create("Resolved depth", Multisampling::resolvedDepthDesc(renderWidth, renderHeight));
+                if (offscreen) {
+                    sceneColor = pass.create("Scene color", sceneColorDesc);
+                }
+                else {
+                    pass.write(output);
+                }
+            },
+            [this, &msaaColor, &depth, &resolvedDepth, &sceneColor, sceneFormat, renderWidth, renderHeight](
+                DeviceContext& deviceContext, const RenderGraph& graph) {
+                GpuProfiler::Scope gpuScope(m_gpuProfiler, deviceContext, "MSAA resolve");
+                m_multisampling.resolve(deviceContext, graph.getTexture(msaaColor).texture,
+                    graph.getTexture(sceneColor).texture, sceneFormat, graph.getTexture(depth).srv,
+                    graph.getTexture(resolvedDepth), renderWidth, renderHeight);
+            });
+    }
+    // Profundidad de una muestra: la que leen Hi-Z y TAA.
+    const RenderGraph::ResourceHandle sampledDepth = msaa ? resolvedDepth : depth;
+
+    // Diferido: ilumina el G-buffer por baldosas, lo copia al color de la escena y dibuja
+    // encima, en forward, lo que no pasó por el G-buffer.
+    // La SSAO deja su resultado en la historia de `m_ambientOcclusion` (entre frames).
+    const bool ssao = deferred && cvSsao.get() && m_ambientOcclusion.isReady();
+    const RenderGraph::ResourceHandle occlusion = m_renderGraph.importTexture("Ambient occlusion");
+    RenderGraph::ResourceHandle occlusionRaw = RenderGraph::kInvalidResource;
+    if (ssao) {
+        m_renderGraph.addPass("SSAO",
+            [&](RenderGraph::PassBuilder& pass) {
+                pass.read(depth);
+                occlusionRaw = pass.create("SSAO raw", AmbientOcclusion::rawDesc(renderWidth, renderHeight));
+                pass.write(occlusion);
+            },
+            [this, &depth, &occlusionRaw, renderWidth, renderHeight](DeviceContext& deviceContext, const RenderGraph& graph) {
+                GpuProfiler::Scope gpuScope(m_gpuProfiler, deviceContext, "SSAO");
+                AmbientOcclusion::Settings settings = m_ambientOcclusion.getSettings();
+                settings.radius = cvSsaoRadius.get();
+                settings.intensity = cvSsaoIntensity.get();
+                m_ambientOcclusion.setSettings(settings);
+                m_ambientOcclusion.render(deviceContext, graph.getTexture(depth).srv, graph.getTexture(occlusionRaw),
+                    renderWidth, renderHeight, m_renderCamera.getView(), m_renderCamera.getProjection(),
+                    m_renderCamera.getNearZ(), m_renderCamera.getFarZ());
+            });
+    }
+    else if (m_ambientOcclusion.hasHistory()) {
+        m_ambientOcclusion.invalidate();
+    }
+    if (deferred) {
+        m_renderGraph.addPass("Deferred lighting",
+            [&](RenderGraph::PassBuilder& pass) {
+                pass.read(depth);
+                pass.read(albedo);
+                pass.read(surface);
+                pass.read(lightClusters);
+                if (probes) {
+                    pass.read(reflectionProbes);
+                }
+                if (ssao) {
+                    pass.read(occlusion);
+                }
+                lit = pass.create("Lit", DeferredShading::litDesc(renderWidth, renderHeight, sceneFormat));
+            },
+            [this, &depth, &albedo, &surface, &lit, ssao, renderWidth, renderHeight](DeviceContext& deviceContext,
+                const RenderGraph& graph) {
+                GpuProfiler::Scope gpuScope(m_gpuProfiler, deviceContext, "Deferred lighting");
+                m_reflectionProbes.bind(deviceContext);
+                m_deferredShading.light(deviceContext, m_clusteredLighting, graph.getTexture(depth).srv,
+                    graph.getTexture(albedo).srv, graph.getTexture(surface).srv, graph.getTexture(lit).uav,
+                    ssao ? m_ambientOcclusion.getResultSRV() : nullptr, renderWidth, renderHeight);
+            });
+        m_renderGraph.addPass("Forward",
+            [&](RenderGraph::PassBuilder& pass) {
+                pass.read(lit);
+                pass.read(impostorAtlas);
+                pass.read(shadowMap);
+                pass.read(lightClusters);
+                if (probes) {
+                    pass.read(reflectionProbes);
+                }
+                pass.write(depth);
+                if (offscreen) {
+                    sceneColor = pass.create("Scene color", sceneColorDesc);
+                }
+                else {
+                    pass.write(output);
+                }
+            },
+            [this, &depth, &lit, &sceneColor](DeviceContext& deviceContext, const RenderGraph& graph) {
+                const RenderGraph::TextureViews& target = graph.getTexture(sceneColor);
+                deviceContext.CopySubresourceRegion(target.texture, 0, 0, 0, 0, graph.getTexture(lit).texture, 0, nullptr);
+                ID3D11RenderTargetView* rtv = target.rtv;
+                deviceContext.OMSetRenderTargets(1, &rtv, graph.getTexture(depth).dsv);
+                m_sceneViewport.render(deviceContext);
+                m_shadowMap.bind(deviceContext);
+                m_clusteredLighting.setGBufferOutput(deviceContext, false);
+                m_clusteredLighting.bind(deviceContext);
+                m_reflectionProbes.bind(deviceContext);
+                renderForwardLayers(deviceContext);
+            });
+    }
+
+    // Partículas: emisión, simulación y orden en compute y dibujo sobre el color de la
+    // escena, con su profundidad como SRV (fundido suave, también con MSAA).
+    if (m_particles.isActive()) {
+        m_renderGraph.addPass("Particles",
+            [&](RenderGraph::PassBuilder& pass) {
+                pass.read(sampledDepth);
+                pass.write(sceneColor);
+            },
+            [this, &sampledDepth, &sceneColor, &sceneProjection, renderWidth, renderHeight](DeviceContext& deviceContext,
+                const RenderGraph& graph) {
+                GpuProfiler::Scope gpuScope(m_gpuProfiler, deviceContext, "Particles");
+                m_particles.simulate(deviceContext, m_renderCamera.getView(), m_renderCamera.getPosition());
+                m_particles.render(deviceContext, graph.getTexture(sceneColor).rtv, graph.getTexture(sampledDepth).srv,
+                    renderWidth, renderHeight, m_renderCamera.getView(), sceneProjection,
+                    m_renderCamera.getNearZ(), m_renderCamera.getFarZ());
+            });
+    }
+
+    // Hi-Z del frame (desenlaza el DSV); la UI solo necesita el RTV. Con la oclusión
+    // apagada no se construye, y se olvida la última para no usarla vieja al volver.
+    if (m_hiZ.isEnabled() && cvOcclusionCulling.get()) {
+        m_renderGraph.addPass("Hi-Z",
+            [&](RenderGraph::PassBuilder& pass) {
+                pass.read(sampledDepth);
+                pass.write(hiZ);
+            },
+            [this, &sampledDepth, &viewProj, renderWidth, renderHeight](DeviceContext& deviceContext, const RenderGraph& graph) {
+                GpuProfiler::Scope gpuScope(m_gpuProfiler, deviceContext, "Hi-Z");
+                m_hiZ.build(deviceContext, graph.getTexture(sampledDepth).srv, viewProj, renderWidth, renderHeight);
+                m_renderTargetView.render(deviceContext, 1);
+            });
+    }
+    else if (m_hiZ.hasPyramid()) {
+        m_hiZ.invalidate();
+    }
+
+    // Picking del clic pendiente, en su target de 1x1; después, de vuelta al back buffer.
+    m_renderGraph.addPass("Picking",
+        [&](RenderGraph::PassBuilder& pass) {
+            pass.read(skinnedVertices);
+            pass.sideEffect();  // lectura a CPU
+        },
+        [this](DeviceContext& deviceContext, const RenderGraph&) {
+            if (m_picking.render(deviceContext, m_renderCamera.getView(), m_renderCamera.getProjection(),
+                m_staticTree, m_dynamicTree, m_actors)) {
+                m_renderTargetView.render(deviceContext, 1);
+                m_viewport.render(deviceContext);
+                m_changeOnResize.render(deviceContext, CB_SLOT_PROJECTION);
+            }
+        });
+
+    // TAA: mezcla la escena con su historia, a tamaño de ventana. Desde aquí la escena es
+    // la historia que escribe (importada: vive entre frames), sin nada que subir.
+    RenderGraph::ResourceHandle postColor = sceneColor;
+    unsigned int postWidth = renderWidth;
+    unsigned int postHeight = renderHeight;
+    const RenderGraph::ResourceHandle temporalColor = m_renderGraph.importTexture("TAA history", m_temporalAA.getOutput());
+    if (taa) {
+        m_renderGraph.addPass("TAA",
+            [&](RenderGraph::PassBuilder& pass) {
+                pass.read(sceneColor);
+                pass.read(sampledDepth);
+                pass.write(temporalColor);
+            },
+            [this, &sceneColor, &sampledDepth, &viewProj, renderWidth, renderHeight](DeviceContext& deviceContext,
+                const RenderGraph& graph) {
+                GpuProfiler::Scope gpuScope(m_gpuProfiler, deviceContext, "TAA");
+                m_temporalAA.resolve(deviceContext, graph.getTexture(sceneColor).srv, graph.getTexture(sampledDepth).srv,
+                    renderWidth, renderHeight, viewProj);
+            });
+        postColor = temporalColor;
+        postWidth = m_outputWidth;
+        postHeight = m_outputHeight;
+    }
+
+    // HDR: bloom y exposición leen la escena; el pase final la lleva al back buffer con
+    // la UI, que se dibuja antes en su propio target. Si hay una captura pendiente la UI
+    // va después, sobre el back buffer, para que la captura salga sin ella.
+    const bool bloom = hdr && cvBloom.get();
+    const bool autoExposure = hdr && cvAutoExposure.get();
+    // Los sprites del HUD y las líneas de depuración van sobre la escena ya en LDR, así
+    // que tampoco la llevan: la UI tiene que quedar encima.
+    const bool hudSprites = m_sprites.hasSprites();
+#if defined(PROFILE)
+    const bool debugLines = m_debugDraw.hasLines();
+#else
+    const bool debugLines = false;
+#endif
+    // En el panel la escena no lleva la UI: la UI se dibuja después, en el back buffer.
+    const bool composeInterface = hdr && !m_renderToViewport && m_userInterface.hasDrawData() &&
+        m_screenshot.getPendingCount() == 0 && !m_frameCapture.isRecording() && !hudSprites && !debugLines;
+    RenderGraph::ResourceHandle bloomDown[PostProcess::kBloomLevels];
+    RenderGraph::ResourceHandle bloomUp[PostProcess::kBloomLevels - 1];
+    RenderGraph::ResourceHandle interfaceColor = RenderGraph::kInvalidResource;
+    const RenderGraph::ResourceHandle exposure = m_renderGraph.importTexture("Exposure");
+    if (hdr) {
+        PostProcess::Settings settings = m_postProcess.getSettings();
+        settings.bloomThreshold = cvBloomThreshold.get();
+        settings.bloomIntensity = cvBloomIntensity.get();
+        settings.autoExposure = autoExposure;
+        settings.exposure = cvExposure.get();
+        settings.gamma = (std::max)(cvGamma.get(), 0.1f);
+        m_postProcess.setSettings(settings);
+    }
+    if (bloom) {
+        m_renderGraph.addPass("Bloom",
+            [&](RenderGraph::PassBuilder& pass) {
+                pass.read(postColor);
+                for (unsigned int level = 0; level < PostProcess::kBloomLevels; ++level) {
+                    bloomDown[level] = pass.create("Bloom down", PostProcess::bloomDesc(postWidth, postHeight, level));
+                }
+                for (unsigned int level = 0; level + 1 < PostProcess::kBloomLevels; ++level) {
+                    bloomUp[level] = pass.create("Bloom up", PostProcess::bloomDesc(postWidth, postHeight, level));
+                }
+            },
+            [this, &postColor, &bloomDown, &bloomUp, postWidth, postHeight](DeviceContext& deviceContext,
+                const RenderGraph& graph) {
+                GpuProfiler::Scope gpuScope(m_gpuProfiler, deviceContext, "Bloom");
+                RenderTargetPool::Target down[PostProcess::kBloomLevels];
+                RenderTargetPool::Target up[PostProcess::kBloomLevels - 1];
+                for (unsigned int level = 0; level < PostProcess::kBloomLevels; ++level) {
+                    down[level] = graph.getTexture(bloomDown[level]);
+                    if (level + 1 < PostProcess::kBloomLevels) {
+                        up[level] = graph.getTexture(bloomUp[level]);
+                    }
+                }
+                m_postProcess.bloom(deviceContext, graph.getTexture(postColor).srv, down, up,
+                    postWidth, postHeight);
+            });
+    }
+    if (autoExposure) {
+        m_renderGraph.addPass("Exposure",
+            [&](RenderGraph::PassBuilder& pass) {
+                pass.read(postColor);
+                pass.write(exposure);
+            },
+            [this, &postColor, postWidth, postHeight](DeviceContext& deviceContext, const RenderGraph& graph) {
+                GpuProfiler::Scope gpuScope(m_gpuProfiler, deviceContext, "Exposure");
+                m_postProcess.exposure(deviceContext, graph.getTexture(postColor).srv,
+                    postWidth, postHeight, m_renderDeltaTime);
+            });
+    }
+    if (composeInterface) {
+        m_renderGraph.addPass("Interface",
+            [&](RenderGraph::PassBuilder& pass) {
+                interfaceColor = pass.create("Interface", PostProcess::interfaceDesc(m_window.m_width, m_window.m_height));
+            },
+            [this, &interfaceColor](DeviceContext& deviceContext, const RenderGraph& graph) {
+                PROFILE_ZONE("UserInterface::render");
+                GpuProfiler::Scope gpuScope(m_gpuProfiler, deviceContext, "ImGui");
+                static const float kTransparent[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+                ID3D11RenderTargetView* rtv = graph.getTexture(interfaceColor).rtv;
+                deviceContext.OMSetRenderTargets(1, &rtv, nullptr);
+                deviceContext.ClearRenderTargetView(rtv, kTransparent);
+                m_viewport.render(deviceContext);
+                m_userInterface.render();
+            });
+    }
+    if (hdr) {
+        m_renderGraph.addPass("Tonemap",
+            [&](RenderGraph::PassBuilder& pass) {
+                pass.read(postColor);
+                if (bloom) {
+                    pass.read(bloomUp[0]);
+                }
+                if (autoExposure) {
+                    pass.read(exposure);
+                }
+                if (composeInterface) {
+                    pass.read(interfaceColor);
+                }
+                pass.write(output);
+            },
+            [this, &postColor, &bloomUp, &interfaceColor, bloom, composeInterface, output](DeviceContext& deviceContext, const RenderGraph& graph) {
+                GpuProfiler::Scope gpuScope(m_gpuProfiler, deviceContext, "Tonemap");
+                m_postProcess.resolve(deviceContext, graph.getTexture(postColor).srv,
+                    bloom ? graph.getTexture(bloomUp[0]).srv : nullptr,
+                    composeInterface ? graph.getTexture(interfaceColor).srv : nullptr,
+                    graph.getTexture(output).rtv, m_outputWidth, m_outputHeight);
+            });
+    }
+    // Sin HDR, la escena a resolución reducida o la salida del TAA (ya del tamaño de la
+    // ventana: Catmull-Rom a la misma escala es una copia) se sube aquí (con HDR, en "Tonemap").
+    else if (offscreen) {
+        m_renderGraph.addPass("Upscale",
+            [&](RenderGraph::PassBuilder& pass) {
+                pass.read(postColor);
+                pass.write(output);
+            },
+            [this, &postColor, output](DeviceContext& deviceContext, const RenderGraph& graph) {
+                GpuProfiler::Scope gpuScope(m_gpuProfiler, deviceContext, "Upscale");
+                m_dynamicResolution.upscale(deviceContext, graph.getTexture(postColor).srv,
+                    graph.getTexture(output).rtv, m_outputWidth, m_outputHeight);
+            });
+    }
+
+    // HUD del juego: forma parte de la imagen, así que entra en capturas y grabaciones.
+    if (hudSprites) {
+        m_renderGraph.addPass("Sprites",
+            [&](RenderGraph::PassBuilder& pass) {
+                pass.write(output);
+            },
+            [this, output](DeviceContext& deviceContext, const RenderGraph& graph) {
+                GpuProfiler::Scope gpuScope(m_gpuProfiler, deviceContext, "Sprites");
+                m_sprites.render(deviceContext, m_textureArrays.isReady() ? &m_textureArrays : nullptr,
+                    graph.getTexture(output).rtv, m_outputWidth, m_outputHeight);
+            });
+    }
+
+    // Capturas y grabación: la escena sin la UI (la UI escribe después en el back buffer).
+    m_renderGraph.addPass("Capture",
+        [&](RenderGraph::PassBuilder& pass) {
+            pass.read(output);
+            pass.sideEffect();  // archivos en disco
+        },
+        [this](DeviceContext& deviceContext, const RenderGraph&) {
+            Texture& captured = m_renderToViewport ? m_editorViewport.getTexture() : m_backBuffer;
+            m_screenshot.update(deviceContext, captured);
+            m_frameCapture.update(deviceContext, captured);
+            m_remoteStream.submit(deviceContext, captured);
+        });
+
+#if defined(PROFILE)
+    // Después de las capturas (salen limpias) y antes de la UI. La profundidad de la
+    // escena solo sirve si tiene una muestra y el tamaño de la salida.
+    if (debugLines) {
+        const bool debugDepth = !msaa && renderWidth == m_outputWidth && renderHeight == m_outputHeight;
+        m_renderGraph.addPass("Debug draw",
+            [&](RenderGraph::PassBuilder& pass) {
+                if (debugDepth) {
+                    pass.read(depth);
+                }
+                pass.write(output);
+            },
+            [this, &depth, &viewProj, output, debugDepth](DeviceContext& deviceContext, const RenderGraph& graph) {
+                GpuProfiler::Scope gpuScope(m_gpuProfiler, deviceContext, "Debug draw");
+                m_debugDraw.render(deviceContext, graph.getTexture(output).rtv,
+                    debugDepth ? graph.getTexture(depth).dsv : nullptr, m_outputWidth, m_outputHeight, viewProj);
+            });
+    }
+#endif
+
+    // Sin listas (modo jugador) no hay pase de UI.
+    if (!composeInterface && (m_renderToViewport || m_userInterface.hasDrawData())) {
+        // En el panel, la UI llena el back buffer (limpio) y muestra el target de la escena.
+        m_renderGraph.addPass("ImGui",
+            [&](RenderGraph::PassBuilder& pass) {
+                if (output != backBuffer) {
+                    pass.read(output);
+                }
+                pass.write(backBuffer);
+            },
+            [this](DeviceContext& deviceContext, const RenderGraph&) {
+                PROFILE_ZONE("UserInterface::render");
+                GpuProfiler::Scope gpuScope(m_gpuProfiler, deviceContext, "ImGui");
+                if (m_renderToViewport) {
+                    deviceContext.ClearRenderTargetView(m_renderTargetView.m_renderTargetView, kClear);
+                    m_renderTargetView.render(deviceContext, 1);
+                    m_viewport.render(deviceContext);
+                }
+                m_userInterface.render();
+            });
+    }
+
+    {
+        PROFILE_ZONE("RenderGraph::compile");
+        m_renderTargetPool.update();
+        m_renderGraph.compile(m_device, m_renderTargetPool);
+    }
+    m_renderGraph.execute(m_deviceContext);
+
+    m_gpuProfiler.endFrame(m_deviceContext);
+    {
+        PROFILE_ZONE("Present");
+        m_swapChain.present();
+    }
+    StartupTimeline::getDefault().markFirstFrame();
+}
+
+/**
+ * @brief Frame de solo UI: el panel "Viewport" está oculto, así que no se cullea ni se
+ * dibuja la escena (ni sombras, ni sondas, ni post).
+ *
+ * @details Mismo grafo mínimo que el pase "ImGui" de @ref render: limpia el back buffer,
+ * dibuja la UI y presenta. `m_gpuProfiler.beginFrame` ya se llamó.
+ */
+void BaseApp::renderInterfaceOnly() {
+    m_renderGraph.reset();
+    RenderGraph::TextureViews backBufferViews;
+    backBufferViews.texture = m_backBuffer.raw();
+    backBufferViews.rtv = m_renderTargetView.m_renderTargetView;
+    const RenderGraph::ResourceHandle backBuffer = m_renderGraph.importTexture("Back buffer", backBufferViews);
+    m_renderGraph.addPass("ImGui",
+        [&](RenderGraph::PassBuilder& pass) { pass.write(backBuffer); },
+        [this](DeviceContext& deviceContext, const RenderGraph&) {
+            PROFILE_ZONE("UserInterface::render");
+            GpuProfiler::Scope gpuScope(m_gpuProfiler, deviceContext, "ImGui");
+            deviceContext.ClearRenderTargetView(m_renderTargetView.m_renderTargetView, kClear);
+            m_renderTargetView.render(deviceContext, 1);
+            m_viewport.render(deviceContext);
+            m_userInterface.render();
+        });
+    {
+        PROFILE_ZONE("RenderGraph::compile");
+        m_renderTargetPool.update();
+        m_renderGraph.compile(m_device, m_renderTargetPool);
+    }
+    m_renderGraph.execute(m_deviceContext);
+
+    m_gpuProfiler.endFrame(m_deviceContext);
+    {
+        PROFILE_ZONE("Present");
+        m_swapChain.present();
+    }
+    StartupTimeline::getDefault().markFirstFrame();
+}
+
+/**
+ * @brief Pase "Shadows": cascadas de sombra, con su propio DSV y viewport.
+ *
+ * Los casters van todos, se vean o no: su sombra puede caer en algo visible.
+ */
+void BaseApp::renderShadows(DeviceContext& deviceContext) {
+    PROFILE_ZONE("Shadows");
+    FrameWatchdog::Scope watchdogScope(m_watchdog, BUDGET_SUBMISSION);
+    GpuProfiler::Scope gpuScope(m_gpuProfiler, deviceContext, "Shadows");
+
+    // Caja de los casters (alarga las cascadas hacia la luz) y huella de los estáticos.
+    XMFLOAT3 casterMin(0.0f, 0.0f, 0.0f);
+    XMFLOAT3 casterMax(0.0f, 0.0f, 0.0f);
+    bool hasCasters = false;
+    uint64_t staticHash = EU::kFnv1aSeed;
+    for (size_t i = 0; i < m_actors.size(); ++i) {
+        XMFLOAT3 mn, mx;
+        if (m_actors[i].isNull() || !m_actors[i]->canCastShadow() || !m_actors[i]->getWorldBounds(mn, mx)) {
+            continue;
+        }
+        if (!hasCasters) {
+            casterMin = mn;
+            casterMax = mx;
+            hasCasters = true;
+        }
+        XMStoreFloat3(&casterMin, XMVectorMin(XMLoadFloat3(&casterMin), XMLoadFloat3(&mn)));
+        XMStoreFloat3(&casterMax, XMVectorMax(XMLoadFloat3(&casterMax), XMLoadFloat3(&mx)));
+        if (m_actors[i]->isStatic()) {
+            EU::Fnv1a(staticHash, &i, sizeof(i));
+            EU::Fnv1a(staticHash, &mn, sizeof(mn));
+            EU::Fnv1a(staticHash, &mx, sizeof(mx));
+        }
+    }
+    // Un caster estático que se mueve (o deja de serlo) invalida las cascadas en caché.
+    if (staticHash != m_staticCasterHash) {
+        m_staticCasterHash = staticHash;
+        m_shadowMap.invalidate();
+    }
+    m_shadowMap.update(m_LightPos, m_renderCamera.getView(), m_renderCamera.getProjection(),
+        m_renderCamera.getNearZ(), m_renderCamera.getFarZ(), casterMin, casterMax);
+
+    // Las cascadas con casters dinámicos hay que redibujarlas; las demás, solo si cambiaron.
+    bool dynamicCasters[ShadowMap::kCascadeCount] = {};
+    for (auto& a : m_actors) {
+        if (a.isNull() || !a->canCastShadow() || a->isStatic()) continue;
+        XMFLOAT3 mn, mx;
+        const bool hasBounds = a->getWorldBounds(mn, mx);
+        for (unsigned int c = 0; c < ShadowMap::kCascadeCount; ++c) {
+            dynamicCasters[c] = dynamicCasters[c] || !hasBounds || m_shadowMap.intersects(c, mn, mx);
+        }
+    }
+    m_shadowMap.schedule(dynamicCasters, m_shadowCascades);
+
+    for (unsigned int cascade : m_shadowCascades) {
+        RenderQueue& queue = m_shadowQueues[cascade];
+        queue.update(m_shadowMap.getLightView());
+        for (auto& a : m_actors) {
+            if (a.isNull() || !a->canCastShadow()) continue;
+            XMFLOAT3 mn, mx;
+            if (!a->getWorldBounds(mn, mx) || m_shadowMap.intersects(cascade, mn, mx)) {
+                a->submit(queue);
+            }
+        }
+        char cascadeName[16] = "";
+        if (deviceContext.areEventMarkersActive()) {
+            sprintf_s(cascadeName, "Cascade %u", cascade);
+        }
+        DeviceContext::EventScope cascadeEvent(deviceContext, cascadeName);
+        m_shadowMap.begin(deviceContext, cascade);
+        queue.renderDepthOnly(deviceContext, true); // alpha test: sombra sólida
+    }
+}
+
+/**
+ * @brief Culling compartido de las vistas del frame.
+ *
+ * Dos BVH de cajas (identificador = posición en m_actors): la estática solo se
+ * reconstruye si cambian sus actores; en la dinámica solo se reajustan las hojas de los
+ * que se movieron, y se reconstruye si cambia su conjunto (aquí) o se degrada (en un
+ * hilo). Cada árbol se recorre una vez para todas las vistas (`SceneBVH::cullViews`):
+ * la cámara del frame y las caras de sonda que tocan, y los subárboles que no ve
+ * ninguna se descartan enteros. Las caras de sondas estáticas ignoran el árbol dinámico.
+ */
+void BaseApp::cullViews() {
+    PROFILE_ZONE("Culling");
+    FrameWatchdog::Scope watchdogScope(m_watchdog, BUDGET_CULLING);
+    m_frustum = m_renderCamera.getFrustum();
+    m_visibleActors.clear();
+    m_untreedActors.clear();
+    m_staticItems.clear();
+    m_dynamicItems.clear();
+    // Los actores que acepta el camino GPU-driven se cullean en GPU: no entran en los
+    // árboles para no enviarlos también a la cola.
+    const bool gpuDriven = m_gpuDriven && m_gpuCulling.isReady();
+    const XMMATRIX view = m_renderCamera.getView();
+    // `r.lodBias` escala el tamaño en pantalla con el que se elige el LOD.
+    const float projScaleY = XMVectorGetY(m_renderCamera.getProjection().r[1]) * std::clamp(cvLodBias.get(), 0.1f, 4.0f);
+    if (gpuDriven) {
+        m_gpuCulling.begin();
+    }
+    // PVS: los estáticos que no ve la celda de la cámara no llegan a la vista 0.
+    const bool pvs = cvPvs.get() && m_visibility.isLoaded();
+    if (pvs) {
+        m_visibility.update(m_actors, m_renderCamera.getPosition(), cvPvsPortals.get());
+    }
+    uint64_t staticHash = EU::kFnv1aSeed;
+    bool sameDynamic = true;
+    m_movedItems.clear();
+    m_actorBounds.resize(m_actors.size());
+    for (size_t i = 0; i < m_actors.size(); ++i) {
+        ActorHandle& a = m_actors[i];
+        if (a.isNull()) continue;
+        // Los que oculta el PVS van por los árboles: la cámara los descarta y las
+        // caras de sonda los siguen viendo.
+        if (gpuDriven && !(pvs && m_visibility.isHidden(static_cast<unsigned int>(i)))) {
+            a->updateLOD(view, projScaleY);
+            if (m_gpuCulling.submit(*a)) {
+                requestActorTexels(*a);
+                m_untreedActors.push_back(static_cast<unsigned int>(i));
+                continue;
+            }
+        }
+        // La caja solo se transforma otra vez si `capture` copió algo nuevo.
+        CachedBounds& cached = m_actorBounds[i];
+        bool moved = false;
+        if (cached.actor != a.value || cached.version != a->getRenderVersion()) {
+            cached.actor = a.value;
+            cached.version = a->getRenderVersion();
+            cached.bounded = a->getWorldBounds(cached.boundsMin, cached.boundsMax);
+            moved = true;
+        }
+        SceneBVH::Item item;
+        item.id = static_cast<unsigned int>(i);
+        item.boundsMin = cached.boundsMin;
+        item.boundsMax = cached.boundsMax;
+        if (!cached.bounded) {
+            m_visibleActors.push_back(item.id); // sin volumen: siempre visible
+            m_untreedActors.push_back(item.id);
+        }
+        else if (a->isStatic()) {
+            EU::Fnv1a(staticHash, &item, sizeof(item));
+            m_staticItems.push_back(item);
+        }
+        else {
+            // Mismo actor en la misma posición de la lista que al construir: basta reajustar.
+            const size_t slot = m_dynamicItems.size();
+            const uint64_t key = (static_cast<uint64_t>(a.value) << 32) | item.id;
+            if (slot >= m_dynamicKeys.size()) {
+                m_dynamicKeys.push_back(key);
+                sameDynamic = false;
+            }
+            else if (m_dynamicKeys[slot] != key) {
+                m_dynamicKeys[slot] = key;
+                sameDynamic = false;
+            }
+            if (moved) {
+                m_movedItems.push_back(static_cast<unsigned int>(slot));
+            }
+            m_dynamicItems.push_back(item);
+        }
+    }
+    if (staticHash != m_staticTreeHash) {
+        m_staticTreeHash = staticHash;
+        m_staticTree.build(m_staticItems);
+    }
+    if (m_dynamicKeys.size() != m_dynamicItems.size()) {
+        m_dynamicKeys.resize(m_dynamicItems.size());
+        sameDynamic = false;
+    }
+    if (!sameDynamic) {
+        m_dynamicTree.build(m_dynamicItems);
+    }
+    else {
+        for (unsigned int slot : m_movedItems) {
+            const SceneBVH::Item& item = m_dynamicItems[slot];
+            m_dynamicTree.setBounds(slot, item.boundsMin, item.boundsMax);
+        }
+        m_dynamicTree.update();
+    }
+    // Las consultas de `captureFrame` usan estos árboles y los actores a los que apuntan.
+    m_sceneQuery.setScene(m_staticTree, m_dynamicTree, m_actors);
+
+    // Vista 0 = cámara del frame; las siguientes, una por cara de sonda.
+    const Frustum* frusta[SceneBVH::kMaxViews] = { &m_frustum };
+    unsigned int viewCount = 1;
+    uint32_t staticOnlyViews = 0;
+    m_probeCameras.resize(m_probeFaces.size());
+    m_probeVisible.resize(m_probeFaces.size());
+    const XMMATRIX faceProjection = ReflectionProbes::getFaceProjection();
+    for (size_t f = 0; f < m_probeFaces.size() && viewCount < SceneBVH::kMaxViews; ++f) {
+        Camera& camera = m_probeCameras[f];
+        camera.setView(m_reflectionProbes.getFaceView(m_probeFaces[f]));
+        camera.setProjection(faceProjection, ReflectionProbes::kNearZ, ReflectionProbes::kFarZ);
+        if (m_reflectionProbes.getProbe(m_probeFaces[f].probe).isStatic) {
+            staticOnlyViews |= 1u << viewCount;
+        }
+        m_probeVisible[f].clear();
+        frusta[viewCount++] = &camera.getFrustum();
+    }
+
+    const size_t unbounded = m_visibleActors.size();
+    m_viewHits.clear();
+    m_staticTree.cullViews(frusta, viewCount, m_viewHits);
+    const size_t staticHits = m_viewHits.size();
+    m_dynamicTree.cullViews(frusta, viewCount, m_viewHits);
+    for (size_t h = 0; h < m_viewHits.size(); ++h) {
+        const SceneBVH::ViewHit& hit = m_viewHits[h];
+        const uint32_t mask = h < staticHits ? hit.viewMask : (hit.viewMask & ~staticOnlyViews);
+        if ((mask & 1u) && !(pvs && m_visibility.isHidden(hit.id))) {
+            m_visibleActors.push_back(hit.id);
+        }
+        for (unsigned int v = 1; v < viewCount; ++v) {
+            if (mask & (1u << v)) {
+                m_probeVisible[v - 1].push_back(hit.id);
+            }
+        }
+    }
+    m_culledActors = static_cast<unsigned int>(unbounded + m_staticItems.size() + m_dynamicItems.size() -
+        m_visibleActors.size());
+
+    // Fuera de los árboles: los que no tienen caja (siempre) y los GPU-driven, que la
+    // cámara cullea en GPU pero las caras dibujan con la cola.
+    for (unsigned int v = 1; v < viewCount; ++v) {
+        const bool staticOnly = (staticOnlyViews & (1u << v)) != 0;
+        for (unsigned int index : m_untreedActors) {
+            const ActorHandle& a = m_actors[index];
+            if (staticOnly && !a->isStatic()) continue;
+            XMFLOAT3 mn, mx;
+            if (!a->getWorldBounds(mn, mx) || frusta[v]->intersectsAABB(mn, mx)) {
+                m_probeVisible[v - 1].push_back(index);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Elige las caras de sonda del frame (antes de @ref cullViews, que las cullea
+ * junto con la cámara).
+ *
+ * Las sondas estáticas no se capturan con texturas pendientes. Como mucho
+ * `SceneBVH::kMaxViews - 1` caras: las demás vistas del recorrido compartido.
+ */
+void BaseApp::scheduleReflectionProbes() {
+    PROFILE_ZONE("ReflectionProbes::schedule");
+    // Huella de lo que ven las estáticas (nombre de su caché): actores estáticos y sol.
+    uint64_t sceneHash = EU::kFnv1aSeed;
+    for (size_t i = 0; i < m_actors.size(); ++i) {
+        XMFLOAT3 mn, mx;
+        if (m_actors[i].isNull() || !m_actors[i]->isStatic() || !m_actors[i]->getWorldBounds(mn, mx)) {
+            continue;
+        }
+        EU::Fnv1a(sceneHash, &i, sizeof(i));
+        EU::Fnv1a(sceneHash, &mn, sizeof(mn));
+        EU::Fnv1a(sceneHash, &mx, sizeof(mx));
+    }
+    EU::Fnv1a(sceneHash, &m_LightPos, sizeof(m_LightPos));
+    m_reflectionProbes.setSceneHash(sceneHash);
+    const unsigned int budget = (std::min)(static_cast<unsigned int>((std::max)(cvProbeFacesPerFrame.get(), 0)),
+        SceneBVH::kMaxViews - 1);
+    m_reflectionProbes.schedule(m_deviceContext, budget, m_textureLoader.getPendingCount() == 0, m_probeFaces);
+}
+
+/**
+ * @brief Pase "Reflection probes": caras de sonda del frame, cada una con su cámara.
+ *
+ * Los actores de cada cara salen del culling compartido (@ref cullViews): las sondas
+ * estáticas solo ven actores estáticos (su captura se guarda en disco); las dinámicas
+ * ven todo. Cada actor usa el LOD que eligió la cámara en el frame anterior.
+ */
+void BaseApp::renderReflectionProbes(DeviceContext& deviceContext) {
+    PROFILE_ZONE("Reflection probes");
+    GpuProfiler::Scope gpuScope(m_gpuProfiler, deviceContext, "Reflection probes");
+    if (m_probeFaces.empty()) {
+        return;
+    }
+
+    m_shaderProgram.render(deviceContext);
+    m_shadowMap.bind(deviceContext);
+    for (size_t f = 0; f < m_probeFaces.size(); ++f) {
+        const ReflectionProbes::Face& face = m_probeFaces[f];
+        const ReflectionProbes::Probe& probe = m_reflectionProbes.getProbe(face.probe);
+        m_probeQueue.update(m_probeCameras[f].getView());
+        for (unsigned int index : m_probeVisible[f]) {
+            if (!m_actors[index].isNull()) {
+                m_actors[index]->submit(m_probeQueue);
+            }
+        }
+        m_reflectionProbes.beginFace(deviceContext, face, kClear);
+        m_clusteredLighting.bindCapture(deviceContext, probe.position);
+        m_probeQueue.render(deviceContext, RENDER_LAYER_OPAQUE);
+        m_probeQueue.render(deviceContext, RENDER_LAYER_ALPHA_TESTED);
+        // Los paquetes sin programa propio usan el enlazado: devolver el de por defecto.
+        m_shaderProgram.render(deviceContext);
+        m_probeQueue.render(deviceContext, RENDER_LAYER_TRANSPARENT);
+        m_reflectionProbes.endFace(deviceContext, face);
+    }
+}
+
+/**
+ * @brief Pase "Scene": limpia y enlaza el color de la escena (o G-buffer) y profundidad,
+ * cullea, envía y dibuja.
+ * @param dsv Profundidad transitoria del grafo.
+ * @param target Back buffer o target HDR; solo en forward.
+ * @param gbuffer Albedo y superficie del camino diferido; nulo = forward.
+ */
+void BaseApp::renderScene(DeviceContext& deviceContext, ID3D11DepthStencilView* dsv,
+    ID3D11RenderTargetView* target, ID3D11RenderTargetView* const* gbuffer) {
+    // Limpiar y bind RTV/DSV. La superficie a cero marca los píxeles sin G-buffer (fondo
+    // y shaders que no lo escriben): su albedo es ya el color final.
+    {
+        GpuProfiler::Scope gpuScope(m_gpuProfiler, deviceContext, "Clear");
+        if (gbuffer) {
+            static const float kNoSurface[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+            deviceContext.OMSetRenderTargets(2, gbuffer, dsv);
+            deviceContext.ClearRenderTargetView(gbuffer[0], kClear);
+            deviceContext.ClearRenderTargetView(gbuffer[1], kNoSurface);
+        }
+        else {
+            deviceContext.OMSetRenderTargets(1, &target, dsv);
+            deviceContext.ClearRenderTargetView(target, kClear);
+        }
+        deviceContext.ClearDepthStencilView(dsv, D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
+    }
+    m_sceneViewport.render(deviceContext);
+
+    // Pipeline
+    m_shaderProgram.render(deviceContext);
+
+    // Constantes
+    m_neverChanges.render(deviceContext, CB_SLOT_VIEW);
+    m_changeOnResize.render(deviceContext, CB_SLOT_PROJECTION);
+    m_shadowMap.bind(deviceContext);
+    m_clusteredLighting.setGBufferOutput(deviceContext, gbuffer != nullptr);
+    m_clusteredLighting.bind(deviceContext);
+    m_reflectionProbes.bind(deviceContext);
+
+    // Culling: la lista de frustum sale de @ref cullViews; aquí queda la oclusión contra
+    // la pirámide Hi-Z y el culling en GPU.
+    {
+        PROFILE_ZONE("Culling");
+        FrameWatchdog::Scope watchdogScope(m_watchdog, BUDGET_CULLING);
+        const bool gpuDriven = m_gpuDriven && m_gpuCulling.isReady();
+
+        // Oclusión: se prueban solo los que pasaron el frustum (compactando la lista).
+        m_occludedActors = 0;
+        if (cvOcclusionCulling.get() && m_hiZ.hasData()) {
+            size_t kept = 0;
+            for (unsigned int index : m_visibleActors) {
+                XMFLOAT3 mn, mx;
+                if (!m_actors[index].isNull() && m_actors[index]->getWorldBounds(mn, mx) &&
+                    m_hiZ.isOccluded(mn, mx)) {
+                    ++m_occludedActors;
+                    continue;
+                }
+                m_visibleActors[kept++] = index;
+            }
+            m_visibleActors.resize(kept);
+        }
+
+        if (gpuDriven) {
+            m_gpuCulling.cull(deviceContext, m_frustum, m_hiZ);
+        }
+        // Hierba y piedras: tiles en CPU, instancias en GPU con el mismo frustum y Hi-Z.
+        if (m_scatter.isActive() && m_terrain.isActive()) {
+            m_scatter.generate(deviceContext, m_terrain, m_frustum, m_hiZ, m_renderCamera.getPosition());
+        }
+    }
+
+    // LOD por tamaño proyectado (P[1][1] = cot(fovY/2)) antes de enviar los paquetes.
+    // El mismo tamaño, en píxeles y dividido por la extensión de las UV, es la
+    // resolución que se pide al streaming de texturas.
+    {
+        PROFILE_ZONE("Submit");
+        FrameWatchdog::Scope watchdogScope(m_watchdog, BUDGET_SUBMISSION);
+        const XMMATRIX view = m_renderCamera.getView();
+        const float projScaleY = XMVectorGetY(m_renderCamera.getProjection().r[1]) * std::clamp(cvLodBias.get(), 0.1f, 4.0f);
+        m_renderQueue.update(view);
+        m_occlusionPredicates.begin();
+        m_impostors.begin();
+        for (unsigned int index : m_visibleActors) {
+            if (m_actors[index].isNull()) continue;
+            Actor& actor = *m_actors[index];
+            actor.updateLOD(view, projScaleY);
+            // Lejos: un quad del atlas en lugar de la malla (ni cola ni texturas a pedir).
+            if (cvImpostors.get() && m_impostors.add(actor, m_renderQueue.getViewPosition())) {
+                continue;
+            }
+            // Los actores con occlusion query se dibujan aparte, tras los opacos.
+            if (!m_occlusionPredicates.add(actor)) {
+                actor.submit(m_renderQueue);
+            }
+            requestActorTexels(actor);
+        }
+    }
+
+    // Pre-pase de profundidad: Z de los opacos sin pixel shader; el pase principal
+    // compara con EQUAL sin escribir Z, así cada píxel se sombrea una sola vez.
+    const bool prepass = m_depthPrepass && cvDepthPrepass.get() && m_renderQueue.hasDepthPrograms();
+    {
+        PROFILE_ZONE("Draw");
+        FrameWatchdog::Scope watchdogScope(m_watchdog, BUDGET_SUBMISSION);
+        GpuProfiler::Scope gpuScope(m_gpuProfiler, deviceContext, "Actors");
+        if (prepass) {
+            GpuProfiler::Scope prepassScope(m_gpuProfiler, deviceContext, "Depth pre-pass");
+            m_renderQueue.renderDepthOnly(deviceContext);
+            m_depthEqualState.render(deviceContext, 0);
+        }
+        {
+            GpuProfiler::Scope opaqueScope(m_gpuProfiler, deviceContext, "Opaque");
+            m_renderQueue.render(deviceContext, RENDER_LAYER_OPAQUE);
+        }
+        if (prepass) {
+            m_depthEqualState.render(deviceContext, 0, true); // vuelve al estado por defecto
+        }
+        // No están en el pre-pase: se dibujan después, con el depth test normal.
+        if (m_renderQueue.getPacketCount(RENDER_LAYER_ALPHA_TESTED) > 0) {
+            GpuProfiler::Scope alphaTestScope(m_gpuProfiler, deviceContext, "Alpha-tested");
+            m_renderQueue.render(deviceContext, RENDER_LAYER_ALPHA_TESTED);
+        }
+        if (m_gpuDriven && m_gpuCulling.isReady()) {
+            GpuProfiler::Scope gpuDrivenScope(m_gpuProfiler, deviceContext, "GPU-driven");
+            m_gpuCulling.render(deviceContext);
+        }
+    }
+    // Terreno: fuera del pre-pase, con el depth test normal. Usa b2, que la cola vuelve a
+    // subir en su siguiente objeto.
+    if (m_terrain.isActive()) {
+        PROFILE_ZONE("Terrain");
+        GpuProfiler::Scope terrainScope(m_gpuProfiler, deviceContext, "Terrain");
+        m_terrain.render(deviceContext, m_frustum, m_renderCamera.getView(),
+            XMMatrixTranspose(m_changeOnResize.get().mProjection), m_renderCamera.getPosition(),
+            m_sceneViewport.m_viewport.Height);
+    }
+    // Hierba y piedras generadas en el bloque de culling; también usan b2.
+    if (m_scatter.isActive() && m_terrain.isActive()) {
+        PROFILE_ZONE("Terrain scatter");
+        GpuProfiler::Scope scatterScope(m_gpuProfiler, deviceContext, "Terrain scatter");
+        m_scatter.render(deviceContext);
+    }
+    // En diferido el resto va tras la iluminación (pase "Forward").
+    if (!gbuffer) {
+        renderForwardLayers(deviceContext);
+    }
+}
+
+/**
+ * @brief Capas que no pasan por el G-buffer: impostores, actores con occlusion query
+ * (se prueban contra lo opaco ya dibujado) y transparentes, sobre el RTV y la
+ * profundidad enlazados.
+ */
+void BaseApp::renderForwardLayers(DeviceContext& deviceContext) {
+    PROFILE_ZONE("Draw forward");
+    FrameWatchdog::Scope watchdogScope(m_watchdog, BUDGET_SUBMISSION);
+    if (m_impostors.getInstanceCount() > 0) {
+        GpuProfiler::Scope impostorScope(m_gpuProfiler, deviceContext, "Impostors");
+        m_impostors.render(deviceContext, m_renderQueue.getViewPosition());
+    }
+    // Sus cajas se prueban contra todo lo opaco ya dibujado.
+    if (m_occlusionPredicates.getActorCount() > 0) {
+        GpuProfiler::Scope predicatedScope(m_gpuProfiler, deviceContext, "Predicated");
+        m_occlusionPredicates.render(deviceContext, m_renderQueue.getViewPosition(), m_renderCamera.getNearZ(),
+            m_shaderProgram, m_shadowMap.isEnabled() ? &m_receiverProgram : nullptr);
+    }
+    // Los paquetes sin programa propio usan el enlazado: devolver el de por defecto.
+    m_shaderProgram.render(deviceContext);
+
+    GpuProfiler::Scope transparentScope(m_gpuProfiler, deviceContext, "Transparent");
+    m_renderQueue.render(deviceContext, RENDER_LAYER_TRANSPARENT);
+}
+
+/**
+ * @brief Libera todos los recursos gráficos y de la escena.
+ *
+ * - Cierra ImGui correctamente (evita Live Objects).
+ * - Limpia actores y sus recursos.
+ * - Destruye buffers, shaders, texturas y vistas.
+ * - Libera el estado del contexto y las referencias del dispositivo.
+ *
+ * @note Llamado al cerrar la aplicación (o si falla @ref init) para evitar fugas de memoria.
+ */
+void BaseApp::destroy() {
+    // Primero el hilo de render: termina su frame antes de liberar nada.
+    m_renderThread.destroy();
+    // Sin más frames: lo pendiente se suelta ya y el resto del cierre libera en el acto.
+    GpuReleaseQueue::getDefault().flush();
+    // El guardado en curso solo usa su copia de la escena: se deja terminar.
+    m_sceneFile.waitSave();
+
+    // Cierra ImGui correctamente (evita Live Objects)
+    m_userInterface.destroy();
+
+    if (m_deviceContext.m_deviceContext)
+        m_deviceContext.ClearState();
+
+    // Primero los cargadores: sueltan sus referencias a los handles pendientes para que
+    // los actores sean los últimos dueños y liberen sus texturas. La recarga antes que el
+    // `ResourceManager`: sus reimportaciones pendientes la apuntan.
+    m_assetReload.destroy();
+    m_resources.destroy();
+    m_textureLoader.destroy();
+    m_shaderReload.destroy();
+    m_uploads.destroy();
+    m_gpuMemory.destroy();
+    // Lo que siga en vuelo se lee esperando a la GPU; el hilo escribe todo antes de parar.
+    if (m_deviceContext.m_deviceContext) {
+        m_screenshot.flush(m_deviceContext);
+        m_frameCapture.stop(m_deviceContext);
+    }
+    m_screenshot.destroy();
+    m_frameCapture.destroy();
+    m_remoteStream.destroy();
+    m_telemetry.destroy();
+    m_staticBatcher.destroy(m_actors);
+    m_lightmapBaker.clear(m_actors);
+    m_visibility.clear();
+    m_stressScene.destroy(m_actors);
+    m_streamer.destroy(m_actors);
+    for (ActorHandle a : m_actors) {
+        if (!a.isNull()) {
+            a->destroy();
+            ActorPool::getDefault().despawn(a);
+        }
+    }
+    m_actors.clear();
+    m_scenePrefabs.clear();
+    m_sceneImports.clear();
+    m_APlane = ActorHandle();
+    m_meshLibrary.destroy();
+    m_materials.destroy();
+    m_renderQueue.destroy();
+    for (RenderQueue& queue : m_shadowQueues) {
+        queue.destroy();
+    }
+    m_probeQueue.destroy();
+    m_deferredRecorder.destroy();
+    m_shadowMap.destroy();
+    m_clusteredLighting.destroy();
+    m_reflectionProbes.destroy();
+    m_deferredShading.destroy();
+    m_ambientOcclusion.destroy();
+    m_postProcess.destroy();
+    m_dynamicResolution.destroy();
+    m_temporalAA.destroy();
+    m_editorViewport.destroy();
+    m_multisampling.destroy();
+
+    m_neverChanges.destroy();
+    m_changeOnResize.destroy();
+    m_shaderProgram.destroy();
+    m_depthProgram.destroy();
+    m_depthInstancedProgram.destroy();
+    m_receiverProgram.destroy();
+    m_lightmapProgram.destroy();
+    m_instancingVariants.destroy();
+    m_receiverInstancingVariants.destroy();
+    m_gpuCulling.destroy();
+    m_occlusionPredicates.destroy();
+    m_picking.destroy();
+    m_impostors.destroy();
+    m_sprites.destroy();
+    m_particles.destroy();
+    m_scatter.destroy();
+    m_terrain.destroy();
+#if defined(PROFILE)
+    m_debugDraw.destroy();
+#endif
+    m_skinning.destroy();
+    m_animations.clear();
+    m_broadphase.clear();
+    m_physicsBodies.clear();
+    m_rigidBodies.clear();
+    m_textureArrays.destroy();
+    m_depthEqualState.destroy();
+    m_hiZ.destroy();
+    m_renderGraph.destroy();
+    m_renderTargetPool.clear();
+    m_renderTargetView.destroy();
+    m_swapChain.destroy();
+    m_frameLimiter.destroy();
+    m_input.destroy();
+    m_trace.destroy();
+    m_gpuProfiler.destroy();
+    JobSystem::getDefault().destroy();
+    if (m_redrawEvent) {
+        CloseHandle(m_redrawEvent);
+        m_redrawEvent = nullptr;
+    }
+
+    m_deviceContext.destroy();
+    m_device.destroy();
+    // Lo último: ya no queda ningún lector con vistas del paquete.
+    VirtualFileSystem::getDefault().unmountAll();
+}
+
+/**
+ * @brief Método principal que ejecuta el bucle de la aplicación.
+ *
+ * @param hInstance     Instancia de la aplicación.
+ * @param hPrevInstance Instancia previa (no usada).
+ * @param lpCmdLine     Línea de comandos.
+ * @param nCmdShow      Estado de visualización de la ventana.
+ * @param wndproc       Procedimiento de ventana Win32.
+ *
+ * @return Código de salida de la aplicación (valor de @c WM_QUIT).
+ *
+ * @details
+ * - Inicializa la ventana y llama a @ref init.
+ * - Antes de cada frame: minimizada, duerme en `WaitMessage`; en modo reposo sin
+ *   cambios pendientes, bloquea en `MsgWaitForMultipleObjects` hasta que llega entrada
+ *   o @ref requestRedraw; si no, el @ref FrameLimiter acota los FPS.
+ * - Espera a que la GPU tenga hueco (@ref SwapChain::waitForFrame), libera lo soltado en
+ *   frames ya terminados (@ref GpuReleaseQueue), vacía la cola de mensajes Win32
+ *   (entrada) y ejecuta @ref update y @ref render.
+ * - Con `-trace N` graba los N primeros frames a JSON (@ref TraceCapture).
+ * - Con `--benchmark <escena> <recorrido>` recorre la cámara, mide y sale (@ref Benchmark).
+ * - Con `-stress N[,N...]` añade N actores sintéticos (@ref SceneGenerator); junto con
+ *   `--benchmark`, mide cada N por turno y escribe el barrido.
+ * - Al salir, llama a @ref destroy y retorna el código @c wParam del mensaje quit.
+ */
+int BaseApp::run(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCmdLine, int nCmdShow, WNDPROC wndproc) {
+    UNREFERENCED_PARAMETER(hPrevInstance);
+    UNREFERENCED_PARAMETER(lpCmdLine); // Se usa GetCommandLineW: separa bien comillas.
+
+    // Fija el reloj del arranque en el hilo principal, antes de la ventana.
+    StartupTimeline::getDefault();
+    LaunchOptions options;
+    parseCommandLine(options);
+
+    m_headless = options.headlessWidth > 0 && options.headlessHeight > 0;
+    if (m_headless) {
+        // Sin ventana: solo su tamaño, que es el de los targets offscreen.
+        m_window.m_width = options.headlessWidth;
+        m_window.m_height = options.headlessHeight;
+    }
+    else {
+        HRESULT windowResult;
+        {
+            StartupTimeline::Scope timelineScope("Window", "Window::init");
+            windowResult = m_window.init(hInstance, nCmdShow, wndproc);
+        }
+        if (FAILED(windowResult))
+            return 0;
+
+        // WndProc recupera la app desde la ventana para reenviarle WM_SIZE y WM_INPUT.
+        SetWindowLongPtr(m_window.m_hWnd, GWLP_USERDATA, reinterpret_cast<LONG_PTR>(this));
+        // Sin raw input, `m_input` sondea el ratón como antes.
+        m_input.init(m_window.m_hWnd);
+    }
+    m_startupTracePath = options.startupTracePath;
+    if (!options.logPath.empty() && !Logger::getDefault().openFile(options.logPath)) {
+        ERROR("BaseApp", "run", ("Cannot write the log to " + options.logPath).c_str());
+    }
+    // Cvars: Engine.cfg (si existe), luego `-config` y por último cada `-cvar`.
+    ConsoleVariables& cvars = ConsoleVariables::getDefault();
+    cvars.loadFile(ConsoleVariables::kDefaultConfig);
+    if (!options.configPath.empty() && FAILED(cvars.loadFile(options.configPath))) {
+        ERROR("BaseApp", "run", ("Cannot read the config " + options.configPath).c_str());
+    }
+    for (const std::string& assignment : options.cvars) {
+        const size_t equals = assignment.find('=');
+        if (equals == std::string::npos ||
+            cvars.set(assignment.substr(0, equals), assignment.substr(equals + 1)) == E_INVALIDARG) {
+            ERROR("BaseApp", "run", ("Invalid -cvar " + assignment).c_str());
+        }
+    }
+    if (!options.pointerBenchmark.empty()) {
+        // Microbenchmark sin escena: no hace falta el dispositivo.
+        return FAILED(PointerBenchmark::run(options.pointerBenchmark)) ? 1 : 0;
+    }
+    if (!options.cookManifest.empty()) {
+        // Cocinado offline: tampoco necesita dispositivo.
+        return FAILED(AssetCooker::run(options.cookManifest, options.packPath)) ? 1 : 0;
+    }
+    if (!options.splitScene.empty()) {
+        // Partir un nivel en celdas solo lee y escribe archivos.
+        SceneData level;
+        const std::string directory = options.streamPath.empty() ? "Stream" : options.streamPath;
+        return FAILED(SceneFile::read(options.splitScene, level)) ||
+            FAILED(WorldStreamer::split(level, options.cellSize, directory)) ? 1 : 0;
+    }
+    // Antes de cualquier carga: los lectores resuelven sus rutas contra el paquete.
+    const std::string packPath = options.packPath.empty() ? VirtualFileSystem::kDefaultPack : options.packPath;
+    const HRESULT mounted = VirtualFileSystem::getDefault().mount(packPath);
+    if (FAILED(mounted) && (mounted != E_FAIL || !options.packPath.empty())) {
+        ERROR("BaseApp", "run", ("Cannot mount " + packPath + "; reading loose files").c_str());
+    }
+    if (!options.benchmarkScene.empty() && _stricmp(options.benchmarkScene.c_str(), "default") != 0) {
+        m_sceneModel = options.benchmarkScene;
+    }
+    // Streaming de mips: presupuesto de VRAM. En benchmark sin presupuesto las
+    // texturas se cargan completas desde el principio (sin recargas durante la medición).
+    m_userTextureBudget = static_cast<size_t>(options.textureBudgetMB) * 1024 * 1024;
+    m_textureLoader.setVramBudget(m_userTextureBudget);
+    if (!options.benchmarkScene.empty() && options.textureBudgetMB == 0) {
+        m_textureLoader.setInitialSize(0);
+    }
+    m_launchScreenshot = options.screenshotPath;
+    m_scenePath = options.scenePath;
+    m_autosaveSeconds = options.autosaveSeconds;
+    m_streamPath = options.streamPath;
+    m_streamBudget = static_cast<size_t>(options.streamBudgetMB) * 1024 * 1024;
+    // Antes de `init`: los input layouts y todos los vertex buffers usan este formato.
+    MeshAsset::setVertexFormat(options.vertexFormat);
+    m_gpuDriven = options.gpuDriven;
+    // Sin triángulos de CPU, los rayos paran en la caja del actor y no se puede hornear.
+    m_meshLibrary.setKeepCpuData(options.queryTriangles || options.lightmapBake);
+    m_physics = options.physics;
+    m_deferredContexts = options.deferredContexts;
+    m_stressImpostorDistance = options.impostorDistance;
+    m_stressLightCount = options.lightCount;
+    m_adapter = options.adapter;
+    m_warp = options.warp;
+    // Las medidas de `-benchmark` se comparan entre máquinas y `-headless` renderiza a
+    // calidad final: ninguno de los dos baja de nivel por su cuenta.
+    m_autoScalability = options.benchmarkScene.empty() && !m_headless;
 
     if (FAILED(init())) {
         destroy();
         return 0;
     }
+    // Sin ventana no hay editor: la escena va directa al back buffer offscreen.
+    m_userInterface.setPlayerMode(options.playerMode || m_headless);
+
+#if defined(PROFILE)
+    CpuProfiler::instance().setThreadName("Main");
+#endif
+    if (options.renderThread) {
+        m_renderThread.init([](void* app) { static_cast<BaseApp*>(app)->render(); }, this);
+    }
+
+    if (options.traceFrames > 0) {
+        m_trace.start(options.tracePath, options.traceFrames, m_gpuProfiler, m_deviceContext);
+    }
+    m_stressCounts = options.stressCounts;
+    if (!m_stressCounts.empty() && FAILED(generateStressScene(0))) {
+        destroy();
+        return 1;
+    }
+    if (m_headless) {
+        return runHeadless(options);
+    }
+    if (!options.benchmarkScene.empty()) {
+        // Medir con la escena completa y las texturas definitivas, no con el placeholder.
+        m_resources.waitIdle();
+        m_textureLoader.waitIdle();
+        if (!m_sceneMesh.isNull() && !m_sceneMesh->isReady()) {
+            ERROR("BaseApp", "run", "Benchmark scene failed to load.");
+            destroy();
+            return 1;
+        }
+        if (FAILED(startBenchmark(options))) {
+            destroy();
+            return 1;
+        }
+        // Medición reproducible: sin reposo ni límite de FPS y sin entrada de ratón en la UI.
+        m_idleThrottle = false;
+        ImGui::GetIO().ConfigFlags |= ImGuiConfigFlags_NoMouse;
+    }
+    // Con `--benchmark`, graba el recorrido de cámara desde su primer frame.
+    if (!options.capture.path.empty() && FAILED(startRecording(options.capture))) {
+        destroy();
+        return 1;
+    }
+    // Sin codificador de hardware el motor sigue en local (el error ya está en el log).
+    // La entrada remota no despierta el bucle en reposo: con stream se dibuja siempre.
+    if (options.remote && SUCCEEDED(m_remoteStream.init(m_device, options.remoteStream))) {
+        m_idleThrottle = false;
+    }
+    // Telemetría solo a petición; la escena se identifica por lo que se cargó.
+    if (!options.telemetryPath.empty()) {
+        Telemetry::Settings telemetry;
+        telemetry.directory = options.telemetryPath;
+        if (SUCCEEDED(m_telemetry.init(m_device, telemetry))) {
+            m_telemetry.setScene(!options.benchmarkScene.empty() ? "benchmark:" + options.benchmarkScene
+                : !m_streamPath.empty() ? "stream:" + m_streamPath
+                : !m_scenePath.empty() ? m_scenePath
+                : m_sceneModel.empty() ? std::string("default") : m_sceneModel);
+        }
+    }
 
     MSG msg = { 0 };
     while (WM_QUIT != msg.message) {
-        if (PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE)) {
+        if (IsIconic(m_window.m_hWnd)) {
+            // Minimizada: no hay nada que presentar; dormir hasta el próximo mensaje.
+            WaitMessage();
+            m_frameLimiter.reset();
+            m_frameTimes.skipNextFrame();
+            m_telemetry.skipNextFrame();
+        }
+        else if (m_idleThrottle && m_activeFrames == 0) {
+            // Editor en reposo: bloquear hasta entrada o aviso de cambio (requestRedraw).
+            MsgWaitForMultipleObjects(1, &m_redrawEvent, FALSE, INFINITE, QS_ALLINPUT);
+            m_activeFrames = kIdleSettleFrames;
+            m_frameLimiter.reset();
+            m_frameTimes.skipNextFrame();
+            m_telemetry.skipNextFrame();
+        }
+        else if (!m_benchmark.isRunning()) {
+            m_frameLimiter.wait();
+        }
+
+        // El frame anterior debe haber terminado antes de tocar el contexto, la ventana
+        // (WM_SIZE) o la lista de actores.
+        {
+            PROFILE_ZONE("Wait for render");
+            m_renderThread.wait();
+        }
+        // El frame anterior terminó en ambos hilos: se recicla el arena del principal.
+        FrameArena::reset();
+        // Esperar antes de leer la entrada: así la que se procese llega al próximo Present.
+        m_swapChain.waitForFrame(m_deviceContext);
+        // Lo soltado en frames que la GPU ya terminó se libera ahora; lo que se suelte en
+        // este frame espera a que termine.
+        if (m_swapChain.getFrameIndex() > 0) {
+            GpuReleaseQueue::getDefault().collect(m_swapChain.getFrameIndex() - 1,
+                m_swapChain.pollCompletedFrames(m_deviceContext));
+        }
+        while (WM_QUIT != msg.message && PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE)) {
             TranslateMessage(&msg);
             DispatchMessage(&msg);
+            m_activeFrames = kIdleSettleFrames;
+        }
+        if (WM_QUIT == msg.message) {
+            break;
+        }
+        // Entrada del frame: todo lo que llegó hasta ahora, lo más tarde posible antes de `update`.
+        m_remoteStream.receiveInput(m_input);
+        m_input.sample(m_window.m_hWnd);
+        if (IsIconic(m_window.m_hWnd)) {
+            continue;
+        }
+        PROFILE_FRAME();
+        MEMORY_FRAME();
+        m_trace.recordFrame(CpuProfiler::instance(), m_gpuProfiler, m_deviceContext);
+        update();
+        // Antes de copiar el frame: el barrido de `-stress` cambia la lista de actores.
+        if (m_benchmark.isRunning() && m_benchmark.recordFrame(m_clock.getRawDeltaTime(), m_gpuProfiler) &&
+            !advanceStressSweep(options)) {
+            PostQuitMessage(0);
+        }
+        if (m_renderThread.isRunning()) {
+            // El render dibuja la simulación del frame anterior mientras esta avanza.
+            captureFrame();
+            m_renderThread.kick();
+            simulate();
         }
         else {
-            update();
+            simulate();
+            captureFrame();
             render();
         }
+        if (m_activeFrames > 0) {
+            --m_activeFrames;
+        }
     }
 
     destroy();
     return (int)msg.wParam;
-}
\ No newline at end of file
+}
+/**
+ * @brief Lee las opciones de la línea de comandos del proceso.
+ *
+ * @details
+ * - `-trace N`, `-traceout archivo`: captura de traza (@ref TraceCapture).
+ * - `-startuptrace archivo`: línea de tiempo del arranque (@ref StartupTimeline); por
+ *   defecto `startup_trace.json`, vacío = solo el resumen del log.
+ * - `--benchmark <escena> <recorrido>`, `-benchmarkframes N`, `-benchmarkout ruta`:
+ *   modo benchmark (@ref Benchmark).
+ * - `-stress N[,N...]`: escena sintética de N actores; con varios valores separados
+ *   por comas y `--benchmark`, un barrido (p. ej. `-stress 1000,10000,100000`).
+ * - `-screenshot archivo.png`: captura del primer frame sin texturas pendientes
+ *   (@ref Screenshot), p. ej. para pruebas de regresión visual.
+ * - `-capture ruta`, `-captureformat png|h264`, `-captureevery N`, `-capturefps F`:
+ *   graba desde el arranque hasta salir (@ref FrameCapture), con el reloj fijo.
+ * - `-vertexformat compact|full`: vértices cuantizados (12 bytes, por defecto) o sin
+ *   comprimir (20 bytes); ver @ref VertexFormat.
+ * - `-impostors D`: los actores de `-stress` pasan a impostor a más de D unidades
+ *   de la cámara (@ref ImpostorRenderer).
+ * - `-lights N`: N luces puntuales de colores sobre la escena de `-stress`, sombreadas
+ *   por clusters (@ref ClusteredLighting).
+ * - `-gpudriven 1`: culling en compute shader y `DrawIndexedInstancedIndirect` para
+ *   las mallas del pool (@ref GpuCulling).
+ * - `-deferred 1`: los draws de las colas se graban en contextos diferidos desde los
+ *   hilos del `JobSystem` (@ref DeferredRecorder).
+ * - `-renderthread 1`: el render de cada frame va en un hilo propio y se solapa con la
+ *   simulación del siguiente (@ref RenderThread).
+ * - `-ptrbench archivo.csv`: compara `TSharedPointer`, `TIntrusivePointer` y
+ *   `std::shared_ptr` (@ref PointerBenchmark) y sale.
+ * - `-cook manifiesto.txt`: compila shaders, importa modelos y comprime texturas a sus
+ *   cachés de disco, escribe la lista y sale (@ref AssetCooker).
+ * - `-pack archivo.spak`: con `-cook`, empaqueta lo cocinado en ese archivo; sin él,
+ *   es el paquete que se monta en lugar de `Assets.spak` (@ref VirtualFileSystem).
+ * - `-querytriangles 1`: las mallas de la biblioteca conservan vértices e índices de
+ *   CPU y los rayos de @ref SceneQuery prueban triángulos en lugar de cajas.
+ * - `-lightmapbake 1`: las mallas conservan sus triángulos de CPU para "Tools > Bake
+ *   lightmaps" (@ref LightmapBaker) y "Tools > Bake visibility" (@ref PotentialVisibility);
+ *   cargar un horneado no lo necesita.
+ * - `-physics 1`: cada frame simulado calcula los pares de actores cuyas cajas se
+ *   tocan (@ref Broadphase), primera fase de la física, y avanza en cada paso fijo las
+ *   entidades con `RigidBody` (@ref RigidBodySolver).
+ * - `-headless AnchoxAlto`: sin ventana, swap chain ni ImGui; dibuja a un target offscreen
+ *   de ese tamaño, graba `-turntable N` frames (una vuelta de cámara; por defecto 1, una
+ *   miniatura) con `-capture` (por defecto `render_000000.png`...) y sale.
+ * - `-warp 1`: dispositivo WARP (por software), p. ej. en servidores sin GPU.
+ * - `-remote [host]:puerto`: codifica cada frame en la GPU (H.264 por defecto) y lo manda
+ *   por UDP a `host`, o al primer cliente que escriba a ese puerto; la entrada del cliente
+ *   vuelve por el mismo puerto (@ref RemoteStream). `-remotecodec h264|hevc`,
+ *   `-remotebitrate Mbps` (12) y `-remotesize AnchoxAlto` (1920x1080) lo ajustan.
+ * - `-telemetry carpeta`: escribe ahí, en segundo plano, un resumen JSON de la sesión por
+ *   escena (percentiles de frame y GPU, tirones, VRAM, adaptador y driver) para la
+ *   herramienta de la flota (@ref Telemetry). Sin la opción no se mide nada.
+ * - `-adapter N|nombre`: GPU donde crear el dispositivo, por índice en la lista del log o
+ *   por parte de su nombre (p. ej. `-adapter intel`); por defecto la de más rendimiento.
+ * - `-player 1`: arranca en modo jugador, sin editor ni frame de ImGui (F11 lo alterna;
+ *   `-cvar ui.playerStats=1` deja una superposición mínima de FPS y tiempos).
+ * - `-log archivo.txt`: copia todo el log (@ref Logger) a un archivo, con tiempo e hilo.
+ * - `-loglevel trace|debug|info|warn|error`: nivel mínimo del log en ejecución (lo que
+ *   está por debajo de `LOG_MIN_LEVEL` ya no está compilado).
+ * - `-logfilter Clase=nivel[,Clase=nivel...]`: nivel propio de algunas categorías.
+ * - `-config archivo.cfg`: valores de cvars (@ref ConsoleVariables), tras `Engine.cfg`.
+ * - `-cvar nombre=valor`: cambia una cvar (p. ej. `-cvar r.depthPrepass=0`); se puede
+ *   repetir y se aplica después de los archivos.
+ *
+ * `CommandLineToArgvW` separa respetando comillas, así una ruta con espacios llega
+ * entera. Se aceptan uno o dos guiones; los argumentos desconocidos se ignoran.
+ */
+void BaseApp::parseCommandLine(LaunchOptions& options) {
+    options = LaunchOptions();
+    options.tracePath = kDefaultTracePath;
+    options.startupTracePath = "startup_trace.json";
+    options.benchmarkReport = kDefaultBenchmarkReport;
+
+    int argc = 0;
+    LPWSTR* argv = CommandLineToArgvW(GetCommandLineW(), &argc);
+    if (!argv) {
+        return;
+    }
+    auto narrow = [](LPCWSTR text) {
+        std::string out;
+        const int size = WideCharToMultiByte(CP_ACP, 0, text, -1, nullptr, 0, nullptr, nullptr);
+        if (size > 1) {
+            out.assign(static_cast<size_t>(size - 1), '\0');
+            WideCharToMultiByte(CP_ACP, 0, text, -1, &out[0], size, nullptr, nullptr);
+        }
+        return out;
+    };
+    for (int i = 1; i + 1 < argc; ++i) {
+        LPCWSTR name = argv[i];
+        if (name[0] == L'-') ++name;
+        if (name[0] == L'-') ++name;
+
+        if (_wcsicmp(name, L"trace") == 0) {
+            options.traceFrames = static_cast<unsigned int>(wcstoul(argv[++i], nullptr, 10));
+        }
+        else if (_wcsicmp(name, L"traceout") == 0) {
+            options.tracePath = narrow(argv[++i]);
+        }
+        else if (_wcsicmp(name, L"startuptrace") == 0) {
+            options.startupTracePath = narrow(argv[++i]);
+        }
+        else if (_wcsicmp(name, L"benchmark") == 0 && i + 2 < argc) {
+            options.benchmarkScene = narrow(argv[++i]);
+            options.benchmarkPath = narrow(argv[++i]);
+        }
+        else if (_wcsicmp(name, L"benchmarkframes") == 0) {
+            options.benchmarkFrames = static_cast<unsigned int>(wcstoul(argv[++i], nullptr, 10));
+        }
+        else if (_wcsicmp(name, L"benchmarkout") == 0) {
+            options.benchmarkReport = narrow(argv[++i]);
+        }
+        else if (_wcsicmp(name, L"texbudget") == 0) {
+            options.textureBudgetMB = static_cast<unsigned int>(wcstoul(argv[++i], nullptr, 10));
+        }
+        else if (_wcsicmp(name, L"screenshot") == 0) {
+            options.screenshotPath = narrow(argv[++i]);
+        }
+        else if (_wcsicmp(name, L"capture") == 0) {
+            options.capture.path = narrow(argv[++i]);
+        }
+        else if (_wcsicmp(name, L"captureformat") == 0) {
+            options.capture.format = (_wcsicmp(argv[++i], L"h264") == 0) ? CAPTURE_FORMAT_H264 : CAPTURE_FORMAT_PNG;
+        }
+        else if (_wcsicmp(name, L"captureevery") == 0) {
+            options.capture.interval = static_cast<unsigned int>((std::max)(1ul, wcstoul(argv[++i], nullptr, 10)));
+        }
+        else if (_wcsicmp(name, L"capturefps") == 0) {
+            options.capture.fps = static_cast<unsigned int>((std::max)(1ul, wcstoul(argv[++i], nullptr, 10)));
+        }
+        else if (_wcsicmp(name, L"vertexformat") == 0) {
+            options.vertexFormat = (_wcsicmp(argv[++i], L"full") == 0) ? VertexFormat::full() : VertexFormat::compact();
+        }
+        else if (_wcsicmp(name, L"impostors") == 0) {
+            options.impostorDistance = static_cast<float>(wcstod(argv[++i], nullptr));
+        }
+        else if (_wcsicmp(name, L"lights") == 0) {
+            options.lightCount = static_cast<unsigned int>(wcstoul(argv[++i], nullptr, 10));
+        }
+        else if (_wcsicmp(name, L"gpudriven") == 0) {
+            options.gpuDriven = wcstoul(argv[++i], nullptr, 10) != 0;
+        }
+        else if (_wcsicmp(name, L"deferred") == 0) {
+            options.deferredContexts = wcstoul(argv[++i], nullptr, 10) != 0;
+        }
+        else if (_wcsicmp(name, L"renderthread") == 0) {
+            options.renderThread = wcstoul(argv[++i], nullptr, 10) != 0;
+        }
+        else if (_wcsicmp(name, L"log") == 0) {
+            options.logPath = narrow(argv[++i]);
+        }
+        else if (_wcsicmp(name, L"loglevel") == 0) {
+            uint8_t level;
+            if (Logger::parseLevel(narrow(argv[++i]).c_str(), level)) {
+                Logger::setLevel(level);
+            }
+        }
+        else if (_wcsicmp(name, L"logfilter") == 0) {
+            std::stringstream filters(narrow(argv[++i]));
+            std::string filter;
+            while (std::getline(filters, filter, ',')) {
+                const size_t equals = filter.find('=');
+                uint8_t level;
+                if (equals != std::string::npos && Logger::parseLevel(filter.c_str() + equals + 1, level)) {
+                    Logger::setCategoryLevel(filter.substr(0, equals).c_str(), level);
+                }
+            }
+        }
+        else if (_wcsicmp(name, L"config") == 0) {
+            options.configPath = narrow(argv[++i]);
+        }
+        else if (_wcsicmp(name, L"cvar") == 0) {
+            options.cvars.push_back(narrow(argv[++i]));
+        }
+        else if (_wcsicmp(name, L"ptrbench") == 0) {
+            options.pointerBenchmark = narrow(argv[++i]);
+        }
+        else if (_wcsicmp(name, L"cook") == 0) {
+            options.cookManifest = narrow(argv[++i]);
+        }
+        else if (_wcsicmp(name, L"pack") == 0) {
+            options.packPath = narrow(argv[++i]);
+        }
+        else if (_wcsicmp(name, L"scene") == 0) {
+            options.scenePath = narrow(argv[++i]);
+        }
+        else if (_wcsicmp(name, L"autosave") == 0) {
+            options.autosaveSeconds = static_cast<float>(wcstod(argv[++i], nullptr));
+        }
+        else if (_wcsicmp(name, L"stream") == 0) {
+            options.streamPath = narrow(argv[++i]);
+        }
+        else if (_wcsicmp(name, L"splitscene") == 0) {
+            options.splitScene = narrow(argv[++i]);
+        }
+        else if (_wcsicmp(name, L"cellsize") == 0) {
+            options.cellSize = static_cast<float>(wcstod(argv[++i], nullptr));
+        }
+        else if (_wcsicmp(name, L"streambudget") == 0) {
+            options.streamBudgetMB = wcstoul(argv[++i], nullptr, 10);
+        }
+        else if (_wcsicmp(name, L"querytriangles") == 0) {
+            options.queryTriangles = wcstoul(argv[++i], nullptr, 10) != 0;
+        }
+        else if (_wcsicmp(name, L"lightmapbake") == 0) {
+            options.lightmapBake = wcstoul(argv[++i], nullptr, 10) != 0;
+        }
+        else if (_wcsicmp(name, L"physics") == 0) {
+            options.physics = wcstoul(argv[++i], nullptr, 10) != 0;
+        }
+        else if (_wcsicmp(name, L"player") == 0) {
+            options.playerMode = wcstoul(argv[++i], nullptr, 10) != 0;
+        }
+        else if (_wcsicmp(name, L"adapter") == 0) {
+            options.adapter = narrow(argv[++i]);
+        }
+        else if (_wcsicmp(name, L"headless") == 0) {
+            unsigned int width = 0, height = 0;
+            if (swscanf_s(argv[++i], L"%ux%u", &width, &height) == 2) {
+                options.headlessWidth = width;
+                options.headlessHeight = height;
+            }
+        }
+        else if (_wcsicmp(name, L"turntable") == 0) {
+            options.turntableFrames = static_cast<unsigned int>(wcstoul(argv[++i], nullptr, 10));
+        }
+        else if (_wcsicmp(name, L"warp") == 0) {
+            options.warp = wcstoul(argv[++i], nullptr, 10) != 0;
+        }
+        else if (_wcsicmp(name, L"remote") == 0) {
+            // `host:puerto`, `:puerto` (espera a un cliente) o solo `host`.
+            const std::string address = narrow(argv[++i]);
+            const size_t colon = address.rfind(':');
+            options.remoteStream.host = address.substr(0, colon);
+            if (colon != std::string::npos) {
+                const unsigned long port = strtoul(address.c_str() + colon + 1, nullptr, 10);
+                if (port > 0 && port <= 0xffff) {
+                    options.remoteStream.port = static_cast<unsigned short>(port);
+                }
+            }
+            options.remote = true;
+        }
+        else if (_wcsicmp(name, L"telemetry") == 0) {
+            options.telemetryPath = narrow(argv[++i]);
+        }
+        else if (_wcsicmp(name, L"remotecodec") == 0) {
+            options.remoteStream.codec = _wcsicmp(argv[++i], L"hevc") == 0 ? STREAM_CODEC_HEVC : STREAM_CODEC_H264;
+        }
+        else if (_wcsicmp(name, L"remotebitrate") == 0) {
+            const double megabits = wcstod(argv[++i], nullptr);
+            if (megabits > 0.0) {
+                options.remoteStream.bitrate = static_cast<unsigned int>(megabits * 1e6);
+            }
+        }
+        else if (_wcsicmp(name, L"remotesize") == 0) {
+            unsigned int width = 0, height = 0;
+            if (swscanf_s(argv[++i], L"%ux%u", &width, &height) == 2) {
+                options.remoteStream.width = width & ~1u;
+                options.remoteStream.height = height & ~1u;
+            }
+        }
+        else if (_wcsicmp(name, L"stress") == 0) {
+            LPCWSTR cursor = argv[++i];
+            while (*cursor) {
+                LPWSTR end = nullptr;
+                const unsigned long count = wcstoul(cursor, &end, 10);
+                if (end == cursor) {
+                    break;
+                }
+                if (count > 0) {
+                    options.stressCounts.push_back(static_cast<unsigned int>(count));
+                }
+                cursor = (*end == L',') ? end + 1 : end;
+            }
+        }
+    }
+    LocalFree(argv);
+}
+
+void BaseApp::updateWatchdog() {
+    FrameWatchdog::Settings settings;
+    settings.enabled = cvWatchdog.get();
+    settings.budgetMs[BUDGET_UPDATE] = cvWatchdogUpdate.get();
+    settings.budgetMs[BUDGET_CULLING] = cvWatchdogCulling.get();
+    settings.budgetMs[BUDGET_SUBMISSION] = cvWatchdogSubmission.get();
+    settings.budgetMs[BUDGET_GPU] = cvWatchdogGpu.get();
+    settings.consecutiveFrames = static_cast<unsigned int>((std::max)(cvWatchdogFrames.get(), 1));
+    settings.dumpSeconds = (std::max)(cvWatchdogSeconds.get(), 0.0f);
+    settings.cooldownSeconds = (std::max)(cvWatchdogCooldown.get(), 0.0f);
+    m_watchdog.setSettings(settings);
+
+    const DeviceContext::RenderStats& stats = m_deviceContext.getLastFrameStats();
+    const StallDetector::FrameStats& stalls = StallDetector::getDefault().getLastFrame();
+    FrameWatchdog::SceneStats scene;
+    scene.actors = static_cast<unsigned int>(m_actors.size());
+    scene.visibleActors = static_cast<unsigned int>(m_visibleActors.size());
+    scene.occludedActors = m_occludedActors;
+    scene.drawCalls = stats.drawCalls;
+    scene.primitives = stats.primitives;
+    scene.stateChanges = stats.totalStateChanges();
+    scene.uploadBytes = stats.uploadBytes;
+    scene.commandLists = stats.commandLists;
+    for (unsigned int count : stalls.count) {
+        scene.stalls += count;
+    }
+    scene.gpuMemoryBytes = static_cast<size_t>(m_gpuMemory.getLocal().usage);
+    m_watchdog.endFrame(m_clock.getRawDeltaTime() * 1000.0, m_gpuProfiler, CpuProfiler::instance(), scene);
+}
+
+void BaseApp::requestActorTexels(Actor& actor) {
+    const EU::TSharedPointer<MeshAsset>& asset = actor.getMeshAsset();
+    const float uvSpan = asset.isNull() ? 1.0f : asset->getUVSpan();
+    const float texels = actor.getScreenSize() * static_cast<float>(m_window.m_height) / uvSpan;
+    for (const TextureHandle& texture : actor.getTextures()) {
+        m_textureLoader.requestTexels(texture, texels);
+    }
+}
+
+/**
+ * @details
+ * La biblioteca sube todo y vacía el cargador (en CPU no queda copia de la geometría).
+ * Con esqueleto y pesos (y compute disponible) el modelo recibe su propia malla
+ * deformable, sin LOD; si no, la compartida de la biblioteca. Solo el primer modelo con
+ * esqueleto se anima: su esqueleto y sus clips viven en `m_modelLoader`.
+ */
+MeshHandle BaseApp::publishModel(const std::string& path, ModelLoader& loader) {
+    MeshHandle mesh;
+    bool hasSkin = false;
+    for (const MeshComponent& component : loader.meshes) {
+        hasSkin = hasSkin || !component.m_skin.empty();
+    }
+    if (hasSkin && loader.skeleton.getJointCount() > 0 && m_modelLoader.skeleton.getJointCount() == 0 &&
+        SUCCEEDED(m_skinning.init(m_device))) {
+        // El esqueleto y los clips pasan a `m_modelLoader`: la animación los apunta
+        // y el cargador del ResourceManager se libera al volver.
+        m_modelLoader.skeleton = std::move(loader.skeleton);
+        m_modelLoader.clips = std::move(loader.clips);
+        AnimationSystem::InstanceID instance = m_animations.create(&m_modelLoader.skeleton);
+        m_animations.play(instance, m_modelLoader.clips.empty() ? nullptr : &m_modelLoader.clips[0]);
+        mesh = m_skinning.getMeshAsset(m_skinning.add(m_device, loader.meshes, instance));
+        if (!mesh.isNull()) {
+            mesh->setSourceName(path);
+        }
+    }
+    if (mesh.isNull()) {
+        mesh = m_meshLibrary.adopt(m_device, path, loader);
+    }
+    return mesh;
+}
+
+/**
+ * @details
+ * Textura, material y malla se piden antes del primer `co_await`: la textura se decodifica
+ * mientras el FBX se importa.
+ */
+Task<> BaseApp::loadSceneModel(ActorHandle actor, std::string path, std::vector<AsyncTextureLoader::Source> diffuse) {
+    ResourceHandle<Material> material = m_resources.loadMaterial(MaterialDesc(), m_resources.loadTexture(diffuse));
+    m_sceneMesh = m_resources.loadMesh(path, [this, path](ModelLoader& loader) {
+        return publishModel(path, loader);
+    });
+
+    const MeshHandle mesh = co_await m_sceneMesh;
+    if (!mesh.isNull()) {
+        actor->setMeshAsset(mesh);
+    }
+    const MaterialHandle resolved = co_await material;
+    if (!resolved.isNull()) {
+        actor->setMaterials(std::vector<MaterialHandle>{ resolved });
+    }
+}
+
+MeshHandle BaseApp::createGroundMesh() {
+    MeshHandle ground = m_meshLibrary.find("Ground");
+    if (!ground.isNull()) {
+        return ground;
+    }
+    const float kSize = 20.0f; // mitad del tamaño (=> 40x40)
+    const float kTiling = 6.0f;  // repetición UV
+
+    // Malla del plano (UVs preparados para tiling)
+    SimpleVertex planeVertices[] =
+    {
+        { XMFLOAT3(-kSize, 0.0f, -kSize), XMFLOAT2(0.0f,    0.0f) },
+        { XMFLOAT3(kSize, 0.0f, -kSize), XMFLOAT2(kTiling, 0.0f) },
+        { XMFLOAT3(kSize, 0.0f,  kSize), XMFLOAT2(kTiling, kTiling) },
+        { XMFLOAT3(-kSize, 0.0f,  kSize), XMFLOAT2(0.0f,    kTiling) },
+    };
+    WORD planeIndices[] = { 0,2,1, 0,3,2 };
+
+    MeshComponent planeMesh;
+    planeMesh.m_vertex.assign(std::begin(planeVertices), std::end(planeVertices));
+    planeMesh.m_index.assign(std::begin(planeIndices), std::end(planeIndices));
+    planeMesh.m_numVertex = 4;
+    planeMesh.m_numIndex = 6;
+    planeMesh.computeBounds();
+
+    std::vector<MeshComponent> meshes{ planeMesh };
+    LightmapUV::generate(meshes);
+    return m_meshLibrary.create(m_device, "Ground", meshes);
+}
+
+HRESULT BaseApp::loadScene(const std::string& path) {
+    SceneData scene;
+    HRESULT hr = SceneFile::read(path, scene);
+    if (FAILED(hr)) {
+        return hr;
+    }
+    hr = SceneFile::instantiate(m_device, scene, m_resources,
+        [this](const std::string& name) { return resolveSceneMesh(name); },
+        { SceneComponent::of<Spin>("Spin") }, m_scenePrefabs, m_actors);
+    MESSAGE("BaseApp", "loadScene", (path + ": " + std::to_string(scene.getEntityCount()) + " actors").c_str());
+    return hr;
+}
+
+/**
+ * @details
+ * Un modelo que varias celdas nombran se importa una vez: mientras se importa, las
+ * peticiones reciben el mismo futuro; después ya está en la biblioteca.
+ */
+ResourceHandle<MeshAsset> BaseApp::resolveSceneMesh(const std::string& name) {
+    m_sceneUsesGround = m_sceneUsesGround || name == "Ground";
+    MeshHandle mesh = name == "Ground" ? createGroundMesh() : m_meshLibrary.find(name);
+    if (!mesh.isNull()) {
+        return ResourceManager::makeReady(mesh);
+    }
+    auto importing = m_sceneImports.find(name);
+    if (importing != m_sceneImports.end()) {
+        if (!importing->second->isDone()) {
+            return importing->second;
+        }
+        m_sceneImports.erase(importing);
+    }
+    if (VirtualFileSystem::getDefault().exists(name)) {
+        ResourceHandle<MeshAsset> future = m_resources.loadMesh(name, [this, name](ModelLoader& loader) {
+            return publishModel(name, loader);
+        });
+        m_sceneImports[name] = future;
+        return future;
+    }
+    ERROR("BaseApp", "resolveSceneMesh", ("Scene mesh not found: " + name).c_str());
+    return ResourceManager::makeReady(MeshHandle());
+}
+
+bool BaseApp::saveScene() {
+    if (m_scenePath.empty() || m_sceneFile.isSaving()) {
+        return false;
+    }
+    // Solo la copia va en el frame; serializar y escribir, en el hilo de guardado.
+    SceneData scene;
+    SceneFile::capture(m_actors, { SceneComponent::of<Spin>("Spin") }, scene);
+    m_autosaveElapsed = 0.0f;
+    return m_sceneFile.saveAsync(m_scenePath, std::move(scene));
+}
+
+void BaseApp::updateLightmaps() {
+    if (!m_lightmapProgram.m_VertexShader) {
+        return;
+    }
+    std::string basePath = kDefaultLightmapPath;
+    if (!m_scenePath.empty()) {
+        basePath = m_scenePath.substr(0, m_scenePath.find_last_of('.')) + "_lightmap";
+    }
+
+    bool changed = false;
+    if (m_userInterface.consumeBakeLightmapsRequest()) {
+        LightmapBaker::Lighting lighting;
+        XMStoreFloat3(&lighting.sunDirection, XMVector3Normalize(XMLoadFloat4(&m_LightPos)));
+        lighting.shadowStrength = m_shadowMap.getStrength();
+        lighting.lights = m_clusteredLighting.getLights();
+        if (m_scenePath.empty()) {
+            CreateDirectoryA("Lightmaps", nullptr);
+        }
+        m_lightmapBaker.bake(m_device, m_actors, lighting, basePath, LightmapBaker::Settings());
+        m_lightmapsChecked = true;
+        changed = true;
+    }
+    if (!cvLightmaps.get()) {
+        if (m_lightmapBaker.getPageCount() > 0) {
+            m_lightmapBaker.clear(m_actors);
+            changed = true;
+        }
+        m_lightmapsChecked = false;
+    }
+    else if (!m_lightmapsChecked && m_resources.getPendingCount() == 0) {
+        m_lightmapsChecked = true;
+        changed = SUCCEEDED(m_lightmapBaker.load(m_device, m_actors, basePath));
+    }
+    // Los actores con lightmap salen de los lotes (y vuelven al quitarlo).
+    if (changed) {
+        m_staticBatcher.destroy(m_actors);
+    }
+}
+
+void BaseApp::updateVisibility() {
+    std::string basePath = kDefaultVisibilityPath;
+    if (!m_scenePath.empty()) {
+        basePath = m_scenePath.substr(0, m_scenePath.find_last_of('.')) + "_visibility";
+    }
+    if (m_userInterface.consumeBakeVisibilityRequest()) {
+        if (m_scenePath.empty()) {
+            CreateDirectoryA("Lightmaps", nullptr);
+        }
+        m_visibility.bake(m_actors, basePath, PotentialVisibility::Settings());
+        m_visibilityChecked = true;
+    }
+    if (!cvPvs.get()) {
+        if (m_visibility.isLoaded()) {
+            m_visibility.clear();
+        }
+        m_visibilityChecked = false;
+    }
+    else if (!m_visibilityChecked && m_resources.getPendingCount() == 0) {
+        m_visibilityChecked = true;
+        m_visibility.load(m_actors, basePath);
+    }
+}
+
+HRESULT BaseApp::generateStressScene(size_t index) {
+    SceneGenerator::Config config;
+    config.actorCount = m_stressCounts[index];
+    config.pool = &m_meshLibrary.getGeometryPool();
+    config.impostorDistance = m_stressImpostorDistance;
+    config.lightCount = m_stressLightCount;
+    config.lights = &m_clusteredLighting;
+    m_stressIndex = index;
+    m_userInterface.selectedActorIndex = 0;
+    // Los lotes comparten texturas con la escena que se va a sustituir.
+    m_staticBatcher.destroy(m_actors);
+    // Los atlas guardan las mallas de la escena anterior.
+    m_impostors.clear();
+    m_particles.clear();
+    return m_stressScene.generate(m_device, config, m_actors);
+}
+
+HRESULT BaseApp::startBenchmark(const LaunchOptions& options) {
+    std::string report = options.benchmarkReport;
+    std::string scene = options.benchmarkScene;
+    if (!m_stressCounts.empty()) {
+        const std::string count = std::to_string(m_stressCounts[m_stressIndex]);
+        report += "_" + count;
+        scene += " + " + count + " stress actors";
+    }
+    return m_benchmark.init(options.benchmarkPath, options.benchmarkFrames, report, scene);
+}
+
+bool BaseApp::advanceStressSweep(const LaunchOptions& options) {
+    if (m_stressCounts.empty()) {
+        return false;
+    }
+    Benchmark::SweepPoint point = { m_stressCounts[m_stressIndex], m_benchmark.getSummary() };
+    m_sweep.push_back(point);
+
+    if (m_stressIndex + 1 < m_stressCounts.size() &&
+        SUCCEEDED(generateStressScene(m_stressIndex + 1)) &&
+        SUCCEEDED(startBenchmark(options))) {
+        return true;
+    }
+
+    const std::string sweepPath = options.benchmarkReport + "_sweep.csv";
+    if (SUCCEEDED(Benchmark::writeSweep(sweepPath, m_sweep))) {
+        MESSAGE("Main", "advanceStressSweep", ("Sweep written to " + sweepPath).c_str());
+    }
+    return false;
+}
+
+/**
+ * @details
+ * Con el reloj fijo, cada frame grabado equivale a `1 / fps` segundos de vídeo aunque
+ * se grabe solo uno de cada `interval`: el vídeo se ve a tiempo real. Los tiempos que
+ * mida un benchmark durante la grabación incluyen la contrapresión del codificador.
+ */
+HRESULT BaseApp::startRecording(const FrameCapture::Settings& settings) {
+    HRESULT hr = m_frameCapture.start(settings);
+    if (SUCCEEDED(hr)) {
+        m_clock.setLockedDelta(1.0 / (static_cast<double>(settings.fps) * settings.interval));
+    }
+    return hr;
+}
+
+void BaseApp::stopRecording() {
+    m_frameCapture.stop(m_deviceContext);
+    m_clock.setLockedDelta(0.0);
+}
+
+/**
+ * @details
+ * Sin mensajes, entrada, limitador ni `Present`: cada vuelta es `waitForFrame` (hasta
+ * @ref kHeadlessFrameLatency frames en vuelo), la simulación y el render. La copia al
+ * anillo de staging de `FrameCapture` y la lectura de frames anteriores no esperan a la
+ * GPU, y los PNG se codifican en sus hilos, así que el lote va al ritmo de la GPU.
+ *
+ * Antes de grabar se espera a que la escena y sus texturas estén completas, igual que
+ * el benchmark: una miniatura con el placeholder no sirve.
+ */
+int BaseApp::runHeadless(const LaunchOptions& options) {
+    m_resources.waitIdle();
+    m_textureLoader.waitIdle();
+    if (!m_sceneMesh.isNull() && !m_sceneMesh->isReady()) {
+        ERROR("BaseApp", "runHeadless", "Scene failed to load.");
+        destroy();
+        return 1;
+    }
+
+    FrameCapture::Settings settings = options.capture;
+    if (settings.path.empty()) {
+        settings.path = kDefaultHeadlessPath;
+    }
+    if (FAILED(startRecording(settings))) {
+        destroy();
+        return 1;
+    }
+    // `interval` frames simulados por cada frame grabado: la vuelta completa se reparte
+    // entre todos.
+    const unsigned int frames = (std::max)(options.turntableFrames, 1u) * settings.interval;
+    const float startYaw = m_camera.getYaw();
+    LARGE_INTEGER frequency, start, end;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&start);
+    for (unsigned int frame = 0; frame < frames; ++frame) {
+        FrameArena::reset();
+        m_swapChain.waitForFrame(m_deviceContext);
+        if (m_swapChain.getFrameIndex() > 0) {
+            GpuReleaseQueue::getDefault().collect(m_swapChain.getFrameIndex() - 1,
+                m_swapChain.pollCompletedFrames(m_deviceContext));
+        }
+        if (frames > 1) {
+            m_camera.setAngles(startYaw + 360.0f * static_cast<float>(frame) / static_cast<float>(frames),
+                m_camera.getPitch());
+        }
+        PROFILE_FRAME();
+        MEMORY_FRAME();
+        update();
+        simulate();
+        captureFrame();
+        render();
+    }
+    stopRecording();
+    QueryPerformanceCounter(&end);
+
+    const double seconds = static_cast<double>(end.QuadPart - start.QuadPart) / static_cast<double>(frequency.QuadPart);
+    char summary[160];
+    sprintf_s(summary, "%u frames at %ux%u in %.2f s (%.1f frames/s)", frames, m_window.m_width,
+        m_window.m_height, seconds, seconds > 0.0 ? frames / seconds : 0.0);
+    MESSAGE("BaseApp", "runHeadless", summary);
+    const bool recorded = m_frameCapture.getEncodedCount() > 0;
+    destroy();
+    return recorded ? 0 : 1;
+}
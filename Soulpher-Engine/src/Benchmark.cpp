@@ -0,0 +1,228 @@
+﻿/**
+ * @file Benchmark.cpp
+ * @brief Implementación del modo benchmark (recorrido de cámara e informe de tiempos).
+ */
+
+#include "Benchmark.h"
+#include "GpuProfiler.h"
+#include <cstring>
+#include <fstream>
+
+namespace {
+    /// Percentil `p` (0..1) de una lista ya ordenada (rango más cercano).
+    double percentile(const std::vector<double>& sorted, double p) {
+        if (sorted.empty()) {
+            return 0.0;
+        }
+        const size_t rank = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+        return sorted[(std::min)(rank, sorted.size() - 1)];
+    }
+
+    /// Cadena JSON con comillas y barras escapadas (las rutas de Windows llevan '\').
+    std::string jsonString(const std::string& text) {
+        std::string out = "\"";
+        for (char c : text) {
+            if (c == '"' || c == '\\') out += '\\';
+            out += c;
+        }
+        return out + "\"";
+    }
+
+    XMVECTOR orbitOf(const Benchmark::CameraKey& key) {
+        return XMVectorSet(key.yawDeg, key.pitchDeg, key.distance, 0.0f);
+    }
+}
+
+HRESULT Benchmark::init(const std::string& pathFile, unsigned int frames,
+    const std::string& reportPath, const std::string& sceneName) {
+    m_keys.clear();
+    std::ifstream file(pathFile.c_str());
+    if (!file) {
+        ERROR("Benchmark", "init", ("Cannot open camera path " + pathFile).c_str());
+        return E_FAIL;
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream fields(line);
+        CameraKey key;
+        if (fields >> key.yawDeg >> key.pitchDeg >> key.distance >> key.target.x >> key.target.y >> key.target.z) {
+            m_keys.push_back(key);
+        }
+    }
+    if (m_keys.empty()) {
+        ERROR("Benchmark", "init", ("No camera keys in " + pathFile).c_str());
+        return E_FAIL;
+    }
+
+    m_frames = (std::max)(frames, 1u);
+    m_frame = 0;
+    m_frameMs.clear();
+    m_frameMs.reserve(m_frames);
+    m_passes.clear();
+    m_gpuSerial = 0;
+    m_reportPath = reportPath;
+    m_sceneName = sceneName;
+    m_running = true;
+    MESSAGE("Benchmark", "init", ("Running " + std::to_string(m_frames) + " frames over " +
+        std::to_string(m_keys.size()) + " camera keys").c_str());
+    return S_OK;
+}
+
+void Benchmark::sampleCamera(CameraKey& key) const {
+    if (m_keys.empty()) {
+        return;
+    }
+    const size_t last = m_keys.size() - 1;
+    if (last == 0) {
+        key = m_keys[0];
+        return;
+    }
+
+    // Calentamiento en la primera clave; después, u en [0, claves-1] según el frame medido.
+    const unsigned int measured = m_frame > kWarmupFrames ? m_frame - kWarmupFrames : 0;
+    const float u = (m_frames > 1)
+        ? static_cast<float>(last) * (std::min)(measured, m_frames - 1) / (m_frames - 1)
+        : 0.0f;
+    const size_t segment = (std::min)(static_cast<size_t>(u), last - 1);
+    const float t = u - static_cast<float>(segment);
+
+    const CameraKey& k0 = m_keys[segment > 0 ? segment - 1 : 0];
+    const CameraKey& k1 = m_keys[segment];
+    const CameraKey& k2 = m_keys[segment + 1];
+    const CameraKey& k3 = m_keys[(std::min)(segment + 2, last)];
+
+    XMFLOAT3 orbit;
+    XMStoreFloat3(&orbit, XMVectorCatmullRom(orbitOf(k0), orbitOf(k1), orbitOf(k2), orbitOf(k3), t));
+    XMStoreFloat3(&key.target, XMVectorCatmullRom(XMLoadFloat3(&k0.target), XMLoadFloat3(&k1.target),
+        XMLoadFloat3(&k2.target), XMLoadFloat3(&k3.target), t));
+    key.yawDeg = orbit.x;
+    key.pitchDeg = orbit.y;
+    key.distance = orbit.z;
+}
+
+bool Benchmark::recordFrame(double frameSeconds, const GpuProfiler& gpuProfiler) {
+    if (!m_running) {
+        return false;
+    }
+    ++m_frame;
+    if (m_frame <= kWarmupFrames) {
+        m_gpuSerial = gpuProfiler.getResultSerial();
+        return false;
+    }
+
+    m_frameMs.push_back(frameSeconds * 1000.0);
+    if (gpuProfiler.getResultSerial() != m_gpuSerial) {
+        m_gpuSerial = gpuProfiler.getResultSerial();
+        for (const GpuProfiler::Result& result : gpuProfiler.getResults()) {
+            auto it = std::find_if(m_passes.begin(), m_passes.end(), [&result](const PassTotal& pass) {
+                return pass.depth == result.depth && std::strcmp(pass.name, result.name) == 0;
+            });
+            if (it == m_passes.end()) {
+                PassTotal pass = { result.name, result.depth, 0.0, 0 };
+                m_passes.push_back(pass);
+                it = m_passes.end() - 1;
+            }
+            it->totalMs += result.ms;
+            ++it->samples;
+        }
+    }
+
+    if (m_frameMs.size() < m_frames) {
+        return false;
+    }
+    m_running = false;
+    if (writeReport()) {
+        MESSAGE("Benchmark", "recordFrame", ("Report written to " + m_reportPath + ".json").c_str());
+    }
+    return true;
+}
+
+Benchmark::Summary Benchmark::getSummary() const {
+    Summary summary;
+    if (m_frameMs.empty()) {
+        return summary;
+    }
+    std::vector<double> sorted = m_frameMs;
+    std::sort(sorted.begin(), sorted.end());
+    double total = 0.0;
+    for (double ms : m_frameMs) {
+        total += ms;
+    }
+    summary.frames = static_cast<unsigned int>(m_frameMs.size());
+    summary.averageMs = total / m_frameMs.size();
+    summary.p50Ms = percentile(sorted, 0.50);
+    summary.p95Ms = percentile(sorted, 0.95);
+    summary.p99Ms = percentile(sorted, 0.99);
+    summary.minMs = sorted.front();
+    summary.maxMs = sorted.back();
+    return summary;
+}
+
+bool Benchmark::writeReport() const {
+    const Summary summary = getSummary();
+
+    std::ofstream csv((m_reportPath + ".csv").c_str(), std::ios::trunc);
+    if (!csv) {
+        ERROR("Benchmark", "writeReport", ("Cannot write " + m_reportPath + ".csv").c_str());
+        return false;
+    }
+    csv << "frame,ms\n";
+    for (size_t i = 0; i < m_frameMs.size(); ++i) {
+        csv << i << ',' << m_frameMs[i] << '\n';
+    }
+
+    std::ofstream json((m_reportPath + ".json").c_str(), std::ios::trunc);
+    if (!json) {
+        ERROR("Benchmark", "writeReport", ("Cannot write " + m_reportPath + ".json").c_str());
+        return false;
+    }
+    json << "{\n";
+    json << "  \"scene\": " << jsonString(m_sceneName) << ",\n";
+    json << "  \"frames\": " << m_frameMs.size() << ",\n";
+    json << "  \"warmupFrames\": " << kWarmupFrames << ",\n";
+    json << "  \"frameTimeMs\": {\n";
+    json << "    \"average\": " << summary.averageMs << ",\n";
+    json << "    \"p50\": " << summary.p50Ms << ",\n";
+    json << "    \"p95\": " << summary.p95Ms << ",\n";
+    json << "    \"p99\": " << summary.p99Ms << ",\n";
+    json << "    \"min\": " << summary.minMs << ",\n";
+    json << "    \"max\": " << summary.maxMs << "\n";
+    json << "  },\n";
+    json << "  \"gpuPassesMs\": [";
+    for (size_t i = 0; i < m_passes.size(); ++i) {
+        const PassTotal& pass = m_passes[i];
+        json << (i ? ",\n" : "\n") << "    { \"name\": " << jsonString(pass.name) << ", \"depth\": " << pass.depth
+            << ", \"average\": " << (pass.samples ? pass.totalMs / pass.samples : 0.0) << " }";
+    }
+    json << "\n  ]\n}\n";
+    return true;
+}
+
+HRESULT Benchmark::appendCameraKey(const std::string& pathFile, const CameraKey& key) {
+    std::ofstream file(pathFile.c_str(), std::ios::app);
+    if (!file) {
+        ERROR("Benchmark", "appendCameraKey", ("Cannot write " + pathFile).c_str());
+        return E_FAIL;
+    }
+    file << key.yawDeg << ' ' << key.pitchDeg << ' ' << key.distance << ' '
+        << key.target.x << ' ' << key.target.y << ' ' << key.target.z << '\n';
+    return S_OK;
+}
+
+HRESULT Benchmark::writeSweep(const std::string& csvPath, const std::vector<SweepPoint>& points) {
+    std::ofstream csv(csvPath.c_str(), std::ios::trunc);
+    if (!csv) {
+        ERROR("Benchmark", "writeSweep", ("Cannot write " + csvPath).c_str());
+        return E_FAIL;
+    }
+    csv << "actors,avg,p50,p95,p99,min,max\n";
+    for (const SweepPoint& point : points) {
+        const Summary& s = point.summary;
+        csv << point.actorCount << ',' << s.averageMs << ',' << s.p50Ms << ',' << s.p95Ms << ','
+            << s.p99Ms << ',' << s.minMs << ',' << s.maxMs << '\n';
+    }
+    return S_OK;
+}
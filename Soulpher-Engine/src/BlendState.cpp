@@ -15,6 +15,8 @@
  * - Si usas **alpha premultiplicado**, cambia a:
  *     SrcBlend = ONE, DestBlend = INV_SRC_ALPHA
  * - `render(reset=true)` restaura el estado por defecto (sin blend).
+ * - Los opacos no deben mezclar: `init(device, false)` crea el mismo estado con
+ *   `BlendEnable = FALSE` (ver la capa opaca de `RenderQueue`).
  */
 
 #include "BlendState.h"
@@ -25,6 +27,7 @@
  /**
   * @brief Crea un estado de blending estándar (SrcAlpha / InvSrcAlpha).
   * @param device Dispositivo de Direct3D 11.
+  * @param alphaBlend `false` desactiva la mezcla (misma máscara de escritura).
   * @return HRESULT S_OK en éxito o error en caso contrario.
   *
   * @note Configuración pensada para **alpha no premultiplicado**:
@@ -32,7 +35,7 @@
   * - Alpha:   Src = ONE,       Dst = ZERO,         Op = ADD
   * - WriteMask: escribe en RGBA.
   */
-HRESULT BlendState::init(Device& device) {
+HRESULT BlendState::init(Device& device, bool alphaBlend) {
     if (!device.m_device) {
         ERROR("BlendState", "init", "Device is null.");
         return E_POINTER;
@@ -45,7 +48,7 @@ HRESULT BlendState::init(Device& device) {
 
     // Config de mezcla para el RTV[0]
     D3D11_RENDER_TARGET_BLEND_DESC rtBlendDesc = {};
-    rtBlendDesc.BlendEnable = TRUE;
+    rtBlendDesc.BlendEnable = alphaBlend ? TRUE : FALSE;
 
     // Color: C_out = C_src * A_src + C_dst * (1 - A_src)
     rtBlendDesc.SrcBlend = D3D11_BLEND_SRC_ALPHA;
@@ -62,7 +65,7 @@ HRESULT BlendState::init(Device& device) {
     blendDesc.RenderTarget[0] = rtBlendDesc;
 
     // Crear el estado
-    HRESULT hr = device.m_device->CreateBlendState(&blendDesc, &m_blendState);
+    HRESULT hr = device.CreateSharedBlendState(&blendDesc, &m_blendState);
     if (FAILED(hr)) {
         ERROR("BlendState", "init",
             ("Failed to create blend state. HRESULT: " + std::to_string(hr)).c_str());
@@ -100,11 +103,11 @@ void BlendState::render(DeviceContext& deviceContext,
     if (!blendFactor) blendFactor = defaultBlendFactor;
 
     if (!reset) {
-        deviceContext.m_deviceContext->OMSetBlendState(m_blendState, blendFactor, sampleMask);
+        deviceContext.OMSetBlendState(m_blendState, blendFactor, sampleMask);
     }
     else {
         // Estado por defecto (blending off)
-        deviceContext.m_deviceContext->OMSetBlendState(nullptr, blendFactor, sampleMask);
+        deviceContext.OMSetBlendState(nullptr, blendFactor, sampleMask);
     }
 }
 
@@ -0,0 +1,432 @@
+﻿/**
+ * @file BlockCompressor.cpp
+ * @brief Codificadores BCn por ajuste de rango y compresión de cadenas de mips.
+ */
+
+#include "BlockCompressor.h"
+#include "MipChain.h"
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+    /// Escribe campos de bits del bloque BC7, del bit menos significativo al más.
+    struct BitWriter {
+        unsigned char* out;
+        unsigned int bit = 0;
+
+        void write(unsigned int value, unsigned int bits) {
+            for (unsigned int i = 0; i < bits; ++i, ++bit) {
+                if (value & (1u << i)) {
+                    out[bit >> 3] |= static_cast<unsigned char>(1u << (bit & 7));
+                }
+            }
+        }
+    };
+
+    /**
+     * Caja envolvente de los canales `[0, channels)` con la diagonal orientada:
+     * un canal que decrece cuando sube el de mayor rango se invierte, para que la
+     * recta min→max siga a los colores del bloque y no a la diagonal contraria.
+     */
+    void fitEndpoints(const unsigned char* block, unsigned int channels, int* lo, int* hi) {
+        double mean[4] = {};
+        for (unsigned int c = 0; c < channels; ++c) {
+            lo[c] = 255;
+            hi[c] = 0;
+            for (unsigned int i = 0; i < 16; ++i) {
+                const int v = block[i * 4 + c];
+                lo[c] = (std::min)(lo[c], v);
+                hi[c] = (std::max)(hi[c], v);
+                mean[c] += v / 16.0;
+            }
+        }
+        unsigned int major = 0;
+        for (unsigned int c = 1; c < channels; ++c) {
+            if (hi[c] - lo[c] > hi[major] - lo[major]) major = c;
+        }
+        for (unsigned int c = 0; c < channels; ++c) {
+            double covariance = 0.0;
+            for (unsigned int i = 0; i < 16; ++i) {
+                covariance += (block[i * 4 + c] - mean[c]) * (block[i * 4 + major] - mean[major]);
+            }
+            // Margen hacia dentro: los extremos de la caja casi nunca son los mejores.
+            const int inset = (hi[c] - lo[c]) >> 4;
+            lo[c] += inset;
+            hi[c] -= inset;
+            if (covariance < 0.0) {
+                std::swap(lo[c], hi[c]);
+            }
+        }
+    }
+
+    unsigned int squaredDistance(const unsigned char* texel, const int* color, unsigned int channels) {
+        unsigned int sum = 0;
+        for (unsigned int c = 0; c < channels; ++c) {
+            const int d = texel[c] - color[c];
+            sum += d * d;
+        }
+        return sum;
+    }
+
+    unsigned short pack565(const int* rgb) {
+        const int r = (rgb[0] * 31 + 127) / 255;
+        const int g = (rgb[1] * 63 + 127) / 255;
+        const int b = (rgb[2] * 31 + 127) / 255;
+        return static_cast<unsigned short>((r << 11) | (g << 5) | b);
+    }
+
+    void unpack565(unsigned short c, int* rgb) {
+        const int r = (c >> 11) & 31, g = (c >> 5) & 63, b = c & 31;
+        rgb[0] = (r << 3) | (r >> 2);
+        rgb[1] = (g << 2) | (g >> 4);
+        rgb[2] = (b << 3) | (b >> 2);
+    }
+
+    /// Bloque de color BC1 en modo de 4 colores (8 bytes); también es la mitad de BC3.
+    void encodeColor(const unsigned char* block, unsigned char* out) {
+        int lo[4], hi[4];
+        fitEndpoints(block, 3, lo, hi);
+        unsigned short c0 = pack565(hi);
+        unsigned short c1 = pack565(lo);
+        if (c0 < c1) {
+            std::swap(c0, c1);
+        }
+
+        unsigned int indices = 0;
+        if (c0 != c1) {
+            int palette[4][3];
+            unpack565(c0, palette[0]);
+            unpack565(c1, palette[1]);
+            for (unsigned int c = 0; c < 3; ++c) {
+                palette[2][c] = (2 * palette[0][c] + palette[1][c] + 1) / 3;
+                palette[3][c] = (palette[0][c] + 2 * palette[1][c] + 1) / 3;
+            }
+            for (unsigned int i = 0; i < 16; ++i) {
+                unsigned int best = 0, bestError = UINT_MAX;
+                for (unsigned int p = 0; p < 4; ++p) {
+                    const unsigned int error = squaredDistance(block + i * 4, palette[p], 3);
+                    if (error < bestError) {
+                        bestError = error;
+                        best = p;
+                    }
+                }
+                indices |= best << (2 * i);
+            }
+        }
+        // c0 == c1: todos los índices a 0 (el color 3 sería negro transparente si c0 <= c1).
+        out[0] = static_cast<unsigned char>(c0 & 0xFF);
+        out[1] = static_cast<unsigned char>(c0 >> 8);
+        out[2] = static_cast<unsigned char>(c1 & 0xFF);
+        out[3] = static_cast<unsigned char>(c1 >> 8);
+        memcpy(out + 4, &indices, 4);
+    }
+
+    /// Bloque BC4 de un canal (8 bytes): dos extremos y 8 niveles interpolados.
+    void encodeChannel(const unsigned char* block, unsigned int channel, unsigned char* out) {
+        int a0 = 0, a1 = 255;
+        for (unsigned int i = 0; i < 16; ++i) {
+            a0 = (std::max)(a0, static_cast<int>(block[i * 4 + channel]));
+            a1 = (std::min)(a1, static_cast<int>(block[i * 4 + channel]));
+        }
+        out[0] = static_cast<unsigned char>(a0);
+        out[1] = static_cast<unsigned char>(a1);
+
+        unsigned long long indices = 0;
+        if (a0 != a1) {
+            int palette[8] = { a0, a1 };
+            for (int k = 2; k < 8; ++k) {
+                palette[k] = ((8 - k) * a0 + (k - 1) * a1 + 3) / 7;
+            }
+            for (unsigned int i = 0; i < 16; ++i) {
+                const int v = block[i * 4 + channel];
+                unsigned int best = 0;
+                int bestError = INT_MAX;
+                for (unsigned int p = 0; p < 8; ++p) {
+                    const int error = abs(v - palette[p]);
+                    if (error < bestError) {
+                        bestError = error;
+                        best = p;
+                    }
+                }
+                indices |= static_cast<unsigned long long>(best) << (3 * i);
+            }
+        }
+        for (unsigned int b = 0; b < 6; ++b) {
+            out[2 + b] = static_cast<unsigned char>(indices >> (8 * b));
+        }
+    }
+
+    /// Pesos de interpolación de los índices de 4 bits de BC7 (sobre 64).
+    const int kBC7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    /// Cuantiza un extremo RGBA a 7 bits por canal + bit P compartido (el de menor error).
+    void quantizeBC7(const int* color, int* quantized, int& pbit, int* decoded) {
+        unsigned int bestError = UINT_MAX;
+        for (int p = 0; p < 2; ++p) {
+            int q[4], d[4];
+            unsigned int error = 0;
+            for (unsigned int c = 0; c < 4; ++c) {
+                q[c] = (std::min)((std::max)((color[c] - p + 1) >> 1, 0), 127);
+                d[c] = (q[c] << 1) | p;
+                error += (d[c] - color[c]) * (d[c] - color[c]);
+            }
+            if (error < bestError) {
+                bestError = error;
+                pbit = p;
+                memcpy(quantized, q, sizeof(q));
+                memcpy(decoded, d, sizeof(d));
+            }
+        }
+    }
+}
+
+DXGI_FORMAT BlockCompressor::getFormat(TextureCompression compression) {
+    switch (compression) {
+    case TEXTURE_COMPRESSION_BC1: return DXGI_FORMAT_BC1_UNORM;
+    case TEXTURE_COMPRESSION_BC3: return DXGI_FORMAT_BC3_UNORM;
+    case TEXTURE_COMPRESSION_BC5: return DXGI_FORMAT_BC5_UNORM;
+    case TEXTURE_COMPRESSION_BC7: return DXGI_FORMAT_BC7_UNORM;
+    default: return DXGI_FORMAT_UNKNOWN;
+    }
+}
+
+unsigned int BlockCompressor::getBlockBytes(DXGI_FORMAT format) {
+    return format == DXGI_FORMAT_BC1_UNORM ? 8 : 16;
+}
+
+TextureCompression BlockCompressor::chooseAuto(const unsigned char* rgba, unsigned int width, unsigned int height) {
+    const size_t count = static_cast<size_t>(width) * height;
+    for (size_t i = 0; i < count; ++i) {
+        if (rgba[i * 4 + 3] != 255) {
+            return TEXTURE_COMPRESSION_BC3;
+        }
+    }
+    return TEXTURE_COMPRESSION_BC1;
+}
+
+void BlockCompressor::encodeBC1(const unsigned char* block, unsigned char* out) {
+    encodeColor(block, out);
+}
+
+void BlockCompressor::encodeBC3(const unsigned char* block, unsigned char* out) {
+    encodeChannel(block, 3, out);
+    encodeColor(block, out + 8);
+}
+
+void BlockCompressor::encodeBC5(const unsigned char* block, unsigned char* out) {
+    encodeChannel(block, 0, out);
+    encodeChannel(block, 1, out + 8);
+}
+
+void BlockCompressor::encodeBC7(const unsigned char* block, unsigned char* out) {
+    int lo[4], hi[4];
+    fitEndpoints(block, 4, lo, hi);
+
+    int q[2][4], p[2], e[2][4];
+    quantizeBC7(lo, q[0], p[0], e[0]);
+    quantizeBC7(hi, q[1], p[1], e[1]);
+
+    int palette[16][4];
+    for (unsigned int w = 0; w < 16; ++w) {
+        for (unsigned int c = 0; c < 4; ++c) {
+            palette[w][c] = ((64 - kBC7Weights[w]) * e[0][c] + kBC7Weights[w] * e[1][c] + 32) >> 6;
+        }
+    }
+    unsigned int indices[16];
+    for (unsigned int i = 0; i < 16; ++i) {
+        unsigned int best = 0, bestError = UINT_MAX;
+        for (unsigned int w = 0; w < 16; ++w) {
+            const unsigned int error = squaredDistance(block + i * 4, palette[w], 4);
+            if (error < bestError) {
+                bestError = error;
+                best = w;
+            }
+        }
+        indices[i] = best;
+    }
+
+    // El índice del texel 0 se guarda con 3 bits: su bit alto debe ser 0.
+    if (indices[0] & 8) {
+        std::swap(q[0], q[1]);
+        std::swap(p[0], p[1]);
+        for (unsigned int& index : indices) {
+            index = 15 - index;
+        }
+    }
+
+    memset(out, 0, 16);
+    BitWriter bits = { out };
+    bits.write(1u << 6, 7);                     // modo 6
+    for (unsigned int c = 0; c < 4; ++c) {
+        bits.write(q[0][c], 7);
+        bits.write(q[1][c], 7);
+    }
+    bits.write(p[0], 1);
+    bits.write(p[1], 1);
+    bits.write(indices[0], 3);
+    for (unsigned int i = 1; i < 16; ++i) {
+        bits.write(indices[i], 4);
+    }
+}
+
+/**
+ * @details Modo 11: una región, extremos de 10 bits sin deltas. El formato sin signo
+ * deshace la cuantización como `half = (comp * 64 + 32) * 31 / 64`, así que cada paso del
+ * extremo son unos 31 pasos de half; el error se mide en bits de half, que es casi
+ * logarítmico (lo que se ve en HDR).
+ */
+void BlockCompressor::encodeBC6H(const unsigned short* block, unsigned char* out) {
+    int lo[3], hi[3];
+    for (unsigned int c = 0; c < 3; ++c) {
+        lo[c] = INT_MAX;
+        hi[c] = 0;
+        for (unsigned int i = 0; i < 16; ++i) {
+            lo[c] = (std::min)(lo[c], static_cast<int>(block[i * 3 + c]));
+            hi[c] = (std::max)(hi[c], static_cast<int>(block[i * 3 + c]));
+        }
+    }
+
+    int q[2][3], e[2][3];
+    for (unsigned int c = 0; c < 3; ++c) {
+        // Mínimo hacia abajo y máximo hacia arriba: la caja cuantizada cubre el bloque.
+        q[0][c] = (std::min)(lo[c] / 31, 1023);
+        q[1][c] = (std::min)((hi[c] + 30) / 31, 1023);
+        for (unsigned int k = 0; k < 2; ++k) {
+            // Descuantización de 10 bits (la del hardware): los extremos 0 y 1023 son exactos.
+            e[k][c] = q[k][c] == 0 ? 0 : q[k][c] == 1023 ? 0xFFFF : ((q[k][c] << 16) + 0x8000) >> 10;
+        }
+    }
+
+    int palette[16][3];
+    for (unsigned int w = 0; w < 16; ++w) {
+        for (unsigned int c = 0; c < 3; ++c) {
+            palette[w][c] = ((((64 - kBC7Weights[w]) * e[0][c] + kBC7Weights[w] * e[1][c] + 32) >> 6) * 31) >> 6;
+        }
+    }
+    unsigned int indices[16];
+    for (unsigned int i = 0; i < 16; ++i) {
+        unsigned int best = 0;
+        long long bestError = LLONG_MAX;
+        for (unsigned int w = 0; w < 16; ++w) {
+            long long error = 0;
+            for (unsigned int c = 0; c < 3; ++c) {
+                const long long d = static_cast<long long>(block[i * 3 + c]) - palette[w][c];
+                error += d * d;
+            }
+            if (error < bestError) {
+                bestError = error;
+                best = w;
+            }
+        }
+        indices[i] = best;
+    }
+
+    // Como en BC7: el índice del texel 0 se guarda con 3 bits.
+    if (indices[0] & 8) {
+        std::swap(q[0], q[1]);
+        for (unsigned int& index : indices) {
+            index = 15 - index;
+        }
+    }
+
+    memset(out, 0, 16);
+    BitWriter bits = { out };
+    bits.write(3, 5);                           // modo 11 (00011)
+    for (unsigned int k = 0; k < 2; ++k) {
+        for (unsigned int c = 0; c < 3; ++c) {
+            bits.write(q[k][c], 10);
+        }
+    }
+    bits.write(indices[0], 3);
+    for (unsigned int i = 1; i < 16; ++i) {
+        bits.write(indices[i], 4);
+    }
+}
+
+bool BlockCompressor::compressHDR(const float* rgb, unsigned int width, unsigned int height, CompressedImage& out) {
+    if (!rgb || width == 0 || height == 0 || width % 4 != 0 || height % 4 != 0) {
+        return false;
+    }
+    out.format = DXGI_FORMAT_BC6H_UF16;
+    out.levels.clear();
+    CompressedImage::Level level;
+    level.width = width;
+    level.height = height;
+    level.rowPitch = (width / 4) * 16;
+    level.size = static_cast<size_t>(level.rowPitch) * (height / 4);
+    out.levels.push_back(level);
+    out.data.assign(level.size, 0);
+
+    unsigned short block[48];
+    unsigned char* dst = out.data.data();
+    for (unsigned int by = 0; by < height; by += 4) {
+        for (unsigned int bx = 0; bx < width; bx += 4) {
+            for (unsigned int i = 0; i < 16; ++i) {
+                const float* texel = rgb + ((static_cast<size_t>(by + (i >> 2)) * width) + bx + (i & 3)) * 3;
+                for (unsigned int c = 0; c < 3; ++c) {
+                    // Sin signo y sin infinitos: el mayor half finito es 65 504.
+                    const float value = (std::min)((std::max)(texel[c], 0.0f), 65504.0f);
+                    block[i * 3 + c] = XMConvertFloatToHalf(value);
+                }
+            }
+            encodeBC6H(block, dst);
+            dst += 16;
+        }
+    }
+    return true;
+}
+
+bool BlockCompressor::compress(const MipChain& mips, TextureCompression compression, CompressedImage& out) {
+    const std::vector<MipChain::Level>& levels = mips.getLevels();
+    if (levels.empty() || levels[0].width % 4 != 0 || levels[0].height % 4 != 0) {
+        return false;
+    }
+    if (compression == TEXTURE_COMPRESSION_AUTO) {
+        compression = chooseAuto(mips.getLevelPixels(0), levels[0].width, levels[0].height);
+    }
+    out.format = getFormat(compression);
+    if (out.format == DXGI_FORMAT_UNKNOWN) {
+        return false;
+    }
+
+    void (*encode)(const unsigned char*, unsigned char*) =
+        compression == TEXTURE_COMPRESSION_BC1 ? encodeBC1 :
+        compression == TEXTURE_COMPRESSION_BC3 ? encodeBC3 :
+        compression == TEXTURE_COMPRESSION_BC5 ? encodeBC5 : encodeBC7;
+    const unsigned int blockBytes = getBlockBytes(out.format);
+
+    out.levels.clear();
+    size_t total = 0;
+    for (const MipChain::Level& level : levels) {
+        CompressedImage::Level compressed;
+        compressed.width = level.width;
+        compressed.height = level.height;
+        compressed.offset = total;
+        compressed.rowPitch = ((level.width + 3) / 4) * blockBytes;
+        compressed.size = static_cast<size_t>(compressed.rowPitch) * ((level.height + 3) / 4);
+        out.levels.push_back(compressed);
+        total += compressed.size;
+    }
+    out.data.assign(total, 0);
+
+    unsigned char block[64];
+    for (size_t l = 0; l < levels.size(); ++l) {
+        const MipChain::Level& level = levels[l];
+        const unsigned char* pixels = mips.getLevelPixels(static_cast<unsigned int>(l));
+        unsigned char* dst = out.data.data() + out.levels[l].offset;
+        for (unsigned int by = 0; by < level.height; by += 4) {
+            for (unsigned int bx = 0; bx < level.width; bx += 4) {
+                // Mips de 2x2 o 1x1: se repite el borde para llenar el bloque.
+                for (unsigned int i = 0; i < 16; ++i) {
+                    const unsigned int x = (std::min)(bx + (i & 3), level.width - 1);
+                    const unsigned int y = (std::min)(by + (i >> 2), level.height - 1);
+                    memcpy(block + i * 4, pixels + (static_cast<size_t>(y) * level.width + x) * 4, 4);
+                }
+                encode(block, dst);
+                dst += blockBytes;
+            }
+        }
+    }
+    return true;
+}
@@ -0,0 +1,194 @@
+﻿/**
+ * @file Broadphase.cpp
+ * @brief Implementación del sweep-and-prune con pruebas SSE y barrido en paralelo.
+ *
+ * @details
+ * Los centinelas del final tienen el mínimo X en `FLT_MAX`: el grupo de cuatro que los
+ * incluye nunca pasa la prueba en X, así que el barrido se corta sin comprobar el
+ * final de la lista en cada paso y las cargas de 4 floats no se salen del arreglo.
+ */
+
+#include "Broadphase.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <cfloat>
+#include <xmmintrin.h>
+
+Broadphase::BodyID Broadphase::add(const XMFLOAT3& boundsMin, const XMFLOAT3& boundsMax, uint32_t userData) {
+    BodyID body;
+    if (!m_free.empty()) {
+        body = m_free.back();
+        m_free.pop_back();
+    }
+    else {
+        body = static_cast<BodyID>(m_bodies.size());
+        m_bodies.emplace_back();
+    }
+    Body& b = m_bodies[body];
+    b.boundsMin = boundsMin;
+    b.boundsMax = boundsMax;
+    b.userData = userData;
+    b.alive = true;
+    m_order.push_back(body);
+    ++m_pendingAdds;
+    return body;
+}
+
+void Broadphase::remove(BodyID body) {
+    if (body >= m_bodies.size() || !m_bodies[body].alive) {
+        return;
+    }
+    // Sigue en `m_order` hasta el próximo `findPairs`; su identificador se libera allí.
+    m_bodies[body].alive = false;
+    ++m_pendingRemovals;
+}
+
+void Broadphase::setBounds(BodyID body, const XMFLOAT3& boundsMin, const XMFLOAT3& boundsMax) {
+    Body& b = m_bodies[body];
+    b.boundsMin = boundsMin;
+    b.boundsMax = boundsMax;
+}
+
+void Broadphase::clear() {
+    m_bodies.clear();
+    m_free.clear();
+    m_order.clear();
+    m_pendingAdds = 0;
+    m_pendingRemovals = 0;
+    m_batches.clear();
+}
+
+void Broadphase::sortAxis() {
+    // Bajas: fuera de la lista y sus identificadores, libres.
+    if (m_pendingRemovals > 0) {
+        size_t kept = 0;
+        for (BodyID body : m_order) {
+            if (m_bodies[body].alive) {
+                m_order[kept++] = body;
+            }
+            else {
+                m_free.push_back(body);
+            }
+        }
+        m_order.resize(kept);
+        m_pendingRemovals = 0;
+    }
+
+    m_swapCount = 0;
+    const std::vector<Body>& bodies = m_bodies;
+    if (m_pendingAdds > 0 && m_pendingAdds * kResortRatio > m_order.size()) {
+        std::sort(m_order.begin(), m_order.end(), [&bodies](BodyID a, BodyID b) {
+            return bodies[a].boundsMin.x < bodies[b].boundsMin.x;
+        });
+    }
+    else {
+        // Inserción: con coherencia entre frames cada cuerpo se mueve pocos puestos.
+        for (size_t i = 1; i < m_order.size(); ++i) {
+            const BodyID body = m_order[i];
+            const float key = bodies[body].boundsMin.x;
+            size_t j = i;
+            while (j > 0 && bodies[m_order[j - 1]].boundsMin.x > key) {
+                m_order[j] = m_order[j - 1];
+                --j;
+            }
+            m_order[j] = body;
+            m_swapCount += static_cast<unsigned int>(i - j);
+        }
+    }
+    m_pendingAdds = 0;
+}
+
+void Broadphase::findPairs(std::vector<Pair>& outPairs, bool parallel) {
+    outPairs.clear();
+    sortAxis();
+    m_testCount = 0;
+    const unsigned int count = static_cast<unsigned int>(m_order.size());
+    if (count < 2) {
+        return;
+    }
+
+    // SoA en el orden del eje, con centinelas que cortan el barrido.
+    const size_t padded = static_cast<size_t>(count) + 4;
+    m_minX.resize(padded); m_maxX.resize(padded);
+    m_minY.resize(padded); m_maxY.resize(padded);
+    m_minZ.resize(padded); m_maxZ.resize(padded);
+    for (unsigned int i = 0; i < count; ++i) {
+        const Body& b = m_bodies[m_order[i]];
+        m_minX[i] = b.boundsMin.x; m_maxX[i] = b.boundsMax.x;
+        m_minY[i] = b.boundsMin.y; m_maxY[i] = b.boundsMax.y;
+        m_minZ[i] = b.boundsMin.z; m_maxZ[i] = b.boundsMax.z;
+    }
+    for (size_t i = count; i < padded; ++i) {
+        m_minX[i] = m_minY[i] = m_minZ[i] = FLT_MAX;
+        m_maxX[i] = m_maxY[i] = m_maxZ[i] = -FLT_MAX;
+    }
+
+    const unsigned int batchCount = (count + kSweepBatch - 1) / kSweepBatch;
+    m_batches.resize(batchCount);
+    auto sweepBatches = [this, count](unsigned int begin, unsigned int end) {
+        for (unsigned int batch = begin; batch < end; ++batch) {
+            const unsigned int first = batch * kSweepBatch;
+            sweep(first, (std::min)(first + kSweepBatch, count), m_batches[batch]);
+        }
+    };
+    if (parallel) {
+        JobSystem::getDefault().parallelFor(batchCount, sweepBatches, 1);
+    }
+    else {
+        sweepBatches(0, batchCount);
+    }
+
+    size_t total = 0;
+    for (unsigned int batch = 0; batch < batchCount; ++batch) {
+        total += m_batches[batch].pairs.size();
+        m_testCount += m_batches[batch].tests;
+    }
+    outPairs.reserve(total);
+    for (unsigned int batch = 0; batch < batchCount; ++batch) {
+        outPairs.insert(outPairs.end(), m_batches[batch].pairs.begin(), m_batches[batch].pairs.end());
+    }
+}
+
+void Broadphase::sweep(unsigned int begin, unsigned int end, Batch& out) const {
+    const unsigned int count = static_cast<unsigned int>(m_order.size());
+    out.pairs.clear();
+    out.tests = 0;
+    const float* minX = m_minX.data();
+    const float* minY = m_minY.data();
+    const float* maxY = m_maxY.data();
+    const float* minZ = m_minZ.data();
+    const float* maxZ = m_maxZ.data();
+    for (unsigned int i = begin; i < end; ++i) {
+        const __m128 maxXi = _mm_set1_ps(m_maxX[i]);
+        const __m128 minYi = _mm_set1_ps(minY[i]);
+        const __m128 maxYi = _mm_set1_ps(maxY[i]);
+        const __m128 minZi = _mm_set1_ps(minZ[i]);
+        const __m128 maxZi = _mm_set1_ps(maxZ[i]);
+        const BodyID bodyI = m_order[i];
+        // Ordenados por mínimo X: el solape en X es `minX[j] <= maxX[i]` y, en cuanto
+        // un candidato falla, fallan todos los que le siguen.
+        for (unsigned int j = i + 1;; j += 4) {
+            const __m128 inX = _mm_cmple_ps(_mm_loadu_ps(minX + j), maxXi);
+            const int xMask = _mm_movemask_ps(inX);
+            if (xMask == 0) {
+                break;
+            }
+            __m128 overlap = _mm_and_ps(inX, _mm_cmple_ps(_mm_loadu_ps(minY + j), maxYi));
+            overlap = _mm_and_ps(overlap, _mm_cmple_ps(minYi, _mm_loadu_ps(maxY + j)));
+            overlap = _mm_and_ps(overlap, _mm_cmple_ps(_mm_loadu_ps(minZ + j), maxZi));
+            overlap = _mm_and_ps(overlap, _mm_cmple_ps(minZi, _mm_loadu_ps(maxZ + j)));
+            int mask = _mm_movemask_ps(overlap);
+            for (unsigned int lane = 0; mask != 0; ++lane, mask >>= 1) {
+                if ((mask & 1) && j + lane < count) {
+                    const BodyID bodyJ = m_order[j + lane];
+                    out.pairs.push_back(bodyI < bodyJ ? Pair{ bodyI, bodyJ } : Pair{ bodyJ, bodyI });
+                }
+            }
+            out.tests += (xMask & 1) + ((xMask >> 1) & 1) + ((xMask >> 2) & 1) + ((xMask >> 3) & 1);
+            // Un cuerpo con el máximo X en `FLT_MAX` también "solapa" los centinelas.
+            if (xMask != 0xF || j + 4 >= count) {
+                break;
+            }
+        }
+    }
+}
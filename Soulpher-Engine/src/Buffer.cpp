@@ -8,9 +8,13 @@
  * - **Index Buffer**   (IASetIndexBuffer)
  * - **Constant Buffer** (VS/PS SetConstantBuffers)
  *
+ * Todas las creaciones pasan por `Buffer::create` con una política (`BufferUsage`).
+ *
  * 🔹 Consejos para estudiantes:
+ * - La geometría estática va `IMMUTABLE`: el driver la coloca donde mejor la lee la GPU.
  * - Usa `D3D11_USAGE_DEFAULT + UpdateSubresource` cuando actualizas poco por frame.
- * - Para actualizar mucho desde CPU, preferir `D3D11_USAGE_DYNAMIC + Map/Unmap`.
+ * - Para actualizar mucho desde CPU, preferir `D3D11_USAGE_DYNAMIC + Map/Unmap`
+ *   (`write` reescribe entero; `append` va añadiendo en anillo).
  * - `m_stride` = tamaño de elemento (vértice o índice) para VB/IB; para CB guarda su ByteWidth.
  */
 
@@ -18,21 +22,100 @@
 #include "Device.h"
 #include "DeviceContext.h"
 #include "MeshComponent.h"
+#include "GpuReleaseQueue.h"
+
+/**
+ * @brief Crea el buffer con la política de uso pedida.
+ *
+ * @details
+ * | Política                  | `Usage`     | CPU   | Escritura                         |
+ * |---------------------------|-------------|-------|-----------------------------------|
+ * | `BUFFER_IMMUTABLE`        | IMMUTABLE   | —     | Solo datos iniciales              |
+ * | `BUFFER_DEFAULT`          | DEFAULT     | —     | `update` / `copyRegion`           |
+ * | `BUFFER_DYNAMIC_DISCARD`  | DYNAMIC     | WRITE | `write` (`WRITE_DISCARD`)         |
+ * | `BUFFER_DYNAMIC_RING`     | DYNAMIC     | WRITE | `append` (`WRITE_NO_OVERWRITE`)   |
+ * | `BUFFER_STAGING_READBACK` | STAGING     | READ  | `copyRegion` desde la GPU         |
+ */
+HRESULT Buffer::create(Device& device, BufferUsage usage, unsigned int bindFlag,
+    unsigned int byteWidth, unsigned int stride, const void* data) {
+    if (!device.m_device) {
+        ERROR("Buffer", "create", "Device is null.");
+        return E_POINTER;
+    }
+    if (byteWidth == 0 || stride == 0) {
+        ERROR("Buffer", "create", "byteWidth or stride is zero");
+        return E_INVALIDARG;
+    }
+    if (usage == BUFFER_IMMUTABLE && !data) {
+        ERROR("Buffer", "create", "Immutable buffers need initial data");
+        return E_INVALIDARG;
+    }
+    if (usage == BUFFER_STAGING_READBACK && bindFlag != 0) {
+        ERROR("Buffer", "create", "Staging buffers cannot be bound to the pipeline");
+        return E_INVALIDARG;
+    }
+    // D3D11.0 no admite `WRITE_NO_OVERWRITE` en constant buffers.
+    if (usage == BUFFER_DYNAMIC_RING && (bindFlag & D3D11_BIND_CONSTANT_BUFFER)) {
+        ERROR("Buffer", "create", "Constant buffers cannot be used as a ring");
+        return E_INVALIDARG;
+    }
+    // Las UAV sin tipo leen y escriben palabras de 32 bits.
+    if ((bindFlag & D3D11_BIND_UNORDERED_ACCESS) && (usage != BUFFER_DEFAULT || byteWidth % 4 != 0)) {
+        ERROR("Buffer", "create", "Unordered access needs a BUFFER_DEFAULT buffer with a size multiple of 4");
+        return E_INVALIDARG;
+    }
+    if ((bindFlag & D3D11_BIND_INDEX_BUFFER) && stride != sizeof(unsigned short) && stride != sizeof(unsigned int)) {
+        ERROR("Buffer", "create", "Index stride must be 2 or 4 bytes");
+        return E_INVALIDARG;
+    }
+
+    D3D11_BUFFER_DESC desc = {};
+    desc.ByteWidth = byteWidth;
+    desc.BindFlags = bindFlag;
+    if (bindFlag & D3D11_BIND_UNORDERED_ACCESS) {
+        desc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_ALLOW_RAW_VIEWS;
+    }
+    switch (usage) {
+    case BUFFER_IMMUTABLE:
+        desc.Usage = D3D11_USAGE_IMMUTABLE;
+        break;
+    case BUFFER_DEFAULT:
+        desc.Usage = D3D11_USAGE_DEFAULT;
+        break;
+    case BUFFER_DYNAMIC_DISCARD:
+    case BUFFER_DYNAMIC_RING:
+        desc.Usage = D3D11_USAGE_DYNAMIC;
+        desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+        break;
+    case BUFFER_STAGING_READBACK:
+        desc.Usage = D3D11_USAGE_STAGING;
+        desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+        break;
+    }
+
+    m_usage = usage;
+    m_bindFlag = bindFlag;
+    m_stride = stride;
+    m_ringCursor = 0;
+    m_indexFormat = DXGI_FORMAT_UNKNOWN;
+    if (bindFlag & D3D11_BIND_INDEX_BUFFER) {
+        m_indexFormat = stride == sizeof(unsigned short) ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+    }
+
+    D3D11_SUBRESOURCE_DATA initData = {};
+    initData.pSysMem = data;
+    return createBuffer(device, desc, data ? &initData : nullptr);
+}
 
  /**
   * @brief Inicializa un Vertex o Index Buffer a partir de una malla.
   * @param device Dispositivo D3D11.
   * @param mesh   Malla con arrays de vértices/índices.
   * @param bindFlag D3D11_BIND_VERTEX_BUFFER o D3D11_BIND_INDEX_BUFFER.
+  * @param usage  Política de uso (inmutable salvo que se vaya a reescribir).
   * @return HRESULT S_OK si ok.
-  *
-  * @note Se usa D3D11_USAGE_DEFAULT y UpdateSubresource para subidas puntuales.
   */
-HRESULT Buffer::init(Device& device, const MeshComponent& mesh, unsigned int bindFlag) {
-    if (!device.m_device) {
-        ERROR("Buffer", "init", "Device is null.");
-        return E_POINTER;
-    }
+HRESULT Buffer::init(Device& device, const MeshComponent& mesh, unsigned int bindFlag, BufferUsage usage) {
     if ((bindFlag & D3D11_BIND_VERTEX_BUFFER) && mesh.m_vertex.empty()) {
         ERROR("Buffer", "init", "Vertex buffer is empty");
         return E_INVALIDARG;
@@ -42,27 +125,21 @@ HRESULT Buffer::init(Device& device, const MeshComponent& mesh, unsigned int bin
         return E_INVALIDARG;
     }
 
-    D3D11_BUFFER_DESC desc = {};
-    D3D11_SUBRESOURCE_DATA data = {};
-
-    desc.Usage = D3D11_USAGE_DEFAULT;
-    desc.CPUAccessFlags = 0;
-    m_bindFlag = bindFlag;
-
     if (bindFlag & D3D11_BIND_VERTEX_BUFFER) {
-        m_stride = sizeof(SimpleVertex);
-        desc.ByteWidth = m_stride * static_cast<unsigned int>(mesh.m_vertex.size());
-        desc.BindFlags = (D3D11_BIND_FLAG)bindFlag;
-        data.pSysMem = mesh.m_vertex.data();
+        const unsigned int count = static_cast<unsigned int>(mesh.m_vertex.size());
+        return create(device, usage, bindFlag, count * sizeof(SimpleVertex), sizeof(SimpleVertex), mesh.m_vertex.data());
     }
-    else if (bindFlag & D3D11_BIND_INDEX_BUFFER) {
-        m_stride = sizeof(unsigned int);
-        desc.ByteWidth = m_stride * static_cast<unsigned int>(mesh.m_index.size());
-        desc.BindFlags = (D3D11_BIND_FLAG)bindFlag;
-        data.pSysMem = mesh.m_index.data();
+    if (bindFlag & D3D11_BIND_INDEX_BUFFER) {
+        // Con menos de 65 536 vértices todos los índices caben en 16 bits.
+        const unsigned int count = static_cast<unsigned int>(mesh.m_index.size());
+        if (mesh.m_vertex.size() <= 0xFFFF) {
+            std::vector<unsigned short> narrow(mesh.m_index.begin(), mesh.m_index.end());
+            return create(device, usage, bindFlag, count * sizeof(unsigned short), sizeof(unsigned short), narrow.data());
+        }
+        return create(device, usage, bindFlag, count * sizeof(unsigned int), sizeof(unsigned int), mesh.m_index.data());
     }
-
-    return createBuffer(device, desc, &data);
+    ERROR("Buffer", "init", "bindFlag must be a vertex or index buffer");
+    return E_INVALIDARG;
 }
 
 /**
@@ -74,23 +151,180 @@ HRESULT Buffer::init(Device& device, const MeshComponent& mesh, unsigned int bin
  * @warning D3D11 requiere alineación a 16 bytes para constant buffers.
  */
 HRESULT Buffer::init(Device& device, unsigned int ByteWidth) {
-    if (!device.m_device) {
-        ERROR("Buffer", "init", "Device is null.");
+    return create(device, BUFFER_DEFAULT, D3D11_BIND_CONSTANT_BUFFER, ByteWidth, ByteWidth);
+}
+
+/**
+ * @brief Crea un Vertex Buffer `IMMUTABLE` con datos ya codificados.
+ */
+HRESULT Buffer::initVertices(Device& device, const void* data, unsigned int stride, unsigned int count) {
+    if (!data || stride == 0 || count == 0) {
+        ERROR("Buffer", "initVertices", "Vertex buffer is empty");
+        return E_INVALIDARG;
+    }
+    return create(device, BUFFER_IMMUTABLE, D3D11_BIND_VERTEX_BUFFER, stride * count, stride, data);
+}
+
+/**
+ * @brief Crea un Vertex Buffer `DEFAULT` con vistas sin tipo permitidas.
+ */
+HRESULT Buffer::initWritableVertices(Device& device, const void* data, unsigned int stride, unsigned int count) {
+    if (!data || stride == 0 || count == 0) {
+        ERROR("Buffer", "initWritableVertices", "Vertex buffer is empty");
+        return E_INVALIDARG;
+    }
+    return create(device, BUFFER_DEFAULT, D3D11_BIND_VERTEX_BUFFER | D3D11_BIND_UNORDERED_ACCESS,
+        stride * count, stride, data);
+}
+
+/**
+ * @brief Crea un Index Buffer `IMMUTABLE`, de 16 bits si se pide.
+ */
+HRESULT Buffer::initIndices(Device& device, const unsigned int* indices, unsigned int count, bool narrow) {
+    if (!indices || count == 0) {
+        ERROR("Buffer", "initIndices", "Index buffer is empty");
+        return E_INVALIDARG;
+    }
+    if (narrow) {
+        std::vector<unsigned short> narrowed(indices, indices + count);
+        return create(device, BUFFER_IMMUTABLE, D3D11_BIND_INDEX_BUFFER,
+            count * sizeof(unsigned short), sizeof(unsigned short), narrowed.data());
+    }
+    return create(device, BUFFER_IMMUTABLE, D3D11_BIND_INDEX_BUFFER,
+        count * sizeof(unsigned int), sizeof(unsigned int), indices);
+}
+
+/**
+ * @brief Crea un Vertex/Index Buffer `DEFAULT` sin datos iniciales.
+ */
+HRESULT Buffer::initStorage(Device& device, unsigned int stride, unsigned int count, unsigned int bindFlag) {
+    return create(device, BUFFER_DEFAULT, bindFlag, stride * count, stride);
+}
+
+/**
+ * @brief Copia una región de `source` a este buffer en la GPU.
+ */
+void Buffer::copyRegion(DeviceContext& deviceContext, unsigned int dstOffset, const Buffer& source,
+    unsigned int srcOffset, unsigned int bytes) {
+    if (!m_buffer || !source.m_buffer) {
+        ERROR("Buffer", "copyRegion", "m_buffer or source is null.");
+        return;
+    }
+    if (bytes == 0) {
+        return;
+    }
+    const D3D11_BOX box = { srcOffset, 0, 0, srcOffset + bytes, 1, 1 };
+    deviceContext.CopySubresourceRegion(m_buffer, 0, dstOffset, 0, 0, source.m_buffer, 0, &box);
+}
+
+/**
+ * @brief Crea un buffer `DYNAMIC` con acceso de escritura desde CPU.
+ *
+ * @note Ideal para datos que se regeneran cada frame (instancias, partículas):
+ * el driver entrega memoria nueva en cada `WRITE_DISCARD` sin esperar a la GPU.
+ */
+HRESULT Buffer::initDynamic(Device& device, unsigned int ByteWidth, unsigned int stride, unsigned int bindFlag) {
+    return create(device, BUFFER_DYNAMIC_DISCARD, bindFlag, ByteWidth, stride);
+}
+
+/**
+ * @details
+ * Las escrituras piden un buffer dinámico y la lectura uno de staging: cualquier otra
+ * combinación la rechazaría el runtime con un error menos claro.
+ */
+HRESULT Buffer::map(DeviceContext& deviceContext, D3D11_MAP mapType, unsigned int mapFlags,
+    D3D11_MAPPED_SUBRESOURCE& mapped, const std::source_location& location) {
+    if (!m_buffer) {
+        ERROR("Buffer", "map", "m_buffer is null.");
         return E_POINTER;
     }
-    if (ByteWidth == 0) {
-        ERROR("Buffer", "init", "ByteWidth is zero");
+    const bool dynamic = m_usage == BUFFER_DYNAMIC_DISCARD || m_usage == BUFFER_DYNAMIC_RING;
+    const bool read = mapType == D3D11_MAP_READ;
+    if ((read && m_usage != BUFFER_STAGING_READBACK) || (!read && !dynamic)) {
+        ERROR("Buffer", "map", "Map type does not match the buffer usage");
         return E_INVALIDARG;
     }
-    m_stride = ByteWidth;
+    HRESULT hr = deviceContext.Map(m_buffer, 0, mapType, mapFlags, &mapped, location);
+    if (FAILED(hr) && hr != DXGI_ERROR_WAS_STILL_DRAWING) {
+        ERROR("Buffer", "map", ("Map failed. HRESULT: " + std::to_string(hr)).c_str());
+    }
+    return hr;
+}
 
-    D3D11_BUFFER_DESC desc = {};
-    desc.Usage = D3D11_USAGE_DEFAULT;
-    desc.ByteWidth = ByteWidth;
-    desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-    m_bindFlag = desc.BindFlags;
+void Buffer::unmap(DeviceContext& deviceContext) {
+    if (m_buffer) {
+        deviceContext.Unmap(m_buffer, 0);
+    }
+}
+
+Buffer::MapScope::MapScope(DeviceContext& deviceContext, Buffer& buffer, D3D11_MAP mapType, unsigned int mapFlags,
+    const std::source_location& location)
+    : m_deviceContext(deviceContext), m_buffer(buffer) {
+    m_result = buffer.map(deviceContext, mapType, mapFlags, m_mapped, location);
+}
+
+Buffer::MapScope::~MapScope() {
+    if (SUCCEEDED(m_result)) {
+        m_buffer.unmap(m_deviceContext);
+    }
+}
+
+/**
+ * @details
+ * El inicio se alinea al stride para que el desplazamiento sea un elemento entero
+ * (vértice o índice). La primera escritura y la que no cabe al final usan
+ * `WRITE_DISCARD` (memoria nueva); el resto, `WRITE_NO_OVERWRITE`, que no espera a la
+ * GPU porque promete no tocar lo ya escrito en esta vuelta.
+ */
+HRESULT Buffer::append(DeviceContext& deviceContext, const void* pSrcData, unsigned int byteCount,
+    unsigned int& offset) {
+    if (m_usage != BUFFER_DYNAMIC_RING) {
+        ERROR("Buffer", "append", "Buffer was not created as a dynamic ring.");
+        return E_INVALIDARG;
+    }
+    if (!pSrcData || byteCount == 0 || byteCount > m_byteWidth) {
+        ERROR("Buffer", "append", "Data is empty or larger than the ring.");
+        return E_INVALIDARG;
+    }
+
+    unsigned int start = (m_ringCursor + m_stride - 1) / m_stride * m_stride;
+    D3D11_MAP mapType = D3D11_MAP_WRITE_NO_OVERWRITE;
+    if (m_ringCursor == 0 || start + byteCount > m_byteWidth) {
+        start = 0;
+        mapType = D3D11_MAP_WRITE_DISCARD;
+    }
+    MapScope scope(deviceContext, *this, mapType);
+    if (!scope.isMapped()) {
+        return scope.getResult();
+    }
+    memcpy(static_cast<unsigned char*>(scope.getData()) + start, pSrcData, byteCount);
+    m_ringCursor = start + byteCount;
+    offset = start;
+    deviceContext.addUploadBytes(byteCount);
+    return S_OK;
+}
 
-    return createBuffer(device, desc, nullptr);
+/**
+ * @brief Sustituye el contenido del buffer dinámico.
+ */
+HRESULT Buffer::write(DeviceContext& deviceContext, const void* pSrcData, unsigned int byteCount) {
+    if (!m_buffer || !pSrcData) {
+        ERROR("Buffer", "write", "m_buffer or pSrcData is null.");
+        return E_POINTER;
+    }
+    if (byteCount > m_byteWidth) {
+        ERROR("Buffer", "write", "byteCount exceeds buffer capacity.");
+        return E_INVALIDARG;
+    }
+
+    MapScope scope(deviceContext, *this, D3D11_MAP_WRITE_DISCARD);
+    if (!scope.isMapped()) {
+        return scope.getResult();
+    }
+    memcpy(scope.getData(), pSrcData, byteCount);
+    m_ringCursor = byteCount;
+    deviceContext.addUploadBytes(byteCount, (m_bindFlag & D3D11_BIND_CONSTANT_BUFFER) != 0);
+    return S_OK;
 }
 
 /**
@@ -111,7 +345,8 @@ void Buffer::update(DeviceContext& deviceContext,
     const D3D11_BOX* pDstBox,
     const void* pSrcData,
     unsigned int SrcRowPitch,
-    unsigned int SrcDepthPitch) {
+    unsigned int SrcDepthPitch,
+    const std::source_location& location) {
     if (!m_buffer) {
         ERROR("Buffer", "update", "m_buffer is null.");
         return;
@@ -120,9 +355,13 @@ void Buffer::update(DeviceContext& deviceContext,
         ERROR("Buffer", "update", "pSrcData is null.");
         return;
     }
+    if (m_usage != BUFFER_DEFAULT) {
+        ERROR("Buffer", "update", "UpdateSubresource needs a BUFFER_DEFAULT buffer.");
+        return;
+    }
 
-    deviceContext.m_deviceContext->UpdateSubresource(
-        m_buffer, DstSubresource, pDstBox, pSrcData, SrcRowPitch, SrcDepthPitch
+    deviceContext.UpdateSubresource(
+        m_buffer, DstSubresource, pDstBox, pSrcData, SrcRowPitch, SrcDepthPitch, location
     );
 }
 
@@ -132,7 +371,7 @@ void Buffer::update(DeviceContext& deviceContext,
  * @param StartSlot Slot inicial (VB/CB).
  * @param NumBuffers Número de buffers.
  * @param setPixelShader Para CB: también enlaza a PS si true.
- * @param format Formato de índice (IB): ej. DXGI_FORMAT_R32_UINT.
+ * @param format Formato de índice (IB); `DXGI_FORMAT_UNKNOWN` = el de `init`.
  */
 void Buffer::render(DeviceContext& deviceContext,
     unsigned int StartSlot,
@@ -148,27 +387,28 @@ void Buffer::render(DeviceContext& deviceContext,
         return;
     }
 
-    switch (m_bindFlag) {
+    // La UAV no cuenta: un VB escrito por un compute shader se enlaza igual.
+    switch (m_bindFlag & ~D3D11_BIND_UNORDERED_ACCESS) {
     case D3D11_BIND_VERTEX_BUFFER:
-        deviceContext.m_deviceContext->IASetVertexBuffers(
+        deviceContext.IASetVertexBuffers(
             StartSlot, NumBuffers, &m_buffer, &m_stride, &m_offset
         );
         break;
 
     case D3D11_BIND_CONSTANT_BUFFER:
-        deviceContext.m_deviceContext->VSSetConstantBuffers(
+        deviceContext.VSSetConstantBuffers(
             StartSlot, NumBuffers, &m_buffer
         );
         if (setPixelShader) {
-            deviceContext.m_deviceContext->PSSetConstantBuffers(
+            deviceContext.PSSetConstantBuffers(
                 StartSlot, NumBuffers, &m_buffer
             );
         }
         break;
 
     case D3D11_BIND_INDEX_BUFFER:
-        deviceContext.m_deviceContext->IASetIndexBuffer(
-            m_buffer, format, m_offset
+        deviceContext.IASetIndexBuffer(
+            m_buffer, format == DXGI_FORMAT_UNKNOWN ? m_indexFormat : format, m_offset
         );
         break;
 
@@ -182,7 +422,11 @@ void Buffer::render(DeviceContext& deviceContext,
  * @brief Libera el recurso de GPU.
  */
 void Buffer::destroy() {
-    SAFE_RELEASE(m_buffer);
+    // Los frames en vuelo aún pueden leerlo: el `Release` espera a que la GPU los termine.
+    GpuReleaseQueue::getDefault().release(m_buffer);
+    m_buffer = nullptr;
+    m_byteWidth = 0;
+    m_ringCursor = 0;
 }
 
 /**
@@ -205,5 +449,6 @@ HRESULT Buffer::createBuffer(Device& device,
         ERROR("Buffer", "createBuffer", "Failed to create buffer");
         return hr;
     }
+    m_byteWidth = desc.ByteWidth;
     return S_OK;
 }
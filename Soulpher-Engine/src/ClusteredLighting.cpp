@@ -0,0 +1,267 @@
+﻿/**
+ * @file ClusteredLighting.cpp
+ * @brief Implementación de las luces locales: subida, culling por clusters y enlace.
+ *
+ * @details
+ * Orden de un frame: @ref ClusteredLighting::capture (con la copia del frame),
+ * @ref ClusteredLighting::cull antes de la escena (pase "Light culling" del grafo) y
+ * @ref ClusteredLighting::bind junto al resto de recursos del pase principal.
+ */
+
+#include "ClusteredLighting.h"
+#include "Device.h"
+#include "DeviceContext.h"
+#include "ShaderLibrary.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    const unsigned int kClusterCount =
+        ClusteredLighting::kClusterX * ClusteredLighting::kClusterY * ClusteredLighting::kClusterZ;
+
+    /// Buffer `R32_UINT` de `count` elementos con SRV (para el PS) y UAV (para el kernel).
+    HRESULT createIndexBuffer(Device& device, unsigned int count, ID3D11Buffer** buffer,
+        ID3D11ShaderResourceView** srv, ID3D11UnorderedAccessView** uav) {
+        D3D11_BUFFER_DESC desc = {};
+        desc.Usage = D3D11_USAGE_DEFAULT;
+        desc.ByteWidth = count * sizeof(uint32_t);
+        desc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_UNORDERED_ACCESS;
+        HRESULT hr = device.CreateBuffer(&desc, nullptr, buffer);
+
+        D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+        srvDesc.Format = DXGI_FORMAT_R32_UINT;
+        srvDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+        srvDesc.Buffer.NumElements = count;
+        if (SUCCEEDED(hr)) { hr = device.CreateShaderResourceView(*buffer, &srvDesc, srv); }
+
+        D3D11_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
+        uavDesc.Format = DXGI_FORMAT_R32_UINT;
+        uavDesc.ViewDimension = D3D11_UAV_DIMENSION_BUFFER;
+        uavDesc.Buffer.NumElements = count;
+        if (SUCCEEDED(hr)) { hr = device.CreateUnorderedAccessView(*buffer, &uavDesc, uav); }
+        return hr;
+    }
+}
+
+const ConstantBufferLayouts::Registration ClusteredLighting::kParamsLayout({ "cbClusters", CB_SLOT_CLUSTERS, sizeof(ClusterParams), {
+    CB_FIELD(ClusterParams, view, "ClusterView"),
+    CB_FIELD(ClusterParams, inverseView, "ClusterInverseView"),
+    CB_FIELD(ClusterParams, projection, "ClusterProjection"),
+    CB_FIELD(ClusterParams, slices, "ClusterSlices"),
+    CB_FIELD(ClusterParams, cameraPosition, "ClusterCamera"),
+    CB_FIELD(ClusterParams, screen, "ClusterScreen"),
+    CB_FIELD_RANGE(ClusterParams, lightCount, "ClusterInfo", 4 * sizeof(uint32_t)) } });
+
+HRESULT ClusteredLighting::init(Device& device) {
+    if (!device.m_device) {
+        ERROR("ClusteredLighting", "init", "Device is null.");
+        return E_POINTER;
+    }
+    destroy();
+
+    // UAV de buffers tipados en compute: nivel 11_0.
+    if (device.m_device->GetFeatureLevel() < D3D_FEATURE_LEVEL_11_0) {
+        MESSAGE("ClusteredLighting", "init", "Feature level < 11_0: clustered lighting disabled.");
+        return DXGI_ERROR_UNSUPPORTED;
+    }
+
+    D3D11_BUFFER_DESC paramsDesc = {};
+    paramsDesc.Usage = D3D11_USAGE_DEFAULT;
+    paramsDesc.ByteWidth = sizeof(ClusterParams);
+    paramsDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+    HRESULT hr = device.CreateBuffer(&paramsDesc, nullptr, &m_params);
+    if (SUCCEEDED(hr)) { hr = device.CreateBuffer(&paramsDesc, nullptr, &m_captureParams); }
+
+    D3D11_BUFFER_DESC lightDesc = {};
+    lightDesc.Usage = D3D11_USAGE_DYNAMIC;
+    lightDesc.ByteWidth = kMaxLights * sizeof(GpuLight);
+    lightDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+    lightDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+    lightDesc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+    lightDesc.StructureByteStride = sizeof(GpuLight);
+    if (SUCCEEDED(hr)) { hr = device.CreateBuffer(&lightDesc, nullptr, &m_lightBuffer); }
+
+    D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+    srvDesc.Format = DXGI_FORMAT_UNKNOWN;
+    srvDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+    srvDesc.Buffer.NumElements = kMaxLights;
+    if (SUCCEEDED(hr)) { hr = device.CreateShaderResourceView(m_lightBuffer, &srvDesc, &m_lightSRV); }
+
+    if (SUCCEEDED(hr)) {
+        hr = createIndexBuffer(device, kClusterCount, &m_countBuffer, &m_countSRV, &m_countUAV);
+    }
+    if (SUCCEEDED(hr)) {
+        hr = createIndexBuffer(device, kClusterCount * kMaxLightsPerCluster, &m_indexBuffer, &m_indexSRV, &m_indexUAV);
+    }
+    if (FAILED(hr)) {
+        ERROR("ClusteredLighting", "init", ("Failed to create the light buffers. hr=" + std::to_string(hr)).c_str());
+        destroy();
+        return hr;
+    }
+
+    ShaderKey key;
+    key.fileName = "LightCulling.fx";
+    key.entryPoint = "CSCull";
+    key.profile = "cs_5_0";
+    hr = device.getShaderLibrary().getComputeShader(device, key, &m_cullShader);
+    if (FAILED(hr)) {
+        destroy();
+        return hr;
+    }
+    m_upload.reserve(kMaxLights);
+    return S_OK;
+}
+
+unsigned int ClusteredLighting::addPointLight(const XMFLOAT3& position, float range, const XMFLOAT3& color,
+    float intensity) {
+    Light light;
+    light.type = Light::POINT;
+    light.position = position;
+    light.range = range;
+    light.color = color;
+    light.intensity = intensity;
+    m_lights.push_back(light);
+    return static_cast<unsigned int>(m_lights.size() - 1);
+}
+
+unsigned int ClusteredLighting::addSpotLight(const XMFLOAT3& position, const XMFLOAT3& direction, float range,
+    const XMFLOAT3& color, float intensity, float innerAngle, float outerAngle) {
+    Light light;
+    light.type = Light::SPOT;
+    light.position = position;
+    XMStoreFloat3(&light.direction, XMVector3Normalize(XMLoadFloat3(&direction)));
+    light.range = range;
+    light.color = color;
+    light.intensity = intensity;
+    light.innerAngle = (std::min)(innerAngle, outerAngle);
+    light.outerAngle = outerAngle;
+    m_lights.push_back(light);
+    return static_cast<unsigned int>(m_lights.size() - 1);
+}
+
+void ClusteredLighting::cull(DeviceContext& deviceContext, const XMMATRIX& view, const XMMATRIX& projection,
+    float nearZ, float farZ, unsigned int width, unsigned int height) {
+    if (!isReady()) {
+        return;
+    }
+
+    // Luces del frame, con el color ya multiplicado por la intensidad.
+    m_upload.clear();
+    if (m_enabled) {
+        const size_t count = (std::min)(m_renderLights.size(), static_cast<size_t>(kMaxLights));
+        for (size_t i = 0; i < count; ++i) {
+            const Light& light = m_renderLights[i];
+            GpuLight gpu;
+            gpu.position = light.position;
+            gpu.range = light.range;
+            gpu.color = XMFLOAT3(light.color.x * light.intensity, light.color.y * light.intensity,
+                light.color.z * light.intensity);
+            gpu.direction = light.direction;
+            gpu.spotCosOuter = light.type == Light::SPOT ? cosf(light.outerAngle) : -2.0f;
+            gpu.spotCosInner = light.type == Light::SPOT ? cosf(light.innerAngle) : -1.0f;
+            m_upload.push_back(gpu);
+        }
+    }
+    m_uploadedLights = static_cast<unsigned int>(m_upload.size());
+    if (!m_upload.empty()) {
+        D3D11_MAPPED_SUBRESOURCE mapped = {};
+        if (FAILED(deviceContext.Map(m_lightBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped))) {
+            m_uploadedLights = 0;
+        }
+        else {
+            memcpy(mapped.pData, m_upload.data(), m_upload.size() * sizeof(GpuLight));
+            deviceContext.Unmap(m_lightBuffer, 0);
+        }
+    }
+
+    XMFLOAT4X4 proj;
+    XMStoreFloat4x4(&proj, projection);
+    const XMMATRIX inverseView = XMMatrixInverse(nullptr, view);
+    XMFLOAT3 camera;
+    XMStoreFloat3(&camera, inverseView.r[3]);
+    const float sliceScale = kClusterZ / logf(farZ / nearZ);
+
+    ClusterParams& params = m_paramsData;
+    params.view = XMMatrixTranspose(view);
+    params.inverseView = XMMatrixTranspose(inverseView);
+    params.projection = XMFLOAT4(proj._11, proj._22, nearZ, farZ);
+    params.slices = XMFLOAT4(sliceScale, -logf(nearZ) * sliceScale, 0.0f, 0.0f);
+    params.cameraPosition = XMFLOAT4(camera.x, camera.y, camera.z, 1.0f);
+    params.screen = XMFLOAT4(static_cast<float>(width), static_cast<float>(height),
+        static_cast<float>((width + kClusterX - 1) / kClusterX), static_cast<float>((height + kClusterY - 1) / kClusterY));
+    params.lightCount = m_uploadedLights;
+    params.gbuffer = 0;
+    params.capture = 0;
+    params.pad = 0;
+    deviceContext.UpdateSubresource(m_params, 0, nullptr, &params, 0, 0);
+
+    // Sin luces los shaders no leen los clusters (`lightCount` = 0): nada que repartir.
+    if (m_uploadedLights == 0) {
+        return;
+    }
+
+    // Los buffers de clusters siguen enlazados al PS del frame anterior.
+    ID3D11ShaderResourceView* nullSRVs[3] = { nullptr, nullptr, nullptr };
+    deviceContext.PSSetShaderResources(kTextureSlot, 3, nullSRVs);
+
+    ID3D11UnorderedAccessView* uavs[2] = { m_countUAV, m_indexUAV };
+    deviceContext.CSSetShader(m_cullShader, nullptr, 0);
+    deviceContext.CSSetConstantBuffers(CB_SLOT_CLUSTERS, 1, &m_params);
+    deviceContext.CSSetShaderResources(kTextureSlot, 1, &m_lightSRV);
+    deviceContext.CSSetUnorderedAccessViews(0, 2, uavs, nullptr);
+    deviceContext.Dispatch(1, 1, kClusterZ);
+
+    ID3D11ShaderResourceView* nullSRV = nullptr;
+    ID3D11UnorderedAccessView* nullUAVs[2] = { nullptr, nullptr };
+    deviceContext.CSSetShaderResources(kTextureSlot, 1, &nullSRV);
+    deviceContext.CSSetUnorderedAccessViews(0, 2, nullUAVs, nullptr);
+    deviceContext.CSSetShader(nullptr, nullptr, 0);
+}
+
+void ClusteredLighting::bind(DeviceContext& deviceContext) {
+    if (!isReady()) {
+        return;
+    }
+    ID3D11ShaderResourceView* srvs[3] = { m_lightSRV, m_countSRV, m_indexSRV };
+    deviceContext.PSSetShaderResources(kTextureSlot, 3, srvs);
+    deviceContext.PSSetConstantBuffers(CB_SLOT_CLUSTERS, 1, &m_params);
+}
+
+void ClusteredLighting::bindCapture(DeviceContext& deviceContext, const XMFLOAT3& eye) {
+    if (!isReady()) {
+        return;
+    }
+    ClusterParams params = m_paramsData;
+    params.cameraPosition = XMFLOAT4(eye.x, eye.y, eye.z, 1.0f);
+    params.gbuffer = 0;
+    params.capture = 1;
+    deviceContext.UpdateSubresource(m_captureParams, 0, nullptr, &params, 0, 0);
+
+    ID3D11ShaderResourceView* srvs[3] = { m_lightSRV, m_countSRV, m_indexSRV };
+    deviceContext.PSSetShaderResources(kTextureSlot, 3, srvs);
+    deviceContext.PSSetConstantBuffers(CB_SLOT_CLUSTERS, 1, &m_captureParams);
+}
+
+void ClusteredLighting::setGBufferOutput(DeviceContext& deviceContext, bool enabled) {
+    if (!isReady() || (m_paramsData.gbuffer != 0) == enabled) {
+        return;
+    }
+    m_paramsData.gbuffer = enabled ? 1u : 0u;
+    deviceContext.UpdateSubresource(m_params, 0, nullptr, &m_paramsData, 0, 0);
+}
+
+void ClusteredLighting::destroy() {
+    SAFE_RELEASE(m_cullShader);
+    SAFE_RELEASE(m_params);
+    SAFE_RELEASE(m_captureParams);
+    SAFE_RELEASE(m_lightSRV);
+    SAFE_RELEASE(m_lightBuffer);
+    SAFE_RELEASE(m_countUAV);
+    SAFE_RELEASE(m_countSRV);
+    SAFE_RELEASE(m_countBuffer);
+    SAFE_RELEASE(m_indexUAV);
+    SAFE_RELEASE(m_indexSRV);
+    SAFE_RELEASE(m_indexBuffer);
+    m_uploadedLights = 0;
+    m_paramsData = {};
+}
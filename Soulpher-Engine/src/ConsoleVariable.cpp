@@ -0,0 +1,282 @@
+﻿/**
+ * @file ConsoleVariable.cpp
+ * @brief Conversión de las cvars a texto y registro: valores pendientes, archivos y consola.
+ */
+
+#include "ConsoleVariable.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+const char* const ConsoleVariables::kDefaultConfig = "Engine.cfg";
+
+namespace {
+    /// Quita espacios y tabuladores de los extremos.
+    std::string trim(const std::string& text) {
+        const size_t first = text.find_first_not_of(" \t\r\n");
+        if (first == std::string::npos) {
+            return std::string();
+        }
+        const size_t last = text.find_last_not_of(" \t\r\n");
+        return text.substr(first, last - first + 1);
+    }
+
+    /// Parte `nombre valor`, `nombre=valor` o `nombre = valor`. `value` vacío si solo hay nombre.
+    void splitAssignment(const std::string& line, std::string& name, std::string& value) {
+        const size_t separator = line.find_first_of(" \t=");
+        if (separator == std::string::npos) {
+            name = trim(line);
+            value.clear();
+            return;
+        }
+        name = trim(line.substr(0, separator));
+        value = trim(line.substr(separator + 1));
+        if (!value.empty() && value[0] == '=') {
+            value = trim(value.substr(1));
+        }
+    }
+
+    const char* typeName(ConsoleVariable::Type type) {
+        switch (type) {
+        case ConsoleVariable::CVAR_BOOL:  return "bool";
+        case ConsoleVariable::CVAR_INT:   return "int";
+        default:                          return "float";
+        }
+    }
+}
+
+//
+// Conversión a texto
+//
+
+template<>
+bool TConsoleVariable<bool>::setFromString(const char* text) {
+    if (strcmp(text, "1") == 0 || _stricmp(text, "true") == 0 || _stricmp(text, "on") == 0) {
+        set(true);
+        return true;
+    }
+    if (strcmp(text, "0") == 0 || _stricmp(text, "false") == 0 || _stricmp(text, "off") == 0) {
+        set(false);
+        return true;
+    }
+    return false;
+}
+
+template<>
+std::string TConsoleVariable<bool>::toString() const {
+    return get() ? "1" : "0";
+}
+
+template<>
+bool TConsoleVariable<int>::setFromString(const char* text) {
+    char* end = nullptr;
+    const long value = strtol(text, &end, 10);
+    if (end == text || *end != '\0') {
+        return false;
+    }
+    set(static_cast<int>(value));
+    return true;
+}
+
+template<>
+std::string TConsoleVariable<int>::toString() const {
+    return std::to_string(get());
+}
+
+template<>
+bool TConsoleVariable<float>::setFromString(const char* text) {
+    char* end = nullptr;
+    const float value = strtof(text, &end);
+    if (end == text || *end != '\0') {
+        return false;
+    }
+    set(value);
+    return true;
+}
+
+template<>
+std::string TConsoleVariable<float>::toString() const {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%g", get());
+    return buffer;
+}
+
+//
+// ConsoleVariable
+//
+
+ConsoleVariable::~ConsoleVariable() {
+    ConsoleVariables::getDefault().remove(this);
+}
+
+void ConsoleVariable::registerVariable() {
+    ConsoleVariables::getDefault().add(this);
+}
+
+//
+// ConsoleVariables
+//
+
+ConsoleVariables& ConsoleVariables::getDefault() {
+    // Estática local: existe antes que la primera cvar estática que la pide, de cualquier .cpp.
+    static ConsoleVariables registry;
+    return registry;
+}
+
+ConsoleVariable* ConsoleVariables::findVariable(const char* name) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ConsoleVariable** variable = m_variables.Find(name);
+    return variable ? *variable : nullptr;
+}
+
+void ConsoleVariables::add(ConsoleVariable* variable) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_variables.Find(variable->getName())) {
+        ERROR("ConsoleVariables", "add", ("Duplicate console variable " + std::string(variable->getName())).c_str());
+        return;
+    }
+    m_variables.Emplace(std::string(variable->getName()), variable);
+    if (std::string* pending = m_pending.Find(variable->getName())) {
+        if (!variable->setFromString(pending->c_str())) {
+            ERROR("ConsoleVariables", "add", ("Invalid value '" + *pending + "' for " + variable->getName()).c_str());
+        }
+        m_pending.Remove(std::string(variable->getName()));
+    }
+}
+
+void ConsoleVariables::remove(ConsoleVariable* variable) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ConsoleVariable** registered = m_variables.Find(variable->getName());
+    if (registered && *registered == variable) {
+        m_variables.Remove(std::string(variable->getName()));
+    }
+}
+
+HRESULT ConsoleVariables::set(const std::string& name, const std::string& value) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ConsoleVariable** variable = m_variables.Find(name);
+    if (!variable) {
+        m_pending.Emplace(name, value);
+        return S_FALSE;
+    }
+    return (*variable)->setFromString(value.c_str()) ? S_OK : E_INVALIDARG;
+}
+
+HRESULT ConsoleVariables::loadFile(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        return E_FAIL;
+    }
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        ++lineNumber;
+        const size_t comment = line.find('#');
+        if (comment != std::string::npos) {
+            line.erase(comment);
+        }
+        std::string name, value;
+        splitAssignment(line, name, value);
+        if (name.empty()) {
+            continue;
+        }
+        if (value.empty() || FAILED(set(name, value))) {
+            ERROR("ConsoleVariables", "loadFile",
+                (path + ":" + std::to_string(lineNumber) + ": invalid line '" + trim(line) + "'").c_str());
+        }
+    }
+    MESSAGE("ConsoleVariables", "loadFile", ("Loaded " + path).c_str());
+    return S_OK;
+}
+
+HRESULT ConsoleVariables::saveFile(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file) {
+        ERROR("ConsoleVariables", "saveFile", ("Cannot write " + path).c_str());
+        return E_FAIL;
+    }
+
+    std::vector<ConsoleVariable*> variables;
+    getSorted(variables);
+    for (const ConsoleVariable* variable : variables) {
+        if (variable->isModified()) {
+            file << variable->getName() << " " << variable->toString() << "\n";
+        }
+    }
+    return S_OK;
+}
+
+void ConsoleVariables::getSorted(std::vector<ConsoleVariable*>& out) const {
+    out.clear();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        out.reserve(m_variables.Num());
+        for (const auto& pair : m_variables) {
+            out.push_back(pair.Value);
+        }
+    }
+    std::sort(out.begin(), out.end(), [](const ConsoleVariable* a, const ConsoleVariable* b) {
+        return strcmp(a->getName(), b->getName()) < 0;
+    });
+}
+
+void ConsoleVariables::execute(const std::string& line, std::vector<std::string>& output) {
+    std::string command, argument;
+    splitAssignment(line, command, argument);
+    if (command.empty()) {
+        return;
+    }
+
+    if (command == "help") {
+        output.push_back("nombre            muestra el valor y la ayuda");
+        output.push_back("nombre valor      cambia el valor");
+        output.push_back("reset nombre      vuelve al valor por defecto");
+        output.push_back("list [prefijo]    lista las cvars");
+        output.push_back(std::string("save [archivo]    guarda las cambiadas (") + kDefaultConfig + ")");
+        return;
+    }
+
+    if (command == "list") {
+        std::vector<ConsoleVariable*> variables;
+        getSorted(variables);
+        for (const ConsoleVariable* variable : variables) {
+            if (strncmp(variable->getName(), argument.c_str(), argument.size()) == 0) {
+                output.push_back(std::string(variable->getName()) + " = " + variable->toString() +
+                    (variable->isModified() ? " *" : ""));
+            }
+        }
+        return;
+    }
+
+    if (command == "save") {
+        const std::string path = argument.empty() ? std::string(kDefaultConfig) : argument;
+        output.push_back(SUCCEEDED(saveFile(path)) ? "Guardado en " + path : "No se pudo escribir " + path);
+        return;
+    }
+
+    if (command == "reset") {
+        ConsoleVariable* variable = findVariable(argument.c_str());
+        if (!variable) {
+            output.push_back("No existe la cvar " + argument);
+            return;
+        }
+        variable->reset();
+        output.push_back(argument + " = " + variable->toString());
+        return;
+    }
+
+    ConsoleVariable* variable = findVariable(command.c_str());
+    if (!variable) {
+        output.push_back("No existe la cvar " + command + " (escribe help)");
+        return;
+    }
+    if (!argument.empty() && !variable->setFromString(argument.c_str())) {
+        output.push_back("'" + argument + "' no es un valor " + typeName(variable->getType()));
+        return;
+    }
+    output.push_back(command + " = " + variable->toString() + "    " + variable->getHelp());
+}
@@ -0,0 +1,139 @@
+﻿/**
+ * @file ConstantBufferLayout.cpp
+ * @brief Registro de layouts, los de `Prerequisites.h` y la validación por reflexión.
+ */
+
+#include "ConstantBufferLayout.h"
+#include "ShaderLibrary.h"
+#include <d3d11shader.h>
+
+namespace {
+    // Buffers compartidos de `Prerequisites.h` (mismos nombres en todos los .fx del motor).
+    const ConstantBufferLayouts::Registration kViewLayout({ "cbNeverChanges", CB_SLOT_VIEW,
+        sizeof(CBNeverChanges), { CB_FIELD(CBNeverChanges, mView, "View") } });
+    const ConstantBufferLayouts::Registration kProjectionLayout({ "cbChangeOnResize", CB_SLOT_PROJECTION,
+        sizeof(CBChangeOnResize), { CB_FIELD(CBChangeOnResize, mProjection, "Projection") } });
+    const ConstantBufferLayouts::Registration kObjectLayout({ "cbChangesEveryFrame", CB_SLOT_OBJECT,
+        sizeof(CBChangesEveryFrame), {
+            CB_FIELD(CBChangesEveryFrame, mWorld, "World"),
+            CB_FIELD(CBChangesEveryFrame, vMeshColor, "vMeshColor") } });
+    const ConstantBufferLayouts::Registration kShadowLayout({ "cbShadow", CB_SLOT_SHADOW,
+        sizeof(CBShadow), {
+            CB_FIELD(CBShadow, mLightViewProj, "LightViewProj"),
+            CB_FIELD(CBShadow, vCascadeSplits, "CascadeSplits"),
+            CB_FIELD(CBShadow, vShadowParams, "ShadowParams") } });
+    const ConstantBufferLayouts::Registration kMaterialLayout({ "cbMaterial", CB_SLOT_MATERIAL,
+        sizeof(CBMaterial), {
+            CB_FIELD(CBMaterial, vDiffuseColor, "vDiffuseColor"),
+            CB_FIELD(CBMaterial, vMaterialParams, "vMaterialParams") } });
+    const ConstantBufferLayouts::Registration kLightmapLayout({ "cbLightmap", CB_SLOT_LIGHTMAP,
+        sizeof(CBLightmap), { CB_FIELD(CBLightmap, vLightmapScaleOffset, "LightmapScaleOffset") } });
+}
+
+ConstantBufferLayouts& ConstantBufferLayouts::getDefault() {
+    static ConstantBufferLayouts layouts;
+    return layouts;
+}
+
+void ConstantBufferLayouts::add(const ConstantBufferLayout& layout) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (ConstantBufferLayout& existing : m_layouts) {
+        if (existing.name == layout.name) {
+            existing = layout;
+            return;
+        }
+    }
+    m_layouts.push_back(layout);
+}
+
+bool ConstantBufferLayouts::find(const std::string& name, ConstantBufferLayout& layout) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const ConstantBufferLayout& existing : m_layouts) {
+        if (existing.name == name) {
+            layout = existing;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @details Solo cuentan los `cbuffer` con registro asignado: uno que el shader declara
+ * pero no usa no llega a enlazarse y no puede leer nada mal. Se informan todas las
+ * diferencias de la variante, no solo la primera.
+ */
+HRESULT ConstantBufferLayouts::validate(const ShaderKey& key, ID3DBlob* bytecode) const {
+    if (!bytecode) {
+        ERROR("ConstantBufferLayouts", "validate", "bytecode is nullptr");
+        return E_POINTER;
+    }
+    ID3D11ShaderReflection* reflection = nullptr;
+    HRESULT hr = D3DReflect(bytecode->GetBufferPointer(), bytecode->GetBufferSize(),
+        IID_ID3D11ShaderReflection, reinterpret_cast<void**>(&reflection));
+    if (FAILED(hr)) {
+        ERROR("ConstantBufferLayouts", "validate", ("D3DReflect failed for " + key.toString() +
+            ". HRESULT: " + std::to_string(hr)).c_str());
+        return hr;
+    }
+
+    D3D11_SHADER_DESC shaderDesc = {};
+    reflection->GetDesc(&shaderDesc);
+    unsigned int mismatches = 0;
+    auto report = [&](const std::string& cbuffer, const std::string& text) {
+        ERROR("ConstantBufferLayouts", "validate", (key.toString() + ": " + cbuffer + ": " + text).c_str());
+        ++mismatches;
+    };
+
+    for (unsigned int i = 0; i < shaderDesc.ConstantBuffers; ++i) {
+        ID3D11ShaderReflectionConstantBuffer* cbuffer = reflection->GetConstantBufferByIndex(i);
+        D3D11_SHADER_BUFFER_DESC bufferDesc = {};
+        if (FAILED(cbuffer->GetDesc(&bufferDesc)) || bufferDesc.Type != D3D11_CT_CBUFFER) {
+            continue;
+        }
+        ConstantBufferLayout layout;
+        D3D11_SHADER_INPUT_BIND_DESC bindDesc = {};
+        if (!find(bufferDesc.Name, layout) ||
+            FAILED(reflection->GetResourceBindingDescByName(bufferDesc.Name, &bindDesc))) {
+            continue;
+        }
+
+        if (bindDesc.BindPoint != layout.slot) {
+            report(layout.name, "bound to b" + std::to_string(bindDesc.BindPoint) +
+                ", C++ expects b" + std::to_string(layout.slot));
+        }
+        const unsigned int expectedSize = (layout.size + 15) & ~15u;
+        if (bufferDesc.Size != expectedSize) {
+            report(layout.name, std::to_string(bufferDesc.Size) + " bytes in HLSL, " +
+                std::to_string(layout.size) + " in C++");
+        }
+
+        std::vector<bool> matched(layout.fields.size(), false);
+        for (unsigned int v = 0; v < bufferDesc.Variables; ++v) {
+            D3D11_SHADER_VARIABLE_DESC variableDesc = {};
+            cbuffer->GetVariableByIndex(v)->GetDesc(&variableDesc);
+            size_t field = 0;
+            while (field < layout.fields.size() && layout.fields[field].name != std::string(variableDesc.Name)) {
+                ++field;
+            }
+            if (field == layout.fields.size()) {
+                report(layout.name, std::string(variableDesc.Name) + " has no C++ field");
+                continue;
+            }
+            matched[field] = true;
+            const ConstantBufferField& expected = layout.fields[field];
+            if (variableDesc.StartOffset != expected.offset || variableDesc.Size != expected.size) {
+                report(layout.name, std::string(variableDesc.Name) + " at offset " +
+                    std::to_string(variableDesc.StartOffset) + " (" + std::to_string(variableDesc.Size) +
+                    " bytes) in HLSL, " + std::to_string(expected.offset) + " (" +
+                    std::to_string(expected.size) + " bytes) in C++");
+            }
+        }
+        for (size_t field = 0; field < layout.fields.size(); ++field) {
+            if (!matched[field]) {
+                report(layout.name, std::string(layout.fields[field].name) + " is missing in HLSL");
+            }
+        }
+    }
+    SAFE_RELEASE(reflection);
+    return mismatches == 0 ? S_OK : E_INVALIDARG;
+}
@@ -0,0 +1,71 @@
+﻿/**
+ * @file ConstantBufferRing.cpp
+ * @brief Implementación del anillo de constant buffers dinámicos.
+ */
+
+#include "ConstantBufferRing.h"
+#include "Device.h"
+#include "DeviceContext.h"
+
+HRESULT ConstantBufferRing::init(Device& device, unsigned int blockSize, unsigned int initialBlocks) {
+    if (!device.m_device) {
+        ERROR("ConstantBufferRing", "init", "Device is null.");
+        return E_POINTER;
+    }
+    if (blockSize == 0 || (blockSize % 16) != 0) {
+        ERROR("ConstantBufferRing", "init", "blockSize must be a non-zero multiple of 16");
+        return E_INVALIDARG;
+    }
+
+    m_device = &device;
+    m_blockSize = blockSize;
+    m_cursor = 0;
+    for (unsigned int i = 0; i < initialBlocks; ++i) {
+        HRESULT hr = addBlock();
+        if (FAILED(hr)) {
+            return hr;
+        }
+    }
+    return S_OK;
+}
+
+void ConstantBufferRing::update() {
+    m_cursor = 0;
+}
+
+Buffer* ConstantBufferRing::allocate(DeviceContext& deviceContext, const void* data, unsigned int bytes) {
+    if (!m_device || bytes > m_blockSize) {
+        ERROR("ConstantBufferRing", "allocate", "Ring not initialized or allocation larger than a block");
+        return nullptr;
+    }
+    if (m_cursor == m_blocks.size() && FAILED(addBlock())) {
+        return nullptr;
+    }
+
+    Buffer& block = m_blocks[m_cursor];
+    if (FAILED(block.write(deviceContext, data, bytes))) {
+        return nullptr;
+    }
+    ++m_cursor;
+    return &block;
+}
+
+void ConstantBufferRing::destroy() {
+    for (auto& block : m_blocks) {
+        block.destroy();
+    }
+    m_blocks.clear();
+    m_cursor = 0;
+    m_device = nullptr;
+}
+
+HRESULT ConstantBufferRing::addBlock() {
+    Buffer block;
+    HRESULT hr = block.initDynamic(*m_device, m_blockSize, m_blockSize, D3D11_BIND_CONSTANT_BUFFER);
+    if (FAILED(hr)) {
+        ERROR("ConstantBufferRing", "addBlock", ("Failed to create block. HRESULT: " + std::to_string(hr)).c_str());
+        return hr;
+    }
+    m_blocks.push_back(block);
+    return S_OK;
+}
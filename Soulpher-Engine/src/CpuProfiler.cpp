@@ -0,0 +1,127 @@
+﻿/**
+ * @file CpuProfiler.cpp
+ * @brief Implementación del registro de zonas de CPU por hilo.
+ */
+
+#include "CpuProfiler.h"
+
+namespace {
+    thread_local void* t_buffer = nullptr; // ThreadBuffer del hilo actual.
+
+    LONGLONG now() {
+        LARGE_INTEGER counter;
+        QueryPerformanceCounter(&counter);
+        return counter.QuadPart;
+    }
+}
+
+CpuProfiler::Zone::Zone(const char* name)
+    : m_name(name) {
+    ++CpuProfiler::instance().threadBuffer().depth;
+    m_begin = now();
+}
+
+CpuProfiler::Zone::~Zone() {
+    const LONGLONG end = now();
+    ThreadBuffer& buffer = CpuProfiler::instance().threadBuffer();
+    --buffer.depth;
+
+    // Escribir la ranura y después publicar el índice: quien lea con acquire ve el evento entero.
+    const unsigned long long index = buffer.writeIndex.load(std::memory_order_relaxed);
+    Event& event = buffer.events[index % kEventCapacity];
+    event.name = m_name;
+    event.begin = m_begin;
+    event.end = end;
+    event.depth = buffer.depth;
+    buffer.writeIndex.store(index + 1, std::memory_order_release);
+}
+
+CpuProfiler::CpuProfiler() {
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    m_msPerTick = 1000.0 / static_cast<double>(frequency.QuadPart);
+    m_frameBegin = now();
+}
+
+CpuProfiler& CpuProfiler::instance() {
+    static CpuProfiler profiler;
+    return profiler;
+}
+
+CpuProfiler::ThreadBuffer& CpuProfiler::threadBuffer() {
+    if (!t_buffer) {
+        std::unique_ptr<ThreadBuffer> buffer(new ThreadBuffer());
+        buffer->threadId = GetCurrentThreadId();
+        t_buffer = buffer.get();
+        std::lock_guard<std::mutex> lock(m_threadsMutex);
+        m_threads.push_back(std::move(buffer));
+    }
+    return *static_cast<ThreadBuffer*>(t_buffer);
+}
+
+void CpuProfiler::beginFrame() {
+    const LONGLONG begin = now();
+    Frame& frame = m_frames[m_frameWrite % kFrameHistory];
+    frame.begin = m_frameBegin;
+    frame.end = begin;
+    ++m_frameWrite;
+    m_frameBegin = begin;
+}
+
+void CpuProfiler::setThreadName(const char* name) {
+    threadBuffer().name = name;
+}
+
+unsigned int CpuProfiler::getFrameCount() const {
+    return (std::min)(m_frameWrite, kFrameHistory);
+}
+
+CpuProfiler::Frame CpuProfiler::getFrame(unsigned int back) const {
+    if (back >= getFrameCount()) {
+        Frame empty = { 0, 0 };
+        return empty;
+    }
+    return m_frames[(m_frameWrite - 1 - back) % kFrameHistory];
+}
+
+unsigned int CpuProfiler::collect(LONGLONG from, LONGLONG to, std::vector<ThreadEvent>& out) const {
+    out.clear();
+    std::lock_guard<std::mutex> lock(m_threadsMutex);
+    for (unsigned int t = 0; t < m_threads.size(); ++t) {
+        const ThreadBuffer& buffer = *m_threads[t];
+        const unsigned long long written = buffer.writeIndex.load(std::memory_order_acquire);
+        const unsigned long long first = (written > kEventCapacity) ? written - kEventCapacity : 0;
+        const size_t start = out.size();
+        std::vector<unsigned long long> slots;
+        for (unsigned long long i = first; i < written; ++i) {
+            const Event& event = buffer.events[i % kEventCapacity];
+            if (event.begin >= from && event.begin < to) {
+                ThreadEvent entry = { event, t };
+                out.push_back(entry);
+                slots.push_back(i);
+            }
+        }
+
+        // Si el hilo siguió escribiendo mientras se copiaba, descartar las ranuras que
+        // pudo haber sobrescrito, más la que puede estar escribiendo ahora mismo
+        // (sin locks: se valida después de leer).
+        const unsigned long long after = buffer.writeIndex.load(std::memory_order_acquire);
+        if (after + 1 > kEventCapacity) {
+            const unsigned long long oldestValid = after + 1 - kEventCapacity;
+            size_t stale = 0;
+            while (stale < slots.size() && slots[stale] < oldestValid) {
+                ++stale;
+            }
+            out.erase(out.begin() + start, out.begin() + start + stale);
+        }
+    }
+    return static_cast<unsigned int>(m_threads.size());
+}
+
+std::string CpuProfiler::getThreadName(unsigned int thread) const {
+    std::lock_guard<std::mutex> lock(m_threadsMutex);
+    if (thread < m_threads.size() && m_threads[thread]->name) {
+        return m_threads[thread]->name;
+    }
+    return "Thread " + std::to_string(thread);
+}
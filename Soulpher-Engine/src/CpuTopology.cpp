@@ -0,0 +1,143 @@
+﻿/**
+ * @file CpuTopology.cpp
+ * @brief Detección de núcleos con `GetLogicalProcessorInformationEx` y afinidad por tipo de hilo.
+ */
+
+#include "CpuTopology.h"
+#include <algorithm>
+#include <thread>
+
+namespace {
+    unsigned int countBits(KAFFINITY mask) {
+        unsigned int count = 0;
+        for (; mask != 0; mask &= mask - 1) {
+            ++count;
+        }
+        return count;
+    }
+
+    const char* getRoleName(CpuTopology::ThreadRole role) {
+        switch (role) {
+        case CpuTopology::THREAD_ROLE_MAIN: return "main";
+        case CpuTopology::THREAD_ROLE_RENDER: return "render";
+        case CpuTopology::THREAD_ROLE_WORKER: return "worker";
+        default: return "background";
+        }
+    }
+}
+
+CpuTopology& CpuTopology::getDefault() {
+    static CpuTopology s_topology;
+    return s_topology;
+}
+
+CpuTopology::CpuTopology() {
+    if (!detect()) {
+        // Sin la información del sistema: un núcleo por procesador lógico, todos iguales.
+        m_cores.clear();
+        const unsigned int logical = (std::max)(std::thread::hardware_concurrency(), 1u);
+        for (unsigned int i = 0; i < logical; ++i) {
+            Core core;
+            core.mask = i < 64 ? KAFFINITY(1) << i : 0;
+            core.logicalCount = 1;
+            m_cores.push_back(core);
+        }
+        m_logicalCount = logical;
+        m_performanceCount = logical;
+        MESSAGE("CpuTopology", "detect", ("No processor information; assuming " +
+            std::to_string(logical) + " cores").c_str());
+        return;
+    }
+    MESSAGE("CpuTopology", "detect", (std::to_string(getPhysicalCount()) + " cores (" +
+        std::to_string(m_performanceCount) + " performance, " + std::to_string(getEfficiencyCount()) +
+        " efficiency), " + std::to_string(m_logicalCount) + " logical processors").c_str());
+}
+
+bool CpuTopology::detect() {
+    DWORD size = 0;
+    if (GetLogicalProcessorInformationEx(RelationProcessorCore, nullptr, &size) ||
+        GetLastError() != ERROR_INSUFFICIENT_BUFFER || size == 0) {
+        return false;
+    }
+    std::vector<unsigned char> buffer(size);
+    SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX* info =
+        reinterpret_cast<SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(buffer.data());
+    if (!GetLogicalProcessorInformationEx(RelationProcessorCore, info, &size)) {
+        return false;
+    }
+
+    // Registros de tamaño variable: cada uno dice dónde empieza el siguiente.
+    BYTE bestClass = 0;
+    m_logicalCount = 0;
+    for (DWORD offset = 0; offset + sizeof(LOGICAL_PROCESSOR_RELATIONSHIP) + sizeof(DWORD) <= size;) {
+        const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX* entry =
+            reinterpret_cast<const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(buffer.data() + offset);
+        if (entry->Size == 0 || offset + entry->Size > size) {
+            break;
+        }
+        if (entry->Relationship == RelationProcessorCore && entry->Processor.GroupCount > 0) {
+            // Un núcleo nunca cruza grupos: basta la primera máscara.
+            Core core;
+            core.group = entry->Processor.GroupMask[0].Group;
+            core.mask = entry->Processor.GroupMask[0].Mask;
+            core.efficiencyClass = entry->Processor.EfficiencyClass;
+            core.logicalCount = countBits(core.mask);
+            bestClass = (std::max)(bestClass, core.efficiencyClass);
+            m_logicalCount += core.logicalCount;
+            m_cores.push_back(core);
+        }
+        offset += entry->Size;
+    }
+    if (m_cores.empty()) {
+        return false;
+    }
+    // Sin CPU híbrida todos los núcleos tienen la clase 0 y quedan como de rendimiento.
+    m_performanceCount = 0;
+    for (Core& core : m_cores) {
+        core.performance = core.efficiencyClass == bestClass;
+        m_performanceCount += core.performance ? 1 : 0;
+    }
+    return true;
+}
+
+unsigned int CpuTopology::getWorkerCount(bool physical) const {
+    const unsigned int threads = physical ? getPhysicalCount() : m_logicalCount;
+    return threads > 1 ? threads - 1 : 0;
+}
+
+KAFFINITY CpuTopology::getMask(WORD group, bool performance) const {
+    KAFFINITY mask = 0;
+    for (const Core& core : m_cores) {
+        if (core.group == group && core.performance == performance) {
+            mask |= core.mask;
+        }
+    }
+    return mask;
+}
+
+void CpuTopology::applyToCurrentThread(ThreadRole role) const {
+    HANDLE thread = GetCurrentThread();
+    const bool critical = role == THREAD_ROLE_MAIN || role == THREAD_ROLE_RENDER;
+    const bool background = role == THREAD_ROLE_BACKGROUND;
+
+    if (isHybrid() && ((critical && m_policy.pinPerformance) || (background && m_policy.backgroundEfficiency))) {
+        GROUP_AFFINITY current = {};
+        if (GetThreadGroupAffinity(thread, &current)) {
+            // Se queda en su grupo: solo cambia qué núcleos de él puede usar.
+            GROUP_AFFINITY affinity = {};
+            affinity.Group = current.Group;
+            affinity.Mask = getMask(current.Group, critical);
+            if (affinity.Mask != 0 && !SetThreadGroupAffinity(thread, &affinity, nullptr)) {
+                LOG_WARNING("CpuTopology", "Cannot set the affinity of a " << getRoleName(role) <<
+                    " thread (error " << GetLastError() << ")");
+            }
+        }
+    }
+    if (m_policy.priorities && role != THREAD_ROLE_WORKER) {
+        const int priority = critical ? THREAD_PRIORITY_ABOVE_NORMAL : THREAD_PRIORITY_BELOW_NORMAL;
+        if (!SetThreadPriority(thread, priority)) {
+            LOG_WARNING("CpuTopology", "Cannot set the priority of a " << getRoleName(role) <<
+                " thread (error " << GetLastError() << ")");
+        }
+    }
+}
@@ -0,0 +1,123 @@
+﻿/**
+ * @file CullingSystem.cpp
+ * @brief Kernels escalar y SSE de culling de esferas.
+ */
+
+#include "CullingSystem.h"
+#include "Frustum.h"
+#include <xmmintrin.h>
+#include <chrono>
+
+void CullingSystem::reserve(unsigned int count) {
+    m_centerX.reserve(count);
+    m_centerY.reserve(count);
+    m_centerZ.reserve(count);
+    m_radius.reserve(count);
+}
+
+void CullingSystem::clear() {
+    m_centerX.clear();
+    m_centerY.clear();
+    m_centerZ.clear();
+    m_radius.clear();
+}
+
+unsigned int CullingSystem::add(const XMFLOAT3& center, float radius) {
+    m_centerX.push_back(center.x);
+    m_centerY.push_back(center.y);
+    m_centerZ.push_back(center.z);
+    m_radius.push_back(radius);
+    return static_cast<unsigned int>(m_radius.size() - 1);
+}
+
+void CullingSystem::cull(const Frustum& frustum, std::vector<unsigned int>& outVisible) const {
+    outVisible.clear();
+    const unsigned int count = getCount();
+    const unsigned int simdCount = count & ~3u;
+
+    // Cada componente de cada plano repetido en los 4 carriles.
+    __m128 px[FRUSTUM_PLANE_COUNT], py[FRUSTUM_PLANE_COUNT];
+    __m128 pz[FRUSTUM_PLANE_COUNT], pw[FRUSTUM_PLANE_COUNT];
+    for (unsigned int p = 0; p < FRUSTUM_PLANE_COUNT; ++p) {
+        const XMFLOAT4& plane = frustum.getPlane(p);
+        px[p] = _mm_set1_ps(plane.x);
+        py[p] = _mm_set1_ps(plane.y);
+        pz[p] = _mm_set1_ps(plane.z);
+        pw[p] = _mm_set1_ps(plane.w);
+    }
+    const __m128 zero = _mm_setzero_ps();
+
+    for (unsigned int i = 0; i < simdCount; i += 4) {
+        const __m128 cx = _mm_loadu_ps(&m_centerX[i]);
+        const __m128 cy = _mm_loadu_ps(&m_centerY[i]);
+        const __m128 cz = _mm_loadu_ps(&m_centerZ[i]);
+        const __m128 negR = _mm_sub_ps(zero, _mm_loadu_ps(&m_radius[i]));
+
+        __m128 visible = _mm_cmpeq_ps(zero, zero); // todos los bits a 1
+        for (unsigned int p = 0; p < FRUSTUM_PLANE_COUNT; ++p) {
+            __m128 d = _mm_mul_ps(px[p], cx);
+            d = _mm_add_ps(d, _mm_mul_ps(py[p], cy));
+            d = _mm_add_ps(d, _mm_mul_ps(pz[p], cz));
+            d = _mm_add_ps(d, pw[p]);
+            visible = _mm_and_ps(visible, _mm_cmpge_ps(d, negR));
+        }
+
+        // Compactar: un bit por carril visible.
+        const int mask = _mm_movemask_ps(visible);
+        for (unsigned int lane = 0; lane < 4; ++lane) {
+            if (mask & (1 << lane)) {
+                outVisible.push_back(i + lane);
+            }
+        }
+    }
+
+    // Resto (< 4 esferas) con la prueba escalar.
+    for (unsigned int i = simdCount; i < count; ++i) {
+        XMFLOAT3 center(m_centerX[i], m_centerY[i], m_centerZ[i]);
+        if (frustum.intersectsSphere(center, m_radius[i])) {
+            outVisible.push_back(i);
+        }
+    }
+}
+
+void CullingSystem::cullScalar(const Frustum& frustum, std::vector<unsigned int>& outVisible) const {
+    outVisible.clear();
+    const unsigned int count = getCount();
+    for (unsigned int i = 0; i < count; ++i) {
+        XMFLOAT3 center(m_centerX[i], m_centerY[i], m_centerZ[i]);
+        if (frustum.intersectsSphere(center, m_radius[i])) {
+            outVisible.push_back(i);
+        }
+    }
+}
+
+CullingBenchmark CullingSystem::benchmark(const Frustum& frustum, unsigned int iterations) const {
+    typedef std::chrono::high_resolution_clock Clock;
+
+    CullingBenchmark result;
+    result.objectCount = getCount();
+    result.iterations = iterations > 0 ? iterations : 1;
+
+    std::vector<unsigned int> visible;
+    visible.reserve(result.objectCount);
+
+    Clock::time_point start = Clock::now();
+    for (unsigned int it = 0; it < result.iterations; ++it) {
+        cullScalar(frustum, visible);
+    }
+    result.scalarMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / result.iterations;
+    result.visibleScalar = static_cast<unsigned int>(visible.size());
+
+    start = Clock::now();
+    for (unsigned int it = 0; it < result.iterations; ++it) {
+        cull(frustum, visible);
+    }
+    result.simdMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / result.iterations;
+    result.visibleSimd = static_cast<unsigned int>(visible.size());
+
+    std::ostringstream os;
+    os << result.objectCount << " spheres: scalar " << result.scalarMs << " ms, SSE "
+       << result.simdMs << " ms, visible " << result.visibleScalar << "/" << result.visibleSimd;
+    MESSAGE("CullingSystem", "benchmark", os.str().c_str());
+    return result;
+}
@@ -0,0 +1,367 @@
+﻿/**
+ * @file DdsFile.cpp
+ * @brief Lector DDS sobre un archivo mapeado y escritura de la caché de texturas BCn.
+ */
+
+#include "DdsFile.h"
+#include "VirtualFileSystem.h"
+#include "GpuMemory.h"
+#include <cstdio>
+#include <cstring>
+
+namespace {
+    const unsigned int kMagic = 0x20534444;        // "DDS "
+    const unsigned int kFourCCDX10 = 0x30315844;   // "DX10"
+    const unsigned int kEngineTag = 0x4C554F53;    // "SOUL" (en reserved1, como hacen otras herramientas)
+    const unsigned int kHeaderDwords = 31;         // DDS_HEADER: 124 bytes
+    const unsigned int kDX10Dwords = 5;            // DDS_HEADER_DXT10: 20 bytes
+
+    // Índices dentro de DDS_HEADER.
+    enum {
+        HEADER_SIZE = 0, HEADER_FLAGS = 1, HEADER_HEIGHT = 2, HEADER_WIDTH = 3,
+        HEADER_LINEAR_SIZE = 4, HEADER_MIP_COUNT = 6, HEADER_RESERVED = 7,
+        HEADER_PF_SIZE = 18, HEADER_PF_FLAGS = 19, HEADER_PF_FOURCC = 20, HEADER_PF_BITS = 21,
+        HEADER_PF_RMASK = 22, HEADER_PF_GMASK = 23, HEADER_PF_BMASK = 24, HEADER_PF_AMASK = 25,
+        HEADER_CAPS = 26, HEADER_CAPS2 = 27
+    };
+
+    const unsigned int kFlagMipCount = 0x20000;    // DDSD_MIPMAPCOUNT
+    const unsigned int kPixelAlpha = 0x1;          // DDPF_ALPHAPIXELS
+    const unsigned int kPixelFourCC = 0x4;         // DDPF_FOURCC
+    const unsigned int kPixelRGB = 0x40;           // DDPF_RGB
+    const unsigned int kPixelLuminance = 0x20000;  // DDPF_LUMINANCE
+    const unsigned int kCaps2Cubemap = 0x200;      // DDSCAPS2_CUBEMAP
+    const unsigned int kCaps2AllFaces = 0xFC00;    // DDSCAPS2_CUBEMAP_POSITIVEX ... NEGATIVEZ
+    const unsigned int kCaps2Volume = 0x200000;    // DDSCAPS2_VOLUME
+    const unsigned int kMiscCube = 0x4;            // D3D11_RESOURCE_MISC_TEXTURECUBE (DX10)
+
+    unsigned int fourCC(char a, char b, char c, char d) {
+        return static_cast<unsigned int>(a) | (static_cast<unsigned int>(b) << 8) |
+            (static_cast<unsigned int>(c) << 16) | (static_cast<unsigned int>(d) << 24);
+    }
+
+    /// Bytes por bloque de 4x4 (formatos BCn) o 0 si no es comprimido.
+    unsigned int getBlockBytes(DXGI_FORMAT format) {
+        switch (format) {
+        case DXGI_FORMAT_BC1_TYPELESS: case DXGI_FORMAT_BC1_UNORM: case DXGI_FORMAT_BC1_UNORM_SRGB:
+        case DXGI_FORMAT_BC4_TYPELESS: case DXGI_FORMAT_BC4_UNORM: case DXGI_FORMAT_BC4_SNORM:
+            return 8;
+        case DXGI_FORMAT_BC2_TYPELESS: case DXGI_FORMAT_BC2_UNORM: case DXGI_FORMAT_BC2_UNORM_SRGB:
+        case DXGI_FORMAT_BC3_TYPELESS: case DXGI_FORMAT_BC3_UNORM: case DXGI_FORMAT_BC3_UNORM_SRGB:
+        case DXGI_FORMAT_BC5_TYPELESS: case DXGI_FORMAT_BC5_UNORM: case DXGI_FORMAT_BC5_SNORM:
+        case DXGI_FORMAT_BC6H_TYPELESS: case DXGI_FORMAT_BC6H_UF16: case DXGI_FORMAT_BC6H_SF16:
+        case DXGI_FORMAT_BC7_TYPELESS: case DXGI_FORMAT_BC7_UNORM: case DXGI_FORMAT_BC7_UNORM_SRGB:
+            return 16;
+        default:
+            return 0;
+        }
+    }
+
+    /// Bits por texel de los formatos sin comprimir admitidos (0 = no admitido).
+    unsigned int getBitsPerPixel(DXGI_FORMAT format) {
+        switch (format) {
+        case DXGI_FORMAT_R32G32B32A32_FLOAT:
+            return 128;
+        case DXGI_FORMAT_R32G32B32_FLOAT:
+            return 96;
+        case DXGI_FORMAT_R16G16B16A16_FLOAT: case DXGI_FORMAT_R16G16B16A16_UNORM:
+        case DXGI_FORMAT_R32G32_FLOAT:
+            return 64;
+        case DXGI_FORMAT_R8G8B8A8_UNORM: case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+        case DXGI_FORMAT_B8G8R8A8_UNORM: case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+        case DXGI_FORMAT_B8G8R8X8_UNORM: case DXGI_FORMAT_R10G10B10A2_UNORM:
+        case DXGI_FORMAT_R11G11B10_FLOAT: case DXGI_FORMAT_R16G16_FLOAT:
+        case DXGI_FORMAT_R16G16_UNORM: case DXGI_FORMAT_R32_FLOAT:
+            return 32;
+        case DXGI_FORMAT_R8G8_UNORM: case DXGI_FORMAT_R16_FLOAT: case DXGI_FORMAT_R16_UNORM:
+        case DXGI_FORMAT_B5G6R5_UNORM: case DXGI_FORMAT_B5G5R5A1_UNORM:
+            return 16;
+        case DXGI_FORMAT_R8_UNORM: case DXGI_FORMAT_A8_UNORM:
+            return 8;
+        default:
+            return 0;
+        }
+    }
+
+    /// Formato DXGI de una cabecera clásica (sin extensión DX10).
+    DXGI_FORMAT getLegacyFormat(const unsigned int* header) {
+        const unsigned int flags = header[HEADER_PF_FLAGS];
+        if (flags & kPixelFourCC) {
+            const unsigned int code = header[HEADER_PF_FOURCC];
+            if (code == fourCC('D', 'X', 'T', '1')) return DXGI_FORMAT_BC1_UNORM;
+            if (code == fourCC('D', 'X', 'T', '2') || code == fourCC('D', 'X', 'T', '3')) return DXGI_FORMAT_BC2_UNORM;
+            if (code == fourCC('D', 'X', 'T', '4') || code == fourCC('D', 'X', 'T', '5')) return DXGI_FORMAT_BC3_UNORM;
+            if (code == fourCC('A', 'T', 'I', '1') || code == fourCC('B', 'C', '4', 'U')) return DXGI_FORMAT_BC4_UNORM;
+            if (code == fourCC('B', 'C', '4', 'S')) return DXGI_FORMAT_BC4_SNORM;
+            if (code == fourCC('A', 'T', 'I', '2') || code == fourCC('B', 'C', '5', 'U')) return DXGI_FORMAT_BC5_UNORM;
+            if (code == fourCC('B', 'C', '5', 'S')) return DXGI_FORMAT_BC5_SNORM;
+            // Códigos numéricos de D3DFORMAT.
+            switch (code) {
+            case 36:  return DXGI_FORMAT_R16G16B16A16_UNORM;
+            case 111: return DXGI_FORMAT_R16_FLOAT;
+            case 112: return DXGI_FORMAT_R16G16_FLOAT;
+            case 113: return DXGI_FORMAT_R16G16B16A16_FLOAT;
+            case 114: return DXGI_FORMAT_R32_FLOAT;
+            case 115: return DXGI_FORMAT_R32G32_FLOAT;
+            case 116: return DXGI_FORMAT_R32G32B32A32_FLOAT;
+            default:  return DXGI_FORMAT_UNKNOWN;
+            }
+        }
+
+        const unsigned int bits = header[HEADER_PF_BITS];
+        const unsigned int r = header[HEADER_PF_RMASK], g = header[HEADER_PF_GMASK], b = header[HEADER_PF_BMASK];
+        const unsigned int a = (flags & kPixelAlpha) ? header[HEADER_PF_AMASK] : 0;
+        if ((flags & kPixelRGB) && bits == 32) {
+            if (r == 0x000000FF && g == 0x0000FF00 && b == 0x00FF0000) return DXGI_FORMAT_R8G8B8A8_UNORM;
+            if (r == 0x00FF0000 && g == 0x0000FF00 && b == 0x000000FF) {
+                return a ? DXGI_FORMAT_B8G8R8A8_UNORM : DXGI_FORMAT_B8G8R8X8_UNORM;
+            }
+        }
+        if ((flags & kPixelRGB) && bits == 16 && r == 0xF800 && g == 0x07E0 && b == 0x001F) {
+            return DXGI_FORMAT_B5G6R5_UNORM;
+        }
+        if ((flags & kPixelLuminance) && bits == 8) {
+            return DXGI_FORMAT_R8_UNORM;
+        }
+        return DXGI_FORMAT_UNKNOWN;
+    }
+
+    bool getWriteTime(const std::string& path, ULARGE_INTEGER& time) {
+        WIN32_FILE_ATTRIBUTE_DATA data;
+        if (!GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &data)) {
+            return false;
+        }
+        time.LowPart = data.ftLastWriteTime.dwLowDateTime;
+        time.HighPart = data.ftLastWriteTime.dwHighDateTime;
+        return true;
+    }
+}
+
+HRESULT DdsFile::load(ID3D11Device* device, const std::string& path,
+    ID3D11ShaderResourceView** srv, bool engineCacheOnly, unsigned int maxSize, Info* info) {
+    *srv = nullptr;
+    FileView mapped;
+    const size_t headerBytes = 4 + kHeaderDwords * 4;
+    if (!VirtualFileSystem::getDefault().open(path, mapped) || mapped.getSize() < headerBytes) {
+        return E_FAIL;
+    }
+
+    unsigned int magic = 0;
+    unsigned int header[kHeaderDwords];
+    memcpy(&magic, mapped.getData(), 4);
+    memcpy(header, mapped.getData() + 4, sizeof(header));
+    if (magic != kMagic || header[HEADER_SIZE] != kHeaderDwords * 4) {
+        ERROR("DdsFile", "load", ("Not a DDS file: " + path).c_str());
+        return E_INVALIDARG;
+    }
+    if (engineCacheOnly &&
+        (header[HEADER_RESERVED] != kEngineTag || header[HEADER_RESERVED + 1] != kEncoderVersion)) {
+        return E_FAIL;
+    }
+
+    // Formato, caras y elementos del array.
+    DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+    unsigned int arraySize = 1;
+    bool cube = false;
+    size_t dataOffset = headerBytes;
+    if ((header[HEADER_PF_FLAGS] & kPixelFourCC) && header[HEADER_PF_FOURCC] == kFourCCDX10) {
+        unsigned int dx10[kDX10Dwords];
+        if (mapped.getSize() < headerBytes + sizeof(dx10)) {
+            return E_FAIL;
+        }
+        memcpy(dx10, mapped.getData() + headerBytes, sizeof(dx10));
+        dataOffset += sizeof(dx10);
+        format = static_cast<DXGI_FORMAT>(dx10[0]);
+        if (dx10[1] != D3D11_RESOURCE_DIMENSION_TEXTURE2D) {
+            ERROR("DdsFile", "load", ("Only 2D textures are supported: " + path).c_str());
+            return E_INVALIDARG;
+        }
+        cube = (dx10[2] & kMiscCube) != 0;
+        arraySize = (std::max)(dx10[3], 1u);
+    }
+    else {
+        format = getLegacyFormat(header);
+        if (header[HEADER_CAPS2] & kCaps2Volume) {
+            ERROR("DdsFile", "load", ("Volume textures are not supported: " + path).c_str());
+            return E_INVALIDARG;
+        }
+        if (header[HEADER_CAPS2] & kCaps2Cubemap) {
+            if ((header[HEADER_CAPS2] & kCaps2AllFaces) != kCaps2AllFaces) {
+                ERROR("DdsFile", "load", ("Partial cubemaps are not supported: " + path).c_str());
+                return E_INVALIDARG;
+            }
+            cube = true;
+        }
+    }
+    const unsigned int blockBytes = getBlockBytes(format);
+    const unsigned int bitsPerPixel = getBitsPerPixel(format);
+    if (blockBytes == 0 && bitsPerPixel == 0) {
+        ERROR("DdsFile", "load", ("Unsupported DDS pixel format: " + path).c_str());
+        return E_INVALIDARG;
+    }
+
+    const unsigned int width = header[HEADER_WIDTH];
+    const unsigned int height = header[HEADER_HEIGHT];
+    const unsigned int mipCount = (header[HEADER_FLAGS] & kFlagMipCount) ? (std::max)(header[HEADER_MIP_COUNT], 1u) : 1u;
+    const unsigned int items = arraySize * (cube ? 6 : 1);
+    if (width == 0 || height == 0 || mipCount > D3D11_REQ_MIP_LEVELS || items > D3D11_REQ_TEXTURE2D_ARRAY_AXIS_DIMENSION) {
+        ERROR("DdsFile", "load", ("Invalid DDS dimensions: " + path).c_str());
+        return E_INVALIDARG;
+    }
+
+    // Mips omitidos: el que queda como mip 0 de un BCn tiene que ser múltiplo de 4.
+    unsigned int skip = 0;
+    while (maxSize && skip + 1 < mipCount && ((std::max)(width, height) >> skip) > maxSize) {
+        ++skip;
+    }
+    while (skip > 0 && blockBytes &&
+        (((std::max)(width >> skip, 1u) % 4) != 0 || ((std::max)(height >> skip, 1u) % 4) != 0)) {
+        --skip;
+    }
+    const unsigned int residentMips = mipCount - skip;
+
+    // Subrecursos en el orden del archivo (elemento → mip), que es el de D3D11:
+    // apuntan a la vista mapeada, sin copiar. Los mips omitidos solo se saltan.
+    std::vector<D3D11_SUBRESOURCE_DATA> subresources(static_cast<size_t>(items) * residentMips);
+    size_t offset = dataOffset;
+    size_t residentBytes = 0;
+    for (unsigned int item = 0; item < items; ++item) {
+        for (unsigned int mip = 0, w = width, h = height; mip < mipCount; ++mip) {
+            const unsigned int pitch = blockBytes ? ((w + 3) / 4) * blockBytes : (w * bitsPerPixel + 7) / 8;
+            const size_t bytes = static_cast<size_t>(pitch) * (blockBytes ? (h + 3) / 4 : h);
+            if (offset + bytes > mapped.getSize()) {
+                ERROR("DdsFile", "load", ("Truncated DDS file: " + path).c_str());
+                return E_FAIL;
+            }
+            if (mip >= skip) {
+                D3D11_SUBRESOURCE_DATA& data = subresources[item * residentMips + (mip - skip)];
+                data.pSysMem = mapped.getData() + offset;
+                data.SysMemPitch = pitch;
+                data.SysMemSlicePitch = static_cast<UINT>(bytes);
+                residentBytes += bytes;
+            }
+            offset += bytes;
+            w = (std::max)(w / 2, 1u);
+            h = (std::max)(h / 2, 1u);
+        }
+    }
+
+    D3D11_TEXTURE2D_DESC desc = {};
+    desc.Width = (std::max)(width >> skip, 1u);
+    desc.Height = (std::max)(height >> skip, 1u);
+    desc.MipLevels = residentMips;
+    desc.ArraySize = items;
+    desc.Format = format;
+    desc.SampleDesc.Count = 1;
+    desc.Usage = D3D11_USAGE_IMMUTABLE;
+    desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+    desc.MiscFlags = cube ? D3D11_RESOURCE_MISC_TEXTURECUBE : 0;
+
+    ID3D11Texture2D* texture = nullptr;
+    HRESULT hr = device->CreateTexture2D(&desc, subresources.data(), &texture);
+    if (FAILED(hr)) {
+        ERROR("DdsFile", "load", ("Failed to create texture from " + path).c_str());
+        return hr;
+    }
+    GpuMemory::track(texture);
+
+    D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+    srvDesc.Format = format;
+    if (cube && arraySize > 1) {
+        srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURECUBEARRAY;
+        srvDesc.TextureCubeArray.MipLevels = residentMips;
+        srvDesc.TextureCubeArray.NumCubes = arraySize;
+    }
+    else if (cube) {
+        srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURECUBE;
+        srvDesc.TextureCube.MipLevels = residentMips;
+    }
+    else if (arraySize > 1) {
+        srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
+        srvDesc.Texture2DArray.MipLevels = residentMips;
+        srvDesc.Texture2DArray.ArraySize = arraySize;
+    }
+    else {
+        srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+        srvDesc.Texture2D.MipLevels = residentMips;
+    }
+    hr = device->CreateShaderResourceView(texture, &srvDesc, srv);
+    SAFE_RELEASE(texture); // la SRV mantiene viva la textura
+    if (FAILED(hr)) {
+        ERROR("DdsFile", "load", ("Failed to create shader resource view for " + path).c_str());
+        return hr;
+    }
+    if (info) {
+        info->width = width;
+        info->height = height;
+        info->mipCount = mipCount;
+        info->residentMip = skip;
+        info->residentBytes = residentBytes;
+    }
+    return hr;
+}
+
+std::string DdsFile::getCachePath(const std::string& sourcePath, TextureCompression compression) {
+    static const char* const kSuffix[] = { "rgba", "auto", "bc1", "bc3", "bc5", "bc7" };
+    return sourcePath + "." + kSuffix[compression] + ".dds";
+}
+
+bool DdsFile::isFresh(const std::string& cachePath, const std::string& sourcePath) {
+    ULARGE_INTEGER cacheTime, sourceTime;
+    if (!getWriteTime(cachePath, cacheTime)) {
+        // Solo empaquetada: vale mientras el original no esté suelto (si lo está, se está editando).
+        return VirtualFileSystem::getDefault().isPacked(cachePath) && !getWriteTime(sourcePath, sourceTime);
+    }
+    // Sin original (solo se distribuyó la caché) vale lo que haya.
+    return !getWriteTime(sourcePath, sourceTime) || cacheTime.QuadPart >= sourceTime.QuadPart;
+}
+
+HRESULT DdsFile::write(const std::string& path, const CompressedImage& image) {
+    const bool compressed = getBlockBytes(image.format) != 0;
+    if ((!compressed && getBitsPerPixel(image.format) == 0) || image.levels.empty() || image.elementCount == 0 ||
+        (image.cubemap && image.elementCount % 6 != 0)) {
+        return E_INVALIDARG;
+    }
+
+    unsigned int header[kHeaderDwords] = {};
+    header[HEADER_SIZE] = kHeaderDwords * 4;
+    header[HEADER_FLAGS] = 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000;           // CAPS|HEIGHT|WIDTH|PIXELFORMAT|MIPMAPCOUNT
+    header[HEADER_FLAGS] |= compressed ? 0x80000 : 0x8;                  // LINEARSIZE o PITCH
+    header[HEADER_HEIGHT] = image.levels[0].height;
+    header[HEADER_WIDTH] = image.levels[0].width;
+    header[HEADER_LINEAR_SIZE] = compressed ? static_cast<unsigned int>(image.levels[0].size) : image.levels[0].rowPitch;
+    header[HEADER_MIP_COUNT] = static_cast<unsigned int>(image.levels.size());
+    header[HEADER_RESERVED] = kEngineTag;
+    header[HEADER_RESERVED + 1] = kEncoderVersion;
+    header[HEADER_PF_SIZE] = 32;
+    header[HEADER_PF_FLAGS] = 0x4;                                       // DDPF_FOURCC
+    header[HEADER_PF_FOURCC] = kFourCCDX10;
+    header[HEADER_CAPS] = 0x1000 | 0x400000 | 0x8;                       // TEXTURE|MIPMAP|COMPLEX
+    if (image.cubemap) {
+        header[HEADER_CAPS2] = kCaps2Cubemap | kCaps2AllFaces;
+    }
+
+    unsigned int dx10[kDX10Dwords] = {};
+    dx10[0] = static_cast<unsigned int>(image.format);
+    dx10[1] = 3;                                                         // D3D11_RESOURCE_DIMENSION_TEXTURE2D
+    dx10[2] = image.cubemap ? kMiscCube : 0;
+    dx10[3] = image.cubemap ? image.elementCount / 6 : image.elementCount; // arraySize (cubos si es cubemap)
+
+    const std::string temp = path + ".tmp" + std::to_string(GetCurrentThreadId());
+    FILE* file = nullptr;
+    if (fopen_s(&file, temp.c_str(), "wb") != 0 || !file) {
+        ERROR("DdsFile", "write", ("Cannot write " + temp).c_str());
+        return E_FAIL;
+    }
+    bool ok = fwrite(&kMagic, 4, 1, file) == 1 &&
+        fwrite(header, sizeof(header), 1, file) == 1 &&
+        fwrite(dx10, sizeof(dx10), 1, file) == 1 &&
+        fwrite(image.data.data(), 1, image.data.size(), file) == image.data.size();
+    ok = fclose(file) == 0 && ok;
+    if (!ok || !MoveFileExA(temp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+        DeleteFileA(temp.c_str());
+        ERROR("DdsFile", "write", ("Cannot write " + path).c_str());
+        return E_FAIL;
+    }
+    return S_OK;
+}
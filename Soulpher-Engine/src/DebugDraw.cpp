@@ -0,0 +1,318 @@
+﻿/**
+ * @file DebugDraw.cpp
+ * @brief Grabación por hilo, recogida y dibujo de las primitivas de depuración.
+ */
+
+#include "DebugDraw.h"
+
+const XMFLOAT4 DebugDraw::kWhite(1.0f, 1.0f, 1.0f, 1.0f);
+const XMFLOAT4 DebugDraw::kRed(1.0f, 0.25f, 0.2f, 1.0f);
+const XMFLOAT4 DebugDraw::kGreen(0.3f, 1.0f, 0.3f, 1.0f);
+const XMFLOAT4 DebugDraw::kBlue(0.3f, 0.55f, 1.0f, 1.0f);
+const XMFLOAT4 DebugDraw::kYellow(1.0f, 0.9f, 0.2f, 1.0f);
+
+#if defined(PROFILE)
+#include "Device.h"
+#include "DeviceContext.h"
+#include "VertexLayout.h"
+#include "imgui.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+const ConstantBufferLayouts::Registration DebugDraw::kDebugDrawLayout({ "cbDebugDraw", CB_SLOT_OBJECT,
+    sizeof(CBDebugDraw), { CB_FIELD(CBDebugDraw, viewProj, "ViewProj") } });
+
+std::atomic<bool> DebugDraw::s_enabled(true);
+
+std::vector<std::unique_ptr<DebugDraw::ThreadBuffer>>& DebugDraw::buffers() {
+    static std::vector<std::unique_ptr<ThreadBuffer>> registry;
+    return registry;
+}
+
+std::mutex& DebugDraw::buffersMutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+DebugDraw::ThreadBuffer& DebugDraw::local() {
+    thread_local ThreadBuffer* buffer = nullptr;
+    if (!buffer) {
+        std::lock_guard<std::mutex> lock(buffersMutex());
+        buffers().push_back(std::make_unique<ThreadBuffer>());
+        buffer = buffers().back().get();
+    }
+    return *buffer;
+}
+
+unsigned int DebugDraw::pack(const XMFLOAT4& color) {
+    auto channel = [](float value) {
+        return static_cast<unsigned int>((std::min)((std::max)(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+    };
+    return channel(color.x) | (channel(color.y) << 8) | (channel(color.z) << 16) | (channel(color.w) << 24);
+}
+
+void DebugDraw::addLines(const XMFLOAT3* points, unsigned int count, const XMFLOAT4& color, bool depthTest) {
+    const unsigned int packed = pack(color);
+    ThreadBuffer& buffer = local();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    std::vector<Vertex>& vertices = buffer.vertices[depthTest ? 0 : 1];
+    for (unsigned int i = 0; i < count; ++i) {
+        vertices.push_back({ points[i], packed });
+    }
+}
+
+void DebugDraw::line(const XMFLOAT3& a, const XMFLOAT3& b, const XMFLOAT4& color, bool depthTest) {
+    if (!isEnabled()) {
+        return;
+    }
+    const XMFLOAT3 points[2] = { a, b };
+    addLines(points, 2, color, depthTest);
+}
+
+void DebugDraw::box(const XMFLOAT3& min, const XMFLOAT3& max, const XMFLOAT4& color, bool depthTest) {
+    orientedBox(XMMatrixIdentity(), min, max, color, depthTest);
+}
+
+/**
+ * @details Esquina `i`: bit 0 elige x, bit 1 y, bit 2 z (0 = min, 1 = max); las 12
+ * aristas unen las esquinas que difieren en un solo bit.
+ */
+void DebugDraw::orientedBox(const XMMATRIX& world, const XMFLOAT3& min, const XMFLOAT3& max,
+    const XMFLOAT4& color, bool depthTest) {
+    if (!isEnabled()) {
+        return;
+    }
+    XMFLOAT3 corners[8];
+    for (unsigned int i = 0; i < 8; ++i) {
+        const XMVECTOR corner = XMVectorSet((i & 1) ? max.x : min.x, (i & 2) ? max.y : min.y,
+            (i & 4) ? max.z : min.z, 1.0f);
+        XMStoreFloat3(&corners[i], XMVector3TransformCoord(corner, world));
+    }
+    XMFLOAT3 points[24];
+    unsigned int count = 0;
+    for (unsigned int i = 0; i < 8; ++i) {
+        for (unsigned int bit = 1; bit < 8; bit <<= 1) {
+            if (!(i & bit)) {
+                points[count++] = corners[i];
+                points[count++] = corners[i | bit];
+            }
+        }
+    }
+    addLines(points, count, color, depthTest);
+}
+
+void DebugDraw::sphere(const XMFLOAT3& center, float radius, const XMFLOAT4& color, bool depthTest) {
+    if (!isEnabled()) {
+        return;
+    }
+    XMFLOAT3 points[3 * kCircleSegments * 2];
+    unsigned int count = 0;
+    for (unsigned int segment = 0; segment < kCircleSegments; ++segment) {
+        const float a0 = XM_2PI * segment / kCircleSegments;
+        const float a1 = XM_2PI * (segment + 1) / kCircleSegments;
+        const float c0 = std::cos(a0) * radius, s0 = std::sin(a0) * radius;
+        const float c1 = std::cos(a1) * radius, s1 = std::sin(a1) * radius;
+        points[count++] = XMFLOAT3(center.x + c0, center.y + s0, center.z);
+        points[count++] = XMFLOAT3(center.x + c1, center.y + s1, center.z);
+        points[count++] = XMFLOAT3(center.x + c0, center.y, center.z + s0);
+        points[count++] = XMFLOAT3(center.x + c1, center.y, center.z + s1);
+        points[count++] = XMFLOAT3(center.x, center.y + c0, center.z + s0);
+        points[count++] = XMFLOAT3(center.x, center.y + c1, center.z + s1);
+    }
+    addLines(points, count, color, depthTest);
+}
+
+/**
+ * @details Las esquinas del cubo NDC (x, y en [-1,1], z en [0,1] en D3D) llevadas al
+ * mundo con la inversa: es el mismo dibujo que `orientedBox` con esa matriz.
+ */
+void DebugDraw::frustum(const XMMATRIX& viewProj, const XMFLOAT4& color, bool depthTest) {
+    XMVECTOR determinant;
+    const XMMATRIX inverse = XMMatrixInverse(&determinant, viewProj);
+    if (XMVectorGetX(determinant) == 0.0f) {
+        return;
+    }
+    orientedBox(inverse, XMFLOAT3(-1.0f, -1.0f, 0.0f), XMFLOAT3(1.0f, 1.0f, 1.0f), color, depthTest);
+}
+
+void DebugDraw::text(const XMFLOAT3& position, const std::string& text, const XMFLOAT4& color) {
+    if (!isEnabled() || text.empty()) {
+        return;
+    }
+    ThreadBuffer& buffer = local();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.labels.push_back({ position, pack(color), text });
+}
+
+HRESULT DebugDraw::init(Device& device) {
+    if (!device.m_device) {
+        ERROR("DebugDraw", "init", "Device is null.");
+        return E_POINTER;
+    }
+    destroy();
+
+    const std::vector<D3D11_INPUT_ELEMENT_DESC> layout = VertexLayout()
+        .add("POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT)
+        .add("COLOR", 0, DXGI_FORMAT_R8G8B8A8_UNORM)
+        .getDesc();
+    HRESULT hr = m_program.init(device, "DebugDraw.fx", layout);
+    if (SUCCEEDED(hr)) {
+        hr = m_vertexBuffer.initDynamic(device, kInitialVertices * sizeof(Vertex), sizeof(Vertex),
+            D3D11_BIND_VERTEX_BUFFER);
+        m_capacity = SUCCEEDED(hr) ? kInitialVertices : 0;
+    }
+    if (SUCCEEDED(hr)) { hr = m_constants.init(device); }
+    if (SUCCEEDED(hr)) { hr = m_blendState.init(device, true); }
+    if (SUCCEEDED(hr)) { hr = m_rasterizer.init(device, 0, 0.0f, D3D11_CULL_NONE); }
+    if (SUCCEEDED(hr)) { hr = m_depthTest.init(device, true, false, false, D3D11_COMPARISON_LESS_EQUAL); }
+    if (SUCCEEDED(hr)) { hr = m_noDepth.init(device, false, false, false); }
+    if (FAILED(hr)) {
+        ERROR("DebugDraw", "init", ("Failed to create debug draw resources. HRESULT: " + std::to_string(hr)).c_str());
+        destroy();
+        return hr;
+    }
+    m_device = &device;
+    return S_OK;
+}
+
+/**
+ * @details Se intercambian los vectores en lugar de copiarlos: el hilo se queda con la
+ * capacidad del frame anterior y no vuelve a reservar.
+ */
+void DebugDraw::collect() {
+    for (unsigned int list = 0; list < 2; ++list) {
+        m_vertices[list].clear();
+    }
+    m_labels.clear();
+    std::lock_guard<std::mutex> registryLock(buffersMutex());
+    for (const std::unique_ptr<ThreadBuffer>& buffer : buffers()) {
+        std::lock_guard<std::mutex> lock(buffer->mutex);
+        for (unsigned int list = 0; list < 2; ++list) {
+            std::vector<Vertex>& source = buffer->vertices[list];
+            if (m_vertices[list].empty()) {
+                m_vertices[list].swap(source);
+            }
+            else {
+                m_vertices[list].insert(m_vertices[list].end(), source.begin(), source.end());
+            }
+            source.clear();
+        }
+        m_labels.insert(m_labels.end(), buffer->labels.begin(), buffer->labels.end());
+        buffer->labels.clear();
+    }
+    // Sin renderer (o por encima del límite) lo grabado se tira igual: no se acumula.
+    const size_t total = isReady() ? m_vertices[0].size() + m_vertices[1].size() : 0;
+    if (!isReady()) {
+        m_vertices[0].clear();
+        m_vertices[1].clear();
+    }
+    else if (total > kMaxVertices) {
+        m_dropped += total - kMaxVertices;
+        m_vertices[1].resize((std::min)(m_vertices[1].size(), static_cast<size_t>(kMaxVertices / 2) & ~size_t(1)));
+        m_vertices[0].resize((kMaxVertices - m_vertices[1].size()) & ~size_t(1));
+    }
+}
+
+void DebugDraw::render(DeviceContext& deviceContext, ID3D11RenderTargetView* rtv, ID3D11DepthStencilView* dsv,
+    unsigned int width, unsigned int height, const XMMATRIX& viewProj) {
+    const unsigned int counts[2] = {
+        static_cast<unsigned int>(m_vertices[0].size()),
+        static_cast<unsigned int>(m_vertices[1].size()) };
+    const unsigned int total = counts[0] + counts[1];
+    if (!isReady() || total == 0) {
+        return;
+    }
+    DeviceContext::EventScope event(deviceContext, "Debug draw");
+
+    if (total > m_capacity) {
+        unsigned int capacity = (std::max)(m_capacity, kInitialVertices);
+        while (capacity < total) capacity *= 2;
+        m_vertexBuffer.destroy();
+        m_capacity = 0;
+        if (FAILED(m_vertexBuffer.initDynamic(*m_device, capacity * sizeof(Vertex), sizeof(Vertex),
+            D3D11_BIND_VERTEX_BUFFER))) {
+            ERROR("DebugDraw", "render", "Failed to grow the vertex buffer");
+            return;
+        }
+        m_capacity = capacity;
+    }
+    D3D11_MAPPED_SUBRESOURCE mapped = {};
+    if (FAILED(m_vertexBuffer.map(deviceContext, D3D11_MAP_WRITE_DISCARD, 0, mapped))) {
+        return;
+    }
+    Vertex* destination = static_cast<Vertex*>(mapped.pData);
+    memcpy(destination, m_vertices[0].data(), counts[0] * sizeof(Vertex));
+    memcpy(destination + counts[0], m_vertices[1].data(), counts[1] * sizeof(Vertex));
+    m_vertexBuffer.unmap(deviceContext);
+
+    CBDebugDraw constants;
+    constants.viewProj = XMMatrixTranspose(viewProj);
+    m_constants.set(constants);
+    m_constants.update(deviceContext);
+    m_constants.render(deviceContext, CB_SLOT_OBJECT);
+
+    D3D11_VIEWPORT viewport = {};
+    viewport.Width = static_cast<float>(width);
+    viewport.Height = static_cast<float>(height);
+    viewport.MaxDepth = 1.0f;
+    deviceContext.RSSetViewports(1, &viewport);
+    deviceContext.OMSetRenderTargets(1, &rtv, dsv);
+    m_program.render(deviceContext);
+    m_blendState.render(deviceContext);
+    m_rasterizer.render(deviceContext);
+    deviceContext.IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_LINELIST);
+    m_vertexBuffer.render(deviceContext, VERTEX_STREAM_GEOMETRY, 1);
+
+    // Sin profundidad de la escena, las dos listas van encima en un solo draw.
+    if (dsv && counts[0] > 0) {
+        m_depthTest.render(deviceContext);
+        deviceContext.Draw(counts[0], 0);
+    }
+    const unsigned int first = dsv ? counts[0] : 0;
+    if (total > first) {
+        m_noDepth.render(deviceContext);
+        deviceContext.Draw(total - first, first);
+    }
+    m_blendState.render(deviceContext, nullptr, 0xffffffff, true);
+    m_noDepth.render(deviceContext, 0, true);
+}
+
+void DebugDraw::drawLabels(const XMMATRIX& viewProj, float x, float y, float width, float height) const {
+    if (m_labels.empty() || width <= 0.0f || height <= 0.0f) {
+        return;
+    }
+    ImDrawList* drawList = ImGui::GetForegroundDrawList();
+    drawList->PushClipRect(ImVec2(x, y), ImVec2(x + width, y + height), true);
+    for (const Label& label : m_labels) {
+        const XMVECTOR clip = XMVector4Transform(XMVectorSet(label.position.x, label.position.y,
+            label.position.z, 1.0f), viewProj);
+        const float w = XMVectorGetW(clip);
+        if (w <= 1e-4f) {
+            continue;
+        }
+        const float ndcX = XMVectorGetX(clip) / w;
+        const float ndcY = XMVectorGetY(clip) / w;
+        const ImVec2 position(x + (ndcX * 0.5f + 0.5f) * width, y + (0.5f - ndcY * 0.5f) * height);
+        // Sombra de un píxel para que se lea sobre fondos claros.
+        drawList->AddText(ImVec2(position.x + 1.0f, position.y + 1.0f), IM_COL32(0, 0, 0, 200), label.text.c_str());
+        drawList->AddText(position, label.color, label.text.c_str());
+    }
+    drawList->PopClipRect();
+}
+
+void DebugDraw::destroy() {
+    m_program.destroy();
+    m_vertexBuffer.destroy();
+    m_capacity = 0;
+    m_constants.destroy();
+    m_blendState.destroy();
+    m_rasterizer.destroy();
+    m_depthTest.destroy();
+    m_noDepth.destroy();
+    m_vertices[0].clear();
+    m_vertices[1].clear();
+    m_labels.clear();
+    m_device = nullptr;
+}
+#endif
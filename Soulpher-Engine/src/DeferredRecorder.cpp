@@ -0,0 +1,90 @@
+﻿/**
+ * @file DeferredRecorder.cpp
+ * @brief Implementación del grabador con contextos diferidos.
+ */
+
+#include "DeferredRecorder.h"
+#include "Device.h"
+
+HRESULT DeferredRecorder::init(Device& device, unsigned int contextCount) {
+    destroy();
+    if (!device.m_device) {
+        ERROR("DeferredRecorder", "init", "device is not initialized");
+        return E_POINTER;
+    }
+    if (contextCount == 0) {
+        contextCount = JobSystem::getDefault().getThreadCount();
+    }
+    contextCount = (std::min)(contextCount, kMaxContexts);
+
+    D3D11_FEATURE_DATA_THREADING threading = {};
+    if (SUCCEEDED(device.m_device->CheckFeatureSupport(D3D11_FEATURE_THREADING, &threading, sizeof(threading)))) {
+        m_driverCommandLists = threading.DriverCommandLists != FALSE;
+    }
+
+    for (unsigned int i = 0; i < contextCount; ++i) {
+        std::unique_ptr<DeviceContext> context(new DeviceContext());
+        HRESULT hr = context->initDeferred(device.m_device);
+        if (FAILED(hr)) {
+            ERROR("DeferredRecorder", "init", "Failed to create a deferred context");
+            destroy();
+            return hr;
+        }
+        m_contexts.push_back(std::move(context));
+    }
+    m_commandLists.assign(m_contexts.size(), nullptr);
+    MESSAGE("DeferredRecorder", "init", ("Created " + std::to_string(contextCount) + " deferred contexts (driver command lists: " +
+        (m_driverCommandLists ? "yes" : "no, emulated") + ")").c_str());
+    return S_OK;
+}
+
+void DeferredRecorder::destroy() {
+    for (ID3D11CommandList*& list : m_commandLists) {
+        SAFE_RELEASE(list);
+    }
+    m_commandLists.clear();
+    for (std::unique_ptr<DeviceContext>& context : m_contexts) {
+        context->destroy();
+    }
+    m_contexts.clear();
+    m_driverCommandLists = false;
+    m_lastListCount = 0;
+}
+
+/**
+ * @details Una lista por cada `kMinItemsPerList` elementos, hasta una por contexto. Con
+ * menos de dos no compensa: `record` graba en el inmediato.
+ */
+unsigned int DeferredRecorder::begin(DeviceContext& immediate, unsigned int count) {
+    unsigned int lists = (std::min)(static_cast<unsigned int>(m_contexts.size()), count / kMinItemsPerList);
+    if (lists < 2 || !JobSystem::getDefault().isJobThread()) {
+        lists = 0;
+    }
+    for (unsigned int i = 0; i < lists; ++i) {
+        m_contexts[i]->inheritState(immediate);
+    }
+    m_lastListCount = lists;
+    return lists;
+}
+
+void DeferredRecorder::finish(unsigned int index) {
+    HRESULT hr = m_contexts[index]->FinishCommandList(&m_commandLists[index]);
+    if (FAILED(hr)) {
+        ERROR("DeferredRecorder", "finish", ("FinishCommandList failed. hr=" + std::to_string(hr)).c_str());
+        m_commandLists[index] = nullptr;
+    }
+}
+
+/**
+ * @details Se restaura el estado del inmediato tras cada lista, así su caché de estado
+ * sigue siendo válida y lo que se dibuje después no ve lo que enlazaron las listas.
+ */
+void DeferredRecorder::end(DeviceContext& immediate, unsigned int lists) {
+    for (unsigned int i = 0; i < lists; ++i) {
+        if (m_commandLists[i]) {
+            immediate.ExecuteCommandList(m_commandLists[i], true);
+            SAFE_RELEASE(m_commandLists[i]);
+        }
+        immediate.mergeStats(*m_contexts[i]);
+    }
+}
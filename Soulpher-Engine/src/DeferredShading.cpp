@@ -0,0 +1,104 @@
+﻿/**
+ * @file DeferredShading.cpp
+ * @brief Implementación del camino diferido: formatos del G-buffer e iluminación por baldosas.
+ */
+
+#include "DeferredShading.h"
+#include "ClusteredLighting.h"
+#include "Device.h"
+#include "DeviceContext.h"
+#include "ShaderLibrary.h"
+
+namespace {
+    RenderTargetPool::Desc targetDesc(unsigned int width, unsigned int height, DXGI_FORMAT format,
+        unsigned int bindFlags) {
+        RenderTargetPool::Desc desc;
+        desc.width = width;
+        desc.height = height;
+        desc.format = format;
+        desc.bindFlags = bindFlags;
+        return desc;
+    }
+}
+
+HRESULT DeferredShading::init(Device& device) {
+    if (!device.m_device) {
+        ERROR("DeferredShading", "init", "Device is null.");
+        return E_POINTER;
+    }
+    destroy();
+
+    // UAV de texturas en compute: nivel 11_0.
+    if (device.m_device->GetFeatureLevel() < D3D_FEATURE_LEVEL_11_0) {
+        MESSAGE("DeferredShading", "init", "Feature level < 11_0: deferred shading disabled.");
+        return DXGI_ERROR_UNSUPPORTED;
+    }
+
+    ShaderKey key;
+    key.fileName = "DeferredLighting.fx";
+    key.entryPoint = "CSLight";
+    key.profile = "cs_5_0";
+    HRESULT hr = device.getShaderLibrary().getComputeShader(device, key, &m_lightShader);
+    if (SUCCEEDED(hr)) {
+        key.defines.push_back({ "LIT_FLOAT", "1" });
+        hr = device.getShaderLibrary().getComputeShader(device, key, &m_lightShaderFloat);
+    }
+    if (FAILED(hr)) {
+        destroy();
+    }
+    return hr;
+}
+
+RenderTargetPool::Desc DeferredShading::albedoDesc(unsigned int width, unsigned int height) {
+    return targetDesc(width, height, DXGI_FORMAT_R8G8B8A8_UNORM,
+        D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE);
+}
+
+RenderTargetPool::Desc DeferredShading::surfaceDesc(unsigned int width, unsigned int height) {
+    return targetDesc(width, height, DXGI_FORMAT_R10G10B10A2_UNORM,
+        D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE);
+}
+
+RenderTargetPool::Desc DeferredShading::litDesc(unsigned int width, unsigned int height, DXGI_FORMAT format) {
+    return targetDesc(width, height, format, D3D11_BIND_UNORDERED_ACCESS);
+}
+
+void DeferredShading::light(DeviceContext& deviceContext, const ClusteredLighting& lights,
+    ID3D11ShaderResourceView* depthSRV, ID3D11ShaderResourceView* albedoSRV,
+    ID3D11ShaderResourceView* surfaceSRV, ID3D11UnorderedAccessView* litUAV,
+    ID3D11ShaderResourceView* occlusionSRV, unsigned int width, unsigned int height) {
+    if (!isReady() || !lights.isReady() || !depthSRV || !albedoSRV || !surfaceSRV || !litUAV) {
+        return;
+    }
+
+    // El G-buffer y la profundidad siguen enlazados como salida del pase anterior.
+    deviceContext.OMSetRenderTargets(0, nullptr, nullptr);
+
+    // El tipo del UAV en el shader tiene que coincidir con el formato (`unorm` o no).
+    D3D11_UNORDERED_ACCESS_VIEW_DESC litDesc;
+    litUAV->GetDesc(&litDesc);
+    const bool unorm = litDesc.Format == DXGI_FORMAT_R8G8B8A8_UNORM;
+
+    // Sin AO t3 queda sin enlazar: el shader lo detecta por su tamaño (0).
+    ID3D11ShaderResourceView* gbuffer[4] = { depthSRV, albedoSRV, surfaceSRV, occlusionSRV };
+    ID3D11ShaderResourceView* lightSRV = lights.getLightSRV();
+    ID3D11Buffer* params = lights.getParams();
+    deviceContext.CSSetShader(unorm ? m_lightShader : m_lightShaderFloat, nullptr, 0);
+    deviceContext.CSSetConstantBuffers(CB_SLOT_CLUSTERS, 1, &params);
+    deviceContext.CSSetShaderResources(0, 4, gbuffer);
+    deviceContext.CSSetShaderResources(ClusteredLighting::kTextureSlot, 1, &lightSRV);
+    deviceContext.CSSetUnorderedAccessViews(0, 1, &litUAV, nullptr);
+    deviceContext.Dispatch((width + kTileSize - 1) / kTileSize, (height + kTileSize - 1) / kTileSize, 1);
+
+    ID3D11ShaderResourceView* nullSRVs[4] = { nullptr, nullptr, nullptr, nullptr };
+    ID3D11UnorderedAccessView* nullUAV = nullptr;
+    deviceContext.CSSetShaderResources(0, 4, nullSRVs);
+    deviceContext.CSSetShaderResources(ClusteredLighting::kTextureSlot, 1, nullSRVs);
+    deviceContext.CSSetUnorderedAccessViews(0, 1, &nullUAV, nullptr);
+    deviceContext.CSSetShader(nullptr, nullptr, 0);
+}
+
+void DeferredShading::destroy() {
+    SAFE_RELEASE(m_lightShader);
+    SAFE_RELEASE(m_lightShaderFloat);
+}
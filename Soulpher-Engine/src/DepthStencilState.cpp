@@ -23,13 +23,16 @@
   * @param device        Dispositivo D3D11.
   * @param enableDepth   Activa/desactiva la prueba de profundidad.
   * @param enableStencil Activa/desactiva la prueba de stencil.
+  * @param writeDepth    Escribe Z en el depth buffer.
+  * @param depthFunc     Comparación de profundidad (por defecto LESS).
   * @return HRESULT S_OK si ok, o código de error en fallo.
   *
   * @note
-  * - DepthFunc = LESS: el fragmento se dibuja si su Z es menor (más cerca).
+  * - DepthFunc = LESS (por defecto): el fragmento se dibuja si su Z es menor (más cerca).
   * - Stencil por defecto con KEEP/INCR/DECR y ALWAYS como comparación.
   */
-HRESULT DepthStencilState::init(Device& device, bool enableDepth, bool enableStencil) {
+HRESULT DepthStencilState::init(Device& device, bool enableDepth, bool enableStencil,
+    bool writeDepth, D3D11_COMPARISON_FUNC depthFunc) {
     if (!device.m_device) {
         ERROR("DepthStencilState", "init", "Device is null.");
         return E_POINTER;
@@ -37,8 +40,8 @@ HRESULT DepthStencilState::init(Device& device, bool enableDepth, bool enableSte
 
     D3D11_DEPTH_STENCIL_DESC desc = {};
     desc.DepthEnable = enableDepth;
-    desc.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ALL;
-    desc.DepthFunc = D3D11_COMPARISON_LESS;
+    desc.DepthWriteMask = writeDepth ? D3D11_DEPTH_WRITE_MASK_ALL : D3D11_DEPTH_WRITE_MASK_ZERO;
+    desc.DepthFunc = depthFunc;
 
     desc.StencilEnable = enableStencil;
     desc.StencilReadMask = D3D11_DEFAULT_STENCIL_READ_MASK;
@@ -56,7 +59,7 @@ HRESULT DepthStencilState::init(Device& device, bool enableDepth, bool enableSte
     desc.BackFace.StencilPassOp = D3D11_STENCIL_OP_KEEP;
     desc.BackFace.StencilFunc = D3D11_COMPARISON_ALWAYS;
 
-    HRESULT hr = device.CreateDepthStencilState(&desc, &m_depthStencilState);
+    HRESULT hr = device.CreateSharedDepthStencilState(&desc, &m_depthStencilState);
     if (FAILED(hr)) {
         ERROR("DepthStencilState", "init", "Failed to create DepthStencilState");
         return hr; // <-- devolver el error real
@@ -94,10 +97,10 @@ void DepthStencilState::render(DeviceContext& deviceContext,
     }
 
     if (!reset) {
-        deviceContext.m_deviceContext->OMSetDepthStencilState(m_depthStencilState, stencilRef);
+        deviceContext.OMSetDepthStencilState(m_depthStencilState, stencilRef);
     }
     else {
-        deviceContext.m_deviceContext->OMSetDepthStencilState(nullptr, stencilRef);
+        deviceContext.OMSetDepthStencilState(nullptr, stencilRef);
     }
 }
 
@@ -91,7 +91,7 @@ void DepthStencilView::render(DeviceContext& deviceContext) {
     }
 
     // Limpia profundidad y stencil antes de renderizar
-    deviceContext.m_deviceContext->ClearDepthStencilView(
+    deviceContext.ClearDepthStencilView(
         m_depthStencilView,
         D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL,
         1.0f,
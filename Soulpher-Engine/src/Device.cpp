@@ -25,117 +25,628 @@
  * // Crear un Render Target View
  * ID3D11RenderTargetView* rtv = nullptr;
  * HRESULT hr = device.CreateRenderTargetView(backBuffer, nullptr, &rtv);
- * if (FAILED(hr)) { /* manejar error */ }
- *@endcode
-     * /
+ * if (FAILED(hr)) { return hr; } // manejar error
+ * @endcode
+ *
+ * Los estados (sampler, blend, depth/stencil, rasterizer) pueden pedirse en su
+ * variante `CreateShared*`, que pasa por la `RenderStateCache` y reutiliza el
+ * objeto existente para un descriptor ya visto.
+ */
 
 #include "Device.h"
+#include "GpuMemory.h"
+
+void
+Device::destroy() {
+    /** @brief Libera los estados, shaders e input layouts compartidos y después el dispositivo principal de DirectX 11. */
+    if (!m_stateCache.isNull()) {
+        m_stateCache->destroy();
+    }
+    if (!m_shaderLibrary.isNull()) {
+        m_shaderLibrary->destroy();
+    }
+    if (!m_inputLayouts.isNull()) {
+        m_inputLayouts->destroy();
+    }
+    SAFE_RELEASE(m_device);
+}
+
+/**
+ * @brief Crea un Render Target View para el pipeline de renderizado.
+ * @param pResource Recurso de DirectX (generalmente una textura de back buffer).
+ * @param pDesc Descriptor opcional del RTV. Si es nullptr, usa configuración por defecto.
+ * @param ppRTView Puntero donde se almacenará la interfaz creada.
+ * @return HRESULT indicando éxito o fallo.
+ *
+ * @note Un Render Target View es donde la GPU dibuja la imagen final antes de enviarla a pantalla.
+ */
+HRESULT
+Device::CreateRenderTargetView(ID3D11Resource* pResource,
+    const D3D11_RENDER_TARGET_VIEW_DESC* pDesc,
+    ID3D11RenderTargetView** ppRTView) {
+    if (!pResource) {
+        ERROR("Device", "CreateRenderTargetView", "pResource is nullptr");
+        return E_INVALIDARG;
+    }
+    if (!ppRTView) {
+        ERROR("Device", "CreateRenderTargetView", "ppRTView is nullptr");
+        return E_POINTER;
+    }
+    HRESULT hr = m_device->CreateRenderTargetView(pResource, pDesc, ppRTView);
+    if (SUCCEEDED(hr)) {
+        MESSAGE("Device", "CreateRenderTargetView", "Render Target View creado correctamente.");
+    }
+    else {
+        ERROR("Device", "CreateRenderTargetView", ("Fallo al crear RTV. HRESULT: " + std::to_string(hr)).c_str());
+    }
+    return hr;
+}
+
+/**
+ * @brief Crea una textura 2D en GPU.
+ * @param pDesc Descriptor de la textura (dimensiones, formato, etc.).
+ * @param pInitialData Datos iniciales opcionales.
+ * @param ppTexture2D Puntero donde se almacenará la textura creada.
+ * @return HRESULT indicando éxito o fallo.
+ *
+ * @note En videojuegos, las texturas 2D pueden ser usadas para mapas de color, normales, iluminación, etc.
+ */
+HRESULT
+Device::CreateTexture2D(const D3D11_TEXTURE2D_DESC* pDesc,
+    const D3D11_SUBRESOURCE_DATA* pInitialData,
+    ID3D11Texture2D** ppTexture2D) {
+    if (!pDesc) {
+        ERROR("Device", "CreateTexture2D", "pDesc is nullptr");
+        return E_INVALIDARG;
+    }
+    if (!ppTexture2D) {
+        ERROR("Device", "CreateTexture2D", "ppTexture2D is nullptr");
+        return E_POINTER;
+    }
+    HRESULT hr = m_device->CreateTexture2D(pDesc, pInitialData, ppTexture2D);
+    if (SUCCEEDED(hr)) {
+        GpuMemory::track(*ppTexture2D);
+        MESSAGE("Device", "CreateTexture2D", "Texture2D creada correctamente.");
+    }
+    else {
+        ERROR("Device", "CreateTexture2D", ("Fallo al crear textura. HRESULT: " + std::to_string(hr)).c_str());
+    }
+    return hr;
+}
+
+/**
+ * @brief Crea un Depth Stencil View para control de profundidad y stencil.
+ * @param pResource Recurso asociado (generalmente una textura de profundidad).
+ * @param pDesc Descriptor del DSV.
+ * @param ppDepthStencilView Puntero donde se almacenará la vista creada.
+ * @return HRESULT indicando éxito o fallo.
+ *
+ * @note El Depth Stencil es vital para evitar que objetos lejanos se dibujen encima de cercanos.
+ */
+HRESULT
+Device::CreateDepthStencilView(ID3D11Resource* pResource,
+    const D3D11_DEPTH_STENCIL_VIEW_DESC* pDesc,
+    ID3D11DepthStencilView** ppDepthStencilView) {
+    if (!pResource) {
+        ERROR("Device", "CreateDepthStencilView", "pResource is nullptr");
+        return E_INVALIDARG;
+    }
+    if (!ppDepthStencilView) {
+        ERROR("Device", "CreateDepthStencilView", "ppDepthStencilView is nullptr");
+        return E_POINTER;
+    }
+    HRESULT hr = m_device->CreateDepthStencilView(pResource, pDesc, ppDepthStencilView);
+    if (SUCCEEDED(hr)) {
+        MESSAGE("Device", "CreateDepthStencilView", "Depth Stencil View creado correctamente.");
+    }
+    else {
+        ERROR("Device", "CreateDepthStencilView", ("Fallo al crear DSV. HRESULT: " + std::to_string(hr)).c_str());
+    }
+    return hr;
+}
+
+/**
+ * @brief Crea un Vertex Shader a partir de bytecode compilado.
+ * @param pShaderBytecode Bytecode del shader (p. ej. de `ShaderLibrary::compile`).
+ * @param BytecodeLength Tamaño del bytecode en bytes.
+ * @param pClassLinkage Class linkage opcional (normalmente nullptr).
+ * @param ppVertexShader Puntero donde se almacenará el shader creado.
+ * @return HRESULT indicando éxito o fallo.
+ *
+ * @note El Vertex Shader transforma cada vértice (mundo → vista → proyección).
+ */
+HRESULT
+Device::CreateVertexShader(const void* pShaderBytecode,
+    unsigned int BytecodeLength,
+    ID3D11ClassLinkage* pClassLinkage,
+    ID3D11VertexShader** ppVertexShader) {
+    if (!pShaderBytecode || BytecodeLength == 0) {
+        ERROR("Device", "CreateVertexShader", "pShaderBytecode is nullptr or empty");
+        return E_INVALIDARG;
+    }
+    if (!ppVertexShader) {
+        ERROR("Device", "CreateVertexShader", "ppVertexShader is nullptr");
+        return E_POINTER;
+    }
+    HRESULT hr = m_device->CreateVertexShader(pShaderBytecode, BytecodeLength, pClassLinkage, ppVertexShader);
+    if (SUCCEEDED(hr)) {
+        MESSAGE("Device", "CreateVertexShader", "Vertex Shader creado correctamente.");
+    }
+    else {
+        ERROR("Device", "CreateVertexShader", ("Fallo al crear Vertex Shader. HRESULT: " + std::to_string(hr)).c_str());
+    }
+    return hr;
+}
+
+/**
+ * @brief Crea un Input Layout que describe el formato de los vértices.
+ * @param pInputElementDescs Arreglo de elementos (semántica, formato, slot).
+ * @param NumElements Número de elementos.
+ * @param pShaderBytecodeWithInputSignature Bytecode del VS cuya firma de entrada se valida.
+ * @param BytecodeLength Tamaño del bytecode.
+ * @param ppInputLayout Puntero donde se almacenará el layout creado.
+ * @return HRESULT indicando éxito o fallo.
+ *
+ * @note El layout debe coincidir con la estructura de entrada del Vertex Shader.
+ */
+HRESULT
+Device::CreateInputLayout(const D3D11_INPUT_ELEMENT_DESC* pInputElementDescs,
+    unsigned int NumElements,
+    const void* pShaderBytecodeWithInputSignature,
+    unsigned int BytecodeLength,
+    ID3D11InputLayout** ppInputLayout) {
+    if (!pInputElementDescs || NumElements == 0) {
+        ERROR("Device", "CreateInputLayout", "pInputElementDescs is nullptr or empty");
+        return E_INVALIDARG;
+    }
+    if (!pShaderBytecodeWithInputSignature) {
+        ERROR("Device", "CreateInputLayout", "pShaderBytecodeWithInputSignature is nullptr");
+        return E_INVALIDARG;
+    }
+    if (!ppInputLayout) {
+        ERROR("Device", "CreateInputLayout", "ppInputLayout is nullptr");
+        return E_POINTER;
+    }
+    HRESULT hr = m_device->CreateInputLayout(pInputElementDescs, NumElements,
+        pShaderBytecodeWithInputSignature, BytecodeLength, ppInputLayout);
+    if (SUCCEEDED(hr)) {
+        MESSAGE("Device", "CreateInputLayout", "Input Layout creado correctamente.");
+    }
+    else {
+        ERROR("Device", "CreateInputLayout", ("Fallo al crear Input Layout. HRESULT: " + std::to_string(hr)).c_str());
+    }
+    return hr;
+}
+
+/**
+ * @brief Crea un Pixel Shader a partir de bytecode compilado.
+ * @param pShaderBytecode Bytecode del shader.
+ * @param BytecodeLength Tamaño del bytecode en bytes.
+ * @param pClassLinkage Class linkage opcional (normalmente nullptr).
+ * @param ppPixelShader Puntero donde se almacenará el shader creado.
+ * @return HRESULT indicando éxito o fallo.
+ *
+ * @note El Pixel Shader calcula el color final de cada fragmento.
+ */
+HRESULT
+Device::CreatePixelShader(const void* pShaderBytecode,
+    unsigned int BytecodeLength,
+    ID3D11ClassLinkage* pClassLinkage,
+    ID3D11PixelShader** ppPixelShader) {
+    if (!pShaderBytecode || BytecodeLength == 0) {
+        ERROR("Device", "CreatePixelShader", "pShaderBytecode is nullptr or empty");
+        return E_INVALIDARG;
+    }
+    if (!ppPixelShader) {
+        ERROR("Device", "CreatePixelShader", "ppPixelShader is nullptr");
+        return E_POINTER;
+    }
+    HRESULT hr = m_device->CreatePixelShader(pShaderBytecode, BytecodeLength, pClassLinkage, ppPixelShader);
+    if (SUCCEEDED(hr)) {
+        MESSAGE("Device", "CreatePixelShader", "Pixel Shader creado correctamente.");
+    }
+    else {
+        ERROR("Device", "CreatePixelShader", ("Fallo al crear Pixel Shader. HRESULT: " + std::to_string(hr)).c_str());
+    }
+    return hr;
+}
+
+/**
+ * @brief Crea un Compute Shader a partir de bytecode compilado.
+ * @param pShaderBytecode Bytecode del shader (perfil cs_5_0).
+ * @param BytecodeLength Tamaño del bytecode en bytes.
+ * @param pClassLinkage Class linkage opcional (normalmente nullptr).
+ * @param ppComputeShader Puntero donde se almacenará el shader creado.
+ * @return HRESULT indicando éxito o fallo.
+ *
+ * @note Los compute shaders ejecutan trabajo general en la GPU (p. ej. reducir
+ * el depth buffer a una pirámide Hi-Z) sin pasar por el pipeline de raster.
+ */
+HRESULT
+Device::CreateComputeShader(const void* pShaderBytecode,
+    unsigned int BytecodeLength,
+    ID3D11ClassLinkage* pClassLinkage,
+    ID3D11ComputeShader** ppComputeShader) {
+    if (!pShaderBytecode || BytecodeLength == 0) {
+        ERROR("Device", "CreateComputeShader", "pShaderBytecode is nullptr or empty");
+        return E_INVALIDARG;
+    }
+    if (!ppComputeShader) {
+        ERROR("Device", "CreateComputeShader", "ppComputeShader is nullptr");
+        return E_POINTER;
+    }
+    HRESULT hr = m_device->CreateComputeShader(pShaderBytecode, BytecodeLength, pClassLinkage, ppComputeShader);
+    if (SUCCEEDED(hr)) {
+        MESSAGE("Device", "CreateComputeShader", "Compute Shader creado correctamente.");
+    }
+    else {
+        ERROR("Device", "CreateComputeShader", ("Fallo al crear Compute Shader. HRESULT: " + std::to_string(hr)).c_str());
+    }
+    return hr;
+}
+
+/**
+ * @brief Crea un Geometry Shader a partir de bytecode compilado.
+ * @param pShaderBytecode Bytecode del shader (perfil gs_5_0 o gs_4_x).
+ * @param BytecodeLength Tamaño del bytecode en bytes.
+ * @param pClassLinkage Class linkage opcional (normalmente nullptr).
+ * @param ppGeometryShader Puntero donde se almacenará el shader creado.
+ * @return HRESULT indicando éxito o fallo.
+ *
+ * @note Recibe primitivas completas y puede emitir otras (p. ej. expandir puntos en quads).
+ */
+HRESULT
+Device::CreateGeometryShader(const void* pShaderBytecode,
+    unsigned int BytecodeLength,
+    ID3D11ClassLinkage* pClassLinkage,
+    ID3D11GeometryShader** ppGeometryShader) {
+    if (!pShaderBytecode || BytecodeLength == 0) {
+        ERROR("Device", "CreateGeometryShader", "pShaderBytecode is nullptr or empty");
+        return E_INVALIDARG;
+    }
+    if (!ppGeometryShader) {
+        ERROR("Device", "CreateGeometryShader", "ppGeometryShader is nullptr");
+        return E_POINTER;
+    }
+    HRESULT hr = m_device->CreateGeometryShader(pShaderBytecode, BytecodeLength, pClassLinkage, ppGeometryShader);
+    if (SUCCEEDED(hr)) {
+        MESSAGE("Device", "CreateGeometryShader", "Geometry Shader creado correctamente.");
+    }
+    else {
+        ERROR("Device", "CreateGeometryShader", ("Fallo al crear Geometry Shader. HRESULT: " + std::to_string(hr)).c_str());
+    }
+    return hr;
+}
+
+/**
+ * @brief Crea un Hull Shader a partir de bytecode compilado.
+ * @param pShaderBytecode Bytecode del shader (perfil hs_5_0).
+ * @param BytecodeLength Tamaño del bytecode en bytes.
+ * @param pClassLinkage Class linkage opcional (normalmente nullptr).
+ * @param ppHullShader Puntero donde se almacenará el shader creado.
+ * @return HRESULT indicando éxito o fallo.
+ *
+ * @note Primera etapa de teselación: decide cuánto subdividir cada parche.
+ */
+HRESULT
+Device::CreateHullShader(const void* pShaderBytecode,
+    unsigned int BytecodeLength,
+    ID3D11ClassLinkage* pClassLinkage,
+    ID3D11HullShader** ppHullShader) {
+    if (!pShaderBytecode || BytecodeLength == 0) {
+        ERROR("Device", "CreateHullShader", "pShaderBytecode is nullptr or empty");
+        return E_INVALIDARG;
+    }
+    if (!ppHullShader) {
+        ERROR("Device", "CreateHullShader", "ppHullShader is nullptr");
+        return E_POINTER;
+    }
+    HRESULT hr = m_device->CreateHullShader(pShaderBytecode, BytecodeLength, pClassLinkage, ppHullShader);
+    if (SUCCEEDED(hr)) {
+        MESSAGE("Device", "CreateHullShader", "Hull Shader creado correctamente.");
+    }
+    else {
+        ERROR("Device", "CreateHullShader", ("Fallo al crear Hull Shader. HRESULT: " + std::to_string(hr)).c_str());
+    }
+    return hr;
+}
+
+/**
+ * @brief Crea un Domain Shader a partir de bytecode compilado.
+ * @param pShaderBytecode Bytecode del shader (perfil ds_5_0).
+ * @param BytecodeLength Tamaño del bytecode en bytes.
+ * @param pClassLinkage Class linkage opcional (normalmente nullptr).
+ * @param ppDomainShader Puntero donde se almacenará el shader creado.
+ * @return HRESULT indicando éxito o fallo.
+ *
+ * @note Última etapa de teselación: coloca los vértices que genera el teselador.
+ */
+HRESULT
+Device::CreateDomainShader(const void* pShaderBytecode,
+    unsigned int BytecodeLength,
+    ID3D11ClassLinkage* pClassLinkage,
+    ID3D11DomainShader** ppDomainShader) {
+    if (!pShaderBytecode || BytecodeLength == 0) {
+        ERROR("Device", "CreateDomainShader", "pShaderBytecode is nullptr or empty");
+        return E_INVALIDARG;
+    }
+    if (!ppDomainShader) {
+        ERROR("Device", "CreateDomainShader", "ppDomainShader is nullptr");
+        return E_POINTER;
+    }
+    HRESULT hr = m_device->CreateDomainShader(pShaderBytecode, BytecodeLength, pClassLinkage, ppDomainShader);
+    if (SUCCEEDED(hr)) {
+        MESSAGE("Device", "CreateDomainShader", "Domain Shader creado correctamente.");
+    }
+    else {
+        ERROR("Device", "CreateDomainShader", ("Fallo al crear Domain Shader. HRESULT: " + std::to_string(hr)).c_str());
+    }
+    return hr;
+}
+
+/**
+ * @brief Crea una Shader Resource View para leer un recurso desde shaders.
+ * @param pResource Recurso (textura o buffer).
+ * @param pDesc Descriptor opcional (formato, mips visibles).
+ * @param ppSRView Puntero donde se almacenará la vista creada.
+ * @return HRESULT indicando éxito o fallo.
+ */
+HRESULT
+Device::CreateShaderResourceView(ID3D11Resource* pResource,
+    const D3D11_SHADER_RESOURCE_VIEW_DESC* pDesc,
+    ID3D11ShaderResourceView** ppSRView) {
+    if (!pResource) {
+        ERROR("Device", "CreateShaderResourceView", "pResource is nullptr");
+        return E_INVALIDARG;
+    }
+    if (!ppSRView) {
+        ERROR("Device", "CreateShaderResourceView", "ppSRView is nullptr");
+        return E_POINTER;
+    }
+    HRESULT hr = m_device->CreateShaderResourceView(pResource, pDesc, ppSRView);
+    if (SUCCEEDED(hr)) {
+        MESSAGE("Device", "CreateShaderResourceView", "Shader Resource View creado correctamente.");
+    }
+    else {
+        ERROR("Device", "CreateShaderResourceView", ("Fallo al crear SRV. HRESULT: " + std::to_string(hr)).c_str());
+    }
+    return hr;
+}
+
+/**
+ * @brief Crea una Unordered Access View para escribir un recurso desde compute shaders.
+ * @param pResource Recurso creado con `D3D11_BIND_UNORDERED_ACCESS`.
+ * @param pDesc Descriptor opcional (formato, mip).
+ * @param ppUAView Puntero donde se almacenará la vista creada.
+ * @return HRESULT indicando éxito o fallo.
+ */
+HRESULT
+Device::CreateUnorderedAccessView(ID3D11Resource* pResource,
+    const D3D11_UNORDERED_ACCESS_VIEW_DESC* pDesc,
+    ID3D11UnorderedAccessView** ppUAView) {
+    if (!pResource) {
+        ERROR("Device", "CreateUnorderedAccessView", "pResource is nullptr");
+        return E_INVALIDARG;
+    }
+    if (!ppUAView) {
+        ERROR("Device", "CreateUnorderedAccessView", "ppUAView is nullptr");
+        return E_POINTER;
+    }
+    HRESULT hr = m_device->CreateUnorderedAccessView(pResource, pDesc, ppUAView);
+    if (SUCCEEDED(hr)) {
+        MESSAGE("Device", "CreateUnorderedAccessView", "Unordered Access View creado correctamente.");
+    }
+    else {
+        ERROR("Device", "CreateUnorderedAccessView", ("Fallo al crear UAV. HRESULT: " + std::to_string(hr)).c_str());
+    }
+    return hr;
+}
+
+/**
+ * @brief Crea un buffer de GPU (vértices, índices o constantes).
+ * @param pDesc Descriptor del buffer (tamaño, uso, bind flags).
+ * @param pInitialData Datos iniciales opcionales.
+ * @param ppBuffer Puntero donde se almacenará el buffer creado.
+ * @return HRESULT indicando éxito o fallo.
+ */
+HRESULT
+Device::CreateBuffer(const D3D11_BUFFER_DESC* pDesc,
+    const D3D11_SUBRESOURCE_DATA* pInitialData,
+    ID3D11Buffer** ppBuffer) {
+    if (!pDesc) {
+        ERROR("Device", "CreateBuffer", "pDesc is nullptr");
+        return E_INVALIDARG;
+    }
+    if (!ppBuffer) {
+        ERROR("Device", "CreateBuffer", "ppBuffer is nullptr");
+        return E_POINTER;
+    }
+    HRESULT hr = m_device->CreateBuffer(pDesc, pInitialData, ppBuffer);
+    if (SUCCEEDED(hr)) {
+        GpuMemory::track(*ppBuffer);
+        MESSAGE("Device", "CreateBuffer", "Buffer creado correctamente.");
+    }
+    else {
+        ERROR("Device", "CreateBuffer", ("Fallo al crear Buffer. HRESULT: " + std::to_string(hr)).c_str());
+    }
+    return hr;
+}
+
+/**
+ * @brief Crea un Sampler State (filtrado y direccionamiento de texturas).
+ * @param pSamplerDesc Descriptor del sampler.
+ * @param ppSamplerState Puntero donde se almacenará el estado creado.
+ * @return HRESULT indicando éxito o fallo.
+ */
+HRESULT
+Device::CreateSamplerState(const D3D11_SAMPLER_DESC* pSamplerDesc,
+    ID3D11SamplerState** ppSamplerState) {
+    if (!pSamplerDesc) {
+        ERROR("Device", "CreateSamplerState", "pSamplerDesc is nullptr");
+        return E_INVALIDARG;
+    }
+    if (!ppSamplerState) {
+        ERROR("Device", "CreateSamplerState", "ppSamplerState is nullptr");
+        return E_POINTER;
+    }
+    HRESULT hr = m_device->CreateSamplerState(pSamplerDesc, ppSamplerState);
+    if (SUCCEEDED(hr)) {
+        MESSAGE("Device", "CreateSamplerState", "Sampler State creado correctamente.");
+    }
+    else {
+        ERROR("Device", "CreateSamplerState", ("Fallo al crear Sampler State. HRESULT: " + std::to_string(hr)).c_str());
+    }
+    return hr;
+}
+
+/**
+ * @brief Crea un Blend State (mezcla de color con el render target).
+ * @param pBlendStateDesc Descriptor del blend state.
+ * @param ppBlendState Puntero donde se almacenará el estado creado.
+ * @return HRESULT indicando éxito o fallo.
+ */
+HRESULT
+Device::CreateBlendState(const D3D11_BLEND_DESC* pBlendStateDesc,
+    ID3D11BlendState** ppBlendState) {
+    if (!pBlendStateDesc) {
+        ERROR("Device", "CreateBlendState", "pBlendStateDesc is nullptr");
+        return E_INVALIDARG;
+    }
+    if (!ppBlendState) {
+        ERROR("Device", "CreateBlendState", "ppBlendState is nullptr");
+        return E_POINTER;
+    }
+    HRESULT hr = m_device->CreateBlendState(pBlendStateDesc, ppBlendState);
+    if (SUCCEEDED(hr)) {
+        MESSAGE("Device", "CreateBlendState", "Blend State creado correctamente.");
+    }
+    else {
+        ERROR("Device", "CreateBlendState", ("Fallo al crear Blend State. HRESULT: " + std::to_string(hr)).c_str());
+    }
+    return hr;
+}
+
+/**
+ * @brief Crea un Depth Stencil State (prueba de profundidad y stencil).
+ * @param pDepthStencilDesc Descriptor del estado.
+ * @param ppDepthStencilState Puntero donde se almacenará el estado creado.
+ * @return HRESULT indicando éxito o fallo.
+ */
+HRESULT
+Device::CreateDepthStencilState(const D3D11_DEPTH_STENCIL_DESC* pDepthStencilDesc,
+    ID3D11DepthStencilState** ppDepthStencilState) {
+    if (!pDepthStencilDesc) {
+        ERROR("Device", "CreateDepthStencilState", "pDepthStencilDesc is nullptr");
+        return E_INVALIDARG;
+    }
+    if (!ppDepthStencilState) {
+        ERROR("Device", "CreateDepthStencilState", "ppDepthStencilState is nullptr");
+        return E_POINTER;
+    }
+    HRESULT hr = m_device->CreateDepthStencilState(pDepthStencilDesc, ppDepthStencilState);
+    if (SUCCEEDED(hr)) {
+        MESSAGE("Device", "CreateDepthStencilState", "Depth Stencil State creado correctamente.");
+    }
+    else {
+        ERROR("Device", "CreateDepthStencilState", ("Fallo al crear Depth Stencil State. HRESULT: " + std::to_string(hr)).c_str());
+    }
+    return hr;
+}
+
+/**
+ * @brief Crea un Rasterizer State (culling, relleno, depth clip).
+ * @param pRasterizerDesc Descriptor del rasterizador.
+ * @param ppRasterizerState Puntero donde se almacenará el estado creado.
+ * @return HRESULT indicando éxito o fallo.
+ */
+HRESULT
+Device::CreateRasterizerState(const D3D11_RASTERIZER_DESC* pRasterizerDesc,
+    ID3D11RasterizerState** ppRasterizerState) {
+    if (!pRasterizerDesc) {
+        ERROR("Device", "CreateRasterizerState", "pRasterizerDesc is nullptr");
+        return E_INVALIDARG;
+    }
+    if (!ppRasterizerState) {
+        ERROR("Device", "CreateRasterizerState", "ppRasterizerState is nullptr");
+        return E_POINTER;
+    }
+    HRESULT hr = m_device->CreateRasterizerState(pRasterizerDesc, ppRasterizerState);
+    if (SUCCEEDED(hr)) {
+        MESSAGE("Device", "CreateRasterizerState", "Rasterizer State creado correctamente.");
+    }
+    else {
+        ERROR("Device", "CreateRasterizerState", ("Fallo al crear Rasterizer State. HRESULT: " + std::to_string(hr)).c_str());
+    }
+    return hr;
+}
+
+/**
+ * @brief Consulta los niveles de calidad MSAA de un formato.
+ * @param Format Formato del render target o depth buffer.
+ * @param SampleCount Muestras por píxel.
+ * @param pNumQualityLevels Recibe los niveles (0 si la combinación no se admite).
+ * @return HRESULT indicando éxito o fallo.
+ */
+HRESULT
+Device::CheckMultisampleQualityLevels(DXGI_FORMAT Format,
+    unsigned int SampleCount,
+    unsigned int* pNumQualityLevels) {
+    if (!pNumQualityLevels) {
+        ERROR("Device", "CheckMultisampleQualityLevels", "pNumQualityLevels is nullptr");
+        return E_POINTER;
+    }
+    *pNumQualityLevels = 0;
+    return m_device->CheckMultisampleQualityLevels(Format, SampleCount, pNumQualityLevels);
+}
+
+/**
+ * @brief Sampler compartido: mismo descriptor → mismo objeto, sin llamar a D3D11.
+ */
+HRESULT
+Device::CreateSharedSamplerState(const D3D11_SAMPLER_DESC* pSamplerDesc,
+    ID3D11SamplerState** ppSamplerState) {
+    if (!pSamplerDesc) {
+        ERROR("Device", "CreateSharedSamplerState", "pSamplerDesc is nullptr");
+        return E_INVALIDARG;
+    }
+    return m_stateCache->getSamplerState(*this, *pSamplerDesc, ppSamplerState);
+}
+
+/**
+ * @brief Blend state compartido.
+ */
+HRESULT
+Device::CreateSharedBlendState(const D3D11_BLEND_DESC* pBlendStateDesc,
+    ID3D11BlendState** ppBlendState) {
+    if (!pBlendStateDesc) {
+        ERROR("Device", "CreateSharedBlendState", "pBlendStateDesc is nullptr");
+        return E_INVALIDARG;
+    }
+    return m_stateCache->getBlendState(*this, *pBlendStateDesc, ppBlendState);
+}
+
+/**
+ * @brief Depth/stencil state compartido.
+ */
+HRESULT
+Device::CreateSharedDepthStencilState(const D3D11_DEPTH_STENCIL_DESC* pDepthStencilDesc,
+    ID3D11DepthStencilState** ppDepthStencilState) {
+    if (!pDepthStencilDesc) {
+        ERROR("Device", "CreateSharedDepthStencilState", "pDepthStencilDesc is nullptr");
+        return E_INVALIDARG;
+    }
+    return m_stateCache->getDepthStencilState(*this, *pDepthStencilDesc, ppDepthStencilState);
+}
 
-     void
-     Device::destroy() {
-     /** @brief Libera el dispositivo principal de DirectX 11. */
-     SAFE_RELEASE(m_device);
- }
-
- /**
-  * @brief Crea un Render Target View para el pipeline de renderizado.
-  * @param pResource Recurso de DirectX (generalmente una textura de back buffer).
-  * @param pDesc Descriptor opcional del RTV. Si es nullptr, usa configuración por defecto.
-  * @param ppRTView Puntero donde se almacenará la interfaz creada.
-  * @return HRESULT indicando éxito o fallo.
-  *
-  * @note Un Render Target View es donde la GPU dibuja la imagen final antes de enviarla a pantalla.
-  */
- HRESULT
-     Device::CreateRenderTargetView(ID3D11Resource* pResource,
-         const D3D11_RENDER_TARGET_VIEW_DESC* pDesc,
-         ID3D11RenderTargetView** ppRTView) {
-     if (!pResource) {
-         ERROR("Device", "CreateRenderTargetView", "pResource is nullptr");
-         return E_INVALIDARG;
-     }
-     if (!ppRTView) {
-         ERROR("Device", "CreateRenderTargetView", "ppRTView is nullptr");
-         return E_POINTER;
-     }
-     HRESULT hr = m_device->CreateRenderTargetView(pResource, pDesc, ppRTView);
-     if (SUCCEEDED(hr)) {
-         MESSAGE("Device", "CreateRenderTargetView", "Render Target View creado correctamente.");
-     }
-     else {
-         ERROR("Device", "CreateRenderTargetView", ("Fallo al crear RTV. HRESULT: " + std::to_string(hr)).c_str());
-     }
-     return hr;
- }
-
- /**
-  * @brief Crea una textura 2D en GPU.
-  * @param pDesc Descriptor de la textura (dimensiones, formato, etc.).
-  * @param pInitialData Datos iniciales opcionales.
-  * @param ppTexture2D Puntero donde se almacenará la textura creada.
-  * @return HRESULT indicando éxito o fallo.
-  *
-  * @note En videojuegos, las texturas 2D pueden ser usadas para mapas de color, normales, iluminación, etc.
-  */
- HRESULT
-     Device::CreateTexture2D(const D3D11_TEXTURE2D_DESC* pDesc,
-         const D3D11_SUBRESOURCE_DATA* pInitialData,
-         ID3D11Texture2D** ppTexture2D) {
-     if (!pDesc) {
-         ERROR("Device", "CreateTexture2D", "pDesc is nullptr");
-         return E_INVALIDARG;
-     }
-     if (!ppTexture2D) {
-         ERROR("Device", "CreateTexture2D", "ppTexture2D is nullptr");
-         return E_POINTER;
-     }
-     HRESULT hr = m_device->CreateTexture2D(pDesc, pInitialData, ppTexture2D);
-     if (SUCCEEDED(hr)) {
-         MESSAGE("Device", "CreateTexture2D", "Texture2D creada correctamente.");
-     }
-     else {
-         ERROR("Device", "CreateTexture2D", ("Fallo al crear textura. HRESULT: " + std::to_string(hr)).c_str());
-     }
-     return hr;
- }
-
- /**
-  * @brief Crea un Depth Stencil View para control de profundidad y stencil.
-  * @param pResource Recurso asociado (generalmente una textura de profundidad).
-  * @param pDesc Descriptor del DSV.
-  * @param ppDepthStencilView Puntero donde se almacenará la vista creada.
-  * @return HRESULT indicando éxito o fallo.
-  *
-  * @note El Depth Stencil es vital para evitar que objetos lejanos se dibujen encima de cercanos.
-  */
- HRESULT
-     Device::CreateDepthStencilView(ID3D11Resource* pResource,
-         const D3D11_DEPTH_STENCIL_VIEW_DESC* pDesc,
-         ID3D11DepthStencilView** ppDepthStencilView) {
-     if (!pResource) {
-         ERROR("Device", "CreateDepthStencilView", "pResource is nullptr");
-         return E_INVALIDARG;
-     }
-     if (!ppDepthStencilView) {
-         ERROR("Device", "CreateDepthStencilView", "ppDepthStencilView is nullptr");
-         return E_POINTER;
-     }
-     HRESULT hr = m_device->CreateDepthStencilView(pResource, pDesc, ppDepthStencilView);
-     if (SUCCEEDED(hr)) {
-         MESSAGE("Device", "CreateDepthStencilView", "Depth Stencil View creado correctamente.");
-     }
-     else {
-         ERROR("Device", "CreateDepthStencilView", ("Fallo al crear DSV. HRESULT: " + std::to_string(hr)).c_str());
-     }
-     return hr;
- }
-
- // ... 📌 Aquí seguirías documentando con el mismo formato
- // para CreateVertexShader, CreateInputLayout, CreatePixelShader,
- // CreateSamplerState, CreateBuffer, CreateBlendState, CreateDepthStencilState y CreateRasterizerState.
- // La idea es incluir:
- // - Qué recurso crea.
- // - Para qué se usa en un motor de videojuegos.
- // - Validaciones.
- // - Ejemplo corto si es útil.
- // - Notas o advertencias clave.
+/**
+ * @brief Rasterizer state compartido.
+ */
+HRESULT
+Device::CreateSharedRasterizerState(const D3D11_RASTERIZER_DESC* pRasterizerDesc,
+    ID3D11RasterizerState** ppRasterizerState) {
+    if (!pRasterizerDesc) {
+        ERROR("Device", "CreateSharedRasterizerState", "pRasterizerDesc is nullptr");
+        return E_INVALIDARG;
+    }
+    return m_stateCache->getRasterizerState(*this, *pRasterizerDesc, ppRasterizerState);
+}
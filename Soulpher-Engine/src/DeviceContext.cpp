@@ -17,6 +17,109 @@
  */
 
 #include "DeviceContext.h"
+#include "StallDetector.h"
+#include <cstring>
+#include <thread>
+
+// El SDK de junio 2010 no trae d3d11_1.h: se declara la interfaz de marcadores
+// (idntica a la del runtime 11.1) para poder pedirla con QueryInterface.
+#ifndef __ID3DUserDefinedAnnotation_INTERFACE_DEFINED__
+MIDL_INTERFACE("b2daad8b-03d4-4dbf-95eb-32ab4b63d0ab")
+ID3DUserDefinedAnnotation : public IUnknown {
+public:
+    virtual INT STDMETHODCALLTYPE BeginEvent(LPCWSTR Name) = 0;
+    virtual INT STDMETHODCALLTYPE EndEvent() = 0;
+    virtual void STDMETHODCALLTYPE SetMarker(LPCWSTR Name) = 0;
+    virtual BOOL STDMETHODCALLTYPE GetStatus() = 0;
+};
+#endif
+
+// Longitud mxima (con terminador) de un nombre de evento; los largos se recortan.
+static const int kMaxEventName = 128;
+
+template<typename T>
+bool DeviceContext::filterSlots(T* cache, unsigned int cacheSize, unsigned int startSlot,
+    unsigned int count, T const* values) {
+    // Solo se puede omitir si todo el rango cae dentro de la cach y coincide.
+    bool same = (startSlot + count) <= cacheSize;
+    for (unsigned int i = 0; i < count && (startSlot + i) < cacheSize; ++i) {
+        if (std::memcmp(&cache[startSlot + i], &values[i], sizeof(T)) != 0) {
+            same = false;
+            cache[startSlot + i] = values[i];
+        }
+    }
+    return same && m_filterState;
+}
+
+/**
+ * @brief Publica los contadores del frame (draws, binds, bytes) e invalida la cach.
+ */
+void DeviceContext::update() {
+    // Los marcadores solo cambian entre frames y solo cuestan algo si alguien escucha.
+    while (m_openEvents > 0) {
+        endEvent(); // Un pase que sali antes de tiempo no puede dejar eventos abiertos.
+    }
+    bool listening = false;
+    if (m_annotation) {
+        listening = m_annotation->GetStatus() != FALSE;
+    }
+    else if (m_perfGetStatus) {
+        listening = m_perfGetStatus() != 0;
+    }
+    m_eventMarkersActive = m_eventMarkersRequested && listening;
+
+    m_lastFrameStats = m_stats;
+    m_stats = RenderStats();
+    invalidateStateCache();
+}
+
+/**
+ * @brief Marca todo el estado como desconocido (ver `BoundState`).
+ */
+void DeviceContext::invalidateStateCache() {
+    std::memset(&m_bound, 0xFF, sizeof(m_bound));
+}
+
+/**
+ * @brief Cuenta un draw: ndices totales y primitivas segn la topologa enlazada.
+ */
+void DeviceContext::countDraw(unsigned int indexCount, unsigned int instanceCount) {
+    unsigned long long primitives = 0;
+    switch (m_topology) {
+    case D3D11_PRIMITIVE_TOPOLOGY_POINTLIST:     primitives = indexCount; break;
+    case D3D11_PRIMITIVE_TOPOLOGY_LINELIST:      primitives = indexCount / 2; break;
+    case D3D11_PRIMITIVE_TOPOLOGY_LINESTRIP:     primitives = indexCount > 1 ? indexCount - 1 : 0; break;
+    case D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST:  primitives = indexCount / 3; break;
+    case D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP: primitives = indexCount > 2 ? indexCount - 2 : 0; break;
+    case D3D11_PRIMITIVE_TOPOLOGY_3_CONTROL_POINT_PATCHLIST: primitives = indexCount / 3; break; // antes de teselar
+    default: break; // Adyacencia: no se usa en el motor.
+    }
+    ++m_stats.drawCalls;
+    m_stats.indices += static_cast<unsigned long long>(indexCount) * instanceCount;
+    m_stats.primitives += primitives * instanceCount;
+}
+
+const char* DeviceContext::getStateCategoryName(StateCategory category) {
+    static const char* kNames[STATE_CATEGORY_COUNT] = {
+        "Shaders", "Input layouts", "Vertex buffers", "Index buffers", "Topology",
+        "Constant buffers", "Shader resources", "Samplers", "Rasterizer", "Blend",
+        "Depth/stencil", "Render targets", "Viewports"
+    };
+    return category < STATE_CATEGORY_COUNT ? kNames[category] : "?";
+}
+
+/**
+ * @brief Restablece el pipeline completo y la cach de estado.
+ */
+void DeviceContext::ClearState() {
+    if (!m_deviceContext) {
+        ERROR("DeviceContext", "ClearState", "m_deviceContext is nullptr");
+        return;
+    }
+    m_deviceContext->ClearState();
+    m_topology = D3D11_PRIMITIVE_TOPOLOGY_UNDEFINED;
+    invalidateStateCache();
+}
 
  /**
   * @brief Libera el contexto de dispositivo.
@@ -24,9 +127,225 @@
   * @note Se debe llamar antes de cerrar la aplicacin para evitar fugas de memoria.
   */
 void DeviceContext::destroy() {
+    SAFE_RELEASE(m_annotation);
+    if (m_d3d9) {
+        FreeLibrary(m_d3d9);
+        m_d3d9 = nullptr;
+    }
+    m_perfBeginEvent = nullptr;
+    m_perfEndEvent = nullptr;
+    m_perfGetStatus = nullptr;
+    m_eventMarkersActive = false;
+    m_deferred = false;
     SAFE_RELEASE(m_deviceContext);
 }
 
+/**
+ * @brief Obtiene la interfaz de marcadores (11.1) o, en su defecto, `D3DPERF_*` de d3d9.dll.
+ *
+ * @note d3d9.dll se carga en tiempo de ejecucin para no enlazar d3d9.lib solo por esto.
+ */
+void DeviceContext::init() {
+    if (!m_deviceContext) {
+        ERROR("DeviceContext", "init", "m_deviceContext is nullptr");
+        return;
+    }
+    if (SUCCEEDED(m_deviceContext->QueryInterface(__uuidof(ID3DUserDefinedAnnotation),
+        reinterpret_cast<void**>(&m_annotation)))) {
+        return;
+    }
+    m_annotation = nullptr;
+
+    m_d3d9 = LoadLibraryW(L"d3d9.dll");
+    if (m_d3d9) {
+        m_perfBeginEvent = reinterpret_cast<PerfBeginEventFn>(GetProcAddress(m_d3d9, "D3DPERF_BeginEvent"));
+        m_perfEndEvent = reinterpret_cast<PerfEndEventFn>(GetProcAddress(m_d3d9, "D3DPERF_EndEvent"));
+        m_perfGetStatus = reinterpret_cast<PerfGetStatusFn>(GetProcAddress(m_d3d9, "D3DPERF_GetStatus"));
+    }
+    if (!m_perfBeginEvent || !m_perfEndEvent || !m_perfGetStatus) {
+        MESSAGE("DeviceContext", "init", "No GPU event marker API available.");
+        m_perfBeginEvent = nullptr;
+        m_perfEndEvent = nullptr;
+        m_perfGetStatus = nullptr;
+    }
+}
+
+/**
+ * @brief Crea un contexto diferido; no busca marcadores (solo existen en el inmediato).
+ */
+HRESULT DeviceContext::initDeferred(ID3D11Device* device) {
+    if (!device) {
+        ERROR("DeviceContext", "initDeferred", "device is nullptr");
+        return E_POINTER;
+    }
+    destroy();
+    HRESULT hr = device->CreateDeferredContext(0, &m_deviceContext);
+    if (FAILED(hr)) {
+        ERROR("DeviceContext", "initDeferred", ("CreateDeferredContext failed. hr=" + std::to_string(hr)).c_str());
+        return hr;
+    }
+    m_deferred = true;
+    m_topology = D3D11_PRIMITIVE_TOPOLOGY_UNDEFINED;
+    invalidateStateCache();
+    return S_OK;
+}
+
+/**
+ * @brief Lee el estado del inmediato con los `*Get*` de D3D11 (que suman referencias)
+ * y lo enlaza aqu directamente, sin pasar por la cach.
+ */
+void DeviceContext::inheritState(DeviceContext& source) {
+    ID3D11DeviceContext* from = source.m_deviceContext;
+    if (!from || !m_deviceContext) {
+        ERROR("DeviceContext", "inheritState", "m_deviceContext is nullptr");
+        return;
+    }
+
+    ID3D11RenderTargetView* targets[D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT] = {};
+    ID3D11DepthStencilView* depthView = nullptr;
+    from->OMGetRenderTargets(D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT, targets, &depthView);
+    m_deviceContext->OMSetRenderTargets(D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT, targets, depthView);
+    for (ID3D11RenderTargetView*& target : targets) {
+        SAFE_RELEASE(target);
+    }
+    SAFE_RELEASE(depthView);
+
+    D3D11_VIEWPORT viewports[D3D11_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE];
+    UINT viewportCount = D3D11_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE;
+    from->RSGetViewports(&viewportCount, viewports);
+    m_deviceContext->RSSetViewports(viewportCount, viewports);
+
+    ID3D11RasterizerState* rasterizer = nullptr;
+    from->RSGetState(&rasterizer);
+    m_deviceContext->RSSetState(rasterizer);
+    SAFE_RELEASE(rasterizer);
+
+    ID3D11BlendState* blend = nullptr;
+    float blendFactor[4];
+    UINT sampleMask = 0;
+    from->OMGetBlendState(&blend, blendFactor, &sampleMask);
+    m_deviceContext->OMSetBlendState(blend, blendFactor, sampleMask);
+    SAFE_RELEASE(blend);
+
+    ID3D11DepthStencilState* depth = nullptr;
+    UINT stencilRef = 0;
+    from->OMGetDepthStencilState(&depth, &stencilRef);
+    m_deviceContext->OMSetDepthStencilState(depth, stencilRef);
+    SAFE_RELEASE(depth);
+
+    ID3D11Buffer* buffers[kCachedConstantBufferSlots] = {};
+    from->VSGetConstantBuffers(0, kCachedConstantBufferSlots, buffers);
+    m_deviceContext->VSSetConstantBuffers(0, kCachedConstantBufferSlots, buffers);
+    for (ID3D11Buffer*& buffer : buffers) {
+        SAFE_RELEASE(buffer);
+    }
+    from->PSGetConstantBuffers(0, kCachedConstantBufferSlots, buffers);
+    m_deviceContext->PSSetConstantBuffers(0, kCachedConstantBufferSlots, buffers);
+    for (ID3D11Buffer*& buffer : buffers) {
+        SAFE_RELEASE(buffer);
+    }
+
+    ID3D11ShaderResourceView* views[kCachedResourceSlots] = {};
+    from->PSGetShaderResources(0, kCachedResourceSlots, views);
+    m_deviceContext->PSSetShaderResources(0, kCachedResourceSlots, views);
+    for (ID3D11ShaderResourceView*& view : views) {
+        SAFE_RELEASE(view);
+    }
+    ID3D11SamplerState* samplers[kCachedResourceSlots] = {};
+    from->PSGetSamplers(0, kCachedResourceSlots, samplers);
+    m_deviceContext->PSSetSamplers(0, kCachedResourceSlots, samplers);
+    for (ID3D11SamplerState*& sampler : samplers) {
+        SAFE_RELEASE(sampler);
+    }
+
+    // Lo dems (shaders, IA, topologa) lo enlaza cada paquete: la cach empieza vaca.
+    m_topology = D3D11_PRIMITIVE_TOPOLOGY_UNDEFINED;
+    invalidateStateCache();
+}
+
+HRESULT DeviceContext::FinishCommandList(ID3D11CommandList** ppCommandList) {
+    if (!m_deviceContext || !m_deferred) {
+        ERROR("DeviceContext", "FinishCommandList", "Not a deferred context");
+        return E_FAIL;
+    }
+    HRESULT hr = m_deviceContext->FinishCommandList(FALSE, ppCommandList);
+    m_topology = D3D11_PRIMITIVE_TOPOLOGY_UNDEFINED;
+    invalidateStateCache();
+    return hr;
+}
+
+void DeviceContext::ExecuteCommandList(ID3D11CommandList* pCommandList, bool restoreState) {
+    if (!m_deviceContext || !pCommandList) {
+        ERROR("DeviceContext", "ExecuteCommandList", "m_deviceContext or pCommandList is nullptr");
+        return;
+    }
+    m_deviceContext->ExecuteCommandList(pCommandList, restoreState ? TRUE : FALSE);
+    ++m_stats.commandLists;
+    if (!restoreState) {
+        // Sin restaurar, el contexto queda en el estado por defecto.
+        m_topology = D3D11_PRIMITIVE_TOPOLOGY_UNDEFINED;
+        invalidateStateCache();
+    }
+}
+
+void DeviceContext::mergeStats(DeviceContext& other) {
+    const RenderStats& from = other.m_stats;
+    m_stats.drawCalls += from.drawCalls;
+    m_stats.indices += from.indices;
+    m_stats.primitives += from.primitives;
+    for (int c = 0; c < STATE_CATEGORY_COUNT; ++c) {
+        m_stats.stateChanges[c] += from.stateChanges[c];
+    }
+    m_stats.filteredCalls += from.filteredCalls;
+    m_stats.shaderResourceBinds += from.shaderResourceBinds;
+    m_stats.constantBufferBytes += from.constantBufferBytes;
+    m_stats.uploadBytes += from.uploadBytes;
+    m_stats.commandLists += from.commandLists;
+    other.m_stats = RenderStats();
+}
+
+/**
+ * @brief Abre un evento: copia el nombre a UTF-16 en la pila (sin reservar memoria).
+ *
+ * @note Los nombres son ASCII/Latin-1, as que basta con ensanchar cada byte.
+ */
+void DeviceContext::beginEvent(const char* name) {
+    if (!m_eventMarkersActive || !name) {
+        return;
+    }
+    wchar_t wideName[kMaxEventName];
+    int length = 0;
+    while (length < kMaxEventName - 1 && name[length]) {
+        wideName[length] = static_cast<wchar_t>(static_cast<unsigned char>(name[length]));
+        ++length;
+    }
+    wideName[length] = L'\0';
+
+    if (m_annotation) {
+        m_annotation->BeginEvent(wideName);
+    }
+    else {
+        m_perfBeginEvent(0xFFFFFFFF, wideName);
+    }
+    ++m_openEvents;
+}
+
+/**
+ * @brief Cierra un evento; ignora cierres sin apertura (marcadores apagados al abrir).
+ */
+void DeviceContext::endEvent() {
+    if (m_openEvents == 0) {
+        return;
+    }
+    --m_openEvents;
+    if (m_annotation) {
+        m_annotation->EndEvent();
+    }
+    else if (m_perfEndEvent) {
+        m_perfEndEvent();
+    }
+}
+
 /**
  * @brief Configura los viewports para el rasterizador.
  * @param NumViewports Nmero de viewports a establecer.
@@ -41,6 +360,7 @@ void DeviceContext::RSSetViewports(unsigned int NumViewports,
         return;
     }
     m_deviceContext->RSSetViewports(NumViewports, pViewports);
+    ++m_stats.stateChanges[STATE_VIEWPORT];
 }
 
 /**
@@ -58,7 +378,39 @@ void DeviceContext::PSSetShaderResources(unsigned int StartSlot,
         ERROR("DeviceContext", "PSSetShaderResources", "ppShaderResourceViews is nullptr");
         return;
     }
+    if (filterSlots(m_bound.psResources, kCachedResourceSlots, StartSlot, NumViews, ppShaderResourceViews)) {
+        ++m_stats.filteredCalls;
+        return;
+    }
     m_deviceContext->PSSetShaderResources(StartSlot, NumViews, ppShaderResourceViews);
+    ++m_stats.stateChanges[STATE_SHADER_RESOURCE];
+    m_stats.shaderResourceBinds += NumViews;
+}
+
+/**
+ * @brief Asigna SRVs al vertex shader.
+ */
+void DeviceContext::VSSetShaderResources(unsigned int StartSlot,
+    unsigned int NumViews,
+    ID3D11ShaderResourceView* const* ppShaderResourceViews) {
+    if (!ppShaderResourceViews) {
+        ERROR("DeviceContext", "VSSetShaderResources", "ppShaderResourceViews is nullptr");
+        return;
+    }
+    m_deviceContext->VSSetShaderResources(StartSlot, NumViews, ppShaderResourceViews);
+}
+
+/**
+ * @brief Asigna estados de muestreo para el Vertex Shader.
+ */
+void DeviceContext::VSSetSamplers(unsigned int StartSlot,
+    unsigned int NumSamplers,
+    ID3D11SamplerState* const* ppSamplers) {
+    if (!ppSamplers) {
+        ERROR("DeviceContext", "VSSetSamplers", "ppSamplers is nullptr");
+        return;
+    }
+    m_deviceContext->VSSetSamplers(StartSlot, NumSamplers, ppSamplers);
 }
 
 /**
@@ -66,42 +418,61 @@ void DeviceContext::PSSetShaderResources(unsigned int StartSlot,
  * @param pInputLayout Layout que describe el formato de los vrtices.
  *
  * @note Debe coincidir con la estructura de vrtices usada en el Vertex Shader.
+ * Nulo es vlido: shaders sin entrada de vrtices (solo `SV_VertexID`).
  */
 void DeviceContext::IASetInputLayout(ID3D11InputLayout* pInputLayout) {
-    if (!pInputLayout) {
-        ERROR("DeviceContext", "IASetInputLayout", "pInputLayout is nullptr");
+    if (m_filterState && m_bound.inputLayout == pInputLayout) {
+        ++m_stats.filteredCalls;
         return;
     }
+    m_bound.inputLayout = pInputLayout;
     m_deviceContext->IASetInputLayout(pInputLayout);
+    ++m_stats.stateChanges[STATE_INPUT_LAYOUT];
 }
 
 /**
  * @brief Asigna el Vertex Shader activo.
- * @param pVertexShader Shader de vrtices.
+ * @param pVertexShader Shader de vrtices (`nullptr` desactiva la etapa).
  * @param ppClassInstances Instancias de clases para shaders (opcional).
  * @param NumClassInstances Nmero de instancias.
  */
 void DeviceContext::VSSetShader(ID3D11VertexShader* pVertexShader,
     ID3D11ClassInstance* const* ppClassInstances,
     unsigned int NumClassInstances) {
-    if (!pVertexShader) {
-        ERROR("DeviceContext", "VSSetShader", "pVertexShader is nullptr");
+    if (!m_deviceContext) {
+        ERROR("DeviceContext", "VSSetShader", "m_deviceContext is nullptr");
         return;
     }
+    // Con class instances el estado no se puede comparar solo por puntero.
+    if (NumClassInstances == 0 && m_filterState && m_bound.vertexShader == pVertexShader) {
+        ++m_stats.filteredCalls;
+        return;
+    }
+    m_bound.vertexShader = NumClassInstances == 0 ? pVertexShader
+                                                  : reinterpret_cast<ID3D11VertexShader*>(~uintptr_t(0));
     m_deviceContext->VSSetShader(pVertexShader, ppClassInstances, NumClassInstances);
+    ++m_stats.stateChanges[STATE_SHADER];
 }
 
 /**
  * @brief Asigna el Pixel Shader activo.
+ * @param pPixelShader Shader de pxeles (`nullptr` = pase solo de profundidad).
  */
 void DeviceContext::PSSetShader(ID3D11PixelShader* pPixelShader,
     ID3D11ClassInstance* const* ppClassInstances,
     unsigned int NumClassInstances) {
-    if (!pPixelShader) {
-        ERROR("DeviceContext", "PSSetShader", "pPixelShader is nullptr");
+    if (!m_deviceContext) {
+        ERROR("DeviceContext", "PSSetShader", "m_deviceContext is nullptr");
         return;
     }
+    if (NumClassInstances == 0 && m_filterState && m_bound.pixelShader == pPixelShader) {
+        ++m_stats.filteredCalls;
+        return;
+    }
+    m_bound.pixelShader = NumClassInstances == 0 ? pPixelShader
+                                                 : reinterpret_cast<ID3D11PixelShader*>(~uintptr_t(0));
     m_deviceContext->PSSetShader(pPixelShader, ppClassInstances, NumClassInstances);
+    ++m_stats.stateChanges[STATE_SHADER];
 }
 
 /**
@@ -118,13 +489,31 @@ void DeviceContext::UpdateSubresource(ID3D11Resource* pDstResource,
     const D3D11_BOX* pDstBox,
     const void* pSrcData,
     unsigned int SrcRowPitch,
-    unsigned int SrcDepthPitch) {
+    unsigned int SrcDepthPitch,
+    const std::source_location& location) {
     if (!pDstResource || !pSrcData) {
         ERROR("DeviceContext", "UpdateSubresource",
             "Invalid arguments: pDstResource or pSrcData is nullptr");
         return;
     }
-    m_deviceContext->UpdateSubresource(pDstResource, DstSubresource, pDstBox, pSrcData, SrcRowPitch, SrcDepthPitch);
+    {
+        // Si la GPU an lee el recurso, el driver copia los datos (o el recurso) aqu.
+        StallDetector::Scope stall(STALL_UPDATE_SUBRESOURCE, pDstResource, location);
+        m_deviceContext->UpdateSubresource(pDstResource, DstSubresource, pDstBox, pSrcData, SrcRowPitch, SrcDepthPitch);
+    }
+
+    // Bytes subidos: para buffers, la caja o el buffer entero; para texturas, los pitch.
+    D3D11_RESOURCE_DIMENSION dimension;
+    pDstResource->GetType(&dimension);
+    if (dimension == D3D11_RESOURCE_DIMENSION_BUFFER) {
+        D3D11_BUFFER_DESC desc;
+        static_cast<ID3D11Buffer*>(pDstResource)->GetDesc(&desc);
+        addUploadBytes(pDstBox ? (pDstBox->right - pDstBox->left) : desc.ByteWidth,
+            (desc.BindFlags & D3D11_BIND_CONSTANT_BUFFER) != 0);
+    }
+    else {
+        addUploadBytes(SrcDepthPitch ? SrcDepthPitch : SrcRowPitch);
+    }
 }
 
 /**
@@ -140,7 +529,19 @@ void DeviceContext::IASetVertexBuffers(unsigned int StartSlot,
             "Invalid arguments: ppVertexBuffers, pStrides, or pOffsets is nullptr");
         return;
     }
+    // Se evalan los tres rangos para que la cach quede completa.
+    const bool sameBuffers = filterSlots(m_bound.vertexBuffers, kCachedVertexBufferSlots,
+        StartSlot, NumBuffers, ppVertexBuffers);
+    const bool sameStrides = filterSlots(m_bound.vertexStrides, kCachedVertexBufferSlots,
+        StartSlot, NumBuffers, pStrides);
+    const bool sameOffsets = filterSlots(m_bound.vertexOffsets, kCachedVertexBufferSlots,
+        StartSlot, NumBuffers, pOffsets);
+    if (sameBuffers && sameStrides && sameOffsets) {
+        ++m_stats.filteredCalls;
+        return;
+    }
     m_deviceContext->IASetVertexBuffers(StartSlot, NumBuffers, ppVertexBuffers, pStrides, pOffsets);
+    ++m_stats.stateChanges[STATE_VERTEX_BUFFER];
 }
 
 /**
@@ -153,7 +554,16 @@ void DeviceContext::IASetIndexBuffer(ID3D11Buffer* pIndexBuffer,
         ERROR("DeviceContext", "IASetIndexBuffer", "pIndexBuffer is nullptr");
         return;
     }
+    if (m_filterState && m_bound.indexBuffer == pIndexBuffer &&
+        m_bound.indexFormat == Format && m_bound.indexOffset == Offset) {
+        ++m_stats.filteredCalls;
+        return;
+    }
+    m_bound.indexBuffer = pIndexBuffer;
+    m_bound.indexFormat = Format;
+    m_bound.indexOffset = Offset;
     m_deviceContext->IASetIndexBuffer(pIndexBuffer, Format, Offset);
+    ++m_stats.stateChanges[STATE_INDEX_BUFFER];
 }
 
 /**
@@ -166,7 +576,12 @@ void DeviceContext::PSSetSamplers(unsigned int StartSlot,
         ERROR("DeviceContext", "PSSetSamplers", "ppSamplers is nullptr");
         return;
     }
+    if (filterSlots(m_bound.psSamplers, kCachedResourceSlots, StartSlot, NumSamplers, ppSamplers)) {
+        ++m_stats.filteredCalls;
+        return;
+    }
     m_deviceContext->PSSetSamplers(StartSlot, NumSamplers, ppSamplers);
+    ++m_stats.stateChanges[STATE_SAMPLER];
 }
 
 /**
@@ -177,20 +592,61 @@ void DeviceContext::RSSetState(ID3D11RasterizerState* pRasterizerState) {
         ERROR("DeviceContext", "RSSetState", "pRasterizerState is nullptr");
         return;
     }
+    if (m_filterState && m_bound.rasterizerState == pRasterizerState) {
+        ++m_stats.filteredCalls;
+        return;
+    }
+    m_bound.rasterizerState = pRasterizerState;
     m_deviceContext->RSSetState(pRasterizerState);
+    ++m_stats.stateChanges[STATE_RASTERIZER];
 }
 
 /**
  * @brief Configura el estado de mezcla de color.
+ *
+ * @note `pBlendState == nullptr` restablece el estado por defecto (blending off).
  */
 void DeviceContext::OMSetBlendState(ID3D11BlendState* pBlendState,
     const float BlendFactor[4],
     unsigned int SampleMask) {
-    if (!pBlendState) {
-        ERROR("DeviceContext", "OMSetBlendState", "pBlendState is nullptr");
+    if (!m_deviceContext) {
+        ERROR("DeviceContext", "OMSetBlendState", "m_deviceContext is nullptr");
         return;
     }
+    static const float kDefaultFactor[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    const float* factor = BlendFactor ? BlendFactor : kDefaultFactor;
+    if (m_filterState && m_bound.blendState == pBlendState && m_bound.sampleMask == SampleMask &&
+        std::memcmp(m_bound.blendFactor, factor, sizeof(m_bound.blendFactor)) == 0) {
+        ++m_stats.filteredCalls;
+        return;
+    }
+    m_bound.blendState = pBlendState;
+    m_bound.sampleMask = SampleMask;
+    std::memcpy(m_bound.blendFactor, factor, sizeof(m_bound.blendFactor));
     m_deviceContext->OMSetBlendState(pBlendState, BlendFactor, SampleMask);
+    ++m_stats.stateChanges[STATE_BLEND];
+}
+
+/**
+ * @brief Configura el estado de profundidad/stencil.
+ *
+ * @note `pDepthStencilState == nullptr` restablece el estado por defecto.
+ */
+void DeviceContext::OMSetDepthStencilState(ID3D11DepthStencilState* pDepthStencilState,
+    unsigned int StencilRef) {
+    if (!m_deviceContext) {
+        ERROR("DeviceContext", "OMSetDepthStencilState", "m_deviceContext is nullptr");
+        return;
+    }
+    if (m_filterState && m_bound.depthStencilState == pDepthStencilState &&
+        m_bound.stencilRef == StencilRef) {
+        ++m_stats.filteredCalls;
+        return;
+    }
+    m_bound.depthStencilState = pDepthStencilState;
+    m_bound.stencilRef = StencilRef;
+    m_deviceContext->OMSetDepthStencilState(pDepthStencilState, StencilRef);
+    ++m_stats.stateChanges[STATE_DEPTH_STENCIL];
 }
 
 /**
@@ -199,17 +655,16 @@ void DeviceContext::OMSetBlendState(ID3D11BlendState* pBlendState,
 void DeviceContext::OMSetRenderTargets(unsigned int NumViews,
     ID3D11RenderTargetView* const* ppRenderTargetViews,
     ID3D11DepthStencilView* pDepthStencilView) {
-    if (!ppRenderTargetViews && !pDepthStencilView) {
-        ERROR("DeviceContext", "OMSetRenderTargets",
-            "Both ppRenderTargetViews and pDepthStencilView are nullptr");
-        return;
-    }
+    // (0, nullptr, nullptr) es vlido: desenlaza todo (p. ej. para leer el depth como SRV).
     if (NumViews > 0 && !ppRenderTargetViews) {
         ERROR("DeviceContext", "OMSetRenderTargets",
             "ppRenderTargetViews is nullptr, but NumViews > 0");
         return;
     }
+    // D3D11 desenlaza en silencio las SRV que pasan a ser salida: la cach de SRV deja de ser fiable.
+    std::memset(m_bound.psResources, 0xFF, sizeof(m_bound.psResources));
     m_deviceContext->OMSetRenderTargets(NumViews, ppRenderTargetViews, pDepthStencilView);
+    ++m_stats.stateChanges[STATE_RENDER_TARGET];
 }
 
 /**
@@ -223,7 +678,14 @@ void DeviceContext::IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY Topology) {
             "Topology is D3D11_PRIMITIVE_TOPOLOGY_UNDEFINED");
         return;
     }
+    m_topology = Topology;
+    if (m_filterState && m_bound.topology == Topology) {
+        ++m_stats.filteredCalls;
+        return;
+    }
+    m_bound.topology = Topology;
     m_deviceContext->IASetPrimitiveTopology(Topology);
+    ++m_stats.stateChanges[STATE_TOPOLOGY];
 }
 
 /**
@@ -271,7 +733,12 @@ void DeviceContext::VSSetConstantBuffers(unsigned int StartSlot,
         ERROR("DeviceContext", "VSSetConstantBuffers", "ppConstantBuffers is nullptr");
         return;
     }
+    if (filterSlots(m_bound.vsConstantBuffers, kCachedConstantBufferSlots, StartSlot, NumBuffers, ppConstantBuffers)) {
+        ++m_stats.filteredCalls;
+        return;
+    }
     m_deviceContext->VSSetConstantBuffers(StartSlot, NumBuffers, ppConstantBuffers);
+    ++m_stats.stateChanges[STATE_CONSTANT_BUFFER];
 }
 
 /**
@@ -284,7 +751,12 @@ void DeviceContext::PSSetConstantBuffers(unsigned int StartSlot,
         ERROR("DeviceContext", "PSSetConstantBuffers", "ppConstantBuffers is nullptr");
         return;
     }
+    if (filterSlots(m_bound.psConstantBuffers, kCachedConstantBufferSlots, StartSlot, NumBuffers, ppConstantBuffers)) {
+        ++m_stats.filteredCalls;
+        return;
+    }
     m_deviceContext->PSSetConstantBuffers(StartSlot, NumBuffers, ppConstantBuffers);
+    ++m_stats.stateChanges[STATE_CONSTANT_BUFFER];
 }
 
 /**
@@ -298,4 +770,313 @@ void DeviceContext::DrawIndexed(unsigned int IndexCount,
         return;
     }
     m_deviceContext->DrawIndexed(IndexCount, StartIndexLocation, BaseVertexLocation);
+    countDraw(IndexCount, 1);
+}
+
+/**
+ * @brief Dibuja vrtices sin index buffer (p. ej. un tringulo generado con `SV_VertexID`).
+ */
+void DeviceContext::Draw(unsigned int VertexCount, unsigned int StartVertexLocation) {
+    if (VertexCount == 0) {
+        ERROR("DeviceContext", "Draw", "VertexCount is zero");
+        return;
+    }
+    m_deviceContext->Draw(VertexCount, StartVertexLocation);
+    countDraw(VertexCount, 1);
+}
+
+/**
+ * @brief Dibuja `InstanceCount` copias de la geometra indexada.
+ *
+ * @note Los datos por instancia (slot con `D3D11_INPUT_PER_INSTANCE_DATA`)
+ * empiezan en `StartInstanceLocation`.
+ */
+void DeviceContext::DrawIndexedInstanced(unsigned int IndexCountPerInstance,
+    unsigned int InstanceCount,
+    unsigned int StartIndexLocation,
+    int BaseVertexLocation,
+    unsigned int StartInstanceLocation) {
+    if (IndexCountPerInstance == 0 || InstanceCount == 0) {
+        ERROR("DeviceContext", "DrawIndexedInstanced", "IndexCountPerInstance or InstanceCount is zero");
+        return;
+    }
+    m_deviceContext->DrawIndexedInstanced(IndexCountPerInstance, InstanceCount,
+        StartIndexLocation, BaseVertexLocation, StartInstanceLocation);
+    countDraw(IndexCountPerInstance, InstanceCount);
+}
+
+/**
+ * @brief Dibuja con argumentos escritos por la GPU (p. ej. por un compute shader de culling).
+ */
+void DeviceContext::DrawIndexedInstancedIndirect(ID3D11Buffer* pBufferForArgs,
+    unsigned int AlignedByteOffsetForArgs) {
+    if (!pBufferForArgs) {
+        ERROR("DeviceContext", "DrawIndexedInstancedIndirect", "pBufferForArgs is nullptr");
+        return;
+    }
+    m_deviceContext->DrawIndexedInstancedIndirect(pBufferForArgs, AlignedByteOffsetForArgs);
+    countDraw(0, 0);
+}
+
+void DeviceContext::DrawInstancedIndirect(ID3D11Buffer* pBufferForArgs,
+    unsigned int AlignedByteOffsetForArgs) {
+    if (!pBufferForArgs) {
+        ERROR("DeviceContext", "DrawInstancedIndirect", "pBufferForArgs is nullptr");
+        return;
+    }
+    m_deviceContext->DrawInstancedIndirect(pBufferForArgs, AlignedByteOffsetForArgs);
+    countDraw(0, 0);
+}
+
+/**
+ * @brief Mapea un recurso (buffer o textura) para lectura/escritura de CPU.
+ */
+HRESULT DeviceContext::Map(ID3D11Resource* pResource,
+    unsigned int Subresource,
+    D3D11_MAP MapType,
+    unsigned int MapFlags,
+    D3D11_MAPPED_SUBRESOURCE* pMappedResource,
+    const std::source_location& location) {
+    if (!pResource || !pMappedResource) {
+        ERROR("DeviceContext", "Map", "pResource or pMappedResource is nullptr");
+        return E_INVALIDARG;
+    }
+    if (MapFlags & D3D11_MAP_FLAG_DO_NOT_WAIT) {
+        return m_deviceContext->Map(pResource, Subresource, MapType, MapFlags, pMappedResource);
+    }
+    StallDetector::Scope stall(STALL_MAP, pResource, location);
+    return m_deviceContext->Map(pResource, Subresource, MapType, MapFlags, pMappedResource);
+}
+
+/**
+ * @brief Cierra el mapeo abierto con `Map`.
+ */
+void DeviceContext::Unmap(ID3D11Resource* pResource, unsigned int Subresource) {
+    if (!pResource) {
+        ERROR("DeviceContext", "Unmap", "pResource is nullptr");
+        return;
+    }
+    m_deviceContext->Unmap(pResource, Subresource);
+}
+
+HRESULT DeviceContext::waitForQuery(ID3D11Asynchronous* query, void* data, unsigned int size,
+    const std::source_location& location) {
+    if (!query) {
+        ERROR("DeviceContext", "waitForQuery", "query is nullptr");
+        return E_INVALIDARG;
+    }
+    StallDetector::Scope stall(STALL_GET_DATA, nullptr, location);
+    HRESULT hr;
+    while ((hr = m_deviceContext->GetData(query, data, size, 0)) == S_FALSE) {
+        std::this_thread::yield();
+    }
+    return hr;
+}
+
+/**
+ * @brief Copia una regin entre subrecursos (misma familia de formato).
+ */
+void DeviceContext::CopySubresourceRegion(ID3D11Resource* pDstResource,
+    unsigned int DstSubresource,
+    unsigned int DstX,
+    unsigned int DstY,
+    unsigned int DstZ,
+    ID3D11Resource* pSrcResource,
+    unsigned int SrcSubresource,
+    const D3D11_BOX* pSrcBox) {
+    if (!pDstResource || !pSrcResource) {
+        ERROR("DeviceContext", "CopySubresourceRegion", "pDstResource or pSrcResource is nullptr");
+        return;
+    }
+    m_deviceContext->CopySubresourceRegion(pDstResource, DstSubresource, DstX, DstY, DstZ,
+        pSrcResource, SrcSubresource, pSrcBox);
+}
+
+/**
+ * @brief Resuelve un subrecurso multimuestra (MSAA) en uno de una muestra.
+ */
+void DeviceContext::ResolveSubresource(ID3D11Resource* pDstResource,
+    unsigned int DstSubresource,
+    ID3D11Resource* pSrcResource,
+    unsigned int SrcSubresource,
+    DXGI_FORMAT Format) {
+    if (!pDstResource || !pSrcResource) {
+        ERROR("DeviceContext", "ResolveSubresource", "pDstResource or pSrcResource is nullptr");
+        return;
+    }
+    m_deviceContext->ResolveSubresource(pDstResource, DstSubresource, pSrcResource, SrcSubresource, Format);
+}
+
+/**
+ * @brief Establece el compute shader.
+ */
+void DeviceContext::CSSetShader(ID3D11ComputeShader* pComputeShader,
+    ID3D11ClassInstance* const* ppClassInstances,
+    unsigned int NumClassInstances) {
+    m_deviceContext->CSSetShader(pComputeShader, ppClassInstances, NumClassInstances);
+}
+
+/**
+ * @brief Asigna SRVs al compute shader.
+ */
+void DeviceContext::CSSetShaderResources(unsigned int StartSlot,
+    unsigned int NumViews,
+    ID3D11ShaderResourceView* const* ppShaderResourceViews) {
+    if (!ppShaderResourceViews) {
+        ERROR("DeviceContext", "CSSetShaderResources", "ppShaderResourceViews is nullptr");
+        return;
+    }
+    m_deviceContext->CSSetShaderResources(StartSlot, NumViews, ppShaderResourceViews);
+}
+
+/**
+ * @brief Asigna UAVs al compute shader.
+ */
+void DeviceContext::CSSetUnorderedAccessViews(unsigned int StartSlot,
+    unsigned int NumUAVs,
+    ID3D11UnorderedAccessView* const* ppUnorderedAccessViews,
+    const unsigned int* pUAVInitialCounts) {
+    if (!ppUnorderedAccessViews) {
+        ERROR("DeviceContext", "CSSetUnorderedAccessViews", "ppUnorderedAccessViews is nullptr");
+        return;
+    }
+    // D3D11 desenlaza en silencio las SRV que pasan a ser salida: la cach de SRV deja de ser fiable.
+    std::memset(m_bound.psResources, 0xFF, sizeof(m_bound.psResources));
+    m_deviceContext->CSSetUnorderedAccessViews(StartSlot, NumUAVs, ppUnorderedAccessViews, pUAVInitialCounts);
+}
+
+/**
+ * @brief Asigna constant buffers al compute shader.
+ */
+void DeviceContext::CSSetConstantBuffers(unsigned int StartSlot,
+    unsigned int NumBuffers,
+    ID3D11Buffer* const* ppConstantBuffers) {
+    if (!ppConstantBuffers) {
+        ERROR("DeviceContext", "CSSetConstantBuffers", "ppConstantBuffers is nullptr");
+        return;
+    }
+    m_deviceContext->CSSetConstantBuffers(StartSlot, NumBuffers, ppConstantBuffers);
+}
+
+/**
+ * @brief Asigna samplers al compute shader.
+ */
+void DeviceContext::CSSetSamplers(unsigned int StartSlot,
+    unsigned int NumSamplers,
+    ID3D11SamplerState* const* ppSamplers) {
+    if (!ppSamplers) {
+        ERROR("DeviceContext", "CSSetSamplers", "ppSamplers is nullptr");
+        return;
+    }
+    m_deviceContext->CSSetSamplers(StartSlot, NumSamplers, ppSamplers);
+}
+
+/**
+ * @brief Lanza el compute shader enlazado.
+ */
+void DeviceContext::Dispatch(unsigned int ThreadGroupCountX,
+    unsigned int ThreadGroupCountY,
+    unsigned int ThreadGroupCountZ) {
+    if (ThreadGroupCountX == 0 || ThreadGroupCountY == 0 || ThreadGroupCountZ == 0) {
+        ERROR("DeviceContext", "Dispatch", "Thread group count is zero");
+        return;
+    }
+    m_deviceContext->Dispatch(ThreadGroupCountX, ThreadGroupCountY, ThreadGroupCountZ);
+}
+
+void DeviceContext::DispatchIndirect(ID3D11Buffer* pBufferForArgs,
+    unsigned int AlignedByteOffsetForArgs) {
+    if (!pBufferForArgs) {
+        ERROR("DeviceContext", "DispatchIndirect", "pBufferForArgs is nullptr");
+        return;
+    }
+    m_deviceContext->DispatchIndirect(pBufferForArgs, AlignedByteOffsetForArgs);
+}
+
+void DeviceContext::CopyStructureCount(ID3D11Buffer* pDstBuffer,
+    unsigned int DstAlignedByteOffset,
+    ID3D11UnorderedAccessView* pSrcView) {
+    if (!pDstBuffer || !pSrcView) {
+        ERROR("DeviceContext", "CopyStructureCount", "pDstBuffer or pSrcView is nullptr");
+        return;
+    }
+    m_deviceContext->CopyStructureCount(pDstBuffer, DstAlignedByteOffset, pSrcView);
+}
+
+/**
+ * @brief Establece el hull shader.
+ */
+void DeviceContext::HSSetShader(ID3D11HullShader* pHullShader,
+    ID3D11ClassInstance* const* ppClassInstances,
+    unsigned int NumClassInstances) {
+    if (!m_deviceContext) {
+        ERROR("DeviceContext", "HSSetShader", "m_deviceContext is nullptr");
+        return;
+    }
+    m_deviceContext->HSSetShader(pHullShader, ppClassInstances, NumClassInstances);
+}
+
+/**
+ * @brief Asigna constant buffers al hull shader.
+ */
+void DeviceContext::HSSetConstantBuffers(unsigned int StartSlot,
+    unsigned int NumBuffers,
+    ID3D11Buffer* const* ppConstantBuffers) {
+    if (!ppConstantBuffers) {
+        ERROR("DeviceContext", "HSSetConstantBuffers", "ppConstantBuffers is nullptr");
+        return;
+    }
+    m_deviceContext->HSSetConstantBuffers(StartSlot, NumBuffers, ppConstantBuffers);
+}
+
+/**
+ * @brief Establece el domain shader.
+ */
+void DeviceContext::DSSetShader(ID3D11DomainShader* pDomainShader,
+    ID3D11ClassInstance* const* ppClassInstances,
+    unsigned int NumClassInstances) {
+    if (!m_deviceContext) {
+        ERROR("DeviceContext", "DSSetShader", "m_deviceContext is nullptr");
+        return;
+    }
+    m_deviceContext->DSSetShader(pDomainShader, ppClassInstances, NumClassInstances);
+}
+
+/**
+ * @brief Asigna SRVs al domain shader.
+ */
+void DeviceContext::DSSetShaderResources(unsigned int StartSlot,
+    unsigned int NumViews,
+    ID3D11ShaderResourceView* const* ppShaderResourceViews) {
+    if (!ppShaderResourceViews) {
+        ERROR("DeviceContext", "DSSetShaderResources", "ppShaderResourceViews is nullptr");
+        return;
+    }
+    m_deviceContext->DSSetShaderResources(StartSlot, NumViews, ppShaderResourceViews);
+}
+
+/**
+ * @brief Asigna constant buffers al domain shader.
+ */
+void DeviceContext::DSSetConstantBuffers(unsigned int StartSlot,
+    unsigned int NumBuffers,
+    ID3D11Buffer* const* ppConstantBuffers) {
+    if (!ppConstantBuffers) {
+        ERROR("DeviceContext", "DSSetConstantBuffers", "ppConstantBuffers is nullptr");
+        return;
+    }
+    m_deviceContext->DSSetConstantBuffers(StartSlot, NumBuffers, ppConstantBuffers);
+}
+
+/**
+ * @brief Asigna samplers al domain shader.
+ */
+void DeviceContext::DSSetSamplers(unsigned int StartSlot,
+    unsigned int NumSamplers,
+    ID3D11SamplerState* const* ppSamplers) {
+    if (!ppSamplers) {
+        ERROR("DeviceContext", "DSSetSamplers", "ppSamplers is nullptr");
+        return;
+    }
+    m_deviceContext->DSSetSamplers(StartSlot, NumSamplers, ppSamplers);
 }
@@ -0,0 +1,121 @@
+﻿/**
+ * @file DynamicResolution.cpp
+ * @brief Implementación del control de resolución dinámica y del pase de subida.
+ */
+
+#include "DynamicResolution.h"
+#include "Device.h"
+#include "DeviceContext.h"
+#include "GpuProfiler.h"
+#include "ShaderLibrary.h"
+#include <algorithm>
+#include <cmath>
+
+HRESULT DynamicResolution::init(Device& device) {
+    if (!device.m_device) {
+        ERROR("DynamicResolution", "init", "Device is null.");
+        return E_POINTER;
+    }
+    destroy();
+
+    D3D11_SAMPLER_DESC samplerDesc = {};
+    samplerDesc.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+    samplerDesc.AddressU = D3D11_TEXTURE_ADDRESS_CLAMP;
+    samplerDesc.AddressV = D3D11_TEXTURE_ADDRESS_CLAMP;
+    samplerDesc.AddressW = D3D11_TEXTURE_ADDRESS_CLAMP;
+    samplerDesc.ComparisonFunc = D3D11_COMPARISON_NEVER;
+    samplerDesc.MaxLOD = D3D11_FLOAT32_MAX;
+    HRESULT hr = device.CreateSharedSamplerState(&samplerDesc, &m_sampler);
+
+    ShaderKey key;
+    key.fileName = "Upscale.fx";
+    key.entryPoint = "VSUpscale";
+    key.profile = "vs_4_0";
+    if (SUCCEEDED(hr)) { hr = device.getShaderLibrary().getVertexShader(device, key, &m_vertexShader); }
+    key.entryPoint = "PSUpscale";
+    key.profile = "ps_4_0";
+    if (SUCCEEDED(hr)) { hr = device.getShaderLibrary().getPixelShader(device, key, &m_pixelShader); }
+    if (FAILED(hr)) {
+        destroy();
+        return hr;
+    }
+    return S_OK;
+}
+
+RenderTargetPool::Desc DynamicResolution::sceneDesc(unsigned int width, unsigned int height) {
+    RenderTargetPool::Desc desc;
+    desc.width = width;
+    desc.height = height;
+    desc.format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    desc.bindFlags = D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
+    return desc;
+}
+
+void DynamicResolution::update(const GpuProfiler& profiler) {
+    if (!profiler.isEnabled() || profiler.getResultSerial() == m_resultSerial) {
+        return;
+    }
+    m_resultSerial = profiler.getResultSerial();
+    const float frameTime = profiler.getFrameTime();
+    if (frameTime <= 0.0f) {
+        return;
+    }
+
+    // Píxeles ~ escala^2: la escala con la que el frame medido cabría en el presupuesto.
+    const float fit = m_scale * std::sqrt(m_settings.frameBudget / frameTime);
+    const float rate = fit < m_scale ? m_settings.downRate : m_settings.upRate;
+    m_scale = (std::clamp)(m_scale + (fit - m_scale) * rate, m_settings.minScale, m_settings.maxScale);
+
+    // Siempre hacia abajo: al bajar no se queda justo por encima del presupuesto y al
+    // subir solo se gana un paso cuando la escala continua lo alcanza entero.
+    m_appliedScale = (std::clamp)(std::floor(m_scale / kScaleStep + 1e-3f) * kScaleStep,
+        m_settings.minScale, m_settings.maxScale);
+}
+
+void DynamicResolution::reset() {
+    m_scale = m_settings.maxScale;
+    m_appliedScale = m_settings.maxScale;
+}
+
+void DynamicResolution::getRenderSize(unsigned int width, unsigned int height,
+    unsigned int& outWidth, unsigned int& outHeight) const {
+    if (m_appliedScale >= 1.0f) {
+        outWidth = width;
+        outHeight = height;
+        return;
+    }
+    outWidth = (std::max)(2u, static_cast<unsigned int>(width * m_appliedScale) & ~1u);
+    outHeight = (std::max)(2u, static_cast<unsigned int>(height * m_appliedScale) & ~1u);
+}
+
+void DynamicResolution::upscale(DeviceContext& deviceContext, ID3D11ShaderResourceView* sourceSRV,
+    ID3D11RenderTargetView* target, unsigned int width, unsigned int height) {
+    if (!isReady() || !sourceSRV || !target) {
+        return;
+    }
+    deviceContext.OMSetRenderTargets(1, &target, nullptr);
+    D3D11_VIEWPORT viewport = {};
+    viewport.Width = static_cast<float>(width);
+    viewport.Height = static_cast<float>(height);
+    viewport.MaxDepth = 1.0f;
+    deviceContext.RSSetViewports(1, &viewport);
+    deviceContext.OMSetBlendState(nullptr, nullptr, 0xffffffff);
+
+    // Triángulo a pantalla completa generado con SV_VertexID: sin vertex buffer ni layout.
+    deviceContext.IASetInputLayout(nullptr);
+    deviceContext.IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    deviceContext.VSSetShader(m_vertexShader, nullptr, 0);
+    deviceContext.PSSetShader(m_pixelShader, nullptr, 0);
+    deviceContext.PSSetShaderResources(0, 1, &sourceSRV);
+    deviceContext.PSSetSamplers(0, 1, &m_sampler);
+    deviceContext.Draw(3, 0);
+
+    ID3D11ShaderResourceView* nullSRV = nullptr;
+    deviceContext.PSSetShaderResources(0, 1, &nullSRV);
+}
+
+void DynamicResolution::destroy() {
+    SAFE_RELEASE(m_vertexShader);
+    SAFE_RELEASE(m_pixelShader);
+    SAFE_RELEASE(m_sampler);
+}
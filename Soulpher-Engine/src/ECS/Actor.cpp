@@ -5,9 +5,9 @@
  * @details
  * Un Actor es una entidad del motor que contiene componentes y lógica
  * de renderizado y actualización. Este archivo implementa:
- * - Inicialización de recursos gráficos (buffers, estados, shaders).
+ * - Inicialización de recursos gráficos (buffers y estados).
  * - Actualización de transformaciones y datos de render por frame.
- * - Renderizado del modelo y de su sombra proyectada.
+ * - Renderizado del modelo (directo o mediante draw packets para la `RenderQueue`).
  * - Destrucción y liberación de recursos.
  *
  * ---
@@ -16,13 +16,18 @@
  * - Aquí, `Transform` define posición, rotación y escala.
  * - `MeshComponent` contiene la geometría a renderizar.
  * - El uso de **constant buffers** permite enviar datos de CPU → GPU cada frame.
- * - El render de sombras se realiza proyectando la geometría en el plano del suelo mediante una matriz de proyección de sombra.
+ * - Las sombras no se dibujan aquí: `ShadowMap` renderiza los casters desde la luz y
+ *   los receptores leen ese mapa (ver `canCastShadow` / `getReceiveShadow`).
  */
 
 #include "ECS/Actor.h"
+#include "ECS/Prefab.h"
 #include "MeshComponent.h"
 #include "Device.h"
 #include "DeviceContext.h"
+#include "RenderQueue.h"
+#include "Frustum.h"
+#include "FrameArena.h"
 
  /**
   * @brief Constructor de Actor.
@@ -31,7 +36,6 @@
   * @details
   * - Crea componentes básicos por defecto (`Transform` y `MeshComponent`).
   * - Inicializa buffers y estados gráficos necesarios para renderizar.
-  * - Carga el shader para sombras.
   */
 Actor::Actor(Device& device) {
     // Crear componentes por defecto
@@ -41,7 +45,7 @@ Actor::Actor(Device& device) {
     addComponent(meshComponent);
 
     HRESULT hr;
-    std::string classNameType = "Actor -> " + m_name;
+    std::string classNameType = "Actor -> " + m_name.str();
 
     // Buffer de modelo (mundo + color)
     hr = m_modelBuffer.init(device, sizeof(CBChangesEveryFrame));
@@ -58,80 +62,465 @@ Actor::Actor(Device& device) {
 
     hr = m_blendstate.init(device);
     if (FAILED(hr)) { ERROR("Actor", classNameType.c_str(), "Failed to create new BlendState"); }
+}
 
-    // Shader para sombras
-    hr = m_shaderShadow.CreateShader(device, PIXEL_SHADER, "HybridEngine.fx");
-    if (FAILED(hr)) {
-        ERROR("Main", "InitDevice",
-            ("Failed to initialize Shadow Shader. HRESULT: " + std::to_string(hr)).c_str());
+/**
+ * @brief Constructor de instancia de un prefab.
+ *
+ * @details Solo reserva lo propio del actor (el `Transform` y su entidad); malla y
+ * texturas se comparten (copia de handles) y los estados y el buffer del camino directo
+ * son los del prefab. Sin `MeshComponent` vacío: nada lo lee.
+ */
+Actor::Actor(Prefab& prefab)
+    : m_meshAsset(prefab.getMeshAsset()),
+      m_textures(prefab.getTextures()),
+      m_materials(prefab.getMaterials()),
+      m_prefab(&prefab) {
+    addComponent(EU::MakeShared<Transform>());
+    m_name = prefab.getNameId();
+    m_color = prefab.getColor();
+    m_model.vMeshColor = m_color;
+    castShadow = prefab.canCastShadow();
+    m_receiveShadow = prefab.getReceiveShadow();
+    m_static = prefab.isStatic();
+    m_transparent = prefab.isTransparent();
+    m_impostorDistance = prefab.getImpostorDistance();
+    ++prefab.m_instanceCount;
+}
+
+Actor::~Actor() {
+    if (m_prefab) {
+        --m_prefab->m_instanceCount;
     }
+}
 
-    // Buffers y estados para sombras
-    hr = m_shaderBuffer.init(device, sizeof(CBChangesEveryFrame));
-    if (FAILED(hr)) {
-        ERROR("Main", "InitDevice",
-            ("Failed to initialize Shadow Buffer. HRESULT: " + std::to_string(hr)).c_str());
+BlendState& Actor::blendState() { return m_prefab ? m_prefab->getBlendState() : m_blendstate; }
+Rasterizer& Actor::rasterizer() { return m_prefab ? m_prefab->getRasterizer() : m_rasterizer; }
+SamplerState& Actor::sampler() { return m_prefab ? m_prefab->getSampler() : m_sampler; }
+Buffer& Actor::modelBuffer() { return m_prefab ? m_prefab->getModelBuffer() : m_modelBuffer; }
+
+/**
+ * @brief Actualiza el actor y sus componentes.
+ * @param deltaTime Duración del paso de simulación (s).
+ * @param deviceContext Contexto de dispositivo para enviar datos a la GPU.
+ *
+ * @details
+ * - Llama a `update()` de cada componente salvo el `Transform`: su matriz ya la
+ *   calculó `Transform::updateAll` para todos los actores del paso.
+ * - Guarda la matriz de mundo del paso anterior y la nueva (para `interpolate`).
+ * - Prepara `m_model` (matriz de mundo y color). La subida a GPU la hace quien
+ *   dibuja: la `RenderQueue` (anillo de constantes) o `render()` en el camino directo.
+ *
+ * Si la versión del transform no cambió desde el paso anterior, el actor está quieto:
+ * no se copia ni se transpone nada (salvo cerrar la interpolación del último movimiento).
+ */
+void Actor::simulate(float deltaTime) {
+    for (auto& component : m_components) {
+        if (component && component->getType() != ComponentType::TRANSFORM) { component->update(deltaTime); }
     }
 
-    hr = m_shadowBlendState.init(device);
-    if (FAILED(hr)) {
-        ERROR("Main", "InitDevice",
-            ("Failed to initialize Shadow Blend State. HRESULT: " + std::to_string(hr)).c_str());
+    const Transform* transform = getComponent<Transform>();
+    const unsigned int version = transform->getVersion();
+    if (m_hasWorld && !m_modelStale && version == m_transformVersion) {
+        if (m_moving) {
+            // Primer paso quieto: el render deja de interpolar y se queda en el mundo actual.
+            m_prevWorld = m_currWorld;
+            m_moving = false;
+            m_model.mWorld = XMMatrixTranspose(getDecodeMatrix() * m_currWorld);
+            m_modelDirty = true;
+        }
+        return;
     }
 
-    hr = m_shadowDepthStencilState.init(device, true, false);
-    if (FAILED(hr)) {
-        ERROR("Main", "InitDevice",
-            ("Failed to initialize Depth Stencil State. HRESULT: " + std::to_string(hr)).c_str());
+    const XMMATRIX& world = transform->getMatrix();
+    m_prevWorld = m_hasWorld ? m_currWorld : world;
+    m_currWorld = world;
+    m_moving = m_hasWorld && version != m_transformVersion;
+    m_hasWorld = true;
+    m_modelStale = false;
+    m_transformVersion = version;
+    m_model.mWorld = XMMatrixTranspose(getDecodeMatrix() * m_currWorld);
+    m_model.vMeshColor = m_color;
+    m_modelDirty = true;
+}
+
+/**
+ * @brief Sube las constantes del modelo solo si cambiaron: un actor quieto reutiliza el
+ * contenido de su buffer.
+ */
+void Actor::publish(DeviceContext& deviceContext) {
+    if (m_prefab) {
+        // Buffer compartido con las demás instancias: se reescribe antes de cada draw.
+        m_prefab->getModelBuffer().update(deviceContext, nullptr, 0, nullptr, &m_renderModel, 0, 0);
+        m_renderDirty = false;
+        return;
     }
+    if (m_renderDirty) {
+        m_modelBuffer.update(deviceContext, nullptr, 0, nullptr, &m_renderModel, 0, 0);
+        m_renderDirty = false;
+    }
+}
 
-    // Posición de la luz para proyección de sombras
-    m_LightPos = XMFLOAT4(2.0f, 4.0f, -2.0f, 1.0f);
+/**
+ * @brief Un actor quieto no copia nada: `m_modelDirty` solo se activa cuando la
+ * simulación, la interpolación o `setColor` cambian `m_model`, y el `Transform` solo
+ * cambia en un paso de simulación (que lo marca).
+ */
+void Actor::capture() {
+    if (!m_modelDirty) {
+        return;
+    }
+    const Transform* transform = getComponent<Transform>();
+    m_renderModel = m_model;
+    m_renderWorld = transform ? transform->getMatrix() : XMMatrixIdentity();
+    m_renderDirty = true;
+    m_modelDirty = false;
+    ++m_renderVersion;
 }
 
 /**
- * @brief Actualiza el actor y sus componentes.
- * @param deltaTime Tiempo transcurrido desde el último frame.
- * @param deviceContext Contexto de dispositivo para enviar datos a la GPU.
+ * @brief Descuantizado de las posiciones del asset (identidad sin asset o sin cuantizar).
+ */
+XMMATRIX Actor::getDecodeMatrix() const {
+    return m_meshAsset.isNull() ? XMMatrixIdentity() : m_meshAsset->getDecodeMatrix();
+}
+
+void Actor::interpolate(float alpha) {
+    // Quieto: `m_model` ya tiene el mundo actual (ver `update`).
+    if (!m_hasWorld || !m_moving) {
+        return;
+    }
+    const XMMATRIX decode = getDecodeMatrix();
+    m_modelDirty = true;
+    if (memcmp(&m_prevWorld, &m_currWorld, sizeof(XMMATRIX)) == 0) {
+        m_model.mWorld = XMMatrixTranspose(decode * m_currWorld);
+        return;
+    }
+
+    XMVECTOR s0, r0, t0, s1, r1, t1;
+    if (!XMMatrixDecompose(&s0, &r0, &t0, m_prevWorld) ||
+        !XMMatrixDecompose(&s1, &r1, &t1, m_currWorld)) {
+        m_model.mWorld = XMMatrixTranspose(decode * m_currWorld); // Escala nula: sin interpolar.
+        return;
+    }
+    XMMATRIX world = XMMatrixAffineTransformation(XMVectorLerp(s0, s1, alpha), XMVectorZero(),
+        XMQuaternionSlerp(r0, r1, alpha), XMVectorLerp(t0, t1, alpha));
+    m_model.mWorld = XMMatrixTranspose(decode * world);
+}
+
+/**
+ * @brief Renderiza el actor directamente (sin cola ni sombras).
+ */
+void Actor::render(DeviceContext& deviceContext) {
+    DeviceContext::EventScope event(deviceContext, getName().c_str());
+    // Los opacos no mezclan (`reset` = estado por defecto, sin blending).
+    blendState().render(deviceContext, nullptr, 0xffffffff, !m_transparent);
+    rasterizer().render(deviceContext);
+    sampler().render(deviceContext, 0, 1);
+
+    deviceContext.IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+    if (m_meshAsset.isNull() || m_batched) { return; }
+
+    MeshAsset& mesh = m_meshAsset->getLOD(m_lodLevel);
+    publish(deviceContext);
+    modelBuffer().render(deviceContext, CB_SLOT_OBJECT, 1, true);
+    const Buffer* boundVertices = nullptr;
+    for (unsigned int i = 0; i < mesh.getSubmeshCount(); i++) {
+        const SubmeshDraw draw = mesh.getDraw(i);
+        if (draw.vertices != boundVertices) {
+            mesh.render(deviceContext, i);
+            boundVertices = draw.vertices;
+        }
+
+        if (const Material* material = getMaterial(i)) {
+            material->getBlendState()->render(deviceContext);
+            material->getRasterizer()->render(deviceContext);
+            material->getSampler()->render(deviceContext, 0, 1);
+            material->getConstants()->render(deviceContext, CB_SLOT_MATERIAL, 1, true);
+        }
+        if (i < m_textures.size() && !m_textures[i].isNull()) {
+            m_textures[i]->render(deviceContext, 0, 1);
+        }
+
+        deviceContext.DrawIndexed(draw.indexCount, draw.startIndex, draw.baseVertex);
+    }
+}
+
+/**
+ * @brief Envía a la cola un paquete por cada malla del actor (del LOD actual).
  *
  * @details
- * - Llama a `update()` de cada componente.
- * - Actualiza el constant buffer del modelo con la matriz de mundo y el color.
+ * La profundidad se toma del origen del mundo copiado, suficiente para ordenar
+ * actores entre sí. El mismo `submit` sirve para la cola del shadow map (los
+ * casters) y para la principal, donde `receiveShadow` elige el programa receptor.
+ *
+ * Cada paquete lleva también `m_renderModel` (mundo + color) para que la cola pueda
+ * empaquetarlo como dato por instancia cuando varios actores comparten `MeshAsset`.
+ *
+ * Con culling por clusters, una malla con parte oculta se envía como varios paquetes
+ * (uno por rango visible). Esos ya no se agrupan con los de otros actores, pero solo
+ * ocurre cuando se ahorran triángulos; una malla entera visible sigue siendo un paquete.
+ *
+ * Un actor fusionado por `StaticBatcher` no envía nada: su geometría va en el lote.
  */
-void Actor::update(float deltaTime, DeviceContext& deviceContext) {
-    for (auto& component : m_components) {
-        if (component) { component->update(deltaTime); }
+void Actor::submit(RenderQueue& queue) {
+    Transform* transform = getComponent<Transform>();
+    if (!transform || m_meshAsset.isNull() || m_batched) {
+        return;
     }
+    // Origen del mundo copiado (no el `Transform`, que puede estar simulando el frame siguiente).
+    const float depth = queue.computeViewDepth(XMVectorSetW(m_renderWorld.r[3], 1.0f));
+
+    MeshAsset& mesh = m_meshAsset->getLOD(m_lodLevel);
+    const Frustum* clusterFrustum = queue.getClusterFrustum();
+    for (unsigned int i = 0; i < mesh.getSubmeshCount(); i++) {
+        const SubmeshDraw draw = mesh.getDraw(i);
+        DrawPacket packet;
+        packet.vertexBuffer = draw.vertices;
+        packet.indexBuffer = draw.indices;
+        packet.positionBuffer = draw.positions;
+        packet.indexFormat = draw.indices->getIndexFormat();
+        // El buffer del prefab es compartido: no sirve de respaldo del anillo de la cola.
+        packet.modelBuffer = m_prefab ? nullptr : &m_modelBuffer;
+        packet.objectData = &m_renderModel;
+        packet.texture = i < m_textures.size() ? m_textures[i].get() : nullptr;
+        packet.blendState = &blendState();
+        packet.rasterizer = &rasterizer();
+        packet.sampler = &sampler();
+        const Material* material = getMaterial(i);
+        if (material) {
+            packet.material = material;
+            packet.shader = material->getShader();
+            packet.blendState = material->getBlendState();
+            packet.rasterizer = material->getRasterizer();
+            packet.sampler = material->getSampler();
+        }
+        packet.startIndex = draw.startIndex;
+        packet.baseVertex = draw.baseVertex;
+        packet.indexCount = draw.indexCount;
+        packet.depth = depth;
+        packet.receiveShadow = m_receiveShadow;
+        packet.layer = RENDER_LAYER_OPAQUE;
+        if (m_transparent || (material && material->isTransparent())) {
+            packet.layer = RENDER_LAYER_TRANSPARENT;
+        }
+        else if (material && material->isAlphaTested()) {
+            packet.layer = RENDER_LAYER_ALPHA_TESTED;
+        }
+        // Luz horneada: solo la geometría para la que se hornearon las UV2 (nivel 0).
+        if (m_lightmap && m_lodLevel == 0 && !packet.shader && packet.layer == RENDER_LAYER_OPAQUE &&
+            draw.lightmapUVs) {
+            packet.lightmap = m_lightmap;
+            packet.lightmapUVs = draw.lightmapUVs;
+            packet.lightmapConstants = &m_lightmapBuffer;
+        }
+        packet.name = m_name.c_str();
+        packet.owner = this;
+        if (!clusterFrustum || !cullClusters(queue, *clusterFrustum, m_renderWorld, mesh.m_meshes[i])) {
+            queue.submit(packet);
+            continue;
+        }
+        for (const ClusterRange& cluster : m_clusterRanges) {
+            packet.startIndex = draw.startIndex + cluster.startIndex;
+            packet.indexCount = cluster.indexCount;
+            queue.submit(packet);
+        }
+    }
+}
 
-    m_model.mWorld = XMMatrixTranspose(getComponent<Transform>()->matrix);
-    m_model.vMeshColor = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
+/**
+ * @brief Culling de los meshlets de una malla y fusión de los rangos visibles.
+ *
+ * @details
+ * - Frustum: la esfera del meshlet se lleva a mundo (radio por la mayor escala).
+ * - Cono: se prueba en el espacio de la malla, con la cámara transformada por la
+ *   inversa del mundo; así vale con escala no uniforme. Con determinante negativo
+ *   (espejo) la cara frontal se invierte y el cono no se usa.
+ *
+ * Los meshlets visibles consecutivos forman un rango. Si quedan más de
+ * @ref kMaxClusterDraws, se fusionan los separados por menos índices ocultos:
+ * dibujar unos triángulos de más es más barato que otro draw.
+ */
+bool Actor::cullClusters(RenderQueue& queue, const Frustum& frustum, const XMMATRIX& world,
+    const MeshComponent& mesh) {
+    m_clusterRanges.clear();
+    if (mesh.m_meshlets.size() < 2) {
+        return false;
+    }
+    XMVECTOR determinant;
+    const XMMATRIX inverse = XMMatrixInverse(&determinant, world);
+    const float det = XMVectorGetX(determinant);
+    if (fabsf(det) < 1e-12f) {
+        return false;
+    }
+    const bool useCone = det > 0.0f;
+    XMFLOAT3 viewPosition;
+    XMStoreFloat3(&viewPosition, XMVector3TransformCoord(XMLoadFloat3(&queue.getViewPosition()), inverse));
+    const float scale = sqrtf(std::max(std::max(XMVectorGetX(XMVector3LengthSq(world.r[0])),
+        XMVectorGetX(XMVector3LengthSq(world.r[1]))), XMVectorGetX(XMVector3LengthSq(world.r[2]))));
+
+    unsigned int culled = 0;
+    for (const Meshlet& meshlet : mesh.m_meshlets) {
+        XMFLOAT3 center;
+        XMStoreFloat3(&center, XMVector3TransformCoord(XMLoadFloat3(&meshlet.center), world));
+        if (!frustum.intersectsSphere(center, meshlet.radius * scale) ||
+            (useCone && meshlet.isBackFacing(viewPosition))) {
+            ++culled;
+            continue;
+        }
+        if (!m_clusterRanges.empty() &&
+            m_clusterRanges.back().startIndex + m_clusterRanges.back().indexCount == meshlet.firstIndex) {
+            m_clusterRanges.back().indexCount += meshlet.indexCount;
+        }
+        else {
+            m_clusterRanges.push_back({ meshlet.firstIndex, meshlet.indexCount });
+        }
+    }
+    queue.addClusterStats(static_cast<unsigned int>(mesh.m_meshlets.size()), culled);
+    if (culled == 0) {
+        m_clusterRanges.clear();
+        return false;
+    }
+    if (m_clusterRanges.size() <= kMaxClusterDraws) {
+        return true;
+    }
 
-    m_modelBuffer.update(deviceContext, nullptr, 0, nullptr, &m_model, 0, 0);
+    // Umbral = el hueco número `merges` de menor a mayor; los iguales, hasta completar.
+    const size_t merges = m_clusterRanges.size() - kMaxClusterDraws;
+    m_clusterGaps.clear();
+    for (size_t i = 0; i + 1 < m_clusterRanges.size(); ++i) {
+        m_clusterGaps.push_back(m_clusterRanges[i + 1].startIndex -
+            (m_clusterRanges[i].startIndex + m_clusterRanges[i].indexCount));
+    }
+    unsigned int threshold;
+    {
+        // Copia temporal para `nth_element`: del arena del hilo, se devuelve al salir.
+        FrameArena::Scope scope;
+        EU::TArray<unsigned int, EU::ArenaAllocator> sorted(FrameArena::allocator());
+        sorted.Reserve(m_clusterGaps.size());
+        for (unsigned int gap : m_clusterGaps) {
+            sorted.Add(gap);
+        }
+        unsigned int* data = sorted.GetData();
+        std::nth_element(data, data + (merges - 1), data + sorted.Num());
+        threshold = data[merges - 1];
+    }
+    size_t equalQuota = merges - static_cast<size_t>(std::count_if(m_clusterGaps.begin(), m_clusterGaps.end(),
+        [threshold](unsigned int gap) { return gap < threshold; }));
+
+    size_t kept = 0;
+    for (size_t i = 1; i < m_clusterRanges.size(); ++i) {
+        const unsigned int gap = m_clusterGaps[i - 1];
+        const bool merge = gap < threshold || (gap == threshold && equalQuota > 0);
+        if (merge) {
+            if (gap == threshold) {
+                --equalQuota;
+            }
+            m_clusterRanges[kept].indexCount = m_clusterRanges[i].startIndex +
+                m_clusterRanges[i].indexCount - m_clusterRanges[kept].startIndex;
+        }
+        else {
+            m_clusterRanges[++kept] = m_clusterRanges[i];
+        }
+    }
+    m_clusterRanges.resize(kept + 1);
+    return true;
 }
 
 /**
- * @brief Renderiza el actor y su sombra (si aplica).
+ * @brief Transforma la AABB local del asset con la matriz de mundo del actor (la del último `capture`).
  */
-void Actor::render(DeviceContext& deviceContext) {
-    if (canCastShadow()) { renderShadow(deviceContext); }
+bool Actor::getWorldBounds(XMFLOAT3& outMin, XMFLOAT3& outMax) {
+    Transform* transform = getComponent<Transform>();
+    if (!transform || m_meshAsset.isNull() || !m_meshAsset->hasBounds()) {
+        return false;
+    }
+    Frustum::transformAABB(m_meshAsset->m_boundsMin, m_meshAsset->m_boundsMax,
+        m_renderWorld, outMin, outMax);
+    return true;
+}
 
-    m_blendstate.render(deviceContext);
-    m_rasterizer.render(deviceContext);
-    m_sampler.render(deviceContext, 0, 1);
+/**
+ * @brief Transforma la AABB local del asset con la matriz actual del `Transform`.
+ */
+bool Actor::getSimulationBounds(XMFLOAT3& outMin, XMFLOAT3& outMax) {
+    Transform* transform = getComponent<Transform>();
+    if (!transform || m_meshAsset.isNull() || !m_meshAsset->hasBounds()) {
+        return false;
+    }
+    Frustum::transformAABB(m_meshAsset->m_boundsMin, m_meshAsset->m_boundsMax,
+        transform->getMatrix(), outMin, outMax);
+    return true;
+}
 
-    deviceContext.IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+/**
+ * @brief Culling por frustum: sin volumen envolvente se asume visible.
+ */
+bool Actor::isVisible(const Frustum& frustum) {
+    XMFLOAT3 mn, mx;
+    if (!getWorldBounds(mn, mx)) {
+        return true;
+    }
+    return frustum.intersectsAABB(mn, mx);
+}
 
-    for (unsigned int i = 0; i < m_meshes.size(); i++) {
-        m_vertexBuffers[i].render(deviceContext, 0, 1);
-        m_indexBuffers[i].render(deviceContext, 0, 1, false, DXGI_FORMAT_R32_UINT);
+/**
+ * @brief Proyecta la esfera envolvente en mundo y deja que el asset elija el nivel.
+ *
+ * @details
+ * Tamaño en pantalla = diámetro proyectado / alto de pantalla = `r * P[1][1] / z`,
+ * con `z` la profundidad en vista del centro. Si la cámara está dentro de la esfera
+ * se usa el nivel 0. El tamaño se guarda también sin LOD (lo usa el streaming de texturas).
+ */
+void Actor::updateLOD(const XMMATRIX& view, float projScaleY) {
+    XMFLOAT3 mn, mx;
+    m_screenSize = 1.0f;
+    if (m_meshAsset.isNull() || !getWorldBounds(mn, mx)) {
+        m_lodLevel = 0;
+        return;
+    }
+
+    XMVECTOR vMin = XMLoadFloat3(&mn);
+    XMVECTOR vMax = XMLoadFloat3(&mx);
+    XMVECTOR center = XMVectorScale(XMVectorAdd(vMin, vMax), 0.5f);
+    const float radius = 0.5f * XMVectorGetX(XMVector3Length(XMVectorSubtract(vMax, vMin)));
+    const float depth = XMVectorGetZ(XMVector3TransformCoord(center, view));
+    if (depth <= radius) {
+        m_lodLevel = 0;
+        return;
+    }
 
-        m_modelBuffer.render(deviceContext, 2, 1, true);
+    m_screenSize = radius * projScaleY / depth;
+    m_lodLevel = m_meshAsset->getLODCount() < 2 ? 0 : m_meshAsset->selectLOD(m_screenSize, m_lodLevel);
+}
 
-        if (m_textures.size() > 0 && i < m_textures.size()) {
-            m_textures[i].render(deviceContext, 0, 1);
+/**
+ * @details Las texturas de los materiales se copian a `m_textures`: el resto del motor
+ * (streaming, `StaticBatcher`, impostores) sigue leyendo `getTextures`. Una submalla sin
+ * material conserva la textura que tuviera.
+ */
+void Actor::setMaterials(const std::vector<MaterialHandle>& materials) {
+    m_materials = materials;
+    if (m_textures.size() < materials.size()) {
+        m_textures.resize(materials.size());
+    }
+    for (size_t i = 0; i < materials.size(); ++i) {
+        if (!materials[i].isNull()) {
+            m_textures[i] = materials[i]->getDesc().diffuse;
         }
+    }
+}
 
-        deviceContext.DrawIndexed(m_meshes[i].m_numIndex, 0, 0);
+void Actor::setName(Name name) {
+    if (name == m_name) {
+        return;
+    }
+    const Name previous = m_name;
+    m_name = name;
+    // Fuera del pool (id 0) no hay índice que mantener.
+    if (getId() != 0) {
+        ActorPool::getDefault().rename(getId(), previous, name);
     }
 }
 
@@ -139,80 +528,60 @@ void Actor::render(DeviceContext& deviceContext) {
  * @brief Libera recursos gráficos asociados al actor.
  */
 void Actor::destroy() {
-    for (auto& vb : m_vertexBuffers) { vb.destroy(); }
-    for (auto& ib : m_indexBuffers) { ib.destroy(); }
-    for (auto& tex : m_textures) { tex.destroy(); }
+    // La geometría solo se libera cuando este actor es su último usuario.
+    if (m_meshAsset.unique()) {
+        m_meshAsset->destroy();
+    }
+    m_meshAsset.reset();
+    // Los materiales primero: también retienen sus texturas.
+    m_materials.clear();
+    // Igual con las texturas: las compartidas las libera su último usuario.
+    for (auto& tex : m_textures) {
+        if (tex.unique()) {
+            tex->destroy();
+        }
+    }
+    m_textures.clear();
 
     m_modelBuffer.destroy();
+    clearLightmap();
     m_rasterizer.destroy();
     m_blendstate.destroy();
     m_sampler.destroy();
 }
 
-/**
- * @brief Configura la geometría del actor desde un conjunto de mallas.
- */
-void Actor::setMesh(Device& device, std::vector<MeshComponent> meshes) {
-    m_meshes = meshes;
-    HRESULT hr;
-    for (auto& mesh : m_meshes) {
-        Buffer vb;
-        hr = vb.init(device, mesh, D3D11_BIND_VERTEX_BUFFER);
-        if (FAILED(hr)) { ERROR("Actor", "setMesh", "Failed to create new vertexBuffer"); }
-        else { m_vertexBuffers.push_back(vb); }
-
-        Buffer ib;
-        hr = ib.init(device, mesh, D3D11_BIND_INDEX_BUFFER);
-        if (FAILED(hr)) { ERROR("Actor", "setMesh", "Failed to create new indexBuffer"); }
-        else { m_indexBuffers.push_back(ib); }
+HRESULT Actor::setLightmap(Device& device, ID3D11ShaderResourceView* lightmap, const XMFLOAT4& scaleOffset) {
+    clearLightmap();
+    if (!lightmap) {
+        return E_POINTER;
+    }
+    CBLightmap constants;
+    constants.vLightmapScaleOffset = scaleOffset;
+    HRESULT hr = m_lightmapBuffer.create(device, BUFFER_IMMUTABLE, D3D11_BIND_CONSTANT_BUFFER,
+        sizeof(CBLightmap), sizeof(CBLightmap), &constants);
+    if (FAILED(hr)) {
+        ERROR("Actor", "setLightmap", ("Failed to create the lightmap constant buffer. HRESULT: " + std::to_string(hr)).c_str());
+        return hr;
     }
+    m_lightmap = lightmap;
+    return S_OK;
+}
+
+void Actor::clearLightmap() {
+    m_lightmap = nullptr;
+    m_lightmapBuffer.destroy();
 }
 
 /**
- * @brief Renderiza la sombra proyectada del actor en el suelo.
+ * @brief Configura la geometría del actor desde un conjunto de mallas.
  *
- * @details
- * - Calcula una matriz de proyección de sombra usando la posición de la luz.
- * - Actualiza el constant buffer específico para sombras.
- * - Usa un pixel shader especial (`m_shaderShadow`) que dibuja en negro semitransparente.
- */
-void Actor::renderShadow(DeviceContext& deviceContext) {
-    auto t = getComponent<Transform>();
-    auto pos = t->getPosition();
-    auto yaw = t->getRotation().y;
-    auto scl = t->getScale();
-
-    XMMATRIX Mscale = XMMatrixScaling(scl.x, scl.y, scl.z);
-    XMMATRIX Myaw = XMMatrixRotationY(yaw);
-    XMMATRIX Mtrans = XMMatrixTranslation(pos.x, pos.y, pos.z);
-    XMMATRIX worldYaw = Mscale * Myaw * Mtrans;
-
-    float Lx = m_LightPos.x, Ly = m_LightPos.y, Lz = m_LightPos.z;
-    float invLy = 1.0f / Ly;
-
-    XMMATRIX S = XMMATRIX(
-        1.0f, -Lx * invLy, 0.0f, 0.0f,
-        0.0f, 0.0f, 0.0f, 0.0f,
-        0.0f, -Lz * invLy, 1.0f, 0.0f,
-        0.0f, 0.0f, 0.0f, 1.0f
-    );
-
-    XMMATRIX worldShadow = worldYaw * S;
-
-    m_cbShadow.mWorld = XMMatrixTranspose(worldShadow);
-    m_cbShadow.vMeshColor = XMFLOAT4(0, 0, 0, 0.5f);
-    m_shaderBuffer.update(deviceContext, nullptr, 0, nullptr, &m_cbShadow, 0, 0);
-    m_shaderBuffer.render(deviceContext, 2, 1, true);
-
-    float blendFactor[4] = { 0.f, 0.f, 0.f, 0.f };
-    m_shaderShadow.render(deviceContext, PIXEL_SHADER);
-    m_shadowBlendState.render(deviceContext, blendFactor, 0xffffffff);
-    m_shadowDepthStencilState.render(deviceContext, 0);
-
-    deviceContext.IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-    for (size_t i = 0; i < m_meshes.size(); ++i) {
-        m_vertexBuffers[i].render(deviceContext, 0, 1);
-        m_indexBuffers[i].render(deviceContext, 0, 1, false, DXGI_FORMAT_R32_UINT);
-        deviceContext.DrawIndexed(m_meshes[i].m_numIndex, 0, 0);
-    }
+ * @note Crea un `MeshAsset` propio. Para compartir geometría entre actores
+ * (e instanciarla) usar `setMeshAsset`.
+ */
+void Actor::setMesh(Device& device, const std::vector<MeshComponent>& meshes) {
+    EU::TSharedPointer<MeshAsset> asset = EU::MakeShared<MeshAsset>();
+    HRESULT hr = asset->init(device, meshes);
+    if (FAILED(hr)) { ERROR("Actor", "setMesh", "Failed to create some mesh buffers"); }
+    m_meshAsset = asset;
+    m_modelStale = true;
 }
@@ -0,0 +1,165 @@
+﻿/**
+ * @file ActorPool.cpp
+ * @brief Implementación del pool de actores.
+ */
+
+#include "ECS/ActorPool.h"
+#include "ECS/Prefab.h"
+#include <malloc.h>
+
+ActorPool& ActorPool::getDefault() {
+    static ActorPool s_pool;
+    return s_pool;
+}
+
+HRESULT ActorPool::reserve(uint32_t count) {
+    if (count > kMaxActors) {
+        ERROR("ActorPool", "reserve", ("Cannot hold " + std::to_string(count) + " actors").c_str());
+        return E_OUTOFMEMORY;
+    }
+    while (getCapacity() < count) {
+        HRESULT hr = addPage();
+        if (FAILED(hr)) {
+            return hr;
+        }
+    }
+    return S_OK;
+}
+
+HRESULT ActorPool::addPage() {
+    if (getCapacity() + kPageSize > kMaxActors) {
+        ERROR("ActorPool", "addPage", "Actor pool is full");
+        return E_OUTOFMEMORY;
+    }
+    unsigned char* page = static_cast<unsigned char*>(_aligned_malloc(sizeof(Actor) * kPageSize, alignof(Actor)));
+    if (!page) {
+        ERROR("ActorPool", "addPage", "Failed to allocate an actor page");
+        return E_OUTOFMEMORY;
+    }
+    const uint32_t base = getCapacity();
+    m_pages.push_back(page);
+    m_generations.resize(base + kPageSize, 1);
+    m_alive.resize(base + kPageSize, 0);
+    // Debajo de los huecos libres que ya había: se ocupan antes los índices bajos y los
+    // actores quedan juntos en las primeras páginas.
+    std::vector<uint32_t> fresh(kPageSize);
+    for (uint32_t i = 0; i < kPageSize; ++i) {
+        fresh[i] = base + kPageSize - 1 - i;
+    }
+    m_freeList.insert(m_freeList.begin(), fresh.begin(), fresh.end());
+    return S_OK;
+}
+
+uint32_t ActorPool::acquireSlot() {
+    if (m_freeList.empty() && FAILED(addPage())) {
+        return kMaxActors;
+    }
+    const uint32_t index = m_freeList.back();
+    m_freeList.pop_back();
+    return index;
+}
+
+ActorHandle ActorPool::commitSlot(uint32_t index, Actor* actor) {
+    ActorHandle handle;
+    handle.value = (static_cast<uint32_t>(m_generations[index]) << ActorHandle::kIndexBits) | index;
+    actor->m_id = handle.value;
+    if (!actor->getNameId().isNone()) {
+        m_byName.emplace(actor->getNameId().getId(), handle.value);
+    }
+    m_alive[index] = 1;
+    ++m_count;
+    EventBus::publish(ActorSpawnedEvent{ handle });
+    return handle;
+}
+
+ActorHandle ActorPool::spawn(Device& device) {
+    const uint32_t index = acquireSlot();
+    if (index == kMaxActors) {
+        return ActorHandle();
+    }
+    return commitSlot(index, new (slot(index)) Actor(device));
+}
+
+ActorHandle ActorPool::spawn(Prefab& prefab) {
+    const uint32_t index = acquireSlot();
+    if (index == kMaxActors) {
+        return ActorHandle();
+    }
+    return commitSlot(index, new (slot(index)) Actor(prefab));
+}
+
+/**
+ * @details La generación salta el 0 al dar la vuelta: así un handle creado nunca vale 0
+ * (el nulo).
+ */
+void ActorPool::despawn(ActorHandle handle) {
+    Actor* actor = get(handle);
+    if (!actor) {
+        return;
+    }
+    const uint32_t index = handle.getIndex();
+    const Name name = actor->getNameId();
+    unindexName(name, handle.value);
+    actor->~Actor();
+    m_alive[index] = 0;
+    uint16_t& generation = m_generations[index];
+    generation = generation >= ActorHandle::kMaxGeneration ? 1 : static_cast<uint16_t>(generation + 1);
+    m_freeList.push_back(index);
+    --m_count;
+    EventBus::publish(ActorDespawnedEvent{ handle, name });
+}
+
+void ActorPool::clear() {
+    for (uint32_t i = 0; i < m_alive.size(); ++i) {
+        if (m_alive[i]) {
+            slot(i)->~Actor();
+        }
+    }
+    for (unsigned char* page : m_pages) {
+        _aligned_free(page);
+    }
+    m_pages.clear();
+    m_generations.clear();
+    m_alive.clear();
+    m_freeList.clear();
+    m_byName.clear();
+    m_count = 0;
+}
+
+ActorHandle ActorPool::findByName(Name name) const {
+    ActorHandle handle;
+    auto found = m_byName.find(name.getId());
+    if (found != m_byName.end()) {
+        handle.value = found->second;
+    }
+    return handle;
+}
+
+void ActorPool::findAllByName(Name name, std::vector<ActorHandle>& out) const {
+    auto range = m_byName.equal_range(name.getId());
+    for (auto it = range.first; it != range.second; ++it) {
+        ActorHandle handle;
+        handle.value = it->second;
+        out.push_back(handle);
+    }
+}
+
+void ActorPool::rename(uint32_t handleValue, Name oldName, Name newName) {
+    unindexName(oldName, handleValue);
+    if (!newName.isNone()) {
+        m_byName.emplace(newName.getId(), handleValue);
+    }
+    ActorHandle handle;
+    handle.value = handleValue;
+    EventBus::publish(ActorRenamedEvent{ handle, oldName, newName });
+}
+
+void ActorPool::unindexName(Name name, uint32_t handleValue) {
+    auto range = m_byName.equal_range(name.getId());
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == handleValue) {
+            m_byName.erase(it);
+            return;
+        }
+    }
+}
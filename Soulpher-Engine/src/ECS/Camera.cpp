@@ -0,0 +1,142 @@
+﻿/**
+ * @file Camera.cpp
+ * @brief Órbita, lente y recálculo perezoso de las matrices de la cámara.
+ */
+
+#include "ECS/Camera.h"
+
+void Camera::update(float deltaTime) {
+    refresh();
+}
+
+void Camera::setOrbit(const XMFLOAT3& target, float yawDeg, float pitchDeg, float distance) {
+    m_target = target;
+    m_yawDeg = yawDeg;
+    m_pitchDeg = pitchDeg;
+    m_distance = distance;
+    m_orbiting = true;
+    m_viewDirty = true;
+}
+
+void Camera::setTarget(const XMFLOAT3& target) {
+    m_target = target;
+    m_orbiting = true;
+    m_viewDirty = true;
+}
+
+void Camera::setAngles(float yawDeg, float pitchDeg) {
+    m_yawDeg = yawDeg;
+    m_pitchDeg = pitchDeg;
+    m_orbiting = true;
+    m_viewDirty = true;
+}
+
+void Camera::setDistance(float distance) {
+    m_distance = distance;
+    m_orbiting = true;
+    m_viewDirty = true;
+}
+
+void Camera::setView(const XMMATRIX& view) {
+    XMStoreFloat4x4(&m_view, view);
+    // El ojo es la traslación de la inversa (la vista es rígida).
+    XMVECTOR determinant;
+    XMStoreFloat3(&m_position, XMMatrixInverse(&determinant, view).r[3]);
+    m_orbiting = false;
+    m_viewDirty = false;
+    m_viewProjectionDirty = true;
+}
+
+void Camera::lookAt(const XMFLOAT3& eye, const XMFLOAT3& target, const XMFLOAT3& up) {
+    XMStoreFloat4x4(&m_view, XMMatrixLookAtLH(XMLoadFloat3(&eye), XMLoadFloat3(&target), XMLoadFloat3(&up)));
+    m_position = eye;
+    m_orbiting = false;
+    m_viewDirty = false;
+    m_viewProjectionDirty = true;
+}
+
+void Camera::setPerspective(float fovY, float aspect, float nearZ, float farZ) {
+    m_fovY = fovY;
+    m_aspect = aspect;
+    m_nearZ = nearZ;
+    m_farZ = farZ;
+    m_perspective = true;
+    m_projectionDirty = true;
+}
+
+void Camera::setAspect(float aspect) {
+    if (m_aspect == aspect && m_perspective) {
+        return;
+    }
+    m_aspect = aspect;
+    m_perspective = true;
+    m_projectionDirty = true;
+}
+
+void Camera::setProjection(const XMMATRIX& projection, float nearZ, float farZ) {
+    XMStoreFloat4x4(&m_projection, projection);
+    m_fovY = 0.0f;
+    m_nearZ = nearZ;
+    m_farZ = farZ;
+    m_perspective = false;
+    m_projectionDirty = false;
+    m_viewProjectionDirty = true;
+}
+
+XMMATRIX Camera::getView() const {
+    refresh();
+    return XMLoadFloat4x4(&m_view);
+}
+
+XMMATRIX Camera::getProjection() const {
+    refresh();
+    return XMLoadFloat4x4(&m_projection);
+}
+
+XMMATRIX Camera::getViewProjection() const {
+    refresh();
+    return XMLoadFloat4x4(&m_viewProjection);
+}
+
+const Frustum& Camera::getFrustum() const {
+    refresh();
+    return m_frustum;
+}
+
+XMFLOAT3 Camera::getPosition() const {
+    refresh();
+    return m_position;
+}
+
+unsigned int Camera::getVersion() const {
+    refresh();
+    return m_version;
+}
+
+void Camera::refresh() const {
+    if (m_viewDirty) {
+        const float yaw = XMConvertToRadians(m_yawDeg);
+        const float pitch = XMConvertToRadians(m_pitchDeg);
+        const float cy = cosf(yaw), sy = sinf(yaw);
+        const float cp = cosf(pitch), sp = sinf(pitch);
+        m_position = XMFLOAT3(m_target.x + sy * cp * m_distance,
+            m_target.y + sp * m_distance,
+            m_target.z + cy * cp * m_distance);
+        XMStoreFloat4x4(&m_view, XMMatrixLookAtLH(XMLoadFloat3(&m_position), XMLoadFloat3(&m_target),
+            XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f)));
+        m_viewDirty = false;
+        m_viewProjectionDirty = true;
+    }
+    if (m_projectionDirty) {
+        XMStoreFloat4x4(&m_projection, XMMatrixPerspectiveFovLH(m_fovY, m_aspect, m_nearZ, m_farZ));
+        m_projectionDirty = false;
+        m_viewProjectionDirty = true;
+    }
+    if (m_viewProjectionDirty) {
+        const XMMATRIX viewProjection = XMMatrixMultiply(XMLoadFloat4x4(&m_view), XMLoadFloat4x4(&m_projection));
+        XMStoreFloat4x4(&m_viewProjection, viewProjection);
+        m_frustum.update(viewProjection);
+        ++m_version;
+        m_viewProjectionDirty = false;
+    }
+}
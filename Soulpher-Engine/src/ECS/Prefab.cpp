@@ -0,0 +1,86 @@
+﻿/**
+ * @file Prefab.cpp
+ * @brief Implementación de los prefabs de actor.
+ */
+
+#include "ECS/Prefab.h"
+#include "Device.h"
+
+HRESULT Prefab::init(Device& device) {
+    destroy();
+    HRESULT hr = m_blendState.init(device);
+    if (SUCCEEDED(hr)) { hr = m_rasterizer.init(device); }
+    if (SUCCEEDED(hr)) { hr = m_sampler.init(device); }
+    if (SUCCEEDED(hr)) { hr = m_modelBuffer.init(device, sizeof(CBChangesEveryFrame)); }
+    if (FAILED(hr)) {
+        ERROR("Prefab", "init", ("Failed to create shared resources for " + m_name.str()).c_str());
+        destroy();
+        return hr;
+    }
+    m_ready = true;
+    return S_OK;
+}
+
+void Prefab::destroy() {
+    if (m_instanceCount > 0) {
+        ERROR("Prefab", "destroy", (m_name.str() + " still has " + std::to_string(m_instanceCount) + " instances").c_str());
+        return;
+    }
+    m_modelBuffer.destroy();
+    m_sampler.destroy();
+    m_rasterizer.destroy();
+    m_blendState.destroy();
+    m_ready = false;
+}
+
+void Prefab::setMaterials(const std::vector<MaterialHandle>& materials) {
+    m_materials = materials;
+    if (m_textures.size() < materials.size()) {
+        m_textures.resize(materials.size());
+    }
+    for (size_t i = 0; i < materials.size(); ++i) {
+        if (!materials[i].isNull()) {
+            m_textures[i] = materials[i]->getDesc().diffuse;
+        }
+    }
+}
+
+ActorHandle Prefab::instantiate(const Placement& placement) {
+    if (!m_ready) {
+        ERROR("Prefab", "instantiate", (m_name.str() + " is not initialized").c_str());
+        return ActorHandle();
+    }
+    ActorHandle actor = ActorPool::getDefault().spawn(*this);
+    if (!actor.isNull()) {
+        actor->getComponent<Transform>()->setTransform(placement.position, placement.rotation, placement.scale);
+    }
+    return actor;
+}
+
+/**
+ * @details Reserva primero los huecos del pool (y el vector de salida): dentro del bucle
+ * cada instancia solo construye el actor y su `Transform`.
+ */
+HRESULT Prefab::instantiate(const std::vector<Placement>& placements, std::vector<ActorHandle>& out) {
+    if (!m_ready) {
+        ERROR("Prefab", "instantiate", (m_name.str() + " is not initialized").c_str());
+        return E_FAIL;
+    }
+    ActorPool& pool = ActorPool::getDefault();
+    const unsigned long long needed = static_cast<unsigned long long>(pool.getCount()) + placements.size();
+    if (needed > ActorPool::kMaxActors) {
+        ERROR("Prefab", "instantiate", "Actor pool cannot hold the whole wave");
+        return E_OUTOFMEMORY;
+    }
+    HRESULT hr = pool.reserve(static_cast<uint32_t>(needed));
+    if (FAILED(hr)) {
+        return hr;
+    }
+    out.reserve(out.size() + placements.size());
+    for (const Placement& placement : placements) {
+        ActorHandle actor = pool.spawn(*this);
+        actor->getComponent<Transform>()->setTransform(placement.position, placement.rotation, placement.scale);
+        out.push_back(actor);
+    }
+    return S_OK;
+}
@@ -17,8 +17,85 @@
  */
 
 #include "ECS/Transform.h"
+#include "ECS/TransformHierarchy.h"
 #include "DeviceContext.h"
 
+namespace {
+    /// `EU::Quaternion` guarda (w, x, y, z); XNA espera (x, y, z, w).
+    XMVECTOR loadQuaternion(const EU::Quaternion& q) {
+        return XMVectorSet(q.x, q.y, q.z, q.w);
+    }
+
+    EU::Quaternion storeQuaternion(FXMVECTOR q) {
+        XMFLOAT4 v;
+        XMStoreFloat4(&v, q);
+        return EU::Quaternion(v.w, v.x, v.y, v.z);
+    }
+}
+
+/**
+ * @details La rotación sale directamente del cuaternión; escalar y trasladar son
+ * multiplicar las filas y poner la última, sin construir ni multiplicar tres matrices.
+ */
+XMMATRIX Transform::composeLocal(const LocalTransform& local) {
+    XMMATRIX m = XMMatrixRotationQuaternion(loadQuaternion(local.rotation));
+    m.r[0] = XMVectorScale(m.r[0], local.scale.x);
+    m.r[1] = XMVectorScale(m.r[1], local.scale.y);
+    m.r[2] = XMVectorScale(m.r[2], local.scale.z);
+    m.r[3] = XMVectorSet(local.position.x, local.position.y, local.position.z, 1.0f);
+    return m;
+}
+
+EU::Quaternion Transform::eulerToQuaternion(const EU::Vector3& euler) {
+    return storeQuaternion(XMQuaternionRotationRollPitchYaw(euler.x, euler.y, euler.z));
+}
+
+/**
+ * @details Con R = Rz(roll) * Rx(pitch) * Ry(yaw): `_32 = -sin(pitch)`, y yaw y roll salen
+ * de la tercera fila y la segunda columna. Con el pitch en +-90 grados yaw y roll giran
+ * sobre el mismo eje: se deja roll a 0 y todo el giro va al yaw.
+ */
+EU::Vector3 Transform::quaternionToEuler(const EU::Quaternion& rotation) {
+    XMFLOAT3X3 m;
+    XMStoreFloat3x3(&m, XMMatrixRotationQuaternion(loadQuaternion(rotation)));
+    const float sinPitch = -m._32;
+    if (sinPitch >= 0.9999f || sinPitch <= -0.9999f) {
+        return EU::Vector3(sinPitch > 0.0f ? XM_PIDIV2 : -XM_PIDIV2, atan2f(-m._13, m._11), 0.0f);
+    }
+    return EU::Vector3(asinf(sinPitch), atan2f(m._31, m._33), atan2f(m._12, m._22));
+}
+
+EU::Quaternion Transform::rotated(const EU::Quaternion& rotation, const EU::Vector3& axis, float radians) {
+    const XMVECTOR turn = XMQuaternionRotationAxis(XMVectorSet(axis.x, axis.y, axis.z, 0.0f), radians);
+    return storeQuaternion(XMQuaternionNormalize(XMQuaternionMultiply(loadQuaternion(rotation), turn)));
+}
+
+Transform::Transform()
+    : Component(kType), m_world(&World::getDefault()) {
+    m_entity = m_world->create();
+    LocalTransform local = {};
+    local.dirty = true;
+    m_world->add(m_entity, local);
+    WorldTransform world;
+    world.matrix = XMMatrixIdentity();
+    world.version = 0;
+    m_world->add(m_entity, world);
+}
+
+Transform::~Transform() {
+    TransformHierarchy::getDefault().remove(*m_world, m_entity);
+    m_world->destroy(m_entity);
+}
+
+bool Transform::setParent(const Transform* parent) {
+    return TransformHierarchy::getDefault().setParent(*m_world, m_entity,
+        parent ? parent->getEntity() : EntityID());
+}
+
+EntityID Transform::getParent() const {
+    return TransformHierarchy::getDefault().getParent(*m_world, m_entity);
+}
+
  /**
   * @brief Inicializa el transform con valores por defecto.
   *
@@ -27,8 +104,11 @@
   * - Matriz de transformación = identidad (sin rotación, traslación o escala).
   */
 void Transform::init() {
-    scale.one();                ///< Escala unitaria.
-    matrix = XMMatrixIdentity();///< Matriz inicial (sin transformación).
+    local().scale.one();                                          ///< Escala unitaria.
+    local().dirty = true;
+    WorldTransform& world = *m_world->get<WorldTransform>(m_entity);
+    world.matrix = XMMatrixIdentity();                            ///< Matriz inicial (sin transformación).
+    ++world.version;
 }
 
 /**
@@ -41,17 +121,42 @@ void Transform::init() {
  * - Este orden asegura que la rotación y la escala se apliquen respecto al sistema local del objeto.
  */
 void Transform::update(float deltaTime) {
-    // Matriz de escala
-    XMMATRIX scaleMatrix = XMMatrixScaling(scale.x, scale.y, scale.z);
-
-    // Matriz de rotación (en radianes: pitch=X, yaw=Y, roll=Z)
-    XMMATRIX rotationMatrix = XMMatrixRotationRollPitchYaw(rotation.x, rotation.y, rotation.z);
-
-    // Matriz de traslación
-    XMMATRIX translationMatrix = XMMatrixTranslation(position.x, position.y, position.z);
+    LocalTransform& data = local();
+    if (!data.dirty) {
+        return;
+    }
+    WorldTransform& world = *m_world->get<WorldTransform>(m_entity);
+    world.matrix = composeLocal(data);
+    // Hijo: con el mundo actual del padre (que puede ir un paso por detrás si también cambió).
+    if (const Parent* parent = m_world->get<Parent>(m_entity)) {
+        if (const WorldTransform* parentWorld = m_world->get<WorldTransform>(parent->entity)) {
+            world.matrix = world.matrix * parentWorld->matrix;
+        }
+    }
+    ++world.version;
+    data.dirty = false;
+}
 
-    // Composición final
-    matrix = scaleMatrix * rotationMatrix * translationMatrix;
+/**
+ * @brief Recalcula las matrices de todos los transforms del mundo.
+ *
+ * @details
+ * Una consulta por chunk: las columnas `LocalTransform` y `WorldTransform` son arrays
+ * contiguos, así que el bucle lee y escribe memoria secuencial en lugar de seguir un
+ * puntero por actor.
+ */
+void Transform::updateAll(World& world, bool parallel) {
+    world.forEachChunkWithout<Parent, LocalTransform, WorldTransform>(
+        [](unsigned int count, const EntityID*, LocalTransform* locals, WorldTransform* worlds) {
+            for (unsigned int i = 0; i < count; ++i) {
+                if (locals[i].dirty) {
+                    worlds[i].matrix = composeLocal(locals[i]);
+                    ++worlds[i].version;
+                    locals[i].dirty = false;
+                }
+            }
+        });
+    TransformHierarchy::getDefault().update(world, parallel);
 }
 
 /**
@@ -63,7 +168,24 @@ void Transform::update(float deltaTime) {
 void Transform::setTransform(const EU::Vector3& newPos,
     const EU::Vector3& newRot,
     const EU::Vector3& newSca) {
-    position = newPos;
-    rotation = newRot;
-    scale = newSca;
+    setTransform(newPos, eulerToQuaternion(newRot), newSca);
+}
+
+void Transform::setTransform(const EU::Vector3& newPos,
+    const EU::Quaternion& newRot,
+    const EU::Vector3& newSca) {
+    LocalTransform& data = local();
+    data.position = newPos;
+    data.rotation = newRot;
+    data.scale = newSca;
+    data.dirty = true;
+}
+
+/**
+ * @brief Desplaza la posición y marca el transform para recalcular su matriz.
+ */
+void Transform::translate(const EU::Vector3& translation) {
+    LocalTransform& data = local();
+    data.position = data.position + translation;
+    data.dirty = true;
 }
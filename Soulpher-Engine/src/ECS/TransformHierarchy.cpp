@@ -0,0 +1,206 @@
+﻿/**
+ * @file TransformHierarchy.cpp
+ * @brief Implementación de la jerarquía de transforms.
+ */
+
+#include "ECS/TransformHierarchy.h"
+#include "ECS/Transform.h"
+#include "JobSystem.h"
+
+TransformHierarchy& TransformHierarchy::getDefault() {
+    static TransformHierarchy s_hierarchy;
+    return s_hierarchy;
+}
+
+bool TransformHierarchy::setParent(World& world, EntityID child, EntityID parent) {
+    if (!world.isAlive(child)) {
+        return false;
+    }
+    if (parent.isValid()) {
+        if (!world.isAlive(parent)) {
+            ERROR("TransformHierarchy", "setParent", "Parent entity is not alive");
+            return false;
+        }
+        for (EntityID ancestor = parent; ancestor.isValid(); ancestor = getParent(world, ancestor)) {
+            if (ancestor == child) {
+                ERROR("TransformHierarchy", "setParent", "Parenting would create a cycle");
+                return false;
+            }
+        }
+    }
+
+    const EntityID previous = getParent(world, child);
+    if (previous == parent) {
+        return true;
+    }
+    if (previous.isValid()) {
+        auto count = m_childCounts.find(previous.index);
+        if (count != m_childCounts.end() && --count->second == 0) {
+            m_childCounts.erase(count);
+        }
+    }
+    if (parent.isValid()) {
+        const Parent link = { parent };
+        world.add(child, link);
+        ++m_childCounts[parent.index];
+    }
+    else {
+        world.remove<Parent>(child);
+    }
+    if (LocalTransform* local = world.get<LocalTransform>(child)) {
+        local->dirty = true;
+    }
+    m_orderDirty = true;
+    return true;
+}
+
+EntityID TransformHierarchy::getParent(World& world, EntityID child) const {
+    const Parent* parent = world.get<Parent>(child);
+    return parent ? parent->entity : EntityID();
+}
+
+void TransformHierarchy::remove(World& world, EntityID entity) {
+    if (world.has<Parent>(entity)) {
+        setParent(world, entity, EntityID());
+    }
+    auto count = m_childCounts.find(entity.index);
+    if (count == m_childCounts.end()) {
+        return;
+    }
+    m_childCounts.erase(count);
+
+    std::vector<EntityID> children;
+    world.each<Parent>([&children, entity](EntityID id, Parent& parent) {
+        if (parent.entity == entity) {
+            children.push_back(id);
+        }
+    });
+    for (EntityID child : children) {
+        world.remove<Parent>(child);
+        if (LocalTransform* local = world.get<LocalTransform>(child)) {
+            local->dirty = true;
+        }
+    }
+    m_orderDirty = true;
+}
+
+/**
+ * @brief Preorden de todos los árboles: raíces ordenadas por índice de entidad para que
+ * el resultado no dependa del orden de los chunks.
+ */
+void TransformHierarchy::rebuild(World& world) {
+    std::unordered_map<uint32_t, std::vector<EntityID>> children;
+    std::vector<EntityID> roots;
+    world.each<Parent>([&](EntityID id, Parent& parent) {
+        std::vector<EntityID>& list = children[parent.entity.index];
+        if (list.empty() && !world.has<Parent>(parent.entity)) {
+            roots.push_back(parent.entity);
+        }
+        list.push_back(id);
+    });
+    std::sort(roots.begin(), roots.end(),
+        [](const EntityID& a, const EntityID& b) { return a.index < b.index; });
+
+    m_nodes.clear();
+    m_roots.clear();
+    struct Frame {
+        uint32_t node;
+        size_t next;
+    };
+    std::vector<Frame> stack;
+    for (const EntityID& root : roots) {
+        m_roots.push_back(static_cast<uint32_t>(m_nodes.size()));
+        Node node;
+        node.entity = root;
+        m_nodes.push_back(node);
+        stack.push_back({ static_cast<uint32_t>(m_nodes.size() - 1), 0 });
+        while (!stack.empty()) {
+            Frame& frame = stack.back();
+            auto found = children.find(m_nodes[frame.node].entity.index);
+            if (found == children.end() || frame.next == found->second.size()) {
+                m_nodes[frame.node].end = static_cast<uint32_t>(m_nodes.size());
+                stack.pop_back();
+                continue;
+            }
+            Node child;
+            child.entity = found->second[frame.next++];
+            child.parent = frame.node;
+            m_nodes.push_back(child);
+            stack.push_back({ static_cast<uint32_t>(m_nodes.size() - 1), 0 });
+        }
+    }
+
+    m_changed.assign(m_nodes.size(), 0);
+    m_cachedStructure = UINT64_MAX;
+    m_forceAll = true;
+    m_orderDirty = false;
+}
+
+void TransformHierarchy::refreshPointers(World& world) {
+    for (Node& node : m_nodes) {
+        node.local = world.get<LocalTransform>(node.entity);
+        node.world = world.get<WorldTransform>(node.entity);
+    }
+    m_cachedStructure = world.getStructureVersion();
+}
+
+void TransformHierarchy::update(World& world, bool parallel) {
+    if (m_orderDirty) {
+        rebuild(world);
+    }
+    m_updatedCount = 0;
+    if (m_nodes.empty()) {
+        return;
+    }
+    if (world.getStructureVersion() != m_cachedStructure) {
+        refreshPointers(world);
+    }
+
+    const uint32_t total = static_cast<uint32_t>(m_nodes.size());
+    JobSystem& jobs = JobSystem::getDefault();
+    if (!parallel || total < kMinParallelNodes || m_roots.size() < 2 || jobs.getThreadCount() < 2) {
+        m_updatedCount = updateRange(0, total);
+        m_forceAll = false;
+        return;
+    }
+
+    // Lotes de árboles completos: el lote de raíces [begin, end) son los nodos
+    // [m_roots[begin], m_roots[end]).
+    std::atomic<unsigned int> updated(0);
+    const uint32_t rootCount = static_cast<uint32_t>(m_roots.size());
+    jobs.parallelFor(rootCount, [this, &updated, rootCount, total](unsigned int begin, unsigned int end) {
+        const uint32_t last = end < rootCount ? m_roots[end] : total;
+        updated += updateRange(m_roots[begin], last);
+    });
+    m_updatedCount = updated;
+    m_forceAll = false;
+}
+
+unsigned int TransformHierarchy::updateRange(uint32_t begin, uint32_t end) {
+    unsigned int updated = 0;
+    for (uint32_t i = begin; i < end; ++i) {
+        Node& node = m_nodes[i];
+        if (!node.local || !node.world) {
+            m_changed[i] = 0;
+            continue;
+        }
+        if (node.parent == kNoParent) {
+            // Raíz: su matriz ya la calculó el pase plano; basta saber si cambió.
+            m_changed[i] = m_forceAll || node.world->version != node.seenVersion;
+            node.seenVersion = node.world->version;
+            continue;
+        }
+        if (!m_forceAll && !node.local->dirty && !m_changed[node.parent]) {
+            m_changed[i] = 0;
+            continue;
+        }
+        const WorldTransform* parentWorld = m_nodes[node.parent].world;
+        node.world->matrix = parentWorld ? Transform::composeLocal(*node.local) * parentWorld->matrix :
+            Transform::composeLocal(*node.local);
+        ++node.world->version;
+        node.local->dirty = false;
+        m_changed[i] = 1;
+        ++updated;
+    }
+    return updated;
+}
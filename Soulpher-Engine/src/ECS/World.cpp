@@ -0,0 +1,202 @@
+﻿/**
+ * @file World.cpp
+ * @brief Implementación del almacenamiento por arquetipos.
+ *
+ * @details
+ * Disposición de un chunk con `capacity` filas: primero `capacity` `EntityID`, después
+ * una columna por tipo (en orden de índice de tipo), cada una alineada a su tipo.
+ */
+
+#include "ECS/World.h"
+#include <malloc.h>
+
+namespace {
+    size_t alignUp(size_t value, size_t alignment) {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+}
+
+World& World::getDefault() {
+    static World s_world;
+    return s_world;
+}
+
+std::vector<World::TypeInfo>& World::typeRegistry() {
+    static std::vector<TypeInfo> s_types;
+    return s_types;
+}
+
+unsigned int World::registerType(size_t size, size_t align) {
+    std::vector<TypeInfo>& types = typeRegistry();
+    if (types.size() >= kMaxComponentTypes) {
+        ERROR("World", "registerType", "Too many component types");
+        return kMaxComponentTypes - 1;
+    }
+    types.push_back({ size, align });
+    return static_cast<unsigned int>(types.size() - 1);
+}
+
+EntityID World::create() {
+    EntityID id;
+    if (!m_freeRecords.empty()) {
+        id.index = m_freeRecords.back();
+        m_freeRecords.pop_back();
+    }
+    else {
+        id.index = static_cast<uint32_t>(m_records.size());
+        m_records.push_back(Record());
+    }
+    Record& record = m_records[id.index];
+    record.alive = true;
+    id.generation = record.generation;
+    allocateRow(findArchetype(0), id);
+    ++m_entityCount;
+    return id;
+}
+
+void World::destroy(EntityID id) {
+    if (!isAlive(id)) {
+        return;
+    }
+    Record& record = m_records[id.index];
+    freeRow(record.archetype, record.chunk, record.row);
+    record.alive = false;
+    ++record.generation;
+    m_freeRecords.push_back(id.index);
+    --m_entityCount;
+}
+
+void World::clear() {
+    for (Archetype* archetype : m_archetypes) {
+        for (Chunk& chunk : archetype->chunks) {
+            _aligned_free(chunk.data);
+        }
+        delete archetype;
+    }
+    m_archetypes.clear();
+    m_archetypeByMask.clear();
+    // Los registros se conservan (con otra generación) para que los handles viejos fallen.
+    m_freeRecords.clear();
+    for (uint32_t i = 0; i < m_records.size(); ++i) {
+        if (m_records[i].alive) {
+            m_records[i].alive = false;
+            ++m_records[i].generation;
+        }
+        m_freeRecords.push_back(i);
+    }
+    m_entityCount = 0;
+    ++m_structureVersion;
+}
+
+unsigned int World::getChunkCount() const {
+    size_t count = 0;
+    for (const Archetype* archetype : m_archetypes) {
+        count += archetype->chunks.size();
+    }
+    return static_cast<unsigned int>(count);
+}
+
+uint32_t World::findArchetype(ComponentMask mask) {
+    auto found = m_archetypeByMask.find(mask);
+    if (found != m_archetypeByMask.end()) {
+        return found->second;
+    }
+
+    const std::vector<TypeInfo>& registry = typeRegistry();
+    Archetype* archetype = new Archetype();
+    archetype->mask = mask;
+    size_t rowBytes = sizeof(EntityID);
+    size_t padding = 0;
+    for (unsigned int type = 0; type < kMaxComponentTypes; ++type) {
+        if (mask & (ComponentMask(1) << type)) {
+            archetype->types.push_back(type);
+            rowBytes += registry[type].size;
+            padding += registry[type].align;
+        }
+    }
+    // Capacidad conservadora: cabe con el peor relleno de alineación entre columnas.
+    archetype->capacity = static_cast<unsigned int>((kChunkBytes - padding) / rowBytes);
+    if (archetype->capacity == 0) {
+        ERROR("World", "findArchetype", "Components too large for a chunk; using one row per chunk");
+        archetype->capacity = 1;
+    }
+    size_t offset = archetype->capacity * sizeof(EntityID);
+    for (unsigned int type : archetype->types) {
+        offset = alignUp(offset, registry[type].align);
+        archetype->offsets[type] = offset;
+        offset += archetype->capacity * registry[type].size;
+    }
+    archetype->chunkBytes = offset > kChunkBytes ? offset : kChunkBytes;
+
+    const uint32_t index = static_cast<uint32_t>(m_archetypes.size());
+    m_archetypes.push_back(archetype);
+    m_archetypeByMask[mask] = index;
+    return index;
+}
+
+void World::allocateRow(uint32_t archetypeIndex, EntityID id) {
+    Archetype& archetype = *m_archetypes[archetypeIndex];
+    if (archetype.chunks.empty() || archetype.chunks.back().count == archetype.capacity) {
+        Chunk chunk;
+        chunk.data = static_cast<unsigned char*>(_aligned_malloc(archetype.chunkBytes, kChunkAlignment));
+        archetype.chunks.push_back(chunk);
+    }
+    Chunk& chunk = archetype.chunks.back();
+    const uint32_t row = chunk.count++;
+    ++m_structureVersion;
+    entitiesOf(chunk)[row] = id;
+
+    Record& record = m_records[id.index];
+    record.archetype = archetypeIndex;
+    record.chunk = static_cast<uint32_t>(archetype.chunks.size() - 1);
+    record.row = row;
+}
+
+void World::freeRow(uint32_t archetypeIndex, uint32_t chunkIndex, uint32_t row) {
+    Archetype& archetype = *m_archetypes[archetypeIndex];
+    const std::vector<TypeInfo>& registry = typeRegistry();
+    ++m_structureVersion;
+    Chunk& last = archetype.chunks.back();
+    const uint32_t lastRow = last.count - 1;
+    Chunk& chunk = archetype.chunks[chunkIndex];
+    if (&chunk != &last || row != lastRow) {
+        // La última fila del arquetipo ocupa el hueco: los chunks siguen compactos.
+        const EntityID moved = entitiesOf(last)[lastRow];
+        entitiesOf(chunk)[row] = moved;
+        for (unsigned int type : archetype.types) {
+            const size_t size = registry[type].size;
+            memcpy(chunk.data + archetype.offsets[type] + row * size,
+                last.data + archetype.offsets[type] + lastRow * size, size);
+        }
+        m_records[moved.index].chunk = chunkIndex;
+        m_records[moved.index].row = row;
+    }
+    if (--last.count == 0) {
+        _aligned_free(last.data);
+        archetype.chunks.pop_back();
+    }
+}
+
+void World::move(EntityID id, ComponentMask mask) {
+    const Record source = m_records[id.index];
+    const uint32_t target = findArchetype(mask);
+    // `findArchetype` puede haber ampliado `m_archetypes`: los punteros se toman después.
+    Archetype& from = *m_archetypes[source.archetype];
+    Archetype& to = *m_archetypes[target];
+    allocateRow(target, id);
+    const Record& destination = m_records[id.index];
+    const std::vector<TypeInfo>& registry = typeRegistry();
+    unsigned char* fromData = from.chunks[source.chunk].data;
+    unsigned char* toData = to.chunks[destination.chunk].data;
+    for (unsigned int type : to.types) {
+        const size_t size = registry[type].size;
+        unsigned char* dst = toData + to.offsets[type] + destination.row * size;
+        if (from.mask & (ComponentMask(1) << type)) {
+            memcpy(dst, fromData + from.offsets[type] + source.row * size, size);
+        }
+        else {
+            memset(dst, 0, size);
+        }
+    }
+    freeRow(source.archetype, source.chunk, source.row);
+}
@@ -0,0 +1,65 @@
+﻿/**
+ * @file EditorViewport.cpp
+ * @brief Target del panel de la escena y su relevo al cambiar de tamaño.
+ */
+
+#include "EditorViewport.h"
+#include "Device.h"
+#include "GpuReleaseQueue.h"
+
+HRESULT EditorViewport::resize(Device& device, unsigned int width, unsigned int height) {
+    if (width == m_width && height == m_height && (m_rtv != nullptr || width == 0 || height == 0)) {
+        return S_OK;
+    }
+
+    // La lista de la UI de este frame ya apunta al SRV actual: `GpuReleaseQueue` lo
+    // mantiene vivo hasta que la GPU termine el frame.
+    GpuReleaseQueue::getDefault().release(m_rtv);
+    m_rtv = nullptr;
+    m_texture.destroy();
+    m_width = width;
+    m_height = height;
+    if (width == 0 || height == 0) {
+        return S_OK;
+    }
+
+    D3D11_TEXTURE2D_DESC desc = {};
+    desc.Width = width;
+    desc.Height = height;
+    desc.MipLevels = 1;
+    desc.ArraySize = 1;
+    desc.Format = kFormat;
+    desc.SampleDesc.Count = 1;
+    desc.Usage = D3D11_USAGE_DEFAULT;
+    desc.BindFlags = D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
+    HRESULT hr = device.CreateTexture2D(&desc, nullptr, &m_texture.m_texture);
+    if (SUCCEEDED(hr)) { hr = device.CreateRenderTargetView(m_texture.m_texture, nullptr, &m_rtv); }
+    if (SUCCEEDED(hr)) { hr = device.CreateShaderResourceView(m_texture.m_texture, nullptr, &m_texture.m_textureFromImg); }
+    if (FAILED(hr)) {
+        ERROR("EditorViewport", "resize", ("Failed to create the viewport target " + std::to_string(width) + "x" +
+            std::to_string(height) + ". hr=" + std::to_string(hr)).c_str());
+        SAFE_RELEASE(m_rtv);
+        m_texture.destroy();
+        m_width = 0;
+        m_height = 0;
+        return hr;
+    }
+    return S_OK;
+}
+
+RenderTargetPool::Target EditorViewport::getViews() const {
+    RenderTargetPool::Target target;
+    target.texture = m_texture.raw();
+    target.rtv = m_rtv;
+    target.srv = m_texture.srv();
+    return target;
+}
+
+void EditorViewport::destroy() {
+    GpuReleaseQueue::getDefault().release(m_rtv);
+    m_rtv = nullptr;
+    m_texture.destroy();
+    m_width = 0;
+    m_height = 0;
+    m_visible = false;
+}
@@ -0,0 +1,68 @@
+﻿/**
+ * @file FrameArena.cpp
+ * @brief Implementación de los arenas por hilo.
+ */
+
+#include "FrameArena.h"
+
+namespace {
+    thread_local EU::LinearArena* t_arena = nullptr; // Arena del hilo actual.
+}
+
+std::vector<std::unique_ptr<EU::LinearArena>>& FrameArena::arenas() {
+    static std::vector<std::unique_ptr<EU::LinearArena>> s_arenas;
+    return s_arenas;
+}
+
+std::mutex& FrameArena::arenasMutex() {
+    static std::mutex s_mutex;
+    return s_mutex;
+}
+
+EU::LinearArena& FrameArena::local() {
+    if (!t_arena) {
+        std::unique_ptr<EU::LinearArena> arena(new EU::LinearArena(kBytesPerThread));
+        if (arena->GetCapacity() == 0) {
+            ERROR("FrameArena", "local", "Failed to allocate the thread arena; temporaries go to the heap");
+        }
+        t_arena = arena.get();
+        std::lock_guard<std::mutex> lock(arenasMutex());
+        arenas().push_back(std::move(arena));
+    }
+    return *t_arena;
+}
+
+const char* FrameArena::copy(const std::string& text) {
+    char* data = static_cast<char*>(local().Allocate(text.size() + 1, 1));
+    if (!data) {
+        return text.c_str();
+    }
+    memcpy(data, text.c_str(), text.size() + 1);
+    return data;
+}
+
+void FrameArena::reset() {
+    local().Reset();
+}
+
+/**
+ * @details Lee los contadores de otros hilos sin sincronizar: son estadísticas y un
+ * valor de hace un momento sirve igual.
+ */
+size_t FrameArena::getPeakBytes() {
+    std::lock_guard<std::mutex> lock(arenasMutex());
+    size_t peak = 0;
+    for (const auto& arena : arenas()) {
+        peak = (std::max)(peak, arena->GetPeak());
+    }
+    return peak;
+}
+
+size_t FrameArena::getFailureCount() {
+    std::lock_guard<std::mutex> lock(arenasMutex());
+    size_t failures = 0;
+    for (const auto& arena : arenas()) {
+        failures += arena->GetFailures();
+    }
+    return failures;
+}
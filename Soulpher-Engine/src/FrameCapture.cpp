@@ -0,0 +1,415 @@
+﻿/**
+ * @file FrameCapture.cpp
+ * @brief Implementación de la grabación de frames con readback en anillo.
+ *
+ * @details
+ * Media Foundation (`mfplat.lib`, `mfreadwrite.lib`, `mfuuid.lib`) viene con
+ * Windows 7 y posteriores. El sink writer recibe RGB32 (BGRX en memoria, de arriba
+ * abajo) y elige él mismo el conversor de color y el codificador H.264.
+ */
+
+#include "FrameCapture.h"
+#include "Screenshot.h"
+#include "Device.h"
+#include "DeviceContext.h"
+#include "GpuMemory.h"
+#include "Texture.h"
+#include <cstdio>
+#include <cstring>
+#include <mfapi.h>
+#include <mfidl.h>
+#include <mfreadwrite.h>
+
+HRESULT FrameCapture::init(Device& device) {
+    if (!device.m_device) {
+        ERROR("FrameCapture", "init", "Device is null.");
+        return E_POINTER;
+    }
+    destroy();
+    m_device = device.m_device;
+    m_device->AddRef();
+    return S_OK;
+}
+
+HRESULT FrameCapture::start(const Settings& settings) {
+    if (!m_device) {
+        ERROR("FrameCapture", "start", "Not initialized");
+        return E_POINTER;
+    }
+    if (m_recording) {
+        ERROR("FrameCapture", "start", "Already recording");
+        return E_FAIL;
+    }
+    if (settings.path.empty() || settings.fps == 0 || settings.interval == 0) {
+        ERROR("FrameCapture", "start", "Path, fps and interval must be set");
+        return E_INVALIDARG;
+    }
+
+    m_settings = settings;
+    if (settings.format == CAPTURE_FORMAT_H264) {
+        HRESULT hr = MFStartup(MF_VERSION);
+        if (FAILED(hr)) {
+            ERROR("FrameCapture", "start", "Media Foundation is not available");
+            return hr;
+        }
+        m_mediaFoundation = true;
+    }
+
+    m_frame = 0;
+    m_captured = 0;
+    m_nextReadback = 0;
+    m_backPressure = 0;
+    m_stopping = false;
+    m_encoded = 0;
+    m_videoWidth = 0;
+    m_videoHeight = 0;
+    m_videoFailed = false;
+
+    if (settings.format == CAPTURE_FORMAT_H264) {
+        m_workers.push_back(std::thread(&FrameCapture::videoLoop, this));
+    }
+    else {
+        const unsigned int cores = std::thread::hardware_concurrency();
+        const unsigned int workers = (std::max)(1u, (std::min)(kMaxPngWorkers, cores > 1 ? cores - 1 : 1));
+        for (unsigned int i = 0; i < workers; ++i) {
+            m_workers.push_back(std::thread(&FrameCapture::pngLoop, this));
+        }
+    }
+    m_recording = true;
+    MESSAGE("FrameCapture", "start", ("Recording to " + settings.path).c_str());
+    return S_OK;
+}
+
+void FrameCapture::update(DeviceContext& deviceContext, Texture& backBuffer) {
+    if (!m_recording) {
+        return;
+    }
+    ++m_frame;
+    readbackInOrder(deviceContext, false, false);
+
+    if ((m_frame - 1) % m_settings.interval != 0 || !backBuffer.raw()) {
+        return;
+    }
+    D3D11_TEXTURE2D_DESC desc;
+    backBuffer.raw()->GetDesc(&desc);
+    if (desc.SampleDesc.Count != 1 ||
+        (desc.Format != DXGI_FORMAT_R8G8B8A8_UNORM && desc.Format != DXGI_FORMAT_R8G8B8A8_UNORM_SRGB)) {
+        ERROR("FrameCapture", "update", "Back buffer must be single-sample RGBA8; recording stopped.");
+        stop(deviceContext);
+        return;
+    }
+
+    Slot* free = nullptr;
+    for (Slot& slot : m_slots) {
+        if (!slot.busy) {
+            free = &slot;
+            break;
+        }
+    }
+    if (!free) {
+        // Anillo lleno: esperar a la copia más antigua (contrapresión sobre la GPU).
+        ++m_backPressure;
+        readbackInOrder(deviceContext, true, false);
+        for (Slot& slot : m_slots) {
+            if (!slot.busy) {
+                free = &slot;
+                break;
+            }
+        }
+        if (!free) {
+            return;
+        }
+    }
+
+    if (!free->staging || free->desc.Width != desc.Width || free->desc.Height != desc.Height ||
+        free->desc.Format != desc.Format) {
+        SAFE_RELEASE(free->staging);
+        free->desc = desc;
+        free->desc.MipLevels = 1;
+        free->desc.ArraySize = 1;
+        free->desc.Usage = D3D11_USAGE_STAGING;
+        free->desc.BindFlags = 0;
+        free->desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+        free->desc.MiscFlags = 0;
+        if (FAILED(m_device->CreateTexture2D(&free->desc, nullptr, &free->staging))) {
+            ERROR("FrameCapture", "update", "Failed to create a staging texture; frame skipped.");
+            return;
+        }
+        GpuMemory::track(free->staging);
+    }
+    deviceContext.CopySubresourceRegion(free->staging, 0, 0, 0, 0, backBuffer.raw(), 0, nullptr);
+    free->frame = m_frame;
+    free->index = m_captured++;
+    free->busy = true;
+}
+
+void FrameCapture::readbackInOrder(DeviceContext& deviceContext, bool waitOldest, bool waitAll) {
+    for (;;) {
+        Slot* next = nullptr;
+        for (Slot& slot : m_slots) {
+            if (slot.busy && slot.index == m_nextReadback) {
+                next = &slot;
+                break;
+            }
+        }
+        if (!next) {
+            return;
+        }
+        const bool wait = waitAll || waitOldest;
+        if (!wait && m_frame - next->frame < kLatencyFrames) {
+            return;
+        }
+        if (!readback(deviceContext, *next, wait)) {
+            return;
+        }
+        ++m_nextReadback;
+        waitOldest = false;
+    }
+}
+
+bool FrameCapture::readback(DeviceContext& deviceContext, Slot& slot, bool wait) {
+    D3D11_MAPPED_SUBRESOURCE mapped = {};
+    HRESULT hr = deviceContext.Map(slot.staging, 0, D3D11_MAP_READ, wait ? 0 : D3D11_MAP_FLAG_DO_NOT_WAIT, &mapped);
+    if (hr == DXGI_ERROR_WAS_STILL_DRAWING) {
+        return false;
+    }
+    slot.busy = false;
+    if (FAILED(hr)) {
+        ERROR("FrameCapture", "readback", "Failed to map a captured frame; frame skipped.");
+        return true; // Se salta: los siguientes no pueden esperar a este para siempre.
+    }
+
+    Frame frame;
+    frame.index = slot.index;
+    frame.width = slot.desc.Width;
+    frame.height = slot.desc.Height;
+    const size_t rowBytes = static_cast<size_t>(frame.width) * 4;
+    frame.pixels.resize(rowBytes * frame.height);
+    for (unsigned int row = 0; row < frame.height; ++row) {
+        std::memcpy(frame.pixels.data() + row * rowBytes,
+            static_cast<const unsigned char*>(mapped.pData) + static_cast<size_t>(row) * mapped.RowPitch, rowBytes);
+    }
+    deviceContext.Unmap(slot.staging, 0);
+
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_frames.size() >= kMaxQueued) {
+            // Codificadores atrasados: frenar el render en vez de descartar el frame.
+            ++m_backPressure;
+            m_space.wait(lock, [this] { return m_frames.size() < kMaxQueued; });
+        }
+        m_frames.push_back(std::move(frame));
+    }
+    m_wake.notify_one();
+    return true;
+}
+
+void FrameCapture::pngLoop() {
+    const HRESULT com = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+    for (;;) {
+        Frame frame;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this] { return m_stopping || !m_frames.empty(); });
+            if (m_frames.empty()) {
+                break;
+            }
+            frame = std::move(m_frames.front());
+            m_frames.pop_front();
+        }
+        m_space.notify_one();
+
+        char suffix[32];
+        snprintf(suffix, sizeof(suffix), "_%06llu.png", frame.index);
+        HRESULT hr = Screenshot::writePng(m_settings.path + suffix, frame.width, frame.height,
+            frame.pixels.data(), frame.width * 4);
+        if (FAILED(hr)) {
+            ERROR("FrameCapture", "pngLoop", ("Failed to write " + m_settings.path + suffix).c_str());
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (SUCCEEDED(hr)) {
+            ++m_encoded;
+        }
+    }
+    if (SUCCEEDED(com)) {
+        CoUninitialize();
+    }
+}
+
+void FrameCapture::videoLoop() {
+    const HRESULT com = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+    for (;;) {
+        Frame frame;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this] { return m_stopping || !m_frames.empty(); });
+            if (m_frames.empty()) {
+                break;
+            }
+            frame = std::move(m_frames.front());
+            m_frames.pop_front();
+        }
+        m_space.notify_one();
+
+        if (!m_writer && !m_videoFailed && FAILED(openVideo(frame.width, frame.height))) {
+            ERROR("FrameCapture", "videoLoop", ("Failed to create H.264 writer for " + m_settings.path).c_str());
+            m_videoFailed = true;
+        }
+        if (m_videoFailed) {
+            continue;
+        }
+        HRESULT hr = writeVideoFrame(frame);
+        if (FAILED(hr)) {
+            ERROR("FrameCapture", "videoLoop", "Failed to encode a video frame");
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (SUCCEEDED(hr)) {
+            ++m_encoded;
+        }
+    }
+
+    if (m_writer) {
+        if (FAILED(m_writer->Finalize())) {
+            ERROR("FrameCapture", "videoLoop", ("Failed to finalize " + m_settings.path).c_str());
+        }
+        SAFE_RELEASE(m_writer);
+    }
+    if (SUCCEEDED(com)) {
+        CoUninitialize();
+    }
+}
+
+HRESULT FrameCapture::openVideo(unsigned int width, unsigned int height) {
+    m_videoWidth = width & ~1u;
+    m_videoHeight = height & ~1u;
+    if (m_videoWidth == 0 || m_videoHeight == 0) {
+        return E_INVALIDARG;
+    }
+
+    std::wstring widePath;
+    const int size = MultiByteToWideChar(CP_ACP, 0, m_settings.path.c_str(), -1, nullptr, 0);
+    if (size > 1) {
+        widePath.assign(static_cast<size_t>(size - 1), L'\0');
+        MultiByteToWideChar(CP_ACP, 0, m_settings.path.c_str(), -1, &widePath[0], size);
+    }
+
+    IMFMediaType* output = nullptr;
+    IMFMediaType* input = nullptr;
+    HRESULT hr = MFCreateSinkWriterFromURL(widePath.c_str(), nullptr, nullptr, &m_writer);
+    if (SUCCEEDED(hr)) hr = MFCreateMediaType(&output);
+    if (SUCCEEDED(hr)) hr = output->SetGUID(MF_MT_MAJOR_TYPE, MFMediaType_Video);
+    if (SUCCEEDED(hr)) hr = output->SetGUID(MF_MT_SUBTYPE, MFVideoFormat_H264);
+    if (SUCCEEDED(hr)) hr = output->SetUINT32(MF_MT_AVG_BITRATE, m_settings.bitrate);
+    if (SUCCEEDED(hr)) hr = output->SetUINT32(MF_MT_INTERLACE_MODE, MFVideoInterlace_Progressive);
+    if (SUCCEEDED(hr)) hr = MFSetAttributeSize(output, MF_MT_FRAME_SIZE, m_videoWidth, m_videoHeight);
+    if (SUCCEEDED(hr)) hr = MFSetAttributeRatio(output, MF_MT_FRAME_RATE, m_settings.fps, 1);
+    if (SUCCEEDED(hr)) hr = MFSetAttributeRatio(output, MF_MT_PIXEL_ASPECT_RATIO, 1, 1);
+    if (SUCCEEDED(hr)) hr = m_writer->AddStream(output, &m_stream);
+
+    if (SUCCEEDED(hr)) hr = MFCreateMediaType(&input);
+    if (SUCCEEDED(hr)) hr = input->SetGUID(MF_MT_MAJOR_TYPE, MFMediaType_Video);
+    if (SUCCEEDED(hr)) hr = input->SetGUID(MF_MT_SUBTYPE, MFVideoFormat_RGB32);
+    if (SUCCEEDED(hr)) hr = input->SetUINT32(MF_MT_INTERLACE_MODE, MFVideoInterlace_Progressive);
+    if (SUCCEEDED(hr)) hr = input->SetUINT32(MF_MT_DEFAULT_STRIDE, m_videoWidth * 4); // Positivo: de arriba abajo.
+    if (SUCCEEDED(hr)) hr = MFSetAttributeSize(input, MF_MT_FRAME_SIZE, m_videoWidth, m_videoHeight);
+    if (SUCCEEDED(hr)) hr = MFSetAttributeRatio(input, MF_MT_FRAME_RATE, m_settings.fps, 1);
+    if (SUCCEEDED(hr)) hr = MFSetAttributeRatio(input, MF_MT_PIXEL_ASPECT_RATIO, 1, 1);
+    if (SUCCEEDED(hr)) hr = m_writer->SetInputMediaType(m_stream, input, nullptr);
+    if (SUCCEEDED(hr)) hr = m_writer->BeginWriting();
+
+    SAFE_RELEASE(input);
+    SAFE_RELEASE(output);
+    if (FAILED(hr)) {
+        SAFE_RELEASE(m_writer);
+    }
+    return hr;
+}
+
+HRESULT FrameCapture::writeVideoFrame(const Frame& frame) {
+    if (frame.width < m_videoWidth || frame.height < m_videoHeight) {
+        return E_INVALIDARG; // La ventana encogió a mitad de grabación: el vídeo no cambia de tamaño.
+    }
+    const DWORD stride = m_videoWidth * 4;
+    const DWORD bytes = stride * m_videoHeight;
+    const LONGLONG duration = 10000000LL / m_settings.fps; // Unidades de 100 ns.
+
+    IMFMediaBuffer* buffer = nullptr;
+    IMFSample* sample = nullptr;
+    BYTE* data = nullptr;
+    HRESULT hr = MFCreateMemoryBuffer(bytes, &buffer);
+    if (SUCCEEDED(hr)) hr = buffer->Lock(&data, nullptr, nullptr);
+    if (SUCCEEDED(hr)) {
+        // RGBA -> BGRX.
+        for (unsigned int y = 0; y < m_videoHeight; ++y) {
+            const unsigned char* src = frame.pixels.data() + static_cast<size_t>(y) * frame.width * 4;
+            BYTE* dst = data + static_cast<size_t>(y) * stride;
+            for (unsigned int x = 0; x < m_videoWidth; ++x, src += 4, dst += 4) {
+                dst[0] = src[2];
+                dst[1] = src[1];
+                dst[2] = src[0];
+                dst[3] = 255;
+            }
+        }
+        buffer->Unlock();
+        hr = buffer->SetCurrentLength(bytes);
+    }
+    if (SUCCEEDED(hr)) hr = MFCreateSample(&sample);
+    if (SUCCEEDED(hr)) hr = sample->AddBuffer(buffer);
+    if (SUCCEEDED(hr)) hr = sample->SetSampleTime(static_cast<LONGLONG>(frame.index) * duration);
+    if (SUCCEEDED(hr)) hr = sample->SetSampleDuration(duration);
+    if (SUCCEEDED(hr)) hr = m_writer->WriteSample(m_stream, sample);
+
+    SAFE_RELEASE(sample);
+    SAFE_RELEASE(buffer);
+    return hr;
+}
+
+void FrameCapture::stop(DeviceContext& deviceContext) {
+    if (!m_recording) {
+        return;
+    }
+    readbackInOrder(deviceContext, true, true);
+    stopWorkers();
+    if (m_mediaFoundation) {
+        MFShutdown();
+        m_mediaFoundation = false;
+    }
+    m_recording = false;
+    MESSAGE("FrameCapture", "stop", ("Recorded " + std::to_string(m_encoded) + " frames to " + m_settings.path).c_str());
+}
+
+void FrameCapture::stopWorkers() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    for (std::thread& worker : m_workers) {
+        worker.join();
+    }
+    m_workers.clear();
+}
+
+unsigned long long FrameCapture::getEncodedCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_encoded;
+}
+
+void FrameCapture::destroy() {
+    if (m_recording) {
+        stopWorkers();
+        if (m_mediaFoundation) {
+            MFShutdown();
+            m_mediaFoundation = false;
+        }
+        m_recording = false;
+    }
+    for (Slot& slot : m_slots) {
+        SAFE_RELEASE(slot.staging);
+        slot.busy = false;
+    }
+    m_frames.clear();
+    SAFE_RELEASE(m_device);
+}
@@ -0,0 +1,41 @@
+﻿/**
+ * @file FrameClock.cpp
+ * @brief Implementación del reloj de frame con `QueryPerformanceCounter`.
+ */
+
+#include "FrameClock.h"
+
+const double FrameClock::kDefaultFixedStep = 1.0 / 60.0;
+const double FrameClock::kMaxFrameTime = 0.25;
+
+void FrameClock::init(double fixedStep) {
+    QueryPerformanceFrequency(&m_frequency);
+    QueryPerformanceCounter(&m_lastCounter);
+    m_fixedStep = (fixedStep > 0.0) ? fixedStep : kDefaultFixedStep;
+    m_accumulator = m_fixedStep;
+    m_deltaTime = 0.0;
+    m_rawDeltaTime = 0.0;
+    m_totalTime = 0.0;
+    m_frameCount = 0;
+}
+
+void FrameClock::tick() {
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    m_rawDeltaTime = static_cast<double>(now.QuadPart - m_lastCounter.QuadPart) /
+        static_cast<double>(m_frequency.QuadPart);
+    m_lastCounter = now;
+
+    m_deltaTime = m_lockedDelta > 0.0 ? m_lockedDelta : (std::min)(m_rawDeltaTime, kMaxFrameTime);
+    m_accumulator += m_deltaTime;
+    m_totalTime += m_deltaTime;
+    ++m_frameCount;
+}
+
+bool FrameClock::stepFixed() {
+    if (m_accumulator < m_fixedStep) {
+        return false;
+    }
+    m_accumulator -= m_fixedStep;
+    return true;
+}
@@ -0,0 +1,91 @@
+﻿/**
+ * @file FrameLimiter.cpp
+ * @brief Implementación del limitador de FPS.
+ */
+
+#include "FrameLimiter.h"
+#include <mmsystem.h>
+
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+const double FrameLimiter::kSpinTime = 0.0005;
+const double FrameLimiter::kLegacySpinTime = 0.002;
+
+HRESULT FrameLimiter::init(double targetFps) {
+    destroy();
+    QueryPerformanceFrequency(&m_frequency);
+
+    m_timer = CreateWaitableTimerExW(nullptr, nullptr,
+        CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+    m_highResolution = (m_timer != nullptr);
+    if (!m_timer) {
+        m_timer = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+        m_raisedPeriod = (timeBeginPeriod(1) == TIMERR_NOERROR);
+    }
+
+    setTargetFps(targetFps);
+    if (!m_timer) {
+        ERROR("FrameLimiter", "init", "Cannot create waitable timer, falling back to spinning.");
+        return HRESULT_FROM_WIN32(GetLastError());
+    }
+    return S_OK;
+}
+
+void FrameLimiter::setTargetFps(double targetFps) {
+    m_targetFps = (targetFps > 0.0) ? targetFps : 0.0;
+    m_periodTicks = (m_targetFps > 0.0)
+        ? static_cast<LONGLONG>(static_cast<double>(m_frequency.QuadPart) / m_targetFps)
+        : 0;
+    reset();
+}
+
+void FrameLimiter::reset() {
+    QueryPerformanceCounter(&m_nextFrame);
+}
+
+void FrameLimiter::wait() {
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    if (m_periodTicks <= 0) {
+        return;
+    }
+
+    m_nextFrame.QuadPart += m_periodTicks;
+    if (now.QuadPart >= m_nextFrame.QuadPart) {
+        // Frame tarde: no se intenta recuperar, la cadencia sigue desde ahora.
+        m_nextFrame = now;
+        return;
+    }
+
+    // Espera gruesa en el timer (unidades de 100 ns, negativo = relativo).
+    const double remaining = static_cast<double>(m_nextFrame.QuadPart - now.QuadPart) /
+        static_cast<double>(m_frequency.QuadPart);
+    const double spin = m_highResolution ? kSpinTime : kLegacySpinTime;
+    if (m_timer && remaining > spin) {
+        LARGE_INTEGER due;
+        due.QuadPart = -static_cast<LONGLONG>((remaining - spin) * 1.0e7);
+        if (SetWaitableTimer(m_timer, &due, 0, nullptr, nullptr, FALSE)) {
+            WaitForSingleObject(m_timer, INFINITE);
+        }
+    }
+
+    // Tramo final activo hasta el instante exacto.
+    do {
+        YieldProcessor();
+        QueryPerformanceCounter(&now);
+    } while (now.QuadPart < m_nextFrame.QuadPart);
+}
+
+void FrameLimiter::destroy() {
+    if (m_timer) {
+        CloseHandle(m_timer);
+        m_timer = nullptr;
+    }
+    if (m_raisedPeriod) {
+        timeEndPeriod(1);
+        m_raisedPeriod = false;
+    }
+    m_highResolution = false;
+}
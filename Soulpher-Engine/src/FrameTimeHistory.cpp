@@ -0,0 +1,164 @@
+﻿/**
+ * @file FrameTimeHistory.cpp
+ * @brief Implementación del historial de tiempos de frame y la captura de tirones.
+ */
+
+#include "FrameTimeHistory.h"
+#include <cstdio>
+
+const double FrameTimeHistory::kDefaultHitchMs = 1000.0 / 30.0;
+
+namespace {
+    /// Percentil `p` (0..1) de una lista ya ordenada (rango más cercano, como `Benchmark`).
+    float percentile(const std::vector<float>& sorted, double p) {
+        if (sorted.empty()) {
+            return 0.0f;
+        }
+        const size_t rank = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+        return sorted[(std::min)(rank, sorted.size() - 1)];
+    }
+
+    /// Cadena JSON con comillas y barras escapadas.
+    std::string jsonString(const std::string& text) {
+        std::string out = "\"";
+        for (char c : text) {
+            if (c == '"' || c == '\\') out += '\\';
+            out += c;
+        }
+        return out + "\"";
+    }
+}
+
+void FrameTimeHistory::recordFrame(double frameSeconds, const CpuProfiler& cpuProfiler,
+    const GpuProfiler& gpuProfiler) {
+    // Completar los tirones que esperaban sus pases de GPU.
+    const bool newGpuResults = gpuProfiler.getResultSerial() != m_gpuSerial;
+    m_gpuSerial = gpuProfiler.getResultSerial();
+    for (Hitch& hitch : m_hitches) {
+        if (hitch.gpuFramesLeft == 0 || --hitch.gpuFramesLeft > 0) {
+            continue;
+        }
+        if (newGpuResults) {
+            hitch.gpuPasses = gpuProfiler.getResults();
+            hitch.gpuFrameBegin = gpuProfiler.getFrameBegin();
+            hitch.gpuFrequency = gpuProfiler.getFrequency();
+        }
+        else {
+            hitch.gpuMissing = true;
+        }
+    }
+
+    if (m_skipNext) {
+        m_skipNext = false;
+        return;
+    }
+
+    const float ms = static_cast<float>(frameSeconds * 1000.0);
+    m_frames[m_written % kCapacity] = ms;
+    ++m_written;
+    if (ms <= m_hitchMs) {
+        return;
+    }
+
+    ++m_hitchCount;
+    if (m_hitches.size() == kMaxHitches) {
+        m_hitches.pop_front();
+    }
+    m_hitches.push_back(Hitch());
+    Hitch& hitch = m_hitches.back();
+    hitch.frame = m_written - 1;
+    hitch.ms = ms;
+    if (cpuProfiler.getFrameCount() > 0) {
+        const CpuProfiler::Frame frame = cpuProfiler.getFrame(0);
+        hitch.cpuBegin = frame.begin;
+        hitch.cpuEnd = frame.end;
+        const unsigned int threads = cpuProfiler.collect(frame.begin, frame.end, hitch.cpuEvents);
+        for (unsigned int t = 0; t < threads; ++t) {
+            hitch.threadNames.push_back(cpuProfiler.getThreadName(t));
+        }
+    }
+    if (gpuProfiler.isEnabled()) {
+        hitch.gpuFramesLeft = GpuProfiler::kFrameLatency;
+    }
+    else {
+        hitch.gpuMissing = true;
+    }
+}
+
+float FrameTimeHistory::getFrameMs(unsigned int back) const {
+    if (back >= getCount()) {
+        return 0.0f;
+    }
+    return m_frames[(m_written - 1 - back) % kCapacity];
+}
+
+FrameTimeHistory::Percentiles FrameTimeHistory::getPercentiles() const {
+    Percentiles result;
+    const unsigned int count = getCount();
+    if (count == 0) {
+        return result;
+    }
+    std::vector<float> sorted(m_frames, m_frames + count);
+    std::sort(sorted.begin(), sorted.end());
+    result.p50 = percentile(sorted, 0.50);
+    result.p95 = percentile(sorted, 0.95);
+    result.p99 = percentile(sorted, 0.99);
+    return result;
+}
+
+void FrameTimeHistory::buildHistogram(float* bins, unsigned int binCount, float maxMs) const {
+    std::fill(bins, bins + binCount, 0.0f);
+    if (binCount == 0 || maxMs <= 0.0f) {
+        return;
+    }
+    const unsigned int count = getCount();
+    for (unsigned int i = 0; i < count; ++i) {
+        const unsigned int bin = static_cast<unsigned int>(m_frames[i] / maxMs * binCount);
+        bins[(std::min)(bin, binCount - 1)] += 1.0f;
+    }
+}
+
+void FrameTimeHistory::clear() {
+    m_written = 0;
+    m_hitches.clear();
+    m_hitchCount = 0;
+}
+
+HRESULT FrameTimeHistory::writeHitchTrace(size_t index, const std::string& path,
+    const CpuProfiler& cpuProfiler) const {
+    if (index >= m_hitches.size()) {
+        return E_INVALIDARG;
+    }
+    const Hitch& hitch = m_hitches[index];
+    FILE* file = nullptr;
+    if (fopen_s(&file, path.c_str(), "w") != 0 || !file) {
+        ERROR("FrameTimeHistory", "writeHitchTrace", ("Cannot write " + path).c_str());
+        return E_FAIL;
+    }
+
+    const double usPerTick = cpuProfiler.toMs(1) * 1000.0;
+    fprintf(file, "{\"traceEvents\":[\n");
+    fprintf(file, "{\"ph\":\"X\",\"name\":\"Frame %llu (%.2f ms)\",\"pid\":1,\"tid\":0,\"ts\":0,\"dur\":%.3f}",
+        hitch.frame, hitch.ms, hitch.ms * 1000.0);
+    for (size_t t = 0; t < hitch.threadNames.size(); ++t) {
+        fprintf(file, ",\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%zu,\"args\":{\"name\":%s}}",
+            t + 1, jsonString(hitch.threadNames[t]).c_str());
+    }
+    for (const CpuProfiler::ThreadEvent& e : hitch.cpuEvents) {
+        fprintf(file, ",\n{\"ph\":\"X\",\"name\":%s,\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+            jsonString(e.event.name).c_str(), e.thread + 1,
+            (e.event.begin - hitch.cpuBegin) * usPerTick, (e.event.end - e.event.begin) * usPerTick);
+    }
+    if (!hitch.gpuPasses.empty() && hitch.gpuFrequency > 0) {
+        const double usPerGpuTick = 1e6 / static_cast<double>(hitch.gpuFrequency);
+        fprintf(file, ",\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":1000,\"args\":{\"name\":\"GPU\"}}");
+        for (const GpuProfiler::Result& pass : hitch.gpuPasses) {
+            fprintf(file, ",\n{\"ph\":\"X\",\"name\":%s,\"pid\":1,\"tid\":1000,\"ts\":%.3f,\"dur\":%.3f}",
+                jsonString(pass.name).c_str(), (pass.begin - hitch.gpuFrameBegin) * usPerGpuTick,
+                (pass.end - pass.begin) * usPerGpuTick);
+        }
+    }
+    fprintf(file, "\n]}\n");
+    fclose(file);
+    return S_OK;
+}
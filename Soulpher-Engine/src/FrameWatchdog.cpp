@@ -0,0 +1,194 @@
+﻿/**
+ * @file FrameWatchdog.cpp
+ * @brief Implementación del vigilante de presupuestos por etapa y de su volcado.
+ */
+
+#include "FrameWatchdog.h"
+#include "CpuProfiler.h"
+#include "GpuProfiler.h"
+#include <cstdio>
+
+namespace {
+    /// Cadena JSON con comillas y barras escapadas.
+    std::string jsonString(const std::string& text) {
+        std::string out = "\"";
+        for (char c : text) {
+            if (c == '"' || c == '\\') out += '\\';
+            out += c;
+        }
+        return out + "\"";
+    }
+
+    LONGLONG now() {
+        LARGE_INTEGER counter;
+        QueryPerformanceCounter(&counter);
+        return counter.QuadPart;
+    }
+}
+
+FrameWatchdog::FrameWatchdog() {
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    m_ticksToMs = 1000.0 / static_cast<double>(frequency.QuadPart);
+}
+
+FrameWatchdog::Scope::Scope(FrameWatchdog& watchdog, BudgetStage stage) :
+    m_watchdog(watchdog), m_stage(stage), m_start(watchdog.m_settings.enabled ? now() : 0) {}
+
+FrameWatchdog::Scope::~Scope() {
+    if (m_start != 0) {
+        m_watchdog.m_current[m_stage] += (now() - m_start) * m_watchdog.m_ticksToMs;
+    }
+}
+
+const char* FrameWatchdog::getStageName(BudgetStage stage) {
+    switch (stage) {
+    case BUDGET_UPDATE:     return "Update";
+    case BUDGET_CULLING:    return "Culling";
+    case BUDGET_SUBMISSION: return "Submission";
+    case BUDGET_GPU:        return "GPU";
+    default:                return "Unknown";
+    }
+}
+
+float FrameWatchdog::getLastMs(BudgetStage stage) const {
+    return m_written > 0 ? m_samples[(m_written - 1) % kHistory].stageMs[stage] : 0.0f;
+}
+
+/**
+ * @details El tiempo de GPU solo cuenta cuando llega un resultado nuevo: un frame que el
+ * perfilador descartó no rompe ni reinicia la racha.
+ */
+bool FrameWatchdog::endFrame(double frameMs, const GpuProfiler& gpuProfiler, const CpuProfiler& cpuProfiler,
+    const SceneStats& scene) {
+    double current[BUDGET_STAGE_COUNT];
+    for (unsigned int s = 0; s < BUDGET_STAGE_COUNT; ++s) {
+        current[s] = m_current[s];
+        m_current[s] = 0.0;
+    }
+    if (!m_settings.enabled) {
+        return false;
+    }
+
+    const bool newGpuResult = gpuProfiler.isEnabled() && gpuProfiler.getResultSerial() != m_gpuSerial;
+    m_gpuSerial = gpuProfiler.getResultSerial();
+    current[BUDGET_GPU] = gpuProfiler.isEnabled() ? gpuProfiler.getFrameTime() : 0.0;
+
+    Sample& sample = m_samples[m_written % kHistory];
+    sample.frame = m_written;
+    sample.end = now();
+    sample.frameMs = static_cast<float>(frameMs);
+    for (unsigned int s = 0; s < BUDGET_STAGE_COUNT; ++s) {
+        sample.stageMs[s] = static_cast<float>(current[s]);
+    }
+    ++m_written;
+
+    int trigger = -1;
+    for (unsigned int s = 0; s < BUDGET_STAGE_COUNT; ++s) {
+        if (s == BUDGET_GPU && !newGpuResult) {
+            continue;
+        }
+        const float budget = m_settings.budgetMs[s];
+        m_overBudget[s] = (budget > 0.0f && current[s] > budget) ? m_overBudget[s] + 1 : 0;
+        if (trigger < 0 && m_overBudget[s] >= (std::max)(m_settings.consecutiveFrames, 1u)) {
+            trigger = static_cast<int>(s);
+        }
+    }
+    if (trigger < 0) {
+        return false;
+    }
+    if (m_lastDump != 0 && (sample.end - m_lastDump) * m_ticksToMs < m_settings.cooldownSeconds * 1000.0) {
+        return false;
+    }
+
+    const std::string path = "watchdog_" + std::to_string(sample.frame) + ".json";
+    m_lastDump = sample.end;
+    for (unsigned int& frames : m_overBudget) {
+        frames = 0;
+    }
+    if (FAILED(writeDump(path, static_cast<BudgetStage>(trigger), gpuProfiler, cpuProfiler, scene))) {
+        return false;
+    }
+    ++m_dumpCount;
+    m_lastDumpPath = path;
+    LOG_WARNING("FrameWatchdog", getStageName(static_cast<BudgetStage>(trigger)) << " over budget for " <<
+        m_settings.consecutiveFrames << " frames, wrote " << path);
+    return true;
+}
+
+/**
+ * @details Un proceso por carril: las etapas como contadores ("C") en el reloj de QPC,
+ * las zonas de CPU en el mismo reloj y los pases de GPU del último resultado, que no se
+ * alinean con él (ver `FrameTimeHistory::writeHitchTrace`), al final del intervalo.
+ */
+HRESULT FrameWatchdog::writeDump(const std::string& path, BudgetStage trigger, const GpuProfiler& gpuProfiler,
+    const CpuProfiler& cpuProfiler, const SceneStats& scene) const {
+    FILE* file = nullptr;
+    if (fopen_s(&file, path.c_str(), "w") != 0 || !file) {
+        ERROR("FrameWatchdog", "writeDump", ("Cannot write " + path).c_str());
+        return E_FAIL;
+    }
+
+    // Muestras de los últimos `dumpSeconds`, de la más antigua a la más nueva.
+    const unsigned long long available = (std::min)(m_written, static_cast<unsigned long long>(kHistory));
+    const LONGLONG last = m_samples[(m_written - 1) % kHistory].end;
+    const double windowMs = m_settings.dumpSeconds * 1000.0;
+    unsigned long long count = 0;
+    while (count < available &&
+        (last - m_samples[(m_written - 1 - count) % kHistory].end) * m_ticksToMs <= windowMs) {
+        ++count;
+    }
+    const Sample& oldest = m_samples[(m_written - count) % kHistory];
+    const LONGLONG origin = oldest.end - static_cast<LONGLONG>(oldest.frameMs / m_ticksToMs);
+    const double usPerTick = m_ticksToMs * 1000.0;
+
+    fprintf(file, "{\"traceEvents\":[\n");
+    fprintf(file, "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":1,\"args\":{\"name\":\"Budgets\"}}");
+    for (unsigned long long i = m_written - count; i < m_written; ++i) {
+        const Sample& sample = m_samples[i % kHistory];
+        const double ts = (sample.end - origin) * usPerTick;
+        fprintf(file, ",\n{\"ph\":\"X\",\"name\":\"Frame %llu\",\"pid\":1,\"tid\":0,\"ts\":%.3f,\"dur\":%.3f}",
+            sample.frame, ts - sample.frameMs * 1000.0, sample.frameMs * 1000.0);
+        fprintf(file, ",\n{\"ph\":\"C\",\"name\":\"Stage ms\",\"pid\":1,\"ts\":%.3f,\"args\":{", ts);
+        for (unsigned int s = 0; s < BUDGET_STAGE_COUNT; ++s) {
+            fprintf(file, "%s\"%s\":%.3f", s ? "," : "", getStageName(static_cast<BudgetStage>(s)), sample.stageMs[s]);
+        }
+        fprintf(file, "}}");
+    }
+
+    // Zonas de CPU del intervalo (el anillo de cada hilo puede no llegar tan atrás).
+    std::vector<CpuProfiler::ThreadEvent> events;
+    const unsigned int threads = cpuProfiler.collect(origin, last, events);
+    for (unsigned int t = 0; t < threads; ++t) {
+        fprintf(file, ",\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":2,\"tid\":%u,\"args\":{\"name\":%s}}",
+            t, jsonString(cpuProfiler.getThreadName(t)).c_str());
+    }
+    for (const CpuProfiler::ThreadEvent& e : events) {
+        fprintf(file, ",\n{\"ph\":\"X\",\"name\":%s,\"pid\":2,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+            jsonString(e.event.name).c_str(), e.thread, (e.event.begin - origin) * usPerTick,
+            (e.event.end - e.event.begin) * usPerTick);
+    }
+
+    if (gpuProfiler.isEnabled() && gpuProfiler.getFrequency() > 0) {
+        const double usPerGpuTick = 1e6 / static_cast<double>(gpuProfiler.getFrequency());
+        const double gpuStart = (last - origin) * usPerTick - gpuProfiler.getFrameTime() * 1000.0;
+        fprintf(file, ",\n{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":3,\"args\":{\"name\":\"GPU (last result)\"}}");
+        for (const GpuProfiler::Result& pass : gpuProfiler.getResults()) {
+            fprintf(file, ",\n{\"ph\":\"X\",\"name\":%s,\"pid\":3,\"tid\":0,\"ts\":%.3f,\"dur\":%.3f}",
+                jsonString(pass.name).c_str(), gpuStart + (pass.begin - gpuProfiler.getFrameBegin()) * usPerGpuTick,
+                (pass.end - pass.begin) * usPerGpuTick);
+        }
+    }
+    fprintf(file, "\n],\n\"otherData\":{\"trigger\":%s,\"consecutiveFrames\":%u",
+        jsonString(getStageName(trigger)).c_str(), m_settings.consecutiveFrames);
+    for (unsigned int s = 0; s < BUDGET_STAGE_COUNT; ++s) {
+        fprintf(file, ",\"budget%sMs\":%.3f", getStageName(static_cast<BudgetStage>(s)), m_settings.budgetMs[s]);
+    }
+    fprintf(file, ",\"actors\":%u,\"visibleActors\":%u,\"occludedActors\":%u,\"drawCalls\":%u,"
+        "\"primitives\":%llu,\"stateChanges\":%u,\"uploadBytes\":%llu,\"commandLists\":%u,\"stalls\":%u,"
+        "\"gpuMemoryBytes\":%zu}}\n",
+        scene.actors, scene.visibleActors, scene.occludedActors, scene.drawCalls, scene.primitives,
+        scene.stateChanges, scene.uploadBytes, scene.commandLists, scene.stalls, scene.gpuMemoryBytes);
+    fclose(file);
+    return S_OK;
+}
@@ -0,0 +1,69 @@
+﻿/**
+ * @file Frustum.cpp
+ * @brief Extracción de planos y pruebas de visibilidad.
+ */
+
+#include "Frustum.h"
+
+void Frustum::update(const XMMATRIX& viewProjection) {
+    // Las filas de la transpuesta son las columnas de la matriz original.
+    XMMATRIX m = XMMatrixTranspose(viewProjection);
+
+    XMVECTOR planes[FRUSTUM_PLANE_COUNT];
+    planes[FRUSTUM_LEFT] = XMVectorAdd(m.r[3], m.r[0]);
+    planes[FRUSTUM_RIGHT] = XMVectorSubtract(m.r[3], m.r[0]);
+    planes[FRUSTUM_BOTTOM] = XMVectorAdd(m.r[3], m.r[1]);
+    planes[FRUSTUM_TOP] = XMVectorSubtract(m.r[3], m.r[1]);
+    planes[FRUSTUM_NEAR] = m.r[2];
+    planes[FRUSTUM_FAR] = XMVectorSubtract(m.r[3], m.r[2]);
+
+    for (unsigned int i = 0; i < FRUSTUM_PLANE_COUNT; ++i) {
+        XMStoreFloat4(&m_planes[i], XMPlaneNormalize(planes[i]));
+    }
+}
+
+bool Frustum::intersectsSphere(const XMFLOAT3& center, float radius) const {
+    for (unsigned int i = 0; i < FRUSTUM_PLANE_COUNT; ++i) {
+        const XMFLOAT4& p = m_planes[i];
+        if (p.x * center.x + p.y * center.y + p.z * center.z + p.w < -radius) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Frustum::intersectsAABB(const XMFLOAT3& boundsMin, const XMFLOAT3& boundsMax) const {
+    for (unsigned int i = 0; i < FRUSTUM_PLANE_COUNT; ++i) {
+        const XMFLOAT4& p = m_planes[i];
+        // Vértice de la caja más adentro en la dirección de la normal.
+        const float x = (p.x >= 0.0f) ? boundsMax.x : boundsMin.x;
+        const float y = (p.y >= 0.0f) ? boundsMax.y : boundsMin.y;
+        const float z = (p.z >= 0.0f) ? boundsMax.z : boundsMin.z;
+        if (p.x * x + p.y * y + p.z * z + p.w < 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Frustum::transformAABB(const XMFLOAT3& localMin, const XMFLOAT3& localMax,
+    const XMMATRIX& world, XMFLOAT3& outMin, XMFLOAT3& outMax) {
+    XMFLOAT4X4 m;
+    XMStoreFloat4x4(&m, world);
+
+    const float c[3] = { (localMin.x + localMax.x) * 0.5f,
+                         (localMin.y + localMax.y) * 0.5f,
+                         (localMin.z + localMax.z) * 0.5f };
+    const float e[3] = { (localMax.x - localMin.x) * 0.5f,
+                         (localMax.y - localMin.y) * 0.5f,
+                         (localMax.z - localMin.z) * 0.5f };
+
+    float wc[3], we[3];
+    for (int j = 0; j < 3; ++j) {
+        wc[j] = c[0] * m.m[0][j] + c[1] * m.m[1][j] + c[2] * m.m[2][j] + m.m[3][j];
+        we[j] = e[0] * fabsf(m.m[0][j]) + e[1] * fabsf(m.m[1][j]) + e[2] * fabsf(m.m[2][j]);
+    }
+
+    outMin = XMFLOAT3(wc[0] - we[0], wc[1] - we[1], wc[2] - we[2]);
+    outMax = XMFLOAT3(wc[0] + we[0], wc[1] + we[1], wc[2] + we[2]);
+}
@@ -0,0 +1,360 @@
+﻿/**
+ * @file GeometryPool.cpp
+ * @brief Implementación del pool de geometría de la escena.
+ */
+
+#include "GeometryPool.h"
+#include "Device.h"
+#include "DeviceContext.h"
+#include <algorithm>
+
+const float GeometryPool::kFragmentationThreshold = 0.5f;
+
+void RangeAllocator::reset(unsigned int capacity) {
+    m_byOffset.clear();
+    m_bySize.clear();
+    m_capacity = capacity;
+    m_free = 0;
+    if (capacity > 0) {
+        insertFree(0, capacity);
+        m_free = capacity;
+    }
+}
+
+void RangeAllocator::grow(unsigned int capacity) {
+    if (capacity <= m_capacity) {
+        return;
+    }
+    const unsigned int old = m_capacity;
+    m_capacity = capacity;
+    free(old, capacity - old);
+}
+
+bool RangeAllocator::allocate(unsigned int size, unsigned int& offset) {
+    auto fit = m_bySize.lower_bound(size);
+    if (size == 0 || fit == m_bySize.end()) {
+        return false;
+    }
+    offset = fit->second;
+    const unsigned int holeSize = fit->first;
+    eraseFree(m_byOffset.find(offset));
+    if (holeSize > size) {
+        insertFree(offset + size, holeSize - size);
+    }
+    m_free -= size;
+    return true;
+}
+
+void RangeAllocator::free(unsigned int offset, unsigned int size) {
+    if (size == 0) {
+        return;
+    }
+    m_free += size;
+    auto next = m_byOffset.lower_bound(offset);
+    if (next != m_byOffset.end() && offset + size == next->first) {
+        size += next->second;
+        next = std::next(next);
+        eraseFree(std::prev(next));
+    }
+    if (next != m_byOffset.begin()) {
+        auto previous = std::prev(next);
+        if (previous->first + previous->second == offset) {
+            offset = previous->first;
+            size += previous->second;
+            eraseFree(previous);
+        }
+    }
+    insertFree(offset, size);
+}
+
+void RangeAllocator::insertFree(unsigned int offset, unsigned int size) {
+    m_byOffset[offset] = size;
+    m_bySize.insert(std::make_pair(size, offset));
+}
+
+void RangeAllocator::eraseFree(std::map<unsigned int, unsigned int>::iterator hole) {
+    auto sized = m_bySize.equal_range(hole->second);
+    for (auto it = sized.first; it != sized.second; ++it) {
+        if (it->second == hole->first) {
+            m_bySize.erase(it);
+            break;
+        }
+    }
+    m_byOffset.erase(hole);
+}
+
+HRESULT GeometryPool::init(Device& device, DeviceContext& deviceContext, unsigned int vertexStride,
+    unsigned int positionStride, unsigned int vertexCapacity, unsigned int indexCapacity) {
+    if (!device.m_device) {
+        ERROR("GeometryPool", "init", "Device is null.");
+        return E_POINTER;
+    }
+    if (vertexStride == 0 || positionStride == 0 || vertexCapacity == 0 || indexCapacity == 0) {
+        ERROR("GeometryPool", "init", "Strides and capacities must be non-zero");
+        return E_INVALIDARG;
+    }
+    destroy();
+    m_device = &device;
+    m_deviceContext = &deviceContext;
+    m_vertexStride = vertexStride;
+    m_positionStride = positionStride;
+    HRESULT hr = resize(vertexCapacity, indexCapacity, false);
+    if (FAILED(hr)) {
+        m_device = nullptr;
+        m_deviceContext = nullptr;
+    }
+    return hr;
+}
+
+GeometryPool::Handle GeometryPool::allocate(const void* vertices, const void* positions, unsigned int vertexCount,
+    const unsigned int* indices, unsigned int indexCount) {
+    if (!isReady() || !vertices || !positions || !indices || vertexCount == 0 || indexCount == 0) {
+        return kNullHandle;
+    }
+    m_narrowed.resize(indexCount);
+    for (unsigned int i = 0; i < indexCount; ++i) {
+        if (indices[i] > 0xFFFF) {
+            ERROR("GeometryPool", "allocate", "Index does not fit in 16 bits");
+            return kNullHandle;
+        }
+        m_narrowed[i] = static_cast<unsigned short>(indices[i]);
+    }
+
+    Range range;
+    unsigned int baseVertex = 0;
+    if (!m_vertexSpace.allocate(vertexCount, baseVertex)) {
+        if (!reserve(vertexCount, 0) || !m_vertexSpace.allocate(vertexCount, baseVertex)) {
+            return kNullHandle;
+        }
+    }
+    if (!m_indexSpace.allocate(indexCount, range.startIndex)) {
+        if (!reserve(0, indexCount) || !m_indexSpace.allocate(indexCount, range.startIndex)) {
+            m_vertexSpace.free(baseVertex, vertexCount);
+            return kNullHandle;
+        }
+    }
+    range.baseVertex = static_cast<int>(baseVertex);
+    range.vertexCount = vertexCount;
+    range.indexCount = indexCount;
+
+    D3D11_BOX box = { baseVertex * m_vertexStride, 0, 0, (baseVertex + vertexCount) * m_vertexStride, 1, 1 };
+    m_vertices.update(*m_deviceContext, nullptr, 0, &box, vertices, 0, 0);
+    box.left = baseVertex * m_positionStride;
+    box.right = (baseVertex + vertexCount) * m_positionStride;
+    m_positions.update(*m_deviceContext, nullptr, 0, &box, positions, 0, 0);
+    box.left = range.startIndex * sizeof(unsigned short);
+    box.right = (range.startIndex + indexCount) * sizeof(unsigned short);
+    m_indices.update(*m_deviceContext, nullptr, 0, &box, m_narrowed.data(), 0, 0);
+
+    Handle handle;
+    if (!m_freeHandles.empty()) {
+        handle = m_freeHandles.back();
+        m_freeHandles.pop_back();
+    }
+    else {
+        m_blocks.push_back(Block());
+        handle = static_cast<Handle>(m_blocks.size());
+    }
+    m_blocks[handle - 1].range = range;
+    m_blocks[handle - 1].used = true;
+    ++m_liveBlocks;
+    return handle;
+}
+
+void GeometryPool::free(Handle handle) {
+    if (handle == kNullHandle || handle > m_blocks.size() || !m_blocks[handle - 1].used) {
+        return;
+    }
+    m_blocks[handle - 1].used = false;
+    --m_liveBlocks;
+    m_pendingFree.push_back(handle);
+}
+
+GeometryPool::Range GeometryPool::getRange(Handle handle) const {
+    if (handle == kNullHandle || handle > m_blocks.size()) {
+        return Range();
+    }
+    return m_blocks[handle - 1].range;
+}
+
+/**
+ * @details
+ * Se compacta cuando más de @ref kFragmentationThreshold de lo libre está fuera del
+ * mayor hueco y lo libre es al menos un octavo del buffer: con poco espacio libre,
+ * compactar copia todo para ganar casi nada.
+ */
+void GeometryPool::update() {
+    for (Handle handle : m_pendingFree) {
+        Block& block = m_blocks[handle - 1];
+        m_vertexSpace.free(static_cast<unsigned int>(block.range.baseVertex), block.range.vertexCount);
+        m_indexSpace.free(block.range.startIndex, block.range.indexCount);
+        block.range = Range();
+        m_freeHandles.push_back(handle);
+    }
+    m_pendingFree.clear();
+
+    const RangeAllocator* spaces[2] = { &m_vertexSpace, &m_indexSpace };
+    for (const RangeAllocator* space : spaces) {
+        const unsigned int freeUnits = space->getFreeUnits();
+        if (freeUnits >= space->getCapacity() / 8 &&
+            space->getLargestFree() < freeUnits * (1.0f - kFragmentationThreshold)) {
+            defragment();
+            break;
+        }
+    }
+}
+
+bool GeometryPool::defragment() {
+    if (!isReady()) {
+        return false;
+    }
+    if (FAILED(resize(m_vertexSpace.getCapacity(), m_indexSpace.getCapacity(), true))) {
+        return false;
+    }
+    ++m_defragmentCount;
+    return true;
+}
+
+/**
+ * @details
+ * Se duplica la capacidad hasta que quepa el bloque, sin pasar de
+ * @ref kMaxBufferBytes. Crecer conserva los desplazamientos (se copia el buffer entero).
+ */
+bool GeometryPool::reserve(unsigned int vertexCount, unsigned int indexCount) {
+    const unsigned long long maxVertices = kMaxBufferBytes / m_vertexStride;
+    const unsigned long long maxIndices = kMaxBufferBytes / sizeof(unsigned short);
+    unsigned long long vertexCapacity = m_vertexSpace.getCapacity();
+    unsigned long long indexCapacity = m_indexSpace.getCapacity();
+    // El bloque cabe si el hueco final (que crece) lo alcanza; basta con añadir su tamaño.
+    while (vertexCount > 0 && vertexCapacity - m_vertexSpace.getCapacity() < vertexCount) {
+        vertexCapacity *= 2;
+    }
+    while (indexCount > 0 && indexCapacity - m_indexSpace.getCapacity() < indexCount) {
+        indexCapacity *= 2;
+    }
+    if (vertexCapacity > maxVertices || indexCapacity > maxIndices) {
+        ERROR("GeometryPool", "reserve", "Pool is full");
+        return false;
+    }
+    return SUCCEEDED(resize(static_cast<unsigned int>(vertexCapacity), static_cast<unsigned int>(indexCapacity), false));
+}
+
+/**
+ * @details
+ * Los buffers nuevos se crean antes de tocar nada: si falla, el pool queda como
+ * estaba. Sin `compact`, el contenido se copia entero a los mismos desplazamientos.
+ * Con `compact`, cada bloque vivo se copia (vértices e índices por separado, en el
+ * orden en que estaban) al siguiente hueco libre; los pendientes de liberar se
+ * descartan, porque ya no hay paquetes que los usen.
+ */
+HRESULT GeometryPool::resize(unsigned int vertexCapacity, unsigned int indexCapacity, bool compact) {
+    Buffer vertices, positions, indices;
+    HRESULT hr = vertices.initStorage(*m_device, m_vertexStride, vertexCapacity, D3D11_BIND_VERTEX_BUFFER);
+    if (SUCCEEDED(hr)) {
+        hr = positions.initStorage(*m_device, m_positionStride, vertexCapacity, D3D11_BIND_VERTEX_BUFFER);
+    }
+    if (SUCCEEDED(hr)) {
+        hr = indices.initStorage(*m_device, sizeof(unsigned short), indexCapacity, D3D11_BIND_INDEX_BUFFER);
+    }
+    if (FAILED(hr)) {
+        ERROR("GeometryPool", "resize", "Failed to create pool buffers");
+        vertices.destroy();
+        positions.destroy();
+        indices.destroy();
+        return hr;
+    }
+
+    DeviceContext& context = *m_deviceContext;
+    if (!compact) {
+        const unsigned int oldVertices = m_vertexSpace.getCapacity();
+        const unsigned int oldIndices = m_indexSpace.getCapacity();
+        if (oldVertices > 0) {
+            vertices.copyRegion(context, 0, m_vertices, 0, oldVertices * m_vertexStride);
+            positions.copyRegion(context, 0, m_positions, 0, oldVertices * m_positionStride);
+        }
+        if (oldIndices > 0) {
+            indices.copyRegion(context, 0, m_indices, 0, oldIndices * static_cast<unsigned int>(sizeof(unsigned short)));
+        }
+        m_vertexSpace.grow(vertexCapacity);
+        m_indexSpace.grow(indexCapacity);
+    }
+    else {
+        for (Handle handle : m_pendingFree) {
+            m_blocks[handle - 1].range = Range();
+            m_freeHandles.push_back(handle);
+        }
+        m_pendingFree.clear();
+
+        std::vector<Handle> order;
+        for (Handle handle = 1; handle <= m_blocks.size(); ++handle) {
+            if (m_blocks[handle - 1].used) {
+                order.push_back(handle);
+            }
+        }
+        m_vertexSpace.reset(vertexCapacity);
+        m_indexSpace.reset(indexCapacity);
+
+        std::sort(order.begin(), order.end(), [this](Handle a, Handle b) {
+            return m_blocks[a - 1].range.baseVertex < m_blocks[b - 1].range.baseVertex;
+        });
+        for (Handle handle : order) {
+            Range& range = m_blocks[handle - 1].range;
+            unsigned int offset = 0;
+            m_vertexSpace.allocate(range.vertexCount, offset);
+            const unsigned int from = static_cast<unsigned int>(range.baseVertex);
+            vertices.copyRegion(context, offset * m_vertexStride, m_vertices, from * m_vertexStride,
+                range.vertexCount * m_vertexStride);
+            positions.copyRegion(context, offset * m_positionStride, m_positions, from * m_positionStride,
+                range.vertexCount * m_positionStride);
+            range.baseVertex = static_cast<int>(offset);
+        }
+
+        std::sort(order.begin(), order.end(), [this](Handle a, Handle b) {
+            return m_blocks[a - 1].range.startIndex < m_blocks[b - 1].range.startIndex;
+        });
+        const unsigned int indexStride = sizeof(unsigned short);
+        for (Handle handle : order) {
+            Range& range = m_blocks[handle - 1].range;
+            unsigned int offset = 0;
+            m_indexSpace.allocate(range.indexCount, offset);
+            indices.copyRegion(context, offset * indexStride, m_indices, range.startIndex * indexStride,
+                range.indexCount * indexStride);
+            range.startIndex = offset;
+        }
+    }
+
+    // La `Buffer` conserva su dirección: los punteros de la cola siguen valiendo.
+    m_vertices.destroy();
+    m_positions.destroy();
+    m_indices.destroy();
+    m_vertices = vertices;
+    m_positions = positions;
+    m_indices = indices;
+    return S_OK;
+}
+
+void GeometryPool::destroy() {
+    m_vertices.destroy();
+    m_positions.destroy();
+    m_indices.destroy();
+    m_vertexSpace.reset(0);
+    m_indexSpace.reset(0);
+    m_blocks.clear();
+    m_freeHandles.clear();
+    m_pendingFree.clear();
+    std::vector<unsigned short>().swap(m_narrowed);
+    m_liveBlocks = 0;
+    m_defragmentCount = 0;
+    m_device = nullptr;
+    m_deviceContext = nullptr;
+}
+
+size_t GeometryPool::getUsedBytes() const {
+    const size_t vertices = m_vertexSpace.getCapacity() - m_vertexSpace.getFreeUnits();
+    const size_t indices = m_indexSpace.getCapacity() - m_indexSpace.getFreeUnits();
+    return vertices * (m_vertexStride + m_positionStride) + indices * sizeof(unsigned short);
+}
+
+size_t GeometryPool::getCapacityBytes() const {
+    return static_cast<size_t>(m_vertices.getByteWidth()) + m_positions.getByteWidth() + m_indices.getByteWidth();
+}
@@ -0,0 +1,361 @@
+﻿/**
+ * @file GpuCulling.cpp
+ * @brief Implementación del culling en GPU y los draws indirectos.
+ *
+ * @details
+ * Orden de un frame: @ref GpuCulling::begin, un @ref GpuCulling::submit por actor,
+ * @ref GpuCulling::cull (antes de dibujar nada) y @ref GpuCulling::render en el
+ * pase opaco. Los grupos reservan en la lista de visibles tantos huecos como
+ * instancias tienen, así que el kernel nunca se sale de su rango aunque todas pasen.
+ */
+
+#include "GpuCulling.h"
+#include "Device.h"
+#include "DeviceContext.h"
+#include "ShaderLibrary.h"
+#include "ShaderProgram.h"
+#include "GeometryPool.h"
+#include "HiZBuffer.h"
+#include "Frustum.h"
+#include "Texture.h"
+#include "Material.h"
+#include "VertexLayout.h"
+#include "ECS/Actor.h"
+#include <algorithm>
+
+HRESULT GpuCulling::init(Device& device, GeometryPool& pool, ShaderProgram* program,
+    ShaderProgram* receiverProgram) {
+    if (!device.m_device) {
+        ERROR("GpuCulling", "init", "Device is null.");
+        return E_POINTER;
+    }
+    if (!program || !pool.isReady()) {
+        ERROR("GpuCulling", "init", "Program or geometry pool not available");
+        return E_INVALIDARG;
+    }
+    destroy();
+
+    // Argumentos indirectos escritos por UAV: nivel 11_0.
+    if (device.m_device->GetFeatureLevel() < D3D_FEATURE_LEVEL_11_0) {
+        MESSAGE("GpuCulling", "init", "Feature level < 11_0: GPU-driven path disabled.");
+        return DXGI_ERROR_UNSUPPORTED;
+    }
+
+    D3D11_BUFFER_DESC paramsDesc = {};
+    paramsDesc.Usage = D3D11_USAGE_DEFAULT;
+    paramsDesc.ByteWidth = sizeof(CullParams);
+    paramsDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+    HRESULT hr = device.CreateBuffer(&paramsDesc, nullptr, &m_params);
+    if (SUCCEEDED(hr)) { hr = m_blendState.init(device, false); }
+    if (SUCCEEDED(hr)) { hr = m_rasterizer.init(device); }
+    if (SUCCEEDED(hr)) { hr = m_sampler.init(device); }
+    if (FAILED(hr)) {
+        destroy();
+        return hr;
+    }
+
+    m_device = &device;
+    m_pool = &pool;
+    m_program = program;
+    m_receiverProgram = receiverProgram;
+    hr = reserve(kInitialInstances, kInitialGroups);
+    if (FAILED(hr)) {
+        destroy();
+        return hr;
+    }
+
+    ShaderKey key;
+    key.fileName = "GpuCulling.fx";
+    key.entryPoint = "CSCull";
+    key.profile = "cs_5_0";
+    hr = device.getShaderLibrary().getComputeShader(device, key, &m_cullShader);
+    if (FAILED(hr)) {
+        destroy();
+        return hr;
+    }
+    return S_OK;
+}
+
+void GpuCulling::begin() {
+    m_instances.clear();
+    m_groups.clear();
+    m_groupLookup.clear();
+}
+
+bool GpuCulling::submit(Actor& actor) {
+    const EU::TSharedPointer<MeshAsset>& asset = actor.getMeshAsset();
+    if (!isReady() || asset.isNull() || actor.isTransparent() || actor.isBatched()) {
+        return false;
+    }
+    if (actor.getReceiveShadow() && !m_receiverProgram) {
+        return false;
+    }
+    MeshAsset& mesh = asset->getLOD(actor.getLODLevel());
+    XMFLOAT3 mn, mx;
+    if (!mesh.isPooled() || mesh.getSubmeshCount() == 0 || !actor.getWorldBounds(mn, mx)) {
+        return false;
+    }
+    for (unsigned int i = 0; i < mesh.getSubmeshCount(); ++i) {
+        const Material* material = actor.getMaterial(i);
+        if (material && !material->usesDefaultPipeline()) {
+            return false;
+        }
+    }
+
+    InstanceData instance;
+    const CBChangesEveryFrame& object = actor.getObjectData();
+    XMStoreFloat4x4(&instance.world, object.mWorld);
+    instance.color = object.vMeshColor;
+    instance.boundsMin = mn;
+    instance.boundsMax = mx;
+    instance.pad = 0;
+
+    const std::vector<TextureHandle>& textures = actor.getTextures();
+    for (unsigned int i = 0; i < mesh.getSubmeshCount(); ++i) {
+        const SubmeshDraw draw = mesh.getDraw(i);
+        GroupKey key;
+        key.baseVertex = draw.baseVertex;
+        key.startIndex = draw.startIndex;
+        key.texture = i < textures.size() ? textures[i].get() : nullptr;
+        const Material* material = actor.getMaterial(i);
+        key.constants = material ? material->getConstants() : nullptr;
+        key.receiveShadow = actor.getReceiveShadow();
+
+        auto found = m_groupLookup.find(key);
+        if (found == m_groupLookup.end()) {
+            Group group;
+            group.args.indexCount = draw.indexCount;
+            group.args.instanceCount = 0;
+            group.args.startIndex = draw.startIndex;
+            group.args.baseVertex = draw.baseVertex;
+            group.args.startInstance = 0;
+            group.texture = key.texture;
+            group.constants = key.constants;
+            group.receiveShadow = key.receiveShadow;
+            found = m_groupLookup.emplace(key, static_cast<unsigned int>(m_groups.size())).first;
+            m_groups.push_back(group);
+        }
+        // Mientras se recoge, `instanceCount` cuenta las instancias del grupo.
+        ++m_groups[found->second].args.instanceCount;
+        instance.group = found->second;
+        m_instances.push_back(instance);
+    }
+    return true;
+}
+
+void GpuCulling::cull(DeviceContext& deviceContext, const Frustum& frustum, const HiZBuffer& hiZ) {
+    if (m_instances.empty()) {
+        return;
+    }
+    const unsigned int instanceCount = static_cast<unsigned int>(m_instances.size());
+    const unsigned int groupCount = static_cast<unsigned int>(m_groups.size());
+    if (FAILED(reserve(instanceCount, groupCount))) {
+        ERROR("GpuCulling", "cull", "Failed to grow the instance buffers; nothing is drawn this frame");
+        begin();
+        return;
+    }
+
+    // Cada grupo empieza en su hueco de la lista; el contador arranca a 0 en la GPU.
+    m_args.resize(groupCount);
+    unsigned int firstInstance = 0;
+    for (unsigned int g = 0; g < groupCount; ++g) {
+        DrawArgs& args = m_groups[g].args;
+        args.startInstance = firstInstance;
+        firstInstance += args.instanceCount;
+        m_args[g] = args;
+        m_args[g].instanceCount = 0;
+    }
+    D3D11_BOX argsBox = { 0, 0, 0, groupCount * static_cast<unsigned int>(sizeof(DrawArgs)), 1, 1 };
+    deviceContext.UpdateSubresource(m_argsBuffer, 0, &argsBox, m_args.data(), 0, 0);
+
+    D3D11_MAPPED_SUBRESOURCE mapped = {};
+    if (FAILED(deviceContext.Map(m_instanceBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped))) {
+        begin();
+        return;
+    }
+    memcpy(mapped.pData, m_instances.data(), m_instances.size() * sizeof(InstanceData));
+    deviceContext.Unmap(m_instanceBuffer, 0);
+
+    CullParams params;
+    for (unsigned int i = 0; i < 6; ++i) {
+        params.planes[i] = frustum.getPlane(i);
+    }
+    const bool useHiZ = hiZ.isEnabled() && hiZ.hasPyramid();
+    params.hiZViewProj = XMMatrixTranspose(useHiZ ? hiZ.getPyramidViewProj() : XMMatrixIdentity());
+    params.instanceCount = instanceCount;
+    params.hiZMipCount = useHiZ ? hiZ.getMipCount() : 0;
+    params.hiZSize[0] = hiZ.getPyramidWidth();
+    params.hiZSize[1] = hiZ.getPyramidHeight();
+    deviceContext.UpdateSubresource(m_params, 0, nullptr, &params, 0, 0);
+
+    ID3D11ShaderResourceView* srvs[2] = { m_instanceSRV, useHiZ ? hiZ.getPyramidSRV() : nullptr };
+    ID3D11UnorderedAccessView* uavs[2] = { m_argsUAV, m_visibleUAV };
+    deviceContext.CSSetShader(m_cullShader, nullptr, 0);
+    deviceContext.CSSetConstantBuffers(0, 1, &m_params);
+    deviceContext.CSSetShaderResources(0, 2, srvs);
+    deviceContext.CSSetUnorderedAccessViews(0, 2, uavs, nullptr);
+    deviceContext.Dispatch((instanceCount + kThreadGroupSize - 1) / kThreadGroupSize, 1, 1);
+
+    // Desenlazar: la lista pasa a leerse en el VS y los argumentos en el draw.
+    ID3D11ShaderResourceView* nullSRVs[2] = { nullptr, nullptr };
+    ID3D11UnorderedAccessView* nullUAVs[2] = { nullptr, nullptr };
+    deviceContext.CSSetShaderResources(0, 2, nullSRVs);
+    deviceContext.CSSetUnorderedAccessViews(0, 2, nullUAVs, nullptr);
+    deviceContext.CSSetShader(nullptr, nullptr, 0);
+}
+
+void GpuCulling::render(DeviceContext& deviceContext) {
+    if (m_instances.empty()) {
+        return;
+    }
+    DeviceContext::EventScope event(deviceContext, "GPU-driven");
+    m_blendState.render(deviceContext);
+    m_rasterizer.render(deviceContext);
+    m_sampler.render(deviceContext, 0, 1);
+    deviceContext.IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    m_pool->getVertexBuffer().render(deviceContext, VERTEX_STREAM_GEOMETRY, 1);
+    m_slotBuffer.render(deviceContext, VERTEX_STREAM_INSTANCE, 1);
+    m_pool->getIndexBuffer().render(deviceContext, 0, 1, false, m_pool->getIndexBuffer().getIndexFormat());
+    ID3D11ShaderResourceView* srvs[2] = { m_instanceSRV, m_visibleSRV };
+    deviceContext.VSSetShaderResources(2, 2, srvs);
+
+    Buffer* defaultConstants = m_defaultMaterial ? m_defaultMaterial->getConstants() : nullptr;
+    ShaderProgram* lastProgram = nullptr;
+    Texture* lastTexture = nullptr;
+    Buffer* lastConstants = nullptr;
+    for (unsigned int g = 0; g < m_groups.size(); ++g) {
+        const Group& group = m_groups[g];
+        ShaderProgram* program = group.receiveShadow ? m_receiverProgram : m_program;
+        if (program != lastProgram) {
+            program->render(deviceContext);
+            lastProgram = program;
+        }
+        Buffer* constants = group.constants ? group.constants : defaultConstants;
+        if (constants && constants != lastConstants) {
+            constants->render(deviceContext, CB_SLOT_MATERIAL, 1, true);
+            lastConstants = constants;
+        }
+        if (group.texture && group.texture != lastTexture) {
+            group.texture->render(deviceContext, 0, 1);
+            lastTexture = group.texture;
+        }
+        deviceContext.DrawIndexedInstancedIndirect(m_argsBuffer, g * static_cast<unsigned int>(sizeof(DrawArgs)));
+    }
+
+    ID3D11ShaderResourceView* nullSRVs[2] = { nullptr, nullptr };
+    deviceContext.VSSetShaderResources(2, 2, nullSRVs);
+}
+
+HRESULT GpuCulling::reserve(unsigned int instanceCount, unsigned int groupCount) {
+    HRESULT hr = S_OK;
+    if (instanceCount > m_instanceCapacity) {
+        unsigned int capacity = (std::max)(m_instanceCapacity, kInitialInstances);
+        while (capacity < instanceCount) capacity *= 2;
+
+        SAFE_RELEASE(m_instanceSRV);
+        SAFE_RELEASE(m_instanceBuffer);
+        SAFE_RELEASE(m_visibleSRV);
+        SAFE_RELEASE(m_visibleUAV);
+        SAFE_RELEASE(m_visibleBuffer);
+        m_slotBuffer.destroy();
+        m_instanceCapacity = 0;
+
+        D3D11_BUFFER_DESC desc = {};
+        desc.Usage = D3D11_USAGE_DYNAMIC;
+        desc.ByteWidth = capacity * sizeof(InstanceData);
+        desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+        desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+        desc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+        desc.StructureByteStride = sizeof(InstanceData);
+        hr = m_device->CreateBuffer(&desc, nullptr, &m_instanceBuffer);
+
+        D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+        srvDesc.Format = DXGI_FORMAT_UNKNOWN;
+        srvDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+        srvDesc.Buffer.FirstElement = 0;
+        srvDesc.Buffer.NumElements = capacity;
+        if (SUCCEEDED(hr)) { hr = m_device->CreateShaderResourceView(m_instanceBuffer, &srvDesc, &m_instanceSRV); }
+
+        desc.Usage = D3D11_USAGE_DEFAULT;
+        desc.ByteWidth = capacity * sizeof(unsigned int);
+        desc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_UNORDERED_ACCESS;
+        desc.CPUAccessFlags = 0;
+        desc.StructureByteStride = sizeof(unsigned int);
+        if (SUCCEEDED(hr)) { hr = m_device->CreateBuffer(&desc, nullptr, &m_visibleBuffer); }
+        if (SUCCEEDED(hr)) { hr = m_device->CreateShaderResourceView(m_visibleBuffer, &srvDesc, &m_visibleSRV); }
+
+        D3D11_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
+        uavDesc.Format = DXGI_FORMAT_UNKNOWN;
+        uavDesc.ViewDimension = D3D11_UAV_DIMENSION_BUFFER;
+        uavDesc.Buffer.FirstElement = 0;
+        uavDesc.Buffer.NumElements = capacity;
+        if (SUCCEEDED(hr)) { hr = m_device->CreateUnorderedAccessView(m_visibleBuffer, &uavDesc, &m_visibleUAV); }
+
+        // Identidad por instancia: con StartInstanceLocation = inicio del grupo, el VS
+        // recibe el hueco de la lista de visibles.
+        if (SUCCEEDED(hr)) {
+            std::vector<unsigned int> slots(capacity);
+            for (unsigned int i = 0; i < capacity; ++i) {
+                slots[i] = i;
+            }
+            hr = m_slotBuffer.create(*m_device, BUFFER_IMMUTABLE, D3D11_BIND_VERTEX_BUFFER,
+                capacity * sizeof(unsigned int), sizeof(unsigned int), slots.data());
+        }
+        if (FAILED(hr)) {
+            return hr;
+        }
+        m_instanceCapacity = capacity;
+    }
+
+    if (groupCount > m_groupCapacity) {
+        unsigned int capacity = (std::max)(m_groupCapacity, kInitialGroups);
+        while (capacity < groupCount) capacity *= 2;
+
+        SAFE_RELEASE(m_argsUAV);
+        SAFE_RELEASE(m_argsBuffer);
+        m_groupCapacity = 0;
+
+        D3D11_BUFFER_DESC desc = {};
+        desc.Usage = D3D11_USAGE_DEFAULT;
+        desc.ByteWidth = capacity * sizeof(DrawArgs);
+        desc.BindFlags = D3D11_BIND_UNORDERED_ACCESS;
+        desc.MiscFlags = D3D11_RESOURCE_MISC_DRAWINDIRECT_ARGS;
+        hr = m_device->CreateBuffer(&desc, nullptr, &m_argsBuffer);
+
+        // Vista tipada R32_UINT: el kernel suma con InterlockedAdd sobre el conteo.
+        D3D11_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
+        uavDesc.Format = DXGI_FORMAT_R32_UINT;
+        uavDesc.ViewDimension = D3D11_UAV_DIMENSION_BUFFER;
+        uavDesc.Buffer.FirstElement = 0;
+        uavDesc.Buffer.NumElements = capacity * (sizeof(DrawArgs) / sizeof(unsigned int));
+        if (SUCCEEDED(hr)) { hr = m_device->CreateUnorderedAccessView(m_argsBuffer, &uavDesc, &m_argsUAV); }
+        if (FAILED(hr)) {
+            return hr;
+        }
+        m_groupCapacity = capacity;
+    }
+    return S_OK;
+}
+
+void GpuCulling::destroy() {
+    SAFE_RELEASE(m_cullShader);
+    SAFE_RELEASE(m_instanceSRV);
+    SAFE_RELEASE(m_instanceBuffer);
+    SAFE_RELEASE(m_visibleSRV);
+    SAFE_RELEASE(m_visibleUAV);
+    SAFE_RELEASE(m_visibleBuffer);
+    SAFE_RELEASE(m_argsUAV);
+    SAFE_RELEASE(m_argsBuffer);
+    SAFE_RELEASE(m_params);
+    m_slotBuffer.destroy();
+    m_blendState.destroy();
+    m_rasterizer.destroy();
+    m_sampler.destroy();
+    m_instanceCapacity = 0;
+    m_groupCapacity = 0;
+    m_device = nullptr;
+    m_pool = nullptr;
+    m_program = nullptr;
+    m_receiverProgram = nullptr;
+    begin();
+}
@@ -0,0 +1,273 @@
+﻿/**
+ * @file GpuMemory.cpp
+ * @brief Implementación de la consulta de presupuesto DXGI y del recuento por categoría.
+ */
+
+#include "GpuMemory.h"
+#include "Device.h"
+#include <atomic>
+#include <dxgi1_4.h>
+
+namespace {
+    std::atomic<unsigned long long> s_bytes[GPU_MEMORY_CATEGORY_COUNT];
+    std::atomic<unsigned int> s_counts[GPU_MEMORY_CATEGORY_COUNT];
+
+    const char* const kCategoryNames[GPU_MEMORY_CATEGORY_COUNT] = {
+        "Textures", "Render targets", "Vertex", "Index", "Constant", "Staging", "Other"
+    };
+
+    // {5B8F1C52-3E1D-4C7A-9A55-0F3B6C2E8D41}: dato privado con el que se apunta un recurso.
+    const GUID kTrackingGuid = { 0x5b8f1c52, 0x3e1d, 0x4c7a, { 0x9a, 0x55, 0x0f, 0x3b, 0x6c, 0x2e, 0x8d, 0x41 } };
+
+    /**
+     * @brief Objeto COM mínimo colgado del recurso: D3D lo suelta al destruir el recurso
+     * y entonces se resta su tamaño.
+     */
+    class AllocationToken : public IUnknown {
+    public:
+        AllocationToken(GpuMemoryCategory category, unsigned long long bytes) : m_category(category), m_bytes(bytes) {
+            s_bytes[m_category].fetch_add(m_bytes, std::memory_order_relaxed);
+            s_counts[m_category].fetch_add(1, std::memory_order_relaxed);
+        }
+
+        HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** object) override {
+            if (!object) {
+                return E_POINTER;
+            }
+            if (riid == __uuidof(IUnknown)) {
+                *object = static_cast<IUnknown*>(this);
+                AddRef();
+                return S_OK;
+            }
+            *object = nullptr;
+            return E_NOINTERFACE;
+        }
+
+        ULONG STDMETHODCALLTYPE AddRef() override {
+            return static_cast<ULONG>(InterlockedIncrement(&m_refs));
+        }
+
+        ULONG STDMETHODCALLTYPE Release() override {
+            const LONG refs = InterlockedDecrement(&m_refs);
+            if (refs == 0) {
+                s_bytes[m_category].fetch_sub(m_bytes, std::memory_order_relaxed);
+                s_counts[m_category].fetch_sub(1, std::memory_order_relaxed);
+                delete this;
+            }
+            return static_cast<ULONG>(refs);
+        }
+
+    private:
+        LONG m_refs = 1;
+        GpuMemoryCategory m_category;
+        unsigned long long m_bytes;
+    };
+
+    /// Bits por texel (en los BCn, del bloque de 4x4 repartido); 32 si no se conoce.
+    unsigned int getFormatBits(DXGI_FORMAT format) {
+        switch (format) {
+        case DXGI_FORMAT_R32G32B32A32_TYPELESS: case DXGI_FORMAT_R32G32B32A32_FLOAT:
+        case DXGI_FORMAT_R32G32B32A32_UINT: case DXGI_FORMAT_R32G32B32A32_SINT:
+            return 128;
+        case DXGI_FORMAT_R32G32B32_TYPELESS: case DXGI_FORMAT_R32G32B32_FLOAT:
+        case DXGI_FORMAT_R32G32B32_UINT: case DXGI_FORMAT_R32G32B32_SINT:
+            return 96;
+        case DXGI_FORMAT_R16G16B16A16_TYPELESS: case DXGI_FORMAT_R16G16B16A16_FLOAT:
+        case DXGI_FORMAT_R16G16B16A16_UNORM: case DXGI_FORMAT_R16G16B16A16_UINT:
+        case DXGI_FORMAT_R16G16B16A16_SNORM: case DXGI_FORMAT_R16G16B16A16_SINT:
+        case DXGI_FORMAT_R32G32_TYPELESS: case DXGI_FORMAT_R32G32_FLOAT:
+        case DXGI_FORMAT_R32G32_UINT: case DXGI_FORMAT_R32G32_SINT:
+        case DXGI_FORMAT_R32G8X24_TYPELESS: case DXGI_FORMAT_D32_FLOAT_S8X24_UINT:
+            return 64;
+        case DXGI_FORMAT_R8G8_TYPELESS: case DXGI_FORMAT_R8G8_UNORM: case DXGI_FORMAT_R8G8_UINT:
+        case DXGI_FORMAT_R8G8_SNORM: case DXGI_FORMAT_R8G8_SINT:
+        case DXGI_FORMAT_R16_TYPELESS: case DXGI_FORMAT_R16_FLOAT: case DXGI_FORMAT_D16_UNORM:
+        case DXGI_FORMAT_R16_UNORM: case DXGI_FORMAT_R16_UINT: case DXGI_FORMAT_R16_SNORM:
+        case DXGI_FORMAT_R16_SINT: case DXGI_FORMAT_B5G6R5_UNORM: case DXGI_FORMAT_B5G5R5A1_UNORM:
+            return 16;
+        case DXGI_FORMAT_R8_TYPELESS: case DXGI_FORMAT_R8_UNORM: case DXGI_FORMAT_R8_UINT:
+        case DXGI_FORMAT_R8_SNORM: case DXGI_FORMAT_R8_SINT: case DXGI_FORMAT_A8_UNORM:
+        case DXGI_FORMAT_BC2_TYPELESS: case DXGI_FORMAT_BC2_UNORM: case DXGI_FORMAT_BC2_UNORM_SRGB:
+        case DXGI_FORMAT_BC3_TYPELESS: case DXGI_FORMAT_BC3_UNORM: case DXGI_FORMAT_BC3_UNORM_SRGB:
+        case DXGI_FORMAT_BC5_TYPELESS: case DXGI_FORMAT_BC5_UNORM: case DXGI_FORMAT_BC5_SNORM:
+        case DXGI_FORMAT_BC6H_TYPELESS: case DXGI_FORMAT_BC6H_UF16: case DXGI_FORMAT_BC6H_SF16:
+        case DXGI_FORMAT_BC7_TYPELESS: case DXGI_FORMAT_BC7_UNORM: case DXGI_FORMAT_BC7_UNORM_SRGB:
+            return 8;
+        case DXGI_FORMAT_BC1_TYPELESS: case DXGI_FORMAT_BC1_UNORM: case DXGI_FORMAT_BC1_UNORM_SRGB:
+        case DXGI_FORMAT_BC4_TYPELESS: case DXGI_FORMAT_BC4_UNORM: case DXGI_FORMAT_BC4_SNORM:
+            return 4;
+        default:
+            return 32;
+        }
+    }
+
+    bool isBlockCompressed(DXGI_FORMAT format) {
+        return (format >= DXGI_FORMAT_BC1_TYPELESS && format <= DXGI_FORMAT_BC5_SNORM) ||
+            (format >= DXGI_FORMAT_BC6H_TYPELESS && format <= DXGI_FORMAT_BC7_UNORM_SRGB);
+    }
+
+    GpuMemoryCategory classify(const D3D11_BUFFER_DESC& desc) {
+        if (desc.Usage == D3D11_USAGE_STAGING) return GPU_MEMORY_STAGING;
+        if (desc.BindFlags & D3D11_BIND_VERTEX_BUFFER) return GPU_MEMORY_VERTEX;
+        if (desc.BindFlags & D3D11_BIND_INDEX_BUFFER) return GPU_MEMORY_INDEX;
+        if (desc.BindFlags & D3D11_BIND_CONSTANT_BUFFER) return GPU_MEMORY_CONSTANT;
+        return GPU_MEMORY_OTHER;
+    }
+
+    GpuMemoryCategory classify(const D3D11_TEXTURE2D_DESC& desc) {
+        if (desc.Usage == D3D11_USAGE_STAGING) return GPU_MEMORY_STAGING;
+        if (desc.BindFlags & (D3D11_BIND_RENDER_TARGET | D3D11_BIND_DEPTH_STENCIL | D3D11_BIND_UNORDERED_ACCESS)) {
+            return GPU_MEMORY_RENDER_TARGET;
+        }
+        return GPU_MEMORY_TEXTURE;
+    }
+}
+
+HRESULT GpuMemory::init(Device& device) {
+    destroy();
+    if (!device.m_device) {
+        ERROR("GpuMemory", "init", "Device is not initialized");
+        return E_POINTER;
+    }
+    IDXGIDevice* dxgiDevice = nullptr;
+    IDXGIAdapter* adapter = nullptr;
+    HRESULT hr = device.m_device->QueryInterface(__uuidof(IDXGIDevice), (void**)&dxgiDevice);
+    if (SUCCEEDED(hr)) {
+        hr = dxgiDevice->GetAdapter(&adapter);
+    }
+    SAFE_RELEASE(dxgiDevice);
+    if (FAILED(hr)) {
+        ERROR("GpuMemory", "init", ("Failed to get the DXGI adapter. HRESULT: " + std::to_string(hr)).c_str());
+        return hr;
+    }
+
+    DXGI_ADAPTER_DESC desc = {};
+    if (SUCCEEDED(adapter->GetDesc(&desc))) {
+        m_dedicatedBytes = desc.DedicatedVideoMemory;
+    }
+    if (SUCCEEDED(adapter->QueryInterface(__uuidof(IDXGIAdapter3), (void**)&m_adapter))) {
+        m_budgetEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+        if (m_budgetEvent && FAILED(m_adapter->RegisterVideoMemoryBudgetChangeNotificationEvent(m_budgetEvent, &m_budgetCookie))) {
+            CloseHandle(m_budgetEvent);
+            m_budgetEvent = nullptr;
+        }
+    }
+    else {
+        MESSAGE("GpuMemory", "init", "IDXGIAdapter3 not available: budget is the adapter's dedicated memory");
+    }
+    SAFE_RELEASE(adapter);
+    query();
+    return S_OK;
+}
+
+void GpuMemory::destroy() {
+    if (m_adapter && m_budgetEvent) {
+        m_adapter->UnregisterVideoMemoryBudgetChangeNotification(m_budgetCookie);
+    }
+    if (m_budgetEvent) {
+        CloseHandle(m_budgetEvent);
+        m_budgetEvent = nullptr;
+    }
+    SAFE_RELEASE(m_adapter);
+    m_budgetCookie = 0;
+    m_local = Segment();
+    m_nonLocal = Segment();
+    m_wasOverBudget = false;
+}
+
+bool GpuMemory::update() {
+    const bool changed = m_budgetEvent && WaitForSingleObject(m_budgetEvent, 0) == WAIT_OBJECT_0;
+    query();
+    const bool over = isOverBudget();
+    if (over && !m_wasOverBudget) {
+        ERROR("GpuMemory", "update", ("Video memory over budget: " + std::to_string(m_local.usage >> 20) +
+            " MB used of " + std::to_string(m_local.budget >> 20) + " MB").c_str());
+    }
+    m_wasOverBudget = over;
+    return changed;
+}
+
+void GpuMemory::query() {
+    if (!m_adapter) {
+        m_local.budget = m_dedicatedBytes;
+        m_local.usage = getTrackedVideoBytes();
+        return;
+    }
+    DXGI_QUERY_VIDEO_MEMORY_INFO info = {};
+    if (SUCCEEDED(m_adapter->QueryVideoMemoryInfo(0, DXGI_MEMORY_SEGMENT_GROUP_LOCAL, &info))) {
+        m_local.budget = info.Budget;
+        m_local.usage = info.CurrentUsage;
+    }
+    if (SUCCEEDED(m_adapter->QueryVideoMemoryInfo(0, DXGI_MEMORY_SEGMENT_GROUP_NON_LOCAL, &info))) {
+        m_nonLocal.budget = info.Budget;
+        m_nonLocal.usage = info.CurrentUsage;
+    }
+}
+
+void GpuMemory::track(ID3D11Resource* resource) {
+    if (!resource) {
+        return;
+    }
+    D3D11_RESOURCE_DIMENSION dimension = D3D11_RESOURCE_DIMENSION_UNKNOWN;
+    resource->GetType(&dimension);
+    GpuMemoryCategory category;
+    unsigned long long bytes;
+    if (dimension == D3D11_RESOURCE_DIMENSION_BUFFER) {
+        D3D11_BUFFER_DESC desc;
+        static_cast<ID3D11Buffer*>(resource)->GetDesc(&desc);
+        category = classify(desc);
+        bytes = desc.ByteWidth;
+    }
+    else if (dimension == D3D11_RESOURCE_DIMENSION_TEXTURE2D) {
+        D3D11_TEXTURE2D_DESC desc;
+        static_cast<ID3D11Texture2D*>(resource)->GetDesc(&desc);
+        category = classify(desc);
+        bytes = estimateBytes(desc);
+    }
+    else {
+        return;
+    }
+    AllocationToken* token = new AllocationToken(category, bytes);
+    resource->SetPrivateDataInterface(kTrackingGuid, token);
+    // Si no se pudo colgar, esta es su única referencia y se resta en el acto.
+    token->Release();
+}
+
+unsigned long long GpuMemory::getTrackedBytes(GpuMemoryCategory category) {
+    return s_bytes[category].load(std::memory_order_relaxed);
+}
+
+unsigned int GpuMemory::getTrackedCount(GpuMemoryCategory category) {
+    return s_counts[category].load(std::memory_order_relaxed);
+}
+
+unsigned long long GpuMemory::getTrackedVideoBytes() {
+    unsigned long long total = 0;
+    for (int c = 0; c < GPU_MEMORY_CATEGORY_COUNT; ++c) {
+        if (c != GPU_MEMORY_STAGING) {
+            total += getTrackedBytes(static_cast<GpuMemoryCategory>(c));
+        }
+    }
+    return total;
+}
+
+const char* GpuMemory::getCategoryName(GpuMemoryCategory category) {
+    return category >= 0 && category < GPU_MEMORY_CATEGORY_COUNT ? kCategoryNames[category] : "?";
+}
+
+unsigned long long GpuMemory::estimateBytes(const D3D11_TEXTURE2D_DESC& desc) {
+    const unsigned int bits = getFormatBits(desc.Format);
+    const bool blocks = isBlockCompressed(desc.Format);
+    unsigned long long bytes = 0;
+    unsigned int width = desc.Width;
+    unsigned int height = desc.Height;
+    for (unsigned int mip = 0; mip < (std::max)(desc.MipLevels, 1u); ++mip) {
+        // Los BCn ocupan bloques enteros de 4x4 aunque el mip sea más pequeño.
+        const unsigned long long w = blocks ? ((width + 3) / 4) * 4 : width;
+        const unsigned long long h = blocks ? ((height + 3) / 4) * 4 : height;
+        bytes += w * h * bits / 8;
+        width = (std::max)(width >> 1, 1u);
+        height = (std::max)(height >> 1, 1u);
+    }
+    return bytes * (std::max)(desc.ArraySize, 1u) * (std::max)(desc.SampleDesc.Count, 1u);
+}
@@ -0,0 +1,519 @@
+﻿/**
+ * @file GpuParticles.cpp
+ * @brief Implementación de las partículas en GPU: buffers, kernels y dibujo indirecto.
+ *
+ * @details
+ * Orden de un frame en @ref GpuParticles::simulate (todo en la GPU, sin esperas):
+ * reset si toca, un `CSEmit` por emisión, `CSPrepareArgs` (argumentos del dispatch de
+ * la simulación a partir de las vivas), `CSSimulate` indirecto, los contadores de la
+ * lista nueva a los argumentos del draw y a `cbAliveCount` y, si se ordena, las claves
+ * y el bitonic sort. @ref GpuParticles::render solo dibuja.
+ */
+
+#include "GpuParticles.h"
+#include "Device.h"
+#include "DeviceContext.h"
+#include "ShaderLibrary.h"
+#include <algorithm>
+
+const ConstantBufferLayouts::Registration GpuParticles::kParticlesLayout({ "cbParticles", CB_SLOT_PARTICLES,
+    sizeof(CBParticles), {
+        CB_FIELD(CBParticles, emitPosition, "EmitPosition"),
+        CB_FIELD(CBParticles, emitVelocity, "EmitVelocity"),
+        CB_FIELD(CBParticles, emitColor, "EmitColor"),
+        CB_FIELD(CBParticles, emitShape, "EmitShape"),
+        CB_FIELD(CBParticles, emitInfo, "EmitInfo"),
+        CB_FIELD(CBParticles, sortInfo, "SortInfo"),
+        CB_FIELD(CBParticles, gravity, "Gravity"),
+        CB_FIELD(CBParticles, simulation, "Simulation"),
+        CB_FIELD(CBParticles, cameraRight, "CameraRight"),
+        CB_FIELD(CBParticles, cameraUp, "CameraUp"),
+        CB_FIELD(CBParticles, cameraForward, "CameraForward"),
+        CB_FIELD(CBParticles, viewProj, "ViewProj") } });
+const ConstantBufferLayouts::Registration GpuParticles::kDeadCountLayout({ "cbDeadCount", CB_SLOT_DEAD_COUNT,
+    sizeof(CBCount), { CB_FIELD(CBCount, count, "DeadCount") } });
+const ConstantBufferLayouts::Registration GpuParticles::kAliveCountLayout({ "cbAliveCount", CB_SLOT_ALIVE_COUNT,
+    sizeof(CBCount), { CB_FIELD(CBCount, count, "AliveCount") } });
+
+namespace {
+    /// Argumentos indirectos: `DrawInstancedIndirect` (4) y `DispatchIndirect` (3), más relleno.
+    const unsigned int kArgsCount = 8;
+    const unsigned int kDrawArgsOffset = 0;
+    const unsigned int kDispatchArgsOffset = 4 * sizeof(unsigned int);
+    /// UAVs de los kernels: u0 partículas, u1 muertas (consume), u2 vivas (append),
+    /// u3 argumentos, u4 claves del orden, u5 muertas (append). La lista de muertas va
+    /// en dos registros porque HLSL no deja declarar dos tipos en el mismo.
+    const unsigned int kUAVCount = 6;
+
+    uint32_t packColor(const XMFLOAT4& color) {
+        auto channel = [](float v) {
+            return static_cast<uint32_t>((std::min)((std::max)(v, 0.0f), 1.0f) * 255.0f + 0.5f);
+        };
+        return channel(color.x) | (channel(color.y) << 8) | (channel(color.z) << 16) | (channel(color.w) << 24);
+    }
+
+    /**
+     * Buffer estructurado con UAV (y SRV si se pide). `uavFlags` = APPEND para las
+     * listas: el mismo contador oculto sirve para Append y Consume.
+     */
+    HRESULT createStructured(Device& device, unsigned int count, unsigned int stride, bool withSRV,
+        unsigned int uavFlags, ID3D11Buffer** buffer, ID3D11UnorderedAccessView** uav,
+        ID3D11ShaderResourceView** srv) {
+        D3D11_BUFFER_DESC desc = {};
+        desc.Usage = D3D11_USAGE_DEFAULT;
+        desc.ByteWidth = count * stride;
+        desc.BindFlags = D3D11_BIND_UNORDERED_ACCESS | (withSRV ? D3D11_BIND_SHADER_RESOURCE : 0);
+        desc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+        desc.StructureByteStride = stride;
+        HRESULT hr = device.CreateBuffer(&desc, nullptr, buffer);
+
+        D3D11_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
+        uavDesc.Format = DXGI_FORMAT_UNKNOWN;
+        uavDesc.ViewDimension = D3D11_UAV_DIMENSION_BUFFER;
+        uavDesc.Buffer.NumElements = count;
+        uavDesc.Buffer.Flags = uavFlags;
+        if (SUCCEEDED(hr)) { hr = device.CreateUnorderedAccessView(*buffer, &uavDesc, uav); }
+        if (SUCCEEDED(hr) && withSRV) {
+            D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+            srvDesc.Format = DXGI_FORMAT_UNKNOWN;
+            srvDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+            srvDesc.Buffer.NumElements = count;
+            hr = device.CreateShaderResourceView(*buffer, &srvDesc, srv);
+        }
+        return hr;
+    }
+
+    HRESULT createConstants(Device& device, unsigned int size, ID3D11Buffer** buffer) {
+        D3D11_BUFFER_DESC desc = {};
+        desc.Usage = D3D11_USAGE_DEFAULT;
+        desc.ByteWidth = size;
+        desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+        return device.CreateBuffer(&desc, nullptr, buffer);
+    }
+}
+
+HRESULT GpuParticles::init(Device& device, unsigned int capacity) {
+    if (!device.m_device) {
+        ERROR("GpuParticles", "init", "Device is null.");
+        return E_POINTER;
+    }
+    destroy();
+
+    // Append/consume y argumentos indirectos escritos por la GPU: nivel 11_0.
+    if (device.m_device->GetFeatureLevel() < D3D_FEATURE_LEVEL_11_0) {
+        MESSAGE("GpuParticles", "init", "Feature level < 11_0: GPU particles disabled.");
+        return DXGI_ERROR_UNSUPPORTED;
+    }
+
+    // Potencia de dos: el bitonic sort y los dispatch de grupos completos lo necesitan.
+    unsigned int rounded = kSortGroupSize;
+    while (rounded < capacity && rounded < (1u << 30)) rounded *= 2;
+    m_capacity = rounded;
+
+    HRESULT hr = createConstants(device, sizeof(CBParticles), &m_params);
+    if (SUCCEEDED(hr)) { hr = createConstants(device, sizeof(CBCount), &m_deadCount); }
+    if (SUCCEEDED(hr)) { hr = createConstants(device, sizeof(CBCount), &m_aliveCount); }
+    if (SUCCEEDED(hr)) {
+        hr = createStructured(device, m_capacity, sizeof(Particle), true, 0,
+            &m_particleBuffer, &m_particleUAV, &m_particleSRV);
+    }
+    if (SUCCEEDED(hr)) {
+        hr = createStructured(device, m_capacity, sizeof(uint32_t), false, D3D11_BUFFER_UAV_FLAG_APPEND,
+            &m_deadBuffer, &m_deadUAV, nullptr);
+    }
+    for (unsigned int i = 0; i < 2 && SUCCEEDED(hr); ++i) {
+        hr = createStructured(device, m_capacity, sizeof(uint32_t), true, D3D11_BUFFER_UAV_FLAG_APPEND,
+            &m_aliveBuffer[i], &m_aliveUAV[i], &m_aliveSRV[i]);
+    }
+    if (SUCCEEDED(hr)) {
+        const unsigned int initial[kArgsCount] = { 4, 0, 0, 0, 0, 1, 1, 0 };
+        D3D11_BUFFER_DESC desc = {};
+        desc.Usage = D3D11_USAGE_DEFAULT;
+        desc.ByteWidth = sizeof(initial);
+        desc.BindFlags = D3D11_BIND_UNORDERED_ACCESS;
+        desc.MiscFlags = D3D11_RESOURCE_MISC_DRAWINDIRECT_ARGS;
+        D3D11_SUBRESOURCE_DATA data = { initial, 0, 0 };
+        hr = device.CreateBuffer(&desc, &data, &m_argsBuffer);
+
+        // Tipada R32_UINT: los buffers de argumentos no pueden ser estructurados.
+        D3D11_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
+        uavDesc.Format = DXGI_FORMAT_R32_UINT;
+        uavDesc.ViewDimension = D3D11_UAV_DIMENSION_BUFFER;
+        uavDesc.Buffer.NumElements = kArgsCount;
+        if (SUCCEEDED(hr)) { hr = device.CreateUnorderedAccessView(m_argsBuffer, &uavDesc, &m_argsUAV); }
+    }
+    if (FAILED(hr)) {
+        ERROR("GpuParticles", "init", ("Failed to create particle buffers. HRESULT: " + std::to_string(hr)).c_str());
+        destroy();
+        return hr;
+    }
+
+    ShaderLibrary& library = device.getShaderLibrary();
+    ShaderKey key;
+    key.fileName = "GpuParticles.fx";
+    key.profile = "cs_5_0";
+    struct { const char* entry; ID3D11ComputeShader** shader; } kernels[] = {
+        { "CSReset", &m_resetShader },
+        { "CSEmit", &m_emitShader },
+        { "CSPrepareArgs", &m_prepareShader },
+        { "CSSimulate", &m_simulateShader },
+        { "CSSortKeys", &m_sortKeysShader },
+        { "CSSortLocal", &m_sortLocalShader },
+        { "CSSortStep", &m_sortStepShader },
+        { "CSSortMerge", &m_sortMergeShader },
+    };
+    for (auto& kernel : kernels) {
+        key.entryPoint = kernel.entry;
+        hr = library.getComputeShader(device, key, kernel.shader);
+        if (FAILED(hr)) {
+            break;
+        }
+    }
+    if (SUCCEEDED(hr)) {
+        key.entryPoint = "VSParticles";
+        key.profile = "vs_5_0";
+        hr = library.getVertexShader(device, key, &m_vertexShader);
+    }
+    if (SUCCEEDED(hr)) {
+        key.entryPoint = "VSParticlesSorted";
+        hr = library.getVertexShader(device, key, &m_sortedVertexShader);
+    }
+    if (SUCCEEDED(hr)) {
+        key.entryPoint = "PSParticles";
+        key.profile = "ps_5_0";
+        hr = library.getPixelShader(device, key, &m_pixelShader);
+    }
+
+    // Color premultiplicado en el PS: con orden, "over"; sin él, suma (no depende del orden).
+    if (SUCCEEDED(hr)) {
+        D3D11_BLEND_DESC desc = {};
+        D3D11_RENDER_TARGET_BLEND_DESC& target = desc.RenderTarget[0];
+        target.BlendEnable = TRUE;
+        target.SrcBlend = D3D11_BLEND_ONE;
+        target.DestBlend = D3D11_BLEND_ONE;
+        target.BlendOp = D3D11_BLEND_OP_ADD;
+        target.SrcBlendAlpha = D3D11_BLEND_ZERO;
+        target.DestBlendAlpha = D3D11_BLEND_ONE;
+        target.BlendOpAlpha = D3D11_BLEND_OP_ADD;
+        target.RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
+        hr = device.CreateSharedBlendState(&desc, &m_additive);
+        if (SUCCEEDED(hr)) {
+            target.DestBlend = D3D11_BLEND_INV_SRC_ALPHA;
+            hr = device.CreateSharedBlendState(&desc, &m_premultiplied);
+        }
+    }
+    if (SUCCEEDED(hr)) { hr = m_rasterizer.init(device, 0, 0.0f, D3D11_CULL_NONE); }
+    if (SUCCEEDED(hr)) { hr = m_noDepth.init(device, false, false, false); }
+    if (FAILED(hr)) {
+        ERROR("GpuParticles", "init", ("Failed to create particle shaders or states. HRESULT: " +
+            std::to_string(hr)).c_str());
+        destroy();
+        return hr;
+    }
+
+    m_device = &device;
+    m_needsReset = true;
+    m_alive = 0;
+    return S_OK;
+}
+
+int GpuParticles::addEmitter(const Emitter& emitter) {
+    for (unsigned int i = 0; i < kMaxEmitters; ++i) {
+        if (!m_emitters[i].used) {
+            m_emitters[i].emitter = emitter;
+            m_emitters[i].carry = 0.0f;
+            m_emitters[i].used = true;
+            ++m_activeEmitters;
+            return static_cast<int>(i);
+        }
+    }
+    ERROR("GpuParticles", "addEmitter", ("No free emitter slots (max " + std::to_string(kMaxEmitters) + ")").c_str());
+    return -1;
+}
+
+void GpuParticles::setEmitter(int id, const Emitter& emitter) {
+    if (id >= 0 && id < static_cast<int>(kMaxEmitters) && m_emitters[id].used) {
+        m_emitters[id].emitter = emitter;
+    }
+}
+
+void GpuParticles::removeEmitter(int id) {
+    if (id >= 0 && id < static_cast<int>(kMaxEmitters) && m_emitters[id].used) {
+        m_emitters[id].used = false;
+        --m_activeEmitters;
+    }
+}
+
+const GpuParticles::Emitter* GpuParticles::getEmitter(int id) const {
+    if (id >= 0 && id < static_cast<int>(kMaxEmitters) && m_emitters[id].used) {
+        return &m_emitters[id].emitter;
+    }
+    return nullptr;
+}
+
+/**
+ * @details El ritmo se integra en CPU con la fracción pendiente de cada emisor, así
+ * que 30 partículas/s a 144 Hz sueltan una cada 4 o 5 frames en lugar de ninguna. Lo
+ * que no quepa en la lista de muertas se descarta en la GPU (`CSEmit`).
+ */
+void GpuParticles::capture(float deltaTime) {
+    m_emissions.clear();
+    m_frameSettings = m_settings;
+    m_deltaTime = (std::max)(deltaTime, 0.0f);
+    m_liveSeconds = (std::max)(m_liveSeconds - m_deltaTime, 0.0f);
+    if (!isReady()) {
+        return;
+    }
+    for (EmitterSlot& slot : m_emitters) {
+        const Emitter& emitter = slot.emitter;
+        if (!slot.used || !emitter.enabled || emitter.rate <= 0.0f || emitter.lifetime <= 0.0f) {
+            continue;
+        }
+        slot.carry += emitter.rate * m_deltaTime;
+        const unsigned int count = static_cast<unsigned int>((std::min)(slot.carry, static_cast<float>(m_capacity)));
+        slot.carry -= static_cast<float>(count);
+        if (count > 0) {
+            m_emissions.push_back({ emitter, count });
+            m_liveSeconds = (std::max)(m_liveSeconds, emitter.lifetime + (std::max)(emitter.lifetimeVariance, 0.0f));
+        }
+    }
+}
+
+void GpuParticles::simulate(DeviceContext& deviceContext, const XMMATRIX& view, const XMFLOAT3& cameraPosition) {
+    m_sortedFrame = false;
+    if (!isActive()) {
+        return;
+    }
+    DeviceContext::EventScope event(deviceContext, "Particle simulation");
+    const unsigned int current = m_alive;
+    const unsigned int next = 1 - m_alive;
+    const unsigned int keep = static_cast<unsigned int>(-1);
+
+    XMFLOAT4X4 v;
+    XMStoreFloat4x4(&v, view);
+    const XMFLOAT3 forward(v._13, v._23, v._33);
+    m_constants.cameraForward = XMFLOAT4(forward.x, forward.y, forward.z,
+        -(forward.x * cameraPosition.x + forward.y * cameraPosition.y + forward.z * cameraPosition.z));
+    const Settings& settings = m_frameSettings;
+    m_constants.gravity = XMFLOAT4(settings.gravity.x, settings.gravity.y, settings.gravity.z, m_deltaTime);
+    m_constants.simulation.x = (std::max)(settings.drag, 0.0f);
+    m_constants.emitInfo[2] = m_capacity;
+    m_constants.sortInfo[2] = m_capacity;
+
+    ID3D11Buffer* constants[3] = { m_params, m_deadCount, m_aliveCount };
+    deviceContext.CSSetConstantBuffers(CB_SLOT_PARTICLES, 3, constants);
+
+    // Todas muertas: la lista de muertas se rellena con todos los índices y la de vivas
+    // que va a leer la simulación se vacía (el contador se fija al enlazar).
+    if (m_needsReset) {
+        upload(deviceContext);
+        ID3D11UnorderedAccessView* uavs[kUAVCount] = { nullptr, nullptr, m_aliveUAV[current], nullptr, nullptr, m_deadUAV };
+        const UINT counts[kUAVCount] = { keep, keep, 0, keep, keep, 0 };
+        deviceContext.CSSetShader(m_resetShader, nullptr, 0);
+        deviceContext.CSSetUnorderedAccessViews(0, kUAVCount, uavs, counts);
+        deviceContext.Dispatch(m_capacity / kThreadGroupSize, 1, 1);
+        m_needsReset = false;
+    }
+
+    // Emisión: el contador de muertas se copia antes de cada emisor (el anterior lo bajó).
+    if (!m_emissions.empty()) {
+        ID3D11UnorderedAccessView* uavs[3] = { m_particleUAV, m_deadUAV, m_aliveUAV[current] };
+        const UINT counts[3] = { keep, keep, keep };
+        deviceContext.CSSetShader(m_emitShader, nullptr, 0);
+        deviceContext.CSSetUnorderedAccessViews(0, 3, uavs, counts);
+        for (const Emission& emission : m_emissions) {
+            const Emitter& e = emission.emitter;
+            m_constants.emitPosition = XMFLOAT4(e.position.x, e.position.y, e.position.z, (std::max)(e.radius, 0.0f));
+            m_constants.emitVelocity = XMFLOAT4(e.velocity.x, e.velocity.y, e.velocity.z, (std::max)(e.spread, 0.0f));
+            m_constants.emitColor[0] = packColor(e.color);
+            m_constants.emitColor[1] = packColor(e.colorEnd);
+            m_constants.emitShape = XMFLOAT4(e.size, e.sizeEnd, e.lifetime, (std::max)(e.lifetimeVariance, 0.0f));
+            m_constants.emitInfo[0] = emission.count;
+            m_constants.emitInfo[1] = ++m_seed;
+            upload(deviceContext);
+            deviceContext.CopyStructureCount(m_deadCount, 0, m_deadUAV);
+            deviceContext.Dispatch((emission.count + kThreadGroupSize - 1) / kThreadGroupSize, 1, 1);
+        }
+    }
+    unbindCompute(deviceContext);
+
+    // Argumentos de la simulación a partir de las vivas (las del frame anterior y las nuevas).
+    deviceContext.CopyStructureCount(m_aliveCount, 0, m_aliveUAV[current]);
+    upload(deviceContext);
+    deviceContext.CSSetShader(m_prepareShader, nullptr, 0);
+    deviceContext.CSSetUnorderedAccessViews(3, 1, &m_argsUAV, nullptr);
+    deviceContext.Dispatch(1, 1, 1);
+    unbindCompute(deviceContext);
+
+    // Simulación: las supervivientes pasan a la otra lista (que empieza vacía).
+    {
+        ID3D11UnorderedAccessView* uavs[kUAVCount] = { m_particleUAV, nullptr, m_aliveUAV[next], nullptr, nullptr, m_deadUAV };
+        const UINT counts[kUAVCount] = { keep, keep, 0, keep, keep, keep };
+        deviceContext.CSSetShader(m_simulateShader, nullptr, 0);
+        deviceContext.CSSetShaderResources(0, 1, &m_aliveSRV[current]);
+        deviceContext.CSSetUnorderedAccessViews(0, kUAVCount, uavs, counts);
+        deviceContext.DispatchIndirect(m_argsBuffer, kDispatchArgsOffset);
+        unbindCompute(deviceContext);
+    }
+    // Instancias del draw y vivas para el orden, sin pasar por la CPU.
+    deviceContext.CopyStructureCount(m_argsBuffer, kDrawArgsOffset + sizeof(unsigned int), m_aliveUAV[next]);
+    deviceContext.CopyStructureCount(m_aliveCount, 0, m_aliveUAV[next]);
+    m_alive = next;
+
+    if (settings.sorted && !m_sortFailed) {
+        if (!m_sortBuffer && FAILED(createSortBuffers())) {
+            ERROR("GpuParticles", "simulate", "Failed to create the sort buffer; particles are drawn unsorted");
+            m_sortFailed = true;
+        }
+        else {
+            dispatchSort(deviceContext, m_aliveSRV[m_alive]);
+            m_sortedFrame = true;
+        }
+    }
+    deviceContext.CSSetShader(nullptr, nullptr, 0);
+}
+
+/**
+ * @details Bitonic sort ascendente de `capacidad` claves (-profundidad, así que las
+ * lejanas primero). Las que sobran llevan `FLT_MAX` y acaban al final, detrás de las
+ * vivas, que son las que dibuja el draw. Los pasos con distancia < @ref kSortGroupSize
+ * se hacen en memoria compartida (`CSSortLocal`, `CSSortMerge`); el resto, uno por
+ * dispatch (`CSSortStep`).
+ */
+void GpuParticles::dispatchSort(DeviceContext& deviceContext, ID3D11ShaderResourceView* aliveSRV) {
+    DeviceContext::EventScope event(deviceContext, "Particle sort");
+    const unsigned int blocks = m_capacity / kSortGroupSize;
+    const unsigned int pairGroups = m_capacity / 2 / kThreadGroupSize;
+
+    ID3D11ShaderResourceView* srvs[2] = { aliveSRV, m_particleSRV };
+    deviceContext.CSSetShader(m_sortKeysShader, nullptr, 0);
+    deviceContext.CSSetShaderResources(0, 2, srvs);
+    deviceContext.CSSetUnorderedAccessViews(4, 1, &m_sortUAV, nullptr);
+    deviceContext.Dispatch(m_capacity / kThreadGroupSize, 1, 1);
+    ID3D11ShaderResourceView* nullSRVs[2] = { nullptr, nullptr };
+    deviceContext.CSSetShaderResources(0, 2, nullSRVs);
+
+    deviceContext.CSSetShader(m_sortLocalShader, nullptr, 0);
+    deviceContext.Dispatch(blocks, 1, 1);
+    for (unsigned int k = kSortGroupSize * 2; k <= m_capacity; k *= 2) {
+        deviceContext.CSSetShader(m_sortStepShader, nullptr, 0);
+        for (unsigned int j = k / 2; j >= kSortGroupSize; j /= 2) {
+            m_constants.sortInfo[0] = k;
+            m_constants.sortInfo[1] = j;
+            upload(deviceContext);
+            deviceContext.Dispatch(pairGroups, 1, 1);
+        }
+        deviceContext.CSSetShader(m_sortMergeShader, nullptr, 0);
+        deviceContext.Dispatch(blocks, 1, 1);
+    }
+    unbindCompute(deviceContext);
+}
+
+void GpuParticles::render(DeviceContext& deviceContext, ID3D11RenderTargetView* rtv, ID3D11ShaderResourceView* depthSRV,
+    unsigned int width, unsigned int height, const XMMATRIX& view, const XMMATRIX& projection,
+    float nearZ, float farZ) {
+    if (!isActive() || !rtv || width == 0 || height == 0) {
+        return;
+    }
+    DeviceContext::EventScope event(deviceContext, "Particles");
+
+    XMFLOAT4X4 v;
+    XMStoreFloat4x4(&v, view);
+    m_constants.cameraRight = XMFLOAT4(v._11, v._21, v._31, 0.0f);
+    m_constants.cameraUp = XMFLOAT4(v._12, v._22, v._32, 0.0f);
+    // Sin profundidad de la escena no hay fundido suave.
+    m_constants.simulation.y = depthSRV ? (std::max)(m_frameSettings.softDistance, 0.0f) : 0.0f;
+    m_constants.simulation.z = nearZ;
+    m_constants.simulation.w = farZ;
+    m_constants.viewProj = XMMatrixTranspose(view * projection);
+    upload(deviceContext);
+
+    D3D11_VIEWPORT viewport = {};
+    viewport.Width = static_cast<float>(width);
+    viewport.Height = static_cast<float>(height);
+    viewport.MaxDepth = 1.0f;
+    deviceContext.RSSetViewports(1, &viewport);
+    deviceContext.OMSetRenderTargets(1, &rtv, nullptr);
+    deviceContext.OMSetBlendState(m_sortedFrame ? m_premultiplied : m_additive, nullptr, 0xffffffff);
+    m_rasterizer.render(deviceContext);
+    m_noDepth.render(deviceContext);
+
+    // Quad generado con SV_VertexID: sin vertex buffer ni layout. t0 vivas, t1 partículas,
+    // t3 claves ordenadas (t2 es la profundidad del PS).
+    ID3D11ShaderResourceView* vsSRVs[4] = { m_aliveSRV[m_alive], m_particleSRV, nullptr,
+        m_sortedFrame ? m_sortSRV : nullptr };
+    deviceContext.IASetInputLayout(nullptr);
+    deviceContext.IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+    deviceContext.VSSetShader(m_sortedFrame ? m_sortedVertexShader : m_vertexShader, nullptr, 0);
+    deviceContext.PSSetShader(m_pixelShader, nullptr, 0);
+    deviceContext.VSSetConstantBuffers(CB_SLOT_PARTICLES, 1, &m_params);
+    deviceContext.PSSetConstantBuffers(CB_SLOT_PARTICLES, 1, &m_params);
+    deviceContext.VSSetShaderResources(0, 4, vsSRVs);
+    deviceContext.PSSetShaderResources(2, 1, &depthSRV);
+    deviceContext.DrawInstancedIndirect(m_argsBuffer, kDrawArgsOffset);
+
+    // Las listas vuelven a ser UAV en la simulación del frame siguiente.
+    ID3D11ShaderResourceView* nullSRVs[4] = {};
+    deviceContext.VSSetShaderResources(0, 4, nullSRVs);
+    deviceContext.PSSetShaderResources(2, 1, nullSRVs);
+    deviceContext.OMSetBlendState(nullptr, nullptr, 0xffffffff);
+    m_noDepth.render(deviceContext, 0, true);
+}
+
+HRESULT GpuParticles::createSortBuffers() {
+    // (clave, índice): 8 bytes por hueco de la capacidad.
+    return createStructured(*m_device, m_capacity, 2 * sizeof(uint32_t), true, 0,
+        &m_sortBuffer, &m_sortUAV, &m_sortSRV);
+}
+
+void GpuParticles::upload(DeviceContext& deviceContext) {
+    deviceContext.UpdateSubresource(m_params, 0, nullptr, &m_constants, 0, 0);
+}
+
+void GpuParticles::unbindCompute(DeviceContext& deviceContext) {
+    ID3D11ShaderResourceView* nullSRV = nullptr;
+    ID3D11UnorderedAccessView* nullUAVs[kUAVCount] = {};
+    deviceContext.CSSetShaderResources(0, 1, &nullSRV);
+    deviceContext.CSSetUnorderedAccessViews(0, kUAVCount, nullUAVs, nullptr);
+}
+
+void GpuParticles::destroy() {
+    SAFE_RELEASE(m_params);
+    SAFE_RELEASE(m_deadCount);
+    SAFE_RELEASE(m_aliveCount);
+    SAFE_RELEASE(m_particleUAV);
+    SAFE_RELEASE(m_particleSRV);
+    SAFE_RELEASE(m_particleBuffer);
+    SAFE_RELEASE(m_deadUAV);
+    SAFE_RELEASE(m_deadBuffer);
+    for (unsigned int i = 0; i < 2; ++i) {
+        SAFE_RELEASE(m_aliveUAV[i]);
+        SAFE_RELEASE(m_aliveSRV[i]);
+        SAFE_RELEASE(m_aliveBuffer[i]);
+    }
+    SAFE_RELEASE(m_sortUAV);
+    SAFE_RELEASE(m_sortSRV);
+    SAFE_RELEASE(m_sortBuffer);
+    SAFE_RELEASE(m_argsUAV);
+    SAFE_RELEASE(m_argsBuffer);
+    SAFE_RELEASE(m_resetShader);
+    SAFE_RELEASE(m_emitShader);
+    SAFE_RELEASE(m_prepareShader);
+    SAFE_RELEASE(m_simulateShader);
+    SAFE_RELEASE(m_sortKeysShader);
+    SAFE_RELEASE(m_sortLocalShader);
+    SAFE_RELEASE(m_sortStepShader);
+    SAFE_RELEASE(m_sortMergeShader);
+    SAFE_RELEASE(m_vertexShader);
+    SAFE_RELEASE(m_sortedVertexShader);
+    SAFE_RELEASE(m_pixelShader);
+    SAFE_RELEASE(m_additive);
+    SAFE_RELEASE(m_premultiplied);
+    m_rasterizer.destroy();
+    m_noDepth.destroy();
+    m_emissions.clear();
+    m_liveSeconds = 0.0f;
+    m_sortFailed = false;
+    m_sortedFrame = false;
+    m_device = nullptr;
+}
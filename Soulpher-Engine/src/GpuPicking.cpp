@@ -0,0 +1,248 @@
+﻿/**
+ * @file GpuPicking.cpp
+ * @brief Implementación del picking por buffer de identificadores.
+ *
+ * @details
+ * La matriz del píxel se aplica después de la proyección: escala el clip space por el
+ * tamaño del viewport y lo desplaza para que el centro del píxel pedido caiga en el
+ * origen. Lo que cubría ese píxel cubre ahora el target de 1x1 entero, y el frustum de
+ * `vista * proyección * píxel` es el prisma que sale de la cámara a través de él.
+ */
+
+#include "GpuPicking.h"
+#include "Device.h"
+#include "DeviceContext.h"
+#include "Frustum.h"
+#include "GpuMemory.h"
+#include "MeshAsset.h"
+#include "SceneBVH.h"
+#include "ECS/Actor.h"
+
+HRESULT GpuPicking::init(Device& device, const std::vector<D3D11_INPUT_ELEMENT_DESC>& layout) {
+    if (!device.m_device) {
+        ERROR("GpuPicking", "init", "Device is null.");
+        return E_POINTER;
+    }
+    destroy();
+    m_device = device.m_device;
+    m_device->AddRef();
+
+    D3D11_TEXTURE2D_DESC desc = {};
+    desc.Width = 1;
+    desc.Height = 1;
+    desc.MipLevels = 1;
+    desc.ArraySize = 1;
+    desc.Format = DXGI_FORMAT_R32_UINT;
+    desc.SampleDesc.Count = 1;
+    desc.Usage = D3D11_USAGE_DEFAULT;
+    desc.BindFlags = D3D11_BIND_RENDER_TARGET;
+    HRESULT hr = m_device->CreateTexture2D(&desc, nullptr, &m_target);
+    if (SUCCEEDED(hr)) { hr = m_device->CreateRenderTargetView(m_target, nullptr, &m_targetView); }
+    if (SUCCEEDED(hr)) {
+        desc.Format = DXGI_FORMAT_D32_FLOAT;
+        desc.BindFlags = D3D11_BIND_DEPTH_STENCIL;
+        hr = m_device->CreateTexture2D(&desc, nullptr, &m_depth);
+    }
+    if (SUCCEEDED(hr)) { hr = m_device->CreateDepthStencilView(m_depth, nullptr, &m_depthView); }
+    desc.Format = DXGI_FORMAT_R32_UINT;
+    desc.Usage = D3D11_USAGE_STAGING;
+    desc.BindFlags = 0;
+    desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+    for (Slot& slot : m_slots) {
+        if (SUCCEEDED(hr)) { hr = m_device->CreateTexture2D(&desc, nullptr, &slot.staging); }
+    }
+    if (SUCCEEDED(hr)) { hr = m_program.init(device, "Picking.fx", layout); }
+    if (SUCCEEDED(hr)) { hr = m_projection.init(device); }
+    if (SUCCEEDED(hr)) { hr = m_object.init(device); }
+    if (SUCCEEDED(hr)) {
+        // Sin culling: el identificador no depende de hacia dónde mire la cara.
+        D3D11_RASTERIZER_DESC rasterizer = {};
+        rasterizer.FillMode = D3D11_FILL_SOLID;
+        rasterizer.CullMode = D3D11_CULL_NONE;
+        rasterizer.DepthClipEnable = TRUE;
+        hr = device.CreateSharedRasterizerState(&rasterizer, &m_rasterizer);
+    }
+    if (FAILED(hr)) {
+        ERROR("GpuPicking", "init", ("Failed to create the picking target. hr=" + std::to_string(hr)).c_str());
+        destroy();
+        return hr;
+    }
+    GpuMemory::track(m_target);
+    GpuMemory::track(m_depth);
+    for (Slot& slot : m_slots) {
+        GpuMemory::track(slot.staging);
+    }
+    return S_OK;
+}
+
+void GpuPicking::request(int x, int y, unsigned int width, unsigned int height) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_request.x = x;
+    m_request.y = y;
+    m_request.width = width;
+    m_request.height = height;
+    m_requested = true;
+}
+
+bool GpuPicking::render(DeviceContext& deviceContext, const XMMATRIX& view, const XMMATRIX& projection,
+    const SceneBVH& staticTree, const SceneBVH& dynamicTree, const std::vector<ActorHandle>& actors) {
+    ++m_frame;
+    Slot* freeSlot = nullptr;
+    for (Slot& slot : m_slots) {
+        if (slot.busy && m_frame - slot.frame >= kLatencyFrames) {
+            readback(deviceContext, slot);
+        }
+        if (!slot.busy && !freeSlot) {
+            freeSlot = &slot;
+        }
+    }
+
+    Request request;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        // Sin slot libre, la petición espera al siguiente frame.
+        if (!m_requested || !freeSlot || !isReady()) {
+            return false;
+        }
+        request = m_request;
+        m_requested = false;
+    }
+    if (request.width == 0 || request.height == 0 ||
+        request.x < 0 || request.y < 0 ||
+        request.x >= static_cast<int>(request.width) || request.y >= static_cast<int>(request.height)) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_result = ActorHandle();
+        m_hasResult = true;
+        return false;
+    }
+    DeviceContext::EventScope event(deviceContext, "Picking");
+
+    // Centro del píxel en NDC (y hacia arriba) llevado al origen y ampliado al viewport.
+    const float w = static_cast<float>(request.width);
+    const float h = static_cast<float>(request.height);
+    const float ndcX = (request.x + 0.5f) / w * 2.0f - 1.0f;
+    const float ndcY = 1.0f - (request.y + 0.5f) / h * 2.0f;
+    const XMMATRIX pixel = XMMatrixMultiply(XMMatrixScaling(w, h, 1.0f),
+        XMMatrixTranslation(-ndcX * w, -ndcY * h, 0.0f));
+    const XMMATRIX pickProjection = XMMatrixMultiply(projection, pixel);
+
+    // Candidatos: solo los actores cuya caja toca el prisma del píxel.
+    Frustum frustum;
+    frustum.update(XMMatrixMultiply(view, pickProjection));
+    m_ids.clear();
+    staticTree.cull(frustum, m_ids);
+    dynamicTree.cull(frustum, m_ids);
+
+    const float clearId[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    deviceContext.ClearRenderTargetView(m_targetView, clearId);
+    deviceContext.ClearDepthStencilView(m_depthView, D3D11_CLEAR_DEPTH, 1.0f, 0);
+    deviceContext.OMSetRenderTargets(1, &m_targetView, m_depthView);
+    D3D11_VIEWPORT viewport = { 0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f };
+    deviceContext.RSSetViewports(1, &viewport);
+    // Un target entero no admite blending; profundidad por defecto (LESS, con escritura).
+    deviceContext.OMSetBlendState(nullptr, nullptr, 0xffffffff);
+    deviceContext.OMSetDepthStencilState(nullptr, 0);
+    deviceContext.RSSetState(m_rasterizer);
+    deviceContext.IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+    CBChangeOnResize pickCamera;
+    pickCamera.mProjection = XMMatrixTranspose(pickProjection);
+    m_projection.set(pickCamera);
+    m_projection.update(deviceContext);
+    m_projection.render(deviceContext, CB_SLOT_PROJECTION);
+    m_program.render(deviceContext);
+
+    freeSlot->candidates.clear();
+    for (unsigned int id : m_ids) {
+        if (id >= actors.size() || actors[id].isNull()) {
+            continue;
+        }
+        Actor& actor = *actors[id];
+        if (actor.getMeshAsset().isNull()) {
+            continue;
+        }
+        freeSlot->candidates.push_back(actors[id]);
+
+        // Mundo tal como lo dibuja el pase principal; el color lleva el identificador
+        // (exacto como float hasta 2^24 candidatos).
+        CBChangesEveryFrame object = actor.getObjectData();
+        object.vMeshColor = XMFLOAT4(static_cast<float>(freeSlot->candidates.size()), 0.0f, 0.0f, 0.0f);
+        m_object.set(object);
+        m_object.update(deviceContext);
+        m_object.render(deviceContext, CB_SLOT_OBJECT, true);
+
+        MeshAsset& mesh = actor.getMeshAsset()->getLOD(actor.getLODLevel());
+        for (unsigned int i = 0; i < mesh.getSubmeshCount(); ++i) {
+            const SubmeshDraw draw = mesh.getDraw(i);
+            Buffer* vertices = draw.positions ? draw.positions : draw.vertices;
+            vertices->render(deviceContext, VERTEX_STREAM_GEOMETRY, 1);
+            draw.indices->render(deviceContext, 0, 1, false, draw.indices->getIndexFormat());
+            deviceContext.DrawIndexed(draw.indexCount, draw.startIndex, draw.baseVertex);
+        }
+    }
+
+    deviceContext.CopySubresourceRegion(freeSlot->staging, 0, 0, 0, 0, m_target, 0, nullptr);
+    freeSlot->frame = m_frame;
+    freeSlot->busy = true;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_inFlight;
+    return true;
+}
+
+bool GpuPicking::readback(DeviceContext& deviceContext, Slot& slot) {
+    D3D11_MAPPED_SUBRESOURCE mapped = {};
+    HRESULT hr = deviceContext.Map(slot.staging, 0, D3D11_MAP_READ, D3D11_MAP_FLAG_DO_NOT_WAIT, &mapped);
+    if (hr == DXGI_ERROR_WAS_STILL_DRAWING) {
+        return false;
+    }
+    slot.busy = false;
+    if (FAILED(hr)) {
+        ERROR("GpuPicking", "readback", "Failed to map the picking texel");
+        std::lock_guard<std::mutex> lock(m_mutex);
+        --m_inFlight;
+        return false;
+    }
+    const uint32_t id = *static_cast<const uint32_t*>(mapped.pData);
+    deviceContext.Unmap(slot.staging, 0);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    --m_inFlight;
+    m_result = (id > 0 && id <= slot.candidates.size()) ? slot.candidates[id - 1] : ActorHandle();
+    m_hasResult = true;
+    return true;
+}
+
+bool GpuPicking::consumeResult(ActorHandle& outActor) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_hasResult) {
+        return false;
+    }
+    outActor = m_result;
+    m_hasResult = false;
+    return true;
+}
+
+bool GpuPicking::isPending() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_requested || m_hasResult || m_inFlight > 0;
+}
+
+void GpuPicking::destroy() {
+    for (Slot& slot : m_slots) {
+        SAFE_RELEASE(slot.staging);
+        slot.candidates.clear();
+        slot.busy = false;
+    }
+    SAFE_RELEASE(m_targetView);
+    SAFE_RELEASE(m_target);
+    SAFE_RELEASE(m_depthView);
+    SAFE_RELEASE(m_depth);
+    SAFE_RELEASE(m_rasterizer);
+    m_program.destroy();
+    m_projection.destroy();
+    m_object.destroy();
+    SAFE_RELEASE(m_device);
+    m_requested = false;
+    m_hasResult = false;
+    m_inFlight = 0;
+}
@@ -0,0 +1,247 @@
+﻿/**
+ * @file GpuProfiler.cpp
+ * @brief Implementación del perfilador de GPU con queries de timestamp.
+ */
+
+#include "GpuProfiler.h"
+#include "Device.h"
+#include "DeviceContext.h"
+
+HRESULT GpuProfiler::init(Device& device) {
+    if (!device.m_device) {
+        ERROR("GpuProfiler", "init", "Device is null.");
+        return E_POINTER;
+    }
+    destroy();
+
+    D3D11_QUERY_DESC disjointDesc = {};
+    disjointDesc.Query = D3D11_QUERY_TIMESTAMP_DISJOINT;
+    D3D11_QUERY_DESC timestampDesc = {};
+    timestampDesc.Query = D3D11_QUERY_TIMESTAMP;
+
+    HRESULT hr = S_OK;
+    for (FrameQueries& frame : m_frames) {
+        hr = device.m_device->CreateQuery(&disjointDesc, &frame.disjoint);
+        if (SUCCEEDED(hr)) hr = device.m_device->CreateQuery(&timestampDesc, &frame.frameBegin);
+        if (SUCCEEDED(hr)) hr = device.m_device->CreateQuery(&timestampDesc, &frame.frameEnd);
+        for (unsigned int i = 0; SUCCEEDED(hr) && i < kMaxScopes; ++i) {
+            hr = device.m_device->CreateQuery(&timestampDesc, &frame.begin[i]);
+            if (SUCCEEDED(hr)) hr = device.m_device->CreateQuery(&timestampDesc, &frame.end[i]);
+        }
+        if (FAILED(hr)) {
+            ERROR("GpuProfiler", "init",
+                ("Failed to create timestamp queries. HRESULT: " + std::to_string(hr)).c_str());
+            destroy();
+            return hr;
+        }
+    }
+
+    // Estadísticas de pipeline: opcionales, un fallo solo las desactiva.
+    D3D11_QUERY_DESC statisticsDesc = {};
+    statisticsDesc.Query = D3D11_QUERY_PIPELINE_STATISTICS;
+    m_statisticsSupported = true;
+    for (FrameQueries& frame : m_frames) {
+        for (unsigned int i = 0; m_statisticsSupported && i < kMaxScopes; ++i) {
+            m_statisticsSupported = SUCCEEDED(device.m_device->CreateQuery(&statisticsDesc, &frame.statistics[i]));
+        }
+    }
+    if (!m_statisticsSupported) {
+        MESSAGE("GpuProfiler", "init", "Pipeline statistics queries unavailable.");
+        for (FrameQueries& frame : m_frames) {
+            for (unsigned int i = 0; i < kMaxScopes; ++i) {
+                SAFE_RELEASE(frame.statistics[i]);
+            }
+        }
+    }
+
+    D3D11_QUERY_DESC eventDesc = {};
+    eventDesc.Query = D3D11_QUERY_EVENT;
+    hr = device.m_device->CreateQuery(&eventDesc, &m_calibrationEvent);
+    if (SUCCEEDED(hr)) hr = device.m_device->CreateQuery(&disjointDesc, &m_calibrationDisjoint);
+    if (SUCCEEDED(hr)) hr = device.m_device->CreateQuery(&timestampDesc, &m_calibrationTimestamp);
+    if (FAILED(hr)) {
+        ERROR("GpuProfiler", "init",
+            ("Failed to create calibration queries. HRESULT: " + std::to_string(hr)).c_str());
+        destroy();
+        return hr;
+    }
+    m_enabled = true;
+    return S_OK;
+}
+
+void GpuProfiler::beginFrame(DeviceContext& deviceContext) {
+    if (!m_enabled || m_inFrame) {
+        return;
+    }
+
+    // El juego que se reutiliza es el de hace kFrameLatency frames: casi siempre listo.
+    FrameQueries& frame = m_frames[m_current];
+    if (frame.pending) {
+        if (!collect(deviceContext, frame)) {
+            ++m_droppedFrames;
+        }
+        frame.pending = false;
+    }
+
+    frame.scopeCount = 0;
+    frame.statisticsIssued = m_statisticsRequested && m_statisticsSupported;
+    m_depth = 0;
+    m_inFrame = true;
+    deviceContext.m_deviceContext->Begin(frame.disjoint);
+    deviceContext.m_deviceContext->End(frame.frameBegin);
+}
+
+void GpuProfiler::endFrame(DeviceContext& deviceContext) {
+    if (!m_inFrame) {
+        return;
+    }
+    FrameQueries& frame = m_frames[m_current];
+    deviceContext.m_deviceContext->End(frame.frameEnd);
+    deviceContext.m_deviceContext->End(frame.disjoint);
+    frame.pending = true;
+    m_inFrame = false;
+    m_current = (m_current + 1) % kFrameLatency;
+}
+
+unsigned int GpuProfiler::beginScope(DeviceContext& deviceContext, const char* name) {
+    // El marcador va aparte de las queries: las capturas lo ven aunque no se mida.
+    deviceContext.beginEvent(name);
+    if (!m_inFrame) {
+        return kMaxScopes;
+    }
+    FrameQueries& frame = m_frames[m_current];
+    if (frame.scopeCount >= kMaxScopes) {
+        return kMaxScopes;
+    }
+    const unsigned int index = frame.scopeCount++;
+    frame.names[index] = name;
+    frame.depths[index] = m_depth++;
+    deviceContext.m_deviceContext->End(frame.begin[index]);
+    if (frame.statisticsIssued) {
+        deviceContext.m_deviceContext->Begin(frame.statistics[index]);
+    }
+    return index;
+}
+
+void GpuProfiler::endScope(DeviceContext& deviceContext, unsigned int index) {
+    if (m_inFrame && index < kMaxScopes) {
+        FrameQueries& frame = m_frames[m_current];
+        if (frame.statisticsIssued) {
+            deviceContext.m_deviceContext->End(frame.statistics[index]);
+        }
+        deviceContext.m_deviceContext->End(frame.end[index]);
+        if (m_depth > 0) {
+            --m_depth;
+        }
+    }
+    deviceContext.endEvent();
+}
+
+bool GpuProfiler::collect(DeviceContext& deviceContext, FrameQueries& frame) {
+    ID3D11DeviceContext* ctx = deviceContext.m_deviceContext;
+    const UINT flags = D3D11_ASYNC_GETDATA_DONOTFLUSH;
+
+    D3D11_QUERY_DATA_TIMESTAMP_DISJOINT disjoint = {};
+    if (ctx->GetData(frame.disjoint, &disjoint, sizeof(disjoint), flags) != S_OK ||
+        disjoint.Disjoint || disjoint.Frequency == 0) {
+        return false;
+    }
+
+    // Con la disjoint lista, los timestamps del frame también lo están.
+    const double toMs = 1000.0 / static_cast<double>(disjoint.Frequency);
+    UINT64 frameBegin = 0, frameEnd = 0;
+    if (ctx->GetData(frame.frameBegin, &frameBegin, sizeof(UINT64), flags) != S_OK ||
+        ctx->GetData(frame.frameEnd, &frameEnd, sizeof(UINT64), flags) != S_OK) {
+        return false;
+    }
+
+    m_results.clear();
+    for (unsigned int i = 0; i < frame.scopeCount; ++i) {
+        UINT64 begin = 0, end = 0;
+        if (ctx->GetData(frame.begin[i], &begin, sizeof(UINT64), flags) != S_OK ||
+            ctx->GetData(frame.end[i], &end, sizeof(UINT64), flags) != S_OK) {
+            continue;
+        }
+        Result result;
+        result.name = frame.names[i];
+        result.depth = frame.depths[i];
+        result.ms = (end > begin) ? static_cast<float>((end - begin) * toMs) : 0.0f;
+        result.begin = begin;
+        result.end = end;
+        result.hasStatistics = frame.statisticsIssued &&
+            ctx->GetData(frame.statistics[i], &result.statistics, sizeof(result.statistics), flags) == S_OK;
+        if (!result.hasStatistics) {
+            ZeroMemory(&result.statistics, sizeof(result.statistics));
+        }
+        m_results.push_back(result);
+    }
+    m_frameTime = (frameEnd > frameBegin) ? static_cast<float>((frameEnd - frameBegin) * toMs) : 0.0f;
+    m_frequency = disjoint.Frequency;
+    m_frameBegin = frameBegin;
+    m_frameEnd = frameEnd;
+    ++m_resultSerial;
+    return true;
+}
+
+bool GpuProfiler::calibrate(DeviceContext& deviceContext, LONGLONG& outCpuTicks,
+    UINT64& outGpuTicks, UINT64& outGpuFrequency) {
+    if (!m_enabled || m_inFrame) {
+        return false;
+    }
+    ID3D11DeviceContext* ctx = deviceContext.m_deviceContext;
+
+    // 1) Vaciar la GPU: así el timestamp siguiente se ejecuta en cuanto se envía.
+    ctx->End(m_calibrationEvent);
+    ctx->Flush();
+    deviceContext.waitForQuery(m_calibrationEvent, nullptr, 0);
+
+    // 2) Timestamp + lectura de CPU en el momento del envío.
+    ctx->Begin(m_calibrationDisjoint);
+    ctx->End(m_calibrationTimestamp);
+    ctx->End(m_calibrationDisjoint);
+    ctx->Flush();
+    LARGE_INTEGER cpu;
+    QueryPerformanceCounter(&cpu);
+
+    D3D11_QUERY_DATA_TIMESTAMP_DISJOINT disjoint = {};
+    deviceContext.waitForQuery(m_calibrationDisjoint, &disjoint, sizeof(disjoint));
+    UINT64 gpu = 0;
+    deviceContext.waitForQuery(m_calibrationTimestamp, &gpu, sizeof(gpu));
+    if (disjoint.Disjoint || disjoint.Frequency == 0) {
+        return false;
+    }
+
+    outCpuTicks = cpu.QuadPart;
+    outGpuTicks = gpu;
+    outGpuFrequency = disjoint.Frequency;
+    return true;
+}
+
+void GpuProfiler::destroy() {
+    for (FrameQueries& frame : m_frames) {
+        SAFE_RELEASE(frame.disjoint);
+        SAFE_RELEASE(frame.frameBegin);
+        SAFE_RELEASE(frame.frameEnd);
+        for (unsigned int i = 0; i < kMaxScopes; ++i) {
+            SAFE_RELEASE(frame.begin[i]);
+            SAFE_RELEASE(frame.end[i]);
+            SAFE_RELEASE(frame.statistics[i]);
+        }
+        frame.scopeCount = 0;
+        frame.statisticsIssued = false;
+        frame.pending = false;
+    }
+    SAFE_RELEASE(m_calibrationEvent);
+    SAFE_RELEASE(m_calibrationDisjoint);
+    SAFE_RELEASE(m_calibrationTimestamp);
+    m_current = 0;
+    m_depth = 0;
+    m_inFrame = false;
+    m_enabled = false;
+    m_statisticsSupported = false;
+    m_frequency = 0;
+    m_resultSerial = 0;
+    m_results.clear();
+    m_frameTime = 0.0f;
+    m_droppedFrames = 0;
+}
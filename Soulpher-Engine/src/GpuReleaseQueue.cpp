@@ -0,0 +1,64 @@
+﻿/**
+ * @file GpuReleaseQueue.cpp
+ * @brief Cola de `Release` por frame y su vaciado con los frames que terminó la GPU.
+ */
+
+#include "GpuReleaseQueue.h"
+
+GpuReleaseQueue& GpuReleaseQueue::getDefault() {
+    static GpuReleaseQueue s_queue;
+    return s_queue;
+}
+
+void GpuReleaseQueue::release(IUnknown* object) {
+    if (!object) {
+        return;
+    }
+    if (m_active.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        // Otra comprobación con el mutex: `flush` pudo cerrar la cola entre medias.
+        if (m_active.load(std::memory_order_relaxed)) {
+            m_pending.push_back(Pending{ object, m_frame });
+            return;
+        }
+    }
+    object->Release();
+}
+
+/**
+ * @details Los `Release` se hacen fuera del mutex: el último de un recurso grande puede
+ * tardar, y mientras tanto otros hilos pueden seguir soltando objetos.
+ */
+void GpuReleaseQueue::collect(unsigned long long currentFrame, unsigned long long completedFrames) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_frame = currentFrame;
+        while (!m_pending.empty() && m_pending.front().frame < completedFrames) {
+            m_ready.push_back(m_pending.front().object);
+            m_pending.pop_front();
+        }
+    }
+    m_active.store(true, std::memory_order_release);
+    for (IUnknown* object : m_ready) {
+        object->Release();
+    }
+    m_deferred.fetch_add(m_ready.size(), std::memory_order_relaxed);
+    m_ready.clear();
+}
+
+void GpuReleaseQueue::flush() {
+    std::deque<Pending> pending;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_active.store(false, std::memory_order_release);
+        pending.swap(m_pending);
+    }
+    for (const Pending& entry : pending) {
+        entry.object->Release();
+    }
+}
+
+size_t GpuReleaseQueue::getPendingCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_pending.size();
+}
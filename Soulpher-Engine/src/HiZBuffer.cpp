@@ -0,0 +1,297 @@
+﻿/**
+ * @file HiZBuffer.cpp
+ * @brief Implementación de la pirámide Hi-Z y la prueba de oclusión en CPU.
+ */
+
+#include "HiZBuffer.h"
+#include "Device.h"
+#include "DeviceContext.h"
+#include "ShaderLibrary.h"
+#include <cmath>
+
+HRESULT HiZBuffer::init(Device& device, unsigned int width, unsigned int height) {
+    if (!device.m_device) {
+        ERROR("HiZBuffer", "init", "Device is null.");
+        return E_POINTER;
+    }
+    if (width < 2 || height < 2) {
+        ERROR("HiZBuffer", "init", "Depth buffer is too small");
+        return E_INVALIDARG;
+    }
+    destroy();
+
+    // Los compute shaders con UAV sobre texturas requieren nivel 11_0.
+    if (device.m_device->GetFeatureLevel() < D3D_FEATURE_LEVEL_11_0) {
+        MESSAGE("HiZBuffer", "init", "Feature level < 11_0: occlusion culling disabled.");
+        return DXGI_ERROR_UNSUPPORTED;
+    }
+
+    // Nivel 0 a media resolución; cada nivel siguiente divide entre dos hasta 1x1.
+    unsigned int w = (std::max)(1u, width / 2);
+    unsigned int h = (std::max)(1u, height / 2);
+    for (;;) {
+        m_mipWidths.push_back(w);
+        m_mipHeights.push_back(h);
+        if (w == 1 && h == 1) break;
+        w = (std::max)(1u, w / 2);
+        h = (std::max)(1u, h / 2);
+    }
+    const unsigned int mipCount = static_cast<unsigned int>(m_mipWidths.size());
+
+    m_readbackMip = mipCount - 1;
+    for (unsigned int i = 0; i < mipCount; ++i) {
+        if (m_mipWidths[i] <= kReadbackMaxWidth) {
+            m_readbackMip = i;
+            break;
+        }
+    }
+
+    D3D11_TEXTURE2D_DESC desc = {};
+    desc.Width = m_mipWidths[0];
+    desc.Height = m_mipHeights[0];
+    desc.MipLevels = mipCount;
+    desc.ArraySize = 1;
+    desc.Format = DXGI_FORMAT_R32_FLOAT;
+    desc.SampleDesc.Count = 1;
+    desc.Usage = D3D11_USAGE_DEFAULT;
+    desc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_UNORDERED_ACCESS;
+    HRESULT hr = device.CreateTexture2D(&desc, nullptr, &m_pyramid);
+    if (FAILED(hr)) {
+        destroy();
+        return hr;
+    }
+
+    D3D11_SHADER_RESOURCE_VIEW_DESC chainDesc = {};
+    chainDesc.Format = DXGI_FORMAT_R32_FLOAT;
+    chainDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+    chainDesc.Texture2D.MostDetailedMip = 0;
+    chainDesc.Texture2D.MipLevels = mipCount;
+    hr = device.CreateShaderResourceView(m_pyramid, &chainDesc, &m_pyramidSRV);
+    if (FAILED(hr)) {
+        destroy();
+        return hr;
+    }
+
+    m_mipSRVs.assign(mipCount, nullptr);
+    m_mipUAVs.assign(mipCount, nullptr);
+    for (unsigned int i = 0; i < mipCount; ++i) {
+        D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+        srvDesc.Format = DXGI_FORMAT_R32_FLOAT;
+        srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+        srvDesc.Texture2D.MostDetailedMip = i;
+        srvDesc.Texture2D.MipLevels = 1;
+        hr = device.CreateShaderResourceView(m_pyramid, &srvDesc, &m_mipSRVs[i]);
+        if (FAILED(hr)) {
+            destroy();
+            return hr;
+        }
+
+        D3D11_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
+        uavDesc.Format = DXGI_FORMAT_R32_FLOAT;
+        uavDesc.ViewDimension = D3D11_UAV_DIMENSION_TEXTURE2D;
+        uavDesc.Texture2D.MipSlice = i;
+        hr = device.CreateUnorderedAccessView(m_pyramid, &uavDesc, &m_mipUAVs[i]);
+        if (FAILED(hr)) {
+            destroy();
+            return hr;
+        }
+    }
+
+    // Dos staging del mip de lectura: se escribe una y se lee la del frame anterior.
+    D3D11_TEXTURE2D_DESC stagingDesc = {};
+    stagingDesc.Width = m_mipWidths[m_readbackMip];
+    stagingDesc.Height = m_mipHeights[m_readbackMip];
+    stagingDesc.MipLevels = 1;
+    stagingDesc.ArraySize = 1;
+    stagingDesc.Format = DXGI_FORMAT_R32_FLOAT;
+    stagingDesc.SampleDesc.Count = 1;
+    stagingDesc.Usage = D3D11_USAGE_STAGING;
+    stagingDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+    for (auto& staging : m_staging) {
+        hr = device.CreateTexture2D(&stagingDesc, nullptr, &staging);
+        if (FAILED(hr)) {
+            destroy();
+            return hr;
+        }
+    }
+    m_cpuDepth.assign(stagingDesc.Width * stagingDesc.Height, 1.0f);
+
+    D3D11_BUFFER_DESC bufferDesc = {};
+    bufferDesc.Usage = D3D11_USAGE_DEFAULT;
+    bufferDesc.ByteWidth = sizeof(HiZParams);
+    bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+    hr = device.CreateBuffer(&bufferDesc, nullptr, &m_params);
+    if (FAILED(hr)) {
+        destroy();
+        return hr;
+    }
+
+    ShaderKey key;
+    key.fileName = "HiZ.fx";
+    key.entryPoint = "CSReduce";
+    key.profile = "cs_5_0";
+    hr = device.getShaderLibrary().getComputeShader(device, key, &m_reduceShader);
+    if (FAILED(hr)) {
+        destroy();
+        return hr;
+    }
+    return S_OK;
+}
+
+void HiZBuffer::build(DeviceContext& deviceContext,
+    ID3D11ShaderResourceView* depthSRV,
+    const XMMATRIX& viewProj,
+    unsigned int depthWidth,
+    unsigned int depthHeight) {
+    if (!m_reduceShader || !depthSRV) {
+        return;
+    }
+
+    // El depth buffer no puede estar enlazado como DSV mientras se lee como SRV.
+    deviceContext.OMSetRenderTargets(0, nullptr, nullptr);
+    deviceContext.CSSetShader(m_reduceShader, nullptr, 0);
+    deviceContext.CSSetConstantBuffers(0, 1, &m_params);
+
+    ID3D11ShaderResourceView* nullSRV = nullptr;
+    ID3D11UnorderedAccessView* nullUAV = nullptr;
+    for (size_t level = 0; level < m_mipUAVs.size(); ++level) {
+        HiZParams params;
+        params.srcSize[0] = (level == 0) ? depthWidth : m_mipWidths[level - 1];
+        params.srcSize[1] = (level == 0) ? depthHeight : m_mipHeights[level - 1];
+        params.dstSize[0] = m_mipWidths[level];
+        params.dstSize[1] = m_mipHeights[level];
+        deviceContext.UpdateSubresource(m_params, 0, nullptr, &params, 0, 0);
+
+        ID3D11ShaderResourceView* src = (level == 0) ? depthSRV : m_mipSRVs[level - 1];
+        deviceContext.CSSetUnorderedAccessViews(0, 1, &m_mipUAVs[level], nullptr);
+        deviceContext.CSSetShaderResources(0, 1, &src);
+        deviceContext.Dispatch((params.dstSize[0] + 7) / 8, (params.dstSize[1] + 7) / 8, 1);
+
+        // Desenlazar antes del siguiente nivel: el destino de este pasa a ser origen.
+        deviceContext.CSSetShaderResources(0, 1, &nullSRV);
+        deviceContext.CSSetUnorderedAccessViews(0, 1, &nullUAV, nullptr);
+    }
+    deviceContext.CSSetShader(nullptr, nullptr, 0);
+    m_pyramidViewProj = viewProj;
+    m_hasPyramid = true;
+
+    const unsigned int slot = m_frame;
+    deviceContext.CopySubresourceRegion(m_staging[slot], 0, 0, 0, 0, m_pyramid, m_readbackMip, nullptr);
+    m_stagingViewProj[slot] = viewProj;
+    m_stagingPending[slot] = true;
+
+    m_frame ^= 1u;
+    readBack(deviceContext);
+}
+
+void HiZBuffer::readBack(DeviceContext& deviceContext) {
+    // Tras alternar, m_frame apunta a la copia del frame anterior.
+    const unsigned int slot = m_frame;
+    if (!m_stagingPending[slot]) {
+        return;
+    }
+
+    D3D11_MAPPED_SUBRESOURCE mapped = {};
+    HRESULT hr = deviceContext.Map(m_staging[slot], 0, D3D11_MAP_READ, D3D11_MAP_FLAG_DO_NOT_WAIT, &mapped);
+    if (hr == DXGI_ERROR_WAS_STILL_DRAWING) {
+        return; // Se conserva el último mip leído; se reintenta el próximo frame.
+    }
+    m_stagingPending[slot] = false;
+    if (FAILED(hr)) {
+        ERROR("HiZBuffer", "readBack", ("Map failed. hr=" + std::to_string(hr)).c_str());
+        return;
+    }
+
+    const unsigned int width = m_mipWidths[m_readbackMip];
+    const unsigned int height = m_mipHeights[m_readbackMip];
+    const unsigned char* row = static_cast<const unsigned char*>(mapped.pData);
+    for (unsigned int y = 0; y < height; ++y, row += mapped.RowPitch) {
+        memcpy(&m_cpuDepth[y * width], row, width * sizeof(float));
+    }
+    deviceContext.Unmap(m_staging[slot], 0);
+
+    m_cpuViewProj = m_stagingViewProj[slot];
+    m_hasData = true;
+}
+
+bool HiZBuffer::isOccluded(const XMFLOAT3& boundsMin, const XMFLOAT3& boundsMax) const {
+    if (!m_hasData) {
+        return false;
+    }
+
+    // Proyectar las 8 esquinas con la matriz del frame que generó la pirámide.
+    float minX = 1.0f, maxX = -1.0f, minY = 1.0f, maxY = -1.0f, minZ = 1.0f;
+    for (int i = 0; i < 8; ++i) {
+        XMVECTOR corner = XMVectorSet((i & 1) ? boundsMax.x : boundsMin.x,
+            (i & 2) ? boundsMax.y : boundsMin.y,
+            (i & 4) ? boundsMax.z : boundsMin.z,
+            1.0f);
+        XMFLOAT4 clip;
+        XMStoreFloat4(&clip, XMVector4Transform(corner, m_cpuViewProj));
+        if (clip.w <= 1e-4f) {
+            return false; // Cruza el plano de la cámara: no se puede acotar en pantalla.
+        }
+        const float invW = 1.0f / clip.w;
+        const float x = clip.x * invW;
+        const float y = clip.y * invW;
+        minX = (std::min)(minX, x);
+        maxX = (std::max)(maxX, x);
+        minY = (std::min)(minY, y);
+        maxY = (std::max)(maxY, y);
+        minZ = (std::min)(minZ, clip.z * invW);
+    }
+
+    minX = (std::max)(minX, -1.0f);
+    maxX = (std::min)(maxX, 1.0f);
+    minY = (std::max)(minY, -1.0f);
+    maxY = (std::min)(maxY, 1.0f);
+    if (minX > maxX || minY > maxY || minZ <= 0.0f) {
+        return false; // Fuera de pantalla o delante del near: decide el frustum culling.
+    }
+
+    // NDC -> texels del mip leído (y hacia abajo). Se amplía un texel por lado
+    // porque las huellas de los bordes impares no son exactamente proporcionales.
+    const int width = static_cast<int>(m_mipWidths[m_readbackMip]);
+    const int height = static_cast<int>(m_mipHeights[m_readbackMip]);
+    int x0 = static_cast<int>(std::floor((minX * 0.5f + 0.5f) * width)) - 1;
+    int x1 = static_cast<int>(std::floor((maxX * 0.5f + 0.5f) * width)) + 1;
+    int y0 = static_cast<int>(std::floor((0.5f - maxY * 0.5f) * height)) - 1;
+    int y1 = static_cast<int>(std::floor((0.5f - minY * 0.5f) * height)) + 1;
+    x0 = (std::max)(x0, 0);
+    y0 = (std::max)(y0, 0);
+    x1 = (std::min)(x1, width - 1);
+    y1 = (std::min)(y1, height - 1);
+
+    for (int y = y0; y <= y1; ++y) {
+        for (int x = x0; x <= x1; ++x) {
+            if (minZ <= m_cpuDepth[y * width + x]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void HiZBuffer::destroy() {
+    for (auto& srv : m_mipSRVs) SAFE_RELEASE(srv);
+    for (auto& uav : m_mipUAVs) SAFE_RELEASE(uav);
+    SAFE_RELEASE(m_pyramidSRV);
+    m_mipSRVs.clear();
+    m_mipUAVs.clear();
+    m_mipWidths.clear();
+    m_mipHeights.clear();
+    for (auto& staging : m_staging) SAFE_RELEASE(staging);
+    SAFE_RELEASE(m_pyramid);
+    SAFE_RELEASE(m_reduceShader);
+    SAFE_RELEASE(m_params);
+
+    m_frame = 0;
+    m_cpuDepth.clear();
+    invalidate();
+}
+
+void HiZBuffer::invalidate() {
+    m_stagingPending[0] = m_stagingPending[1] = false;
+    m_hasData = false;
+    m_hasPyramid = false;
+}
@@ -0,0 +1,115 @@
+﻿/**
+ * @file ImageDecoder.cpp
+ * @brief Firmas de formato y decodificación con stb_image.
+ */
+
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_ONLY_PNG
+#define STBI_ONLY_JPEG
+#define STBI_ONLY_TGA
+#define STBI_ONLY_HDR
+#include "stb_image.h"
+#include "ImageDecoder.h"
+#include "VirtualFileSystem.h"
+#include <climits>
+#include <cstring>
+
+namespace {
+    /**
+     * TGA no tiene firma al principio: en TGA 2.0 el pie termina en
+     * "TRUEVISION-XFILE."; si no, se valida la cabecera (tipo de imagen, mapa de
+     * color y bits por píxel) como hace stb.
+     */
+    bool looksLikeTga(const unsigned char* bytes, size_t size) {
+        static const char kFooter[] = "TRUEVISION-XFILE.";
+        const size_t footerSize = sizeof(kFooter); // incluye el '\0' final del pie
+        if (size >= 18 + footerSize && memcmp(bytes + size - footerSize, kFooter, footerSize) == 0) {
+            return true;
+        }
+        if (size < 18) {
+            return false;
+        }
+        const unsigned char colorMapType = bytes[1];
+        const unsigned char imageType = bytes[2];
+        const unsigned char bits = bytes[16];
+        const bool validType = imageType == 1 || imageType == 2 || imageType == 3 ||
+            imageType == 9 || imageType == 10 || imageType == 11;
+        const bool validBits = bits == 8 || bits == 15 || bits == 16 || bits == 24 || bits == 32;
+        const unsigned int width = bytes[12] | (bytes[13] << 8);
+        const unsigned int height = bytes[14] | (bytes[15] << 8);
+        return colorMapType <= 1 && validType && validBits && width > 0 && height > 0;
+    }
+}
+
+void DecodedImage::release() {
+    if (m_pixels) {
+        stbi_image_free(m_pixels);
+        m_pixels = nullptr;
+    }
+    m_width = 0;
+    m_height = 0;
+    m_format = IMAGE_FORMAT_UNKNOWN;
+}
+
+ImageFormat ImageDecoder::detect(const unsigned char* bytes, size_t size) {
+    static const unsigned char kPng[8] = { 0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A };
+    if (size >= 8 && memcmp(bytes, kPng, 8) == 0) {
+        return IMAGE_FORMAT_PNG;
+    }
+    if (size >= 3 && bytes[0] == 0xFF && bytes[1] == 0xD8 && bytes[2] == 0xFF) {
+        return IMAGE_FORMAT_JPG;
+    }
+    if ((size >= 10 && memcmp(bytes, "#?RADIANCE", 10) == 0) ||
+        (size >= 6 && memcmp(bytes, "#?RGBE", 6) == 0)) {
+        return IMAGE_FORMAT_HDR;
+    }
+    if (looksLikeTga(bytes, size)) {
+        return IMAGE_FORMAT_TGA;
+    }
+    return IMAGE_FORMAT_UNKNOWN;
+}
+
+HRESULT ImageDecoder::decode(const unsigned char* bytes, size_t size, DecodedImage& out,
+    std::string* errorText) {
+    out.release();
+    const ImageFormat format = detect(bytes, size);
+    if (format == IMAGE_FORMAT_UNKNOWN || size > static_cast<size_t>(INT_MAX)) {
+        if (errorText) *errorText = "unknown image format";
+        return E_INVALIDARG;
+    }
+
+    int width = 0, height = 0, channels = 0;
+    const int length = static_cast<int>(size);
+    // Siempre 4 canales: RGBA8 y RGBA float son formatos DXGI directos.
+    out.m_pixels = format == IMAGE_FORMAT_HDR
+        ? static_cast<void*>(stbi_loadf_from_memory(bytes, length, &width, &height, &channels, 4))
+        : static_cast<void*>(stbi_load_from_memory(bytes, length, &width, &height, &channels, 4));
+    if (!out.m_pixels) {
+        if (errorText) *errorText = std::string(getFormatName(format)) + ": " + stbi_failure_reason();
+        return E_FAIL;
+    }
+    out.m_width = static_cast<unsigned int>(width);
+    out.m_height = static_cast<unsigned int>(height);
+    out.m_format = format;
+    return S_OK;
+}
+
+HRESULT ImageDecoder::decodeFile(const std::string& path, DecodedImage& out, std::string* errorText) {
+    FileView file;
+    if (!VirtualFileSystem::getDefault().open(path, file)) {
+        out.release();
+        if (errorText) *errorText = "cannot open file";
+        return E_FAIL;
+    }
+    return decode(file.getData(), file.getSize(), out, errorText);
+}
+
+const char* ImageDecoder::getFormatName(ImageFormat format) {
+    switch (format) {
+    case IMAGE_FORMAT_PNG: return "PNG";
+    case IMAGE_FORMAT_JPG: return "JPG";
+    case IMAGE_FORMAT_TGA: return "TGA";
+    case IMAGE_FORMAT_HDR: return "HDR";
+    default: return "unknown";
+    }
+}
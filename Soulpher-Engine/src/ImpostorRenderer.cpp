@@ -0,0 +1,363 @@
+﻿/**
+ * @file ImpostorRenderer.cpp
+ * @brief Implementación del horneado y dibujo de impostores.
+ *
+ * @details
+ * Convención de las vistas: la celda `i` es el actor visto desde la dirección
+ * `(sin a, 0, cos a)` de su espacio de modelo, con `a = 2 * pi * i / kViewCount`; la
+ * cámara mira al centro de la esfera desde el doble del radio. `Impostor.fx` recupera
+ * `a` con `atan2(x, z)` de la dirección de la cámara en el espacio del actor.
+ */
+
+#include "ImpostorRenderer.h"
+#include "Device.h"
+#include "DeviceContext.h"
+#include "VertexLayout.h"
+#include "MeshAsset.h"
+#include "Texture.h"
+#include "ECS/Actor.h"
+#include "ECS/Transform.h"
+#include <algorithm>
+#include <cmath>
+
+// Comparte b2 con `cbChangesEveryFrame` (otro pase): se distinguen por el nombre.
+const ConstantBufferLayouts::Registration ImpostorRenderer::kImpostorLayout({ "cbImpostor", CB_SLOT_OBJECT, sizeof(CBImpostor), {
+    CB_FIELD(CBImpostor, eyePos, "EyePos"),
+    CB_FIELD(CBImpostor, atlasInfo, "AtlasInfo") } });
+
+HRESULT ImpostorRenderer::init(Device& device, const std::vector<D3D11_INPUT_ELEMENT_DESC>& layout) {
+    if (!device.m_device) {
+        ERROR("ImpostorRenderer", "init", "Device is null.");
+        return E_POINTER;
+    }
+    destroy();
+
+    const float corners[4][2] = { { -1.0f, -1.0f }, { -1.0f, 1.0f }, { 1.0f, 1.0f }, { 1.0f, -1.0f } };
+    const unsigned int indices[6] = { 0, 1, 2, 0, 2, 3 };
+    const std::vector<D3D11_INPUT_ELEMENT_DESC> quadLayout = VertexLayout()
+        .add("POSITION", 0, DXGI_FORMAT_R32G32_FLOAT)
+        .add("IMPOSTOR_CENTER", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, VERTEX_STREAM_INSTANCE, true)
+        .add("INSTANCE_COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, VERTEX_STREAM_INSTANCE, true)
+        .add("IMPOSTOR_AXIS", 0, DXGI_FORMAT_R32G32_FLOAT, VERTEX_STREAM_INSTANCE, true)
+        .getDesc();
+
+    HRESULT hr = m_bakeProgram.init(device, "Impostor.fx", layout, { { "BAKE", "1" } });
+    if (SUCCEEDED(hr)) { hr = m_program.init(device, "Impostor.fx", quadLayout); }
+    if (SUCCEEDED(hr)) { hr = m_quadVertices.initVertices(device, corners, sizeof(corners[0]), 4); }
+    if (SUCCEEDED(hr)) { hr = m_quadIndices.initIndices(device, indices, 6, true); }
+    if (SUCCEEDED(hr)) {
+        hr = m_instanceBuffer.initDynamic(device, kInitialInstances * sizeof(InstanceData),
+            sizeof(InstanceData), D3D11_BIND_VERTEX_BUFFER);
+        m_instanceCapacity = SUCCEEDED(hr) ? kInitialInstances : 0;
+    }
+    if (SUCCEEDED(hr)) { hr = m_bakeView.init(device); }
+    if (SUCCEEDED(hr)) { hr = m_bakeProjection.init(device); }
+    if (SUCCEEDED(hr)) { hr = m_bakeObject.init(device); }
+    if (SUCCEEDED(hr)) { hr = m_constants.init(device); }
+    if (SUCCEEDED(hr)) { hr = m_sampler.init(device); }
+    if (SUCCEEDED(hr)) { hr = m_rasterizer.init(device); }
+    if (SUCCEEDED(hr)) { hr = m_blendState.init(device, false); }
+    if (SUCCEEDED(hr)) {
+        D3D11_TEXTURE2D_DESC desc = {};
+        desc.Width = kTileSize;
+        desc.Height = kTileSize;
+        desc.MipLevels = 1;
+        desc.ArraySize = 1;
+        desc.Format = DXGI_FORMAT_D24_UNORM_S8_UINT;
+        desc.SampleDesc.Count = 1;
+        desc.Usage = D3D11_USAGE_DEFAULT;
+        desc.BindFlags = D3D11_BIND_DEPTH_STENCIL;
+        hr = device.CreateTexture2D(&desc, nullptr, &m_depthTexture);
+    }
+    if (SUCCEEDED(hr)) { hr = device.CreateDepthStencilView(m_depthTexture, nullptr, &m_depthView); }
+    if (FAILED(hr)) {
+        ERROR("ImpostorRenderer", "init", ("Failed to create impostor resources. hr=" + std::to_string(hr)).c_str());
+        destroy();
+        return hr;
+    }
+    m_device = &device;
+    return S_OK;
+}
+
+void ImpostorRenderer::begin() {
+    for (auto& entry : m_atlases) {
+        entry.second.instances.clear();
+    }
+    m_instanceCount = 0;
+}
+
+bool ImpostorRenderer::add(Actor& actor, const XMFLOAT3& eye) {
+    const float distance = actor.getImpostorDistance();
+    const EU::TSharedPointer<MeshAsset>& asset = actor.getMeshAsset();
+    Transform* transform = actor.getComponent<Transform>();
+    if (!isReady() || distance <= 0.0f || asset.isNull() || !asset->hasBounds() || !transform ||
+        actor.isTransparent() || actor.isBatched()) {
+        return false;
+    }
+
+    // Esfera del asset en mundo (radio por la mayor escala).
+    const XMFLOAT3& mn = asset->m_boundsMin;
+    const XMFLOAT3& mx = asset->m_boundsMax;
+    const XMFLOAT3 localCenter((mn.x + mx.x) * 0.5f, (mn.y + mx.y) * 0.5f, (mn.z + mx.z) * 0.5f);
+    const XMMATRIX& world = actor.getRenderWorld();
+    const XMVECTOR center = XMVector3TransformCoord(XMLoadFloat3(&localCenter), world);
+    if (XMVectorGetX(XMVector3LengthSq(XMVectorSubtract(center, XMLoadFloat3(&eye)))) < distance * distance) {
+        return false;
+    }
+
+    Key key;
+    key.asset = asset.get();
+    const std::vector<TextureHandle>& textures = actor.getTextures();
+    for (const TextureHandle& texture : textures) {
+        key.textures.push_back(texture.get());
+    }
+    auto found = m_atlases.find(key);
+    if (found == m_atlases.end()) {
+        Atlas atlas;
+        atlas.asset = asset;
+        atlas.textures = textures;
+        atlas.center = localCenter;
+        atlas.radius = 0.5f * XMVectorGetX(XMVector3Length(XMVectorSubtract(XMLoadFloat3(&mx), XMLoadFloat3(&mn))));
+        found = m_atlases.emplace(key, atlas).first;
+    }
+    Atlas& atlas = found->second;
+    if (!atlas.baked) {
+        if (!atlas.queued) {
+            atlas.queued = true;
+            m_pending.push_back(&atlas);
+        }
+        return false;
+    }
+
+    const float scale = sqrtf((std::max)((std::max)(XMVectorGetX(XMVector3LengthSq(world.r[0])),
+        XMVectorGetX(XMVector3LengthSq(world.r[1]))), XMVectorGetX(XMVector3LengthSq(world.r[2]))));
+    XMFLOAT2 axis(XMVectorGetX(world.r[0]), XMVectorGetZ(world.r[0]));
+    const float axisLength = sqrtf(axis.x * axis.x + axis.y * axis.y);
+    axis = axisLength > 1e-6f ? XMFLOAT2(axis.x / axisLength, axis.y / axisLength) : XMFLOAT2(1.0f, 0.0f);
+
+    InstanceData instance;
+    XMStoreFloat4(&instance.center, center);
+    instance.center.w = atlas.radius * scale;
+    instance.color = actor.getColor();
+    instance.axisX = axis;
+    atlas.instances.push_back(instance);
+    ++m_instanceCount;
+    return true;
+}
+
+void ImpostorRenderer::bake(DeviceContext& deviceContext, bool allowed) {
+    if (!allowed || m_pending.empty()) {
+        return;
+    }
+    DeviceContext::EventScope event(deviceContext, "Impostor bake");
+    unsigned int baked = 0;
+    while (!m_pending.empty() && baked < kMaxBakesPerFrame) {
+        Atlas* atlas = m_pending.front();
+        m_pending.erase(m_pending.begin());
+        atlas->queued = false;
+        if (SUCCEEDED(bakeAtlas(deviceContext, *atlas))) {
+            atlas->baked = true;
+        }
+        else {
+            // Sin atlas, esos actores siguen con su malla; no se reintenta cada frame.
+            ERROR("ImpostorRenderer", "bake", "Failed to bake an impostor atlas");
+            atlas->queued = true;
+        }
+        ++baked;
+    }
+    ID3D11RenderTargetView* nullRTV = nullptr;
+    deviceContext.OMSetRenderTargets(1, &nullRTV, nullptr);
+}
+
+HRESULT ImpostorRenderer::bakeAtlas(DeviceContext& deviceContext, Atlas& atlas) {
+    MeshAsset& mesh = *atlas.asset;
+    if (mesh.getSubmeshCount() == 0 || atlas.radius <= 0.0f) {
+        return E_INVALIDARG;
+    }
+
+    releaseAtlas(atlas);
+    D3D11_TEXTURE2D_DESC desc = {};
+    desc.Width = kTileSize * kViewCount;
+    desc.Height = kTileSize;
+    desc.MipLevels = kMipCount;
+    desc.ArraySize = 1;
+    desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    desc.SampleDesc.Count = 1;
+    desc.Usage = D3D11_USAGE_DEFAULT;
+    desc.BindFlags = D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
+    desc.MiscFlags = D3D11_RESOURCE_MISC_GENERATE_MIPS;
+    HRESULT hr = m_device->CreateTexture2D(&desc, nullptr, &atlas.texture);
+    ID3D11RenderTargetView* rtv = nullptr;
+    if (SUCCEEDED(hr)) { hr = m_device->CreateRenderTargetView(atlas.texture, nullptr, &rtv); }
+    if (SUCCEEDED(hr)) { hr = m_device->CreateShaderResourceView(atlas.texture, nullptr, &atlas.srv); }
+    if (FAILED(hr)) {
+        SAFE_RELEASE(rtv);
+        releaseAtlas(atlas);
+        return hr;
+    }
+
+    const float clear[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    deviceContext.ClearRenderTargetView(rtv, clear);
+    deviceContext.OMSetRenderTargets(1, &rtv, m_depthView);
+    deviceContext.OMSetDepthStencilState(nullptr, 0);
+    m_bakeProgram.render(deviceContext);
+    m_blendState.render(deviceContext);
+    m_rasterizer.render(deviceContext);
+    m_sampler.render(deviceContext, 0, 1);
+    deviceContext.IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+    // Ortográfica que encierra la esfera; la cámara a 2 radios del centro.
+    const float r = atlas.radius;
+    CBChangeOnResize projection;
+    projection.mProjection = XMMatrixTranspose(XMMatrixOrthographicLH(2.0f * r, 2.0f * r, 0.5f * r, 3.5f * r));
+    m_bakeProjection.set(projection);
+    m_bakeProjection.update(deviceContext);
+    m_bakeProjection.render(deviceContext, CB_SLOT_PROJECTION);
+    CBChangesEveryFrame object;
+    object.mWorld = XMMatrixTranspose(mesh.getDecodeMatrix());
+    object.vMeshColor = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
+    m_bakeObject.set(object);
+    m_bakeObject.update(deviceContext);
+    m_bakeObject.render(deviceContext, CB_SLOT_OBJECT);
+
+    const XMVECTOR center = XMLoadFloat3(&atlas.center);
+    for (unsigned int view = 0; view < kViewCount; ++view) {
+        const float angle = XM_2PI * static_cast<float>(view) / static_cast<float>(kViewCount);
+        const XMVECTOR eye = XMVectorAdd(center, XMVectorSet(sinf(angle) * 2.0f * r, 0.0f, cosf(angle) * 2.0f * r, 0.0f));
+        CBNeverChanges camera;
+        camera.mView = XMMatrixTranspose(XMMatrixLookAtLH(eye, center, XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f)));
+        m_bakeView.set(camera);
+        m_bakeView.update(deviceContext);
+        m_bakeView.render(deviceContext, CB_SLOT_VIEW);
+
+        D3D11_VIEWPORT viewport = {};
+        viewport.TopLeftX = static_cast<float>(view * kTileSize);
+        viewport.Width = static_cast<float>(kTileSize);
+        viewport.Height = static_cast<float>(kTileSize);
+        viewport.MaxDepth = 1.0f;
+        deviceContext.RSSetViewports(1, &viewport);
+        deviceContext.ClearDepthStencilView(m_depthView, D3D11_CLEAR_DEPTH, 1.0f, 0);
+
+        for (unsigned int i = 0; i < mesh.getSubmeshCount(); ++i) {
+            const SubmeshDraw draw = mesh.getDraw(i);
+            draw.vertices->render(deviceContext, VERTEX_STREAM_GEOMETRY, 1);
+            draw.indices->render(deviceContext, 0, 1, false, draw.indices->getIndexFormat());
+            if (i < atlas.textures.size() && !atlas.textures[i].isNull()) {
+                atlas.textures[i]->render(deviceContext, 0, 1);
+            }
+            deviceContext.DrawIndexed(draw.indexCount, draw.startIndex, draw.baseVertex);
+        }
+    }
+
+    ID3D11RenderTargetView* nullRTV = nullptr;
+    deviceContext.OMSetRenderTargets(1, &nullRTV, nullptr);
+    deviceContext.m_deviceContext->GenerateMips(atlas.srv);
+    SAFE_RELEASE(rtv);
+    return S_OK;
+}
+
+void ImpostorRenderer::render(DeviceContext& deviceContext, const XMFLOAT3& eye) {
+    if (m_instanceCount == 0) {
+        return;
+    }
+    DeviceContext::EventScope event(deviceContext, "Impostors");
+
+    // Todas las instancias en un buffer; cada atlas dibuja su tramo.
+    m_upload.clear();
+    for (auto& entry : m_atlases) {
+        m_upload.insert(m_upload.end(), entry.second.instances.begin(), entry.second.instances.end());
+    }
+    if (m_upload.size() > m_instanceCapacity) {
+        unsigned int capacity = (std::max)(m_instanceCapacity, kInitialInstances);
+        while (capacity < m_upload.size()) capacity *= 2;
+        m_instanceBuffer.destroy();
+        m_instanceCapacity = 0;
+        if (FAILED(m_instanceBuffer.initDynamic(*m_device, capacity * sizeof(InstanceData),
+            sizeof(InstanceData), D3D11_BIND_VERTEX_BUFFER))) {
+            ERROR("ImpostorRenderer", "render", "Failed to grow the instance buffer");
+            return;
+        }
+        m_instanceCapacity = capacity;
+    }
+    if (FAILED(m_instanceBuffer.write(deviceContext, m_upload.data(),
+        static_cast<unsigned int>(m_upload.size() * sizeof(InstanceData))))) {
+        return;
+    }
+
+    CBImpostor constants;
+    constants.eyePos = XMFLOAT4(eye.x, eye.y, eye.z, 1.0f);
+    constants.atlasInfo = XMFLOAT4(static_cast<float>(kViewCount), 1.0f / kViewCount, 0.0f, 0.0f);
+    m_constants.set(constants);
+    m_constants.update(deviceContext);
+    m_constants.render(deviceContext, CB_SLOT_OBJECT);
+
+    m_program.render(deviceContext);
+    m_blendState.render(deviceContext);
+    m_rasterizer.render(deviceContext);
+    m_sampler.render(deviceContext, 0, 1);
+    deviceContext.IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    m_quadVertices.render(deviceContext, VERTEX_STREAM_GEOMETRY, 1);
+    m_instanceBuffer.render(deviceContext, VERTEX_STREAM_INSTANCE, 1);
+    m_quadIndices.render(deviceContext, 0, 1, false, DXGI_FORMAT_R16_UINT);
+
+    unsigned int first = 0;
+    for (auto& entry : m_atlases) {
+        const unsigned int count = static_cast<unsigned int>(entry.second.instances.size());
+        if (count == 0) {
+            continue;
+        }
+        deviceContext.PSSetShaderResources(0, 1, &entry.second.srv);
+        deviceContext.DrawIndexedInstanced(6, count, 0, 0, first);
+        first += count;
+    }
+}
+
+unsigned int ImpostorRenderer::getAtlasCount() const {
+    unsigned int count = 0;
+    for (const auto& entry : m_atlases) {
+        count += entry.second.baked ? 1u : 0u;
+    }
+    return count;
+}
+
+size_t ImpostorRenderer::getAtlasBytes() const {
+    // RGBA8 con su cadena de mips (~4/3 del nivel 0).
+    const size_t level0 = static_cast<size_t>(kTileSize) * kViewCount * kTileSize * 4;
+    return getAtlasCount() * (level0 * 4 / 3);
+}
+
+void ImpostorRenderer::releaseAtlas(Atlas& atlas) {
+    SAFE_RELEASE(atlas.srv);
+    SAFE_RELEASE(atlas.texture);
+    atlas.baked = false;
+}
+
+void ImpostorRenderer::clear() {
+    for (auto& entry : m_atlases) {
+        releaseAtlas(entry.second);
+    }
+    m_atlases.clear();
+    m_pending.clear();
+    m_instanceCount = 0;
+}
+
+void ImpostorRenderer::destroy() {
+    clear();
+    m_upload.clear();
+    m_bakeProgram.destroy();
+    m_program.destroy();
+    m_quadVertices.destroy();
+    m_quadIndices.destroy();
+    m_instanceBuffer.destroy();
+    m_instanceCapacity = 0;
+    m_bakeView.destroy();
+    m_bakeProjection.destroy();
+    m_bakeObject.destroy();
+    m_constants.destroy();
+    SAFE_RELEASE(m_depthView);
+    SAFE_RELEASE(m_depthTexture);
+    m_sampler.destroy();
+    m_rasterizer.destroy();
+    m_blendState.destroy();
+    m_device = nullptr;
+}
@@ -32,6 +32,8 @@
   *
   * @warning El `Layout` debe coincidir exactamente con la estructura de entrada definida en el Vertex Shader.
   * @note Es común definir este layout una sola vez al inicio, y reutilizarlo para todas las mallas que compartan el mismo formato.
+  * @note El objeto sale de la `InputLayoutCache` del `Device`: si otro programa ya pidió
+  *       el mismo layout con la misma firma de entrada, se reutiliza su `ID3D11InputLayout`.
   */
 HRESULT InputLayout::init(Device& device,
     std::vector<D3D11_INPUT_ELEMENT_DESC>& Layout,
@@ -45,10 +47,9 @@ HRESULT InputLayout::init(Device& device,
         return E_POINTER;
     }
 
-    HRESULT hr = device.CreateInputLayout(Layout.data(),
-        static_cast<unsigned int>(Layout.size()),
-        VertexShaderData->GetBufferPointer(),
-        VertexShaderData->GetBufferSize(),
+    // Los programas con las mismas entradas comparten el objeto de la caché del Device.
+    SAFE_RELEASE(m_inputLayout);
+    HRESULT hr = device.getInputLayoutCache().getInputLayout(device, Layout, VertexShaderData,
         &m_inputLayout);
 
     if (FAILED(hr)) {
@@ -81,7 +82,7 @@ void InputLayout::render(DeviceContext& deviceContext) {
         return;
     }
 
-    deviceContext.m_deviceContext->IASetInputLayout(m_inputLayout);
+    deviceContext.IASetInputLayout(m_inputLayout);
 }
 
 /**
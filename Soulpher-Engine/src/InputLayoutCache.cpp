@@ -0,0 +1,108 @@
+﻿/**
+ * @file InputLayoutCache.cpp
+ * @brief Implementación de la caché de input layouts.
+ */
+
+#include "InputLayoutCache.h"
+#include "VertexLayout.h"
+#include "Device.h"
+#include <cstring>
+
+namespace {
+    uint32_t readU32(const unsigned char* bytes) {
+        uint32_t value;
+        memcpy(&value, bytes, sizeof(value));
+        return value;
+    }
+
+    uint32_t fourCC(char a, char b, char c, char d) {
+        return static_cast<uint32_t>(static_cast<unsigned char>(a)) |
+            (static_cast<uint32_t>(static_cast<unsigned char>(b)) << 8) |
+            (static_cast<uint32_t>(static_cast<unsigned char>(c)) << 16) |
+            (static_cast<uint32_t>(static_cast<unsigned char>(d)) << 24);
+    }
+}
+
+uint64_t InputLayoutCache::hashInputSignature(const void* bytecode, size_t size) {
+    uint64_t hash = EU::kFnv1aSeed;
+    const unsigned char* bytes = static_cast<const unsigned char*>(bytecode);
+
+    // Contenedor DXBC: "DXBC", checksum (16), versión, tamaño, nº de bloques y
+    // la tabla de offsets; cada bloque empieza por su FourCC y su tamaño.
+    const size_t kHeaderSize = 32;
+    if (bytes && size >= kHeaderSize && readU32(bytes) == fourCC('D', 'X', 'B', 'C')) {
+        const uint32_t chunkCount = readU32(bytes + 28);
+        if (kHeaderSize + static_cast<size_t>(chunkCount) * 4 <= size) {
+            for (uint32_t i = 0; i < chunkCount; ++i) {
+                const uint32_t offset = readU32(bytes + kHeaderSize + i * 4);
+                if (static_cast<size_t>(offset) + 8 > size) {
+                    continue;
+                }
+                const uint32_t id = readU32(bytes + offset);
+                const uint32_t chunkSize = readU32(bytes + offset + 4);
+                if ((id == fourCC('I', 'S', 'G', 'N') || id == fourCC('I', 'S', 'G', '1')) &&
+                    static_cast<size_t>(offset) + 8 + chunkSize <= size) {
+                    EU::Fnv1a(hash, bytes + offset, 8 + static_cast<size_t>(chunkSize));
+                    return hash;
+                }
+            }
+        }
+    }
+
+    EU::Fnv1a(hash, bytecode, size);
+    return hash;
+}
+
+HRESULT InputLayoutCache::getInputLayout(Device& device,
+    const std::vector<D3D11_INPUT_ELEMENT_DESC>& layout,
+    ID3DBlob* vertexShaderData,
+    ID3D11InputLayout** ppInputLayout) {
+    if (!ppInputLayout) {
+        ERROR("InputLayoutCache", "getInputLayout", "ppInputLayout is nullptr");
+        return E_POINTER;
+    }
+    if (layout.empty() || !vertexShaderData) {
+        ERROR("InputLayoutCache", "getInputLayout", "Empty layout or missing vertex shader data");
+        return E_INVALIDARG;
+    }
+
+    const uint64_t keys[2] = {
+        VertexLayout::hashDesc(layout),
+        hashInputSignature(vertexShaderData->GetBufferPointer(), vertexShaderData->GetBufferSize())
+    };
+    uint64_t key = EU::kFnv1aSeed;
+    EU::Fnv1a(key, keys, sizeof(keys));
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_layouts.find(key);
+    if (it != m_layouts.end()) {
+        ++m_hits;
+        it->second->AddRef();
+        *ppInputLayout = it->second;
+        return S_OK;
+    }
+
+    ID3D11InputLayout* inputLayout = nullptr;
+    HRESULT hr = device.CreateInputLayout(layout.data(),
+        static_cast<unsigned int>(layout.size()),
+        vertexShaderData->GetBufferPointer(),
+        static_cast<unsigned int>(vertexShaderData->GetBufferSize()),
+        &inputLayout);
+    if (FAILED(hr)) {
+        return hr;
+    }
+
+    m_layouts[key] = inputLayout;
+    inputLayout->AddRef();
+    *ppInputLayout = inputLayout;
+    return S_OK;
+}
+
+void InputLayoutCache::destroy() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& pair : m_layouts) {
+        SAFE_RELEASE(pair.second);
+    }
+    m_layouts.clear();
+    m_hits = 0;
+}
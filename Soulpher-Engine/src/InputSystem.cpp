@@ -0,0 +1,228 @@
+﻿/**
+ * @file InputSystem.cpp
+ * @brief Registro de raw input, acumulación de `WM_INPUT` y muestreo por frame.
+ */
+
+#include "InputSystem.h"
+
+namespace {
+    /// Flancos de raw input de cada `MouseButton` (bajada, subida).
+    const USHORT kButtonFlags[InputSystem::MOUSE_BUTTON_COUNT][2] = {
+        { RI_MOUSE_LEFT_BUTTON_DOWN, RI_MOUSE_LEFT_BUTTON_UP },
+        { RI_MOUSE_RIGHT_BUTTON_DOWN, RI_MOUSE_RIGHT_BUTTON_UP },
+        { RI_MOUSE_MIDDLE_BUTTON_DOWN, RI_MOUSE_MIDDLE_BUTTON_UP },
+    };
+    /// Teclas virtuales de cada `MouseButton` (sondeo).
+    const int kButtonKeys[InputSystem::MOUSE_BUTTON_COUNT] = { VK_LBUTTON, VK_RBUTTON, VK_MBUTTON };
+}
+
+HRESULT InputSystem::init(HWND hwnd) {
+    // Página genérica de escritorio: 0x02 = ratón, 0x06 = teclado.
+    RAWINPUTDEVICE devices[2] = {};
+    devices[0].usUsagePage = 0x01;
+    devices[0].usUsage = 0x02;
+    devices[0].hwndTarget = hwnd;
+    devices[1].usUsagePage = 0x01;
+    devices[1].usUsage = 0x06;
+    devices[1].hwndTarget = hwnd;
+    if (!RegisterRawInputDevices(devices, 2, sizeof(RAWINPUTDEVICE))) {
+        const HRESULT hr = HRESULT_FROM_WIN32(GetLastError());
+        MESSAGE("InputSystem", "init", ("Raw input unavailable, polling instead. hr=" + std::to_string(hr)).c_str());
+        GetCursorPos(&m_lastCursor);
+        return hr;
+    }
+    m_pending.events.reserve(kMaxEvents);
+    m_frame.events.reserve(kMaxEvents);
+    m_registered = true;
+    return S_OK;
+}
+
+void InputSystem::handleRawInput(HRAWINPUT input) {
+    RAWINPUT raw;
+    UINT size = sizeof(raw);
+    if (GetRawInputData(input, RID_INPUT, &raw, &size, sizeof(RAWINPUTHEADER)) == static_cast<UINT>(-1)) {
+        return;
+    }
+
+    const DWORD messageTime = static_cast<DWORD>(GetMessageTime());
+    if (raw.header.dwType == RIM_TYPEMOUSE) {
+        const RAWMOUSE& mouse = raw.data.mouse;
+        if (mouse.usFlags & MOUSE_MOVE_ABSOLUTE) {
+            // 0..65535 sobre la pantalla (o el escritorio virtual): el delta es la diferencia.
+            const bool virtualDesktop = (mouse.usFlags & MOUSE_VIRTUAL_DESKTOP) != 0;
+            const long x = MulDiv(mouse.lLastX, GetSystemMetrics(virtualDesktop ? SM_CXVIRTUALSCREEN : SM_CXSCREEN), 65535);
+            const long y = MulDiv(mouse.lLastY, GetSystemMetrics(virtualDesktop ? SM_CYVIRTUALSCREEN : SM_CYSCREEN), 65535);
+            if (m_hasAbsolute) {
+                m_pending.mouseDeltaX += x - m_lastAbsoluteX;
+                m_pending.mouseDeltaY += y - m_lastAbsoluteY;
+            }
+            m_lastAbsoluteX = x;
+            m_lastAbsoluteY = y;
+            m_hasAbsolute = true;
+        }
+        else {
+            m_pending.mouseDeltaX += mouse.lLastX;
+            m_pending.mouseDeltaY += mouse.lLastY;
+        }
+        for (uint8_t button = 0; button < MOUSE_BUTTON_COUNT; ++button) {
+            if (mouse.usButtonFlags & kButtonFlags[button][0]) {
+                setButton(static_cast<MouseButton>(button), true, messageTime);
+            }
+            if (mouse.usButtonFlags & kButtonFlags[button][1]) {
+                setButton(static_cast<MouseButton>(button), false, messageTime);
+            }
+        }
+        if (mouse.usButtonFlags & RI_MOUSE_WHEEL) {
+            const float notches = static_cast<short>(mouse.usButtonData) / static_cast<float>(WHEEL_DELTA);
+            m_pending.wheel += notches;
+            pushEvent(Event::WHEEL, 0, notches, messageTime);
+        }
+    }
+    else if (raw.header.dwType == RIM_TYPEKEYBOARD) {
+        const RAWKEYBOARD& keyboard = raw.data.keyboard;
+        // 255: parte de una secuencia de escape (p. ej. Pausa), sin tecla propia.
+        if (keyboard.VKey == 0 || keyboard.VKey >= 255) {
+            return;
+        }
+        setKey(static_cast<uint8_t>(keyboard.VKey), (keyboard.Flags & RI_KEY_BREAK) == 0, messageTime);
+    }
+}
+
+void InputSystem::injectMouseMove(long deltaX, long deltaY) {
+    m_pending.mouseDeltaX += deltaX;
+    m_pending.mouseDeltaY += deltaY;
+}
+
+void InputSystem::injectButton(MouseButton button, bool down) {
+    if (button < MOUSE_BUTTON_COUNT) {
+        setButton(button, down, GetTickCount());
+    }
+}
+
+void InputSystem::injectWheel(float notches) {
+    m_pending.wheel += notches;
+    pushEvent(Event::WHEEL, 0, notches, GetTickCount());
+}
+
+void InputSystem::injectKey(uint8_t key, bool down) {
+    if (key != 0 && key != 255) {
+        setKey(key, down, GetTickCount());
+    }
+}
+
+void InputSystem::setButton(MouseButton button, bool down, DWORD time) {
+    const uint8_t bit = static_cast<uint8_t>(1u << button);
+    if (down) {
+        m_pending.buttons |= bit;
+        m_pending.pressed |= bit;
+        pushEvent(Event::BUTTON_DOWN, button, 0.0f, time);
+    }
+    else {
+        m_pending.buttons &= ~bit;
+        m_pending.released |= bit;
+        pushEvent(Event::BUTTON_UP, button, 0.0f, time);
+    }
+}
+
+void InputSystem::setKey(uint8_t key, bool down, DWORD time) {
+    if (!down) {
+        m_pending.keys.reset(key);
+        pushEvent(Event::KEY_UP, key, 0.0f, time);
+    }
+    else if (!m_pending.keys.test(key)) {
+        // La autorrepetición manda bajadas sin subida: solo la primera es un evento.
+        m_pending.keys.set(key);
+        m_pending.keysPressed.set(key);
+        pushEvent(Event::KEY_DOWN, key, 0.0f, time);
+    }
+}
+
+void InputSystem::pushEvent(Event::Type type, uint8_t code, float wheel, DWORD time) {
+    if (m_pending.events.size() >= kMaxEvents) {
+        ++m_pending.droppedEvents;
+        return;
+    }
+    Event event;
+    event.type = type;
+    event.code = code;
+    event.wheel = wheel;
+    event.time = time;
+    m_pending.events.push_back(event);
+}
+
+void InputSystem::releaseAll() {
+    for (uint8_t button = 0; button < MOUSE_BUTTON_COUNT; ++button) {
+        if (m_pending.buttons & (1u << button)) {
+            m_pending.released |= static_cast<uint8_t>(1u << button);
+            pushEvent(Event::BUTTON_UP, button, 0.0f, GetTickCount());
+        }
+    }
+    m_pending.buttons = 0;
+    m_pending.keys.reset();
+    m_hasAbsolute = false;
+}
+
+void InputSystem::poll() {
+    POINT cursor;
+    GetCursorPos(&cursor);
+    // `+=`: lo inyectado (@ref injectMouseMove) se suma al sondeo.
+    m_pending.mouseDeltaX += cursor.x - m_lastCursor.x;
+    m_pending.mouseDeltaY += cursor.y - m_lastCursor.y;
+    m_lastCursor = cursor;
+    for (uint8_t button = 0; button < MOUSE_BUTTON_COUNT; ++button) {
+        const uint8_t bit = static_cast<uint8_t>(1u << button);
+        const bool down = (GetAsyncKeyState(kButtonKeys[button]) & 0x8000) != 0;
+        if (down && !(m_pending.buttons & bit)) {
+            m_pending.pressed |= bit;
+        }
+        else if (!down && (m_pending.buttons & bit)) {
+            m_pending.released |= bit;
+        }
+        m_pending.buttons = down ? (m_pending.buttons | bit) : (m_pending.buttons & ~bit);
+    }
+}
+
+void InputSystem::sample(HWND hwnd) {
+    if (!m_registered) {
+        poll();
+    }
+
+    // La copia se lleva lo acumulado; los estados (botones, teclas) siguen en `m_pending`.
+    m_frame.mouseDeltaX = m_pending.mouseDeltaX;
+    m_frame.mouseDeltaY = m_pending.mouseDeltaY;
+    m_frame.wheel = m_pending.wheel;
+    m_frame.buttons = m_pending.buttons;
+    m_frame.pressed = m_pending.pressed;
+    m_frame.released = m_pending.released;
+    m_frame.keys = m_pending.keys;
+    m_frame.keysPressed = m_pending.keysPressed;
+    m_frame.droppedEvents = m_pending.droppedEvents;
+    m_frame.events.swap(m_pending.events);
+    m_frame.oldestEventAge = m_frame.events.empty() ? 0 : GetTickCount() - m_frame.events.front().time;
+    GetCursorPos(&m_frame.cursor);
+    ScreenToClient(hwnd, &m_frame.cursor);
+
+    m_pending.mouseDeltaX = 0;
+    m_pending.mouseDeltaY = 0;
+    m_pending.wheel = 0.0f;
+    m_pending.pressed = 0;
+    m_pending.released = 0;
+    m_pending.keysPressed.reset();
+    m_pending.droppedEvents = 0;
+    m_pending.events.clear();
+}
+
+void InputSystem::destroy() {
+    if (!m_registered) {
+        return;
+    }
+    RAWINPUTDEVICE devices[2] = {};
+    devices[0].usUsagePage = 0x01;
+    devices[0].usUsage = 0x02;
+    devices[0].dwFlags = RIDEV_REMOVE;
+    devices[1].usUsagePage = 0x01;
+    devices[1].usUsage = 0x06;
+    devices[1].dwFlags = RIDEV_REMOVE;
+    RegisterRawInputDevices(devices, 2, sizeof(RAWINPUTDEVICE));
+    m_registered = false;
+}
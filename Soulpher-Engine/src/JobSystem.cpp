@@ -0,0 +1,251 @@
+﻿/**
+ * @file JobSystem.cpp
+ * @brief Implementación del sistema de trabajos: colas de robo, anillos y workers.
+ */
+
+#include "JobSystem.h"
+#include "CpuProfiler.h"
+#include "CpuTopology.h"
+#include <malloc.h>
+
+namespace {
+    thread_local JobSystem* t_owner = nullptr;       // Sistema al que pertenece el hilo actual.
+    thread_local unsigned int t_thread = 0;          // Su índice en ese sistema.
+
+    /// Intentos de encontrar trabajo antes de que un worker se duerma.
+    const unsigned int kIdleSpins = 64;
+}
+
+JobSystem& JobSystem::getDefault() {
+    static JobSystem s_jobs;
+    return s_jobs;
+}
+
+// ==== JobSystem ====
+
+HRESULT JobSystem::init(unsigned int workerCount) {
+    destroy();
+    if (workerCount == 0) {
+        const unsigned int cores = std::thread::hardware_concurrency();
+        workerCount = cores > 1 ? cores - 1 : 0;
+    }
+    workerCount = (std::min)(workerCount, kMaxThreads - 1);
+
+    for (unsigned int i = 0; i <= workerCount; ++i) {
+        std::unique_ptr<ThreadState> state(new ThreadState());
+        state->jobs = static_cast<Job*>(_aligned_malloc(sizeof(Job) * kJobsPerThread, alignof(Job)));
+        if (!state->jobs) {
+            ERROR("JobSystem", "init", "Failed to allocate the job ring");
+            destroy();
+            return E_OUTOFMEMORY;
+        }
+        for (unsigned int j = 0; j < kJobsPerThread; ++j) {
+            new (&state->jobs[j]) Job();
+        }
+        m_threads.push_back(std::move(state));
+    }
+
+    m_stopping = false;
+    t_owner = this;
+    t_thread = 0;
+    // Los hilos arrancan cuando `m_threads` ya no cambia: todos ven las colas de todos.
+    for (unsigned int i = 1; i <= workerCount; ++i) {
+        m_threads[i]->thread = std::thread(&JobSystem::workerLoop, this, i);
+    }
+    MESSAGE("JobSystem", "init", ("Started " + std::to_string(workerCount) + " job workers").c_str());
+    return S_OK;
+}
+
+void JobSystem::destroy() {
+    if (m_threads.empty()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    for (std::unique_ptr<ThreadState>& state : m_threads) {
+        if (state->thread.joinable()) {
+            state->thread.join();
+        }
+    }
+    for (std::unique_ptr<ThreadState>& state : m_threads) {
+        _aligned_free(state->jobs);
+    }
+    m_threads.clear();
+    m_queued = 0;
+    if (t_owner == this) {
+        t_owner = nullptr;
+    }
+}
+
+bool JobSystem::isJobThread() const {
+    return currentThread() < m_threads.size();
+}
+
+unsigned int JobSystem::currentThread() const {
+    return t_owner == this ? t_thread : kMaxThreads;
+}
+
+Job* JobSystem::allocate(JobFunction function, Job* parent, const void* data, size_t size) {
+    const unsigned int thread = currentThread();
+    if (thread >= m_threads.size()) {
+        ERROR("JobSystem", "createJob", "Called from a thread without a job queue");
+        return nullptr;
+    }
+    if (size > kJobDataBytes) {
+        ERROR("JobSystem", "createJob", "Job data too large");
+        return nullptr;
+    }
+    ThreadState& state = *m_threads[thread];
+    Job* job = &state.jobs[state.nextJob++ & (kJobsPerThread - 1)];
+    // El anillo dio la vuelta hasta un trabajo sin terminar: se ayuda hasta que acabe.
+    while (job->unfinished.load(std::memory_order_acquire) > 0) {
+        if (Job* other = findJob(thread)) {
+            execute(other);
+        }
+        else {
+            std::this_thread::yield();
+        }
+    }
+    job->function = function;
+    job->parent = parent;
+    job->unfinished.store(1, std::memory_order_relaxed);
+    if (size > 0) {
+        memcpy(job->data, data, size);
+    }
+    if (parent) {
+        parent->unfinished.fetch_add(1, std::memory_order_relaxed);
+    }
+    return job;
+}
+
+void JobSystem::run(Job* job) {
+    if (!job) {
+        return;
+    }
+    const unsigned int thread = currentThread();
+    if (thread >= m_threads.size() || !m_threads[thread]->queue.Push(job)) {
+        // Sin cola (o llena): se ejecuta aquí mismo.
+        execute(job);
+        return;
+    }
+    m_queued.fetch_add(1);
+    if (m_sleeping.load() > 0) {
+        // Con el mutex: el worker que iba a dormirse ya ve `m_queued` o ya está esperando.
+        { std::lock_guard<std::mutex> lock(m_sleepMutex); }
+        m_wake.notify_one();
+    }
+}
+
+void JobSystem::wait(const Job* job) {
+    if (!job) {
+        return;
+    }
+    const unsigned int thread = currentThread();
+    while (job->unfinished.load(std::memory_order_acquire) > 0) {
+        Job* other = thread < m_threads.size() ? findJob(thread) : nullptr;
+        if (other) {
+            execute(other);
+        }
+        else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+Job* JobSystem::findJob(unsigned int thread) {
+    if (m_queued.load(std::memory_order_relaxed) <= 0) {
+        return nullptr;
+    }
+    Job* job = nullptr;
+    if (!m_threads[thread]->queue.Pop(job)) {
+        job = nullptr;
+        // Roba empezando por el siguiente hilo, para no cargar siempre al mismo.
+        const unsigned int count = static_cast<unsigned int>(m_threads.size());
+        for (unsigned int i = 1; i < count && !job; ++i) {
+            m_threads[(thread + i) % count]->queue.Steal(job);
+        }
+        if (job) {
+            m_stealCount.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    if (job) {
+        m_queued.fetch_sub(1);
+    }
+    return job;
+}
+
+void JobSystem::execute(Job* job) {
+    job->function(*job, job->data);
+    finish(job);
+}
+
+void JobSystem::finish(Job* job) {
+    // Un padre termina cuando llega a cero: él y todos sus hijos han acabado.
+    while (job && job->unfinished.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        job = job->parent;
+    }
+}
+
+void JobSystem::workerLoop(unsigned int thread) {
+    t_owner = this;
+    t_thread = thread;
+#if defined(PROFILE)
+    CpuProfiler::instance().setThreadName("Jobs");
+#endif
+    CpuTopology::getDefault().applyToCurrentThread(CpuTopology::THREAD_ROLE_WORKER);
+    unsigned int idle = 0;
+    while (!m_stopping.load()) {
+        if (Job* job = findJob(thread)) {
+            execute(job);
+            idle = 0;
+            continue;
+        }
+        if (++idle < kIdleSpins) {
+            std::this_thread::yield();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        m_sleeping.fetch_add(1);
+        m_wake.wait(lock, [this]() { return m_stopping.load() || m_queued.load() > 0; });
+        m_sleeping.fetch_sub(1);
+        idle = 0;
+    }
+}
+
+// ==== parallelFor ====
+
+void JobSystem::parallelFor(unsigned int count, unsigned int minBatch, RangeFunction function, const void* context) {
+    if (count == 0) {
+        return;
+    }
+    const unsigned int threads = getThreadCount();
+    const unsigned int target = (count + threads * kBatchesPerThread - 1) / (threads * kBatchesPerThread);
+    const unsigned int batch = (std::max)((std::max)(minBatch, target), 1u);
+    if (threads == 1 || count <= batch || !isJobThread()) {
+        function(context, 0, count);
+        return;
+    }
+    const RangeData range = { function, context, 0, count, batch };
+    Job* root = createJob(&JobSystem::rangeJob, &range, sizeof(range));
+    run(root);
+    wait(root);
+}
+
+/**
+ * @details Parte el rango por la mitad mientras sea mayor que el lote: la mitad derecha
+ * va a la cola (donde la puede robar otro hilo) y este sigue con la izquierda.
+ */
+void JobSystem::rangeJob(Job& job, const void* data) {
+    RangeData range = *static_cast<const RangeData*>(data);
+    JobSystem& system = *t_owner;
+    while (range.end - range.begin > range.batch) {
+        RangeData right = range;
+        right.begin = range.begin + (range.end - range.begin) / 2;
+        system.run(system.createChild(job, &JobSystem::rangeJob, &right, sizeof(right)));
+        range.end = right.begin;
+    }
+    range.function(range.context, range.begin, range.end);
+}
@@ -0,0 +1,513 @@
+﻿/**
+ * @file LightmapBaker.cpp
+ * @brief Implementación del atlas y el trazado de los lightmaps.
+ */
+
+#include "LightmapBaker.h"
+#include "Device.h"
+#include "MeshAsset.h"
+#include "BlockCompressor.h"
+#include "DdsFile.h"
+#include "JobSystem.h"
+#include "TriangleBvh.h"
+#include "ECS/Actor.h"
+#include "ECS/Transform.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+namespace {
+    const uint32_t kMagic = 0x504D4C53; // "SLMP"
+    /// Separación entre rectángulos: un bloque BC6H entero, para que nunca mezcle dos actores.
+    const unsigned int kRectGap = 4;
+    /// Pasadas de relleno de bordes (texeles que crece cada isla).
+    const unsigned int kDilatePasses = 8;
+
+    struct FileHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t sceneHash;
+        uint32_t pageCount;
+        uint32_t entryCount;
+    };
+
+    /// Rectángulo de un candidato, en el orden de @ref collectCandidates.
+    struct FileEntry {
+        uint32_t page;
+        uint32_t padding;
+        XMFLOAT4 scaleOffset;
+    };
+
+    bool isCandidate(Actor& actor) {
+        const EU::TSharedPointer<MeshAsset>& asset = actor.getMeshAsset();
+        return actor.isStatic() && !actor.isTransparent() && !asset.isNull() && asset->hasLightmapUV() &&
+            actor.hasComponent<Transform>();
+    }
+
+    /// Candidatos en el orden de la escena y huella de lo que invalida el horneado.
+    std::vector<Actor*> collectCandidates(const std::vector<ActorHandle>& actors, uint64_t& hash) {
+        std::vector<Actor*> candidates;
+        hash = EU::kFnv1aSeed;
+        for (ActorHandle handle : actors) {
+            Actor* actor = handle.get();
+            if (!actor || !isCandidate(*actor)) {
+                continue;
+            }
+            Transform* transform = actor->getComponent<Transform>();
+            transform->update(0.0f);
+            XMFLOAT4X4 world;
+            XMStoreFloat4x4(&world, transform->getMatrix());
+            const std::string& source = actor->getMeshAsset()->getSourceName();
+            const size_t nameSize = actor->getName().size();
+            EU::Fnv1a(hash, &nameSize, sizeof(nameSize));
+            EU::Fnv1a(hash, actor->getName().data(), nameSize);
+            EU::Fnv1a(hash, &world, sizeof(world));
+            EU::Fnv1a(hash, source.data(), source.size());
+            candidates.push_back(actor);
+        }
+        return candidates;
+    }
+
+    XMFLOAT3 add(const XMFLOAT3& a, const XMFLOAT3& b) { return XMFLOAT3(a.x + b.x, a.y + b.y, a.z + b.z); }
+    XMFLOAT3 sub(const XMFLOAT3& a, const XMFLOAT3& b) { return XMFLOAT3(a.x - b.x, a.y - b.y, a.z - b.z); }
+    XMFLOAT3 scale(const XMFLOAT3& a, float s) { return XMFLOAT3(a.x * s, a.y * s, a.z * s); }
+    float dot(const XMFLOAT3& a, const XMFLOAT3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+    XMFLOAT3 cross(const XMFLOAT3& a, const XMFLOAT3& b) {
+        return XMFLOAT3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+    }
+    XMFLOAT3 normalize(const XMFLOAT3& a) {
+        const float length = sqrtf(dot(a, a));
+        return length > 0.0f ? scale(a, 1.0f / length) : XMFLOAT3(0.0f, 1.0f, 0.0f);
+    }
+
+    /// Generador por texel (xorshift32): el resultado no depende del reparto entre hilos.
+    struct Random {
+        uint32_t state;
+        explicit Random(uint32_t seed) : state(seed * 747796405u + 2891336453u) { if (!state) state = 1; }
+        float next() {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            return (state >> 8) * (1.0f / 16777216.0f);
+        }
+    };
+
+    /// Dirección con densidad proporcional al coseno alrededor de `normal`.
+    XMFLOAT3 sampleCosine(const XMFLOAT3& normal, Random& random) {
+        const XMFLOAT3 helper = fabsf(normal.x) > 0.9f ? XMFLOAT3(0.0f, 1.0f, 0.0f) : XMFLOAT3(1.0f, 0.0f, 0.0f);
+        const XMFLOAT3 tangent = normalize(cross(helper, normal));
+        const XMFLOAT3 bitangent = cross(normal, tangent);
+        const float r = sqrtf(random.next());
+        const float phi = 6.2831853f * random.next();
+        const float x = r * cosf(phi), y = r * sinf(phi);
+        const float z = sqrtf((std::max)(0.0f, 1.0f - x * x - y * y));
+        return normalize(add(add(scale(tangent, x), scale(bitangent, y)), scale(normal, z)));
+    }
+
+    /// Lo que el trazado necesita de la escena.
+    struct Scene {
+        TriangleBvh bvh;
+        const LightmapBaker::Lighting* lighting = nullptr;
+        float bias = 1e-3f;     ///< Separación del origen de los rayos respecto de la superficie.
+        float albedo = 0.5f;
+        unsigned int samples = 1;
+        unsigned int bounces = 0;
+
+        bool occluded(const XMFLOAT3& origin, const XMFLOAT3& direction, float maxT) const {
+            float t;
+            unsigned int triangle;
+            return bvh.trace(origin, direction, maxT, true, t, triangle);
+        }
+
+        /// Sol (sin la parte de cielo) y luces locales en un punto.
+        XMFLOAT3 direct(const XMFLOAT3& position, const XMFLOAT3& normal) const {
+            const XMFLOAT3 origin = add(position, scale(normal, bias));
+            float sun = 0.0f;
+            if (dot(normal, lighting->sunDirection) > 0.0f && !occluded(origin, lighting->sunDirection, FLT_MAX)) {
+                sun = lighting->shadowStrength;
+            }
+            XMFLOAT3 result(sun, sun, sun);
+            for (const ClusteredLighting::Light& light : lighting->lights) {
+                const XMFLOAT3 toLight = sub(light.position, position);
+                const float distance = sqrtf(dot(toLight, toLight));
+                if (distance >= light.range || distance < 1e-4f) {
+                    continue;
+                }
+                const XMFLOAT3 direction = scale(toLight, 1.0f / distance);
+                const float lambert = dot(normal, direction);
+                if (lambert <= 0.0f) {
+                    continue;
+                }
+                // La misma atenuación que `EvaluateLight` (ClusteredLights.fxh).
+                const float falloff = 1.0f - distance / light.range;
+                float spot = 1.0f;
+                if (light.type == ClusteredLighting::Light::SPOT) {
+                    const float cosOuter = cosf(light.outerAngle);
+                    const float cosInner = cosf(light.innerAngle);
+                    const float x = (std::min)((std::max)((-dot(direction, light.direction) - cosOuter) /
+                        (std::max)(cosInner - cosOuter, 1e-4f), 0.0f), 1.0f);
+                    spot = x * x * (3.0f - 2.0f * x);
+                }
+                const float amount = lambert * falloff * falloff * spot * light.intensity;
+                if (amount <= 0.0f || occluded(origin, direction, distance - bias)) {
+                    continue;
+                }
+                result = add(result, scale(light.color, amount));
+            }
+            return result;
+        }
+
+        /// Irradiancia horneada de un texel (directa + cielo + rebotes).
+        XMFLOAT3 shade(const XMFLOAT3& position, const XMFLOAT3& normal, Random& random) const {
+            const float sky = 1.0f - lighting->shadowStrength;
+            XMFLOAT3 gathered(0.0f, 0.0f, 0.0f);
+            for (unsigned int s = 0; s < samples; ++s) {
+                XMFLOAT3 origin = add(position, scale(normal, bias));
+                XMFLOAT3 direction = sampleCosine(normal, random);
+                float throughput = 1.0f;
+                for (unsigned int bounce = 0;; ++bounce) {
+                    float t;
+                    unsigned int triangle;
+                    if (!bvh.trace(origin, direction, FLT_MAX, false, t, triangle)) {
+                        gathered = add(gathered, XMFLOAT3(throughput * sky, throughput * sky, throughput * sky));
+                        break;
+                    }
+                    if (bounce == bounces) {
+                        break;
+                    }
+                    XMFLOAT3 hitNormal = bvh.getTriangle(triangle).normal;
+                    if (dot(hitNormal, direction) > 0.0f) {
+                        hitNormal = scale(hitNormal, -1.0f);
+                    }
+                    const XMFLOAT3 hit = add(origin, scale(direction, t));
+                    throughput *= albedo;
+                    gathered = add(gathered, scale(direct(hit, hitNormal), throughput));
+                    origin = add(hit, scale(hitNormal, bias));
+                    direction = sampleCosine(hitNormal, random);
+                }
+            }
+            return add(direct(position, normal), scale(gathered, 1.0f / static_cast<float>(samples)));
+        }
+    };
+
+    /// Texel del atlas que cubre alguna superficie.
+    struct Texel {
+        XMFLOAT3 position;
+        XMFLOAT3 normal;
+        bool valid = false;
+    };
+
+    /// Rectángulo de un candidato en el atlas.
+    struct Placement {
+        Actor* actor = nullptr;
+        XMMATRIX world;
+        unsigned int size = 0;
+        unsigned int page = 0;
+        unsigned int x = 0;
+        unsigned int y = 0;
+    };
+
+    /// Rasteriza las UV2 de un actor en su rectángulo (prueba del centro del texel).
+    void rasterize(const Placement& placement, const MeshAsset& asset, std::vector<Texel>& texels,
+        unsigned int atlasSize) {
+        for (const MeshComponent& mesh : asset.m_meshes) {
+            if (mesh.m_lightmapUV.size() != mesh.m_vertex.size()) {
+                continue;
+            }
+            for (size_t i = 0; i + 2 < mesh.m_index.size(); i += 3) {
+                XMFLOAT2 uv[3];
+                XMFLOAT3 world[3];
+                for (unsigned int k = 0; k < 3; ++k) {
+                    const unsigned int v = mesh.m_index[i + k];
+                    uv[k] = XMFLOAT2(placement.x + mesh.m_lightmapUV[v].x * placement.size,
+                        placement.y + mesh.m_lightmapUV[v].y * placement.size);
+                    XMStoreFloat3(&world[k], XMVector3TransformCoord(XMLoadFloat3(&mesh.m_vertex[v].Pos), placement.world));
+                }
+                const XMFLOAT3 normal = normalize(cross(sub(world[1], world[0]), sub(world[2], world[0])));
+                const float area = (uv[1].x - uv[0].x) * (uv[2].y - uv[0].y) - (uv[2].x - uv[0].x) * (uv[1].y - uv[0].y);
+                if (fabsf(area) < 1e-12f) {
+                    continue;
+                }
+                const int x0 = (std::max)(static_cast<int>(floorf((std::min)(uv[0].x, (std::min)(uv[1].x, uv[2].x)))), static_cast<int>(placement.x));
+                const int y0 = (std::max)(static_cast<int>(floorf((std::min)(uv[0].y, (std::min)(uv[1].y, uv[2].y)))), static_cast<int>(placement.y));
+                const int x1 = (std::min)(static_cast<int>(ceilf((std::max)(uv[0].x, (std::max)(uv[1].x, uv[2].x)))), static_cast<int>(placement.x + placement.size));
+                const int y1 = (std::min)(static_cast<int>(ceilf((std::max)(uv[0].y, (std::max)(uv[1].y, uv[2].y)))), static_cast<int>(placement.y + placement.size));
+                for (int y = y0; y < y1; ++y) {
+                    for (int x = x0; x < x1; ++x) {
+                        const float px = x + 0.5f, py = y + 0.5f;
+                        const float w0 = ((uv[1].x - px) * (uv[2].y - py) - (uv[2].x - px) * (uv[1].y - py)) / area;
+                        const float w1 = ((uv[2].x - px) * (uv[0].y - py) - (uv[0].x - px) * (uv[2].y - py)) / area;
+                        const float w2 = 1.0f - w0 - w1;
+                        if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f) {
+                            continue;
+                        }
+                        Texel& texel = texels[static_cast<size_t>(y) * atlasSize + x];
+                        if (texel.valid) {
+                            continue;
+                        }
+                        texel.position = add(add(scale(world[0], w0), scale(world[1], w1)), scale(world[2], w2));
+                        texel.normal = normal;
+                        texel.valid = true;
+                    }
+                }
+            }
+        }
+    }
+
+    /// Rellena los texeles vacíos vecinos de los llenos con su media (por pasadas).
+    void dilate(std::vector<XMFLOAT3>& color, std::vector<char>& filled, unsigned int size) {
+        std::vector<XMFLOAT3> next;
+        std::vector<char> nextFilled;
+        for (unsigned int pass = 0; pass < kDilatePasses; ++pass) {
+            next = color;
+            nextFilled = filled;
+            for (unsigned int y = 0; y < size; ++y) {
+                for (unsigned int x = 0; x < size; ++x) {
+                    if (filled[y * size + x]) {
+                        continue;
+                    }
+                    XMFLOAT3 sum(0.0f, 0.0f, 0.0f);
+                    unsigned int count = 0;
+                    for (int dy = -1; dy <= 1; ++dy) {
+                        for (int dx = -1; dx <= 1; ++dx) {
+                            const int nx = static_cast<int>(x) + dx, ny = static_cast<int>(y) + dy;
+                            if (nx < 0 || ny < 0 || nx >= static_cast<int>(size) || ny >= static_cast<int>(size) ||
+                                !filled[ny * size + nx]) {
+                                continue;
+                            }
+                            sum = add(sum, color[ny * size + nx]);
+                            ++count;
+                        }
+                    }
+                    if (count > 0) {
+                        next[y * size + x] = scale(sum, 1.0f / count);
+                        nextFilled[y * size + x] = 1;
+                    }
+                }
+            }
+            color.swap(next);
+            filled.swap(nextFilled);
+        }
+    }
+
+    std::string pagePath(const std::string& basePath, unsigned int page) {
+        return basePath + "_" + std::to_string(page) + ".dds";
+    }
+}
+
+/**
+ * @details Las páginas se trazan una a una; dentro de una página, por filas en el
+ * `JobSystem`. Cada texel tiene su propia semilla, así el resultado es el mismo con
+ * cualquier número de hilos.
+ */
+HRESULT LightmapBaker::bake(Device& device, const std::vector<ActorHandle>& actors, const Lighting& lighting,
+    const std::string& basePath, const Settings& settings) {
+    uint64_t hash = 0;
+    const std::vector<Actor*> candidates = collectCandidates(actors, hash);
+    if (candidates.empty()) {
+        MESSAGE("LightmapBaker", "bake", "No static actors with lightmap UVs.");
+        return S_FALSE;
+    }
+    for (Actor* actor : candidates) {
+        if (!actor->getMeshAsset()->hasCpuData()) {
+            ERROR("LightmapBaker", "bake", ("Mesh data was released for " + actor->getName() +
+                "; start with -lightmapbake 1").c_str());
+            return E_FAIL;
+        }
+    }
+    const unsigned int atlasSize = (std::max)(settings.atlasSize & ~3u, 16u);
+    const unsigned int maxRect = (std::min)((std::max)(settings.maxRectSize & ~3u, 4u), atlasSize - kRectGap);
+    const unsigned int minRect = (std::min)((std::max)((settings.minRectSize + 3) & ~3u, 4u), maxRect);
+
+    // 1) Geometría del mundo (estáticos con copia de CPU) y rectángulo de cada candidato.
+    Scene scene;
+    scene.lighting = &lighting;
+    scene.albedo = settings.albedo;
+    scene.samples = (std::max)(settings.samples, 1u);
+    scene.bounces = settings.bounces;
+    std::vector<Triangle> triangles;
+    XMFLOAT3 sceneMin(FLT_MAX, FLT_MAX, FLT_MAX), sceneMax(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+    TriangleBvh::gatherStatic(actors, triangles, sceneMin, sceneMax);
+    const XMFLOAT3 diagonal = sub(sceneMax, sceneMin);
+    scene.bias = (std::max)(sqrtf((std::max)(dot(diagonal, diagonal), 0.0f)) * 1e-4f, 1e-4f);
+    scene.bvh.build(std::move(triangles));
+
+    std::vector<Placement> placements(candidates.size());
+    for (size_t c = 0; c < candidates.size(); ++c) {
+        Placement& placement = placements[c];
+        placement.actor = candidates[c];
+        placement.world = candidates[c]->getComponent<Transform>()->getMatrix();
+        float area = 0.0f;
+        for (const MeshComponent& mesh : candidates[c]->getMeshAsset()->m_meshes) {
+            if (mesh.m_lightmapUV.size() != mesh.m_vertex.size()) {
+                continue;
+            }
+            for (size_t i = 0; i + 2 < mesh.m_index.size(); i += 3) {
+                XMFLOAT3 p[3];
+                for (unsigned int k = 0; k < 3; ++k) {
+                    XMStoreFloat3(&p[k], XMVector3TransformCoord(XMLoadFloat3(&mesh.m_vertex[mesh.m_index[i + k]].Pos), placement.world));
+                }
+                const XMFLOAT3 n = cross(sub(p[1], p[0]), sub(p[2], p[0]));
+                area += 0.5f * sqrtf(dot(n, n));
+            }
+        }
+        // Las islas ocupan más o menos la mitad del cuadrado UV2.
+        const float side = sqrtf(area * 2.0f) * settings.texelsPerUnit;
+        const unsigned int size = (static_cast<unsigned int>(side) + 3) & ~3u;
+        placement.size = (std::min)((std::max)(size, minRect), maxRect);
+    }
+
+    // 2) Atlas: por filas, de mayor a menor, en tantas páginas como hagan falta.
+    std::vector<size_t> order(placements.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&placements](size_t a, size_t b) {
+        return placements[a].size > placements[b].size;
+    });
+    unsigned int pageCount = 1, cursorX = 0, cursorY = 0, rowHeight = 0;
+    for (size_t index : order) {
+        Placement& placement = placements[index];
+        const unsigned int cell = placement.size + kRectGap;
+        if (cursorX + cell > atlasSize) {
+            cursorX = 0;
+            cursorY += rowHeight;
+            rowHeight = 0;
+        }
+        if (cursorY + cell > atlasSize) {
+            ++pageCount;
+            cursorX = cursorY = rowHeight = 0;
+        }
+        placement.page = pageCount - 1;
+        placement.x = cursorX + kRectGap / 2;
+        placement.y = cursorY + kRectGap / 2;
+        cursorX += cell;
+        rowHeight = (std::max)(rowHeight, cell);
+    }
+
+    // 3) Trazado, relleno, BC6H y disco, página a página.
+    for (unsigned int page = 0; page < pageCount; ++page) {
+        std::vector<Texel> texels(static_cast<size_t>(atlasSize) * atlasSize);
+        for (const Placement& placement : placements) {
+            if (placement.page == page) {
+                rasterize(placement, *placement.actor->getMeshAsset(), texels, atlasSize);
+            }
+        }
+        std::vector<XMFLOAT3> color(texels.size(), XMFLOAT3(0.0f, 0.0f, 0.0f));
+        std::vector<char> filled(texels.size(), 0);
+        JobSystem::getDefault().parallelFor(atlasSize, [&](unsigned int begin, unsigned int end) {
+            for (unsigned int y = begin; y < end; ++y) {
+                for (unsigned int x = 0; x < atlasSize; ++x) {
+                    const size_t index = static_cast<size_t>(y) * atlasSize + x;
+                    if (!texels[index].valid) {
+                        continue;
+                    }
+                    Random random(static_cast<uint32_t>(index) ^ (page * 0x9E3779B9u));
+                    color[index] = scene.shade(texels[index].position, texels[index].normal, random);
+                    filled[index] = 1;
+                }
+            }
+        }, 4);
+        dilate(color, filled, atlasSize);
+
+        std::vector<float> rgb(color.size() * 3);
+        std::memcpy(rgb.data(), color.data(), rgb.size() * sizeof(float));
+        CompressedImage image;
+        if (!BlockCompressor::compressHDR(rgb.data(), atlasSize, atlasSize, image) ||
+            FAILED(DdsFile::write(pagePath(basePath, page), image))) {
+            ERROR("LightmapBaker", "bake", ("Cannot write " + pagePath(basePath, page)).c_str());
+            return E_FAIL;
+        }
+    }
+
+    // 4) Índice: huella de la escena y rectángulo de cada candidato.
+    const std::string indexPath = basePath + ".slmap";
+    const std::string temp = indexPath + ".tmp";
+    FILE* file = nullptr;
+    if (fopen_s(&file, temp.c_str(), "wb") != 0 || !file) {
+        ERROR("LightmapBaker", "bake", ("Cannot write " + temp).c_str());
+        return E_FAIL;
+    }
+    FileHeader header = { kMagic, kFormatVersion, hash, pageCount, static_cast<uint32_t>(placements.size()) };
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    for (const Placement& placement : placements) {
+        const float inverse = 1.0f / static_cast<float>(atlasSize);
+        FileEntry entry = { placement.page, 0, XMFLOAT4(placement.size * inverse, placement.size * inverse,
+            placement.x * inverse, placement.y * inverse) };
+        ok = ok && fwrite(&entry, sizeof(entry), 1, file) == 1;
+    }
+    ok = fclose(file) == 0 && ok;
+    if (!ok || !MoveFileExA(temp.c_str(), indexPath.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+        DeleteFileA(temp.c_str());
+        ERROR("LightmapBaker", "bake", ("Cannot write " + indexPath).c_str());
+        return E_FAIL;
+    }
+    MESSAGE("LightmapBaker", "bake", ("Baked " + std::to_string(candidates.size()) + " actors into " +
+        std::to_string(pageCount) + " pages.").c_str());
+    return load(device, actors, basePath);
+}
+
+HRESULT LightmapBaker::load(Device& device, const std::vector<ActorHandle>& actors, const std::string& basePath) {
+    clear(actors);
+    FILE* file = nullptr;
+    const std::string indexPath = basePath + ".slmap";
+    if (fopen_s(&file, indexPath.c_str(), "rb") != 0 || !file) {
+        return E_FAIL;
+    }
+    FileHeader header = {};
+    std::vector<FileEntry> entries;
+    bool ok = fread(&header, sizeof(header), 1, file) == 1 && header.magic == kMagic &&
+        header.version == kFormatVersion;
+    if (ok) {
+        entries.resize(header.entryCount);
+        ok = header.entryCount == 0 || fread(entries.data(), sizeof(FileEntry), entries.size(), file) == entries.size();
+    }
+    fclose(file);
+    if (!ok) {
+        ERROR("LightmapBaker", "load", ("Invalid lightmap index " + indexPath).c_str());
+        return E_INVALIDARG;
+    }
+
+    uint64_t hash = 0;
+    const std::vector<Actor*> candidates = collectCandidates(actors, hash);
+    if (hash != header.sceneHash || candidates.size() != entries.size()) {
+        MESSAGE("LightmapBaker", "load", "Scene changed since the last bake; lightmaps not applied.");
+        return E_ABORT;
+    }
+
+    for (uint32_t page = 0; page < header.pageCount; ++page) {
+        ID3D11ShaderResourceView* srv = nullptr;
+        HRESULT hr = DdsFile::load(device.m_device, pagePath(basePath, page), &srv);
+        if (FAILED(hr)) {
+            ERROR("LightmapBaker", "load", ("Cannot load " + pagePath(basePath, page) + ". HRESULT: " +
+                std::to_string(hr)).c_str());
+            destroy();
+            return hr;
+        }
+        m_pages.push_back(srv);
+    }
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        if (entries[i].page < m_pages.size()) {
+            candidates[i]->setLightmap(device, m_pages[entries[i].page], entries[i].scaleOffset);
+        }
+    }
+    MESSAGE("LightmapBaker", "load", ("Loaded " + indexPath).c_str());
+    return S_OK;
+}
+
+void LightmapBaker::clear(const std::vector<ActorHandle>& actors) {
+    for (ActorHandle handle : actors) {
+        if (Actor* actor = handle.get()) {
+            actor->clearLightmap();
+        }
+    }
+    destroy();
+}
+
+void LightmapBaker::destroy() {
+    for (ID3D11ShaderResourceView*& page : m_pages) {
+        SAFE_RELEASE(page);
+    }
+    m_pages.clear();
+}
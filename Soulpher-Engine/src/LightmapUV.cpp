@@ -0,0 +1,255 @@
+﻿/**
+ * @file LightmapUV.cpp
+ * @brief Implementación de las islas, la proyección y el empaquetado de las UV2.
+ */
+
+#include "LightmapUV.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+namespace {
+    /// Posición como clave exacta (bits de los tres floats).
+    struct PositionKey {
+        uint32_t x, y, z;
+        bool operator==(const PositionKey& other) const {
+            return x == other.x && y == other.y && z == other.z;
+        }
+    };
+
+    struct PositionKeyHash {
+        size_t operator()(const PositionKey& key) const {
+            uint64_t hash = key.x;
+            hash = hash * 0x9E3779B97F4A7C15ull ^ key.y;
+            hash = hash * 0x9E3779B97F4A7C15ull ^ key.z;
+            return static_cast<size_t>(hash ^ (hash >> 29));
+        }
+    };
+
+    PositionKey positionKey(const XMFLOAT3& p) {
+        PositionKey key;
+        std::memcpy(&key.x, &p.x, sizeof(uint32_t));
+        std::memcpy(&key.y, &p.y, sizeof(uint32_t));
+        std::memcpy(&key.z, &p.z, sizeof(uint32_t));
+        return key;
+    }
+
+    /// Raíz de `i` en la unión-búsqueda de triángulos (con compresión de camino).
+    unsigned int findRoot(std::vector<unsigned int>& parent, unsigned int i) {
+        while (parent[i] != i) {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    }
+
+    /// Eje dominante de la normal de un triángulo: 0..5 = +X, -X, +Y, -Y, +Z, -Z.
+    unsigned int dominantAxis(const XMFLOAT3& a, const XMFLOAT3& b, const XMFLOAT3& c) {
+        const float ux = b.x - a.x, uy = b.y - a.y, uz = b.z - a.z;
+        const float vx = c.x - a.x, vy = c.y - a.y, vz = c.z - a.z;
+        const float n[3] = { uy * vz - uz * vy, uz * vx - ux * vz, ux * vy - uy * vx };
+        unsigned int axis = 0;
+        for (unsigned int i = 1; i < 3; ++i) {
+            if (fabsf(n[i]) > fabsf(n[axis])) axis = i;
+        }
+        return axis * 2 + (n[axis] < 0.0f ? 1 : 0);
+    }
+
+    /// Posición proyectada en el plano del eje (orientada para que la isla no salga en espejo).
+    XMFLOAT2 project(const XMFLOAT3& p, unsigned int axis) {
+        const float flip = (axis & 1) ? -1.0f : 1.0f;
+        switch (axis >> 1) {
+        case 0: return XMFLOAT2(-p.z * flip, p.y);
+        case 1: return XMFLOAT2(p.x, -p.z * flip);
+        default: return XMFLOAT2(p.x * flip, p.y);
+        }
+    }
+
+    struct Chart {
+        unsigned int mesh = 0;                  ///< Índice en la lista de mallas.
+        std::vector<unsigned int> triangles;
+        unsigned int axis = 0;
+        XMFLOAT2 min = XMFLOAT2(FLT_MAX, FLT_MAX);
+        XMFLOAT2 max = XMFLOAT2(-FLT_MAX, -FLT_MAX);
+        XMFLOAT2 offset = XMFLOAT2(0.0f, 0.0f); ///< Esquina en el cuadrado 0..1 tras empaquetar.
+    };
+
+    /// Islas de una malla (pasos 1 y 2). `false` si no admite UV2.
+    bool buildCharts(const MeshComponent& mesh, unsigned int meshIndex, std::vector<Chart>& charts) {
+        const size_t vertexCount = mesh.m_vertex.size();
+        const unsigned int triangleCount = static_cast<unsigned int>(mesh.m_index.size() / 3);
+        if (!mesh.m_skin.empty() || !mesh.m_morphs.empty() || triangleCount == 0) {
+            return false;
+        }
+        for (unsigned int index : mesh.m_index) {
+            if (index >= vertexCount) {
+                return false;
+            }
+        }
+
+        // 1) Triángulos con una arista común (por posición) y el mismo eje.
+        std::unordered_map<PositionKey, unsigned int, PositionKeyHash> welded;
+        std::vector<unsigned int> weldedId(vertexCount);
+        for (size_t v = 0; v < vertexCount; ++v) {
+            weldedId[v] = welded.emplace(positionKey(mesh.m_vertex[v].Pos),
+                static_cast<unsigned int>(welded.size())).first->second;
+        }
+        std::vector<unsigned int> axes(triangleCount);
+        std::vector<unsigned int> parent(triangleCount);
+        std::unordered_map<uint64_t, unsigned int> edges;
+        for (unsigned int t = 0; t < triangleCount; ++t) {
+            const unsigned int* tri = &mesh.m_index[t * 3];
+            axes[t] = dominantAxis(mesh.m_vertex[tri[0]].Pos, mesh.m_vertex[tri[1]].Pos, mesh.m_vertex[tri[2]].Pos);
+            parent[t] = t;
+            for (unsigned int k = 0; k < 3; ++k) {
+                const uint64_t a = weldedId[tri[k]];
+                const uint64_t b = weldedId[tri[(k + 1) % 3]];
+                const uint64_t key = (std::min)(a, b) << 32 | (std::max)(a, b);
+                auto found = edges.emplace(key, t);
+                if (!found.second && axes[found.first->second] == axes[t]) {
+                    parent[findRoot(parent, t)] = findRoot(parent, found.first->second);
+                }
+            }
+        }
+
+        // 2) Proyección y caja de cada isla.
+        std::unordered_map<unsigned int, size_t> chartOfRoot;
+        for (unsigned int t = 0; t < triangleCount; ++t) {
+            auto found = chartOfRoot.emplace(findRoot(parent, t), charts.size());
+            if (found.second) {
+                charts.emplace_back();
+                charts.back().mesh = meshIndex;
+                charts.back().axis = axes[t];
+            }
+            Chart& chart = charts[found.first->second];
+            chart.triangles.push_back(t);
+            for (unsigned int k = 0; k < 3; ++k) {
+                const XMFLOAT2 p = project(mesh.m_vertex[mesh.m_index[t * 3 + k]].Pos, chart.axis);
+                chart.min = XMFLOAT2((std::min)(chart.min.x, p.x), (std::min)(chart.min.y, p.y));
+                chart.max = XMFLOAT2((std::max)(chart.max.x, p.x), (std::max)(chart.max.y, p.y));
+            }
+        }
+        return true;
+    }
+
+    /// UV2 por esquina (paso 4); un vértice ya usado por otra isla se duplica.
+    void assignUV(MeshComponent& mesh, const std::vector<Chart>& charts, const std::vector<unsigned int>& meshCharts,
+        float scale) {
+        const size_t vertexCount = mesh.m_vertex.size();
+        std::vector<int> owner(vertexCount, -1);
+        std::vector<XMFLOAT2> uv(vertexCount, XMFLOAT2(0.0f, 0.0f));
+        std::unordered_map<uint64_t, unsigned int> duplicates;
+        for (unsigned int c : meshCharts) {
+            const Chart& chart = charts[c];
+            for (unsigned int t : chart.triangles) {
+                for (unsigned int k = 0; k < 3; ++k) {
+                    unsigned int& index = mesh.m_index[t * 3 + k];
+                    const XMFLOAT2 p = project(mesh.m_vertex[index].Pos, chart.axis);
+                    const XMFLOAT2 texel((p.x - chart.min.x) * scale + chart.offset.x,
+                        (p.y - chart.min.y) * scale + chart.offset.y);
+                    if (owner[index] < 0) {
+                        owner[index] = static_cast<int>(c);
+                        uv[index] = texel;
+                    }
+                    else if (owner[index] != static_cast<int>(c)) {
+                        auto found = duplicates.emplace(static_cast<uint64_t>(c) << 32 | index,
+                            static_cast<unsigned int>(mesh.m_vertex.size()));
+                        if (found.second) {
+                            const SimpleVertex copy = mesh.m_vertex[index];
+                            mesh.m_vertex.push_back(copy);
+                            owner.push_back(static_cast<int>(c));
+                            uv.push_back(texel);
+                        }
+                        index = found.first->second;
+                    }
+                }
+            }
+        }
+        mesh.m_lightmapUV = std::move(uv);
+        mesh.m_numVertex = static_cast<int>(mesh.m_vertex.size());
+    }
+
+    /// Coloca las islas por filas con escala `scale` (UV por unidad). `false` si no caben.
+    bool pack(std::vector<Chart>& charts, const std::vector<unsigned int>& order, float scale, float padding) {
+        float x = padding, y = padding, rowHeight = 0.0f;
+        for (unsigned int index : order) {
+            Chart& chart = charts[index];
+            const float width = (chart.max.x - chart.min.x) * scale;
+            const float height = (chart.max.y - chart.min.y) * scale;
+            if (x + width + padding > 1.0f) {
+                x = padding;
+                y += rowHeight + padding;
+                rowHeight = 0.0f;
+            }
+            if (x + width + padding > 1.0f || y + height + padding > 1.0f) {
+                return false;
+            }
+            chart.offset = XMFLOAT2(x, y);
+            x += width + padding;
+            rowHeight = (std::max)(rowHeight, height);
+        }
+        return true;
+    }
+}
+
+/**
+ * @details La escala del empaquetado se busca por bisección: la mayor con la que todas
+ * las islas de todas las mallas caben en 0..1 con su margen.
+ */
+bool LightmapUV::generate(std::vector<MeshComponent>& meshes) {
+    std::vector<Chart> charts;
+    std::vector<std::vector<unsigned int>> meshCharts(meshes.size());
+    for (unsigned int m = 0; m < meshes.size(); ++m) {
+        meshes[m].m_lightmapUV.clear();
+        const size_t first = charts.size();
+        if (!buildCharts(meshes[m], m, charts)) {
+            continue;
+        }
+        for (size_t c = first; c < charts.size(); ++c) {
+            meshCharts[m].push_back(static_cast<unsigned int>(c));
+        }
+    }
+    if (charts.empty()) {
+        return false;
+    }
+
+    // 3) Empaquetado: de mayor a menor alto, con la mayor escala que cabe.
+    std::vector<unsigned int> order(charts.size());
+    float largest = 0.0f;
+    for (unsigned int i = 0; i < charts.size(); ++i) {
+        order[i] = i;
+        largest = (std::max)(largest, (std::max)(charts[i].max.x - charts[i].min.x, charts[i].max.y - charts[i].min.y));
+    }
+    std::sort(order.begin(), order.end(), [&charts](unsigned int a, unsigned int b) {
+        return charts[a].max.y - charts[a].min.y > charts[b].max.y - charts[b].min.y;
+    });
+    const float padding = static_cast<float>(kPadding) / static_cast<float>(kReferenceSize);
+    if (!(largest > 0.0f)) {
+        return false;
+    }
+    float low = 0.0f;
+    float high = (1.0f - 2.0f * padding) / largest;
+    if (pack(charts, order, high, padding)) {
+        low = high;
+    }
+    else {
+        for (unsigned int step = 0; step < 24; ++step) {
+            const float middle = 0.5f * (low + high);
+            if (pack(charts, order, middle, padding)) low = middle; else high = middle;
+        }
+    }
+    if (!(low > 0.0f) || !pack(charts, order, low, padding)) {
+        ERROR("LightmapUV", "generate", ("Too many charts for the lightmap padding: " + meshes[0].m_name.str()).c_str());
+        return false;
+    }
+
+    // 4) UV2 de cada malla que tiene islas.
+    for (unsigned int m = 0; m < meshes.size(); ++m) {
+        if (!meshCharts[m].empty()) {
+            assignUV(meshes[m], charts, meshCharts[m], low);
+        }
+    }
+    return true;
+}
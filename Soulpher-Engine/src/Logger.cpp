@@ -0,0 +1,362 @@
+﻿/**
+ * @file Logger.cpp
+ * @brief Implementación del log asíncrono: formateo sin memoria, anillos y hilo de salida.
+ *
+ * @details
+ * Un error despierta al hilo del log sin tomar ningún lock (`notify_one` tras marcar
+ * `m_urgent`). Si el aviso llega justo antes de que el hilo se ponga a esperar se
+ * pierde, pero la espera tiene límite de @ref Logger::kFlushIntervalMs: el error sale
+ * como mucho un intervalo tarde.
+ */
+
+#include "Logger.h"
+#include <windows.h>
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+
+namespace {
+    enum LoggerState : int {
+        LOGGER_NOT_CREATED = 0,
+        LOGGER_ALIVE = 1,
+        LOGGER_DESTROYED = 2,
+    };
+    std::atomic<int> s_state{ LOGGER_NOT_CREATED };
+
+    /// Categoría con nivel propio. Una vez publicada (`s_categoryCount`) su nombre no cambia.
+    struct CategoryLevel {
+        char name[Logger::kCategoryBytes];
+        std::atomic<uint8_t> level;
+    };
+    CategoryLevel s_categories[Logger::kMaxCategories];
+    std::mutex s_categoryMutex;                  ///< Solo entre escritores.
+
+    const char* const kLevelNames[LOG_LEVEL_COUNT] = { "trace", "debug", "info", "warn", "error" };
+
+    /// Texto del registro terminado en nulo (`out` tiene `kTextBytes + 1`).
+    void recordText(const LogRecord& record, char* out) {
+        memcpy(out, record.text, record.length);
+        out[record.length] = '\0';
+    }
+
+    /// Salida por defecto: el depurador, igual que hacían las macros.
+    void debuggerSink(const LogRecord&, const char* line, void*) {
+        wchar_t wide[LogRecord::kTextBytes + 2];
+        const int length = MultiByteToWideChar(CP_UTF8, 0, line, -1, wide, LogRecord::kTextBytes + 1);
+        const int end = length > 0 ? length - 1 : 0;
+        wide[end] = L'\n';
+        wide[end + 1] = L'\0';
+        OutputDebugStringW(wide);
+    }
+}
+
+// ==== LogStream ====
+
+LogStream::LogStream(uint8_t level, const char* category) {
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    m_record.timestamp = static_cast<uint64_t>(now.QuadPart);
+    m_record.category = category;
+    m_record.threadId = GetCurrentThreadId();
+    m_record.level = level;
+    m_record.truncated = 0;
+    m_record.length = 0;
+}
+
+LogStream::~LogStream() {
+    Logger::submit(m_record);
+}
+
+LogStream& LogStream::operator<<(const char* text) {
+    if (!text) {
+        text = "(null)";
+    }
+    append(text, strlen(text));
+    return *this;
+}
+
+LogStream& LogStream::operator<<(const wchar_t* text) {
+    if (!text) {
+        append("(null)", 6);
+        return *this;
+    }
+    appendWide(text, wcslen(text));
+    return *this;
+}
+
+LogStream& LogStream::operator<<(double value) {
+    // Seis cifras significativas, como `std::ostream` por defecto.
+    char buffer[32];
+    const std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::general, 6);
+    append(buffer, result.ec == std::errc() ? static_cast<size_t>(result.ptr - buffer) : 0);
+    return *this;
+}
+
+LogStream& LogStream::operator<<(const void* pointer) {
+    char buffer[2 + 16] = { '0', 'x' };
+    const std::to_chars_result result = std::to_chars(buffer + 2, buffer + sizeof(buffer),
+        static_cast<unsigned long long>(reinterpret_cast<uintptr_t>(pointer)), 16);
+    append(buffer, static_cast<size_t>(result.ptr - buffer));
+    return *this;
+}
+
+void LogStream::append(const char* text, size_t length) {
+    const size_t space = LogRecord::kTextBytes - m_record.length;
+    if (length > space) {
+        length = space;
+        m_record.truncated = 1;
+    }
+    memcpy(m_record.text + m_record.length, text, length);
+    m_record.length = static_cast<uint16_t>(m_record.length + length);
+}
+
+void LogStream::appendWide(const wchar_t* text, size_t length) {
+    // UTF-16 a UTF-8 a mano: sin llamadas al sistema ni buffers intermedios.
+    for (size_t i = 0; i < length && !m_record.truncated; ++i) {
+        unsigned int code = text[i];
+        if (code >= 0xD800 && code < 0xDC00 && i + 1 < length && text[i + 1] >= 0xDC00 && text[i + 1] < 0xE000) {
+            code = 0x10000 + ((code - 0xD800) << 10) + (text[++i] - 0xDC00);
+        }
+        char bytes[4];
+        size_t count;
+        if (code < 0x80) {
+            bytes[0] = static_cast<char>(code);
+            count = 1;
+        }
+        else if (code < 0x800) {
+            bytes[0] = static_cast<char>(0xC0 | (code >> 6));
+            bytes[1] = static_cast<char>(0x80 | (code & 0x3F));
+            count = 2;
+        }
+        else if (code < 0x10000) {
+            bytes[0] = static_cast<char>(0xE0 | (code >> 12));
+            bytes[1] = static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            bytes[2] = static_cast<char>(0x80 | (code & 0x3F));
+            count = 3;
+        }
+        else {
+            bytes[0] = static_cast<char>(0xF0 | (code >> 18));
+            bytes[1] = static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+            bytes[2] = static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            bytes[3] = static_cast<char>(0x80 | (code & 0x3F));
+            count = 4;
+        }
+        // Un carácter que no cabe entero no se parte.
+        if (count > LogRecord::kTextBytes - m_record.length) {
+            m_record.truncated = 1;
+            break;
+        }
+        append(bytes, count);
+    }
+}
+
+void LogStream::appendSigned(long long value) {
+    char buffer[24];
+    const std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    append(buffer, static_cast<size_t>(result.ptr - buffer));
+}
+
+void LogStream::appendUnsigned(unsigned long long value) {
+    char buffer[24];
+    const std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    append(buffer, static_cast<size_t>(result.ptr - buffer));
+}
+
+// ==== Logger ====
+
+Logger::Logger() {
+    LARGE_INTEGER frequency, now;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&now);
+    m_start = static_cast<uint64_t>(now.QuadPart);
+    m_secondsPerTick = 1.0 / static_cast<double>(frequency.QuadPart);
+    m_recent.reserve(kRecentLines);
+    m_sinks.push_back(SinkEntry{ debuggerSink, nullptr });
+    s_state.store(LOGGER_ALIVE, std::memory_order_release);
+    m_thread = std::thread(&Logger::run, this);
+}
+
+Logger::~Logger() {
+    m_stopping.store(true);
+    m_wake.notify_one();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    // Lo que llegue a partir de aquí va directo al depurador.
+    s_state.store(LOGGER_DESTROYED, std::memory_order_release);
+    flush();
+    std::lock_guard<std::mutex> lock(m_drainMutex);
+    if (m_file) {
+        fclose(m_file);
+        m_file = nullptr;
+    }
+}
+
+Logger& Logger::getDefault() {
+    static Logger s_logger;
+    return s_logger;
+}
+
+bool Logger::setCategoryLevel(const char* category, uint8_t level) {
+    std::lock_guard<std::mutex> lock(s_categoryMutex);
+    const unsigned int count = s_categoryCount.load(std::memory_order_relaxed);
+    for (unsigned int i = 0; i < count; ++i) {
+        if (strcmp(s_categories[i].name, category) == 0) {
+            s_categories[i].level.store(level, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    if (count == kMaxCategories || strlen(category) >= kCategoryBytes) {
+        return false;
+    }
+    strcpy_s(s_categories[count].name, category);
+    s_categories[count].level.store(level, std::memory_order_relaxed);
+    s_categoryCount.store(count + 1, std::memory_order_release);
+    return true;
+}
+
+uint8_t Logger::categoryLevel(const char* category) {
+    const unsigned int count = s_categoryCount.load(std::memory_order_acquire);
+    for (unsigned int i = 0; i < count; ++i) {
+        if (strcmp(s_categories[i].name, category) == 0) {
+            return s_categories[i].level.load(std::memory_order_relaxed);
+        }
+    }
+    return s_level.load(std::memory_order_relaxed);
+}
+
+bool Logger::parseLevel(const char* name, uint8_t& outLevel) {
+    for (uint8_t level = 0; level < LOG_LEVEL_COUNT; ++level) {
+        if (_stricmp(name, kLevelNames[level]) == 0) {
+            outLevel = level;
+            return true;
+        }
+    }
+    if (_stricmp(name, "warning") == 0) {
+        outLevel = LOG_LEVEL_WARNING;
+        return true;
+    }
+    return false;
+}
+
+const char* Logger::getLevelName(uint8_t level) {
+    return level < LOG_LEVEL_COUNT ? kLevelNames[level] : "?";
+}
+
+void Logger::submit(const LogRecord& record) {
+    if (s_state.load(std::memory_order_acquire) == LOGGER_DESTROYED) {
+        char line[LogRecord::kTextBytes + 1];
+        recordText(record, line);
+        debuggerSink(record, line, nullptr);
+        return;
+    }
+    Logger& logger = getDefault();
+    if (!logger.m_rings.Push(record)) {
+        logger.m_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (record.level == LOG_LEVEL_ERROR) {
+        logger.m_urgent.store(true, std::memory_order_release);
+        logger.m_wake.notify_one();
+    }
+}
+
+void Logger::flush() {
+    std::lock_guard<std::mutex> lock(m_drainMutex);
+    drain();
+}
+
+bool Logger::openFile(const std::string& path) {
+    FILE* file = nullptr;
+    if (fopen_s(&file, path.c_str(), "w") != 0 || !file) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(m_drainMutex);
+    if (m_file) {
+        fclose(m_file);
+    }
+    m_file = file;
+    return true;
+}
+
+void Logger::addSink(Sink sink, void* user) {
+    std::lock_guard<std::mutex> lock(m_drainMutex);
+    m_sinks.push_back(SinkEntry{ sink, user });
+}
+
+void Logger::removeSink(Sink sink, void* user) {
+    std::lock_guard<std::mutex> lock(m_drainMutex);
+    m_sinks.erase(std::remove_if(m_sinks.begin(), m_sinks.end(), [sink, user](const SinkEntry& entry) {
+        return entry.sink == sink && entry.user == user;
+    }), m_sinks.end());
+}
+
+double Logger::toSeconds(uint64_t timestamp) const {
+    return static_cast<double>(static_cast<int64_t>(timestamp - m_start)) * m_secondsPerTick;
+}
+
+void Logger::run() {
+    while (!m_stopping.load()) {
+        {
+            std::unique_lock<std::mutex> lock(m_wakeMutex);
+            m_wake.wait_for(lock, std::chrono::milliseconds(kFlushIntervalMs), [this]() {
+                return m_stopping.load() || m_urgent.load(std::memory_order_acquire);
+            });
+        }
+        m_urgent.store(false, std::memory_order_relaxed);
+        flush();
+    }
+}
+
+void Logger::drain() {
+    m_pending.clear();
+    m_rings.Drain([this](LogRecord& record) { m_pending.push_back(record); });
+    // Cada anillo ya está en orden; entre hilos manda la marca de tiempo.
+    std::stable_sort(m_pending.begin(), m_pending.end(), [](const LogRecord& a, const LogRecord& b) {
+        return a.timestamp < b.timestamp;
+    });
+    for (const LogRecord& record : m_pending) {
+        write(record);
+    }
+
+    const unsigned long long dropped = m_dropped.load(std::memory_order_relaxed);
+    if (dropped != m_reportedDrops) {
+        LogRecord notice = {};
+        LARGE_INTEGER now;
+        QueryPerformanceCounter(&now);
+        notice.timestamp = static_cast<uint64_t>(now.QuadPart);
+        notice.threadId = GetCurrentThreadId();
+        notice.level = LOG_LEVEL_ERROR;
+        notice.category = "Logger";
+        const int length = snprintf(notice.text, LogRecord::kTextBytes, "ERROR : Logger::drain : %llu messages dropped (ring full)",
+            dropped - m_reportedDrops);
+        notice.length = static_cast<uint16_t>((std::min)(length, static_cast<int>(LogRecord::kTextBytes) - 1));
+        m_reportedDrops = dropped;
+        write(notice);
+    }
+    if (m_file) {
+        fflush(m_file);
+    }
+}
+
+void Logger::write(const LogRecord& record) {
+    char line[LogRecord::kTextBytes + 1];
+    recordText(record, line);
+    for (const SinkEntry& entry : m_sinks) {
+        entry.sink(record, line, entry.user);
+    }
+    if (m_file) {
+        fprintf(m_file, "[%10.3f][%5u][%-5s] %s%s\n", toSeconds(record.timestamp), record.threadId,
+            getLevelName(record.level), line, record.truncated ? "..." : "");
+    }
+
+    std::lock_guard<std::mutex> lock(m_recentMutex);
+    if (m_recent.size() < kRecentLines) {
+        m_recent.push_back(Recent{ record.level, line });
+    }
+    else {
+        m_recent[m_recentFirst].level = record.level;
+        m_recent[m_recentFirst].line = line;
+        m_recentFirst = (m_recentFirst + 1) % kRecentLines;
+    }
+    m_recentVersion.fetch_add(1, std::memory_order_relaxed);
+}
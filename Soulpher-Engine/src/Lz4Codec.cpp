@@ -0,0 +1,214 @@
+﻿/**
+ * @file Lz4Codec.cpp
+ * @brief Búsqueda de coincidencias (rápida y por cadenas de hash) y decodificación LZ4.
+ */
+
+#include "Lz4Codec.h"
+#include <cstring>
+
+namespace {
+    const size_t kMinMatch = 4;
+    /// Los últimos 5 bytes siempre son literales.
+    const size_t kLastLiterals = 5;
+    /// Una coincidencia no empieza en los últimos 12 bytes.
+    const size_t kMatchLimit = 12;
+    const size_t kMaxOffset = 65535;
+    const unsigned int kHashBits = 16;
+    const unsigned int kWindow = 1u << 16;
+    /// Candidatas revisadas por posición en el nivel alto.
+    const unsigned int kMaxAttempts = 256;
+    const uint32_t kNone = 0xFFFFFFFFu;
+
+    uint32_t read32(const unsigned char* p) {
+        uint32_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    uint32_t hash4(const unsigned char* p) {
+        return (read32(p) * 2654435761u) >> (32 - kHashBits);
+    }
+
+    /// Salida con comprobación de capacidad.
+    struct Writer {
+        unsigned char* data;
+        size_t capacity;
+        size_t size;
+
+        bool byte(unsigned char value) {
+            if (size >= capacity) return false;
+            data[size++] = value;
+            return true;
+        }
+        bool bytes(const unsigned char* source, size_t count) {
+            if (count > capacity - size) return false;
+            std::memcpy(data + size, source, count);
+            size += count;
+            return true;
+        }
+        /// Resto de una longitud que no cupo en los 4 bits del token.
+        bool length(size_t value) {
+            for (; value >= 255; value -= 255) {
+                if (!byte(255)) return false;
+            }
+            return byte(static_cast<unsigned char>(value));
+        }
+    };
+
+    /// Secuencia: literales `[anchor, position)` y, si `match > 0`, la coincidencia.
+    bool emit(Writer& out, const unsigned char* source, size_t anchor, size_t position,
+        size_t offset, size_t match) {
+        const size_t literals = position - anchor;
+        const size_t extra = match > 0 ? match - kMinMatch : 0;
+        const unsigned char token = static_cast<unsigned char>(
+            ((literals < 15 ? literals : 15) << 4) | (match > 0 ? (extra < 15 ? extra : 15) : 0));
+        if (!out.byte(token) ||
+            (literals >= 15 && !out.length(literals - 15)) ||
+            !out.bytes(source + anchor, literals)) {
+            return false;
+        }
+        if (match == 0) {
+            return true;
+        }
+        return out.byte(static_cast<unsigned char>(offset & 0xFF)) &&
+            out.byte(static_cast<unsigned char>(offset >> 8)) &&
+            (extra < 15 || out.length(extra - 15));
+    }
+
+    /// Bytes iguales entre `a` y `b`, sin pasar de `end`.
+    size_t matchLength(const unsigned char* source, size_t a, size_t b, size_t end) {
+        size_t length = 0;
+        while (b + length < end && source[a + length] == source[b + length]) {
+            ++length;
+        }
+        return length;
+    }
+}
+
+size_t Lz4Codec::compress(const unsigned char* source, size_t sourceSize,
+    unsigned char* destination, size_t capacity, bool high) {
+    Writer out = { destination, capacity, 0 };
+    size_t anchor = 0;
+
+    if (sourceSize > kMatchLimit) {
+        const size_t limit = sourceSize - kMatchLimit;
+        const size_t matchEnd = sourceSize - kLastLiterals;
+        std::vector<uint32_t> head(size_t(1) << kHashBits, kNone);
+        std::vector<uint32_t> chain(high ? kWindow : 0, kNone);
+        size_t inserted = 0; // siguiente posición a añadir a las tablas
+
+        auto insert = [&](size_t position) {
+            const uint32_t h = hash4(source + position);
+            if (high) {
+                chain[position & (kWindow - 1)] = head[h];
+            }
+            head[h] = static_cast<uint32_t>(position);
+        };
+
+        size_t position = 0;
+        while (position < limit) {
+            size_t bestLength = 0, bestOffset = 0;
+            uint32_t candidate = head[hash4(source + position)];
+            if (high) {
+                while (inserted < position) insert(inserted++);
+                candidate = head[hash4(source + position)];
+                for (unsigned int attempt = 0; attempt < kMaxAttempts && candidate != kNone &&
+                    position - candidate <= kMaxOffset; ++attempt) {
+                    const size_t length = matchLength(source, candidate, position, matchEnd);
+                    if (length > bestLength) {
+                        bestLength = length;
+                        bestOffset = position - candidate;
+                    }
+                    const uint32_t next = chain[candidate & (kWindow - 1)];
+                    if (next == kNone || next >= candidate) break; // la ventana dio la vuelta
+                    candidate = next;
+                }
+            }
+            else {
+                if (candidate != kNone && position - candidate <= kMaxOffset) {
+                    bestLength = matchLength(source, candidate, position, matchEnd);
+                    bestOffset = position - candidate;
+                }
+                insert(position);
+            }
+
+            if (bestLength < kMinMatch) {
+                ++position;
+                continue;
+            }
+            if (!emit(out, source, anchor, position, bestOffset, bestLength)) {
+                return 0;
+            }
+            position += bestLength;
+            anchor = position;
+            if (!high && position - 2 < limit) {
+                insert(position - 2); // deja una referencia dentro de lo que se saltó
+            }
+        }
+    }
+    // Última secuencia: solo literales.
+    if (!emit(out, source, anchor, sourceSize, 0, 0)) {
+        return 0;
+    }
+    return out.size;
+}
+
+bool Lz4Codec::decompress(const unsigned char* source, size_t sourceSize,
+    unsigned char* destination, size_t destinationSize) {
+    size_t in = 0, out = 0;
+    auto length = [&](size_t& value) {
+        unsigned char extra;
+        do {
+            if (in >= sourceSize) return false;
+            extra = source[in++];
+            value += extra;
+        } while (extra == 255);
+        return true;
+    };
+
+    for (;;) {
+        if (in >= sourceSize) {
+            return false;
+        }
+        const unsigned char token = source[in++];
+        size_t literals = token >> 4;
+        if (literals == 15 && !length(literals)) {
+            return false;
+        }
+        if (literals > sourceSize - in || literals > destinationSize - out) {
+            return false;
+        }
+        std::memcpy(destination + out, source + in, literals);
+        in += literals;
+        out += literals;
+        if (in == sourceSize) {
+            return out == destinationSize; // la última secuencia no tiene coincidencia
+        }
+
+        if (sourceSize - in < 2) {
+            return false;
+        }
+        const size_t offset = source[in] | (size_t(source[in + 1]) << 8);
+        in += 2;
+        size_t match = token & 15;
+        if ((match == 15 && !length(match)) || offset == 0 || offset > out) {
+            return false;
+        }
+        match += kMinMatch;
+        if (match > destinationSize - out) {
+            return false;
+        }
+        unsigned char* target = destination + out;
+        const unsigned char* from = target - offset;
+        if (offset >= match) {
+            std::memcpy(target, from, match);
+        }
+        else {
+            // Solapada (p. ej. un byte repetido): hay que copiar en orden.
+            for (size_t i = 0; i < match; ++i) {
+                target[i] = from[i];
+            }
+        }
+        out += match;
+    }
+}
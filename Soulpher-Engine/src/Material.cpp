@@ -0,0 +1,174 @@
+﻿/**
+ * @file Material.cpp
+ * @brief Implementación del registro de materiales.
+ */
+
+#include "Material.h"
+#include "Device.h"
+
+HRESULT MaterialLibrary::init(Device& device) {
+    if (!device.m_device) {
+        ERROR("MaterialLibrary", "init", "Device is null.");
+        return E_POINTER;
+    }
+    destroy();
+    HRESULT hr = m_opaqueBlend.init(device, false);
+    if (SUCCEEDED(hr)) { hr = m_alphaBlend.init(device); }
+    if (SUCCEEDED(hr)) { hr = m_rasterizer.init(device); }
+    if (SUCCEEDED(hr)) { hr = m_twoSidedRasterizer.init(device, 0, 0.0f, D3D11_CULL_NONE); }
+    if (SUCCEEDED(hr)) { hr = m_sampler.init(device); }
+    if (FAILED(hr)) {
+        ERROR("MaterialLibrary", "init", "Failed to create the material states");
+        destroy();
+        return hr;
+    }
+    m_device = &device;
+    // El identificador 0 es "sin material".
+    m_materials.resize(1);
+    m_keys.resize(1);
+
+    m_default = get(MaterialDesc());
+    if (m_default.isNull()) {
+        destroy();
+        return E_FAIL;
+    }
+    return S_OK;
+}
+
+MaterialLibrary::Key MaterialLibrary::makeKey(const MaterialDesc& desc) {
+    Key key;
+    key.texture = desc.diffuse.get();
+    key.color = desc.diffuseColor;
+    key.shader = desc.shader;
+    key.blendMode = desc.blendMode;
+    // El umbral solo cuenta con alpha test: el resto no lo lee.
+    key.alphaCutoff = desc.blendMode == MATERIAL_ALPHA_TESTED ? desc.alphaCutoff : 0.0f;
+    key.roughness = desc.roughness;
+    key.twoSided = desc.twoSided;
+    return key;
+}
+
+/**
+ * @details
+ * Un material liberado conserva su entrada hasta @ref releaseUnused; si entretanto se
+ * pide la misma descripción, se crea otro con el mismo identificador.
+ */
+MaterialHandle MaterialLibrary::get(const MaterialDesc& desc) {
+    if (!m_device) {
+        return MaterialHandle();
+    }
+    const Key key = makeKey(desc);
+    auto found = m_lookup.find(key);
+    if (found != m_lookup.end()) {
+        MaterialHandle existing = m_materials[found->second].lock();
+        if (!existing.isNull()) {
+            return existing;
+        }
+    }
+
+    Material::ID id = Material::kNoMaterial;
+    if (found != m_lookup.end()) {
+        id = found->second;
+    }
+    else if (!m_freeIDs.empty()) {
+        id = m_freeIDs.back();
+        m_freeIDs.pop_back();
+    }
+    else if (m_materials.size() <= kMaxMaterials) {
+        id = static_cast<Material::ID>(m_materials.size());
+        m_materials.emplace_back();
+        m_keys.emplace_back();
+    }
+    else {
+        ERROR("MaterialLibrary", "get", "Out of material IDs");
+        return MaterialHandle();
+    }
+
+    CBMaterial values;
+    values.vDiffuseColor = desc.diffuseColor;
+    values.vMaterialParams = XMFLOAT4(key.alphaCutoff, key.roughness, 0.0f, 0.0f);
+    EU::TSharedPointer<Buffer> constants = constantsFor(values);
+    if (constants.isNull()) {
+        if (found == m_lookup.end()) {
+            m_freeIDs.push_back(id);
+        }
+        return MaterialHandle();
+    }
+
+    MaterialHandle material = EU::MakeShared<Material>();
+    material->m_desc = desc;
+    material->m_id = id;
+    material->m_constants = constants;
+    material->m_blendState = desc.blendMode == MATERIAL_BLENDED ? &m_alphaBlend : &m_opaqueBlend;
+    material->m_rasterizer = desc.twoSided ? &m_twoSidedRasterizer : &m_rasterizer;
+    material->m_sampler = &m_sampler;
+    m_materials[id] = material;
+    m_keys[id] = key;
+    m_lookup[key] = id;
+    return material;
+}
+
+EU::TSharedPointer<Buffer> MaterialLibrary::constantsFor(const CBMaterial& values) {
+    for (Constants& entry : m_constants) {
+        if (memcmp(&entry.values, &values, sizeof(CBMaterial)) == 0) {
+            EU::TSharedPointer<Buffer> buffer = entry.buffer.lock();
+            if (!buffer.isNull()) {
+                return buffer;
+            }
+        }
+    }
+    EU::TSharedPointer<Buffer> buffer(new Buffer(), ReleaseBuffer());
+    HRESULT hr = buffer->create(*m_device, BUFFER_IMMUTABLE, D3D11_BIND_CONSTANT_BUFFER,
+        sizeof(CBMaterial), sizeof(CBMaterial), &values);
+    if (FAILED(hr)) {
+        ERROR("MaterialLibrary", "constantsFor", "Failed to create the material constant buffer");
+        return EU::TSharedPointer<Buffer>();
+    }
+    Constants entry;
+    entry.values = values;
+    entry.buffer = buffer;
+    m_constants.push_back(entry);
+    return buffer;
+}
+
+unsigned int MaterialLibrary::releaseUnused() {
+    unsigned int released = 0;
+    for (size_t id = 1; id < m_materials.size(); ++id) {
+        if (m_materials[id].expired() && m_lookup.erase(m_keys[id]) > 0) {
+            m_materials[id] = EU::TWeakPointer<Material>();
+            m_freeIDs.push_back(static_cast<Material::ID>(id));
+            ++released;
+        }
+    }
+    for (size_t i = 0; i < m_constants.size();) {
+        if (m_constants[i].buffer.expired()) {
+            m_constants[i] = m_constants.back();
+            m_constants.pop_back();
+        }
+        else {
+            ++i;
+        }
+    }
+    return released;
+}
+
+void MaterialLibrary::destroy() {
+    m_default = MaterialHandle();
+    m_lookup.clear();
+    m_materials.clear();
+    m_keys.clear();
+    m_freeIDs.clear();
+    for (Constants& entry : m_constants) {
+        EU::TSharedPointer<Buffer> buffer = entry.buffer.lock();
+        if (!buffer.isNull()) {
+            buffer->destroy();
+        }
+    }
+    m_constants.clear();
+    m_opaqueBlend.destroy();
+    m_alphaBlend.destroy();
+    m_rasterizer.destroy();
+    m_twoSidedRasterizer.destroy();
+    m_sampler.destroy();
+    m_device = nullptr;
+}
@@ -0,0 +1,181 @@
+﻿/**
+ * @file MemoryTracker.cpp
+ * @brief Contadores de reservas y, con `PROFILE`, sustitución del `new`/`delete` global.
+ */
+
+#include "MemoryTracker.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+    // Estado con inicialización a cero en la carga (sin constructores): `new` puede
+    // llamarse antes que cualquier constructor estático.
+    std::atomic<unsigned long long> s_allocations[MEMORY_TAG_COUNT];
+    std::atomic<unsigned long long> s_bytes[MEMORY_TAG_COUNT];
+    std::atomic<long long> s_liveBytes[MEMORY_TAG_COUNT];
+    std::atomic<unsigned long long> s_violations;
+    std::atomic<bool> s_breakOnViolation;
+
+    // Último frame cerrado (solo el hilo principal los escribe y los lee).
+    MemoryTracker::TagStats s_frameStats[MEMORY_TAG_COUNT];
+    unsigned long long s_frameAllocations = 0;
+    unsigned long long s_peakFrameAllocations = 0;
+
+    thread_local MemoryTag t_tag = MEMORY_TAG_UNTAGGED;  // Etiqueta del hilo actual.
+    thread_local unsigned int t_noAllocDepth = 0;        // `NoAllocScope` abiertos.
+
+    const char* const kTagNames[MEMORY_TAG_COUNT] = { "Untagged", "Render", "ECS", "Loader", "UI" };
+}
+
+MemoryTracker::TagScope::TagScope(MemoryTag tag) : m_previous(t_tag) {
+    t_tag = tag;
+}
+
+MemoryTracker::TagScope::~TagScope() {
+    t_tag = m_previous;
+}
+
+MemoryTracker::NoAllocScope::NoAllocScope() {
+    ++t_noAllocDepth;
+}
+
+MemoryTracker::NoAllocScope::~NoAllocScope() {
+    --t_noAllocDepth;
+}
+
+void MemoryTracker::beginFrame() {
+    unsigned long long total = 0;
+    for (int tag = 0; tag < MEMORY_TAG_COUNT; ++tag) {
+        TagStats& stats = s_frameStats[tag];
+        stats.allocations = s_allocations[tag].exchange(0, std::memory_order_relaxed);
+        stats.bytes = s_bytes[tag].exchange(0, std::memory_order_relaxed);
+        stats.liveBytes = s_liveBytes[tag].load(std::memory_order_relaxed);
+        total += stats.allocations;
+    }
+    s_frameAllocations = total;
+    s_peakFrameAllocations = (std::max)(s_peakFrameAllocations, total);
+}
+
+MemoryTracker::TagStats MemoryTracker::getFrameStats(MemoryTag tag) {
+    return s_frameStats[tag];
+}
+
+unsigned long long MemoryTracker::getFrameAllocations() {
+    return s_frameAllocations;
+}
+
+unsigned long long MemoryTracker::getPeakFrameAllocations() {
+    return s_peakFrameAllocations;
+}
+
+unsigned long long MemoryTracker::getViolationCount() {
+    return s_violations.load(std::memory_order_relaxed);
+}
+
+void MemoryTracker::setBreakOnViolation(bool enabled) {
+    s_breakOnViolation.store(enabled, std::memory_order_relaxed);
+}
+
+bool MemoryTracker::getBreakOnViolation() {
+    return s_breakOnViolation.load(std::memory_order_relaxed);
+}
+
+const char* MemoryTracker::getTagName(MemoryTag tag) {
+    return tag >= 0 && tag < MEMORY_TAG_COUNT ? kTagNames[tag] : "?";
+}
+
+bool MemoryTracker::isEnabled() {
+#if defined(PROFILE)
+    return true;
+#else
+    return false;
+#endif
+}
+
+#if defined(PROFILE)
+namespace {
+    /// Delante de cada reserva; 16 bytes para no perder la alineación de `malloc`.
+    struct alignas(16) AllocationHeader {
+        size_t bytes;
+        MemoryTag tag;
+    };
+
+    void* trackedAllocate(size_t bytes) {
+        AllocationHeader* header = static_cast<AllocationHeader*>(malloc(sizeof(AllocationHeader) + bytes));
+        if (!header) {
+            return nullptr;
+        }
+        const MemoryTag tag = t_tag;
+        header->bytes = bytes;
+        header->tag = tag;
+        s_allocations[tag].fetch_add(1, std::memory_order_relaxed);
+        s_bytes[tag].fetch_add(bytes, std::memory_order_relaxed);
+        s_liveBytes[tag].fetch_add(static_cast<long long>(bytes), std::memory_order_relaxed);
+        if (t_noAllocDepth > 0) {
+            s_violations.fetch_add(1, std::memory_order_relaxed);
+            if (s_breakOnViolation.load(std::memory_order_relaxed) && IsDebuggerPresent()) {
+                __debugbreak();
+            }
+        }
+        return header + 1;
+    }
+
+    void trackedRelease(void* ptr) {
+        if (!ptr) {
+            return;
+        }
+        AllocationHeader* header = static_cast<AllocationHeader*>(ptr) - 1;
+        s_liveBytes[header->tag].fetch_sub(static_cast<long long>(header->bytes), std::memory_order_relaxed);
+        free(header);
+    }
+}
+
+void* operator new(size_t bytes) {
+    void* ptr = trackedAllocate(bytes);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new[](size_t bytes) {
+    void* ptr = trackedAllocate(bytes);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new(size_t bytes, const std::nothrow_t&) noexcept {
+    return trackedAllocate(bytes);
+}
+
+void* operator new[](size_t bytes, const std::nothrow_t&) noexcept {
+    return trackedAllocate(bytes);
+}
+
+void operator delete(void* ptr) noexcept {
+    trackedRelease(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    trackedRelease(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    trackedRelease(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    trackedRelease(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+    trackedRelease(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+    trackedRelease(ptr);
+}
+#endif
@@ -0,0 +1,393 @@
+﻿/**
+ * @file MeshAsset.cpp
+ * @brief Implementación de la geometría compartible `MeshAsset`.
+ */
+
+#include "MeshAsset.h"
+#include "Device.h"
+#include "DeviceContext.h"
+#include "MeshletBuilder.h"
+
+const float MeshAsset::kLODHysteresis = 0.15f;
+const float MeshAsset::kSkinnedBoundsMargin = 0.5f;
+VertexFormat MeshAsset::s_vertexFormat = VertexFormat::compact();
+
+/**
+ * @brief Concatena las submallas en páginas de buffers compartidos.
+ *
+ * @details
+ * Cada página junta los vértices (stream completo y de posiciones) e índices de
+ * submallas consecutivas, hasta @ref kMaxPageBytes. Los índices se guardan relativos
+ * a cada submalla y se dibujan con `BaseVertexLocation`, así una página se sube con
+ * 16 bits si ninguna de sus submallas pasa de 65 535 vértices.
+ *
+ * @note Una submalla vacía o con índices fuera de rango se registra y se omite;
+ * `m_meshes` queda alineado con `m_submeshes`. Si falla la creación de una página, el
+ * asset entero queda vacío (los rangos ya no tendrían buffer).
+ *
+ * Con `pool`, si todo cabe en una página de 16 bits, la página se sube como un
+ * bloque del pool en lugar de crear buffers propios.
+ *
+ * Las submallas sin meshlets (geometría procedural) se parten aquí si tienen más de
+ * un meshlet de triángulos; las importadas ya los traen de la caché.
+ *
+ * Con posiciones cuantizadas, todas las submallas comparten una AABB (la del asset,
+ * o la del nivel 0 si es un LOD), así basta una matriz de descuantizado por actor.
+ */
+HRESULT MeshAsset::init(Device& device, const std::vector<MeshComponent>& meshes, bool keepCpuData,
+    GeometryPool* pool) {
+    m_keepCpuData = keepCpuData;
+    m_pool = pool;
+    m_meshes.reserve(meshes.size());
+    m_submeshes.reserve(meshes.size());
+    if (!m_hasDecode) {
+        m_decode = VertexFormat::computeDecode(meshes);
+    }
+
+    HRESULT result = S_OK;
+    XMFLOAT2 uvMin(0.0f, 0.0f), uvMax(0.0f, 0.0f);
+    bool hasUV = false;
+    const unsigned int stride = s_vertexFormat.getStride();
+    std::vector<unsigned char> encoded, vertices, positions;
+    std::vector<unsigned int> indices;
+    std::vector<uint32_t> lightmapUVs;
+    bool narrow = true;
+    MeshComponent partitioned;
+    for (const auto& source : meshes) {
+        m_hasLightmapUV = m_hasLightmapUV ||
+            (!source.m_lightmapUV.empty() && source.m_lightmapUV.size() == source.m_vertex.size());
+    }
+    for (const auto& source : meshes) {
+        // Geometría que no pasó por el importador (procedural): se parte aquí.
+        const bool needsMeshlets = !m_skinned && source.m_meshlets.empty() &&
+            source.m_index.size() / 3 > MeshletBuilder::kMaxTriangles;
+        if (needsMeshlets) {
+            partitioned = source;
+            MeshletBuilder::build(partitioned);
+        }
+        const MeshComponent& mesh = needsMeshlets ? partitioned : source;
+        const size_t vertexCount = mesh.m_vertex.size();
+        bool valid = vertexCount > 0 && !mesh.m_index.empty();
+        for (size_t i = 0; valid && i < mesh.m_index.size(); ++i) {
+            valid = mesh.m_index[i] < vertexCount;
+        }
+        if (!valid) {
+            ERROR("MeshAsset", "init", ("Empty submesh or index out of range: " + mesh.m_name.str()).c_str());
+            result = E_INVALIDARG;
+            continue;
+        }
+
+        // Página llena: se sube y se empieza otra.
+        if (!indices.empty() &&
+            (vertices.size() + vertexCount * stride > kMaxPageBytes ||
+             (indices.size() + mesh.m_index.size()) * sizeof(unsigned int) > kMaxPageBytes)) {
+            HRESULT hr = addPage(device, vertices, positions, indices, lightmapUVs, narrow);
+            if (FAILED(hr)) {
+                destroy();
+                m_meshes.clear();
+                return hr;
+            }
+            narrow = true;
+        }
+
+        SubmeshRange range;
+        range.page = static_cast<unsigned int>(m_pages.size());
+        range.startIndex = static_cast<unsigned int>(indices.size());
+        range.indexCount = static_cast<unsigned int>(mesh.m_index.size());
+        range.baseVertex = static_cast<int>(vertices.size() / stride);
+        range.vertexCount = static_cast<unsigned int>(vertexCount);
+        s_vertexFormat.encode(mesh.m_vertex, m_decode, encoded);
+        vertices.insert(vertices.end(), encoded.begin(), encoded.end());
+        // Stream compacto de posiciones para los pases de solo profundidad.
+        s_vertexFormat.encodePositions(mesh.m_vertex, m_decode, encoded);
+        positions.insert(positions.end(), encoded.begin(), encoded.end());
+        indices.insert(indices.end(), mesh.m_index.begin(), mesh.m_index.end());
+        narrow = narrow && vertexCount <= 0xFFFF;
+        if (m_hasLightmapUV) {
+            // R16G16_UNORM: 1/65 535 de precisión sobra para cualquier atlas de D3D11.
+            const bool hasUV2 = mesh.m_lightmapUV.size() == vertexCount;
+            for (size_t v = 0; v < vertexCount; ++v) {
+                const XMFLOAT2 uv = hasUV2 ? mesh.m_lightmapUV[v] : XMFLOAT2(0.0f, 0.0f);
+                const uint32_t u16 = static_cast<uint32_t>((std::min)((std::max)(uv.x, 0.0f), 1.0f) * 65535.0f + 0.5f);
+                const uint32_t v16 = static_cast<uint32_t>((std::min)((std::max)(uv.y, 0.0f), 1.0f) * 65535.0f + 0.5f);
+                lightmapUVs.push_back(u16 | v16 << 16);
+            }
+        }
+
+        m_submeshes.push_back(range);
+        m_meshes.push_back(mesh);
+
+        // Extensión de las UV (densidad de texeles para el streaming de texturas).
+        for (const SimpleVertex& v : mesh.m_vertex) {
+            if (!hasUV) {
+                uvMin = uvMax = v.Tex;
+                hasUV = true;
+            }
+            uvMin = XMFLOAT2(std::min(uvMin.x, v.Tex.x), std::min(uvMin.y, v.Tex.y));
+            uvMax = XMFLOAT2(std::max(uvMax.x, v.Tex.x), std::max(uvMax.y, v.Tex.y));
+        }
+
+        // AABB del asset = unión de las submallas (para el culling por actor).
+        MeshComponent& added = m_meshes.back();
+        if (m_skinned) {
+            added.m_meshlets.clear();
+        }
+        if (!added.m_hasBounds) {
+            added.computeBounds();
+        }
+        if (added.m_hasBounds) {
+            if (!m_hasBounds) {
+                m_boundsMin = added.m_boundsMin;
+                m_boundsMax = added.m_boundsMax;
+                m_hasBounds = true;
+            }
+            else {
+                m_boundsMin = XMFLOAT3(std::min(m_boundsMin.x, added.m_boundsMin.x),
+                    std::min(m_boundsMin.y, added.m_boundsMin.y),
+                    std::min(m_boundsMin.z, added.m_boundsMin.z));
+                m_boundsMax = XMFLOAT3(std::max(m_boundsMax.x, added.m_boundsMax.x),
+                    std::max(m_boundsMax.y, added.m_boundsMax.y),
+                    std::max(m_boundsMax.z, added.m_boundsMax.z));
+            }
+        }
+        if (!keepCpuData) {
+            std::vector<SimpleVertex>().swap(added.m_vertex);
+            std::vector<unsigned int>().swap(added.m_index);
+            std::vector<SkinVertex>().swap(added.m_skin);
+            std::vector<MorphTarget>().swap(added.m_morphs);
+            std::vector<XMFLOAT2>().swap(added.m_lightmapUV);
+        }
+    }
+    const bool poolable = m_pool && !m_skinned && !m_hasLightmapUV && m_pool->isReady() && m_pages.empty() && narrow &&
+        m_pool->getVertexStride() == stride && m_pool->getPositionStride() == s_vertexFormat.getPositionStride();
+    if (!indices.empty() && poolable) {
+        m_allocation = m_pool->allocate(vertices.data(), positions.data(),
+            static_cast<unsigned int>(vertices.size() / stride), indices.data(), static_cast<unsigned int>(indices.size()));
+    }
+    if (!indices.empty() && m_allocation == GeometryPool::kNullHandle) {
+        HRESULT hr = addPage(device, vertices, positions, indices, lightmapUVs, narrow);
+        if (FAILED(hr)) {
+            destroy();
+            m_meshes.clear();
+            return hr;
+        }
+    }
+    if (hasUV) {
+        m_uvSpan = std::max(std::max(uvMax.x - uvMin.x, uvMax.y - uvMin.y), 1.0f / 64.0f);
+    }
+    return result;
+}
+
+/**
+ * @details La AABB de cuantización se calcula aquí (y no en @ref init) para ampliarla
+ * antes de codificar; la del asset se iguala a ella al terminar.
+ */
+HRESULT MeshAsset::initSkinned(Device& device, const std::vector<MeshComponent>& meshes) {
+    m_skinned = true;
+    m_decode = VertexFormat::computeDecode(meshes);
+    // Más el mayor delta de blend shape: una forma a peso 1 no se sale de la caja.
+    float morphReach = 0.0f;
+    for (const MeshComponent& mesh : meshes) {
+        for (const MorphTarget& target : mesh.m_morphs) {
+            for (const XMFLOAT3& d : target.deltas) {
+                morphReach = (std::max)(morphReach, (std::max)(std::fabs(d.x), (std::max)(std::fabs(d.y), std::fabs(d.z))));
+            }
+        }
+    }
+    const float margin = kSkinnedBoundsMargin *
+        (std::max)(m_decode.scale.x, (std::max)(m_decode.scale.y, m_decode.scale.z)) + morphReach;
+    m_decode.scale = XMFLOAT3(m_decode.scale.x + margin, m_decode.scale.y + margin, m_decode.scale.z + margin);
+    m_hasDecode = true;
+
+    HRESULT hr = init(device, meshes, true, nullptr);
+    if (m_hasBounds) {
+        const XMFLOAT3& c = m_decode.offset;
+        const XMFLOAT3& e = m_decode.scale;
+        m_boundsMin = XMFLOAT3(c.x - e.x, c.y - e.y, c.z - e.z);
+        m_boundsMax = XMFLOAT3(c.x + e.x, c.y + e.y, c.z + e.z);
+    }
+    return hr;
+}
+
+/**
+ * @brief Sube una página y vacía los datos de CPU que la formaban.
+ */
+HRESULT MeshAsset::addPage(Device& device, std::vector<unsigned char>& vertices,
+    std::vector<unsigned char>& positions, std::vector<unsigned int>& indices,
+    std::vector<uint32_t>& lightmapUVs, bool narrow) {
+    GeometryPage page;
+    const unsigned int vertexCount = static_cast<unsigned int>(vertices.size() / s_vertexFormat.getStride());
+    HRESULT hr = m_skinned
+        ? page.vertices.initWritableVertices(device, vertices.data(), s_vertexFormat.getStride(), vertexCount)
+        : page.vertices.initVertices(device, vertices.data(), s_vertexFormat.getStride(), vertexCount);
+    if (FAILED(hr)) {
+        ERROR("MeshAsset", "addPage", "Failed to create new vertexBuffer");
+        return hr;
+    }
+    hr = page.indices.initIndices(device, indices.data(), static_cast<unsigned int>(indices.size()), narrow);
+    if (FAILED(hr)) {
+        ERROR("MeshAsset", "addPage", "Failed to create new indexBuffer");
+        page.vertices.destroy();
+        return hr;
+    }
+    hr = m_skinned
+        ? page.positions.initWritableVertices(device, positions.data(), s_vertexFormat.getPositionStride(), vertexCount)
+        : page.positions.initVertices(device, positions.data(), s_vertexFormat.getPositionStride(), vertexCount);
+    if (FAILED(hr)) {
+        ERROR("MeshAsset", "addPage", "Failed to create new position buffer");
+        page.vertices.destroy();
+        page.indices.destroy();
+        return hr;
+    }
+    if (!lightmapUVs.empty()) {
+        hr = page.lightmapUVs.initVertices(device, lightmapUVs.data(), sizeof(uint32_t), vertexCount);
+        if (FAILED(hr)) {
+            ERROR("MeshAsset", "addPage", "Failed to create new lightmap UV buffer");
+            page.vertices.destroy();
+            page.indices.destroy();
+            page.positions.destroy();
+            return hr;
+        }
+    }
+    m_pages.push_back(page);
+    vertices.clear();
+    positions.clear();
+    indices.clear();
+    lightmapUVs.clear();
+    return S_OK;
+}
+
+/**
+ * @brief Enlaza la página (VB en el slot 0 e IB) de una submalla.
+ */
+void MeshAsset::render(DeviceContext& deviceContext, unsigned int submesh) {
+    if (submesh >= getSubmeshCount()) {
+        ERROR("MeshAsset", "render", "Submesh index out of range");
+        return;
+    }
+    SubmeshDraw draw = getDraw(submesh);
+    draw.vertices->render(deviceContext, 0, 1);
+    draw.indices->render(deviceContext, 0, 1, false, draw.indices->getIndexFormat());
+}
+
+SubmeshDraw MeshAsset::getDraw(unsigned int submesh) {
+    const SubmeshRange& range = m_submeshes[submesh];
+    SubmeshDraw draw;
+    draw.startIndex = range.startIndex;
+    draw.indexCount = range.indexCount;
+    draw.baseVertex = range.baseVertex;
+    if (isPooled()) {
+        const GeometryPool::Range block = m_pool->getRange(m_allocation);
+        draw.vertices = &m_pool->getVertexBuffer();
+        draw.indices = &m_pool->getIndexBuffer();
+        draw.positions = &m_pool->getPositionBuffer();
+        draw.startIndex += block.startIndex;
+        draw.baseVertex += block.baseVertex;
+    }
+    else {
+        GeometryPage& page = m_pages[range.page];
+        draw.vertices = &page.vertices;
+        draw.indices = &page.indices;
+        draw.positions = &page.positions;
+        draw.lightmapUVs = m_hasLightmapUV ? &page.lightmapUVs : nullptr;
+    }
+    return draw;
+}
+
+/**
+ * @brief Libera todos los buffers, incluidos los de los niveles de detalle.
+ */
+void MeshAsset::destroy() {
+    for (GeometryPage& page : m_pages) {
+        page.vertices.destroy();
+        page.indices.destroy();
+        page.positions.destroy();
+        page.lightmapUVs.destroy();
+    }
+    m_pages.clear();
+    if (m_pool) {
+        m_pool->free(m_allocation); // Diferido: los paquetes del frame aún pueden usarlo.
+    }
+    m_allocation = GeometryPool::kNullHandle;
+    m_submeshes.clear();
+    m_hasBounds = false;
+    m_hasLightmapUV = false;
+
+    for (auto& lod : m_lods) { if (!lod.isNull()) lod->destroy(); }
+    m_lods.clear();
+    m_lodScreenSizes.clear();
+}
+
+/**
+ * @brief Crea los buffers del nuevo nivel y lo añade al final de la cadena.
+ */
+HRESULT MeshAsset::addLOD(Device& device, const std::vector<MeshComponent>& meshes, float screenSize) {
+    EU::TSharedPointer<MeshAsset> lod = EU::MakeShared<MeshAsset>();
+    lod->m_decode = m_decode;   // Misma cuantización: el actor no cambia de matriz al cambiar de nivel.
+    lod->m_hasDecode = true;
+    HRESULT hr = lod->init(device, meshes, m_keepCpuData, m_pool);
+    if (FAILED(hr) || lod->getSubmeshCount() != getSubmeshCount()) {
+        ERROR("MeshAsset", "addLOD", "LOD submeshes do not match level 0; LOD discarded");
+        lod->destroy();
+        return FAILED(hr) ? hr : E_INVALIDARG;
+    }
+    m_lods.push_back(lod);
+    m_lodScreenSizes.push_back(screenSize);
+    return S_OK;
+}
+
+/**
+ * @brief Libera las copias de CPU; los recuentos siguen valiendo para dibujar.
+ */
+void MeshAsset::releaseCpuData() {
+    for (MeshComponent& mesh : m_meshes) {
+        std::vector<SimpleVertex>().swap(mesh.m_vertex);
+        std::vector<unsigned int>().swap(mesh.m_index);
+        std::vector<SkinVertex>().swap(mesh.m_skin);
+        std::vector<MorphTarget>().swap(mesh.m_morphs);
+        std::vector<XMFLOAT2>().swap(mesh.m_lightmapUV);
+    }
+    m_keepCpuData = false;
+    for (auto& lod : m_lods) { if (!lod.isNull()) lod->releaseCpuData(); }
+}
+
+size_t MeshAsset::getCpuBytes() const {
+    size_t bytes = 0;
+    for (const MeshComponent& mesh : m_meshes) {
+        bytes += mesh.m_vertex.capacity() * sizeof(SimpleVertex) + mesh.m_index.capacity() * sizeof(unsigned int) +
+            mesh.m_skin.capacity() * sizeof(SkinVertex) + mesh.m_lightmapUV.capacity() * sizeof(XMFLOAT2);
+        for (const MorphTarget& target : mesh.m_morphs) {
+            bytes += target.vertices.capacity() * sizeof(unsigned int) + target.deltas.capacity() * sizeof(XMFLOAT3);
+        }
+    }
+    for (const auto& lod : m_lods) { if (!lod.isNull()) bytes += lod->getCpuBytes(); }
+    return bytes;
+}
+
+/**
+ * @brief Nivel `level` (0 = este asset), acotado al más simple disponible.
+ */
+MeshAsset& MeshAsset::getLOD(unsigned int level) {
+    if (level == 0 || m_lods.empty()) {
+        return *this;
+    }
+    level = (std::min)(level, static_cast<unsigned int>(m_lods.size()));
+    return *m_lods[level - 1];
+}
+
+/**
+ * @brief Avanza o retrocede desde el nivel actual solo si se supera el umbral con margen.
+ */
+unsigned int MeshAsset::selectLOD(float screenSize, unsigned int currentLevel) const {
+    unsigned int level = (std::min)(currentLevel, static_cast<unsigned int>(m_lods.size()));
+
+    // Más lejos: pasar al siguiente nivel cuando se queda claramente por debajo de su umbral.
+    while (level < m_lods.size() && screenSize < m_lodScreenSizes[level] * (1.0f - kLODHysteresis)) {
+        ++level;
+    }
+    // Más cerca: volver al anterior cuando se supera claramente el umbral del nivel actual.
+    while (level > 0 && screenSize > m_lodScreenSizes[level - 1] * (1.0f + kLODHysteresis)) {
+        --level;
+    }
+    return level;
+}
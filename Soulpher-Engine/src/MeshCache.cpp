@@ -0,0 +1,526 @@
+﻿/**
+ * @file MeshCache.cpp
+ * @brief Implementación de la caché `.smesh` (ver @ref MeshCache.h para la disposición).
+ */
+
+#include "MeshCache.h"
+#include "MeshCodec.h"
+#include "JobSystem.h"
+#include "VirtualFileSystem.h"
+#include <atomic>
+#include <cstring>
+
+namespace {
+    const uint32_t kMagic = 0x48534D53; // "SMSH"
+
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t vertexStride;     ///< `sizeof(SimpleVertex)` al escribir.
+        uint32_t levelCount;
+        uint64_t key;
+        uint32_t submeshCount;
+        uint32_t materialCount;
+        uint32_t vertexCount;
+        uint32_t indexCount;
+        uint32_t stringBytes;
+        uint32_t nameOffset;       ///< Nombre del modelo, en la tabla de cadenas.
+        uint32_t nameLength;
+        uint32_t meshletCount;
+        uint32_t lightmapUVCount;
+        uint64_t vertexBytes;      ///< Bytes de la sección de vértices (bloques de `MeshCodec`).
+        uint64_t indexBytes;
+        uint64_t lightmapUVBytes;
+        uint64_t levelsOffset;
+        uint64_t submeshesOffset;
+        uint64_t materialsOffset;
+        uint64_t stringsOffset;
+        uint64_t verticesOffset;
+        uint64_t indicesOffset;
+        uint64_t meshletsOffset;
+        uint64_t lightmapUVsOffset;
+    };
+
+    struct LevelEntry {
+        float screenSize;
+        uint32_t firstSubmesh;
+        uint32_t submeshCount;
+    };
+
+    struct SubmeshEntry {
+        uint32_t nameOffset;
+        uint32_t nameLength;
+        uint32_t firstVertex;
+        uint32_t vertexCount;
+        uint32_t firstIndex;
+        uint32_t indexCount;
+        XMFLOAT3 boundsMin;
+        XMFLOAT3 boundsMax;
+        XMFLOAT3 sphereCenter;
+        float sphereRadius;
+        uint32_t firstMeshlet;
+        uint32_t meshletCount;
+        uint32_t firstLightmapUV;
+        uint32_t lightmapUVCount;  ///< 0 (sin UV2) o `vertexCount`.
+        uint64_t vertexData;       ///< Bloque de vértices, desde el inicio de su sección.
+        uint64_t indexData;
+        uint64_t lightmapUVData;
+        uint32_t vertexDataSize;   ///< Bytes del bloque.
+        uint32_t indexDataSize;
+        uint32_t lightmapUVDataSize;
+    };
+
+    struct StringEntry {
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    uint64_t align16(uint64_t value) {
+        return (value + 15) & ~uint64_t(15);
+    }
+
+    /// `count` elementos de `stride` bytes desde `offset` caben en el archivo.
+    bool fits(uint64_t offset, uint64_t count, uint64_t stride, size_t fileSize) {
+        return offset <= fileSize && count <= (fileSize - offset) / stride;
+    }
+
+    /// Submalla pendiente de decodificar (los bloques ya se comprobaron contra sus secciones).
+    struct PendingMesh {
+        const SubmeshEntry* entry;
+        MeshComponent* mesh;
+    };
+
+    StringEntry addString(std::string& strings, const std::string& value) {
+        StringEntry entry = { static_cast<uint32_t>(strings.size()), static_cast<uint32_t>(value.size()) };
+        strings += value;
+        return entry;
+    }
+}
+
+bool MeshCache::makeKey(const std::string& sourcePath, unsigned int importerVersion,
+    unsigned int lodLevels, float lodRatio, unsigned long long& key) {
+    FileView source;
+    if (!VirtualFileSystem::getDefault().open(sourcePath, source)) {
+        return false;
+    }
+    uint64_t hash = EU::kFnv1aSeed;
+    EU::Fnv1a(hash, source.getData(), source.getSize());
+    const uint64_t size = source.getSize();
+    EU::Fnv1a(hash, &size, sizeof(size));
+    EU::Fnv1a(hash, &importerVersion, sizeof(importerVersion));
+    EU::Fnv1a(hash, &lodLevels, sizeof(lodLevels));
+    EU::Fnv1a(hash, &lodRatio, sizeof(lodRatio));
+    key = hash;
+    return true;
+}
+
+bool MeshCache::readKey(const std::string& path, unsigned long long& key) {
+    FileView file;
+    Header header;
+    if (!VirtualFileSystem::getDefault().open(path, file) || file.getSize() < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(&header, file.getData(), sizeof(header));
+    if (header.magic != kMagic || header.version != kFormatVersion) {
+        return false;
+    }
+    key = header.key;
+    return true;
+}
+
+HRESULT MeshCache::load(const std::string& path, unsigned long long key, Model& model) {
+    FileView file;
+    if (!VirtualFileSystem::getDefault().open(path, file)) {
+        return E_FAIL;
+    }
+    const unsigned char* data = file.getData();
+    const size_t size = file.getSize();
+
+    Header header;
+    if (size < sizeof(header)) {
+        return E_INVALIDARG;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (header.magic != kMagic) {
+        return E_INVALIDARG;
+    }
+    if (header.version != kFormatVersion || header.vertexStride != sizeof(SimpleVertex) || header.key != key) {
+        return E_ABORT;
+    }
+    if (header.levelCount == 0 ||
+        !fits(header.levelsOffset, header.levelCount, sizeof(LevelEntry), size) ||
+        !fits(header.submeshesOffset, header.submeshCount, sizeof(SubmeshEntry), size) ||
+        !fits(header.materialsOffset, header.materialCount, sizeof(StringEntry), size) ||
+        !fits(header.stringsOffset, header.stringBytes, 1, size) ||
+        !fits(header.verticesOffset, header.vertexBytes, 1, size) ||
+        !fits(header.indicesOffset, header.indexBytes, 1, size) ||
+        !fits(header.meshletsOffset, header.meshletCount, sizeof(Meshlet), size) ||
+        !fits(header.lightmapUVsOffset, header.lightmapUVBytes, 1, size) ||
+        uint64_t(header.nameOffset) + header.nameLength > header.stringBytes) {
+        return E_INVALIDARG;
+    }
+
+    const LevelEntry* levels = reinterpret_cast<const LevelEntry*>(data + header.levelsOffset);
+    const SubmeshEntry* submeshes = reinterpret_cast<const SubmeshEntry*>(data + header.submeshesOffset);
+    const StringEntry* materials = reinterpret_cast<const StringEntry*>(data + header.materialsOffset);
+    const char* strings = reinterpret_cast<const char*>(data + header.stringsOffset);
+    const Meshlet* meshlets = reinterpret_cast<const Meshlet*>(data + header.meshletsOffset);
+
+    Model loaded;
+    std::vector<PendingMesh> pending;
+    pending.reserve(header.submeshCount);
+    loaded.name.assign(strings + header.nameOffset, header.nameLength);
+    for (uint32_t i = 0; i < header.materialCount; ++i) {
+        if (uint64_t(materials[i].offset) + materials[i].length > header.stringBytes) {
+            return E_INVALIDARG;
+        }
+        loaded.textureFileNames.emplace_back(strings + materials[i].offset, materials[i].length);
+    }
+
+    loaded.lods.resize(header.levelCount - 1);
+    loaded.lodScreenSizes.resize(header.levelCount - 1);
+    for (uint32_t level = 0; level < header.levelCount; ++level) {
+        const LevelEntry& entry = levels[level];
+        if (uint64_t(entry.firstSubmesh) + entry.submeshCount > header.submeshCount) {
+            return E_INVALIDARG;
+        }
+        std::vector<MeshComponent>& target = level == 0 ? loaded.meshes : loaded.lods[level - 1];
+        target.resize(entry.submeshCount);
+        if (level > 0) {
+            loaded.lodScreenSizes[level - 1] = entry.screenSize;
+        }
+
+        for (uint32_t i = 0; i < entry.submeshCount; ++i) {
+            const SubmeshEntry& submesh = submeshes[entry.firstSubmesh + i];
+            if (uint64_t(submesh.firstVertex) + submesh.vertexCount > header.vertexCount ||
+                uint64_t(submesh.firstIndex) + submesh.indexCount > header.indexCount ||
+                uint64_t(submesh.nameOffset) + submesh.nameLength > header.stringBytes ||
+                uint64_t(submesh.firstMeshlet) + submesh.meshletCount > header.meshletCount ||
+                (submesh.lightmapUVCount != 0 && submesh.lightmapUVCount != submesh.vertexCount) ||
+                uint64_t(submesh.firstLightmapUV) + submesh.lightmapUVCount > header.lightmapUVCount ||
+                submesh.vertexData > header.vertexBytes || submesh.vertexDataSize > header.vertexBytes - submesh.vertexData ||
+                submesh.indexData > header.indexBytes || submesh.indexDataSize > header.indexBytes - submesh.indexData ||
+                submesh.lightmapUVData > header.lightmapUVBytes ||
+                submesh.lightmapUVDataSize > header.lightmapUVBytes - submesh.lightmapUVData) {
+                return E_INVALIDARG;
+            }
+            // Los streams se decodifican después, todos a la vez; aquí solo se reservan.
+            MeshComponent& mesh = target[i];
+            mesh.m_name = Name(strings + submesh.nameOffset, submesh.nameLength);
+            mesh.m_vertex.resize(submesh.vertexCount);
+            mesh.m_index.resize(submesh.indexCount);
+            mesh.m_numVertex = static_cast<int>(submesh.vertexCount);
+            mesh.m_numIndex = static_cast<int>(submesh.indexCount);
+            mesh.m_boundsMin = submesh.boundsMin;
+            mesh.m_boundsMax = submesh.boundsMax;
+            mesh.m_sphereCenter = submesh.sphereCenter;
+            mesh.m_sphereRadius = submesh.sphereRadius;
+            mesh.m_hasBounds = submesh.vertexCount > 0;
+            mesh.m_meshlets.assign(meshlets + submesh.firstMeshlet, meshlets + submesh.firstMeshlet + submesh.meshletCount);
+            mesh.m_lightmapUV.resize(submesh.lightmapUVCount);
+            for (const Meshlet& meshlet : mesh.m_meshlets) {
+                if (uint64_t(meshlet.firstIndex) + meshlet.indexCount > submesh.indexCount) {
+                    return E_INVALIDARG;
+                }
+            }
+            PendingMesh entryMesh = { &submesh, &mesh };
+            pending.push_back(entryMesh);
+        }
+    }
+
+    // Una submalla por trabajo, desde la vista: el archivo se desmapea al salir.
+    std::atomic<bool> corrupt{ false };
+    JobSystem::getDefault().parallelFor(static_cast<unsigned int>(pending.size()), [&](unsigned int begin, unsigned int end) {
+        for (unsigned int i = begin; i < end && !corrupt.load(std::memory_order_relaxed); ++i) {
+            const SubmeshEntry& submesh = *pending[i].entry;
+            MeshComponent& mesh = *pending[i].mesh;
+            const bool ok = MeshCodec::decodeVertices(data + header.verticesOffset + submesh.vertexData,
+                    submesh.vertexDataSize, mesh.m_vertex.data(), mesh.m_vertex.size(), sizeof(SimpleVertex)) &&
+                MeshCodec::decodeIndices(data + header.indicesOffset + submesh.indexData,
+                    submesh.indexDataSize, mesh.m_index.data(), mesh.m_index.size()) &&
+                (submesh.lightmapUVCount == 0 ||
+                    MeshCodec::decodeVertices(data + header.lightmapUVsOffset + submesh.lightmapUVData,
+                        submesh.lightmapUVDataSize, mesh.m_lightmapUV.data(), mesh.m_lightmapUV.size(), sizeof(XMFLOAT2)));
+            if (!ok) {
+                corrupt.store(true, std::memory_order_relaxed);
+            }
+        }
+    });
+    if (corrupt.load()) {
+        return E_INVALIDARG;
+    }
+
+    model = std::move(loaded);
+    return S_OK;
+}
+
+HRESULT MeshCache::write(const std::string& path, unsigned long long key, const Model& model) {
+    if (model.lodScreenSizes.size() < model.lods.size()) {
+        return E_INVALIDARG;
+    }
+
+    Writer writer;
+    HRESULT hr = writer.begin(path, key, model.name, model.textureFileNames);
+    for (size_t level = 0; SUCCEEDED(hr) && level <= model.lods.size(); ++level) {
+        if (level > 0) {
+            writer.beginLevel(model.lodScreenSizes[level - 1]);
+        }
+        const std::vector<MeshComponent>& source = level == 0 ? model.meshes : model.lods[level - 1];
+        for (size_t i = 0; SUCCEEDED(hr) && i < source.size(); ++i) {
+            hr = writer.addMesh(source[i]);
+        }
+    }
+    return SUCCEEDED(hr) ? writer.finish() : hr;
+}
+
+// ============================================================================
+//  Writer
+// ============================================================================
+
+struct MeshCache::Writer::State {
+    std::string path;
+    uint64_t key = 0;
+    std::string strings;
+    StringEntry name = {};
+    std::vector<LevelEntry> levels;
+    std::vector<SubmeshEntry> submeshes;
+    std::vector<StringEntry> materials;
+    std::vector<Meshlet> meshlets;  ///< Pequeños (40 B por ~124 triángulos): se quedan en memoria.
+    std::vector<unsigned char> lightmapUVs; ///< Bloques de UV2: solo las mallas estáticas importadas enteras los tienen.
+    uint32_t lightmapUVCount = 0;
+    uint64_t vertexCount = 0;
+    uint64_t indexCount = 0;
+    uint64_t vertexBytes = 0;       ///< Bytes escritos en el auxiliar de vértices.
+    uint64_t indexBytes = 0;
+    std::vector<unsigned char> encoded; ///< Bloque de la submalla que se está escribiendo.
+    std::string verticesPath;       ///< Auxiliar con los bloques de vértices de todas las submallas.
+    std::string indicesPath;        ///< Auxiliar con los bloques de índices.
+    FILE* vertices = nullptr;
+    FILE* indices = nullptr;
+};
+
+namespace {
+    /// Rellena con ceros hasta `target` (las secciones van alineadas a 16).
+    bool padTo(FILE* file, uint64_t& position, uint64_t target) {
+        static const unsigned char zeros[16] = {};
+        while (position < target) {
+            const size_t count = static_cast<size_t>((std::min)(target - position, uint64_t(sizeof(zeros))));
+            if (fwrite(zeros, 1, count, file) != count) {
+                return false;
+            }
+            position += count;
+        }
+        return true;
+    }
+
+    bool writeBlock(FILE* file, uint64_t& position, const void* data, size_t size) {
+        if (size > 0 && fwrite(data, 1, size, file) != size) {
+            return false;
+        }
+        position += size;
+        return true;
+    }
+
+    /// Copia un auxiliar entero al final de `file` por bloques de 1 MB.
+    bool appendFile(FILE* file, uint64_t& position, const std::string& sourcePath, uint64_t expected) {
+        FILE* source = nullptr;
+        if (expected == 0) {
+            return true;
+        }
+        if (fopen_s(&source, sourcePath.c_str(), "rb") != 0 || !source) {
+            return false;
+        }
+        std::vector<unsigned char> buffer(1u << 20);
+        uint64_t copied = 0;
+        size_t read = 0;
+        while ((read = fread(buffer.data(), 1, buffer.size(), source)) > 0) {
+            if (fwrite(buffer.data(), 1, read, file) != read) {
+                break;
+            }
+            copied += read;
+        }
+        fclose(source);
+        position += copied;
+        return copied == expected;
+    }
+}
+
+MeshCache::Writer::Writer() : m_state(new State()) {}
+
+MeshCache::Writer::~Writer() {
+    abort();
+}
+
+HRESULT MeshCache::Writer::begin(const std::string& path, unsigned long long key, const std::string& name,
+    const std::vector<std::string>& textureFileNames) {
+    abort();
+    State& state = *m_state;
+    state.path = path;
+    state.key = key;
+    state.name = addString(state.strings, name);
+    for (const std::string& texture : textureFileNames) {
+        state.materials.push_back(addString(state.strings, texture));
+    }
+    LevelEntry level = { 1.0f, 0, 0 };
+    state.levels.push_back(level);
+
+    const std::string suffix = std::to_string(GetCurrentThreadId());
+    state.verticesPath = path + ".vtx" + suffix;
+    state.indicesPath = path + ".idx" + suffix;
+    if (fopen_s(&state.vertices, state.verticesPath.c_str(), "wb") != 0 || !state.vertices ||
+        fopen_s(&state.indices, state.indicesPath.c_str(), "wb") != 0 || !state.indices) {
+        ERROR("MeshCache", "Writer::begin", ("Cannot write " + state.verticesPath).c_str());
+        abort();
+        return E_FAIL;
+    }
+    return S_OK;
+}
+
+void MeshCache::Writer::beginLevel(float screenSize) {
+    State& state = *m_state;
+    LevelEntry level = { screenSize, static_cast<uint32_t>(state.submeshes.size()), 0 };
+    state.levels.push_back(level);
+}
+
+HRESULT MeshCache::Writer::addMesh(const MeshComponent& mesh) {
+    State& state = *m_state;
+    if (!state.vertices || !state.indices) {
+        return E_FAIL;
+    }
+    if (state.vertexCount + mesh.m_vertex.size() > UINT32_MAX ||
+        state.indexCount + mesh.m_index.size() > UINT32_MAX) {
+        ERROR("MeshCache", "Writer::addMesh", "Model exceeds 2^32 vertices or indices");
+        return E_INVALIDARG;
+    }
+    const bool hasLightmapUV = mesh.m_lightmapUV.size() == mesh.m_vertex.size() && !mesh.m_vertex.empty();
+
+    MeshComponent bounded;
+    const MeshComponent* bounds = &mesh;
+    if (!mesh.m_hasBounds) {
+        bounded.m_vertex = mesh.m_vertex;
+        bounded.computeBounds();
+        bounds = &bounded;
+    }
+    const StringEntry meshName = addString(state.strings, mesh.m_name.str());
+    SubmeshEntry submesh = { meshName.offset, meshName.length,
+        static_cast<uint32_t>(state.vertexCount), static_cast<uint32_t>(mesh.m_vertex.size()),
+        static_cast<uint32_t>(state.indexCount), static_cast<uint32_t>(mesh.m_index.size()),
+        bounds->m_boundsMin, bounds->m_boundsMax, bounds->m_sphereCenter, bounds->m_sphereRadius,
+        static_cast<uint32_t>(state.meshlets.size()), static_cast<uint32_t>(mesh.m_meshlets.size()),
+        state.lightmapUVCount, hasLightmapUV ? static_cast<uint32_t>(mesh.m_vertex.size()) : 0u };
+
+    // Cada stream se codifica aparte por submalla: así `load` las decodifica en paralelo.
+    MeshCodec::encodeVertices(mesh.m_vertex.data(), mesh.m_vertex.size(), sizeof(SimpleVertex), state.encoded);
+    submesh.vertexData = state.vertexBytes;
+    submesh.vertexDataSize = static_cast<uint32_t>(state.encoded.size());
+    bool ok = fwrite(state.encoded.data(), 1, state.encoded.size(), state.vertices) == state.encoded.size();
+    MeshCodec::encodeIndices(mesh.m_index.data(), mesh.m_index.size(), state.encoded);
+    submesh.indexData = state.indexBytes;
+    submesh.indexDataSize = static_cast<uint32_t>(state.encoded.size());
+    ok = ok && fwrite(state.encoded.data(), 1, state.encoded.size(), state.indices) == state.encoded.size();
+    if (!ok) {
+        ERROR("MeshCache", "Writer::addMesh", ("Cannot write " + state.verticesPath).c_str());
+        return E_FAIL;
+    }
+    submesh.lightmapUVData = state.lightmapUVs.size();
+    if (hasLightmapUV) {
+        MeshCodec::encodeVertices(mesh.m_lightmapUV.data(), mesh.m_lightmapUV.size(), sizeof(XMFLOAT2), state.encoded);
+        submesh.lightmapUVDataSize = static_cast<uint32_t>(state.encoded.size());
+        state.lightmapUVs.insert(state.lightmapUVs.end(), state.encoded.begin(), state.encoded.end());
+        state.lightmapUVCount += static_cast<uint32_t>(mesh.m_lightmapUV.size());
+    }
+    state.submeshes.push_back(submesh);
+    state.meshlets.insert(state.meshlets.end(), mesh.m_meshlets.begin(), mesh.m_meshlets.end());
+    state.levels.back().submeshCount++;
+    state.vertexCount += mesh.m_vertex.size();
+    state.indexCount += mesh.m_index.size();
+    state.vertexBytes += submesh.vertexDataSize;
+    state.indexBytes += submesh.indexDataSize;
+    return S_OK;
+}
+
+HRESULT MeshCache::Writer::finish() {
+    State& state = *m_state;
+    if (!state.vertices || !state.indices) {
+        return E_FAIL;
+    }
+    bool ok = fclose(state.vertices) == 0;
+    ok = fclose(state.indices) == 0 && ok;
+    state.vertices = nullptr;
+    state.indices = nullptr;
+
+    Header header = {};
+    header.magic = kMagic;
+    header.version = kFormatVersion;
+    header.vertexStride = sizeof(SimpleVertex);
+    header.levelCount = static_cast<uint32_t>(state.levels.size());
+    header.key = state.key;
+    header.submeshCount = static_cast<uint32_t>(state.submeshes.size());
+    header.materialCount = static_cast<uint32_t>(state.materials.size());
+    header.vertexCount = static_cast<uint32_t>(state.vertexCount);
+    header.indexCount = static_cast<uint32_t>(state.indexCount);
+    header.stringBytes = static_cast<uint32_t>(state.strings.size());
+    header.nameOffset = state.name.offset;
+    header.nameLength = state.name.length;
+    header.meshletCount = static_cast<uint32_t>(state.meshlets.size());
+    header.lightmapUVCount = state.lightmapUVCount;
+    header.vertexBytes = state.vertexBytes;
+    header.indexBytes = state.indexBytes;
+    header.lightmapUVBytes = state.lightmapUVs.size();
+    header.levelsOffset = align16(sizeof(Header));
+    header.submeshesOffset = align16(header.levelsOffset + state.levels.size() * sizeof(LevelEntry));
+    header.materialsOffset = align16(header.submeshesOffset + state.submeshes.size() * sizeof(SubmeshEntry));
+    header.stringsOffset = align16(header.materialsOffset + state.materials.size() * sizeof(StringEntry));
+    header.verticesOffset = align16(header.stringsOffset + state.strings.size());
+    header.indicesOffset = align16(header.verticesOffset + state.vertexBytes);
+    header.meshletsOffset = align16(header.indicesOffset + state.indexBytes);
+    header.lightmapUVsOffset = align16(header.meshletsOffset + state.meshlets.size() * sizeof(Meshlet));
+
+    const std::string temp = state.path + ".tmp" + std::to_string(GetCurrentThreadId());
+    FILE* file = nullptr;
+    if (!ok || fopen_s(&file, temp.c_str(), "wb") != 0 || !file) {
+        ERROR("MeshCache", "write", ("Cannot write " + temp).c_str());
+        abort();
+        return E_FAIL;
+    }
+    uint64_t position = 0;
+    ok = writeBlock(file, position, &header, sizeof(header)) &&
+        padTo(file, position, header.levelsOffset) &&
+        writeBlock(file, position, state.levels.data(), state.levels.size() * sizeof(LevelEntry)) &&
+        padTo(file, position, header.submeshesOffset) &&
+        writeBlock(file, position, state.submeshes.data(), state.submeshes.size() * sizeof(SubmeshEntry)) &&
+        padTo(file, position, header.materialsOffset) &&
+        writeBlock(file, position, state.materials.data(), state.materials.size() * sizeof(StringEntry)) &&
+        padTo(file, position, header.stringsOffset) &&
+        writeBlock(file, position, state.strings.data(), state.strings.size()) &&
+        padTo(file, position, header.verticesOffset) &&
+        appendFile(file, position, state.verticesPath, state.vertexBytes) &&
+        padTo(file, position, header.indicesOffset) &&
+        appendFile(file, position, state.indicesPath, state.indexBytes) &&
+        padTo(file, position, header.meshletsOffset) &&
+        writeBlock(file, position, state.meshlets.data(), state.meshlets.size() * sizeof(Meshlet)) &&
+        padTo(file, position, header.lightmapUVsOffset) &&
+        writeBlock(file, position, state.lightmapUVs.data(), state.lightmapUVs.size());
+    ok = fclose(file) == 0 && ok;
+    if (!ok || !MoveFileExA(temp.c_str(), state.path.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+        DeleteFileA(temp.c_str());
+        ERROR("MeshCache", "write", ("Cannot write " + state.path).c_str());
+        abort();
+        return E_FAIL;
+    }
+    abort();
+    return S_OK;
+}
+
+void MeshCache::Writer::abort() {
+    State& state = *m_state;
+    if (state.vertices) fclose(state.vertices);
+    if (state.indices) fclose(state.indices);
+    if (!state.verticesPath.empty()) DeleteFileA(state.verticesPath.c_str());
+    if (!state.indicesPath.empty()) DeleteFileA(state.indicesPath.c_str());
+    state = State();
+}
+
+size_t MeshCache::Writer::getMeshCount() const {
+    return m_state->submeshes.size();
+}
@@ -0,0 +1,336 @@
+﻿/**
+ * @file MeshCodec.cpp
+ * @brief Implementación de los códecs de índices (FIFO de aristas) y vértices (planos de bytes).
+ */
+
+#include "MeshCodec.h"
+#include "Lz4Codec.h"
+#include <cstring>
+
+namespace {
+    /// Cómo se guardó un bloque (primer byte).
+    enum BlockMode : unsigned char {
+        BLOCK_RAW = 0,          ///< Los datos tal cual.
+        BLOCK_CODED = 1,        ///< Codificados, sin LZ4.
+        BLOCK_CODED_LZ4 = 2,    ///< Codificados y comprimidos: `uint32` con el tamaño codificado y el bloque LZ4.
+    };
+
+    /// Código de un triángulo sin arista en la FIFO (los otros: giro << 4 | entrada).
+    const unsigned char kNoEdge = 0xF0;
+    /// Valores de vértice: 0 = siguiente nuevo, 1..kFifoSize = FIFO, desde aquí = salto en zigzag.
+    const uint32_t kExplicitBase = MeshCodec::kFifoSize + 1;
+
+    void writeVarint(std::vector<unsigned char>& out, uint32_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<unsigned char>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<unsigned char>(value));
+    }
+
+    bool readVarint(const unsigned char*& cursor, const unsigned char* end, uint32_t& value) {
+        value = 0;
+        for (unsigned int shift = 0; shift < 35; shift += 7) {
+            if (cursor >= end) {
+                return false;
+            }
+            const unsigned char byte = *cursor++;
+            value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    uint32_t zigzag(uint32_t delta) {
+        return (delta << 1) ^ static_cast<uint32_t>(static_cast<int32_t>(delta) >> 31);
+    }
+
+    uint32_t unzigzag(uint32_t value) {
+        return (value >> 1) ^ (0u - (value & 1));
+    }
+
+    /// Pasa un bloque codificado por LZ4 si gana algo; si no, lo deja como `BLOCK_CODED`.
+    void finishBlock(std::vector<unsigned char>& coded, std::vector<unsigned char>& out) {
+        std::vector<unsigned char> compressed(coded.size() + 1 + sizeof(uint32_t));
+        const size_t packed = coded.empty() ? 0 :
+            Lz4Codec::compress(coded.data(), coded.size(), compressed.data() + 1 + sizeof(uint32_t),
+                compressed.size() - 1 - sizeof(uint32_t), true);
+        if (packed == 0 || packed + sizeof(uint32_t) >= coded.size()) {
+            out.resize(coded.size() + 1);
+            out[0] = BLOCK_CODED;
+            if (!coded.empty()) {
+                std::memcpy(out.data() + 1, coded.data(), coded.size());
+            }
+            return;
+        }
+        const uint32_t codedSize = static_cast<uint32_t>(coded.size());
+        compressed[0] = BLOCK_CODED_LZ4;
+        std::memcpy(compressed.data() + 1, &codedSize, sizeof(codedSize));
+        compressed.resize(1 + sizeof(uint32_t) + packed);
+        out.swap(compressed);
+    }
+
+    /// Datos codificados de un bloque (descomprimidos en `scratch` si hace falta).
+    bool openBlock(const unsigned char* data, size_t size, std::vector<unsigned char>& scratch,
+        const unsigned char*& coded, size_t& codedSize) {
+        if (data[0] == BLOCK_CODED) {
+            coded = data + 1;
+            codedSize = size - 1;
+            return true;
+        }
+        uint32_t expected = 0;
+        if (data[0] != BLOCK_CODED_LZ4 || size < 1 + sizeof(expected)) {
+            return false;
+        }
+        std::memcpy(&expected, data + 1, sizeof(expected));
+        scratch.resize(expected);
+        if (!Lz4Codec::decompress(data + 1 + sizeof(expected), size - 1 - sizeof(expected), scratch.data(), expected)) {
+            return false;
+        }
+        coded = scratch.data();
+        codedSize = expected;
+        return true;
+    }
+
+    /// Estado compartido por el codificador y el decodificador de índices.
+    struct IndexState {
+        uint32_t edges[MeshCodec::kFifoSize][2];
+        uint32_t vertices[MeshCodec::kFifoSize];
+        unsigned int edgeOffset = 0;
+        unsigned int vertexOffset = 0;
+        uint32_t next = 0;      ///< Siguiente vértice nuevo (los índices suelen crecer de uno en uno).
+        uint32_t last = 0;      ///< Último vértice explícito (base del salto).
+
+        IndexState() {
+            std::memset(edges, 0xFF, sizeof(edges));
+            std::memset(vertices, 0xFF, sizeof(vertices));
+        }
+
+        void pushEdge(uint32_t a, uint32_t b) {
+            edges[edgeOffset][0] = a;
+            edges[edgeOffset][1] = b;
+            edgeOffset = (edgeOffset + 1) % MeshCodec::kFifoSize;
+        }
+
+        void pushVertex(uint32_t v) {
+            vertices[vertexOffset] = v;
+            vertexOffset = (vertexOffset + 1) % MeshCodec::kFifoSize;
+        }
+
+        /// Entrada `i` de la FIFO de aristas contando desde la más reciente.
+        const uint32_t* edge(unsigned int i) const {
+            return edges[(edgeOffset + MeshCodec::kFifoSize - 1 - i) % MeshCodec::kFifoSize];
+        }
+
+        void encodeVertex(uint32_t v, std::vector<unsigned char>& data) {
+            if (v == next) {
+                data.push_back(0);
+                ++next;
+                pushVertex(v);
+                return;
+            }
+            for (unsigned int i = 1; i <= MeshCodec::kFifoSize; ++i) {
+                if (vertices[(vertexOffset + MeshCodec::kFifoSize - i) % MeshCodec::kFifoSize] == v) {
+                    writeVarint(data, i);
+                    return;
+                }
+            }
+            writeVarint(data, zigzag(v - last) + kExplicitBase);
+            last = v;
+            pushVertex(v);
+        }
+
+        bool decodeVertex(const unsigned char*& cursor, const unsigned char* end, uint32_t& v) {
+            uint32_t value;
+            if (!readVarint(cursor, end, value)) {
+                return false;
+            }
+            if (value == 0) {
+                v = next++;
+            }
+            else if (value <= MeshCodec::kFifoSize) {
+                v = vertices[(vertexOffset + MeshCodec::kFifoSize - value) % MeshCodec::kFifoSize];
+                return true;
+            }
+            else {
+                v = last + unzigzag(value - kExplicitBase);
+                last = v;
+            }
+            pushVertex(v);
+            return true;
+        }
+    };
+}
+
+void MeshCodec::encodeVertices(const void* vertices, size_t count, size_t stride, std::vector<unsigned char>& out) {
+    const unsigned char* source = static_cast<const unsigned char*>(vertices);
+    if (stride == 0 || stride % 4 != 0 || count == 0) {
+        out.resize(count * stride + 1);
+        out[0] = BLOCK_RAW;
+        if (count * stride > 0) {
+            std::memcpy(out.data() + 1, source, count * stride);
+        }
+        return;
+    }
+    // Plano (canal, byte) = los bytes `byte` de la diferencia en zigzag de ese canal.
+    const size_t channels = stride / 4;
+    std::vector<unsigned char> planes(count * stride);
+    for (size_t c = 0; c < channels; ++c) {
+        unsigned char* plane = planes.data() + c * 4 * count;
+        uint32_t previous = 0;
+        for (size_t i = 0; i < count; ++i) {
+            uint32_t value;
+            std::memcpy(&value, source + i * stride + c * 4, sizeof(value));
+            const uint32_t delta = zigzag(value - previous);
+            previous = value;
+            plane[i] = static_cast<unsigned char>(delta);
+            plane[count + i] = static_cast<unsigned char>(delta >> 8);
+            plane[2 * count + i] = static_cast<unsigned char>(delta >> 16);
+            plane[3 * count + i] = static_cast<unsigned char>(delta >> 24);
+        }
+    }
+    finishBlock(planes, out);
+}
+
+bool MeshCodec::decodeVertices(const unsigned char* data, size_t size, void* vertices, size_t count, size_t stride) {
+    unsigned char* target = static_cast<unsigned char*>(vertices);
+    if (size == 0) {
+        return false;
+    }
+    if (data[0] == BLOCK_RAW) {
+        if (size - 1 != count * stride) {
+            return false;
+        }
+        if (count * stride > 0) {
+            std::memcpy(target, data + 1, count * stride);
+        }
+        return true;
+    }
+    std::vector<unsigned char> scratch;
+    const unsigned char* planes = nullptr;
+    size_t planesSize = 0;
+    if (stride == 0 || stride % 4 != 0 || !openBlock(data, size, scratch, planes, planesSize) ||
+        planesSize != count * stride) {
+        return false;
+    }
+    const size_t channels = stride / 4;
+    for (size_t c = 0; c < channels; ++c) {
+        const unsigned char* plane = planes + c * 4 * count;
+        uint32_t value = 0;
+        for (size_t i = 0; i < count; ++i) {
+            const uint32_t delta = plane[i] | (static_cast<uint32_t>(plane[count + i]) << 8) |
+                (static_cast<uint32_t>(plane[2 * count + i]) << 16) | (static_cast<uint32_t>(plane[3 * count + i]) << 24);
+            value += unzigzag(delta);
+            std::memcpy(target + i * stride + c * 4, &value, sizeof(value));
+        }
+    }
+    return true;
+}
+
+/**
+ * @details Los códigos (un byte por triángulo) van delante y los vértices detrás: dos
+ * streams con estadísticas distintas que LZ4 comprime mejor por separado.
+ */
+void MeshCodec::encodeIndices(const unsigned int* indices, size_t count, std::vector<unsigned char>& out) {
+    if (count == 0 || count % 3 != 0) {
+        out.resize(count * sizeof(unsigned int) + 1);
+        out[0] = BLOCK_RAW;
+        if (count > 0) {
+            std::memcpy(out.data() + 1, indices, count * sizeof(unsigned int));
+        }
+        return;
+    }
+    const size_t triangleCount = count / 3;
+    std::vector<unsigned char> coded(triangleCount);
+    coded.reserve(triangleCount * 3);
+    IndexState state;
+    for (size_t t = 0; t < triangleCount; ++t) {
+        const uint32_t tri[3] = { indices[t * 3], indices[t * 3 + 1], indices[t * 3 + 2] };
+        unsigned int rotation = 3, entry = 0;
+        for (unsigned int i = 0; i < kFifoSize && rotation == 3; ++i) {
+            const uint32_t* e = state.edge(i);
+            for (unsigned int r = 0; r < 3; ++r) {
+                if (e[0] == tri[r] && e[1] == tri[(r + 1) % 3]) {
+                    rotation = r;
+                    entry = i;
+                    break;
+                }
+            }
+        }
+        if (rotation < 3) {
+            // Girado a (x, y, z) con (x, y) la arista compartida: solo falta z.
+            const uint32_t x = tri[rotation], y = tri[(rotation + 1) % 3], z = tri[(rotation + 2) % 3];
+            coded[t] = static_cast<unsigned char>((rotation << 4) | entry);
+            state.encodeVertex(z, coded);
+            state.pushEdge(z, y);
+            state.pushEdge(x, z);
+        }
+        else {
+            coded[t] = kNoEdge;
+            state.encodeVertex(tri[0], coded);
+            state.encodeVertex(tri[1], coded);
+            state.encodeVertex(tri[2], coded);
+            state.pushEdge(tri[1], tri[0]);
+            state.pushEdge(tri[2], tri[1]);
+            state.pushEdge(tri[0], tri[2]);
+        }
+    }
+    finishBlock(coded, out);
+}
+
+bool MeshCodec::decodeIndices(const unsigned char* data, size_t size, unsigned int* indices, size_t count) {
+    if (size == 0) {
+        return false;
+    }
+    if (data[0] == BLOCK_RAW) {
+        if (size - 1 != count * sizeof(unsigned int)) {
+            return false;
+        }
+        if (count > 0) {
+            std::memcpy(indices, data + 1, count * sizeof(unsigned int));
+        }
+        return true;
+    }
+    std::vector<unsigned char> scratch;
+    const unsigned char* coded = nullptr;
+    size_t codedSize = 0;
+    const size_t triangleCount = count / 3;
+    if (count % 3 != 0 || !openBlock(data, size, scratch, coded, codedSize) || codedSize < triangleCount) {
+        return false;
+    }
+    const unsigned char* cursor = coded + triangleCount;
+    const unsigned char* end = coded + codedSize;
+    IndexState state;
+    for (size_t t = 0; t < triangleCount; ++t) {
+        const unsigned char code = coded[t];
+        unsigned int* tri = indices + t * 3;
+        if (code == kNoEdge) {
+            if (!state.decodeVertex(cursor, end, tri[0]) || !state.decodeVertex(cursor, end, tri[1]) ||
+                !state.decodeVertex(cursor, end, tri[2])) {
+                return false;
+            }
+            state.pushEdge(tri[1], tri[0]);
+            state.pushEdge(tri[2], tri[1]);
+            state.pushEdge(tri[0], tri[2]);
+            continue;
+        }
+        const unsigned int rotation = code >> 4;
+        if (rotation > 2) {
+            return false;
+        }
+        const uint32_t* e = state.edge(code & 0x0F);
+        const uint32_t x = e[0], y = e[1];
+        uint32_t z;
+        if (!state.decodeVertex(cursor, end, z)) {
+            return false;
+        }
+        tri[rotation] = x;
+        tri[(rotation + 1) % 3] = y;
+        tri[(rotation + 2) % 3] = z;
+        state.pushEdge(z, y);
+        state.pushEdge(x, z);
+    }
+    return cursor == end;
+}
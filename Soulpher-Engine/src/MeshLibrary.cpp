@@ -0,0 +1,140 @@
+﻿/**
+ * @file MeshLibrary.cpp
+ * @brief Implementación del registro de geometría compartida.
+ */
+
+#include "MeshLibrary.h"
+#include "ModelLoader.h"
+
+HRESULT MeshLibrary::init(Device& device, DeviceContext& deviceContext) {
+    const VertexFormat& format = MeshAsset::getVertexFormat();
+    return m_geometryPool.init(device, deviceContext, format.getStride(), format.getPositionStride());
+}
+
+void MeshLibrary::update() {
+    releaseUnused();
+    m_geometryPool.update();
+}
+
+MeshHandle MeshLibrary::find(const std::string& name) const {
+    auto found = m_meshes.find(name);
+    return found != m_meshes.end() ? found->second.lock() : MeshHandle();
+}
+
+/**
+ * @details
+ * El asset se crea aparte (no con `MakeShared`) para darle @ref ReleaseAsset: así el
+ * último `reset` de un actor libera los buffers aunque la biblioteca siga observándolo.
+ */
+MeshHandle MeshLibrary::create(Device& device, const std::string& name, const std::vector<MeshComponent>& meshes) {
+    MeshHandle existing = find(name);
+    if (!existing.isNull()) {
+        return existing;
+    }
+
+    MeshHandle asset(new MeshAsset(), ReleaseAsset());
+    HRESULT hr = asset->init(device, meshes, m_keepCpuData, &m_geometryPool);
+    if (FAILED(hr)) {
+        ERROR("MeshLibrary", "create", ("Failed to create some mesh buffers for " + name).c_str());
+    }
+    if (asset->getSubmeshCount() == 0) {
+        return MeshHandle();
+    }
+    asset->setSourceName(name);
+    m_meshes[name] = asset;
+    return asset;
+}
+
+/**
+ * @details
+ * Los LOD se añaden al asset antes de registrarlo; uno que no coincide con el nivel 0
+ * se descarta (ver `MeshAsset::addLOD`) sin invalidar el resto. Después se vacían los
+ * vectores del cargador con `swap` para devolver la memoria, no solo el tamaño.
+ */
+MeshHandle MeshLibrary::adopt(Device& device, const std::string& name, ModelLoader& loader) {
+    MeshHandle asset = find(name);
+    if (asset.isNull() && !loader.meshes.empty()) {
+        asset = create(device, name, loader.meshes);
+        for (size_t lod = 0; !asset.isNull() && lod < loader.lods.size() && lod < loader.lodScreenSizes.size(); ++lod) {
+            asset->addLOD(device, loader.lods[lod], loader.lodScreenSizes[lod]);
+        }
+    }
+    std::vector<MeshComponent>().swap(loader.meshes);
+    std::vector<std::vector<MeshComponent>>().swap(loader.lods);
+    std::vector<float>().swap(loader.lodScreenSizes);
+    return asset;
+}
+
+/**
+ * @details
+ * La malla nueva se construye aparte (nivel 0 y LOD) y luego se intercambia con el
+ * asset registrado; lo que queda en la copia temporal son los buffers anteriores.
+ */
+bool MeshLibrary::replace(Device& device, const std::string& name, ModelLoader& loader) {
+    MeshHandle existing = find(name);
+    bool replaced = false;
+    if (!existing.isNull() && !loader.meshes.empty()) {
+        MeshAsset fresh;
+        const HRESULT hr = fresh.init(device, loader.meshes, m_keepCpuData, &m_geometryPool);
+        if (SUCCEEDED(hr) && fresh.getSubmeshCount() > 0) {
+            for (size_t lod = 0; lod < loader.lods.size() && lod < loader.lodScreenSizes.size(); ++lod) {
+                fresh.addLOD(device, loader.lods[lod], loader.lodScreenSizes[lod]);
+            }
+            fresh.setSourceName(name);
+            std::swap(*existing, fresh);
+            replaced = true;
+        }
+        else {
+            ERROR("MeshLibrary", "replace", ("Failed to create the new buffers for " + name + "; keeping the old mesh").c_str());
+        }
+        fresh.destroy();
+    }
+    std::vector<MeshComponent>().swap(loader.meshes);
+    std::vector<std::vector<MeshComponent>>().swap(loader.lods);
+    std::vector<float>().swap(loader.lodScreenSizes);
+    return replaced;
+}
+
+std::vector<std::string> MeshLibrary::getNames() const {
+    std::vector<std::string> names;
+    for (const auto& pair : m_meshes) {
+        if (!pair.second.expired()) {
+            names.push_back(pair.first);
+        }
+    }
+    return names;
+}
+
+unsigned int MeshLibrary::releaseUnused() {
+    unsigned int released = 0;
+    for (auto it = m_meshes.begin(); it != m_meshes.end();) {
+        if (it->second.expired()) {
+            it = m_meshes.erase(it);
+            ++released;
+        }
+        else {
+            ++it;
+        }
+    }
+    return released;
+}
+
+void MeshLibrary::destroy() {
+    for (auto& pair : m_meshes) {
+        MeshHandle asset = pair.second.lock();
+        if (!asset.isNull()) {
+            asset->destroy();
+        }
+    }
+    m_meshes.clear();
+    m_geometryPool.destroy();
+}
+
+size_t MeshLibrary::getCpuBytes() const {
+    size_t bytes = 0;
+    for (const auto& pair : m_meshes) {
+        MeshHandle asset = pair.second.lock();
+        bytes += asset.isNull() ? 0 : asset->getCpuBytes();
+    }
+    return bytes;
+}
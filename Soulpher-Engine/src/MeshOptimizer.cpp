@@ -0,0 +1,356 @@
+﻿/**
+ * @file MeshOptimizer.cpp
+ * @brief Implementación de las pasadas de caché (Forsyth), overdraw y lectura de vértices.
+ */
+
+#include "MeshOptimizer.h"
+#include <cmath>
+
+const float MeshOptimizer::kOverdrawThreshold = 1.05f;
+
+namespace {
+    const unsigned int kInvalid = ~0u;
+    const float kCacheDecayPower = 1.5f;
+    const float kLastTriangleScore = 0.75f;
+    const float kValenceBoostScale = 2.0f;
+    const float kValenceBoostPower = 0.5f;
+    /// Tamaño de la caché FIFO con la que se miden los grupos de overdraw.
+    const unsigned int kFifoSize = 16;
+
+    /// Puntuación de Forsyth de un vértice.
+    float vertexScore(int cachePosition, unsigned int remaining) {
+        if (remaining == 0) {
+            return -1.0f;
+        }
+        float score = 0.0f;
+        if (cachePosition >= 0) {
+            if (cachePosition < 3) {
+                score = kLastTriangleScore; // Los del último triángulo, igual para los tres.
+            }
+            else {
+                const float scaler = 1.0f / (MeshOptimizer::kCacheSize - 3);
+                score = powf(1.0f - (cachePosition - 3) * scaler, kCacheDecayPower);
+            }
+        }
+        // Premia vértices con pocos triángulos pendientes: acabarlos libera la caché.
+        score += kValenceBoostScale * powf(static_cast<float>(remaining), -kValenceBoostPower);
+        return score;
+    }
+
+    /// Simula una caché FIFO; devuelve los fallos del triángulo `tri`.
+    unsigned int fifoMisses(const unsigned int* tri, std::vector<unsigned int>& timestamps,
+        unsigned int& time, unsigned int cacheSize) {
+        unsigned int misses = 0;
+        for (int k = 0; k < 3; ++k) {
+            if (time - timestamps[tri[k]] > cacheSize) {
+                timestamps[tri[k]] = time++;
+                ++misses;
+            }
+        }
+        return misses;
+    }
+}
+
+void MeshOptimizer::optimize(MeshComponent& mesh) {
+    const size_t vertexCount = mesh.m_vertex.size();
+    if (mesh.m_index.size() < 3 || mesh.m_index.size() % 3 != 0 || vertexCount == 0) {
+        return;
+    }
+    for (unsigned int index : mesh.m_index) {
+        if (index >= vertexCount) {
+            return;
+        }
+    }
+
+    optimizeVertexCache(mesh.m_index, vertexCount);
+    optimizeOverdraw(mesh.m_index, mesh.m_vertex, kOverdrawThreshold);
+    optimizeVertexFetch(mesh.m_vertex, mesh.m_index, mesh.m_skin.size() == vertexCount ? &mesh.m_skin : nullptr,
+        &mesh.m_morphs);
+    mesh.m_numVertex = static_cast<int>(mesh.m_vertex.size());
+    mesh.m_numIndex = static_cast<int>(mesh.m_index.size());
+    mesh.m_meshlets.clear(); // sus rangos ya no valen (ver `MeshletBuilder::build`)
+}
+
+void MeshOptimizer::optimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount) {
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0) {
+        return;
+    }
+
+    // Adyacencia vértice -> triángulos (CSR); `remaining` es la parte aún no emitida.
+    std::vector<unsigned int> remaining(vertexCount, 0);
+    for (unsigned int index : indices) {
+        ++remaining[index];
+    }
+    std::vector<unsigned int> offsets(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; ++v) {
+        offsets[v + 1] = offsets[v] + remaining[v];
+    }
+    std::vector<unsigned int> adjacency(indices.size());
+    {
+        std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t t = 0; t < triangleCount; ++t) {
+            for (int k = 0; k < 3; ++k) {
+                adjacency[fill[indices[t * 3 + k]]++] = static_cast<unsigned int>(t);
+            }
+        }
+    }
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> score(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v) {
+        score[v] = vertexScore(-1, remaining[v]);
+    }
+    std::vector<float> triangleScore(triangleCount);
+    std::vector<bool> emitted(triangleCount, false);
+    for (size_t t = 0; t < triangleCount; ++t) {
+        triangleScore[t] = score[indices[t * 3]] + score[indices[t * 3 + 1]] + score[indices[t * 3 + 2]];
+    }
+
+    std::vector<unsigned int> output;
+    output.reserve(indices.size());
+    std::vector<unsigned int> cache;
+    std::vector<unsigned int> nextCache;
+    cache.reserve(kCacheSize + 3);
+    nextCache.reserve(kCacheSize + 3);
+
+    unsigned int best = 0;
+    float bestScore = triangleScore[0];
+    for (size_t t = 1; t < triangleCount; ++t) {
+        if (triangleScore[t] > bestScore) {
+            bestScore = triangleScore[t];
+            best = static_cast<unsigned int>(t);
+        }
+    }
+    size_t scanCursor = 0;
+
+    for (size_t emittedCount = 0; emittedCount < triangleCount; ++emittedCount) {
+        if (best == kInvalid) {
+            // Ningún triángulo toca la caché: el siguiente sin emitir (recorrido lineal).
+            while (emitted[scanCursor]) {
+                ++scanCursor;
+            }
+            best = static_cast<unsigned int>(scanCursor);
+        }
+
+        const unsigned int* tri = &indices[best * 3];
+        output.insert(output.end(), tri, tri + 3);
+        emitted[best] = true;
+
+        // Quitar el triángulo de la lista pendiente de sus vértices.
+        for (int k = 0; k < 3; ++k) {
+            const unsigned int v = tri[k];
+            unsigned int* begin = &adjacency[offsets[v]];
+            unsigned int* end = begin + remaining[v];
+            for (unsigned int* it = begin; it != end; ++it) {
+                if (*it == best) {
+                    *it = *(end - 1);
+                    break;
+                }
+            }
+            --remaining[v];
+        }
+
+        // Nueva caché LRU: el triángulo delante, luego lo que había.
+        nextCache.assign(tri, tri + 3);
+        for (unsigned int v : cache) {
+            if (v != tri[0] && v != tri[1] && v != tri[2]) {
+                nextCache.push_back(v);
+            }
+        }
+        cache.swap(nextCache);
+
+        // Actualizar puntuaciones de lo que está (o acaba de salir) de la caché.
+        for (size_t i = 0; i < cache.size(); ++i) {
+            const unsigned int v = cache[i];
+            cachePosition[v] = i < kCacheSize ? static_cast<int>(i) : -1;
+            const float newScore = vertexScore(cachePosition[v], remaining[v]);
+            const float delta = newScore - score[v];
+            score[v] = newScore;
+            for (unsigned int a = offsets[v]; a < offsets[v] + remaining[v]; ++a) {
+                triangleScore[adjacency[a]] += delta;
+            }
+        }
+        if (cache.size() > kCacheSize) {
+            cache.resize(kCacheSize);
+        }
+
+        // Siguiente: el mejor triángulo pendiente de algún vértice en caché.
+        best = kInvalid;
+        bestScore = -1.0f;
+        for (unsigned int v : cache) {
+            for (unsigned int a = offsets[v]; a < offsets[v] + remaining[v]; ++a) {
+                const unsigned int t = adjacency[a];
+                if (triangleScore[t] > bestScore) {
+                    bestScore = triangleScore[t];
+                    best = t;
+                }
+            }
+        }
+    }
+
+    indices.swap(output);
+}
+
+void MeshOptimizer::optimizeOverdraw(std::vector<unsigned int>& indices,
+    const std::vector<SimpleVertex>& vertices, float threshold) {
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount < 2) {
+        return;
+    }
+
+    // 1) Cortes "duros": triángulos con tres fallos, donde la caché ya se vació.
+    std::vector<unsigned int> timestamps(vertices.size(), 0);
+    unsigned int time = kFifoSize + 1;
+    std::vector<size_t> hard;
+    for (size_t t = 0; t < triangleCount; ++t) {
+        if (fifoMisses(&indices[t * 3], timestamps, time, kFifoSize) == 3) {
+            hard.push_back(t);
+        }
+    }
+    hard.push_back(triangleCount);
+
+    // 2) Cortes "blandos": dentro de cada tramo, en cuanto el grupo acumulado (con la
+    //    caché vacía al empezar) no supera `threshold` veces el ACMR del tramo.
+    std::vector<size_t> clusters;
+    for (size_t h = 0; h + 1 < hard.size(); ++h) {
+        const size_t start = hard[h];
+        const size_t end = hard[h + 1];
+
+        time += kFifoSize + 1;
+        unsigned int misses = 0;
+        for (size_t t = start; t < end; ++t) {
+            misses += fifoMisses(&indices[t * 3], timestamps, time, kFifoSize);
+        }
+        const float target = threshold * misses / static_cast<float>(end - start);
+
+        size_t clusterStart = start;
+        unsigned int clusterMisses = 0;
+        time += kFifoSize + 1;
+        clusters.push_back(start);
+        for (size_t t = start; t < end; ++t) {
+            clusterMisses += fifoMisses(&indices[t * 3], timestamps, time, kFifoSize);
+            if (t + 1 < end && clusterMisses <= target * (t + 1 - clusterStart)) {
+                clusterStart = t + 1;
+                clusterMisses = 0;
+                time += kFifoSize + 1;
+                clusters.push_back(clusterStart);
+            }
+        }
+    }
+    clusters.push_back(triangleCount);
+    if (clusters.size() <= 2) {
+        return;
+    }
+
+    // 3) Centro de la malla y, por grupo, centroide y normal ponderados por área.
+    XMVECTOR meshCenter = XMVectorZero();
+    float meshArea = 0.0f;
+    const size_t clusterCount = clusters.size() - 1;
+    std::vector<std::pair<float, size_t>> order(clusterCount);
+    std::vector<XMFLOAT3> centroids(clusterCount);
+    std::vector<XMFLOAT3> normals(clusterCount);
+    for (size_t c = 0; c < clusterCount; ++c) {
+        XMVECTOR centroid = XMVectorZero();
+        XMVECTOR normal = XMVectorZero();
+        float area = 0.0f;
+        for (size_t t = clusters[c]; t < clusters[c + 1]; ++t) {
+            XMVECTOR p0 = XMLoadFloat3(&vertices[indices[t * 3]].Pos);
+            XMVECTOR p1 = XMLoadFloat3(&vertices[indices[t * 3 + 1]].Pos);
+            XMVECTOR p2 = XMLoadFloat3(&vertices[indices[t * 3 + 2]].Pos);
+            XMVECTOR n = XMVector3Cross(XMVectorSubtract(p1, p0), XMVectorSubtract(p2, p0));
+            const float a = XMVectorGetX(XMVector3Length(n));
+            XMVECTOR center = XMVectorScale(XMVectorAdd(XMVectorAdd(p0, p1), p2), 1.0f / 3.0f);
+            centroid = XMVectorAdd(centroid, XMVectorScale(center, a));
+            normal = XMVectorAdd(normal, n);
+            area += a;
+        }
+        meshCenter = XMVectorAdd(meshCenter, centroid);
+        meshArea += area;
+        XMStoreFloat3(&centroids[c], area > 0.0f ? XMVectorScale(centroid, 1.0f / area) : centroid);
+        const float normalLength = XMVectorGetX(XMVector3Length(normal));
+        XMStoreFloat3(&normals[c], normalLength > 0.0f ? XMVectorScale(normal, 1.0f / normalLength) : normal);
+    }
+    if (meshArea <= 0.0f) {
+        return;
+    }
+    meshCenter = XMVectorScale(meshCenter, 1.0f / meshArea);
+
+    // 4) Más "hacia fuera" primero: suelen tapar a los demás desde casi cualquier vista.
+    for (size_t c = 0; c < clusterCount; ++c) {
+        XMVECTOR offset = XMVectorSubtract(XMLoadFloat3(&centroids[c]), meshCenter);
+        order[c] = std::make_pair(-XMVectorGetX(XMVector3Dot(offset, XMLoadFloat3(&normals[c]))), c);
+    }
+    std::stable_sort(order.begin(), order.end(),
+        [](const std::pair<float, size_t>& a, const std::pair<float, size_t>& b) { return a.first < b.first; });
+
+    std::vector<unsigned int> output;
+    output.reserve(indices.size());
+    for (const auto& entry : order) {
+        const size_t c = entry.second;
+        output.insert(output.end(), indices.begin() + clusters[c] * 3, indices.begin() + clusters[c + 1] * 3);
+    }
+    indices.swap(output);
+}
+
+void MeshOptimizer::optimizeVertexFetch(std::vector<SimpleVertex>& vertices, std::vector<unsigned int>& indices,
+    std::vector<SkinVertex>* skin, std::vector<MorphTarget>* morphs) {
+    std::vector<unsigned int> remap(vertices.size(), kInvalid);
+    std::vector<SimpleVertex> output;
+    std::vector<SkinVertex> skinOutput;
+    output.reserve(vertices.size());
+    if (skin) {
+        skinOutput.reserve(skin->size());
+    }
+    for (unsigned int& index : indices) {
+        if (remap[index] == kInvalid) {
+            remap[index] = static_cast<unsigned int>(output.size());
+            output.push_back(vertices[index]);
+            if (skin) {
+                skinOutput.push_back((*skin)[index]);
+            }
+        }
+        index = remap[index];
+    }
+    vertices.swap(output);
+    if (skin) {
+        skin->swap(skinOutput);
+    }
+    if (!morphs) {
+        return;
+    }
+    // Los vértices que no usa ningún triángulo desaparecen también de los blend shapes.
+    std::vector<std::pair<unsigned int, XMFLOAT3>> moved;
+    for (MorphTarget& target : *morphs) {
+        moved.clear();
+        for (size_t i = 0; i < target.vertices.size() && i < target.deltas.size(); ++i) {
+            const unsigned int vertex = target.vertices[i];
+            if (vertex < remap.size() && remap[vertex] != kInvalid) {
+                moved.emplace_back(remap[vertex], target.deltas[i]);
+            }
+        }
+        std::sort(moved.begin(), moved.end(),
+            [](const std::pair<unsigned int, XMFLOAT3>& a, const std::pair<unsigned int, XMFLOAT3>& b) { return a.first < b.first; });
+        target.vertices.resize(moved.size());
+        target.deltas.resize(moved.size());
+        for (size_t i = 0; i < moved.size(); ++i) {
+            target.vertices[i] = moved[i].first;
+            target.deltas[i] = moved[i].second;
+        }
+    }
+}
+
+float MeshOptimizer::computeACMR(const std::vector<unsigned int>& indices, size_t vertexCount,
+    unsigned int cacheSize) {
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0) {
+        return 0.0f;
+    }
+    std::vector<unsigned int> timestamps(vertexCount, 0);
+    unsigned int time = cacheSize + 1;
+    unsigned int misses = 0;
+    for (size_t t = 0; t < triangleCount; ++t) {
+        misses += fifoMisses(&indices[t * 3], timestamps, time, cacheSize);
+    }
+    return misses / static_cast<float>(triangleCount);
+}
@@ -0,0 +1,242 @@
+﻿/**
+ * @file MeshSimplifier.cpp
+ * @brief Implementación del colapso de aristas con cuádricas (Garland-Heckbert).
+ */
+
+#include "MeshSimplifier.h"
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <queue>
+#include <unordered_map>
+
+const float MeshSimplifier::kBoundaryWeight = 1000.0f;
+
+namespace {
+    /// Matriz simétrica 4x4 guardada como sus 10 coeficientes distintos.
+    struct Quadric {
+        double a[10] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+
+        void addPlane(double nx, double ny, double nz, double d, double w) {
+            a[0] += w * nx * nx; a[1] += w * nx * ny; a[2] += w * nx * nz; a[3] += w * nx * d;
+            a[4] += w * ny * ny; a[5] += w * ny * nz; a[6] += w * ny * d;
+            a[7] += w * nz * nz; a[8] += w * nz * d;
+            a[9] += w * d * d;
+        }
+
+        Quadric& operator+=(const Quadric& o) {
+            for (int i = 0; i < 10; ++i) a[i] += o.a[i];
+            return *this;
+        }
+
+        /// v^T Q v con v = (x, y, z, 1).
+        double eval(const XMFLOAT3& p) const {
+            const double x = p.x, y = p.y, z = p.z;
+            return a[0] * x * x + 2.0 * a[1] * x * y + 2.0 * a[2] * x * z + 2.0 * a[3] * x
+                + a[4] * y * y + 2.0 * a[5] * y * z + 2.0 * a[6] * y
+                + a[7] * z * z + 2.0 * a[8] * z
+                + a[9];
+        }
+    };
+
+    /// Colapso candidato `from` -> `to`; válido mientras los sellos no cambien.
+    struct Candidate {
+        double cost;
+        unsigned int from;
+        unsigned int to;
+        unsigned int stampFrom;
+        unsigned int stampTo;
+        bool operator>(const Candidate& o) const { return cost > o.cost; }
+    };
+
+    XMVECTOR faceNormal(const XMFLOAT3& p0, const XMFLOAT3& p1, const XMFLOAT3& p2) {
+        XMVECTOR a = XMLoadFloat3(&p0);
+        return XMVector3Cross(XMVectorSubtract(XMLoadFloat3(&p1), a), XMVectorSubtract(XMLoadFloat3(&p2), a));
+    }
+
+    uint64_t edgeKey(unsigned int a, unsigned int b) {
+        if (a > b) std::swap(a, b);
+        return (static_cast<uint64_t>(a) << 32) | b;
+    }
+}
+
+MeshComponent MeshSimplifier::simplify(const MeshComponent& mesh, float ratio) {
+    const size_t indexCount = mesh.m_index.size();
+    if (ratio >= 1.0f || indexCount < 3 || indexCount % 3 != 0 || mesh.m_vertex.empty()) {
+        return mesh;
+    }
+
+    const std::vector<SimpleVertex>& vertices = mesh.m_vertex;
+    const unsigned int vertexCount = static_cast<unsigned int>(vertices.size());
+    const unsigned int faceCount = static_cast<unsigned int>(indexCount / 3);
+    const unsigned int target = (std::max)(1u, static_cast<unsigned int>(faceCount * (std::max)(ratio, 0.0f)));
+
+    std::vector<unsigned int> faces(mesh.m_index.begin(), mesh.m_index.end());
+    std::vector<bool> faceAlive(faceCount, true);
+    std::vector<std::vector<unsigned int>> vertexFaces(vertexCount);
+    std::vector<Quadric> quadrics(vertexCount);
+    std::unordered_map<uint64_t, unsigned int> edgeUse;
+    edgeUse.reserve(indexCount);
+
+    // 1) Cuádricas de los planos de cada triángulo (ponderadas por área).
+    for (unsigned int f = 0; f < faceCount; ++f) {
+        const unsigned int* tri = &faces[f * 3];
+        if (tri[0] >= vertexCount || tri[1] >= vertexCount || tri[2] >= vertexCount) {
+            ERROR("MeshSimplifier", "simplify", ("Index out of range in " + mesh.m_name.str()).c_str());
+            return mesh;
+        }
+        for (int k = 0; k < 3; ++k) {
+            vertexFaces[tri[k]].push_back(f);
+            ++edgeUse[edgeKey(tri[k], tri[(k + 1) % 3])];
+        }
+
+        XMVECTOR n = faceNormal(vertices[tri[0]].Pos, vertices[tri[1]].Pos, vertices[tri[2]].Pos);
+        const float area = XMVectorGetX(XMVector3Length(n));
+        if (area <= 0.0f) {
+            continue;
+        }
+        XMFLOAT3 unit;
+        XMStoreFloat3(&unit, XMVectorScale(n, 1.0f / area));
+        const XMFLOAT3& p = vertices[tri[0]].Pos;
+        const double d = -(unit.x * p.x + unit.y * p.y + unit.z * p.z);
+        for (int k = 0; k < 3; ++k) {
+            quadrics[tri[k]].addPlane(unit.x, unit.y, unit.z, d, area);
+        }
+    }
+
+    // 2) Planos de borde: perpendiculares a la cara, conteniendo la arista.
+    for (unsigned int f = 0; f < faceCount; ++f) {
+        const unsigned int* tri = &faces[f * 3];
+        XMVECTOR n = XMVector3Normalize(faceNormal(vertices[tri[0]].Pos, vertices[tri[1]].Pos, vertices[tri[2]].Pos));
+        for (int k = 0; k < 3; ++k) {
+            const unsigned int a = tri[k];
+            const unsigned int b = tri[(k + 1) % 3];
+            if (edgeUse[edgeKey(a, b)] != 1) {
+                continue;
+            }
+            XMVECTOR pa = XMLoadFloat3(&vertices[a].Pos);
+            XMVECTOR edge = XMVectorSubtract(XMLoadFloat3(&vertices[b].Pos), pa);
+            XMVECTOR side = XMVector3Cross(edge, n);
+            const float length = XMVectorGetX(XMVector3Length(side));
+            if (length <= 0.0f) {
+                continue;
+            }
+            XMFLOAT3 unit;
+            XMStoreFloat3(&unit, XMVectorScale(side, 1.0f / length));
+            const double d = -XMVectorGetX(XMVector3Dot(XMLoadFloat3(&unit), pa));
+            const double w = kBoundaryWeight * XMVectorGetX(XMVector3LengthSq(edge));
+            quadrics[a].addPlane(unit.x, unit.y, unit.z, d, w);
+            quadrics[b].addPlane(unit.x, unit.y, unit.z, d, w);
+        }
+    }
+
+    // 3) Cola de colapsos: por arista, la dirección más barata.
+    std::vector<unsigned int> stamps(vertexCount, 0);
+    std::vector<bool> removed(vertexCount, false);
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> heap;
+
+    auto pushEdge = [&](unsigned int a, unsigned int b) {
+        Quadric q = quadrics[a];
+        q += quadrics[b];
+        const double costAtoB = q.eval(vertices[b].Pos);
+        const double costBtoA = q.eval(vertices[a].Pos);
+        if (costAtoB <= costBtoA) {
+            heap.push({ costAtoB, a, b, stamps[a], stamps[b] });
+        }
+        else {
+            heap.push({ costBtoA, b, a, stamps[b], stamps[a] });
+        }
+    };
+    for (const auto& edge : edgeUse) {
+        pushEdge(static_cast<unsigned int>(edge.first >> 32), static_cast<unsigned int>(edge.first & 0xFFFFFFFFu));
+    }
+
+    // 4) Colapsar hasta llegar al objetivo.
+    unsigned int liveFaces = faceCount;
+    std::vector<unsigned int> neighbors;
+    while (liveFaces > target && !heap.empty()) {
+        const Candidate c = heap.top();
+        heap.pop();
+        if (removed[c.from] || removed[c.to] ||
+            stamps[c.from] != c.stampFrom || stamps[c.to] != c.stampTo) {
+            continue; // Entrada obsoleta.
+        }
+
+        // Rechazar si algún triángulo que sobrevive invierte su normal.
+        bool flips = false;
+        for (unsigned int f : vertexFaces[c.from]) {
+            if (!faceAlive[f]) continue;
+            unsigned int* tri = &faces[f * 3];
+            if (tri[0] == c.to || tri[1] == c.to || tri[2] == c.to) continue;
+
+            XMFLOAT3 moved[3] = { vertices[tri[0]].Pos, vertices[tri[1]].Pos, vertices[tri[2]].Pos };
+            XMVECTOR before = faceNormal(moved[0], moved[1], moved[2]);
+            for (int k = 0; k < 3; ++k) {
+                if (tri[k] == c.from) moved[k] = vertices[c.to].Pos;
+            }
+            XMVECTOR after = faceNormal(moved[0], moved[1], moved[2]);
+            if (XMVectorGetX(XMVector3Dot(before, after)) <= 0.0f) {
+                flips = true;
+                break;
+            }
+        }
+        if (flips) {
+            continue;
+        }
+
+        for (unsigned int f : vertexFaces[c.from]) {
+            if (!faceAlive[f]) continue;
+            unsigned int* tri = &faces[f * 3];
+            if (tri[0] == c.to || tri[1] == c.to || tri[2] == c.to) {
+                faceAlive[f] = false;
+                --liveFaces;
+                continue;
+            }
+            for (int k = 0; k < 3; ++k) {
+                if (tri[k] == c.from) tri[k] = c.to;
+            }
+            vertexFaces[c.to].push_back(f);
+        }
+        vertexFaces[c.from].clear();
+        quadrics[c.to] += quadrics[c.from];
+        removed[c.from] = true;
+        ++stamps[c.to];
+
+        // Compactar las caras de `to` y reevaluar sus aristas.
+        std::vector<unsigned int>& toFaces = vertexFaces[c.to];
+        toFaces.erase(std::remove_if(toFaces.begin(), toFaces.end(),
+            [&faceAlive](unsigned int f) { return !faceAlive[f]; }), toFaces.end());
+        neighbors.clear();
+        for (unsigned int f : toFaces) {
+            for (int k = 0; k < 3; ++k) {
+                if (faces[f * 3 + k] != c.to) neighbors.push_back(faces[f * 3 + k]);
+            }
+        }
+        std::sort(neighbors.begin(), neighbors.end());
+        neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+        for (unsigned int w : neighbors) {
+            pushEdge(c.to, w);
+        }
+    }
+
+    // 5) Reconstruir vértices e índices con solo lo que sigue en uso.
+    MeshComponent result;
+    result.m_name = mesh.m_name;
+    std::vector<unsigned int> remap(vertexCount, UINT_MAX);
+    result.m_index.reserve(liveFaces * 3);
+    for (unsigned int f = 0; f < faceCount; ++f) {
+        if (!faceAlive[f]) continue;
+        for (int k = 0; k < 3; ++k) {
+            const unsigned int v = faces[f * 3 + k];
+            if (remap[v] == UINT_MAX) {
+                remap[v] = static_cast<unsigned int>(result.m_vertex.size());
+                result.m_vertex.push_back(vertices[v]);
+            }
+            result.m_index.push_back(remap[v]);
+        }
+    }
+    result.m_numVertex = static_cast<int>(result.m_vertex.size());
+    result.m_numIndex = static_cast<int>(result.m_index.size());
+    result.computeBounds();
+    return result;
+}
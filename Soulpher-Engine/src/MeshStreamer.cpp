@@ -0,0 +1,385 @@
+﻿/**
+ * @file MeshStreamer.cpp
+ * @brief Implementación de la importación fuera de núcleo (ver @ref MeshStreamer.h).
+ */
+
+#include "MeshStreamer.h"
+#include "MappedFile.h"
+#include "MeshCache.h"
+#include "MeshOptimizer.h"
+#include "MeshletBuilder.h"
+#include "ObjParser.h"
+#include <cstring>
+#include <unordered_map>
+
+namespace {
+    const uint32_t kNoTexcoord = 0xFFFFFFFFu;
+    const unsigned int kHistogramBins = 4096;
+    const unsigned int kMaxClusterVertices = 0xFFFF;
+
+    /// Un triángulo ya resuelto: índices globales de posición y UV.
+    struct TriangleRecord {
+        uint32_t position[3];
+        uint32_t texcoord[3];
+    };
+
+    /// Archivo auxiliar de solo escritura; se borra al destruirse.
+    class SpillFile {
+    public:
+        SpillFile() = default;
+        SpillFile(const SpillFile&) = delete;
+        SpillFile& operator=(const SpillFile&) = delete;
+        ~SpillFile() {
+            close();
+            remove();
+        }
+
+        bool open(const std::string& path) {
+            m_path = path;
+            if (fopen_s(&m_file, path.c_str(), "wb") != 0 || !m_file) {
+                m_file = nullptr;
+                return false;
+            }
+            setvbuf(m_file, nullptr, _IOFBF, 1 << 16);
+            return true;
+        }
+
+        void write(const void* data, size_t size) {
+            if (!m_file || fwrite(data, 1, size, m_file) != size) {
+                m_failed = true;
+            }
+        }
+
+        /// Cierra el archivo (queda en disco para mapearlo); `false` si alguna escritura falló.
+        bool close() {
+            bool ok = !m_failed;
+            if (m_file) {
+                ok = fclose(m_file) == 0 && ok;
+                m_file = nullptr;
+            }
+            return ok;
+        }
+
+        void remove() {
+            if (!m_path.empty()) {
+                DeleteFileA(m_path.c_str());
+                m_path.clear();
+            }
+        }
+
+        const std::string& getPath() const { return m_path; }
+
+    private:
+        std::string m_path;
+        FILE* m_file = nullptr;
+        bool m_failed = false;
+    };
+
+    float axisOf(const XMFLOAT3& v, int axis) {
+        return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+    }
+
+    /// Separa los 10 bits bajos de `v` dejando dos ceros entre cada uno.
+    uint32_t part1By2(uint32_t v) {
+        v &= 0x3FF;
+        v = (v | (v << 16)) & 0x030000FF;
+        v = (v | (v << 8)) & 0x0300F00F;
+        v = (v | (v << 4)) & 0x030C30C3;
+        v = (v | (v << 2)) & 0x09249249;
+        return v;
+    }
+
+    /// Pasada 1: posiciones y UV a los auxiliares, AABB y número de triángulos.
+    struct ScanVisitor {
+        SpillFile& positions;
+        SpillFile& texcoords;
+        uint64_t positionCount = 0;
+        uint64_t texcoordCount = 0;
+        uint64_t triangleCount = 0;
+        XMFLOAT3 boundsMin = XMFLOAT3(0.0f, 0.0f, 0.0f);
+        XMFLOAT3 boundsMax = XMFLOAT3(0.0f, 0.0f, 0.0f);
+
+        void position(const XMFLOAT3& v) {
+            if (positionCount == 0) {
+                boundsMin = boundsMax = v;
+            }
+            boundsMin = XMFLOAT3((std::min)(boundsMin.x, v.x), (std::min)(boundsMin.y, v.y), (std::min)(boundsMin.z, v.z));
+            boundsMax = XMFLOAT3((std::max)(boundsMax.x, v.x), (std::max)(boundsMax.y, v.y), (std::max)(boundsMax.z, v.z));
+            positions.write(&v, sizeof(v));
+            ++positionCount;
+        }
+
+        void texcoord(const XMFLOAT2& t) {
+            texcoords.write(&t, sizeof(t));
+            ++texcoordCount;
+        }
+
+        void face(const ObjParser::Corner*, unsigned int count) {
+            triangleCount += count - 2;
+        }
+    };
+
+    /// Pasada 2: triangula y manda cada triángulo a la franja de su centroide.
+    struct BucketVisitor {
+        const XMFLOAT3* positions;
+        uint64_t positionTotal;
+        uint64_t texcoordTotal;
+        int axis;
+        const std::vector<float>& limits; ///< Límite superior de cada franja salvo la última.
+        std::vector<SpillFile>& buckets;
+        uint64_t positionsSeen = 0;
+        uint64_t texcoordsSeen = 0;
+        bool valid = true;
+        std::vector<uint32_t> polygonPositions;
+        std::vector<uint32_t> polygonTexcoords;
+
+        void position(const XMFLOAT3&) { ++positionsSeen; }
+        void texcoord(const XMFLOAT2&) { ++texcoordsSeen; }
+
+        /// Índice del OBJ (base 1, negativo = relativo) a índice global.
+        static bool resolve(int value, uint64_t seen, uint64_t total, uint32_t& index) {
+            const long long resolved = value < 0 ? static_cast<long long>(seen) + value : value - 1;
+            if (resolved < 0 || resolved >= static_cast<long long>(total)) {
+                return false;
+            }
+            index = static_cast<uint32_t>(resolved);
+            return true;
+        }
+
+        void face(const ObjParser::Corner* corners, unsigned int count) {
+            if (!valid) {
+                return;
+            }
+            polygonPositions.resize(count);
+            polygonTexcoords.resize(count);
+            for (unsigned int i = 0; i < count; ++i) {
+                polygonTexcoords[i] = kNoTexcoord;
+                if (!resolve(corners[i].position, positionsSeen, positionTotal, polygonPositions[i]) ||
+                    (corners[i].texcoord != 0 &&
+                        !resolve(corners[i].texcoord, texcoordsSeen, texcoordTotal, polygonTexcoords[i]))) {
+                    valid = false;
+                    return;
+                }
+            }
+
+            for (unsigned int k = 1; k + 1 < count; ++k) {
+                const TriangleRecord record = {
+                    { polygonPositions[0], polygonPositions[k], polygonPositions[k + 1] },
+                    { polygonTexcoords[0], polygonTexcoords[k], polygonTexcoords[k + 1] } };
+                const float centroid = (axisOf(positions[record.position[0]], axis) +
+                    axisOf(positions[record.position[1]], axis) +
+                    axisOf(positions[record.position[2]], axis)) / 3.0f;
+                const size_t bucket = std::upper_bound(limits.begin(), limits.end(), centroid) - limits.begin();
+                buckets[bucket].write(&record, sizeof(record));
+            }
+        }
+    };
+
+    /// Cluster en construcción: soldadura local de (posición, UV).
+    struct ClusterBuilder {
+        const XMFLOAT3* positions;
+        const XMFLOAT2* texcoords;
+        MeshComponent mesh;
+        std::unordered_map<uint64_t, unsigned int> weld;
+
+        unsigned int vertex(uint32_t position, uint32_t texcoord) {
+            const uint64_t key = (static_cast<uint64_t>(position) << 32) | texcoord;
+            auto inserted = weld.emplace(key, static_cast<unsigned int>(mesh.m_vertex.size()));
+            if (inserted.second) {
+                SimpleVertex v{ positions[position], XMFLOAT2(0.0f, 0.0f) };
+                if (texcoord != kNoTexcoord) {
+                    v.Tex = XMFLOAT2(texcoords[texcoord].x, 1.0f - texcoords[texcoord].y);
+                }
+                mesh.m_vertex.push_back(v);
+            }
+            return inserted.first->second;
+        }
+
+        bool fits() const {
+            return mesh.m_index.size() / 3 < MeshStreamer::kClusterTriangles &&
+                mesh.m_vertex.size() + 3 <= kMaxClusterVertices;
+        }
+    };
+}
+
+HRESULT MeshStreamer::importOBJ(const std::string& sourcePath, const std::string& cachePath,
+    unsigned long long key, Stats* stats) {
+    MappedFile source;
+    if (!source.open(sourcePath)) {
+        ERROR("MeshStreamer", "importOBJ", ("Cannot open " + sourcePath).c_str());
+        return E_FAIL;
+    }
+    const char* text = reinterpret_cast<const char*>(source.getData());
+    const char* textEnd = text + source.getSize();
+    const std::string suffix = std::to_string(GetCurrentThreadId());
+
+    // 1) Escaneo: atributos a disco, AABB y recuento.
+    SpillFile positionFile, texcoordFile;
+    if (!positionFile.open(cachePath + ".pos" + suffix) || !texcoordFile.open(cachePath + ".uv" + suffix)) {
+        ERROR("MeshStreamer", "importOBJ", ("Cannot write next to " + cachePath).c_str());
+        return E_FAIL;
+    }
+    ScanVisitor scan = { positionFile, texcoordFile };
+    if (!ObjParser::parse(text, textEnd, scan)) {
+        ERROR("MeshStreamer", "importOBJ", ("Malformed line in " + sourcePath).c_str());
+        return E_INVALIDARG;
+    }
+    if (!positionFile.close() || !texcoordFile.close()) {
+        ERROR("MeshStreamer", "importOBJ", ("Cannot write next to " + cachePath).c_str());
+        return E_FAIL;
+    }
+    if (scan.triangleCount == 0 || scan.positionCount >= kNoTexcoord || scan.texcoordCount >= kNoTexcoord) {
+        ERROR("MeshStreamer", "importOBJ", ("No faces or too many vertices in " + sourcePath).c_str());
+        return E_INVALIDARG;
+    }
+
+    MappedFile positionMap, texcoordMap;
+    if (!positionMap.open(positionFile.getPath()) ||
+        (scan.texcoordCount > 0 && !texcoordMap.open(texcoordFile.getPath()))) {
+        ERROR("MeshStreamer", "importOBJ", "Cannot map the attribute files");
+        return E_FAIL;
+    }
+    const XMFLOAT3* positions = reinterpret_cast<const XMFLOAT3*>(positionMap.getData());
+    const XMFLOAT2* texcoords = reinterpret_cast<const XMFLOAT2*>(texcoordMap.getData());
+
+    // 2) Franjas en el eje más largo, cortadas por cuantiles de las posiciones.
+    const XMFLOAT3 extent(scan.boundsMax.x - scan.boundsMin.x,
+        scan.boundsMax.y - scan.boundsMin.y, scan.boundsMax.z - scan.boundsMin.z);
+    const int axis = (extent.x >= extent.y && extent.x >= extent.z) ? 0 : (extent.y >= extent.z ? 1 : 2);
+    const float axisMin = axisOf(scan.boundsMin, axis);
+    const float axisExtent = axisOf(extent, axis);
+    const unsigned int bucketCount = static_cast<unsigned int>((std::min)(uint64_t(kMaxBuckets),
+        (std::max)(uint64_t(1), (scan.triangleCount + kBucketTriangles - 1) / kBucketTriangles)));
+
+    std::vector<float> limits;
+    if (bucketCount > 1 && axisExtent > 0.0f) {
+        std::vector<uint64_t> histogram(kHistogramBins, 0);
+        for (uint64_t i = 0; i < scan.positionCount; ++i) {
+            const float t = (axisOf(positions[i], axis) - axisMin) / axisExtent;
+            histogram[(std::min)(static_cast<unsigned int>(t * kHistogramBins), kHistogramBins - 1)]++;
+        }
+        uint64_t cumulative = 0;
+        unsigned int next = 1;
+        for (unsigned int bin = 0; bin < kHistogramBins && next < bucketCount; ++bin) {
+            cumulative += histogram[bin];
+            while (next < bucketCount && cumulative * bucketCount >= scan.positionCount * next) {
+                limits.push_back(axisMin + axisExtent * (bin + 1) / kHistogramBins);
+                ++next;
+            }
+        }
+    }
+
+    std::vector<SpillFile> buckets(limits.size() + 1);
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        if (!buckets[i].open(cachePath + ".b" + std::to_string(i) + "_" + suffix)) {
+            ERROR("MeshStreamer", "importOBJ", ("Cannot write next to " + cachePath).c_str());
+            return E_FAIL;
+        }
+    }
+    BucketVisitor bucketing = { positions, scan.positionCount, scan.texcoordCount, axis, limits, buckets };
+    if (!ObjParser::parse(text, textEnd, bucketing) || !bucketing.valid) {
+        ERROR("MeshStreamer", "importOBJ", ("Face index out of range in " + sourcePath).c_str());
+        return E_INVALIDARG;
+    }
+    for (SpillFile& bucket : buckets) {
+        if (!bucket.close()) {
+            ERROR("MeshStreamer", "importOBJ", ("Cannot write " + bucket.getPath()).c_str());
+            return E_FAIL;
+        }
+    }
+    source.close();
+
+    // 3) Cada franja: orden Morton de los centroides, cortes en clusters y escritura.
+    MeshCache::Writer writer;
+    HRESULT hr = writer.begin(cachePath, key, sourcePath, std::vector<std::string>());
+    if (FAILED(hr)) {
+        return hr;
+    }
+    Stats result;
+    result.buckets = static_cast<unsigned int>(buckets.size());
+    std::vector<std::pair<uint32_t, uint32_t>> order;
+
+    for (SpillFile& bucket : buckets) {
+        MappedFile records;
+        if (!records.open(bucket.getPath())) {
+            bucket.remove(); // Franja vacía.
+            continue;
+        }
+        const TriangleRecord* triangles = reinterpret_cast<const TriangleRecord*>(records.getData());
+        const size_t triangleCount = records.getSize() / sizeof(TriangleRecord);
+
+        auto centroidOf = [&](const TriangleRecord& t) {
+            const XMFLOAT3& a = positions[t.position[0]];
+            const XMFLOAT3& b = positions[t.position[1]];
+            const XMFLOAT3& c = positions[t.position[2]];
+            return XMFLOAT3((a.x + b.x + c.x) / 3.0f, (a.y + b.y + c.y) / 3.0f, (a.z + b.z + c.z) / 3.0f);
+        };
+        XMFLOAT3 mn = centroidOf(triangles[0]), mx = mn;
+        for (size_t i = 1; i < triangleCount; ++i) {
+            const XMFLOAT3 c = centroidOf(triangles[i]);
+            mn = XMFLOAT3((std::min)(mn.x, c.x), (std::min)(mn.y, c.y), (std::min)(mn.z, c.z));
+            mx = XMFLOAT3((std::max)(mx.x, c.x), (std::max)(mx.y, c.y), (std::max)(mx.z, c.z));
+        }
+        auto quantize = [](float value, float low, float high) {
+            const float range = high - low;
+            return range > 0.0f ? static_cast<uint32_t>((value - low) / range * 1023.0f + 0.5f) : 0u;
+        };
+        order.resize(triangleCount);
+        for (size_t i = 0; i < triangleCount; ++i) {
+            const XMFLOAT3 c = centroidOf(triangles[i]);
+            order[i] = std::make_pair(part1By2(quantize(c.x, mn.x, mx.x)) |
+                (part1By2(quantize(c.y, mn.y, mx.y)) << 1) |
+                (part1By2(quantize(c.z, mn.z, mx.z)) << 2), static_cast<uint32_t>(i));
+        }
+        std::sort(order.begin(), order.end());
+
+        ClusterBuilder cluster = { positions, texcoords };
+        auto flush = [&]() -> HRESULT {
+            if (cluster.mesh.m_index.empty()) {
+                return S_OK;
+            }
+            MeshComponent& mesh = cluster.mesh;
+            mesh.m_name = "cluster" + std::to_string(result.clusters);
+            mesh.m_numVertex = static_cast<int>(mesh.m_vertex.size());
+            mesh.m_numIndex = static_cast<int>(mesh.m_index.size());
+            MeshOptimizer::optimize(mesh);
+            MeshletBuilder::build(mesh);
+            mesh.computeBounds();
+            const HRESULT added = writer.addMesh(mesh);
+            result.triangles += mesh.m_index.size() / 3;
+            result.vertices += mesh.m_vertex.size();
+            ++result.clusters;
+            mesh = MeshComponent();
+            cluster.weld.clear();
+            return added;
+        };
+
+        for (size_t i = 0; i < triangleCount && SUCCEEDED(hr); ++i) {
+            if (!cluster.fits()) {
+                hr = flush();
+            }
+            const TriangleRecord& t = triangles[order[i].second];
+            for (int corner = 0; corner < 3; ++corner) {
+                cluster.mesh.m_index.push_back(cluster.vertex(t.position[corner], t.texcoord[corner]));
+            }
+        }
+        if (SUCCEEDED(hr)) {
+            hr = flush();
+        }
+        records.close();
+        bucket.remove();
+        if (FAILED(hr)) {
+            return hr;
+        }
+    }
+
+    hr = writer.finish();
+    if (SUCCEEDED(hr)) {
+        MESSAGE("MeshStreamer", "importOBJ", sourcePath.c_str() << ": " << result.triangles << " triangles in "
+            << result.clusters << " clusters (" << result.buckets << " buckets)");
+        if (stats) {
+            *stats = result;
+        }
+    }
+    return hr;
+}
@@ -0,0 +1,270 @@
+﻿/**
+ * @file MeshletBuilder.cpp
+ * @brief Implementación de la partición en meshlets y de sus volúmenes de culling.
+ */
+
+#include "MeshletBuilder.h"
+#include "MeshOptimizer.h"
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+const float MeshletBuilder::kMinConeCosine = 0.1f;
+
+namespace {
+    /// Posición como clave exacta (bits de los tres floats).
+    struct PositionKey {
+        uint32_t x, y, z;
+        bool operator==(const PositionKey& other) const {
+            return x == other.x && y == other.y && z == other.z;
+        }
+    };
+
+    struct PositionKeyHash {
+        size_t operator()(const PositionKey& key) const {
+            uint64_t hash = key.x;
+            hash = hash * 0x9E3779B97F4A7C15ull ^ key.y;
+            hash = hash * 0x9E3779B97F4A7C15ull ^ key.z;
+            return static_cast<size_t>(hash ^ (hash >> 29));
+        }
+    };
+
+    PositionKey positionKey(const XMFLOAT3& p) {
+        PositionKey key;
+        std::memcpy(&key.x, &p.x, sizeof(uint32_t));
+        std::memcpy(&key.y, &p.y, sizeof(uint32_t));
+        std::memcpy(&key.z, &p.z, sizeof(uint32_t));
+        return key;
+    }
+
+    XMFLOAT3 centroid(const std::vector<SimpleVertex>& vertices, const unsigned int* tri) {
+        const XMFLOAT3& a = vertices[tri[0]].Pos;
+        const XMFLOAT3& b = vertices[tri[1]].Pos;
+        const XMFLOAT3& c = vertices[tri[2]].Pos;
+        return XMFLOAT3((a.x + b.x + c.x) / 3.0f, (a.y + b.y + c.y) / 3.0f, (a.z + b.z + c.z) / 3.0f);
+    }
+}
+
+void MeshletBuilder::build(MeshComponent& mesh) {
+    mesh.m_meshlets.clear();
+    const size_t vertexCount = mesh.m_vertex.size();
+    const size_t triangleCount = mesh.m_index.size() / 3;
+    if (triangleCount == 0 || mesh.m_index.size() % 3 != 0) {
+        return;
+    }
+    for (unsigned int index : mesh.m_index) {
+        if (index >= vertexCount) {
+            return;
+        }
+    }
+
+    // 1) Vértices soldados por posición (solo para la adyacencia).
+    std::vector<unsigned int> welded(vertexCount);
+    std::unordered_map<PositionKey, unsigned int, PositionKeyHash> positions;
+    positions.reserve(vertexCount);
+    for (size_t i = 0; i < vertexCount; ++i) {
+        auto inserted = positions.emplace(positionKey(mesh.m_vertex[i].Pos), static_cast<unsigned int>(positions.size()));
+        welded[i] = inserted.first->second;
+    }
+    const size_t weldedCount = positions.size();
+    positions.clear();
+
+    // 2) Triángulos de cada vértice soldado (listas compactas: offsets + datos).
+    std::vector<unsigned int> adjacencyOffsets(weldedCount + 1, 0);
+    for (unsigned int index : mesh.m_index) {
+        adjacencyOffsets[welded[index] + 1]++;
+    }
+    for (size_t i = 0; i < weldedCount; ++i) {
+        adjacencyOffsets[i + 1] += adjacencyOffsets[i];
+    }
+    std::vector<unsigned int> adjacency(mesh.m_index.size());
+    {
+        std::vector<unsigned int> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for (size_t i = 0; i < mesh.m_index.size(); ++i) {
+            adjacency[fill[welded[mesh.m_index[i]]]++] = static_cast<unsigned int>(i / 3);
+        }
+    }
+
+    // 3) Crecimiento voraz de cada meshlet.
+    std::vector<unsigned int> order;
+    order.reserve(mesh.m_index.size());
+    std::vector<char> emitted(triangleCount, 0);
+    std::vector<unsigned int> stamp(weldedCount, 0);  // = meshlet actual + 1 si el vértice ya está dentro
+    std::vector<unsigned int> candidates;
+    unsigned int meshletStamp = 1;
+    unsigned int meshletVertices = 0;
+    unsigned int meshletTriangles = 0;
+    XMFLOAT3 centroidSum(0.0f, 0.0f, 0.0f);
+    size_t cursor = 0;
+    size_t remaining = triangleCount;
+
+    auto newVertices = [&](unsigned int tri) {
+        unsigned int count = 0;
+        for (unsigned int k = 0; k < 3; ++k) {
+            const unsigned int v = welded[mesh.m_index[tri * 3 + k]];
+            bool repeated = stamp[v] == meshletStamp;
+            for (unsigned int j = 0; j < k && !repeated; ++j) {
+                repeated = welded[mesh.m_index[tri * 3 + j]] == v;
+            }
+            count += repeated ? 0 : 1;
+        }
+        return count;
+    };
+    auto closeMeshlet = [&]() {
+        if (meshletTriangles == 0) {
+            return;
+        }
+        Meshlet meshlet;
+        meshlet.indexCount = meshletTriangles * 3;
+        meshlet.firstIndex = static_cast<uint32_t>(order.size()) - meshlet.indexCount;
+        mesh.m_meshlets.push_back(meshlet);
+        ++meshletStamp;
+        meshletVertices = 0;
+        meshletTriangles = 0;
+        centroidSum = XMFLOAT3(0.0f, 0.0f, 0.0f);
+        candidates.clear();
+    };
+
+    while (remaining > 0) {
+        // Vecino con menos vértices nuevos; a igualdad, el más cercano al centro.
+        int best = -1;
+        unsigned int bestNew = 4;
+        float bestDistance = FLT_MAX;
+        size_t kept = 0;
+        const float scale = meshletTriangles > 0 ? 1.0f / meshletTriangles : 0.0f;
+        const XMFLOAT3 center(centroidSum.x * scale, centroidSum.y * scale, centroidSum.z * scale);
+        for (unsigned int tri : candidates) {
+            if (emitted[tri]) {
+                continue;
+            }
+            candidates[kept++] = tri;
+            const unsigned int added = newVertices(tri);
+            if (added > bestNew) {
+                continue;
+            }
+            const XMFLOAT3 c = centroid(mesh.m_vertex, &mesh.m_index[tri * 3]);
+            const float distance = (c.x - center.x) * (c.x - center.x) +
+                (c.y - center.y) * (c.y - center.y) + (c.z - center.z) * (c.z - center.z);
+            if (added < bestNew || distance < bestDistance) {
+                best = static_cast<int>(tri);
+                bestNew = added;
+                bestDistance = distance;
+            }
+        }
+        candidates.resize(kept);
+
+        if (meshletTriangles > 0 && (best < 0 || meshletVertices + bestNew > kMaxVertices)) {
+            closeMeshlet();
+            continue;
+        }
+        if (best < 0) {
+            while (emitted[cursor]) {
+                ++cursor;
+            }
+            best = static_cast<int>(cursor);
+            bestNew = newVertices(static_cast<unsigned int>(best));
+        }
+
+        const unsigned int tri = static_cast<unsigned int>(best);
+        emitted[tri] = 1;
+        --remaining;
+        for (unsigned int k = 0; k < 3; ++k) {
+            const unsigned int index = mesh.m_index[tri * 3 + k];
+            order.push_back(index);
+            const unsigned int v = welded[index];
+            if (stamp[v] != meshletStamp) {
+                stamp[v] = meshletStamp;
+                for (unsigned int a = adjacencyOffsets[v]; a < adjacencyOffsets[v + 1]; ++a) {
+                    if (!emitted[adjacency[a]]) {
+                        candidates.push_back(adjacency[a]);
+                    }
+                }
+            }
+        }
+        const XMFLOAT3 c = centroid(mesh.m_vertex, &mesh.m_index[tri * 3]);
+        centroidSum = XMFLOAT3(centroidSum.x + c.x, centroidSum.y + c.y, centroidSum.z + c.z);
+        meshletVertices += bestNew;
+        if (++meshletTriangles == kMaxTriangles) {
+            closeMeshlet();
+        }
+    }
+    closeMeshlet();
+
+    // 4) Índices por meshlet y vértices por primer uso (los rangos no cambian).
+    mesh.m_index.swap(order);
+    MeshOptimizer::optimizeVertexFetch(mesh.m_vertex, mesh.m_index,
+        mesh.m_skin.size() == mesh.m_vertex.size() ? &mesh.m_skin : nullptr, &mesh.m_morphs);
+    mesh.m_numVertex = static_cast<int>(mesh.m_vertex.size());
+    mesh.m_numIndex = static_cast<int>(mesh.m_index.size());
+    for (Meshlet& meshlet : mesh.m_meshlets) {
+        computeBounds(mesh, meshlet);
+    }
+}
+
+/**
+ * @details
+ * Esfera: centro de la AABB de los vértices y la distancia máxima a él. Cono: eje =
+ * media de las normales unitarias de los triángulos (cara frontal en sentido horario,
+ * como el `Rasterizer`), `cos` = el menor producto con el eje. Con el cono más
+ * abierto que ~84° (@ref kMinConeCosine) no se podría descartar casi nunca y se deja
+ * sin cono.
+ */
+void MeshletBuilder::computeBounds(const MeshComponent& mesh, Meshlet& meshlet) {
+    meshlet.center = XMFLOAT3(0.0f, 0.0f, 0.0f);
+    meshlet.radius = 0.0f;
+    meshlet.coneAxis = XMFLOAT3(0.0f, 0.0f, 0.0f);
+    meshlet.coneCutoff = 1.0f;
+    const size_t end = static_cast<size_t>(meshlet.firstIndex) + meshlet.indexCount;
+    if (meshlet.indexCount < 3 || end > mesh.m_index.size()) {
+        return;
+    }
+
+    XMFLOAT3 mn = mesh.m_vertex[mesh.m_index[meshlet.firstIndex]].Pos;
+    XMFLOAT3 mx = mn;
+    for (size_t i = meshlet.firstIndex; i < end; ++i) {
+        const XMFLOAT3& p = mesh.m_vertex[mesh.m_index[i]].Pos;
+        mn = XMFLOAT3(std::min(mn.x, p.x), std::min(mn.y, p.y), std::min(mn.z, p.z));
+        mx = XMFLOAT3(std::max(mx.x, p.x), std::max(mx.y, p.y), std::max(mx.z, p.z));
+    }
+    meshlet.center = XMFLOAT3((mn.x + mx.x) * 0.5f, (mn.y + mx.y) * 0.5f, (mn.z + mx.z) * 0.5f);
+    float radiusSq = 0.0f;
+    for (size_t i = meshlet.firstIndex; i < end; ++i) {
+        const XMFLOAT3& p = mesh.m_vertex[mesh.m_index[i]].Pos;
+        const float dx = p.x - meshlet.center.x, dy = p.y - meshlet.center.y, dz = p.z - meshlet.center.z;
+        radiusSq = std::max(radiusSq, dx * dx + dy * dy + dz * dz);
+    }
+    meshlet.radius = sqrtf(radiusSq);
+
+    XMFLOAT3 normals[kMaxTriangles];
+    unsigned int normalCount = 0;
+    XMFLOAT3 sum(0.0f, 0.0f, 0.0f);
+    for (size_t i = meshlet.firstIndex; i + 2 < end && normalCount < kMaxTriangles; i += 3) {
+        const XMFLOAT3& a = mesh.m_vertex[mesh.m_index[i]].Pos;
+        const XMFLOAT3& b = mesh.m_vertex[mesh.m_index[i + 1]].Pos;
+        const XMFLOAT3& c = mesh.m_vertex[mesh.m_index[i + 2]].Pos;
+        const XMFLOAT3 e1(b.x - a.x, b.y - a.y, b.z - a.z);
+        const XMFLOAT3 e2(c.x - a.x, c.y - a.y, c.z - a.z);
+        XMFLOAT3 n(e1.y * e2.z - e1.z * e2.y, e1.z * e2.x - e1.x * e2.z, e1.x * e2.y - e1.y * e2.x);
+        const float length = sqrtf(n.x * n.x + n.y * n.y + n.z * n.z);
+        if (length <= 1e-12f) {
+            continue; // degenerado: no tiene cara que descartar
+        }
+        n = XMFLOAT3(n.x / length, n.y / length, n.z / length);
+        normals[normalCount++] = n;
+        sum = XMFLOAT3(sum.x + n.x, sum.y + n.y, sum.z + n.z);
+    }
+    const float sumLength = sqrtf(sum.x * sum.x + sum.y * sum.y + sum.z * sum.z);
+    if (normalCount == 0 || sumLength <= 1e-6f) {
+        return;
+    }
+    const XMFLOAT3 axis(sum.x / sumLength, sum.y / sumLength, sum.z / sumLength);
+    float minDot = 1.0f;
+    for (unsigned int i = 0; i < normalCount; ++i) {
+        minDot = std::min(minDot, axis.x * normals[i].x + axis.y * normals[i].y + axis.z * normals[i].z);
+    }
+    if (minDot <= kMinConeCosine) {
+        return;
+    }
+    meshlet.coneAxis = axis;
+    meshlet.coneCutoff = sqrtf(1.0f - minDot * minDot);
+}
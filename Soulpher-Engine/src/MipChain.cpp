@@ -0,0 +1,87 @@
+﻿/**
+ * @file MipChain.cpp
+ * @brief Filtro de caja 2x2 (SSE2 y escalar) y construcción de la cadena de mips.
+ */
+
+#include "MipChain.h"
+#include <emmintrin.h>
+#include <cstring>
+
+unsigned int MipChain::levelCount(unsigned int width, unsigned int height) {
+    unsigned int levels = 1;
+    while (width > 1 || height > 1) {
+        width = (std::max)(width / 2, 1u);
+        height = (std::max)(height / 2, 1u);
+        ++levels;
+    }
+    return levels;
+}
+
+void MipChain::downsample(const unsigned char* src, unsigned int srcWidth, unsigned int srcHeight,
+    unsigned char* dst) {
+    const unsigned int dstWidth = (std::max)(srcWidth / 2, 1u);
+    const unsigned int dstHeight = (std::max)(srcHeight / 2, 1u);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i round = _mm_set1_epi16(2);
+
+    for (unsigned int y = 0; y < dstHeight; ++y) {
+        const unsigned char* row0 = src + static_cast<size_t>(2 * y) * srcWidth * 4;
+        const unsigned char* row1 = src + static_cast<size_t>((std::min)(2 * y + 1, srcHeight - 1)) * srcWidth * 4;
+        unsigned char* out = dst + static_cast<size_t>(y) * dstWidth * 4;
+
+        unsigned int x = 0;
+        // 2 texeles de destino = 4 de origen por fila = 16 bytes.
+        for (; x + 2 <= dstWidth && 2 * x + 4 <= srcWidth; x += 2) {
+            const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + 8 * x));
+            const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + 8 * x));
+            // Texeles 0-1 y 2-3 en 16 bits, sumando las dos filas.
+            const __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+            const __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+            // Suma horizontal de cada pareja: 0+1 y 2+3.
+            const __m128i sumLo = _mm_add_epi16(lo, _mm_srli_si128(lo, 8));
+            const __m128i sumHi = _mm_add_epi16(hi, _mm_srli_si128(hi, 8));
+            __m128i sum = _mm_unpacklo_epi64(sumLo, sumHi);
+            sum = _mm_srli_epi16(_mm_add_epi16(sum, round), 2);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(out + 4 * x), _mm_packus_epi16(sum, zero));
+        }
+        // Resto (y anchos de 1 texel): repite la última columna.
+        for (; x < dstWidth; ++x) {
+            const unsigned int x0 = 2 * x;
+            const unsigned int x1 = (std::min)(2 * x + 1, srcWidth - 1);
+            for (unsigned int c = 0; c < 4; ++c) {
+                const unsigned int sum = row0[x0 * 4 + c] + row0[x1 * 4 + c] + row1[x0 * 4 + c] + row1[x1 * 4 + c];
+                out[x * 4 + c] = static_cast<unsigned char>((sum + 2) / 4);
+            }
+        }
+    }
+}
+
+void MipChain::build(const unsigned char* rgba, unsigned int width, unsigned int height, bool copyLevel0) {
+    m_levels.clear();
+    m_borrowed = copyLevel0 ? nullptr : rgba;
+    const unsigned int count = levelCount(width, height);
+
+    size_t total = 0;
+    for (unsigned int i = 0, w = width, h = height; i < count; ++i) {
+        Level level;
+        level.width = w;
+        level.height = h;
+        level.offset = total;
+        m_levels.push_back(level);
+        if (i > 0 || copyLevel0) {
+            total += static_cast<size_t>(w) * h * 4;
+        }
+        w = (std::max)(w / 2, 1u);
+        h = (std::max)(h / 2, 1u);
+    }
+
+    m_pixels.resize(total);
+    if (copyLevel0) {
+        memcpy(m_pixels.data(), rgba, static_cast<size_t>(width) * height * 4);
+    }
+    for (unsigned int i = 1; i < count; ++i) {
+        const Level& source = m_levels[i - 1];
+        downsample(getLevelPixels(i - 1), source.width, source.height,
+            m_pixels.data() + m_levels[i].offset);
+    }
+}
@@ -15,12 +15,24 @@
  *  4. Guardar el resultado en `MeshComponent` para que el motor lo renderice.
  *
  * @note
- * - Para OBJ se utiliza la librera externa `OBJ_Loader`.
+ * - Para OBJ se utiliza `ObjParser` (archivo mapeado, anlisis en paralelo).
  * - Para FBX se emplea el **Autodesk FBX SDK**.
  */
 
 #include "ModelLoader.h"
-#include "OBJ_Loader.h"
+#include "ObjParser.h"
+#include "MeshSimplifier.h"
+#include "MeshOptimizer.h"
+#include "MeshletBuilder.h"
+#include "LightmapUV.h"
+#include "MeshCache.h"
+#include "MeshStreamer.h"
+#include "Animation.h"
+#include "VirtualFileSystem.h"
+#include "StartupTimeline.h"
+#include <atomic>
+#include <cstring>
+#include <unordered_map>
 
  // ============================================================================
  //  Carga de modelos OBJ
@@ -32,38 +44,13 @@
   * @return MeshComponent Malla con vrtices, ndices y coordenadas UV cargadas.
   *
   * @details
-  * - Usa `objl::Loader` para interpretar el formato OBJ.
-  * - Convierte los datos a `SimpleVertex` para que el motor pueda procesarlos.
+  * - Usa `ObjParser`: mapea el archivo, lo analiza por tramos en paralelo y escribe
+  *   los vrtices soldados directamente en el `MeshComponent`.
   * - Invierte el eje Y de las coordenadas UV (1 - Y) para ajustarse al sistema DirectX.
   */
 MeshComponent ModelLoader::LoadOBJModel(const std::string& filePath) {
     MeshComponent mesh;
-    objl::Loader loader;
-
-    if (!loader.LoadFile(filePath)) {
-        return mesh; // Devuelve vaco si falla
-    }
-
-    mesh.m_name = filePath;
-
-    const unsigned int numVertices = loader.LoadedVertices.size();
-    const unsigned int numIndices = loader.LoadedIndices.size();
-
-    // Reservar memoria exacta para evitar reallocaciones
-    mesh.m_vertex.resize(numVertices);
-    mesh.m_index = std::move(loader.LoadedIndices); // Mover directamente (optimizacin)
-
-    for (unsigned int i = 0; i < numVertices; ++i) {
-        const auto& v = loader.LoadedVertices[i];
-        mesh.m_vertex[i] = SimpleVertex{
-            { v.Position.X, v.Position.Y, v.Position.Z },
-            { v.TextureCoordinate.X, 1.0f - v.TextureCoordinate.Y }
-        };
-    }
-
-    mesh.m_numVertex = numVertices;
-    mesh.m_numIndex = numIndices;
-
+    ObjParser::load(filePath, mesh); // Devuelve vaco si falla
     return mesh;
 }
 
@@ -78,19 +65,26 @@ MeshComponent ModelLoader::LoadOBJModel(const std::string& filePath) {
  * - Crea el `FbxManager` que controla toda la interaccin con FBX.
  * - Configura `FbxIOSettings` para definir opciones de importacin/exportacin.
  * - Crea una escena vaca (`FbxScene`) donde se almacenar el modelo importado.
+ * - Si ya existen, no hace nada: la escena se reutiliza vacindola entre cargas.
  */
 bool ModelLoader::InitializeFBXManager() {
-    lSdkManager = FbxManager::Create();
-    if (!lSdkManager) {
-        ERROR("ModelLoader", "FbxManager::Create()", "Unable to create FBX Manager!");
-        return false;
-    }
-    else {
-        MESSAGE("ModelLoader", "ModelLoader", "Autodesk FBX SDK version " << lSdkManager->GetVersion());
+    if (lSdkManager && lScene) {
+        return true;
     }
 
-    FbxIOSettings* ios = FbxIOSettings::Create(lSdkManager, IOSROOT);
-    lSdkManager->SetIOSettings(ios);
+    if (!lSdkManager) {
+        lSdkManager = FbxManager::Create();
+        if (!lSdkManager) {
+            ERROR("ModelLoader", "FbxManager::Create()", "Unable to create FBX Manager!");
+            return false;
+        }
+        else {
+            MESSAGE("ModelLoader", "ModelLoader", "Autodesk FBX SDK version " << lSdkManager->GetVersion());
+        }
+
+        FbxIOSettings* ios = FbxIOSettings::Create(lSdkManager, IOSROOT);
+        lSdkManager->SetIOSettings(ios);
+    }
 
     lScene = FbxScene::Create(lSdkManager, "MyScene");
     if (!lScene) {
@@ -103,6 +97,20 @@ bool ModelLoader::InitializeFBXManager() {
     return true;
 }
 
+/**
+ * @brief Destruye el `FbxManager`.
+ *
+ * @details `FbxManager::Destroy` destruye tambin todos los objetos creados con l
+ * (escena, `FbxIOSettings`, importadores olvidados), as que basta con una llamada.
+ */
+void ModelLoader::ReleaseFBXManager() {
+    if (lSdkManager) {
+        lSdkManager->Destroy();
+    }
+    lSdkManager = nullptr;
+    lScene = nullptr;
+}
+
 // ============================================================================
 //  Carga de modelos FBX
 // ============================================================================
@@ -113,53 +121,240 @@ bool ModelLoader::InitializeFBXManager() {
  * @return true si se carg correctamente, false si fall.
  *
  * @details
- * 1. Inicializa el SDK de FBX.
+ * 1. Inicializa el SDK de FBX (solo la primera vez).
  * 2. Crea un `FbxImporter` para leer el archivo.
  * 3. Importa la escena completa a `lScene`.
- * 4. Procesa recursivamente cada nodo (`FbxNode`) para extraer mallas y materiales.
+ * 4. Procesa recursivamente cada nodo (`FbxNode`) para extraer mallas y materiales;
+ *    con los huesos ya numerados convierte las mallas (con sus pesos) y los clips.
+ * 5. Vaca `lScene` (`FbxScene::Clear`): la geometra ya est en `meshes` y as la
+ *    memoria del SDK no crece con cada modelo importado.
  */
 bool ModelLoader::LoadFBXModel(const std::string& filePath) {
-    if (InitializeFBXManager()) {
-        FbxImporter* lImporter = FbxImporter::Create(lSdkManager, "");
-        if (!lImporter) {
-            ERROR("ModelLoader", "FbxImporter::Create()", "Unable to create FBX Importer!");
-            return false;
+    if (!InitializeFBXManager()) {
+        return false;
+    }
+
+    modelName.clear();
+    meshes.clear();
+    lods.clear();
+    lodScreenSizes.clear();
+    textureFileNames.clear();
+    skeleton.clear();
+    clips.clear();
+    m_lodLevel = 0;
+    m_pendingMeshes.clear();
+
+    FbxImporter* lImporter = FbxImporter::Create(lSdkManager, "");
+    if (!lImporter) {
+        ERROR("ModelLoader", "FbxImporter::Create()", "Unable to create FBX Importer!");
+        return false;
+    }
+    else {
+        MESSAGE("ModelLoader", "ModelLoader", "FBX Importer created successfully.");
+    }
+
+    if (!lImporter->Initialize(filePath.c_str(), -1, lSdkManager->GetIOSettings())) {
+        ERROR("ModelLoader", "FbxImporter::Initialize()", "Unable to initialize FBX Importer! Error: " << lImporter->GetStatus().GetErrorString());
+        lImporter->Destroy();
+        return false;
+    }
+
+    lScene->Clear();
+    if (!lImporter->Import(lScene)) {
+        ERROR("ModelLoader", "FbxImporter::Import()", "Unable to import FBX Scene! Error: " << lImporter->GetStatus().GetErrorString());
+        lImporter->Destroy();
+        lScene->Clear();
+        return false;
+    }
+    else {
+        MESSAGE("ModelLoader", "ModelLoader", "FBX Scene imported successfully.");
+        modelName = lImporter->GetFileName();
+    }
+
+    lImporter->Destroy();
+
+    bool loaded = false;
+    FbxNode* lRootNode = lScene->GetRootNode();
+    if (lRootNode) {
+        for (int i = 0; i < lRootNode->GetChildCount(); i++) {
+            ProcessFBXNode(lRootNode->GetChild(i));
         }
-        else {
-            MESSAGE("ModelLoader", "ModelLoader", "FBX Importer created successfully.");
+        ProcessFBXSkeleton(lRootNode);
+        ExtractFBXMeshes();
+        ProcessFBXAnimations();
+        loaded = true;
+    }
+    else {
+        ERROR("ModelLoader", "FbxScene::GetRootNode()", "Unable to get root node from FBX Scene!");
+    }
+
+    // Los nodos mueren con la escena.
+    m_jointNodes.clear();
+    m_jointIndex.clear();
+    lScene->Clear();
+    return loaded;
+}
+
+// ============================================================================
+//  Cach .smesh
+// ============================================================================
+/**
+ * @brief Carga desde la cach o importa el FBX y deja la cach escrita.
+ *
+ * @details
+ * La clave se calcula leyendo el FBX entero (mapeado), lo que cuesta mucho menos
+ * que importarlo. Si el FBX no existe pero hay cach, no se puede validar: se
+ * importa igualmente (y falla), para no cargar una cach de otro archivo. La
+ * excepcin es una cach empaquetada (@ref VirtualFileSystem): la escribi el
+ * cocinado y se usa con la clave que lleva.
+ */
+bool ModelLoader::LoadCachedFBXModel(const std::string& filePath, unsigned int lodLevels, float lodRatio) {
+    StartupTimeline::Scope timelineScope("Model", filePath);
+    const std::string cachePath = MeshCache::getCachePath(filePath);
+    unsigned long long key = 0;
+    const bool keyed = MeshCache::makeKey(filePath, kImporterVersion, lodLevels, lodRatio, key) ||
+        (VirtualFileSystem::getDefault().isPacked(cachePath) && MeshCache::readKey(cachePath, key));
+
+    const std::string animationPath = AnimationCache::getCachePath(filePath);
+
+    MeshCache::Model cached;
+    if (keyed && SUCCEEDED(MeshCache::load(cachePath, key, cached)) && !cached.meshes.empty()) {
+        // Sin `.sanim` el modelo es esttico; uno que no vale obliga a reimportar.
+        AnimationCache::Animations animations;
+        const HRESULT hr = AnimationCache::load(animationPath, key, animations);
+        if (hr == E_FAIL || (SUCCEEDED(hr) && animations.skins.size() == cached.meshes.size() &&
+            (animations.morphs.empty() || animations.morphs.size() == cached.meshes.size()))) {
+            modelName = cached.name;
+            meshes = std::move(cached.meshes);
+            lods = std::move(cached.lods);
+            lodScreenSizes = std::move(cached.lodScreenSizes);
+            textureFileNames = std::move(cached.textureFileNames);
+            skeleton = std::move(animations.skeleton);
+            clips = std::move(animations.clips);
+            for (size_t i = 0; i < animations.skins.size(); ++i) {
+                if (animations.skins[i].size() == meshes[i].m_vertex.size()) {
+                    meshes[i].m_skin = std::move(animations.skins[i]);
+                }
+            }
+            for (size_t i = 0; i < animations.morphs.size(); ++i) {
+                for (MorphTarget& target : animations.morphs[i]) {
+                    if (!target.vertices.empty() && target.vertices.back() < meshes[i].m_vertex.size()) {
+                        meshes[i].m_morphs.push_back(std::move(target));
+                    }
+                }
+            }
+            MESSAGE("ModelLoader", "LoadCachedFBXModel", "Loaded " << cachePath.c_str());
+            StartupTimeline::getDefault().recordCache(STARTUP_CACHE_MESH, true);
+            return true;
         }
+    }
+    StartupTimeline::getDefault().recordCache(STARTUP_CACHE_MESH, false);
 
-        if (!lImporter->Initialize(filePath.c_str(), -1, lSdkManager->GetIOSettings())) {
-            ERROR("ModelLoader", "FbxImporter::Initialize()", "Unable to initialize FBX Importer! Error: " << lImporter->GetStatus().GetErrorString());
-            lImporter->Destroy();
-            return false;
+    if (!LoadFBXModel(filePath) || meshes.empty()) {
+        return false;
+    }
+    GenerateLODs(lodLevels, lodRatio);
+
+    if (keyed) {
+        MeshCache::Model model;
+        model.name = modelName;
+        model.meshes = meshes;
+        model.lods = lods;
+        model.lodScreenSizes = lodScreenSizes;
+        model.textureFileNames = textureFileNames;
+        if (SUCCEEDED(MeshCache::write(cachePath, key, model))) {
+            MESSAGE("ModelLoader", "LoadCachedFBXModel", "Wrote " << cachePath.c_str());
         }
 
-        if (!lImporter->Import(lScene)) {
-            ERROR("ModelLoader", "FbxImporter::Import()", "Unable to import FBX Scene! Error: " << lImporter->GetStatus().GetErrorString());
-            lImporter->Destroy();
-            return false;
+        bool hasMorphs = false;
+        for (const MeshComponent& mesh : meshes) {
+            hasMorphs = hasMorphs || !mesh.m_morphs.empty();
+        }
+        if (skeleton.getJointCount() > 0 || hasMorphs) {
+            AnimationCache::Animations animations;
+            animations.skeleton = skeleton;
+            animations.clips = clips;
+            for (const MeshComponent& mesh : meshes) {
+                animations.skins.push_back(mesh.m_skin);
+                if (hasMorphs) {
+                    animations.morphs.push_back(mesh.m_morphs);
+                }
+            }
+            if (SUCCEEDED(AnimationCache::write(animationPath, key, animations))) {
+                MESSAGE("ModelLoader", "LoadCachedFBXModel", "Wrote " << animationPath.c_str());
+            }
         }
         else {
-            MESSAGE("ModelLoader", "ModelLoader", "FBX Scene imported successfully.");
-            modelName = lImporter->GetFileName();
+            DeleteFileA(animationPath.c_str()); // uno viejo hara animar un modelo que ya no tiene huesos
         }
+    }
+    return true;
+}
 
-        lImporter->Destroy();
+/**
+ * @brief Carga un OBJ desde su cach, o lo importa y la escribe.
+ *
+ * @details
+ * Los OBJ grandes no se cargan nunca enteros durante la importacin: `MeshStreamer`
+ * escribe la cach directamente y despus se lee como cualquier otra.
+ */
+bool ModelLoader::LoadCachedOBJModel(const std::string& filePath) {
+    StartupTimeline::Scope timelineScope("Model", filePath);
+    const std::string cachePath = MeshCache::getCachePath(filePath);
+    unsigned long long key = 0;
+    if (!MeshCache::makeKey(filePath, kImporterVersion, 0, 0.0f, key) &&
+        !(VirtualFileSystem::getDefault().isPacked(cachePath) && MeshCache::readKey(cachePath, key))) {
+        ERROR("ModelLoader", "LoadCachedOBJModel", ("Cannot open " + filePath).c_str());
+        return false;
+    }
+
+    meshes.clear();
+    lods.clear();
+    lodScreenSizes.clear();
+    textureFileNames.clear();
 
-        FbxNode* lRootNode = lScene->GetRootNode();
-        if (lRootNode) {
-            for (int i = 0; i < lRootNode->GetChildCount(); i++) {
-                ProcessFBXNode(lRootNode->GetChild(i));
+    MeshCache::Model cached;
+    HRESULT hr = MeshCache::load(cachePath, key, cached);
+    StartupTimeline::getDefault().recordCache(STARTUP_CACHE_MESH, SUCCEEDED(hr));
+    if (FAILED(hr)) {
+        WIN32_FILE_ATTRIBUTE_DATA attributes;
+        const unsigned long long size = GetFileAttributesExA(filePath.c_str(), GetFileExInfoStandard, &attributes)
+            ? (static_cast<unsigned long long>(attributes.nFileSizeHigh) << 32) | attributes.nFileSizeLow : 0;
+
+        if (size < kStreamingImportBytes) {
+            MeshComponent mesh = LoadOBJModel(filePath);
+            if (mesh.m_index.empty()) {
+                return false;
+            }
+            MeshOptimizer::optimize(mesh);
+            MeshletBuilder::build(mesh);
+            modelName = filePath;
+            meshes.push_back(std::move(mesh));
+            LightmapUV::generate(meshes);
+
+            MeshCache::Model model;
+            model.name = modelName;
+            model.meshes = meshes;
+            if (SUCCEEDED(MeshCache::write(cachePath, key, model))) {
+                MESSAGE("ModelLoader", "LoadCachedOBJModel", "Wrote " << cachePath.c_str());
             }
             return true;
         }
-        else {
-            ERROR("ModelLoader", "FbxScene::GetRootNode()", "Unable to get root node from FBX Scene!");
+
+        // Importacin fuera de ncleo: la cach es el resultado.
+        hr = MeshStreamer::importOBJ(filePath, cachePath, key);
+        if (SUCCEEDED(hr)) {
+            hr = MeshCache::load(cachePath, key, cached);
+        }
+        if (FAILED(hr)) {
             return false;
         }
     }
-    return false;
+
+    modelName = cached.name;
+    meshes = std::move(cached.meshes);
+    MESSAGE("ModelLoader", "LoadCachedOBJModel", "Loaded " << cachePath.c_str());
+    return !meshes.empty();
 }
 
 // ============================================================================
@@ -171,13 +366,18 @@ bool ModelLoader::LoadFBXModel(const std::string& filePath) {
  * @param node Nodo actual de la escena.
  *
  * @details
- * - Si el nodo contiene una malla, se llama a `ProcessFBXMesh`.
+ * - Si el nodo contiene una malla, se apunta para `ExtractFBXMeshes`.
  * - Luego se procesan todos sus hijos de forma recursiva.
  */
 void ModelLoader::ProcessFBXNode(FbxNode* node) {
     if (node->GetNodeAttribute()) {
         if (node->GetNodeAttribute()->GetAttributeType() == FbxNodeAttribute::eMesh) {
-            ProcessFBXMesh(node);
+            m_pendingMeshes.push_back({ node, m_lodLevel });
+        }
+        else if (node->GetNodeAttribute()->GetAttributeType() == FbxNodeAttribute::eLODGroup &&
+            m_lodLevel == 0) {
+            ProcessFBXLODGroup(node);
+            return;
         }
     }
 
@@ -186,80 +386,576 @@ void ModelLoader::ProcessFBXNode(FbxNode* node) {
     }
 }
 
+namespace {
+    /// Desplazamiento por debajo del cual un control point no cuenta como movido por un blend shape.
+    const float kMorphEpsilon = 1e-5f;
+
+    /// Vrtice de salida: control point (posicin) + UV, comparados bit a bit.
+    struct WeldKey {
+        int controlPoint;
+        uint32_t u;
+        uint32_t v;
+        bool operator==(const WeldKey& other) const {
+            return controlPoint == other.controlPoint && u == other.u && v == other.v;
+        }
+    };
+
+    struct WeldKeyHash {
+        size_t operator()(const WeldKey& key) const {
+            uint64_t hash = static_cast<uint32_t>(key.controlPoint) * 0x9E3779B97F4A7C15ull;
+            hash ^= (uint64_t(key.u) << 32 | key.v) + 0x7F4A7C159E3779B9ull + (hash << 6) + (hash >> 2);
+            return static_cast<size_t>(hash);
+        }
+    };
+
+    uint32_t floatBits(float value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    /// Transformacin de la geometra respecto a su nodo (no se hereda a los hijos).
+    FbxAMatrix geometricTransform(FbxNode* node) {
+        return FbxAMatrix(node->GetGeometricTranslation(FbxNode::eSourcePivot),
+            node->GetGeometricRotation(FbxNode::eSourcePivot),
+            node->GetGeometricScaling(FbxNode::eSourcePivot));
+    }
+
+    /// `FbxAMatrix` (traslacin en la fila 3, `M * v`) a `Matrix3x4` en forma de columna.
+    EU::Matrix3x4 toMatrix3x4(const FbxAMatrix& matrix) {
+        EU::Matrix3x4 result;
+        for (int r = 0; r < 3; ++r) {
+            for (int c = 0; c < 4; ++c) {
+                result.m[r][c] = static_cast<float>(matrix.Get(c, r));
+            }
+        }
+        return result;
+    }
+
+    JointPose toJointPose(const FbxAMatrix& matrix) {
+        const FbxVector4 t = matrix.GetT();
+        const FbxQuaternion q = matrix.GetQ();
+        const FbxVector4 s = matrix.GetS();
+        JointPose pose;
+        pose.rotation = EU::Quaternion((float)q[3], (float)q[0], (float)q[1], (float)q[2]);
+        pose.translation = EU::Vector3((float)t[0], (float)t[1], (float)t[2]);
+        pose.scale = EU::Vector3((float)s[0], (float)s[1], (float)s[2]);
+        return pose;
+    }
+
+    /**
+     * @brief Influencias de cada control point: las 4 de ms peso, en UNORM8 sumando 255.
+     * @note Un control point sin pesos se ata al hueso 0 (la raz).
+     */
+    void buildControlPointSkin(FbxMesh* mesh, const ModelLoader::JointMap& joints, std::vector<SkinVertex>& skin) {
+        const int controlPointCount = mesh->GetControlPointsCount();
+        std::vector<int> bones(controlPointCount * 4, 0);
+        std::vector<float> weights(controlPointCount * 4, 0.0f);
+
+        for (int d = 0; d < mesh->GetDeformerCount(FbxDeformer::eSkin); ++d) {
+            FbxSkin* deformer = static_cast<FbxSkin*>(mesh->GetDeformer(d, FbxDeformer::eSkin));
+            for (int c = 0; c < deformer->GetClusterCount(); ++c) {
+                FbxCluster* cluster = deformer->GetCluster(c);
+                const auto joint = joints.find(cluster->GetLink());
+                if (joint == joints.end()) {
+                    continue;
+                }
+                const int* indices = cluster->GetControlPointIndices();
+                const double* values = cluster->GetControlPointWeights();
+                for (int i = 0; i < cluster->GetControlPointIndicesCount(); ++i) {
+                    const int point = indices[i];
+                    const float weight = static_cast<float>(values[i]);
+                    if (point < 0 || point >= controlPointCount || weight <= 0.0f) {
+                        continue;
+                    }
+                    // Sustituye a la influencia ms ligera si esta pesa ms.
+                    float* w = &weights[point * 4];
+                    int lightest = 0;
+                    for (int k = 1; k < 4; ++k) {
+                        if (w[k] < w[lightest]) {
+                            lightest = k;
+                        }
+                    }
+                    if (weight > w[lightest]) {
+                        w[lightest] = weight;
+                        bones[point * 4 + lightest] = joint->second;
+                    }
+                }
+            }
+        }
+
+        skin.resize(controlPointCount);
+        for (int point = 0; point < controlPointCount; ++point) {
+            const float* w = &weights[point * 4];
+            const float sum = w[0] + w[1] + w[2] + w[3];
+            SkinVertex& vertex = skin[point];
+            int heaviest = 0;
+            int total = 0;
+            for (int k = 0; k < 4; ++k) {
+                vertex.Bones[k] = static_cast<unsigned char>(bones[point * 4 + k]);
+                vertex.Weights[k] = sum > 0.0f ? static_cast<unsigned char>(w[k] / sum * 255.0f + 0.5f) : 0;
+                total += vertex.Weights[k];
+                heaviest = w[k] > w[heaviest] ? k : heaviest;
+            }
+            // El redondeo puede dejar la suma en 254 o 256: se corrige en la mayor.
+            vertex.Weights[heaviest] = static_cast<unsigned char>(vertex.Weights[heaviest] + 255 - total);
+        }
+    }
+
+    /// Blend shape por control point: solo los que se mueven, en orden creciente.
+    struct ControlPointMorph {
+        std::string name;
+        std::vector<int> points;
+        std::vector<XMFLOAT3> deltas;
+    };
+
+    /**
+     * @brief Canales de los `FbxBlendShape` de la malla como deltas sobre sus control points.
+     * @note De cada canal se usa la ltima forma (la de peso 100); las intermedias
+     * (in-betweens) se ignoran. Los control points que no se mueven no se guardan.
+     */
+    void buildControlPointMorphs(FbxMesh* mesh, std::vector<ControlPointMorph>& morphs) {
+        const int controlPointCount = mesh->GetControlPointsCount();
+        const FbxVector4* base = mesh->GetControlPoints();
+        for (int d = 0; d < mesh->GetDeformerCount(FbxDeformer::eBlendShape); ++d) {
+            FbxBlendShape* deformer = static_cast<FbxBlendShape*>(mesh->GetDeformer(d, FbxDeformer::eBlendShape));
+            for (int c = 0; c < deformer->GetBlendShapeChannelCount(); ++c) {
+                FbxBlendShapeChannel* channel = deformer->GetBlendShapeChannel(c);
+                const int shapeCount = channel ? channel->GetTargetShapeCount() : 0;
+                FbxShape* shape = shapeCount > 0 ? channel->GetTargetShape(shapeCount - 1) : nullptr;
+                if (!shape) {
+                    continue;
+                }
+                ControlPointMorph morph;
+                morph.name = channel->GetName();
+                const FbxVector4* target = shape->GetControlPoints();
+                const int count = (std::min)(controlPointCount, shape->GetControlPointsCount());
+                for (int point = 0; point < count; ++point) {
+                    const XMFLOAT3 delta((float)(target[point][0] - base[point][0]),
+                        (float)(target[point][1] - base[point][1]), (float)(target[point][2] - base[point][2]));
+                    if (delta.x * delta.x + delta.y * delta.y + delta.z * delta.z > kMorphEpsilon * kMorphEpsilon) {
+                        morph.points.push_back(point);
+                        morph.deltas.push_back(delta);
+                    }
+                }
+                if (!morph.points.empty()) {
+                    morphs.push_back(std::move(morph));
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Pasa los blend shapes de control points a vrtices: un control point partido
+     * por costuras de UV da el mismo delta a cada uno de sus vrtices.
+     * @param vertexPoints Control point de cada vrtice de la malla.
+     */
+    void buildVertexMorphs(const std::vector<ControlPointMorph>& morphs, const std::vector<int>& vertexPoints,
+        int controlPointCount, std::vector<MorphTarget>& targets) {
+        // Vrtices de cada control point (CSR).
+        std::vector<unsigned int> offsets(controlPointCount + 1, 0);
+        for (int point : vertexPoints) {
+            ++offsets[point + 1];
+        }
+        for (int point = 0; point < controlPointCount; ++point) {
+            offsets[point + 1] += offsets[point];
+        }
+        std::vector<unsigned int> pointVertices(vertexPoints.size());
+        std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t v = 0; v < vertexPoints.size(); ++v) {
+            pointVertices[fill[vertexPoints[v]]++] = static_cast<unsigned int>(v);
+        }
+
+        std::vector<std::pair<unsigned int, XMFLOAT3>> moved;
+        for (const ControlPointMorph& morph : morphs) {
+            moved.clear();
+            for (size_t i = 0; i < morph.points.size(); ++i) {
+                const int point = morph.points[i];
+                for (unsigned int k = offsets[point]; k < offsets[point + 1]; ++k) {
+                    moved.emplace_back(pointVertices[k], morph.deltas[i]);
+                }
+            }
+            if (moved.empty()) {
+                continue; // mueve control points que ningn polgono usa
+            }
+            std::sort(moved.begin(), moved.end(),
+                [](const std::pair<unsigned int, XMFLOAT3>& a, const std::pair<unsigned int, XMFLOAT3>& b) { return a.first < b.first; });
+            MorphTarget target;
+            target.name = morph.name;
+            target.vertices.reserve(moved.size());
+            target.deltas.reserve(moved.size());
+            for (const auto& entry : moved) {
+                target.vertices.push_back(entry.first);
+                target.deltas.push_back(entry.second);
+            }
+            targets.push_back(std::move(target));
+        }
+    }
+}
+
 // ============================================================================
 //  Procesamiento de mallas FBX
 // ============================================================================
+/**
+ * @brief Convierte `m_pendingMeshes` repartindolas entre varios hilos.
+ *
+ * @details
+ * Los hilos se reparten las mallas con un contador atmico (las mallas de un FBX de
+ * escenario son muy desiguales, as que un reparto fijo dejara hilos ociosos). El
+ * hilo que llama tambin trabaja. Con una sola malla no se crean hilos.
+ */
+void ModelLoader::ExtractFBXMeshes() {
+    const size_t count = m_pendingMeshes.size();
+    std::vector<MeshComponent> converted(count);
+
+    std::atomic<size_t> next(0);
+    auto work = [&]() {
+        for (size_t i = next++; i < count; i = next++) {
+            ProcessFBXMesh(m_pendingMeshes[i].node, converted[i], m_jointIndex.empty() ? nullptr : &m_jointIndex);
+        }
+    };
+
+    // Hilos extra adems del actual: uno menos que ncleos, sin pasar de una malla por hilo.
+    const unsigned int cores = std::thread::hardware_concurrency();
+    const size_t extra = (std::min)(count, static_cast<size_t>(cores > 1 ? cores : 1)) - (std::min)(count, size_t(1));
+    std::vector<std::thread> workers;
+    workers.reserve(extra);
+    for (size_t i = 0; i < extra; ++i) {
+        workers.push_back(std::thread(work));
+    }
+    work();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    // Orden determinista: el del recorrido, independientemente de qu hilo termin antes.
+    for (size_t i = 0; i < count; ++i) {
+        if (!m_pendingMeshes[i].node->GetMesh()) {
+            continue;
+        }
+        const int level = m_pendingMeshes[i].lodLevel;
+        if (level == 0) {
+            meshes.push_back(std::move(converted[i]));
+        }
+        else {
+            lods[level - 1].push_back(std::move(converted[i]));
+        }
+    }
+    m_pendingMeshes.clear();
+
+    // UV2 del modelo entero: las submallas comparten el rectngulo del actor en el atlas.
+    // Duplica vrtices de las costuras sin cambiar el orden de los ndices (meshlets vlidos).
+    LightmapUV::generate(meshes);
+}
+
 /**
  * @brief Convierte una malla FBX (`FbxMesh`) a un `MeshComponent`.
  *
  * @param node Nodo que contiene la malla.
+ * @param meshData Recibe la malla (vaca si el nodo no tiene `FbxMesh`).
  *
  * @details
- * 1. Extrae posiciones desde los control points.
- * 2. Extrae coordenadas UV dependiendo del modo de mapeo.
- * 3. Extrae ndices de los polgonos.
- * 4. Crea un `MeshComponent` y lo almacena en `meshes`.
+ * 1. Recorre cada vrtice de polgono y obtiene su UV segn el modo de mapeo.
+ * 2. Suelda: el par (control point, UV) se busca en una tabla hash; si ya existe se
+ *    reutiliza ese vrtice y, si no, se crea uno nuevo. Un control point con varias
+ *    UV (costura) da varios vrtices; uno con la misma UV en todas sus caras, uno solo.
+ * 3. Triangula cada polgono en abanico (0, i, i+1), como espera `TRIANGLELIST`.
+ * 4. Reordena tringulos y vrtices con `MeshOptimizer` (cach, overdraw, lectura).
+ * 5. Parte la malla en meshlets (`MeshletBuilder`) para el culling por clusters.
+ * 6. Con `joints`, cada vrtice hereda las influencias de su control point (`m_skin`).
+ * 7. Cada canal de sus `FbxBlendShape` pasa a `m_morphs` con solo los vrtices que mueve
+ *    (el optimizador renumera esos ndices con los vrtices).
+ *
+ * @note No se usa `FbxGeometryConverter::Triangulate`: modifica la escena y esta
+ * funcin se llama desde varios hilos. El abanico es correcto para polgonos convexos,
+ * que son los que exportan los DCC habituales.
  */
-void ModelLoader::ProcessFBXMesh(FbxNode* node) {
+void ModelLoader::ProcessFBXMesh(FbxNode* node, MeshComponent& meshData, const JointMap* joints) {
     FbxMesh* mesh = node->GetMesh();
     if (!mesh) return;
 
+    const int polygonCount = mesh->GetPolygonCount();
+    const int polygonVertexCount = mesh->GetPolygonVertexCount();
+    const FbxVector4* controlPoint = mesh->GetControlPoints();
+
+    FbxGeometryElementUV* uvElement = mesh->GetElementUVCount() > 0 ? mesh->GetElementUV(0) : nullptr;
+    const FbxGeometryElement::EMappingMode mappingMode =
+        uvElement ? uvElement->GetMappingMode() : FbxGeometryElement::eNone;
+    const bool uvIndexed = uvElement && uvElement->GetReferenceMode() != FbxGeometryElement::eDirect;
+
     std::vector<SimpleVertex> vertices;
     std::vector<unsigned int> indices;
+    vertices.reserve(mesh->GetControlPointsCount());
+    indices.reserve(static_cast<size_t>(polygonVertexCount > polygonCount * 2 ? polygonVertexCount - polygonCount * 2 : 0) * 3);
+    std::unordered_map<WeldKey, unsigned int, WeldKeyHash> welded;
+    welded.reserve(mesh->GetControlPointsCount());
+
+    std::vector<SkinVertex> controlPointSkin;
+    std::vector<SkinVertex> skin;
+    if (joints && mesh->GetDeformerCount(FbxDeformer::eSkin) > 0) {
+        buildControlPointSkin(mesh, *joints, controlPointSkin);
+        skin.reserve(mesh->GetControlPointsCount());
+    }
+    std::vector<ControlPointMorph> controlPointMorphs;
+    std::vector<int> vertexPoints; // control point de cada vrtice (solo con blend shapes)
+    if (mesh->GetDeformerCount(FbxDeformer::eBlendShape) > 0) {
+        buildControlPointMorphs(mesh, controlPointMorphs);
+    }
+
+    std::vector<unsigned int> polygon;
+    int polyIndexCounter = 0;
+    for (int polyIndex = 0; polyIndex < polygonCount; polyIndex++) {
+        const int polySize = mesh->GetPolygonSize(polyIndex);
+        polygon.clear();
+
+        for (int vertIndex = 0; vertIndex < polySize; vertIndex++, polyIndexCounter++) {
+            const int controlPointIndex = mesh->GetPolygonVertex(polyIndex, vertIndex);
+            if (controlPointIndex < 0) {
+                continue;
+            }
 
-    // Posiciones
-    for (int i = 0; i < mesh->GetControlPointsCount(); i++) {
-        SimpleVertex vertex;
-        FbxVector4* controlPoint = mesh->GetControlPoints();
-        vertex.Pos = XMFLOAT3((float)controlPoint[i][0], (float)controlPoint[i][1], (float)controlPoint[i][2]);
-        vertices.push_back(vertex);
-    }
-
-    // Coordenadas UV
-    if (mesh->GetElementUVCount() > 0) {
-        FbxGeometryElementUV* uvElement = mesh->GetElementUV(0);
-        FbxGeometryElement::EMappingMode mappingMode = uvElement->GetMappingMode();
-        FbxGeometryElement::EReferenceMode referenceMode = uvElement->GetReferenceMode();
-        int polyIndexCounter = 0;
-
-        for (int polyIndex = 0; polyIndex < mesh->GetPolygonCount(); polyIndex++) {
-            int polySize = mesh->GetPolygonSize(polyIndex);
-            for (int vertIndex = 0; vertIndex < polySize; vertIndex++) {
-                int controlPointIndex = mesh->GetPolygonVertex(polyIndex, vertIndex);
-                int uvIndex = -1;
-
-                if (mappingMode == FbxGeometryElement::eByControlPoint) {
-                    uvIndex = (referenceMode == FbxGeometryElement::eDirect) ?
-                        controlPointIndex :
-                        uvElement->GetIndexArray().GetAt(controlPointIndex);
+            XMFLOAT2 tex(0.0f, 0.0f);
+            int uvIndex = -1;
+            if (mappingMode == FbxGeometryElement::eByControlPoint) {
+                uvIndex = uvIndexed ? uvElement->GetIndexArray().GetAt(controlPointIndex) : controlPointIndex;
+            }
+            else if (mappingMode == FbxGeometryElement::eByPolygonVertex) {
+                uvIndex = uvIndexed ? uvElement->GetIndexArray().GetAt(polyIndexCounter) : polyIndexCounter;
+            }
+            if (uvIndex != -1) {
+                FbxVector2 uv = uvElement->GetDirectArray().GetAt(uvIndex);
+                tex = XMFLOAT2((float)uv[0], -(float)uv[1]);
+            }
+
+            const WeldKey key = { controlPointIndex, floatBits(tex.x), floatBits(tex.y) };
+            auto inserted = welded.emplace(key, static_cast<unsigned int>(vertices.size()));
+            if (inserted.second) {
+                const FbxVector4& position = controlPoint[controlPointIndex];
+                SimpleVertex vertex;
+                vertex.Pos = XMFLOAT3((float)position[0], (float)position[1], (float)position[2]);
+                vertex.Tex = tex;
+                vertices.push_back(vertex);
+                if (!controlPointSkin.empty()) {
+                    skin.push_back(controlPointSkin[controlPointIndex]);
                 }
-                else if (mappingMode == FbxGeometryElement::eByPolygonVertex) {
-                    uvIndex = uvElement->GetIndexArray().GetAt(polyIndexCounter++);
+                if (!controlPointMorphs.empty()) {
+                    vertexPoints.push_back(controlPointIndex);
                 }
+            }
+            polygon.push_back(inserted.first->second);
+        }
+
+        // Abanico: un polgono de n vrtices da n - 2 tringulos.
+        for (size_t i = 2; i < polygon.size(); ++i) {
+            indices.push_back(polygon[0]);
+            indices.push_back(polygon[i - 1]);
+            indices.push_back(polygon[i]);
+        }
+    }
+
+    meshData.m_name = node->GetName();
+    meshData.m_numVertex = static_cast<int>(vertices.size());
+    meshData.m_numIndex = static_cast<int>(indices.size());
+    meshData.m_vertex = std::move(vertices);
+    meshData.m_index = std::move(indices);
+    meshData.m_skin = std::move(skin);
+    if (!controlPointMorphs.empty()) {
+        buildVertexMorphs(controlPointMorphs, vertexPoints, mesh->GetControlPointsCount(), meshData.m_morphs);
+    }
+    MeshOptimizer::optimize(meshData);
+    MeshletBuilder::build(meshData);
+    meshData.computeBounds();
+}
 
-                if (uvIndex != -1) {
-                    FbxVector2 uv = uvElement->GetDirectArray().GetAt(uvIndex);
-                    vertices[controlPointIndex].Tex = XMFLOAT2((float)uv[0], -(float)uv[1]);
+// ============================================================================
+//  Esqueleto y animaciones
+// ============================================================================
+/**
+ * @brief Numera los huesos y calcula su pose de enlace.
+ *
+ * @details
+ * 1. Recorre los `FbxSkin` de las mallas apuntadas: cada nodo enlazado por un cluster
+ *    es un hueso, aunque no tenga atributo `eSkeleton`, y su inversa de enlace es
+ *    `link^-1 * mesh * geometra` (del control point al espacio del hueso).
+ * 2. Recorre la escena en profundidad: padres antes que hijos, como espera `AnimationSystem`.
+ *
+ * Si salen ms de `Skeleton::kMaxJoints` huesos no se importa esqueleto (ni pesos ni
+ * clips): los ndices de `SkinVertex` no los alcanzaran.
+ */
+void ModelLoader::ProcessFBXSkeleton(FbxNode* root) {
+    std::unordered_map<FbxNode*, FbxAMatrix> clusterBind;
+    for (const PendingMesh& pending : m_pendingMeshes) {
+        FbxMesh* mesh = pending.node->GetMesh();
+        if (!mesh) {
+            continue;
+        }
+        const FbxAMatrix geometry = geometricTransform(pending.node);
+        for (int d = 0; d < mesh->GetDeformerCount(FbxDeformer::eSkin); ++d) {
+            FbxSkin* deformer = static_cast<FbxSkin*>(mesh->GetDeformer(d, FbxDeformer::eSkin));
+            for (int c = 0; c < deformer->GetClusterCount(); ++c) {
+                FbxCluster* cluster = deformer->GetCluster(c);
+                if (!cluster->GetLink()) {
+                    continue;
                 }
+                FbxAMatrix meshBind;
+                FbxAMatrix linkBind;
+                cluster->GetTransformMatrix(meshBind);
+                cluster->GetTransformLinkMatrix(linkBind);
+                clusterBind.emplace(cluster->GetLink(), linkBind.Inverse() * meshBind * geometry);
             }
         }
     }
 
-    // ndices
-    for (int i = 0; i < mesh->GetPolygonCount(); i++) {
-        for (int j = 0; j < mesh->GetPolygonSize(i); j++) {
-            indices.push_back(mesh->GetPolygonVertex(i, j));
+    std::vector<FbxAMatrix> globals;
+    std::vector<std::pair<FbxNode*, int>> stack(1, std::make_pair(root, -1));
+    while (!stack.empty()) {
+        FbxNode* node = stack.back().first;
+        int parent = stack.back().second;
+        stack.pop_back();
+
+        const FbxNodeAttribute* attribute = node->GetNodeAttribute();
+        const auto bind = clusterBind.find(node);
+        if ((attribute && attribute->GetAttributeType() == FbxNodeAttribute::eSkeleton) || bind != clusterBind.end()) {
+            const int index = static_cast<int>(skeleton.getJointCount());
+            const FbxAMatrix global = node->EvaluateGlobalTransform();
+            skeleton.names.push_back(node->GetName());
+            skeleton.parents.push_back(parent);
+            skeleton.inverseBind.push_back(toMatrix3x4(bind != clusterBind.end() ? bind->second : global.Inverse()));
+            skeleton.bindPose.push_back(toJointPose(parent >= 0 ? globals[parent].Inverse() * global : global));
+            globals.push_back(global);
+            m_jointNodes.push_back(node);
+            m_jointIndex[node] = index;
+            parent = index;
+        }
+        // Al revs para que el primer hijo salga antes de la pila.
+        for (int i = node->GetChildCount() - 1; i >= 0; --i) {
+            stack.push_back(std::make_pair(node->GetChild(i), parent));
         }
     }
 
-    MeshComponent meshData;
-    meshData.m_name = node->GetName();
-    meshData.m_vertex = vertices;
-    meshData.m_index = indices;
-    meshData.m_numVertex = vertices.size();
-    meshData.m_numIndex = indices.size();
+    if (skeleton.getJointCount() > Skeleton::kMaxJoints) {
+        ERROR("ModelLoader", "ProcessFBXSkeleton",
+            "Skeleton has " << skeleton.getJointCount() << " joints, the limit is " << Skeleton::kMaxJoints);
+        skeleton.clear();
+        m_jointNodes.clear();
+        m_jointIndex.clear();
+    }
+    else if (skeleton.getJointCount() > 0) {
+        MESSAGE("ModelLoader", "ProcessFBXSkeleton", "Imported skeleton with " << skeleton.getJointCount() << " joints");
+    }
+}
+
+/**
+ * @brief Convierte las pilas de animacin de la escena en clips.
+ *
+ * @details El evaluador del FBX SDK no es seguro entre hilos, as que se muestrea en
+ * serie; la compresin (`AnimationClip::build`) es lo barato.
+ */
+void ModelLoader::ProcessFBXAnimations() {
+    const unsigned int jointCount = skeleton.getJointCount();
+    if (jointCount == 0) {
+        return;
+    }
+
+    const double sampleRate = AnimationClip::kDefaultSampleRate;
+    std::vector<FbxAMatrix> globals(jointCount);
+    std::vector<JointPose> frames;
+    const int stackCount = lScene->GetSrcObjectCount<FbxAnimStack>();
+    for (int s = 0; s < stackCount; ++s) {
+        FbxAnimStack* stack = lScene->GetSrcObject<FbxAnimStack>(s);
+        lScene->SetCurrentAnimationStack(stack);
+        const FbxTimeSpan span = stack->GetLocalTimeSpan();
+        const double start = span.GetStart().GetSecondDouble();
+        const double length = (std::max)(0.0, span.GetStop().GetSecondDouble() - start);
+        const unsigned int frameCount = static_cast<unsigned int>(
+            (std::min)(length * sampleRate + 0.5, AnimationClip::kMaxFrames - 1.0)) + 1;
+
+        frames.resize(static_cast<size_t>(frameCount) * jointCount);
+        for (unsigned int frame = 0; frame < frameCount; ++frame) {
+            FbxTime time;
+            time.SetSecondDouble(start + frame / sampleRate);
+            for (unsigned int j = 0; j < jointCount; ++j) {
+                globals[j] = m_jointNodes[j]->EvaluateGlobalTransform(time);
+                const int parent = skeleton.parents[j];
+                frames[frame * jointCount + j] = toJointPose(parent >= 0 ? globals[parent].Inverse() * globals[j] : globals[j]);
+            }
+        }
 
-    meshes.push_back(meshData);
+        AnimationClip clip = AnimationClip::build(stack->GetName(), static_cast<float>(sampleRate), jointCount, frames);
+        if (!clip.isEmpty()) {
+            MESSAGE("ModelLoader", "ProcessFBXAnimations", "Imported clip " << stack->GetName() << ": " << frameCount
+                << " frames, " << clip.getKeyCount() << " keys (" << clip.getMemoryUsage() / 1024 << " KB)");
+            clips.push_back(std::move(clip));
+        }
+    }
+}
+
+// ============================================================================
+//  Niveles de detalle (LOD)
+// ============================================================================
+/**
+ * @brief Reparte los hijos de un `FbxLODGroup` entre `meshes` y `lods`.
+ *
+ * @details
+ * Cada hijo del grupo es un nivel completo (puede tener varias mallas). Los umbrales
+ * del grupo solo se respetan si estn en porcentaje de pantalla; en distancia
+ * dependeran de la cmara, as que se usan los valores por defecto.
+ */
+void ModelLoader::ProcessFBXLODGroup(FbxNode* node) {
+    FbxLODGroup* group = static_cast<FbxLODGroup*>(node->GetNodeAttribute());
+    const int levelCount = node->GetChildCount();
+    if (static_cast<int>(lods.size()) < levelCount - 1) {
+        lods.resize(levelCount - 1);
+    }
+
+    for (int i = 0; i < levelCount; ++i) {
+        m_lodLevel = i;
+        ProcessFBXNode(node->GetChild(i));
+    }
+    m_lodLevel = 0;
+
+    lodScreenSizes.clear();
+    const bool percentages = group->ThresholdsUsedAsPercentage.Get();
+    for (int i = 1; i < levelCount; ++i) {
+        FbxDouble percentage = 0.0;
+        if (percentages && group->GetThreshold(i - 1, percentage)) {
+            lodScreenSizes.push_back(static_cast<float>(percentage) / 100.0f);
+        }
+        else {
+            lodScreenSizes.push_back(0.5f / static_cast<float>(1 << (i - 1)));
+        }
+    }
+    MESSAGE("ModelLoader", "ProcessFBXLODGroup",
+        "Imported FbxLODGroup " << node->GetName() << " with " << levelCount << " levels");
+}
+
+/**
+ * @brief Simplifica cada submalla de `meshes` para obtener `levelCount` niveles ms.
+ *
+ * @details
+ * Cada nivel parte del anterior (no del original), que es ms rpido y da una
+ * cadena coherente. Si el archivo ya traa `FbxLODGroup` no se hace nada.
+ */
+void ModelLoader::GenerateLODs(unsigned int levelCount, float ratio) {
+    if (!lods.empty() || meshes.empty()) {
+        return;
+    }
+
+    lods.resize(levelCount);
+    lodScreenSizes.resize(levelCount);
+    const std::vector<MeshComponent>* previous = &meshes;
+    float screenSize = 0.5f;
+    for (unsigned int level = 0; level < levelCount; ++level) {
+        for (const MeshComponent& mesh : *previous) {
+            lods[level].push_back(MeshSimplifier::simplify(mesh, ratio));
+            MeshOptimizer::optimize(lods[level].back());
+            MeshletBuilder::build(lods[level].back());
+        }
+        lodScreenSizes[level] = screenSize;
+        screenSize *= ratio;
+        previous = &lods[level];
+    }
+    MESSAGE("ModelLoader", "GenerateLODs", "Generated " << levelCount << " LOD levels for " << modelName.c_str());
 }
 
 // ============================================================================
@@ -0,0 +1,121 @@
+﻿/**
+ * @file Multisampling.cpp
+ * @brief Implementación del modo MSAA de la escena y de su resolución.
+ */
+
+#include "Multisampling.h"
+#include "Device.h"
+#include "DeviceContext.h"
+#include "ShaderLibrary.h"
+#include <algorithm>
+
+namespace {
+    unsigned int groups(unsigned int size) {
+        return (size + Multisampling::kTileSize - 1) / Multisampling::kTileSize;
+    }
+}
+
+HRESULT Multisampling::init(Device& device) {
+    if (!device.m_device) {
+        ERROR("Multisampling", "init", "Device is null.");
+        return E_POINTER;
+    }
+    destroy();
+
+    // La profundidad se resuelve con un compute shader que escribe un UAV de textura.
+    if (device.m_device->GetFeatureLevel() < D3D_FEATURE_LEVEL_11_0) {
+        MESSAGE("Multisampling", "init", "Feature level < 11_0: MSAA disabled.");
+        return DXGI_ERROR_UNSUPPORTED;
+    }
+
+    ShaderKey key;
+    key.fileName = "MultisampleResolve.fx";
+    key.entryPoint = "CSResolveDepth";
+    key.profile = "cs_5_0";
+    return device.getShaderLibrary().getComputeShader(device, key, &m_resolveDepthShader);
+}
+
+void Multisampling::configure(Device& device, unsigned int samples, unsigned int quality, DXGI_FORMAT colorFormat) {
+    if (samples == m_requestedSamples && quality == m_requestedQuality && colorFormat == m_colorFormat) {
+        return;
+    }
+    m_requestedSamples = samples;
+    m_requestedQuality = quality;
+    m_colorFormat = colorFormat;
+    m_sampleCount = 1;
+    m_sampleQuality = 0;
+
+    // Potencias de dos desde la pedida: el primer número que admiten los dos formatos.
+    unsigned int count = 1;
+    while (count * 2 <= (std::min)(samples, kMaxSamples)) {
+        count *= 2;
+    }
+    for (; count > 1; count /= 2) {
+        unsigned int colorLevels = 0;
+        unsigned int depthLevels = 0;
+        if (FAILED(device.CheckMultisampleQualityLevels(colorFormat, count, &colorLevels)) ||
+            FAILED(device.CheckMultisampleQualityLevels(DXGI_FORMAT_D24_UNORM_S8_UINT, count, &depthLevels)) ||
+            colorLevels == 0 || depthLevels == 0) {
+            continue;
+        }
+        m_sampleCount = count;
+        m_sampleQuality = (std::min)(quality, (std::min)(colorLevels, depthLevels) - 1);
+        break;
+    }
+    if (samples > 1) {
+        MESSAGE("Multisampling", "configure", ("MSAA " + std::to_string(m_sampleCount) + "x, quality " +
+            std::to_string(m_sampleQuality) + ".").c_str());
+    }
+}
+
+RenderTargetPool::Desc Multisampling::colorDesc(unsigned int width, unsigned int height, DXGI_FORMAT format) const {
+    RenderTargetPool::Desc desc;
+    desc.width = width;
+    desc.height = height;
+    desc.format = format;
+    desc.bindFlags = D3D11_BIND_RENDER_TARGET;
+    desc.sampleCount = m_sampleCount;
+    desc.sampleQuality = m_sampleQuality;
+    return desc;
+}
+
+void Multisampling::applyTo(RenderTargetPool::Desc& depthDesc) const {
+    depthDesc.sampleCount = m_sampleCount;
+    depthDesc.sampleQuality = m_sampleQuality;
+}
+
+RenderTargetPool::Desc Multisampling::resolvedDepthDesc(unsigned int width, unsigned int height) {
+    RenderTargetPool::Desc desc;
+    desc.width = width;
+    desc.height = height;
+    desc.format = kResolvedDepthFormat;
+    desc.bindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_UNORDERED_ACCESS;
+    return desc;
+}
+
+void Multisampling::resolve(DeviceContext& deviceContext, ID3D11Texture2D* color, ID3D11Texture2D* target,
+    DXGI_FORMAT format, ID3D11ShaderResourceView* depthSRV, const RenderTargetPool::Target& resolvedDepth,
+    unsigned int width, unsigned int height) {
+    if (!isReady() || !color || !target || !depthSRV || !resolvedDepth.uav) {
+        return;
+    }
+    deviceContext.ResolveSubresource(target, 0, color, 0, format);
+
+    // La profundidad sigue enlazada como DSV del pase "Scene".
+    deviceContext.OMSetRenderTargets(0, nullptr, nullptr);
+    ID3D11ShaderResourceView* nullSRV = nullptr;
+    ID3D11UnorderedAccessView* nullUAV = nullptr;
+    ID3D11UnorderedAccessView* depthUAV = resolvedDepth.uav;
+    deviceContext.CSSetShader(m_resolveDepthShader, nullptr, 0);
+    deviceContext.CSSetShaderResources(0, 1, &depthSRV);
+    deviceContext.CSSetUnorderedAccessViews(0, 1, &depthUAV, nullptr);
+    deviceContext.Dispatch(groups(width), groups(height), 1);
+
+    deviceContext.CSSetShaderResources(0, 1, &nullSRV);
+    deviceContext.CSSetUnorderedAccessViews(0, 1, &nullUAV, nullptr);
+    deviceContext.CSSetShader(nullptr, nullptr, 0);
+}
+
+void Multisampling::destroy() {
+    SAFE_RELEASE(m_resolveDepthShader);
+}
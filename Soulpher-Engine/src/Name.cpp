@@ -0,0 +1,99 @@
+﻿/**
+ * @file Name.cpp
+ * @brief Tabla de internado: hash abierto sobre los ids y bloques de entradas estables.
+ */
+
+#include "Name.h"
+
+namespace {
+    uint32_t hashText(const char* text, size_t length) {
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < length; ++i) {
+            hash = (hash ^ static_cast<unsigned char>(text[i])) * 16777619u;
+        }
+        return hash;
+    }
+}
+
+NameTable& NameTable::get() {
+    static NameTable s_table;
+    return s_table;
+}
+
+NameTable::NameTable() {
+    // La entrada 0 es la cadena vacía: un `Name` por defecto resuelve a "".
+    m_chunks[0].store(new Entry[kChunkSize], std::memory_order_release);
+    m_count.store(1, std::memory_order_release);
+    m_slots.assign(1024, 0);
+}
+
+NameTable::~NameTable() {
+    for (std::atomic<Entry*>& chunk : m_chunks) {
+        delete[] chunk.load(std::memory_order_relaxed);
+    }
+}
+
+uint32_t NameTable::intern(const char* text, size_t length) {
+    if (length == 0) {
+        return 0;
+    }
+    const uint32_t hash = hashText(text, length);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const uint32_t mask = static_cast<uint32_t>(m_slots.size()) - 1;
+    uint32_t slot = hash & mask;
+    while (const uint32_t id = m_slots[slot]) {
+        const Entry& existing = *entry(id);
+        if (existing.hash == hash && existing.text.size() == length &&
+            memcmp(existing.text.data(), text, length) == 0) {
+            return id;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    const uint32_t id = m_count.load(std::memory_order_relaxed);
+    const uint32_t chunk = id / kChunkSize;
+    if (chunk >= kMaxChunks) {
+        ERROR("NameTable", "intern", ("Name table is full, dropping " + std::string(text, length)).c_str());
+        return 0;
+    }
+    if (id % kChunkSize == 0) {
+        m_chunks[chunk].store(new Entry[kChunkSize], std::memory_order_release);
+    }
+    Entry& created = m_chunks[chunk].load(std::memory_order_relaxed)[id % kChunkSize];
+    created.text.assign(text, length);
+    created.hash = hash;
+    m_slots[slot] = id;
+    // Se publica después de escribir la entrada: `resolve` no ve ids a medio construir.
+    m_count.store(id + 1, std::memory_order_release);
+
+    // Carga máxima del 50 %: las sondas siguen siendo cortas.
+    if ((id + 1) * 2 > m_slots.size()) {
+        grow();
+    }
+    return id;
+}
+
+void NameTable::grow() {
+    std::vector<uint32_t> slots(m_slots.size() * 2, 0);
+    const uint32_t mask = static_cast<uint32_t>(slots.size()) - 1;
+    const uint32_t count = m_count.load(std::memory_order_relaxed);
+    for (uint32_t id = 1; id < count; ++id) {
+        uint32_t slot = entry(id)->hash & mask;
+        while (slots[slot]) {
+            slot = (slot + 1) & mask;
+        }
+        slots[slot] = id;
+    }
+    m_slots.swap(slots);
+}
+
+const std::string& NameTable::resolve(uint32_t id) const {
+    const Entry* found = entry(id);
+    return found ? found->text : entry(0)->text;
+}
+
+uint32_t NameTable::getHash(uint32_t id) const {
+    const Entry* found = entry(id);
+    return found ? found->hash : 0;
+}
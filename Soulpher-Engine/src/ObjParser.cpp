@@ -0,0 +1,192 @@
+﻿/**
+ * @file ObjParser.cpp
+ * @brief Implementación del lector OBJ mapeado y paralelo.
+ */
+
+#include "ObjParser.h"
+#include "VirtualFileSystem.h"
+#include <cstdint>
+#include <unordered_map>
+
+namespace {
+    /// Índice de un atributo tal como se leyó: absoluto o relativo al tramo.
+    struct ObjIndex {
+        int value = -1;        ///< Base 0; -1 = ausente.
+        bool relative = false; ///< `value` cuenta desde el inicio del tramo (índice negativo en el OBJ).
+    };
+
+    struct ChunkCorner {
+        ObjIndex position;
+        ObjIndex texcoord;
+    };
+
+    /// Lo que produce un tramo del archivo, antes de unirlo con los demás.
+    struct Chunk {
+        const char* begin = nullptr;
+        const char* end = nullptr;
+        std::vector<XMFLOAT3> positions;
+        std::vector<XMFLOAT2> texcoords;
+        std::vector<ChunkCorner> corners;        ///< Esquinas de todas las caras, seguidas.
+        std::vector<unsigned int> polygons; ///< Esquinas de cada cara.
+        bool valid = true;
+    };
+
+    /// Pasa un índice del OBJ a base 0 (los negativos, relativos al tramo).
+    ObjIndex toIndex(int value, size_t localCount) {
+        ObjIndex index;
+        if (value != 0) {
+            index.relative = value < 0;
+            index.value = value < 0 ? static_cast<int>(localCount) + value : value - 1;
+        }
+        return index;
+    }
+
+    /// Visitante de @ref ObjParser::parse que guarda el tramo en memoria.
+    struct ChunkVisitor {
+        Chunk& chunk;
+
+        void position(const XMFLOAT3& v) { chunk.positions.push_back(v); }
+        void texcoord(const XMFLOAT2& t) { chunk.texcoords.push_back(t); }
+        void face(const ObjParser::Corner* corners, unsigned int count) {
+            for (unsigned int i = 0; i < count; ++i) {
+                ChunkCorner corner;
+                corner.position = toIndex(corners[i].position, chunk.positions.size());
+                corner.texcoord = toIndex(corners[i].texcoord, chunk.texcoords.size());
+                chunk.corners.push_back(corner);
+            }
+            chunk.polygons.push_back(count);
+        }
+    };
+
+    void parseChunk(Chunk& chunk) {
+        ChunkVisitor visitor = { chunk };
+        chunk.valid = ObjParser::parse(chunk.begin, chunk.end, visitor);
+    }
+
+    /// Índice global de un atributo (o -1 si está fuera de rango).
+    int resolve(const ObjIndex& index, size_t chunkBase, size_t total) {
+        const long long value = index.relative
+            ? static_cast<long long>(chunkBase) + index.value
+            : static_cast<long long>(index.value);
+        return (value >= 0 && value < static_cast<long long>(total)) ? static_cast<int>(value) : -1;
+    }
+}
+
+bool ObjParser::load(const std::string& path, MeshComponent& mesh, unsigned int threadCount) {
+    mesh = MeshComponent();
+
+    FileView file;
+    if (!VirtualFileSystem::getDefault().open(path, file)) {
+        ERROR("ObjParser", "load", ("Cannot open " + path).c_str());
+        return false;
+    }
+    const char* data = reinterpret_cast<const char*>(file.getData());
+    const size_t size = file.getSize();
+
+    // 1) Tramos terminados en salto de línea, como mucho uno por hilo.
+    if (threadCount == 0) {
+        threadCount = std::thread::hardware_concurrency();
+    }
+    const size_t byWork = (std::max)(size / kMinChunkBytes, size_t(1));
+    const size_t chunkCount = (std::min)(static_cast<size_t>((std::max)(threadCount, 1u)), byWork);
+
+    std::vector<Chunk> chunks(chunkCount);
+    const char* cursor = data;
+    for (size_t i = 0; i < chunkCount; ++i) {
+        const char* end = (i + 1 == chunkCount) ? data + size : data + size * (i + 1) / chunkCount;
+        if (end < cursor) {
+            end = cursor;
+        }
+        end = (i + 1 == chunkCount) ? end : ObjParser::skipLine(end, data + size);
+        chunks[i].begin = cursor;
+        chunks[i].end = end;
+        cursor = end;
+    }
+
+    // 2) Análisis en paralelo; el hilo que llama analiza el primer tramo.
+    std::vector<std::thread> workers;
+    workers.reserve(chunkCount - 1);
+    for (size_t i = 1; i < chunkCount; ++i) {
+        workers.push_back(std::thread(parseChunk, std::ref(chunks[i])));
+    }
+    parseChunk(chunks[0]);
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    // 3) Unión en orden del archivo.
+    size_t positionTotal = 0, texcoordTotal = 0, cornerTotal = 0;
+    for (const Chunk& chunk : chunks) {
+        if (!chunk.valid) {
+            ERROR("ObjParser", "load", ("Malformed line in " + path).c_str());
+            return false;
+        }
+        positionTotal += chunk.positions.size();
+        texcoordTotal += chunk.texcoords.size();
+        cornerTotal += chunk.corners.size();
+    }
+    std::vector<XMFLOAT3> positions;
+    std::vector<XMFLOAT2> texcoords;
+    std::vector<size_t> positionBase(chunkCount), texcoordBase(chunkCount);
+    positions.reserve(positionTotal);
+    texcoords.reserve(texcoordTotal);
+    for (size_t i = 0; i < chunkCount; ++i) {
+        positionBase[i] = positions.size();
+        texcoordBase[i] = texcoords.size();
+        positions.insert(positions.end(), chunks[i].positions.begin(), chunks[i].positions.end());
+        texcoords.insert(texcoords.end(), chunks[i].texcoords.begin(), chunks[i].texcoords.end());
+    }
+
+    // 4) Triangulación en abanico y soldadura por par (posición, UV).
+    std::unordered_map<uint64_t, unsigned int> weld;
+    weld.reserve(cornerTotal);
+    mesh.m_vertex.reserve(positionTotal);
+    mesh.m_index.reserve(cornerTotal * 2);
+
+    std::vector<unsigned int> polygon;
+    for (size_t i = 0; i < chunkCount; ++i) {
+        const Chunk& chunk = chunks[i];
+        size_t corner = 0;
+        for (unsigned int count : chunk.polygons) {
+            polygon.clear();
+            for (unsigned int k = 0; k < count; ++k, ++corner) {
+                const ChunkCorner& c = chunk.corners[corner];
+                const int position = resolve(c.position, positionBase[i], positionTotal);
+                const bool hasTexcoord = c.texcoord.relative || c.texcoord.value >= 0;
+                const int texcoord = hasTexcoord ? resolve(c.texcoord, texcoordBase[i], texcoordTotal) : -1;
+                if (position < 0 || (hasTexcoord && texcoord < 0)) {
+                    ERROR("ObjParser", "load", ("Face index out of range in " + path).c_str());
+                    mesh = MeshComponent();
+                    return false;
+                }
+
+                const uint64_t key = (static_cast<uint64_t>(position) << 32) | static_cast<uint32_t>(texcoord);
+                auto inserted = weld.emplace(key, static_cast<unsigned int>(mesh.m_vertex.size()));
+                if (inserted.second) {
+                    SimpleVertex vertex{ positions[position], XMFLOAT2(0.0f, 0.0f) };
+                    if (hasTexcoord) {
+                        vertex.Tex = XMFLOAT2(texcoords[texcoord].x, 1.0f - texcoords[texcoord].y);
+                    }
+                    mesh.m_vertex.push_back(vertex);
+                }
+                polygon.push_back(inserted.first->second);
+            }
+            for (unsigned int k = 1; k + 1 < count; ++k) {
+                mesh.m_index.push_back(polygon[0]);
+                mesh.m_index.push_back(polygon[k]);
+                mesh.m_index.push_back(polygon[k + 1]);
+            }
+        }
+    }
+    if (mesh.m_index.empty()) {
+        ERROR("ObjParser", "load", ("No faces in " + path).c_str());
+        mesh = MeshComponent();
+        return false;
+    }
+
+    mesh.m_name = path;
+    mesh.m_numVertex = static_cast<int>(mesh.m_vertex.size());
+    mesh.m_numIndex = static_cast<int>(mesh.m_index.size());
+    mesh.computeBounds();
+    return true;
+}
@@ -0,0 +1,161 @@
+﻿/**
+ * @file OcclusionPredicates.cpp
+ * @brief Implementación de las occlusion queries predicadas.
+ *
+ * @details
+ * Todas las cajas se lanzan antes que el primer actor: entre la query de un actor y
+ * su draw pasan los de las demás cajas, y el predicado tiene más margen para estar
+ * resuelto cuando la GPU llega a él.
+ */
+
+#include "OcclusionPredicates.h"
+#include "Device.h"
+#include "DeviceContext.h"
+#include "VertexLayout.h"
+#include "ECS/Actor.h"
+
+HRESULT OcclusionPredicates::init(Device& device) {
+    if (!device.m_device) {
+        ERROR("OcclusionPredicates", "init", "Device is null.");
+        return E_POINTER;
+    }
+    destroy();
+
+    // Caja unidad: esquina i = (i & 1, i & 2, i & 4).
+    const float corners[8][3] = {
+        { 0.0f, 0.0f, 0.0f }, { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 1.0f, 1.0f, 0.0f },
+        { 0.0f, 0.0f, 1.0f }, { 1.0f, 0.0f, 1.0f }, { 0.0f, 1.0f, 1.0f }, { 1.0f, 1.0f, 1.0f },
+    };
+    const unsigned int indices[36] = {
+        0, 2, 1, 1, 2, 3,   4, 5, 6, 5, 7, 6,   // -Z, +Z
+        0, 1, 4, 1, 5, 4,   2, 6, 3, 3, 6, 7,   // -Y, +Y
+        0, 4, 2, 2, 4, 6,   1, 3, 5, 3, 7, 5,   // -X, +X
+    };
+
+    HRESULT hr = m_boxProgram.initVertexOnly(device, "OcclusionBox.fx",
+        VertexLayout().add("POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT).getDesc());
+    if (SUCCEEDED(hr)) { hr = m_boxVertices.initVertices(device, corners, sizeof(corners[0]), 8); }
+    if (SUCCEEDED(hr)) { hr = m_boxIndices.initIndices(device, indices, 36, true); }
+    if (SUCCEEDED(hr)) { hr = m_boxConstants.init(device); }
+    // Sin escribir Z: la caja solo cuenta muestras, no tapa nada.
+    if (SUCCEEDED(hr)) { hr = m_testState.init(device, true, false, false, D3D11_COMPARISON_LESS_EQUAL); }
+    if (SUCCEEDED(hr)) {
+        // Sin culling: si el orden de las caras no cuadra, la prueba sigue siendo conservadora.
+        D3D11_RASTERIZER_DESC desc = {};
+        desc.FillMode = D3D11_FILL_SOLID;
+        desc.CullMode = D3D11_CULL_NONE;
+        desc.DepthClipEnable = TRUE;
+        hr = device.CreateSharedRasterizerState(&desc, &m_boxRasterizer);
+    }
+    if (FAILED(hr)) {
+        ERROR("OcclusionPredicates", "init", ("Failed to create the occlusion box. hr=" + std::to_string(hr)).c_str());
+        destroy();
+        return hr;
+    }
+    m_device = &device;
+    return S_OK;
+}
+
+bool OcclusionPredicates::add(Actor& actor) {
+    XMFLOAT3 mn, mx;
+    if (!isReady() || !actor.usesOcclusionQuery() || actor.isTransparent() || actor.isBatched() ||
+        actor.getMeshAsset().isNull() || !actor.getWorldBounds(mn, mx)) {
+        return false;
+    }
+    m_actors.push_back(&actor);
+    return true;
+}
+
+void OcclusionPredicates::render(DeviceContext& deviceContext, const XMFLOAT3& eye, float nearPlane,
+    ShaderProgram& program, ShaderProgram* receiverProgram) {
+    m_queryCount = 0;
+    if (m_actors.empty()) {
+        return;
+    }
+    if (FAILED(reserve(static_cast<unsigned int>(m_actors.size())))) {
+        ERROR("OcclusionPredicates", "render", "Failed to create predicates; drawing without them");
+    }
+    DeviceContext::EventScope event(deviceContext, "Occlusion predicates");
+
+    // 1) Cajas: una query por actor (salvo con la cámara dentro o casi).
+    m_framePredicates.assign(m_actors.size(), nullptr);
+    m_boxProgram.render(deviceContext);
+    m_testState.render(deviceContext, 0);
+    deviceContext.RSSetState(m_boxRasterizer);
+    deviceContext.IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    m_boxVertices.render(deviceContext, VERTEX_STREAM_GEOMETRY, 1);
+    m_boxIndices.render(deviceContext, 0, 1, false, DXGI_FORMAT_R16_UINT);
+    const float margin = 2.0f * nearPlane;
+    for (size_t i = 0; i < m_actors.size() && i < m_predicates.size(); ++i) {
+        XMFLOAT3 mn, mx;
+        m_actors[i]->getWorldBounds(mn, mx);
+        if (eye.x >= mn.x - margin && eye.x <= mx.x + margin &&
+            eye.y >= mn.y - margin && eye.y <= mx.y + margin &&
+            eye.z >= mn.z - margin && eye.z <= mx.z + margin) {
+            continue;
+        }
+        CBChangesEveryFrame box;
+        box.mWorld = XMMatrixTranspose(XMMatrixMultiply(
+            XMMatrixScaling(mx.x - mn.x, mx.y - mn.y, mx.z - mn.z),
+            XMMatrixTranslation(mn.x, mn.y, mn.z)));
+        box.vMeshColor = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
+        m_boxConstants.set(box);
+        m_boxConstants.update(deviceContext);
+        m_boxConstants.render(deviceContext, CB_SLOT_OBJECT);
+
+        ID3D11Predicate* predicate = m_predicates[i];
+        deviceContext.m_deviceContext->Begin(predicate);
+        deviceContext.DrawIndexed(36, 0, 0);
+        deviceContext.m_deviceContext->End(predicate);
+        m_framePredicates[i] = predicate;
+        ++m_queryCount;
+    }
+    m_testState.render(deviceContext, 0, true);
+
+    // 2) Actores: cada uno bajo su predicado (FALSE = se descarta si no pasó ninguna muestra).
+    ShaderProgram* lastProgram = nullptr;
+    for (size_t i = 0; i < m_actors.size(); ++i) {
+        Actor& actor = *m_actors[i];
+        ShaderProgram* target = (actor.getReceiveShadow() && receiverProgram) ? receiverProgram : &program;
+        if (target != lastProgram) {
+            target->render(deviceContext);
+            lastProgram = target;
+        }
+        deviceContext.m_deviceContext->SetPredication(m_framePredicates[i], FALSE);
+        actor.render(deviceContext);
+    }
+    deviceContext.m_deviceContext->SetPredication(nullptr, FALSE);
+}
+
+HRESULT OcclusionPredicates::reserve(unsigned int count) {
+    D3D11_QUERY_DESC desc = {};
+    desc.Query = D3D11_QUERY_OCCLUSION_PREDICATE;
+    // Pista: si el resultado no está listo, el driver puede dibujar sin esperar.
+    desc.MiscFlags = D3D11_QUERY_MISC_PREDICATEHINT;
+    while (m_predicates.size() < count) {
+        ID3D11Predicate* predicate = nullptr;
+        HRESULT hr = m_device->m_device->CreatePredicate(&desc, &predicate);
+        if (FAILED(hr)) {
+            return hr;
+        }
+        m_predicates.push_back(predicate);
+    }
+    return S_OK;
+}
+
+void OcclusionPredicates::destroy() {
+    for (ID3D11Predicate*& predicate : m_predicates) {
+        SAFE_RELEASE(predicate);
+    }
+    m_predicates.clear();
+    m_framePredicates.clear();
+    m_actors.clear();
+    m_boxProgram.destroy();
+    m_boxVertices.destroy();
+    m_boxIndices.destroy();
+    m_boxConstants.destroy();
+    m_testState.destroy();
+    SAFE_RELEASE(m_boxRasterizer);
+    m_device = nullptr;
+    m_queryCount = 0;
+}
@@ -0,0 +1,133 @@
+﻿/**
+ * @file PointerBenchmark.cpp
+ * @brief Implementación del microbenchmark de punteros.
+ */
+
+#include "PointerBenchmark.h"
+#include <chrono>
+#include <fstream>
+#include <memory>
+
+namespace {
+    /// Objeto pequeño típico (un componente con un par de vectores).
+    struct Payload {
+        float values[12] = { 1.0f };
+    };
+
+    /// El mismo objeto, marcado para que `MakeShared` use su pool de bloques.
+    struct PooledPayload {
+        float values[12] = { 1.0f };
+    };
+
+    template<typename Policy>
+    struct CountedPayload : EU::TRefCounted<Policy> {
+        float values[12] = { 1.0f };
+    };
+
+}
+
+namespace EU { template<> struct TUsePool<PooledPayload> : std::true_type {}; }
+
+namespace {
+    // Se escribe al final de cada caso para que el compilador no elimine el bucle.
+    volatile float g_sink = 0.0f;
+
+    typedef std::chrono::steady_clock Clock;
+
+    double nsPerOp(Clock::time_point start, unsigned int iterations) {
+        const double ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+        return ns / iterations;
+    }
+
+    /// Crea `iterations` objetos en lotes (todos vivos a la vez dentro del lote) y los destruye.
+    template<typename Ptr, typename Make>
+    double create(unsigned int iterations, const Make& make) {
+        const unsigned int kBatch = 1024;
+        std::vector<Ptr> pointers(kBatch);
+        const Clock::time_point start = Clock::now();
+        for (unsigned int done = 0; done < iterations; done += kBatch) {
+            for (Ptr& pointer : pointers) {
+                pointer = make();
+            }
+            for (Ptr& pointer : pointers) {
+                pointer = Ptr();
+            }
+        }
+        return nsPerOp(start, iterations);
+    }
+
+    /// Copia y suelta un puntero `iterations` veces.
+    template<typename Ptr>
+    double copy(unsigned int iterations, const Ptr& source) {
+        float sum = 0.0f;
+        const Clock::time_point start = Clock::now();
+        for (unsigned int i = 0; i < iterations; ++i) {
+            Ptr copy(source);
+            sum += copy->values[0];
+        }
+        g_sink = sum;
+        return nsPerOp(start, iterations);
+    }
+
+    /// Lee un campo de cada objeto de un vector de punteros (repetido hasta `iterations`).
+    template<typename Ptr, typename Make>
+    double read(unsigned int iterations, const Make& make) {
+        const unsigned int kCount = 65536;
+        std::vector<Ptr> pointers;
+        pointers.reserve(kCount);
+        for (unsigned int i = 0; i < kCount; ++i) {
+            pointers.push_back(make());
+        }
+        float sum = 0.0f;
+        const Clock::time_point start = Clock::now();
+        for (unsigned int i = 0; i < iterations; ++i) {
+            sum += pointers[i % kCount]->values[i % 12];
+        }
+        g_sink = sum;
+        return nsPerOp(start, iterations);
+    }
+
+    template<typename Ptr, typename Make>
+    void measurePointer(std::vector<PointerBenchmark::Result>& results, const char* name,
+        unsigned int iterations, const Make& make) {
+        results.push_back({ "create", name, create<Ptr>(iterations, make) });
+        results.push_back({ "copy", name, copy<Ptr>(iterations, make()) });
+        results.push_back({ "read", name, read<Ptr>(iterations, make) });
+    }
+}
+
+std::vector<PointerBenchmark::Result> PointerBenchmark::measure(unsigned int iterations) {
+    iterations = (std::max)(iterations, 1024u);
+    std::vector<Result> results;
+    measurePointer<EU::TSharedPointer<Payload>>(results, "TSharedPointer(new T)", iterations,
+        []() { return EU::TSharedPointer<Payload>(new Payload()); });
+    measurePointer<EU::TSharedPointer<Payload>>(results, "MakeShared", iterations,
+        []() { return EU::MakeShared<Payload>(); });
+    measurePointer<EU::TSharedPointer<PooledPayload>>(results, "MakeShared (pool)", iterations,
+        []() { return EU::MakeShared<PooledPayload>(); });
+    measurePointer<EU::TAtomicSharedPointer<Payload>>(results, "MakeAtomicShared", iterations,
+        []() { return EU::MakeAtomicShared<Payload>(); });
+    measurePointer<EU::TIntrusivePointer<CountedPayload<EU::SingleThreadRefCount>>>(results, "TIntrusivePointer", iterations,
+        []() { return EU::MakeIntrusive<CountedPayload<EU::SingleThreadRefCount>>(); });
+    measurePointer<EU::TIntrusivePointer<CountedPayload<EU::AtomicRefCount>>>(results, "TIntrusivePointer (atomic)", iterations,
+        []() { return EU::MakeIntrusive<CountedPayload<EU::AtomicRefCount>>(); });
+    measurePointer<std::shared_ptr<Payload>>(results, "std::make_shared", iterations,
+        []() { return std::make_shared<Payload>(); });
+    return results;
+}
+
+HRESULT PointerBenchmark::run(const std::string& csvPath, unsigned int iterations) {
+    const std::vector<Result> results = measure(iterations);
+    std::ofstream csv(csvPath.c_str(), std::ios::trunc);
+    if (!csv) {
+        ERROR("PointerBenchmark", "run", ("Cannot write " + csvPath).c_str());
+        return E_FAIL;
+    }
+    csv << "test,pointer,ns\n";
+    for (const Result& result : results) {
+        csv << result.test << ",\"" << result.pointer << "\"," << result.nsPerOp << '\n';
+        MESSAGE("PointerBenchmark", result.test, (std::string(result.pointer) + ": " +
+            std::to_string(result.nsPerOp) + " ns").c_str());
+    }
+    return S_OK;
+}
@@ -0,0 +1,298 @@
+﻿/**
+ * @file PostProcess.cpp
+ * @brief Implementación de la cadena HDR: bloom, exposición automática y pase final.
+ */
+
+#include "PostProcess.h"
+#include "Device.h"
+#include "DeviceContext.h"
+#include "ShaderLibrary.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+    RenderTargetPool::Desc targetDesc(unsigned int width, unsigned int height, DXGI_FORMAT format,
+        unsigned int bindFlags) {
+        RenderTargetPool::Desc desc;
+        desc.width = width;
+        desc.height = height;
+        desc.format = format;
+        desc.bindFlags = bindFlags;
+        return desc;
+    }
+
+    unsigned int bloomSize(unsigned int size, unsigned int level) {
+        return (std::max)(1u, size >> (level + 1));
+    }
+
+    unsigned int groups(unsigned int size, unsigned int tile) {
+        return (size + tile - 1) / tile;
+    }
+}
+
+const ConstantBufferLayouts::Registration PostProcess::kParamsLayout({ "cbPost", CB_SLOT_POST, sizeof(PostParams), {
+    CB_FIELD(PostParams, size, "PostSize"),
+    CB_FIELD(PostParams, bloom, "BloomParams"),
+    CB_FIELD(PostParams, exposure, "ExposureParams"),
+    CB_FIELD(PostParams, tone, "ToneParams") } });
+
+HRESULT PostProcess::init(Device& device) {
+    if (!device.m_device) {
+        ERROR("PostProcess", "init", "Device is null.");
+        return E_POINTER;
+    }
+    destroy();
+
+    // UAV de texturas y buffers en compute: nivel 11_0.
+    if (device.m_device->GetFeatureLevel() < D3D_FEATURE_LEVEL_11_0) {
+        MESSAGE("PostProcess", "init", "Feature level < 11_0: HDR post-processing disabled.");
+        return DXGI_ERROR_UNSUPPORTED;
+    }
+
+    D3D11_BUFFER_DESC paramsDesc = {};
+    paramsDesc.Usage = D3D11_USAGE_DEFAULT;
+    paramsDesc.ByteWidth = sizeof(PostParams);
+    paramsDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+    HRESULT hr = device.CreateBuffer(&paramsDesc, nullptr, &m_params);
+
+    // Histograma a cero: después lo vacía cada `CSExposure`.
+    const std::vector<uint32_t> zeros(kHistogramBins, 0u);
+    D3D11_SUBRESOURCE_DATA histogramData = {};
+    histogramData.pSysMem = zeros.data();
+    D3D11_BUFFER_DESC histogramDesc = {};
+    histogramDesc.Usage = D3D11_USAGE_DEFAULT;
+    histogramDesc.ByteWidth = kHistogramBins * sizeof(uint32_t);
+    histogramDesc.BindFlags = D3D11_BIND_UNORDERED_ACCESS;
+    histogramDesc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_ALLOW_RAW_VIEWS;
+    if (SUCCEEDED(hr)) { hr = device.CreateBuffer(&histogramDesc, &histogramData, &m_histogram); }
+
+    D3D11_UNORDERED_ACCESS_VIEW_DESC histogramUAVDesc = {};
+    histogramUAVDesc.Format = DXGI_FORMAT_R32_TYPELESS;
+    histogramUAVDesc.ViewDimension = D3D11_UAV_DIMENSION_BUFFER;
+    histogramUAVDesc.Buffer.NumElements = kHistogramBins;
+    histogramUAVDesc.Buffer.Flags = D3D11_BUFFER_UAV_FLAG_RAW;
+    if (SUCCEEDED(hr)) { hr = device.CreateUnorderedAccessView(m_histogram, &histogramUAVDesc, &m_histogramUAV); }
+
+    // Exposición 1 hasta la primera adaptación.
+    const float initialExposure[2] = { 1.0f, 0.18f };
+    D3D11_SUBRESOURCE_DATA exposureData = {};
+    exposureData.pSysMem = initialExposure;
+    D3D11_BUFFER_DESC exposureDesc = {};
+    exposureDesc.Usage = D3D11_USAGE_DEFAULT;
+    exposureDesc.ByteWidth = sizeof(initialExposure);
+    exposureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_UNORDERED_ACCESS;
+    if (SUCCEEDED(hr)) { hr = device.CreateBuffer(&exposureDesc, &exposureData, &m_exposure); }
+
+    D3D11_SHADER_RESOURCE_VIEW_DESC exposureSRVDesc = {};
+    exposureSRVDesc.Format = DXGI_FORMAT_R32_FLOAT;
+    exposureSRVDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+    exposureSRVDesc.Buffer.NumElements = 2;
+    if (SUCCEEDED(hr)) { hr = device.CreateShaderResourceView(m_exposure, &exposureSRVDesc, &m_exposureSRV); }
+
+    D3D11_UNORDERED_ACCESS_VIEW_DESC exposureUAVDesc = {};
+    exposureUAVDesc.Format = DXGI_FORMAT_R32_FLOAT;
+    exposureUAVDesc.ViewDimension = D3D11_UAV_DIMENSION_BUFFER;
+    exposureUAVDesc.Buffer.NumElements = 2;
+    if (SUCCEEDED(hr)) { hr = device.CreateUnorderedAccessView(m_exposure, &exposureUAVDesc, &m_exposureUAV); }
+
+    D3D11_SAMPLER_DESC samplerDesc = {};
+    samplerDesc.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+    samplerDesc.AddressU = D3D11_TEXTURE_ADDRESS_CLAMP;
+    samplerDesc.AddressV = D3D11_TEXTURE_ADDRESS_CLAMP;
+    samplerDesc.AddressW = D3D11_TEXTURE_ADDRESS_CLAMP;
+    samplerDesc.ComparisonFunc = D3D11_COMPARISON_NEVER;
+    samplerDesc.MaxLOD = D3D11_FLOAT32_MAX;
+    if (SUCCEEDED(hr)) { hr = device.CreateSharedSamplerState(&samplerDesc, &m_sampler); }
+
+    if (FAILED(hr)) {
+        ERROR("PostProcess", "init", ("Failed to create the post-processing buffers. hr=" + std::to_string(hr)).c_str());
+        destroy();
+        return hr;
+    }
+
+    ShaderLibrary& library = device.getShaderLibrary();
+    ShaderKey key;
+    key.fileName = "PostProcess.fx";
+    key.profile = "cs_5_0";
+    key.entryPoint = "CSBloomDown";
+    hr = library.getComputeShader(device, key, &m_downShader);
+    if (SUCCEEDED(hr)) {
+        key.entryPoint = "CSBloomUp";
+        hr = library.getComputeShader(device, key, &m_upShader);
+    }
+    if (SUCCEEDED(hr)) {
+        key.entryPoint = "CSHistogram";
+        hr = library.getComputeShader(device, key, &m_histogramShader);
+    }
+    if (SUCCEEDED(hr)) {
+        key.entryPoint = "CSExposure";
+        hr = library.getComputeShader(device, key, &m_exposureShader);
+    }
+    if (SUCCEEDED(hr)) {
+        key.entryPoint = "VSTonemap";
+        key.profile = "vs_5_0";
+        hr = library.getVertexShader(device, key, &m_vertexShader);
+    }
+    if (SUCCEEDED(hr)) {
+        key.entryPoint = "PSTonemap";
+        key.profile = "ps_5_0";
+        hr = library.getPixelShader(device, key, &m_pixelShader);
+    }
+    if (FAILED(hr)) {
+        destroy();
+        return hr;
+    }
+    return S_OK;
+}
+
+RenderTargetPool::Desc PostProcess::sceneDesc(unsigned int width, unsigned int height) {
+    return targetDesc(width, height, kSceneFormat, D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE);
+}
+
+RenderTargetPool::Desc PostProcess::bloomDesc(unsigned int width, unsigned int height, unsigned int level) {
+    return targetDesc(bloomSize(width, level), bloomSize(height, level), kSceneFormat,
+        D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_UNORDERED_ACCESS);
+}
+
+RenderTargetPool::Desc PostProcess::interfaceDesc(unsigned int width, unsigned int height) {
+    return targetDesc(width, height, DXGI_FORMAT_R8G8B8A8_UNORM, D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE);
+}
+
+void PostProcess::fillParams(unsigned int dstWidth, unsigned int dstHeight, unsigned int srcWidth,
+    unsigned int srcHeight) {
+    const float logRange = (std::max)(m_settings.maxLogLuminance - m_settings.minLogLuminance, 1e-3f);
+    m_paramsData.size = XMFLOAT4(static_cast<float>(dstWidth), static_cast<float>(dstHeight),
+        static_cast<float>(srcWidth), static_cast<float>(srcHeight));
+    m_paramsData.bloom = XMFLOAT4(m_settings.bloomThreshold, m_settings.bloomKnee, m_settings.bloomIntensity, 0.0f);
+    m_paramsData.exposure = XMFLOAT4(m_settings.minLogLuminance, logRange, 0.0f, m_settings.exposure);
+    m_paramsData.tone = XMFLOAT4(1.0f / (std::max)(m_settings.gamma, 0.1f), exp2f(m_settings.exposure),
+        m_settings.autoExposure ? 1.0f : 0.0f, 0.0f);
+}
+
+void PostProcess::bloom(DeviceContext& deviceContext, ID3D11ShaderResourceView* sceneSRV,
+    const RenderTargetPool::Target* down, const RenderTargetPool::Target* up,
+    unsigned int width, unsigned int height) {
+    if (!isReady() || !sceneSRV) {
+        return;
+    }
+    ID3D11ShaderResourceView* nullSRVs[2] = { nullptr, nullptr };
+    ID3D11UnorderedAccessView* nullUAV = nullptr;
+    deviceContext.CSSetConstantBuffers(CB_SLOT_POST, 1, &m_params);
+
+    // Bajada: escena -> down[0] (con umbral) -> ... -> down[n-1].
+    deviceContext.CSSetShader(m_downShader, nullptr, 0);
+    for (unsigned int level = 0; level < kBloomLevels; ++level) {
+        const unsigned int srcWidth = level == 0 ? width : bloomSize(width, level - 1);
+        const unsigned int srcHeight = level == 0 ? height : bloomSize(height, level - 1);
+        const unsigned int dstWidth = bloomSize(width, level);
+        const unsigned int dstHeight = bloomSize(height, level);
+        fillParams(dstWidth, dstHeight, srcWidth, srcHeight);
+        m_paramsData.bloom.w = level == 0 ? 1.0f : 0.0f;
+        deviceContext.UpdateSubresource(m_params, 0, nullptr, &m_paramsData, 0, 0);
+
+        ID3D11ShaderResourceView* source = level == 0 ? sceneSRV : down[level - 1].srv;
+        deviceContext.CSSetShaderResources(0, 1, &source);
+        deviceContext.CSSetUnorderedAccessViews(0, 1, &down[level].uav, nullptr);
+        deviceContext.Dispatch(groups(dstWidth, 8), groups(dstHeight, 8), 1);
+        deviceContext.CSSetShaderResources(0, 1, nullSRVs);
+        deviceContext.CSSetUnorderedAccessViews(0, 1, &nullUAV, nullptr);
+    }
+
+    // Subida: up[i] = down[i] + tienda(up[i + 1]), empezando por el nivel más pequeño.
+    deviceContext.CSSetShader(m_upShader, nullptr, 0);
+    for (unsigned int level = kBloomLevels - 1; level-- > 0;) {
+        const unsigned int dstWidth = bloomSize(width, level);
+        const unsigned int dstHeight = bloomSize(height, level);
+        fillParams(dstWidth, dstHeight, bloomSize(width, level + 1), bloomSize(height, level + 1));
+        deviceContext.UpdateSubresource(m_params, 0, nullptr, &m_paramsData, 0, 0);
+
+        ID3D11ShaderResourceView* sources[2] = {
+            down[level].srv, level + 1 == kBloomLevels - 1 ? down[level + 1].srv : up[level + 1].srv };
+        deviceContext.CSSetShaderResources(0, 2, sources);
+        deviceContext.CSSetUnorderedAccessViews(0, 1, &up[level].uav, nullptr);
+        deviceContext.Dispatch(groups(dstWidth, 8), groups(dstHeight, 8), 1);
+        deviceContext.CSSetShaderResources(0, 2, nullSRVs);
+        deviceContext.CSSetUnorderedAccessViews(0, 1, &nullUAV, nullptr);
+    }
+    deviceContext.CSSetShader(nullptr, nullptr, 0);
+}
+
+void PostProcess::exposure(DeviceContext& deviceContext, ID3D11ShaderResourceView* sceneSRV,
+    unsigned int width, unsigned int height, float deltaTime) {
+    if (!isReady() || !sceneSRV) {
+        return;
+    }
+    fillParams(width, height, width, height);
+    // Fracción del camino hacia el objetivo que se recorre este frame.
+    m_paramsData.exposure.z = 1.0f - expf(-(std::max)(deltaTime, 0.0f) * m_settings.adaptationSpeed);
+    deviceContext.UpdateSubresource(m_params, 0, nullptr, &m_paramsData, 0, 0);
+
+    ID3D11UnorderedAccessView* uavs[2] = { m_histogramUAV, m_exposureUAV };
+    deviceContext.CSSetConstantBuffers(CB_SLOT_POST, 1, &m_params);
+    deviceContext.CSSetShaderResources(0, 1, &sceneSRV);
+    deviceContext.CSSetUnorderedAccessViews(1, 2, uavs, nullptr);
+    deviceContext.CSSetShader(m_histogramShader, nullptr, 0);
+    deviceContext.Dispatch(groups(width, 16), groups(height, 16), 1);
+    deviceContext.CSSetShader(m_exposureShader, nullptr, 0);
+    deviceContext.Dispatch(1, 1, 1);
+
+    ID3D11ShaderResourceView* nullSRV = nullptr;
+    ID3D11UnorderedAccessView* nullUAVs[2] = { nullptr, nullptr };
+    deviceContext.CSSetShaderResources(0, 1, &nullSRV);
+    deviceContext.CSSetUnorderedAccessViews(1, 2, nullUAVs, nullptr);
+    deviceContext.CSSetShader(nullptr, nullptr, 0);
+}
+
+void PostProcess::resolve(DeviceContext& deviceContext, ID3D11ShaderResourceView* sceneSRV,
+    ID3D11ShaderResourceView* bloomSRV, ID3D11ShaderResourceView* interfaceSRV,
+    ID3D11RenderTargetView* target, unsigned int width, unsigned int height) {
+    if (!isReady() || !sceneSRV || !target) {
+        return;
+    }
+    fillParams(width, height, width, height);
+    if (!bloomSRV) {
+        m_paramsData.bloom.z = 0.0f;
+    }
+    m_paramsData.tone.w = interfaceSRV ? 1.0f : 0.0f;
+    deviceContext.UpdateSubresource(m_params, 0, nullptr, &m_paramsData, 0, 0);
+
+    deviceContext.OMSetRenderTargets(1, &target, nullptr);
+    D3D11_VIEWPORT viewport = {};
+    viewport.Width = static_cast<float>(width);
+    viewport.Height = static_cast<float>(height);
+    viewport.MaxDepth = 1.0f;
+    deviceContext.RSSetViewports(1, &viewport);
+    deviceContext.OMSetBlendState(nullptr, nullptr, 0xffffffff);
+
+    // Triángulo a pantalla completa generado con SV_VertexID: sin vertex buffer ni layout.
+    ID3D11ShaderResourceView* srvs[4] = { sceneSRV, bloomSRV, m_exposureSRV, interfaceSRV };
+    deviceContext.IASetInputLayout(nullptr);
+    deviceContext.IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    deviceContext.VSSetShader(m_vertexShader, nullptr, 0);
+    deviceContext.PSSetShader(m_pixelShader, nullptr, 0);
+    deviceContext.PSSetConstantBuffers(CB_SLOT_POST, 1, &m_params);
+    deviceContext.PSSetShaderResources(0, 4, srvs);
+    deviceContext.PSSetSamplers(0, 1, &m_sampler);
+    deviceContext.Draw(3, 0);
+
+    // La escena y la UI vuelven a ser render targets (y la exposición UAV) el frame siguiente.
+    ID3D11ShaderResourceView* nullSRVs[4] = { nullptr, nullptr, nullptr, nullptr };
+    deviceContext.PSSetShaderResources(0, 4, nullSRVs);
+}
+
+void PostProcess::destroy() {
+    SAFE_RELEASE(m_downShader);
+    SAFE_RELEASE(m_upShader);
+    SAFE_RELEASE(m_histogramShader);
+    SAFE_RELEASE(m_exposureShader);
+    SAFE_RELEASE(m_vertexShader);
+    SAFE_RELEASE(m_pixelShader);
+    SAFE_RELEASE(m_sampler);
+    SAFE_RELEASE(m_params);
+    SAFE_RELEASE(m_histogramUAV);
+    SAFE_RELEASE(m_histogram);
+    SAFE_RELEASE(m_exposureUAV);
+    SAFE_RELEASE(m_exposureSRV);
+    SAFE_RELEASE(m_exposure);
+}
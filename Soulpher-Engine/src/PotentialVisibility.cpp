@@ -0,0 +1,663 @@
+﻿/**
+ * @file PotentialVisibility.cpp
+ * @brief Horneado por muestreo de rayos, formato de disco y consulta del PVS.
+ */
+
+#include "PotentialVisibility.h"
+#include "MeshAsset.h"
+#include "JobSystem.h"
+#include "TriangleBvh.h"
+#include "ECS/Actor.h"
+#include "ECS/Transform.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace {
+    const uint32_t kMagic = 0x53565053; // "SPVS"
+
+    struct FileHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t sceneHash;
+        XMFLOAT3 origin;
+        float cellSize;
+        uint32_t dims[3];
+        uint32_t entryCount;
+        uint32_t portalCount;
+        uint32_t rowBytes;
+        uint32_t portalCellCount;
+        uint32_t padding;
+    };
+
+    struct FilePortal {
+        char name[32];
+        XMFLOAT3 boundsMin;
+        XMFLOAT3 boundsMax;
+    };
+
+    /// Estático de la escena con su caja en mundo.
+    struct Static {
+        ActorHandle handle;
+        XMFLOAT3 boundsMin, boundsMax;
+    };
+
+    /// Estáticos con caja en el orden de la escena y huella de lo que invalida el horneado.
+    std::vector<Static> collectStatics(const std::vector<ActorHandle>& actors, uint64_t& hash) {
+        std::vector<Static> statics;
+        hash = EU::kFnv1aSeed;
+        for (ActorHandle handle : actors) {
+            Actor* actor = handle.get();
+            if (!actor || !actor->isStatic() || !actor->hasComponent<Transform>()) {
+                continue;
+            }
+            Transform* transform = actor->getComponent<Transform>();
+            transform->update(0.0f);
+            Static entry;
+            entry.handle = handle;
+            if (!actor->getSimulationBounds(entry.boundsMin, entry.boundsMax)) {
+                continue;
+            }
+            XMFLOAT4X4 world;
+            XMStoreFloat4x4(&world, transform->getMatrix());
+            const std::string& source = actor->getMeshAsset()->getSourceName();
+            const size_t nameSize = actor->getName().size();
+            EU::Fnv1a(hash, &nameSize, sizeof(nameSize));
+            EU::Fnv1a(hash, actor->getName().data(), nameSize);
+            EU::Fnv1a(hash, &world, sizeof(world));
+            EU::Fnv1a(hash, source.data(), source.size());
+            statics.push_back(entry);
+        }
+        return statics;
+    }
+
+    /// Portales de `<basePath>.portals` (sin archivo, ninguno).
+    std::vector<PotentialVisibility::Portal> readPortals(const std::string& path) {
+        std::vector<PotentialVisibility::Portal> portals;
+        std::ifstream file(path.c_str());
+        std::string line;
+        while (std::getline(file, line)) {
+            std::istringstream words(line.substr(0, line.find('#')));
+            PotentialVisibility::Portal portal;
+            XMFLOAT3& a = portal.boundsMin;
+            XMFLOAT3& b = portal.boundsMax;
+            if (!(words >> portal.name >> a.x >> a.y >> a.z >> b.x >> b.y >> b.z)) {
+                continue;
+            }
+            portal.boundsMin = XMFLOAT3((std::min)(a.x, b.x), (std::min)(a.y, b.y), (std::min)(a.z, b.z));
+            portal.boundsMax = XMFLOAT3((std::max)(a.x, b.x), (std::max)(a.y, b.y), (std::max)(a.z, b.z));
+            portals.push_back(portal);
+        }
+        return portals;
+    }
+
+    /// Generador por par de celdas (xorshift32): el resultado no depende del reparto entre hilos.
+    struct Random {
+        uint32_t state;
+        explicit Random(uint32_t seed) : state(seed * 747796405u + 2891336453u) { if (!state) state = 1; }
+        float next() {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            return (state >> 8) * (1.0f / 16777216.0f);
+        }
+    };
+
+    XMFLOAT3 samplePoint(const XMFLOAT3& boundsMin, const XMFLOAT3& boundsMax, Random& random) {
+        return XMFLOAT3(boundsMin.x + (boundsMax.x - boundsMin.x) * random.next(),
+            boundsMin.y + (boundsMax.y - boundsMin.y) * random.next(),
+            boundsMin.z + (boundsMax.z - boundsMin.z) * random.next());
+    }
+
+    /// El segmento `origin + direction * [0, length]` toca la caja.
+    bool segmentHitsBox(const XMFLOAT3& origin, const XMFLOAT3& direction, float length,
+        const XMFLOAT3& boundsMin, const XMFLOAT3& boundsMax) {
+        float t0 = 0.0f, t1 = length;
+        const float* o = &origin.x;
+        const float* d = &direction.x;
+        const float* lo = &boundsMin.x;
+        const float* hi = &boundsMax.x;
+        for (unsigned int a = 0; a < 3; ++a) {
+            if (fabsf(d[a]) < 1e-12f) {
+                if (o[a] < lo[a] || o[a] > hi[a]) {
+                    return false;
+                }
+                continue;
+            }
+            float tNear = (lo[a] - o[a]) / d[a];
+            float tFar = (hi[a] - o[a]) / d[a];
+            if (tNear > tFar) std::swap(tNear, tFar);
+            t0 = tNear > t0 ? tNear : t0;
+            t1 = tFar < t1 ? tFar : t1;
+            if (t0 > t1) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void writeVarint(std::vector<uint8_t>& out, uint32_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    uint32_t readVarint(const uint8_t*& cursor, const uint8_t* end) {
+        uint32_t value = 0;
+        for (unsigned int shift = 0; cursor < end && shift < 32; shift += 7) {
+            const uint8_t byte = *cursor++;
+            value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) {
+                break;
+            }
+        }
+        return value;
+    }
+
+    /// Carreras (ceros, unos) de una lista creciente de celdas visibles; los ceros del final no se guardan.
+    void encodeRuns(const std::vector<uint32_t>& visible, std::vector<uint8_t>& out) {
+        uint32_t cursor = 0;
+        for (size_t i = 0; i < visible.size();) {
+            const uint32_t start = visible[i];
+            uint32_t end = start + 1;
+            for (++i; i < visible.size() && visible[i] == end; ++i) {
+                ++end;
+            }
+            writeVarint(out, start - cursor);
+            writeVarint(out, end - start);
+            cursor = end;
+        }
+    }
+
+    XMFLOAT3 sub(const XMFLOAT3& a, const XMFLOAT3& b) { return XMFLOAT3(a.x - b.x, a.y - b.y, a.z - b.z); }
+    float dot(const XMFLOAT3& a, const XMFLOAT3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+    XMFLOAT3 cross(const XMFLOAT3& a, const XMFLOAT3& b) {
+        return XMFLOAT3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+    }
+}
+
+/**
+ * @details Las filas se calculan en paralelo, cada una con su propio generador por par
+ * de celdas, y se comprimen al terminarlas: nunca hay más de una fila descomprimida
+ * por hilo.
+ */
+HRESULT PotentialVisibility::bake(const std::vector<ActorHandle>& actors, const std::string& basePath,
+    const Settings& settings) {
+    uint64_t hash = 0;
+    const std::vector<Static> statics = collectStatics(actors, hash);
+    if (statics.empty()) {
+        MESSAGE("PotentialVisibility", "bake", "No static actors to bake visibility for.");
+        return S_FALSE;
+    }
+    for (ActorHandle handle : actors) {
+        Actor* actor = handle.get();
+        if (actor && actor->isStatic() && !actor->isTransparent() && !actor->getMeshAsset().isNull() &&
+            !actor->getMeshAsset()->hasCpuData()) {
+            ERROR("PotentialVisibility", "bake", ("Mesh data was released for " + actor->getName() +
+                "; start with -lightmapbake 1").c_str());
+            return E_FAIL;
+        }
+    }
+    std::vector<Portal> portals = readPortals(basePath + ".portals");
+    if (portals.size() > kMaxPortals) {
+        LOG_WARNING("PotentialVisibility", "Only the first " << kMaxPortals << " of " << portals.size() <<
+            " portals are baked.");
+        portals.resize(kMaxPortals);
+    }
+
+    // 1) Rejilla sobre la caja de los estáticos (un poco holgada) y celdas destino.
+    XMFLOAT3 sceneMin(FLT_MAX, FLT_MAX, FLT_MAX), sceneMax(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+    for (const Static& s : statics) {
+        XMStoreFloat3(&sceneMin, XMVectorMin(XMLoadFloat3(&sceneMin), XMLoadFloat3(&s.boundsMin)));
+        XMStoreFloat3(&sceneMax, XMVectorMax(XMLoadFloat3(&sceneMax), XMLoadFloat3(&s.boundsMax)));
+    }
+    float cellSize = (std::max)(settings.cellSize, 0.1f);
+    unsigned int dims[3] = {};
+    for (;;) {
+        dims[0] = (std::max)(static_cast<unsigned int>(ceilf((sceneMax.x - sceneMin.x) / cellSize + 1e-3f)), 1u);
+        dims[1] = (std::max)(static_cast<unsigned int>(ceilf((sceneMax.y - sceneMin.y) / cellSize + 1e-3f)), 1u);
+        dims[2] = (std::max)(static_cast<unsigned int>(ceilf((sceneMax.z - sceneMin.z) / cellSize + 1e-3f)), 1u);
+        if (static_cast<uint64_t>(dims[0]) * dims[1] * dims[2] <= kMaxCells) {
+            break;
+        }
+        cellSize *= 1.25f;
+    }
+    clear();
+    m_origin = sceneMin;
+    m_cellSize = cellSize;
+    std::memcpy(m_dims, dims, sizeof(dims));
+    const unsigned int cellCount = getCellCount();
+
+    std::vector<char> isTarget(cellCount, 0);
+    for (const Static& s : statics) {
+        unsigned int first[3], last[3];
+        getCellRange(s.boundsMin, s.boundsMax, first, last);
+        for (unsigned int z = first[2]; z <= last[2]; ++z) {
+            for (unsigned int y = first[1]; y <= last[1]; ++y) {
+                for (unsigned int x = first[0]; x <= last[0]; ++x) {
+                    isTarget[x + m_dims[0] * (y + m_dims[1] * z)] = 1;
+                }
+            }
+        }
+    }
+    std::vector<uint32_t> targets;
+    for (uint32_t c = 0; c < cellCount; ++c) {
+        if (isTarget[c]) {
+            targets.push_back(c);
+        }
+    }
+
+    // 2) Oclusores: los estáticos opacos.
+    std::vector<Triangle> triangles;
+    XMFLOAT3 triangleMin(FLT_MAX, FLT_MAX, FLT_MAX), triangleMax(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+    TriangleBvh::gatherStatic(actors, triangles, triangleMin, triangleMax);
+    TriangleBvh bvh;
+    bvh.build(std::move(triangles));
+
+    // 3) Una fila por celda de cámara.
+    const unsigned int samples = (std::max)(settings.samples, 1u);
+    const float maxDistance = settings.maxDistance > 0.0f ? settings.maxDistance + cellSize * 1.7320508f : FLT_MAX;
+    std::vector<std::vector<uint8_t>> rows(cellCount);
+    std::vector<std::vector<PortalCell>> portalRows(cellCount);
+    const unsigned int dimX = m_dims[0], dimY = m_dims[1];
+    const XMFLOAT3 origin = m_origin;
+    JobSystem::getDefault().parallelFor(cellCount, [&](unsigned int begin, unsigned int end) {
+        std::vector<uint32_t> visible;
+        for (unsigned int a = begin; a < end; ++a) {
+            const int ax = static_cast<int>(a % dimX), ay = static_cast<int>((a / dimX) % dimY), az = static_cast<int>(a / (dimX * dimY));
+            const XMFLOAT3 cameraMin(origin.x + (ax - 0.5f) * cellSize, origin.y + (ay - 0.5f) * cellSize, origin.z + (az - 0.5f) * cellSize);
+            const XMFLOAT3 cameraMax(cameraMin.x + 2.0f * cellSize, cameraMin.y + 2.0f * cellSize, cameraMin.z + 2.0f * cellSize);
+            visible.clear();
+            for (uint32_t b : targets) {
+                const int bx = static_cast<int>(b % dimX), by = static_cast<int>((b / dimX) % dimY), bz = static_cast<int>(b / (dimX * dimY));
+                if (std::abs(ax - bx) <= 1 && std::abs(ay - by) <= 1 && std::abs(az - bz) <= 1) {
+                    visible.push_back(b);
+                    continue;
+                }
+                const XMFLOAT3 offset(static_cast<float>(bx - ax), static_cast<float>(by - ay), static_cast<float>(bz - az));
+                if (sqrtf(dot(offset, offset)) * cellSize > maxDistance) {
+                    continue;
+                }
+                const XMFLOAT3 targetMin(origin.x + bx * cellSize, origin.y + by * cellSize, origin.z + bz * cellSize);
+                const XMFLOAT3 targetMax(targetMin.x + cellSize, targetMin.y + cellSize, targetMin.z + cellSize);
+                Random random(a * 0x9E3779B9u ^ b);
+                uint32_t mask = 0;
+                bool direct = false;
+                for (unsigned int s = 0; s < samples && !direct; ++s) {
+                    const XMFLOAT3 p = samplePoint(cameraMin, cameraMax, random);
+                    const XMFLOAT3 q = samplePoint(targetMin, targetMax, random);
+                    const XMFLOAT3 d = sub(q, p);
+                    const float length = sqrtf(dot(d, d));
+                    if (length < 1e-4f) {
+                        continue;
+                    }
+                    const XMFLOAT3 direction(d.x / length, d.y / length, d.z / length);
+                    float t;
+                    unsigned int triangle;
+                    if (bvh.trace(p, direction, length, true, t, triangle)) {
+                        continue;
+                    }
+                    uint32_t crossed = 0;
+                    for (size_t k = 0; k < portals.size(); ++k) {
+                        if (segmentHitsBox(p, direction, length, portals[k].boundsMin, portals[k].boundsMax)) {
+                            crossed |= 1u << k;
+                        }
+                    }
+                    direct = crossed == 0;
+                    mask |= crossed;
+                }
+                if (direct || mask != 0) {
+                    visible.push_back(b);
+                }
+                if (!direct && mask != 0) {
+                    portalRows[a].push_back({ b, mask });
+                }
+            }
+            encodeRuns(visible, rows[a]);
+        }
+    }, 8);
+
+    m_rowOffsets.resize(cellCount + 1);
+    m_portalOffsets.resize(cellCount + 1);
+    for (unsigned int c = 0; c < cellCount; ++c) {
+        m_rowOffsets[c] = static_cast<uint32_t>(m_rows.size());
+        m_portalOffsets[c] = static_cast<uint32_t>(m_portalCells.size());
+        m_rows.insert(m_rows.end(), rows[c].begin(), rows[c].end());
+        m_portalCells.insert(m_portalCells.end(), portalRows[c].begin(), portalRows[c].end());
+    }
+    m_rowOffsets[cellCount] = static_cast<uint32_t>(m_rows.size());
+    m_portalOffsets[cellCount] = static_cast<uint32_t>(m_portalCells.size());
+
+    // 4) Disco: cabecera, portales, filas y destinos por portal.
+    const std::string path = basePath + ".spvs";
+    const std::string temp = path + ".tmp";
+    FILE* file = nullptr;
+    if (fopen_s(&file, temp.c_str(), "wb") != 0 || !file) {
+        clear();
+        ERROR("PotentialVisibility", "bake", ("Cannot write " + temp).c_str());
+        return E_FAIL;
+    }
+    FileHeader header = { kMagic, kFormatVersion, hash, m_origin, m_cellSize, { m_dims[0], m_dims[1], m_dims[2] },
+        static_cast<uint32_t>(statics.size()), static_cast<uint32_t>(portals.size()),
+        static_cast<uint32_t>(m_rows.size()), static_cast<uint32_t>(m_portalCells.size()), 0 };
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    for (const Portal& portal : portals) {
+        FilePortal entry = {};
+        strncpy_s(entry.name, portal.name.c_str(), _TRUNCATE);
+        entry.boundsMin = portal.boundsMin;
+        entry.boundsMax = portal.boundsMax;
+        ok = ok && fwrite(&entry, sizeof(entry), 1, file) == 1;
+    }
+    ok = ok && fwrite(m_rowOffsets.data(), sizeof(uint32_t), m_rowOffsets.size(), file) == m_rowOffsets.size();
+    ok = ok && (m_rows.empty() || fwrite(m_rows.data(), 1, m_rows.size(), file) == m_rows.size());
+    ok = ok && fwrite(m_portalOffsets.data(), sizeof(uint32_t), m_portalOffsets.size(), file) == m_portalOffsets.size();
+    ok = ok && (m_portalCells.empty() ||
+        fwrite(m_portalCells.data(), sizeof(PortalCell), m_portalCells.size(), file) == m_portalCells.size());
+    ok = fclose(file) == 0 && ok;
+    if (!ok || !MoveFileExA(temp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+        DeleteFileA(temp.c_str());
+        clear();
+        ERROR("PotentialVisibility", "bake", ("Cannot write " + path).c_str());
+        return E_FAIL;
+    }
+    MESSAGE("PotentialVisibility", "bake", ("Baked " + std::to_string(cellCount) + " cells (" +
+        std::to_string(targets.size()) + " with statics, " + std::to_string(portals.size()) + " portals) into " +
+        std::to_string(m_rows.size()) + " bytes of runs; uncompressed rows would take " +
+        std::to_string(static_cast<uint64_t>(cellCount) * ((cellCount + 7) / 8)) + ".").c_str());
+    return load(actors, basePath);
+}
+
+HRESULT PotentialVisibility::load(const std::vector<ActorHandle>& actors, const std::string& basePath) {
+    clear();
+    FILE* file = nullptr;
+    const std::string path = basePath + ".spvs";
+    if (fopen_s(&file, path.c_str(), "rb") != 0 || !file) {
+        return E_FAIL;
+    }
+    FileHeader header = {};
+    std::vector<FilePortal> portals;
+    bool ok = fread(&header, sizeof(header), 1, file) == 1 && header.magic == kMagic &&
+        header.version == kFormatVersion && header.portalCount <= kMaxPortals && header.cellSize > 0.0f &&
+        static_cast<uint64_t>(header.dims[0]) * header.dims[1] * header.dims[2] <= kMaxCells;
+    const size_t cellCount = ok ? static_cast<size_t>(header.dims[0]) * header.dims[1] * header.dims[2] : 0;
+    if (ok) {
+        portals.resize(header.portalCount);
+        m_rowOffsets.resize(cellCount + 1);
+        m_rows.resize(header.rowBytes);
+        m_portalOffsets.resize(cellCount + 1);
+        m_portalCells.resize(header.portalCellCount);
+        ok = (portals.empty() || fread(portals.data(), sizeof(FilePortal), portals.size(), file) == portals.size()) &&
+            fread(m_rowOffsets.data(), sizeof(uint32_t), m_rowOffsets.size(), file) == m_rowOffsets.size() &&
+            (m_rows.empty() || fread(m_rows.data(), 1, m_rows.size(), file) == m_rows.size()) &&
+            fread(m_portalOffsets.data(), sizeof(uint32_t), m_portalOffsets.size(), file) == m_portalOffsets.size() &&
+            (m_portalCells.empty() ||
+                fread(m_portalCells.data(), sizeof(PortalCell), m_portalCells.size(), file) == m_portalCells.size());
+    }
+    fclose(file);
+    ok = ok && m_rowOffsets.back() == m_rows.size() && m_portalOffsets.back() == m_portalCells.size();
+    for (size_t c = 0; ok && c < cellCount; ++c) {
+        ok = m_rowOffsets[c] <= m_rowOffsets[c + 1] && m_portalOffsets[c] <= m_portalOffsets[c + 1];
+    }
+    for (size_t i = 0; ok && i < m_portalCells.size(); ++i) {
+        ok = m_portalCells[i].cell < cellCount;
+    }
+    if (!ok) {
+        clear();
+        ERROR("PotentialVisibility", "load", ("Invalid visibility file " + path).c_str());
+        return E_INVALIDARG;
+    }
+
+    uint64_t hash = 0;
+    const std::vector<Static> statics = collectStatics(actors, hash);
+    if (hash != header.sceneHash || statics.size() != header.entryCount) {
+        clear();
+        MESSAGE("PotentialVisibility", "load", "Scene changed since the last bake; visibility not applied.");
+        return E_ABORT;
+    }
+
+    m_origin = header.origin;
+    m_cellSize = header.cellSize;
+    std::memcpy(m_dims, header.dims, sizeof(m_dims));
+    for (const FilePortal& entry : portals) {
+        Portal portal;
+        portal.name.assign(entry.name, strnlen(entry.name, sizeof(entry.name)));
+        portal.boundsMin = entry.boundsMin;
+        portal.boundsMax = entry.boundsMax;
+        m_portals.push_back(portal);
+    }
+    m_entries.resize(statics.size());
+    for (size_t i = 0; i < statics.size(); ++i) {
+        Entry& entry = m_entries[i];
+        entry.handle = statics[i].handle.value;
+        getCellRange(statics[i].boundsMin, statics[i].boundsMax, entry.cellMin, entry.cellMax);
+        m_entryByHandle[entry.handle] = static_cast<unsigned int>(i);
+    }
+    MESSAGE("PotentialVisibility", "load", ("Loaded " + path).c_str());
+    return S_OK;
+}
+
+void PotentialVisibility::clear() {
+    m_rowOffsets.clear();
+    m_rows.clear();
+    m_portalOffsets.clear();
+    m_portalCells.clear();
+    m_portals.clear();
+    m_entries.clear();
+    m_entryByHandle.Clear();
+    m_cameraCell = kInvalid;
+    m_rowBits.clear();
+    m_cellMasks.clear();
+    m_entryStates.clear();
+    m_entryMasks.clear();
+    m_actorKeys.clear();
+    m_actorEntries.clear();
+    m_hidden.clear();
+    m_hiddenCount = 0;
+    std::memset(m_dims, 0, sizeof(m_dims));
+}
+
+/**
+ * @details La fila solo se descomprime al cambiar de celda; los estáticos que dependen
+ * de portales se prueban cada frame, porque su pirámide depende de la posición exacta.
+ */
+void PotentialVisibility::update(const std::vector<ActorHandle>& actors, const XMFLOAT3& cameraPosition,
+    bool portals) {
+    m_hiddenCount = 0;
+    if (!isLoaded()) {
+        m_hidden.clear();
+        return;
+    }
+    bool remap = actors.size() != m_actorKeys.size();
+    for (size_t i = 0; !remap && i < actors.size(); ++i) {
+        remap = actors[i].value != m_actorKeys[i];
+    }
+    if (remap) {
+        m_actorKeys.resize(actors.size());
+        m_actorEntries.resize(actors.size());
+        for (size_t i = 0; i < actors.size(); ++i) {
+            m_actorKeys[i] = actors[i].value;
+            const unsigned int* entry = m_entryByHandle.Find(actors[i].value);
+            m_actorEntries[i] = entry ? *entry : kInvalid;
+        }
+    }
+    const unsigned int cell = findCell(cameraPosition);
+    if (cell != m_cameraCell) {
+        m_cameraCell = cell;
+        classify();
+    }
+    m_hidden.assign(actors.size(), 0);
+    if (m_cameraCell == kInvalid) {
+        return;
+    }
+    for (size_t i = 0; i < actors.size(); ++i) {
+        const unsigned int e = m_actorEntries[i];
+        if (e == kInvalid || m_entryStates[e] == ENTRY_VISIBLE) {
+            continue;
+        }
+        bool hidden = m_entryStates[e] == ENTRY_HIDDEN;
+        if (!hidden && portals) {
+            XMFLOAT3 mn, mx;
+            hidden = !actors[i].isNull() && actors[i]->getWorldBounds(mn, mx);
+            for (unsigned int p = 0; hidden && p < m_portals.size(); ++p) {
+                if ((m_entryMasks[e] & (1u << p)) && m_portals[p].open) {
+                    hidden = !throughPortal(p, cameraPosition, mn, mx);
+                }
+            }
+        }
+        if (hidden) {
+            m_hidden[i] = 1;
+            ++m_hiddenCount;
+        }
+    }
+}
+
+unsigned int PotentialVisibility::findPortal(const std::string& name) const {
+    for (size_t i = 0; i < m_portals.size(); ++i) {
+        if (m_portals[i].name == name) {
+            return static_cast<unsigned int>(i);
+        }
+    }
+    return kInvalid;
+}
+
+void PotentialVisibility::setPortalOpen(unsigned int index, bool open) {
+    if (index < m_portals.size()) {
+        m_portals[index].open = open;
+    }
+}
+
+unsigned int PotentialVisibility::findCell(const XMFLOAT3& position) const {
+    unsigned int index[3];
+    for (unsigned int a = 0; a < 3; ++a) {
+        const float f = ((&position.x)[a] - (&m_origin.x)[a]) / m_cellSize;
+        if (!(f >= 0.0f) || f >= static_cast<float>(m_dims[a])) {
+            return kInvalid;
+        }
+        index[a] = (std::min)(static_cast<unsigned int>(f), m_dims[a] - 1);
+    }
+    return index[0] + m_dims[0] * (index[1] + m_dims[1] * index[2]);
+}
+
+void PotentialVisibility::getCellRange(const XMFLOAT3& boundsMin, const XMFLOAT3& boundsMax,
+    unsigned int first[3], unsigned int last[3]) const {
+    for (unsigned int a = 0; a < 3; ++a) {
+        const float low = ((&boundsMin.x)[a] - (&m_origin.x)[a]) / m_cellSize;
+        const float high = ((&boundsMax.x)[a] - (&m_origin.x)[a]) / m_cellSize;
+        first[a] = (std::min)(static_cast<unsigned int>((std::max)(low, 0.0f)), m_dims[a] - 1);
+        last[a] = (std::min)(static_cast<unsigned int>((std::max)(high, 0.0f)), m_dims[a] - 1);
+    }
+}
+
+void PotentialVisibility::classify() {
+    m_entryStates.assign(m_entries.size(), ENTRY_VISIBLE);
+    m_entryMasks.assign(m_entries.size(), 0);
+    if (m_cameraCell == kInvalid) {
+        return;
+    }
+    const unsigned int cellCount = getCellCount();
+    m_rowBits.assign((cellCount + 7) / 8, 0);
+    const uint8_t* cursor = m_rows.data() + m_rowOffsets[m_cameraCell];
+    const uint8_t* end = m_rows.data() + m_rowOffsets[m_cameraCell + 1];
+    uint32_t cell = 0;
+    while (cursor < end) {
+        cell += readVarint(cursor, end);
+        const uint32_t ones = readVarint(cursor, end);
+        for (uint32_t c = cell; c < cell + ones && c < cellCount; ++c) {
+            m_rowBits[c >> 3] |= static_cast<uint8_t>(1u << (c & 7));
+        }
+        cell += ones;
+    }
+    m_cellMasks.assign(cellCount, 0);
+    for (uint32_t i = m_portalOffsets[m_cameraCell]; i < m_portalOffsets[m_cameraCell + 1]; ++i) {
+        m_cellMasks[m_portalCells[i].cell] = m_portalCells[i].mask;
+    }
+
+    for (size_t e = 0; e < m_entries.size(); ++e) {
+        const Entry& entry = m_entries[e];
+        uint8_t state = ENTRY_HIDDEN;
+        uint32_t mask = 0;
+        for (unsigned int z = entry.cellMin[2]; z <= entry.cellMax[2] && state != ENTRY_VISIBLE; ++z) {
+            for (unsigned int y = entry.cellMin[1]; y <= entry.cellMax[1] && state != ENTRY_VISIBLE; ++y) {
+                for (unsigned int x = entry.cellMin[0]; x <= entry.cellMax[0]; ++x) {
+                    const unsigned int c = x + m_dims[0] * (y + m_dims[1] * z);
+                    if (!(m_rowBits[c >> 3] & (1u << (c & 7)))) {
+                        continue;
+                    }
+                    if (m_cellMasks[c] == 0) {
+                        state = ENTRY_VISIBLE;
+                        break;
+                    }
+                    mask |= m_cellMasks[c];
+                }
+            }
+        }
+        if (state != ENTRY_VISIBLE && mask != 0) {
+            state = ENTRY_PORTAL;
+        }
+        m_entryStates[e] = state;
+        m_entryMasks[e] = mask;
+    }
+}
+
+/**
+ * @details Pirámide de la cámara al rectángulo central de la caja del portal (el eje
+ * más fino es su normal) más el plano del portal: la caja tiene que quedar, al menos en
+ * parte, dentro de los cinco. Con la cámara en el hueco no se recorta nada.
+ */
+bool PotentialVisibility::throughPortal(unsigned int portal, const XMFLOAT3& cameraPosition,
+    const XMFLOAT3& boundsMin, const XMFLOAT3& boundsMax) const {
+    const Portal& p = m_portals[portal];
+    const XMFLOAT3 center((p.boundsMin.x + p.boundsMax.x) * 0.5f, (p.boundsMin.y + p.boundsMax.y) * 0.5f,
+        (p.boundsMin.z + p.boundsMax.z) * 0.5f);
+    const XMFLOAT3 half = sub(p.boundsMax, center);
+    const float* c = &center.x;
+    const float* h = &half.x;
+    const float* eye = &cameraPosition.x;
+    const unsigned int axis = h[0] < h[1] ? (h[0] < h[2] ? 0 : 2) : (h[1] < h[2] ? 1 : 2);
+    if (fabsf(eye[axis] - c[axis]) <= h[axis] + 1e-3f) {
+        return true;
+    }
+    const unsigned int u = (axis + 1) % 3, v = (axis + 2) % 3;
+    const float signs[4][2] = { { -1.0f, -1.0f }, { 1.0f, -1.0f }, { 1.0f, 1.0f }, { -1.0f, 1.0f } };
+    XMFLOAT3 corners[4];
+    for (unsigned int k = 0; k < 4; ++k) {
+        float* corner = &corners[k].x;
+        corner[axis] = c[axis];
+        corner[u] = c[u] + signs[k][0] * h[u];
+        corner[v] = c[v] + signs[k][1] * h[v];
+    }
+
+    XMFLOAT4 planes[5];
+    unsigned int planeCount = 0;
+    for (unsigned int k = 0; k < 4; ++k) {
+        XMFLOAT3 n = cross(sub(corners[k], cameraPosition), sub(corners[(k + 1) % 4], cameraPosition));
+        if (dot(n, n) < 1e-12f) {
+            continue;
+        }
+        float d = -dot(n, cameraPosition);
+        if (dot(n, center) + d < 0.0f) {
+            n = XMFLOAT3(-n.x, -n.y, -n.z);
+            d = -d;
+        }
+        planes[planeCount++] = XMFLOAT4(n.x, n.y, n.z, d);
+    }
+    XMFLOAT3 normal(0.0f, 0.0f, 0.0f);
+    (&normal.x)[axis] = eye[axis] < c[axis] ? 1.0f : -1.0f;
+    planes[planeCount++] = XMFLOAT4(normal.x, normal.y, normal.z, -dot(normal, center));
+
+    for (unsigned int k = 0; k < planeCount; ++k) {
+        const XMFLOAT4& plane = planes[k];
+        const XMFLOAT3 positive(plane.x >= 0.0f ? boundsMax.x : boundsMin.x, plane.y >= 0.0f ? boundsMax.y : boundsMin.y,
+            plane.z >= 0.0f ? boundsMax.z : boundsMin.z);
+        if (plane.x * positive.x + plane.y * positive.y + plane.z * positive.z + plane.w < 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
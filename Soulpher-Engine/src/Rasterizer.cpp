@@ -24,6 +24,9 @@
   * @brief Inicializa el estado de rasterización.
   *
   * @param device Referencia al dispositivo Direct3D 11 que se usará para crear el estado.
+  * @param depthBias Sesgo constante de profundidad (0 salvo en pases de sombra).
+  * @param slopeScaledDepthBias Sesgo según la pendiente (0 salvo en pases de sombra).
+  * @param cullMode Caras descartadas (traseras por defecto).
   * @return HRESULT Código de resultado de Direct3D:
   *         - S_OK si se creó correctamente.
   *         - Error específico si falla la creación.
@@ -31,27 +34,28 @@
   * @note
   * En este caso:
   *  - FillMode está configurado como sólido (`D3D11_FILL_SOLID`), ideal para renderizado final.
-  *  - CullMode descarta caras traseras (`D3D11_CULL_BACK`) para optimizar.
+  *  - CullMode descarta por defecto caras traseras (`D3D11_CULL_BACK`) para optimizar.
   *  - DepthClipEnable está activo para evitar dibujar objetos fuera del rango de profundidad.
   *
   * @warning
   * Cambiar FillMode a `D3D11_FILL_WIREFRAME` es útil para depurar geometría,
   * pero puede reducir la inmersión visual en el producto final.
   */
-HRESULT Rasterizer::init(Device device) {
+HRESULT Rasterizer::init(Device& device, int depthBias, float slopeScaledDepthBias,
+    D3D11_CULL_MODE cullMode) {
     D3D11_RASTERIZER_DESC rasterizerDesc = {};
     rasterizerDesc.FillMode = D3D11_FILL_SOLID;           ///< Relleno sólido (wireframe para depuración).
-    rasterizerDesc.CullMode = D3D11_CULL_BACK;            ///< Culling de caras traseras.
+    rasterizerDesc.CullMode = cullMode;                   ///< Culling de caras traseras (por defecto).
     rasterizerDesc.FrontCounterClockwise = false;         ///< Orientación de vértices: horario = cara frontal.
-    rasterizerDesc.DepthBias = 0;
-    rasterizerDesc.SlopeScaledDepthBias = 0.0f;
+    rasterizerDesc.DepthBias = depthBias;
+    rasterizerDesc.SlopeScaledDepthBias = slopeScaledDepthBias;
     rasterizerDesc.DepthBiasClamp = 0.0f;
     rasterizerDesc.DepthClipEnable = true;                ///< Habilita el recorte por profundidad.
     rasterizerDesc.ScissorEnable = false;
     rasterizerDesc.MultisampleEnable = false;
     rasterizerDesc.AntialiasedLineEnable = false;
 
-    HRESULT hr = device.CreateRasterizerState(&rasterizerDesc, &m_rasterizerState);
+    HRESULT hr = device.CreateSharedRasterizerState(&rasterizerDesc, &m_rasterizerState);
 
     if (FAILED(hr)) {
         ERROR("Rasterizer", "init", "CHECK FOR CreateRasterizerState()");
@@ -0,0 +1,531 @@
+﻿/**
+ * @file ReflectionProbes.cpp
+ * @brief Implementación de la captura por partes, el prefiltrado y la caché de sondas.
+ *
+ * @details
+ * La sonda `i` ocupa los slices `6i..6i+5` del array (caras en el orden de D3D). Las
+ * vistas de las caras siguen los ejes de D3D: en la cara +X, la x de pantalla va hacia
+ * -Z y la y hacia +Y; `ReflectionProbe.fx` reconstruye la dirección de cada texel con
+ * la misma convención.
+ */
+
+#include "ReflectionProbes.h"
+#include "Device.h"
+#include "DeviceContext.h"
+#include "ShaderLibrary.h"
+#include "DdsFile.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+    /// Dirección y "arriba" de cada cara (+X, -X, +Y, -Y, +Z, -Z).
+    const float kFaceAxes[6][2][3] = {
+        { { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f } },
+        { { -1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f } },
+        { { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, -1.0f } },
+        { { 0.0f, -1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f } },
+        { { 0.0f, 0.0f, 1.0f }, { 0.0f, 1.0f, 0.0f } },
+        { { 0.0f, 0.0f, -1.0f }, { 0.0f, 1.0f, 0.0f } },
+    };
+
+    const unsigned int kPrefilterTile = 8;
+    const unsigned int kBytesPerTexel = 8;  // R16G16B16A16_FLOAT
+}
+
+HRESULT ReflectionProbes::init(Device& device) {
+    if (!device.m_device) {
+        ERROR("ReflectionProbes", "init", "Device is null.");
+        return E_POINTER;
+    }
+    destroy();
+
+    // TextureCubeArray y UAV de texturas: 10.1 y 11_0 respectivamente.
+    if (device.m_device->GetFeatureLevel() < D3D_FEATURE_LEVEL_11_0) {
+        MESSAGE("ReflectionProbes", "init", "Feature level < 11_0: reflection probes disabled.");
+        return DXGI_ERROR_UNSUPPORTED;
+    }
+
+    D3D11_TEXTURE2D_DESC captureDesc = {};
+    captureDesc.Width = kFaceSize;
+    captureDesc.Height = kFaceSize;
+    captureDesc.MipLevels = kMipCount;
+    captureDesc.ArraySize = 6;
+    captureDesc.Format = kFormat;
+    captureDesc.SampleDesc.Count = 1;
+    captureDesc.Usage = D3D11_USAGE_DEFAULT;
+    captureDesc.BindFlags = D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
+    captureDesc.MiscFlags = D3D11_RESOURCE_MISC_GENERATE_MIPS | D3D11_RESOURCE_MISC_TEXTURECUBE;
+    HRESULT hr = device.CreateTexture2D(&captureDesc, nullptr, &m_captureTexture);
+    if (SUCCEEDED(hr)) { hr = device.CreateShaderResourceView(m_captureTexture, nullptr, &m_captureSRV); }
+    for (unsigned int face = 0; face < 6 && SUCCEEDED(hr); ++face) {
+        D3D11_RENDER_TARGET_VIEW_DESC rtvDesc = {};
+        rtvDesc.Format = kFormat;
+        rtvDesc.ViewDimension = D3D11_RTV_DIMENSION_TEXTURE2DARRAY;
+        rtvDesc.Texture2DArray.FirstArraySlice = face;
+        rtvDesc.Texture2DArray.ArraySize = 1;
+        hr = device.CreateRenderTargetView(m_captureTexture, &rtvDesc, &m_captureRTV[face]);
+    }
+
+    if (SUCCEEDED(hr)) {
+        D3D11_TEXTURE2D_DESC depthDesc = {};
+        depthDesc.Width = kFaceSize;
+        depthDesc.Height = kFaceSize;
+        depthDesc.MipLevels = 1;
+        depthDesc.ArraySize = 1;
+        depthDesc.Format = DXGI_FORMAT_D24_UNORM_S8_UINT;
+        depthDesc.SampleDesc.Count = 1;
+        depthDesc.Usage = D3D11_USAGE_DEFAULT;
+        depthDesc.BindFlags = D3D11_BIND_DEPTH_STENCIL;
+        hr = device.CreateTexture2D(&depthDesc, nullptr, &m_depthTexture);
+    }
+    if (SUCCEEDED(hr)) { hr = device.CreateDepthStencilView(m_depthTexture, nullptr, &m_depthView); }
+
+    // Array de sondas: lo escribe el prefiltrado (UAV por mip) y lo leen los shaders.
+    D3D11_TEXTURE2D_DESC probeDesc = captureDesc;
+    probeDesc.ArraySize = kMaxProbes * 6;
+    probeDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_UNORDERED_ACCESS;
+    probeDesc.MiscFlags = D3D11_RESOURCE_MISC_TEXTURECUBE;
+    if (SUCCEEDED(hr)) { hr = device.CreateTexture2D(&probeDesc, nullptr, &m_probeTexture); }
+    if (SUCCEEDED(hr)) {
+        D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+        srvDesc.Format = kFormat;
+        srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURECUBEARRAY;
+        srvDesc.TextureCubeArray.MipLevels = kMipCount;
+        srvDesc.TextureCubeArray.NumCubes = kMaxProbes;
+        hr = device.CreateShaderResourceView(m_probeTexture, &srvDesc, &m_probeSRV);
+    }
+    for (unsigned int mip = 0; mip < kMipCount && SUCCEEDED(hr); ++mip) {
+        D3D11_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
+        uavDesc.Format = kFormat;
+        uavDesc.ViewDimension = D3D11_UAV_DIMENSION_TEXTURE2DARRAY;
+        uavDesc.Texture2DArray.MipSlice = mip;
+        uavDesc.Texture2DArray.ArraySize = kMaxProbes * 6;
+        hr = device.CreateUnorderedAccessView(m_probeTexture, &uavDesc, &m_probeUAV[mip]);
+    }
+
+    if (SUCCEEDED(hr)) {
+        D3D11_TEXTURE2D_DESC stagingDesc = captureDesc;
+        stagingDesc.Usage = D3D11_USAGE_STAGING;
+        stagingDesc.BindFlags = 0;
+        stagingDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+        stagingDesc.MiscFlags = 0;
+        hr = device.CreateTexture2D(&stagingDesc, nullptr, &m_staging);
+    }
+
+    D3D11_BUFFER_DESC paramsDesc = {};
+    paramsDesc.Usage = D3D11_USAGE_DEFAULT;
+    paramsDesc.ByteWidth = sizeof(ProbeParams);
+    paramsDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+    m_paramsData = {};
+    D3D11_SUBRESOURCE_DATA initialParams = {};
+    initialParams.pSysMem = &m_paramsData;  // sin sondas: ningún píxel lee el array
+    if (SUCCEEDED(hr)) { hr = device.CreateBuffer(&paramsDesc, &initialParams, &m_params); }
+    paramsDesc.ByteWidth = sizeof(PrefilterParams);
+    if (SUCCEEDED(hr)) { hr = device.CreateBuffer(&paramsDesc, nullptr, &m_prefilterParams); }
+
+    if (SUCCEEDED(hr)) {
+        D3D11_SAMPLER_DESC samplerDesc = {};
+        samplerDesc.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+        samplerDesc.AddressU = D3D11_TEXTURE_ADDRESS_CLAMP;
+        samplerDesc.AddressV = D3D11_TEXTURE_ADDRESS_CLAMP;
+        samplerDesc.AddressW = D3D11_TEXTURE_ADDRESS_CLAMP;
+        samplerDesc.ComparisonFunc = D3D11_COMPARISON_NEVER;
+        samplerDesc.MaxLOD = D3D11_FLOAT32_MAX;
+        hr = device.CreateSharedSamplerState(&samplerDesc, &m_sampler);
+    }
+    if (SUCCEEDED(hr)) { hr = m_faceView.init(device); }
+    if (SUCCEEDED(hr)) { hr = m_faceProjection.init(device); }
+    if (FAILED(hr)) {
+        ERROR("ReflectionProbes", "init", ("Failed to create the probe resources. hr=" + std::to_string(hr)).c_str());
+        destroy();
+        return hr;
+    }
+
+    ShaderKey key;
+    key.fileName = "ReflectionProbe.fx";
+    key.entryPoint = "CSPrefilter";
+    key.profile = "cs_5_0";
+    hr = device.getShaderLibrary().getComputeShader(device, key, &m_prefilterShader);
+    if (FAILED(hr)) {
+        destroy();
+        return hr;
+    }
+
+    CBChangeOnResize projection;
+    projection.mProjection = XMMatrixTranspose(getFaceProjection());
+    m_faceProjection.set(projection);
+    m_device = &device;
+
+    // Las sondas añadidas antes (o de un init anterior) se capturan de nuevo.
+    for (Probe& probe : m_probes) {
+        probe.ready = false;
+        probe.dirty = true;
+        probe.cacheTried = false;
+    }
+    m_current = -1;
+    m_paramsDirty = true;
+    return S_OK;
+}
+
+int ReflectionProbes::add(const XMFLOAT3& position, float radius, bool isStatic) {
+    if (m_probes.size() >= kMaxProbes || !(radius > 0.0f)) {
+        return -1;
+    }
+    Probe probe;
+    probe.position = position;
+    probe.radius = radius;
+    probe.isStatic = isStatic;
+    m_probes.push_back(probe);
+    m_paramsDirty = true;
+    return static_cast<int>(m_probes.size() - 1);
+}
+
+void ReflectionProbes::clear() {
+    m_probes.clear();
+    m_current = -1;
+    m_nextFace = 0;
+    m_nextDynamic = 0;
+    m_readbackProbe = -1;
+    m_paramsDirty = true;
+}
+
+void ReflectionProbes::setSceneHash(uint64_t hash) {
+    if (hash == m_sceneHash) {
+        return;
+    }
+    m_sceneHash = hash;
+    // El contenido viejo se sigue usando hasta que llegue el nuevo.
+    for (unsigned int i = 0; i < m_probes.size(); ++i) {
+        Probe& probe = m_probes[i];
+        if (!probe.isStatic) {
+            continue;
+        }
+        probe.dirty = true;
+        probe.cacheTried = false;
+        if (m_current == static_cast<int>(i)) {
+            m_current = -1;
+        }
+        if (m_readbackProbe == static_cast<int>(i)) {
+            m_readbackProbe = -1;
+        }
+    }
+}
+
+void ReflectionProbes::setEnabled(DeviceContext& deviceContext, bool enabled) {
+    if (enabled == m_enabled) {
+        return;
+    }
+    m_enabled = enabled;
+    if (isReady()) {
+        uploadParams(deviceContext);
+    }
+}
+
+void ReflectionProbes::invalidate() {
+    for (Probe& probe : m_probes) {
+        probe.dirty = true;
+        probe.cacheTried = true;
+    }
+    m_current = -1;
+    m_readbackProbe = -1;
+}
+
+std::string ReflectionProbes::getCacheFile(unsigned int index) const {
+    const Probe& probe = m_probes[index];
+    uint64_t hash = EU::kFnv1aSeed;
+    const unsigned int layout[3] = { kFormatVersion, kFaceSize, kMipCount };
+    EU::Fnv1a(hash, &m_sceneHash, sizeof(m_sceneHash));
+    EU::Fnv1a(hash, layout, sizeof(layout));
+    EU::Fnv1a(hash, &probe.position, sizeof(probe.position));
+    EU::Fnv1a(hash, &probe.radius, sizeof(probe.radius));
+    char name[40] = "";
+    sprintf_s(name, "probe_%016llx.dds", static_cast<unsigned long long>(hash));
+    return m_cachePath + "\\" + name;
+}
+
+bool ReflectionProbes::loadCached(DeviceContext& deviceContext, unsigned int index) {
+    ID3D11ShaderResourceView* srv = nullptr;
+    if (FAILED(DdsFile::load(m_device->m_device, getCacheFile(index), &srv, true))) {
+        return false;
+    }
+    ID3D11Resource* resource = nullptr;
+    srv->GetResource(&resource);
+    ID3D11Texture2D* texture = nullptr;
+    D3D11_TEXTURE2D_DESC desc = {};
+    if (resource && SUCCEEDED(resource->QueryInterface(__uuidof(ID3D11Texture2D), reinterpret_cast<void**>(&texture)))) {
+        texture->GetDesc(&desc);
+    }
+    const bool fits = texture && desc.Width == kFaceSize && desc.Height == kFaceSize &&
+        desc.MipLevels == kMipCount && desc.ArraySize == 6 && desc.Format == kFormat;
+    if (fits) {
+        for (unsigned int face = 0; face < 6; ++face) {
+            for (unsigned int mip = 0; mip < kMipCount; ++mip) {
+                deviceContext.CopySubresourceRegion(m_probeTexture, D3D11CalcSubresource(mip, index * 6 + face, kMipCount),
+                    0, 0, 0, texture, D3D11CalcSubresource(mip, face, kMipCount), nullptr);
+            }
+        }
+    }
+    SAFE_RELEASE(texture);
+    SAFE_RELEASE(resource);
+    SAFE_RELEASE(srv);
+    return fits;
+}
+
+bool ReflectionProbes::finishReadback(DeviceContext& deviceContext) {
+    D3D11_MAPPED_SUBRESOURCE mapped = {};
+    HRESULT hr = deviceContext.Map(m_staging, 0, D3D11_MAP_READ, D3D11_MAP_FLAG_DO_NOT_WAIT, &mapped);
+    if (hr == DXGI_ERROR_WAS_STILL_DRAWING) {
+        return false;
+    }
+    const unsigned int index = static_cast<unsigned int>(m_readbackProbe);
+    m_readbackProbe = -1;
+    if (FAILED(hr)) {
+        ERROR("ReflectionProbes", "finishReadback", ("Failed to map the probe readback. hr=" + std::to_string(hr)).c_str());
+        return true;
+    }
+    deviceContext.Unmap(m_staging, 0);
+
+    // Mips de una cara y, detrás, las otras cinco caras (orden del DDS).
+    CompressedImage image;
+    image.format = kFormat;
+    image.elementCount = 6;
+    image.cubemap = true;
+    size_t faceBytes = 0;
+    for (unsigned int mip = 0; mip < kMipCount; ++mip) {
+        CompressedImage::Level level;
+        level.width = kFaceSize >> mip;
+        level.height = kFaceSize >> mip;
+        level.offset = faceBytes;
+        level.rowPitch = level.width * kBytesPerTexel;
+        level.size = static_cast<size_t>(level.rowPitch) * level.height;
+        image.levels.push_back(level);
+        faceBytes += level.size;
+    }
+    image.data.resize(faceBytes * 6);
+    for (unsigned int face = 0; face < 6; ++face) {
+        for (unsigned int mip = 0; mip < kMipCount; ++mip) {
+            const CompressedImage::Level& level = image.levels[mip];
+            const unsigned int subresource = D3D11CalcSubresource(mip, face, kMipCount);
+            // Todas las copias salieron juntas: si la primera llegó, las demás también.
+            if (FAILED(deviceContext.Map(m_staging, subresource, D3D11_MAP_READ, 0, &mapped))) {
+                ERROR("ReflectionProbes", "finishReadback", "Failed to map a probe face.");
+                return true;
+            }
+            unsigned char* target = image.data.data() + face * faceBytes + level.offset;
+            for (unsigned int row = 0; row < level.height; ++row) {
+                memcpy(target + row * level.rowPitch, static_cast<const unsigned char*>(mapped.pData) + row * mapped.RowPitch,
+                    level.rowPitch);
+            }
+            deviceContext.Unmap(m_staging, subresource);
+        }
+    }
+    if (SUCCEEDED(DdsFile::write(getCacheFile(index), image))) {
+        MESSAGE("ReflectionProbes", "finishReadback", ("Cached static probe " + std::to_string(index)).c_str());
+    }
+    return true;
+}
+
+void ReflectionProbes::schedule(DeviceContext& deviceContext, unsigned int faceBudget, bool allowStatic,
+    std::vector<Face>& faces) {
+    faces.clear();
+    if (!isReady()) {
+        return;
+    }
+    if (m_readbackProbe >= 0) {
+        finishReadback(deviceContext);
+    }
+
+    // Estáticas de la caché: sin capturar nada.
+    bool changed = m_paramsDirty;
+    for (unsigned int i = 0; i < m_probes.size(); ++i) {
+        Probe& probe = m_probes[i];
+        if (!probe.isStatic || !probe.dirty || probe.cacheTried) {
+            continue;
+        }
+        probe.cacheTried = true;
+        if (!m_cachePath.empty() && m_current != static_cast<int>(i) && loadCached(deviceContext, i)) {
+            probe.ready = true;
+            probe.dirty = false;
+            changed = true;
+        }
+    }
+    if (changed) {
+        uploadParams(deviceContext);
+    }
+
+    // Caras: se termina la sonda empezada; luego las estáticas pendientes (una lectura a
+    // la vez) y las dinámicas por turnos.
+    const unsigned int count = static_cast<unsigned int>(m_probes.size());
+    while (faces.size() < faceBudget) {
+        if (m_current < 0) {
+            for (unsigned int i = 0; i < count && m_current < 0; ++i) {
+                const Probe& probe = m_probes[i];
+                if (probe.isStatic && probe.dirty && allowStatic && m_readbackProbe < 0) {
+                    m_current = static_cast<int>(i);
+                }
+            }
+            for (unsigned int step = 0; step < count && m_current < 0; ++step) {
+                const unsigned int i = (m_nextDynamic + step) % count;
+                if (!m_probes[i].isStatic) {
+                    m_current = static_cast<int>(i);
+                    m_nextDynamic = i + 1;
+                }
+            }
+            if (m_current < 0) {
+                break;
+            }
+            m_nextFace = 0;
+        }
+        Face face;
+        face.probe = static_cast<unsigned int>(m_current);
+        face.face = m_nextFace;
+        faces.push_back(face);
+        if (++m_nextFace == 6) {
+            m_current = -1;
+            // Una sola dinámica sin estáticas: no repetir la misma sonda en el mismo frame.
+            if (!m_probes[face.probe].isStatic) {
+                break;
+            }
+        }
+    }
+}
+
+XMMATRIX ReflectionProbes::getFaceView(const Face& face) const {
+    const XMFLOAT3& position = m_probes[face.probe].position;
+    const XMVECTOR eye = XMLoadFloat3(&position);
+    const XMVECTOR direction = XMVectorSet(kFaceAxes[face.face][0][0], kFaceAxes[face.face][0][1],
+        kFaceAxes[face.face][0][2], 0.0f);
+    const XMVECTOR up = XMVectorSet(kFaceAxes[face.face][1][0], kFaceAxes[face.face][1][1],
+        kFaceAxes[face.face][1][2], 0.0f);
+    return XMMatrixLookToLH(eye, direction, up);
+}
+
+XMMATRIX ReflectionProbes::getFaceProjection() {
+    return XMMatrixPerspectiveFovLH(XM_PIDIV2, 1.0f, kNearZ, kFarZ);
+}
+
+void ReflectionProbes::beginFace(DeviceContext& deviceContext, const Face& face, const float clearColor[4]) {
+    ID3D11RenderTargetView* rtv = m_captureRTV[face.face];
+    deviceContext.OMSetRenderTargets(1, &rtv, m_depthView);
+    deviceContext.ClearRenderTargetView(rtv, clearColor);
+    deviceContext.ClearDepthStencilView(m_depthView, D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
+    D3D11_VIEWPORT viewport = {};
+    viewport.Width = static_cast<float>(kFaceSize);
+    viewport.Height = static_cast<float>(kFaceSize);
+    viewport.MaxDepth = 1.0f;
+    deviceContext.RSSetViewports(1, &viewport);
+
+    CBNeverChanges view;
+    view.mView = XMMatrixTranspose(getFaceView(face));
+    m_faceView.set(view);
+    m_faceView.update(deviceContext);
+    m_faceView.render(deviceContext, CB_SLOT_VIEW);
+    m_faceProjection.update(deviceContext);
+    m_faceProjection.render(deviceContext, CB_SLOT_PROJECTION);
+}
+
+void ReflectionProbes::endFace(DeviceContext& deviceContext, const Face& face) {
+    ID3D11RenderTargetView* nullRTV = nullptr;
+    deviceContext.OMSetRenderTargets(1, &nullRTV, nullptr);
+    if (face.face != 5) {
+        return;
+    }
+    const unsigned int firstSlice = face.probe * 6;
+
+    // Mip 0: la captura tal cual (espejo). El resto, prefiltrado desde sus mips.
+    deviceContext.m_deviceContext->GenerateMips(m_captureSRV);
+    for (unsigned int f = 0; f < 6; ++f) {
+        deviceContext.CopySubresourceRegion(m_probeTexture, D3D11CalcSubresource(0, firstSlice + f, kMipCount),
+            0, 0, 0, m_captureTexture, D3D11CalcSubresource(0, f, kMipCount), nullptr);
+    }
+
+    // El array no puede estar enlazado como SRV mientras se escribe por UAV.
+    ID3D11ShaderResourceView* nullSRV = nullptr;
+    deviceContext.PSSetShaderResources(8, 1, &nullSRV);
+    deviceContext.CSSetShaderResources(8, 1, &nullSRV);
+    deviceContext.CSSetShader(m_prefilterShader, nullptr, 0);
+    deviceContext.CSSetShaderResources(0, 1, &m_captureSRV);
+    deviceContext.CSSetSamplers(0, 1, &m_sampler);
+    deviceContext.CSSetConstantBuffers(CB_SLOT_PROBES, 1, &m_prefilterParams);
+    for (unsigned int mip = 1; mip < kMipCount; ++mip) {
+        const unsigned int size = kFaceSize >> mip;
+        PrefilterParams params;
+        params.params = XMFLOAT4(static_cast<float>(mip) / static_cast<float>(kMipCount - 1), static_cast<float>(size),
+            static_cast<float>(firstSlice), static_cast<float>(kFaceSize));
+        deviceContext.UpdateSubresource(m_prefilterParams, 0, nullptr, &params, 0, 0);
+        deviceContext.CSSetUnorderedAccessViews(0, 1, &m_probeUAV[mip], nullptr);
+        const unsigned int groups = (size + kPrefilterTile - 1) / kPrefilterTile;
+        deviceContext.Dispatch(groups, groups, 6);
+    }
+    ID3D11UnorderedAccessView* nullUAV = nullptr;
+    deviceContext.CSSetUnorderedAccessViews(0, 1, &nullUAV, nullptr);
+    deviceContext.CSSetShaderResources(0, 1, &nullSRV);
+    deviceContext.CSSetShader(nullptr, nullptr, 0);
+
+    Probe& probe = m_probes[face.probe];
+    probe.ready = true;
+    if (probe.isStatic) {
+        probe.dirty = false;
+        if (!m_cachePath.empty() && m_readbackProbe < 0) {
+            for (unsigned int f = 0; f < 6; ++f) {
+                for (unsigned int mip = 0; mip < kMipCount; ++mip) {
+                    deviceContext.CopySubresourceRegion(m_staging, D3D11CalcSubresource(mip, f, kMipCount), 0, 0, 0,
+                        m_probeTexture, D3D11CalcSubresource(mip, firstSlice + f, kMipCount), nullptr);
+                }
+            }
+            m_readbackProbe = static_cast<int>(face.probe);
+        }
+    }
+    uploadParams(deviceContext);
+    bind(deviceContext);
+}
+
+void ReflectionProbes::uploadParams(DeviceContext& deviceContext) {
+    ProbeParams& params = m_paramsData;
+    for (unsigned int i = 0; i < kMaxProbes; ++i) {
+        const bool ready = i < m_probes.size() && m_probes[i].ready;
+        params.spheres[i] = ready ? XMFLOAT4(m_probes[i].position.x, m_probes[i].position.y, m_probes[i].position.z,
+            m_probes[i].radius) : XMFLOAT4(0.0f, 0.0f, 0.0f, 0.0f);
+    }
+    params.info = XMFLOAT4(m_enabled ? static_cast<float>(m_probes.size()) : 0.0f, static_cast<float>(kMipCount - 1), 1.0f, 0.0f);
+    deviceContext.UpdateSubresource(m_params, 0, nullptr, &params, 0, 0);
+    m_paramsDirty = false;
+}
+
+void ReflectionProbes::bind(DeviceContext& deviceContext) {
+    if (!isReady()) {
+        return;
+    }
+    deviceContext.PSSetShaderResources(8, 1, &m_probeSRV);
+    deviceContext.PSSetConstantBuffers(CB_SLOT_PROBES, 1, &m_params);
+    deviceContext.PSSetSamplers(2, 1, &m_sampler);
+    deviceContext.CSSetShaderResources(8, 1, &m_probeSRV);
+    deviceContext.CSSetConstantBuffers(CB_SLOT_PROBES, 1, &m_params);
+    deviceContext.CSSetSamplers(2, 1, &m_sampler);
+}
+
+void ReflectionProbes::destroy() {
+    SAFE_RELEASE(m_captureSRV);
+    for (ID3D11RenderTargetView*& rtv : m_captureRTV) {
+        SAFE_RELEASE(rtv);
+    }
+    SAFE_RELEASE(m_captureTexture);
+    SAFE_RELEASE(m_depthView);
+    SAFE_RELEASE(m_depthTexture);
+    SAFE_RELEASE(m_probeSRV);
+    for (ID3D11UnorderedAccessView*& uav : m_probeUAV) {
+        SAFE_RELEASE(uav);
+    }
+    SAFE_RELEASE(m_probeTexture);
+    SAFE_RELEASE(m_staging);
+    SAFE_RELEASE(m_prefilterShader);
+    SAFE_RELEASE(m_params);
+    SAFE_RELEASE(m_prefilterParams);
+    SAFE_RELEASE(m_sampler);
+    m_faceView.destroy();
+    m_faceProjection.destroy();
+    m_device = nullptr;
+    m_current = -1;
+    m_readbackProbe = -1;
+    m_paramsData = {};
+}
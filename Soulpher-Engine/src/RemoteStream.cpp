@@ -0,0 +1,758 @@
+﻿/**
+ * @file RemoteStream.cpp
+ * @brief Conversión a NV12, codificador de hardware de Media Foundation y envío UDP.
+ */
+
+// Winsock antes de <windows.h> (lo incluye Prerequisites.h): si no, choca con winsock.h.
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include "RemoteStream.h"
+#include "Device.h"
+#include "DeviceContext.h"
+#include "InputSystem.h"
+#include "ShaderLibrary.h"
+#include "Texture.h"
+#include <d3d10.h>
+#include <mfapi.h>
+#include <mfidl.h>
+#include <mferror.h>
+#include <mftransform.h>
+#include <codecapi.h>
+
+namespace {
+    /// `DXGI_FORMAT_NV12`: no está en el `dxgiformat.h` del SDK de junio de 2010.
+    const DXGI_FORMAT kFormatNV12 = static_cast<DXGI_FORMAT>(103);
+    /// Frames de diferencia entre frames clave (también se fuerzan a petición del cliente).
+    const unsigned long kKeyframeInterval = 120;
+
+    /// Formato con el que se lee la copia: sin sRGB (el shader quiere los valores en gamma).
+    void copyFormats(DXGI_FORMAT source, DXGI_FORMAT& texture, DXGI_FORMAT& view) {
+        switch (source) {
+        case DXGI_FORMAT_R8G8B8A8_UNORM:
+        case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+            texture = DXGI_FORMAT_R8G8B8A8_TYPELESS;
+            view = DXGI_FORMAT_R8G8B8A8_UNORM;
+            break;
+        case DXGI_FORMAT_B8G8R8A8_UNORM:
+        case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+            texture = DXGI_FORMAT_B8G8R8A8_TYPELESS;
+            view = DXGI_FORMAT_B8G8R8A8_UNORM;
+            break;
+        default:
+            texture = source;
+            view = source;
+            break;
+        }
+    }
+}
+
+HRESULT RemoteStream::init(Device& device, const Settings& settings) {
+    if (!device.m_device) {
+        ERROR("RemoteStream", "init", "Device is null.");
+        return E_POINTER;
+    }
+    if (settings.width == 0 || settings.height == 0 || (settings.width | settings.height) & 1 ||
+        settings.fps == 0 || settings.bitrate == 0) {
+        ERROR("RemoteStream", "init", "Stream size must be even and fps and bitrate non-zero");
+        return E_INVALIDARG;
+    }
+    destroy();
+    m_settings = settings;
+
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    m_ticksToMs = 1000.0 / static_cast<double>(frequency.QuadPart);
+
+    HRESULT hr = MFStartup(MF_VERSION);
+    if (FAILED(hr)) {
+        ERROR("RemoteStream", "init", "Media Foundation is not available");
+        return hr;
+    }
+    m_mediaFoundation = true;
+    m_device = device.m_device;
+    m_device->AddRef();
+
+    hr = createConversion(device);
+    if (SUCCEEDED(hr)) { hr = createEncoder(device); }
+    if (SUCCEEDED(hr)) { hr = openSocket(); }
+    if (FAILED(hr)) {
+        destroy();
+        return hr;
+    }
+
+    m_thread = std::thread(&RemoteStream::eventLoop, this);
+    // Empieza a pedir entrada cuando recibe START_OF_STREAM (ya en el hilo de eventos).
+    HRESULT start = m_encoder->ProcessMessage(MFT_MESSAGE_NOTIFY_BEGIN_STREAMING, 0);
+    if (SUCCEEDED(start)) { start = m_encoder->ProcessMessage(MFT_MESSAGE_NOTIFY_START_OF_STREAM, 0); }
+    if (FAILED(start)) {
+        ERROR("RemoteStream", "init", ("Encoder did not start. HRESULT: " + std::to_string(start)).c_str());
+        destroy();
+        return start;
+    }
+
+    char summary[160];
+    sprintf_s(summary, "Streaming %ux%u@%u %s at %.1f Mbps on UDP port %u%s%s",
+        settings.width, settings.height, settings.fps,
+        settings.codec == STREAM_CODEC_HEVC ? "HEVC" : "H.264", settings.bitrate / 1e6,
+        static_cast<unsigned int>(settings.port), settings.host.empty() ? "" : " to ",
+        settings.host.c_str());
+    MESSAGE("RemoteStream", "init", summary);
+    return S_OK;
+}
+
+HRESULT RemoteStream::createConversion(Device& device) {
+    D3D11_SAMPLER_DESC samplerDesc = {};
+    samplerDesc.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+    samplerDesc.AddressU = D3D11_TEXTURE_ADDRESS_CLAMP;
+    samplerDesc.AddressV = D3D11_TEXTURE_ADDRESS_CLAMP;
+    samplerDesc.AddressW = D3D11_TEXTURE_ADDRESS_CLAMP;
+    samplerDesc.ComparisonFunc = D3D11_COMPARISON_NEVER;
+    samplerDesc.MaxLOD = D3D11_FLOAT32_MAX;
+    HRESULT hr = device.CreateSharedSamplerState(&samplerDesc, &m_sampler);
+
+    ShaderKey key;
+    key.fileName = "StreamConvert.fx";
+    key.entryPoint = "VSStream";
+    key.profile = "vs_4_0";
+    if (SUCCEEDED(hr)) { hr = device.getShaderLibrary().getVertexShader(device, key, &m_vertexShader); }
+    key.entryPoint = "PSLuma";
+    key.profile = "ps_4_0";
+    if (SUCCEEDED(hr)) { hr = device.getShaderLibrary().getPixelShader(device, key, &m_lumaShader); }
+    key.entryPoint = "PSChroma";
+    if (SUCCEEDED(hr)) { hr = device.getShaderLibrary().getPixelShader(device, key, &m_chromaShader); }
+    if (FAILED(hr)) {
+        return hr;
+    }
+
+    // Los planos de NV12 se escriben por separado: una vista R8 es la luma y una R8G8, la croma.
+    D3D11_TEXTURE2D_DESC desc = {};
+    desc.Width = m_settings.width;
+    desc.Height = m_settings.height;
+    desc.MipLevels = 1;
+    desc.ArraySize = 1;
+    desc.Format = kFormatNV12;
+    desc.SampleDesc.Count = 1;
+    desc.Usage = D3D11_USAGE_DEFAULT;
+    desc.BindFlags = D3D11_BIND_RENDER_TARGET;
+    D3D11_RENDER_TARGET_VIEW_DESC viewDesc = {};
+    viewDesc.ViewDimension = D3D11_RTV_DIMENSION_TEXTURE2D;
+    for (Slot& slot : m_slots) {
+        hr = m_device->CreateTexture2D(&desc, nullptr, &slot.texture);
+        viewDesc.Format = DXGI_FORMAT_R8_UNORM;
+        if (SUCCEEDED(hr)) { hr = m_device->CreateRenderTargetView(slot.texture, &viewDesc, &slot.luma); }
+        viewDesc.Format = DXGI_FORMAT_R8G8_UNORM;
+        if (SUCCEEDED(hr)) { hr = m_device->CreateRenderTargetView(slot.texture, &viewDesc, &slot.chroma); }
+        if (FAILED(hr)) {
+            ERROR("RemoteStream", "createConversion",
+                ("NV12 render targets are not supported. HRESULT: " + std::to_string(hr)).c_str());
+            return hr;
+        }
+    }
+    return S_OK;
+}
+
+/**
+ * @details Solo codificadores de hardware (`MFT_ENUM_FLAG_HARDWARE`): el de software
+ * necesitaría leer cada frame a la CPU, que es justo lo que se evita. Son MFT asíncronos:
+ * hay que desbloquearlos (`MF_TRANSFORM_ASYNC_UNLOCK`) y piden la entrada por eventos.
+ * El tipo de salida va antes que el de entrada (el códec decide qué entradas acepta).
+ */
+HRESULT RemoteStream::createEncoder(Device& device) {
+    // El MFT usa el contexto inmediato desde sus hilos: el dispositivo se protege con un cerrojo.
+    ID3D10Multithread* multithread = nullptr;
+    if (SUCCEEDED(device.m_device->QueryInterface(__uuidof(ID3D10Multithread),
+        reinterpret_cast<void**>(&multithread)))) {
+        multithread->SetMultithreadProtected(TRUE);
+        SAFE_RELEASE(multithread);
+    }
+
+    HRESULT hr = MFCreateDXGIDeviceManager(&m_resetToken, &m_deviceManager);
+    if (SUCCEEDED(hr)) { hr = m_deviceManager->ResetDevice(m_device, m_resetToken); }
+    if (FAILED(hr)) {
+        ERROR("RemoteStream", "createEncoder", ("Cannot share the device. HRESULT: " + std::to_string(hr)).c_str());
+        return hr;
+    }
+
+    const GUID& subtype = m_settings.codec == STREAM_CODEC_HEVC ? MFVideoFormat_HEVC : MFVideoFormat_H264;
+    MFT_REGISTER_TYPE_INFO inputInfo = { MFMediaType_Video, MFVideoFormat_NV12 };
+    MFT_REGISTER_TYPE_INFO outputInfo = { MFMediaType_Video, subtype };
+    IMFActivate** activates = nullptr;
+    UINT32 count = 0;
+    hr = MFTEnumEx(MFT_CATEGORY_VIDEO_ENCODER, MFT_ENUM_FLAG_HARDWARE | MFT_ENUM_FLAG_SORTANDFILTER,
+        &inputInfo, &outputInfo, &activates, &count);
+    if (SUCCEEDED(hr) && count == 0) {
+        hr = MF_E_TOPO_CODEC_NOT_FOUND;
+    }
+    // El primero que acepte el dispositivo (el orden ya prefiere el del adaptador).
+    for (UINT32 i = 0; SUCCEEDED(hr) && i < count && !m_encoder; ++i) {
+        IMFTransform* encoder = nullptr;
+        if (FAILED(activates[i]->ActivateObject(IID_PPV_ARGS(&encoder)))) {
+            continue;
+        }
+        IMFAttributes* attributes = nullptr;
+        HRESULT attempt = encoder->GetAttributes(&attributes);
+        if (SUCCEEDED(attempt)) { attempt = attributes->SetUINT32(MF_TRANSFORM_ASYNC_UNLOCK, TRUE); }
+        if (SUCCEEDED(attempt)) { attributes->SetUINT32(MF_LOW_LATENCY, TRUE); }
+        if (SUCCEEDED(attempt)) {
+            attempt = encoder->ProcessMessage(MFT_MESSAGE_SET_D3D_MANAGER,
+                reinterpret_cast<ULONG_PTR>(m_deviceManager));
+        }
+        SAFE_RELEASE(attributes);
+        if (SUCCEEDED(attempt)) {
+            WCHAR name[128] = L"";
+            activates[i]->GetString(MFT_FRIENDLY_NAME_Attribute, name, ARRAYSIZE(name), nullptr);
+            char narrow[128];
+            WideCharToMultiByte(CP_UTF8, 0, name, -1, narrow, sizeof(narrow), nullptr, nullptr);
+            MESSAGE("RemoteStream", "createEncoder", (std::string("Hardware encoder: ") + narrow).c_str());
+            m_encoder = encoder;
+        }
+        else {
+            activates[i]->ShutdownObject();
+            SAFE_RELEASE(encoder);
+        }
+    }
+    for (UINT32 i = 0; i < count; ++i) {
+        SAFE_RELEASE(activates[i]);
+    }
+    CoTaskMemFree(activates);
+    if (SUCCEEDED(hr) && !m_encoder) {
+        hr = MF_E_TOPO_CODEC_NOT_FOUND;
+    }
+    if (FAILED(hr)) {
+        ERROR("RemoteStream", "createEncoder",
+            ("No hardware encoder accepts the device. HRESULT: " + std::to_string(hr)).c_str());
+        return hr;
+    }
+
+    // Muchos MFT no numeran sus flujos (E_NOTIMPL): entonces son 0 y 0.
+    if (FAILED(m_encoder->GetStreamIDs(1, &m_inputStreamId, 1, &m_outputStreamId))) {
+        m_inputStreamId = 0;
+        m_outputStreamId = 0;
+    }
+
+    IMFMediaType* output = nullptr;
+    hr = MFCreateMediaType(&output);
+    if (SUCCEEDED(hr)) { hr = output->SetGUID(MF_MT_MAJOR_TYPE, MFMediaType_Video); }
+    if (SUCCEEDED(hr)) { hr = output->SetGUID(MF_MT_SUBTYPE, subtype); }
+    if (SUCCEEDED(hr)) { hr = output->SetUINT32(MF_MT_AVG_BITRATE, m_settings.bitrate); }
+    if (SUCCEEDED(hr)) { hr = output->SetUINT32(MF_MT_INTERLACE_MODE, MFVideoInterlace_Progressive); }
+    if (SUCCEEDED(hr)) { hr = MFSetAttributeSize(output, MF_MT_FRAME_SIZE, m_settings.width, m_settings.height); }
+    if (SUCCEEDED(hr)) { hr = MFSetAttributeRatio(output, MF_MT_FRAME_RATE, m_settings.fps, 1); }
+    if (SUCCEEDED(hr)) { hr = MFSetAttributeRatio(output, MF_MT_PIXEL_ASPECT_RATIO, 1, 1); }
+    if (SUCCEEDED(hr)) {
+        hr = output->SetUINT32(MF_MT_MPEG2_PROFILE, m_settings.codec == STREAM_CODEC_HEVC
+            ? eAVEncH265VProfile_Main_420_8 : eAVEncH264VProfile_Main);
+    }
+    if (SUCCEEDED(hr)) { hr = m_encoder->SetOutputType(m_outputStreamId, output, 0); }
+    SAFE_RELEASE(output);
+    if (FAILED(hr)) {
+        ERROR("RemoteStream", "createEncoder", ("Output type rejected. HRESULT: " + std::to_string(hr)).c_str());
+        return hr;
+    }
+
+    // La entrada parte del tipo NV12 que ofrece el códec, con el tamaño y la cadencia.
+    IMFMediaType* input = nullptr;
+    hr = MF_E_INVALIDMEDIATYPE;
+    for (DWORD i = 0; ; ++i) {
+        IMFMediaType* available = nullptr;
+        if (FAILED(m_encoder->GetInputAvailableType(m_inputStreamId, i, &available))) {
+            break;
+        }
+        GUID format = GUID_NULL;
+        available->GetGUID(MF_MT_SUBTYPE, &format);
+        if (format == MFVideoFormat_NV12) {
+            input = available;
+            hr = S_OK;
+            break;
+        }
+        SAFE_RELEASE(available);
+    }
+    if (SUCCEEDED(hr)) { hr = MFSetAttributeSize(input, MF_MT_FRAME_SIZE, m_settings.width, m_settings.height); }
+    if (SUCCEEDED(hr)) { hr = MFSetAttributeRatio(input, MF_MT_FRAME_RATE, m_settings.fps, 1); }
+    if (SUCCEEDED(hr)) { hr = m_encoder->SetInputType(m_inputStreamId, input, 0); }
+    SAFE_RELEASE(input);
+    if (FAILED(hr)) {
+        ERROR("RemoteStream", "createEncoder", ("NV12 input rejected. HRESULT: " + std::to_string(hr)).c_str());
+        return hr;
+    }
+
+    // Latencia antes que calidad: CBR, GOP fijo y sin frames B (reordenarían la salida).
+    if (SUCCEEDED(m_encoder->QueryInterface(IID_PPV_ARGS(&m_codecApi)))) {
+        setCodecValue(CODECAPI_AVLowLatencyMode, TRUE);
+        setCodecValue(CODECAPI_AVEncCommonRateControlMode, eAVEncCommonRateControlMode_CBR);
+        setCodecValue(CODECAPI_AVEncCommonMeanBitRate, m_settings.bitrate);
+        setCodecValue(CODECAPI_AVEncMPVGOPSize, kKeyframeInterval);
+        setCodecValue(CODECAPI_AVEncMPVDefaultBPictureCount, 0);
+    }
+
+    MFT_OUTPUT_STREAM_INFO info = {};
+    hr = m_encoder->GetOutputStreamInfo(m_outputStreamId, &info);
+    if (SUCCEEDED(hr)) {
+        m_providesSamples = (info.dwFlags &
+            (MFT_OUTPUT_STREAM_PROVIDES_SAMPLES | MFT_OUTPUT_STREAM_CAN_PROVIDE_SAMPLES)) != 0;
+        m_outputBufferSize = (std::max)(info.cbSize, m_settings.width * m_settings.height * 3 / 2);
+        hr = m_encoder->QueryInterface(IID_PPV_ARGS(&m_events));
+    }
+    if (FAILED(hr)) {
+        ERROR("RemoteStream", "createEncoder", ("Encoder is not asynchronous. HRESULT: " + std::to_string(hr)).c_str());
+    }
+    return hr;
+}
+
+void RemoteStream::setCodecValue(const GUID& property, unsigned long value) {
+    VARIANT variant;
+    VariantInit(&variant);
+    variant.vt = VT_UI4;
+    variant.ulVal = value;
+    // Opcional: cada fabricante implementa un subconjunto.
+    m_codecApi->SetValue(&property, &variant);
+}
+
+HRESULT RemoteStream::openSocket() {
+    WSADATA data;
+    int error = WSAStartup(MAKEWORD(2, 2), &data);
+    if (error != 0) {
+        ERROR("RemoteStream", "openSocket", ("Winsock is not available. Error: " + std::to_string(error)).c_str());
+        return HRESULT_FROM_WIN32(error);
+    }
+    m_winsock = true;
+
+    const SOCKET udp = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (udp == INVALID_SOCKET) {
+        error = WSAGetLastError();
+        ERROR("RemoteStream", "openSocket", ("Cannot create the socket. Error: " + std::to_string(error)).c_str());
+        return HRESULT_FROM_WIN32(error);
+    }
+    m_socket = udp;
+
+    // Sin bloqueo en los dos sentidos: la entrada se lee una vez por frame y un envío
+    // que no cabe se pierde (el cliente pide un frame clave).
+    u_long nonBlocking = 1;
+    ioctlsocket(udp, FIONBIO, &nonBlocking);
+    const int sendBuffer = 1 << 20;
+    setsockopt(udp, SOL_SOCKET, SO_SNDBUF, reinterpret_cast<const char*>(&sendBuffer), sizeof(sendBuffer));
+
+    sockaddr_in local = {};
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    local.sin_port = htons(m_settings.port);
+    if (bind(udp, reinterpret_cast<const sockaddr*>(&local), sizeof(local)) == SOCKET_ERROR) {
+        error = WSAGetLastError();
+        ERROR("RemoteStream", "openSocket",
+            ("Cannot listen on port " + std::to_string(m_settings.port) + ". Error: " + std::to_string(error)).c_str());
+        return HRESULT_FROM_WIN32(error);
+    }
+
+    if (!m_settings.host.empty()) {
+        addrinfo hints = {};
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_DGRAM;
+        addrinfo* result = nullptr;
+        error = getaddrinfo(m_settings.host.c_str(), std::to_string(m_settings.port).c_str(), &hints, &result);
+        if (error != 0 || !result) {
+            ERROR("RemoteStream", "openSocket", ("Cannot resolve " + m_settings.host).c_str());
+            return HRESULT_FROM_WIN32(error != 0 ? error : WSAHOST_NOT_FOUND);
+        }
+        memcpy(m_destination, result->ai_addr, sizeof(sockaddr_in));
+        m_destinationSize = sizeof(sockaddr_in);
+        freeaddrinfo(result);
+    }
+    return S_OK;
+}
+
+HRESULT RemoteStream::ensureSourceCopy(ID3D11Texture2D* source) {
+    D3D11_TEXTURE2D_DESC sourceDesc;
+    source->GetDesc(&sourceDesc);
+    DXGI_FORMAT textureFormat, viewFormat;
+    copyFormats(sourceDesc.Format, textureFormat, viewFormat);
+    if (m_sourceCopy) {
+        D3D11_TEXTURE2D_DESC copyDesc;
+        m_sourceCopy->GetDesc(&copyDesc);
+        if (copyDesc.Width == sourceDesc.Width && copyDesc.Height == sourceDesc.Height &&
+            copyDesc.Format == textureFormat) {
+            return S_OK;
+        }
+        SAFE_RELEASE(m_sourceSRV);
+        SAFE_RELEASE(m_sourceCopy);
+    }
+
+    D3D11_TEXTURE2D_DESC desc = {};
+    desc.Width = sourceDesc.Width;
+    desc.Height = sourceDesc.Height;
+    desc.MipLevels = 1;
+    desc.ArraySize = 1;
+    desc.Format = textureFormat;
+    desc.SampleDesc.Count = 1;
+    desc.Usage = D3D11_USAGE_DEFAULT;
+    desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+    HRESULT hr = m_device->CreateTexture2D(&desc, nullptr, &m_sourceCopy);
+    D3D11_SHADER_RESOURCE_VIEW_DESC viewDesc = {};
+    viewDesc.Format = viewFormat;
+    viewDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+    viewDesc.Texture2D.MipLevels = 1;
+    if (SUCCEEDED(hr)) { hr = m_device->CreateShaderResourceView(m_sourceCopy, &viewDesc, &m_sourceSRV); }
+    if (FAILED(hr)) {
+        ERROR("RemoteStream", "ensureSourceCopy", ("Cannot create the frame copy. HRESULT: " + std::to_string(hr)).c_str());
+        SAFE_RELEASE(m_sourceCopy);
+        return hr;
+    }
+    return S_OK;
+}
+
+/**
+ * @details Sin petición pendiente del codificador el frame se descarta (no se encola):
+ * así la latencia no crece aunque la GPU renderice más rápido de lo que se codifica.
+ * La cuenta de slots basta porque el MFT pide una entrada nueva solo cuando ya tiene
+ * sitio, y nunca tiene más de @ref kSlots en vuelo con el modo de baja latencia.
+ */
+void RemoteStream::submit(DeviceContext& deviceContext, Texture& source) {
+    if (!isRunning() || !source.raw()) {
+        return;
+    }
+    if (m_inputRequests.load(std::memory_order_acquire) <= 0) {
+        std::lock_guard<std::mutex> lock(m_statsMutex);
+        ++m_stats.dropped;
+        return;
+    }
+    if (FAILED(ensureSourceCopy(source.raw()))) {
+        return;
+    }
+
+    D3D11_TEXTURE2D_DESC sourceDesc;
+    source.raw()->GetDesc(&sourceDesc);
+    DXGI_FORMAT textureFormat, viewFormat;
+    copyFormats(sourceDesc.Format, textureFormat, viewFormat);
+    if (sourceDesc.SampleDesc.Count > 1) {
+        deviceContext.ResolveSubresource(m_sourceCopy, 0, source.raw(), 0, viewFormat);
+    }
+    else {
+        deviceContext.CopySubresourceRegion(m_sourceCopy, 0, 0, 0, 0, source.raw(), 0, nullptr);
+    }
+
+    Slot& slot = m_slots[m_nextSlot];
+    m_nextSlot = (m_nextSlot + 1) % kSlots;
+
+    deviceContext.OMSetBlendState(nullptr, nullptr, 0xffffffff);
+    deviceContext.IASetInputLayout(nullptr);
+    deviceContext.IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    deviceContext.VSSetShader(m_vertexShader, nullptr, 0);
+    deviceContext.PSSetShaderResources(0, 1, &m_sourceSRV);
+    deviceContext.PSSetSamplers(0, 1, &m_sampler);
+
+    D3D11_VIEWPORT viewport = {};
+    viewport.Width = static_cast<float>(m_settings.width);
+    viewport.Height = static_cast<float>(m_settings.height);
+    viewport.MaxDepth = 1.0f;
+    deviceContext.OMSetRenderTargets(1, &slot.luma, nullptr);
+    deviceContext.RSSetViewports(1, &viewport);
+    deviceContext.PSSetShader(m_lumaShader, nullptr, 0);
+    deviceContext.Draw(3, 0);
+
+    viewport.Width *= 0.5f;
+    viewport.Height *= 0.5f;
+    deviceContext.OMSetRenderTargets(1, &slot.chroma, nullptr);
+    deviceContext.RSSetViewports(1, &viewport);
+    deviceContext.PSSetShader(m_chromaShader, nullptr, 0);
+    deviceContext.Draw(3, 0);
+
+    ID3D11ShaderResourceView* nullSRV = nullptr;
+    deviceContext.PSSetShaderResources(0, 1, &nullSRV);
+    ID3D11RenderTargetView* nullRTV = nullptr;
+    deviceContext.OMSetRenderTargets(1, &nullRTV, nullptr);
+    // El codificador lee la textura en su propia cola: lo de arriba tiene que salir ya.
+    deviceContext.m_deviceContext->Flush();
+
+    IMFMediaBuffer* buffer = nullptr;
+    IMFSample* sample = nullptr;
+    HRESULT hr = MFCreateDXGISurfaceBuffer(__uuidof(ID3D11Texture2D), slot.texture, 0, FALSE, &buffer);
+    IMF2DBuffer* buffer2D = nullptr;
+    if (SUCCEEDED(hr) && SUCCEEDED(buffer->QueryInterface(IID_PPV_ARGS(&buffer2D)))) {
+        DWORD length = 0;
+        buffer2D->GetContiguousLength(&length);
+        buffer->SetCurrentLength(length);
+        SAFE_RELEASE(buffer2D);
+    }
+    if (SUCCEEDED(hr)) { hr = MFCreateSample(&sample); }
+    if (SUCCEEDED(hr)) { hr = sample->AddBuffer(buffer); }
+    const LONGLONG duration = 10000000LL / m_settings.fps;
+    if (SUCCEEDED(hr)) { hr = sample->SetSampleTime(static_cast<LONGLONG>(m_frameIndex) * duration); }
+    if (SUCCEEDED(hr)) { hr = sample->SetSampleDuration(duration); }
+    if (SUCCEEDED(hr)) {
+        if (m_keyframeRequested.exchange(false) && m_codecApi) {
+            setCodecValue(CODECAPI_AVEncVideoForceKeyFrame, 1);
+        }
+        LARGE_INTEGER now;
+        QueryPerformanceCounter(&now);
+        m_submitTicks[m_frameIndex % ARRAYSIZE(m_submitTicks)] = now.QuadPart;
+        m_inputRequests.fetch_sub(1, std::memory_order_acq_rel);
+        hr = m_encoder->ProcessInput(m_inputStreamId, sample, 0);
+    }
+    SAFE_RELEASE(sample);
+    SAFE_RELEASE(buffer);
+
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    if (SUCCEEDED(hr)) {
+        ++m_frameIndex;
+        ++m_stats.submitted;
+    }
+    else {
+        ++m_stats.dropped;
+    }
+}
+
+void RemoteStream::eventLoop() {
+    for (;;) {
+        IMFMediaEvent* event = nullptr;
+        if (FAILED(m_events->GetEvent(0, &event))) {
+            break;
+        }
+        MediaEventType type = MEUnknown;
+        event->GetType(&type);
+        SAFE_RELEASE(event);
+        if (type == METransformNeedInput) {
+            m_inputRequests.fetch_add(1, std::memory_order_acq_rel);
+        }
+        else if (type == METransformHaveOutput) {
+            drainOutput();
+        }
+        else if (type == METransformDrainComplete) {
+            break;
+        }
+    }
+}
+
+void RemoteStream::drainOutput() {
+    MFT_OUTPUT_DATA_BUFFER output = {};
+    output.dwStreamID = m_outputStreamId;
+    IMFSample* ownSample = nullptr;
+    if (!m_providesSamples) {
+        IMFMediaBuffer* buffer = nullptr;
+        if (FAILED(MFCreateSample(&ownSample)) || FAILED(MFCreateMemoryBuffer(m_outputBufferSize, &buffer))) {
+            SAFE_RELEASE(ownSample);
+            return;
+        }
+        ownSample->AddBuffer(buffer);
+        SAFE_RELEASE(buffer);
+        output.pSample = ownSample;
+    }
+
+    DWORD status = 0;
+    HRESULT hr = m_encoder->ProcessOutput(0, 1, &output, &status);
+    if (hr == MF_E_TRANSFORM_STREAM_CHANGE) {
+        // El códec cambió su salida (p. ej. cabeceras nuevas): se acepta la que propone.
+        IMFMediaType* type = nullptr;
+        if (SUCCEEDED(m_encoder->GetOutputAvailableType(m_outputStreamId, 0, &type))) {
+            m_encoder->SetOutputType(m_outputStreamId, type, 0);
+            SAFE_RELEASE(type);
+        }
+    }
+    else if (SUCCEEDED(hr) && output.pSample) {
+        IMFMediaBuffer* buffer = nullptr;
+        if (SUCCEEDED(output.pSample->ConvertToContiguousBuffer(&buffer))) {
+            BYTE* data = nullptr;
+            DWORD length = 0;
+            if (SUCCEEDED(buffer->Lock(&data, nullptr, &length))) {
+                UINT32 keyframe = FALSE;
+                output.pSample->GetUINT32(MFSampleExtension_CleanPoint, &keyframe);
+                LONGLONG sampleTime = 0;
+                output.pSample->GetSampleTime(&sampleTime);
+                sendFrame(data, length, keyframe != FALSE, sampleTime);
+                buffer->Unlock();
+            }
+            SAFE_RELEASE(buffer);
+        }
+    }
+
+    SAFE_RELEASE(output.pEvents);
+    if (output.pSample != ownSample) {
+        SAFE_RELEASE(output.pSample);
+    }
+    SAFE_RELEASE(ownSample);
+}
+
+void RemoteStream::sendFrame(const BYTE* data, DWORD size, bool keyframe, LONGLONG sampleTime) {
+    sockaddr_in destination;
+    {
+        std::lock_guard<std::mutex> lock(m_destinationMutex);
+        if (m_destinationSize == 0) {
+            return;     // nadie escucha todavía
+        }
+        memcpy(&destination, m_destination, sizeof(destination));
+    }
+
+    const unsigned int fragments = (size + kMaxPayload - 1) / kMaxPayload;
+    if (fragments == 0 || fragments > 0xffff) {
+        return;
+    }
+    char packet[sizeof(PacketHeader) + kMaxPayload];
+    PacketHeader header = {};
+    header.frame = m_sentFrames++;
+    header.fragmentCount = static_cast<uint16_t>(fragments);
+    header.keyframe = keyframe ? 1 : 0;
+    unsigned int failed = 0;
+    for (unsigned int i = 0; i < fragments; ++i) {
+        const DWORD offset = i * kMaxPayload;
+        const DWORD bytes = (std::min)(static_cast<DWORD>(kMaxPayload), size - offset);
+        header.fragment = static_cast<uint16_t>(i);
+        memcpy(packet, &header, sizeof(header));
+        memcpy(packet + sizeof(header), data + offset, bytes);
+        if (sendto(static_cast<SOCKET>(m_socket), packet, static_cast<int>(sizeof(header) + bytes), 0,
+            reinterpret_cast<const sockaddr*>(&destination), sizeof(destination)) == SOCKET_ERROR) {
+            ++failed;
+        }
+    }
+
+    // Latencia de esta máquina: del submit de ese frame al último trozo enviado.
+    const LONGLONG duration = 10000000LL / m_settings.fps;
+    const unsigned long long index = static_cast<unsigned long long>((sampleTime + duration / 2) / duration);
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    const double latencyMs = static_cast<double>(now.QuadPart - m_submitTicks[index % ARRAYSIZE(m_submitTicks)]) * m_ticksToMs;
+
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    ++m_stats.sent;
+    m_stats.bytes += size;
+    m_stats.averageLatencyMs = m_stats.sent == 1 ? latencyMs : m_stats.averageLatencyMs * 0.95 + latencyMs * 0.05;
+    m_stats.maxLatencyMs = (std::max)(m_stats.maxLatencyMs, latencyMs);
+    if (failed > 0) {
+        // El cliente verá el hueco y pedirá un frame clave; aquí solo se cuenta.
+        ++m_stats.dropped;
+    }
+}
+
+void RemoteStream::receiveInput(InputSystem& input) {
+    if (m_socket == static_cast<unsigned long long>(INVALID_SOCKET)) {
+        return;
+    }
+    for (;;) {
+        InputPacket packet;
+        sockaddr_in sender = {};
+        int senderSize = sizeof(sender);
+        const int received = recvfrom(static_cast<SOCKET>(m_socket), reinterpret_cast<char*>(&packet),
+            sizeof(packet), 0, reinterpret_cast<sockaddr*>(&sender), &senderSize);
+        if (received == SOCKET_ERROR) {
+            // WSAEWOULDBLOCK: no queda nada. WSAECONNRESET: el cliente cerró (ICMP), se ignora.
+            if (WSAGetLastError() == WSAECONNRESET) {
+                continue;
+            }
+            break;
+        }
+        if (received != sizeof(packet)) {
+            continue;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_destinationMutex);
+            if (m_destinationSize == 0 || memcmp(m_destination, &sender, sizeof(sender)) != 0) {
+                memcpy(m_destination, &sender, sizeof(sender));
+                m_destinationSize = sizeof(sender);
+                m_keyframeRequested = true;
+                char address[INET_ADDRSTRLEN] = "";
+                inet_ntop(AF_INET, &sender.sin_addr, address, sizeof(address));
+                MESSAGE("RemoteStream", "receiveInput", (std::string("Streaming to ") + address + ":" +
+                    std::to_string(ntohs(sender.sin_port))).c_str());
+            }
+        }
+
+        switch (packet.type) {
+        case InputPacket::HELLO:
+        case InputPacket::KEYFRAME:
+            m_keyframeRequested = true;
+            break;
+        case InputPacket::MOUSE_MOVE:
+            input.injectMouseMove(packet.x, packet.y);
+            break;
+        case InputPacket::MOUSE_BUTTON:
+            if (packet.code < InputSystem::MOUSE_BUTTON_COUNT) {
+                input.injectButton(static_cast<InputSystem::MouseButton>(packet.code), packet.down != 0);
+            }
+            break;
+        case InputPacket::WHEEL:
+            input.injectWheel(packet.x / static_cast<float>(WHEEL_DELTA));
+            break;
+        case InputPacket::KEY:
+            input.injectKey(packet.code, packet.down != 0);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+RemoteStream::Stats RemoteStream::getStats() {
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    Stats stats = m_stats;
+    m_stats.maxLatencyMs = 0.0;
+    return stats;
+}
+
+void RemoteStream::destroy() {
+    if (m_encoder) {
+        // El hilo de eventos sale con METransformDrainComplete.
+        if (m_thread.joinable()) {
+            HRESULT hr = m_encoder->ProcessMessage(MFT_MESSAGE_NOTIFY_END_OF_STREAM, m_inputStreamId);
+            if (SUCCEEDED(hr)) { hr = m_encoder->ProcessMessage(MFT_MESSAGE_COMMAND_DRAIN, m_inputStreamId); }
+            if (FAILED(hr)) {
+                // Sin vaciado no llega DrainComplete: cerrar la cola de eventos despierta a GetEvent.
+                IMFShutdown* shutdown = nullptr;
+                if (SUCCEEDED(m_encoder->QueryInterface(IID_PPV_ARGS(&shutdown)))) {
+                    shutdown->Shutdown();
+                    SAFE_RELEASE(shutdown);
+                }
+            }
+            m_thread.join();
+        }
+        m_encoder->ProcessMessage(MFT_MESSAGE_NOTIFY_END_STREAMING, 0);
+        m_encoder->ProcessMessage(MFT_MESSAGE_SET_D3D_MANAGER, 0);
+
+        const Stats stats = getStats();
+        char summary[192];
+        sprintf_s(summary, "Stream stopped: %llu frames sent (%.1f MB), %llu dropped, encode+send latency %.1f ms",
+            stats.sent, stats.bytes / (1024.0 * 1024.0), stats.dropped, stats.averageLatencyMs);
+        MESSAGE("RemoteStream", "destroy", summary);
+
+        IMFShutdown* shutdown = nullptr;
+        if (SUCCEEDED(m_encoder->QueryInterface(IID_PPV_ARGS(&shutdown)))) {
+            shutdown->Shutdown();
+            SAFE_RELEASE(shutdown);
+        }
+    }
+    SAFE_RELEASE(m_codecApi);
+    SAFE_RELEASE(m_events);
+    SAFE_RELEASE(m_encoder);
+    SAFE_RELEASE(m_deviceManager);
+
+    if (m_socket != static_cast<unsigned long long>(INVALID_SOCKET)) {
+        closesocket(static_cast<SOCKET>(m_socket));
+        m_socket = static_cast<unsigned long long>(INVALID_SOCKET);
+    }
+    if (m_winsock) {
+        WSACleanup();
+        m_winsock = false;
+    }
+    m_destinationSize = 0;
+
+    for (Slot& slot : m_slots) {
+        SAFE_RELEASE(slot.luma);
+        SAFE_RELEASE(slot.chroma);
+        SAFE_RELEASE(slot.texture);
+    }
+    SAFE_RELEASE(m_sourceSRV);
+    SAFE_RELEASE(m_sourceCopy);
+    SAFE_RELEASE(m_vertexShader);
+    SAFE_RELEASE(m_lumaShader);
+    SAFE_RELEASE(m_chromaShader);
+    SAFE_RELEASE(m_sampler);
+    SAFE_RELEASE(m_device);
+    if (m_mediaFoundation) {
+        MFShutdown();
+        m_mediaFoundation = false;
+    }
+
+    m_inputRequests = 0;
+    m_keyframeRequested = false;
+    m_frameIndex = 0;
+    m_sentFrames = 0;
+    m_nextSlot = 0;
+    m_stats = Stats();
+}
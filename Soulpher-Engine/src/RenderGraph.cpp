@@ -0,0 +1,254 @@
+﻿/**
+ * @file RenderGraph.cpp
+ * @brief Implementación del grafo de render: dependencias, descarte, orden y pool.
+ */
+
+#include "RenderGraph.h"
+#include "Device.h"
+#include "DeviceContext.h"
+#include <algorithm>
+
+namespace {
+    const uint32_t kNone = ~0u;
+}
+
+//
+// PassBuilder
+//
+
+RenderGraph::ResourceHandle RenderGraph::PassBuilder::create(const char* name, const TextureDesc& desc) {
+    Resource resource;
+    resource.name = name;
+    resource.desc = desc;
+    resource.producer = m_pass;
+    m_graph.m_resources.push_back(resource);
+    return write(static_cast<ResourceHandle>(m_graph.m_resources.size() - 1));
+}
+
+RenderGraph::ResourceHandle RenderGraph::PassBuilder::read(ResourceHandle resource) {
+    m_graph.addAccess(m_pass, resource, false);
+    return resource;
+}
+
+RenderGraph::ResourceHandle RenderGraph::PassBuilder::write(ResourceHandle resource) {
+    m_graph.addAccess(m_pass, resource, true);
+    return resource;
+}
+
+void RenderGraph::PassBuilder::sideEffect() {
+    m_graph.m_passes[m_pass].sideEffect = true;
+}
+
+//
+// Declaración
+//
+
+void RenderGraph::reset() {
+    releaseLeases();
+    m_passes.clear();
+    m_resources.clear();
+    m_order.clear();
+}
+
+RenderGraph::ResourceHandle RenderGraph::importTexture(const char* name, const TextureViews& views) {
+    Resource resource;
+    resource.name = name;
+    resource.imported = true;
+    resource.views = views;
+    m_resources.push_back(resource);
+    return static_cast<ResourceHandle>(m_resources.size() - 1);
+}
+
+void RenderGraph::addPass(const char* name, const SetupFunction& setup, const ExecuteFunction& execute) {
+    Pass pass;
+    pass.name = name;
+    pass.execute = execute;
+    m_passes.push_back(std::move(pass));
+    PassBuilder builder(*this, static_cast<uint32_t>(m_passes.size() - 1));
+    setup(builder);
+}
+
+void RenderGraph::addAccess(uint32_t pass, ResourceHandle handle, bool write) {
+    if (handle >= m_resources.size()) {
+        ERROR("RenderGraph", "addAccess", ("Invalid resource in pass " + std::string(m_passes[pass].name)).c_str());
+        return;
+    }
+    Resource& resource = m_resources[handle];
+    Pass& current = m_passes[pass];
+    if (resource.lastWriter != kNone && resource.lastWriter != pass) {
+        current.dependencies.push_back(resource.lastWriter);
+    }
+    if (!write) {
+        current.reads.push_back(handle);
+        resource.readersSinceWrite.push_back(pass);
+        return;
+    }
+    // Escribir encima de lo que otros leen: esos pases van antes.
+    for (uint32_t reader : resource.readersSinceWrite) {
+        if (reader != pass) {
+            current.dependencies.push_back(reader);
+        }
+    }
+    current.writes.push_back(handle);
+    resource.lastWriter = pass;
+    resource.readersSinceWrite.clear();
+}
+
+//
+// Compilación
+//
+
+HRESULT RenderGraph::compile(Device& device, RenderTargetPool& pool) {
+    releaseLeases();
+    m_pool = &pool;
+    m_order.clear();
+    m_culledPasses = 0;
+    m_transientCount = 0;
+    m_physicalCount = 0;
+    m_requestedBytes = 0;
+    m_allocatedBytes = 0;
+
+    // 1) Descarte, de atrás adelante: las dependencias siempre apuntan a pases anteriores,
+    //    así que al llegar a un pase ya se sabe si alguien vivo lee lo que escribe.
+    std::vector<bool> needed(m_resources.size(), false);
+    for (size_t p = m_passes.size(); p-- > 0;) {
+        Pass& pass = m_passes[p];
+        pass.alive = pass.sideEffect;
+        for (ResourceHandle handle : pass.writes) {
+            pass.alive = pass.alive || m_resources[handle].imported || needed[handle];
+        }
+        if (!pass.alive) {
+            ++m_culledPasses;
+            continue;
+        }
+        for (ResourceHandle handle : pass.reads) {
+            needed[handle] = true;
+        }
+    }
+
+    // 2) Orden topológico; entre los listos, el primero declarado.
+    std::vector<bool> scheduled(m_passes.size(), false);
+    const size_t aliveCount = m_passes.size() - m_culledPasses;
+    while (m_order.size() < aliveCount) {
+        uint32_t next = kNone;
+        for (uint32_t p = 0; p < m_passes.size() && next == kNone; ++p) {
+            if (!m_passes[p].alive || scheduled[p]) continue;
+            bool ready = true;
+            for (uint32_t dependency : m_passes[p].dependencies) {
+                ready = ready && (!m_passes[dependency].alive || scheduled[dependency]);
+            }
+            if (ready) {
+                next = p;
+            }
+        }
+        if (next == kNone) {
+            // Imposible con dependencias hacia atrás; se deja constancia por si cambia la API.
+            ERROR("RenderGraph", "compile", "Dependency cycle, frame skipped.");
+            m_order.clear();
+            return E_FAIL;
+        }
+        scheduled[next] = true;
+        m_order.push_back(next);
+    }
+
+    // 3) Vida de cada transitoria: del primer al último pase (en `m_order`) que la usa.
+    for (uint32_t position = 0; position < m_order.size(); ++position) {
+        const Pass& pass = m_passes[m_order[position]];
+        for (const std::vector<ResourceHandle>* list : { &pass.reads, &pass.writes }) {
+            for (ResourceHandle handle : *list) {
+                Resource& resource = m_resources[handle];
+                if (resource.imported) continue;
+                resource.firstUse = (std::min)(resource.firstUse, position);
+                resource.lastUse = (std::max)(resource.lastUse, position);
+            }
+        }
+    }
+
+    // 4) Memoria: por orden de nacimiento, cada transitoria toma una textura ya prestada
+    //    compatible cuya transitoria anterior murió, o pide otra al pool.
+    std::vector<ResourceHandle> transients;
+    for (ResourceHandle handle = 0; handle < m_resources.size(); ++handle) {
+        if (!m_resources[handle].imported && m_resources[handle].firstUse != kNone) {
+            transients.push_back(handle);
+        }
+    }
+    std::sort(transients.begin(), transients.end(), [this](ResourceHandle a, ResourceHandle b) {
+        return m_resources[a].firstUse < m_resources[b].firstUse;
+    });
+
+    HRESULT result = S_OK;
+    std::vector<bool> failed(m_resources.size(), false);
+    for (ResourceHandle handle : transients) {
+        Resource& resource = m_resources[handle];
+        HRESULT hr = S_OK;
+        resource.lease = acquire(device, resource.desc, resource.firstUse, resource.lastUse, hr);
+        if (resource.lease == kNone) {
+            ERROR("RenderGraph", "compile", ("Cannot create transient texture " + std::string(resource.name)).c_str());
+            failed[handle] = true;
+            result = hr;
+            continue;
+        }
+        resource.views = m_leases[resource.lease].target;
+        ++m_transientCount;
+        m_requestedBytes += RenderTargetPool::estimateBytes(resource.desc);
+    }
+    m_physicalCount = static_cast<unsigned int>(m_leases.size());
+    for (const Lease& lease : m_leases) {
+        m_allocatedBytes += RenderTargetPool::estimateBytes(lease.desc);
+    }
+
+    // Sin memoria para una transitoria: fuera los pases que la tocan.
+    if (FAILED(result)) {
+        m_order.erase(std::remove_if(m_order.begin(), m_order.end(), [&](uint32_t p) {
+            const Pass& pass = m_passes[p];
+            for (ResourceHandle handle : pass.reads) if (failed[handle]) return true;
+            for (ResourceHandle handle : pass.writes) if (failed[handle]) return true;
+            return false;
+        }), m_order.end());
+    }
+    return result;
+}
+
+uint32_t RenderGraph::acquire(Device& device, const TextureDesc& desc, uint32_t firstUse, uint32_t lastUse, HRESULT& hr) {
+    for (uint32_t i = 0; i < m_leases.size(); ++i) {
+        Lease& lease = m_leases[i];
+        if (lease.desc == desc && lease.busyUntil < firstUse) {
+            lease.busyUntil = lastUse;
+            return i;
+        }
+    }
+
+    Lease lease;
+    lease.desc = desc;
+    lease.busyUntil = lastUse;
+    hr = m_pool->acquire(device, desc, lease.target);
+    if (FAILED(hr)) {
+        return kNone;
+    }
+    m_leases.push_back(lease);
+    return static_cast<uint32_t>(m_leases.size() - 1);
+}
+
+void RenderGraph::releaseLeases() {
+    for (const Lease& lease : m_leases) {
+        m_pool->release(lease.target);
+    }
+    m_leases.clear();
+}
+
+//
+// Ejecución
+//
+
+void RenderGraph::execute(DeviceContext& deviceContext) {
+    for (uint32_t p : m_order) {
+        m_passes[p].execute(deviceContext, *this);
+    }
+    // Las vistas siguen en `m_resources`, pero la memoria ya es del pool.
+    releaseLeases();
+}
+
+const RenderGraph::TextureViews& RenderGraph::getTexture(ResourceHandle resource) const {
+    static const TextureViews kEmpty;
+    return resource < m_resources.size() ? m_resources[resource].views : kEmpty;
+}
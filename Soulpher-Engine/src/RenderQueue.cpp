@@ -0,0 +1,623 @@
+﻿/**
+ * @file RenderQueue.cpp
+ * @brief Implementación de la cola de render ordenada por clave.
+ *
+ * @details
+ * Cada capa se ordena con `std::sort` sobre entradas (clave, índice) y luego
+ * se recorre enlazando solo el estado que cambia respecto al paquete anterior.
+ * Con cientos de actores que comparten sampler, rasterizer y blend state, esto
+ * elimina la mayoría de llamadas redundantes a D3D11.
+ *
+ * En la capa opaca, antes de ordenar, los paquetes con la misma geometría y
+ * estado se agrupan (ordenando índices por identidad de recursos) y cada grupo
+ * de `kMinInstanceBatch` o más se sustituye por un lote instanciado.
+ *
+ * Ordenar y agrupar una capa se hace una sola vez por frame (`prepare`): el
+ * pre-pase de profundidad y el pase principal recorren la misma lista.
+ */
+
+#include "RenderQueue.h"
+#include "DeferredRecorder.h"
+#include "ActorCost.h"
+#include "Device.h"
+#include "DeviceContext.h"
+#include "Buffer.h"
+#include "Texture.h"
+#include "ShaderProgram.h"
+#include "BlendState.h"
+#include "Rasterizer.h"
+#include "SamplerState.h"
+#include "Material.h"
+#include "VertexLayout.h"
+#include <cstring>
+#include <tuple>
+
+namespace {
+    constexpr uint64_t kDepthBits30 = (1ull << 30) - 1;
+
+    /// Convierte una profundidad positiva en 30 bits monotónicos
+    /// (el patrón de bits IEEE-754 de un float positivo crece con su valor).
+    uint64_t quantizeDepth(float depth) {
+        if (!(depth > 0.0f)) { depth = 0.0f; }
+        uint32_t bits;
+        std::memcpy(&bits, &depth, sizeof(bits));
+        return (static_cast<uint64_t>(bits) >> 1) & kDepthBits30;
+    }
+
+    /// Constantes de material que enlaza el paquete (nulas = las por defecto de la cola).
+    const Buffer* materialConstants(const DrawPacket& p) {
+        return p.material ? p.material->getConstants() : nullptr;
+    }
+
+    /// Identidad de lo que se enlaza en un draw: dos paquetes iguales aquí son instanciables.
+    /// `material` es la textura o, si la textura tiene capa en el pool, su array.
+    auto geometryKey(const DrawPacket& p, const void* material) {
+        return std::make_tuple(
+            reinterpret_cast<uintptr_t>(p.vertexBuffer), reinterpret_cast<uintptr_t>(p.indexBuffer),
+            p.startIndex, p.indexCount, p.baseVertex,
+            reinterpret_cast<uintptr_t>(material), reinterpret_cast<uintptr_t>(materialConstants(p)),
+            reinterpret_cast<uintptr_t>(p.shader),
+            reinterpret_cast<uintptr_t>(p.blendState), reinterpret_cast<uintptr_t>(p.rasterizer),
+            reinterpret_cast<uintptr_t>(p.sampler));
+    }
+}
+
+/**
+ * @brief Reserva memoria inicial para cada bucket.
+ */
+void RenderQueue::init(Device& device, unsigned int reservePackets) {
+    m_device = &device;
+    for (auto& bucket : m_buckets) {
+        bucket.reserve(reservePackets);
+    }
+    for (auto& entries : m_sortEntries) {
+        entries.reserve(reservePackets);
+    }
+    m_groupScratch.reserve(reservePackets);
+    m_consumed.reserve(reservePackets);
+    m_instanceData.reserve(reservePackets);
+
+    HRESULT hr = m_objectConstants.init(device);
+    if (FAILED(hr)) {
+        ERROR("RenderQueue", "init", "Failed to create the object constant ring");
+    }
+}
+
+/**
+ * @brief Vacía los buckets (conservando su capacidad) y guarda la vista.
+ */
+void RenderQueue::update(const XMMATRIX& view) {
+    for (auto& bucket : m_buckets) {
+        bucket.clear();
+    }
+    for (bool& prepared : m_prepared) {
+        prepared = false;
+    }
+    m_objectConstants.update();
+    m_view = view;
+    XMStoreFloat3(&m_viewPosition, XMMatrixInverse(nullptr, view).r[3]);
+    m_clustersTested = 0;
+    m_clustersCulled = 0;
+}
+
+/**
+ * @brief Ordena la capa indicada y emite sus draws filtrando estado repetido.
+ */
+void RenderQueue::render(DeviceContext& deviceContext, RenderLayer layer) {
+    if (layer >= RENDER_LAYER_COUNT) {
+        ERROR("RenderQueue", "render", "Invalid render layer");
+        return;
+    }
+    prepare(deviceContext, layer);
+    draw(deviceContext, layer, false);
+}
+
+/**
+ * @brief Pre-pase de profundidad de la capa opaca con los programas solo-profundidad.
+ *
+ * @details
+ * Usa el mismo orden (adelante -> atrás) y los mismos lotes instanciados que el
+ * pase principal; este los reutiliza sin volver a ordenar ni a subir datos.
+ */
+void RenderQueue::renderDepthOnly(DeviceContext& deviceContext, bool alphaTested) {
+    if (!m_depthProgram) {
+        ERROR("RenderQueue", "renderDepthOnly", "Depth program not set");
+        return;
+    }
+    prepare(deviceContext, RENDER_LAYER_OPAQUE);
+    draw(deviceContext, RENDER_LAYER_OPAQUE, true);
+    if (alphaTested) {
+        prepare(deviceContext, RENDER_LAYER_ALPHA_TESTED);
+        draw(deviceContext, RENDER_LAYER_ALPHA_TESTED, true);
+    }
+}
+
+/**
+ * @brief Ordena la capa y crea sus lotes instanciados (una vez por frame).
+ */
+void RenderQueue::prepare(DeviceContext& deviceContext, RenderLayer layer) {
+    if (m_prepared[layer]) {
+        return;
+    }
+    m_prepared[layer] = true;
+
+    std::vector<DrawPacket>& bucket = m_buckets[layer];
+    std::vector<SortEntry>& sortEntries = m_sortEntries[layer];
+    sortEntries.clear();
+    m_objectBlocks[layer].assign(bucket.size(), nullptr);
+    if (bucket.empty()) {
+        return;
+    }
+    m_consumed.assign(bucket.size(), 0);
+
+    // Instancing solo en opacos: en transparentes el orden por profundidad manda.
+    if (layer == RENDER_LAYER_OPAQUE) {
+        m_batches.clear();
+        m_instancedDraws = 0;
+        m_arrayDraws = 0;
+        if (m_instancing && m_instancingProgram && m_device) {
+            buildInstanceBatches(deviceContext, bucket);
+        }
+    }
+
+    for (unsigned int i = 0; i < bucket.size(); ++i) {
+        if (!m_consumed[i]) {
+            sortEntries.push_back({ makeSortKey(bucket[i]), i });
+        }
+    }
+    std::sort(sortEntries.begin(), sortEntries.end(),
+        [](const SortEntry& a, const SortEntry& b) { return a.key < b.key; });
+}
+
+/**
+ * @brief Recorre la capa preparada y emite sus draws.
+ *
+ * @details
+ * En modo solo-profundidad se enlaza el stream de posiciones (`positionBuffer`,
+ * o el intercalado si no hay) y los programas sin Pixel Shader; blend, sampler
+ * y textura no afectan a la Z y se omiten.
+ */
+void RenderQueue::draw(DeviceContext& deviceContext, RenderLayer layer, bool depthOnly) {
+    std::vector<DrawPacket>& bucket = m_buckets[layer];
+    if (bucket.empty()) {
+        return;
+    }
+    const std::vector<SortEntry>& sortEntries = m_sortEntries[layer];
+    const unsigned int count = static_cast<unsigned int>(sortEntries.size());
+    // Los timestamps del actor medido solo valen en el contexto inmediato.
+    if (!m_recorder || !m_recorder->isReady() || (m_costs && m_costs->isProfiling())) {
+        drawRange(deviceContext, layer, depthOnly, 0, count);
+        return;
+    }
+
+    // Los contextos diferidos no pueden mapear el anillo con NO_OVERWRITE: las
+    // constantes de todos los paquetes se suben antes, aquí, en el inmediato.
+    for (const SortEntry& entry : sortEntries) {
+        if ((entry.index & kBatchFlag) == 0 && bucket[entry.index].objectData) {
+            objectConstants(deviceContext, layer, entry.index, bucket[entry.index]);
+        }
+    }
+    m_recorder->record(deviceContext, count,
+        [this, layer, depthOnly](DeviceContext& context, unsigned int begin, unsigned int end) {
+            drawRange(context, layer, depthOnly, begin, end);
+        });
+}
+
+/**
+ * @brief Emite las entradas ordenadas `[begin, end)` de la capa.
+ *
+ * @note Puede llamarse a la vez desde varios hilos con contextos diferidos distintos:
+ * solo lee la cola y los bloques de constantes ya subidos.
+ */
+void RenderQueue::drawRange(DeviceContext& deviceContext, RenderLayer layer, bool depthOnly,
+    unsigned int begin, unsigned int end) {
+    std::vector<DrawPacket>& bucket = m_buckets[layer];
+    const std::vector<SortEntry>& sortEntries = m_sortEntries[layer];
+
+    // Último estado enlazado (solo dentro de esta capa: quien dibuje entre
+    // capas puede cambiar el pipeline, así que se empieza siempre de cero).
+    ShaderProgram* lastShader = nullptr;
+    BlendState* lastBlend = nullptr;
+    Rasterizer* lastRasterizer = nullptr;
+    SamplerState* lastSampler = nullptr;
+    Buffer* lastVertexBuffer = nullptr;
+    Buffer* lastIndexBuffer = nullptr;
+    Buffer* lastModelBuffer = nullptr;
+    Texture* lastTexture = nullptr;
+    ID3D11ShaderResourceView* lastArray = nullptr;
+    Buffer* lastMaterialConstants = nullptr;
+    ID3D11ShaderResourceView* lastLightmap = nullptr;
+    Buffer* lastLightmapUVs = nullptr;
+    Buffer* lastLightmapConstants = nullptr;
+    Buffer* defaultMaterialConstants = m_defaultMaterial ? m_defaultMaterial->getConstants() : nullptr;
+
+    deviceContext.IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    // Solo la capa transparente mezcla: en las demás se ignora el estado del paquete.
+    const bool blended = layer == RENDER_LAYER_TRANSPARENT;
+    if (!depthOnly && !blended) {
+        float blendFactor[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        deviceContext.OMSetBlendState(nullptr, blendFactor, 0xffffffff);
+    }
+
+    for (unsigned int i = begin; i < end; ++i) {
+        const SortEntry& entry = sortEntries[i];
+        const bool isBatch = (entry.index & kBatchFlag) != 0;
+        DrawPacket& p = isBatch ? m_batches[entry.index & ~kBatchFlag] : bucket[entry.index];
+        if (!p.vertexBuffer || !p.indexBuffer || p.indexCount == 0) {
+            continue;
+        }
+
+        ShaderProgram* shader = p.shader ? p.shader : m_defaultProgram;
+        Buffer* vertexBuffer = p.vertexBuffer;
+        if (depthOnly) {
+            shader = (p.instanceCount > 1) ? m_depthInstancedProgram : m_depthProgram;
+            if (!shader) {
+                continue;
+            }
+            if (p.positionBuffer) {
+                vertexBuffer = p.positionBuffer;
+            }
+        }
+
+        if (shader && shader != lastShader) {
+            shader->render(deviceContext);
+            lastShader = shader;
+        }
+        if (!depthOnly && blended && p.blendState && p.blendState != lastBlend) {
+            p.blendState->render(deviceContext);
+            lastBlend = p.blendState;
+        }
+        Rasterizer* rasterizer = (depthOnly && m_depthRasterizer) ? m_depthRasterizer : p.rasterizer;
+        if (rasterizer && rasterizer != lastRasterizer) {
+            rasterizer->render(deviceContext);
+            lastRasterizer = rasterizer;
+        }
+        if (!depthOnly && p.sampler && p.sampler != lastSampler) {
+            p.sampler->render(deviceContext, 0, 1);
+            lastSampler = p.sampler;
+        }
+        if (vertexBuffer != lastVertexBuffer) {
+            vertexBuffer->render(deviceContext, VERTEX_STREAM_GEOMETRY, 1);
+            lastVertexBuffer = vertexBuffer;
+        }
+        if (p.indexBuffer != lastIndexBuffer) {
+            p.indexBuffer->render(deviceContext, 0, 1, false, p.indexFormat);
+            lastIndexBuffer = p.indexBuffer;
+        }
+        if (p.objectData && !isBatch) {
+            Buffer* constants = objectConstants(deviceContext, layer, entry.index, p);
+            if (constants && constants != lastModelBuffer) {
+                constants->render(deviceContext, CB_SLOT_OBJECT, 1, true);
+                lastModelBuffer = constants;
+            }
+        }
+        else if (p.modelBuffer && p.modelBuffer != lastModelBuffer) {
+            p.modelBuffer->render(deviceContext, CB_SLOT_OBJECT, 1, true);
+            lastModelBuffer = p.modelBuffer;
+        }
+        Buffer* materialBuffer = p.material ? p.material->getConstants() : defaultMaterialConstants;
+        if (!depthOnly && materialBuffer && materialBuffer != lastMaterialConstants) {
+            materialBuffer->render(deviceContext, CB_SLOT_MATERIAL, 1, true);
+            lastMaterialConstants = materialBuffer;
+        }
+        if (!depthOnly && p.textureArray) {
+            if (p.textureArray != lastArray) {
+                deviceContext.PSSetShaderResources(0, 1, &p.textureArray);
+                lastArray = p.textureArray;
+                lastTexture = nullptr;
+            }
+        }
+        else if (!depthOnly && p.texture && p.texture != lastTexture) {
+            p.texture->render(deviceContext, 0, 1);
+            lastTexture = p.texture;
+            lastArray = nullptr;
+        }
+        if (!depthOnly && p.lightmap && p.lightmapUVs && p.lightmapConstants && shader == m_lightmapProgram) {
+            if (p.lightmap != lastLightmap) {
+                deviceContext.PSSetShaderResources(7, 1, &p.lightmap);
+                lastLightmap = p.lightmap;
+            }
+            if (p.lightmapUVs != lastLightmapUVs) {
+                p.lightmapUVs->render(deviceContext, VERTEX_STREAM_LIGHTMAP, 1);
+                lastLightmapUVs = p.lightmapUVs;
+            }
+            if (p.lightmapConstants != lastLightmapConstants) {
+                p.lightmapConstants->render(deviceContext, CB_SLOT_LIGHTMAP, 1, true);
+                lastLightmapConstants = p.lightmapConstants;
+            }
+        }
+
+        if (p.instanceCount > 1) {
+            // El lote se nombra por su primer actor y el número de instancias.
+            char batchName[96] = "";
+            if (deviceContext.areEventMarkersActive()) {
+                sprintf_s(batchName, "%s x%u", p.name ? p.name : "Batch", p.instanceCount);
+            }
+            DeviceContext::EventScope event(deviceContext, batchName);
+            m_instanceBuffer.render(deviceContext, VERTEX_STREAM_INSTANCE, 1);
+            if (!depthOnly && p.textureArray) {
+                m_sliceBuffer.render(deviceContext, VERTEX_STREAM_SLICE, 1);
+            }
+            deviceContext.DrawIndexedInstanced(p.indexCount, p.instanceCount,
+                p.startIndex, p.baseVertex, p.firstInstance);
+        }
+        else if (m_costs && m_costs->isProfiled(p.owner)) {
+            DeviceContext::EventScope event(deviceContext, p.name);
+            const unsigned int scope = m_costs->beginGpuScope(deviceContext, m_shadowCosts);
+            deviceContext.DrawIndexed(p.indexCount, p.startIndex, p.baseVertex);
+            m_costs->endGpuScope(deviceContext, scope);
+        }
+        else {
+            DeviceContext::EventScope event(deviceContext, p.name);
+            deviceContext.DrawIndexed(p.indexCount, p.startIndex, p.baseVertex);
+        }
+    }
+}
+
+/**
+ * @brief Constantes transitorias del paquete: un bloque del anillo, subido una sola vez.
+ *
+ * @note Si el anillo falla se recurre al `modelBuffer` del actor (UpdateSubresource).
+ */
+Buffer* RenderQueue::objectConstants(DeviceContext& deviceContext, RenderLayer layer,
+    unsigned int index, const DrawPacket& packet) {
+    Buffer*& block = m_objectBlocks[layer][index];
+    if (block || deviceContext.isDeferred()) {
+        // En un contexto diferido solo vale lo que `draw` subió antes.
+        return block;
+    }
+    block = m_objectConstants.allocate(deviceContext, packet.objectData, sizeof(CBChangesEveryFrame));
+    if (!block && packet.modelBuffer) {
+        packet.modelBuffer->update(deviceContext, nullptr, 0, nullptr, packet.objectData, 0, 0);
+        block = packet.modelBuffer;
+    }
+    return block;
+}
+
+/**
+ * @brief Fusiona paquetes con idéntica geometría/estado en lotes instanciados.
+ *
+ * @details
+ * 1) Ordena los índices de paquetes instanciables por `geometryKey`.
+ * 2) Cada racha de `kMinInstanceBatch` o más paquetes se convierte en un lote:
+ *    sus `objectData` se copian consecutivos a `m_instanceData`.
+ * 3) Se sube todo con un solo `WRITE_DISCARD`. Si falla, no se crea ningún lote
+ *    y los paquetes se dibujan uno a uno como siempre.
+ *
+ * Con arrays de texturas, en el paso 1 se busca la capa de cada textura y se agrupa
+ * por el array; el stream de capas se sube igual, en paralelo al de instancias.
+ */
+void RenderQueue::buildInstanceBatches(DeviceContext& deviceContext, std::vector<DrawPacket>& bucket) {
+    m_groupScratch.clear();
+    m_instanceData.clear();
+    m_sliceData.clear();
+    m_slots.assign(bucket.size(), TextureArrayPool::Slot());
+    for (unsigned int i = 0; i < bucket.size(); ++i) {
+        // Un programa propio (p. ej. el de un material) no tiene variante instanciada.
+        const bool defaultShader = !bucket[i].shader || bucket[i].shader == m_receiverProgram;
+        // El actor medido va suelto: sus draws llevan timestamps propios.
+        const bool profiled = m_costs && m_costs->isProfiled(bucket[i].owner);
+        if (bucket[i].objectData && bucket[i].instanceCount == 1 && defaultShader && !profiled) {
+            m_groupScratch.push_back(i);
+            if (m_textureArrays && bucket[i].texture && arrayProgramFor(bucket[i])) {
+                m_slots[i] = m_textureArrays->resolve(deviceContext, bucket[i].texture);
+            }
+        }
+    }
+    if (m_groupScratch.size() < kMinInstanceBatch) {
+        return;
+    }
+
+    auto material = [this, &bucket](unsigned int i) -> const void* {
+        return m_slots[i].srv ? static_cast<const void*>(m_slots[i].srv) : bucket[i].texture;
+    };
+    std::sort(m_groupScratch.begin(), m_groupScratch.end(),
+        [&bucket, &material](unsigned int a, unsigned int b) {
+            return geometryKey(bucket[a], material(a)) < geometryKey(bucket[b], material(b));
+        });
+
+    bool anyArray = false;
+    size_t runStart = 0;
+    while (runStart < m_groupScratch.size()) {
+        const unsigned int firstIndex = m_groupScratch[runStart];
+        const DrawPacket& first = bucket[firstIndex];
+        const auto key = geometryKey(first, material(firstIndex));
+        size_t runEnd = runStart + 1;
+        while (runEnd < m_groupScratch.size() &&
+            geometryKey(bucket[m_groupScratch[runEnd]], material(m_groupScratch[runEnd])) == key) {
+            ++runEnd;
+        }
+
+        const unsigned int count = static_cast<unsigned int>(runEnd - runStart);
+        if (count >= kMinInstanceBatch) {
+            DrawPacket batch = first;
+            batch.shader = (first.shader && first.shader == m_receiverProgram && m_receiverInstancedProgram)
+                ? m_receiverInstancedProgram : m_instancingProgram;
+            if (m_slots[firstIndex].srv) {
+                batch.shader = arrayProgramFor(first);
+                batch.texture = nullptr;
+                batch.textureArray = m_slots[firstIndex].srv;
+                anyArray = true;
+                ++m_arrayDraws;
+            }
+            batch.instanceCount = count;
+            batch.firstInstance = static_cast<unsigned int>(m_instanceData.size());
+            batch.objectData = nullptr;
+            for (size_t k = runStart; k < runEnd; ++k) {
+                const DrawPacket& member = bucket[m_groupScratch[k]];
+                m_instanceData.push_back(*member.objectData);
+                m_sliceData.push_back(m_slots[m_groupScratch[k]].slice);
+                batch.depth = std::min(batch.depth, member.depth); // el más cercano decide el orden
+                m_consumed[m_groupScratch[k]] = 1;
+            }
+            m_batches.push_back(batch);
+        }
+        runStart = runEnd;
+    }
+
+    if (m_batches.empty()) {
+        return;
+    }
+
+    const unsigned int bytes = static_cast<unsigned int>(m_instanceData.size() * sizeof(CBChangesEveryFrame));
+    HRESULT hr = reserveInstanceBuffer(bytes);
+    if (SUCCEEDED(hr)) {
+        hr = m_instanceBuffer.write(deviceContext, m_instanceData.data(), bytes);
+    }
+    if (SUCCEEDED(hr) && anyArray) {
+        const unsigned int sliceBytes = static_cast<unsigned int>(m_sliceData.size() * sizeof(unsigned int));
+        hr = reserveSliceBuffer(sliceBytes);
+        if (SUCCEEDED(hr)) {
+            hr = m_sliceBuffer.write(deviceContext, m_sliceData.data(), sliceBytes);
+        }
+    }
+    if (FAILED(hr)) {
+        ERROR("RenderQueue", "buildInstanceBatches", "Instance upload failed, drawing packets individually");
+        m_batches.clear();
+        m_arrayDraws = 0;
+        std::fill(m_consumed.begin(), m_consumed.end(), 0);
+        return;
+    }
+
+    for (unsigned int b = 0; b < m_batches.size(); ++b) {
+        m_sortEntries[RENDER_LAYER_OPAQUE].push_back({ makeSortKey(m_batches[b]), b | kBatchFlag });
+    }
+    m_instancedDraws = static_cast<unsigned int>(m_batches.size());
+}
+
+/**
+ * @brief Recrea el buffer de instancias si no cabe `bytes` (crece en potencias de 2).
+ */
+HRESULT RenderQueue::reserveInstanceBuffer(unsigned int bytes) {
+    if (m_instanceBuffer.getByteWidth() >= bytes) {
+        return S_OK;
+    }
+    unsigned int capacity = 64 * sizeof(CBChangesEveryFrame);
+    while (capacity < bytes) {
+        capacity *= 2;
+    }
+    m_instanceBuffer.destroy();
+    return m_instanceBuffer.initDynamic(*m_device, capacity,
+        sizeof(CBChangesEveryFrame), D3D11_BIND_VERTEX_BUFFER);
+}
+
+/**
+ * @brief Igual que `reserveInstanceBuffer`, para el stream de capas (4 bytes por instancia).
+ */
+HRESULT RenderQueue::reserveSliceBuffer(unsigned int bytes) {
+    if (m_sliceBuffer.getByteWidth() >= bytes) {
+        return S_OK;
+    }
+    unsigned int capacity = 64 * sizeof(unsigned int);
+    while (capacity < bytes) {
+        capacity *= 2;
+    }
+    m_sliceBuffer.destroy();
+    return m_sliceBuffer.initDynamic(*m_device, capacity, sizeof(unsigned int), D3D11_BIND_VERTEX_BUFFER);
+}
+
+/**
+ * @brief El lote de un receptor de sombra usa la variante receptora; el resto, la general.
+ */
+ShaderProgram* RenderQueue::arrayProgramFor(const DrawPacket& packet) const {
+    if (packet.shader && packet.shader == m_receiverProgram) {
+        return m_receiverInstancedProgram ? m_receiverArrayProgram : nullptr;
+    }
+    return m_arrayProgram;
+}
+
+/**
+ * @brief Libera la memoria reservada por los buckets.
+ */
+void RenderQueue::destroy() {
+    for (auto& bucket : m_buckets) {
+        bucket.clear();
+        bucket.shrink_to_fit();
+    }
+    for (auto& entries : m_sortEntries) {
+        entries.clear();
+        entries.shrink_to_fit();
+    }
+    for (auto& blocks : m_objectBlocks) {
+        blocks.clear();
+    }
+    m_batches.clear();
+    m_instanceData.clear();
+    m_sliceData.clear();
+    m_slots.clear();
+    m_instanceBuffer.destroy();
+    m_sliceBuffer.destroy();
+    m_objectConstants.destroy();
+    m_device = nullptr;
+}
+
+/**
+ * @brief Inserta un paquete en el bucket de su capa.
+ *
+ * @details Los receptores de sombra sin shader propio toman aquí el programa
+ * receptor, así la clave y la agrupación en lotes ya los distinguen. Los paquetes con
+ * lightmap toman antes el suyo: la sombra del sol ya va horneada.
+ */
+void RenderQueue::submit(const DrawPacket& packet) {
+    if (packet.layer >= RENDER_LAYER_COUNT) {
+        ERROR("RenderQueue", "submit", "Invalid render layer");
+        return;
+    }
+    m_buckets[packet.layer].push_back(packet);
+    if (m_costs && m_costs->isTracking()) {
+        m_costs->record(packet.owner, packet.indexCount, m_shadowCosts);
+    }
+    if (packet.lightmap && !packet.shader && m_lightmapProgram) {
+        m_buckets[packet.layer].back().shader = m_lightmapProgram;
+    }
+    else if (packet.receiveShadow && !packet.shader && m_receiverProgram) {
+        m_buckets[packet.layer].back().shader = m_receiverProgram;
+    }
+}
+
+/**
+ * @brief Transforma una posición de mundo a vista y devuelve su z.
+ */
+float RenderQueue::computeViewDepth(const XMVECTOR& worldPosition) const {
+    XMVECTOR viewPos = XMVector3TransformCoord(worldPosition, m_view);
+    return XMVectorGetZ(viewPos);
+}
+
+/**
+ * @brief Construye la clave según la capa (ver distribución en RenderQueue.h).
+ */
+uint64_t RenderQueue::makeSortKey(const DrawPacket& packet) {
+    const uint64_t layer = static_cast<uint64_t>(packet.layer) & 0x3;
+    const uint64_t shader = stateId(packet.shader);
+    uint64_t material = stateId(packet.texture);
+    if (packet.textureArray) {
+        material = stateId(packet.textureArray);
+    }
+    else if (packet.material) {
+        material = packet.material->getID();
+    }
+    const uint64_t depth = quantizeDepth(packet.depth);
+
+    if (packet.layer == RENDER_LAYER_TRANSPARENT) {
+        const uint64_t invDepth = (~depth) & kDepthBits30;
+        return (layer << 62) | (invDepth << 32) | (shader << 16) | material;
+    }
+    return (layer << 62) | (shader << 46) | (material << 30) | depth;
+}
+
+/**
+ * @brief Mezcla los bits del puntero y se queda con 16 bits.
+ *
+ * @note Dos estados distintos pueden colisionar; solo afecta al orden (no a la
+ * corrección), porque cada paquete enlaza sus propios recursos.
+ */
+uint64_t RenderQueue::stateId(const void* ptr) {
+    if (!ptr) {
+        return 0;
+    }
+    uint64_t v = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(ptr));
+    v ^= v >> 33;
+    v *= 0xff51afd7ed558ccdull;
+    v ^= v >> 33;
+    return (v & 0xffff) | 1; // nunca 0: 0 está reservado para "sin estado"
+}
@@ -0,0 +1,126 @@
+﻿/**
+ * @file RenderStateCache.cpp
+ * @brief Implementación de la caché de estados compartidos.
+ */
+
+#include "RenderStateCache.h"
+#include "Device.h"
+#include <cstring>
+
+template<typename DescT, typename StateT, typename CreateFn>
+HRESULT RenderStateCache::acquire(Cache<DescT, StateT>& cache, const DescT& desc,
+    StateT** ppState, CreateFn create) {
+    if (!ppState) {
+        ERROR("RenderStateCache", "acquire", "ppState is nullptr");
+        return E_POINTER;
+    }
+
+    const uint64_t key = hashBytes(&desc, sizeof(DescT));
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<typename Cache<DescT, StateT>::Entry>& bucket = cache.buckets[key];
+    for (auto& entry : bucket) {
+        if (std::memcmp(&entry.desc, &desc, sizeof(DescT)) == 0) {
+            entry.state->AddRef();
+            *ppState = entry.state;
+            ++m_hits;
+            return S_OK;
+        }
+    }
+
+    StateT* state = nullptr;
+    HRESULT hr = create(&desc, &state);
+    if (FAILED(hr)) {
+        return hr;
+    }
+    bucket.push_back({ desc, state });
+    ++cache.count;
+
+    // La caché conserva su referencia; el usuario recibe la suya.
+    state->AddRef();
+    *ppState = state;
+    return S_OK;
+}
+
+template<typename DescT, typename StateT>
+void RenderStateCache::release(Cache<DescT, StateT>& cache) {
+    for (auto& bucket : cache.buckets) {
+        for (auto& entry : bucket.second) {
+            SAFE_RELEASE(entry.state);
+        }
+    }
+    cache.buckets.clear();
+    cache.count = 0;
+}
+
+/**
+ * @brief Sampler compartido para `desc`.
+ */
+HRESULT RenderStateCache::getSamplerState(Device& device, const D3D11_SAMPLER_DESC& desc,
+    ID3D11SamplerState** ppState) {
+    return acquire(m_samplers, desc, ppState,
+        [&device](const D3D11_SAMPLER_DESC* d, ID3D11SamplerState** out) {
+            return device.CreateSamplerState(d, out);
+        });
+}
+
+/**
+ * @brief Blend state compartido para `desc`.
+ */
+HRESULT RenderStateCache::getBlendState(Device& device, const D3D11_BLEND_DESC& desc,
+    ID3D11BlendState** ppState) {
+    return acquire(m_blendStates, desc, ppState,
+        [&device](const D3D11_BLEND_DESC* d, ID3D11BlendState** out) {
+            return device.CreateBlendState(d, out);
+        });
+}
+
+/**
+ * @brief Depth/stencil state compartido para `desc`.
+ */
+HRESULT RenderStateCache::getDepthStencilState(Device& device, const D3D11_DEPTH_STENCIL_DESC& desc,
+    ID3D11DepthStencilState** ppState) {
+    return acquire(m_depthStates, desc, ppState,
+        [&device](const D3D11_DEPTH_STENCIL_DESC* d, ID3D11DepthStencilState** out) {
+            return device.CreateDepthStencilState(d, out);
+        });
+}
+
+/**
+ * @brief Rasterizer state compartido para `desc`.
+ */
+HRESULT RenderStateCache::getRasterizerState(Device& device, const D3D11_RASTERIZER_DESC& desc,
+    ID3D11RasterizerState** ppState) {
+    return acquire(m_rasterizers, desc, ppState,
+        [&device](const D3D11_RASTERIZER_DESC* d, ID3D11RasterizerState** out) {
+            return device.CreateRasterizerState(d, out);
+        });
+}
+
+/**
+ * @brief Libera las referencias retenidas por la caché.
+ */
+void RenderStateCache::destroy() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    release(m_samplers);
+    release(m_blendStates);
+    release(m_depthStates);
+    release(m_rasterizers);
+    m_hits = 0;
+}
+
+/**
+ * @brief Total de estados únicos vivos en la caché.
+ */
+unsigned int RenderStateCache::getStateCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_samplers.count + m_blendStates.count + m_depthStates.count + m_rasterizers.count;
+}
+
+/**
+ * @brief FNV-1a de 64 bits (@ref EU::Fnv1a).
+ */
+uint64_t RenderStateCache::hashBytes(const void* data, size_t size) {
+    uint64_t hash = EU::kFnv1aSeed;
+    EU::Fnv1a(hash, data, size);
+    return hash;
+}
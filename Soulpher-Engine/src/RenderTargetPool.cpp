@@ -0,0 +1,152 @@
+﻿/**
+ * @file RenderTargetPool.cpp
+ * @brief Implementación del pool de render targets.
+ */
+
+#include "RenderTargetPool.h"
+#include "Device.h"
+#include "GpuMemory.h"
+#include <algorithm>
+
+namespace {
+    DXGI_FORMAT viewFormat(DXGI_FORMAT view, DXGI_FORMAT texture) {
+        return view != DXGI_FORMAT_UNKNOWN ? view : texture;
+    }
+
+    D3D11_TEXTURE2D_DESC textureDesc(const RenderTargetPool::Desc& desc) {
+        D3D11_TEXTURE2D_DESC out = {};
+        out.Width = desc.width;
+        out.Height = desc.height;
+        out.MipLevels = 1;
+        out.ArraySize = 1;
+        out.Format = desc.format;
+        out.SampleDesc.Count = (std::max)(1u, desc.sampleCount);
+        out.SampleDesc.Quality = desc.sampleQuality;
+        out.Usage = D3D11_USAGE_DEFAULT;
+        out.BindFlags = desc.bindFlags;
+        return out;
+    }
+}
+
+bool RenderTargetPool::Desc::operator==(const Desc& other) const {
+    return width == other.width && height == other.height && format == other.format &&
+        bindFlags == other.bindFlags && sampleCount == other.sampleCount &&
+        sampleQuality == other.sampleQuality && rtvFormat == other.rtvFormat &&
+        dsvFormat == other.dsvFormat && srvFormat == other.srvFormat && uavFormat == other.uavFormat;
+}
+
+HRESULT RenderTargetPool::acquire(Device& device, const Desc& desc, Target& out) {
+    for (Entry& entry : m_entries) {
+        if (!entry.leased && entry.desc == desc) {
+            entry.leased = true;
+            entry.lastFrame = m_frame;
+            out = entry.target;
+            return S_OK;
+        }
+    }
+
+    Entry entry;
+    entry.desc = desc;
+    HRESULT hr = create(device, desc, entry.target);
+    if (FAILED(hr)) {
+        ERROR("RenderTargetPool", "acquire", ("Cannot create render target " + std::to_string(desc.width) + "x" +
+            std::to_string(desc.height) + ". hr=" + std::to_string(hr)).c_str());
+        return hr;
+    }
+    entry.leased = true;
+    entry.lastFrame = m_frame;
+    m_entries.push_back(entry);
+    out = entry.target;
+    return S_OK;
+}
+
+void RenderTargetPool::release(const Target& target) {
+    for (Entry& entry : m_entries) {
+        if (entry.target.texture == target.texture) {
+            entry.leased = false;
+            return;
+        }
+    }
+}
+
+void RenderTargetPool::update() {
+    ++m_frame;
+    for (size_t i = m_entries.size(); i-- > 0;) {
+        if (!m_entries[i].leased && m_frame - m_entries[i].lastFrame > kRetainFrames) {
+            destroyTarget(m_entries[i].target);
+            m_entries.erase(m_entries.begin() + i);
+        }
+    }
+}
+
+void RenderTargetPool::clear() {
+    for (Entry& entry : m_entries) {
+        destroyTarget(entry.target);
+    }
+    m_entries.clear();
+}
+
+unsigned int RenderTargetPool::getLeasedCount() const {
+    unsigned int count = 0;
+    for (const Entry& entry : m_entries) {
+        count += entry.leased ? 1 : 0;
+    }
+    return count;
+}
+
+unsigned long long RenderTargetPool::getAllocatedBytes() const {
+    unsigned long long bytes = 0;
+    for (const Entry& entry : m_entries) {
+        bytes += estimateBytes(entry.desc);
+    }
+    return bytes;
+}
+
+unsigned long long RenderTargetPool::estimateBytes(const Desc& desc) {
+    return GpuMemory::estimateBytes(textureDesc(desc));
+}
+
+HRESULT RenderTargetPool::create(Device& device, const Desc& desc, Target& out) {
+    const D3D11_TEXTURE2D_DESC texture = textureDesc(desc);
+    const bool multisampled = texture.SampleDesc.Count > 1;
+    HRESULT hr = device.CreateTexture2D(&texture, nullptr, &out.texture);
+
+    if (SUCCEEDED(hr) && (desc.bindFlags & D3D11_BIND_RENDER_TARGET)) {
+        D3D11_RENDER_TARGET_VIEW_DESC rtvDesc = {};
+        rtvDesc.Format = viewFormat(desc.rtvFormat, desc.format);
+        rtvDesc.ViewDimension = multisampled ? D3D11_RTV_DIMENSION_TEXTURE2DMS : D3D11_RTV_DIMENSION_TEXTURE2D;
+        hr = device.CreateRenderTargetView(out.texture, &rtvDesc, &out.rtv);
+    }
+    if (SUCCEEDED(hr) && (desc.bindFlags & D3D11_BIND_DEPTH_STENCIL)) {
+        D3D11_DEPTH_STENCIL_VIEW_DESC dsvDesc = {};
+        dsvDesc.Format = viewFormat(desc.dsvFormat, desc.format);
+        dsvDesc.ViewDimension = multisampled ? D3D11_DSV_DIMENSION_TEXTURE2DMS : D3D11_DSV_DIMENSION_TEXTURE2D;
+        hr = device.CreateDepthStencilView(out.texture, &dsvDesc, &out.dsv);
+    }
+    if (SUCCEEDED(hr) && (desc.bindFlags & D3D11_BIND_SHADER_RESOURCE)) {
+        D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+        srvDesc.Format = viewFormat(desc.srvFormat, desc.format);
+        srvDesc.ViewDimension = multisampled ? D3D11_SRV_DIMENSION_TEXTURE2DMS : D3D11_SRV_DIMENSION_TEXTURE2D;
+        srvDesc.Texture2D.MipLevels = 1;
+        hr = device.CreateShaderResourceView(out.texture, &srvDesc, &out.srv);
+    }
+    if (SUCCEEDED(hr) && (desc.bindFlags & D3D11_BIND_UNORDERED_ACCESS)) {
+        D3D11_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
+        uavDesc.Format = viewFormat(desc.uavFormat, desc.format);
+        uavDesc.ViewDimension = D3D11_UAV_DIMENSION_TEXTURE2D;
+        hr = device.CreateUnorderedAccessView(out.texture, &uavDesc, &out.uav);
+    }
+
+    if (FAILED(hr)) {
+        destroyTarget(out);
+    }
+    return hr;
+}
+
+void RenderTargetPool::destroyTarget(Target& target) {
+    SAFE_RELEASE(target.uav);
+    SAFE_RELEASE(target.srv);
+    SAFE_RELEASE(target.dsv);
+    SAFE_RELEASE(target.rtv);
+    SAFE_RELEASE(target.texture);
+}
@@ -149,11 +149,11 @@ void RenderTargetView::render(DeviceContext& deviceContext,
     ID3D11RenderTargetView* rtv = m_renderTargetView;
     ID3D11DepthStencilView* dsv = depthStencilView.m_depthStencilView;
 
-    deviceContext.m_deviceContext->OMSetRenderTargets(numViews, &rtv, dsv);
-    deviceContext.m_deviceContext->ClearRenderTargetView(rtv, ClearColor);
+    deviceContext.OMSetRenderTargets(numViews, &rtv, dsv);
+    deviceContext.ClearRenderTargetView(rtv, ClearColor);
 
     if (dsv) {
-        deviceContext.m_deviceContext->ClearDepthStencilView(
+        deviceContext.ClearDepthStencilView(
             dsv, D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
     }
 }
@@ -178,7 +178,7 @@ void RenderTargetView::render(DeviceContext& deviceContext, unsigned int numView
     }
 
     ID3D11RenderTargetView* rtv = m_renderTargetView;
-    deviceContext.m_deviceContext->OMSetRenderTargets(numViews, &rtv, nullptr);
+    deviceContext.OMSetRenderTargets(numViews, &rtv, nullptr);
 }
 
 /**
@@ -0,0 +1,78 @@
+﻿/**
+ * @file RenderThread.cpp
+ * @brief Implementación del hilo de render.
+ */
+
+#include "RenderThread.h"
+#include "CpuProfiler.h"
+#include "CpuTopology.h"
+#include "FrameArena.h"
+
+HRESULT RenderThread::init(Function function, void* context) {
+    destroy();
+    if (!function) {
+        ERROR("RenderThread", "init", "function is nullptr");
+        return E_INVALIDARG;
+    }
+    m_function = function;
+    m_context = context;
+    m_pending = false;
+    m_stopping = false;
+    m_thread = std::thread(&RenderThread::loop, this);
+    MESSAGE("RenderThread", "init", "Render thread started");
+    return S_OK;
+}
+
+void RenderThread::destroy() {
+    if (!m_thread.joinable()) {
+        return;
+    }
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_kicked.notify_one();
+    m_thread.join();
+    m_function = nullptr;
+    m_context = nullptr;
+}
+
+void RenderThread::kick() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_pending) {
+            ERROR("RenderThread", "kick", "Previous frame still running; call wait first");
+            return;
+        }
+        m_pending = true;
+    }
+    m_kicked.notify_one();
+}
+
+void RenderThread::wait() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this]() { return !m_pending; });
+}
+
+void RenderThread::loop() {
+#if defined(PROFILE)
+    CpuProfiler::instance().setThreadName("Render");
+#endif
+    // En una CPU híbrida, un E-core alarga el frame entero: solo P-cores.
+    CpuTopology::getDefault().applyToCurrentThread(CpuTopology::THREAD_ROLE_RENDER);
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_kicked.wait(lock, [this]() { return m_pending || m_stopping; });
+        if (m_stopping) {
+            return;
+        }
+        lock.unlock();
+        // Lo transitorio del frame anterior de este hilo ya no se usa.
+        FrameArena::reset();
+        m_function(m_context);
+        lock.lock();
+        m_pending = false;
+        m_done.notify_all();
+    }
+}
@@ -0,0 +1,370 @@
+﻿/**
+ * @file ResourceManager.cpp
+ * @brief Nodos de carga, hilos de trabajo y publicación de futuros.
+ */
+
+#include "ResourceManager.h"
+#include "CpuTopology.h"
+#include "Device.h"
+#include "ModelLoader.h"
+#include "JobSystem.h"
+#include "MemoryTracker.h"
+
+namespace {
+    std::string lowerExtension(const std::string& path) {
+        const size_t dot = path.find_last_of('.');
+        const size_t slash = path.find_last_of("/\\");
+        if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+            return std::string();
+        }
+        std::string extension = path.substr(dot + 1);
+        for (char& c : extension) {
+            c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+        }
+        return extension;
+    }
+}
+
+HRESULT ResourceManager::init(Device& device, MeshLibrary& meshes, MaterialLibrary& materials,
+    AsyncTextureLoader& textures, unsigned int workerCount) {
+    destroy();
+    m_device = &device;
+    m_meshes = &meshes;
+    m_materials = &materials;
+    m_textures = &textures;
+    m_stopping = false;
+    workerCount = (std::min)(workerCount == 0 ? kMaxWorkers : workerCount, kMaxWorkers);
+    for (unsigned int i = 0; i < workerCount; ++i) {
+        m_workers.push_back(std::thread(&ResourceManager::workerLoop, this));
+    }
+    if (m_workers.empty()) {
+        ERROR("ResourceManager", "init", "No loader threads.");
+        return E_FAIL;
+    }
+    return S_OK;
+}
+
+ResourceManager::Node& ResourceManager::addNode() {
+    m_nodes.push_back(std::unique_ptr<Node>(new Node()));
+    Node& node = *m_nodes.back();
+    node.id = m_nextId++;
+    return node;
+}
+
+/**
+ * @details
+ * El `ModelLoader` es del nodo: el hilo lo rellena y el hilo principal lo lee al
+ * publicar, nunca a la vez. Al soltar el nodo se libera (y con él el FBX SDK).
+ */
+ResourceHandle<MeshAsset> ResourceManager::loadMesh(const std::string& path, MeshPublisher publisher) {
+    ResourceHandle<MeshAsset> future = EU::MakeShared<ResourceFuture<MeshAsset>>();
+    std::shared_ptr<ModelLoader> loader = std::make_shared<ModelLoader>();
+    if (!publisher) {
+        MeshLibrary* meshes = m_meshes;
+        Device* device = m_device;
+        publisher = [meshes, device, path](ModelLoader& imported) {
+            return meshes->adopt(*device, path, imported);
+        };
+    }
+
+    Node& node = addNode();
+    node.work = [loader, path]() {
+        const bool loaded = lowerExtension(path) == "obj"
+            ? loader->LoadCachedOBJModel(path) : loader->LoadCachedFBXModel(path);
+        return loaded && !loader->meshes.empty();
+    };
+    node.publish = [future, loader, path, publisher](bool succeeded) {
+        if (!succeeded) {
+            ERROR("ResourceManager", "loadMesh", ("Failed to load model: " + path).c_str());
+            future->publish(MeshHandle());
+            return;
+        }
+        const MeshHandle mesh = publisher(*loader);
+        if (mesh.isNull()) {
+            ERROR("ResourceManager", "loadMesh", ("Failed to create mesh buffers for " + path).c_str());
+        }
+        future->publish(mesh);
+    };
+    return future;
+}
+
+ResourceHandle<Texture> ResourceManager::loadTexture(const std::vector<AsyncTextureLoader::Source>& sources) {
+    ResourceHandle<Texture> future = EU::MakeShared<ResourceFuture<Texture>>();
+    const TextureHandle texture = m_textures->load(sources);
+    AsyncTextureLoader* textures = m_textures;
+
+    // Sin trabajo propio: el cargador de texturas ya lo hace en sus hilos.
+    Node& node = addNode();
+    node.dependencies.push_back([textures, texture]() {
+        bool loaded = false;
+        return textures->isSettled(texture, loaded);
+    });
+    node.publish = [future, texture](bool) {
+        // Si ninguna candidata se leyó, el handle se queda con el placeholder: se publica
+        // igualmente, como hacía `load` (el error ya está en el log del cargador).
+        future->publish(texture);
+    };
+    return future;
+}
+
+ResourceHandle<Material> ResourceManager::loadMaterial(const MaterialDesc& desc,
+    const ResourceHandle<Texture>& diffuse, ShaderPermutations* shaders, ShaderPermutations::Features features) {
+    ResourceHandle<Material> future = EU::MakeShared<ResourceFuture<Material>>();
+    MaterialLibrary* materials = m_materials;
+
+    // La variante de shader es un nodo propio: su VS/PS se compila a la caché de disco en
+    // un hilo, y `get` (al publicar el material) solo lee el bytecode.
+    std::shared_ptr<bool> shaderCompiled;
+    Node* shaderNode = nullptr;
+    if (shaders) {
+        const std::vector<ShaderKey> keys = shaders->getKeys(features);
+        shaderCompiled = std::make_shared<bool>(false);
+        Node& node = addNode();
+        node.work = [keys]() {
+            ShaderLibrary library;
+            bool compiled = true;
+            for (const ShaderKey& key : keys) {
+                std::string cachePath;
+                compiled = SUCCEEDED(library.cookToDisk(key, cachePath)) && compiled;
+            }
+            return compiled;
+        };
+        std::shared_ptr<bool> done = shaderCompiled;
+        node.publish = [done](bool) { *done = true; };
+        shaderNode = &node;
+    }
+
+    Node& node = addNode();
+    if (!diffuse.isNull()) {
+        node.dependencies.push_back([diffuse]() { return diffuse->isDone(); });
+    }
+    if (shaderNode) {
+        std::shared_ptr<bool> done = shaderCompiled;
+        node.dependencies.push_back([done]() { return *done; });
+    }
+    node.publish = [future, materials, desc, diffuse, shaders, features](bool) {
+        MaterialDesc resolved = desc;
+        resolved.diffuse = diffuse.isNull() ? TextureHandle() : diffuse->get();
+        // Si la variante no compila, `get` devuelve nulo y el material usa el programa de la cola.
+        resolved.shader = shaders ? shaders->get(features) : nullptr;
+        future->publish(materials->get(resolved));
+    };
+    return future;
+}
+
+template<>
+ResourceHandle<MeshAsset> ResourceManager::load<MeshAsset>(const std::string& path) {
+    return loadMesh(path);
+}
+
+template<>
+ResourceHandle<Texture> ResourceManager::load<Texture>(const std::string& path) {
+    static const char* const kExtensions[] = { "dds", "png", "jpg", "tga", "hdr" };
+    const std::string extension = lowerExtension(path);
+    for (int type = DDS; type <= HDR; ++type) {
+        if (extension == kExtensions[type]) {
+            return loadTexture({ { path.substr(0, path.size() - extension.size() - 1),
+                static_cast<ExtensionType>(type) } });
+        }
+    }
+    ERROR("ResourceManager", "load", ("Unknown texture extension: " + path).c_str());
+    ResourceHandle<Texture> future = EU::MakeShared<ResourceFuture<Texture>>();
+    future->publish(TextureHandle());
+    return future;
+}
+
+void ResourceManager::runOnLoader(std::function<bool()> work, std::function<void(bool)> done) {
+    Node& node = addNode();
+    node.work = std::move(work);
+    node.publish = std::move(done);
+}
+
+/**
+ * @details
+ * El trabajo guarda su propia referencia al estado: si la aplicación se cierra con el
+ * trabajo aún en cola, el nodo puede desaparecer antes que él.
+ */
+void ResourceManager::runOnJobs(std::function<bool()> work, std::function<void(bool)> done) {
+    struct State {
+        std::function<bool()> work;
+        std::atomic<bool> finished{ false };
+        bool succeeded = false;
+    };
+    std::shared_ptr<State> state = std::make_shared<State>();
+    state->work = std::move(work);
+
+    Node& node = addNode();
+    node.onJobs = true;
+    node.dependencies.push_back([state]() { return state->finished.load(std::memory_order_acquire); });
+    node.publish = [state, done](bool) { done(state->succeeded); };
+
+    struct Runner {
+        static void call(Job&, const void* data) {
+            std::unique_ptr<std::shared_ptr<State>> owner(*static_cast<std::shared_ptr<State>* const*>(data));
+            State& state = **owner;
+            state.succeeded = state.work();
+            state.work = nullptr;
+            state.finished.store(true, std::memory_order_release);
+        }
+    };
+    std::shared_ptr<State>* owner = new std::shared_ptr<State>(state);
+    JobSystem& jobs = JobSystem::getDefault();
+    // Sin workers el trabajo se quedaría en la cola del hilo principal hasta el siguiente `wait`.
+    Job* job = jobs.getThreadCount() > 1 ? jobs.createJob(&Runner::call, &owner, sizeof(owner)) : nullptr;
+    if (job) {
+        jobs.run(job);
+    }
+    else {
+        Job local;
+        Runner::call(local, &owner);
+    }
+}
+
+void ResourceManager::post(std::function<void()> callback) {
+    Node& node = addNode();
+    node.nextUpdate = true;
+    node.publish = [callback](bool) { callback(); };
+}
+
+/**
+ * @details
+ * Se repite hasta que una vuelta no publica nada: un material cuya textura se publicó
+ * en esta misma llamada sale también en este frame, no en el siguiente.
+ */
+unsigned int ResourceManager::update() {
+    std::vector<std::pair<unsigned long long, bool>> finished;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        finished.swap(m_results);
+    }
+    for (const auto& result : finished) {
+        for (const std::unique_ptr<Node>& node : m_nodes) {
+            if (node->id == result.first) {
+                node->worked = true;
+                node->succeeded = result.second;
+                break;
+            }
+        }
+    }
+
+    // Lo que `post` pida durante esta llamada espera a la siguiente (si no, una corrutina
+    // que cede el frame en bucle no dejaría salir de aquí).
+    const unsigned long long firstNew = m_nextId;
+    unsigned int published = 0;
+    bool progress = true;
+    while (progress) {
+        progress = false;
+        for (size_t i = 0; i < m_nodes.size(); ++i) {
+            Node& node = *m_nodes[i];
+            if (node.nextUpdate && node.id >= firstNew) {
+                continue;
+            }
+            if (!node.queued) {
+                bool ready = true;
+                for (const std::function<bool()>& dependency : node.dependencies) {
+                    ready = ready && dependency();
+                }
+                if (!ready) {
+                    continue;
+                }
+                node.queued = true;
+                if (node.work) {
+                    {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        Task task = { node.id, node.work };
+                        m_queue.push_back(task);
+                    }
+                    m_wake.notify_one();
+                    continue;
+                }
+                node.worked = true;
+            }
+            if (node.worked) {
+                // Se saca de la lista antes de publicar: las continuaciones pueden pedir más cargas.
+                std::unique_ptr<Node> done = std::move(m_nodes[i]);
+                m_nodes.erase(m_nodes.begin() + i);
+                --i;
+                done->publish(done->succeeded);
+                ++published;
+                progress = true;
+            }
+        }
+    }
+    return published;
+}
+
+void ResourceManager::waitIdle() {
+    while (!m_nodes.empty()) {
+        m_textures->waitIdle();
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_idle.wait(lock, [this] { return m_queue.empty() && m_busy == 0; });
+        }
+        const size_t before = m_nodes.size();
+        update();
+        if (m_nodes.size() == before && m_textures->getPendingCount() == 0) {
+            bool running = false;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                running = !m_queue.empty() || m_busy > 0;
+            }
+            for (const std::unique_ptr<Node>& node : m_nodes) {
+                running = running || node->onJobs || node->nextUpdate;
+            }
+            if (!running) {
+                ERROR("ResourceManager", "waitIdle", "Loads waiting on dependencies that never finish.");
+                return;
+            }
+            std::this_thread::yield();
+        }
+    }
+}
+
+void ResourceManager::workerLoop() {
+    MEMORY_SCOPE(MEMORY_TAG_LOADER);
+    CpuTopology::getDefault().applyToCurrentThread(CpuTopology::THREAD_ROLE_BACKGROUND);
+    for (;;) {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this] { return m_stopping || !m_queue.empty(); });
+            if (m_stopping) {
+                return;
+            }
+            task = m_queue.front();
+            m_queue.pop_front();
+            ++m_busy;
+        }
+
+        const bool succeeded = task.work();
+        // Se suelta aquí: lo que capture (p. ej. el `ModelLoader`) se libera en el hilo principal.
+        task.work = nullptr;
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_results.push_back(std::make_pair(task.id, succeeded));
+            --m_busy;
+        }
+        m_idle.notify_all();
+    }
+}
+
+void ResourceManager::destroy() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+        m_queue.clear();
+    }
+    m_wake.notify_all();
+    for (std::thread& worker : m_workers) {
+        worker.join();
+    }
+    m_workers.clear();
+    m_results.clear();
+    // Los futuros pendientes se quedan pendientes; sus continuaciones no se llaman.
+    m_nodes.clear();
+    m_device = nullptr;
+    m_meshes = nullptr;
+    m_materials = nullptr;
+    m_textures = nullptr;
+}
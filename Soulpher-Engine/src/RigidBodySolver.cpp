@@ -0,0 +1,473 @@
+﻿/**
+ * @file RigidBodySolver.cpp
+ * @brief Implementación del solver de impulsos secuenciales por islas.
+ *
+ * @details
+ * Dentro de una isla, dos contactos que comparten un cuerpo dinámico escriben su
+ * velocidad, así que no pueden resolverse a la vez; entre islas distintas no comparten
+ * ninguno. Los cuerpos estáticos sí se comparten, pero su masa inversa es 0 y nunca se
+ * escribe su velocidad: por eso no unen islas ni cuentan al colorear.
+ */
+
+#include "RigidBodySolver.h"
+#include "JobSystem.h"
+#include "ECS/Actor.h"
+#include "ECS/Transform.h"
+#include "ECS/TransformHierarchy.h"
+#include "ECS/World.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace {
+    /// Componente `axis` (0 = X, 1 = Y, 2 = Z) de un vector.
+    inline float& axisOf(XMFLOAT3& v, unsigned int axis) { return (&v.x)[axis]; }
+    inline float axisOf(const XMFLOAT3& v, unsigned int axis) { return (&v.x)[axis]; }
+}
+
+RigidBody RigidBodySolver::makeBody(float mass, const EU::Vector3& halfExtents, float friction) {
+    RigidBody body;
+    body.velocity = EU::Vector3(0.0f, 0.0f, 0.0f);
+    body.halfExtents = halfExtents;
+    body.inverseMass = mass > 0.0f ? 1.0f / mass : 0.0f;
+    body.friction = friction;
+    body.sleepTimer = 0.0f;
+    body.proxy = Broadphase::kInvalidBody;
+    body.sleeping = false;
+    return body;
+}
+
+bool RigidBodySolver::attach(Actor& actor, float mass, float friction) {
+    Transform* transform = actor.getComponent<Transform>();
+    XMFLOAT3 boundsMin, boundsMax;
+    if (!transform || !actor.getSimulationBounds(boundsMin, boundsMax)) {
+        return false;
+    }
+    const EU::Vector3 halfExtents((boundsMax.x - boundsMin.x) * 0.5f,
+        (boundsMax.y - boundsMin.y) * 0.5f,
+        (boundsMax.z - boundsMin.z) * 0.5f);
+    return World::getDefault().add(transform->getEntity(), makeBody(mass, halfExtents, friction)) != nullptr;
+}
+
+void RigidBodySolver::clear() {
+    m_position.clear();
+    m_velocity.clear();
+    m_halfExtents.clear();
+    m_inverseMass.clear();
+    m_friction.clear();
+    m_sleepTimer.clear();
+    m_sleeping.clear();
+    m_sleepingCount = 0;
+    m_broadphase.clear();
+    m_pairs.clear();
+    m_proxyBody.clear();
+    m_proxyAlive.clear();
+    m_contacts.clear();
+    m_order.clear();
+    m_islands.clear();
+    m_smallIslands.clear();
+    m_cache[0].Clear();
+    m_cache[1].Clear();
+    m_cacheIndex = 0;
+}
+
+uint32_t RigidBodySolver::findRoot(uint32_t body) {
+    uint32_t root = body;
+    while (m_parent[root] != root) {
+        root = m_parent[root];
+    }
+    while (m_parent[body] != root) {
+        const uint32_t next = m_parent[body];
+        m_parent[body] = root;
+        body = next;
+    }
+    return root;
+}
+
+void RigidBodySolver::step(World& world, float deltaTime, bool parallel) {
+    if (deltaTime <= 0.0f) {
+        return;
+    }
+    m_invDeltaTime = 1.0f / deltaTime;
+
+    // 1) Recogida: cuerpos raíz (los hijos siguen a su padre) en el orden de los chunks.
+    m_position.clear();
+    m_velocity.clear();
+    m_halfExtents.clear();
+    m_inverseMass.clear();
+    m_friction.clear();
+    m_sleepTimer.clear();
+    m_sleeping.clear();
+    std::fill(m_proxyBody.begin(), m_proxyBody.end(), kNone);
+    world.forEachChunkWithout<Parent, LocalTransform, RigidBody>(
+        [this](unsigned int count, const EntityID*, LocalTransform* locals, RigidBody* bodies) {
+            for (unsigned int i = 0; i < count; ++i) {
+                RigidBody& rb = bodies[i];
+                const uint32_t index = static_cast<uint32_t>(m_position.size());
+                const XMFLOAT3 position(locals[i].position.x, locals[i].position.y, locals[i].position.z);
+                const XMFLOAT3 half(rb.halfExtents.x, rb.halfExtents.y, rb.halfExtents.z);
+                m_position.push_back(position);
+                m_velocity.push_back(XMFLOAT3(rb.velocity.x, rb.velocity.y, rb.velocity.z));
+                m_halfExtents.push_back(half);
+                m_inverseMass.push_back(rb.inverseMass);
+                m_friction.push_back(rb.friction);
+                m_sleepTimer.push_back(rb.sleepTimer);
+                m_sleeping.push_back(rb.sleeping && rb.inverseMass > 0.0f ? 1 : 0);
+
+                // Un poco de margen para que los contactos en reposo sigan saliendo.
+                const XMFLOAT3 boundsMin(position.x - half.x - kSlop, position.y - half.y - kSlop, position.z - half.z - kSlop);
+                const XMFLOAT3 boundsMax(position.x + half.x + kSlop, position.y + half.y + kSlop, position.z + half.z + kSlop);
+                uint32_t proxy = rb.proxy;
+                // Proxy nuevo si no tiene, si se perdió o si otro cuerpo ya lo reclamó
+                // (un componente copiado de otra entidad).
+                if (proxy >= m_proxyBody.size() || !m_proxyAlive[proxy] || m_proxyBody[proxy] != kNone) {
+                    proxy = m_broadphase.add(boundsMin, boundsMax, index);
+                    if (proxy >= m_proxyBody.size()) {
+                        m_proxyBody.resize(proxy + 1, kNone);
+                        m_proxyAlive.resize(proxy + 1, 0);
+                    }
+                    m_proxyAlive[proxy] = 1;
+                    rb.proxy = proxy;
+                }
+                else {
+                    m_broadphase.setBounds(proxy, boundsMin, boundsMax);
+                }
+                m_proxyBody[proxy] = index;
+            }
+        });
+    // Proxies de cuerpos que ya no existen.
+    for (uint32_t proxy = 0; proxy < m_proxyBody.size(); ++proxy) {
+        if (m_proxyAlive[proxy] && m_proxyBody[proxy] == kNone) {
+            m_broadphase.remove(proxy);
+            m_proxyAlive[proxy] = 0;
+        }
+    }
+    const uint32_t bodyCount = static_cast<uint32_t>(m_position.size());
+
+    // 2) Gravedad y fase amplia.
+    for (uint32_t i = 0; i < bodyCount; ++i) {
+        if (m_inverseMass[i] > 0.0f && !m_sleeping[i]) {
+            m_velocity[i].x += m_gravity.x * deltaTime;
+            m_velocity[i].y += m_gravity.y * deltaTime;
+            m_velocity[i].z += m_gravity.z * deltaTime;
+        }
+    }
+    m_broadphase.findPairs(m_pairs, parallel);
+
+    // 3) Contactos caja contra caja, con los impulsos del paso anterior.
+    m_contacts.clear();
+    const EU::TMap<uint64_t, WarmStart>& previous = m_cache[m_cacheIndex];
+    for (const Broadphase::Pair& pair : m_pairs) {
+        const uint32_t a = m_proxyBody[pair.a];
+        const uint32_t b = m_proxyBody[pair.b];
+        if (a == kNone || b == kNone || (m_inverseMass[a] == 0.0f && m_inverseMass[b] == 0.0f)) {
+            continue;
+        }
+        float depth = FLT_MAX;
+        float offset = 0.0f;
+        unsigned int axis = 0;
+        bool touching = true;
+        for (unsigned int k = 0; k < 3 && touching; ++k) {
+            const float d = axisOf(m_position[b], k) - axisOf(m_position[a], k);
+            const float overlap = axisOf(m_halfExtents[a], k) + axisOf(m_halfExtents[b], k) - std::fabs(d);
+            touching = overlap > 0.0f;
+            if (overlap < depth) {
+                depth = overlap;
+                offset = d;
+                axis = k;
+            }
+        }
+        if (!touching) {
+            continue;
+        }
+        Contact contact;
+        contact.a = a;
+        contact.b = b;
+        contact.key = (static_cast<uint64_t>(pair.a) << 32) | pair.b;
+        contact.axis = static_cast<uint8_t>(axis);
+        contact.sign = offset >= 0.0f ? 1.0f : -1.0f;
+        contact.bias = kBaumgarte * m_invDeltaTime * (std::max)(depth - kSlop, 0.0f);
+        contact.mass = 1.0f / (m_inverseMass[a] + m_inverseMass[b]);
+        contact.friction = std::sqrt(m_friction[a] * m_friction[b]);
+        contact.normalImpulse = 0.0f;
+        contact.tangentImpulse[0] = 0.0f;
+        contact.tangentImpulse[1] = 0.0f;
+        // Solo si la normal no cambió: otro eje es otro contacto.
+        const WarmStart* cached = previous.Find(contact.key);
+        if (cached && cached->axis == contact.axis && cached->sign == contact.sign) {
+            contact.normalImpulse = cached->normalImpulse;
+            contact.tangentImpulse[0] = cached->tangentImpulse[0];
+            contact.tangentImpulse[1] = cached->tangentImpulse[1];
+        }
+        m_contacts.push_back(contact);
+    }
+
+    // 4) Islas: union-find sobre los contactos entre cuerpos dinámicos.
+    m_parent.resize(bodyCount);
+    for (uint32_t i = 0; i < bodyCount; ++i) {
+        m_parent[i] = i;
+    }
+    for (const Contact& contact : m_contacts) {
+        if (m_inverseMass[contact.a] > 0.0f && m_inverseMass[contact.b] > 0.0f) {
+            const uint32_t rootA = findRoot(contact.a);
+            const uint32_t rootB = findRoot(contact.b);
+            if (rootA != rootB) {
+                // La raíz menor gana: el resultado no depende del orden de los pares.
+                m_parent[(std::max)(rootA, rootB)] = (std::min)(rootA, rootB);
+            }
+        }
+    }
+    // Una isla con algún cuerpo despierto (o recién tocado) se despierta entera.
+    m_rootAwake.assign(bodyCount, 0);
+    for (uint32_t i = 0; i < bodyCount; ++i) {
+        if (m_inverseMass[i] > 0.0f && !m_sleeping[i]) {
+            m_rootAwake[findRoot(i)] = 1;
+        }
+    }
+    for (uint32_t i = 0; i < bodyCount; ++i) {
+        if (m_sleeping[i] && m_rootAwake[findRoot(i)]) {
+            m_sleeping[i] = 0;
+            m_sleepTimer[i] = 0.0f;
+        }
+    }
+
+    // Contactos de las islas despiertas, agrupados por isla (orden por conteo).
+    m_islandOf.assign(bodyCount, kNone);
+    m_islands.clear();
+    std::vector<uint32_t>& contactIsland = m_scratch;
+    contactIsland.resize(m_contacts.size());
+    for (size_t c = 0; c < m_contacts.size(); ++c) {
+        const Contact& contact = m_contacts[c];
+        const uint32_t root = findRoot(m_inverseMass[contact.a] > 0.0f ? contact.a : contact.b);
+        if (!m_rootAwake[root]) {
+            contactIsland[c] = kNone;
+            continue;
+        }
+        if (m_islandOf[root] == kNone) {
+            m_islandOf[root] = static_cast<uint32_t>(m_islands.size());
+            m_islands.push_back(Island{ 0, 0 });
+        }
+        contactIsland[c] = m_islandOf[root];
+        ++m_islands[contactIsland[c]].count;
+    }
+    uint32_t solved = 0;
+    for (Island& island : m_islands) {
+        island.first = solved;
+        solved += island.count;
+        island.count = 0;
+    }
+    m_order.resize(solved);
+    for (size_t c = 0; c < m_contacts.size(); ++c) {
+        if (contactIsland[c] != kNone) {
+            Island& island = m_islands[contactIsland[c]];
+            m_order[island.first + island.count++] = static_cast<uint32_t>(c);
+        }
+    }
+
+    // 5) Impulsos: islas pequeñas enteras por hilo; las grandes, de una en una por colores.
+    m_smallIslands.clear();
+    for (uint32_t i = 0; i < m_islands.size(); ++i) {
+        if (m_islands[i].count < kLargeIsland) {
+            m_smallIslands.push_back(i);
+        }
+    }
+    auto solveSmall = [this](unsigned int begin, unsigned int end) {
+        for (unsigned int i = begin; i < end; ++i) {
+            solveIsland(m_islands[m_smallIslands[i]]);
+        }
+    };
+    if (parallel) {
+        JobSystem::getDefault().parallelFor(static_cast<unsigned int>(m_smallIslands.size()), solveSmall, 1);
+    }
+    else {
+        solveSmall(0, static_cast<unsigned int>(m_smallIslands.size()));
+    }
+    for (const Island& island : m_islands) {
+        if (island.count >= kLargeIsland) {
+            solveColored(island, parallel);
+        }
+    }
+
+    // Impulsos para el siguiente paso (los de islas dormidas se conservan tal cual).
+    EU::TMap<uint64_t, WarmStart>& current = m_cache[1 - m_cacheIndex];
+    current.Clear();
+    current.Reserve(m_contacts.size());
+    for (const Contact& contact : m_contacts) {
+        WarmStart& warm = current[contact.key];
+        warm.axis = contact.axis;
+        warm.sign = contact.sign;
+        warm.normalImpulse = contact.normalImpulse;
+        warm.tangentImpulse[0] = contact.tangentImpulse[0];
+        warm.tangentImpulse[1] = contact.tangentImpulse[1];
+    }
+    m_cacheIndex = 1 - m_cacheIndex;
+
+    // 6) Integración y reposo por islas enteras.
+    m_rootTimer.assign(bodyCount, FLT_MAX);
+    for (uint32_t i = 0; i < bodyCount; ++i) {
+        if (m_inverseMass[i] == 0.0f || m_sleeping[i]) {
+            continue;
+        }
+        XMFLOAT3& v = m_velocity[i];
+        m_position[i].x += v.x * deltaTime;
+        m_position[i].y += v.y * deltaTime;
+        m_position[i].z += v.z * deltaTime;
+        const float speedSq = v.x * v.x + v.y * v.y + v.z * v.z;
+        m_sleepTimer[i] = speedSq < kSleepSpeed * kSleepSpeed ? m_sleepTimer[i] + deltaTime : 0.0f;
+        float& timer = m_rootTimer[findRoot(i)];
+        timer = (std::min)(timer, m_sleepTimer[i]);
+    }
+    m_sleepingCount = 0;
+    for (uint32_t i = 0; i < bodyCount; ++i) {
+        if (m_inverseMass[i] == 0.0f) {
+            continue;
+        }
+        if (!m_sleeping[i] && m_rootTimer[findRoot(i)] >= kTimeToSleep) {
+            m_sleeping[i] = 1;
+            m_velocity[i] = XMFLOAT3(0.0f, 0.0f, 0.0f);
+        }
+        m_sleepingCount += m_sleeping[i];
+    }
+
+    // 7) Escritura en los mismos chunks y en el mismo orden que la recogida.
+    uint32_t index = 0;
+    world.forEachChunkWithout<Parent, LocalTransform, RigidBody>(
+        [this, &index](unsigned int count, const EntityID*, LocalTransform* locals, RigidBody* bodies) {
+            for (unsigned int i = 0; i < count; ++i, ++index) {
+                RigidBody& rb = bodies[i];
+                LocalTransform& local = locals[i];
+                const XMFLOAT3& p = m_position[index];
+                if (local.position.x != p.x || local.position.y != p.y || local.position.z != p.z) {
+                    local.position = EU::Vector3(p.x, p.y, p.z);
+                    local.dirty = true;
+                }
+                const XMFLOAT3& v = m_velocity[index];
+                rb.velocity = EU::Vector3(v.x, v.y, v.z);
+                rb.sleepTimer = m_sleepTimer[index];
+                rb.sleeping = m_sleeping[index] != 0;
+            }
+        });
+}
+
+void RigidBodySolver::warmStart(const Contact& contact) {
+    const float invA = m_inverseMass[contact.a];
+    const float invB = m_inverseMass[contact.b];
+    XMFLOAT3 impulse(0.0f, 0.0f, 0.0f);
+    axisOf(impulse, contact.axis) = contact.sign * contact.normalImpulse;
+    axisOf(impulse, (contact.axis + 1) % 3) = contact.tangentImpulse[0];
+    axisOf(impulse, (contact.axis + 2) % 3) = contact.tangentImpulse[1];
+    // Los estáticos no se escriben: los comparten islas que se resuelven a la vez.
+    if (invA > 0.0f) {
+        XMFLOAT3& v = m_velocity[contact.a];
+        v.x -= impulse.x * invA;
+        v.y -= impulse.y * invA;
+        v.z -= impulse.z * invA;
+    }
+    if (invB > 0.0f) {
+        XMFLOAT3& v = m_velocity[contact.b];
+        v.x += impulse.x * invB;
+        v.y += impulse.y * invB;
+        v.z += impulse.z * invB;
+    }
+}
+
+void RigidBodySolver::solveContact(Contact& contact) {
+    XMFLOAT3& va = m_velocity[contact.a];
+    XMFLOAT3& vb = m_velocity[contact.b];
+    const float invA = m_inverseMass[contact.a];
+    const float invB = m_inverseMass[contact.b];
+
+    // Normal: la velocidad de separación debe llegar al menos a `bias`.
+    const unsigned int n = contact.axis;
+    const float vn = (axisOf(vb, n) - axisOf(va, n)) * contact.sign;
+    const float normalTotal = (std::max)(contact.normalImpulse + (contact.bias - vn) * contact.mass, 0.0f);
+    const float normal = (normalTotal - contact.normalImpulse) * contact.sign;
+    contact.normalImpulse = normalTotal;
+    if (invA > 0.0f) { axisOf(va, n) -= normal * invA; }
+    if (invB > 0.0f) { axisOf(vb, n) += normal * invB; }
+
+    // Fricción en las dos tangentes, dentro del cono de Coulomb.
+    const float limit = contact.friction * contact.normalImpulse;
+    for (unsigned int k = 0; k < 2; ++k) {
+        const unsigned int t = (n + 1 + k) % 3;
+        const float vt = axisOf(vb, t) - axisOf(va, t);
+        const float total = (std::max)(-limit, (std::min)(contact.tangentImpulse[k] - vt * contact.mass, limit));
+        const float tangent = total - contact.tangentImpulse[k];
+        contact.tangentImpulse[k] = total;
+        if (invA > 0.0f) { axisOf(va, t) -= tangent * invA; }
+        if (invB > 0.0f) { axisOf(vb, t) += tangent * invB; }
+    }
+}
+
+void RigidBodySolver::solveIsland(const Island& island) {
+    const uint32_t* order = m_order.data() + island.first;
+    for (uint32_t i = 0; i < island.count; ++i) {
+        warmStart(m_contacts[order[i]]);
+    }
+    for (unsigned int iteration = 0; iteration < kIterations; ++iteration) {
+        for (uint32_t i = 0; i < island.count; ++i) {
+            solveContact(m_contacts[order[i]]);
+        }
+    }
+}
+
+void RigidBodySolver::solveColored(const Island& island, bool parallel) {
+    uint32_t* order = m_order.data() + island.first;
+
+    // Coloreado voraz: el primer color que no use ninguno de sus cuerpos dinámicos.
+    m_colorMask.resize(m_position.size());
+    for (uint32_t i = 0; i < island.count; ++i) {
+        const Contact& contact = m_contacts[order[i]];
+        m_colorMask[contact.a] = 0;
+        m_colorMask[contact.b] = 0;
+    }
+    m_contactColor.resize(island.count);
+    m_colorStart.assign(kMaxColors + 2, 0);
+    for (uint32_t i = 0; i < island.count; ++i) {
+        const Contact& contact = m_contacts[order[i]];
+        const bool dynamicA = m_inverseMass[contact.a] > 0.0f;
+        const bool dynamicB = m_inverseMass[contact.b] > 0.0f;
+        const uint32_t used = (dynamicA ? m_colorMask[contact.a] : 0) | (dynamicB ? m_colorMask[contact.b] : 0);
+        unsigned int color = 0;
+        while (color < kMaxColors && (used & (1u << color)) != 0) {
+            ++color;
+        }
+        if (color < kMaxColors) {
+            if (dynamicA) { m_colorMask[contact.a] |= 1u << color; }
+            if (dynamicB) { m_colorMask[contact.b] |= 1u << color; }
+        }
+        m_contactColor[i] = static_cast<uint8_t>(color);
+        ++m_colorStart[color + 1];
+    }
+    for (unsigned int color = 0; color <= kMaxColors; ++color) {
+        m_colorStart[color + 1] += m_colorStart[color];
+    }
+    // Reordena la isla por colores (el último grupo, `kMaxColors`, va en serie).
+    m_scratch.resize(island.count);
+    std::vector<uint32_t> cursor(m_colorStart.begin(), m_colorStart.end() - 1);
+    for (uint32_t i = 0; i < island.count; ++i) {
+        m_scratch[cursor[m_contactColor[i]]++] = order[i];
+    }
+    std::copy(m_scratch.begin(), m_scratch.end(), order);
+
+    for (uint32_t i = 0; i < island.count; ++i) {
+        warmStart(m_contacts[order[i]]);
+    }
+    for (unsigned int iteration = 0; iteration < kIterations; ++iteration) {
+        for (unsigned int color = 0; color <= kMaxColors; ++color) {
+            const uint32_t first = m_colorStart[color];
+            const uint32_t count = m_colorStart[color + 1] - first;
+            auto solveRange = [this, order, first](unsigned int begin, unsigned int end) {
+                for (unsigned int i = begin; i < end; ++i) {
+                    solveContact(m_contacts[order[first + i]]);
+                }
+            };
+            if (parallel && color < kMaxColors) {
+                JobSystem::getDefault().parallelFor(count, solveRange, kColorBatch);
+            }
+            else {
+                solveRange(0, count);
+            }
+        }
+    }
+}
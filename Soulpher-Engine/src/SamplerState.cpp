@@ -51,7 +51,7 @@ HRESULT SamplerState::init(Device& device) {
     sampDesc.MinLOD = 0;
     sampDesc.MaxLOD = D3D11_FLOAT32_MAX;
 
-    HRESULT hr = device.CreateSamplerState(&sampDesc, &m_sampler);
+    HRESULT hr = device.CreateSharedSamplerState(&sampDesc, &m_sampler);
     if (FAILED(hr)) {
         ERROR("SamplerState", "init", "Failed to create SamplerState");
         return hr;
@@ -60,6 +60,45 @@ HRESULT SamplerState::init(Device& device) {
     return S_OK;
 }
 
+/**
+ * @brief Inicializa el sampler de comparacin del shadow map.
+ *
+ * @param device  Referencia al dispositivo Direct3D 11.
+ * @return HRESULT Devuelve `S_OK` si se crea correctamente, o un cdigo de error si falla.
+ *
+ * @details
+ *  - Filtro `COMPARISON_MIN_MAG_LINEAR_MIP_POINT`: PCF bilineal por hardware.
+ *  - Comparacin `LESS_EQUAL`: 1 si la referencia est delante del texel (iluminado).
+ *  - Direccin `BORDER` con borde 1.0: lo que cae fuera del mapa no recibe sombra.
+ */
+HRESULT SamplerState::initComparison(Device& device) {
+    if (!device.m_device) {
+        ERROR("SamplerState", "initComparison", "Device is nullptr");
+        return E_POINTER;
+    }
+
+    D3D11_SAMPLER_DESC sampDesc = {};
+    sampDesc.Filter = D3D11_FILTER_COMPARISON_MIN_MAG_LINEAR_MIP_POINT;
+    sampDesc.AddressU = D3D11_TEXTURE_ADDRESS_BORDER;
+    sampDesc.AddressV = D3D11_TEXTURE_ADDRESS_BORDER;
+    sampDesc.AddressW = D3D11_TEXTURE_ADDRESS_BORDER;
+    sampDesc.ComparisonFunc = D3D11_COMPARISON_LESS_EQUAL;
+    sampDesc.BorderColor[0] = 1.0f;
+    sampDesc.BorderColor[1] = 1.0f;
+    sampDesc.BorderColor[2] = 1.0f;
+    sampDesc.BorderColor[3] = 1.0f;
+    sampDesc.MinLOD = 0;
+    sampDesc.MaxLOD = D3D11_FLOAT32_MAX;
+
+    HRESULT hr = device.CreateSharedSamplerState(&sampDesc, &m_sampler);
+    if (FAILED(hr)) {
+        ERROR("SamplerState", "initComparison", "Failed to create comparison SamplerState");
+        return hr;
+    }
+
+    return S_OK;
+}
+
 /**
  * @brief Actualiza el estado de muestreo.
  *
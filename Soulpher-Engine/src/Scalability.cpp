@@ -0,0 +1,392 @@
+﻿/**
+ * @file Scalability.cpp
+ * @brief Implementación del benchmark de arranque, de los niveles y de su archivo.
+ */
+
+#include "Scalability.h"
+#include "ConsoleVariable.h"
+#include "Device.h"
+#include "DeviceContext.h"
+#include "JobSystem.h"
+#include "ShaderLibrary.h"
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+const char* const Scalability::kDefaultPath = "Scalability.cfg";
+const double Scalability::kCpuMilliseconds = 30.0;
+
+/**
+ * @details Valores de referencia: una integrada reciente da unos 5-10 Gpíxeles/s y
+ * 500-1500 Mvértices/s; una gama media de escritorio, del orden de 40 y 4000. La de CPU
+ * sube con los núcleos (un trabajo son unos microsegundos de cálculo).
+ */
+const float Scalability::kThresholds[METRIC_COUNT][SCALABILITY_TIER_COUNT - 1] = {
+    { 4.0f, 15.0f, 50.0f },         // Gpíxeles/s
+    { 400.0f, 1200.0f, 4000.0f },   // Mvértices/s
+    { 300.0f, 800.0f, 2000.0f },    // trabajos/ms
+};
+
+namespace {
+    const unsigned int kFormatVersion = 1;
+    /// Iteraciones de cálculo de cada trabajo de la prueba de CPU.
+    const unsigned int kJobIterations = 2048;
+
+    const Scalability::Settings kTiers[SCALABILITY_TIER_COUNT] = {
+        //  sombras  escala  TAA    MSAA  LOD    texturas
+        {   512,     0.6f,   false, 1,    0.5f,  256 },     // Low
+        {   1024,    0.75f,  true,  1,    0.75f, 512 },     // Medium
+        {   2048,    1.0f,   true,  1,    1.0f,  1024 },    // High
+        {   4096,    1.0f,   true,  1,    1.0f,  0 },       // Epic
+    };
+
+    LONGLONG now() {
+        LARGE_INTEGER counter;
+        QueryPerformanceCounter(&counter);
+        return counter.QuadPart;
+    }
+
+    double ticksToMs() {
+        LARGE_INTEGER frequency;
+        QueryPerformanceFrequency(&frequency);
+        return 1000.0 / static_cast<double>(frequency.QuadPart);
+    }
+
+    /// Trabajo de la prueba de CPU: un poco de coma flotante que el compilador no puede quitar.
+    void benchmarkJob(Job&, const void* data) {
+        std::atomic<unsigned int>* sink = *static_cast<std::atomic<unsigned int>* const*>(data);
+        float x = 1.0f;
+        for (unsigned int i = 0; i < kJobIterations; ++i) {
+            x = std::sqrt(x * 1.0001f + static_cast<float>(i & 7));
+        }
+        sink->fetch_add(static_cast<unsigned int>(x), std::memory_order_relaxed);
+    }
+
+    void noJob(Job&, const void*) {}
+
+    /// Cambia `variable` a `value` si sigue en su valor por defecto; `true` si cambió.
+    template<typename T>
+    bool applyDefault(const char* name, T value) {
+        TConsoleVariable<T>* variable = ConsoleVariables::getDefault().find<T>(name);
+        if (!variable || variable->isModified() || variable->get() == value) {
+            return false;
+        }
+        variable->set(value);
+        return true;
+    }
+}
+
+const Scalability::Settings& Scalability::getSettings(ScalabilityTier tier) {
+    return kTiers[(std::min)(static_cast<unsigned int>(tier), static_cast<unsigned int>(SCALABILITY_TIER_COUNT) - 1)];
+}
+
+const char* Scalability::getTierName(ScalabilityTier tier) {
+    switch (tier) {
+    case SCALABILITY_LOW:    return "Low";
+    case SCALABILITY_MEDIUM: return "Medium";
+    case SCALABILITY_HIGH:   return "High";
+    case SCALABILITY_EPIC:   return "Epic";
+    default:                 return "Unknown";
+    }
+}
+
+ScalabilityTier Scalability::selectTier(const float metrics[METRIC_COUNT]) {
+    int tier = SCALABILITY_EPIC;
+    for (unsigned int m = 0; m < METRIC_COUNT; ++m) {
+        int reached = SCALABILITY_LOW;
+        while (reached < SCALABILITY_EPIC && metrics[m] >= kThresholds[m][reached]) {
+            ++reached;
+        }
+        tier = (std::min)(tier, reached);
+    }
+    return static_cast<ScalabilityTier>(tier);
+}
+
+/**
+ * @details Las cvars se buscan por nombre: las declara `BaseApp.cpp` y al llamar aquí ya
+ * traen Engine.cfg, `-config` y `-cvar`. Un valor igual al de defecto puesto a mano no
+ * se distingue del de defecto; para fijarlo hay que usar `r.scalability`.
+ */
+unsigned int Scalability::apply(ScalabilityTier tier) {
+    const Settings& settings = getSettings(tier);
+    unsigned int changed = 0;
+    changed += applyDefault<int>("r.shadowMapSize", static_cast<int>(settings.shadowMapSize));
+    changed += applyDefault<float>("r.renderScale", settings.renderScale);
+    changed += applyDefault<bool>("r.taa", settings.taa);
+    changed += applyDefault<int>("r.msaa", settings.msaa);
+    changed += applyDefault<float>("r.lodBias", settings.lodBias);
+    changed += applyDefault<int>("r.textureBudgetMB", settings.textureBudgetMB);
+    return changed;
+}
+
+HRESULT Scalability::detect(Device& device, DeviceContext& deviceContext, Result& result,
+    const std::string& path) {
+    result = Result();
+    result.adapterKey = getAdapterKey(device);
+    Result saved;
+    if (!result.adapterKey.empty() && SUCCEEDED(load(path, saved)) && saved.adapterKey == result.adapterKey) {
+        result = saved;
+        return S_OK;
+    }
+
+    const double toMs = ticksToMs();
+    const LONGLONG start = now();
+    HRESULT hr = measureGpu(device, deviceContext, result);
+    if (FAILED(hr)) {
+        result.tier = SCALABILITY_HIGH;
+        return hr;
+    }
+    result.metrics[METRIC_JOBS] = measureJobs();
+    result.milliseconds = (now() - start) * toMs;
+    result.tier = selectTier(result.metrics);
+    result.measured = true;
+    MESSAGE("Scalability", "detect", ("Tier " + std::string(getTierName(result.tier)) + " (fill " +
+        std::to_string(result.metrics[METRIC_FILL]) + " Gpix/s, vertex " +
+        std::to_string(result.metrics[METRIC_VERTEX]) + " Mvert/s, jobs " +
+        std::to_string(result.metrics[METRIC_JOBS]) + "/ms, " +
+        std::to_string(static_cast<int>(result.milliseconds)) + " ms)").c_str());
+    if (!result.adapterKey.empty()) {
+        save(path, result);
+    }
+    return S_OK;
+}
+
+/**
+ * @details Cada prueba va entre dos timestamps dentro de su propia query disjoint, tras
+ * un draw de calentamiento (la primera vez el driver aún compila o pagina). Las dos se
+ * graban seguidas y se espera una sola vez.
+ */
+HRESULT Scalability::measureGpu(Device& device, DeviceContext& deviceContext, Result& result) {
+    ID3D11VertexShader* fillVS = nullptr;
+    ID3D11VertexShader* vertexVS = nullptr;
+    ID3D11PixelShader* fillPS = nullptr;
+    ID3D11Texture2D* target = nullptr;
+    ID3D11RenderTargetView* targetRTV = nullptr;
+    ID3D11Query* disjoint[2] = {};
+    ID3D11Query* timestamps[4] = {};
+
+    ShaderKey key;
+    key.fileName = "Scalability.fx";
+    key.entryPoint = "VSFill";
+    key.profile = "vs_4_0";
+    HRESULT hr = device.getShaderLibrary().getVertexShader(device, key, &fillVS);
+    key.entryPoint = "VSVertex";
+    if (SUCCEEDED(hr)) { hr = device.getShaderLibrary().getVertexShader(device, key, &vertexVS); }
+    key.entryPoint = "PSFill";
+    key.profile = "ps_4_0";
+    if (SUCCEEDED(hr)) { hr = device.getShaderLibrary().getPixelShader(device, key, &fillPS); }
+
+    D3D11_TEXTURE2D_DESC desc = {};
+    desc.Width = kFillSize;
+    desc.Height = kFillSize;
+    desc.MipLevels = 1;
+    desc.ArraySize = 1;
+    desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    desc.SampleDesc.Count = 1;
+    desc.Usage = D3D11_USAGE_DEFAULT;
+    desc.BindFlags = D3D11_BIND_RENDER_TARGET;
+    if (SUCCEEDED(hr)) { hr = device.CreateTexture2D(&desc, nullptr, &target); }
+    if (SUCCEEDED(hr)) { hr = device.CreateRenderTargetView(target, nullptr, &targetRTV); }
+
+    D3D11_QUERY_DESC disjointDesc = { D3D11_QUERY_TIMESTAMP_DISJOINT, 0 };
+    D3D11_QUERY_DESC timestampDesc = { D3D11_QUERY_TIMESTAMP, 0 };
+    for (unsigned int i = 0; i < 2 && SUCCEEDED(hr); ++i) {
+        hr = device.m_device->CreateQuery(&disjointDesc, &disjoint[i]);
+    }
+    for (unsigned int i = 0; i < 4 && SUCCEEDED(hr); ++i) {
+        hr = device.m_device->CreateQuery(&timestampDesc, &timestamps[i]);
+    }
+
+    if (SUCCEEDED(hr)) {
+        ID3D11DeviceContext* ctx = deviceContext.m_deviceContext;
+        D3D11_VIEWPORT viewport = {};
+        viewport.Width = static_cast<float>(kFillSize);
+        viewport.Height = static_cast<float>(kFillSize);
+        viewport.MaxDepth = 1.0f;
+        deviceContext.OMSetRenderTargets(1, &targetRTV, nullptr);
+        deviceContext.RSSetViewports(1, &viewport);
+        deviceContext.OMSetBlendState(nullptr, nullptr, 0xffffffff);
+        deviceContext.IASetInputLayout(nullptr);
+        deviceContext.IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+        // Relleno: triángulos a pantalla completa, solo escritura (sin mezcla ni profundidad).
+        deviceContext.VSSetShader(fillVS, nullptr, 0);
+        deviceContext.PSSetShader(fillPS, nullptr, 0);
+        deviceContext.Draw(3, 0);
+        ctx->Begin(disjoint[0]);
+        ctx->End(timestamps[0]);
+        for (unsigned int i = 0; i < kFillDraws; ++i) {
+            deviceContext.Draw(3, 0);
+        }
+        ctx->End(timestamps[1]);
+        ctx->End(disjoint[0]);
+
+        // Vértices: triángulos fuera de la pantalla, el rasterizador no genera píxeles.
+        deviceContext.VSSetShader(vertexVS, nullptr, 0);
+        deviceContext.Draw(kVertexCount / 8 / 3 * 3, 0);
+        ctx->Begin(disjoint[1]);
+        ctx->End(timestamps[2]);
+        for (unsigned int i = 0; i < kVertexDraws; ++i) {
+            deviceContext.Draw(kVertexCount, 0);
+        }
+        ctx->End(timestamps[3]);
+        ctx->End(disjoint[1]);
+
+        ID3D11RenderTargetView* nullRTV = nullptr;
+        deviceContext.OMSetRenderTargets(1, &nullRTV, nullptr);
+        deviceContext.VSSetShader(nullptr, nullptr, 0);
+        deviceContext.PSSetShader(nullptr, nullptr, 0);
+
+        UINT64 ticks[4] = {};
+        D3D11_QUERY_DATA_TIMESTAMP_DISJOINT data[2] = {};
+        for (unsigned int i = 0; i < 2 && SUCCEEDED(hr); ++i) {
+            hr = deviceContext.waitForQuery(disjoint[i], &data[i], sizeof(data[i]));
+        }
+        for (unsigned int i = 0; i < 4 && SUCCEEDED(hr); ++i) {
+            hr = deviceContext.waitForQuery(timestamps[i], &ticks[i], sizeof(ticks[i]));
+        }
+        if (SUCCEEDED(hr) && (data[0].Disjoint || data[1].Disjoint || data[0].Frequency == 0 ||
+            data[1].Frequency == 0 || ticks[1] <= ticks[0] || ticks[3] <= ticks[2])) {
+            hr = E_FAIL;
+        }
+        if (SUCCEEDED(hr)) {
+            const double fillSeconds = static_cast<double>(ticks[1] - ticks[0]) / data[0].Frequency;
+            const double vertexSeconds = static_cast<double>(ticks[3] - ticks[2]) / data[1].Frequency;
+            result.metrics[METRIC_FILL] = static_cast<float>(
+                static_cast<double>(kFillSize) * kFillSize * kFillDraws / fillSeconds / 1e9);
+            result.metrics[METRIC_VERTEX] = static_cast<float>(
+                static_cast<double>(kVertexCount) * kVertexDraws / vertexSeconds / 1e6);
+        }
+        else {
+            ERROR("Scalability", "measureGpu", ("Timestamps not available. HRESULT: " + std::to_string(hr)).c_str());
+        }
+    }
+    else {
+        ERROR("Scalability", "measureGpu", ("Failed to create the benchmark resources. HRESULT: " + std::to_string(hr)).c_str());
+    }
+
+    for (ID3D11Query*& query : timestamps) {
+        SAFE_RELEASE(query);
+    }
+    for (ID3D11Query*& query : disjoint) {
+        SAFE_RELEASE(query);
+    }
+    SAFE_RELEASE(targetRTV);
+    SAFE_RELEASE(target);
+    SAFE_RELEASE(fillPS);
+    SAFE_RELEASE(vertexVS);
+    SAFE_RELEASE(fillVS);
+    return hr;
+}
+
+/**
+ * @details Lotes de @ref kJobsPerRound hijos de un trabajo vacío, hasta
+ * @ref kCpuMilliseconds (y al menos dos lotes: el primero despierta a los workers).
+ */
+float Scalability::measureJobs() {
+    JobSystem& jobs = JobSystem::getDefault();
+    std::atomic<unsigned int> sink{ 0 };
+    std::atomic<unsigned int>* sinkPointer = &sink;
+    const double toMs = ticksToMs();
+
+    unsigned int rounds = 0;
+    LONGLONG measuredStart = 0;
+    double elapsed = 0.0;
+    do {
+        if (rounds == 1) {
+            measuredStart = now();
+        }
+        Job* root = jobs.createJob(&noJob);
+        if (!root) {
+            return 0.0f;
+        }
+        for (unsigned int i = 0; i < kJobsPerRound; ++i) {
+            jobs.run(jobs.createChild(*root, &benchmarkJob, &sinkPointer, sizeof(sinkPointer)));
+        }
+        jobs.run(root);
+        jobs.wait(root);
+        ++rounds;
+        if (rounds > 1) {
+            elapsed = (now() - measuredStart) * toMs;
+        }
+    } while (rounds < 2 || elapsed < kCpuMilliseconds);
+    return elapsed > 0.0 ? static_cast<float>((rounds - 1) * kJobsPerRound / elapsed) : 0.0f;
+}
+
+std::string Scalability::getAdapterKey(Device& device) {
+    if (!device.m_device) {
+        return std::string();
+    }
+    IDXGIDevice* dxgiDevice = nullptr;
+    IDXGIAdapter* adapter = nullptr;
+    HRESULT hr = device.m_device->QueryInterface(__uuidof(IDXGIDevice), (void**)&dxgiDevice);
+    if (SUCCEEDED(hr)) {
+        hr = dxgiDevice->GetAdapter(&adapter);
+    }
+    SAFE_RELEASE(dxgiDevice);
+    DXGI_ADAPTER_DESC desc = {};
+    if (FAILED(hr) || FAILED(adapter->GetDesc(&desc))) {
+        SAFE_RELEASE(adapter);
+        return std::string();
+    }
+    LARGE_INTEGER umd = {};
+    adapter->CheckInterfaceSupport(__uuidof(IDXGIDevice), &umd);
+    SAFE_RELEASE(adapter);
+    char key[64];
+    sprintf_s(key, "%04x:%04x %u.%u.%u.%u", desc.VendorId, desc.DeviceId,
+        HIWORD(umd.HighPart), LOWORD(umd.HighPart), HIWORD(umd.LowPart), LOWORD(umd.LowPart));
+    return key;
+}
+
+HRESULT Scalability::load(const std::string& path, Result& result) {
+    std::ifstream file(path);
+    if (!file) {
+        return E_FAIL;
+    }
+    unsigned int version = 0;
+    int tier = -1;
+    std::string line;
+    while (std::getline(file, line)) {
+        const size_t comment = line.find('#');
+        if (comment != std::string::npos) {
+            line.erase(comment);
+        }
+        std::istringstream stream(line);
+        std::string name;
+        if (!(stream >> name)) {
+            continue;
+        }
+        if (name == "version") stream >> version;
+        else if (name == "adapter") { stream >> std::ws; std::getline(stream, result.adapterKey); }
+        else if (name == "tier") stream >> tier;
+        else if (name == "fill") stream >> result.metrics[METRIC_FILL];
+        else if (name == "vertex") stream >> result.metrics[METRIC_VERTEX];
+        else if (name == "jobs") stream >> result.metrics[METRIC_JOBS];
+        else if (name == "milliseconds") stream >> result.milliseconds;
+    }
+    if (version != kFormatVersion || tier < 0 || tier >= SCALABILITY_TIER_COUNT) {
+        return E_FAIL;
+    }
+    result.tier = static_cast<ScalabilityTier>(tier);
+    result.measured = false;
+    return S_OK;
+}
+
+HRESULT Scalability::save(const std::string& path, const Result& result) {
+    std::ofstream file(path);
+    if (!file) {
+        ERROR("Scalability", "save", ("Cannot write " + path).c_str());
+        return E_FAIL;
+    }
+    file << "# Benchmark de arranque (se repite si cambia el adaptador o el driver; borrar para forzarlo)\n";
+    file << "version " << kFormatVersion << "\n";
+    file << "adapter " << result.adapterKey << "\n";
+    file << "tier " << static_cast<int>(result.tier) << "    # " << getTierName(result.tier) << "\n";
+    file << "fill " << result.metrics[METRIC_FILL] << "    # Gpix/s\n";
+    file << "vertex " << result.metrics[METRIC_VERTEX] << "    # Mvert/s\n";
+    file << "jobs " << result.metrics[METRIC_JOBS] << "    # jobs/ms\n";
+    file << "milliseconds " << result.milliseconds << "\n";
+    return S_OK;
+}
@@ -0,0 +1,788 @@
+﻿/**
+ * @file SceneBVH.cpp
+ * @brief Construcción SAH por bins, reajuste incremental con rotaciones y recorridos de la BVH.
+ */
+
+#include "SceneBVH.h"
+#include "Frustum.h"
+#include <algorithm>
+#include <cfloat>
+#include <cstring>
+#include <xmmintrin.h>
+
+namespace {
+    /// Coste de visitar un nodo interior frente a probar un elemento (SAH).
+    const float kTraversalCost = 1.0f;
+    /// Profundidad máxima de la construcción (las rotaciones pueden bajar algo más).
+    const unsigned int kMaxDepth = 64;
+    /// Mejora mínima de área (relativa al nodo) para que una rotación compense.
+    const float kRotationEpsilon = 1e-4f;
+
+    /// Mitad del área de una caja (el factor 2 se cancela en los cocientes SAH).
+    float halfArea(const XMFLOAT3& mn, const XMFLOAT3& mx) {
+        const float dx = mx.x - mn.x;
+        const float dy = mx.y - mn.y;
+        const float dz = mx.z - mn.z;
+        return dx * dy + dy * dz + dz * dx;
+    }
+
+    void grow(XMFLOAT3& mn, XMFLOAT3& mx, const XMFLOAT3& pMin, const XMFLOAT3& pMax) {
+        mn.x = (std::min)(mn.x, pMin.x); mn.y = (std::min)(mn.y, pMin.y); mn.z = (std::min)(mn.z, pMin.z);
+        mx.x = (std::max)(mx.x, pMax.x); mx.y = (std::max)(mx.y, pMax.y); mx.z = (std::max)(mx.z, pMax.z);
+    }
+
+    float component(const XMFLOAT3& v, unsigned int axis) {
+        return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+    }
+
+    /// Caja vacía (cualquier `grow` la sustituye).
+    void emptyBounds(XMFLOAT3& mn, XMFLOAT3& mx) {
+        mn = XMFLOAT3(FLT_MAX, FLT_MAX, FLT_MAX);
+        mx = XMFLOAT3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+    }
+
+    /// Entrada del rayo en la caja (método de los slabs) o `FLT_MAX` si no la corta.
+    float intersectRay(const XMFLOAT3& origin, const XMFLOAT3& invDir,
+        const XMFLOAT3& mn, const XMFLOAT3& mx, float maxT) {
+        float t0 = (mn.x - origin.x) * invDir.x, t1 = (mx.x - origin.x) * invDir.x;
+        float tMin = (std::min)(t0, t1), tMax = (std::max)(t0, t1);
+        t0 = (mn.y - origin.y) * invDir.y; t1 = (mx.y - origin.y) * invDir.y;
+        tMin = (std::max)(tMin, (std::min)(t0, t1)); tMax = (std::min)(tMax, (std::max)(t0, t1));
+        t0 = (mn.z - origin.z) * invDir.z; t1 = (mx.z - origin.z) * invDir.z;
+        tMin = (std::max)(tMin, (std::min)(t0, t1)); tMax = (std::min)(tMax, (std::max)(t0, t1));
+        tMin = (std::max)(tMin, 0.0f);
+        return (tMax >= tMin && tMin < maxT) ? tMin : FLT_MAX;
+    }
+}
+
+void SceneBVH::clear() {
+    cancelRebuild();
+    m_items.clear();
+    m_indices.clear();
+    m_nodes.clear();
+    m_parents.clear();
+    m_itemLeaf.clear();
+    m_dirtyLeaves.clear();
+    m_touched.clear();
+    m_stamps.clear();
+    m_areaSum = 0.0f;
+    m_buildCost = 0.0f;
+}
+
+void SceneBVH::computeBounds(const Node& node, XMFLOAT3& outMin, XMFLOAT3& outMax) const {
+    if (node.count == 0) {
+        const Node& left = m_nodes[node.leftFirst];
+        const Node& right = m_nodes[node.leftFirst + 1];
+        outMin = left.boundsMin;
+        outMax = left.boundsMax;
+        grow(outMin, outMax, right.boundsMin, right.boundsMax);
+        return;
+    }
+    emptyBounds(outMin, outMax);
+    for (uint32_t i = 0; i < node.count; ++i) {
+        const Item& item = m_items[m_indices[node.leftFirst + i]];
+        grow(outMin, outMax, item.boundsMin, item.boundsMax);
+    }
+}
+
+float SceneBVH::getWeight(const Node& node) {
+    return node.count > 0 ? static_cast<float>(node.count) : kTraversalCost;
+}
+
+/**
+ * @details
+ * Los nodos se crean en orden de pila: cada par de hijos se añade al final del arreglo,
+ * detrás de su padre. El reparto de elementos es in situ sobre `m_indices`, de modo que
+ * cualquier subárbol cubre un rango contiguo.
+ */
+void SceneBVH::build(const std::vector<Item>& items) {
+    clear();
+    if (items.empty()) {
+        return;
+    }
+    m_items = items;
+    m_indices.resize(m_items.size());
+    std::vector<XMFLOAT3> centroids(m_items.size());
+    for (size_t i = 0; i < m_items.size(); ++i) {
+        m_indices[i] = static_cast<uint32_t>(i);
+        const Item& item = m_items[i];
+        centroids[i] = XMFLOAT3((item.boundsMin.x + item.boundsMax.x) * 0.5f,
+            (item.boundsMin.y + item.boundsMax.y) * 0.5f, (item.boundsMin.z + item.boundsMax.z) * 0.5f);
+    }
+    // Como mucho 2n - 1 nodos: se reserva para no reubicar durante la construcción.
+    m_nodes.reserve(m_items.size() * 2);
+    Node root;
+    root.leftFirst = 0;
+    root.count = static_cast<uint32_t>(m_items.size());
+    m_nodes.push_back(root);
+    computeBounds(m_nodes[0], m_nodes[0].boundsMin, m_nodes[0].boundsMax);
+    subdivide(0, centroids);
+    linkNodes();
+
+    m_buildCost = getCost();
+    ++m_buildCount;
+}
+
+void SceneBVH::subdivide(uint32_t rootIndex, const std::vector<XMFLOAT3>& centroids) {
+    struct Pending { uint32_t node; unsigned int depth; };
+    std::vector<Pending> stack;
+    stack.push_back({ rootIndex, 0 });
+    while (!stack.empty()) {
+        const Pending pending = stack.back();
+        stack.pop_back();
+        const uint32_t first = m_nodes[pending.node].leftFirst;
+        const uint32_t count = m_nodes[pending.node].count;
+        if (count <= kMaxLeafItems || pending.depth + 1 >= kMaxDepth) {
+            continue;
+        }
+
+        // Caja de los centroides: los bins se reparten sobre ella, no sobre la del nodo.
+        XMFLOAT3 centroidMin, centroidMax;
+        emptyBounds(centroidMin, centroidMax);
+        for (uint32_t i = 0; i < count; ++i) {
+            const XMFLOAT3& c = centroids[m_indices[first + i]];
+            grow(centroidMin, centroidMax, c, c);
+        }
+
+        float bestCost = FLT_MAX;
+        unsigned int bestAxis = 0;
+        unsigned int bestSplit = 0;
+        for (unsigned int axis = 0; axis < 3; ++axis) {
+            const float lo = component(centroidMin, axis);
+            const float extent = component(centroidMax, axis) - lo;
+            if (extent <= 0.0f) {
+                continue;
+            }
+            const float scale = kBinCount / extent;
+            XMFLOAT3 binMin[kBinCount], binMax[kBinCount];
+            uint32_t binCount[kBinCount] = {};
+            for (unsigned int b = 0; b < kBinCount; ++b) {
+                emptyBounds(binMin[b], binMax[b]);
+            }
+            for (uint32_t i = 0; i < count; ++i) {
+                const uint32_t index = m_indices[first + i];
+                const unsigned int b = (std::min)(kBinCount - 1,
+                    static_cast<unsigned int>((component(centroids[index], axis) - lo) * scale));
+                ++binCount[b];
+                grow(binMin[b], binMax[b], m_items[index].boundsMin, m_items[index].boundsMax);
+            }
+
+            // Barrido desde la izquierda (áreas y cuentas acumuladas) y desde la derecha.
+            float leftArea[kBinCount - 1];
+            uint32_t leftCount[kBinCount - 1];
+            XMFLOAT3 accMin, accMax;
+            emptyBounds(accMin, accMax);
+            uint32_t accCount = 0;
+            for (unsigned int b = 0; b < kBinCount - 1; ++b) {
+                accCount += binCount[b];
+                if (binCount[b] > 0) grow(accMin, accMax, binMin[b], binMax[b]);
+                leftCount[b] = accCount;
+                leftArea[b] = accCount > 0 ? halfArea(accMin, accMax) : 0.0f;
+            }
+            emptyBounds(accMin, accMax);
+            accCount = 0;
+            for (unsigned int b = kBinCount - 1; b > 0; --b) {
+                accCount += binCount[b];
+                if (binCount[b] > 0) grow(accMin, accMax, binMin[b], binMax[b]);
+                if (leftCount[b - 1] == 0 || accCount == 0) {
+                    continue;
+                }
+                const float cost = leftArea[b - 1] * leftCount[b - 1] + halfArea(accMin, accMax) * accCount;
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestSplit = b;
+                }
+            }
+        }
+
+        // Cortar solo si sale más barato que probar todos los elementos de la hoja.
+        const Node& node = m_nodes[pending.node];
+        const float leafCost = halfArea(node.boundsMin, node.boundsMax) * count;
+        if (bestCost == FLT_MAX ||
+            kTraversalCost * halfArea(node.boundsMin, node.boundsMax) + bestCost >= leafCost) {
+            continue;
+        }
+
+        const float lo = component(centroidMin, bestAxis);
+        const float scale = kBinCount / (component(centroidMax, bestAxis) - lo);
+        uint32_t* begin = m_indices.data() + first;
+        uint32_t* middle = std::partition(begin, begin + count, [&](uint32_t index) {
+            const unsigned int b = (std::min)(kBinCount - 1,
+                static_cast<unsigned int>((component(centroids[index], bestAxis) - lo) * scale));
+            return b < bestSplit;
+        });
+        const uint32_t leftItems = static_cast<uint32_t>(middle - begin);
+        if (leftItems == 0 || leftItems == count) {
+            continue;
+        }
+
+        const uint32_t left = static_cast<uint32_t>(m_nodes.size());
+        Node child;
+        child.leftFirst = first;
+        child.count = leftItems;
+        m_nodes.push_back(child);
+        child.leftFirst = first + leftItems;
+        child.count = count - leftItems;
+        m_nodes.push_back(child);
+        computeBounds(m_nodes[left], m_nodes[left].boundsMin, m_nodes[left].boundsMax);
+        computeBounds(m_nodes[left + 1], m_nodes[left + 1].boundsMin, m_nodes[left + 1].boundsMax);
+        m_nodes[pending.node].leftFirst = left;
+        m_nodes[pending.node].count = 0;
+        stack.push_back({ left, pending.depth + 1 });
+        stack.push_back({ left + 1, pending.depth + 1 });
+    }
+}
+
+bool SceneBVH::refit(const std::vector<Item>& items) {
+    if (items.size() != m_items.size() || m_nodes.empty()) {
+        return false;
+    }
+    for (size_t i = 0; i < items.size(); ++i) {
+        if (items[i].id != m_items[i].id) {
+            return false;
+        }
+    }
+    m_items = items;
+    m_dirtyLeaves.clear();
+    refitAll();
+    return true;
+}
+
+void SceneBVH::linkNodes() {
+    m_parents.assign(m_nodes.size(), kNoParent);
+    m_itemLeaf.assign(m_items.size(), 0);
+    m_stamps.assign(m_nodes.size(), 0);
+    m_epoch = 0;
+    m_areaSum = 0.0f;
+    for (uint32_t n = 0; n < m_nodes.size(); ++n) {
+        const Node& node = m_nodes[n];
+        m_areaSum += halfArea(node.boundsMin, node.boundsMax) * getWeight(node);
+        if (node.count == 0) {
+            m_parents[node.leftFirst] = n;
+            m_parents[node.leftFirst + 1] = n;
+            continue;
+        }
+        for (uint32_t i = 0; i < node.count; ++i) {
+            m_itemLeaf[m_indices[node.leftFirst + i]] = n;
+        }
+    }
+}
+
+/**
+ * @details
+ * Tras las rotaciones un hijo puede quedar antes que su padre en el arreglo: se recorre
+ * en preorden y se ajusta en el orden inverso, que siempre pone los hijos primero.
+ */
+void SceneBVH::refitAll() {
+    m_areaSum = 0.0f;
+    if (m_nodes.empty()) {
+        return;
+    }
+    std::vector<uint32_t> order;
+    order.reserve(m_nodes.size());
+    order.push_back(0);
+    for (size_t i = 0; i < order.size(); ++i) {
+        const Node& node = m_nodes[order[i]];
+        if (node.count == 0) {
+            order.push_back(node.leftFirst);
+            order.push_back(node.leftFirst + 1);
+        }
+    }
+    for (size_t i = order.size(); i-- > 0;) {
+        Node& node = m_nodes[order[i]];
+        computeBounds(node, node.boundsMin, node.boundsMax);
+        m_areaSum += halfArea(node.boundsMin, node.boundsMax) * getWeight(node);
+    }
+}
+
+void SceneBVH::setBounds(unsigned int item, const XMFLOAT3& boundsMin, const XMFLOAT3& boundsMax) {
+    m_items[item].boundsMin = boundsMin;
+    m_items[item].boundsMax = boundsMax;
+    m_dirtyLeaves.push_back(m_itemLeaf[item]);
+}
+
+/**
+ * @details
+ * Desde cada hoja marcada se sube recalculando cajas hasta la primera que no cambia: por
+ * encima, todo se calculó con esa misma caja. Los nodos interiores por los que se pasa
+ * (incluido el que paró la subida) se apuntan una vez por `update` para probar rotaciones.
+ */
+void SceneBVH::refitDirty() {
+    m_touched.clear();
+    if (++m_epoch == 0) {
+        std::fill(m_stamps.begin(), m_stamps.end(), 0u);
+        m_epoch = 1;
+    }
+    for (uint32_t leaf : m_dirtyLeaves) {
+        uint32_t n = leaf;
+        while (n != kNoParent) {
+            Node& node = m_nodes[n];
+            XMFLOAT3 mn, mx;
+            computeBounds(node, mn, mx);
+            const bool changed = memcmp(&mn, &node.boundsMin, sizeof(mn)) != 0 ||
+                memcmp(&mx, &node.boundsMax, sizeof(mx)) != 0;
+            if (changed) {
+                m_areaSum += (halfArea(mn, mx) - halfArea(node.boundsMin, node.boundsMax)) * getWeight(node);
+                node.boundsMin = mn;
+                node.boundsMax = mx;
+                ++m_refitCount;
+            }
+            if (node.count == 0 && m_stamps[n] != m_epoch) {
+                m_stamps[n] = m_epoch;
+                m_touched.push_back(n);
+            }
+            if (!changed) {
+                break;
+            }
+            n = m_parents[n];
+        }
+    }
+    m_dirtyLeaves.clear();
+}
+
+void SceneBVH::swapSlots(uint32_t a, uint32_t b) {
+    std::swap(m_nodes[a], m_nodes[b]);
+    // Cada hueco conserva su padre; lo que cuelga del contenido movido apunta al hueco nuevo.
+    for (uint32_t slot : { a, b }) {
+        const Node& node = m_nodes[slot];
+        if (node.count == 0) {
+            m_parents[node.leftFirst] = slot;
+            m_parents[node.leftFirst + 1] = slot;
+            continue;
+        }
+        for (uint32_t i = 0; i < node.count; ++i) {
+            m_itemLeaf[m_indices[node.leftFirst + i]] = slot;
+        }
+    }
+}
+
+/**
+ * @details
+ * Rotación de Kopta et al.: cambiar un hijo `H` de `N` por un nieto `G` del otro hijo
+ * `O` no cambia la caja de `N` ni las de `H` y `G`; solo la de `O`, que pasa a envolver
+ * `H` y el hermano de `G`. Se elige el cambio que más la reduce.
+ */
+bool SceneBVH::rotate(uint32_t nodeIndex) {
+    const Node& node = m_nodes[nodeIndex];
+    if (node.count > 0) {
+        return false;
+    }
+    float bestDelta = -kRotationEpsilon * halfArea(node.boundsMin, node.boundsMax);
+    uint32_t bestChild = kNoParent;
+    uint32_t bestGrandchild = kNoParent;
+    for (uint32_t side = 0; side < 2; ++side) {
+        const uint32_t child = node.leftFirst + side;
+        const uint32_t other = node.leftFirst + (1 - side);
+        const Node& otherNode = m_nodes[other];
+        if (otherNode.count > 0) {
+            continue;
+        }
+        const float otherArea = halfArea(otherNode.boundsMin, otherNode.boundsMax);
+        for (uint32_t g = 0; g < 2; ++g) {
+            const Node& sibling = m_nodes[otherNode.leftFirst + (1 - g)];
+            XMFLOAT3 mn = m_nodes[child].boundsMin;
+            XMFLOAT3 mx = m_nodes[child].boundsMax;
+            grow(mn, mx, sibling.boundsMin, sibling.boundsMax);
+            const float delta = halfArea(mn, mx) - otherArea;
+            if (delta < bestDelta) {
+                bestDelta = delta;
+                bestChild = child;
+                bestGrandchild = otherNode.leftFirst + g;
+            }
+        }
+    }
+    if (bestChild == kNoParent) {
+        return false;
+    }
+    const uint32_t other = m_parents[bestGrandchild];
+    swapSlots(bestChild, bestGrandchild);
+    Node& otherNode = m_nodes[other];
+    computeBounds(otherNode, otherNode.boundsMin, otherNode.boundsMax);
+    m_areaSum += bestDelta * kTraversalCost;
+    return true;
+}
+
+void SceneBVH::update() {
+    m_refitCount = 0;
+    m_rotationCount = 0;
+    if (m_rebuildThread.joinable() && m_rebuildDone.load(std::memory_order_acquire)) {
+        m_rebuildThread.join();
+        // Topología nueva, cajas actuales: las que se movieron desde la copia se reajustan.
+        m_nodes.swap(m_rebuilt->m_nodes);
+        m_indices.swap(m_rebuilt->m_indices);
+        m_rebuilt.reset();
+        m_dirtyLeaves.clear();
+        linkNodes();
+        refitAll();
+        m_refitCount = static_cast<unsigned int>(m_nodes.size());
+        m_buildCost = getCost();
+        ++m_buildCount;
+        return;
+    }
+    if (m_nodes.empty()) {
+        m_dirtyLeaves.clear();
+        return;
+    }
+
+    refitDirty();
+    for (uint32_t n : m_touched) {
+        if (rotate(n)) {
+            ++m_rotationCount;
+        }
+    }
+
+    if (!m_rebuildThread.joinable() && m_items.size() > kMaxLeafItems &&
+        getCost() > kRebuildRatio * m_buildCost) {
+        startRebuild();
+    }
+}
+
+void SceneBVH::startRebuild() {
+    m_rebuilt = std::make_unique<SceneBVH>();
+    m_rebuildDone.store(false, std::memory_order_relaxed);
+    SceneBVH* target = m_rebuilt.get();
+    m_rebuildThread = std::thread([this, target, snapshot = m_items]() {
+        target->build(snapshot);
+        m_rebuildDone.store(true, std::memory_order_release);
+    });
+}
+
+void SceneBVH::cancelRebuild() {
+    if (m_rebuildThread.joinable()) {
+        m_rebuildThread.join();
+    }
+    m_rebuilt.reset();
+}
+
+/**
+ * @details
+ * Cada entrada de la pila lleva la máscara de planos que aún cortan a su padre. Para
+ * cada plano se prueba el vértice más adentro (si está fuera, el nodo entero lo está) y
+ * el más afuera (si está dentro, ese plano ya no hace falta para los descendientes).
+ */
+unsigned int SceneBVH::cull(const Frustum& frustum, std::vector<unsigned int>& outIds) const {
+    if (m_nodes.empty()) {
+        return 0;
+    }
+    struct Pending { uint32_t node; uint32_t planeMask; };
+    std::vector<Pending> stack;
+    stack.reserve(kMaxDepth * 2);
+    stack.push_back({ 0, (1u << FRUSTUM_PLANE_COUNT) - 1 });
+    unsigned int visited = 0;
+    while (!stack.empty()) {
+        const Pending pending = stack.back();
+        stack.pop_back();
+        const Node& node = m_nodes[pending.node];
+        ++visited;
+        uint32_t mask = pending.planeMask;
+        bool outside = false;
+        for (unsigned int p = 0; p < FRUSTUM_PLANE_COUNT && !outside; ++p) {
+            if (!(mask & (1u << p))) continue;
+            const XMFLOAT4& plane = frustum.getPlane(p);
+            const float inX = plane.x >= 0.0f ? node.boundsMax.x : node.boundsMin.x;
+            const float inY = plane.y >= 0.0f ? node.boundsMax.y : node.boundsMin.y;
+            const float inZ = plane.z >= 0.0f ? node.boundsMax.z : node.boundsMin.z;
+            if (plane.x * inX + plane.y * inY + plane.z * inZ + plane.w < 0.0f) {
+                outside = true;
+                break;
+            }
+            const float outX = plane.x >= 0.0f ? node.boundsMin.x : node.boundsMax.x;
+            const float outY = plane.y >= 0.0f ? node.boundsMin.y : node.boundsMax.y;
+            const float outZ = plane.z >= 0.0f ? node.boundsMin.z : node.boundsMax.z;
+            if (plane.x * outX + plane.y * outY + plane.z * outZ + plane.w >= 0.0f) {
+                mask &= ~(1u << p);
+            }
+        }
+        if (outside) {
+            continue;
+        }
+        if (node.count == 0) {
+            stack.push_back({ node.leftFirst, mask });
+            stack.push_back({ node.leftFirst + 1, mask });
+            continue;
+        }
+        for (uint32_t i = 0; i < node.count; ++i) {
+            const Item& item = m_items[m_indices[node.leftFirst + i]];
+            // Máscara vacía: la hoja está dentro de todos los planos y no hace falta probar.
+            if (mask == 0 || frustum.intersectsAABB(item.boundsMin, item.boundsMax)) {
+                outIds.push_back(item.id);
+            }
+        }
+    }
+    return visited;
+}
+
+unsigned int SceneBVH::cullViews(const Frustum* const* frusta, unsigned int viewCount,
+    std::vector<ViewHit>& outHits) const {
+    if (viewCount > kMaxViews) {
+        viewCount = kMaxViews;
+    }
+    if (m_nodes.empty() || viewCount == 0) {
+        return 0;
+    }
+    // Planos pendientes de cada vista, un byte por vista (6 bits usados).
+    struct Pending { uint32_t node; uint32_t views; uint64_t planeMasks; };
+    const uint64_t allPlanes = (1u << FRUSTUM_PLANE_COUNT) - 1;
+    Pending root = { 0, (1u << viewCount) - 1, 0 };
+    for (unsigned int v = 0; v < viewCount; ++v) {
+        root.planeMasks |= allPlanes << (v * 8);
+    }
+    std::vector<Pending> stack;
+    stack.reserve(kMaxDepth * 2);
+    stack.push_back(root);
+    unsigned int visited = 0;
+    while (!stack.empty()) {
+        Pending pending = stack.back();
+        stack.pop_back();
+        const Node& node = m_nodes[pending.node];
+        ++visited;
+        for (unsigned int v = 0; v < viewCount; ++v) {
+            if (!(pending.views & (1u << v))) continue;
+            uint64_t mask = (pending.planeMasks >> (v * 8)) & allPlanes;
+            for (unsigned int p = 0; p < FRUSTUM_PLANE_COUNT; ++p) {
+                if (!(mask & (1ull << p))) continue;
+                const XMFLOAT4& plane = frusta[v]->getPlane(p);
+                const float inX = plane.x >= 0.0f ? node.boundsMax.x : node.boundsMin.x;
+                const float inY = plane.y >= 0.0f ? node.boundsMax.y : node.boundsMin.y;
+                const float inZ = plane.z >= 0.0f ? node.boundsMax.z : node.boundsMin.z;
+                if (plane.x * inX + plane.y * inY + plane.z * inZ + plane.w < 0.0f) {
+                    pending.views &= ~(1u << v);
+                    break;
+                }
+                const float outX = plane.x >= 0.0f ? node.boundsMin.x : node.boundsMax.x;
+                const float outY = plane.y >= 0.0f ? node.boundsMin.y : node.boundsMax.y;
+                const float outZ = plane.z >= 0.0f ? node.boundsMin.z : node.boundsMax.z;
+                if (plane.x * outX + plane.y * outY + plane.z * outZ + plane.w >= 0.0f) {
+                    mask &= ~(1ull << p);
+                }
+            }
+            pending.planeMasks = (pending.planeMasks & ~(allPlanes << (v * 8))) | (mask << (v * 8));
+        }
+        if (pending.views == 0) {
+            continue;
+        }
+        if (node.count == 0) {
+            stack.push_back({ node.leftFirst, pending.views, pending.planeMasks });
+            stack.push_back({ node.leftFirst + 1, pending.views, pending.planeMasks });
+            continue;
+        }
+        for (uint32_t i = 0; i < node.count; ++i) {
+            const Item& item = m_items[m_indices[node.leftFirst + i]];
+            uint32_t seen = 0;
+            for (unsigned int v = 0; v < viewCount; ++v) {
+                if (!(pending.views & (1u << v))) continue;
+                // Sin planos pendientes la hoja está dentro de esa vista entera.
+                if (((pending.planeMasks >> (v * 8)) & allPlanes) == 0 ||
+                    frusta[v]->intersectsAABB(item.boundsMin, item.boundsMax)) {
+                    seen |= 1u << v;
+                }
+            }
+            if (seen) {
+                outHits.push_back({ item.id, seen });
+            }
+        }
+    }
+    return visited;
+}
+
+void SceneBVH::queryAABB(const XMFLOAT3& boundsMin, const XMFLOAT3& boundsMax,
+    std::vector<unsigned int>& outIds) const {
+    if (m_nodes.empty()) {
+        return;
+    }
+    auto overlaps = [&](const XMFLOAT3& mn, const XMFLOAT3& mx) {
+        return mn.x <= boundsMax.x && mx.x >= boundsMin.x &&
+               mn.y <= boundsMax.y && mx.y >= boundsMin.y &&
+               mn.z <= boundsMax.z && mx.z >= boundsMin.z;
+    };
+    std::vector<uint32_t> stack;
+    stack.reserve(kMaxDepth * 2);
+    stack.push_back(0);
+    while (!stack.empty()) {
+        const Node& node = m_nodes[stack.back()];
+        stack.pop_back();
+        if (!overlaps(node.boundsMin, node.boundsMax)) {
+            continue;
+        }
+        if (node.count == 0) {
+            stack.push_back(node.leftFirst);
+            stack.push_back(node.leftFirst + 1);
+            continue;
+        }
+        for (uint32_t i = 0; i < node.count; ++i) {
+            const Item& item = m_items[m_indices[node.leftFirst + i]];
+            if (overlaps(item.boundsMin, item.boundsMax)) {
+                outIds.push_back(item.id);
+            }
+        }
+    }
+}
+
+/**
+ * @details
+ * Se baja primero por el hijo que el rayo corta antes y se poda cualquier nodo cuya
+ * entrada quede más lejos que el mejor impacto encontrado.
+ */
+bool SceneBVH::raycast(const XMFLOAT3& origin, const XMFLOAT3& direction, float maxT,
+    unsigned int& outId, float& outT) const {
+    if (m_nodes.empty()) {
+        return false;
+    }
+    const XMFLOAT3 invDir(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+    float best = maxT;
+    bool hit = false;
+    std::vector<uint32_t> stack;
+    stack.reserve(kMaxDepth * 2);
+    if (intersectRay(origin, invDir, m_nodes[0].boundsMin, m_nodes[0].boundsMax, best) != FLT_MAX) {
+        stack.push_back(0);
+    }
+    while (!stack.empty()) {
+        const Node& node = m_nodes[stack.back()];
+        stack.pop_back();
+        if (node.count > 0) {
+            for (uint32_t i = 0; i < node.count; ++i) {
+                const Item& item = m_items[m_indices[node.leftFirst + i]];
+                const float t = intersectRay(origin, invDir, item.boundsMin, item.boundsMax, best);
+                if (t < best) {
+                    best = t;
+                    outId = item.id;
+                    hit = true;
+                }
+            }
+            continue;
+        }
+        uint32_t nearChild = node.leftFirst;
+        uint32_t farChild = node.leftFirst + 1;
+        float tNear = intersectRay(origin, invDir, m_nodes[nearChild].boundsMin, m_nodes[nearChild].boundsMax, best);
+        float tFar = intersectRay(origin, invDir, m_nodes[farChild].boundsMin, m_nodes[farChild].boundsMax, best);
+        if (tFar < tNear) {
+            std::swap(nearChild, farChild);
+            std::swap(tNear, tFar);
+        }
+        // El cercano se apila el último para visitarlo primero.
+        if (tFar != FLT_MAX) stack.push_back(farChild);
+        if (tNear != FLT_MAX) stack.push_back(nearChild);
+    }
+    if (hit) {
+        outT = best;
+    }
+    return hit;
+}
+
+namespace {
+    /// Cuatro rayos en SoA para la prueba de cajas en SSE.
+    struct RayLanes {
+        __m128 originX, originY, originZ;
+        __m128 invDirX, invDirY, invDirZ;
+    };
+
+    /// Entrada de los cuatro rayos en una caja; `FLT_MAX` en los carriles que no la cortan.
+    __m128 intersectLanes(const RayLanes& rays, const XMFLOAT3& mn, const XMFLOAT3& mx, __m128 maxT) {
+        const __m128 t0x = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(mn.x), rays.originX), rays.invDirX);
+        const __m128 t1x = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(mx.x), rays.originX), rays.invDirX);
+        const __m128 t0y = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(mn.y), rays.originY), rays.invDirY);
+        const __m128 t1y = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(mx.y), rays.originY), rays.invDirY);
+        const __m128 t0z = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(mn.z), rays.originZ), rays.invDirZ);
+        const __m128 t1z = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(mx.z), rays.originZ), rays.invDirZ);
+        __m128 tMin = _mm_max_ps(_mm_max_ps(_mm_min_ps(t0x, t1x), _mm_min_ps(t0y, t1y)), _mm_min_ps(t0z, t1z));
+        const __m128 tMax = _mm_min_ps(_mm_min_ps(_mm_max_ps(t0x, t1x), _mm_max_ps(t0y, t1y)), _mm_max_ps(t0z, t1z));
+        tMin = _mm_max_ps(tMin, _mm_setzero_ps());
+        const __m128 hit = _mm_and_ps(_mm_cmpge_ps(tMax, tMin), _mm_cmplt_ps(tMin, maxT));
+        return _mm_or_ps(_mm_and_ps(hit, tMin), _mm_andnot_ps(hit, _mm_set1_ps(FLT_MAX)));
+    }
+
+    /// Menor distancia de los carriles (`FLT_MAX` si ninguno corta).
+    float minLane(__m128 t) {
+        t = _mm_min_ps(t, _mm_shuffle_ps(t, t, _MM_SHUFFLE(2, 3, 0, 1)));
+        t = _mm_min_ps(t, _mm_shuffle_ps(t, t, _MM_SHUFFLE(1, 0, 3, 2)));
+        return _mm_cvtss_f32(t);
+    }
+}
+
+/**
+ * @details
+ * Los carriles sin rayo empiezan con distancia máxima negativa: ninguna caja los acepta.
+ * En los nodos interiores se baja primero por el hijo con la entrada más cercana de
+ * cualquier carril y se poda lo que queda detrás de todos los mejores impactos.
+ */
+unsigned int SceneBVH::raycastPacket(const XMFLOAT3 origins[4], const XMFLOAT3 directions[4], unsigned int laneMask,
+    float inOutT[4], unsigned int outIds[4], RayItemTest test, const void* context) const {
+    if (m_nodes.empty() || (laneMask & 0xF) == 0) {
+        return 0;
+    }
+    RayLanes rays;
+    rays.originX = _mm_setr_ps(origins[0].x, origins[1].x, origins[2].x, origins[3].x);
+    rays.originY = _mm_setr_ps(origins[0].y, origins[1].y, origins[2].y, origins[3].y);
+    rays.originZ = _mm_setr_ps(origins[0].z, origins[1].z, origins[2].z, origins[3].z);
+    const __m128 one = _mm_set1_ps(1.0f);
+    rays.invDirX = _mm_div_ps(one, _mm_setr_ps(directions[0].x, directions[1].x, directions[2].x, directions[3].x));
+    rays.invDirY = _mm_div_ps(one, _mm_setr_ps(directions[0].y, directions[1].y, directions[2].y, directions[3].y));
+    rays.invDirZ = _mm_div_ps(one, _mm_setr_ps(directions[0].z, directions[1].z, directions[2].z, directions[3].z));
+    float best[4];
+    for (unsigned int lane = 0; lane < 4; ++lane) {
+        best[lane] = (laneMask & (1u << lane)) ? inOutT[lane] : -1.0f;
+    }
+
+    unsigned int hitMask = 0;
+    std::vector<uint32_t> stack;
+    stack.reserve(kMaxDepth * 2);
+    if (minLane(intersectLanes(rays, m_nodes[0].boundsMin, m_nodes[0].boundsMax, _mm_loadu_ps(best))) != FLT_MAX) {
+        stack.push_back(0);
+    }
+    while (!stack.empty()) {
+        const Node& node = m_nodes[stack.back()];
+        stack.pop_back();
+        const __m128 bestT = _mm_loadu_ps(best);
+        if (node.count == 0) {
+            uint32_t nearChild = node.leftFirst;
+            uint32_t farChild = node.leftFirst + 1;
+            float tNear = minLane(intersectLanes(rays, m_nodes[nearChild].boundsMin, m_nodes[nearChild].boundsMax, bestT));
+            float tFar = minLane(intersectLanes(rays, m_nodes[farChild].boundsMin, m_nodes[farChild].boundsMax, bestT));
+            if (tFar < tNear) {
+                std::swap(nearChild, farChild);
+                std::swap(tNear, tFar);
+            }
+            if (tFar != FLT_MAX) stack.push_back(farChild);
+            if (tNear != FLT_MAX) stack.push_back(nearChild);
+            continue;
+        }
+        for (uint32_t i = 0; i < node.count; ++i) {
+            const Item& item = m_items[m_indices[node.leftFirst + i]];
+            float boxT[4];
+            _mm_storeu_ps(boxT, intersectLanes(rays, item.boundsMin, item.boundsMax, _mm_loadu_ps(best)));
+            for (unsigned int lane = 0; lane < 4; ++lane) {
+                if (boxT[lane] == FLT_MAX) {
+                    continue;
+                }
+                if (test) {
+                    if (!test(context, item.id, origins[lane], directions[lane], boxT[lane], best[lane])) {
+                        continue;
+                    }
+                }
+                else {
+                    best[lane] = boxT[lane];
+                }
+                outIds[lane] = item.id;
+                hitMask |= 1u << lane;
+            }
+        }
+    }
+    for (unsigned int lane = 0; lane < 4; ++lane) {
+        if (hitMask & (1u << lane)) {
+            inOutT[lane] = best[lane];
+        }
+    }
+    return hitMask;
+}
+
+float SceneBVH::getCost() const {
+    if (m_nodes.empty()) {
+        return 0.0f;
+    }
+    const float rootArea = halfArea(m_nodes[0].boundsMin, m_nodes[0].boundsMax);
+    if (rootArea <= 0.0f) {
+        return static_cast<float>(m_items.size());
+    }
+    return m_areaSum / rootArea;
+}
@@ -0,0 +1,552 @@
+﻿/**
+ * @file SceneFile.cpp
+ * @brief Formato `.sscene`: secciones, captura de actores e instanciación por prefabs.
+ */
+
+#include "SceneFile.h"
+#include "VirtualFileSystem.h"
+#include <cstring>
+#include <map>
+#include <unordered_map>
+
+namespace {
+    const uint32_t kMagic = 0x4E435353; // "SSCN"
+    const uint32_t kFormatVersion = 1;
+    const size_t kSectionAlignment = 64;
+
+    /// Secciones conocidas (el valor se guarda en el archivo: no reordenar).
+    enum SectionID : uint32_t {
+        SECTION_POSITION = 1,
+        SECTION_ROTATION = 2,
+        SECTION_SCALE = 3,
+        SECTION_PARENT = 4,
+        SECTION_MESH = 5,
+        SECTION_MATERIAL = 6,
+        SECTION_COLOR = 7,
+        SECTION_FLAGS = 8,
+        SECTION_IMPOSTOR = 9,
+        SECTION_NAME = 10,
+        SECTION_STRING_OFFSETS = 11, ///< `strings.size() + 1` posiciones en `SECTION_STRING_CHARS`.
+        SECTION_STRING_CHARS = 12,
+        SECTION_MATERIAL_TABLE = 13,
+        SECTION_BLOB = 14            ///< `BlobHeader`, filas y valores de un componente.
+    };
+
+    struct FileHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t entityCount;
+        uint32_t sectionCount;
+    };
+
+    struct SectionEntry {
+        uint32_t id;
+        uint32_t elementSize; ///< 0 = tamaño variable (cadenas, blobs).
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    struct BlobHeader {
+        uint32_t type;        ///< Nombre en la tabla de cadenas.
+        uint32_t elementSize;
+        uint32_t count;
+        uint32_t reserved;
+    };
+
+    static_assert(sizeof(EU::Vector3) == 12 && sizeof(EU::Quaternion) == 16, "Scene columns are copied as raw floats");
+    static_assert(sizeof(SceneMaterial) == 32, "SceneMaterial is stored as is");
+
+    /// Secciones acumuladas en memoria antes de escribir.
+    struct SectionWriter {
+        std::vector<SectionEntry> entries;
+        std::vector<unsigned char> data; ///< Contenido a partir del final de la tabla.
+
+        void add(uint32_t id, uint32_t elementSize, const void* bytes, size_t size) {
+            data.resize((data.size() + kSectionAlignment - 1) & ~(kSectionAlignment - 1));
+            SectionEntry entry = { id, elementSize, data.size(), size };
+            entries.push_back(entry);
+            const unsigned char* source = static_cast<const unsigned char*>(bytes);
+            data.insert(data.end(), source, source + size);
+        }
+
+        template<typename T>
+        void column(uint32_t id, const std::vector<T>& values) {
+            add(id, sizeof(T), values.data(), values.size() * sizeof(T));
+        }
+    };
+
+    /// Copia una columna si la sección tiene el tamaño esperado.
+    template<typename T>
+    bool readColumn(const unsigned char* file, const SectionEntry& entry, uint32_t count, std::vector<T>& out) {
+        if (entry.elementSize != sizeof(T) || entry.size != uint64_t(count) * sizeof(T)) {
+            return false;
+        }
+        out.resize(count);
+        if (count > 0) {
+            std::memcpy(out.data(), file + entry.offset, static_cast<size_t>(entry.size));
+        }
+        return true;
+    }
+}
+
+void SceneData::resize(uint32_t count) {
+    positions.resize(count, EU::Vector3(0.0f, 0.0f, 0.0f));
+    rotations.resize(count, EU::Quaternion(1.0f, 0.0f, 0.0f, 0.0f));
+    scales.resize(count, EU::Vector3(1.0f, 1.0f, 1.0f));
+    parents.resize(count, kNone);
+    meshes.resize(count, kNone);
+    materials.resize(count, kNone);
+    colors.resize(count, XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f));
+    flags.resize(count, SCENE_CAST_SHADOW | SCENE_RECEIVE_SHADOW);
+    impostorDistances.resize(count, 0.0f);
+    names.resize(count, kNone);
+}
+
+void SceneData::clear() {
+    resize(0);
+    strings.clear();
+    materialTable.clear();
+    blobs.clear();
+}
+
+void SceneFile::capture(const std::vector<ActorHandle>& actors,
+    const std::vector<SceneComponent>& components, SceneData& scene) {
+    scene.clear();
+    std::unordered_map<std::string, uint32_t> stringIndex;
+    auto intern = [&](const std::string& text) {
+        auto found = stringIndex.find(text);
+        if (found != stringIndex.end()) {
+            return found->second;
+        }
+        const uint32_t index = static_cast<uint32_t>(scene.strings.size());
+        scene.strings.push_back(text);
+        stringIndex[text] = index;
+        return index;
+    };
+
+    std::vector<Actor*> live;
+    live.reserve(actors.size());
+    for (const ActorHandle& handle : actors) {
+        if (Actor* actor = handle.get()) {
+            live.push_back(actor);
+        }
+    }
+    const uint32_t count = static_cast<uint32_t>(live.size());
+    scene.resize(count);
+
+    std::vector<EntityID> entities(count);
+    std::unordered_map<uint32_t, uint32_t> rowOfEntity;
+    std::unordered_map<const MeshAsset*, uint32_t> meshIndex;
+    std::unordered_map<const Material*, uint32_t> materialIndex;
+    rowOfEntity.reserve(count);
+    for (uint32_t row = 0; row < count; ++row) {
+        Actor& actor = *live[row];
+        const Transform& transform = *actor.getComponent<Transform>();
+        scene.positions[row] = transform.getPosition();
+        scene.rotations[row] = transform.getRotation();
+        scene.scales[row] = transform.getScale();
+        entities[row] = transform.getEntity();
+        rowOfEntity[entities[row].index] = row;
+
+        const MeshAsset* mesh = actor.getMeshAsset().get();
+        if (mesh) {
+            auto found = meshIndex.find(mesh);
+            if (found == meshIndex.end()) {
+                const uint32_t index = mesh->getSourceName().empty() ? SceneData::kNone : intern(mesh->getSourceName());
+                found = meshIndex.insert(std::make_pair(mesh, index)).first;
+            }
+            scene.meshes[row] = found->second;
+        }
+
+        // Un material por actor: el de la primera submalla (como los crea la escena).
+        const Material* material = actor.getMaterial(0);
+        if (material) {
+            auto found = materialIndex.find(material);
+            if (found == materialIndex.end()) {
+                const MaterialDesc& desc = material->getDesc();
+                SceneMaterial entry = {};
+                entry.diffuse = desc.diffuse.isNull() ? SceneData::kNone : intern(desc.diffuse->m_textureName);
+                entry.diffuseColor = desc.diffuseColor;
+                entry.blendMode = static_cast<uint32_t>(desc.blendMode);
+                entry.alphaCutoff = desc.alphaCutoff;
+                entry.twoSided = desc.twoSided ? 1u : 0u;
+                found = materialIndex.insert(std::make_pair(material,
+                    static_cast<uint32_t>(scene.materialTable.size()))).first;
+                scene.materialTable.push_back(entry);
+            }
+            scene.materials[row] = found->second;
+        }
+
+        scene.colors[row] = actor.getColor();
+        scene.flags[row] = (actor.canCastShadow() ? SCENE_CAST_SHADOW : 0) |
+            (actor.getReceiveShadow() ? SCENE_RECEIVE_SHADOW : 0) |
+            (actor.isStatic() ? SCENE_STATIC : 0) |
+            (actor.isTransparent() ? SCENE_TRANSPARENT : 0);
+        scene.impostorDistances[row] = actor.getImpostorDistance();
+        scene.names[row] = intern(actor.getName());
+    }
+
+    // Padres: cuando ya se conoce la fila de cada entidad.
+    for (uint32_t row = 0; row < count; ++row) {
+        const EntityID parent = live[row]->getComponent<Transform>()->getParent();
+        auto found = parent.isValid() ? rowOfEntity.find(parent.index) : rowOfEntity.end();
+        if (found != rowOfEntity.end()) {
+            scene.parents[row] = found->second;
+        }
+    }
+
+    for (const SceneComponent& component : components) {
+        SceneBlob blob;
+        blob.type = component.type;
+        blob.elementSize = component.elementSize;
+        for (uint32_t row = 0; row < count; ++row) {
+            const unsigned char* value = static_cast<const unsigned char*>(component.get(entities[row]));
+            if (value) {
+                blob.entities.push_back(row);
+                blob.data.insert(blob.data.end(), value, value + component.elementSize);
+            }
+        }
+        if (!blob.entities.empty()) {
+            scene.blobs.push_back(std::move(blob));
+        }
+    }
+}
+
+HRESULT SceneFile::write(const std::string& path, const SceneData& scene) {
+    SectionWriter sections;
+    sections.column(SECTION_POSITION, scene.positions);
+    sections.column(SECTION_ROTATION, scene.rotations);
+    sections.column(SECTION_SCALE, scene.scales);
+    sections.column(SECTION_PARENT, scene.parents);
+    sections.column(SECTION_MESH, scene.meshes);
+    sections.column(SECTION_MATERIAL, scene.materials);
+    sections.column(SECTION_COLOR, scene.colors);
+    sections.column(SECTION_FLAGS, scene.flags);
+    sections.column(SECTION_IMPOSTOR, scene.impostorDistances);
+    sections.column(SECTION_NAME, scene.names);
+
+    std::vector<uint32_t> offsets(1, 0);
+    std::string chars;
+    for (const std::string& text : scene.strings) {
+        chars += text;
+        offsets.push_back(static_cast<uint32_t>(chars.size()));
+    }
+    sections.column(SECTION_STRING_OFFSETS, offsets);
+    sections.add(SECTION_STRING_CHARS, 0, chars.data(), chars.size());
+    sections.column(SECTION_MATERIAL_TABLE, scene.materialTable);
+
+    // Los tipos de los blobs se escriben con los demás textos: van antes de la tabla.
+    for (const SceneBlob& blob : scene.blobs) {
+        uint32_t type = SceneData::kNone;
+        for (size_t i = 0; i < scene.strings.size() && type == SceneData::kNone; ++i) {
+            if (scene.strings[i] == blob.type) {
+                type = static_cast<uint32_t>(i);
+            }
+        }
+        if (type == SceneData::kNone) {
+            ERROR("SceneFile", "write", ("Blob type not in the string table: " + blob.type).c_str());
+            continue;
+        }
+        BlobHeader header = { type, blob.elementSize, static_cast<uint32_t>(blob.entities.size()), 0 };
+        std::vector<unsigned char> payload(sizeof(header));
+        std::memcpy(payload.data(), &header, sizeof(header));
+        const unsigned char* rows = reinterpret_cast<const unsigned char*>(blob.entities.data());
+        payload.insert(payload.end(), rows, rows + blob.entities.size() * sizeof(uint32_t));
+        payload.insert(payload.end(), blob.data.begin(), blob.data.end());
+        sections.add(SECTION_BLOB, 0, payload.data(), payload.size());
+    }
+
+    FileHeader header = { kMagic, kFormatVersion, scene.getEntityCount(),
+        static_cast<uint32_t>(sections.entries.size()) };
+    const size_t tableEnd = sizeof(header) + sections.entries.size() * sizeof(SectionEntry);
+    const size_t dataStart = (tableEnd + kSectionAlignment - 1) & ~(kSectionAlignment - 1);
+    for (SectionEntry& entry : sections.entries) {
+        entry.offset += dataStart;
+    }
+
+    const std::string temp = path + ".tmp" + std::to_string(GetCurrentThreadId());
+    FILE* file = nullptr;
+    if (fopen_s(&file, temp.c_str(), "wb") != 0 || !file) {
+        ERROR("SceneFile", "write", ("Cannot write " + temp).c_str());
+        return E_FAIL;
+    }
+    const std::vector<unsigned char> padding(dataStart - tableEnd, 0);
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+        fwrite(sections.entries.data(), sizeof(SectionEntry), sections.entries.size(), file) == sections.entries.size() &&
+        fwrite(padding.data(), 1, padding.size(), file) == padding.size() &&
+        fwrite(sections.data.data(), 1, sections.data.size(), file) == sections.data.size();
+    ok = fclose(file) == 0 && ok;
+    if (!ok || !MoveFileExA(temp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+        ERROR("SceneFile", "write", ("Cannot write " + path).c_str());
+        DeleteFileA(temp.c_str());
+        return E_FAIL;
+    }
+    return S_OK;
+}
+
+HRESULT SceneFile::read(const std::string& path, SceneData& scene) {
+    FileView view;
+    if (!VirtualFileSystem::getDefault().open(path, view)) {
+        return HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND);
+    }
+    const unsigned char* data = view.getData();
+    const size_t size = view.getSize();
+    FileHeader header = {};
+    if (size < sizeof(header)) {
+        ERROR("SceneFile", "read", ("Truncated scene: " + path).c_str());
+        return E_FAIL;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (header.magic != kMagic || header.version != kFormatVersion ||
+        (size - sizeof(header)) / sizeof(SectionEntry) < header.sectionCount) {
+        ERROR("SceneFile", "read", ("Not a scene of this version: " + path).c_str());
+        return E_FAIL;
+    }
+    std::vector<SectionEntry> entries(header.sectionCount);
+    std::memcpy(entries.data(), data + sizeof(header), entries.size() * sizeof(SectionEntry));
+
+    scene.clear();
+    const uint32_t count = header.entityCount;
+    scene.resize(count); // columnas que falten: valores por defecto
+    bool ok = true;
+    bool hasTransforms[3] = { false, false, false };
+    std::vector<uint32_t> offsets;
+    const SectionEntry* chars = nullptr;
+    std::vector<const SectionEntry*> blobs;
+    for (const SectionEntry& entry : entries) {
+        if (entry.offset > size || entry.size > size - entry.offset) {
+            ok = false;
+            break;
+        }
+        switch (entry.id) {
+        case SECTION_POSITION: ok = hasTransforms[0] = readColumn(data, entry, count, scene.positions); break;
+        case SECTION_ROTATION: ok = hasTransforms[1] = readColumn(data, entry, count, scene.rotations); break;
+        case SECTION_SCALE: ok = hasTransforms[2] = readColumn(data, entry, count, scene.scales); break;
+        case SECTION_PARENT: ok = readColumn(data, entry, count, scene.parents); break;
+        case SECTION_MESH: ok = readColumn(data, entry, count, scene.meshes); break;
+        case SECTION_MATERIAL: ok = readColumn(data, entry, count, scene.materials); break;
+        case SECTION_COLOR: ok = readColumn(data, entry, count, scene.colors); break;
+        case SECTION_FLAGS: ok = readColumn(data, entry, count, scene.flags); break;
+        case SECTION_IMPOSTOR: ok = readColumn(data, entry, count, scene.impostorDistances); break;
+        case SECTION_NAME: ok = readColumn(data, entry, count, scene.names); break;
+        case SECTION_STRING_OFFSETS:
+            ok = entry.elementSize == sizeof(uint32_t) && entry.size >= sizeof(uint32_t) &&
+                readColumn(data, entry, static_cast<uint32_t>(entry.size / sizeof(uint32_t)), offsets);
+            break;
+        case SECTION_STRING_CHARS: chars = &entry; break;
+        case SECTION_MATERIAL_TABLE:
+            ok = readColumn(data, entry, static_cast<uint32_t>(entry.size / sizeof(SceneMaterial)), scene.materialTable);
+            break;
+        case SECTION_BLOB: blobs.push_back(&entry); break;
+        default: break; // sección de una versión posterior
+        }
+        if (!ok) {
+            break;
+        }
+    }
+
+    // Tabla de cadenas: posiciones crecientes dentro de los caracteres.
+    if (ok && !offsets.empty()) {
+        const uint64_t charCount = chars ? chars->size : 0;
+        scene.strings.reserve(offsets.size() - 1);
+        for (size_t i = 0; ok && i + 1 < offsets.size(); ++i) {
+            ok = offsets[i] <= offsets[i + 1] && offsets[i + 1] <= charCount;
+            if (ok) {
+                scene.strings.push_back(std::string(reinterpret_cast<const char*>(data + chars->offset + offsets[i]),
+                    offsets[i + 1] - offsets[i]));
+            }
+        }
+    }
+
+    for (size_t i = 0; ok && i < blobs.size(); ++i) {
+        const SectionEntry& entry = *blobs[i];
+        BlobHeader blobHeader = {};
+        ok = entry.size >= sizeof(blobHeader);
+        if (!ok) {
+            break;
+        }
+        std::memcpy(&blobHeader, data + entry.offset, sizeof(blobHeader));
+        const uint64_t rowsBytes = uint64_t(blobHeader.count) * sizeof(uint32_t);
+        const uint64_t valueBytes = uint64_t(blobHeader.count) * blobHeader.elementSize;
+        ok = blobHeader.type < scene.strings.size() && entry.size == sizeof(blobHeader) + rowsBytes + valueBytes;
+        if (!ok) {
+            break;
+        }
+        SceneBlob blob;
+        blob.type = scene.strings[blobHeader.type];
+        blob.elementSize = blobHeader.elementSize;
+        const unsigned char* rows = data + entry.offset + sizeof(blobHeader);
+        blob.entities.resize(blobHeader.count);
+        std::memcpy(blob.entities.data(), rows, static_cast<size_t>(rowsBytes));
+        blob.data.assign(rows + rowsBytes, rows + rowsBytes + valueBytes);
+        scene.blobs.push_back(std::move(blob));
+    }
+
+    if (!ok || !hasTransforms[0] || !hasTransforms[1] || !hasTransforms[2]) {
+        ERROR("SceneFile", "read", ("Corrupt scene: " + path).c_str());
+        scene.clear();
+        return E_FAIL;
+    }
+    return S_OK;
+}
+
+/**
+ * @details
+ * Cada malla y cada material distintos se piden una sola vez; los actores que los
+ * comparten son instancias del mismo prefab y reciben el recurso en una continuación.
+ * Las referencias fuera de rango (archivo editado a mano o de otra versión) se tratan
+ * como vacías.
+ */
+HRESULT SceneFile::instantiate(Device& device, const SceneData& scene, ResourceManager& resources,
+    const MeshResolver& meshes, const std::vector<SceneComponent>& components,
+    std::vector<std::unique_ptr<Prefab>>& prefabs, std::vector<ActorHandle>& actors) {
+    const uint32_t count = scene.getEntityCount();
+    const uint32_t stringCount = static_cast<uint32_t>(scene.strings.size());
+    const uint32_t materialCount = static_cast<uint32_t>(scene.materialTable.size());
+
+    std::unordered_map<uint32_t, ResourceHandle<MeshAsset>> meshFutures;
+    for (uint32_t mesh : scene.meshes) {
+        if (mesh < stringCount && meshFutures.find(mesh) == meshFutures.end()) {
+            meshFutures[mesh] = meshes(scene.strings[mesh]);
+        }
+    }
+    std::vector<ResourceHandle<Material>> materialFutures(materialCount);
+    for (uint32_t i = 0; i < materialCount; ++i) {
+        const SceneMaterial& row = scene.materialTable[i];
+        MaterialDesc desc;
+        desc.diffuseColor = row.diffuseColor;
+        desc.blendMode = static_cast<MaterialBlendMode>(row.blendMode);
+        desc.alphaCutoff = row.alphaCutoff;
+        desc.twoSided = row.twoSided != 0;
+        const ResourceHandle<Texture> texture = row.diffuse < stringCount
+            ? resources.load<Texture>(scene.strings[row.diffuse]) : ResourceHandle<Texture>();
+        materialFutures[i] = resources.loadMaterial(desc, texture);
+    }
+
+    // Un grupo por pareja malla/material (clave ordenada: el resultado no depende del hash).
+    std::map<uint64_t, std::vector<uint32_t>> groups;
+    for (uint32_t row = 0; row < count; ++row) {
+        const uint32_t mesh = scene.meshes[row] < stringCount ? scene.meshes[row] : SceneData::kNone;
+        const uint32_t material = scene.materials[row] < materialCount ? scene.materials[row] : SceneData::kNone;
+        groups[(uint64_t(mesh) << 32) | material].push_back(row);
+    }
+
+    std::vector<ActorHandle> byRow(count);
+    auto publishActors = [&]() {
+        for (const ActorHandle& actor : byRow) {
+            if (!actor.isNull()) {
+                actors.push_back(actor);
+            }
+        }
+    };
+    HRESULT hr = ActorPool::getDefault().reserve(ActorPool::getDefault().getCount() + count);
+    if (FAILED(hr)) {
+        return hr;
+    }
+
+    for (const auto& group : groups) {
+        std::unique_ptr<Prefab> prefab(new Prefab());
+        hr = prefab->init(device);
+        std::vector<ActorHandle> created;
+        if (SUCCEEDED(hr)) {
+            hr = prefab->instantiate(std::vector<Prefab::Placement>(group.second.size()), created);
+        }
+        prefabs.push_back(std::move(prefab));
+        if (FAILED(hr)) {
+            ERROR("SceneFile", "instantiate", "Failed to create scene actors");
+            publishActors();
+            return hr;
+        }
+
+        for (size_t i = 0; i < created.size(); ++i) {
+            const uint32_t row = group.second[i];
+            Actor& actor = *created[i];
+            byRow[row] = created[i];
+            actor.getComponent<Transform>()->setTransform(scene.positions[row], scene.rotations[row], scene.scales[row]);
+            actor.setColor(scene.colors[row]);
+            actor.setCastShadow((scene.flags[row] & SCENE_CAST_SHADOW) != 0);
+            actor.setReceiveShadow((scene.flags[row] & SCENE_RECEIVE_SHADOW) != 0);
+            actor.setStatic((scene.flags[row] & SCENE_STATIC) != 0);
+            actor.setTransparent((scene.flags[row] & SCENE_TRANSPARENT) != 0);
+            actor.setImpostorDistance(scene.impostorDistances[row]);
+            if (scene.names[row] < stringCount) {
+                actor.setName(scene.strings[scene.names[row]]);
+            }
+        }
+
+        std::shared_ptr<std::vector<ActorHandle>> members = std::make_shared<std::vector<ActorHandle>>(created);
+        const uint32_t mesh = static_cast<uint32_t>(group.first >> 32);
+        const uint32_t material = static_cast<uint32_t>(group.first);
+        if (mesh != SceneData::kNone && !meshFutures[mesh].isNull()) {
+            meshFutures[mesh]->then([members](const MeshHandle& asset) {
+                for (const ActorHandle& member : *members) {
+                    if (!member.isNull()) {
+                        member->setMeshAsset(asset);
+                    }
+                }
+            });
+        }
+        if (material != SceneData::kNone) {
+            materialFutures[material]->then([members](const MaterialHandle& resolved) {
+                for (const ActorHandle& member : *members) {
+                    if (!member.isNull()) {
+                        member->setMaterials(std::vector<MaterialHandle>{ resolved });
+                    }
+                }
+            });
+        }
+    }
+
+    for (uint32_t row = 0; row < count; ++row) {
+        const uint32_t parent = scene.parents[row];
+        if (parent < count && parent != row &&
+            !byRow[row]->getComponent<Transform>()->setParent(byRow[parent]->getComponent<Transform>())) {
+            ERROR("SceneFile", "instantiate", "Parent cycle in the scene; entity left unparented");
+        }
+    }
+
+    for (const SceneBlob& blob : scene.blobs) {
+        const SceneComponent* component = nullptr;
+        for (const SceneComponent& candidate : components) {
+            if (candidate.type == blob.type) {
+                component = &candidate;
+            }
+        }
+        if (!component || component->elementSize != blob.elementSize) {
+            MESSAGE("SceneFile", "instantiate", ("Skipping component " + blob.type).c_str());
+            continue;
+        }
+        for (size_t i = 0; i < blob.entities.size(); ++i) {
+            if (blob.entities[i] < count) {
+                component->add(byRow[blob.entities[i]]->getComponent<Transform>()->getEntity(),
+                    blob.data.data() + i * blob.elementSize);
+            }
+        }
+    }
+
+    publishActors();
+    return S_OK;
+}
+
+bool SceneFile::saveAsync(const std::string& path, SceneData&& scene) {
+    if (isSaving()) {
+        return false;
+    }
+    if (m_saver.joinable()) {
+        m_saver.join();
+    }
+    m_saving.store(true, std::memory_order_release);
+    std::shared_ptr<SceneData> snapshot = std::make_shared<SceneData>(std::move(scene));
+    m_saver = std::thread([this, path, snapshot]() {
+        m_lastResult = write(path, *snapshot);
+        m_saving.store(false, std::memory_order_release);
+    });
+    return true;
+}
+
+HRESULT SceneFile::waitSave() {
+    if (m_saver.joinable()) {
+        m_saver.join();
+    }
+    return m_lastResult;
+}
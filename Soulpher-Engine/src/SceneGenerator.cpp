@@ -0,0 +1,287 @@
+﻿/**
+ * @file SceneGenerator.cpp
+ * @brief Implementación del generador de escenas de estrés.
+ */
+
+#include "SceneGenerator.h"
+#include "Device.h"
+#include "ClusteredLighting.h"
+#include <cmath>
+#include <random>
+
+namespace {
+    /// Lado de las texturas procedurales y de cada casilla del tablero (px).
+    const unsigned int kTextureSize = 64;
+    const unsigned int kCheckerCell = 8;
+
+    /// Altura del suelo de la escena del editor (ver BaseApp::init).
+    const float kGroundY = -5.0f;
+
+    /// Número en [0, 1) a partir del generador; no depende de la implementación de
+    /// `std::uniform_real_distribution`, así la escena es igual con cualquier STL.
+    float nextFloat(std::mt19937& rng) {
+        return static_cast<float>(rng() >> 8) * (1.0f / 16777216.0f);
+    }
+
+    /// Color de tono `hue` en [0, 1) con saturación y brillo fijos.
+    XMFLOAT4 hueColor(float hue) {
+        const float h = hue * 6.0f;
+        const float f = h - std::floor(h);
+        const float lo = 0.35f, hi = 1.0f;
+        const float up = lo + (hi - lo) * f;
+        const float down = hi - (hi - lo) * f;
+        switch (static_cast<int>(h) % 6) {
+        case 0:  return XMFLOAT4(hi, up, lo, 1.0f);
+        case 1:  return XMFLOAT4(down, hi, lo, 1.0f);
+        case 2:  return XMFLOAT4(lo, hi, up, 1.0f);
+        case 3:  return XMFLOAT4(lo, down, hi, 1.0f);
+        case 4:  return XMFLOAT4(up, lo, hi, 1.0f);
+        default: return XMFLOAT4(hi, lo, down, 1.0f);
+        }
+    }
+
+    /**
+     * Caja de semiejes `half` con cada cara partida en `segments` x `segments` quads.
+     * Para cada cara se eligen `u` y `v` con `u x v = normal`, así los triángulos
+     * (q00, q10, q01) y (q10, q11, q01) quedan en sentido horario vistos desde fuera.
+     */
+    MeshComponent makeBox(const XMFLOAT3& half, unsigned int segments, const std::string& name) {
+        static const float kFaces[6][3][3] = {
+            { { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 } },  // +X
+            { { -1, 0, 0 }, { 0, 0, 1 }, { 0, 1, 0 } }, // -X
+            { { 0, 1, 0 }, { 0, 0, 1 }, { 1, 0, 0 } },  // +Y
+            { { 0, -1, 0 }, { 1, 0, 0 }, { 0, 0, 1 } }, // -Y
+            { { 0, 0, 1 }, { 1, 0, 0 }, { 0, 1, 0 } },  // +Z
+            { { 0, 0, -1 }, { 0, 1, 0 }, { 1, 0, 0 } }, // -Z
+        };
+
+        MeshComponent mesh;
+        mesh.m_name = name;
+        const unsigned int side = segments + 1;
+        mesh.m_vertex.reserve(6 * side * side);
+        mesh.m_index.reserve(6 * segments * segments * 6);
+        for (const auto& face : kFaces) {
+            const unsigned int base = static_cast<unsigned int>(mesh.m_vertex.size());
+            for (unsigned int j = 0; j < side; ++j) {
+                for (unsigned int i = 0; i < side; ++i) {
+                    const float s = static_cast<float>(i) / segments;
+                    const float t = static_cast<float>(j) / segments;
+                    const float a = s * 2.0f - 1.0f;
+                    const float b = t * 2.0f - 1.0f;
+                    SimpleVertex vertex;
+                    vertex.Pos = XMFLOAT3(
+                        (face[0][0] + face[1][0] * a + face[2][0] * b) * half.x,
+                        (face[0][1] + face[1][1] * a + face[2][1] * b) * half.y,
+                        (face[0][2] + face[1][2] * a + face[2][2] * b) * half.z);
+                    vertex.Tex = XMFLOAT2(s, 1.0f - t);
+                    mesh.m_vertex.push_back(vertex);
+                }
+            }
+            for (unsigned int j = 0; j < segments; ++j) {
+                for (unsigned int i = 0; i < segments; ++i) {
+                    const unsigned int q00 = base + j * side + i;
+                    const unsigned int q10 = q00 + 1;
+                    const unsigned int q01 = q00 + side;
+                    const unsigned int q11 = q01 + 1;
+                    const unsigned int quad[6] = { q00, q10, q01, q10, q11, q01 };
+                    mesh.m_index.insert(mesh.m_index.end(), quad, quad + 6);
+                }
+            }
+        }
+        mesh.m_numVertex = static_cast<int>(mesh.m_vertex.size());
+        mesh.m_numIndex = static_cast<int>(mesh.m_index.size());
+        mesh.computeBounds();
+        return mesh;
+    }
+}
+
+HRESULT SceneGenerator::generate(Device& device, const Config& config,
+    std::vector<ActorHandle>& actors) {
+    destroy(actors);
+
+    std::mt19937 rng(config.seed);
+    const unsigned int variants = (std::max)(config.meshVariants, 1u);
+    const unsigned int textures = (std::max)(config.textureCount, 1u);
+    const unsigned int materials = (std::max)(config.materialCount, 1u);
+
+    // 1) Variantes de malla: proporciones distintas y 12..768 triángulos.
+    m_meshes.reserve(variants);
+    m_sharedMeshes.reserve(variants);
+    for (unsigned int v = 0; v < variants; ++v) {
+        const XMFLOAT3 half(0.5f, 0.5f + 0.25f * (v % 3), 0.5f + 0.15f * (v % 2));
+        m_meshes.push_back(makeBox(half, 1u << (v % 4), "StressBox" + std::to_string(v)));
+
+        EU::TSharedPointer<MeshAsset> asset = EU::MakeShared<MeshAsset>();
+        std::vector<MeshComponent> meshes{ m_meshes.back() };
+        HRESULT hr = asset->init(device, meshes, true, config.pool);
+        if (FAILED(hr)) {
+            ERROR("SceneGenerator", "generate", ("Failed to create mesh variant " + std::to_string(v)).c_str());
+            asset->destroy();
+            destroy(actors);
+            return hr;
+        }
+        m_sharedMeshes.push_back(asset);
+    }
+
+    // 2) Tableros de ajedrez: dos tonos por textura.
+    std::vector<unsigned char> pixels(kTextureSize * kTextureSize * 4);
+    m_textures.reserve(textures);
+    for (unsigned int t = 0; t < textures; ++t) {
+        const XMFLOAT4 light = hueColor(static_cast<float>(t) / textures);
+        const float dark = 0.35f;
+        for (unsigned int y = 0; y < kTextureSize; ++y) {
+            for (unsigned int x = 0; x < kTextureSize; ++x) {
+                const bool odd = ((x / kCheckerCell) + (y / kCheckerCell)) & 1;
+                const float k = odd ? dark : 1.0f;
+                unsigned char* p = &pixels[(y * kTextureSize + x) * 4];
+                p[0] = static_cast<unsigned char>(light.x * k * 255.0f);
+                p[1] = static_cast<unsigned char>(light.y * k * 255.0f);
+                p[2] = static_cast<unsigned char>(light.z * k * 255.0f);
+                p[3] = 255;
+            }
+        }
+        m_textures.push_back(EU::MakeShared<Texture>());
+        HRESULT hr = m_textures[t]->init(device, kTextureSize, kTextureSize, pixels.data());
+        if (FAILED(hr)) {
+            ERROR("SceneGenerator", "generate", ("Failed to create texture " + std::to_string(t)).c_str());
+            destroy(actors);
+            return hr;
+        }
+    }
+
+    // 3) Prefabs de los actores compartidos: variante x textura.
+    m_prefabs.reserve(variants * textures);
+    for (unsigned int v = 0; v < variants; ++v) {
+        for (unsigned int t = 0; t < textures; ++t) {
+            std::unique_ptr<Prefab> prefab(new Prefab());
+            prefab->setName("Stress");
+            prefab->setMeshAsset(m_sharedMeshes[v]);
+            prefab->setTextures(std::vector<TextureHandle>{ m_textures[t] });
+            prefab->setImpostorDistance(config.impostorDistance);
+            HRESULT hr = prefab->init(device);
+            if (FAILED(hr)) {
+                destroy(actors);
+                return hr;
+            }
+            m_prefabs.push_back(std::move(prefab));
+        }
+    }
+
+    // 4) Actores en rejilla cuadrada centrada en el origen.
+    const unsigned int side = static_cast<unsigned int>(std::ceil(std::sqrt(static_cast<double>(config.actorCount))));
+    const float origin = -0.5f * (side - 1) * config.spacing;
+    // Huecos del pool por adelantado: crear los actores no reserva páginas una a una.
+    ActorPool& pool = ActorPool::getDefault();
+    HRESULT hr = pool.reserve(pool.getCount() + config.actorCount);
+    if (FAILED(hr)) {
+        destroy(actors);
+        return hr;
+    }
+    m_actors.reserve(config.actorCount);
+    actors.reserve(actors.size() + config.actorCount);
+    for (unsigned int i = 0; i < config.actorCount; ++i) {
+        const unsigned int variant = rng() % variants;
+        const bool unique = nextFloat(rng) < config.uniqueMeshRatio;
+        const unsigned int texture = rng() % textures;
+        ActorHandle actor;
+        if (unique) {
+            actor = pool.spawn(device);
+            actor->setMesh(device, std::vector<MeshComponent>{ m_meshes[variant] });
+            actor->setTextures(std::vector<TextureHandle>{ m_textures[texture] });
+        }
+        else {
+            actor = pool.spawn(*m_prefabs[variant * textures + texture]);
+        }
+        actor->setName("Stress" + std::to_string(i));
+        actor->setColor(hueColor(static_cast<float>(rng() % materials) / materials));
+
+        const float scale = 0.25f + 0.25f * nextFloat(rng);
+        const float jitter = 0.25f * config.spacing;
+        const float x = origin + (i % side) * config.spacing + (nextFloat(rng) - 0.5f) * jitter;
+        const float z = origin + (i / side) * config.spacing + (nextFloat(rng) - 0.5f) * jitter;
+        const float y = kGroundY + m_meshes[variant].m_boundsMax.y * scale;
+        const float yaw = nextFloat(rng) * XM_2PI;
+        actor->getComponent<Transform>()->setTransform(
+            EU::Vector3(x, y, z), EU::Vector3(0.0f, yaw, 0.0f), EU::Vector3(scale, scale, scale));
+
+        const bool isStatic = nextFloat(rng) < config.staticRatio;
+        actor->setStatic(isStatic);
+        actor->setCastShadow(nextFloat(rng) < config.casterRatio);
+        actor->setImpostorDistance(config.impostorDistance);
+        actor->setReceiveShadow(true);
+        if (!isStatic) {
+            const float speed = 0.5f + 1.5f * nextFloat(rng);
+            const Spin spin = { (rng() & 1) ? speed : -speed };
+            World::getDefault().add(actor->getComponent<Transform>()->getEntity(), spin);
+            ++m_dynamicCount;
+        }
+
+        m_actors.push_back(actor);
+        actors.push_back(actor);
+    }
+
+    // 5) Luces puntuales a poca altura sobre la rejilla, con alcance de unas pocas celdas.
+    if (config.lights && config.lightCount > 0) {
+        config.lights->clear();
+        const float extent = (side - 1) * config.spacing + config.spacing;
+        for (unsigned int i = 0; i < config.lightCount; ++i) {
+            const XMFLOAT4 color = hueColor(nextFloat(rng));
+            const XMFLOAT3 position(origin - 0.5f * config.spacing + nextFloat(rng) * extent,
+                kGroundY + 0.5f + 1.5f * nextFloat(rng),
+                origin - 0.5f * config.spacing + nextFloat(rng) * extent);
+            config.lights->addPointLight(position, config.spacing * (2.0f + 2.0f * nextFloat(rng)),
+                XMFLOAT3(color.x, color.y, color.z), 1.5f);
+        }
+    }
+
+    MESSAGE("SceneGenerator", "generate", ("Generated " + std::to_string(config.actorCount) + " actors (" +
+        std::to_string(m_dynamicCount) + " dynamic)").c_str());
+    return S_OK;
+}
+
+void SceneGenerator::update(float deltaTime) {
+    if (m_dynamicCount == 0) {
+        return;
+    }
+    const EU::Vector3 up(0.0f, 1.0f, 0.0f);
+    World::getDefault().forEachChunk<LocalTransform, Spin>(
+        [deltaTime, &up](unsigned int count, const EntityID*, LocalTransform* locals, Spin* spins) {
+            for (unsigned int i = 0; i < count; ++i) {
+                locals[i].rotation = Transform::rotated(locals[i].rotation, up, spins[i].radiansPerSecond * deltaTime);
+                locals[i].dirty = true;
+            }
+        });
+}
+
+void SceneGenerator::destroy(std::vector<ActorHandle>& actors) {
+    if (!m_actors.empty()) {
+        EU::TSet<uint32_t> generated;
+        generated.Reserve(m_actors.size());
+        for (ActorHandle actor : m_actors) {
+            generated.Add(actor.value);
+        }
+        actors.erase(std::remove_if(actors.begin(), actors.end(),
+            [&generated](ActorHandle actor) { return generated.Contains(actor.value); }),
+            actors.end());
+    }
+
+    // Los actores sueltan sus mallas únicas; las mallas y texturas compartidas
+    // siguen referenciadas aquí, así que se liberan después.
+    // Las entidades (y su `Spin`) se destruyen con el `Transform` de cada actor.
+    m_dynamicCount = 0;
+    for (ActorHandle actor : m_actors) {
+        actor->destroy();
+        ActorPool::getDefault().despawn(actor);
+    }
+    m_actors.clear();
+    m_prefabs.clear();
+    for (auto& asset : m_sharedMeshes) {
+        asset->destroy();
+    }
+    m_sharedMeshes.clear();
+    for (auto& texture : m_textures) {
+        texture->destroy();
+    }
+    m_textures.clear();
+    m_meshes.clear();
+}
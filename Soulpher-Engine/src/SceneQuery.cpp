@@ -0,0 +1,358 @@
+﻿/**
+ * @file SceneQuery.cpp
+ * @brief Paquetes de rayos contra la BVH, triángulos por meshlet y cola de consultas.
+ */
+
+#include "SceneQuery.h"
+#include "SceneBVH.h"
+#include "JobSystem.h"
+#include "MeshAsset.h"
+#include "ECS/Actor.h"
+#include <algorithm>
+
+namespace {
+    /// Margen relativo para volver a encontrar el mismo impacto al calcular su normal.
+    const float kRefineEpsilon = 1e-4f;
+
+    /**
+     * @brief Möller-Trumbore a doble cara: parámetro del rayo en el triángulo.
+     * @return `true` si lo corta en `[0, maxT)`.
+     */
+    bool intersectTriangle(const XMVECTOR origin, const XMVECTOR direction, const XMFLOAT3& a,
+        const XMFLOAT3& b, const XMFLOAT3& c, float maxT, float& outT) {
+        const XMVECTOR v0 = XMLoadFloat3(&a);
+        const XMVECTOR e1 = XMVectorSubtract(XMLoadFloat3(&b), v0);
+        const XMVECTOR e2 = XMVectorSubtract(XMLoadFloat3(&c), v0);
+        const XMVECTOR p = XMVector3Cross(direction, e2);
+        const float det = XMVectorGetX(XMVector3Dot(e1, p));
+        if (fabsf(det) < 1e-12f) {
+            return false;
+        }
+        const float invDet = 1.0f / det;
+        const XMVECTOR s = XMVectorSubtract(origin, v0);
+        const float u = XMVectorGetX(XMVector3Dot(s, p)) * invDet;
+        if (u < 0.0f || u > 1.0f) {
+            return false;
+        }
+        const XMVECTOR q = XMVector3Cross(s, e1);
+        const float v = XMVectorGetX(XMVector3Dot(direction, q)) * invDet;
+        if (v < 0.0f || u + v > 1.0f) {
+            return false;
+        }
+        const float t = XMVectorGetX(XMVector3Dot(e2, q)) * invDet;
+        if (t < 0.0f || t >= maxT) {
+            return false;
+        }
+        outT = t;
+        return true;
+    }
+
+    /// `true` si el rayo puede cortar la esfera antes de `maxT` (dirección sin normalizar).
+    bool rayTouchesSphere(const XMVECTOR origin, const XMVECTOR direction, const XMFLOAT3& center,
+        float radius, float maxT) {
+        const XMVECTOR oc = XMVectorSubtract(XMLoadFloat3(&center), origin);
+        const float dd = XMVectorGetX(XMVector3Dot(direction, direction));
+        const float od = XMVectorGetX(XMVector3Dot(oc, direction));
+        const float oo = XMVectorGetX(XMVector3Dot(oc, oc));
+        const float distanceSq = oo - od * od / dd;
+        if (distanceSq > radius * radius) {
+            return false;
+        }
+        const float tCenter = od / dd;
+        const float tHalf = sqrtf((radius * radius - distanceSq) / dd);
+        return tCenter + tHalf >= 0.0f && tCenter - tHalf < maxT;
+    }
+
+    /// Distancia al cuadrado de un punto a una caja (0 dentro).
+    float distanceSqToBox(const XMFLOAT3& p, const XMFLOAT3& mn, const XMFLOAT3& mx) {
+        const float dx = (std::max)((std::max)(mn.x - p.x, 0.0f), p.x - mx.x);
+        const float dy = (std::max)((std::max)(mn.y - p.y, 0.0f), p.y - mx.y);
+        const float dz = (std::max)((std::max)(mn.z - p.z, 0.0f), p.z - mx.z);
+        return dx * dx + dy * dy + dz * dz;
+    }
+}
+
+void SceneQuery::Batch::clear() {
+    rayTickets.clear();
+    rays.clear();
+    hits.clear();
+    overlapTickets.clear();
+    spheres.clear();
+    offsets.clear();
+    actors.clear();
+}
+
+void SceneQuery::setScene(const SceneBVH& staticTree, const SceneBVH& dynamicTree,
+    const std::vector<ActorHandle>& actors) {
+    m_trees[0] = &staticTree;
+    m_trees[1] = &dynamicTree;
+    m_actors.assign(actors.begin(), actors.end());
+}
+
+/**
+ * @details
+ * El rayo se lleva al espacio del modelo con la inversa del mundo del render (el
+ * parámetro `t` no cambia con una transformación afín). Cada submalla descarta sus
+ * meshlets por la esfera antes de probar sus triángulos; sin meshlets se prueban todos.
+ */
+bool SceneQuery::intersectActor(unsigned int id, const XMFLOAT3& origin, const XMFLOAT3& direction,
+    float boxT, float& inOutT, RayHit* outHit) const {
+    if (id >= m_actors.size()) {
+        return false;
+    }
+    Actor* actor = m_actors[id].get();
+    if (!actor) {
+        return false;
+    }
+    MeshAsset* asset = actor->getMeshAsset().get();
+    if (!asset || !asset->hasCpuData()) {
+        // Sin triángulos: la caja del actor es el impacto.
+        if (boxT >= inOutT) {
+            return false;
+        }
+        inOutT = boxT;
+        if (outHit) {
+            XMFLOAT3 mn, mx;
+            actor->getWorldBounds(mn, mx);
+            const XMFLOAT3 p(origin.x + direction.x * boxT, origin.y + direction.y * boxT,
+                origin.z + direction.z * boxT);
+            // Cara de la caja más cercana al punto de entrada.
+            const float faces[6] = { fabsf(p.x - mn.x), fabsf(p.x - mx.x), fabsf(p.y - mn.y),
+                                     fabsf(p.y - mx.y), fabsf(p.z - mn.z), fabsf(p.z - mx.z) };
+            const unsigned int face = static_cast<unsigned int>(std::min_element(faces, faces + 6) - faces);
+            const float sign = (face & 1) ? 1.0f : -1.0f;
+            outHit->normal = XMFLOAT3(face / 2 == 0 ? sign : 0.0f, face / 2 == 1 ? sign : 0.0f,
+                face / 2 == 2 ? sign : 0.0f);
+            outHit->triangle = false;
+        }
+        return true;
+    }
+
+    const XMMATRIX world = actor->getRenderWorld();
+    XMVECTOR determinant;
+    const XMMATRIX invWorld = XMMatrixInverse(&determinant, world);
+    const XMVECTOR localOrigin = XMVector3TransformCoord(XMLoadFloat3(&origin), invWorld);
+    const XMVECTOR localDirection = XMVector3TransformNormal(XMLoadFloat3(&direction), invWorld);
+
+    bool hit = false;
+    const MeshComponent* hitMesh = nullptr;
+    size_t hitTriangle = 0;
+    for (const MeshComponent& mesh : asset->m_meshes) {
+        if (mesh.m_vertex.empty() || mesh.m_index.size() < 3) {
+            continue;
+        }
+        auto testRange = [&](size_t first, size_t count) {
+            const size_t last = (std::min)(first + count, mesh.m_index.size());
+            for (size_t i = first; i + 2 < last; i += 3) {
+                float t;
+                if (intersectTriangle(localOrigin, localDirection, mesh.m_vertex[mesh.m_index[i]].Pos,
+                    mesh.m_vertex[mesh.m_index[i + 1]].Pos, mesh.m_vertex[mesh.m_index[i + 2]].Pos, inOutT, t)) {
+                    inOutT = t;
+                    hit = true;
+                    hitMesh = &mesh;
+                    hitTriangle = i;
+                }
+            }
+        };
+        if (mesh.m_meshlets.empty()) {
+            testRange(0, mesh.m_index.size());
+            continue;
+        }
+        for (const Meshlet& meshlet : mesh.m_meshlets) {
+            if (rayTouchesSphere(localOrigin, localDirection, meshlet.center, meshlet.radius, inOutT)) {
+                testRange(meshlet.firstIndex, meshlet.indexCount);
+            }
+        }
+    }
+
+    if (hit && outHit) {
+        const XMVECTOR a = XMLoadFloat3(&hitMesh->m_vertex[hitMesh->m_index[hitTriangle]].Pos);
+        const XMVECTOR b = XMLoadFloat3(&hitMesh->m_vertex[hitMesh->m_index[hitTriangle + 1]].Pos);
+        const XMVECTOR c = XMLoadFloat3(&hitMesh->m_vertex[hitMesh->m_index[hitTriangle + 2]].Pos);
+        const XMVECTOR localNormal = XMVector3Cross(XMVectorSubtract(b, a), XMVectorSubtract(c, a));
+        // Las normales van con la inversa traspuesta; se orientan hacia el rayo.
+        XMVECTOR normal = XMVector3Normalize(XMVector3TransformNormal(localNormal, XMMatrixTranspose(invWorld)));
+        if (XMVectorGetX(XMVector3Dot(normal, XMLoadFloat3(&direction))) > 0.0f) {
+            normal = XMVectorNegate(normal);
+        }
+        XMStoreFloat3(&outHit->normal, normal);
+        outHit->triangle = true;
+    }
+    return hit;
+}
+
+bool SceneQuery::testActor(const void* context, unsigned int id, const XMFLOAT3& origin,
+    const XMFLOAT3& direction, float boxT, float& inOutT) {
+    return static_cast<const SceneQuery*>(context)->intersectActor(id, origin, direction, boxT, inOutT, nullptr);
+}
+
+/**
+ * @details
+ * Cada lote de trabajo recorre paquetes de cuatro rayos consecutivos, primero contra el
+ * árbol estático y luego contra el dinámico con las distancias ya acortadas. El impacto
+ * ganador se repite una vez con su actor para sacar la normal.
+ */
+void SceneQuery::raycast(const Ray* rays, unsigned int count, RayHit* outHits) const {
+    const unsigned int packets = (count + 3) / 4;
+    JobSystem::getDefault().parallelFor(packets, [this, rays, count, outHits](unsigned int begin, unsigned int end) {
+        for (unsigned int packet = begin; packet < end; ++packet) {
+            XMFLOAT3 origins[4];
+            XMFLOAT3 directions[4];
+            float t[4];
+            unsigned int ids[4] = {};
+            unsigned int laneMask = 0;
+            for (unsigned int lane = 0; lane < 4; ++lane) {
+                const unsigned int index = packet * 4 + lane;
+                if (index < count) {
+                    origins[lane] = rays[index].origin;
+                    directions[lane] = rays[index].direction;
+                    t[lane] = rays[index].maxDistance;
+                    laneMask |= 1u << lane;
+                }
+                else {
+                    origins[lane] = XMFLOAT3(0.0f, 0.0f, 0.0f);
+                    directions[lane] = XMFLOAT3(0.0f, 0.0f, 1.0f);
+                    t[lane] = 0.0f;
+                }
+            }
+            unsigned int hitMask = 0;
+            for (const SceneBVH* tree : m_trees) {
+                if (tree) {
+                    hitMask |= tree->raycastPacket(origins, directions, laneMask, t, ids, &SceneQuery::testActor, this);
+                }
+            }
+            for (unsigned int lane = 0; lane < 4; ++lane) {
+                const unsigned int index = packet * 4 + lane;
+                if (index >= count) {
+                    break;
+                }
+                RayHit& hit = outHits[index];
+                hit = RayHit();
+                if (!(hitMask & (1u << lane))) {
+                    continue;
+                }
+                hit.hit = true;
+                hit.actor = m_actors[ids[lane]];
+                hit.distance = t[lane];
+                hit.position = XMFLOAT3(origins[lane].x + directions[lane].x * t[lane],
+                    origins[lane].y + directions[lane].y * t[lane], origins[lane].z + directions[lane].z * t[lane]);
+                float refine = t[lane] + kRefineEpsilon * (1.0f + t[lane]);
+                intersectActor(ids[lane], origins[lane], directions[lane], t[lane], refine, &hit);
+            }
+        }
+    }, (std::max)(1u, kMinBatch / 4));
+}
+
+void SceneQuery::overlap(const Sphere* spheres, unsigned int count, std::vector<uint32_t>& outOffsets,
+    std::vector<ActorHandle>& outActors) const {
+    std::vector<std::vector<ActorHandle>> perSphere(count);
+    JobSystem::getDefault().parallelFor(count, [&](unsigned int begin, unsigned int end) {
+        std::vector<unsigned int> ids;
+        for (unsigned int s = begin; s < end; ++s) {
+            const Sphere& sphere = spheres[s];
+            const XMFLOAT3 mn(sphere.center.x - sphere.radius, sphere.center.y - sphere.radius,
+                sphere.center.z - sphere.radius);
+            const XMFLOAT3 mx(sphere.center.x + sphere.radius, sphere.center.y + sphere.radius,
+                sphere.center.z + sphere.radius);
+            ids.clear();
+            for (const SceneBVH* tree : m_trees) {
+                if (tree) {
+                    tree->queryAABB(mn, mx, ids);
+                }
+            }
+            for (unsigned int id : ids) {
+                Actor* actor = id < m_actors.size() ? m_actors[id].get() : nullptr;
+                XMFLOAT3 boundsMin, boundsMax;
+                if (actor && actor->getWorldBounds(boundsMin, boundsMax) &&
+                    distanceSqToBox(sphere.center, boundsMin, boundsMax) <= sphere.radius * sphere.radius) {
+                    perSphere[s].push_back(m_actors[id]);
+                }
+            }
+        }
+    }, kMinBatch);
+
+    outOffsets.resize(static_cast<size_t>(count) + 1);
+    outActors.clear();
+    for (unsigned int s = 0; s < count; ++s) {
+        outOffsets[s] = static_cast<uint32_t>(outActors.size());
+        outActors.insert(outActors.end(), perSphere[s].begin(), perSphere[s].end());
+    }
+    outOffsets[count] = static_cast<uint32_t>(outActors.size());
+}
+
+SceneQuery::Ticket SceneQuery::queueRay(const Ray& ray) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const Ticket ticket = m_nextTicket++;
+    if (m_nextTicket == 0) {
+        m_nextTicket = 1;
+    }
+    m_pending.rayTickets.push_back(ticket);
+    m_pending.rays.push_back(ray);
+    return ticket;
+}
+
+SceneQuery::Ticket SceneQuery::queueOverlap(const Sphere& sphere) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const Ticket ticket = m_nextTicket++;
+    if (m_nextTicket == 0) {
+        m_nextTicket = 1;
+    }
+    m_pending.overlapTickets.push_back(ticket);
+    m_pending.spheres.push_back(sphere);
+    return ticket;
+}
+
+bool SceneQuery::getRayHit(Ticket ticket, RayHit& outHit) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (unsigned int age = 0; age < 2; ++age) {
+        const Batch& batch = m_completed[(m_newest + 2 - age) % 2];
+        auto it = std::lower_bound(batch.rayTickets.begin(), batch.rayTickets.end(), ticket);
+        if (it != batch.rayTickets.end() && *it == ticket) {
+            outHit = batch.hits[it - batch.rayTickets.begin()];
+            return true;
+        }
+    }
+    return false;
+}
+
+bool SceneQuery::getOverlap(Ticket ticket, std::vector<ActorHandle>& outActors) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (unsigned int age = 0; age < 2; ++age) {
+        const Batch& batch = m_completed[(m_newest + 2 - age) % 2];
+        auto it = std::lower_bound(batch.overlapTickets.begin(), batch.overlapTickets.end(), ticket);
+        if (it != batch.overlapTickets.end() && *it == ticket) {
+            const size_t s = it - batch.overlapTickets.begin();
+            outActors.assign(batch.actors.begin() + batch.offsets[s], batch.actors.begin() + batch.offsets[s + 1]);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @details
+ * La cola se cambia por el lote más viejo bajo el cerrojo y se resuelve fuera de él: los
+ * hilos pueden seguir encolando para el frame siguiente mientras tanto.
+ */
+void SceneQuery::execute() {
+    m_running.clear();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::swap(m_running, m_pending);
+    }
+    m_executedCount = static_cast<unsigned int>(m_running.rays.size() + m_running.spheres.size());
+    if (m_executedCount == 0) {
+        return;
+    }
+    m_running.hits.resize(m_running.rays.size());
+    if (!m_running.rays.empty()) {
+        raycast(m_running.rays.data(), static_cast<unsigned int>(m_running.rays.size()), m_running.hits.data());
+    }
+    if (!m_running.spheres.empty()) {
+        overlap(m_running.spheres.data(), static_cast<unsigned int>(m_running.spheres.size()),
+            m_running.offsets, m_running.actors);
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_newest = 1 - m_newest;
+    std::swap(m_completed[m_newest], m_running);
+}
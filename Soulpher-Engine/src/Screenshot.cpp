@@ -1,130 +1,250 @@
 ﻿/**
  * @file Screenshot.cpp
- * @brief Implementación de captura de pantalla del back buffer y su integración con la UI.
+ * @brief Implementación de las capturas por readback de GPU y su codificación PNG.
  *
  * @details
- * Este módulo permite capturar una imagen del contenido actual de la ventana del juego
- * (back buffer) y guardarla como un archivo de imagen.
- *
- * Flujo general:
- *  1. Obtener el **back buffer** desde el `SwapChain`.
- *  2. Crear un contexto de dispositivo de memoria (DC) y un bitmap compatible.
- *  3. Copiar el contenido de la ventana al bitmap.
- *  4. Convertir los datos de píxeles a formato RGB.
- *  5. (Opcional) Guardar en un archivo PNG.
- *
- * Además, se integra un **popup en ImGui** para permitir al usuario capturar la pantalla
- * directamente desde la interfaz del juego.
- *
- * @note
- * - Actualmente el guardado a PNG está comentado porque requiere `stb_image_write.h`.
- * - El sistema usa **GDI** para la captura, lo que es más simple pero menos eficiente
- *   que acceder directamente a los datos de GPU.
+ * El PNG se escribe con WIC (`windowscodecs.lib`), que viene con Windows: no hace
+ * falta ninguna dependencia más. El codificador de PNG de WIC acepta BGR de 24 bits
+ * en todas las versiones, así que el hilo convierte desde el RGBA del back buffer
+ * (y descarta el alfa, que en el back buffer no significa nada).
  */
 
 #include "Screenshot.h"
-#include "Window.h"
-#include "SwapChain.h"
+#include "Device.h"
+#include "DeviceContext.h"
+#include "GpuMemory.h"
 #include "Texture.h"
- //#define STB_IMAGE_WRITE_IMPLEMENTATION
- //#include "stb_image_write.h"
-
- /**
-  * @brief Captura el contenido actual del back buffer de la ventana.
-  *
-  * @param window       Referencia a la ventana activa.
-  * @param swapChain    Cadena de intercambio asociada.
-  * @param backBuffer   Textura donde se copiará el contenido del back buffer.
-  *
-  * @details
-  * - Usa `GetBuffer()` para acceder al back buffer de Direct3D.
-  * - Utiliza funciones de Windows GDI (`BitBlt`, `GetDIBits`) para copiar y leer píxeles.
-  * - Convierte el formato de color de **BGR a RGB**.
-  *
-  * @note
-  * Esta función actualmente no guarda la imagen en disco, pero está preparada
-  * para hacerlo mediante **stb_image_write**.
-  */
-void Screenshot::captureScreenshot(Window window, SwapChain swapChain, Texture& backBuffer) {
-    // Obtener el back buffer
-    swapChain.m_swapChain->GetBuffer(0, __uuidof(ID3D11Texture2D), reinterpret_cast<LPVOID*>(&backBuffer.m_texture));
-
-    // Obtener el HWND de la ventana
-    HWND hWnd = GetForegroundWindow();
-
-    // Obtener el DC de la ventana
-    HDC hDC = GetDC(hWnd);
-
-    // Calcular dimensiones de la ventana
-    RECT rect;
-    GetClientRect(hWnd, &rect);
-    int width = rect.right - rect.left;
-    int height = rect.bottom - rect.top;
-
-    // Crear un bitmap compatible en memoria
-    HBITMAP hBitmap = CreateCompatibleBitmap(hDC, width, height);
-    HDC hMemoryDC = CreateCompatibleDC(hDC);
-    SelectObject(hMemoryDC, hBitmap);
-
-    // Copiar el contenido de la ventana al bitmap
-    BitBlt(hMemoryDC, 0, 0, width, height, hDC, 0, 0, SRCCOPY);
-
-    // Obtener datos de píxeles
-    BITMAPINFO bmi = { 0 };
-    bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
-    bmi.bmiHeader.biWidth = window.m_width;
-    bmi.bmiHeader.biHeight = -window.m_height; // negativo para evitar imagen invertida
-    bmi.bmiHeader.biPlanes = 1;
-    bmi.bmiHeader.biBitCount = 32;
-    bmi.bmiHeader.biCompression = BI_RGB;
-    std::vector<uint8_t> pixels(window.m_width * window.m_height * 4);
-    GetDIBits(hMemoryDC, hBitmap, 0, window.m_height, pixels.data(), &bmi, DIB_RGB_COLORS);
-
-    // Convertir BGR → RGB
-    for (size_t i = 0; i < pixels.size(); i += 4) {
-        std::swap(pixels[i], pixels[i + 2]);
-    }
-
-    // Guardar en archivo PNG (comentado)
-    // stbi_write_png("screenshot.png", window.m_width, window.m_height, 4, pixels.data(), window.m_width * 4);
-
-    // Liberar recursos
-    DeleteDC(hMemoryDC);
-    DeleteObject(hBitmap);
-    ReleaseDC(hWnd, hDC);
-    backBuffer.m_texture->Release();
+#include <cstring>
+#include <wincodec.h>
+
+HRESULT Screenshot::init(Device& device) {
+    if (!device.m_device) {
+        ERROR("Screenshot", "init", "Device is null.");
+        return E_POINTER;
+    }
+    destroy();
+    m_device = device.m_device;
+    m_device->AddRef();
+    m_stopping = false;
+    m_encoder = std::thread(&Screenshot::encoderLoop, this);
+    return S_OK;
 }
 
-/**
- * @brief Dibuja en ImGui el popup de captura de pantalla.
- *
- * @param window       Referencia a la ventana activa.
- * @param swapChain    Cadena de intercambio asociada.
- * @param backBuffer   Textura donde se copiará el contenido del back buffer.
- *
- * @details
- * - Muestra un botón "Capture Screenshot".
- * - Abre un popup con opciones para cerrar o capturar.
- * - Llama a `captureScreenshot()` si el usuario lo confirma.
- *
- * @note
- * Esta integración permite que el jugador capture la pantalla
- * sin necesidad de salir del juego.
- */
-void Screenshot::ui(Window window, SwapChain swapChain, Texture& backBuffer) {
-    if (ImGui::Button("Capture Screenshot"))
+void Screenshot::request(const std::string& path) {
+    m_requests.push_back(path);
+}
+
+void Screenshot::update(DeviceContext& deviceContext, Texture& backBuffer) {
+    ++m_frame;
+    for (Slot& slot : m_slots) {
+        if (slot.busy && m_frame - slot.frame >= kLatencyFrames) {
+            readback(deviceContext, slot, false);
+        }
+    }
+    if (m_requests.empty() || !m_device || !backBuffer.raw()) {
+        return;
+    }
+
+    D3D11_TEXTURE2D_DESC desc;
+    backBuffer.raw()->GetDesc(&desc);
+    if (desc.SampleDesc.Count != 1 ||
+        (desc.Format != DXGI_FORMAT_R8G8B8A8_UNORM && desc.Format != DXGI_FORMAT_R8G8B8A8_UNORM_SRGB)) {
+        ERROR("Screenshot", "update", "Back buffer must be single-sample RGBA8; screenshot request dropped.");
+        m_requests.clear();
+        return;
+    }
+
+    for (Slot& slot : m_slots) {
+        if (m_requests.empty()) {
+            break;
+        }
+        if (slot.busy) {
+            continue;
+        }
+        if (!slot.staging || slot.desc.Width != desc.Width || slot.desc.Height != desc.Height ||
+            slot.desc.Format != desc.Format) {
+            SAFE_RELEASE(slot.staging);
+            slot.desc = desc;
+            slot.desc.MipLevels = 1;
+            slot.desc.ArraySize = 1;
+            slot.desc.Usage = D3D11_USAGE_STAGING;
+            slot.desc.BindFlags = 0;
+            slot.desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+            slot.desc.MiscFlags = 0;
+            if (FAILED(m_device->CreateTexture2D(&slot.desc, nullptr, &slot.staging))) {
+                ERROR("Screenshot", "update", "Failed to create a staging texture");
+                return;
+            }
+            GpuMemory::track(slot.staging);
+        }
+        deviceContext.CopySubresourceRegion(slot.staging, 0, 0, 0, 0, backBuffer.raw(), 0, nullptr);
+        slot.path = m_requests.front();
+        slot.frame = m_frame;
+        slot.busy = true;
+        m_requests.pop_front();
+    }
+}
+
+void Screenshot::flush(DeviceContext& deviceContext) {
+    for (Slot& slot : m_slots) {
+        if (slot.busy) {
+            readback(deviceContext, slot, true);
+        }
+    }
+}
+
+bool Screenshot::readback(DeviceContext& deviceContext, Slot& slot, bool wait) {
+    D3D11_MAPPED_SUBRESOURCE mapped = {};
+    HRESULT hr = deviceContext.Map(slot.staging, 0, D3D11_MAP_READ, wait ? 0 : D3D11_MAP_FLAG_DO_NOT_WAIT, &mapped);
+    if (hr == DXGI_ERROR_WAS_STILL_DRAWING) {
+        return false;
+    }
+    slot.busy = false;
+    if (FAILED(hr)) {
+        ERROR("Screenshot", "readback", ("Failed to map capture for " + slot.path).c_str());
+        return false;
+    }
+
+    Image image;
+    image.path = slot.path;
+    image.width = slot.desc.Width;
+    image.height = slot.desc.Height;
+    const size_t rowBytes = static_cast<size_t>(image.width) * 4;
+    image.pixels.resize(rowBytes * image.height);
+    for (unsigned int row = 0; row < image.height; ++row) {
+        std::memcpy(image.pixels.data() + row * rowBytes,
+            static_cast<const unsigned char*>(mapped.pData) + static_cast<size_t>(row) * mapped.RowPitch, rowBytes);
+    }
+    deviceContext.Unmap(slot.staging, 0);
+
     {
-        ImGui::OpenPopup("popup_mensaje");
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_images.push_back(std::move(image));
+    }
+    m_wake.notify_one();
+    return true;
+}
+
+void Screenshot::encoderLoop() {
+    const HRESULT com = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+    for (;;) {
+        Image image;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this] { return m_stopping || !m_images.empty(); });
+            if (m_images.empty()) {
+                break; // Parar solo con la cola vacía: lo leído se escribe.
+            }
+            image = std::move(m_images.front());
+            m_images.pop_front();
+            ++m_encoding;
+        }
+
+        HRESULT hr = writePng(image.path, image.width, image.height, image.pixels.data(), image.width * 4);
+        if (SUCCEEDED(hr)) {
+            MESSAGE("Screenshot", "encoderLoop", ("Screenshot written to " + image.path).c_str());
+        }
+        else {
+            ERROR("Screenshot", "encoderLoop", ("Failed to write " + image.path).c_str());
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        --m_encoding;
+        if (SUCCEEDED(hr)) {
+            ++m_written;
+        }
+    }
+    if (SUCCEEDED(com)) {
+        CoUninitialize();
+    }
+}
+
+HRESULT Screenshot::writePng(const std::string& path, unsigned int width, unsigned int height,
+    const unsigned char* rgba, unsigned int rowPitch) {
+    if (!rgba || width == 0 || height == 0) {
+        return E_INVALIDARG;
     }
-    if (ImGui::BeginPopup("popup_mensaje")) {
 
-        if (ImGui::Button("Close")) {
-            ImGui::CloseCurrentPopup();
+    // RGBA -> BGR (formato que el codificador PNG de WIC acepta siempre).
+    const unsigned int stride = width * 3;
+    std::vector<unsigned char> bgr(static_cast<size_t>(stride) * height);
+    for (unsigned int y = 0; y < height; ++y) {
+        const unsigned char* src = rgba + static_cast<size_t>(y) * rowPitch;
+        unsigned char* dst = bgr.data() + static_cast<size_t>(y) * stride;
+        for (unsigned int x = 0; x < width; ++x, src += 4, dst += 3) {
+            dst[0] = src[2];
+            dst[1] = src[1];
+            dst[2] = src[0];
         }
-        ImGui::SameLine();
-        if (ImGui::Button("Capture Screenshot")) {
-            captureScreenshot(window, swapChain, backBuffer);
+    }
+
+    std::wstring widePath;
+    const int size = MultiByteToWideChar(CP_ACP, 0, path.c_str(), -1, nullptr, 0);
+    if (size > 1) {
+        widePath.assign(static_cast<size_t>(size - 1), L'\0');
+        MultiByteToWideChar(CP_ACP, 0, path.c_str(), -1, &widePath[0], size);
+    }
+
+    IWICImagingFactory* factory = nullptr;
+    IWICStream* stream = nullptr;
+    IWICBitmapEncoder* encoder = nullptr;
+    IWICBitmapFrameEncode* frame = nullptr;
+    IPropertyBag2* properties = nullptr;
+
+    HRESULT hr = CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER,
+        __uuidof(IWICImagingFactory), reinterpret_cast<void**>(&factory));
+    if (SUCCEEDED(hr)) hr = factory->CreateStream(&stream);
+    if (SUCCEEDED(hr)) hr = stream->InitializeFromFilename(widePath.c_str(), GENERIC_WRITE);
+    if (SUCCEEDED(hr)) hr = factory->CreateEncoder(GUID_ContainerFormatPng, nullptr, &encoder);
+    if (SUCCEEDED(hr)) hr = encoder->Initialize(stream, WICBitmapEncoderNoCache);
+    if (SUCCEEDED(hr)) hr = encoder->CreateNewFrame(&frame, &properties);
+    if (SUCCEEDED(hr)) hr = frame->Initialize(properties);
+    if (SUCCEEDED(hr)) hr = frame->SetSize(width, height);
+    WICPixelFormatGUID format = GUID_WICPixelFormat24bppBGR;
+    if (SUCCEEDED(hr)) hr = frame->SetPixelFormat(&format);
+    if (SUCCEEDED(hr) && format != GUID_WICPixelFormat24bppBGR) hr = E_FAIL;
+    if (SUCCEEDED(hr)) hr = frame->WritePixels(height, stride, static_cast<UINT>(bgr.size()), bgr.data());
+    if (SUCCEEDED(hr)) hr = frame->Commit();
+    if (SUCCEEDED(hr)) hr = encoder->Commit();
+
+    SAFE_RELEASE(properties);
+    SAFE_RELEASE(frame);
+    SAFE_RELEASE(encoder);
+    SAFE_RELEASE(stream);
+    SAFE_RELEASE(factory);
+    return hr;
+}
+
+unsigned int Screenshot::getPendingCount() const {
+    unsigned int pending = static_cast<unsigned int>(m_requests.size());
+    for (const Slot& slot : m_slots) {
+        if (slot.busy) {
+            ++pending;
         }
-        ImGui::EndPopup();
     }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return pending + static_cast<unsigned int>(m_images.size()) + m_encoding;
+}
+
+unsigned long long Screenshot::getWrittenCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_written;
+}
+
+void Screenshot::destroy() {
+    if (m_encoder.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_wake.notify_all();
+        m_encoder.join();
+    }
+    for (Slot& slot : m_slots) {
+        SAFE_RELEASE(slot.staging);
+        slot.busy = false;
+    }
+    m_requests.clear();
+    m_images.clear();
+    SAFE_RELEASE(m_device);
 }
@@ -0,0 +1,250 @@
+﻿/**
+ * @file ShaderHotReload.cpp
+ * @brief Vigilancia de la carpeta de shaders, recompilación en un hilo y sustitución entre frames.
+ */
+
+#include "ShaderHotReload.h"
+#include "Device.h"
+#include <cwctype>
+
+namespace {
+    /// Tamaño del buffer de notificaciones (en DWORDs).
+    const size_t kNotifyBufferWords = 16 * 1024;
+
+    /// Extensiones que pueden afectar a un shader compilado.
+    bool isShaderSource(const std::wstring& name) {
+        const size_t dot = name.find_last_of(L'.');
+        if (dot == std::wstring::npos) {
+            return false;
+        }
+        std::wstring extension = name.substr(dot + 1);
+        for (wchar_t& c : extension) {
+            c = static_cast<wchar_t>(towlower(c));
+        }
+        return extension == L"fx" || extension == L"fxh" || extension == L"hlsl" || extension == L"hlsli";
+    }
+}
+
+HRESULT ShaderHotReload::init(Device& device, const std::string& directory) {
+    if (!device.m_device) {
+        ERROR("ShaderHotReload", "init", "Device is null.");
+        return E_POINTER;
+    }
+    destroy();
+
+    m_directoryHandle = CreateFileA(directory.c_str(), FILE_LIST_DIRECTORY,
+        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+        FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+    if (m_directoryHandle == INVALID_HANDLE_VALUE) {
+        const HRESULT hr = HRESULT_FROM_WIN32(GetLastError());
+        ERROR("ShaderHotReload", "init", ("Cannot open shader directory: " + directory).c_str());
+        return hr;
+    }
+    m_changeEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+    m_requestEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    m_stopEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+    m_notifyBuffer.assign(kNotifyBufferWords, 0);
+    m_overlapped = OVERLAPPED();
+    m_overlapped.hEvent = m_changeEvent;
+    if (!m_changeEvent || !m_requestEvent || !m_stopEvent || !watch()) {
+        ERROR("ShaderHotReload", "init", "Cannot watch the shader directory.");
+        destroy();
+        return E_FAIL;
+    }
+
+    m_device = &device;
+    m_directory = directory;
+    m_changed = false;
+    m_busy = false;
+    m_thread = std::thread(&ShaderHotReload::threadLoop, this);
+    MESSAGE("ShaderHotReload", "init", ("Watching shaders in " + directory).c_str());
+    return S_OK;
+}
+
+bool ShaderHotReload::watch() {
+    ResetEvent(m_changeEvent);
+    return ReadDirectoryChangesW(m_directoryHandle, m_notifyBuffer.data(),
+        static_cast<DWORD>(m_notifyBuffer.size() * sizeof(DWORD)), TRUE,
+        FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME, nullptr,
+        &m_overlapped, nullptr) != FALSE;
+}
+
+bool ShaderHotReload::readChanges() {
+    DWORD bytes = 0;
+    if (!GetOverlappedResult(m_directoryHandle, &m_overlapped, &bytes, FALSE)) {
+        return false;
+    }
+    // 0 bytes: el buffer se desbordó y se perdió el detalle; se trata como un cambio.
+    if (bytes == 0) {
+        return true;
+    }
+    bool shaderChanged = false;
+    const unsigned char* cursor = reinterpret_cast<const unsigned char*>(m_notifyBuffer.data());
+    for (;;) {
+        const FILE_NOTIFY_INFORMATION* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(cursor);
+        const std::wstring name(info->FileName, info->FileNameLength / sizeof(WCHAR));
+        shaderChanged = shaderChanged || isShaderSource(name);
+        if (info->NextEntryOffset == 0) {
+            break;
+        }
+        cursor += info->NextEntryOffset;
+    }
+    return shaderChanged;
+}
+
+/**
+ * @details
+ * Un solo hilo vigila y compila: mientras compila, el sistema sigue acumulando los
+ * cambios de la carpeta y se leen en la siguiente vuelta.
+ */
+void ShaderHotReload::threadLoop() {
+    HANDLE events[3] = { m_stopEvent, m_changeEvent, m_requestEvent };
+    bool settling = false;
+    for (;;) {
+        const DWORD signaled = WaitForMultipleObjects(3, events, FALSE, settling ? kSettleMs : INFINITE);
+        if (signaled == WAIT_OBJECT_0) {
+            break;
+        }
+        if (signaled == WAIT_TIMEOUT) {
+            // Ya no llegan escrituras: el hilo principal pedirá la comparación.
+            settling = false;
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_changed = true;
+            continue;
+        }
+        if (signaled == WAIT_OBJECT_0 + 1) {
+            settling = readChanges() || settling;
+            if (!watch()) {
+                ERROR("ShaderHotReload", "threadLoop", "ReadDirectoryChangesW failed; hot reload stopped.");
+                break;
+            }
+            continue;
+        }
+        if (signaled == WAIT_OBJECT_0 + 2) {
+            std::vector<ShaderLibrary::Variant> variants;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                variants.swap(m_requests);
+            }
+            compileChanged(variants);
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_busy = false;
+            continue;
+        }
+        ERROR("ShaderHotReload", "threadLoop", "Wait failed; hot reload stopped.");
+        break;
+    }
+}
+
+void ShaderHotReload::compileChanged(const std::vector<ShaderLibrary::Variant>& variants) {
+    for (const ShaderLibrary::Variant& variant : variants) {
+        if (WaitForSingleObject(m_stopEvent, 0) == WAIT_OBJECT_0) {
+            return;
+        }
+        uint64_t hash = 0;
+        if (!ShaderLibrary::hashSource(variant.key, hash) || hash == variant.sourceHash) {
+            continue;
+        }
+        Result result;
+        result.key = variant.key;
+        result.sourceHash = hash;
+        result.bytecode = nullptr;
+        ShaderLibrary::compile(variant.key, &result.bytecode, &result.errors);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_results.push_back(result);
+    }
+}
+
+unsigned int ShaderHotReload::update() {
+    if (!m_device) {
+        return 0;
+    }
+    std::vector<Result> finished;
+    bool request = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        finished.swap(m_results);
+        request = m_changed && !m_busy;
+    }
+
+    unsigned int replaced = 0;
+    ShaderLibrary& library = m_device->getShaderLibrary();
+    for (Result& result : finished) {
+        const std::string id = result.key.toString();
+        if (!result.bytecode) {
+            log(result.errors.empty() ? "Failed to compile " + id : result.errors, true);
+            continue;
+        }
+        if (SUCCEEDED(library.replace(*m_device, result.key, result.bytecode, result.sourceHash))) {
+            log("Reloaded " + id, false);
+            ++replaced;
+        }
+        else {
+            log("Compiled but could not create " + id + "; keeping the old shader", true);
+        }
+        SAFE_RELEASE(result.bytecode);
+    }
+    m_reloadCount += replaced;
+
+    if (request) {
+        // Solo vertex y pixel shaders: son los que tienen programas que recargar.
+        std::vector<ShaderLibrary::Variant> variants;
+        for (const ShaderLibrary::Variant& variant : library.getVariants()) {
+            if (variant.type == VERTEX_SHADER || variant.type == PIXEL_SHADER) {
+                variants.push_back(variant);
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_requests.swap(variants);
+            m_changed = false;
+            m_busy = true;
+        }
+        SetEvent(m_requestEvent);
+    }
+    return replaced;
+}
+
+bool ShaderHotReload::isCompiling() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_busy;
+}
+
+void ShaderHotReload::log(const std::string& text, bool error) {
+    if (error) {
+        ERROR("ShaderHotReload", "update", text.c_str());
+    }
+    LogLine line = { text, error };
+    m_log.push_back(line);
+    while (m_log.size() > kMaxLogLines) {
+        m_log.pop_front();
+    }
+}
+
+void ShaderHotReload::destroy() {
+    if (m_thread.joinable()) {
+        SetEvent(m_stopEvent);
+        m_thread.join();
+    }
+    if (m_directoryHandle != INVALID_HANDLE_VALUE) {
+        // La lectura pendiente escribe en `m_notifyBuffer`: se cancela antes de soltarlo.
+        if (CancelIoEx(m_directoryHandle, &m_overlapped)) {
+            DWORD bytes = 0;
+            GetOverlappedResult(m_directoryHandle, &m_overlapped, &bytes, TRUE);
+        }
+        CloseHandle(m_directoryHandle);
+        m_directoryHandle = INVALID_HANDLE_VALUE;
+    }
+    if (m_changeEvent) { CloseHandle(m_changeEvent); m_changeEvent = nullptr; }
+    if (m_requestEvent) { CloseHandle(m_requestEvent); m_requestEvent = nullptr; }
+    if (m_stopEvent) { CloseHandle(m_stopEvent); m_stopEvent = nullptr; }
+    for (Result& result : m_results) {
+        SAFE_RELEASE(result.bytecode);
+    }
+    m_results.clear();
+    m_requests.clear();
+    m_notifyBuffer.clear();
+    m_changed = false;
+    m_busy = false;
+    m_device = nullptr;
+}
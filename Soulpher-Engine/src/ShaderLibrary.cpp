@@ -0,0 +1,584 @@
+﻿/**
+ * @file ShaderLibrary.cpp
+ * @brief Implementación de la biblioteca de shaders compartidos.
+ */
+
+#include "ShaderLibrary.h"
+#include "ConstantBufferLayout.h"
+#include "Device.h"
+#include "ShaderProgram.h"
+#include "StartupTimeline.h"
+#include "VirtualFileSystem.h"
+#include <fstream>
+#include <memory>
+
+namespace {
+    /// Fuentes y bytecode pueden venir de un paquete (@ref VirtualFileSystem).
+    bool readFile(const std::string& path, std::string& out) {
+        FileView file;
+        if (!VirtualFileSystem::getDefault().open(path, file)) {
+            return false;
+        }
+        out.assign(reinterpret_cast<const char*>(file.getData()), file.getSize());
+        return true;
+    }
+
+    /// Directorio de `path` con separador final ("" si no tiene).
+    std::string directoryOf(const std::string& path) {
+        size_t slash = path.find_last_of("/\\");
+        return (slash == std::string::npos) ? std::string() : path.substr(0, slash + 1);
+    }
+
+    /**
+     * `D3DCompile` recibe el código en memoria: los `#include "..."` se leen aquí,
+     * relativos al archivo que los contiene (el mismo criterio que `hashFile`).
+     */
+    class IncludeHandler : public ID3DInclude {
+    public:
+        explicit IncludeHandler(const std::string& rootDirectory) : m_rootDirectory(rootDirectory) {}
+
+        HRESULT __stdcall Open(D3D_INCLUDE_TYPE, LPCSTR pFileName, LPCVOID pParentData,
+            LPCVOID* ppData, UINT* pBytes) override {
+            auto parent = m_open.find(pParentData);
+            const std::string& directory = (parent != m_open.end()) ? parent->second.directory : m_rootDirectory;
+            const std::string path = directory + pFileName;
+
+            File file;
+            file.source.reset(new std::string());
+            if (!readFile(path, *file.source)) {
+                return E_FAIL;
+            }
+            file.directory = directoryOf(path);
+            *ppData = file.source->data();
+            *pBytes = static_cast<UINT>(file.source->size());
+            m_open[*ppData] = std::move(file);
+            return S_OK;
+        }
+
+        HRESULT __stdcall Close(LPCVOID pData) override {
+            m_open.erase(pData);
+            return S_OK;
+        }
+
+    private:
+        struct File {
+            std::unique_ptr<std::string> source; ///< En el heap: `data()` no se mueve con el mapa.
+            std::string directory;
+        };
+        std::string m_rootDirectory;
+        std::map<LPCVOID, File> m_open;
+    };
+}
+
+std::string ShaderKey::toString() const {
+    std::vector<ShaderDefine> sorted = defines;
+    std::sort(sorted.begin(), sorted.end(),
+        [](const ShaderDefine& a, const ShaderDefine& b) { return a.name < b.name; });
+
+    std::string result = fileName + "|" + entryPoint + "|" + profile + "|";
+    for (const auto& define : sorted) {
+        result += define.name + "=" + define.value + ";";
+    }
+    return result;
+}
+
+HRESULT ShaderLibrary::compile(const ShaderKey& key, ID3DBlob** ppBlobOut, std::string* errors) {
+    if (!ppBlobOut) {
+        ERROR("ShaderLibrary", "compile", "ppBlobOut is nullptr");
+        return E_POINTER;
+    }
+
+    DWORD dwShaderFlags = compileFlags();
+
+    std::string source;
+    if (!readFile(key.fileName, source)) {
+        ERROR("ShaderLibrary", "compile", ("Cannot read shader file: " + key.fileName).c_str());
+        return HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND);
+    }
+
+    // Lista de macros terminada en { nullptr, nullptr } como pide D3DCompile.
+    std::vector<D3D_SHADER_MACRO> macros;
+    macros.reserve(key.defines.size() + 1);
+    for (const auto& define : key.defines) {
+        D3D_SHADER_MACRO macro = { define.name.c_str(), define.value.c_str() };
+        macros.push_back(macro);
+    }
+    D3D_SHADER_MACRO terminator = { nullptr, nullptr };
+    macros.push_back(terminator);
+
+    IncludeHandler includes(directoryOf(key.fileName));
+    ID3DBlob* pErrorBlob = nullptr;
+    HRESULT hr = D3DCompile(source.data(),
+        source.size(),
+        key.fileName.c_str(),
+        macros.data(),
+        &includes,
+        key.entryPoint.c_str(),
+        key.profile.c_str(),
+        dwShaderFlags,
+        0,
+        ppBlobOut,
+        &pErrorBlob);
+
+    if (FAILED(hr)) {
+        std::string message = "Failed to compile " + key.toString();
+        if (pErrorBlob) {
+            message += ". Error: ";
+            message += static_cast<const char*>(pErrorBlob->GetBufferPointer());
+        }
+        ERROR("ShaderLibrary", "compile", message.c_str());
+        if (errors) {
+            *errors = message;
+        }
+    }
+    SAFE_RELEASE(pErrorBlob);
+    return hr;
+}
+
+ShaderLibrary::Entry* ShaderLibrary::acquire(Device& device, const ShaderKey& key,
+    ShaderType type, HRESULT& hr) {
+    const std::string id = key.toString();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_entries.find(id);
+        if (it != m_entries.end()) {
+            ++m_hits;
+            hr = S_OK;
+            return &it->second;
+        }
+    }
+
+    Entry entry;
+    entry.key = key;
+    entry.type = type;
+    hr = loadOrCompile(key, &entry.bytecode, entry.sourceHash);
+    if (FAILED(hr)) {
+        return nullptr;
+    }
+    // También el bytecode de la caché: el struct de C++ puede haber cambiado sin el .fx.
+    hr = ConstantBufferLayouts::getDefault().validate(key, entry.bytecode);
+    if (FAILED(hr)) {
+        SAFE_RELEASE(entry.bytecode);
+        return nullptr;
+    }
+    hr = createShader(device, entry);
+    if (FAILED(hr)) {
+        SAFE_RELEASE(entry.bytecode);
+        return nullptr;
+    }
+
+    // Solo el VS necesita conservar el bytecode (firma para Input Layouts).
+    if (type != VERTEX_SHADER) {
+        SAFE_RELEASE(entry.bytecode);
+    }
+
+    // Otro hilo pudo compilar la misma variante mientras tanto: gana la primera.
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto inserted = m_entries.emplace(id, entry);
+    if (!inserted.second) {
+        release(entry);
+        return &inserted.first->second;
+    }
+    MESSAGE("ShaderLibrary", "acquire", ("Compiled " + id).c_str());
+    return &inserted.first->second;
+}
+
+HRESULT ShaderLibrary::createShader(Device& device, Entry& entry) {
+    const void* code = entry.bytecode->GetBufferPointer();
+    const unsigned int size = static_cast<unsigned int>(entry.bytecode->GetBufferSize());
+    switch (entry.type) {
+    case PIXEL_SHADER:
+        return device.CreatePixelShader(code, size, nullptr, &entry.pixelShader);
+    case COMPUTE_SHADER:
+        return device.CreateComputeShader(code, size, nullptr, &entry.computeShader);
+    case GEOMETRY_SHADER:
+        return device.CreateGeometryShader(code, size, nullptr, &entry.geometryShader);
+    case HULL_SHADER:
+        return device.CreateHullShader(code, size, nullptr, &entry.hullShader);
+    case DOMAIN_SHADER:
+        return device.CreateDomainShader(code, size, nullptr, &entry.domainShader);
+    default:
+        return device.CreateVertexShader(code, size, nullptr, &entry.vertexShader);
+    }
+}
+
+void ShaderLibrary::release(Entry& entry) {
+    SAFE_RELEASE(entry.vertexShader);
+    SAFE_RELEASE(entry.pixelShader);
+    SAFE_RELEASE(entry.computeShader);
+    SAFE_RELEASE(entry.geometryShader);
+    SAFE_RELEASE(entry.hullShader);
+    SAFE_RELEASE(entry.domainShader);
+    SAFE_RELEASE(entry.bytecode);
+}
+
+HRESULT ShaderLibrary::cookToDisk(const ShaderKey& key, std::string& cachePath) {
+    uint64_t hash = 0;
+    if (!hashSource(key, hash)) {
+        ERROR("ShaderLibrary", "cookToDisk", ("Cannot read shader source: " + key.fileName).c_str());
+        return HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND);
+    }
+    cachePath = getCachePath(hash);
+    if (GetFileAttributesA(cachePath.c_str()) != INVALID_FILE_ATTRIBUTES) {
+        return S_FALSE;
+    }
+    ID3DBlob* bytecode = nullptr;
+    HRESULT hr = compile(key, &bytecode);
+    if (SUCCEEDED(hr)) {
+        hr = ConstantBufferLayouts::getDefault().validate(key, bytecode);
+    }
+    if (FAILED(hr)) {
+        SAFE_RELEASE(bytecode);
+        return hr;
+    }
+    saveToCache(hash, bytecode);
+    SAFE_RELEASE(bytecode);
+    return S_OK;
+}
+
+std::vector<ShaderLibrary::Variant> ShaderLibrary::getVariants() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<Variant> variants;
+    variants.reserve(m_entries.size());
+    for (const auto& pair : m_entries) {
+        Variant variant = { pair.second.key, pair.second.type, pair.second.sourceHash };
+        variants.push_back(variant);
+    }
+    return variants;
+}
+
+/**
+ * @details
+ * Quien ya tenía el objeto anterior conserva su referencia y sigue siendo válido;
+ * los programas registrados piden el nuevo aquí mismo, el resto al volver a pedirlo.
+ */
+HRESULT ShaderLibrary::replace(Device& device, const ShaderKey& key, ID3DBlob* bytecode, uint64_t sourceHash) {
+    if (!bytecode) {
+        ERROR("ShaderLibrary", "replace", "bytecode is nullptr");
+        return E_POINTER;
+    }
+    const std::string id = key.toString();
+    // Un .fx editado en caliente con otro layout no llega a sustituir a la variante buena.
+    HRESULT hr = ConstantBufferLayouts::getDefault().validate(key, bytecode);
+    if (FAILED(hr)) {
+        return hr;
+    }
+    std::unique_lock<std::mutex> lock(m_mutex);
+    auto it = m_entries.find(id);
+    if (it == m_entries.end()) {
+        ERROR("ShaderLibrary", "replace", ("Variant not loaded: " + id).c_str());
+        return E_INVALIDARG;
+    }
+
+    Entry fresh;
+    fresh.key = it->second.key;
+    fresh.type = it->second.type;
+    fresh.sourceHash = sourceHash;
+    fresh.bytecode = bytecode;
+    bytecode->AddRef();
+    hr = createShader(device, fresh);
+    if (FAILED(hr)) {
+        ERROR("ShaderLibrary", "replace", ("Failed to create reloaded shader: " + id).c_str());
+        release(fresh);
+        return hr;
+    }
+    if (m_diskCache) {
+        saveToCache(sourceHash, bytecode);
+    }
+    if (fresh.type != VERTEX_SHADER) {
+        SAFE_RELEASE(fresh.bytecode);
+    }
+    release(it->second);
+    it->second = fresh;
+    // Los programas vuelven a pedir su variante a la biblioteca: fuera del cerrojo.
+    const std::vector<ShaderProgram*> programs = m_programs;
+    lock.unlock();
+
+    for (ShaderProgram* program : programs) {
+        program->reload(device, id);
+    }
+    MESSAGE("ShaderLibrary", "replace", ("Reloaded " + id).c_str());
+    return S_OK;
+}
+
+void ShaderLibrary::addProgram(ShaderProgram* program) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (program && std::find(m_programs.begin(), m_programs.end(), program) == m_programs.end()) {
+        m_programs.push_back(program);
+    }
+}
+
+void ShaderLibrary::removeProgram(ShaderProgram* program) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_programs.erase(std::remove(m_programs.begin(), m_programs.end(), program), m_programs.end());
+}
+
+HRESULT ShaderLibrary::getVertexShader(Device& device, const ShaderKey& key,
+    ID3D11VertexShader** ppShader, ID3DBlob** ppBytecode) {
+    if (!ppShader) {
+        ERROR("ShaderLibrary", "getVertexShader", "ppShader is nullptr");
+        return E_POINTER;
+    }
+
+    HRESULT hr = S_OK;
+    Entry* entry = acquire(device, key, VERTEX_SHADER, hr);
+    if (!entry) {
+        return hr;
+    }
+    if (!entry->vertexShader) {
+        ERROR("ShaderLibrary", "getVertexShader", ("Not a vertex shader: " + key.toString()).c_str());
+        return E_INVALIDARG;
+    }
+
+    entry->vertexShader->AddRef();
+    *ppShader = entry->vertexShader;
+    if (ppBytecode) {
+        entry->bytecode->AddRef();
+        *ppBytecode = entry->bytecode;
+    }
+    return S_OK;
+}
+
+HRESULT ShaderLibrary::getPixelShader(Device& device, const ShaderKey& key,
+    ID3D11PixelShader** ppShader) {
+    if (!ppShader) {
+        ERROR("ShaderLibrary", "getPixelShader", "ppShader is nullptr");
+        return E_POINTER;
+    }
+
+    HRESULT hr = S_OK;
+    Entry* entry = acquire(device, key, PIXEL_SHADER, hr);
+    if (!entry) {
+        return hr;
+    }
+    if (!entry->pixelShader) {
+        ERROR("ShaderLibrary", "getPixelShader", ("Not a pixel shader: " + key.toString()).c_str());
+        return E_INVALIDARG;
+    }
+
+    entry->pixelShader->AddRef();
+    *ppShader = entry->pixelShader;
+    return S_OK;
+}
+
+HRESULT ShaderLibrary::loadOrCompile(const ShaderKey& key, ID3DBlob** ppBlobOut, uint64_t& hash) {
+    StartupTimeline::Scope timelineScope("Shader", key.toString());
+    // El hash se calcula aunque no haya caché en disco: la recarga en caliente lo compara.
+    if (!hashSource(key, hash)) {
+        hash = 0;
+        return compile(key, ppBlobOut);
+    }
+    if (!m_diskCache) {
+        return compile(key, ppBlobOut);
+    }
+
+    const std::string cachePath = getCachePath(hash);
+
+    // Acierto: el bytecode ya compilado va directo a Create*Shader.
+    std::string bytecode;
+    if (readFile(cachePath, bytecode) && !bytecode.empty()) {
+        HRESULT hr = D3DCreateBlob(bytecode.size(), ppBlobOut);
+        if (SUCCEEDED(hr)) {
+            memcpy((*ppBlobOut)->GetBufferPointer(), bytecode.data(), bytecode.size());
+            ++m_diskHits;
+            StartupTimeline::getDefault().recordCache(STARTUP_CACHE_SHADER, true);
+            return S_OK;
+        }
+    }
+
+    StartupTimeline::getDefault().recordCache(STARTUP_CACHE_SHADER, false);
+    HRESULT hr = compile(key, ppBlobOut);
+    if (FAILED(hr)) {
+        return hr;
+    }
+
+    // Guardar para el próximo arranque.
+    saveToCache(hash, *ppBlobOut);
+    return S_OK;
+}
+
+std::string ShaderLibrary::getCachePath(uint64_t hash) const {
+    char name[17];
+    sprintf_s(name, "%016llx", static_cast<unsigned long long>(hash));
+    return m_cacheDirectory + "\\" + name + ".cso";
+}
+
+void ShaderLibrary::saveToCache(uint64_t hash, ID3DBlob* bytecode) const {
+    const std::string cachePath = getCachePath(hash);
+
+    CreateDirectoryA(m_cacheDirectory.c_str(), nullptr);
+    std::ofstream file(cachePath.c_str(), std::ios::binary | std::ios::trunc);
+    if (file) {
+        file.write(static_cast<const char*>(bytecode->GetBufferPointer()),
+            static_cast<std::streamsize>(bytecode->GetBufferSize()));
+    }
+    else {
+        ERROR("ShaderLibrary", "saveToCache", ("Cannot write shader cache: " + cachePath).c_str());
+    }
+}
+
+bool ShaderLibrary::hashSource(const ShaderKey& key, uint64_t& hash) {
+    hash = EU::kFnv1aSeed;
+
+    const std::string id = key.toString();
+    EU::Fnv1a(hash, id.data(), id.size());
+    const DWORD flags = compileFlags();
+    EU::Fnv1a(hash, &flags, sizeof(flags));
+
+    std::set<std::string> visited;
+    return hashFile(key.fileName, hash, visited);
+}
+
+bool ShaderLibrary::hashFile(const std::string& path, uint64_t& hash, std::set<std::string>& visited) {
+    if (!visited.insert(path).second) {
+        return true;
+    }
+
+    std::string source;
+    if (!readFile(path, source)) {
+        return false;
+    }
+    EU::Fnv1a(hash, source.data(), source.size());
+
+    // Seguir los #include "archivo" relativos al archivo actual.
+    const std::string directory = directoryOf(path);
+    size_t pos = 0;
+    while ((pos = source.find("#include", pos)) != std::string::npos) {
+        pos += 8;
+        size_t open = source.find_first_of("\"\n", pos);
+        if (open == std::string::npos || source[open] != '"') {
+            continue;
+        }
+        size_t close = source.find('"', open + 1);
+        if (close == std::string::npos) {
+            break;
+        }
+        if (!hashFile(directory + source.substr(open + 1, close - open - 1), hash, visited)) {
+            return false;
+        }
+        pos = close + 1;
+    }
+    return true;
+}
+
+DWORD ShaderLibrary::compileFlags() {
+    DWORD dwShaderFlags = D3DCOMPILE_ENABLE_STRICTNESS;
+#if defined( DEBUG ) || defined( _DEBUG )
+    dwShaderFlags |= D3DCOMPILE_DEBUG;
+#else
+    dwShaderFlags |= D3DCOMPILE_OPTIMIZATION_LEVEL3;
+#endif
+    return dwShaderFlags;
+}
+
+std::string ShaderLibrary::profile(ShaderType type, D3D_FEATURE_LEVEL featureLevel) {
+    const bool sm5 = featureLevel >= D3D_FEATURE_LEVEL_11_0;
+    const char* model = sm5 ? "_5_0" : (featureLevel >= D3D_FEATURE_LEVEL_10_1 ? "_4_1" : "_4_0");
+    switch (type) {
+    case PIXEL_SHADER:    return std::string("ps") + model;
+    case COMPUTE_SHADER:  return std::string("cs") + model;
+    case GEOMETRY_SHADER: return std::string("gs") + model;
+    case HULL_SHADER:     return sm5 ? "hs_5_0" : "";
+    case DOMAIN_SHADER:   return sm5 ? "ds_5_0" : "";
+    default:              return std::string("vs") + model;
+    }
+}
+
+HRESULT ShaderLibrary::getComputeShader(Device& device, const ShaderKey& key,
+    ID3D11ComputeShader** ppShader) {
+    if (!ppShader) {
+        ERROR("ShaderLibrary", "getComputeShader", "ppShader is nullptr");
+        return E_POINTER;
+    }
+
+    HRESULT hr = S_OK;
+    Entry* entry = acquire(device, key, COMPUTE_SHADER, hr);
+    if (!entry) {
+        return hr;
+    }
+    if (!entry->computeShader) {
+        ERROR("ShaderLibrary", "getComputeShader", ("Not a compute shader: " + key.toString()).c_str());
+        return E_INVALIDARG;
+    }
+
+    entry->computeShader->AddRef();
+    *ppShader = entry->computeShader;
+    return S_OK;
+}
+
+HRESULT ShaderLibrary::getGeometryShader(Device& device, const ShaderKey& key,
+    ID3D11GeometryShader** ppShader) {
+    if (!ppShader) {
+        ERROR("ShaderLibrary", "getGeometryShader", "ppShader is nullptr");
+        return E_POINTER;
+    }
+
+    HRESULT hr = S_OK;
+    Entry* entry = acquire(device, key, GEOMETRY_SHADER, hr);
+    if (!entry) {
+        return hr;
+    }
+    if (!entry->geometryShader) {
+        ERROR("ShaderLibrary", "getGeometryShader", ("Not a geometry shader: " + key.toString()).c_str());
+        return E_INVALIDARG;
+    }
+
+    entry->geometryShader->AddRef();
+    *ppShader = entry->geometryShader;
+    return S_OK;
+}
+
+HRESULT ShaderLibrary::getHullShader(Device& device, const ShaderKey& key,
+    ID3D11HullShader** ppShader) {
+    if (!ppShader) {
+        ERROR("ShaderLibrary", "getHullShader", "ppShader is nullptr");
+        return E_POINTER;
+    }
+
+    HRESULT hr = S_OK;
+    Entry* entry = acquire(device, key, HULL_SHADER, hr);
+    if (!entry) {
+        return hr;
+    }
+    if (!entry->hullShader) {
+        ERROR("ShaderLibrary", "getHullShader", ("Not a hull shader: " + key.toString()).c_str());
+        return E_INVALIDARG;
+    }
+
+    entry->hullShader->AddRef();
+    *ppShader = entry->hullShader;
+    return S_OK;
+}
+
+HRESULT ShaderLibrary::getDomainShader(Device& device, const ShaderKey& key,
+    ID3D11DomainShader** ppShader) {
+    if (!ppShader) {
+        ERROR("ShaderLibrary", "getDomainShader", "ppShader is nullptr");
+        return E_POINTER;
+    }
+
+    HRESULT hr = S_OK;
+    Entry* entry = acquire(device, key, DOMAIN_SHADER, hr);
+    if (!entry) {
+        return hr;
+    }
+    if (!entry->domainShader) {
+        ERROR("ShaderLibrary", "getDomainShader", ("Not a domain shader: " + key.toString()).c_str());
+        return E_INVALIDARG;
+    }
+
+    entry->domainShader->AddRef();
+    *ppShader = entry->domainShader;
+    return S_OK;
+}
+
+void ShaderLibrary::destroy() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& pair : m_entries) {
+        release(pair.second);
+    }
+    m_entries.clear();
+    m_programs.clear();
+    m_hits = 0;
+    m_diskHits = 0;
+}
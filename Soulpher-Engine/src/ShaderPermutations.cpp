@@ -0,0 +1,134 @@
+﻿/**
+ * @file ShaderPermutations.cpp
+ * @brief Implementación de las variantes por palabras clave.
+ */
+
+#include "ShaderPermutations.h"
+#include "Device.h"
+#include <fstream>
+#include <sstream>
+
+HRESULT ShaderPermutations::init(Device& device, const std::string& fileName,
+    const std::vector<std::string>& keywords, LayoutBuilder layout) {
+    if (!device.m_device) {
+        ERROR("ShaderPermutations", "init", "Device is null.");
+        return E_POINTER;
+    }
+    if (fileName.empty() || !layout || keywords.size() > kMaxKeywords) {
+        ERROR("ShaderPermutations", "init", "Invalid file name, layout or keyword count.");
+        return E_INVALIDARG;
+    }
+    destroy();
+    m_device = &device;
+    m_fileName = fileName;
+    m_keywords = keywords;
+    m_layout = layout;
+    return S_OK;
+}
+
+ShaderPermutations::Features ShaderPermutations::feature(const std::string& keyword) const {
+    for (size_t i = 0; i < m_keywords.size(); ++i) {
+        if (m_keywords[i] == keyword) {
+            return Features(1) << i;
+        }
+    }
+    return 0;
+}
+
+std::vector<ShaderDefine> ShaderPermutations::definesFor(Features features) const {
+    std::vector<ShaderDefine> defines;
+    for (size_t i = 0; i < m_keywords.size(); ++i) {
+        if (features & (Features(1) << i)) {
+            defines.push_back({ m_keywords[i], "1" });
+        }
+    }
+    return defines;
+}
+
+std::vector<ShaderKey> ShaderPermutations::getKeys(Features features) const {
+    std::vector<ShaderKey> keys;
+    if (!m_device) {
+        return keys;
+    }
+    const D3D_FEATURE_LEVEL level = m_device->m_device->GetFeatureLevel();
+    for (ShaderType type : { ShaderType::VERTEX_SHADER, ShaderType::PIXEL_SHADER }) {
+        ShaderKey key;
+        key.fileName = m_fileName;
+        key.entryPoint = (type == ShaderType::PIXEL_SHADER) ? "PS" : "VS";
+        key.profile = ShaderLibrary::profile(type, level);
+        key.defines = definesFor(features);
+        keys.push_back(key);
+    }
+    return keys;
+}
+
+ShaderProgram* ShaderPermutations::get(Features features) {
+    if (!m_device) {
+        return nullptr;
+    }
+    auto found = m_variants.find(features);
+    if (found != m_variants.end()) {
+        return &found->second;
+    }
+    if (m_failed.count(features)) {
+        return nullptr;
+    }
+
+    ShaderProgram& program = m_variants[features];
+    HRESULT hr = program.init(*m_device, m_fileName, m_layout(features), definesFor(features));
+    if (FAILED(hr)) {
+        std::string name = m_fileName;
+        for (const ShaderDefine& define : definesFor(features)) {
+            name += " " + define.name;
+        }
+        ERROR("ShaderPermutations", "get", ("Failed to compile variant: " + name).c_str());
+        program.destroy();
+        m_variants.erase(features);
+        m_failed.insert(features);
+        return nullptr;
+    }
+    return &program;
+}
+
+unsigned int ShaderPermutations::precompile(const std::string& listPath) {
+    std::ifstream file(listPath);
+    if (!file) {
+        ERROR("ShaderPermutations", "precompile", ("Cannot open variant list: " + listPath).c_str());
+        return 0;
+    }
+    unsigned int compiled = 0;
+    std::string line;
+    while (std::getline(file, line)) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream words(line);
+        std::string fileName;
+        if (!(words >> fileName) || fileName != m_fileName) {
+            continue;
+        }
+        Features features = 0;
+        bool known = true;
+        std::string keyword;
+        while (words >> keyword) {
+            const Features bit = feature(keyword);
+            if (!bit) {
+                ERROR("ShaderPermutations", "precompile", ("Unknown keyword: " + keyword).c_str());
+                known = false;
+                break;
+            }
+            features |= bit;
+        }
+        if (known && !m_variants.count(features) && get(features)) {
+            ++compiled;
+        }
+    }
+    return compiled;
+}
+
+void ShaderPermutations::destroy() {
+    for (auto& variant : m_variants) {
+        variant.second.destroy();
+    }
+    m_variants.clear();
+    m_failed.clear();
+    m_device = nullptr;
+}
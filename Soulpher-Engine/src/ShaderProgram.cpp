@@ -18,11 +18,20 @@ HRESULT
 ShaderProgram::init(Device& device,
     const std::string& fileName,
     std::vector<D3D11_INPUT_ELEMENT_DESC> Layout) {
+    return init(device, fileName, Layout, std::vector<ShaderDefine>());
+}
+
+HRESULT
+ShaderProgram::init(Device& device,
+    const std::string& fileName,
+    std::vector<D3D11_INPUT_ELEMENT_DESC> Layout,
+    const std::vector<ShaderDefine>& defines) {
     /**
      * @brief Inicializa el programa de shaders con un Vertex Shader, Pixel Shader y su Input Layout.
      * @param device Referencia al dispositivo Direct3D 11.
      * @param fileName Ruta del archivo HLSL.
      * @param Layout Descripcin de los elementos de entrada (Input Layout).
+     * @param defines Macros de la variante (vaco = sin macros).
      * @return HRESULT S_OK si se inicializ correctamente, o cdigo de error en caso contrario.
      */
     if (!device.m_device) {
@@ -38,6 +47,7 @@ ShaderProgram::init(Device& device,
         return E_INVALIDARG;
     }
     m_shaderFileName = fileName;
+    m_defines = defines;
 
     // Crear Vertex Shader
     HRESULT hr = CreateShader(device, ShaderType::VERTEX_SHADER);
@@ -63,6 +73,48 @@ ShaderProgram::init(Device& device,
     return hr;
 }
 
+HRESULT
+ShaderProgram::initVertexOnly(Device& device,
+    const std::string& fileName,
+    std::vector<D3D11_INPUT_ELEMENT_DESC> Layout) {
+    /**
+     * @brief Inicializa el programa solo con Vertex Shader e Input Layout.
+     * @param device Referencia al dispositivo Direct3D 11.
+     * @param fileName Ruta del archivo HLSL.
+     * @param Layout Descripcin de los elementos de entrada (Input Layout).
+     * @return HRESULT S_OK si se inicializ correctamente, o cdigo de error en caso contrario.
+     */
+    if (!device.m_device) {
+        ERROR("ShaderProgram", "initVertexOnly", "Device is null.");
+        return E_POINTER;
+    }
+    if (fileName.empty()) {
+        ERROR("ShaderProgram", "initVertexOnly", "File name is empty.");
+        return E_INVALIDARG;
+    }
+    if (Layout.empty()) {
+        ERROR("ShaderProgram", "initVertexOnly", "Input layout is empty.");
+        return E_INVALIDARG;
+    }
+    m_shaderFileName = fileName;
+    m_defines.clear();
+    m_vertexOnly = true;
+    SAFE_RELEASE(m_PixelShader);
+
+    HRESULT hr = CreateShader(device, ShaderType::VERTEX_SHADER);
+    if (FAILED(hr)) {
+        ERROR("ShaderProgram", "initVertexOnly", "Failed to create vertex shader.");
+        return hr;
+    }
+
+    hr = CreateInputLayout(device, Layout);
+    if (FAILED(hr)) {
+        ERROR("ShaderProgram", "initVertexOnly", "Failed to create input layout.");
+        return hr;
+    }
+    return hr;
+}
+
 HRESULT
 ShaderProgram::CreateInputLayout(Device& device,
     std::vector<D3D11_INPUT_ELEMENT_DESC> Layout) {
@@ -93,6 +145,13 @@ ShaderProgram::CreateInputLayout(Device& device,
         return hr;
     }
 
+    // Con el layout guardado, la recarga en caliente puede rehacerlo.
+    m_layout = Layout;
+    if (!m_library) {
+        m_library = &device.getShaderLibrary();
+        m_library->addProgram(this);
+    }
+
     return hr;
 }
 
@@ -114,55 +173,78 @@ ShaderProgram::CreateShader(Device& device, ShaderType type) {
     }
 
     HRESULT hr = S_OK;
-    ID3DBlob* shaderData = nullptr;
+    const ShaderKey key = makeKey(device, type);
 
-    const char* shaderEntryPoint = (type == ShaderType::PIXEL_SHADER) ? "PS" : "VS";
-    const char* shaderModel = (type == ShaderType::PIXEL_SHADER) ? "ps_4_0" : "vs_4_0";
-
-    // Compilar shader desde archivo
-    hr = CompileShaderFromFile(m_shaderFileName.data(),
-        shaderEntryPoint,
-        shaderModel,
-        &shaderData);
-
-    if (FAILED(hr)) {
-        ERROR("ShaderProgram", "CreateShader",
-            "Failed to compile shader from file: %s", m_shaderFileName.c_str());
-        return hr;
-    }
-
-    // Crear objeto shader
+    // La biblioteca compila cada variante una sola vez y comparte el objeto.
     if (type == PIXEL_SHADER) {
-        hr = device.CreatePixelShader(shaderData->GetBufferPointer(),
-            shaderData->GetBufferSize(),
-            nullptr,
-            &m_PixelShader);
+        SAFE_RELEASE(m_PixelShader);
+        hr = device.getShaderLibrary().getPixelShader(device, key, &m_PixelShader);
     }
     else {
-        hr = device.CreateVertexShader(shaderData->GetBufferPointer(),
-            shaderData->GetBufferSize(),
-            nullptr,
-            &m_VertexShader);
+        SAFE_RELEASE(m_VertexShader);
+        SAFE_RELEASE(m_vertexShaderData);
+        hr = device.getShaderLibrary().getVertexShader(device, key, &m_VertexShader, &m_vertexShaderData);
     }
 
     if (FAILED(hr)) {
         ERROR("ShaderProgram", "CreateShader",
-            "Failed to create shader object from compiled data.");
-        shaderData->Release();
+            ("Failed to create shader from file: " + m_shaderFileName).c_str());
         return hr;
     }
 
-    // Guardar datos compilados
-    if (type == PIXEL_SHADER) {
-        SAFE_RELEASE(m_pixelShaderData);
-        m_pixelShaderData = shaderData;
+    return S_OK;
+}
+
+ShaderKey
+ShaderProgram::makeKey(Device& device, ShaderType type) const {
+    ShaderKey key;
+    key.fileName = m_shaderFileName;
+    key.entryPoint = (type == ShaderType::PIXEL_SHADER) ? "PS" : "VS";
+    // SM5 en 11_0; el perfil baja con el feature level del dispositivo.
+    key.profile = ShaderLibrary::profile(type, device.m_device->GetFeatureLevel());
+    key.defines = m_defines;
+    return key;
+}
+
+HRESULT
+ShaderProgram::reload(Device& device, const std::string& variant) {
+    /**
+     * @brief Cambia el shader de la etapa recompilada por el nuevo objeto de la biblioteca.
+     * @param device Referencia al dispositivo Direct3D 11.
+     * @param variant Clave cannica de la variante recompilada.
+     * @return S_OK si se cambi, S_FALSE si el programa no la usa, o cdigo de error.
+     */
+    if (!device.m_device || m_shaderFileName.empty()) {
+        return S_FALSE;
     }
-    else {
-        SAFE_RELEASE(m_vertexShaderData);
-        m_vertexShaderData = shaderData;
+    const ShaderKey vertexKey = makeKey(device, ShaderType::VERTEX_SHADER);
+    if (variant == vertexKey.toString()) {
+        // El layout se valida contra la firma nueva antes de soltar el VS anterior.
+        ID3D11VertexShader* shader = nullptr;
+        ID3DBlob* bytecode = nullptr;
+        HRESULT hr = device.getShaderLibrary().getVertexShader(device, vertexKey, &shader, &bytecode);
+        InputLayout layout;
+        if (SUCCEEDED(hr)) {
+            hr = layout.init(device, m_layout, bytecode);
+        }
+        SAFE_RELEASE(bytecode);
+        if (FAILED(hr)) {
+            ERROR("ShaderProgram", "reload",
+                ("Reloaded vertex shader does not match the input layout; keeping the old one: " + variant).c_str());
+            SAFE_RELEASE(shader);
+            layout.destroy();
+            return hr;
+        }
+        SAFE_RELEASE(m_VertexShader);
+        m_VertexShader = shader;
+        m_inputLayout.destroy();
+        m_inputLayout = layout;
+        return S_OK;
     }
-
-    return S_OK;
+    if (!m_vertexOnly && variant == makeKey(device, ShaderType::PIXEL_SHADER).toString()) {
+        return CreateShader(device, ShaderType::PIXEL_SHADER);
+    }
+    return S_FALSE;
 }
 
 HRESULT
@@ -183,9 +265,7 @@ ShaderProgram::CreateShader(Device& device, ShaderType type, const std::string&
         return E_INVALIDARG;
     }
     m_shaderFileName = fileName;
-    CreateShader(device, type);
-
-    return S_OK;
+    return CreateShader(device, type);
 }
 
 HRESULT
@@ -197,47 +277,20 @@ ShaderProgram::CompileShaderFromFile(char* szFileName,
      * @brief Compila un shader desde un archivo HLSL.
      * @param szFileName Ruta del archivo HLSL.
      * @param szEntryPoint Punto de entrada (funcin principal) del shader.
-     * @param szShaderModel Modelo de shader a usar (ej. vs_4_0, ps_4_0).
+     * @param szShaderModel Modelo de shader a usar (ej. vs_5_0, ps_5_0).
      * @param ppBlobOut Puntero para recibir el bytecode compilado.
      * @return HRESULT S_OK si se compila correctamente, o cdigo de error.
      */
-    HRESULT hr = S_OK;
-    DWORD dwShaderFlags = D3DCOMPILE_ENABLE_STRICTNESS;
-
-#if defined( DEBUG ) || defined( _DEBUG )
-    dwShaderFlags |= D3DCOMPILE_DEBUG;
-#endif
-
-    ID3DBlob* pErrorBlob;
-    hr = D3DX11CompileFromFile(szFileName,
-        nullptr,
-        nullptr,
-        szEntryPoint,
-        szShaderModel,
-        dwShaderFlags,
-        0,
-        nullptr,
-        ppBlobOut,
-        &pErrorBlob,
-        nullptr);
-
-    if (FAILED(hr)) {
-        if (pErrorBlob) {
-            ERROR("ShaderProgram", "CompileShaderFromFile",
-                "Failed to compile shader from file: %s. Error: %s",
-                szFileName, static_cast<const char*>(pErrorBlob->GetBufferPointer()));
-            pErrorBlob->Release();
-        }
-        else {
-            ERROR("ShaderProgram", "CompileShaderFromFile",
-                "Failed to compile shader from file: %s. No error message available.",
-                szFileName);
-        }
-        return hr;
+    if (!szFileName || !szEntryPoint || !szShaderModel) {
+        ERROR("ShaderProgram", "CompileShaderFromFile", "Invalid arguments.");
+        return E_INVALIDARG;
     }
-
-    SAFE_RELEASE(pErrorBlob)
-        return S_OK;
+    // Mismo compilador, flags e includes que las variantes de la biblioteca.
+    ShaderKey key;
+    key.fileName = szFileName;
+    key.entryPoint = szEntryPoint;
+    key.profile = szShaderModel;
+    return ShaderLibrary::compile(key, ppBlobOut);
 }
 
 void
@@ -251,14 +304,14 @@ ShaderProgram::render(DeviceContext& deviceContext) {
      * @brief Activa el Vertex Shader, Pixel Shader e Input Layout en el pipeline.
      * @param deviceContext Contexto de dispositivo para emitir comandos de renderizado.
      */
-    if (!m_VertexShader || !m_PixelShader || !m_inputLayout.m_inputLayout) {
+    if (!m_VertexShader || (!m_PixelShader && !m_vertexOnly) || !m_inputLayout.m_inputLayout) {
         ERROR("ShaderProgram", "render", "Shaders or InputLayout not initialized");
         return;
     }
 
     m_inputLayout.render(deviceContext);
-    deviceContext.m_deviceContext->VSSetShader(m_VertexShader, nullptr, 0);
-    deviceContext.m_deviceContext->PSSetShader(m_PixelShader, nullptr, 0);
+    deviceContext.VSSetShader(m_VertexShader, nullptr, 0);
+    deviceContext.PSSetShader(m_PixelShader, nullptr, 0); // nullptr en programas solo-profundidad
 }
 
 void
@@ -274,10 +327,10 @@ ShaderProgram::render(DeviceContext& deviceContext, ShaderType type) {
     }
     switch (type) {
     case VERTEX_SHADER:
-        deviceContext.m_deviceContext->VSSetShader(m_VertexShader, nullptr, 0);
+        deviceContext.VSSetShader(m_VertexShader, nullptr, 0);
         break;
     case PIXEL_SHADER:
-        deviceContext.m_deviceContext->PSSetShader(m_PixelShader, nullptr, 0);
+        deviceContext.PSSetShader(m_PixelShader, nullptr, 0);
         break;
     default:
         break;
@@ -292,4 +345,8 @@ ShaderProgram::destroy() {
     SAFE_RELEASE(m_PixelShader);
     SAFE_RELEASE(m_vertexShaderData);
     SAFE_RELEASE(m_pixelShaderData);
+    if (m_library) {
+        m_library->removeProgram(this);
+        m_library = nullptr;
+    }
 }
@@ -0,0 +1,298 @@
+﻿/**
+ * @file ShadowMap.cpp
+ * @brief Implementación de las cascadas de sombra y su caché.
+ */
+
+#include "ShadowMap.h"
+#include "Device.h"
+#include "DeviceContext.h"
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+const float ShadowMap::kShadowDistance = 60.0f;
+const float ShadowMap::kSplitLambda = 0.5f;
+const float ShadowMap::kCachePadding = 0.25f;
+
+namespace {
+    /// Sesgo que se resta a la profundidad del receptor al comparar (espacio [0, 1]).
+    const float kCompareBias = 0.0005f;
+    /// Sesgo del rasterizador del pase de casters (D32_FLOAT: unidades de 2^(exp - 23)).
+    const int kRasterDepthBias = 1000;
+    /// Sesgo según la pendiente: las caras casi paralelas a la luz necesitan más.
+    const float kRasterSlopeBias = 2.0f;
+
+    /// Redondea hacia abajo a un múltiplo de `step`.
+    float snap(float value, float step) {
+        return floorf(value / step) * step;
+    }
+}
+
+static_assert(ShadowMap::kCascadeCount == sizeof(CBShadow::mLightViewProj) / sizeof(XMMATRIX),
+    "CBShadow must hold one matrix per cascade");
+
+HRESULT ShadowMap::init(Device& device, unsigned int size) {
+    if (!device.m_device) {
+        ERROR("ShadowMap", "init", "Device is null.");
+        return E_POINTER;
+    }
+    if (size == 0) {
+        ERROR("ShadowMap", "init", "Shadow map size must be greater than 0");
+        return E_INVALIDARG;
+    }
+    destroy();
+    m_size = size;
+
+    // Typeless para poder escribir cada capa como DSV y leer el array como SRV.
+    D3D11_TEXTURE2D_DESC desc = {};
+    desc.Width = size;
+    desc.Height = size;
+    desc.MipLevels = 1;
+    desc.ArraySize = kCascadeCount;
+    desc.Format = DXGI_FORMAT_R32_TYPELESS;
+    desc.SampleDesc.Count = 1;
+    desc.Usage = D3D11_USAGE_DEFAULT;
+    desc.BindFlags = D3D11_BIND_DEPTH_STENCIL | D3D11_BIND_SHADER_RESOURCE;
+    HRESULT hr = device.CreateTexture2D(&desc, nullptr, &m_depthArray);
+
+    for (unsigned int i = 0; i < kCascadeCount && SUCCEEDED(hr); ++i) {
+        D3D11_DEPTH_STENCIL_VIEW_DESC dsvDesc = {};
+        dsvDesc.Format = DXGI_FORMAT_D32_FLOAT;
+        dsvDesc.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2DARRAY;
+        dsvDesc.Texture2DArray.MipSlice = 0;
+        dsvDesc.Texture2DArray.FirstArraySlice = i;
+        dsvDesc.Texture2DArray.ArraySize = 1;
+        hr = device.CreateDepthStencilView(m_depthArray, &dsvDesc, &m_cascades[i].view);
+        if (SUCCEEDED(hr)) hr = m_cascades[i].viewBuffer.init(device);
+        if (SUCCEEDED(hr)) hr = m_cascades[i].projBuffer.init(device);
+        m_cascades[i].dirty = true;
+    }
+    if (SUCCEEDED(hr)) {
+        D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+        srvDesc.Format = DXGI_FORMAT_R32_FLOAT;
+        srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
+        srvDesc.Texture2DArray.MostDetailedMip = 0;
+        srvDesc.Texture2DArray.MipLevels = 1;
+        srvDesc.Texture2DArray.FirstArraySlice = 0;
+        srvDesc.Texture2DArray.ArraySize = kCascadeCount;
+        hr = device.CreateShaderResourceView(m_depthArray, &srvDesc, &m_arraySRV);
+    }
+    if (SUCCEEDED(hr)) hr = m_viewport.init(size, size);
+    if (SUCCEEDED(hr)) hr = m_rasterizer.init(device, kRasterDepthBias, kRasterSlopeBias);
+    if (SUCCEEDED(hr)) hr = m_comparisonSampler.initComparison(device);
+    if (SUCCEEDED(hr)) hr = m_shadowBuffer.init(device);
+    if (FAILED(hr)) {
+        ERROR("ShadowMap", "init", ("Failed to create shadow map resources. HRESULT: " + std::to_string(hr)).c_str());
+        destroy();
+        return hr;
+    }
+
+    std::memset(&m_shadowData, 0, sizeof(m_shadowData));
+    m_nextFarCascade = 1;
+    m_enabled = true;
+    return S_OK;
+}
+
+/**
+ * @brief Reparte [near, kShadowDistance] y ajusta una esfera a cada tramo.
+ *
+ * @details
+ * Para un tramo [zn, zf] de un frustum simétrico con k² = tan²(fovX/2) + tan²(fovY/2),
+ * el centro sobre el eje que equidista de las esquinas cercanas y lejanas está en
+ * `z = (zn + zf)(1 + k²) / 2` (o en `zf` si eso queda más lejos). La esfera no
+ * depende de la orientación de la cámara, así que el tamaño de la cascada (y el de
+ * sus texels) no cambia al girar: solo se traslada.
+ */
+void ShadowMap::update(const XMFLOAT4& lightPos, const XMMATRIX& view, const XMMATRIX& projection,
+    float nearZ, float farZ, const XMFLOAT3& sceneMin, const XMFLOAT3& sceneMax) {
+    if (!m_enabled) {
+        return;
+    }
+
+    XMVECTOR toLight = XMVector3Normalize(XMVectorSet(lightPos.x, lightPos.y, lightPos.z, 0.0f));
+    if (XMVectorGetX(XMVector3LengthSq(toLight)) < 0.5f) {
+        toLight = XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f); // luz en el origen: cenital
+    }
+    // Con la luz casi vertical, "arriba" = Y sería paralelo a la dirección de vista.
+    XMVECTOR up = (fabsf(XMVectorGetY(toLight)) > 0.99f)
+        ? XMVectorSet(0.0f, 0.0f, 1.0f, 0.0f)
+        : XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f);
+    m_lightView = XMMatrixLookAtLH(XMVectorZero(), XMVectorNegate(toLight), up);
+
+    // Lo más cercano a la luz de todos los casters: el volumen de cada cascada se
+    // alarga hasta ahí para que un caster fuera del tramo siga proyectando sombra.
+    float casterNearZ = FLT_MAX;
+    for (unsigned int corner = 0; corner < 8; ++corner) {
+        XMVECTOR p = XMVectorSet((corner & 1) ? sceneMax.x : sceneMin.x,
+            (corner & 2) ? sceneMax.y : sceneMin.y,
+            (corner & 4) ? sceneMax.z : sceneMin.z, 1.0f);
+        casterNearZ = (std::min)(casterNearZ, XMVectorGetZ(XMVector3TransformCoord(p, m_lightView)));
+    }
+
+    const float tanX = 1.0f / XMVectorGetX(projection.r[0]);
+    const float tanY = 1.0f / XMVectorGetY(projection.r[1]);
+    const float k2 = tanX * tanX + tanY * tanY;
+    const XMMATRIX invView = XMMatrixInverse(nullptr, view);
+    const float shadowFar = (std::min)(farZ, kShadowDistance);
+
+    float splits[kCascadeCount];
+    float zn = nearZ;
+    for (unsigned int i = 0; i < kCascadeCount; ++i) {
+        const float t = static_cast<float>(i + 1) / kCascadeCount;
+        const float logSplit = nearZ * powf(shadowFar / nearZ, t);
+        const float uniformSplit = nearZ + (shadowFar - nearZ) * t;
+        const float zf = kSplitLambda * logSplit + (1.0f - kSplitLambda) * uniformSplit;
+        splits[i] = zf;
+
+        float centerZ = 0.5f * (zn + zf) * (1.0f + k2);
+        float radius;
+        if (centerZ >= zf) {
+            centerZ = zf;
+            radius = zf * sqrtf(k2);
+        }
+        else {
+            radius = sqrtf((zf - centerZ) * (zf - centerZ) + zf * zf * k2);
+        }
+        XMVECTOR center = XMVector3TransformCoord(XMVectorSet(0.0f, 0.0f, centerZ, 1.0f), invView);
+
+        Cascade& cascade = m_cascades[i];
+        const XMMATRIX projectionFit = fitCascade(i, center, radius, casterNearZ);
+        const XMMATRIX viewProj = XMMatrixMultiply(m_lightView, projectionFit);
+        if (std::memcmp(&viewProj, &cascade.viewProj, sizeof(XMMATRIX)) != 0) {
+            cascade.viewProj = viewProj;
+            cascade.volume.update(viewProj);
+            cascade.dirty = true;
+
+            CBNeverChanges lightViewData;
+            lightViewData.mView = XMMatrixTranspose(m_lightView);
+            cascade.viewBuffer.set(lightViewData);
+            CBChangeOnResize projData;
+            projData.mProjection = XMMatrixTranspose(projectionFit);
+            cascade.projBuffer.set(projData);
+        }
+        zn = zf;
+    }
+
+    m_shadowData.vCascadeSplits = XMFLOAT4(splits[0], splits[1], splits[2], splits[3]);
+    m_shadowData.vShadowParams = XMFLOAT4(1.0f / static_cast<float>(m_size), kCompareBias, m_strength, 0.0f);
+    m_shadowBuffer.set(m_shadowData);
+}
+
+/**
+ * @brief Ortográfica fuera de centro alrededor de la esfera, en espacio de luz.
+ *
+ * @details
+ * - Cascada 0 (cada frame): centro redondeado al texel, para que las sombras no
+ *   tiemblen al mover la cámara.
+ * - Cacheables: radio con margen y centro redondeado a una rejilla de
+ *   `radio * kCachePadding`; el error de redondeo (< 0.71 pasos) cabe en el margen.
+ *
+ * El plano cercano se lleva hasta el caster más cercano a la luz, redondeado a la
+ * misma rejilla para que un caster dinámico no invalide la caché en cada frame.
+ */
+XMMATRIX ShadowMap::fitCascade(unsigned int cascade, const XMVECTOR& center, float radius,
+    float casterNearZ) const {
+    float r = radius;
+    float step = 2.0f * r / static_cast<float>(m_size);
+    if (cascade > 0) {
+        r = radius * (1.0f + kCachePadding);
+        const float texel = 2.0f * r / static_cast<float>(m_size);
+        step = (std::max)(texel, snap(radius * kCachePadding, texel));
+    }
+
+    XMFLOAT3 c;
+    XMStoreFloat3(&c, XMVector3TransformCoord(center, m_lightView));
+    c.x = snap(c.x, step);
+    c.y = snap(c.y, step);
+    c.z = snap(c.z, step);
+
+    const float farZ = c.z + r;
+    const float nearZ = snap((std::min)(casterNearZ, c.z - r), step);
+    return XMMatrixOrthographicOffCenterLH(c.x - r, c.x + r, c.y - r, c.y + r, nearZ, farZ);
+}
+
+void ShadowMap::invalidate() {
+    for (Cascade& cascade : m_cascades) {
+        cascade.dirty = true;
+    }
+}
+
+bool ShadowMap::intersects(unsigned int cascade, const XMFLOAT3& boundsMin, const XMFLOAT3& boundsMax) const {
+    if (cascade >= kCascadeCount) {
+        return false;
+    }
+    return m_cascades[cascade].volume.intersectsAABB(boundsMin, boundsMax);
+}
+
+/**
+ * @brief La cascada 0 siempre; de las lejanas, la siguiente en turno que lo necesite.
+ */
+void ShadowMap::schedule(const bool hasDynamicCasters[kCascadeCount], std::vector<unsigned int>& outCascades) {
+    outCascades.clear();
+    if (!m_enabled) {
+        m_renderedCount = 0;
+        return;
+    }
+    outCascades.push_back(0);
+
+    const unsigned int farCount = kCascadeCount - 1;
+    for (unsigned int k = 0; k < farCount; ++k) {
+        const unsigned int c = 1 + (m_nextFarCascade - 1 + k) % farCount;
+        if (m_cascades[c].dirty || hasDynamicCasters[c]) {
+            outCascades.push_back(c);
+            m_nextFarCascade = 1 + c % farCount;
+            break;
+        }
+    }
+    m_renderedCount = static_cast<unsigned int>(outCascades.size());
+}
+
+void ShadowMap::begin(DeviceContext& deviceContext, unsigned int cascade) {
+    if (!m_enabled || cascade >= kCascadeCount) {
+        return;
+    }
+    Cascade& c = m_cascades[cascade];
+
+    // El array sigue enlazado como SRV: hay que soltarlo antes de escribir una capa.
+    ID3D11ShaderResourceView* nullSRV = nullptr;
+    deviceContext.PSSetShaderResources(kTextureSlot, 1, &nullSRV);
+    deviceContext.OMSetRenderTargets(0, nullptr, c.view);
+    deviceContext.ClearDepthStencilView(c.view, D3D11_CLEAR_DEPTH, 1.0f, 0);
+    m_viewport.render(deviceContext);
+
+    c.viewBuffer.update(deviceContext);
+    c.projBuffer.update(deviceContext);
+    c.viewBuffer.render(deviceContext, CB_SLOT_VIEW);
+    c.projBuffer.render(deviceContext, CB_SLOT_PROJECTION);
+
+    // A partir de aquí la capa corresponde a este ajuste: los receptores lo usan.
+    m_shadowData.mLightViewProj[cascade] = XMMatrixTranspose(c.viewProj);
+    m_shadowBuffer.set(m_shadowData);
+    c.dirty = false;
+}
+
+void ShadowMap::bind(DeviceContext& deviceContext) {
+    if (!m_enabled) {
+        return;
+    }
+
+    m_shadowBuffer.update(deviceContext);
+    m_shadowBuffer.render(deviceContext, CB_SLOT_SHADOW, true);
+    deviceContext.PSSetShaderResources(kTextureSlot, 1, &m_arraySRV);
+    m_comparisonSampler.render(deviceContext, kSamplerSlot, 1);
+}
+
+void ShadowMap::destroy() {
+    m_shadowBuffer.destroy();
+    m_comparisonSampler.destroy();
+    m_rasterizer.destroy();
+    for (Cascade& cascade : m_cascades) {
+        cascade.viewBuffer.destroy();
+        cascade.projBuffer.destroy();
+        SAFE_RELEASE(cascade.view);
+        cascade.dirty = true;
+    }
+    SAFE_RELEASE(m_arraySRV);
+    SAFE_RELEASE(m_depthArray);
+    m_enabled = false;
+}
@@ -0,0 +1,521 @@
+﻿/**
+ * @file SkinningSystem.cpp
+ * @brief Alta de mallas deformables, copia de paletas y dispatch del skinning.
+ *
+ * @details
+ * Orden de un frame: la simulación actualiza `AnimationSystem`; con el render parado,
+ * @ref SkinningSystem::capture copia las paletas nuevas; al empezar el render,
+ * @ref SkinningSystem::dispatch las sube y deforma. Entre dos `capture` sin `dispatch`
+ * (no pasa con `BaseApp`) la malla pendiente se vuelve a copiar con la pose más nueva.
+ * Los pesos de blend shape viajan con la pose: cambiar uno sube su versión.
+ */
+
+#include "SkinningSystem.h"
+#include "Device.h"
+#include "DeviceContext.h"
+#include "ShaderLibrary.h"
+#include "CpuProfiler.h"
+#include <algorithm>
+
+namespace {
+    unsigned int packBytes(const unsigned char values[4]) {
+        return values[0] | values[1] << 8 | values[2] << 16 | static_cast<unsigned int>(values[3]) << 24;
+    }
+}
+
+HRESULT SkinningSystem::init(Device& device) {
+    if (!device.m_device) {
+        ERROR("SkinningSystem", "init", "Device is null.");
+        return E_POINTER;
+    }
+    destroy();
+
+    // Vertex buffers escritos por UAV sin tipo: nivel 11_0.
+    if (device.m_device->GetFeatureLevel() < D3D_FEATURE_LEVEL_11_0) {
+        MESSAGE("SkinningSystem", "init", "Feature level < 11_0: skinning disabled.");
+        return DXGI_ERROR_UNSUPPORTED;
+    }
+
+    D3D11_BUFFER_DESC paramsDesc = {};
+    paramsDesc.Usage = D3D11_USAGE_DEFAULT;
+    paramsDesc.ByteWidth = sizeof(SkinParams);
+    paramsDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+    HRESULT hr = device.CreateBuffer(&paramsDesc, nullptr, &m_params);
+    if (FAILED(hr)) {
+        destroy();
+        return hr;
+    }
+
+    m_device = &device;
+    hr = reserve(kInitialPaletteJoints);
+    if (FAILED(hr)) {
+        destroy();
+        return hr;
+    }
+
+    ShaderKey key;
+    key.fileName = "Skinning.fx";
+    key.entryPoint = "CSSkin";
+    key.profile = "cs_5_0";
+    hr = device.getShaderLibrary().getComputeShader(device, key, &m_shader);
+    if (SUCCEEDED(hr)) {
+        key.entryPoint = "CSMorph";
+        hr = device.getShaderLibrary().getComputeShader(device, key, &m_morphShader);
+    }
+    if (SUCCEEDED(hr)) { hr = reserveBatches(kInitialMorphBatches); }
+    if (FAILED(hr)) {
+        destroy();
+        return hr;
+    }
+    return S_OK;
+}
+
+/**
+ * @details Los vértices de `SourceVertex` siguen el orden de las páginas del asset:
+ * las submallas válidas (`MeshAsset::m_meshes`) una tras otra, así que el vértice `v`
+ * de la página `p` es `pages[p].firstSource + v`. Las submallas sin `m_skin` entran
+ * con peso 0 (el kernel las deja en la pose de enlace).
+ */
+SkinningSystem::SkinID SkinningSystem::add(Device& device, const std::vector<MeshComponent>& meshes,
+    AnimationSystem::InstanceID instance) {
+    if (!isReady()) {
+        return kInvalidSkin;
+    }
+    SkinnedMesh mesh;
+    mesh.instance = instance;
+    mesh.asset = EU::MakeShared<MeshAsset>();
+    HRESULT hr = mesh.asset->initSkinned(device, meshes);
+    if (FAILED(hr) || mesh.asset->getSubmeshCount() == 0) {
+        ERROR("SkinningSystem", "add", "Failed to create the skinned mesh buffers");
+        mesh.asset->destroy();
+        return kInvalidSkin;
+    }
+
+    MeshAsset& asset = *mesh.asset;
+    std::vector<SourceVertex> sources;
+    std::vector<unsigned int> submeshFirstSource;
+    for (unsigned int i = 0; i < asset.getSubmeshCount(); ++i) {
+        const MeshComponent& submesh = asset.m_meshes[i];
+        const SubmeshRange& range = asset.m_submeshes[i];
+        if (range.page >= mesh.pages.size()) {
+            Page page;
+            page.firstSource = static_cast<unsigned int>(sources.size());
+            mesh.pages.push_back(page);
+        }
+        const bool skinned = submesh.m_skin.size() == submesh.m_vertex.size();
+        submeshFirstSource.push_back(static_cast<unsigned int>(sources.size()));
+        for (size_t v = 0; v < submesh.m_vertex.size(); ++v) {
+            SourceVertex source;
+            source.position = submesh.m_vertex[v].Pos;
+            source.bones = skinned ? packBytes(submesh.m_skin[v].Bones) : 0;
+            source.weights = skinned ? packBytes(submesh.m_skin[v].Weights) : 0;
+            source.morphSlot = kInvalidMorph;
+            sources.push_back(source);
+        }
+        mesh.pages[range.page].vertexCount = static_cast<unsigned int>(range.baseVertex) + range.vertexCount;
+    }
+    hr = createMorphs(device, mesh, submeshFirstSource, sources);
+    if (FAILED(hr)) {
+        ERROR("SkinningSystem", "add", ("Failed to create the blend shape buffers. HRESULT: " + std::to_string(hr)).c_str());
+        release(mesh);
+        return kInvalidSkin;
+    }
+    // Los vértices ya están en `sources` y en los buffers.
+    asset.releaseCpuData();
+
+    D3D11_BUFFER_DESC desc = {};
+    desc.Usage = D3D11_USAGE_IMMUTABLE;
+    desc.ByteWidth = static_cast<unsigned int>(sources.size() * sizeof(SourceVertex));
+    desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+    desc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+    desc.StructureByteStride = sizeof(SourceVertex);
+    D3D11_SUBRESOURCE_DATA data = {};
+    data.pSysMem = sources.data();
+    hr = device.CreateBuffer(&desc, &data, &mesh.sources);
+
+    D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+    srvDesc.Format = DXGI_FORMAT_UNKNOWN;
+    srvDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+    srvDesc.Buffer.FirstElement = 0;
+    srvDesc.Buffer.NumElements = static_cast<unsigned int>(sources.size());
+    if (SUCCEEDED(hr)) { hr = device.CreateShaderResourceView(mesh.sources, &srvDesc, &mesh.sourcesSRV); }
+
+    // Vistas sin tipo (R32_TYPELESS + RAW) sobre el VB y el stream de posiciones.
+    for (size_t p = 0; SUCCEEDED(hr) && p < mesh.pages.size(); ++p) {
+        GeometryPage& geometry = asset.m_pages[p];
+        D3D11_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
+        uavDesc.Format = DXGI_FORMAT_R32_TYPELESS;
+        uavDesc.ViewDimension = D3D11_UAV_DIMENSION_BUFFER;
+        uavDesc.Buffer.Flags = D3D11_BUFFER_UAV_FLAG_RAW;
+        uavDesc.Buffer.FirstElement = 0;
+        uavDesc.Buffer.NumElements = geometry.vertices.getByteWidth() / 4;
+        hr = device.CreateUnorderedAccessView(geometry.vertices.getResource(), &uavDesc, &mesh.pages[p].vertices);
+        uavDesc.Buffer.NumElements = geometry.positions.getByteWidth() / 4;
+        if (SUCCEEDED(hr)) {
+            hr = device.CreateUnorderedAccessView(geometry.positions.getResource(), &uavDesc, &mesh.pages[p].positions);
+        }
+    }
+    if (FAILED(hr)) {
+        ERROR("SkinningSystem", "add", "Failed to create the skinning views");
+        release(mesh);
+        return kInvalidSkin;
+    }
+
+    SkinID id;
+    if (!m_free.empty()) {
+        id = m_free.back();
+        m_free.pop_back();
+        m_meshes[id] = mesh;
+    }
+    else {
+        id = static_cast<SkinID>(m_meshes.size());
+        m_meshes.push_back(mesh);
+    }
+    m_instanceByAsset[m_meshes[id].asset.get()] = instance;
+    return id;
+}
+
+void SkinningSystem::remove(SkinID id) {
+    if (id < m_meshes.size() && !m_meshes[id].asset.isNull()) {
+        m_instanceByAsset.Remove(m_meshes[id].asset.get());
+        release(m_meshes[id]);
+        m_meshes[id] = SkinnedMesh();
+        m_free.push_back(id);
+    }
+}
+
+EU::TSharedPointer<MeshAsset> SkinningSystem::getMeshAsset(SkinID id) const {
+    return id < m_meshes.size() ? m_meshes[id].asset : EU::TSharedPointer<MeshAsset>();
+}
+
+unsigned int SkinningSystem::findMorphTarget(SkinID id, const std::string& name) const {
+    if (id >= m_meshes.size()) {
+        return kInvalidMorph;
+    }
+    const std::vector<std::string>& names = m_meshes[id].morphNames;
+    const auto found = std::find(names.begin(), names.end(), name);
+    return found != names.end() ? static_cast<unsigned int>(found - names.begin()) : kInvalidMorph;
+}
+
+unsigned int SkinningSystem::getMorphTargetCount(SkinID id) const {
+    return id < m_meshes.size() ? static_cast<unsigned int>(m_meshes[id].morphNames.size()) : 0;
+}
+
+/**
+ * @details Cada vértice que mueve alguna forma recibe un acumulador (`morphSlot`), así
+ * que el buffer de acumuladores mide lo que mueven las formas y no la malla entera. Los
+ * deltas de una forma que aparece en varias submallas quedan contiguos: un lote por forma.
+ */
+HRESULT SkinningSystem::createMorphs(Device& device, SkinnedMesh& mesh,
+    const std::vector<unsigned int>& submeshFirstSource, std::vector<SourceVertex>& sources) {
+    const MeshAsset& asset = *mesh.asset;
+    std::vector<std::vector<MorphDelta>> deltasByTarget;
+    unsigned int slotCount = 0;
+    for (unsigned int i = 0; i < asset.getSubmeshCount(); ++i) {
+        const MeshComponent& submesh = asset.m_meshes[i];
+        for (const MorphTarget& target : submesh.m_morphs) {
+            auto found = std::find(mesh.morphNames.begin(), mesh.morphNames.end(), target.name);
+            const size_t index = found - mesh.morphNames.begin();
+            if (found == mesh.morphNames.end()) {
+                mesh.morphNames.push_back(target.name);
+                deltasByTarget.emplace_back();
+            }
+            for (size_t k = 0; k < target.vertices.size() && k < target.deltas.size(); ++k) {
+                if (target.vertices[k] >= submesh.m_vertex.size()) {
+                    continue;
+                }
+                SourceVertex& source = sources[submeshFirstSource[i] + target.vertices[k]];
+                if (source.morphSlot == kInvalidMorph) {
+                    source.morphSlot = slotCount++;
+                }
+                deltasByTarget[index].push_back({ source.morphSlot, target.deltas[k] });
+            }
+        }
+    }
+    if (slotCount == 0) {
+        mesh.morphNames.clear();
+        return S_OK;
+    }
+
+    std::vector<MorphDelta> deltas;
+    mesh.morphRanges.resize(deltasByTarget.size());
+    for (size_t t = 0; t < deltasByTarget.size(); ++t) {
+        mesh.morphRanges[t].firstDelta = static_cast<unsigned int>(deltas.size());
+        mesh.morphRanges[t].deltaCount = static_cast<unsigned int>(deltasByTarget[t].size());
+        deltas.insert(deltas.end(), deltasByTarget[t].begin(), deltasByTarget[t].end());
+    }
+
+    D3D11_BUFFER_DESC desc = {};
+    desc.Usage = D3D11_USAGE_IMMUTABLE;
+    desc.ByteWidth = static_cast<unsigned int>(deltas.size() * sizeof(MorphDelta));
+    desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+    desc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+    desc.StructureByteStride = sizeof(MorphDelta);
+    D3D11_SUBRESOURCE_DATA data = {};
+    data.pSysMem = deltas.data();
+    HRESULT hr = device.CreateBuffer(&desc, &data, &mesh.morphDeltas);
+
+    D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+    srvDesc.Format = DXGI_FORMAT_UNKNOWN;
+    srvDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+    srvDesc.Buffer.FirstElement = 0;
+    srvDesc.Buffer.NumElements = static_cast<unsigned int>(deltas.size());
+    if (SUCCEEDED(hr)) { hr = device.CreateShaderResourceView(mesh.morphDeltas, &srvDesc, &mesh.morphDeltasSRV); }
+
+    // Acumuladores a 0: `CSSkin` los vuelve a dejar así después de leerlos.
+    const std::vector<int> zeros(slotCount * 3, 0);
+    D3D11_BUFFER_DESC offsetsDesc = {};
+    offsetsDesc.Usage = D3D11_USAGE_DEFAULT;
+    offsetsDesc.ByteWidth = slotCount * 3 * sizeof(int);
+    offsetsDesc.BindFlags = D3D11_BIND_UNORDERED_ACCESS;
+    offsetsDesc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_ALLOW_RAW_VIEWS;
+    D3D11_SUBRESOURCE_DATA offsetsData = {};
+    offsetsData.pSysMem = zeros.data();
+    if (SUCCEEDED(hr)) { hr = device.CreateBuffer(&offsetsDesc, &offsetsData, &mesh.morphOffsets); }
+
+    D3D11_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
+    uavDesc.Format = DXGI_FORMAT_R32_TYPELESS;
+    uavDesc.ViewDimension = D3D11_UAV_DIMENSION_BUFFER;
+    uavDesc.Buffer.Flags = D3D11_BUFFER_UAV_FLAG_RAW;
+    uavDesc.Buffer.FirstElement = 0;
+    uavDesc.Buffer.NumElements = slotCount * 3;
+    if (SUCCEEDED(hr)) { hr = device.CreateUnorderedAccessView(mesh.morphOffsets, &uavDesc, &mesh.morphOffsetsUAV); }
+    return hr;
+}
+
+AnimationSystem::InstanceID SkinningSystem::getInstance(const MeshAsset* asset) const {
+    const AnimationSystem::InstanceID* instance = m_instanceByAsset.Find(asset);
+    return instance ? *instance : AnimationSystem::kInvalidInstance;
+}
+
+void SkinningSystem::capture(const AnimationSystem& animations) {
+    PROFILE_ZONE("SkinningSystem::capture");
+    m_palettes.clear();
+    m_batches.clear();
+    m_skippedCount = 0;
+    for (SkinnedMesh& mesh : m_meshes) {
+        if (mesh.asset.isNull()) {
+            continue;
+        }
+        const unsigned int version = animations.getPoseVersion(mesh.instance);
+        if (version == 0 || (version == mesh.version && !mesh.pending)) {
+            ++m_skippedCount;
+            continue;
+        }
+        const EU::Matrix3x4* palette = animations.getPalette(mesh.instance);
+        mesh.firstJoint = static_cast<unsigned int>(m_palettes.size());
+        m_palettes.insert(m_palettes.end(), palette, palette + animations.getPaletteSize(mesh.instance));
+        mesh.version = version;
+        mesh.pending = true;
+
+        // Solo las formas con peso: las demás no lanzan ni un hilo.
+        unsigned int weightCount = 0;
+        const float* weights = animations.getMorphWeights(mesh.instance, weightCount);
+        mesh.firstBatch = static_cast<unsigned int>(m_batches.size());
+        mesh.morphThreads = 0;
+        const unsigned int targetCount = (std::min)(weightCount, static_cast<unsigned int>(mesh.morphRanges.size()));
+        for (unsigned int t = 0; t < targetCount; ++t) {
+            if (weights[t] == 0.0f || mesh.morphRanges[t].deltaCount == 0) {
+                continue;
+            }
+            MorphBatch batch;
+            batch.firstDelta = mesh.morphRanges[t].firstDelta;
+            batch.deltaCount = mesh.morphRanges[t].deltaCount;
+            batch.firstThread = mesh.morphThreads;
+            batch.weight = weights[t];
+            m_batches.push_back(batch);
+            mesh.morphThreads += batch.deltaCount;
+        }
+        mesh.batchCount = static_cast<unsigned int>(m_batches.size()) - mesh.firstBatch;
+    }
+}
+
+void SkinningSystem::dispatch(DeviceContext& deviceContext) {
+    m_skinnedCount = 0;
+    m_morphDeltaCount = 0;
+    if (!isReady() || m_palettes.empty()) {
+        return;
+    }
+    PROFILE_ZONE("SkinningSystem::dispatch");
+    const unsigned int jointCount = static_cast<unsigned int>(m_palettes.size());
+    if (FAILED(reserve(jointCount))) {
+        ERROR("SkinningSystem", "dispatch", "Failed to grow the palette buffer; meshes keep their last pose");
+        return;
+    }
+    D3D11_MAPPED_SUBRESOURCE mapped = {};
+    if (FAILED(deviceContext.Map(m_paletteBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped))) {
+        return;
+    }
+    memcpy(mapped.pData, m_palettes.data(), jointCount * sizeof(EU::Matrix3x4));
+    deviceContext.Unmap(m_paletteBuffer, 0);
+
+    // Sin lotes subidos las mallas se deforman sin blend shapes (una pose sin cara).
+    bool morphs = !m_batches.empty() && SUCCEEDED(reserveBatches(static_cast<unsigned int>(m_batches.size())));
+    if (morphs && SUCCEEDED(deviceContext.Map(m_batchBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped))) {
+        memcpy(mapped.pData, m_batches.data(), m_batches.size() * sizeof(MorphBatch));
+        deviceContext.Unmap(m_batchBuffer, 0);
+    }
+    else {
+        morphs = false;
+    }
+
+    DeviceContext::EventScope event(deviceContext, "Skinning");
+    const VertexFormat& format = MeshAsset::getVertexFormat();
+    deviceContext.CSSetConstantBuffers(0, 1, &m_params);
+    for (SkinnedMesh& mesh : m_meshes) {
+        if (mesh.asset.isNull() || !mesh.pending) {
+            continue;
+        }
+        const bool morphed = morphs && mesh.batchCount > 0 && mesh.morphOffsetsUAV;
+        // La descuantización del asset es escala + traslación (ver VertexFormat).
+        XMFLOAT4X4 decode;
+        XMStoreFloat4x4(&decode, mesh.asset->getDecodeMatrix());
+
+        SkinParams params = {};
+        params.firstJoint = mesh.firstJoint;
+        params.vertexStride = format.getStride();
+        params.positionStride = format.getPositionStride();
+        params.snorm16 = format.getPositionEncoding() == POSITION_SNORM16 ? 1 : 0;
+        params.decodeOffset = XMFLOAT4(decode._41, decode._42, decode._43, 0.0f);
+        params.decodeScale = XMFLOAT4(decode._11, decode._22, decode._33, 0.0f);
+        params.morphed = morphed ? 1 : 0;
+
+        ID3D11ShaderResourceView* srvs[4] = { m_paletteSRV, mesh.sourcesSRV, m_batchSRV, mesh.morphDeltasSRV };
+        deviceContext.CSSetShaderResources(0, 4, srvs);
+        // Los acumuladores van en u2 en los dos kernels (nulo si la malla no tiene formas).
+        deviceContext.CSSetUnorderedAccessViews(2, 1, &mesh.morphOffsetsUAV, nullptr);
+        if (morphed) {
+            params.morphThreads = mesh.morphThreads;
+            params.firstBatch = mesh.firstBatch;
+            params.batchCount = mesh.batchCount;
+            deviceContext.UpdateSubresource(m_params, 0, nullptr, &params, 0, 0);
+            deviceContext.CSSetShader(m_morphShader, nullptr, 0);
+            deviceContext.Dispatch((mesh.morphThreads + kThreadGroupSize - 1) / kThreadGroupSize, 1, 1);
+            m_morphDeltaCount += mesh.morphThreads;
+        }
+        deviceContext.CSSetShader(m_shader, nullptr, 0);
+        for (const Page& page : mesh.pages) {
+            params.vertexCount = page.vertexCount;
+            params.firstSource = page.firstSource;
+            deviceContext.UpdateSubresource(m_params, 0, nullptr, &params, 0, 0);
+            ID3D11UnorderedAccessView* uavs[2] = { page.vertices, page.positions };
+            deviceContext.CSSetUnorderedAccessViews(0, 2, uavs, nullptr);
+            deviceContext.Dispatch((page.vertexCount + kThreadGroupSize - 1) / kThreadGroupSize, 1, 1);
+        }
+        mesh.pending = false;
+        ++m_skinnedCount;
+    }
+
+    // Desenlazar: los buffers pasan a leerse como vertex buffers.
+    ID3D11ShaderResourceView* nullSRVs[4] = { nullptr, nullptr, nullptr, nullptr };
+    ID3D11UnorderedAccessView* nullUAVs[3] = { nullptr, nullptr, nullptr };
+    deviceContext.CSSetShaderResources(0, 4, nullSRVs);
+    deviceContext.CSSetUnorderedAccessViews(0, 3, nullUAVs, nullptr);
+    deviceContext.CSSetShader(nullptr, nullptr, 0);
+    m_palettes.clear();
+    m_batches.clear();
+}
+
+HRESULT SkinningSystem::reserve(unsigned int jointCount) {
+    if (jointCount <= m_paletteCapacity) {
+        return S_OK;
+    }
+    unsigned int capacity = (std::max)(m_paletteCapacity, kInitialPaletteJoints);
+    while (capacity < jointCount) capacity *= 2;
+
+    SAFE_RELEASE(m_paletteSRV);
+    SAFE_RELEASE(m_paletteBuffer);
+    m_paletteCapacity = 0;
+
+    D3D11_BUFFER_DESC desc = {};
+    desc.Usage = D3D11_USAGE_DYNAMIC;
+    desc.ByteWidth = capacity * sizeof(EU::Matrix3x4);
+    desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+    desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+    desc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+    desc.StructureByteStride = sizeof(XMFLOAT4);
+    HRESULT hr = m_device->CreateBuffer(&desc, nullptr, &m_paletteBuffer);
+
+    D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+    srvDesc.Format = DXGI_FORMAT_UNKNOWN;
+    srvDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+    srvDesc.Buffer.FirstElement = 0;
+    srvDesc.Buffer.NumElements = capacity * 3;
+    if (SUCCEEDED(hr)) { hr = m_device->CreateShaderResourceView(m_paletteBuffer, &srvDesc, &m_paletteSRV); }
+    if (FAILED(hr)) {
+        return hr;
+    }
+    m_paletteCapacity = capacity;
+    return S_OK;
+}
+
+HRESULT SkinningSystem::reserveBatches(unsigned int batchCount) {
+    if (batchCount <= m_batchCapacity) {
+        return S_OK;
+    }
+    unsigned int capacity = (std::max)(m_batchCapacity, kInitialMorphBatches);
+    while (capacity < batchCount) capacity *= 2;
+
+    SAFE_RELEASE(m_batchSRV);
+    SAFE_RELEASE(m_batchBuffer);
+    m_batchCapacity = 0;
+
+    D3D11_BUFFER_DESC desc = {};
+    desc.Usage = D3D11_USAGE_DYNAMIC;
+    desc.ByteWidth = capacity * sizeof(MorphBatch);
+    desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+    desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+    desc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+    desc.StructureByteStride = sizeof(MorphBatch);
+    HRESULT hr = m_device->CreateBuffer(&desc, nullptr, &m_batchBuffer);
+
+    D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+    srvDesc.Format = DXGI_FORMAT_UNKNOWN;
+    srvDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+    srvDesc.Buffer.FirstElement = 0;
+    srvDesc.Buffer.NumElements = capacity;
+    if (SUCCEEDED(hr)) { hr = m_device->CreateShaderResourceView(m_batchBuffer, &srvDesc, &m_batchSRV); }
+    if (FAILED(hr)) {
+        return hr;
+    }
+    m_batchCapacity = capacity;
+    return S_OK;
+}
+
+void SkinningSystem::release(SkinnedMesh& mesh) {
+    for (Page& page : mesh.pages) {
+        SAFE_RELEASE(page.vertices);
+        SAFE_RELEASE(page.positions);
+    }
+    mesh.pages.clear();
+    SAFE_RELEASE(mesh.sourcesSRV);
+    SAFE_RELEASE(mesh.sources);
+    SAFE_RELEASE(mesh.morphDeltasSRV);
+    SAFE_RELEASE(mesh.morphDeltas);
+    SAFE_RELEASE(mesh.morphOffsetsUAV);
+    SAFE_RELEASE(mesh.morphOffsets);
+}
+
+void SkinningSystem::destroy() {
+    for (SkinnedMesh& mesh : m_meshes) {
+        release(mesh);
+    }
+    m_meshes.clear();
+    m_free.clear();
+    m_instanceByAsset.Clear();
+    m_palettes.clear();
+    m_batches.clear();
+    SAFE_RELEASE(m_shader);
+    SAFE_RELEASE(m_morphShader);
+    SAFE_RELEASE(m_params);
+    SAFE_RELEASE(m_paletteSRV);
+    SAFE_RELEASE(m_paletteBuffer);
+    m_paletteCapacity = 0;
+    SAFE_RELEASE(m_batchSRV);
+    SAFE_RELEASE(m_batchBuffer);
+    m_batchCapacity = 0;
+    m_device = nullptr;
+    m_skinnedCount = 0;
+    m_skippedCount = 0;
+    m_morphDeltaCount = 0;
+}
@@ -0,0 +1,246 @@
+﻿/**
+ * @file SpriteBatch.cpp
+ * @brief Implementación del lote de sprites: resolución de texturas, reparto por
+ * grupos y dibujo instanciado.
+ */
+
+#include "SpriteBatch.h"
+#include "Device.h"
+#include "DeviceContext.h"
+#include "VertexLayout.h"
+#include "Texture.h"
+#include "TextureArrayPool.h"
+#include <algorithm>
+
+const ConstantBufferLayouts::Registration SpriteBatch::kSpriteLayout({ "cbSprite", CB_SLOT_OBJECT,
+    sizeof(CBSprite), { CB_FIELD(CBSprite, screen, "Screen") } });
+
+HRESULT SpriteBatch::init(Device& device) {
+    if (!device.m_device) {
+        ERROR("SpriteBatch", "init", "Device is null.");
+        return E_POINTER;
+    }
+    destroy();
+
+    const std::vector<D3D11_INPUT_ELEMENT_DESC> layout = VertexLayout()
+        .add("SPRITE_RECT", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, VERTEX_STREAM_INSTANCE, true)
+        .add("SPRITE_UV", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, VERTEX_STREAM_INSTANCE, true)
+        .add("INSTANCE_COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, VERTEX_STREAM_INSTANCE, true)
+        .add("SPRITE_PARAMS", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, VERTEX_STREAM_INSTANCE, true)
+        .getDesc();
+
+    HRESULT hr = m_program.init(device, "Sprite.fx", layout);
+    if (SUCCEEDED(hr)) { hr = m_arrayProgram.init(device, "Sprite.fx", layout, { { "TEXTURE_ARRAY", "1" } }); }
+    if (SUCCEEDED(hr)) {
+        hr = m_instanceBuffer.initDynamic(device, kInitialSprites * sizeof(InstanceData),
+            sizeof(InstanceData), D3D11_BIND_VERTEX_BUFFER);
+        m_instanceCapacity = SUCCEEDED(hr) ? kInitialSprites : 0;
+    }
+    if (SUCCEEDED(hr)) { hr = m_constants.init(device); }
+    if (SUCCEEDED(hr)) { hr = m_blendState.init(device, true); }
+    if (SUCCEEDED(hr)) { hr = m_rasterizer.init(device, 0, 0.0f, D3D11_CULL_NONE); }
+    if (SUCCEEDED(hr)) { hr = m_noDepth.init(device, false, false, false); }
+    if (SUCCEEDED(hr)) {
+        D3D11_SAMPLER_DESC desc = {};
+        desc.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+        desc.AddressU = D3D11_TEXTURE_ADDRESS_CLAMP;
+        desc.AddressV = D3D11_TEXTURE_ADDRESS_CLAMP;
+        desc.AddressW = D3D11_TEXTURE_ADDRESS_CLAMP;
+        desc.ComparisonFunc = D3D11_COMPARISON_NEVER;
+        desc.MaxLOD = D3D11_FLOAT32_MAX;
+        hr = device.CreateSharedSamplerState(&desc, &m_sampler);
+    }
+    if (SUCCEEDED(hr)) {
+        const unsigned int white = 0xffffffff;
+        D3D11_TEXTURE2D_DESC desc = {};
+        desc.Width = 1;
+        desc.Height = 1;
+        desc.MipLevels = 1;
+        desc.ArraySize = 1;
+        desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        desc.SampleDesc.Count = 1;
+        desc.Usage = D3D11_USAGE_IMMUTABLE;
+        desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+        D3D11_SUBRESOURCE_DATA data = { &white, sizeof(white), 0 };
+        hr = device.CreateTexture2D(&desc, &data, &m_whiteTexture);
+    }
+    if (SUCCEEDED(hr)) { hr = device.CreateShaderResourceView(m_whiteTexture, nullptr, &m_whiteSRV); }
+    if (FAILED(hr)) {
+        ERROR("SpriteBatch", "init", ("Failed to create sprite resources. HRESULT: " + std::to_string(hr)).c_str());
+        destroy();
+        return hr;
+    }
+    m_device = &device;
+    return S_OK;
+}
+
+void SpriteBatch::add(const Sprite& sprite) {
+    if (!isReady() || sprite.size.x == 0.0f || sprite.size.y == 0.0f || sprite.color.w <= 0.0f) {
+        return;
+    }
+    m_pending.push_back(sprite);
+}
+
+void SpriteBatch::capture() {
+    m_frame.swap(m_pending);
+    m_pending.clear();
+}
+
+/**
+ * @details Tres pasadas sobre los sprites, todas lineales:
+ * 1. Cada textura distinta se resuelve una vez (pool o SRV suelta) a un binding; las
+ *    texturas del mismo array comparten binding y solo cambian de capa.
+ * 2. Se cuenta cuántos sprites caen en cada grupo (capa, binding) y se convierte el
+ *    conteo en el primer índice de cada grupo.
+ * 3. Cada sprite se escribe en su hueco del buffer mapeado.
+ */
+void SpriteBatch::render(DeviceContext& deviceContext, TextureArrayPool* textureArrays,
+    ID3D11RenderTargetView* rtv, unsigned int width, unsigned int height) {
+    m_lastSprites = 0;
+    m_lastDraws = 0;
+    const unsigned int count = static_cast<unsigned int>(m_frame.size());
+    if (!isReady() || count == 0 || width == 0 || height == 0) {
+        return;
+    }
+    DeviceContext::EventScope event(deviceContext, "Sprites");
+
+    m_bindings.clear();
+    m_resolved.clear();
+    m_spriteBinding.resize(count);
+    m_spriteSlice.resize(count);
+    for (unsigned int i = 0; i < count; ++i) {
+        const Texture* texture = m_frame[i].texture;
+        auto found = m_resolved.find(texture);
+        if (found == m_resolved.end()) {
+            Binding binding = { m_whiteSRV, false };
+            float slice = 0.0f;
+            if (texture && texture->srv()) {
+                binding.srv = texture->srv();
+                if (textureArrays && textureArrays->isReady()) {
+                    const TextureArrayPool::Slot slot = textureArrays->resolve(deviceContext, texture);
+                    if (slot.srv) {
+                        binding = { slot.srv, true };
+                        slice = static_cast<float>(slot.slice);
+                    }
+                }
+            }
+            unsigned int index = 0;
+            while (index < m_bindings.size() &&
+                (m_bindings[index].srv != binding.srv || m_bindings[index].array != binding.array)) {
+                ++index;
+            }
+            if (index == m_bindings.size()) {
+                m_bindings.push_back(binding);
+            }
+            found = m_resolved.emplace(texture, Resolved{ index, slice }).first;
+        }
+        m_spriteBinding[i] = found->second.binding;
+        m_spriteSlice[i] = found->second.slice;
+    }
+
+    const unsigned int bindingCount = static_cast<unsigned int>(m_bindings.size());
+    const unsigned int groupCount = kLayerCount * bindingCount;
+    m_offsets.assign(groupCount + 1, 0);
+    for (unsigned int i = 0; i < count; ++i) {
+        const unsigned int layer = (std::min)(m_frame[i].layer, kLayerCount - 1);
+        ++m_offsets[layer * bindingCount + m_spriteBinding[i] + 1];
+    }
+    for (unsigned int group = 0; group < groupCount; ++group) {
+        m_offsets[group + 1] += m_offsets[group];
+    }
+
+    if (count > m_instanceCapacity) {
+        unsigned int capacity = (std::max)(m_instanceCapacity, kInitialSprites);
+        while (capacity < count) capacity *= 2;
+        m_instanceBuffer.destroy();
+        m_instanceCapacity = 0;
+        if (FAILED(m_instanceBuffer.initDynamic(*m_device, capacity * sizeof(InstanceData),
+            sizeof(InstanceData), D3D11_BIND_VERTEX_BUFFER))) {
+            ERROR("SpriteBatch", "render", "Failed to grow the instance buffer");
+            return;
+        }
+        m_instanceCapacity = capacity;
+    }
+    D3D11_MAPPED_SUBRESOURCE mapped = {};
+    if (FAILED(m_instanceBuffer.map(deviceContext, D3D11_MAP_WRITE_DISCARD, 0, mapped))) {
+        return;
+    }
+    // `m_offsets[g]` avanza al escribir: al terminar apunta al final del grupo g, que es
+    // el inicio del g + 1; el inicio del grupo g queda en `m_offsets[g - 1]` (0 para el primero).
+    InstanceData* instances = static_cast<InstanceData*>(mapped.pData);
+    for (unsigned int i = 0; i < count; ++i) {
+        const Sprite& sprite = m_frame[i];
+        const unsigned int layer = (std::min)(sprite.layer, kLayerCount - 1);
+        InstanceData& instance = instances[m_offsets[layer * bindingCount + m_spriteBinding[i]]++];
+        instance.rect = XMFLOAT4(sprite.position.x, sprite.position.y, sprite.size.x, sprite.size.y);
+        instance.uv = sprite.uv;
+        instance.color = sprite.color;
+        instance.rotation = sprite.rotation;
+        instance.slice = m_spriteSlice[i];
+        instance.padding[0] = 0.0f;
+        instance.padding[1] = 0.0f;
+    }
+    m_instanceBuffer.unmap(deviceContext);
+
+    CBSprite constants;
+    constants.screen = XMFLOAT4(2.0f / width, 2.0f / height, 0.0f, 0.0f);
+    m_constants.set(constants);
+    m_constants.update(deviceContext);
+    m_constants.render(deviceContext, CB_SLOT_OBJECT);
+
+    D3D11_VIEWPORT viewport = {};
+    viewport.Width = static_cast<float>(width);
+    viewport.Height = static_cast<float>(height);
+    viewport.MaxDepth = 1.0f;
+    deviceContext.RSSetViewports(1, &viewport);
+    deviceContext.OMSetRenderTargets(1, &rtv, nullptr);
+    m_blendState.render(deviceContext);
+    m_rasterizer.render(deviceContext);
+    m_noDepth.render(deviceContext);
+    deviceContext.PSSetSamplers(0, 1, &m_sampler);
+    deviceContext.IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+    m_instanceBuffer.render(deviceContext, VERTEX_STREAM_INSTANCE, 1);
+
+    const ShaderProgram* bound = nullptr;
+    unsigned int first = 0;
+    for (unsigned int group = 0; group < groupCount; ++group) {
+        const unsigned int end = m_offsets[group];
+        if (end == first) {
+            continue;
+        }
+        const Binding& binding = m_bindings[group % bindingCount];
+        ShaderProgram* program = binding.array ? &m_arrayProgram : &m_program;
+        if (program != bound) {
+            program->render(deviceContext);
+            bound = program;
+        }
+        deviceContext.PSSetShaderResources(0, 1, &binding.srv);
+        deviceContext.DrawInstanced(4, end - first, 0, first);
+        first = end;
+        ++m_lastDraws;
+    }
+    m_lastSprites = count;
+
+    ID3D11ShaderResourceView* nullSRV = nullptr;
+    deviceContext.PSSetShaderResources(0, 1, &nullSRV);
+    m_blendState.render(deviceContext, nullptr, 0xffffffff, true);
+    m_noDepth.render(deviceContext, 0, true);
+}
+
+void SpriteBatch::destroy() {
+    m_program.destroy();
+    m_arrayProgram.destroy();
+    m_instanceBuffer.destroy();
+    m_instanceCapacity = 0;
+    m_constants.destroy();
+    m_blendState.destroy();
+    m_rasterizer.destroy();
+    m_noDepth.destroy();
+    SAFE_RELEASE(m_sampler);
+    SAFE_RELEASE(m_whiteSRV);
+    SAFE_RELEASE(m_whiteTexture);
+    m_pending.clear();
+    m_frame.clear();
+    m_resolved.clear();
+    m_device = nullptr;
+}
@@ -0,0 +1,134 @@
+﻿/**
+ * @file StallDetector.cpp
+ * @brief Medida de las esperas a la GPU, contadores por frame y avisos limitados por sitio.
+ */
+
+#include "StallDetector.h"
+
+namespace {
+    const char* const kKindNames[STALL_KIND_COUNT] = { "Map", "UpdateSubresource", "GetData", "Present" };
+
+    /// Solo el nombre del archivo (las rutas del compilador son absolutas).
+    const char* fileName(const char* path) {
+        const char* name = path;
+        for (const char* c = path; *c; ++c) {
+            if (*c == '\\' || *c == '/') {
+                name = c + 1;
+            }
+        }
+        return name;
+    }
+
+    /// 1, 2, 4, 8...: las veces que un sitio vuelve a avisar.
+    bool isPowerOfTwo(unsigned long long value) {
+        return value != 0 && (value & (value - 1)) == 0;
+    }
+}
+
+StallDetector& StallDetector::getDefault() {
+    static StallDetector s_detector;
+    return s_detector;
+}
+
+StallDetector::StallDetector() {
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    m_ticksToMs = 1000.0 / static_cast<double>(frequency.QuadPart);
+}
+
+StallDetector::Scope::Scope(StallKind kind, ID3D11Resource* resource, const std::source_location& location)
+    : m_kind(kind), m_resource(resource), m_location(location) {
+    if (StallDetector::getDefault().getThreshold() > 0.0) {
+        LARGE_INTEGER now;
+        QueryPerformanceCounter(&now);
+        m_start = now.QuadPart;
+    }
+}
+
+StallDetector::Scope::~Scope() {
+    if (m_start == 0) {
+        return;
+    }
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    StallDetector& detector = StallDetector::getDefault();
+    const double ms = static_cast<double>(now.QuadPart - m_start) * detector.m_ticksToMs;
+    if (ms > detector.getThreshold()) {
+        detector.report(m_kind, ms, m_resource, m_location);
+    }
+}
+
+void StallDetector::report(StallKind kind, double ms, ID3D11Resource* resource, const std::source_location& location) {
+    Stall stall;
+    stall.kind = kind;
+    stall.ms = ms;
+    stall.file = fileName(location.file_name());
+    stall.line = location.line();
+    describe(resource, stall.resource, sizeof(stall.resource));
+
+    unsigned long long siteCount = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_frame.count[kind];
+        m_frame.ms[kind] += ms;
+        m_recent[m_recentNext] = stall;
+        m_recentNext = (m_recentNext + 1) % kRecentStalls;
+        m_recentCount = (std::min)(m_recentCount + 1, kRecentStalls);
+        // El puntero al archivo (un literal por archivo) y la línea identifican el sitio
+        // sin formatear nada.
+        const uint64_t site = (static_cast<uint64_t>(reinterpret_cast<uintptr_t>(location.file_name())) << 20) ^
+            location.line();
+        siteCount = ++m_siteCounts[site];
+    }
+    if (isPowerOfTwo(siteCount)) {
+        LOG_WARNING("StallDetector", "CPU waited " << ms << " ms on the GPU in " << kKindNames[kind] << " at " <<
+            stall.file << ":" << stall.line << " (" << stall.resource << "), occurrence " << siteCount);
+    }
+}
+
+void StallDetector::describe(ID3D11Resource* resource, char* out, size_t size) {
+    if (!resource) {
+        snprintf(out, size, "-");
+        return;
+    }
+    UINT nameSize = static_cast<UINT>(size - 1);
+    if (SUCCEEDED(resource->GetPrivateData(WKPDID_D3DDebugObjectName, &nameSize, out))) {
+        out[nameSize] = '\0';
+        return;
+    }
+    D3D11_RESOURCE_DIMENSION dimension;
+    resource->GetType(&dimension);
+    if (dimension == D3D11_RESOURCE_DIMENSION_BUFFER) {
+        D3D11_BUFFER_DESC desc;
+        static_cast<ID3D11Buffer*>(resource)->GetDesc(&desc);
+        snprintf(out, size, "buffer %u B, usage %d, bind 0x%x", desc.ByteWidth, static_cast<int>(desc.Usage), desc.BindFlags);
+    }
+    else if (dimension == D3D11_RESOURCE_DIMENSION_TEXTURE2D) {
+        D3D11_TEXTURE2D_DESC desc;
+        static_cast<ID3D11Texture2D*>(resource)->GetDesc(&desc);
+        snprintf(out, size, "texture %ux%u, format %d, usage %d", desc.Width, desc.Height,
+            static_cast<int>(desc.Format), static_cast<int>(desc.Usage));
+    }
+    else {
+        snprintf(out, size, "resource %p", static_cast<void*>(resource));
+    }
+}
+
+void StallDetector::endFrame() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_lastFrame = m_frame;
+    m_frame = FrameStats();
+}
+
+unsigned int StallDetector::getRecent(Stall* out, unsigned int capacity) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const unsigned int count = (std::min)(m_recentCount, capacity);
+    for (unsigned int i = 0; i < count; ++i) {
+        out[i] = m_recent[(m_recentNext + kRecentStalls - 1 - i) % kRecentStalls];
+    }
+    return count;
+}
+
+const char* StallDetector::getKindName(StallKind kind) {
+    return kind < STALL_KIND_COUNT ? kKindNames[kind] : "?";
+}
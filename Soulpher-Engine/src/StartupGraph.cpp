@@ -0,0 +1,179 @@
+﻿/**
+ * @file StartupGraph.cpp
+ * @brief Reparto de las tareas de arranque, frame de carga y resumen de tiempos.
+ */
+
+#include "StartupGraph.h"
+#include "JobSystem.h"
+#include "StartupTimeline.h"
+#include <algorithm>
+
+StartupGraph::~StartupGraph() {
+    if (m_finishedEvent) {
+        CloseHandle(m_finishedEvent);
+    }
+}
+
+StartupGraph::Task StartupGraph::add(const char* name, std::function<HRESULT()> function,
+    std::initializer_list<Task> dependencies, unsigned int flags) {
+    std::unique_ptr<Node> node(new Node());
+    node->name = name;
+    node->function = std::move(function);
+    node->flags = flags;
+    for (Task dependency : dependencies) {
+        if (dependency < m_nodes.size()) {
+            node->dependencies.push_back(dependency);
+        }
+        else {
+            ERROR("StartupGraph", "add", (std::string("Unknown dependency for ") + name).c_str());
+        }
+    }
+    m_nodes.push_back(std::move(node));
+    return static_cast<Task>(m_nodes.size() - 1);
+}
+
+bool StartupGraph::isReady(const Node& node) const {
+    for (Task dependency : node.dependencies) {
+        if (!m_nodes[dependency]->finished.load(std::memory_order_acquire)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void StartupGraph::execute(Task task) {
+    Node& node = *m_nodes[task];
+    LARGE_INTEGER begin, end;
+    QueryPerformanceCounter(&begin);
+    node.result = node.function();
+    QueryPerformanceCounter(&end);
+    node.ms = static_cast<double>(end.QuadPart - begin.QuadPart) * m_ticksToMs;
+    StartupTimeline::getDefault().record("Startup", node.name, begin.QuadPart, end.QuadPart);
+    node.finished.store(true, std::memory_order_release);
+    if (m_finishedEvent) {
+        SetEvent(m_finishedEvent);
+    }
+}
+
+void StartupGraph::taskJob(Job& job, const void* data) {
+    UNREFERENCED_PARAMETER(job);
+    const JobData& jobData = *static_cast<const JobData*>(data);
+    jobData.graph->execute(jobData.task);
+}
+
+HRESULT StartupGraph::run(const std::function<void()>& idle, unsigned int idleIntervalMs) {
+    LARGE_INTEGER frequency, start;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&start);
+    m_ticksToMs = 1000.0 / static_cast<double>(frequency.QuadPart);
+    if (!m_finishedEvent) {
+        m_finishedEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    }
+
+    JobSystem& jobs = JobSystem::getDefault();
+    // Sin workers (un núcleo) nadie robaría los trabajos: todo en este hilo.
+    const bool parallel = jobs.getThreadCount() > 1 && m_finishedEvent;
+    HRESULT failure = S_OK;
+    Task failedTask = 0;
+    size_t finished = 0;
+    size_t running = 0;
+    std::vector<bool> counted(m_nodes.size(), false);
+    DWORD lastIdle = GetTickCount();
+
+    while (finished < m_nodes.size()) {
+        // Recoger lo terminado.
+        for (size_t i = 0; i < m_nodes.size(); ++i) {
+            Node& node = *m_nodes[i];
+            if (counted[i] || !node.finished.load(std::memory_order_acquire)) {
+                continue;
+            }
+            counted[i] = true;
+            ++finished;
+            if (!(node.flags & TASK_MAIN_THREAD)) {
+                --running;
+            }
+            if (FAILED(node.result) && SUCCEEDED(failure)) {
+                failure = node.result;
+                failedTask = static_cast<Task>(i);
+            }
+        }
+        if (FAILED(failure)) {
+            // No se lanza nada más; solo se espera a lo que está en marcha.
+            if (running == 0) {
+                break;
+            }
+        }
+        else {
+            // Lanzar lo que ya tiene sus dependencias; lo del hilo principal, en el acto.
+            bool launched = false;
+            for (size_t i = 0; i < m_nodes.size() && SUCCEEDED(failure); ++i) {
+                Node& node = *m_nodes[i];
+                if (node.started || !isReady(node)) {
+                    continue;
+                }
+                node.started = true;
+                launched = true;
+                if (node.flags & TASK_MAIN_THREAD) {
+                    execute(static_cast<Task>(i));
+                    break;  // Puede haber liberado otras: volver a recoger.
+                }
+                Job* job = nullptr;
+                if (parallel) {
+                    const JobData data = { this, static_cast<Task>(i) };
+                    job = jobs.createJob(&StartupGraph::taskJob, &data, sizeof(data));
+                }
+                ++running;
+                if (job) {
+                    jobs.run(job);
+                }
+                else {
+                    execute(static_cast<Task>(i));
+                }
+            }
+            if (launched) {
+                continue;
+            }
+        }
+
+        if (running == 0) {
+            // Nada en marcha ni nada listo: una dependencia que nunca termina.
+            failure = E_FAIL;
+            while (failedTask < m_nodes.size() && m_nodes[failedTask]->started) {
+                ++failedTask;
+            }
+            break;
+        }
+        WaitForSingleObject(m_finishedEvent, idleIntervalMs);
+        if (idle && GetTickCount() - lastIdle >= idleIntervalMs) {
+            idle();
+            lastIdle = GetTickCount();
+        }
+    }
+
+    LARGE_INTEGER end;
+    QueryPerformanceCounter(&end);
+    m_wallMs = static_cast<double>(end.QuadPart - start.QuadPart) * m_ticksToMs;
+    m_totalMs = 0.0;
+    m_criticalPathMs = 0.0;
+    // Las dependencias tienen índice menor: un recorrido en orden basta.
+    for (const std::unique_ptr<Node>& node : m_nodes) {
+        double longest = 0.0;
+        for (Task dependency : node->dependencies) {
+            longest = (std::max)(longest, m_nodes[dependency]->pathMs);
+        }
+        node->pathMs = longest + node->ms;
+        m_totalMs += node->ms;
+        m_criticalPathMs = (std::max)(m_criticalPathMs, node->pathMs);
+    }
+
+    if (FAILED(failure)) {
+        ERROR("StartupGraph", "run", (std::string("Startup failed in ") + m_nodes[failedTask]->name +
+            ". hr=" + std::to_string(failure)).c_str());
+        return failure;
+    }
+    char summary[160];
+    sprintf_s(summary, "%u tasks in %.1f ms (%.1f ms serial, %.1f ms critical path)",
+        static_cast<unsigned int>(m_nodes.size()), m_wallMs, m_totalMs, m_criticalPathMs);
+    MESSAGE("StartupGraph", "run", summary);
+    return S_OK;
+}
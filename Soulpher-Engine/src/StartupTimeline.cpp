@@ -0,0 +1,196 @@
+﻿/**
+ * @file StartupTimeline.cpp
+ * @brief Reloj desde la creación del proceso, intervalos del arranque y su JSON.
+ */
+
+#include "StartupTimeline.h"
+#include <cstdio>
+
+namespace {
+    const char* const kCacheNames[STARTUP_CACHE_COUNT] = { "shader", "mesh" };
+
+    /// Escribe `text` como cadena JSON (las rutas llevan `\`).
+    void writeJsonString(FILE* file, const std::string& text) {
+        fputc('"', file);
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                fputc('\\', file);
+                fputc(c, file);
+            }
+            else if (static_cast<unsigned char>(c) < 0x20) {
+                fprintf(file, "\\u%04x", static_cast<unsigned int>(static_cast<unsigned char>(c)));
+            }
+            else {
+                fputc(c, file);
+            }
+        }
+        fputc('"', file);
+    }
+}
+
+StartupTimeline::Scope::Scope(const char* category, const std::string& name)
+    : m_category(category) {
+    if (StartupTimeline::getDefault().isRecording()) {
+        m_name = name;
+        LARGE_INTEGER now;
+        QueryPerformanceCounter(&now);
+        m_begin = now.QuadPart;
+    }
+}
+
+StartupTimeline::Scope::~Scope() {
+    if (m_begin == 0) {
+        return;
+    }
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    StartupTimeline::getDefault().record(m_category, m_name, m_begin, now.QuadPart);
+}
+
+StartupTimeline& StartupTimeline::getDefault() {
+    static StartupTimeline s_timeline;
+    return s_timeline;
+}
+
+StartupTimeline::StartupTimeline() {
+    LARGE_INTEGER frequency, now;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&now);
+    m_ticksToMs = 1000.0 / static_cast<double>(frequency.QuadPart);
+    m_originTicks = now.QuadPart;
+    m_mainThread = GetCurrentThreadId();
+
+    // Cuánto lleva vivo el proceso ahora mismo (unidades de 100 ns en los FILETIME).
+    FILETIME creation, exitTime, kernel, user, current;
+    if (GetProcessTimes(GetCurrentProcess(), &creation, &exitTime, &kernel, &user)) {
+        GetSystemTimePreciseAsFileTime(&current);
+        ULARGE_INTEGER created, nowTime;
+        created.LowPart = creation.dwLowDateTime;
+        created.HighPart = creation.dwHighDateTime;
+        nowTime.LowPart = current.dwLowDateTime;
+        nowTime.HighPart = current.dwHighDateTime;
+        if (nowTime.QuadPart > created.QuadPart) {
+            m_originProcessMs = static_cast<double>(nowTime.QuadPart - created.QuadPart) / 10000.0;
+        }
+    }
+    m_spans.reserve(256);
+}
+
+double StartupTimeline::toProcessMs(LONGLONG ticks) const {
+    return m_originProcessMs + static_cast<double>(ticks - m_originTicks) * m_ticksToMs;
+}
+
+double StartupTimeline::getProcessMs() const {
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return toProcessMs(now.QuadPart);
+}
+
+void StartupTimeline::record(const char* category, const std::string& name, LONGLONG begin, LONGLONG end) {
+    if (!isRecording()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_spans.size() < kMaxSpans) {
+        m_spans.push_back({ category, name, begin, end, GetCurrentThreadId() });
+    }
+}
+
+void StartupTimeline::recordCache(StartupCache cache, bool hit) {
+    if (!isRecording() || cache >= STARTUP_CACHE_COUNT) {
+        return;
+    }
+    (hit ? m_hits : m_misses)[cache].fetch_add(1, std::memory_order_relaxed);
+}
+
+bool StartupTimeline::isWarmStart() const {
+    for (int c = 0; c < STARTUP_CACHE_COUNT; ++c) {
+        if (m_misses[c].load(std::memory_order_relaxed) > 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void StartupTimeline::setGraphTimes(double wallMs, double serialMs, double criticalPathMs) {
+    m_graphWallMs = wallMs;
+    m_graphSerialMs = serialMs;
+    m_graphCriticalMs = criticalPathMs;
+}
+
+void StartupTimeline::markFirstFrame() {
+    double expected = 0.0;
+    const double firstFrameMs = getProcessMs();
+    if (!m_firstFrameMs.compare_exchange_strong(expected, firstFrameMs)) {
+        return;
+    }
+
+    std::string caches;
+    for (int c = 0; c < STARTUP_CACHE_COUNT; ++c) {
+        const unsigned int hits = m_hits[c].load(std::memory_order_relaxed);
+        const unsigned int total = hits + m_misses[c].load(std::memory_order_relaxed);
+        char line[96];
+        sprintf_s(line, ", %s cache %u/%u hits (%.0f%%)", kCacheNames[c], hits, total,
+            total > 0 ? 100.0 * hits / total : 100.0);
+        caches += line;
+    }
+    char summary[256];
+    sprintf_s(summary, "First frame at %.1f ms since process creation (%s start); graph %.1f ms, "
+        "critical path %.1f ms, serial %.1f ms",
+        firstFrameMs, isWarmStart() ? "warm" : "cold", m_graphWallMs, m_graphCriticalMs, m_graphSerialMs);
+    MESSAGE("StartupTimeline", "markFirstFrame", (summary + caches).c_str());
+}
+
+/**
+ * @details El JSON se escribe en el hilo que llama (una vez, unos cientos de eventos):
+ * un "X" por intervalo, en microsegundos desde la creación del proceso, y los hitos
+ * (primer frame, fin de la carga) como eventos instantáneos "i".
+ */
+HRESULT StartupTimeline::finish(const std::string& path) {
+    if (!m_recording.exchange(false)) {
+        return S_FALSE;
+    }
+    const double loadedMs = getProcessMs();
+    char summary[128];
+    sprintf_s(summary, "Scene loaded at %.1f ms since process creation (%s start)",
+        loadedMs, isWarmStart() ? "warm" : "cold");
+    MESSAGE("StartupTimeline", "finish", summary);
+    if (path.empty()) {
+        return S_OK;
+    }
+
+    FILE* file = nullptr;
+    if (fopen_s(&file, path.c_str(), "w") != 0 || !file) {
+        ERROR("StartupTimeline", "finish", ("Cannot write " + path).c_str());
+        return HRESULT_FROM_WIN32(ERROR_ACCESS_DENIED);
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", file);
+    fprintf(file, "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%lu,\"args\":{\"name\":\"Main\"}}",
+        static_cast<unsigned long>(m_mainThread));
+    for (const Span& span : m_spans) {
+        fputs(",\n{\"ph\":\"X\",\"cat\":", file);
+        writeJsonString(file, span.category);
+        fputs(",\"name\":", file);
+        writeJsonString(file, span.name);
+        fprintf(file, ",\"pid\":1,\"tid\":%lu,\"ts\":%.3f,\"dur\":%.3f}",
+            static_cast<unsigned long>(span.thread), toProcessMs(span.begin) * 1000.0,
+            static_cast<double>(span.end - span.begin) * m_ticksToMs * 1000.0);
+    }
+    const double firstFrameMs = getFirstFrameMs();
+    if (firstFrameMs > 0.0) {
+        fprintf(file, ",\n{\"ph\":\"i\",\"s\":\"g\",\"name\":\"First frame\",\"pid\":1,\"tid\":%lu,\"ts\":%.3f}",
+            static_cast<unsigned long>(m_mainThread), firstFrameMs * 1000.0);
+    }
+    fprintf(file, ",\n{\"ph\":\"i\",\"s\":\"g\",\"name\":\"Scene loaded\",\"pid\":1,\"tid\":%lu,\"ts\":%.3f}",
+        static_cast<unsigned long>(m_mainThread), loadedMs * 1000.0);
+    fputs("\n]}\n", file);
+    const bool failed = ferror(file) != 0;
+    fclose(file);
+    if (failed) {
+        ERROR("StartupTimeline", "finish", ("Failed writing " + path).c_str());
+        return E_FAIL;
+    }
+    MESSAGE("StartupTimeline", "finish", ("Startup timeline written to " + path).c_str());
+    return S_OK;
+}
@@ -0,0 +1,303 @@
+﻿/**
+ * @file StaticBatcher.cpp
+ * @brief Implementación del horneado de lotes estáticos.
+ *
+ * @details
+ * Los vértices se llevan a mundo en CPU (las posiciones de `MeshAsset::m_meshes` están
+ * sin cuantizar, en espacio de modelo). Los meshlets de las mallas de origen no se
+ * copian: sus rangos dejan de valer al concatenar, y `MeshAsset::init` vuelve a partir
+ * cada submalla del lote.
+ */
+
+#include "StaticBatcher.h"
+#include "Device.h"
+#include "DeviceContext.h"
+#include "MeshComponent.h"
+#include "ECS/Transform.h"
+#include "EngineUtilities/Utilities/BatchMath.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+const float StaticBatcher::kDefaultCellSize = 32.0f;
+
+namespace {
+    /// Lo que debe compartir una submalla para caer en el mismo lote.
+    struct BatchKey {
+        Texture* texture;
+        const Material* material;   ///< Material de la submalla (nulo = estados del actor).
+        float color[4];
+        bool castShadow;
+        bool receiveShadow;
+        int cellX;
+        int cellZ;
+
+        bool operator<(const BatchKey& o) const {
+            if (texture != o.texture) { return texture < o.texture; }
+            if (material != o.material) { return material < o.material; }
+            if (cellX != o.cellX) { return cellX < o.cellX; }
+            if (cellZ != o.cellZ) { return cellZ < o.cellZ; }
+            for (int i = 0; i < 4; ++i) {
+                if (color[i] != o.color[i]) { return color[i] < o.color[i]; }
+            }
+            if (castShadow != o.castShadow) { return castShadow < o.castShadow; }
+            return receiveShadow < o.receiveShadow;
+        }
+    };
+
+    struct BatchItem {
+        Actor* actor;
+        unsigned int submesh;
+    };
+
+    struct BatchGroup {
+        TextureHandle texture;          ///< Textura de todas las submallas del grupo.
+        MaterialHandle material;        ///< Su material, si lo tienen.
+        std::vector<BatchItem> items;
+        std::vector<Actor*> sources;    ///< Actores con alguna submalla en el grupo.
+    };
+
+    /// Añade una submalla, en mundo, al final de `target`.
+    void appendWorld(MeshComponent& target, const MeshComponent& source, const XMMATRIX& world, bool flip) {
+        const unsigned int base = static_cast<unsigned int>(target.m_vertex.size());
+        target.m_vertex.insert(target.m_vertex.end(), source.m_vertex.begin(), source.m_vertex.end());
+        if (!source.m_vertex.empty()) {
+            // Matriz de mundo afín: la transformación por lotes no divide por w.
+            EU::Matrix4x4 matrix;
+            XMStoreFloat4x4(reinterpret_cast<XMFLOAT4X4*>(matrix.m), world);
+            SimpleVertex* appended = &target.m_vertex[base];
+            EU::TransformPoints(matrix, &appended->Pos, sizeof(SimpleVertex),
+                &appended->Pos, sizeof(SimpleVertex), source.m_vertex.size());
+        }
+        target.m_index.reserve(target.m_index.size() + source.m_index.size());
+        for (size_t i = 0; i + 2 < source.m_index.size(); i += 3) {
+            // Con espejo (determinante negativo) el orden de los vértices se invierte.
+            target.m_index.push_back(base + source.m_index[i]);
+            target.m_index.push_back(base + source.m_index[flip ? i + 2 : i + 1]);
+            target.m_index.push_back(base + source.m_index[flip ? i + 1 : i + 2]);
+        }
+        target.m_numVertex = static_cast<int>(target.m_vertex.size());
+        target.m_numIndex = static_cast<int>(target.m_index.size());
+    }
+}
+
+bool StaticBatcher::isCandidate(Actor& actor) {
+    // Los lotes se crean sin copia de CPU: nunca vuelven a entrar como candidatos.
+    // Con lightmap, el actor se dibuja solo: el lote no tiene UV2 ni un rectángulo por actor.
+    const EU::TSharedPointer<MeshAsset>& asset = actor.getMeshAsset();
+    return actor.isStatic() && !actor.isTransparent() && !actor.hasLightmap() && !asset.isNull() &&
+        asset->hasCpuData() && asset->getLODCount() == 1 && asset->getSubmeshCount() > 0 &&
+        actor.hasComponent<Transform>();
+}
+
+uint64_t StaticBatcher::computeFingerprint(const std::vector<ActorHandle>& actors) const {
+    uint64_t hash = EU::kFnv1aSeed;
+    bool any = false;
+    for (ActorHandle actor : actors) {
+        if (actor.isNull() || !isCandidate(*actor)) {
+            continue;
+        }
+        any = true;
+        Transform* transform = actor->getComponent<Transform>();
+        const MeshAsset* asset = actor->getMeshAsset().get();
+        const XMFLOAT4& color = actor->getColor();
+        const bool flags[2] = { actor->canCastShadow(), actor->getReceiveShadow() };
+        // El handle y no la dirección: un actor nuevo puede reutilizar el hueco de uno destruido.
+        EU::Fnv1a(hash, &actor.value, sizeof(actor.value));
+        EU::Fnv1a(hash, &asset, sizeof(asset));
+        EU::Fnv1a(hash, &transform->getPosition(), sizeof(EU::Vector3));
+        EU::Fnv1a(hash, &transform->getRotation(), sizeof(EU::Quaternion));
+        EU::Fnv1a(hash, &transform->getScale(), sizeof(EU::Vector3));
+        EU::Fnv1a(hash, &color, sizeof(color));
+        EU::Fnv1a(hash, flags, sizeof(flags));
+        for (const TextureHandle& texture : actor->getTextures()) {
+            const Texture* tex = texture.get();
+            EU::Fnv1a(hash, &tex, sizeof(tex));
+        }
+        for (const MaterialHandle& material : actor->getMaterials()) {
+            const Material* mat = material.get();
+            EU::Fnv1a(hash, &mat, sizeof(mat));
+        }
+    }
+    if (!any) {
+        return 0;
+    }
+    EU::Fnv1a(hash, &m_cellSize, sizeof(m_cellSize));
+    return hash ? hash : 1;
+}
+
+bool StaticBatcher::update(Device& device, DeviceContext& deviceContext,
+    std::vector<ActorHandle>& actors) {
+    if (!m_enabled) {
+        if (!m_batches.empty() || !m_sources.empty()) {
+            destroy(actors);
+        }
+        return false;
+    }
+    if (computeFingerprint(actors) == m_fingerprint) {
+        return false;
+    }
+    bake(device, deviceContext, actors);
+    return true;
+}
+
+HRESULT StaticBatcher::bake(Device& device, DeviceContext& deviceContext,
+    std::vector<ActorHandle>& actors) {
+    destroy(actors);
+
+    // 1) Agrupar las submallas de los candidatos por celda y material.
+    std::map<BatchKey, BatchGroup> groups;
+    for (ActorHandle actor : actors) {
+        if (actor.isNull() || !isCandidate(*actor)) {
+            continue;
+        }
+        Transform* transform = actor->getComponent<Transform>();
+        transform->update(0.0f);
+
+        XMFLOAT3 center;
+        XMFLOAT3 mn, mx;
+        if (actor->getWorldBounds(mn, mx)) {
+            center = XMFLOAT3((mn.x + mx.x) * 0.5f, (mn.y + mx.y) * 0.5f, (mn.z + mx.z) * 0.5f);
+        }
+        else {
+            const EU::Vector3& pos = transform->getPosition();
+            center = XMFLOAT3(pos.x, pos.y, pos.z);
+        }
+
+        BatchKey key;
+        const XMFLOAT4& color = actor->getColor();
+        key.color[0] = color.x;
+        key.color[1] = color.y;
+        key.color[2] = color.z;
+        key.color[3] = color.w;
+        key.castShadow = actor->canCastShadow();
+        key.receiveShadow = actor->getReceiveShadow();
+        key.cellX = static_cast<int>(std::floor(center.x / m_cellSize));
+        key.cellZ = static_cast<int>(std::floor(center.z / m_cellSize));
+
+        const std::vector<TextureHandle>& textures = actor->getTextures();
+        const std::vector<MaterialHandle>& materials = actor->getMaterials();
+        const unsigned int submeshes = actor->getMeshAsset()->getSubmeshCount();
+        for (unsigned int i = 0; i < submeshes; ++i) {
+            const TextureHandle texture = i < textures.size() ? textures[i] : TextureHandle();
+            const MaterialHandle material = i < materials.size() ? materials[i] : MaterialHandle();
+            key.texture = texture.get();
+            key.material = material.get();
+            BatchGroup& group = groups[key];
+            group.texture = texture;
+            group.material = material;
+            group.items.push_back({ actor.get(), i });
+            if (group.sources.empty() || group.sources.back() != actor.get()) {
+                group.sources.push_back(actor.get());
+            }
+        }
+    }
+
+    // 2) Un actor por grupo con las submallas en mundo, partidas a 65 535 vértices.
+    HRESULT result = S_OK;
+    EU::TSet<Actor*> batched, incomplete;
+    for (auto& entry : groups) {
+        BatchGroup& group = entry.second;
+        std::vector<MeshComponent> meshes(1);
+        unsigned int triangles = 0;
+        for (const BatchItem& item : group.items) {
+            const MeshComponent& source = item.actor->getMeshAsset()->m_meshes[item.submesh];
+            if (!meshes.back().m_vertex.empty() &&
+                meshes.back().m_vertex.size() + source.m_vertex.size() > kMaxBatchVertices) {
+                meshes.emplace_back();
+            }
+            const XMMATRIX world = item.actor->getComponent<Transform>()->getMatrix();
+            const bool flip = XMVectorGetX(XMMatrixDeterminant(world)) < 0.0f;
+            appendWorld(meshes.back(), source, world, flip);
+            triangles += static_cast<unsigned int>(source.m_index.size() / 3);
+        }
+        for (size_t i = 0; i < meshes.size(); ++i) {
+            meshes[i].m_name = "StaticBatch" + std::to_string(m_batches.size()) + "_" + std::to_string(i);
+            meshes[i].computeBounds();
+        }
+
+        EU::TSharedPointer<MeshAsset> asset = EU::MakeShared<MeshAsset>();
+        HRESULT hr = asset->init(device, meshes, false);
+        if (FAILED(hr)) {
+            ERROR("StaticBatcher", "bake", "Failed to create a batch; its actors are drawn one by one");
+            asset->destroy();
+            incomplete.Append(group.sources);
+            if (SUCCEEDED(result)) { result = hr; }
+            continue;
+        }
+
+        ActorHandle batch = ActorPool::getDefault().spawn(device);
+        if (batch.isNull()) {
+            ERROR("StaticBatcher", "bake", "Actor pool is full; its actors are drawn one by one");
+            asset->destroy();
+            incomplete.Append(group.sources);
+            if (SUCCEEDED(result)) { result = E_OUTOFMEMORY; }
+            continue;
+        }
+        batch->setName("StaticBatch" + std::to_string(m_batches.size()));
+        batch->getComponent<Transform>()->setTransform(
+            EU::Vector3(0.0f, 0.0f, 0.0f), EU::Vector3(0.0f, 0.0f, 0.0f), EU::Vector3(1.0f, 1.0f, 1.0f));
+        batch->setMeshAsset(asset);
+        batch->setTextures(std::vector<TextureHandle>(asset->getSubmeshCount(), group.texture));
+        if (!group.material.isNull()) {
+            batch->setMaterials(std::vector<MaterialHandle>(asset->getSubmeshCount(), group.material));
+        }
+        const BatchKey& key = entry.first;
+        batch->setColor(XMFLOAT4(key.color[0], key.color[1], key.color[2], key.color[3]));
+        batch->setStatic(true);
+        batch->setCastShadow(key.castShadow);
+        batch->setReceiveShadow(key.receiveShadow);
+        batch->getComponent<Transform>()->update(0.0f);
+        batch->update(0.0f, deviceContext);
+        batch->capture(); // se crea con el render parado: listo para dibujarse ya
+
+        m_batches.push_back(batch);
+        actors.push_back(batch);
+        batched.Append(group.sources);
+        m_stats.sourceDraws += static_cast<unsigned int>(group.items.size());
+        m_stats.triangles += triangles;
+    }
+
+    // 3) Solo se apagan los actores cuyas submallas entraron todas en algún lote.
+    for (ActorHandle actor : actors) {
+        if (!actor.isNull() && batched.Contains(actor.get()) && !incomplete.Contains(actor.get())) {
+            actor->setBatched(true);
+            m_sources.push_back(actor);
+        }
+    }
+
+    m_stats.sourceActors = static_cast<unsigned int>(m_sources.size());
+    m_stats.batches = static_cast<unsigned int>(m_batches.size());
+    m_fingerprint = computeFingerprint(actors);
+    MESSAGE("StaticBatcher", "bake", ("Merged " + std::to_string(m_stats.sourceActors) + " static actors into " +
+        std::to_string(m_stats.batches) + " batches").c_str());
+    return result;
+}
+
+void StaticBatcher::destroy(std::vector<ActorHandle>& actors) {
+    EU::TSet<uint32_t> owned;
+    owned.Reserve(m_batches.size());
+    for (ActorHandle batch : m_batches) {
+        owned.Add(batch.value);
+    }
+    actors.erase(std::remove_if(actors.begin(), actors.end(),
+        [&owned](ActorHandle actor) { return owned.Contains(actor.value); }),
+        actors.end());
+    for (ActorHandle batch : m_batches) {
+        if (Actor* actor = batch.get()) {
+            actor->destroy();
+            ActorPool::getDefault().despawn(batch);
+        }
+    }
+    m_batches.clear();
+
+    // Un original destruido entre medias ya no resuelve: se salta.
+    for (ActorHandle source : m_sources) {
+        if (Actor* actor = source.get()) {
+            actor->setBatched(false);
+        }
+    }
+    m_sources.clear();
+    m_stats = Stats();
+    m_fingerprint = 0;
+}
@@ -11,35 +11,129 @@
 #include "SwapChain.h"
 #include "Device.h"
 #include "DeviceContext.h"
+#include "StallDetector.h"
 #include "Texture.h"
 #include "Window.h"
+#include <dxgi1_6.h>
 
- /**
-  * @brief Inicializa el dispositivo, contexto y swap chain.
-  *
-  * @param device Referencia al objeto Device que contendr el dispositivo Direct3D creado.
-  * @param deviceContext Referencia al objeto DeviceContext que contendr el contexto de dispositivo.
-  * @param backBuffer Referencia a la textura donde se almacenar el back buffer.
-  * @param window Informacin y manejador de la ventana.
-  * @return HRESULT Cdigo de xito o error (E_POINTER, E_INVALIDARG, etc.).
-  *
-  * @details
-  * - Crea el dispositivo Direct3D y su contexto.
-  * - Configura la descripcin de la swap chain.
-  * - Obtiene el `IDXGIFactory` y crea la swap chain asociada a la ventana.
-  * - Extrae el back buffer como `ID3D11Texture2D` y lo asigna al `Texture` recibido.
-  */
-HRESULT
-SwapChain::init(Device& device,
-    DeviceContext& deviceContext,
-    Texture& backBuffer,
-    Window window)
-{
-    if (!window.m_hWnd) {
-        ERROR("SwapChain", "init", "Invalid window handle. (m_hWnd is nullptr)");
-        return E_POINTER;
+namespace {
+    // Valores de DXGI 1.4/1.5 que el SDK de junio 2010 no declara (dxgi.h es 1.1).
+    const DXGI_SWAP_EFFECT kSwapEffectFlipSequential = static_cast<DXGI_SWAP_EFFECT>(3);
+    const DXGI_SWAP_EFFECT kSwapEffectFlipDiscard = static_cast<DXGI_SWAP_EFFECT>(4);
+    const unsigned int kSwapChainFlagAllowTearing = 2048; // DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING
+    const unsigned int kPresentAllowTearing = 0x200;      // DXGI_PRESENT_ALLOW_TEARING
+    // D3D_FEATURE_LEVEL_11_1 (d3dcommon.h del SDK de junio 2010 llega a 11_0).
+    const D3D_FEATURE_LEVEL kFeatureLevel11_1 = static_cast<D3D_FEATURE_LEVEL>(0xb100);
+    const unsigned int kAdapterFlagSoftware = 2;          // DXGI_ADAPTER_FLAG_SOFTWARE (dxgi.h de Windows 8)
+
+    /// Nombre del adaptador en ANSI para el log y la comparacin con `-adapter`.
+    std::string adapterName(const DXGI_ADAPTER_DESC1& desc) {
+        char name[128] = {};
+        WideCharToMultiByte(CP_ACP, 0, desc.Description, -1, name, sizeof(name), nullptr, nullptr);
+        return name;
+    }
+
+    /// "11_1", "10_0"...
+    std::string featureLevelName(D3D_FEATURE_LEVEL level) {
+        return std::to_string((level >> 12) & 0xf) + "_" + std::to_string((level >> 8) & 0xf);
     }
 
+    /**
+     * @brief Elige el adaptador: el indicado en `adapter` (ndice o parte del nombre) o,
+     * si est vaco, el de ms rendimiento.
+     * @return Adaptador con una referencia, o nullptr para el adaptador por defecto.
+     *
+     * @details Con DXGI 1.6 (Windows 10 1803) el orden lo da `EnumAdapterByGpuPreference`
+     * con `HIGH_PERFORMANCE`: en un porttil hbrido la GPU dedicada va primero. Sin l se
+     * toma el de ms memoria dedicada. Los adaptadores software (Basic Render) no cuentan.
+     */
+    IDXGIAdapter1* selectAdapter(const std::string& adapter) {
+        IDXGIFactory1* factory = nullptr;
+        if (FAILED(CreateDXGIFactory1(__uuidof(IDXGIFactory1), reinterpret_cast<void**>(&factory)))) {
+            return nullptr;
+        }
+        IDXGIFactory6* factory6 = nullptr;
+        factory->QueryInterface(__uuidof(IDXGIFactory6), reinterpret_cast<void**>(&factory6));
+
+        std::vector<IDXGIAdapter1*> adapters;
+        std::vector<DXGI_ADAPTER_DESC1> descs;
+        for (unsigned int i = 0; ; ++i) {
+            IDXGIAdapter1* candidate = nullptr;
+            const HRESULT hr = factory6
+                ? factory6->EnumAdapterByGpuPreference(i, DXGI_GPU_PREFERENCE_HIGH_PERFORMANCE,
+                    __uuidof(IDXGIAdapter1), reinterpret_cast<void**>(&candidate))
+                : factory->EnumAdapters1(i, &candidate);
+            if (FAILED(hr)) {
+                break;  // DXGI_ERROR_NOT_FOUND: no hay ms.
+            }
+            DXGI_ADAPTER_DESC1 desc = {};
+            if (FAILED(candidate->GetDesc1(&desc)) || (desc.Flags & kAdapterFlagSoftware)) {
+                SAFE_RELEASE(candidate);
+                continue;
+            }
+            MESSAGE("SwapChain", "selectAdapter", ("Adapter " + std::to_string(adapters.size()) + ": " +
+                adapterName(desc) + " (" + std::to_string(desc.DedicatedVideoMemory >> 20) + " MB)").c_str());
+            adapters.push_back(candidate);
+            descs.push_back(desc);
+        }
+        SAFE_RELEASE(factory6);
+        SAFE_RELEASE(factory);
+        if (adapters.empty()) {
+            return nullptr;
+        }
+
+        size_t chosen = 0;
+        if (!factory6) {
+            for (size_t i = 1; i < descs.size(); ++i) {
+                if (descs[i].DedicatedVideoMemory > descs[chosen].DedicatedVideoMemory) {
+                    chosen = i;
+                }
+            }
+        }
+        if (!adapter.empty()) {
+            size_t match = adapters.size();
+            if (adapter.find_first_not_of("0123456789") == std::string::npos) {
+                match = static_cast<size_t>(strtoul(adapter.c_str(), nullptr, 10));
+            }
+            else {
+                // `tolower` con un `char` negativo (nombres en CP_ACP) no est definido.
+                const auto lower = [](char c) { return static_cast<char>(tolower(static_cast<unsigned char>(c))); };
+                std::string wanted = adapter;
+                std::transform(wanted.begin(), wanted.end(), wanted.begin(), lower);
+                for (size_t i = 0; i < descs.size() && match == adapters.size(); ++i) {
+                    std::string name = adapterName(descs[i]);
+                    std::transform(name.begin(), name.end(), name.begin(), lower);
+                    if (name.find(wanted) != std::string::npos) {
+                        match = i;
+                    }
+                }
+            }
+            if (match < adapters.size()) {
+                chosen = match;
+            }
+            else {
+                ERROR("SwapChain", "selectAdapter", ("No adapter matches '" + adapter +
+                    "'; using the high-performance one").c_str());
+            }
+        }
+        for (size_t i = 0; i < adapters.size(); ++i) {
+            if (i != chosen) {
+                SAFE_RELEASE(adapters[i]);
+            }
+        }
+        return adapters[chosen];
+    }
+}
+
+/**
+ * @brief Crea el dispositivo y su contexto y obtiene el `IDXGIDevice` y el adaptador.
+ *
+ * @details Elige el adaptador (ver `selectAdapter`) pidiendo 11_1 primero. Si falla en
+ * ese adaptador se prueban hardware, WARP y referencia con el adaptador por defecto; con
+ * `DeviceConfig::warp`, directamente WARP.
+ */
+HRESULT
+SwapChain::createDevice(Device& device, DeviceContext& deviceContext, const DeviceConfig& deviceConfig) {
     HRESULT hr = S_OK;
 
     // Flags de creacin del dispositivo
@@ -56,49 +150,156 @@ SwapChain::init(Device& device,
     };
     const unsigned int numDriverTypes = ARRAYSIZE(driverTypes);
 
-    // Niveles de caractersticas a soportar
+    // Niveles de caractersticas a soportar: 11_1 da offsets en constant buffers
+    // (`*SetConstantBuffers1`) y UAVs en todas las etapas.
     D3D_FEATURE_LEVEL featureLevels[] = {
+        kFeatureLevel11_1,
         D3D_FEATURE_LEVEL_11_0,
         D3D_FEATURE_LEVEL_10_1,
         D3D_FEATURE_LEVEL_10_0,
     };
     const unsigned int numFeatureLevels = ARRAYSIZE(featureLevels);
 
-    // Intentar crear el dispositivo con cada tipo de driver
+    // Un runtime 11.0 (Windows 7 sin la actualizacin de plataforma) rechaza 11_1
+    // con E_INVALIDARG: se repite sin l.
+    auto tryCreate = [&](IDXGIAdapter* adapter, D3D_DRIVER_TYPE driverType) {
+        HRESULT result = D3D11CreateDevice(adapter, driverType, nullptr, createDeviceFlags,
+            featureLevels, numFeatureLevels, D3D11_SDK_VERSION,
+            &device.m_device, &m_featureLevel, &deviceContext.m_deviceContext);
+        if (result == E_INVALIDARG) {
+            result = D3D11CreateDevice(adapter, driverType, nullptr, createDeviceFlags,
+                featureLevels + 1, numFeatureLevels - 1, D3D11_SDK_VERSION,
+                &device.m_device, &m_featureLevel, &deviceContext.m_deviceContext);
+        }
+        return result;
+    };
+
+    // Con un adaptador concreto el tipo de driver tiene que ser UNKNOWN.
     bool created = false;
-    for (unsigned int i = 0; i < numDriverTypes; ++i) {
+    if (deviceConfig.warp) {
+        m_driverType = D3D_DRIVER_TYPE_WARP;
+        hr = tryCreate(nullptr, m_driverType);
+        created = SUCCEEDED(hr);
+    }
+    IDXGIAdapter1* adapter = created ? nullptr : selectAdapter(deviceConfig.adapter);
+    if (adapter) {
+        m_driverType = D3D_DRIVER_TYPE_HARDWARE;
+        hr = tryCreate(adapter, D3D_DRIVER_TYPE_UNKNOWN);
+        created = SUCCEEDED(hr);
+        SAFE_RELEASE(adapter);
+    }
+    // Intentar crear el dispositivo con cada tipo de driver
+    for (unsigned int i = 0; i < numDriverTypes && !created; ++i) {
         m_driverType = driverTypes[i];
-        hr = D3D11CreateDevice(
-            nullptr,
-            m_driverType,
-            nullptr,
-            createDeviceFlags,
-            featureLevels,
-            numFeatureLevels,
-            D3D11_SDK_VERSION,
-            &device.m_device,
-            &m_featureLevel,
-            &deviceContext.m_deviceContext);
-
-        if (SUCCEEDED(hr)) {
-            MESSAGE("SwapChain", "init", "Device created successfully.");
-            created = true;
-            break;
-        }
+        hr = tryCreate(nullptr, m_driverType);
+        created = SUCCEEDED(hr);
     }
     if (!created) {
-        ERROR("SwapChain", "init",
+        ERROR("SwapChain", "createDevice",
             ("Failed to create D3D11 device. HRESULT: " + std::to_string(hr)).c_str());
         return hr;
     }
 
-    // Sin MSAA para depuracin
+    hr = device.m_device->QueryInterface(__uuidof(IDXGIDevice), (void**)&m_dxgiDevice);
+    if (FAILED(hr)) {
+        ERROR("SwapChain", "createDevice",
+            ("Failed to query IDXGIDevice. HRESULT: " + std::to_string(hr)).c_str());
+        return hr;
+    }
+    hr = m_dxgiDevice->GetAdapter(&m_dxgiAdapter);
+    if (FAILED(hr)) {
+        ERROR("SwapChain", "createDevice",
+            ("Failed to get IDXGIAdapter. HRESULT: " + std::to_string(hr)).c_str());
+        return hr;
+    }
+    IDXGIAdapter1* adapter1 = nullptr;
+    if (SUCCEEDED(m_dxgiAdapter->QueryInterface(__uuidof(IDXGIAdapter1), (void**)&adapter1))) {
+        DXGI_ADAPTER_DESC1 desc = {};
+        if (SUCCEEDED(adapter1->GetDesc1(&desc))) {
+            m_adapterName = adapterName(desc);
+        }
+        SAFE_RELEASE(adapter1);
+    }
+    MESSAGE("SwapChain", "createDevice", ("Device created on " + m_adapterName + ", feature level " +
+        featureLevelName(m_featureLevel) + (m_driverType == D3D_DRIVER_TYPE_HARDWARE ? "" : " (software driver)")).c_str());
+    return S_OK;
+}
+
+/**
+ * @brief Latencia: DXGI no deja encolar ms de `maxFrameLatency` frames y
+ * `waitForFrame` espera al frame ms antiguo en vuelo antes de empezar el siguiente.
+ */
+HRESULT
+SwapChain::createFrameQueries(Device& device, unsigned int maxFrameLatency) {
+    HRESULT hr = S_OK;
+    maxFrameLatency = (std::max)(maxFrameLatency, 1u);
+    IDXGIDevice1* dxgiDevice1 = nullptr;
+    if (SUCCEEDED(m_dxgiDevice->QueryInterface(__uuidof(IDXGIDevice1), (void**)&dxgiDevice1))) {
+        dxgiDevice1->SetMaximumFrameLatency(maxFrameLatency);
+        SAFE_RELEASE(dxgiDevice1);
+    }
+    D3D11_QUERY_DESC queryDesc = {};
+    queryDesc.Query = D3D11_QUERY_EVENT;
+    m_frameQueries.assign(maxFrameLatency, nullptr);
+    for (auto& query : m_frameQueries) {
+        hr = device.m_device->CreateQuery(&queryDesc, &query);
+        if (FAILED(hr)) {
+            ERROR("SwapChain", "createFrameQueries",
+                ("Failed to create frame latency query. HRESULT: " + std::to_string(hr)).c_str());
+            return hr;
+        }
+    }
+    m_frameIndex = 0;
+    m_completedFrames = 0;
+    return S_OK;
+}
+
+ /**
+  * @brief Inicializa el dispositivo, contexto y swap chain.
+  *
+  * @param device Referencia al objeto Device que contendr el dispositivo Direct3D creado.
+  * @param deviceContext Referencia al objeto DeviceContext que contendr el contexto de dispositivo.
+  * @param backBuffer Referencia a la textura donde se almacenar el back buffer.
+  * @param window Informacin y manejador de la ventana.
+  * @param config Modo de presentacin, nmero de buffers y latencia mxima.
+  * @param deviceConfig Adaptador (por defecto el de ms rendimiento).
+  * @return HRESULT Cdigo de xito o error (E_POINTER, E_INVALIDARG, etc.).
+  *
+  * @details
+  * - Crea el dispositivo Direct3D y su contexto (ver `createDevice`).
+  * - Configura la descripcin de la swap chain.
+  * - Obtiene el `IDXGIFactory` y crea la swap chain asociada a la ventana, probando
+  *   FLIP_DISCARD, FLIP_SEQUENTIAL y DISCARD por ese orden.
+  * - Limita la latencia de frames y crea las queries de `waitForFrame`.
+  * - Extrae el back buffer como `ID3D11Texture2D` y lo asigna al `Texture` recibido.
+  */
+HRESULT
+SwapChain::init(Device& device,
+    DeviceContext& deviceContext,
+    Texture& backBuffer,
+    Window window,
+    const PresentConfig& config,
+    const DeviceConfig& deviceConfig)
+{
+    if (!window.m_hWnd) {
+        ERROR("SwapChain", "init", "Invalid window handle. (m_hWnd is nullptr)");
+        return E_POINTER;
+    }
+
+    HRESULT hr = createDevice(device, deviceContext, deviceConfig);
+    if (FAILED(hr)) {
+        return hr;
+    }
+
+    // El back buffer siempre es de una muestra: el flip model no admite swap chains
+    // multimuestra. El MSAA (`r.msaa`) se dibuja en targets propios y se resuelve antes
+    // del postproceso (ver Multisampling.h).
     m_sampleCount = 1;
     m_qualityLevels = 0;
 
     // Descripcin de la swap chain
     DXGI_SWAP_CHAIN_DESC sd = {};
-    sd.BufferCount = 1;
+    sd.BufferCount = (std::max)(config.bufferCount, 1u);
     sd.BufferDesc.Width = window.m_width;
     sd.BufferDesc.Height = window.m_height;
     sd.BufferDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
@@ -107,23 +308,10 @@ SwapChain::init(Device& device,
     sd.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
     sd.OutputWindow = window.m_hWnd;
     sd.Windowed = TRUE;
-    sd.SwapEffect = DXGI_SWAP_EFFECT_DISCARD;
     sd.SampleDesc.Count = 1;
     sd.SampleDesc.Quality = 0;
 
     // Obtener la factory de DXGI
-    hr = device.m_device->QueryInterface(__uuidof(IDXGIDevice), (void**)&m_dxgiDevice);
-    if (FAILED(hr)) {
-        ERROR("SwapChain", "init",
-            ("Failed to query IDXGIDevice. HRESULT: " + std::to_string(hr)).c_str());
-        return hr;
-    }
-    hr = m_dxgiDevice->GetAdapter(&m_dxgiAdapter);
-    if (FAILED(hr)) {
-        ERROR("SwapChain", "init",
-            ("Failed to get IDXGIAdapter. HRESULT: " + std::to_string(hr)).c_str());
-        return hr;
-    }
     hr = m_dxgiAdapter->GetParent(__uuidof(IDXGIFactory),
         reinterpret_cast<void**>(&m_dxgiFactory));
     if (FAILED(hr)) {
@@ -132,13 +320,43 @@ SwapChain::init(Device& device,
         return hr;
     }
 
-    // Crear la swap chain
-    hr = m_dxgiFactory->CreateSwapChain(device.m_device, &sd, &m_swapChain);
+    // Crear la swap chain: del modo ms moderno al clsico hasta que uno funcione.
+    struct Attempt { DXGI_SWAP_EFFECT effect; bool tearing; };
+    const bool wantTearing = config.allowTearing && !config.vsync;
+    const Attempt attempts[] = {
+        { kSwapEffectFlipDiscard, wantTearing }, // Windows 10 (+ tearing)
+        { kSwapEffectFlipDiscard, false },       // Windows 10 sin soporte de tearing
+        { kSwapEffectFlipSequential, false },    // Windows 8
+        { DXGI_SWAP_EFFECT_DISCARD, false },     // Modelo blit clsico
+    };
+    for (const Attempt& attempt : attempts) {
+        const bool flip = attempt.effect != DXGI_SWAP_EFFECT_DISCARD;
+        if ((flip && !config.flipModel) || (flip && sd.BufferCount < 2) ||
+            (attempt.tearing && !wantTearing)) {
+            continue;
+        }
+        sd.SwapEffect = attempt.effect;
+        sd.Flags = attempt.tearing ? kSwapChainFlagAllowTearing : 0;
+        hr = m_dxgiFactory->CreateSwapChain(device.m_device, &sd, &m_swapChain);
+        if (SUCCEEDED(hr)) {
+            m_flipModel = flip;
+            m_tearing = attempt.tearing;
+            break;
+        }
+    }
     if (FAILED(hr)) {
         ERROR("SwapChain", "init",
             ("Failed to create swap chain. HRESULT: " + std::to_string(hr)).c_str());
         return hr;
     }
+    m_vsync = config.vsync;
+    MESSAGE("SwapChain", "init", (std::string("Swap effect: ") +
+        (m_flipModel ? "flip" : "discard (blit)") + (m_tearing ? ", tearing" : "")).c_str());
+
+    hr = createFrameQueries(device, config.maxFrameLatency);
+    if (FAILED(hr)) {
+        return hr;
+    }
 
     // Obtener el back buffer
     ID3D11Texture2D* bb = nullptr;
@@ -159,11 +377,69 @@ SwapChain::init(Device& device,
     return S_OK;
 }
 
+/**
+ * @details Mismo dispositivo y mismas queries de latencia que @ref init, sin ventana ni
+ * swap chain: el "back buffer" es una textura RGBA8 normal (la que lee `FrameCapture`)
+ * y @ref present no hace nada.
+ */
+HRESULT
+SwapChain::initHeadless(Device& device,
+    DeviceContext& deviceContext,
+    Texture& backBuffer,
+    unsigned int width,
+    unsigned int height,
+    unsigned int maxFrameLatency,
+    const DeviceConfig& deviceConfig)
+{
+    if (width == 0 || height == 0) {
+        ERROR("SwapChain", "initHeadless", "Invalid offscreen size.");
+        return E_INVALIDARG;
+    }
+    HRESULT hr = createDevice(device, deviceContext, deviceConfig);
+    if (FAILED(hr)) {
+        return hr;
+    }
+    m_sampleCount = 1;
+    m_qualityLevels = 0;
+    m_headless = true;
+
+    hr = createFrameQueries(device, maxFrameLatency);
+    if (FAILED(hr)) {
+        return hr;
+    }
+
+    D3D11_TEXTURE2D_DESC desc = {};
+    desc.Width = width;
+    desc.Height = height;
+    desc.MipLevels = 1;
+    desc.ArraySize = 1;
+    desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    desc.SampleDesc.Count = 1;
+    desc.Usage = D3D11_USAGE_DEFAULT;
+    desc.BindFlags = D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
+    ID3D11Texture2D* target = nullptr;
+    hr = device.m_device->CreateTexture2D(&desc, nullptr, &target);
+    if (FAILED(hr)) {
+        ERROR("SwapChain", "initHeadless",
+            ("Failed to create offscreen target. HRESULT: " + std::to_string(hr)).c_str());
+        return hr;
+    }
+    SAFE_RELEASE(backBuffer.m_texture);
+    backBuffer.m_texture = target;
+    MESSAGE("SwapChain", "initHeadless", ("Offscreen target " + std::to_string(width) + "x" +
+        std::to_string(height)).c_str());
+    return S_OK;
+}
+
 /**
  * @brief Libera todos los recursos asociados a la swap chain y objetos DXGI.
  */
 void
 SwapChain::destroy() {
+    for (auto& query : m_frameQueries) {
+        SAFE_RELEASE(query);
+    }
+    m_frameQueries.clear();
     if (m_swapChain) { SAFE_RELEASE(m_swapChain); }
     if (m_dxgiDevice) { SAFE_RELEASE(m_dxgiDevice); }
     if (m_dxgiAdapter) { SAFE_RELEASE(m_dxgiAdapter); }
@@ -173,19 +449,112 @@ SwapChain::destroy() {
 /**
  * @brief Presenta el back buffer en pantalla.
  *
- * @details Llama a `IDXGISwapChain::Present` para mostrar la imagen renderizada.
+ * @details Llama a `IDXGISwapChain::Present` para mostrar la imagen renderizada,
+ * con intervalo 1 si hay vsync y `ALLOW_TEARING` si el swap chain lo admite.
  * En caso de error, registra el cdigo HRESULT.
  */
 void
 SwapChain::present() {
     if (m_swapChain) {
-        HRESULT hr = m_swapChain->Present(0, 0);
+        const unsigned int flags = (m_tearing && !m_vsync) ? kPresentAllowTearing : 0;
+        HRESULT hr;
+        if (m_vsync) {
+            // Con vsync bloquear aqu es lo esperado: no es una espera a vigilar.
+            hr = m_swapChain->Present(1, flags);
+        }
+        else {
+            StallDetector::Scope stall(STALL_PRESENT, nullptr);
+            hr = m_swapChain->Present(0, flags);
+        }
         if (FAILED(hr)) {
             ERROR("SwapChain", "present",
                 ("Failed to present swap chain. HRESULT: " + std::to_string(hr)).c_str());
         }
     }
-    else {
+    else if (!m_headless) {
         ERROR("SwapChain", "present", "Swap chain is not initialized.");
     }
 }
+
+/**
+ * @brief Redimensiona los back buffers conservando el modo de presentacin.
+ *
+ * @details `ResizeBuffers` reutiliza el nmero de buffers y el formato (0 y UNKNOWN);
+ * los flags deben coincidir con los de creacin (tearing).
+ */
+HRESULT
+SwapChain::resize(Texture& backBuffer, unsigned int width, unsigned int height) {
+    if (!m_swapChain) {
+        ERROR("SwapChain", "resize", "Swap chain is not initialized.");
+        return E_POINTER;
+    }
+
+    // En el acto, no por `GpuReleaseQueue`: con una referencia viva `ResizeBuffers` falla.
+    SAFE_RELEASE(backBuffer.m_textureFromImg);
+    SAFE_RELEASE(backBuffer.m_texture);
+    HRESULT hr = m_swapChain->ResizeBuffers(0, width, height, DXGI_FORMAT_UNKNOWN,
+        m_tearing ? kSwapChainFlagAllowTearing : 0);
+    if (FAILED(hr)) {
+        ERROR("SwapChain", "resize",
+            ("Failed to resize buffers. HRESULT: " + std::to_string(hr)).c_str());
+        return hr;
+    }
+
+    hr = m_swapChain->GetBuffer(0, __uuidof(ID3D11Texture2D), (void**)&backBuffer.m_texture);
+    if (FAILED(hr)) {
+        ERROR("SwapChain", "resize",
+            ("Failed to get back buffer. HRESULT: " + std::to_string(hr)).c_str());
+    }
+    return hr;
+}
+
+/**
+ * @brief Acota los frames en vuelo antes de empezar uno nuevo.
+ *
+ * @details
+ * Cierra la query del frame anterior y espera a la del frame `maxFrameLatency` atrs.
+ * Con latencia 1 se espera a que la GPU termine el frame anterior: la entrada que se
+ * lea a continuacin llega a pantalla en el siguiente `Present`.
+ */
+void
+SwapChain::waitForFrame(DeviceContext& deviceContext) {
+    if (m_frameQueries.empty() || !deviceContext.m_deviceContext) {
+        return;
+    }
+
+    const size_t latency = m_frameQueries.size();
+    if (m_frameIndex > 0) {
+        deviceContext.m_deviceContext->End(m_frameQueries[(m_frameIndex - 1) % latency]);
+    }
+    if (m_frameIndex >= latency) {
+        ID3D11Query* oldest = m_frameQueries[(m_frameIndex - latency) % latency];
+        while (deviceContext.m_deviceContext->GetData(oldest, nullptr, 0, 0) == S_FALSE) {
+            std::this_thread::yield();
+        }
+    }
+    ++m_frameIndex;
+}
+
+/**
+ * @details
+ * `waitForFrame` ya esper al frame `latencia` atrs, as que ese y los anteriores estn
+ * terminados. De los siguientes, cuyas queries ya se cerraron, se pregunta sin esperar
+ * (`DONOTFLUSH`) en orden hasta el primero que la GPU no haya terminado.
+ */
+unsigned long long
+SwapChain::pollCompletedFrames(DeviceContext& deviceContext) {
+    if (m_frameIndex == 0 || m_frameQueries.empty() || !deviceContext.m_deviceContext) {
+        return m_completedFrames;
+    }
+    const unsigned long long latency = m_frameQueries.size();
+    const unsigned long long current = m_frameIndex - 1;
+    if (current >= latency) {
+        m_completedFrames = (std::max)(m_completedFrames, current - latency + 1);
+    }
+    while (m_completedFrames < current &&
+        deviceContext.m_deviceContext->GetData(m_frameQueries[m_completedFrames % latency], nullptr, 0,
+            D3D11_ASYNC_GETDATA_DONOTFLUSH) == S_OK) {
+        ++m_completedFrames;
+    }
+    return m_completedFrames;
+}
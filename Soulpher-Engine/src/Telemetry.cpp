@@ -0,0 +1,271 @@
+﻿/**
+ * @file Telemetry.cpp
+ * @brief Implementación de la telemetría de campo: histogramas, adaptador y escritura.
+ */
+
+#include "Telemetry.h"
+#include "Device.h"
+#include "GpuProfiler.h"
+#include <cmath>
+#include <cstdio>
+#include <memory>
+
+const double Telemetry::kFirstBinMs = 0.1;
+const double Telemetry::kBinRatio = 1.04;
+
+namespace {
+    /// Cadena JSON con comillas, barras y controles escapados.
+    std::string jsonString(const std::string& text) {
+        std::string out = "\"";
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                out += '\\';
+                out += c;
+            }
+            else if (static_cast<unsigned char>(c) < 0x20) {
+                out += ' ';
+            }
+            else {
+                out += c;
+            }
+        }
+        return out + "\"";
+    }
+
+    std::string narrow(const wchar_t* text) {
+        char buffer[256] = "";
+        WideCharToMultiByte(CP_UTF8, 0, text, -1, buffer, sizeof(buffer), nullptr, nullptr);
+        return buffer;
+    }
+}
+
+void Telemetry::Histogram::add(double ms) {
+    int bin = 0;
+    if (ms > kFirstBinMs) {
+        bin = static_cast<int>(std::ceil(std::log(ms / kFirstBinMs) / std::log(kBinRatio)));
+    }
+    ++bins[(std::min)(bin, static_cast<int>(kBins) - 1)];
+    ++count;
+}
+
+double Telemetry::Histogram::percentile(double p) const {
+    if (count == 0) {
+        return 0.0;
+    }
+    const unsigned long long rank = static_cast<unsigned long long>(std::ceil(p * count));
+    unsigned long long seen = 0;
+    for (unsigned int bin = 0; bin < kBins; ++bin) {
+        seen += bins[bin];
+        if (seen >= rank && bins[bin] > 0) {
+            return kFirstBinMs * std::pow(kBinRatio, static_cast<double>(bin));
+        }
+    }
+    return kFirstBinMs * std::pow(kBinRatio, static_cast<double>(kBins - 1));
+}
+
+/**
+ * @details La versión del driver es la de la UMD que devuelve
+ * `CheckInterfaceSupport(IDXGIDevice)`: la que ve el usuario en el panel del fabricante
+ * (p. ej. 31.0.15.3623).
+ */
+HRESULT Telemetry::init(Device& device, const Settings& settings) {
+    destroy();
+    if (settings.directory.empty()) {
+        ERROR("Telemetry", "init", "No output directory");
+        return E_INVALIDARG;
+    }
+    if (!device.m_device) {
+        ERROR("Telemetry", "init", "Device is not initialized");
+        return E_POINTER;
+    }
+    if (!CreateDirectoryA(settings.directory.c_str(), nullptr) && GetLastError() != ERROR_ALREADY_EXISTS) {
+        const HRESULT hr = HRESULT_FROM_WIN32(GetLastError());
+        ERROR("Telemetry", "init", ("Cannot create " + settings.directory + ". HRESULT: " + std::to_string(hr)).c_str());
+        return hr;
+    }
+
+    IDXGIDevice* dxgiDevice = nullptr;
+    IDXGIAdapter* adapter = nullptr;
+    HRESULT hr = device.m_device->QueryInterface(__uuidof(IDXGIDevice), (void**)&dxgiDevice);
+    if (SUCCEEDED(hr)) {
+        hr = dxgiDevice->GetAdapter(&adapter);
+    }
+    SAFE_RELEASE(dxgiDevice);
+    if (FAILED(hr)) {
+        ERROR("Telemetry", "init", ("Failed to get the DXGI adapter. HRESULT: " + std::to_string(hr)).c_str());
+        return hr;
+    }
+    DXGI_ADAPTER_DESC desc = {};
+    if (SUCCEEDED(adapter->GetDesc(&desc))) {
+        m_adapterName = narrow(desc.Description);
+        m_vendorId = desc.VendorId;
+        m_deviceId = desc.DeviceId;
+        m_dedicatedVideoMemory = desc.DedicatedVideoMemory;
+    }
+    LARGE_INTEGER umd = {};
+    if (SUCCEEDED(adapter->CheckInterfaceSupport(__uuidof(IDXGIDevice), &umd))) {
+        char version[32];
+        sprintf_s(version, "%u.%u.%u.%u", HIWORD(umd.HighPart), LOWORD(umd.HighPart),
+            HIWORD(umd.LowPart), LOWORD(umd.LowPart));
+        m_driverVersion = version;
+    }
+    SAFE_RELEASE(adapter);
+
+    SYSTEMTIME time;
+    GetSystemTime(&time);
+    char session[64];
+    sprintf_s(session, "%04u%02u%02u-%02u%02u%02u_%lu", time.wYear, time.wMonth, time.wDay,
+        time.wHour, time.wMinute, time.wSecond, GetCurrentProcessId());
+    char started[32];
+    sprintf_s(started, "%04u-%02u-%02uT%02u:%02u:%02uZ", time.wYear, time.wMonth, time.wDay,
+        time.wHour, time.wMinute, time.wSecond);
+    m_session = session;
+    m_started = started;
+    m_settings = settings;
+    m_path = settings.directory + "\\session_" + m_session + ".json";
+    m_scenes.assign(1, SceneAggregate());
+    m_scenes[0].id = "default";
+    m_current = 0;
+    m_seconds = 0.0;
+    m_sinceFlush = 0.0;
+    m_running = true;
+    MESSAGE("Telemetry", "init", ("Writing session summaries to " + m_path).c_str());
+    return S_OK;
+}
+
+void Telemetry::setScene(const std::string& sceneId) {
+    if (!m_running || m_scenes[m_current].id == sceneId) {
+        return;
+    }
+    for (size_t i = 0; i < m_scenes.size(); ++i) {
+        if (m_scenes[i].id == sceneId) {
+            m_current = i;
+            return;
+        }
+    }
+    // La escena por defecto sin frames es la de arranque: se renombra en vez de quedar vacía.
+    if (m_scenes[m_current].frame.count == 0) {
+        m_scenes[m_current].id = sceneId;
+        return;
+    }
+    m_scenes.push_back(SceneAggregate());
+    m_scenes.back().id = sceneId;
+    m_current = m_scenes.size() - 1;
+}
+
+void Telemetry::recordFrame(double frameMs, const GpuProfiler& gpuProfiler, double hitchMs,
+    unsigned long long vramUsage, unsigned long long vramBudget) {
+    if (!m_running) {
+        return;
+    }
+    if (m_skipNext) {
+        m_skipNext = false;
+        return;
+    }
+    SceneAggregate& scene = m_scenes[m_current];
+    scene.frame.add(frameMs);
+    if (gpuProfiler.isEnabled() && gpuProfiler.getResultSerial() != m_gpuSerial) {
+        scene.gpu.add(gpuProfiler.getFrameTime());
+    }
+    m_gpuSerial = gpuProfiler.getResultSerial();
+    scene.seconds += frameMs / 1000.0;
+    scene.hitchMs = hitchMs;
+    if (frameMs > hitchMs) {
+        ++scene.hitches;
+    }
+    scene.vramSum += static_cast<double>(vramUsage);
+    scene.vramPeak = (std::max)(scene.vramPeak, vramUsage);
+    scene.vramBudget = vramBudget;
+
+    m_seconds += frameMs / 1000.0;
+    m_sinceFlush += frameMs / 1000.0;
+    if (m_sinceFlush >= m_settings.flushSeconds) {
+        flush(false);
+    }
+}
+
+/**
+ * @details Si el hilo aún escribe el anterior, se salta esta vez (sin esperar en el hilo
+ * principal); el final espera siempre.
+ */
+void Telemetry::flush(bool final) {
+    if (!final && m_writing.load(std::memory_order_acquire)) {
+        return;
+    }
+    if (m_writer.joinable()) {
+        m_writer.join();
+    }
+    m_sinceFlush = 0.0;
+    std::shared_ptr<Snapshot> snapshot = std::make_shared<Snapshot>();
+    snapshot->scenes = m_scenes;
+    snapshot->durationSeconds = m_seconds;
+    snapshot->final = final;
+    m_writing.store(true, std::memory_order_release);
+    m_writer = std::thread([this, snapshot]() {
+        write(*snapshot);
+        m_writing.store(false, std::memory_order_release);
+    });
+}
+
+void Telemetry::destroy() {
+    if (m_running) {
+        flush(true);
+        m_running = false;
+    }
+    if (m_writer.joinable()) {
+        m_writer.join();
+    }
+}
+
+HRESULT Telemetry::write(const Snapshot& snapshot) const {
+    const std::string temp = m_path + ".tmp";
+    FILE* file = nullptr;
+    if (fopen_s(&file, temp.c_str(), "w") != 0 || !file) {
+        ERROR("Telemetry", "write", ("Cannot write " + temp).c_str());
+        return E_FAIL;
+    }
+    fprintf(file, "{\"version\":%u,\"session\":%s,\"started\":%s,\"durationSeconds\":%.1f,\"final\":%s,\n",
+        kFormatVersion, jsonString(m_session).c_str(), jsonString(m_started).c_str(),
+        snapshot.durationSeconds, snapshot.final ? "true" : "false");
+    fprintf(file, "\"adapter\":{\"name\":%s,\"vendorId\":%u,\"deviceId\":%u,\"driver\":%s,\"dedicatedVideoMemory\":%llu},\n",
+        jsonString(m_adapterName).c_str(), m_vendorId, m_deviceId, jsonString(m_driverVersion).c_str(),
+        m_dedicatedVideoMemory);
+    fprintf(file, "\"histogram\":{\"firstMs\":%g,\"ratio\":%g,\"bins\":%u},\n\"scenes\":[",
+        kFirstBinMs, kBinRatio, kBins);
+
+    auto writeHistogram = [file](const char* name, const Histogram& histogram) {
+        fprintf(file, "\"%s\":{\"count\":%llu,\"p50\":%.3f,\"p90\":%.3f,\"p95\":%.3f,\"p99\":%.3f,\"p999\":%.3f,\"bins\":[",
+            name, histogram.count, histogram.percentile(0.5), histogram.percentile(0.9),
+            histogram.percentile(0.95), histogram.percentile(0.99), histogram.percentile(0.999));
+        bool first = true;
+        for (unsigned int bin = 0; bin < kBins; ++bin) {
+            if (histogram.bins[bin] > 0) {
+                fprintf(file, "%s[%u,%u]", first ? "" : ",", bin, histogram.bins[bin]);
+                first = false;
+            }
+        }
+        fprintf(file, "]}");
+    };
+    bool firstScene = true;
+    for (const SceneAggregate& scene : snapshot.scenes) {
+        if (scene.frame.count == 0) {
+            continue;
+        }
+        fprintf(file, "%s\n{\"id\":%s,\"seconds\":%.1f,\"hitches\":%llu,\"hitchMs\":%.1f,", firstScene ? "" : ",",
+            jsonString(scene.id).c_str(), scene.seconds, scene.hitches, scene.hitchMs);
+        writeHistogram("frame", scene.frame);
+        fprintf(file, ",");
+        writeHistogram("gpu", scene.gpu);
+        fprintf(file, ",\"vram\":{\"averageBytes\":%.0f,\"peakBytes\":%llu,\"budgetBytes\":%llu}}",
+            scene.vramSum / static_cast<double>(scene.frame.count), scene.vramPeak, scene.vramBudget);
+        firstScene = false;
+    }
+    fprintf(file, "\n]}\n");
+    const bool ok = fclose(file) == 0;
+    if (!ok || !MoveFileExA(temp.c_str(), m_path.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+        ERROR("Telemetry", "write", ("Cannot write " + m_path).c_str());
+        DeleteFileA(temp.c_str());
+        return E_FAIL;
+    }
+    return S_OK;
+}
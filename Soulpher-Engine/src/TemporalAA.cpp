@@ -0,0 +1,176 @@
+﻿/**
+ * @file TemporalAA.cpp
+ * @brief Implementación del antialiasing temporal y de la subida temporal.
+ */
+
+#include "TemporalAA.h"
+#include "Device.h"
+#include "DeviceContext.h"
+#include "ShaderLibrary.h"
+
+namespace {
+    unsigned int groups(unsigned int size) {
+        return (size + TemporalAA::kTileSize - 1) / TemporalAA::kTileSize;
+    }
+
+    /// Inverso radical de `index` en `base`: el término `index` de la secuencia de Halton.
+    float halton(unsigned int index, unsigned int base) {
+        float result = 0.0f;
+        float fraction = 1.0f;
+        while (index > 0) {
+            fraction /= static_cast<float>(base);
+            result += fraction * static_cast<float>(index % base);
+            index /= base;
+        }
+        return result;
+    }
+}
+
+const ConstantBufferLayouts::Registration TemporalAA::kParamsLayout({ "cbTemporal", CB_SLOT_TEMPORAL, sizeof(TemporalParams), {
+    CB_FIELD(TemporalParams, reprojection, "TemporalReprojection"),
+    CB_FIELD(TemporalParams, size, "TemporalSize"),
+    CB_FIELD(TemporalParams, jitter, "TemporalJitter"),
+    CB_FIELD(TemporalParams, params, "TemporalParams") } });
+
+HRESULT TemporalAA::init(Device& device, unsigned int width, unsigned int height) {
+    if (!device.m_device) {
+        ERROR("TemporalAA", "init", "Device is null.");
+        return E_POINTER;
+    }
+    destroy();
+
+    // UAV de texturas en compute: nivel 11_0.
+    if (device.m_device->GetFeatureLevel() < D3D_FEATURE_LEVEL_11_0) {
+        MESSAGE("TemporalAA", "init", "Feature level < 11_0: TAA disabled.");
+        return DXGI_ERROR_UNSUPPORTED;
+    }
+    m_width = width;
+    m_height = height;
+
+    D3D11_BUFFER_DESC paramsDesc = {};
+    paramsDesc.Usage = D3D11_USAGE_DEFAULT;
+    paramsDesc.ByteWidth = sizeof(TemporalParams);
+    paramsDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+    HRESULT hr = device.CreateBuffer(&paramsDesc, nullptr, &m_params);
+
+    D3D11_SAMPLER_DESC samplerDesc = {};
+    samplerDesc.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+    samplerDesc.AddressU = D3D11_TEXTURE_ADDRESS_CLAMP;
+    samplerDesc.AddressV = D3D11_TEXTURE_ADDRESS_CLAMP;
+    samplerDesc.AddressW = D3D11_TEXTURE_ADDRESS_CLAMP;
+    samplerDesc.ComparisonFunc = D3D11_COMPARISON_NEVER;
+    samplerDesc.MaxLOD = D3D11_FLOAT32_MAX;
+    if (SUCCEEDED(hr)) { hr = device.CreateSharedSamplerState(&samplerDesc, &m_sampler); }
+
+    D3D11_TEXTURE2D_DESC historyDesc = {};
+    historyDesc.Width = width;
+    historyDesc.Height = height;
+    historyDesc.MipLevels = 1;
+    historyDesc.ArraySize = 1;
+    historyDesc.Format = kHistoryFormat;
+    historyDesc.SampleDesc.Count = 1;
+    historyDesc.Usage = D3D11_USAGE_DEFAULT;
+    historyDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_UNORDERED_ACCESS;
+    for (unsigned int i = 0; i < 2 && SUCCEEDED(hr); ++i) {
+        hr = device.CreateTexture2D(&historyDesc, nullptr, &m_history[i]);
+        if (SUCCEEDED(hr)) { hr = device.CreateShaderResourceView(m_history[i], nullptr, &m_historySRV[i]); }
+        if (SUCCEEDED(hr)) { hr = device.CreateUnorderedAccessView(m_history[i], nullptr, &m_historyUAV[i]); }
+    }
+    if (FAILED(hr)) {
+        ERROR("TemporalAA", "init", ("Failed to create the TAA history. hr=" + std::to_string(hr)).c_str());
+        destroy();
+        return hr;
+    }
+
+    ShaderKey key;
+    key.fileName = "TemporalAA.fx";
+    key.entryPoint = "CSResolve";
+    key.profile = "cs_5_0";
+    hr = device.getShaderLibrary().getComputeShader(device, key, &m_resolveShader);
+    if (FAILED(hr)) {
+        destroy();
+        return hr;
+    }
+    return S_OK;
+}
+
+XMFLOAT2 TemporalAA::nextJitter() {
+    // Desde 1: el término 0 de Halton es (0, 0) en todas las bases.
+    const unsigned int index = m_frame % kJitterPhases + 1;
+    ++m_frame;
+    m_jitter = XMFLOAT2(halton(index, 2) - 0.5f, halton(index, 3) - 0.5f);
+    return m_jitter;
+}
+
+XMMATRIX TemporalAA::jitterProjection(const XMMATRIX& projection, const XMFLOAT2& jitter,
+    unsigned int width, unsigned int height) {
+    // Un píxel son 2 / ancho en NDC; la y de los píxeles crece hacia abajo.
+    XMMATRIX result = projection;
+    result.r[2] = XMVectorAdd(result.r[2], XMVectorSet(
+        2.0f * jitter.x / static_cast<float>(width), -2.0f * jitter.y / static_cast<float>(height), 0.0f, 0.0f));
+    return result;
+}
+
+RenderTargetPool::Target TemporalAA::getOutput() const {
+    const unsigned int next = 1 - m_current;
+    RenderTargetPool::Target target;
+    target.texture = m_history[next];
+    target.srv = m_historySRV[next];
+    target.uav = m_historyUAV[next];
+    return target;
+}
+
+void TemporalAA::resolve(DeviceContext& deviceContext, ID3D11ShaderResourceView* sceneSRV,
+    ID3D11ShaderResourceView* depthSRV, unsigned int sceneWidth, unsigned int sceneHeight,
+    const XMMATRIX& viewProj) {
+    if (!isReady() || !sceneSRV || !depthSRV || sceneWidth == 0 || sceneHeight == 0) {
+        return;
+    }
+    const unsigned int previous = m_current;
+    const unsigned int next = 1 - m_current;
+
+    // La historia está en coordenadas de la ventana: sirve aunque cambie la escala de la
+    // escena, así que solo se pierde al redimensionar (nuevo `init`) o al invalidarla.
+    const XMMATRIX reprojection = XMMatrixMultiply(XMMatrixInverse(nullptr, viewProj), m_previousViewProj);
+    TemporalParams params;
+    params.reprojection = XMMatrixTranspose(reprojection);
+    params.size = XMFLOAT4(static_cast<float>(m_width), static_cast<float>(m_height),
+        static_cast<float>(sceneWidth), static_cast<float>(sceneHeight));
+    params.jitter = XMFLOAT4(m_jitter.x, m_jitter.y, m_settings.blend, m_hasHistory ? 1.0f : 0.0f);
+    params.params = XMFLOAT4(m_settings.clipScale, 0.0f, 0.0f, 0.0f);
+    deviceContext.UpdateSubresource(m_params, 0, nullptr, &params, 0, 0);
+
+    // La profundidad sigue enlazada como DSV del pase que dibujó la escena.
+    deviceContext.OMSetRenderTargets(0, nullptr, nullptr);
+    deviceContext.CSSetConstantBuffers(CB_SLOT_TEMPORAL, 1, &m_params);
+
+    ID3D11ShaderResourceView* sources[3] = { sceneSRV, depthSRV, m_historySRV[previous] };
+    ID3D11ShaderResourceView* nullSRVs[3] = { nullptr, nullptr, nullptr };
+    ID3D11UnorderedAccessView* nullUAV = nullptr;
+    deviceContext.CSSetShader(m_resolveShader, nullptr, 0);
+    deviceContext.CSSetShaderResources(0, 3, sources);
+    deviceContext.CSSetSamplers(0, 1, &m_sampler);
+    deviceContext.CSSetUnorderedAccessViews(0, 1, &m_historyUAV[next], nullptr);
+    deviceContext.Dispatch(groups(m_width), groups(m_height), 1);
+
+    deviceContext.CSSetShaderResources(0, 3, nullSRVs);
+    deviceContext.CSSetUnorderedAccessViews(0, 1, &nullUAV, nullptr);
+    deviceContext.CSSetShader(nullptr, nullptr, 0);
+
+    m_current = next;
+    m_hasHistory = true;
+    m_previousViewProj = viewProj;
+}
+
+void TemporalAA::destroy() {
+    SAFE_RELEASE(m_resolveShader);
+    SAFE_RELEASE(m_params);
+    SAFE_RELEASE(m_sampler);
+    for (unsigned int i = 0; i < 2; ++i) {
+        SAFE_RELEASE(m_historyUAV[i]);
+        SAFE_RELEASE(m_historySRV[i]);
+        SAFE_RELEASE(m_history[i]);
+    }
+    m_current = 0;
+    m_hasHistory = false;
+}
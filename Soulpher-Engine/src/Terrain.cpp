@@ -0,0 +1,422 @@
+﻿/**
+ * @file Terrain.cpp
+ * @brief Implementación del clipmap: rejilla compartida, centros de los niveles,
+ * culling de bloques, mapa procedural y dibujo instanciado (con o sin teselado).
+ */
+
+#include "Terrain.h"
+#include "Device.h"
+#include "DeviceContext.h"
+#include "VertexLayout.h"
+#include "Frustum.h"
+#include "AsyncTextureLoader.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+const ConstantBufferLayouts::Registration Terrain::kTerrainLayout({ "cbTerrain", CB_SLOT_OBJECT,
+    sizeof(CBTerrain), {
+        CB_FIELD(CBTerrain, view, "View"),
+        CB_FIELD(CBTerrain, projection, "Projection"),
+        CB_FIELD(CBTerrain, camera, "Camera"),
+        CB_FIELD(CBTerrain, heights, "Heights"),
+        CB_FIELD(CBTerrain, tessellation, "Tessellation") } });
+
+namespace {
+    /// Bloques por nivel.
+    const unsigned int kBlocksPerLevel = Terrain::kBlocksPerSide * Terrain::kBlocksPerSide;
+
+    /// Valor pseudoaleatorio en [0, 1] de un punto entero de la red.
+    float latticeValue(int x, int y) {
+        unsigned int h = static_cast<unsigned int>(x) * 374761393u + static_cast<unsigned int>(y) * 668265263u;
+        h = (h ^ (h >> 13)) * 1274126177u;
+        return static_cast<float>((h ^ (h >> 16)) & 0xffffu) / 65535.0f;
+    }
+
+    /// Ruido de valor con interpolación suave (periodo `period`, para que el mapa repita sin costura).
+    float valueNoise(float x, float y, int period) {
+        const float fx = std::floor(x);
+        const float fy = std::floor(y);
+        const int x0 = static_cast<int>(fx) % period;
+        const int y0 = static_cast<int>(fy) % period;
+        const int x1 = (x0 + 1) % period;
+        const int y1 = (y0 + 1) % period;
+        const float tx = (x - fx) * (x - fx) * (3.0f - 2.0f * (x - fx));
+        const float ty = (y - fy) * (y - fy) * (3.0f - 2.0f * (y - fy));
+        const float a = latticeValue(x0, y0) + (latticeValue(x1, y0) - latticeValue(x0, y0)) * tx;
+        const float b = latticeValue(x0, y1) + (latticeValue(x1, y1) - latticeValue(x0, y1)) * tx;
+        return a + (b - a) * ty;
+    }
+}
+
+HRESULT Terrain::init(Device& device) {
+    if (!device.m_device) {
+        ERROR("Terrain", "init", "Device is null.");
+        return E_POINTER;
+    }
+    destroy();
+
+    const std::vector<D3D11_INPUT_ELEMENT_DESC> layout = VertexLayout()
+        .add("TERRAIN_BLOCK", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, VERTEX_STREAM_INSTANCE, true)
+        .add("TERRAIN_LEVEL", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, VERTEX_STREAM_INSTANCE, true)
+        .getDesc();
+
+    // Un bloque: (kBlockQuads + 1)^2 vértices implícitos, dos triángulos por celda en el
+    // sentido de las agujas del reloj visto desde arriba.
+    const unsigned int side = kBlockQuads + 1;
+    std::vector<unsigned int> indices;
+    indices.reserve(kBlockQuads * kBlockQuads * 6);
+    for (unsigned int z = 0; z < kBlockQuads; ++z) {
+        for (unsigned int x = 0; x < kBlockQuads; ++x) {
+            const unsigned int v0 = z * side + x;
+            const unsigned int v2 = v0 + side;
+            indices.insert(indices.end(), { v0, v2, v0 + 1, v0 + 1, v2, v2 + 1 });
+        }
+    }
+    m_gridIndexCount = static_cast<unsigned int>(indices.size());
+
+    HRESULT hr = m_program.init(device, "Terrain.fx", layout);
+    if (SUCCEEDED(hr)) { hr = m_gridIndices.initIndices(device, indices.data(), m_gridIndexCount, true); }
+    if (SUCCEEDED(hr)) {
+        hr = m_instanceBuffer.initDynamic(device, kMaxLevels * kBlocksPerLevel * sizeof(InstanceData),
+            sizeof(InstanceData), D3D11_BIND_VERTEX_BUFFER);
+    }
+    if (SUCCEEDED(hr)) { hr = m_constants.init(device); }
+    if (SUCCEEDED(hr)) { hr = m_rasterizer.init(device); }
+    if (SUCCEEDED(hr)) {
+        D3D11_SAMPLER_DESC desc = {};
+        desc.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+        desc.AddressU = D3D11_TEXTURE_ADDRESS_CLAMP;
+        desc.AddressV = D3D11_TEXTURE_ADDRESS_CLAMP;
+        desc.AddressW = D3D11_TEXTURE_ADDRESS_CLAMP;
+        desc.ComparisonFunc = D3D11_COMPARISON_NEVER;
+        desc.MaxLOD = D3D11_FLOAT32_MAX;
+        hr = device.CreateSharedSamplerState(&desc, &m_heightSampler);
+        if (SUCCEEDED(hr)) {
+            desc.Filter = D3D11_FILTER_ANISOTROPIC;
+            desc.MaxAnisotropy = 8;
+            desc.AddressU = D3D11_TEXTURE_ADDRESS_WRAP;
+            desc.AddressV = D3D11_TEXTURE_ADDRESS_WRAP;
+            desc.AddressW = D3D11_TEXTURE_ADDRESS_WRAP;
+            hr = device.CreateSharedSamplerState(&desc, &m_diffuseSampler);
+        }
+    }
+    if (SUCCEEDED(hr)) {
+        const unsigned int white = 0xffffffff;
+        D3D11_TEXTURE2D_DESC desc = {};
+        desc.Width = 1;
+        desc.Height = 1;
+        desc.MipLevels = 1;
+        desc.ArraySize = 1;
+        desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        desc.SampleDesc.Count = 1;
+        desc.Usage = D3D11_USAGE_IMMUTABLE;
+        desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+        D3D11_SUBRESOURCE_DATA data = { &white, sizeof(white), 0 };
+        hr = device.CreateTexture2D(&desc, &data, &m_whiteTexture);
+    }
+    if (SUCCEEDED(hr)) { hr = device.CreateShaderResourceView(m_whiteTexture, nullptr, &m_whiteSRV); }
+    if (SUCCEEDED(hr)) { hr = createProceduralHeightmap(device); }
+    if (FAILED(hr)) {
+        ERROR("Terrain", "init", ("Failed to create terrain resources. HRESULT: " + std::to_string(hr)).c_str());
+        destroy();
+        return hr;
+    }
+
+    // Teselado: opcional, sin él el terreno se dibuja igual con la rejilla.
+    HRESULT hrTess = device.m_device->GetFeatureLevel() >= D3D_FEATURE_LEVEL_11_0 ? S_OK : DXGI_ERROR_UNSUPPORTED;
+    if (SUCCEEDED(hrTess)) {
+        hrTess = m_tessProgram.init(device, "Terrain.fx", layout, { { "TESSELLATION", "1" } });
+    }
+    if (SUCCEEDED(hrTess)) {
+        ShaderLibrary& library = device.getShaderLibrary();
+        ShaderKey key;
+        key.fileName = "Terrain.fx";
+        key.defines = { { "TESSELLATION", "1" } };
+        key.entryPoint = "HS";
+        key.profile = "hs_5_0";
+        hrTess = library.getHullShader(device, key, &m_hullShader);
+        if (SUCCEEDED(hrTess)) {
+            key.entryPoint = "DS";
+            key.profile = "ds_5_0";
+            hrTess = library.getDomainShader(device, key, &m_domainShader);
+        }
+    }
+    if (FAILED(hrTess)) {
+        LOG_WARNING("Terrain", "Tessellation not available (HRESULT " << hrTess << "), using the plain grid.");
+        m_tessProgram.destroy();
+        SAFE_RELEASE(m_hullShader);
+        SAFE_RELEASE(m_domainShader);
+    }
+    m_device = &device;
+    return S_OK;
+}
+
+/**
+ * @details Ruido de valor en 6 octavas (periódico: el borde del mapa enlaza consigo
+ * mismo), elevado al cuadrado para dejar llanuras entre colinas y multiplicado por una
+ * máscara que vale 0 cerca del centro: ahí queda el suelo plano del editor, a
+ * `Settings::baseHeight`. Los mips se promedian de 2x2 en float y se guardan en R16.
+ */
+HRESULT Terrain::createProceduralHeightmap(Device& device) {
+    const unsigned int size = kProceduralSize;
+    const int kBasePeriod = 8;
+    const float kFlatRadius = 0.015f;   // en UV: ~30 unidades con el `extent` por defecto
+    const float kRiseRadius = 0.06f;
+
+    std::vector<float> heights(size * size);
+    for (unsigned int y = 0; y < size; ++y) {
+        for (unsigned int x = 0; x < size; ++x) {
+            const float u = (x + 0.5f) / size;
+            const float v = (y + 0.5f) / size;
+            float sum = 0.0f;
+            float amplitude = 1.0f;
+            float total = 0.0f;
+            int period = kBasePeriod;
+            for (int octave = 0; octave < 6; ++octave) {
+                sum += valueNoise(u * period, v * period, period) * amplitude;
+                total += amplitude;
+                amplitude *= 0.5f;
+                period *= 2;
+            }
+            const float noise = sum / total;
+            const float radius = std::sqrt((u - 0.5f) * (u - 0.5f) + (v - 0.5f) * (v - 0.5f));
+            const float t = std::clamp((radius - kFlatRadius) / (kRiseRadius - kFlatRadius), 0.0f, 1.0f);
+            heights[y * size + x] = noise * noise * t * t * (3.0f - 2.0f * t);
+        }
+    }
+
+    unsigned int mipCount = 1;
+    while ((size >> mipCount) > 0) ++mipCount;
+    std::vector<std::vector<uint16_t>> mips(mipCount);
+    std::vector<D3D11_SUBRESOURCE_DATA> data(mipCount);
+    unsigned int mipSize = size;
+    for (unsigned int mip = 0; mip < mipCount; ++mip) {
+        if (mip > 0) {
+            const unsigned int previous = mipSize;
+            mipSize = (std::max)(mipSize / 2, 1u);
+            std::vector<float> reduced(mipSize * mipSize);
+            for (unsigned int y = 0; y < mipSize; ++y) {
+                for (unsigned int x = 0; x < mipSize; ++x) {
+                    const unsigned int x0 = (std::min)(x * 2, previous - 1), x1 = (std::min)(x * 2 + 1, previous - 1);
+                    const unsigned int y0 = (std::min)(y * 2, previous - 1), y1 = (std::min)(y * 2 + 1, previous - 1);
+                    reduced[y * mipSize + x] = 0.25f * (heights[y0 * previous + x0] + heights[y0 * previous + x1] +
+                        heights[y1 * previous + x0] + heights[y1 * previous + x1]);
+                }
+            }
+            heights.swap(reduced);
+        }
+        mips[mip].resize(mipSize * mipSize);
+        for (unsigned int i = 0; i < mipSize * mipSize; ++i) {
+            mips[mip][i] = static_cast<uint16_t>(std::clamp(heights[i], 0.0f, 1.0f) * 65535.0f + 0.5f);
+        }
+        data[mip] = { mips[mip].data(), mipSize * static_cast<unsigned int>(sizeof(uint16_t)), 0 };
+    }
+
+    D3D11_TEXTURE2D_DESC desc = {};
+    desc.Width = size;
+    desc.Height = size;
+    desc.MipLevels = mipCount;
+    desc.ArraySize = 1;
+    desc.Format = DXGI_FORMAT_R16_UNORM;
+    desc.SampleDesc.Count = 1;
+    desc.Usage = D3D11_USAGE_IMMUTABLE;
+    desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+    HRESULT hr = device.CreateTexture2D(&desc, data.data(), &m_proceduralTexture);
+    if (SUCCEEDED(hr)) { hr = device.CreateShaderResourceView(m_proceduralTexture, nullptr, &m_proceduralSRV); }
+    return hr;
+}
+
+void Terrain::setTextures(const TextureHandle& heightmap, const TextureHandle& diffuse) {
+    m_heightmap = heightmap;
+    m_diffuse = diffuse;
+}
+
+void Terrain::requestTexels(AsyncTextureLoader& loader) const {
+    if (isActive() && !m_heightmap.isNull()) {
+        loader.requestTexels(m_heightmap, m_settings.extent / (std::max)(m_settings.cellSize, 1e-3f));
+    }
+}
+
+ID3D11ShaderResourceView* Terrain::getHeightSRV(unsigned int* size) const {
+    // El placeholder del cargador es de 1x1: hasta que llegue el mapa, el procedural.
+    if (!m_heightmap.isNull() && m_heightmap->srv() && m_heightmap->m_width > 1) {
+        if (size) {
+            *size = (std::max)(m_heightmap->m_width >> m_heightmap->m_residentMip, 1u);
+        }
+        return m_heightmap->srv();
+    }
+    if (size) {
+        *size = kProceduralSize;
+    }
+    return m_proceduralSRV;
+}
+
+/**
+ * @details Los centros se eligen del nivel más grueso al más fino. El más grueso se
+ * ajusta a su lado de bloque; cada nivel fino se pone a medio bloque grueso (un bloque
+ * suyo) del centro del grueso, hacia la cámara. Así el nivel fino ocupa justo 3x3
+ * bloques gruesos y entre su borde y el del grueso queda al menos un bloque, y la
+ * cámara nunca está a más de un bloque del centro de su nivel.
+ */
+void Terrain::buildInstances(const Frustum& frustum, const XMFLOAT3& cameraPosition, unsigned int heightmapSize) {
+    const Settings& settings = m_frameSettings;
+    const unsigned int levels = std::clamp(settings.levels, 1u, kMaxLevels);
+    const float cellSize = (std::max)(settings.cellSize, 1e-3f);
+    const float texel = (std::max)(settings.extent, 1e-3f) / static_cast<float>((std::max)(heightmapSize, 1u));
+    const float minHeight = settings.baseHeight + (std::min)(settings.heightScale, 0.0f);
+    const float maxHeight = settings.baseHeight + (std::max)(settings.heightScale, 0.0f);
+
+    float centerX[kMaxLevels];
+    float centerZ[kMaxLevels];
+    float mips[kMaxLevels];
+    for (int level = static_cast<int>(levels) - 1; level >= 0; --level) {
+        const float cell = cellSize * static_cast<float>(1u << level);
+        const float block = cell * kBlockQuads;
+        if (level == static_cast<int>(levels) - 1) {
+            centerX[level] = std::round(cameraPosition.x / block) * block;
+            centerZ[level] = std::round(cameraPosition.z / block) * block;
+        }
+        else {
+            centerX[level] = centerX[level + 1] + (cameraPosition.x >= centerX[level + 1] ? block : -block);
+            centerZ[level] = centerZ[level + 1] + (cameraPosition.z >= centerZ[level + 1] ? block : -block);
+        }
+        mips[level] = (std::max)(std::log2(cell / texel), 0.0f);
+    }
+
+    m_instances.clear();
+    m_lastCulled = 0;
+    const float halfBlocks = 0.5f * kBlocksPerSide;
+    for (unsigned int level = 0; level < levels; ++level) {
+        const float cell = cellSize * static_cast<float>(1u << level);
+        const float block = cell * kBlockQuads;
+        const float originX = centerX[level] - halfBlocks * block;
+        const float originZ = centerZ[level] - halfBlocks * block;
+        const bool last = level + 1 == levels;
+
+        // Hueco del nivel anterior (mide la mitad: kBlocksPerSide / 2 bloques de este).
+        float holeMinX = 0.0f, holeMinZ = 0.0f, holeMaxX = 0.0f, holeMaxZ = 0.0f;
+        if (level > 0) {
+            const float holeHalf = 0.5f * halfBlocks * block;
+            holeMinX = centerX[level - 1] - holeHalf;
+            holeMaxX = centerX[level - 1] + holeHalf;
+            holeMinZ = centerZ[level - 1] - holeHalf;
+            holeMaxZ = centerZ[level - 1] + holeHalf;
+        }
+        const float epsilon = 0.25f * cell;
+
+        for (unsigned int j = 0; j < kBlocksPerSide; ++j) {
+            for (unsigned int i = 0; i < kBlocksPerSide; ++i) {
+                const float x = originX + i * block;
+                const float z = originZ + j * block;
+                if (level > 0 && x >= holeMinX - epsilon && x + block <= holeMaxX + epsilon &&
+                    z >= holeMinZ - epsilon && z + block <= holeMaxZ + epsilon) {
+                    continue;
+                }
+                if (!frustum.intersectsAABB(XMFLOAT3(x, minHeight, z), XMFLOAT3(x + block, maxHeight, z + block))) {
+                    ++m_lastCulled;
+                    continue;
+                }
+                InstanceData instance;
+                instance.block = XMFLOAT4(x, z, cell, mips[level]);
+                // El último nivel no tiene a quién parecerse en el borde: sin transición.
+                instance.level = XMFLOAT4(centerX[level], centerZ[level], last ? 0.0f : halfBlocks * block,
+                    last ? mips[level] : mips[level + 1]);
+                m_instances.push_back(instance);
+            }
+        }
+    }
+}
+
+void Terrain::render(DeviceContext& deviceContext, const Frustum& frustum, const XMMATRIX& view,
+    const XMMATRIX& projection, const XMFLOAT3& cameraPosition, float viewportHeight) {
+    m_lastBlocks = 0;
+    m_lastCulled = 0;
+    if (!isActive()) {
+        return;
+    }
+    const Settings& settings = m_frameSettings;
+    unsigned int heightmapSize = 0;
+    ID3D11ShaderResourceView* heightSRV = getHeightSRV(&heightmapSize);
+    ID3D11ShaderResourceView* diffuseSRV = !m_diffuse.isNull() && m_diffuse->srv() ? m_diffuse->srv() : m_whiteSRV;
+
+    buildInstances(frustum, cameraPosition, heightmapSize);
+    const unsigned int count = static_cast<unsigned int>(m_instances.size());
+    if (count == 0) {
+        return;
+    }
+    DeviceContext::EventScope event(deviceContext, "Terrain");
+
+    D3D11_MAPPED_SUBRESOURCE mapped = {};
+    if (FAILED(m_instanceBuffer.map(deviceContext, D3D11_MAP_WRITE_DISCARD, 0, mapped))) {
+        return;
+    }
+    std::copy(m_instances.begin(), m_instances.end(), static_cast<InstanceData*>(mapped.pData));
+    m_instanceBuffer.unmap(deviceContext);
+
+    CBTerrain constants;
+    constants.view = XMMatrixTranspose(view);
+    constants.projection = XMMatrixTranspose(projection);
+    constants.camera = XMFLOAT4(cameraPosition.x, cameraPosition.y, cameraPosition.z, viewportHeight);
+    constants.heights = XMFLOAT4(settings.baseHeight, settings.heightScale,
+        1.0f / (std::max)(settings.extent, 1e-3f), settings.textureScale);
+    constants.tessellation = XMFLOAT4((std::max)(settings.tessellationFactor, 1.0f),
+        (std::max)(settings.tessellationPixels, 1.0f), XMVectorGetY(projection.r[1]), settings.roughness);
+    m_constants.set(constants);
+    m_constants.update(deviceContext);
+    m_constants.render(deviceContext, CB_SLOT_OBJECT, true);
+
+    const bool tessellate = settings.tessellation && supportsTessellation();
+    (tessellate ? m_tessProgram : m_program).render(deviceContext);
+    m_rasterizer.render(deviceContext);
+    deviceContext.VSSetShaderResources(2, 1, &heightSRV);
+    deviceContext.VSSetSamplers(3, 1, &m_heightSampler);
+    deviceContext.PSSetShaderResources(0, 1, &diffuseSRV);
+    deviceContext.PSSetSamplers(4, 1, &m_diffuseSampler);
+    if (tessellate) {
+        ID3D11Buffer* buffer = m_constants.getResource();
+        deviceContext.HSSetShader(m_hullShader, nullptr, 0);
+        deviceContext.HSSetConstantBuffers(CB_SLOT_OBJECT, 1, &buffer);
+        deviceContext.DSSetShader(m_domainShader, nullptr, 0);
+        deviceContext.DSSetConstantBuffers(CB_SLOT_OBJECT, 1, &buffer);
+        deviceContext.DSSetShaderResources(2, 1, &heightSRV);
+        deviceContext.DSSetSamplers(3, 1, &m_heightSampler);
+        deviceContext.IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_3_CONTROL_POINT_PATCHLIST);
+    }
+    else {
+        deviceContext.IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    }
+    m_gridIndices.render(deviceContext, 0, 1, false, DXGI_FORMAT_R16_UINT);
+    m_instanceBuffer.render(deviceContext, VERTEX_STREAM_INSTANCE, 1);
+    deviceContext.DrawIndexedInstanced(m_gridIndexCount, count, 0, 0, 0);
+    m_lastBlocks = count;
+
+    if (tessellate) {
+        // El resto del motor no espera hull ni domain enlazados.
+        deviceContext.HSSetShader(nullptr, nullptr, 0);
+        deviceContext.DSSetShader(nullptr, nullptr, 0);
+        deviceContext.IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    }
+}
+
+void Terrain::destroy() {
+    m_program.destroy();
+    m_tessProgram.destroy();
+    SAFE_RELEASE(m_hullShader);
+    SAFE_RELEASE(m_domainShader);
+    m_gridIndices.destroy();
+    m_gridIndexCount = 0;
+    m_instanceBuffer.destroy();
+    m_constants.destroy();
+    m_rasterizer.destroy();
+    SAFE_RELEASE(m_heightSampler);
+    SAFE_RELEASE(m_diffuseSampler);
+    SAFE_RELEASE(m_proceduralSRV);
+    SAFE_RELEASE(m_proceduralTexture);
+    SAFE_RELEASE(m_whiteSRV);
+    SAFE_RELEASE(m_whiteTexture);
+    m_heightmap = TextureHandle();
+    m_diffuse = TextureHandle();
+    m_instances.clear();
+    m_device = nullptr;
+}
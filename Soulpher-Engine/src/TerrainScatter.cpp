@@ -0,0 +1,476 @@
+﻿/**
+ * @file TerrainScatter.cpp
+ * @brief Implementación del scatter: formas, tiles visibles, kernel de generación y
+ * dibujo indirecto por capa.
+ *
+ * @details
+ * Orden de un frame: @ref TerrainScatter::generate en el bloque de culling (tiles,
+ * argumentos a 0 y los dos kernels) y @ref TerrainScatter::render tras el terreno. Cada
+ * capa tiene su rango fijo en la lista de instancias (`capa * kLayerCapacity`), así que
+ * el kernel nunca escribe fuera de él aunque todos los candidatos pasen.
+ */
+
+#include "TerrainScatter.h"
+#include "Device.h"
+#include "DeviceContext.h"
+#include "ShaderLibrary.h"
+#include "VertexLayout.h"
+#include "Frustum.h"
+#include "HiZBuffer.h"
+#include "Terrain.h"
+#include <algorithm>
+#include <cmath>
+
+const ConstantBufferLayouts::Registration TerrainScatter::kScatterLayout({ "cbScatter", CB_SLOT_OBJECT,
+    sizeof(CBScatter), {
+        CB_FIELD(CBScatter, planes, "Planes"),
+        CB_FIELD(CBScatter, hiZViewProj, "HiZViewProj"),
+        CB_FIELD(CBScatter, camera, "Camera"),
+        CB_FIELD(CBScatter, heights, "Heights"),
+        CB_FIELD(CBScatter, placement, "Placement"),
+        CB_FIELD(CBScatter, shape, "Shape"),
+        CB_FIELD(CBScatter, bounds, "Bounds"),
+        CB_FIELD(CBScatter, color, "Colors"),
+        CB_FIELD(CBScatter, tileCount, "TileCount"),
+        CB_FIELD(CBScatter, hiZMipCount, "HiZMipCount"),
+        CB_FIELD(CBScatter, hiZSize, "HiZSize"),
+        CB_FIELD(CBScatter, roughness, "Roughness") } });
+
+namespace {
+    /// Grupos del kernel por tile (64 hilos por grupo).
+    const unsigned int kGroupsPerTile = TerrainScatter::kTileCandidates * TerrainScatter::kTileCandidates / 64;
+    /// Fracción del alcance donde la densidad empieza a bajar.
+    const float kFadeStart = 0.7f;
+}
+
+TerrainScatter::Settings::Settings() {
+    // Capa 0: hierba (los valores por defecto de Layer). Capa 1: piedras sueltas.
+    Layer& rocks = layers[1];
+    rocks.shape = SCATTER_ROCK;
+    rocks.spacing = 5.0f;
+    rocks.density = 0.3f;
+    rocks.maxDistance = 250.0f;
+    rocks.minScale = 0.3f;
+    rocks.maxScale = 1.4f;
+    rocks.minUp = 0.6f;
+    rocks.densityChannel = 1;
+    rocks.color = XMFLOAT4(0.46f, 0.44f, 0.41f, 1.0f);
+    rocks.colorVariation = 0.15f;
+    layers[2].densityChannel = 2;
+    layers[3].densityChannel = 3;
+}
+
+HRESULT TerrainScatter::init(Device& device) {
+    if (!device.m_device) {
+        ERROR("TerrainScatter", "init", "Device is null.");
+        return E_POINTER;
+    }
+    destroy();
+
+    // Argumentos indirectos escritos por UAV: nivel 11_0.
+    if (device.m_device->GetFeatureLevel() < D3D_FEATURE_LEVEL_11_0) {
+        MESSAGE("TerrainScatter", "init", "Feature level < 11_0: terrain scatter disabled.");
+        return DXGI_ERROR_UNSUPPORTED;
+    }
+
+    const std::vector<D3D11_INPUT_ELEMENT_DESC> layout = VertexLayout()
+        .add("POSITION", 0, DXGI_FORMAT_R32G32B32A32_FLOAT)
+        .append(VertexLayout::instanceSlot())
+        .getDesc();
+    HRESULT hr = m_program.init(device, "TerrainScatter.fx", layout);
+    if (SUCCEEDED(hr)) { hr = createMeshes(device); }
+
+    // Identidad por instancia: con StartInstanceLocation = inicio de la capa, el VS
+    // recibe su hueco en la lista.
+    const unsigned int capacity = kMaxLayers * kLayerCapacity;
+    if (SUCCEEDED(hr)) {
+        std::vector<unsigned int> slots(capacity);
+        for (unsigned int i = 0; i < capacity; ++i) {
+            slots[i] = i;
+        }
+        hr = m_slotBuffer.create(device, BUFFER_IMMUTABLE, D3D11_BIND_VERTEX_BUFFER,
+            capacity * sizeof(unsigned int), sizeof(unsigned int), slots.data());
+    }
+
+    D3D11_BUFFER_DESC desc = {};
+    D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+    srvDesc.Format = DXGI_FORMAT_UNKNOWN;
+    srvDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+    if (SUCCEEDED(hr)) {
+        desc.Usage = D3D11_USAGE_DYNAMIC;
+        desc.ByteWidth = kMaxTiles * sizeof(TileData);
+        desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+        desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+        desc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+        desc.StructureByteStride = sizeof(TileData);
+        hr = device.CreateBuffer(&desc, nullptr, &m_tileBuffer);
+        srvDesc.Buffer.NumElements = kMaxTiles;
+        if (SUCCEEDED(hr)) { hr = device.CreateShaderResourceView(m_tileBuffer, &srvDesc, &m_tileSRV); }
+    }
+    if (SUCCEEDED(hr)) {
+        desc.Usage = D3D11_USAGE_DEFAULT;
+        desc.ByteWidth = capacity * sizeof(InstanceData);
+        desc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_UNORDERED_ACCESS;
+        desc.CPUAccessFlags = 0;
+        desc.StructureByteStride = sizeof(InstanceData);
+        hr = device.CreateBuffer(&desc, nullptr, &m_instanceBuffer);
+        srvDesc.Buffer.NumElements = capacity;
+        if (SUCCEEDED(hr)) { hr = device.CreateShaderResourceView(m_instanceBuffer, &srvDesc, &m_instanceSRV); }
+
+        D3D11_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
+        uavDesc.Format = DXGI_FORMAT_UNKNOWN;
+        uavDesc.ViewDimension = D3D11_UAV_DIMENSION_BUFFER;
+        uavDesc.Buffer.NumElements = capacity;
+        if (SUCCEEDED(hr)) { hr = device.CreateUnorderedAccessView(m_instanceBuffer, &uavDesc, &m_instanceUAV); }
+    }
+    if (SUCCEEDED(hr)) {
+        desc.Usage = D3D11_USAGE_DEFAULT;
+        desc.ByteWidth = kMaxLayers * sizeof(DrawArgs);
+        desc.BindFlags = D3D11_BIND_UNORDERED_ACCESS;
+        desc.CPUAccessFlags = 0;
+        desc.MiscFlags = D3D11_RESOURCE_MISC_DRAWINDIRECT_ARGS;
+        desc.StructureByteStride = 0;
+        hr = device.CreateBuffer(&desc, nullptr, &m_argsBuffer);
+
+        // Vista tipada R32_UINT: el kernel suma con InterlockedAdd sobre el conteo.
+        D3D11_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
+        uavDesc.Format = DXGI_FORMAT_R32_UINT;
+        uavDesc.ViewDimension = D3D11_UAV_DIMENSION_BUFFER;
+        uavDesc.Buffer.NumElements = kMaxLayers * (sizeof(DrawArgs) / sizeof(unsigned int));
+        if (SUCCEEDED(hr)) { hr = device.CreateUnorderedAccessView(m_argsBuffer, &uavDesc, &m_argsUAV); }
+    }
+    if (SUCCEEDED(hr)) { hr = m_constants.init(device); }
+    if (SUCCEEDED(hr)) { hr = m_rasterizer.init(device); }
+    if (SUCCEEDED(hr)) { hr = m_twoSidedRasterizer.init(device, 0, 0.0f, D3D11_CULL_NONE); }
+    if (SUCCEEDED(hr)) {
+        D3D11_SAMPLER_DESC samplerDesc = {};
+        samplerDesc.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+        samplerDesc.AddressU = D3D11_TEXTURE_ADDRESS_CLAMP;
+        samplerDesc.AddressV = D3D11_TEXTURE_ADDRESS_CLAMP;
+        samplerDesc.AddressW = D3D11_TEXTURE_ADDRESS_CLAMP;
+        samplerDesc.ComparisonFunc = D3D11_COMPARISON_NEVER;
+        samplerDesc.MaxLOD = D3D11_FLOAT32_MAX;
+        hr = device.CreateSharedSamplerState(&samplerDesc, &m_sampler);
+    }
+    if (SUCCEEDED(hr)) {
+        const unsigned int white = 0xffffffff;
+        D3D11_TEXTURE2D_DESC textureDesc = {};
+        textureDesc.Width = 1;
+        textureDesc.Height = 1;
+        textureDesc.MipLevels = 1;
+        textureDesc.ArraySize = 1;
+        textureDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        textureDesc.SampleDesc.Count = 1;
+        textureDesc.Usage = D3D11_USAGE_IMMUTABLE;
+        textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+        D3D11_SUBRESOURCE_DATA data = { &white, sizeof(white), 0 };
+        hr = device.CreateTexture2D(&textureDesc, &data, &m_whiteTexture);
+    }
+    if (SUCCEEDED(hr)) { hr = device.CreateShaderResourceView(m_whiteTexture, nullptr, &m_whiteSRV); }
+    if (SUCCEEDED(hr)) {
+        ShaderKey key;
+        key.fileName = "TerrainScatter.fx";
+        key.entryPoint = "CSScatter";
+        key.profile = "cs_5_0";
+        hr = device.getShaderLibrary().getComputeShader(device, key, &m_scatterShader);
+        if (SUCCEEDED(hr)) {
+            key.entryPoint = "CSFinalize";
+            hr = device.getShaderLibrary().getComputeShader(device, key, &m_finalizeShader);
+        }
+    }
+    if (FAILED(hr)) {
+        ERROR("TerrainScatter", "init", ("Failed to create scatter resources. HRESULT: " + std::to_string(hr)).c_str());
+        destroy();
+        return hr;
+    }
+    m_device = &device;
+    return S_OK;
+}
+
+/**
+ * @details Vértices `(x, y, z, viento)`. La mata son tres briznas de tres tramos que se
+ * estrechan hasta la punta y se inclinan hacia fuera (el viento crece con el cuadrado
+ * de la altura: la base no se mueve). La piedra es un icosaedro de radio 0.5 achatado
+ * y medio enterrado; sus caras miran hacia fuera en el sentido de las agujas del reloj.
+ */
+HRESULT TerrainScatter::createMeshes(Device& device) {
+    const unsigned int kSegments = 3;
+    const float kBladeHeight = 0.6f;
+    const float kBladeWidth = 0.05f;
+    const float kBladeOffset = 0.04f;
+    const float kBladeLean = 0.15f;
+
+    std::vector<XMFLOAT4> vertices;
+    std::vector<unsigned int> indices;
+    for (unsigned int blade = 0; blade < 3; ++blade) {
+        const float angle = blade * XM_2PI / 3.0f + 0.35f;
+        const float dx = std::cos(angle), dz = std::sin(angle);
+        const unsigned int first = static_cast<unsigned int>(vertices.size());
+        for (unsigned int k = 0; k <= kSegments; ++k) {
+            const float t = static_cast<float>(k) / kSegments;
+            const float cx = dx * (kBladeOffset + kBladeLean * t * t);
+            const float cz = dz * (kBladeOffset + kBladeLean * t * t);
+            const float y = t * kBladeHeight;
+            if (k == kSegments) {
+                vertices.push_back(XMFLOAT4(cx, y, cz, 1.0f));
+                break;
+            }
+            // El ancho va en perpendicular a la inclinación.
+            const float halfWidth = kBladeWidth * (1.0f - t);
+            vertices.push_back(XMFLOAT4(cx + dz * halfWidth, y, cz - dx * halfWidth, t * t));
+            vertices.push_back(XMFLOAT4(cx - dz * halfWidth, y, cz + dx * halfWidth, t * t));
+        }
+        for (unsigned int k = 0; k + 1 < kSegments; ++k) {
+            const unsigned int v = first + 2 * k;
+            indices.insert(indices.end(), { v, v + 2, v + 1, v + 1, v + 2, v + 3 });
+        }
+        const unsigned int last = first + 2 * (kSegments - 1);
+        indices.insert(indices.end(), { last, last + 2, last + 1 });
+    }
+    ShapeRange& grass = m_shapes[SCATTER_GRASS];
+    grass.indexCount = static_cast<unsigned int>(indices.size());
+    grass.startIndex = 0;
+    grass.baseVertex = 0;
+    grass.radius = kBladeOffset + kBladeLean + kBladeWidth;
+    grass.height = kBladeHeight;
+
+    const float kRockRadius = 0.5f;
+    const float kRockFlatten = 0.6f;
+    const float kRockSink = 0.1f;
+    const float g = 0.5f * (1.0f + std::sqrt(5.0f));
+    const XMFLOAT3 corners[12] = {
+        { -1.0f, g, 0.0f }, { 1.0f, g, 0.0f }, { -1.0f, -g, 0.0f }, { 1.0f, -g, 0.0f },
+        { 0.0f, -1.0f, g }, { 0.0f, 1.0f, g }, { 0.0f, -1.0f, -g }, { 0.0f, 1.0f, -g },
+        { g, 0.0f, -1.0f }, { g, 0.0f, 1.0f }, { -g, 0.0f, -1.0f }, { -g, 0.0f, 1.0f } };
+    const unsigned int faces[60] = {
+        0, 11, 5,  0, 5, 1,  0, 1, 7,  0, 7, 10,  0, 10, 11,
+        1, 5, 9,  5, 11, 4,  11, 10, 2,  10, 7, 6,  7, 1, 8,
+        3, 9, 4,  3, 4, 2,  3, 2, 6,  3, 6, 8,  3, 8, 9,
+        4, 9, 5,  2, 4, 11,  6, 2, 10,  8, 6, 7,  9, 8, 1 };
+    const float scale = kRockRadius / std::sqrt(1.0f + g * g);
+    ShapeRange& rock = m_shapes[SCATTER_ROCK];
+    rock.indexCount = 60;
+    rock.startIndex = static_cast<unsigned int>(indices.size());
+    rock.baseVertex = static_cast<int>(vertices.size());
+    rock.radius = kRockRadius;
+    rock.height = kRockRadius * kRockFlatten - kRockSink;
+    for (const XMFLOAT3& corner : corners) {
+        vertices.push_back(XMFLOAT4(corner.x * scale, corner.y * scale * kRockFlatten - kRockSink,
+            corner.z * scale, 0.0f));
+    }
+    indices.insert(indices.end(), faces, faces + 60);
+
+    HRESULT hr = m_vertices.create(device, BUFFER_IMMUTABLE, D3D11_BIND_VERTEX_BUFFER,
+        static_cast<unsigned int>(vertices.size() * sizeof(XMFLOAT4)), sizeof(XMFLOAT4), vertices.data());
+    if (SUCCEEDED(hr)) {
+        hr = m_indices.initIndices(device, indices.data(), static_cast<unsigned int>(indices.size()), true);
+    }
+    return hr;
+}
+
+void TerrainScatter::capture(float deltaTime) {
+    m_frameSettings = m_settings;
+    m_frameTime += deltaTime;
+}
+
+/**
+ * @details Por capa, los tiles del cuadrado que rodea a la cámara cuyo punto más
+ * cercano (en planta) está dentro del alcance. La caja de un tile va del mínimo al
+ * máximo del terreno, ampliada con la instancia más grande de la capa: en pendiente
+ * una piedra puede asomar por encima del tile vecino.
+ */
+void TerrainScatter::buildTiles(const Terrain& terrain, const Frustum& frustum, const HiZBuffer& hiZ,
+    const XMFLOAT3& cameraPosition) {
+    const Settings& settings = m_frameSettings;
+    const Terrain::Settings& terrainSettings = terrain.getFrameSettings();
+    const float minHeight = terrainSettings.baseHeight + (std::min)(terrainSettings.heightScale, 0.0f);
+    const float maxHeight = terrainSettings.baseHeight + (std::max)(terrainSettings.heightScale, 0.0f);
+    const bool useHiZ = hiZ.hasData();
+
+    m_tiles.clear();
+    const unsigned int layers = (std::min)(settings.layerCount, kMaxLayers);
+    for (unsigned int layer = 0; layer < layers; ++layer) {
+        const Layer& params = settings.layers[layer];
+        if (params.density * settings.densityScale <= 0.0f || params.maxDistance <= 0.0f ||
+            params.shape >= SCATTER_SHAPE_COUNT) {
+            continue;
+        }
+        const float tileSize = (std::max)(params.spacing, 0.05f) * kTileCandidates;
+        const ShapeRange& shape = m_shapes[params.shape];
+        const float radius = shape.radius * params.maxScale + settings.wind;
+        const float top = shape.height * params.maxScale;
+        const float maxDistanceSq = params.maxDistance * params.maxDistance;
+
+        const int x0 = static_cast<int>(std::floor((cameraPosition.x - params.maxDistance) / tileSize));
+        const int x1 = static_cast<int>(std::floor((cameraPosition.x + params.maxDistance) / tileSize));
+        const int z0 = static_cast<int>(std::floor((cameraPosition.z - params.maxDistance) / tileSize));
+        const int z1 = static_cast<int>(std::floor((cameraPosition.z + params.maxDistance) / tileSize));
+        for (int z = z0; z <= z1; ++z) {
+            for (int x = x0; x <= x1; ++x) {
+                const float minX = x * tileSize;
+                const float minZ = z * tileSize;
+                const float dx = (std::max)({ minX - cameraPosition.x, cameraPosition.x - minX - tileSize, 0.0f });
+                const float dz = (std::max)({ minZ - cameraPosition.z, cameraPosition.z - minZ - tileSize, 0.0f });
+                if (dx * dx + dz * dz > maxDistanceSq) {
+                    ++m_lastCulledTiles;
+                    continue;
+                }
+                const XMFLOAT3 boundsMin(minX - radius, minHeight - radius, minZ - radius);
+                const XMFLOAT3 boundsMax(minX + tileSize + radius, maxHeight + top, minZ + tileSize + radius);
+                if (!frustum.intersectsAABB(boundsMin, boundsMax) || (useHiZ && hiZ.isOccluded(boundsMin, boundsMax)) ||
+                    m_tiles.size() >= kMaxTiles) {
+                    ++m_lastCulledTiles;
+                    continue;
+                }
+                TileData tile;
+                tile.cellX = x * static_cast<int>(kTileCandidates);
+                tile.cellZ = z * static_cast<int>(kTileCandidates);
+                tile.layer = layer;
+                tile.pad = 0;
+                m_tiles.push_back(tile);
+            }
+        }
+    }
+}
+
+void TerrainScatter::generate(DeviceContext& deviceContext, const Terrain& terrain, const Frustum& frustum,
+    const HiZBuffer& hiZ, const XMFLOAT3& cameraPosition) {
+    m_generatedLayers = 0;
+    m_lastTiles = 0;
+    m_lastCulledTiles = 0;
+    if (!isActive() || !terrain.isActive()) {
+        return;
+    }
+    const Settings& settings = m_frameSettings;
+    buildTiles(terrain, frustum, hiZ, cameraPosition);
+    const unsigned int tileCount = static_cast<unsigned int>(m_tiles.size());
+    if (tileCount == 0) {
+        return;
+    }
+    DeviceContext::EventScope event(deviceContext, "Terrain scatter");
+
+    // Cada capa dibuja su forma desde el inicio de su rango; el conteo arranca a 0.
+    const unsigned int layers = (std::min)(settings.layerCount, kMaxLayers);
+    DrawArgs args[kMaxLayers] = {};
+    for (unsigned int layer = 0; layer < kMaxLayers; ++layer) {
+        const ScatterShape shape = layer < layers && settings.layers[layer].shape < SCATTER_SHAPE_COUNT ?
+            settings.layers[layer].shape : SCATTER_GRASS;
+        args[layer].indexCount = m_shapes[shape].indexCount;
+        args[layer].startIndex = m_shapes[shape].startIndex;
+        args[layer].baseVertex = m_shapes[shape].baseVertex;
+        args[layer].startInstance = layer * kLayerCapacity;
+    }
+    deviceContext.UpdateSubresource(m_argsBuffer, 0, nullptr, args, 0, 0);
+
+    D3D11_MAPPED_SUBRESOURCE mapped = {};
+    if (FAILED(deviceContext.Map(m_tileBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped))) {
+        return;
+    }
+    memcpy(mapped.pData, m_tiles.data(), tileCount * sizeof(TileData));
+    deviceContext.Unmap(m_tileBuffer, 0);
+
+    const Terrain::Settings& terrainSettings = terrain.getFrameSettings();
+    const bool useHiZ = hiZ.isEnabled() && hiZ.hasPyramid();
+    CBScatter constants = {};
+    for (unsigned int i = 0; i < 6; ++i) {
+        constants.planes[i] = frustum.getPlane(i);
+    }
+    constants.hiZViewProj = XMMatrixTranspose(useHiZ ? hiZ.getPyramidViewProj() : XMMatrixIdentity());
+    constants.camera = XMFLOAT4(cameraPosition.x, cameraPosition.y, cameraPosition.z, m_frameTime);
+    constants.heights = XMFLOAT4(terrainSettings.baseHeight, terrainSettings.heightScale,
+        1.0f / (std::max)(terrainSettings.extent, 1e-3f), settings.wind);
+    for (unsigned int layer = 0; layer < layers; ++layer) {
+        const Layer& params = settings.layers[layer];
+        const ShapeRange& shape = m_shapes[params.shape < SCATTER_SHAPE_COUNT ? params.shape : SCATTER_GRASS];
+        constants.placement[layer] = XMFLOAT4((std::max)(params.spacing, 0.05f),
+            std::clamp(params.density * settings.densityScale, 0.0f, 1.0f),
+            params.maxDistance, params.maxDistance * kFadeStart);
+        constants.shape[layer] = XMFLOAT4(params.minScale, params.maxScale, params.minUp,
+            static_cast<float>((std::min)(params.densityChannel, 3u)));
+        constants.bounds[layer] = XMFLOAT4(shape.radius, shape.height, 0.0f, 0.0f);
+        constants.color[layer] = XMFLOAT4(params.color.x, params.color.y, params.color.z, params.colorVariation);
+    }
+    constants.tileCount = tileCount;
+    constants.hiZMipCount = useHiZ ? hiZ.getMipCount() : 0;
+    constants.hiZSize[0] = hiZ.getPyramidWidth();
+    constants.hiZSize[1] = hiZ.getPyramidHeight();
+    constants.roughness = settings.roughness;
+    m_constants.set(constants);
+    m_constants.update(deviceContext);
+
+    ID3D11Buffer* buffer = m_constants.getResource();
+    ID3D11ShaderResourceView* hiZSRV = useHiZ ? hiZ.getPyramidSRV() : nullptr;
+    ID3D11ShaderResourceView* maps[2] = { terrain.getHeightSRV(),
+        !m_densityMap.isNull() && m_densityMap->srv() ? m_densityMap->srv() : m_whiteSRV };
+    ID3D11UnorderedAccessView* uavs[2] = { m_argsUAV, m_instanceUAV };
+    deviceContext.CSSetShader(m_scatterShader, nullptr, 0);
+    deviceContext.CSSetConstantBuffers(CB_SLOT_OBJECT, 1, &buffer);
+    deviceContext.CSSetShaderResources(0, 1, &m_tileSRV);
+    deviceContext.CSSetShaderResources(2, 1, &hiZSRV);
+    deviceContext.CSSetShaderResources(9, 2, maps);
+    deviceContext.CSSetSamplers(3, 1, &m_sampler);
+    deviceContext.CSSetUnorderedAccessViews(0, 2, uavs, nullptr);
+    deviceContext.Dispatch(kGroupsPerTile, tileCount, 1);
+    deviceContext.CSSetShader(m_finalizeShader, nullptr, 0);
+    deviceContext.Dispatch(1, 1, 1);
+
+    // Desenlazar: la lista pasa a leerse en el VS y los argumentos en el draw.
+    ID3D11ShaderResourceView* nullSRVs[2] = { nullptr, nullptr };
+    ID3D11UnorderedAccessView* nullUAVs[2] = { nullptr, nullptr };
+    deviceContext.CSSetShaderResources(0, 1, nullSRVs);
+    deviceContext.CSSetShaderResources(2, 1, nullSRVs);
+    deviceContext.CSSetShaderResources(9, 2, nullSRVs);
+    deviceContext.CSSetUnorderedAccessViews(0, 2, nullUAVs, nullptr);
+    deviceContext.CSSetShader(nullptr, nullptr, 0);
+
+    m_generatedLayers = layers;
+    m_lastTiles = tileCount;
+}
+
+void TerrainScatter::render(DeviceContext& deviceContext) {
+    if (m_generatedLayers == 0) {
+        return;
+    }
+    DeviceContext::EventScope event(deviceContext, "Terrain scatter");
+    m_program.render(deviceContext);
+    m_constants.render(deviceContext, CB_SLOT_OBJECT, true);
+    deviceContext.IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    m_vertices.render(deviceContext, VERTEX_STREAM_GEOMETRY, 1);
+    m_slotBuffer.render(deviceContext, VERTEX_STREAM_INSTANCE, 1);
+    m_indices.render(deviceContext, 0, 1, false, DXGI_FORMAT_R16_UINT);
+    deviceContext.VSSetShaderResources(3, 1, &m_instanceSRV);
+
+    for (unsigned int layer = 0; layer < m_generatedLayers; ++layer) {
+        (m_frameSettings.layers[layer].shape == SCATTER_GRASS ? m_twoSidedRasterizer : m_rasterizer).render(deviceContext);
+        deviceContext.DrawIndexedInstancedIndirect(m_argsBuffer, layer * static_cast<unsigned int>(sizeof(DrawArgs)));
+    }
+
+    ID3D11ShaderResourceView* nullSRV = nullptr;
+    deviceContext.VSSetShaderResources(3, 1, &nullSRV);
+}
+
+void TerrainScatter::destroy() {
+    SAFE_RELEASE(m_scatterShader);
+    SAFE_RELEASE(m_finalizeShader);
+    m_program.destroy();
+    m_vertices.destroy();
+    m_indices.destroy();
+    m_slotBuffer.destroy();
+    SAFE_RELEASE(m_tileSRV);
+    SAFE_RELEASE(m_tileBuffer);
+    SAFE_RELEASE(m_instanceSRV);
+    SAFE_RELEASE(m_instanceUAV);
+    SAFE_RELEASE(m_instanceBuffer);
+    SAFE_RELEASE(m_argsUAV);
+    SAFE_RELEASE(m_argsBuffer);
+    m_constants.destroy();
+    m_rasterizer.destroy();
+    m_twoSidedRasterizer.destroy();
+    SAFE_RELEASE(m_sampler);
+    SAFE_RELEASE(m_whiteSRV);
+    SAFE_RELEASE(m_whiteTexture);
+    m_densityMap = TextureHandle();
+    m_tiles.clear();
+    m_generatedLayers = 0;
+    m_device = nullptr;
+}
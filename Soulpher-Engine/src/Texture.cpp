@@ -3,26 +3,43 @@
  * @brief Carga/creación, enlace y liberación de texturas 2D (SRV).
  *
  * @details
- * Ofrece tres sobrecargas de init():
- *  - init(Device, const std::string&, ExtensionType): carga desde DDS o PNG.
+ * Ofrece estas sobrecargas de init():
+ *  - init(Device, const std::string&, ExtensionType): carga desde DDS, PNG, JPG, TGA o HDR.
+ *    Lo que no es DDS se decodifica con @ref ImageDecoder; las imágenes de 8 bits se
+ *    crean con su cadena de mips completa (@ref MipChain) y opcionalmente comprimidas
+ *    a BCn con caché DDS junto al original (@ref DdsFile).
+ *    La variante con `ID3D11Device*` es la misma carga sin copiar `Device` (la usan
+ *    los hilos de @ref AsyncTextureLoader).
  *  - init(Device, width, height, Format, BindFlags, sampleCount, qualityLevels): crea una textura vacía.
  *  - init(Device&, Texture&, DXGI_FORMAT): crea una SRV aliasando otra textura existente.
+ *  - init(Device&, width, height, rgba): textura inmutable desde píxeles en memoria.
  *
- * Incluye además update(), render() para enlazar como SRV en el PS, y destroy() para liberar recursos.
+ * Incluye además update(), render() para enlazar como SRV en el PS, share() para
+ * repartir la misma textura entre actores, y destroy() para liberar recursos.
  */
 
-#define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
 #include "Texture.h"
 #include "Device.h"
 #include "DeviceContext.h"
+#include "GpuMemory.h"
+#include "MipChain.h"
+#include "DdsFile.h"
+#include "ImageDecoder.h"
+#include "GpuReleaseQueue.h"
 
  // Helper local (evita macro-collisions con SAFE_RELEASE)
 static void SafeRelease(IUnknown*& p) { if (p) { p->Release(); p = nullptr; } }
 
 HRESULT
-Texture::init(Device device, const std::string& textureName, ExtensionType extensionType) {
-    if (!device.m_device) {
+Texture::init(Device device, const std::string& textureName, ExtensionType extensionType,
+    TextureCompression compression) {
+    return init(device.m_device, textureName, extensionType, compression);
+}
+
+HRESULT
+Texture::init(ID3D11Device* device, const std::string& textureName, ExtensionType extensionType,
+    TextureCompression compression, unsigned int maxSize) {
+    if (!device) {
         ERROR("Texture", "init", "Device is null.");
         return E_POINTER;
     }
@@ -36,77 +53,131 @@ Texture::init(Device device, const std::string& textureName, ExtensionType exten
     if (m_texture) { m_texture->Release();        m_texture = nullptr; }
 
     HRESULT hr = S_OK;
+    DdsFile::Info info;
 
     switch (extensionType) {
     case DDS: {
         m_textureName = textureName + ".dds";
 
-        // Carga directa a SRV (el recurso subyacente queda referenciado por la SRV)
-        hr = D3DX11CreateShaderResourceViewFromFileA(
-            device.m_device,
-            m_textureName.c_str(),
-            nullptr,
-            nullptr,
-            &m_textureFromImg,
-            nullptr
-        );
+        // Archivo mapeado directo a CreateTexture2D (la SRV mantiene viva la textura)
+        hr = DdsFile::load(device, m_textureName, &m_textureFromImg, false, maxSize, &info);
 
         if (FAILED(hr)) {
             ERROR("Texture", "init",
                 ("Failed to load DDS texture. Verify filepath: " + m_textureName).c_str());
             return hr;
         }
+        setResidency(info);
         break;
     }
 
-    case PNG: {
-        m_textureName = textureName + ".png";
-        int width = 0, height = 0, channels = 0;
+    case PNG:
+    case JPG:
+    case TGA:
+    case HDR: {
+        static const char* const kExtensions[] = { ".dds", ".png", ".jpg", ".tga", ".hdr" };
+        m_textureName = textureName + kExtensions[extensionType];
+
+        // Comprimida: si la caché DDS está al día se suben sus bloques sin decodificar.
+        const std::string cachePath = compression != TEXTURE_COMPRESSION_NONE
+            ? DdsFile::getCachePath(m_textureName, compression) : std::string();
+        if (!cachePath.empty() && extensionType != HDR && DdsFile::isFresh(cachePath, m_textureName) &&
+            SUCCEEDED(DdsFile::load(device, cachePath, &m_textureFromImg, true, maxSize, &info))) {
+            setResidency(info);
+            return S_OK;
+        }
 
-        // Cargar PNG con stb (forzamos RGBA = 4)
-        unsigned char* data = stbi_load(m_textureName.c_str(), &width, &height, &channels, 4);
-        if (!data) {
-            ERROR("Texture", "init",
-                ("Failed to load PNG texture: " + std::string(stbi_failure_reason())).c_str());
+        // Decodificar (el formato real se detecta por el contenido, no por la extensión)
+        DecodedImage image;
+        std::string reason;
+        if (FAILED(ImageDecoder::decodeFile(m_textureName, image, &reason))) {
+            ERROR("Texture", "init", ("Failed to load " + m_textureName + ": " + reason).c_str());
             return E_FAIL;
         }
 
+        // Cadena de mips en CPU: la textura se crea completa e inmutable (sin contexto).
+        // El mip 0 es el propio búfer del decodificador. HDR (float) va sin mips ni BCn.
+        MipChain mips;
+        if (!image.isHdr()) {
+            mips.build(image.getPixels(), image.getWidth(), image.getHeight(), false);
+        }
+
+        // Codificar y guardar la caché; BCn exige un nivel 0 múltiplo de 4 (si no, RGBA8).
+        CompressedImage compressed;
+        const bool useCompressed = !cachePath.empty() && !image.isHdr() &&
+            BlockCompressor::compress(mips, compression, compressed);
+        if (useCompressed) {
+            DdsFile::write(cachePath, compressed); // sin caché solo se pierde tiempo la próxima vez
+        }
+
+        // Niveles completos y primer nivel que se sube (streaming: los más detallados
+        // se omiten; en BCn el nuevo mip 0 también tiene que ser múltiplo de 4).
+        info.width = image.getWidth();
+        info.height = image.getHeight();
+        info.mipCount = static_cast<unsigned int>(useCompressed ? compressed.levels.size() :
+            image.isHdr() ? 1 : mips.getLevels().size());
+        unsigned int skip = 0;
+        while (maxSize && skip + 1 < info.mipCount && ((std::max)(info.width, info.height) >> skip) > maxSize) {
+            ++skip;
+        }
+        while (skip > 0 && useCompressed &&
+            (compressed.levels[skip].width % 4 != 0 || compressed.levels[skip].height % 4 != 0)) {
+            --skip;
+        }
+        info.residentMip = skip;
+
         // Descripción de textura 2D
         D3D11_TEXTURE2D_DESC textureDesc = {};
-        textureDesc.Width = width;
-        textureDesc.Height = height;
-        textureDesc.MipLevels = 1;
+        textureDesc.Width = (std::max)(image.getWidth() >> skip, 1u);
+        textureDesc.Height = (std::max)(image.getHeight() >> skip, 1u);
+        textureDesc.MipLevels = info.mipCount - skip;
         textureDesc.ArraySize = 1;
-        textureDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        textureDesc.Format = useCompressed ? compressed.format : image.getDxgiFormat();
         textureDesc.SampleDesc.Count = 1;
         textureDesc.SampleDesc.Quality = 0;
-        textureDesc.Usage = D3D11_USAGE_DEFAULT;
+        textureDesc.Usage = D3D11_USAGE_IMMUTABLE;
         textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
         textureDesc.CPUAccessFlags = 0;
         textureDesc.MiscFlags = 0;
 
-        // Datos iniciales
-        D3D11_SUBRESOURCE_DATA initData = {};
-        initData.pSysMem = data;
-        initData.SysMemPitch = width * 4;
+        // Datos iniciales: un subrecurso por mip residente
+        std::vector<D3D11_SUBRESOURCE_DATA> initData(textureDesc.MipLevels);
+        for (UINT i = 0; i < textureDesc.MipLevels; ++i) {
+            const UINT level = i + skip;
+            if (useCompressed) {
+                initData[i].pSysMem = compressed.data.data() + compressed.levels[level].offset;
+                initData[i].SysMemPitch = compressed.levels[level].rowPitch;
+                info.residentBytes += compressed.levels[level].size;
+            }
+            else if (image.isHdr()) {
+                initData[i].pSysMem = image.getPixels();
+                initData[i].SysMemPitch = image.getWidth() * image.getBytesPerPixel();
+                info.residentBytes += static_cast<size_t>(initData[i].SysMemPitch) * image.getHeight();
+            }
+            else {
+                initData[i].pSysMem = mips.getLevelPixels(level);
+                initData[i].SysMemPitch = mips.getLevels()[level].width * 4;
+                info.residentBytes += static_cast<size_t>(initData[i].SysMemPitch) * mips.getLevels()[level].height;
+            }
+        }
 
         // Crear la textura con datos
-        hr = device.m_device->CreateTexture2D(&textureDesc, &initData, &m_texture);
-        stbi_image_free(data);
+        hr = device->CreateTexture2D(&textureDesc, initData.data(), &m_texture);
 
         if (FAILED(hr)) {
-            ERROR("Texture", "init", "Failed to create texture from PNG data");
+            ERROR("Texture", "init", ("Failed to create texture from " + m_textureName).c_str());
             return hr;
         }
+        GpuMemory::track(m_texture);
 
         // Crear SRV para la textura
         D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
         srvDesc.Format = textureDesc.Format;
         srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
-        srvDesc.Texture2D.MipLevels = 1;
+        srvDesc.Texture2D.MipLevels = textureDesc.MipLevels;
         srvDesc.Texture2D.MostDetailedMip = 0;
 
-        hr = device.m_device->CreateShaderResourceView(m_texture, &srvDesc, &m_textureFromImg);
+        hr = device->CreateShaderResourceView(m_texture, &srvDesc, &m_textureFromImg);
 
         // La SRV ya mantiene la referencia al recurso subyacente -> podemos soltar la ID3D11Texture2D local
         SafeRelease(reinterpret_cast<IUnknown*&>(m_texture));
@@ -115,6 +186,7 @@ Texture::init(Device device, const std::string& textureName, ExtensionType exten
             ERROR("Texture", "init", "Failed to create shader resource view for PNG texture");
             return hr;
         }
+        setResidency(info);
         break;
     }
 
@@ -166,6 +238,7 @@ Texture::init(Device device,
             ("Failed to create texture with specified params. HRESULT: " + std::to_string(hr)).c_str());
         return hr;
     }
+    GpuMemory::track(m_texture);
 
     // Nota: si necesitas SRV/RTV/DSV, créalas externamente con tus clases de View (RenderTargetView/DepthStencilView)
     return S_OK;
@@ -203,6 +276,72 @@ Texture::init(Device& device, Texture& textureRef, DXGI_FORMAT format) {
     return S_OK;
 }
 
+HRESULT
+Texture::init(Device& device, unsigned int width, unsigned int height, const void* rgba) {
+    if (!device.m_device) {
+        ERROR("Texture", "init", "Device is null.");
+        return E_POINTER;
+    }
+    if (!rgba || width == 0 || height == 0) {
+        ERROR("Texture", "init", "Invalid pixel data.");
+        return E_INVALIDARG;
+    }
+
+    D3D11_TEXTURE2D_DESC textureDesc = {};
+    textureDesc.Width = width;
+    textureDesc.Height = height;
+    textureDesc.MipLevels = 1;
+    textureDesc.ArraySize = 1;
+    textureDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    textureDesc.SampleDesc.Count = 1;
+    textureDesc.Usage = D3D11_USAGE_IMMUTABLE;
+    textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+    D3D11_SUBRESOURCE_DATA initData = {};
+    initData.pSysMem = rgba;
+    initData.SysMemPitch = width * 4;
+
+    HRESULT hr = device.m_device->CreateTexture2D(&textureDesc, &initData, &m_texture);
+    if (FAILED(hr)) {
+        ERROR("Texture", "init", "Failed to create texture from pixel data");
+        return hr;
+    }
+    GpuMemory::track(m_texture);
+
+    hr = device.m_device->CreateShaderResourceView(m_texture, nullptr, &m_textureFromImg);
+
+    // Igual que en PNG: la SRV mantiene viva la textura.
+    SafeRelease(reinterpret_cast<IUnknown*&>(m_texture));
+
+    if (FAILED(hr)) {
+        ERROR("Texture", "init", "Failed to create shader resource view for pixel data");
+        return hr;
+    }
+    m_width = width;
+    m_height = height;
+    m_mipCount = 1;
+    m_residentMip = 0;
+    m_residentBytes = static_cast<size_t>(width) * height * 4;
+    return S_OK;
+}
+
+void
+Texture::setResidency(const DdsFile::Info& info) {
+    m_width = info.width;
+    m_height = info.height;
+    m_mipCount = info.mipCount;
+    m_residentMip = info.residentMip;
+    m_residentBytes = info.residentBytes;
+}
+
+Texture
+Texture::share() const {
+    Texture copy = *this;
+    if (copy.m_texture) copy.m_texture->AddRef();
+    if (copy.m_textureFromImg) copy.m_textureFromImg->AddRef();
+    return copy;
+}
+
 void
 Texture::update() {
     // no-op (placeholder para streams o actualizaciones futuras)
@@ -222,13 +361,16 @@ Texture::render(DeviceContext& deviceContext,
         // Enlazamos una sola SRV. Si en el futuro manejas varias,
         // prepara un array y pásalo con NumViews.
         ID3D11ShaderResourceView* srv = m_textureFromImg;
-        deviceContext.m_deviceContext->PSSetShaderResources(StartSlot, 1, &srv);
+        deviceContext.PSSetShaderResources(StartSlot, 1, &srv);
     }
 }
 
 void
 Texture::destroy() {
-    // Libera ambos independientemente (no usar else-if)
-    SafeRelease(reinterpret_cast<IUnknown*&>(m_textureFromImg));
-    SafeRelease(reinterpret_cast<IUnknown*&>(m_texture));
+    // Ambos independientemente (no usar else-if); el `Release` espera a que la GPU
+    // termine los frames que aún pueden leerlos.
+    GpuReleaseQueue::getDefault().release(m_textureFromImg);
+    GpuReleaseQueue::getDefault().release(m_texture);
+    m_textureFromImg = nullptr;
+    m_texture = nullptr;
 }
@@ -0,0 +1,150 @@
+﻿/**
+ * @file TextureArrayPool.cpp
+ * @brief Copia de texturas a capas de `Texture2DArray` y reciclado de capas.
+ */
+
+#include "TextureArrayPool.h"
+#include "Device.h"
+#include "DeviceContext.h"
+#include "GpuMemory.h"
+#include "Texture.h"
+
+HRESULT TextureArrayPool::init(Device& device) {
+    if (!device.m_device) {
+        ERROR("TextureArrayPool", "init", "Device is null.");
+        return E_POINTER;
+    }
+    destroy();
+    m_device = device.m_device;
+    m_device->AddRef();
+    return S_OK;
+}
+
+void TextureArrayPool::update() {
+    ++m_frame;
+    for (auto it = m_members.begin(); it != m_members.end();) {
+        if (m_frame - it->second.lastUsed < kUnusedFrames) {
+            ++it;
+            continue;
+        }
+        if (it->second.array != kNoArray) {
+            m_arrays[it->second.array].freeSlices.push_back(it->second.slice);
+        }
+        it->first->Release();
+        it = m_members.erase(it);
+    }
+}
+
+TextureArrayPool::Slot TextureArrayPool::resolve(DeviceContext& deviceContext, const Texture* texture) {
+    Slot slot;
+    ID3D11ShaderResourceView* source = texture ? texture->srv() : nullptr;
+    if (!m_device || !source) {
+        return slot;
+    }
+
+    auto found = m_members.find(source);
+    if (found == m_members.end()) {
+        Member member;
+        member.array = kNoArray;
+
+        // Solo texturas 2D simples: la vista tiene que cubrir el recurso entero.
+        D3D11_SHADER_RESOURCE_VIEW_DESC viewDesc;
+        source->GetDesc(&viewDesc);
+        ID3D11Resource* resource = nullptr;
+        ID3D11Texture2D* sourceTexture = nullptr;
+        source->GetResource(&resource);
+        if (resource) {
+            resource->QueryInterface(__uuidof(ID3D11Texture2D), reinterpret_cast<void**>(&sourceTexture));
+        }
+        SAFE_RELEASE(resource);
+        if (sourceTexture && viewDesc.ViewDimension == D3D11_SRV_DIMENSION_TEXTURE2D &&
+            viewDesc.Texture2D.MostDetailedMip == 0) {
+            D3D11_TEXTURE2D_DESC desc;
+            sourceTexture->GetDesc(&desc);
+            if (desc.ArraySize == 1 && desc.SampleDesc.Count == 1 && desc.MiscFlags == 0 &&
+                viewDesc.Texture2D.MipLevels >= desc.MipLevels) {
+                member.array = acquireSlice(desc, member.slice);
+            }
+            if (member.array != kNoArray) {
+                const Array& array = m_arrays[member.array];
+                for (UINT mip = 0; mip < desc.MipLevels; ++mip) {
+                    deviceContext.CopySubresourceRegion(array.texture,
+                        D3D11CalcSubresource(mip, member.slice, desc.MipLevels), 0, 0, 0,
+                        sourceTexture, D3D11CalcSubresource(mip, 0, desc.MipLevels), nullptr);
+                }
+            }
+        }
+        SAFE_RELEASE(sourceTexture);
+
+        // La SRV se retiene: mientras tenga capa no puede reaparecer otra con su dirección.
+        source->AddRef();
+        found = m_members.insert(std::make_pair(source, member)).first;
+    }
+
+    found->second.lastUsed = m_frame;
+    if (found->second.array != kNoArray) {
+        slot.srv = m_arrays[found->second.array].srv;
+        slot.slice = found->second.slice;
+    }
+    return slot;
+}
+
+unsigned int TextureArrayPool::acquireSlice(const D3D11_TEXTURE2D_DESC& desc, unsigned int& slice) {
+    for (unsigned int i = 0; i < m_arrays.size(); ++i) {
+        Array& array = m_arrays[i];
+        if (!array.freeSlices.empty() && array.desc.Width == desc.Width && array.desc.Height == desc.Height &&
+            array.desc.Format == desc.Format && array.desc.MipLevels == desc.MipLevels) {
+            slice = array.freeSlices.back();
+            array.freeSlices.pop_back();
+            return i;
+        }
+    }
+
+    Array array;
+    array.desc = desc;
+    array.desc.ArraySize = kSlicesPerArray;
+    array.desc.Usage = D3D11_USAGE_DEFAULT;
+    array.desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+    array.desc.CPUAccessFlags = 0;
+    array.desc.MiscFlags = 0;
+    HRESULT hr = m_device->CreateTexture2D(&array.desc, nullptr, &array.texture);
+    if (SUCCEEDED(hr)) {
+        GpuMemory::track(array.texture);
+        hr = m_device->CreateShaderResourceView(array.texture, nullptr, &array.srv);
+    }
+    if (FAILED(hr)) {
+        ERROR("TextureArrayPool", "acquireSlice", "Failed to create texture array; texture stays unbatched.");
+        SAFE_RELEASE(array.texture);
+        return kNoArray;
+    }
+    for (unsigned int s = kSlicesPerArray; s-- > 1;) {
+        array.freeSlices.push_back(s);
+    }
+    slice = 0;
+    m_arrays.push_back(array);
+    return static_cast<unsigned int>(m_arrays.size() - 1);
+}
+
+unsigned int TextureArrayPool::getSliceCount() const {
+    unsigned int count = 0;
+    for (const auto& member : m_members) {
+        if (member.second.array != kNoArray) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+void TextureArrayPool::destroy() {
+    for (auto& member : m_members) {
+        member.first->Release();
+    }
+    m_members.clear();
+    for (Array& array : m_arrays) {
+        SAFE_RELEASE(array.srv);
+        SAFE_RELEASE(array.texture);
+    }
+    m_arrays.clear();
+    m_frame = 0;
+    SAFE_RELEASE(m_device);
+}
@@ -0,0 +1,212 @@
+﻿/**
+ * @file TraceCapture.cpp
+ * @brief Implementación de la captura a formato Chrome `trace_event`.
+ */
+
+#include "TraceCapture.h"
+#include "GpuProfiler.h"
+#include "DeviceContext.h"
+
+namespace {
+    /// Escribe `text` como cadena JSON (los nombres son literales; basta con escapar " y \).
+    void writeJsonString(FILE* file, const char* text) {
+        fputc('"', file);
+        for (const char* c = text; *c; ++c) {
+            if (*c == '"' || *c == '\\') fputc('\\', file);
+            fputc(*c, file);
+        }
+        fputc('"', file);
+    }
+}
+
+HRESULT TraceCapture::start(const std::string& path, unsigned int frames,
+    GpuProfiler& gpuProfiler, DeviceContext& deviceContext) {
+    if (isRecording()) {
+        return E_PENDING;
+    }
+    destroy(); // Si hubo una captura anterior, recoger su hilo escritor.
+    if (frames == 0) {
+        return E_INVALIDARG;
+    }
+
+    if (fopen_s(&m_file, path.c_str(), "wb") != 0 || !m_file) {
+        ERROR("TraceCapture", "start", ("Cannot open " + path).c_str());
+        m_file = nullptr;
+        return E_FAIL;
+    }
+    m_path = path;
+
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    m_usPerCpuTick = 1.0e6 / static_cast<double>(frequency.QuadPart);
+    m_cpuOrigin = counter.QuadPart;
+
+    m_gpuAligned = gpuProfiler.calibrate(deviceContext, m_calibrationCpu, m_calibrationGpu, m_gpuFrequency);
+    if (!m_gpuAligned) {
+        MESSAGE("TraceCapture", "start", "GPU clock calibration failed, GPU ranges omitted.");
+    }
+    m_gpuSerial = gpuProfiler.getResultSerial();
+
+    m_framesLeft = frames;
+    m_drainLeft = kGpuDrainFrames;
+    m_seenThreads.clear();
+    m_threadNames.clear();
+    m_closing = false;
+    m_queue.clear();
+    m_writer = std::thread(&TraceCapture::writerLoop, this);
+
+    std::vector<TraceEvent> header;
+    TraceEvent gpuName = { 'M', "GPU", 0.0, 0.0, kGpuThreadId, 0.0 };
+    header.push_back(gpuName);
+    push(header);
+
+    MESSAGE("TraceCapture", "start", ("Recording " + std::to_string(frames) + " frames to " + path).c_str());
+    return S_OK;
+}
+
+double TraceCapture::cpuToUs(LONGLONG ticks) const {
+    return static_cast<double>(ticks - m_cpuOrigin) * m_usPerCpuTick;
+}
+
+void TraceCapture::recordFrame(const CpuProfiler& cpuProfiler, const GpuProfiler& gpuProfiler,
+    const DeviceContext& deviceContext) {
+    if (!isRecording()) {
+        return;
+    }
+    m_batch.clear();
+
+    if (m_framesLeft > 0) {
+        // Zonas de CPU del frame que acaba de terminar.
+        const CpuProfiler::Frame frame = cpuProfiler.getFrame(0);
+        const unsigned int threads = cpuProfiler.collect(frame.begin, frame.end, m_cpuEvents);
+        if (m_seenThreads.size() < threads) {
+            m_seenThreads.resize(threads, 0);
+        }
+        for (const auto& e : m_cpuEvents) {
+            if (!m_seenThreads[e.thread]) {
+                // El escritor no debe tocar el perfilador: se copia el nombre aquí.
+                m_seenThreads[e.thread] = 1;
+                m_threadNames.push_back(cpuProfiler.getThreadName(e.thread));
+                TraceEvent threadName = { 'M', m_threadNames.back().c_str(), 0.0, 0.0, e.thread, 0.0 };
+                m_batch.push_back(threadName);
+            }
+            TraceEvent zone = { 'X', e.event.name, cpuToUs(e.event.begin),
+                static_cast<double>(e.event.end - e.event.begin) * m_usPerCpuTick, e.thread, 0.0 };
+            m_batch.push_back(zone);
+        }
+
+        // Contadores: el contexto los reinicia al empezar `render`, así que aún son los del frame.
+        const double at = cpuToUs(frame.end);
+        TraceEvent draws = { 'C', "Draw calls", at, 0.0, 0,
+            static_cast<double>(deviceContext.getDrawCallCount()) };
+        TraceEvent bytes = { 'C', "Bytes uploaded", at, 0.0, 0,
+            static_cast<double>(deviceContext.getUploadBytes()) };
+        m_batch.push_back(draws);
+        m_batch.push_back(bytes);
+        --m_framesLeft;
+    }
+    else {
+        --m_drainLeft;
+    }
+
+    // Secciones de GPU recién leídas, pasadas al reloj de CPU.
+    if (m_gpuAligned && gpuProfiler.getResultSerial() != m_gpuSerial) {
+        m_gpuSerial = gpuProfiler.getResultSerial();
+        const double usPerGpuTick = 1.0e6 / static_cast<double>(m_gpuFrequency);
+        const double calibrationUs = cpuToUs(m_calibrationCpu);
+        auto gpuToUs = [&](UINT64 ticks) {
+            return calibrationUs + (static_cast<double>(ticks) - static_cast<double>(m_calibrationGpu)) * usPerGpuTick;
+        };
+        const double frameBegin = gpuToUs(gpuProfiler.getFrameBegin());
+        if (frameBegin >= 0.0) {
+            TraceEvent gpuFrame = { 'X', "GPU frame", frameBegin,
+                (gpuProfiler.getFrameEnd() - gpuProfiler.getFrameBegin()) * usPerGpuTick, kGpuThreadId, 0.0 };
+            m_batch.push_back(gpuFrame);
+            for (const GpuProfiler::Result& r : gpuProfiler.getResults()) {
+                TraceEvent pass = { 'X', r.name, gpuToUs(r.begin),
+                    (r.end > r.begin ? r.end - r.begin : 0) * usPerGpuTick, kGpuThreadId, 0.0 };
+                m_batch.push_back(pass);
+            }
+        }
+    }
+
+    push(m_batch);
+
+    if (!isRecording()) {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_closing = true;
+        m_queueReady.notify_one();
+        MESSAGE("TraceCapture", "recordFrame", ("Trace written to " + m_path).c_str());
+    }
+}
+
+void TraceCapture::push(std::vector<TraceEvent>& batch) {
+    if (batch.empty()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(m_queueMutex);
+    m_queue.push_back(batch);
+    m_queueReady.notify_one();
+}
+
+void TraceCapture::writerLoop() {
+    fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", m_file);
+    bool first = true;
+    std::vector<std::vector<TraceEvent>> pending;
+    for (;;) {
+        bool closing = false;
+        {
+            std::unique_lock<std::mutex> lock(m_queueMutex);
+            m_queueReady.wait(lock, [this] { return !m_queue.empty() || m_closing; });
+            pending.swap(m_queue);
+            closing = m_closing;
+        }
+
+        for (const auto& batch : pending) {
+            for (const TraceEvent& e : batch) {
+                fputs(first ? "" : ",\n", m_file);
+                first = false;
+                fputs("{\"name\":", m_file);
+                writeJsonString(m_file, e.phase == 'M' ? "thread_name" : e.name);
+                fprintf(m_file, ",\"ph\":\"%c\",\"pid\":1,\"tid\":%u", e.phase, e.thread);
+                if (e.phase == 'M') {
+                    fputs(",\"args\":{\"name\":", m_file);
+                    writeJsonString(m_file, e.name);
+                    fputs("}}", m_file);
+                }
+                else if (e.phase == 'C') {
+                    fprintf(m_file, ",\"ts\":%.3f,\"args\":{\"value\":%.0f}}", e.timestamp, e.value);
+                }
+                else {
+                    fprintf(m_file, ",\"ts\":%.3f,\"dur\":%.3f}", e.timestamp, e.duration);
+                }
+            }
+        }
+        pending.clear();
+
+        if (closing) {
+            std::lock_guard<std::mutex> lock(m_queueMutex);
+            if (m_queue.empty()) {
+                break;
+            }
+        }
+    }
+    fputs("\n]}\n", m_file);
+    fclose(m_file);
+    m_file = nullptr;
+}
+
+void TraceCapture::destroy() {
+    if (!m_writer.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_closing = true;
+        m_queueReady.notify_one();
+    }
+    m_writer.join();
+    m_framesLeft = 0;
+    m_drainLeft = 0;
+}
@@ -0,0 +1,200 @@
+﻿/**
+ * @file TriangleBvh.cpp
+ * @brief Construcción y trazado de la BVH de triángulos de los horneados.
+ */
+
+#include "TriangleBvh.h"
+#include "MeshAsset.h"
+#include "ECS/Actor.h"
+#include "ECS/Transform.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace {
+    XMFLOAT3 add(const XMFLOAT3& a, const XMFLOAT3& b) { return XMFLOAT3(a.x + b.x, a.y + b.y, a.z + b.z); }
+    XMFLOAT3 sub(const XMFLOAT3& a, const XMFLOAT3& b) { return XMFLOAT3(a.x - b.x, a.y - b.y, a.z - b.z); }
+    XMFLOAT3 scale(const XMFLOAT3& a, float s) { return XMFLOAT3(a.x * s, a.y * s, a.z * s); }
+    float dot(const XMFLOAT3& a, const XMFLOAT3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+    XMFLOAT3 cross(const XMFLOAT3& a, const XMFLOAT3& b) {
+        return XMFLOAT3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+    }
+    XMFLOAT3 normalize(const XMFLOAT3& a) {
+        const float length = sqrtf(dot(a, a));
+        return length > 0.0f ? scale(a, 1.0f / length) : XMFLOAT3(0.0f, 1.0f, 0.0f);
+    }
+}
+
+void TriangleBvh::build(std::vector<Triangle> triangles) {
+    m_triangles = std::move(triangles);
+    m_nodes.clear();
+    if (m_triangles.empty()) {
+        return;
+    }
+    std::vector<XMFLOAT3> centers(m_triangles.size());
+    for (size_t i = 0; i < m_triangles.size(); ++i) {
+        const Triangle& t = m_triangles[i];
+        centers[i] = add(t.v0, scale(add(t.e1, t.e2), 1.0f / 3.0f));
+    }
+    std::vector<unsigned int> order(m_triangles.size());
+    for (unsigned int i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    m_nodes.reserve(m_triangles.size() * 2 / kLeafSize + 1);
+    m_nodes.emplace_back();
+    buildNode(0, order, centers, 0, static_cast<unsigned int>(order.size()));
+
+    std::vector<Triangle> sorted(m_triangles.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        sorted[i] = m_triangles[order[i]];
+    }
+    m_triangles = std::move(sorted);
+}
+
+bool TriangleBvh::trace(const XMFLOAT3& origin, const XMFLOAT3& direction, float maxT, bool anyHit,
+    float& hitT, unsigned int& hitTriangle) const {
+    if (m_nodes.empty()) {
+        return false;
+    }
+    const XMFLOAT3 inverse(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+    unsigned int stack[64];
+    unsigned int top = 0;
+    stack[top++] = 0;
+    bool hit = false;
+    hitT = maxT;
+    while (top > 0) {
+        const Node& node = m_nodes[stack[--top]];
+        if (!intersectsBox(node, origin, inverse, hitT)) {
+            continue;
+        }
+        if (node.count > 0) {
+            for (unsigned int i = node.first; i < node.first + node.count; ++i) {
+                float t;
+                if (intersectTriangle(m_triangles[i], origin, direction, t) && t < hitT) {
+                    hitT = t;
+                    hitTriangle = i;
+                    hit = true;
+                    if (anyHit) {
+                        return true;
+                    }
+                }
+            }
+        }
+        else if (top + 2 <= 64) {
+            stack[top++] = node.first;
+            stack[top++] = node.first + 1;
+        }
+    }
+    return hit;
+}
+
+void TriangleBvh::gatherStatic(const std::vector<ActorHandle>& actors, std::vector<Triangle>& triangles,
+    XMFLOAT3& boundsMin, XMFLOAT3& boundsMax) {
+    for (ActorHandle handle : actors) {
+        Actor* actor = handle.get();
+        if (!actor || !actor->isStatic() || actor->isTransparent() || actor->getMeshAsset().isNull() ||
+            !actor->getMeshAsset()->hasCpuData() || !actor->hasComponent<Transform>()) {
+            continue;
+        }
+        Transform* transform = actor->getComponent<Transform>();
+        transform->update(0.0f);
+        const XMMATRIX world = transform->getMatrix();
+        for (const MeshComponent& mesh : actor->getMeshAsset()->m_meshes) {
+            for (size_t i = 0; i + 2 < mesh.m_index.size(); i += 3) {
+                XMFLOAT3 p[3];
+                for (unsigned int k = 0; k < 3; ++k) {
+                    XMStoreFloat3(&p[k], XMVector3TransformCoord(XMLoadFloat3(&mesh.m_vertex[mesh.m_index[i + k]].Pos), world));
+                    boundsMin = XMFLOAT3((std::min)(boundsMin.x, p[k].x), (std::min)(boundsMin.y, p[k].y), (std::min)(boundsMin.z, p[k].z));
+                    boundsMax = XMFLOAT3((std::max)(boundsMax.x, p[k].x), (std::max)(boundsMax.y, p[k].y), (std::max)(boundsMax.z, p[k].z));
+                }
+                Triangle triangle;
+                triangle.v0 = p[0];
+                triangle.e1 = sub(p[1], p[0]);
+                triangle.e2 = sub(p[2], p[0]);
+                triangle.normal = normalize(cross(triangle.e1, triangle.e2));
+                triangles.push_back(triangle);
+            }
+        }
+    }
+}
+
+void TriangleBvh::buildNode(unsigned int index, std::vector<unsigned int>& order, const std::vector<XMFLOAT3>& centers,
+    unsigned int begin, unsigned int end) {
+    XMFLOAT3 boundsMin(FLT_MAX, FLT_MAX, FLT_MAX), boundsMax(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+    XMFLOAT3 centerMin = boundsMin, centerMax = boundsMax;
+    for (unsigned int i = begin; i < end; ++i) {
+        const Triangle& t = m_triangles[order[i]];
+        const XMFLOAT3 corners[3] = { t.v0, add(t.v0, t.e1), add(t.v0, t.e2) };
+        for (const XMFLOAT3& p : corners) {
+            boundsMin = XMFLOAT3((std::min)(boundsMin.x, p.x), (std::min)(boundsMin.y, p.y), (std::min)(boundsMin.z, p.z));
+            boundsMax = XMFLOAT3((std::max)(boundsMax.x, p.x), (std::max)(boundsMax.y, p.y), (std::max)(boundsMax.z, p.z));
+        }
+        const XMFLOAT3& c = centers[order[i]];
+        centerMin = XMFLOAT3((std::min)(centerMin.x, c.x), (std::min)(centerMin.y, c.y), (std::min)(centerMin.z, c.z));
+        centerMax = XMFLOAT3((std::max)(centerMax.x, c.x), (std::max)(centerMax.y, c.y), (std::max)(centerMax.z, c.z));
+    }
+    m_nodes[index].min = boundsMin;
+    m_nodes[index].max = boundsMax;
+
+    if (end - begin <= kLeafSize) {
+        m_nodes[index].first = begin;
+        m_nodes[index].count = end - begin;
+        return;
+    }
+    const float extent[3] = { centerMax.x - centerMin.x, centerMax.y - centerMin.y, centerMax.z - centerMin.z };
+    const unsigned int axis = extent[0] > extent[1] ? (extent[0] > extent[2] ? 0 : 2) : (extent[1] > extent[2] ? 1 : 2);
+    const unsigned int middle = begin + (end - begin) / 2;
+    std::nth_element(order.begin() + begin, order.begin() + middle, order.begin() + end,
+        [&centers, axis](unsigned int a, unsigned int b) {
+            return (&centers[a].x)[axis] < (&centers[b].x)[axis];
+        });
+
+    // Los dos hijos van seguidos: se reservan antes de bajar por ninguno.
+    const unsigned int children = static_cast<unsigned int>(m_nodes.size());
+    m_nodes.emplace_back();
+    m_nodes.emplace_back();
+    m_nodes[index].first = children;
+    m_nodes[index].count = 0;
+    buildNode(children, order, centers, begin, middle);
+    buildNode(children + 1, order, centers, middle, end);
+}
+
+bool TriangleBvh::intersectsBox(const Node& node, const XMFLOAT3& origin, const XMFLOAT3& inverse, float maxT) {
+    float t0 = 0.0f, t1 = maxT;
+    const float* o = &origin.x;
+    const float* inv = &inverse.x;
+    const float* lo = &node.min.x;
+    const float* hi = &node.max.x;
+    for (unsigned int a = 0; a < 3; ++a) {
+        float tNear = (lo[a] - o[a]) * inv[a];
+        float tFar = (hi[a] - o[a]) * inv[a];
+        if (tNear > tFar) std::swap(tNear, tFar);
+        t0 = tNear > t0 ? tNear : t0;
+        t1 = tFar < t1 ? tFar : t1;
+        if (t0 > t1) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool TriangleBvh::intersectTriangle(const Triangle& t, const XMFLOAT3& origin, const XMFLOAT3& direction, float& hitT) {
+    const XMFLOAT3 p = cross(direction, t.e2);
+    const float determinant = dot(t.e1, p);
+    if (fabsf(determinant) < 1e-12f) {
+        return false;
+    }
+    const float inverse = 1.0f / determinant;
+    const XMFLOAT3 s = sub(origin, t.v0);
+    const float u = dot(s, p) * inverse;
+    if (u < 0.0f || u > 1.0f) {
+        return false;
+    }
+    const XMFLOAT3 q = cross(s, t.e1);
+    const float v = dot(direction, q) * inverse;
+    if (v < 0.0f || u + v > 1.0f) {
+        return false;
+    }
+    hitT = dot(t.e2, q) * inverse;
+    return hitT > 0.0f;
+}
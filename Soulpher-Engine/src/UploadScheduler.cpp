@@ -0,0 +1,311 @@
+﻿/**
+ * @file UploadScheduler.cpp
+ * @brief Implementación del planificador de subidas con anillo de staging.
+ */
+
+#include "UploadScheduler.h"
+#include "Device.h"
+#include "DeviceContext.h"
+#include "GpuMemory.h"
+#include <cstring>
+
+namespace {
+    bool isBlockCompressed(DXGI_FORMAT format) {
+        return (format >= DXGI_FORMAT_BC1_TYPELESS && format <= DXGI_FORMAT_BC5_SNORM) ||
+            (format >= DXGI_FORMAT_BC6H_TYPELESS && format <= DXGI_FORMAT_BC7_UNORM_SRGB);
+    }
+}
+
+HRESULT UploadScheduler::init(Device& device, unsigned int frameBudget) {
+    if (!device.m_device) {
+        ERROR("UploadScheduler", "init", "Device is null.");
+        return E_POINTER;
+    }
+    if (frameBudget == 0) {
+        ERROR("UploadScheduler", "init", "frameBudget must be non-zero");
+        return E_INVALIDARG;
+    }
+    destroy();
+    m_device = device.m_device;
+    m_device->AddRef();
+    m_frameBudget = frameBudget;
+    return createRing();
+}
+
+HRESULT UploadScheduler::createRing() {
+    for (ID3D11Buffer*& segment : m_ring) {
+        SAFE_RELEASE(segment);
+    }
+    m_ringBytes = 0;
+
+    D3D11_BUFFER_DESC desc = {};
+    desc.ByteWidth = m_frameBudget;
+    desc.Usage = D3D11_USAGE_STAGING;
+    desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+    for (ID3D11Buffer*& segment : m_ring) {
+        HRESULT hr = m_device->CreateBuffer(&desc, nullptr, &segment);
+        if (FAILED(hr)) {
+            ERROR("UploadScheduler", "createRing", "Failed to create the staging ring");
+            for (ID3D11Buffer*& created : m_ring) {
+                SAFE_RELEASE(created);
+            }
+            return hr;
+        }
+        GpuMemory::track(segment);
+    }
+    m_ringBytes = m_frameBudget;
+    return S_OK;
+}
+
+unsigned long long UploadScheduler::uploadBuffer(ID3D11Buffer* destination, unsigned int offset,
+    const void* data, unsigned int bytes) {
+    if (!destination || !data || bytes == 0) {
+        ERROR("UploadScheduler", "uploadBuffer", "Invalid destination or empty data");
+        return 0;
+    }
+    Request request;
+    request.destination = destination;
+    request.offset = offset;
+    request.data.assign(static_cast<const unsigned char*>(data), static_cast<const unsigned char*>(data) + bytes);
+    destination->AddRef();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    request.ticket = m_nextTicket++;
+    m_pendingBytes += bytes;
+    m_incoming.push_back(std::move(request));
+    return m_incoming.back().ticket;
+}
+
+unsigned long long UploadScheduler::uploadTexture(ID3D11Texture2D* destination, unsigned int subresource,
+    const void* data, unsigned int rowPitch, unsigned int rows) {
+    if (!destination || !data || rowPitch == 0 || rows == 0) {
+        ERROR("UploadScheduler", "uploadTexture", "Invalid destination or empty data");
+        return 0;
+    }
+    const size_t bytes = static_cast<size_t>(rowPitch) * rows;
+    Request request;
+    request.destination = destination;
+    request.texture = true;
+    request.subresource = subresource;
+    request.rowPitch = rowPitch;
+    request.rows = rows;
+    request.data.assign(static_cast<const unsigned char*>(data), static_cast<const unsigned char*>(data) + bytes);
+    destination->AddRef();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    request.ticket = m_nextTicket++;
+    m_pendingBytes += bytes;
+    m_incoming.push_back(std::move(request));
+    return m_incoming.back().ticket;
+}
+
+/**
+ * @details
+ * Primero se escriben todos los staging del frame (mapeados) y se apuntan las
+ * copias; después del `Unmap` se emiten: D3D11 no deja copiar desde un recurso
+ * que sigue mapeado.
+ */
+unsigned int UploadScheduler::update(DeviceContext& deviceContext) {
+    if (!m_device) {
+        return 0;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (Request& request : m_incoming) {
+            m_active.push_back(std::move(request));
+        }
+        m_incoming.clear();
+    }
+    if (m_ringBytes != m_frameBudget && FAILED(createRing())) {
+        return 0;
+    }
+
+    ID3D11Buffer* segment = m_ring[m_frame % kRingFrames];
+    D3D11_MAPPED_SUBRESOURCE segmentMap = {};
+    bool segmentMapped = false;
+    unsigned int segmentCursor = 0;
+    unsigned int copied = 0;
+    unsigned long long lastCompleted = 0;
+    std::vector<ID3D11Resource*> finished;
+    m_copies.clear();
+
+    while (!m_active.empty() && copied < m_frameBudget) {
+        Request& request = m_active.front();
+
+        if (!request.texture) {
+            if (!segmentMapped) {
+                if (FAILED(deviceContext.Map(segment, 0, D3D11_MAP_WRITE, D3D11_MAP_FLAG_DO_NOT_WAIT, &segmentMap))) {
+                    break; // La GPU aún lee este segmento: se sigue el frame que viene.
+                }
+                segmentMapped = true;
+            }
+            const size_t remaining = request.data.size() - request.consumed;
+            const unsigned int chunk = static_cast<unsigned int>((std::min)(remaining,
+                static_cast<size_t>((std::min)(m_ringBytes - segmentCursor, m_frameBudget - copied))));
+            if (chunk == 0) {
+                break;
+            }
+            std::memcpy(static_cast<unsigned char*>(segmentMap.pData) + segmentCursor,
+                request.data.data() + request.consumed, chunk);
+            Copy copy = { request.destination, 0, request.offset + static_cast<unsigned int>(request.consumed),
+                segment, { segmentCursor, 0, 0, segmentCursor + chunk, 1, 1 } };
+            m_copies.push_back(copy);
+            segmentCursor += chunk;
+            request.consumed += chunk;
+            copied += chunk;
+            if (request.consumed < request.data.size()) {
+                break; // Presupuesto agotado: el resto, en el frame siguiente.
+            }
+        }
+        else {
+            const unsigned int bytes = static_cast<unsigned int>(request.data.size());
+            if (copied > 0 && bytes > m_frameBudget - copied) {
+                break;
+            }
+
+            ID3D11Texture2D* destination = static_cast<ID3D11Texture2D*>(request.destination);
+            D3D11_TEXTURE2D_DESC desc;
+            destination->GetDesc(&desc);
+            const unsigned int mip = request.subresource % desc.MipLevels;
+            const unsigned int width = (std::max)(1u, desc.Width >> mip);
+            const unsigned int height = (std::max)(1u, desc.Height >> mip);
+
+            if (isBlockCompressed(desc.Format) && ((width % 4) != 0 || (height % 4) != 0)) {
+                deviceContext.UpdateSubresource(destination, request.subresource, nullptr,
+                    request.data.data(), request.rowPitch, 0);
+            }
+            else {
+                Staging* staging = acquireStaging(desc, width, height);
+                D3D11_MAPPED_SUBRESOURCE mapped = {};
+                if (!staging ||
+                    FAILED(deviceContext.Map(staging->texture, 0, D3D11_MAP_WRITE, D3D11_MAP_FLAG_DO_NOT_WAIT, &mapped))) {
+                    break;
+                }
+                const unsigned int rowBytes = (std::min)(request.rowPitch, static_cast<unsigned int>(mapped.RowPitch));
+                for (unsigned int row = 0; row < request.rows; ++row) {
+                    std::memcpy(static_cast<unsigned char*>(mapped.pData) + static_cast<size_t>(row) * mapped.RowPitch,
+                        request.data.data() + static_cast<size_t>(row) * request.rowPitch, rowBytes);
+                }
+                deviceContext.Unmap(staging->texture, 0);
+                staging->lastUsed = m_frame;
+                Copy copy = { destination, request.subresource, 0, staging->texture, { 0, 0, 0, width, height, 1 } };
+                m_copies.push_back(copy);
+            }
+            copied += bytes;
+        }
+
+        lastCompleted = request.ticket;
+        finished.push_back(request.destination);
+        m_active.pop_front();
+    }
+
+    if (segmentMapped) {
+        deviceContext.Unmap(segment, 0);
+    }
+    for (const Copy& copy : m_copies) {
+        deviceContext.CopySubresourceRegion(copy.destination, copy.subresource, copy.dstX, 0, 0,
+            copy.source, 0, &copy.box);
+    }
+    // Las copias ya están en el contexto (que retiene sus recursos): se sueltan los destinos.
+    for (ID3D11Resource* destination : finished) {
+        destination->Release();
+    }
+    if (copied > 0) {
+        deviceContext.addUploadBytes(copied);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (lastCompleted) {
+            m_completed = lastCompleted;
+        }
+        m_pendingBytes -= (std::min)(m_pendingBytes, static_cast<unsigned long long>(copied));
+    }
+
+    for (size_t i = 0; i < m_staging.size();) {
+        if (m_frame - m_staging[i].lastUsed > kStagingIdleFrames) {
+            SAFE_RELEASE(m_staging[i].texture);
+            m_staging[i] = m_staging.back();
+            m_staging.pop_back();
+        }
+        else {
+            ++i;
+        }
+    }
+    ++m_frame;
+    return copied;
+}
+
+UploadScheduler::Staging* UploadScheduler::acquireStaging(const D3D11_TEXTURE2D_DESC& desc,
+    unsigned int width, unsigned int height) {
+    for (Staging& staging : m_staging) {
+        if (staging.desc.Width == width && staging.desc.Height == height && staging.desc.Format == desc.Format &&
+            m_frame >= staging.lastUsed + kRingFrames) {
+            return &staging;
+        }
+    }
+
+    Staging staging;
+    staging.desc.Width = width;
+    staging.desc.Height = height;
+    staging.desc.MipLevels = 1;
+    staging.desc.ArraySize = 1;
+    staging.desc.Format = desc.Format;
+    staging.desc.SampleDesc.Count = 1;
+    staging.desc.Usage = D3D11_USAGE_STAGING;
+    staging.desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+    if (FAILED(m_device->CreateTexture2D(&staging.desc, nullptr, &staging.texture))) {
+        ERROR("UploadScheduler", "acquireStaging", "Failed to create a staging texture");
+        return nullptr;
+    }
+    GpuMemory::track(staging.texture);
+    // Recién creada: nadie la está leyendo (lastUsed se pone al escribirla).
+    staging.lastUsed = m_frame;
+    m_staging.push_back(staging);
+    return &m_staging.back();
+}
+
+bool UploadScheduler::isComplete(unsigned long long ticket) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return ticket <= m_completed;
+}
+
+void UploadScheduler::setFrameBudget(unsigned int bytes) {
+    if (bytes == 0) {
+        ERROR("UploadScheduler", "setFrameBudget", "Budget must be non-zero");
+        return;
+    }
+    m_frameBudget = bytes;
+}
+
+unsigned long long UploadScheduler::getPendingBytes() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_pendingBytes;
+}
+
+void UploadScheduler::destroy() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (Request& request : m_incoming) {
+            SAFE_RELEASE(request.destination);
+        }
+        m_incoming.clear();
+        m_pendingBytes = 0;
+        m_completed = m_nextTicket - 1; // Lo descartado no va a llegar: nadie debe esperarlo.
+    }
+    for (Request& request : m_active) {
+        SAFE_RELEASE(request.destination);
+    }
+    m_active.clear();
+    m_copies.clear();
+    for (Staging& staging : m_staging) {
+        SAFE_RELEASE(staging.texture);
+    }
+    m_staging.clear();
+    for (ID3D11Buffer*& segment : m_ring) {
+        SAFE_RELEASE(segment);
+    }
+    m_ringBytes = 0;
+    m_frame = 0;
+    SAFE_RELEASE(m_device);
+}
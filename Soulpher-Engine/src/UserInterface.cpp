@@ -11,6 +11,104 @@
 #include "Texture.h"
 #include "MeshComponent.h"
 #include "ECS\\Actor.h"
+#include "ECS\\ActorPool.h"
+#include "GpuProfiler.h"
+#include "ActorCost.h"
+#include "CpuProfiler.h"
+#include "DeviceContext.h"
+#include "StallDetector.h"
+#include "FrameTimeHistory.h"
+#include "FrameArena.h"
+#include "MemoryTracker.h"
+#include "GpuMemory.h"
+#include "ShaderHotReload.h"
+#include "ConsoleVariable.h"
+#include <cfloat>
+#include <algorithm>
+
+namespace {
+    /**
+     * @brief Flame graph de `events` en [begin, end]: un carril por hilo y una fila por
+     * nivel de anidamiento; `frameStarts` dibuja una línea al inicio de cada frame.
+     */
+    void drawFlameGraph(const std::vector<CpuProfiler::ThreadEvent>& events,
+        const std::vector<std::string>& threadNames, LONGLONG begin, LONGLONG end,
+        const std::vector<LONGLONG>& frameStarts, const CpuProfiler& profiler) {
+        const unsigned int threadCount = static_cast<unsigned int>(threadNames.size());
+        if (threadCount == 0 || end <= begin) {
+            return;
+        }
+
+        // Filas por hilo según la profundidad máxima vista.
+        EU::TArray<unsigned int, EU::ArenaAllocator> rows(FrameArena::allocator());
+        rows.Reserve(threadCount);
+        for (unsigned int t = 0; t < threadCount; ++t) {
+            rows.Add(0);
+        }
+        for (const auto& e : events) {
+            rows[e.thread] = (std::max)(rows[e.thread], e.event.depth + 1);
+        }
+
+        const float rowHeight = ImGui::GetTextLineHeight() + 4.0f;
+        const float laneGap = ImGui::GetTextLineHeight() + 6.0f;
+        float height = 0.0f;
+        for (unsigned int t = 0; t < threadCount; ++t) {
+            height += laneGap + rows[t] * rowHeight;
+        }
+
+        const ImVec2 origin = ImGui::GetCursorScreenPos();
+        const float width = (std::max)(ImGui::GetContentRegionAvail().x, 50.0f);
+        const double span = static_cast<double>(end - begin);
+        ImDrawList* drawList = ImGui::GetWindowDrawList();
+        auto toX = [&](LONGLONG ticks) {
+            return origin.x + static_cast<float>((ticks - begin) / span) * width;
+        };
+
+        // Separadores de frame.
+        for (LONGLONG start : frameStarts) {
+            const float x = toX(start);
+            drawList->AddLine(ImVec2(x, origin.y), ImVec2(x, origin.y + height), IM_COL32(255, 255, 255, 60));
+        }
+
+        // Carriles: nombre del hilo y una fila por nivel de anidamiento.
+        EU::TArray<float, EU::ArenaAllocator> laneTop(FrameArena::allocator());
+        laneTop.Reserve(threadCount);
+        float y = origin.y;
+        for (unsigned int t = 0; t < threadCount; ++t) {
+            drawList->AddText(ImVec2(origin.x, y), IM_COL32(200, 200, 200, 255), threadNames[t].c_str());
+            laneTop.Add(y + laneGap);
+            y = laneTop[t] + rows[t] * rowHeight;
+        }
+
+        const ImVec2 mouse = ImGui::GetIO().MousePos;
+        const CpuProfiler::ThreadEvent* hovered = nullptr;
+        for (const auto& e : events) {
+            const float x0 = toX(e.event.begin);
+            const float x1 = (std::max)(toX(e.event.end), x0 + 1.0f);
+            const float y0 = laneTop[e.thread] + e.event.depth * rowHeight;
+            const float y1 = y0 + rowHeight - 1.0f;
+
+            // Color estable por nombre (el puntero del literal basta como identidad).
+            const uintptr_t id = reinterpret_cast<uintptr_t>(e.event.name) * 2654435761u;
+            const ImU32 color = IM_COL32(80 + (id >> 8) % 140, 80 + (id >> 16) % 140, 80 + (id >> 24) % 140, 255);
+            drawList->AddRectFilled(ImVec2(x0, y0), ImVec2(x1, y1), color);
+
+            const ImVec2 textSize = ImGui::CalcTextSize(e.event.name);
+            if (x1 - x0 > textSize.x + 4.0f) {
+                drawList->AddText(ImVec2(x0 + 2.0f, y0 + 2.0f), IM_COL32(0, 0, 0, 255), e.event.name);
+            }
+            if (mouse.x >= x0 && mouse.x < x1 && mouse.y >= y0 && mouse.y < y1) {
+                hovered = &e;
+            }
+        }
+
+        ImGui::Dummy(ImVec2(width, height));
+        if (hovered && ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("%s\n%.3f ms", hovered->event.name,
+                profiler.toMs(hovered->event.end - hovered->event.begin));
+        }
+    }
+}
 
     UserInterface::UserInterface() {}
 UserInterface::~UserInterface() {}
@@ -40,23 +138,60 @@ void UserInterface::init(void* window, ID3D11Device* device, ID3D11DeviceContext
     m_imguiInitialized = true;
 }
 
+void UserInterface::initHeadless() {
+    IMGUI_CHECKVERSION();
+    ImGui::CreateContext();
+    m_headless = true;
+    m_playerMode = true;
+    m_playerStats = false;
+}
+
 void UserInterface::update() {
+    // Modo jugador: sin frame, salvo para la superposición mínima. Sin backends, nunca.
+    m_frameActive = !m_headless && (!m_playerMode || m_playerStats);
+    if (!m_frameActive) {
+        return;
+    }
+
     // Frame ImGui
     ImGui_ImplDX11_NewFrame();
     ImGui_ImplWin32_NewFrame();
     ImGui::NewFrame();
+    if (m_playerMode) {
+        return;
+    }
 
     // Dockspace “global” para un layout más predecible (opcional pero recomendable)
-    ImGui::DockSpaceOverViewport(NULL, ImGuiDockNodeFlags_PassthruCentralNode);
+    m_dockspaceId = ImGui::DockSpaceOverViewport(NULL, ImGuiDockNodeFlags_PassthruCentralNode);
 
     // Siempre visibles
     ToolBar();
     closeApp();
 }
 
-void UserInterface::render() {
+/**
+ * @details Las listas de ImGui se reescriben en el siguiente `NewFrame`: se clonan
+ * (`ImDrawList::CloneOutput`) para poder dibujarlas después desde otro hilo. Las
+ * ventanas secundarias crean y presentan sus propias ventanas Win32, que solo puede
+ * tocar el hilo principal: se dibujan aquí mismo.
+ */
+void UserInterface::prepareRender() {
+    releaseDrawData();
+    if (!m_frameActive) {
+        // Sin frame nadie vacía la entrada que sigue acumulando el backend de Win32
+        // (lo hace `EndFrame`): la rueda sumaría para siempre.
+        ImGuiIO& io = ImGui::GetIO();
+        io.MouseWheel = io.MouseWheelH = 0.0f;
+        io.InputQueueCharacters.resize(0);
+        return;
+    }
     ImGui::Render();
-    ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData());
+    const ImDrawData* drawData = ImGui::GetDrawData();
+    m_drawData = *drawData;
+    for (int i = 0; i < drawData->CmdListsCount; ++i) {
+        m_drawLists.push_back(drawData->CmdLists[i]->CloneOutput());
+    }
+    m_drawData.CmdLists = m_drawLists.empty() ? nullptr : m_drawLists.data();
 
     ImGuiIO& io = ImGui::GetIO();
     if (io.ConfigFlags & ImGuiConfigFlags_ViewportsEnable)
@@ -66,11 +201,65 @@ void UserInterface::render() {
     }
 }
 
+void UserInterface::render() {
+    if (m_drawData.Valid) {
+        ImGui_ImplDX11_RenderDrawData(&m_drawData);
+    }
+}
+
+void UserInterface::setPlayerMode(bool playerMode) {
+    if (playerMode == m_playerMode) {
+        return;
+    }
+    m_playerMode = playerMode;
+    m_viewportVisible = false;
+    m_viewportHovered = false;
+    // Sin frames, las ventanas secundarias se quedarían congeladas: se cierran y ImGui las
+    // vuelve a crear al salir del modo jugador.
+    if (playerMode && m_imguiInitialized && (ImGui::GetIO().ConfigFlags & ImGuiConfigFlags_ViewportsEnable)) {
+        ImGui::DestroyPlatformWindows();
+    }
+}
+
+void UserInterface::playerStats(const FrameTimeHistory& frameTimes, const GpuProfiler& gpuProfiler) {
+    if (!m_frameActive || frameTimes.getCount() == 0) {
+        return;
+    }
+    const ImGuiViewport* viewport = ImGui::GetMainViewport();
+    const float margin = 10.0f;
+    ImGui::SetNextWindowPos(ImVec2(viewport->WorkPos.x + margin, viewport->WorkPos.y + margin));
+    ImGui::SetNextWindowViewport(viewport->ID);
+    ImGui::SetNextWindowBgAlpha(0.6f);
+    const ImGuiWindowFlags flags = ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_AlwaysAutoResize |
+        ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoFocusOnAppearing |
+        ImGuiWindowFlags_NoNav | ImGuiWindowFlags_NoDocking | ImGuiWindowFlags_NoInputs;
+    ImGui::Begin("Player stats", nullptr, flags);
+    const float frameMs = frameTimes.getFrameMs(0);
+    ImGui::Text("%.0f FPS  %.2f ms", frameMs > 0.0f ? 1000.0f / frameMs : 0.0f, frameMs);
+    ImGui::Text("GPU %.2f ms", gpuProfiler.getFrameTime());
+    ImGui::End();
+}
+
+void UserInterface::releaseDrawData() {
+    for (ImDrawList* list : m_drawLists) {
+        IM_DELETE(list);
+    }
+    m_drawLists.clear();
+    m_drawData.Clear();
+}
+
 void UserInterface::destroy()
 {
+    if (m_headless && ImGui::GetCurrentContext() != nullptr) {
+        ImGui::DestroyContext();
+        m_headless = false;
+        return;
+    }
     if (!m_imguiInitialized || ImGui::GetCurrentContext() == nullptr)
         return;
 
+    releaseDrawData();
+
     ImGui_ImplDX11_Shutdown();
     ImGui_ImplWin32_Shutdown();
     ImGui::DestroyContext();
@@ -157,32 +346,76 @@ void UserInterface::menuBar(Window window, SwapChain swapChain, Texture& backBuf
         }
         if (ImGui::BeginMenu("Capture screenshot"))
         {
-            // Screenshot sc; sc.captureScreenshot(window, swapChain, backBuffer);
+            // Las capturas se piden desde "Profile > Capture screenshot" (ver ToolBar).
             ImGui::EndMenu();
         }
         ImGui::EndMainMenuBar();
     }
 }
 
-void UserInterface::Renderer(Window window, ID3D11ShaderResourceView* renderTexture) {
-    bool Stage = true;
-    // No forzamos pos cada frame para no “clavar” la ventana
-    ImGui::Begin("Renderer", &Stage);
-    ImTextureID texId = (ImTextureID)renderTexture;
-    ImGui::Image(texId, ImVec2(window.m_width / 2.0f, window.m_height / 2.0f));
+void UserInterface::Renderer(ID3D11ShaderResourceView* renderTexture) {
+    m_viewportVisible = false;
+    m_viewportHovered = false;
+    if (!m_showViewport) {
+        return;
+    }
+    // Solo la primera vez: después el usuario lo mueve o lo desacopla.
+    ImGui::SetNextWindowDockID(m_dockspaceId, ImGuiCond_FirstUseEver);
+    ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(0.0f, 0.0f));
+    // Sin scroll: la rueda es el zoom de la cámara.
+    const bool open = ImGui::Begin("Viewport", &m_showViewport, ImGuiWindowFlags_NoScrollbar |
+        ImGuiWindowFlags_NoScrollWithMouse);
+    ImGui::PopStyleVar();
+    if (open) {
+        const ImVec2 area = ImGui::GetContentRegionAvail();
+        if (area.x >= 1.0f && area.y >= 1.0f) {
+            m_viewportWidth = static_cast<unsigned int>(area.x);
+            m_viewportHeight = static_cast<unsigned int>(area.y);
+            const ImVec2 size(float(m_viewportWidth), float(m_viewportHeight));
+            const ImVec2 origin = ImGui::GetCursorScreenPos();
+            const ImVec2 mouse = ImGui::GetIO().MousePos;
+            m_viewportOriginX = origin.x;
+            m_viewportOriginY = origin.y;
+            m_viewportMouseX = static_cast<int>(mouse.x - origin.x);
+            m_viewportMouseY = static_cast<int>(mouse.y - origin.y);
+            m_viewportVisible = true;
+            if (renderTexture) {
+                ImGui::Image((ImTextureID)renderTexture, size);
+                ImGui::SetCursorScreenPos(origin);
+            }
+            // Encima de la imagen, un botón invisible se queda los clics: arrastrar no mueve
+            // la ventana y la cámara sabe que el ratón está sobre la escena.
+            ImGui::InvisibleButton("##scene", size, ImGuiButtonFlags_MouseButtonLeft |
+                ImGuiButtonFlags_MouseButtonRight | ImGuiButtonFlags_MouseButtonMiddle);
+            // Activo: un arrastre empezado en la escena sigue aunque el ratón salga del panel.
+            m_viewportHovered = ImGui::IsItemHovered() || ImGui::IsItemActive();
+        }
+    }
     ImGui::End();
 }
 
-void UserInterface::inspectorGeneral(EU::TSharedPointer<Actor> actor) {
+void UserInterface::inspectorGeneral(ActorHandle actor, ActorCost* costs) {
     ImGui::Begin("Inspector");
 
-    bool isStatic = false;
-    ImGui::Checkbox("##Static", &isStatic);
+    bool isStatic = actor->isStatic();
+    if (ImGui::Checkbox("##Static", &isStatic)) {
+        actor->setStatic(isStatic);
+    }
     ImGui::SameLine();
 
-    char objectName[128] = "Cube";
+    // El buffer se rellena al cambiar de actor, no cada frame; el nombre se aplica al soltar el campo.
+    const std::string& name = actor->getName();
+    if (m_nameActor != actor.value || (!m_nameEditing && name.compare(m_nameBuffer) != 0)) {
+        snprintf(m_nameBuffer, sizeof(m_nameBuffer), "%s", name.c_str());
+        m_nameActor = actor.value;
+    }
     ImGui::SetNextItemWidth(ImGui::GetContentRegionAvailWidth() * 0.6f);
-    ImGui::InputText("##ObjectName", &actor->getName()[0], IM_ARRAYSIZE(objectName));
+    ImGui::InputText("##ObjectName", m_nameBuffer, IM_ARRAYSIZE(m_nameBuffer));
+    m_nameEditing = ImGui::IsItemActive();
+    if (ImGui::IsItemDeactivatedAfterEdit()) {
+        actor->setName(m_nameBuffer);
+        m_outlinerDirty = true;
+    }
     ImGui::SameLine();
 
     if (ImGui::Button("Icon")) {
@@ -191,33 +424,211 @@ void UserInterface::inspectorGeneral(EU::TSharedPointer<Actor> actor) {
 
     ImGui::Separator();
 
-    const char* tags[] = { "Untagged", "Player", "Enemy", "Environment" };
+    static const char* const tags[] = { "Untagged", "Player", "Enemy", "Environment" };
     static int currentTag = 0;
     ImGui::SetNextItemWidth(ImGui::GetContentRegionAvailWidth() * 0.5f);
     ImGui::Combo("Tag", &currentTag, tags, IM_ARRAYSIZE(tags));
     ImGui::SameLine();
 
-    const char* layers[] = { "Default", "TransparentFX", "Ignore Raycast", "Water", "UI" };
+    static const char* const layers[] = { "Default", "TransparentFX", "Ignore Raycast", "Water", "UI" };
     static int currentLayer = 0;
     ImGui::SetNextItemWidth(ImGui::GetContentRegionAvailWidth() * 0.5f);
     ImGui::Combo("Layer", &currentLayer, layers, IM_ARRAYSIZE(layers));
 
+    // Actores caros: caja de prueba + SetPredication (ver OcclusionPredicates).
+    bool occlusionQuery = actor->usesOcclusionQuery();
+    if (ImGui::Checkbox("Occlusion query", &occlusionQuery)) {
+        actor->setOcclusionQuery(occlusionQuery);
+    }
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Draw the bounding box into a predicate first;\nthe GPU skips the actor if the box is hidden.");
+    }
+    float impostorDistance = actor->getImpostorDistance();
+    ImGui::SetNextItemWidth(ImGui::GetContentRegionAvailWidth() * 0.5f);
+    if (ImGui::DragFloat("Impostor distance", &impostorDistance, 1.0f, 0.0f, 10000.0f, "%.0f")) {
+        actor->setImpostorDistance(impostorDistance);
+    }
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Beyond this distance the actor is drawn as a baked billboard (0 = never).");
+    }
+
     ImGui::Separator();
     if (ImGui::CollapsingHeader("Transform", ImGuiTreeNodeFlags_DefaultOpen)) {
         inspectorContainer(actor);
     }
+
+    // Coste del último frame; los contadores solo se recogen con la sección abierta.
+    m_costPanelOpen = costs && ImGui::CollapsingHeader("Cost");
+    if (m_costPanelOpen) {
+        if (!costs->isTracking()) {
+            costs->setTracking(true);
+            ImGui::TextDisabled("Collecting...");
+        }
+        const ActorCost::Cost cost = costs->getCost(*actor);
+        ImGui::Text("Draw calls: %u (%u triangles)", cost.draws, cost.triangles);
+        ImGui::Text("Shadow draws: %u (%u triangles)", cost.shadowDraws, cost.shadowTriangles);
+        ImGui::Text("Texture memory: %.2f MB", cost.textureBytes / (1024.0 * 1024.0));
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Shared textures count in full for every actor that uses them.");
+        }
+
+        bool profiled = costs->getProfiledActor() == actor.get();
+        if (ImGui::Checkbox("Measure GPU time", &profiled)) {
+            costs->setProfiledActor(profiled ? actor.get() : nullptr);
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Times each draw of this actor with GPU timestamps.\n"
+                "Its draws leave instanced batches and deferred contexts while measuring.");
+        }
+        if (profiled) {
+            if (cost.gpuMs < 0.0f) {
+                ImGui::TextDisabled("GPU: waiting for results...");
+            }
+            else {
+                ImGui::Text("GPU: %.3f ms (shadow %.3f ms)", cost.gpuMs, cost.shadowGpuMs);
+            }
+        }
+    }
     ImGui::End();
 }
 
-void UserInterface::inspectorContainer(EU::TSharedPointer<Actor> actor) {
-    vec3Control("Position", const_cast<float*>(actor->getComponent<Transform>()->getPosition().data()));
-    vec3Control("Rotation", const_cast<float*>(actor->getComponent<Transform>()->getRotation().data()));
-    vec3Control("Scale", const_cast<float*>(actor->getComponent<Transform>()->getScale().data()));
+void UserInterface::inspectorContainer(ActorHandle actor) {
+    Transform* transform = actor->getComponent<Transform>();
+    if (!transform) {
+        return;
+    }
+    // Se edita una copia y se aplica con los setters, que marcan el transform como sucio.
+    // La rotación se guarda como cuaternión; aquí se muestra en grados de Euler.
+    const float toDegrees = 180.0f / XM_PI;
+    const EU::Vector3 euler = transform->getEulerAngles() * toDegrees;
+    EU::Vector3 position = transform->getPosition();
+    EU::Vector3 rotation = euler;
+    EU::Vector3 scale = transform->getScale();
+    vec3Control("Position", position.data());
+    vec3Control("Rotation", rotation.data());
+    vec3Control("Scale", scale.data());
+    if (memcmp(&rotation, &euler, sizeof(EU::Vector3)) != 0) {
+        transform->setTransform(position, rotation * (1.0f / toDegrees), scale);
+    }
+    else if (memcmp(&position, &transform->getPosition(), sizeof(EU::Vector3)) != 0 ||
+        memcmp(&scale, &transform->getScale(), sizeof(EU::Vector3)) != 0) {
+        // Sin tocar la rotación: no se pasa por Euler y el cuaternión queda intacto.
+        transform->setTransform(position, transform->getRotation(), scale);
+    }
 }
 
 void UserInterface::output() {
-    bool Stage = true;
-    ImGui::Begin("Output", &Stage);
+    ImGui::Begin("Output");
+    Logger& logger = Logger::getDefault();
+    // Solo los niveles compilados (desde `LOG_MIN_LEVEL`).
+    int level = Logger::getLevel();
+    ImGui::SetNextItemWidth(100.0f);
+    if (ImGui::BeginCombo("Level", Logger::getLevelName(static_cast<uint8_t>(level)))) {
+        for (int option = LOG_MIN_LEVEL; option < LOG_LEVEL_COUNT; ++option) {
+            if (ImGui::Selectable(Logger::getLevelName(static_cast<uint8_t>(option)), option == level)) {
+                Logger::setLevel(static_cast<uint8_t>(option));
+            }
+        }
+        ImGui::EndCombo();
+    }
+    if (logger.getDroppedCount() > 0) {
+        ImGui::SameLine();
+        ImGui::TextDisabled("Dropped: %llu (ring full)", logger.getDroppedCount());
+    }
+    ImGui::Separator();
+    ImGui::BeginChild("OutputLog");
+    logger.forEachRecent([](uint8_t level, const std::string& line) {
+        if (level >= LOG_LEVEL_WARNING) {
+            const ImVec4 color = level == LOG_LEVEL_ERROR ? ImVec4(1.0f, 0.4f, 0.3f, 1.0f) : ImVec4(1.0f, 0.8f, 0.3f, 1.0f);
+            ImGui::PushStyleColor(ImGuiCol_Text, color);
+            ImGui::TextWrapped("%s", line.c_str());
+            ImGui::PopStyleColor();
+        }
+        else {
+            ImGui::TextUnformatted(line.c_str());
+        }
+    });
+    // Seguir la última línea mientras el usuario no suba.
+    if (ImGui::GetScrollY() >= ImGui::GetScrollMaxY()) {
+        ImGui::SetScrollHereY(1.0f);
+    }
+    ImGui::EndChild();
+    ImGui::End();
+}
+
+void UserInterface::console() {
+    ImGui::Begin("Console");
+    ConsoleVariables& cvars = ConsoleVariables::getDefault();
+
+    // Tabla de cvars: se editan en sitio; la ayuda sale al pasar el ratón. Las cambiadas en amarillo.
+    std::vector<ConsoleVariable*> variables;
+    cvars.getSorted(variables);
+    const float inputHeight = ImGui::GetFrameHeightWithSpacing();
+    if (ImGui::BeginTable("ConsoleVariables", 2, ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY | ImGuiTableFlags_Resizable,
+        ImVec2(0.0f, ImGui::GetContentRegionAvail().y * 0.5f))) {
+        for (ConsoleVariable* variable : variables) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            if (variable->isModified()) {
+                ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.3f, 1.0f), "%s", variable->getName());
+            }
+            else {
+                ImGui::TextUnformatted(variable->getName());
+            }
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("%s\nClic derecho: valor por defecto", variable->getHelp());
+            }
+            if (ImGui::IsItemClicked(ImGuiMouseButton_Right)) {
+                variable->reset();
+            }
+            ImGui::TableNextColumn();
+            ImGui::PushID(variable);
+            ImGui::SetNextItemWidth(-FLT_MIN);
+            switch (variable->getType()) {
+            case ConsoleVariable::CVAR_BOOL: {
+                CVarBool* cvar = static_cast<CVarBool*>(variable);
+                bool value = cvar->get();
+                if (ImGui::Checkbox("##value", &value)) cvar->set(value);
+                break;
+            }
+            case ConsoleVariable::CVAR_INT: {
+                CVarInt* cvar = static_cast<CVarInt*>(variable);
+                int value = cvar->get();
+                if (ImGui::DragInt("##value", &value)) cvar->set(value);
+                break;
+            }
+            case ConsoleVariable::CVAR_FLOAT: {
+                CVarFloat* cvar = static_cast<CVarFloat*>(variable);
+                float value = cvar->get();
+                if (ImGui::DragFloat("##value", &value, 0.01f)) cvar->set(value);
+                break;
+            }
+            }
+            ImGui::PopID();
+        }
+        ImGui::EndTable();
+    }
+
+    // Historial y línea de comandos (`help` lista los comandos).
+    ImGui::Separator();
+    ImGui::BeginChild("ConsoleOutput", ImVec2(0.0f, -inputHeight));
+    for (const std::string& line : m_consoleOutput) {
+        ImGui::TextUnformatted(line.c_str());
+    }
+    if (ImGui::GetScrollY() >= ImGui::GetScrollMaxY()) {
+        ImGui::SetScrollHereY(1.0f);
+    }
+    ImGui::EndChild();
+    ImGui::SetNextItemWidth(-FLT_MIN);
+    if (ImGui::InputText("##command", m_consoleInput, sizeof(m_consoleInput), ImGuiInputTextFlags_EnterReturnsTrue)) {
+        m_consoleOutput.push_back(std::string("> ") + m_consoleInput);
+        cvars.execute(m_consoleInput, m_consoleOutput);
+        m_consoleInput[0] = '\0';
+        if (m_consoleOutput.size() > kConsoleHistory) {
+            m_consoleOutput.erase(m_consoleOutput.begin(), m_consoleOutput.end() - kConsoleHistory);
+        }
+        ImGui::SetKeyboardFocusHere(-1);
+    }
     ImGui::End();
 }
 
@@ -533,7 +944,9 @@ void UserInterface::ToolBar() {
         if (ImGui::BeginMenu("File")) {
             ImGui::MenuItem("New");
             ImGui::MenuItem("Open");
-            ImGui::MenuItem("Save");
+            if (ImGui::MenuItem("Save")) {
+                m_saveSceneRequested = true;
+            }
             if (ImGui::MenuItem("Exit")) {
                 show_exit_popup = true;
                 ImGui::OpenPopup("Exit?");
@@ -551,12 +964,88 @@ void UserInterface::ToolBar() {
         if (ImGui::BeginMenu("Tools")) {
             ImGui::MenuItem("Options");
             ImGui::MenuItem("Settings");
+            ImGui::Separator();
+            if (ImGui::MenuItem("Bake lightmaps")) {
+                m_bakeLightmapsRequested = true;
+            }
+            if (ImGui::MenuItem("Bake visibility")) {
+                m_bakeVisibilityRequested = true;
+            }
+            ImGui::EndMenu();
+        }
+        if (ImGui::BeginMenu("Window")) {
+            ImGui::MenuItem("Viewport", nullptr, &m_showViewport);
+            ImGui::EndMenu();
+        }
+        if (ImGui::BeginMenu("Profile")) {
+            ImGui::SliderInt("Frames", &m_traceFrames, 1, 1000);
+            if (ImGui::MenuItem("Capture trace")) {
+                m_traceRequested = true;
+            }
+            if (ImGui::MenuItem("Add camera key")) {
+                m_cameraKeyRequested = true;
+            }
+            if (ImGui::MenuItem("Capture screenshot")) {
+                m_screenshotRequested = true;
+            }
+            if (ImGui::MenuItem(m_recording ? "Stop recording" : "Start recording (H.264)")) {
+                m_recordToggleRequested = true;
+            }
+            ImGui::Separator();
+            ImGui::MenuItem("GPU event markers", nullptr, &m_eventMarkers);
+            ImGui::MenuItem("Texture arrays", nullptr, &m_textureArrays);
+            ImGui::MenuItem("Stats overlay", nullptr, &m_showStats);
             ImGui::EndMenu();
         }
         ImGui::EndMainMenuBar();
     }
 }
 
+bool UserInterface::consumeCameraKeyRequest() {
+    const bool requested = m_cameraKeyRequested;
+    m_cameraKeyRequested = false;
+    return requested;
+}
+
+bool UserInterface::consumeScreenshotRequest() {
+    const bool requested = m_screenshotRequested;
+    m_screenshotRequested = false;
+    return requested;
+}
+
+bool UserInterface::consumeSaveSceneRequest() {
+    const bool requested = m_saveSceneRequested;
+    m_saveSceneRequested = false;
+    return requested;
+}
+
+bool UserInterface::consumeBakeLightmapsRequest() {
+    const bool requested = m_bakeLightmapsRequested;
+    m_bakeLightmapsRequested = false;
+    return requested;
+}
+
+bool UserInterface::consumeBakeVisibilityRequest() {
+    const bool requested = m_bakeVisibilityRequested;
+    m_bakeVisibilityRequested = false;
+    return requested;
+}
+
+bool UserInterface::consumeRecordToggleRequest() {
+    const bool requested = m_recordToggleRequested;
+    m_recordToggleRequested = false;
+    return requested;
+}
+
+bool UserInterface::consumeTraceRequest(unsigned int& frames) {
+    if (!m_traceRequested) {
+        return false;
+    }
+    m_traceRequested = false;
+    frames = static_cast<unsigned int>(m_traceFrames);
+    return true;
+}
+
 void UserInterface::closeApp() {
     if (show_exit_popup) {
         ImGui::OpenPopup("Exit?");
@@ -599,30 +1088,610 @@ void UserInterface::RenderFullScreenTransparentWindow() {
     ImGui::End();
 }
 
-void UserInterface::outliner(const std::vector<EU::TSharedPointer<Actor>>& actors) {
+void UserInterface::outliner(const std::vector<ActorHandle>& actors, ActorCost* costs) {
     ImGui::Begin("Hierarchy");
 
-    static ImGuiTextFilter filter;
-    filter.Draw("Search...", 180.0f);
+    if (m_outlinerFilter.Draw("Search...", 180.0f) || m_outlinerActorCount != actors.size()) {
+        m_outlinerDirty = true;
+    }
+    if (costs) {
+        static const char* const sortKeys[ActorCost::SORT_KEY_COUNT] = {
+            "Scene order", "Triangles", "Draw calls", "Shadow triangles", "Texture memory" };
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(140.0f);
+        if (ImGui::Combo("Sort by", &m_outlinerSort, sortKeys, IM_ARRAYSIZE(sortKeys))) {
+            m_outlinerDirty = true;
+        }
+        costs->setTracking(m_costPanelOpen || m_outlinerSort != ActorCost::SORT_NONE);
+        m_costPanelOpen = false;
+    }
     ImGui::Separator();
+    const int actorCount = static_cast<int>(actors.size());
+
+    // Por coste: lista plana del más caro al más barato (con el filtro, si lo hay).
+    if (costs && m_outlinerSort != ActorCost::SORT_NONE) {
+        const ActorCost::SortKey key = static_cast<ActorCost::SortKey>(m_outlinerSort);
+        const unsigned long long serial = costs->getSerial();
+        if (m_outlinerDirty || serial - m_outlinerSortSerial >= kOutlinerSortFrames) {
+            m_outlinerSorted.clear();
+            std::vector<std::pair<double, int>> values;
+            values.reserve(actors.size());
+            for (int i = 0; i < actorCount; ++i) {
+                if (actors[i] && (!m_outlinerFilter.IsActive() ||
+                    m_outlinerFilter.PassFilter(actors[i]->getName().c_str()))) {
+                    values.push_back({ ActorCost::sortValue(costs->getCost(*actors[i]), key), i });
+                }
+            }
+            std::stable_sort(values.begin(), values.end(),
+                [](const std::pair<double, int>& a, const std::pair<double, int>& b) { return a.first > b.first; });
+            for (const auto& value : values) {
+                m_outlinerSorted.push_back(value.second);
+            }
+            m_outlinerSortSerial = serial;
+            m_outlinerActorCount = actors.size();
+            m_outlinerDirty = false;
+        }
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(m_outlinerSorted.size()));
+        while (clipper.Step()) {
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+                const int index = m_outlinerSorted[row];
+                if (index >= actorCount || !actors[index]) {
+                    continue;
+                }
+                outlinerRow(actors, index);
+                const ActorCost::Cost cost = costs->getCost(*actors[index]);
+                ImGui::SameLine();
+                if (key == ActorCost::SORT_TEXTURE_MEMORY) {
+                    ImGui::TextDisabled("%.2f MB", cost.textureBytes / (1024.0 * 1024.0));
+                }
+                else {
+                    ImGui::TextDisabled("%.0f", ActorCost::sortValue(cost, key));
+                }
+            }
+        }
+        ImGui::End();
+        return;
+    }
 
-    for (int i = 0; i < (int)actors.size(); ++i) {
-        const auto& actor = actors[i];
-        std::string actorName = actor ? actor->getName() : "Unnamed Actor";
-        if (!filter.PassFilter(actorName.c_str()))
-            continue;
+    // Con filtro: los índices que pasan (solo se recalculan si algo cambió) y se recortan.
+    if (m_outlinerFilter.IsActive()) {
+        if (m_outlinerDirty) {
+            m_outlinerMatches.clear();
+            for (int i = 0; i < actorCount; ++i) {
+                if (actors[i] && m_outlinerFilter.PassFilter(actors[i]->getName().c_str())) {
+                    m_outlinerMatches.push_back(i);
+                }
+            }
+            m_outlinerActorCount = actors.size();
+            m_outlinerDirty = false;
+        }
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(m_outlinerMatches.size()));
+        while (clipper.Step()) {
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+                outlinerRow(actors, m_outlinerMatches[row]);
+            }
+        }
+        ImGui::End();
+        return;
+    }
+    m_outlinerActorCount = actors.size();
+
+    // Escena pequeña: lista plana.
+    if (actorCount <= kOutlinerGroupSize) {
+        ImGuiListClipper clipper;
+        clipper.Begin(actorCount);
+        while (clipper.Step()) {
+            for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+                outlinerRow(actors, i);
+            }
+        }
+        ImGui::End();
+        return;
+    }
 
-        ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_OpenOnDoubleClick;
-        if (selectedActorIndex == i) flags |= ImGuiTreeNodeFlags_Selected;
+    // Escena grande: una cabecera por grupo y, bajo las abiertas, sus actores. Todas las
+    // filas miden lo mismo, así que el clipper recorta cabeceras e hijos por igual.
+    const int groupCount = (actorCount + kOutlinerGroupSize - 1) / kOutlinerGroupSize;
+    while (!m_outlinerOpenGroups.empty() && m_outlinerOpenGroups.back() >= groupCount) {
+        m_outlinerOpenGroups.pop_back();
+    }
+    auto groupSize = [&](int group) { return (std::min)(kOutlinerGroupSize, actorCount - group * kOutlinerGroupSize); };
+    auto isOpen = [&](int group) {
+        return std::binary_search(m_outlinerOpenGroups.begin(), m_outlinerOpenGroups.end(), group);
+    };
+    int rowCount = groupCount;
+    for (int group : m_outlinerOpenGroups) {
+        rowCount += groupSize(group);
+    }
 
-        bool nodeOpen = ImGui::TreeNodeEx((void*)(intptr_t)i, flags, "%s", actorName.c_str());
-        if (ImGui::IsItemClicked())
-            selectedActorIndex = i;
+    int toggled = -1;
+    ImGuiListClipper clipper;
+    clipper.Begin(rowCount);
+    while (clipper.Step()) {
+        // Grupo y fila de `DisplayStart`: solo se recorren los grupos abiertos (pocos).
+        int group = -1;
+        int child = -1;
+        int skipped = 0;
+        for (int open : m_outlinerOpenGroups) {
+            const int header = open + skipped;
+            if (clipper.DisplayStart <= header) {
+                break;
+            }
+            if (clipper.DisplayStart <= header + groupSize(open)) {
+                group = open;
+                child = clipper.DisplayStart - header - 1;
+                break;
+            }
+            skipped += groupSize(open);
+        }
+        if (group < 0) {
+            group = clipper.DisplayStart - skipped;
+        }
 
-        if (nodeOpen) {
-            ImGui::TreePop();
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+            const bool open = isOpen(group);
+            if (child < 0) {
+                const int first = group * kOutlinerGroupSize;
+                ImGui::SetNextItemOpen(open);
+                if (ImGui::TreeNodeEx((void*)(intptr_t)(-1 - group), ImGuiTreeNodeFlags_NoTreePushOnOpen,
+                    "Actors %d - %d", first, first + groupSize(group) - 1) != open) {
+                    toggled = group;
+                }
+            }
+            else {
+                ImGui::Indent();
+                outlinerRow(actors, group * kOutlinerGroupSize + child);
+                ImGui::Unindent();
+            }
+            // Siguiente fila: primer hijo de un grupo abierto, siguiente hijo o siguiente cabecera.
+            if (child < 0 && open) {
+                child = 0;
+            }
+            else if (child >= 0 && child + 1 < groupSize(group)) {
+                ++child;
+            }
+            else {
+                ++group;
+                child = -1;
+            }
         }
     }
+    // Abrir o cerrar después de recorrer: durante el recorrido la lista no cambia.
+    if (toggled >= 0) {
+        auto it = std::lower_bound(m_outlinerOpenGroups.begin(), m_outlinerOpenGroups.end(), toggled);
+        if (it != m_outlinerOpenGroups.end() && *it == toggled) {
+            m_outlinerOpenGroups.erase(it);
+        }
+        else {
+            m_outlinerOpenGroups.insert(it, toggled);
+        }
+    }
+
+    ImGui::End();
+}
+
+void UserInterface::outlinerRow(const std::vector<ActorHandle>& actors, int index) {
+    const ActorHandle actor = actors[index];
+    // Hoja sin TreePush: una fila es un solo item, y el nombre se pasa por referencia.
+    ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_Leaf | ImGuiTreeNodeFlags_NoTreePushOnOpen;
+    if (selectedActorIndex == index) {
+        flags |= ImGuiTreeNodeFlags_Selected;
+    }
+    ImGui::TreeNodeEx((void*)(intptr_t)index, flags, "%s", actor ? actor->getName().c_str() : "Unnamed Actor");
+    if (ImGui::IsItemClicked()) {
+        selectedActorIndex = index;
+    }
+}
+
+void UserInterface::gpuProfiler(GpuProfiler& profiler) {
+    ImGui::Begin("GPU Profiler");
+
+    if (!profiler.isEnabled()) {
+        ImGui::TextDisabled("Timestamp queries unavailable.");
+        ImGui::End();
+        return;
+    }
+
+    ImGui::Text("GPU frame: %.3f ms", profiler.getFrameTime());
+    ImGui::TextDisabled("Dropped frames: %u", profiler.getDroppedFrames());
+    if (profiler.hasPipelineStatistics()) {
+        bool statistics = profiler.isPipelineStatisticsEnabled();
+        if (ImGui::Checkbox("Pipeline statistics", &statistics)) {
+            profiler.setPipelineStatistics(statistics);
+        }
+    }
+    ImGui::Separator();
+
+    // Overdraw = invocaciones de PS / píxeles del back buffer (1.0 = cada píxel una vez).
+    const bool statistics = profiler.isPipelineStatisticsEnabled();
+    const double pixels = static_cast<double>((std::max)(profiler.getTargetPixelCount(), 1u));
+    const int columns = statistics ? 7 : 2;
+    if (ImGui::BeginTable("GpuPasses", columns, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV)) {
+        ImGui::TableSetupColumn("Pass");
+        ImGui::TableSetupColumn("ms", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+        if (statistics) {
+            ImGui::TableSetupColumn("IA verts", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+            ImGui::TableSetupColumn("VS", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+            ImGui::TableSetupColumn("Prims", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+            ImGui::TableSetupColumn("PS", ImGuiTableColumnFlags_WidthFixed, 90.0f);
+            ImGui::TableSetupColumn("Overdraw", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+        }
+        ImGui::TableHeadersRow();
+        for (const GpuProfiler::Result& result : profiler.getResults()) {
+            ImGui::TableNextRow();
+            ImGui::TableSetColumnIndex(0);
+            ImGui::Indent(result.depth * 12.0f + 1.0f);
+            ImGui::TextUnformatted(result.name);
+            ImGui::Unindent(result.depth * 12.0f + 1.0f);
+            ImGui::TableSetColumnIndex(1);
+            ImGui::Text("%.3f", result.ms);
+            if (statistics && result.hasStatistics) {
+                const D3D11_QUERY_DATA_PIPELINE_STATISTICS& s = result.statistics;
+                ImGui::TableSetColumnIndex(2);
+                ImGui::Text("%llu", s.IAVertices);
+                ImGui::TableSetColumnIndex(3);
+                ImGui::Text("%llu", s.VSInvocations);
+                ImGui::TableSetColumnIndex(4);
+                ImGui::Text("%llu", s.CPrimitives);
+                ImGui::TableSetColumnIndex(5);
+                ImGui::Text("%llu", s.PSInvocations);
+                ImGui::TableSetColumnIndex(6);
+                ImGui::Text("%.2fx", s.PSInvocations / pixels);
+            }
+        }
+        ImGui::EndTable();
+    }
+
+    ImGui::End();
+}
+
+void UserInterface::renderStats(const DeviceContext& deviceContext) {
+    if (!m_showStats) {
+        return;
+    }
+
+    // Esquina superior derecha del viewport principal, bajo la barra de menú.
+    const ImGuiViewport* viewport = ImGui::GetMainViewport();
+    const float margin = 10.0f;
+    ImGui::SetNextWindowPos(ImVec2(viewport->WorkPos.x + viewport->WorkSize.x - margin,
+        viewport->WorkPos.y + margin), ImGuiCond_Always, ImVec2(1.0f, 0.0f));
+    ImGui::SetNextWindowViewport(viewport->ID);
+    ImGui::SetNextWindowBgAlpha(0.6f);
+    const ImGuiWindowFlags flags = ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_AlwaysAutoResize |
+        ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoFocusOnAppearing |
+        ImGuiWindowFlags_NoNav | ImGuiWindowFlags_NoDocking;
+    if (!ImGui::Begin("Render stats", nullptr, flags)) {
+        ImGui::End();
+        return;
+    }
+
+    const DeviceContext::RenderStats& stats = deviceContext.getLastFrameStats();
+    ImGui::Text("Draw calls:   %u", stats.drawCalls);
+    ImGui::Text("Indices:      %llu", stats.indices);
+    ImGui::Text("Primitives:   %llu", stats.primitives);
+    ImGui::Text("SRV binds:    %u", stats.shaderResourceBinds);
+    ImGui::Text("CB upload:    %.1f KB", stats.constantBufferBytes / 1024.0);
+    ImGui::Text("Total upload: %.1f KB", stats.uploadBytes / 1024.0);
+    if (stats.commandLists > 0) {
+        ImGui::Text("Command lists: %u", stats.commandLists);
+    }
+    ImGui::Separator();
+    ImGui::Text("State changes: %u (%u filtered)", stats.totalStateChanges(), stats.filteredCalls);
+    for (int c = 0; c < STATE_CATEGORY_COUNT; ++c) {
+        if (stats.stateChanges[c] > 0) {
+            ImGui::TextDisabled("  %-16s %u", DeviceContext::getStateCategoryName(static_cast<StateCategory>(c)),
+                stats.stateChanges[c]);
+        }
+    }
+    const StallDetector::FrameStats& stalls = StallDetector::getDefault().getLastFrame();
+    unsigned int stallCount = 0;
+    double stallMs = 0.0;
+    for (int k = 0; k < STALL_KIND_COUNT; ++k) {
+        stallCount += stalls.count[k];
+        stallMs += stalls.ms[k];
+    }
+    ImGui::Separator();
+    ImGui::Text("CPU waits on GPU: %u (%.2f ms)", stallCount, stallMs);
+    for (int k = 0; k < STALL_KIND_COUNT; ++k) {
+        if (stalls.count[k] > 0) {
+            ImGui::TextDisabled("  %-16s %u (%.2f ms)", StallDetector::getKindName(static_cast<StallKind>(k)),
+                stalls.count[k], stalls.ms[k]);
+        }
+    }
+    StallDetector::Stall recent[4];
+    const unsigned int recentCount = StallDetector::getDefault().getRecent(recent, 4);
+    for (unsigned int i = 0; i < recentCount; ++i) {
+        ImGui::TextDisabled("  %.2f ms %s %s:%u", recent[i].ms, recent[i].resource, recent[i].file, recent[i].line);
+    }
+    ImGui::End();
+}
+
+void UserInterface::cpuProfiler(const CpuProfiler& profiler) {
+    ImGui::Begin("CPU Profiler");
+
+#if !defined(PROFILE)
+    UNREFERENCED_PARAMETER(profiler);
+    ImGui::TextDisabled("Build with PROFILE (Debug/Profile) to record CPU zones.");
+#else
+    const unsigned int available = profiler.getFrameCount();
+    ImGui::SliderInt("Frames", &m_flameFrames, 1, 16);
+    const unsigned int frames = (std::min)(static_cast<unsigned int>(m_flameFrames), available);
+    if (frames == 0) {
+        ImGui::End();
+        return;
+    }
+
+    const CpuProfiler::Frame newest = profiler.getFrame(0);
+    const CpuProfiler::Frame oldest = profiler.getFrame(frames - 1);
+    ImGui::Text("Last frame: %.3f ms", profiler.toMs(newest.end - newest.begin));
+
+    static std::vector<CpuProfiler::ThreadEvent> events;
+    const unsigned int threadCount = profiler.collect(oldest.begin, newest.end, events);
+    // Estáticos como `events`: conservan la capacidad y no reservan en cada frame.
+    static std::vector<std::string> threadNames;
+    threadNames.resize(threadCount);
+    for (unsigned int t = 0; t < threadCount; ++t) {
+        threadNames[t] = profiler.getThreadName(t);
+    }
+    static std::vector<LONGLONG> frameStarts;
+    frameStarts.clear();
+    for (unsigned int f = 0; f < frames; ++f) {
+        frameStarts.push_back(profiler.getFrame(f).begin);
+    }
+    drawFlameGraph(events, threadNames, oldest.begin, newest.end, frameStarts, profiler);
+#endif
 
     ImGui::End();
-}
\ No newline at end of file
+}
+
+void UserInterface::frameTimes(FrameTimeHistory& history, const CpuProfiler& profiler) {
+    ImGui::Begin("Frame Times");
+
+    const unsigned int count = history.getCount();
+    const FrameTimeHistory::Percentiles percentiles = history.getPercentiles();
+    const float threshold = static_cast<float>(history.getHitchThreshold());
+    const ImVec4 hitchColor(1.0f, 0.4f, 0.3f, 1.0f);
+    ImGui::Text("Last: %.2f ms   p50: %.2f   p95: %.2f", history.getFrameMs(0), percentiles.p50, percentiles.p95);
+    ImGui::SameLine();
+    if (percentiles.p99 > threshold) {
+        ImGui::TextColored(hitchColor, "p99: %.2f", percentiles.p99);
+    }
+    else {
+        ImGui::Text("p99: %.2f", percentiles.p99);
+    }
+    ImGui::TextDisabled("%u frames", count);
+
+    // Historial (el más antiguo a la izquierda) e histograma sobre la misma escala.
+    auto frameAt = [](void* data, int index) {
+        const FrameTimeHistory* frames = static_cast<const FrameTimeHistory*>(data);
+        return frames->getFrameMs(frames->getCount() - 1 - static_cast<unsigned int>(index));
+    };
+    const float width = ImGui::GetContentRegionAvail().x;
+    ImGui::PlotLines("##FrameTimes", frameAt, &history, static_cast<int>(count), 0, nullptr,
+        0.0f, m_frameTimeRangeMs, ImVec2(width, 60.0f));
+
+    const unsigned int kBins = 40;
+    float bins[kBins];
+    history.buildHistogram(bins, kBins, m_frameTimeRangeMs);
+    char overlay[64];
+    snprintf(overlay, sizeof(overlay), "0 - %.0f ms", m_frameTimeRangeMs);
+    ImGui::PlotHistogram("##FrameHistogram", bins, kBins, 0, overlay, 0.0f, FLT_MAX, ImVec2(width, 60.0f));
+
+    ImGui::SliderFloat("Range (ms)", &m_frameTimeRangeMs, 5.0f, 200.0f, "%.0f");
+    float hitchMs = threshold;
+    if (ImGui::SliderFloat("Hitch threshold (ms)", &hitchMs, 5.0f, 200.0f, "%.1f")) {
+        history.setHitchThreshold(hitchMs);
+    }
+    if (ImGui::Button("Clear")) {
+        history.clear();
+        m_selectedHitchFrame = kNoHitch;
+    }
+
+    ImGui::Separator();
+    const std::deque<FrameTimeHistory::Hitch>& hitches = history.getHitches();
+    ImGui::Text("Hitches: %llu (last %u kept)", history.getHitchCount(), FrameTimeHistory::kMaxHitches);
+    // Más reciente primero; la selección sigue al frame aunque se descarten tirones viejos.
+    int selected = -1;
+    for (int i = static_cast<int>(hitches.size()) - 1; i >= 0; --i) {
+        char label[64];
+        snprintf(label, sizeof(label), "Frame %llu: %.2f ms", hitches[i].frame, hitches[i].ms);
+        if (ImGui::Selectable(label, m_selectedHitchFrame == hitches[i].frame)) {
+            m_selectedHitchFrame = hitches[i].frame;
+        }
+        if (m_selectedHitchFrame == hitches[i].frame) {
+            selected = i;
+        }
+    }
+
+    if (selected >= 0) {
+        const FrameTimeHistory::Hitch& hitch = hitches[selected];
+        ImGui::Separator();
+        ImGui::TextColored(hitchColor, "Frame %llu: %.2f ms", hitch.frame, hitch.ms);
+        if (ImGui::Button("Save trace")) {
+            m_hitchExportRequested = true;
+            m_hitchExportIndex = static_cast<size_t>(selected);
+        }
+
+        if (hitch.cpuEvents.empty()) {
+            ImGui::TextDisabled("No CPU zones (build with PROFILE).");
+        }
+        else {
+            drawFlameGraph(hitch.cpuEvents, hitch.threadNames, hitch.cpuBegin, hitch.cpuEnd,
+                std::vector<LONGLONG>(), profiler);
+        }
+
+        if (hitch.gpuFramesLeft > 0) {
+            ImGui::TextDisabled("GPU passes pending (%u frames)...", hitch.gpuFramesLeft);
+        }
+        else if (hitch.gpuMissing) {
+            ImGui::TextDisabled("GPU results for this frame were dropped.");
+        }
+        else if (ImGui::BeginTable("HitchGpu", 2, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV)) {
+            ImGui::TableSetupColumn("GPU pass");
+            ImGui::TableSetupColumn("ms", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+            ImGui::TableHeadersRow();
+            for (const GpuProfiler::Result& pass : hitch.gpuPasses) {
+                ImGui::TableNextRow();
+                ImGui::TableSetColumnIndex(0);
+                ImGui::Indent(pass.depth * 12.0f + 1.0f);
+                ImGui::TextUnformatted(pass.name);
+                ImGui::Unindent(pass.depth * 12.0f + 1.0f);
+                ImGui::TableSetColumnIndex(1);
+                ImGui::Text("%.3f", pass.ms);
+            }
+            ImGui::EndTable();
+        }
+    }
+
+    ImGui::End();
+}
+
+void UserInterface::memoryStats() {
+    ImGui::Begin("Memory");
+
+    if (!MemoryTracker::isEnabled()) {
+        ImGui::TextDisabled("Build with PROFILE (Debug/Profile) to track heap allocations.");
+    }
+    else {
+        const unsigned long long allocations = MemoryTracker::getFrameAllocations();
+        const ImVec4 warnColor(1.0f, 0.4f, 0.3f, 1.0f);
+        if (allocations > 0) {
+            ImGui::TextColored(warnColor, "Allocations this frame: %llu", allocations);
+        }
+        else {
+            ImGui::Text("Allocations this frame: 0");
+        }
+        ImGui::SameLine();
+        ImGui::TextDisabled("(peak %llu)", MemoryTracker::getPeakFrameAllocations());
+
+        if (ImGui::BeginTable("MemoryTags", 4, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV)) {
+            ImGui::TableSetupColumn("Subsystem");
+            ImGui::TableSetupColumn("Allocs", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+            ImGui::TableSetupColumn("KB", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+            ImGui::TableSetupColumn("Live MB", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+            ImGui::TableHeadersRow();
+            for (int t = 0; t < MEMORY_TAG_COUNT; ++t) {
+                const MemoryTag tag = static_cast<MemoryTag>(t);
+                const MemoryTracker::TagStats stats = MemoryTracker::getFrameStats(tag);
+                ImGui::TableNextRow();
+                ImGui::TableSetColumnIndex(0);
+                ImGui::TextUnformatted(MemoryTracker::getTagName(tag));
+                ImGui::TableSetColumnIndex(1);
+                ImGui::Text("%llu", stats.allocations);
+                ImGui::TableSetColumnIndex(2);
+                ImGui::Text("%.1f", stats.bytes / 1024.0);
+                ImGui::TableSetColumnIndex(3);
+                ImGui::Text("%.2f", stats.liveBytes / (1024.0 * 1024.0));
+            }
+            ImGui::EndTable();
+        }
+
+        // Reservas dentro de MEMORY_NO_ALLOC_SCOPE: con el depurador, parar en la reserva.
+        const unsigned long long violations = MemoryTracker::getViolationCount();
+        if (violations > 0) {
+            ImGui::TextColored(warnColor, "No-alloc violations: %llu", violations);
+        }
+        else {
+            ImGui::Text("No-alloc violations: 0");
+        }
+        bool breakOnViolation = MemoryTracker::getBreakOnViolation();
+        if (ImGui::Checkbox("Break on no-alloc violation", &breakOnViolation)) {
+            MemoryTracker::setBreakOnViolation(breakOnViolation);
+        }
+    }
+
+    ImGui::Separator();
+    ImGui::Text("Frame arena peak: %.1f KB of %.1f KB", FrameArena::getPeakBytes() / 1024.0,
+        FrameArena::kBytesPerThread / 1024.0);
+    ImGui::Text("Frame arena overflows: %llu", static_cast<unsigned long long>(FrameArena::getFailureCount()));
+    ImGui::End();
+}
+
+void UserInterface::gpuMemory(const GpuMemory& memory) {
+    ImGui::Begin("GPU Memory");
+
+    const double mb = 1024.0 * 1024.0;
+    const GpuMemory::Segment& local = memory.getLocal();
+    if (memory.isOverBudget()) {
+        // El sistema ya está paginando: los tirones vienen de aquí.
+        ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.3f, 1.0f), "Over budget: %.0f / %.0f MB",
+            local.usage / mb, local.budget / mb);
+    }
+    else {
+        ImGui::Text("Local: %.0f / %.0f MB", local.usage / mb, local.budget / mb);
+    }
+    if (local.budget != 0) {
+        ImGui::ProgressBar(static_cast<float>((std::min)(1.0, static_cast<double>(local.usage) / local.budget)));
+    }
+    if (memory.hasBudgetQueries()) {
+        const GpuMemory::Segment& nonLocal = memory.getNonLocal();
+        ImGui::Text("Non-local: %.0f / %.0f MB", nonLocal.usage / mb, nonLocal.budget / mb);
+    }
+    else {
+        ImGui::TextDisabled("No IDXGIAdapter3: budget is the dedicated VRAM, usage is the engine's own.");
+    }
+
+    ImGui::Separator();
+    if (ImGui::BeginTable("GpuMemoryCategories", 3, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV)) {
+        ImGui::TableSetupColumn("Category");
+        ImGui::TableSetupColumn("Count", ImGuiTableColumnFlags_WidthFixed, 60.0f);
+        ImGui::TableSetupColumn("MB", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+        ImGui::TableHeadersRow();
+        for (int c = 0; c < GPU_MEMORY_CATEGORY_COUNT; ++c) {
+            const GpuMemoryCategory category = static_cast<GpuMemoryCategory>(c);
+            ImGui::TableNextRow();
+            ImGui::TableSetColumnIndex(0);
+            ImGui::TextUnformatted(GpuMemory::getCategoryName(category));
+            ImGui::TableSetColumnIndex(1);
+            ImGui::Text("%u", GpuMemory::getTrackedCount(category));
+            ImGui::TableSetColumnIndex(2);
+            ImGui::Text("%.1f", GpuMemory::getTrackedBytes(category) / mb);
+        }
+        ImGui::EndTable();
+    }
+    ImGui::Text("Engine video memory: %.1f MB", GpuMemory::getTrackedVideoBytes() / mb);
+    ImGui::End();
+}
+
+void UserInterface::shaderReload(ShaderHotReload& reload) {
+    ImGui::Begin("Shaders");
+    if (!reload.isWatching()) {
+        ImGui::TextDisabled("Hot reload off (the shader directory could not be watched).");
+    }
+    else {
+        ImGui::Text("Watching: %s", reload.getDirectory().c_str());
+        ImGui::Text("Reloaded: %u%s", reload.getReloadCount(), reload.isCompiling() ? "  (compiling...)" : "");
+    }
+    if (ImGui::Button("Clear")) {
+        reload.clearLog();
+    }
+    ImGui::Separator();
+    ImGui::BeginChild("ShaderLog");
+    for (const ShaderHotReload::LogLine& line : reload.getLog()) {
+        if (line.error) {
+            ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 0.4f, 0.3f, 1.0f));
+            ImGui::TextWrapped("%s", line.text.c_str());
+            ImGui::PopStyleColor();
+        }
+        else {
+            ImGui::TextUnformatted(line.text.c_str());
+        }
+    }
+    // Seguir la última línea mientras el usuario no suba.
+    if (ImGui::GetScrollY() >= ImGui::GetScrollMaxY()) {
+        ImGui::SetScrollHereY(1.0f);
+    }
+    ImGui::EndChild();
+    ImGui::End();
+}
+
+bool UserInterface::consumeHitchExportRequest(size_t& index) {
+    if (!m_hitchExportRequested) {
+        return false;
+    }
+    m_hitchExportRequested = false;
+    index = m_hitchExportIndex;
+    return true;
+}
@@ -0,0 +1,134 @@
+﻿/**
+ * @file VertexFormat.cpp
+ * @brief Implementación de la codificación de vértices y de su input layout.
+ */
+
+#include "VertexFormat.h"
+#include "MeshComponent.h"
+#include <cmath>
+#include <cstring>
+
+namespace {
+    D3D11_INPUT_ELEMENT_DESC element(const char* semantic, DXGI_FORMAT format) {
+        D3D11_INPUT_ELEMENT_DESC desc{};
+        desc.SemanticName = semantic;
+        desc.SemanticIndex = 0;
+        desc.Format = format;
+        desc.InputSlot = 0;
+        desc.AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;
+        desc.InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+        desc.InstanceDataStepRate = 0;
+        return desc;
+    }
+
+    short toSnorm16(float value) {
+        const float clamped = (std::max)(-1.0f, (std::min)(1.0f, value));
+        return static_cast<short>(floorf(clamped * 32767.0f + 0.5f));
+    }
+
+    unsigned short toUnorm16(float value) {
+        const float clamped = (std::max)(0.0f, (std::min)(1.0f, value));
+        return static_cast<unsigned short>(floorf(clamped * 65535.0f + 0.5f));
+    }
+
+    /// Escribe la posición de `v` en `out` y devuelve el siguiente byte libre.
+    unsigned char* writePosition(unsigned char* out, const SimpleVertex& v, PositionEncoding encoding,
+        const VertexFormat::PositionDecode& decode) {
+        if (encoding == POSITION_SNORM16) {
+            const short q[4] = {
+                toSnorm16((v.Pos.x - decode.offset.x) / decode.scale.x),
+                toSnorm16((v.Pos.y - decode.offset.y) / decode.scale.y),
+                toSnorm16((v.Pos.z - decode.offset.z) / decode.scale.z),
+                32767, // w = 1: la traslación de la matriz de mundo se aplica igual.
+            };
+            std::memcpy(out, q, sizeof(q));
+            return out + sizeof(q);
+        }
+        std::memcpy(out, &v.Pos, sizeof(v.Pos));
+        return out + sizeof(v.Pos);
+    }
+}
+
+unsigned int VertexFormat::getStride() const {
+    const unsigned int texcoord = m_texcoord == TEXCOORD_FLOAT32 ? 8 : 4;
+    return getPositionStride() + texcoord;
+}
+
+unsigned int VertexFormat::getPositionStride() const {
+    return m_position == POSITION_SNORM16 ? 8 : 12;
+}
+
+std::vector<D3D11_INPUT_ELEMENT_DESC> VertexFormat::getInputLayout() const {
+    DXGI_FORMAT texcoord = DXGI_FORMAT_R32G32_FLOAT;
+    if (m_texcoord == TEXCOORD_FLOAT16) texcoord = DXGI_FORMAT_R16G16_FLOAT;
+    if (m_texcoord == TEXCOORD_UNORM16) texcoord = DXGI_FORMAT_R16G16_UNORM;
+    return { getPositionElement(), element("TEXCOORD", texcoord) };
+}
+
+D3D11_INPUT_ELEMENT_DESC VertexFormat::getPositionElement() const {
+    return element("POSITION", m_position == POSITION_SNORM16
+        ? DXGI_FORMAT_R16G16B16A16_SNORM : DXGI_FORMAT_R32G32B32_FLOAT);
+}
+
+VertexFormat::PositionDecode VertexFormat::computeDecode(const std::vector<MeshComponent>& meshes) {
+    PositionDecode decode;
+    bool any = false;
+    XMFLOAT3 mn(0.0f, 0.0f, 0.0f), mx(0.0f, 0.0f, 0.0f);
+    for (const MeshComponent& mesh : meshes) {
+        for (const SimpleVertex& v : mesh.m_vertex) {
+            if (!any) {
+                mn = mx = v.Pos;
+                any = true;
+            }
+            mn = XMFLOAT3((std::min)(mn.x, v.Pos.x), (std::min)(mn.y, v.Pos.y), (std::min)(mn.z, v.Pos.z));
+            mx = XMFLOAT3((std::max)(mx.x, v.Pos.x), (std::max)(mx.y, v.Pos.y), (std::max)(mx.z, v.Pos.z));
+        }
+    }
+    if (!any) {
+        return decode;
+    }
+    auto half = [](float a, float b) { const float h = (b - a) * 0.5f; return h > 0.0f ? h : 1.0f; };
+    decode.offset = XMFLOAT3((mn.x + mx.x) * 0.5f, (mn.y + mx.y) * 0.5f, (mn.z + mx.z) * 0.5f);
+    decode.scale = XMFLOAT3(half(mn.x, mx.x), half(mn.y, mx.y), half(mn.z, mx.z));
+    return decode;
+}
+
+XMMATRIX VertexFormat::getDecodeMatrix(const PositionDecode& decode) const {
+    if (m_position != POSITION_SNORM16) {
+        return XMMatrixIdentity();
+    }
+    return XMMatrixMultiply(XMMatrixScaling(decode.scale.x, decode.scale.y, decode.scale.z),
+        XMMatrixTranslation(decode.offset.x, decode.offset.y, decode.offset.z));
+}
+
+void VertexFormat::encode(const std::vector<SimpleVertex>& vertices, const PositionDecode& decode,
+    std::vector<unsigned char>& out) const {
+    out.resize(vertices.size() * getStride());
+    unsigned char* cursor = out.data();
+    for (const SimpleVertex& v : vertices) {
+        cursor = writePosition(cursor, v, m_position, decode);
+        if (m_texcoord == TEXCOORD_FLOAT16) {
+            const HALF uv[2] = { XMConvertFloatToHalf(v.Tex.x), XMConvertFloatToHalf(v.Tex.y) };
+            std::memcpy(cursor, uv, sizeof(uv));
+            cursor += sizeof(uv);
+        }
+        else if (m_texcoord == TEXCOORD_UNORM16) {
+            const unsigned short uv[2] = { toUnorm16(v.Tex.x), toUnorm16(v.Tex.y) };
+            std::memcpy(cursor, uv, sizeof(uv));
+            cursor += sizeof(uv);
+        }
+        else {
+            std::memcpy(cursor, &v.Tex, sizeof(v.Tex));
+            cursor += sizeof(v.Tex);
+        }
+    }
+}
+
+void VertexFormat::encodePositions(const std::vector<SimpleVertex>& vertices, const PositionDecode& decode,
+    std::vector<unsigned char>& out) const {
+    out.resize(vertices.size() * getPositionStride());
+    unsigned char* cursor = out.data();
+    for (const SimpleVertex& v : vertices) {
+        cursor = writePosition(cursor, v, m_position, decode);
+    }
+}
@@ -0,0 +1,155 @@
+﻿/**
+ * @file VertexLayout.cpp
+ * @brief Implementación de los layouts de vértices por streams.
+ */
+
+#include "VertexLayout.h"
+#include "VertexFormat.h"
+#include <cstring>
+
+namespace {
+    /// Bytes de los formatos que usan los streams del motor (0 si no se conoce).
+    unsigned int formatSize(DXGI_FORMAT format) {
+        switch (format) {
+        case DXGI_FORMAT_R32G32B32A32_FLOAT:
+        case DXGI_FORMAT_R32G32B32A32_UINT:
+            return 16;
+        case DXGI_FORMAT_R32G32B32_FLOAT:
+            return 12;
+        case DXGI_FORMAT_R32G32_FLOAT:
+        case DXGI_FORMAT_R16G16B16A16_SNORM:
+        case DXGI_FORMAT_R16G16B16A16_FLOAT:
+            return 8;
+        case DXGI_FORMAT_R32_FLOAT:
+        case DXGI_FORMAT_R32_UINT:
+        case DXGI_FORMAT_R16G16_FLOAT:
+        case DXGI_FORMAT_R16G16_UNORM:
+        case DXGI_FORMAT_R16G16_SNORM:
+        case DXGI_FORMAT_R8G8B8A8_UNORM:
+            return 4;
+        default:
+            return 0;
+        }
+    }
+}
+
+VertexLayout& VertexLayout::add(const char* semantic, unsigned int semanticIndex, DXGI_FORMAT format,
+    unsigned int slot, bool perInstance) {
+    VertexElement element;
+    element.semantic = semantic;
+    element.semanticIndex = semanticIndex;
+    element.format = format;
+    element.slot = slot;
+    element.perInstance = perInstance;
+    m_elements.push_back(element);
+    return *this;
+}
+
+VertexLayout& VertexLayout::append(const VertexLayout& other) {
+    m_elements.insert(m_elements.end(), other.m_elements.begin(), other.m_elements.end());
+    return *this;
+}
+
+VertexLayout VertexLayout::select(unsigned int slotMask) const {
+    VertexLayout result;
+    for (const VertexElement& element : m_elements) {
+        if (slotMask & (1u << element.slot)) {
+            result.m_elements.push_back(element);
+        }
+    }
+    return result;
+}
+
+VertexLayout VertexLayout::geometry(const VertexFormat& format) {
+    VertexLayout layout;
+    for (const D3D11_INPUT_ELEMENT_DESC& desc : format.getInputLayout()) {
+        layout.add(desc.SemanticName, desc.SemanticIndex, desc.Format, VERTEX_STREAM_GEOMETRY);
+    }
+    return layout;
+}
+
+VertexLayout VertexLayout::positions(const VertexFormat& format) {
+    const D3D11_INPUT_ELEMENT_DESC desc = format.getPositionElement();
+    return VertexLayout().add(desc.SemanticName, desc.SemanticIndex, desc.Format, VERTEX_STREAM_GEOMETRY);
+}
+
+VertexLayout VertexLayout::instanceWorld() {
+    VertexLayout layout;
+    for (unsigned int row = 0; row < 4; ++row) {
+        layout.add("INSTANCE_WORLD", row, DXGI_FORMAT_R32G32B32A32_FLOAT, VERTEX_STREAM_INSTANCE, true);
+    }
+    return layout;
+}
+
+VertexLayout VertexLayout::instanceData() {
+    return instanceWorld().add("INSTANCE_COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT,
+        VERTEX_STREAM_INSTANCE, true);
+}
+
+VertexLayout VertexLayout::instanceSlice() {
+    return VertexLayout().add("INSTANCE_SLICE", 0, DXGI_FORMAT_R32_UINT, VERTEX_STREAM_SLICE, true);
+}
+
+VertexLayout VertexLayout::instanceSlot() {
+    return VertexLayout().add("INSTANCE_SLOT", 0, DXGI_FORMAT_R32_UINT, VERTEX_STREAM_INSTANCE, true);
+}
+
+VertexLayout VertexLayout::lightmapUV() {
+    return VertexLayout().add("TEXCOORD", 1, DXGI_FORMAT_R16G16_UNORM, VERTEX_STREAM_LIGHTMAP);
+}
+
+std::vector<D3D11_INPUT_ELEMENT_DESC> VertexLayout::getDesc() const {
+    std::vector<D3D11_INPUT_ELEMENT_DESC> result;
+    result.reserve(m_elements.size());
+    for (const VertexElement& element : m_elements) {
+        D3D11_INPUT_ELEMENT_DESC desc{};
+        desc.SemanticName = element.semantic;
+        desc.SemanticIndex = element.semanticIndex;
+        desc.Format = element.format;
+        desc.InputSlot = element.slot;
+        desc.AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;
+        desc.InputSlotClass = element.perInstance ? D3D11_INPUT_PER_INSTANCE_DATA : D3D11_INPUT_PER_VERTEX_DATA;
+        desc.InstanceDataStepRate = element.perInstance ? 1 : 0;
+        result.push_back(desc);
+    }
+    return result;
+}
+
+unsigned int VertexLayout::getStride(unsigned int slot) const {
+    unsigned int stride = 0;
+    for (const VertexElement& element : m_elements) {
+        if (element.slot == slot) {
+            stride += formatSize(element.format);
+        }
+    }
+    return stride;
+}
+
+unsigned int VertexLayout::getSlotMask() const {
+    unsigned int mask = 0;
+    for (const VertexElement& element : m_elements) {
+        mask |= 1u << element.slot;
+    }
+    return mask;
+}
+
+uint64_t VertexLayout::getHash() const {
+    return hashDesc(getDesc());
+}
+
+uint64_t VertexLayout::hashDesc(const std::vector<D3D11_INPUT_ELEMENT_DESC>& desc) {
+    uint64_t hash = EU::kFnv1aSeed;
+    for (const D3D11_INPUT_ELEMENT_DESC& element : desc) {
+        // La semántica por contenido (con su terminador): dos literales iguales
+        // en distintas unidades de compilación pueden tener punteros distintos.
+        const char* semantic = element.SemanticName ? element.SemanticName : "";
+        EU::Fnv1a(hash, semantic, strlen(semantic) + 1);
+        EU::Fnv1a(hash, &element.SemanticIndex, sizeof(element.SemanticIndex));
+        EU::Fnv1a(hash, &element.Format, sizeof(element.Format));
+        EU::Fnv1a(hash, &element.InputSlot, sizeof(element.InputSlot));
+        EU::Fnv1a(hash, &element.AlignedByteOffset, sizeof(element.AlignedByteOffset));
+        EU::Fnv1a(hash, &element.InputSlotClass, sizeof(element.InputSlotClass));
+        EU::Fnv1a(hash, &element.InstanceDataStepRate, sizeof(element.InstanceDataStepRate));
+    }
+    return hash;
+}
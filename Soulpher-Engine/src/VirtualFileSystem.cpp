@@ -0,0 +1,378 @@
+﻿/**
+ * @file VirtualFileSystem.cpp
+ * @brief Montaje y búsqueda en paquetes `.spak`, y su escritura.
+ */
+
+#include "VirtualFileSystem.h"
+#include "Lz4Codec.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <set>
+
+const char* const VirtualFileSystem::kDefaultPack = "Assets.spak";
+
+namespace {
+    const uint32_t kMagic = 0x4B415053; // "SPAK"
+
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t entryCount;
+        uint32_t nameBytes;
+        uint64_t entriesOffset;
+        uint64_t namesOffset;
+        uint32_t blockSize;
+        uint32_t reserved;
+    };
+
+    uint64_t alignUp(uint64_t value, uint64_t alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    bool isLooseFile(const std::string& path) {
+        const DWORD attributes = GetFileAttributesA(path.c_str());
+        return attributes != INVALID_FILE_ATTRIBUTES && !(attributes & FILE_ATTRIBUTE_DIRECTORY);
+    }
+}
+
+VirtualFileSystem& VirtualFileSystem::getDefault() {
+    static VirtualFileSystem instance;
+    return instance;
+}
+
+std::string VirtualFileSystem::normalizePath(const std::string& path) {
+    std::vector<std::string> parts;
+    std::string part;
+    for (size_t i = 0; i <= path.size(); ++i) {
+        const char c = i < path.size() ? path[i] : '\\';
+        if (c != '\\' && c != '/') {
+            part += static_cast<char>(tolower(static_cast<unsigned char>(c)));
+            continue;
+        }
+        if (part == ".." && !parts.empty() && parts.back() != "..") {
+            parts.pop_back();
+        }
+        else if (!part.empty() && part != ".") {
+            parts.push_back(part);
+        }
+        part.clear();
+    }
+    std::string result;
+    for (const std::string& p : parts) {
+        if (!result.empty()) result += '\\';
+        result += p;
+    }
+    return result;
+}
+
+uint64_t VirtualFileSystem::hashPath(const std::string& normalized) {
+    uint64_t hash = EU::kFnv1aSeed;
+    EU::Fnv1a(hash, normalized.data(), normalized.size());
+    return hash;
+}
+
+/**
+ * @details
+ * Todo lo que la búsqueda da por supuesto se comprueba aquí una vez: que la tabla, los
+ * nombres y cada entrada caben en el archivo, que la tabla está ordenada y que cada
+ * entrada comprimida tiene los bloques que corresponden a su tamaño.
+ */
+HRESULT VirtualFileSystem::mount(const std::string& packPath) {
+    std::unique_ptr<Pack> pack(new Pack());
+    if (!pack->file.open(packPath)) {
+        return E_FAIL;
+    }
+    const unsigned char* data = pack->file.getData();
+    const uint64_t size = pack->file.getSize();
+
+    Header header;
+    if (size < sizeof(header)) {
+        return E_INVALIDARG;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (header.magic != kMagic || header.version != kFormatVersion ||
+        header.entriesOffset % alignof(Entry) != 0 || header.entriesOffset > size ||
+        header.entryCount > (size - header.entriesOffset) / sizeof(Entry) ||
+        header.namesOffset > size || header.nameBytes > size - header.namesOffset || header.blockSize == 0) {
+        ERROR("VirtualFileSystem", "mount", ("Not a valid pack: " + packPath).c_str());
+        return E_INVALIDARG;
+    }
+
+    const Entry* entries = reinterpret_cast<const Entry*>(data + header.entriesOffset);
+    for (uint32_t i = 0; i < header.entryCount; ++i) {
+        const Entry& entry = entries[i];
+        const uint64_t blocks = (entry.size + header.blockSize - 1) / header.blockSize;
+        const bool layout = entry.blockCount == 0
+            ? entry.storedSize == entry.size
+            : entry.blockCount == blocks && entry.offset % sizeof(uint32_t) == 0 &&
+              entry.storedSize >= uint64_t(entry.blockCount) * sizeof(uint32_t);
+        if (!layout || entry.offset > size || entry.storedSize > size - entry.offset ||
+            uint64_t(entry.nameOffset) + entry.nameLength > header.nameBytes ||
+            (i > 0 && entries[i - 1].pathHash > entry.pathHash)) {
+            ERROR("VirtualFileSystem", "mount", ("Corrupt pack table: " + packPath).c_str());
+            return E_INVALIDARG;
+        }
+    }
+
+    pack->path = packPath;
+    pack->entries = entries;
+    pack->entryCount = header.entryCount;
+    pack->names = reinterpret_cast<const char*>(data + header.namesOffset);
+    pack->blockSize = header.blockSize;
+    m_packs.push_back(std::move(pack));
+    MESSAGE("VirtualFileSystem", "mount",
+        ("Mounted " + packPath + " (" + std::to_string(header.entryCount) + " files)").c_str());
+    return S_OK;
+}
+
+void VirtualFileSystem::unmountAll() {
+    m_packs.clear();
+}
+
+unsigned int VirtualFileSystem::getEntryCount() const {
+    unsigned int count = 0;
+    for (const auto& pack : m_packs) {
+        count += pack->entryCount;
+    }
+    return count;
+}
+
+const VirtualFileSystem::Entry*
+VirtualFileSystem::find(const std::string& normalized, const Pack** pack) const {
+    const uint64_t hash = hashPath(normalized);
+    for (auto it = m_packs.rbegin(); it != m_packs.rend(); ++it) {
+        const Pack& candidate = **it;
+        const Entry* end = candidate.entries + candidate.entryCount;
+        const Entry* entry = std::lower_bound(candidate.entries, end, hash,
+            [](const Entry& e, uint64_t value) { return e.pathHash < value; });
+        for (; entry != end && entry->pathHash == hash; ++entry) {
+            if (entry->nameLength == normalized.size() &&
+                std::memcmp(candidate.names + entry->nameOffset, normalized.data(), normalized.size()) == 0) {
+                if (pack) *pack = &candidate;
+                return entry;
+            }
+        }
+    }
+    return nullptr;
+}
+
+bool VirtualFileSystem::open(const std::string& path, FileView& view) const {
+    view.close();
+    if (m_looseOverride && view.m_loose.open(path)) {
+        view.m_data = view.m_loose.getData();
+        view.m_size = view.m_loose.getSize();
+        return true;
+    }
+    if (!m_packs.empty()) {
+        const Pack* pack = nullptr;
+        const Entry* entry = find(normalizePath(path), &pack);
+        if (entry && entry->size > 0) {
+            if (entry->blockCount > 0) {
+                if (!decode(*pack, *entry, view)) {
+                    ERROR("VirtualFileSystem", "open", ("Corrupt packed file: " + path).c_str());
+                    view.close();
+                    return false;
+                }
+                view.m_data = view.m_decoded.data();
+            }
+            else {
+                view.m_data = pack->file.getData() + entry->offset;
+            }
+            view.m_size = static_cast<size_t>(entry->size);
+            view.m_packed = true;
+            return true;
+        }
+    }
+    if (!m_looseOverride && view.m_loose.open(path)) {
+        view.m_data = view.m_loose.getData();
+        view.m_size = view.m_loose.getSize();
+        return true;
+    }
+    return false;
+}
+
+bool VirtualFileSystem::decode(const Pack& pack, const Entry& entry, FileView& view) {
+    const unsigned char* stored = pack.file.getData() + entry.offset;
+    const uint32_t* blockSizes = reinterpret_cast<const uint32_t*>(stored);
+    const size_t blockSize = pack.blockSize;
+
+    // Dónde empieza cada bloque: los tamaños se suman en serie y el resto va en paralelo.
+    std::vector<uint64_t> starts(entry.blockCount + 1);
+    starts[0] = uint64_t(entry.blockCount) * sizeof(uint32_t);
+    for (uint32_t i = 0; i < entry.blockCount; ++i) {
+        starts[i + 1] = starts[i] + blockSizes[i];
+    }
+    if (starts[entry.blockCount] > entry.storedSize) {
+        return false;
+    }
+
+    view.m_decoded.resize(static_cast<size_t>(entry.size));
+    unsigned char* decoded = view.m_decoded.data();
+    const size_t total = view.m_decoded.size();
+    std::atomic<bool> ok(true);
+    JobSystem::getDefault().parallelFor(entry.blockCount, [&](unsigned int begin, unsigned int end) {
+        for (unsigned int i = begin; i < end; ++i) {
+            const size_t first = i * blockSize;
+            const size_t raw = (std::min)(blockSize, total - first);
+            const unsigned char* block = stored + starts[i];
+            if (blockSizes[i] == raw) {
+                std::memcpy(decoded + first, block, raw);
+            }
+            else if (!Lz4Codec::decompress(block, blockSizes[i], decoded + first, raw)) {
+                ok = false;
+            }
+        }
+    });
+    return ok;
+}
+
+bool VirtualFileSystem::exists(const std::string& path) const {
+    return isPacked(path) || isLooseFile(path);
+}
+
+bool VirtualFileSystem::isPacked(const std::string& path) const {
+    return !m_packs.empty() && find(normalizePath(path), nullptr) != nullptr;
+}
+
+/**
+ * @details
+ * Una pasada: cada archivo se lee, se comprime (bloques en paralelo) y se escribe detrás
+ * del anterior; la tabla y los nombres van al final y la cabecera se reescribe con sus
+ * desplazamientos. Se escribe a un temporal que se renombra, como las demás cachés.
+ */
+HRESULT VirtualFileSystem::writePack(const std::string& packPath, const std::vector<PackFile>& files) {
+    const std::string temp = packPath + ".tmp";
+    std::ofstream out(temp.c_str(), std::ios::binary | std::ios::trunc);
+    if (!out) {
+        ERROR("VirtualFileSystem", "writePack", ("Cannot write " + temp).c_str());
+        return E_FAIL;
+    }
+    auto fail = [&](HRESULT hr) {
+        out.close();
+        DeleteFileA(temp.c_str());
+        return hr;
+    };
+    auto pad = [&](uint64_t alignment) {
+        const uint64_t position = static_cast<uint64_t>(out.tellp());
+        const std::string zeros(static_cast<size_t>(alignUp(position, alignment) - position), '\0');
+        out.write(zeros.data(), zeros.size());
+    };
+
+    Header header = {};
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    std::vector<Entry> entries;
+    std::string names;
+    std::set<std::string> written;
+    uint64_t rawBytes = 0, storedBytes = 0;
+    for (const PackFile& file : files) {
+        const std::string name = normalizePath(file.path);
+        if (!written.insert(name).second) {
+            continue;
+        }
+        MappedFile source;
+        const DWORD attributes = GetFileAttributesA(file.path.c_str());
+        if (!source.open(file.path) && (attributes == INVALID_FILE_ATTRIBUTES || (attributes & FILE_ATTRIBUTE_DIRECTORY))) {
+            ERROR("VirtualFileSystem", "writePack", ("Cannot read " + file.path).c_str());
+            return fail(E_FAIL);
+        }
+        const unsigned char* data = source.getData();
+        const size_t size = source.getSize(); // 0 si estaba vacío
+
+        Entry entry = {};
+        entry.pathHash = hashPath(name);
+        entry.size = size;
+        entry.nameOffset = static_cast<uint32_t>(names.size());
+        entry.nameLength = static_cast<uint32_t>(name.size());
+        names += name;
+
+        // Bloques comprimidos; uno que no encoge se guarda tal cual.
+        const uint32_t blockCount = static_cast<uint32_t>((size + kBlockSize - 1) / kBlockSize);
+        std::vector<std::vector<unsigned char>> blocks;
+        uint64_t compressedSize = uint64_t(blockCount) * sizeof(uint32_t);
+        if (file.compression != PACK_COMPRESSION_NONE && size > 0) {
+            blocks.resize(blockCount);
+            const bool high = file.compression == PACK_COMPRESSION_HIGH;
+            JobSystem::getDefault().parallelFor(blockCount, [&](unsigned int begin, unsigned int end) {
+                for (unsigned int i = begin; i < end; ++i) {
+                    const size_t first = size_t(i) * kBlockSize;
+                    const size_t raw = (std::min)(size_t(kBlockSize), size - first);
+                    std::vector<unsigned char>& block = blocks[i];
+                    block.resize(raw - 1);
+                    block.resize(Lz4Codec::compress(data + first, raw, block.data(), block.size(), high));
+                    if (block.empty()) {
+                        block.assign(data + first, data + first + raw);
+                    }
+                }
+            });
+            for (const std::vector<unsigned char>& block : blocks) {
+                compressedSize += block.size();
+            }
+        }
+
+        pad(kAlignment);
+        entry.offset = static_cast<uint64_t>(out.tellp());
+        if (!blocks.empty() && compressedSize <= size - size / 16) {
+            entry.compression = file.compression;
+            entry.blockCount = blockCount;
+            entry.storedSize = compressedSize;
+            for (const std::vector<unsigned char>& block : blocks) {
+                const uint32_t blockSize = static_cast<uint32_t>(block.size());
+                out.write(reinterpret_cast<const char*>(&blockSize), sizeof(blockSize));
+            }
+            for (const std::vector<unsigned char>& block : blocks) {
+                out.write(reinterpret_cast<const char*>(block.data()), block.size());
+            }
+        }
+        else {
+            entry.compression = PACK_COMPRESSION_NONE;
+            entry.storedSize = size;
+            out.write(reinterpret_cast<const char*>(data), size);
+        }
+        rawBytes += entry.size;
+        storedBytes += entry.storedSize;
+        entries.push_back(entry);
+    }
+
+    std::sort(entries.begin(), entries.end(),
+        [](const Entry& a, const Entry& b) { return a.pathHash < b.pathHash; });
+    for (size_t i = 1; i < entries.size(); ++i) {
+        if (entries[i - 1].pathHash == entries[i].pathHash) {
+            ERROR("VirtualFileSystem", "writePack",
+                ("Path hash collision: " + names.substr(entries[i - 1].nameOffset, entries[i - 1].nameLength) +
+                    " / " + names.substr(entries[i].nameOffset, entries[i].nameLength)).c_str());
+            return fail(E_INVALIDARG);
+        }
+    }
+
+    pad(alignof(Entry));
+    header.magic = kMagic;
+    header.version = kFormatVersion;
+    header.entryCount = static_cast<uint32_t>(entries.size());
+    header.nameBytes = static_cast<uint32_t>(names.size());
+    header.blockSize = kBlockSize;
+    header.entriesOffset = static_cast<uint64_t>(out.tellp());
+    header.namesOffset = header.entriesOffset + entries.size() * sizeof(Entry);
+    out.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(Entry));
+    out.write(names.data(), names.size());
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.close();
+    if (!out) {
+        DeleteFileA(temp.c_str());
+        ERROR("VirtualFileSystem", "writePack", ("Cannot write " + temp).c_str());
+        return E_FAIL;
+    }
+    if (!MoveFileExA(temp.c_str(), packPath.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+        DeleteFileA(temp.c_str());
+        ERROR("VirtualFileSystem", "writePack", ("Cannot replace " + packPath).c_str());
+        return E_FAIL;
+    }
+    MESSAGE("VirtualFileSystem", "writePack",
+        ("Wrote " + packPath + " (" + std::to_string(entries.size()) + " files, " +
+            std::to_string(rawBytes / 1024) + " KB -> " + std::to_string(storedBytes / 1024) + " KB)").c_str());
+    return S_OK;
+}
@@ -0,0 +1,355 @@
+﻿/**
+ * @file WorldStreamer.cpp
+ * @brief Partición de escenas en celdas, lectura en segundo plano y residencia por distancia.
+ */
+
+#include "WorldStreamer.h"
+#include "VirtualFileSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+namespace {
+    const char* const kManifestName = "level.sstream";
+
+    /// Celda de una coordenada de mundo.
+    int cellOf(float coordinate, float cellSize) {
+        return static_cast<int>(std::floor(coordinate / cellSize));
+    }
+}
+
+HRESULT WorldStreamer::init(Device& device, ResourceManager& resources, const SceneFile::MeshResolver& meshes,
+    const std::vector<SceneComponent>& components, const std::string& directory, const Settings& settings) {
+    const std::string manifest = directory + "\\" + kManifestName;
+    FileView view;
+    if (!VirtualFileSystem::getDefault().open(manifest, view)) {
+        return HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND);
+    }
+    const std::string text(reinterpret_cast<const char*>(view.getData()), view.getSize());
+    float cellSize = 0.0f;
+    if (sscanf_s(text.c_str(), "cellSize %f", &cellSize) != 1 || !(cellSize > 0.0f)) {
+        ERROR("WorldStreamer", "init", ("Invalid level manifest: " + manifest).c_str());
+        return E_FAIL;
+    }
+
+    m_device = &device;
+    m_resources = &resources;
+    m_meshes = meshes;
+    m_components = components;
+    m_directory = directory;
+    m_cellSize = cellSize;
+    m_settings = settings;
+    if (m_settings.loadRadius <= 0.0f) {
+        m_settings.loadRadius = 1.5f * cellSize;
+    }
+    if (m_settings.unloadRadius <= 0.0f) {
+        m_settings.unloadRadius = m_settings.loadRadius + 0.5f * cellSize;
+    }
+    m_settings.unloadRadius = (std::max)(m_settings.unloadRadius, m_settings.loadRadius);
+    m_settings.maxInFlight = (std::max)(m_settings.maxInFlight, 1u);
+    MESSAGE("WorldStreamer", "init", ("Streaming " + directory + " (cell " + std::to_string(cellSize) + ")").c_str());
+    return S_OK;
+}
+
+std::string WorldStreamer::getCellPath(int x, int z) const {
+    return m_directory + "\\cell_" + std::to_string(x) + "_" + std::to_string(z) + ".sscene";
+}
+
+float WorldStreamer::getDistance(const Cell& cell, const XMFLOAT3& focus) const {
+    const float minX = cell.x * m_cellSize;
+    const float minZ = cell.z * m_cellSize;
+    const float dx = (std::max)((std::max)(minX - focus.x, focus.x - (minX + m_cellSize)), 0.0f);
+    const float dz = (std::max)((std::max)(minZ - focus.z, focus.z - (minZ + m_cellSize)), 0.0f);
+    return std::sqrt(dx * dx + dz * dz);
+}
+
+/**
+ * @details
+ * Orden de cada frame: publicar lo leído, descargar lo lejano, ajustar al presupuesto y
+ * solo entonces encolar lecturas, para que una celda recién descargada libere sitio a
+ * la siguiente en la misma pasada.
+ */
+void WorldStreamer::update(const XMFLOAT3& focus, std::vector<ActorHandle>& actors) {
+    if (!m_resources) {
+        return;
+    }
+
+    // 1) Celdas leídas en los hilos de carga.
+    std::vector<std::pair<int64_t, std::shared_ptr<SceneData>>> loaded;
+    loaded.swap(m_loaded);
+    for (const auto& item : loaded) {
+        auto found = m_cells.find(item.first);
+        if (found == m_cells.end() || found->second.state != CELL_LOADING) {
+            continue;
+        }
+        Cell& cell = found->second;
+        --m_loadingCount;
+        if (!item.second) {
+            cell.state = CELL_MISSING; // no se reintenta: el error ya está en el log
+        }
+        else if (cell.cancelled) {
+            cell.state = CELL_UNLOADED;
+        }
+        else {
+            instantiate(cell, *item.second, actors);
+        }
+    }
+
+    // 2) Histéresis: fuera de `unloadRadius` se descarga (o se descarta al terminar de leer).
+    for (auto& pair : m_cells) {
+        Cell& cell = pair.second;
+        const bool far = getDistance(cell, focus) > m_settings.unloadRadius;
+        if (cell.state == CELL_RESIDENT && far) {
+            unload(cell, actors);
+        }
+        else if (cell.state == CELL_LOADING) {
+            cell.cancelled = far;
+        }
+    }
+
+    // 3) Presupuesto: primero las más lejanas; la más cercana se queda siempre.
+    while (m_settings.budgetBytes > 0 && m_residentBytes > m_settings.budgetBytes && m_residentCount > 1) {
+        Cell* farthest = nullptr;
+        float farthestDistance = -1.0f;
+        for (auto& pair : m_cells) {
+            const float distance = getDistance(pair.second, focus);
+            if (pair.second.state == CELL_RESIDENT && distance > farthestDistance) {
+                farthest = &pair.second;
+                farthestDistance = distance;
+            }
+        }
+        unload(*farthest, actors);
+    }
+
+    // 4) Lecturas, de la más cercana a la más lejana dentro de `loadRadius`.
+    const float radius = m_settings.loadRadius;
+    std::vector<std::pair<float, Cell*>> candidates;
+    for (int x = cellOf(focus.x - radius, m_cellSize); x <= cellOf(focus.x + radius, m_cellSize); ++x) {
+        for (int z = cellOf(focus.z - radius, m_cellSize); z <= cellOf(focus.z + radius, m_cellSize); ++z) {
+            const int64_t key = makeKey(x, z);
+            auto found = m_cells.find(key);
+            if (found == m_cells.end()) {
+                // Primera vez que se mira: se comprueba si existe y se recuerda.
+                Cell cell;
+                cell.x = x;
+                cell.z = z;
+                cell.state = VirtualFileSystem::getDefault().exists(getCellPath(x, z)) ? CELL_UNLOADED : CELL_MISSING;
+                found = m_cells.emplace(key, std::move(cell)).first;
+            }
+            const float distance = getDistance(found->second, focus);
+            if (found->second.state == CELL_UNLOADED && distance <= radius) {
+                candidates.push_back(std::make_pair(distance, &found->second));
+            }
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(),
+        [](const std::pair<float, Cell*>& a, const std::pair<float, Cell*>& b) { return a.first < b.first; });
+    const size_t averageBytes = m_residentCount > 0 ? m_residentBytes / m_residentCount : 0;
+    for (const auto& candidate : candidates) {
+        if (m_loadingCount >= m_settings.maxInFlight) {
+            break;
+        }
+        if (m_settings.budgetBytes > 0 && m_residentCount > 0 &&
+            m_residentBytes + averageBytes * (m_loadingCount + 1) > m_settings.budgetBytes) {
+            break;
+        }
+        load(*candidate.second);
+    }
+}
+
+void WorldStreamer::load(Cell& cell) {
+    cell.state = CELL_LOADING;
+    cell.cancelled = false;
+    ++m_loadingCount;
+    const int64_t key = makeKey(cell.x, cell.z);
+    const std::string path = getCellPath(cell.x, cell.z);
+    // La escena es del trabajo hasta que termina; después solo la lee el hilo principal.
+    std::shared_ptr<SceneData> scene = std::make_shared<SceneData>();
+    m_resources->runOnLoader([path, scene]() {
+        return SUCCEEDED(SceneFile::read(path, *scene));
+    }, [this, key, scene](bool succeeded) {
+        m_loaded.push_back(std::make_pair(key, succeeded ? scene : std::shared_ptr<SceneData>()));
+    });
+}
+
+void WorldStreamer::instantiate(Cell& cell, const SceneData& scene, std::vector<ActorHandle>& actors) {
+    const HRESULT hr = SceneFile::instantiate(*m_device, scene, *m_resources, m_meshes, m_components,
+        cell.prefabs, cell.actors);
+    if (FAILED(hr)) {
+        ERROR("WorldStreamer", "instantiate", ("Cell " + std::to_string(cell.x) + "," + std::to_string(cell.z) +
+            " only partially created").c_str());
+    }
+    actors.insert(actors.end(), cell.actors.begin(), cell.actors.end());
+
+    size_t blobBytes = 0;
+    for (const SceneBlob& blob : scene.blobs) {
+        blobBytes += blob.data.size();
+    }
+    cell.bytes = cell.actors.size() * (sizeof(Actor) + sizeof(Transform)) +
+        cell.prefabs.size() * sizeof(Prefab) + blobBytes;
+    cell.state = CELL_RESIDENT;
+    m_residentBytes += cell.bytes;
+    ++m_residentCount;
+}
+
+void WorldStreamer::unload(Cell& cell, std::vector<ActorHandle>& actors) {
+    if (!cell.actors.empty()) {
+        EU::TSet<uint32_t> owned;
+        owned.Reserve(cell.actors.size());
+        for (ActorHandle actor : cell.actors) {
+            owned.Add(actor.value);
+        }
+        actors.erase(std::remove_if(actors.begin(), actors.end(),
+            [&owned](ActorHandle actor) { return owned.Contains(actor.value); }),
+            actors.end());
+    }
+    for (ActorHandle actor : cell.actors) {
+        if (!actor.isNull()) {
+            actor->destroy();
+            ActorPool::getDefault().despawn(actor);
+        }
+    }
+    cell.actors.clear();
+    cell.prefabs.clear();
+    m_residentBytes -= cell.bytes;
+    cell.bytes = 0;
+    cell.state = CELL_UNLOADED;
+    --m_residentCount;
+}
+
+void WorldStreamer::destroy(std::vector<ActorHandle>& actors) {
+    for (auto& pair : m_cells) {
+        if (pair.second.state == CELL_RESIDENT) {
+            unload(pair.second, actors);
+        }
+    }
+    m_cells.clear();
+    m_loaded.clear();
+    m_loadingCount = 0;
+    m_device = nullptr;
+    m_resources = nullptr;
+    m_meshes = SceneFile::MeshResolver();
+    m_components.clear();
+}
+
+/**
+ * @details
+ * Cada celda lleva solo las cadenas y materiales que usan sus filas, con los índices
+ * renumerados; los padres se renumeran dentro de la celda (están en la misma, porque la
+ * celda la decide la raíz).
+ */
+HRESULT WorldStreamer::split(const SceneData& scene, float cellSize, const std::string& directory) {
+    if (!(cellSize > 0.0f)) {
+        cellSize = kDefaultCellSize;
+    }
+    const uint32_t count = scene.getEntityCount();
+    const uint32_t stringCount = static_cast<uint32_t>(scene.strings.size());
+    const uint32_t materialCount = static_cast<uint32_t>(scene.materialTable.size());
+
+    // Orden estable por clave: la misma escena produce siempre los mismos archivos.
+    std::map<int64_t, std::vector<uint32_t>> cells;
+    for (uint32_t row = 0; row < count; ++row) {
+        uint32_t root = row;
+        for (uint32_t depth = 0; depth < count && scene.parents[root] < count; ++depth) {
+            root = scene.parents[root];
+        }
+        const EU::Vector3& position = scene.positions[root];
+        cells[makeKey(cellOf(position.x, cellSize), cellOf(position.z, cellSize))].push_back(row);
+    }
+
+    if (!CreateDirectoryA(directory.c_str(), nullptr) && GetLastError() != ERROR_ALREADY_EXISTS) {
+        ERROR("WorldStreamer", "split", ("Cannot create " + directory).c_str());
+        return HRESULT_FROM_WIN32(GetLastError());
+    }
+
+    for (const auto& entry : cells) {
+        const std::vector<uint32_t>& rows = entry.second;
+        SceneData part;
+        part.resize(static_cast<uint32_t>(rows.size()));
+
+        std::unordered_map<uint32_t, uint32_t> strings;
+        auto remapString = [&](uint32_t index) {
+            if (index >= stringCount) {
+                return SceneData::kNone;
+            }
+            auto found = strings.find(index);
+            if (found == strings.end()) {
+                found = strings.emplace(index, static_cast<uint32_t>(part.strings.size())).first;
+                part.strings.push_back(scene.strings[index]);
+            }
+            return found->second;
+        };
+        std::unordered_map<uint32_t, uint32_t> materials;
+        std::unordered_map<uint32_t, uint32_t> localRow;
+        for (uint32_t i = 0; i < rows.size(); ++i) {
+            localRow[rows[i]] = i;
+        }
+
+        for (uint32_t i = 0; i < rows.size(); ++i) {
+            const uint32_t row = rows[i];
+            part.positions[i] = scene.positions[row];
+            part.rotations[i] = scene.rotations[row];
+            part.scales[i] = scene.scales[row];
+            auto parent = localRow.find(scene.parents[row]);
+            part.parents[i] = parent != localRow.end() ? parent->second : SceneData::kNone;
+            part.meshes[i] = remapString(scene.meshes[row]);
+            part.colors[i] = scene.colors[row];
+            part.flags[i] = scene.flags[row];
+            part.impostorDistances[i] = scene.impostorDistances[row];
+            part.names[i] = remapString(scene.names[row]);
+
+            const uint32_t material = scene.materials[row];
+            if (material < materialCount) {
+                auto found = materials.find(material);
+                if (found == materials.end()) {
+                    SceneMaterial copy = scene.materialTable[material];
+                    copy.diffuse = remapString(copy.diffuse);
+                    found = materials.emplace(material, static_cast<uint32_t>(part.materialTable.size())).first;
+                    part.materialTable.push_back(copy);
+                }
+                part.materials[i] = found->second;
+            }
+        }
+
+        for (const SceneBlob& blob : scene.blobs) {
+            SceneBlob piece;
+            piece.type = blob.type;
+            piece.elementSize = blob.elementSize;
+            for (size_t k = 0; k < blob.entities.size(); ++k) {
+                auto found = localRow.find(blob.entities[k]);
+                if (found != localRow.end()) {
+                    piece.entities.push_back(found->second);
+                    const unsigned char* value = blob.data.data() + k * blob.elementSize;
+                    piece.data.insert(piece.data.end(), value, value + blob.elementSize);
+                }
+            }
+            if (!piece.entities.empty()) {
+                // `SceneFile::write` guarda el tipo como índice de la tabla de cadenas.
+                if (std::find(part.strings.begin(), part.strings.end(), piece.type) == part.strings.end()) {
+                    part.strings.push_back(piece.type);
+                }
+                part.blobs.push_back(std::move(piece));
+            }
+        }
+
+        const int x = static_cast<int>(entry.first >> 32);
+        const int z = static_cast<int>(static_cast<uint32_t>(entry.first));
+        const std::string path = directory + "\\cell_" + std::to_string(x) + "_" + std::to_string(z) + ".sscene";
+        const HRESULT hr = SceneFile::write(path, part);
+        if (FAILED(hr)) {
+            return hr;
+        }
+    }
+
+    const std::string manifest = directory + "\\" + kManifestName;
+    FILE* file = nullptr;
+    if (fopen_s(&file, manifest.c_str(), "w") != 0 || !file) {
+        ERROR("WorldStreamer", "split", ("Cannot write " + manifest).c_str());
+        return E_FAIL;
+    }
+    fprintf(file, "cellSize %g\n", cellSize);
+    fclose(file);
+    MESSAGE("WorldStreamer", "split", (std::to_string(count) + " actors in " + std::to_string(cells.size()) +
+        " cells written to " + directory).c_str());
+    return S_OK;
+}